@@ -307,6 +307,33 @@ hsaKmtWaitOnMultipleEvents_Ext(
     uint64_t   *event_age       //IN/OUT
     );
 
+/**
+  Exports a set of signal events as a pollable file descriptor (eventfd).
+  The descriptor becomes readable whenever one of the events is signaled;
+  reading it clears the readiness. Wakeups may be spurious, callers must
+  check the state they are waiting for. The events must stay valid until
+  the descriptor is released with hsaKmtCloseEventFd.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtOpenEventFd(
+    HsaEvent*   Events[],       //IN
+    HSAuint32   NumEvents,      //IN
+    int        *Fd              //OUT
+    );
+
+/**
+  Stops tracking the events exported through a descriptor returned by
+  hsaKmtOpenEventFd and closes it
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtCloseEventFd(
+    int         Fd              //IN
+    );
+
 /**
   new TEMPORARY function definition - to be used only on "Triniti + Southern Islands" platform
   If used on other platforms the function will return HSAKMT_STATUS_ERROR
@@ -664,6 +691,68 @@ hsaKmtUnmapMemoryToGPU(
     void*           MemoryAddress       //IN (page-aligned)
     );
 
+/**
+  Ensures that each of the memory ranges is resident and can be accessed by
+  the GPUs in NodeArray, as hsaKmtMapMemoryToGPUNodes. Stops at the first
+  range that fails; earlier ranges stay mapped.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtMapMemoryToGPUNodesBatch(
+    HsaMemoryRange* Ranges,                //IN
+    HSAuint64       NumberOfRanges,        //IN
+    HsaMemMapFlags  MemMapFlags,           //IN
+    HSAuint64       NumberOfNodes,         //IN
+    HSAuint32*      NodeArray              //IN
+    );
+
+/**
+  Releases the residency of each of the memory addresses, as
+  hsaKmtUnmapMemoryToGPU. All addresses are processed; an error is returned
+  if any of them failed.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtUnmapMemoryToGPUBatch(
+    void**          MemoryAddresses,       //IN (page-aligned)
+    HSAuint64       NumberOfAddresses      //IN
+    );
+
+/**
+  Declares the GPU nodes the process is going to use. The per-GPU VM of a
+  node is acquired on its first use; until this is called, using any GPU
+  acquires the VMs of all GPUs. Afterwards memory mapped without a node list
+  is only mapped to active nodes. Nodes outside the set are still activated
+  if they are named explicitly later. With XNACK enabled all GPUs are
+  activated. NumberOfNodes 0 only declares that a set will follow.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtActivateNodes(
+    HSAuint32       NumberOfNodes,         //IN
+    HSAuint32*      NodeArray              //IN
+    );
+
+/**
+  Queues a batch of memory and event operations for execution on a
+  libhsakmt worker thread, so the calling thread can continue with host work.
+  Batches run in submission order and the operations of a batch run in array
+  order, each as the corresponding synchronous call. The Status of every
+  operation is filled in before CompletionEvent is signaled. Ops must stay
+  valid until then.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtSubmitAsyncOps(
+    HsaAsyncOp*     Ops,                   //IN/OUT
+    HSAuint32       NumberOfOps,           //IN
+    HsaEvent*       CompletionEvent        //IN
+    );
+
 
 /**
   Notifies the kernel driver that a process wants to use GPU debugging facilities
@@ -942,6 +1031,80 @@ hsaKmtPmcStopTrace(
     HSATraceId  TraceId     //IN
     );
 
+/**
+  Creates a multiplexed counter session. Counters are split into groups that
+  each fit the per-block concurrency limits and the groups are time-sliced
+  while the session runs. With a non-zero SliceIntervalUs a session thread
+  switches groups at that period, otherwise the caller switches with
+  hsaKmtPmcRotateSession. NumberOfGroups returns the number of groups.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtPmcCreateSession(
+    HSAuint32           NodeId,             //IN
+    HSAuint32           NumberOfCounters,   //IN
+    HsaCounter*         Counters,           //IN
+    HSAuint32           SliceIntervalUs,    //IN
+    HSAuint32*          NumberOfGroups,     //OUT
+    HSAPmcSessionId*    SessionId           //OUT
+    );
+
+/**
+  Stops the session if it is running and releases its traces
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtPmcDestroySession(
+    HSAPmcSessionId     SessionId           //IN
+    );
+
+/**
+  Starts counting with the first counter group of the session
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtPmcStartSession(
+    HSAPmcSessionId     SessionId           //IN
+    );
+
+/**
+  Switches a running session to its next counter group
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtPmcRotateSession(
+    HSAPmcSessionId     SessionId           //IN
+    );
+
+/**
+  Returns an estimate of every session counter, in the order passed to
+  hsaKmtPmcCreateSession. Each counted value is scaled by the time the session
+  has run over the time its group was counting. Counters of a group that has
+  not counted yet read as 0.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtPmcReadSession(
+    HSAPmcSessionId     SessionId,          //IN
+    HSAuint32           NumberOfValues,     //IN
+    HSAuint64*          Values              //OUT
+    );
+
+/**
+  Stops counting. The session keeps its values and may be started again.
+*/
+
+HSAKMT_STATUS
+HSAKMTAPI
+hsaKmtPmcStopSession(
+    HSAPmcSessionId     SessionId           //IN
+    );
+
 /**
   Sets trap handler and trap buffer to be used for all queues associated with the specified NodeId within this process context
 */
@@ -1333,6 +1333,8 @@ typedef struct _HsaPmcTraceRoot
     HSATraceId                  TraceId;
 } HsaPmcTraceRoot;
 
+typedef HSAuint64   HSAPmcSessionId;
+
 typedef struct _HsaGpuTileConfig
 {
     HSAuint32 *TileConfig;
@@ -1497,6 +1499,48 @@ typedef union
     } ui32;
 } HSA_REGISTER_MEM_FLAGS;
 
+//
+// Operations queued with hsaKmtSubmitAsyncOps
+//
+
+typedef enum _HSA_ASYNC_OP_TYPE
+{
+    HSA_ASYNC_OP_ALLOC_MEMORY         = 0,  // hsaKmtAllocMemory
+    HSA_ASYNC_OP_FREE_MEMORY          = 1,  // hsaKmtFreeMemory
+    HSA_ASYNC_OP_REGISTER_MEMORY      = 2,  // hsaKmtRegisterMemory
+    HSA_ASYNC_OP_MAP_MEMORY_TO_GPU    = 3,  // hsaKmtMapMemoryToGPU
+    HSA_ASYNC_OP_SET_EVENT            = 4,  // hsaKmtSetEvent
+    HSA_ASYNC_OP_NUM
+} HSA_ASYNC_OP_TYPE;
+
+typedef struct _HsaAsyncOp
+{
+    HSA_ASYNC_OP_TYPE   Type;
+    HSAKMT_STATUS       Status;             // OUT: result of the operation
+    union
+    {
+        struct
+        {
+            HSAuint32   PreferredNode;
+            HsaMemFlags MemFlags;
+            HSAuint64   SizeInBytes;
+            void*       MemoryAddress;      // OUT
+        } Alloc;
+        struct
+        {
+            void*       MemoryAddress;
+            HSAuint64   SizeInBytes;
+        } Memory;                           // Free and Register
+        struct
+        {
+            void*       MemoryAddress;
+            HSAuint64   SizeInBytes;
+            HSAuint64   AlternateVAGPU;     // OUT
+        } Map;
+        HsaEvent*       Event;              // SetEvent
+    } Args;
+} HsaAsyncOp;
+
 #pragma pack(pop, hsakmttypes_h)
 
 
@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2026 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including
+ * the next paragraph) shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "libhsakmt.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+/* Asynchronous submission of memory and event operations. KFD has no
+ * asynchronous ioctl interface (no uring_cmd support), so batches are
+ * queued on a FIFO and executed by a single worker thread which signals
+ * the completion event of each batch.
+ */
+struct async_batch {
+	HsaAsyncOp *ops;
+	HSAuint32 num_ops;
+	HsaEvent *completion;
+	struct async_batch *next;
+};
+
+static pthread_mutex_t async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t async_cond = PTHREAD_COND_INITIALIZER;
+static struct async_batch *async_head, *async_tail;
+static bool async_worker_running;
+
+void hsakmt_clear_async_ops(void)
+{
+	struct async_batch *batch;
+
+	/* Batches queued in the parent are not executed in the child */
+	pthread_mutex_init(&async_mutex, NULL);
+	pthread_cond_init(&async_cond, NULL);
+	while (async_head) {
+		batch = async_head;
+		async_head = batch->next;
+		free(batch);
+	}
+	async_tail = NULL;
+	async_worker_running = false;
+}
+
+static HSAKMT_STATUS async_execute(HsaAsyncOp *op)
+{
+	switch (op->Type) {
+	case HSA_ASYNC_OP_ALLOC_MEMORY:
+		return hsaKmtAllocMemory(op->Args.Alloc.PreferredNode,
+					 op->Args.Alloc.SizeInBytes,
+					 op->Args.Alloc.MemFlags,
+					 &op->Args.Alloc.MemoryAddress);
+	case HSA_ASYNC_OP_FREE_MEMORY:
+		return hsaKmtFreeMemory(op->Args.Memory.MemoryAddress,
+					op->Args.Memory.SizeInBytes);
+	case HSA_ASYNC_OP_REGISTER_MEMORY:
+		return hsaKmtRegisterMemory(op->Args.Memory.MemoryAddress,
+					    op->Args.Memory.SizeInBytes);
+	case HSA_ASYNC_OP_MAP_MEMORY_TO_GPU:
+		return hsaKmtMapMemoryToGPU(op->Args.Map.MemoryAddress,
+					    op->Args.Map.SizeInBytes,
+					    &op->Args.Map.AlternateVAGPU);
+	case HSA_ASYNC_OP_SET_EVENT:
+		return hsaKmtSetEvent(op->Args.Event);
+	default:
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+	}
+}
+
+static void *async_worker(void *arg)
+{
+	struct async_batch *batch;
+	HSAuint32 i;
+
+	pthread_mutex_lock(&async_mutex);
+	for (;;) {
+		while (!async_head)
+			pthread_cond_wait(&async_cond, &async_mutex);
+
+		/* Take everything queued so far and run it in one go */
+		batch = async_head;
+		async_head = async_tail = NULL;
+		pthread_mutex_unlock(&async_mutex);
+
+		while (batch) {
+			struct async_batch *next = batch->next;
+
+			for (i = 0; i < batch->num_ops; i++)
+				batch->ops[i].Status = async_execute(&batch->ops[i]);
+			if (hsaKmtSetEvent(batch->completion) != HSAKMT_STATUS_SUCCESS)
+				pr_err("Failed to signal async batch completion\n");
+			free(batch);
+			batch = next;
+		}
+
+		pthread_mutex_lock(&async_mutex);
+	}
+
+	return NULL;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtSubmitAsyncOps(HsaAsyncOp *Ops,
+					     HSAuint32 NumberOfOps,
+					     HsaEvent *CompletionEvent)
+{
+	struct async_batch *batch;
+	pthread_t thread;
+	HSAuint32 i;
+
+	CHECK_KFD_OPEN();
+
+	pr_debug("[%s] %u ops\n", __func__, NumberOfOps);
+
+	if ((!Ops && NumberOfOps) || !CompletionEvent)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+	if (CompletionEvent->EventData.EventType != HSA_EVENTTYPE_SIGNAL)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	for (i = 0; i < NumberOfOps; i++) {
+		if (Ops[i].Type >= HSA_ASYNC_OP_NUM)
+			return HSAKMT_STATUS_INVALID_PARAMETER;
+		Ops[i].Status = HSAKMT_STATUS_ERROR;
+	}
+
+	batch = malloc(sizeof(*batch));
+	if (!batch)
+		return HSAKMT_STATUS_NO_MEMORY;
+	batch->ops = Ops;
+	batch->num_ops = NumberOfOps;
+	batch->completion = CompletionEvent;
+	batch->next = NULL;
+
+	pthread_mutex_lock(&async_mutex);
+	if (!async_worker_running) {
+		if (pthread_create(&thread, NULL, async_worker, NULL)) {
+			pthread_mutex_unlock(&async_mutex);
+			free(batch);
+			return HSAKMT_STATUS_ERROR;
+		}
+		pthread_detach(thread);
+		async_worker_running = true;
+	}
+
+	if (async_tail)
+		async_tail->next = batch;
+	else
+		async_head = batch;
+	async_tail = batch;
+	pthread_cond_signal(&async_cond);
+	pthread_mutex_unlock(&async_mutex);
+
+	return HSAKMT_STATUS_SUCCESS;
+}
@@ -30,15 +30,58 @@
 #include <errno.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/eventfd.h>
 #include <stdio.h>
 #include "hsakmt/linux/kfd_ioctl.h"
 #include "fmm.h"
 
 static HSAuint64 *events_page = NULL;
 
+/* Signal events exported as a pollable eventfd. A single watcher thread
+ * waits on the events of all registrations and bumps the eventfd of each
+ * registration that had one of its events fire. Event ages are tracked so
+ * the watcher doesn't hide signals from other age-aware waiters.
+ */
+struct event_fd {
+	int fd;
+	HSAuint32 num_events;
+	HsaEvent **events;
+	uint64_t *event_age;
+	struct event_fd *next;
+};
+
+static pthread_mutex_t event_fd_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t event_fd_cond = PTHREAD_COND_INITIALIZER;
+static struct event_fd *event_fds;
+static HsaEvent *event_fd_wakeup;	/* interrupts the watcher's wait */
+static uint64_t event_fd_wakeup_age = 1;
+static uint64_t event_fd_generation;
+static uint64_t event_fd_watch_generation;	/* what the watcher waits on */
+static bool event_fd_thread_running;
+
+static void clear_event_fds(void)
+{
+	struct event_fd *efd;
+
+	pthread_mutex_init(&event_fd_mutex, NULL);
+	pthread_cond_init(&event_fd_cond, NULL);
+	while (event_fds) {
+		efd = event_fds;
+		event_fds = efd->next;
+		free(efd->events);
+		free(efd->event_age);
+		free(efd);
+	}
+	event_fd_wakeup = NULL;
+	event_fd_wakeup_age = 1;
+	event_fd_thread_running = false;
+}
+
 void hsakmt_clear_events_page(void)
 {
 	events_page = NULL;
+	/* The parent's eventfd registrations reference its KFD events */
+	clear_event_fds();
 }
 
 static bool IsSystemEventType(HSA_EVENTTYPE type)
@@ -460,6 +503,212 @@ out:
 	return result;
 }
 
+static void *event_fd_watcher(void *arg)
+{
+	HsaEvent **events = NULL;
+	uint64_t *ages = NULL;
+	HSAuint32 capacity = 0, num_events, i, j;
+	uint64_t generation, one = 1;
+	struct event_fd *efd;
+	HSAKMT_STATUS ret;
+
+	for (;;) {
+		pthread_mutex_lock(&event_fd_mutex);
+		if (!event_fds)
+			break;
+
+		num_events = 1;
+		for (efd = event_fds; efd; efd = efd->next)
+			num_events += efd->num_events;
+		if (num_events > capacity) {
+			free(events);
+			free(ages);
+			events = malloc(num_events * sizeof(*events));
+			ages = malloc(num_events * sizeof(*ages));
+			if (!events || !ages) {
+				pr_err("Out of memory watching %u events\n", num_events);
+				break;
+			}
+			capacity = num_events;
+		}
+
+		events[0] = event_fd_wakeup;
+		ages[0] = event_fd_wakeup_age;
+		i = 1;
+		for (efd = event_fds; efd; efd = efd->next) {
+			memcpy(&events[i], efd->events, efd->num_events * sizeof(*events));
+			memcpy(&ages[i], efd->event_age, efd->num_events * sizeof(*ages));
+			i += efd->num_events;
+		}
+		generation = event_fd_generation;
+		event_fd_watch_generation = generation;
+		pthread_cond_broadcast(&event_fd_cond);
+		pthread_mutex_unlock(&event_fd_mutex);
+
+		ret = hsaKmtWaitOnMultipleEvents_Ext(events, num_events, false,
+						     HSA_EVENTTIMEOUT_INFINITE, ages);
+
+		pthread_mutex_lock(&event_fd_mutex);
+		if (ret != HSAKMT_STATUS_SUCCESS && ret != HSAKMT_STATUS_WAIT_TIMEOUT) {
+			pr_err("Waiting on exported events failed: %d\n", ret);
+			break;
+		}
+		event_fd_wakeup_age = ages[0];
+
+		/* Registrations changed while waiting, unreported ages are
+		 * picked up again by the next wait
+		 */
+		if (generation == event_fd_generation) {
+			i = 1;
+			for (efd = event_fds; efd; efd = efd->next) {
+				bool fired = false;
+
+				for (j = 0; j < efd->num_events; j++, i++) {
+					if (ages[i] == efd->event_age[j])
+						continue;
+					efd->event_age[j] = ages[i];
+					fired = true;
+				}
+				if (fired && write(efd->fd, &one, sizeof(one)) < 0 &&
+				    errno != EAGAIN)
+					pr_err("Failed to signal event fd %d\n", efd->fd);
+			}
+		}
+		pthread_mutex_unlock(&event_fd_mutex);
+	}
+
+	event_fd_thread_running = false;
+	pthread_cond_broadcast(&event_fd_cond);
+	pthread_mutex_unlock(&event_fd_mutex);
+	free(events);
+	free(ages);
+	return NULL;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtOpenEventFd(HsaEvent *Events[],
+					  HSAuint32 NumEvents,
+					  int *Fd)
+{
+	HsaEventDescriptor wakeup_desc = {0};
+	HSAKMT_STATUS result = HSAKMT_STATUS_SUCCESS;
+	struct event_fd *efd;
+	pthread_t thread;
+	HSAuint32 i;
+
+	CHECK_KFD_OPEN();
+	/* Sharing events with other waiters relies on event age tracking */
+	CHECK_KFD_MINOR_VERSION(14);
+
+	if (!Events || !NumEvents || !Fd)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	for (i = 0; i < NumEvents; i++) {
+		if (!Events[i])
+			return HSAKMT_STATUS_INVALID_HANDLE;
+		if (Events[i]->EventData.EventType != HSA_EVENTTYPE_SIGNAL)
+			return HSAKMT_STATUS_INVALID_PARAMETER;
+	}
+
+	efd = calloc(1, sizeof(*efd));
+	if (!efd)
+		return HSAKMT_STATUS_NO_MEMORY;
+	efd->num_events = NumEvents;
+	efd->events = malloc(NumEvents * sizeof(*efd->events));
+	efd->event_age = malloc(NumEvents * sizeof(*efd->event_age));
+	if (!efd->events || !efd->event_age) {
+		result = HSAKMT_STATUS_NO_MEMORY;
+		goto out_free;
+	}
+	memcpy(efd->events, Events, NumEvents * sizeof(*efd->events));
+	/* Age 1 returns at once if the event has fired before */
+	for (i = 0; i < NumEvents; i++)
+		efd->event_age[i] = 1;
+
+	efd->fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (efd->fd < 0) {
+		pr_err("Failed to create event fd: %s\n", strerror(errno));
+		result = HSAKMT_STATUS_ERROR;
+		goto out_free;
+	}
+
+	pthread_mutex_lock(&event_fd_mutex);
+	if (!event_fd_wakeup) {
+		wakeup_desc.EventType = HSA_EVENTTYPE_SIGNAL;
+		result = hsaKmtCreateEvent(&wakeup_desc, false, false,
+					   &event_fd_wakeup);
+		if (result != HSAKMT_STATUS_SUCCESS) {
+			pthread_mutex_unlock(&event_fd_mutex);
+			goto out_close;
+		}
+	}
+
+	efd->next = event_fds;
+	event_fds = efd;
+	event_fd_generation++;
+
+	if (event_fd_thread_running) {
+		hsaKmtSetEvent(event_fd_wakeup);
+	} else if (pthread_create(&thread, NULL, event_fd_watcher, NULL) == 0) {
+		pthread_detach(thread);
+		event_fd_thread_running = true;
+	} else {
+		event_fds = efd->next;
+		pthread_mutex_unlock(&event_fd_mutex);
+		result = HSAKMT_STATUS_ERROR;
+		goto out_close;
+	}
+	pthread_mutex_unlock(&event_fd_mutex);
+
+	*Fd = efd->fd;
+	return HSAKMT_STATUS_SUCCESS;
+
+out_close:
+	close(efd->fd);
+out_free:
+	free(efd->events);
+	free(efd->event_age);
+	free(efd);
+	return result;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtCloseEventFd(int Fd)
+{
+	struct event_fd **link, *efd = NULL;
+
+	CHECK_KFD_OPEN();
+
+	pthread_mutex_lock(&event_fd_mutex);
+	for (link = &event_fds; *link; link = &(*link)->next) {
+		if ((*link)->fd == Fd) {
+			efd = *link;
+			*link = efd->next;
+			break;
+		}
+	}
+	if (efd) {
+		uint64_t generation = ++event_fd_generation;
+
+		/* Wait for the watcher to drop the events from its wait, the
+		 * caller may destroy them once this returns
+		 */
+		if (event_fd_thread_running)
+			hsaKmtSetEvent(event_fd_wakeup);
+		while (event_fd_thread_running &&
+		       event_fd_watch_generation < generation)
+			pthread_cond_wait(&event_fd_cond, &event_fd_mutex);
+	}
+	pthread_mutex_unlock(&event_fd_mutex);
+
+	if (!efd)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	close(efd->fd);
+	free(efd->events);
+	free(efd->event_age);
+	free(efd);
+	return HSAKMT_STATUS_SUCCESS;
+}
+
 HSAKMT_STATUS HSAKMTAPI hsaKmtOpenSMI(HSAuint32 NodeId, int *fd)
 {
 	struct kfd_ioctl_smi_events_args args;
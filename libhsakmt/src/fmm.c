@@ -50,6 +50,10 @@
 #define MPOL_F_STATIC_NODES     (1 << 15)
 #endif
 
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT          26
+#endif
+
 #define NON_VALID_GPU_ID 0
 
 #define INIT_MANAGEABLE_APERTURE(base_value, limit_value) {	\
@@ -111,6 +115,8 @@ struct vm_object {
 	void *user_data;
 	/* Flag to indicate imported KFD buffer */
 	bool is_imported_kfd_bo;
+	/* VA arena the address range was carved from, if any */
+	struct va_arena *va_arena;
 #ifdef SANITIZER_AMDGPU
 	int mmap_flags;
 	int mmap_fd;
@@ -198,6 +204,9 @@ typedef struct {
 	uint32_t usable_peer_id_num;
 	uint32_t *usable_peer_id_array;
 	int drm_render_minor;
+	bool has_apertures;	/* KFD reported process apertures for this GPU */
+	bool svm_memory_policy;	/* GPUVM in canonical space, needs SVM policy */
+	bool vm_acquired;	/* VM acquired and MMIO page mapped */
 } gpu_mem_t;
 
 enum svm_aperture_type {
@@ -265,10 +274,21 @@ static manageable_aperture_t cpuvm_aperture = INIT_MANAGEABLE_APERTURE(0, 0);
 */
 static manageable_aperture_t mem_handle_aperture = INIT_MANAGEABLE_APERTURE(START_NON_CANONICAL_ADDR, (START_NON_CANONICAL_ADDR + (1ULL << 47)));
 
-/* GPU node array for default mappings */
+/* GPU node array for default mappings. Only GPUs whose VM has been
+ * acquired are listed, see fmm_activate_gpu_locked().
+ */
 static uint32_t all_gpu_id_array_size;
 static uint32_t *all_gpu_id_array;
 
+/* Per-GPU VMs are acquired lazily on first use. Until the application
+ * declares the set of GPUs it uses (hsaKmtActivateNodes), the first use
+ * of any GPU activates all of them.
+ */
+static pthread_mutex_t gpu_activate_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool gpu_active_set_declared;
+static uint32_t gpu_active_count;
+static gpu_mem_t *fmm_default_gpu(void);
+
 /* IPC structures and helper functions */
 typedef enum _HSA_APERTURE {
 	HSA_APERTURE_UNSUPPORTED = 0,
@@ -352,6 +372,7 @@ static vm_object_t *vm_create_and_init_object(void *start, uint64_t size,
 		object->metadata = NULL;
 		object->user_data = NULL;
 		object->is_imported_kfd_bo = false;
+		object->va_arena = NULL;
 		object->node.key = rbtree_key((unsigned long)start, size);
 		object->user_node.key = rbtree_key(0, 0);
 #ifdef SANITIZER_AMDGPU
@@ -488,58 +509,13 @@ static vm_object_t *vm_find_object_by_address_userptr(manageable_aperture_t *app
 static vm_object_t *vm_find_object_by_address_userptr_range(manageable_aperture_t *app,
 						    const void *address, int is_userptr)
 {
-	vm_object_t *cur = NULL;
 	rbtree_t *tree = vm_object_tree(app, is_userptr);
-	rbtree_key_t key = rbtree_key((unsigned long)address, 0);
-	rbtree_node_t *rn = rbtree_lookup_nearest(tree, &key, LKP_ALL, RIGHT);
-	rbtree_node_t *ln;
-	void *start;
-	uint64_t size;
-
-	/* all nodes might sit on left side of *address*, in this case rn is NULL.
-	 * So pick up the rightest one as rn.
+	/* userptr might overlap, the interval lookup returns the rightmost
+	 * node containing *address* as a walk from right to left would.
 	 */
-	if (!rn)
-		rn = rbtree_min_max(tree, RIGHT);
-
-	if (is_userptr) {
-		/* userptr might overlap. Need walk through the tree from right to left as only left nodes
-		 * can obtain the *address*
-		 */
-		ln = rbtree_min_max(tree, LEFT);
-	} else {
-		/* if key->size is -1, it match the node with start <= address.
-		 * if key->size is 0, it match the node with start < address.
-		 */
-		key = rbtree_key((unsigned long)address, -1);
-		ln = rbtree_lookup_nearest(tree, &key, LKP_ALL, LEFT);
-	}
-	if (!ln)
-		return NULL;
+	rbtree_node_t *n = rbtree_lookup_interval(tree, (unsigned long)address);
 
-	while (rn) {
-		cur = vm_object_entry(rn, is_userptr);
-		if (is_userptr == 0) {
-			start = cur->start;
-			size = cur->size;
-		} else {
-			start = cur->userptr;
-			size = cur->userptr_size;
-		}
-
-		if (address >= start &&
-				(uint64_t)address < ((uint64_t)start + size))
-			break;
-
-		cur = NULL;
-
-		if (ln == rn)
-			break;
-
-		rn = hsakmt_rbtree_prev(tree, rn);
-	}
-
-	return cur; /* NULL if not found */
+	return n ? vm_object_entry(n, is_userptr) : NULL; /* NULL if not found */
 }
 
 static vm_object_t *vm_find_object_by_address(manageable_aperture_t *app,
@@ -597,6 +573,42 @@ static uint64_t vm_align_area_size(manageable_aperture_t *app, uint64_t size)
 	return size + (uint64_t)app->guard_pages * PAGE_SIZE;
 }
 
+/* Remove any CPU mapping of [address, address + size) and reset its NUMA
+ * policy, but keep the address range reserved.
+ */
+static void reserve_cpu_range(void *address, uint64_t size)
+{
+	void *mmap_ret;
+
+	/* Reset NUMA policy */
+	mbind(address, size, MPOL_DEFAULT, NULL, 0, 0);
+
+	/* Remove any CPU mapping, but keep the address range reserved */
+	mmap_ret = mmap(address, size, PROT_NONE,
+		MAP_ANONYMOUS | MAP_NORESERVE | MAP_PRIVATE | MAP_FIXED,
+		-1, 0);
+	if (mmap_ret == MAP_FAILED && errno == ENOMEM) {
+		/* When mmap count reaches max_map_count, any mmap will
+		 * fail. Reduce the count with munmap then map it as
+		 * NORESERVE immediately.
+		 */
+		if (munmap(address, size) == 0) {
+			/* After unmapping, try mmap again and handle failure
+			 * */
+			mmap_ret = mmap(address, size, PROT_NONE,
+					MAP_ANONYMOUS | MAP_NORESERVE | MAP_PRIVATE | MAP_FIXED,
+					-1, 0);
+			if (mmap_ret == MAP_FAILED) {
+				/* Handle mmap failure gracefully, log if needed */
+				pr_err("Failed to remap memory after unmap\n");
+			}
+		} else {
+			/* Handle munmap failure if needed */
+			pr_err("Failed to unmap memory\n");
+		}
+	}
+}
+
 /*
  * Assumes that fmm_mutex is locked on entry.
  */
@@ -632,37 +644,8 @@ static void reserved_aperture_release(manageable_aperture_t *app,
 			vm_split_area(app, area, address, MemorySizeInBytes);
 	}
 
-	if (app->is_cpu_accessible) {
-		void *mmap_ret;
-
-		/* Reset NUMA policy */
-		mbind(address, MemorySizeInBytes, MPOL_DEFAULT, NULL, 0, 0);
-
-		/* Remove any CPU mapping, but keep the address range reserved */
-		mmap_ret = mmap(address, MemorySizeInBytes, PROT_NONE,
-			MAP_ANONYMOUS | MAP_NORESERVE | MAP_PRIVATE | MAP_FIXED,
-			-1, 0);
-		if (mmap_ret == MAP_FAILED && errno == ENOMEM) {
-			/* When mmap count reaches max_map_count, any mmap will
-			 * fail. Reduce the count with munmap then map it as
-			 * NORESERVE immediately.
-			 */
-			if (munmap(address, MemorySizeInBytes) == 0) {
-				/* After unmapping, try mmap again and handle failure
-				 * */
-				mmap_ret = mmap(address, MemorySizeInBytes, PROT_NONE,
-						MAP_ANONYMOUS | MAP_NORESERVE | MAP_PRIVATE | MAP_FIXED,
-						-1, 0);
-				if (mmap_ret == MAP_FAILED) {
-					/* Handle mmap failure gracefully, log if needed */
-					pr_err("Failed to remap memory after unmap\n");
-				}
-			} else {
-				/* Handle munmap failure if needed */
-				pr_err("Failed to unmap memory\n");
-			}
-		}
-	}
+	if (app->is_cpu_accessible)
+		reserve_cpu_range(address, MemorySizeInBytes);
 }
 
 /*
@@ -883,6 +866,266 @@ static void aperture_release_area(manageable_aperture_t *app, void *address,
 	app->ops->release_area(app, address, MemorySizeInBytes);
 }
 
+/* Per-thread VA arenas
+ *
+ * Device allocations without a fixed address carve their VA from an arena
+ * owned by the allocating thread instead of searching the aperture for a
+ * hole under fmm_mutex every time. An arena reserves a large range from the
+ * aperture once and hands out sub-ranges with a bump pointer. Freed
+ * sub-ranges are not reused one by one: an arena rewinds when all of its
+ * sub-ranges are free, and returns its range to the aperture once its thread
+ * has moved on to a new arena or exited.
+ *
+ * Lock order is aperture fmm_mutex, then arena lock, then va_arena_mutex.
+ */
+#define VA_ARENA_DEFAULT_SIZE_MB 64
+
+struct va_arena {
+	manageable_aperture_t *aperture;
+	void *base;
+	uint64_t size;
+	pthread_mutex_t lock;	/* protects offset, live and retired */
+	uint64_t offset;	/* bump pointer */
+	uint32_t live;		/* sub-ranges not freed yet */
+	bool retired;		/* owning thread moved on */
+	bool dead;		/* aperture was torn down, protected by va_arena_mutex */
+	struct va_arena *next;	/* va_arena_list, protected by va_arena_mutex */
+	struct va_arena *prev;
+};
+
+static uint64_t va_arena_size = (uint64_t)VA_ARENA_DEFAULT_SIZE_MB << 20;
+static struct va_arena *va_arena_list;
+static pthread_mutex_t va_arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t va_arena_key;
+static bool va_arena_key_valid;
+
+static void va_arena_retire(struct va_arena *arena);
+
+/* Thread exit: give the thread's arena back once its sub-ranges are freed */
+static void va_arena_thread_exit(void *data)
+{
+	struct va_arena *arena = data;
+	bool dead;
+
+	pthread_mutex_lock(&va_arena_mutex);
+	dead = arena->dead;
+	pthread_mutex_unlock(&va_arena_mutex);
+
+	if (dead)
+		free(arena);
+	else
+		va_arena_retire(arena);
+}
+
+static struct va_arena *va_arena_create(manageable_aperture_t *aper)
+{
+	struct va_arena *arena;
+
+	arena = calloc(1, sizeof(*arena));
+	if (!arena)
+		return NULL;
+
+	pthread_mutex_lock(&aper->fmm_mutex);
+	arena->base = aperture_allocate_area_aligned(aper, NULL, va_arena_size,
+						     GPU_HUGE_PAGE_SIZE);
+	pthread_mutex_unlock(&aper->fmm_mutex);
+	if (!arena->base) {
+		free(arena);
+		return NULL;
+	}
+
+	arena->aperture = aper;
+	arena->size = va_arena_size;
+	pthread_mutex_init(&arena->lock, NULL);
+
+	pthread_mutex_lock(&va_arena_mutex);
+	arena->next = va_arena_list;
+	if (va_arena_list)
+		va_arena_list->prev = arena;
+	va_arena_list = arena;
+	pthread_mutex_unlock(&va_arena_mutex);
+
+	return arena;
+}
+
+/* Return the arena's range to its aperture. Assumes that the aperture's
+ * fmm_mutex is locked on entry.
+ */
+static void va_arena_destroy_locked(struct va_arena *arena)
+{
+	aperture_release_area(arena->aperture, arena->base, arena->size);
+
+	pthread_mutex_lock(&va_arena_mutex);
+	if (arena->prev)
+		arena->prev->next = arena->next;
+	else
+		va_arena_list = arena->next;
+	if (arena->next)
+		arena->next->prev = arena->prev;
+	pthread_mutex_unlock(&va_arena_mutex);
+
+	pthread_mutex_destroy(&arena->lock);
+	free(arena);
+}
+
+static void va_arena_retire(struct va_arena *arena)
+{
+	manageable_aperture_t *aper = arena->aperture;
+	bool idle;
+
+	pthread_mutex_lock(&aper->fmm_mutex);
+	pthread_mutex_lock(&arena->lock);
+	arena->retired = true;
+	idle = !arena->live;
+	pthread_mutex_unlock(&arena->lock);
+	if (idle)
+		va_arena_destroy_locked(arena);
+	pthread_mutex_unlock(&aper->fmm_mutex);
+}
+
+/* Carve [offset, offset + size) aligned as reserved_aperture_allocate_aligned
+ * would. Returns NULL if the arena is full. Assumes that arena->lock is held.
+ */
+static void *va_arena_carve(struct va_arena *arena, uint64_t size,
+			    uint64_t align, uint64_t offset)
+{
+	uint64_t base = (uint64_t)arena->base;
+	uint64_t start = ALIGN_UP(base + arena->offset, align) + offset;
+	uint64_t area_size = vm_align_area_size(arena->aperture, size);
+
+	if (start + area_size > base + arena->size)
+		return NULL;
+
+	arena->offset = start + area_size - base;
+	arena->live++;
+	return (void *)start;
+}
+
+/* Allocate a VA range for a device allocation from the calling thread's
+ * arena. Returns NULL if the request should go to the aperture instead.
+ */
+static void *va_arena_allocate(manageable_aperture_t *aper, uint64_t size,
+			       uint64_t align, struct va_arena **arena_out)
+{
+	struct va_arena *arena;
+	uint64_t offset = 0, orig_align = align;
+	void *mem = NULL;
+
+	if (!va_arena_key_valid || aper != svm.dgpu_aperture ||
+	    size > va_arena_size / 64 || align > GPU_HUGE_PAGE_SIZE)
+		return NULL;
+
+	/* Same alignment policy as reserved_aperture_allocate_aligned */
+	if (align < aper->align)
+		align = aper->align;
+	while (align < GPU_HUGE_PAGE_SIZE && size >= (align << 1))
+		align <<= 1;
+	if (orig_align <= (uint64_t)PAGE_SIZE)
+		offset = align - (size & (align - 1));
+
+	arena = pthread_getspecific(va_arena_key);
+	if (arena) {
+		pthread_mutex_lock(&va_arena_mutex);
+		if (arena->dead) {
+			free(arena);
+			arena = NULL;
+		}
+		pthread_mutex_unlock(&va_arena_mutex);
+	}
+
+	if (arena) {
+		pthread_mutex_lock(&arena->lock);
+		if (!arena->live)
+			arena->offset = 0;
+		mem = va_arena_carve(arena, size, align, offset);
+		pthread_mutex_unlock(&arena->lock);
+		if (mem)
+			goto out;
+
+		va_arena_retire(arena);
+	}
+
+	arena = va_arena_create(aper);
+	pthread_setspecific(va_arena_key, arena);
+	if (!arena)
+		return NULL;
+
+	pthread_mutex_lock(&arena->lock);
+	mem = va_arena_carve(arena, size, align, offset);
+	pthread_mutex_unlock(&arena->lock);
+	if (!mem)
+		return NULL;
+
+out:
+	*arena_out = arena;
+	return mem;
+}
+
+/* Free a sub-range handed out by va_arena_allocate(). Assumes that the
+ * aperture's fmm_mutex is locked on entry.
+ */
+static void va_arena_release_locked(struct va_arena *arena, void *address,
+				    uint64_t size)
+{
+	bool idle;
+
+	/* Drop the BO's CPU mapping before the range can be handed out again */
+	if (arena->aperture->is_cpu_accessible)
+		reserve_cpu_range(address, size);
+
+	pthread_mutex_lock(&arena->lock);
+	idle = !--arena->live && arena->retired;
+	pthread_mutex_unlock(&arena->lock);
+	if (idle)
+		va_arena_destroy_locked(arena);
+}
+
+/* Release the VA of an object, whether it came from an arena or straight
+ * from the aperture. Assumes that the aperture's fmm_mutex is locked on
+ * entry.
+ */
+static void fmm_release_object_va(manageable_aperture_t *aper,
+				  vm_object_t *object)
+{
+	if (object->va_arena)
+		va_arena_release_locked(object->va_arena, object->start,
+					object->size);
+	else
+		aperture_release_area(aper, object->start, object->size);
+}
+
+static void va_arenas_init(void)
+{
+	char *envvar;
+	unsigned int size_mb = VA_ARENA_DEFAULT_SIZE_MB;
+
+	/* HSA_VA_ARENA_SIZE sets the per-thread arena size in MB, 0 disables
+	 * the arenas
+	 */
+	envvar = getenv("HSA_VA_ARENA_SIZE");
+	if (envvar && sscanf(envvar, "%u", &size_mb) != 1)
+		size_mb = VA_ARENA_DEFAULT_SIZE_MB;
+	va_arena_size = ALIGN_UP((uint64_t)size_mb << 20, GPU_HUGE_PAGE_SIZE);
+
+	if (va_arena_size && !va_arena_key_valid)
+		va_arena_key_valid = !pthread_key_create(&va_arena_key,
+							 va_arena_thread_exit);
+}
+
+/* Forget all arenas when their apertures are torn down. Threads still
+ * holding one free it on their next allocation or at exit.
+ */
+static void va_arenas_clear(void)
+{
+	struct va_arena *arena;
+
+	pthread_mutex_lock(&va_arena_mutex);
+	for (arena = va_arena_list; arena; arena = arena->next)
+		arena->dead = true;
+	va_arena_list = NULL;
+	pthread_mutex_unlock(&va_arena_mutex);
+}
+
 /* returns 0 on success. Assumes, that fmm_mutex is locked on entry */
 static vm_object_t *aperture_allocate_object(manageable_aperture_t *app,
 					     void *new_address,
@@ -1029,6 +1272,8 @@ static HsaMemFlags fmm_translate_ioc_to_hsa_flags(uint32_t ioc_flags)
 		mflags.ui32.CoarseGrain = 1;
 	if (ioc_flags & KFD_IOC_ALLOC_MEM_FLAGS_EXT_COHERENT)
 		mflags.ui32.ExtendedCoherent = 1;
+	if (ioc_flags & KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED)
+		mflags.ui32.Uncached = 1;
 	if (ioc_flags & KFD_IOC_ALLOC_MEM_FLAGS_PUBLIC)
 		mflags.ui32.HostAccess = 1;
 	return mflags;
@@ -1045,7 +1290,7 @@ static HSAKMT_STATUS fmm_register_mem_svm_api(void *address,
 	HSAuint64 aligned_addr = (HSAuint64)address - page_offset;
 	HSAuint64 aligned_size = PAGE_ALIGN_UP(page_offset + size);
 
-	if (!g_first_gpu_mem)
+	if (!gpu_mem_count)
 		return HSAKMT_STATUS_ERROR;
 
 	s_attr = 2 * sizeof(struct kfd_ioctl_svm_attribute);
@@ -1079,7 +1324,7 @@ static HSAKMT_STATUS fmm_map_mem_svm_api(void *address,
 	size_t s_attr;
 	uint32_t i, nattr;
 
-	if (!g_first_gpu_mem)
+	if (!gpu_mem_count)
 		return HSAKMT_STATUS_ERROR;
 
 	nattr = nodes_array_size;
@@ -1234,15 +1479,16 @@ void hsakmt_fmm_print(uint32_t gpu_id)
  * object is found, this function returns with the
  * (*out_aper)->fmm_mutex locked.
  */
-static vm_object_t *vm_find_object(const void *addr, uint64_t size,
-				   manageable_aperture_t **out_aper)
+/* Find the aperture addr belongs to, NULL without SVM apertures. *userptr is
+ * set if addr can only be a userptr.
+ */
+static manageable_aperture_t *vm_find_aperture(const void *addr, bool *userptr)
 {
 	manageable_aperture_t *aper = NULL;
-	bool range = (size == UINT64_MAX);
-	bool userptr = false;
-	vm_object_t *obj = NULL;
 	uint32_t i;
 
+	*userptr = false;
+
 	for (i = 0; i < gpu_mem_count; i++)
 		if (gpu_mem[i].gpu_id != NON_VALID_GPU_ID &&
 		    addr >= gpu_mem[i].gpuvm_aperture.base &&
@@ -1260,7 +1506,7 @@ static vm_object_t *vm_find_object(const void *addr, uint64_t size,
 
 	if (!aper) {
 		if (!svm.dgpu_aperture)
-			goto no_svm;
+			return NULL;
 
 		if ((addr >= svm.dgpu_aperture->base) &&
 		    (addr <= svm.dgpu_aperture->limit))
@@ -1270,11 +1516,20 @@ static vm_object_t *vm_find_object(const void *addr, uint64_t size,
 			aper = svm.dgpu_alt_aperture;
 		else {
 			aper = svm.dgpu_aperture;
-			userptr = true;
+			*userptr = true;
 		}
 	}
 
-	pthread_mutex_lock(&aper->fmm_mutex);
+	return aper;
+}
+
+/* Look up an object in aper, the aperture must be locked */
+static vm_object_t *vm_find_object_locked(manageable_aperture_t *aper, bool userptr,
+					  const void *addr, uint64_t size)
+{
+	bool range = (size == UINT64_MAX);
+	vm_object_t *obj = NULL;
+
 	if (range) {
 		/* mmap_apertures can have userptrs in them. Try to
 		 * look up addresses as userptrs first to sort out any
@@ -1304,7 +1559,22 @@ static vm_object_t *vm_find_object(const void *addr, uint64_t size,
 		}
 	}
 
-no_svm:
+	return obj;
+}
+
+static vm_object_t *vm_find_object(const void *addr, uint64_t size,
+				   manageable_aperture_t **out_aper)
+{
+	bool range = (size == UINT64_MAX);
+	bool userptr;
+	manageable_aperture_t *aper = vm_find_aperture(addr, &userptr);
+	vm_object_t *obj = NULL;
+
+	if (aper) {
+		pthread_mutex_lock(&aper->fmm_mutex);
+		obj = vm_find_object_locked(aper, userptr, addr, size);
+	}
+
 	if (!obj && !hsakmt_is_dgpu) {
 		/* On APUs try finding it in the CPUVM aperture */
 		if (aper)
@@ -1401,6 +1671,15 @@ static uint32_t fmm_translate_hsa_to_ioc_flags(HsaMemFlags flags)
 			      KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED);
 	if (!flags.ui32.ReadOnly)
 		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE;
+	/* Coherency and cache policy are chosen per allocation. Disabling the
+	 * cache globally forces every allocation to be fine grain and uncached.
+	 */
+	if (!flags.ui32.CoarseGrain || svm.disable_cache)
+		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_COHERENT;
+	if (flags.ui32.Uncached || svm.disable_cache)
+		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED;
+	if (flags.ui32.ExtendedCoherent)
+		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_EXT_COHERENT;
 	/* TODO: Since, ROCr interfaces doesn't allow caller to set page
 	 * permissions, mark all user allocations with exec permission.
 	 * Check for flags.ui32.ExecuteAccess once ROCr is ready.
@@ -1468,15 +1747,23 @@ static void *__fmm_allocate_device(uint32_t gpu_id, void *address, uint64_t Memo
 {
 	void *mem = NULL;
 	vm_object_t *obj;
+	struct va_arena *arena = NULL;
 
 	/* Check that aperture is properly initialized/supported */
 	if (!aperture_is_valid(aperture->base, aperture->limit))
 		return NULL;
 
-	/* Allocate address space */
-	pthread_mutex_lock(&aperture->fmm_mutex);
-	mem = aperture_allocate_area_aligned(aperture, address, MemorySizeInBytes, alignment);
-	pthread_mutex_unlock(&aperture->fmm_mutex);
+	/* Allocate address space, VRAM without a fixed address comes from the
+	 * thread's VA arena without taking fmm_mutex
+	 */
+	if (!address && (ioc_flags & KFD_IOC_ALLOC_MEM_FLAGS_VRAM))
+		mem = va_arena_allocate(aperture, MemorySizeInBytes, alignment, &arena);
+	if (!mem) {
+		pthread_mutex_lock(&aperture->fmm_mutex);
+		mem = aperture_allocate_area_aligned(aperture, address, MemorySizeInBytes,
+						     alignment);
+		pthread_mutex_unlock(&aperture->fmm_mutex);
+	}
 
 	if (!mem)
 		return NULL;
@@ -1492,11 +1779,17 @@ static void *__fmm_allocate_device(uint32_t gpu_id, void *address, uint64_t Memo
 		 * Release region in aperture
 		 */
 		pthread_mutex_lock(&aperture->fmm_mutex);
-		aperture_release_area(aperture, mem, MemorySizeInBytes);
+		if (arena)
+			va_arena_release_locked(arena, mem, MemorySizeInBytes);
+		else
+			aperture_release_area(aperture, mem, MemorySizeInBytes);
 		pthread_mutex_unlock(&aperture->fmm_mutex);
 
 		/* Assign NULL to mem to indicate failure to calling function */
 		mem = NULL;
+	} else {
+		/* Not published yet, no other thread can look the object up */
+		obj->va_arena = arena;
 	}
 	if (vm_obj)
 		*vm_obj = obj;
@@ -1587,15 +1880,6 @@ void *hsakmt_fmm_allocate_device(uint32_t gpu_id, uint32_t node_id, void *addres
 	if(mflags.ui32.NoAddress)
 		aperture = &mem_handle_aperture;
 
-	if (!mflags.ui32.CoarseGrain || svm.disable_cache)
-		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_COHERENT;
-
-	if (mflags.ui32.Uncached || svm.disable_cache)
-		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED;
-
-	if (mflags.ui32.ExtendedCoherent)
-		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_EXT_COHERENT;
-
 	if (mflags.ui32.Contiguous)
 		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_CONTIGUOUS_BEST_EFFORT;
 
@@ -1684,6 +1968,38 @@ void *hsakmt_fmm_allocate_doorbell(uint32_t gpu_id, uint64_t MemorySizeInBytes,
 	return mem;
 }
 
+/* Back [address, address + size) or a new range with anonymous memory.
+ * Requests for 2MB or 1GB pages use hugetlbfs pages of that size, and fall
+ * back to transparent huge pages if the hugetlb pool can't satisfy them.
+ */
+static void *fmm_mmap_anonymous(void *address, uint64_t size, int prot,
+				HsaMemFlags mflags)
+{
+	int flags = MAP_ANONYMOUS | MAP_PRIVATE | (address ? MAP_FIXED : 0);
+	uint32_t page_size = hsakmt_PageSizeFromFlags(mflags.ui32.PageSize);
+	bool huge = mflags.ui32.PageSize == HSA_PAGE_SIZE_2MB ||
+		    mflags.ui32.PageSize == HSA_PAGE_SIZE_1GB;
+	void *mem;
+
+	if (huge) {
+		int log2_size = __builtin_ctz(page_size);
+
+		mem = mmap(address, size, prot,
+			   flags | MAP_HUGETLB | (log2_size << MAP_HUGE_SHIFT), -1, 0);
+		if (mem != MAP_FAILED)
+			return mem;
+
+		pr_debug("No %uKB hugetlb pages for %p size 0x%lx, using THP\n",
+			 page_size >> 10, address, size);
+	}
+
+	mem = mmap(address, size, prot, flags, -1, 0);
+	if (mem != MAP_FAILED && huge)
+		madvise(mem, size, MADV_HUGEPAGE);
+
+	return mem;
+}
+
 static void *fmm_allocate_host_cpu(void *address, uint64_t MemorySizeInBytes,
 				HsaMemFlags mflags)
 {
@@ -1701,10 +2017,9 @@ static void *fmm_allocate_host_cpu(void *address, uint64_t MemorySizeInBytes,
 		mmap_prot |= PROT_WRITE;
 
 	/* mmap will return a pointer with alignment equal to
-	 * sysconf(_SC_PAGESIZE).
+	 * sysconf(_SC_PAGESIZE), or the huge page size if requested.
 	 */
-	mem = mmap(NULL, MemorySizeInBytes, mmap_prot,
-			MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+	mem = fmm_mmap_anonymous(NULL, MemorySizeInBytes, mmap_prot, mflags);
 
 	if (mem == MAP_FAILED)
 		return NULL;
@@ -1794,7 +2109,7 @@ static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *addr
 	int32_t gpu_drm_fd;
 	uint32_t ioc_flags;
 	uint32_t preferred_gpu_id;
-	int gpu_mem_id = 0; /* default to g_first_gpu_mem */
+	int gpu_mem_id;
 	uint64_t size;
 	void *mem;
 
@@ -1802,14 +2117,16 @@ static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *addr
 	if (MemorySizeInBytes >= (2 * 1024 * 1024))
 		flags |= MADV_HUGEPAGE;
 
-
-	if (!g_first_gpu_mem)
-		return NULL;
-
 	if (gpu_id) {
 		gpu_mem_id = gpu_mem_find_by_gpu_id(gpu_id);
 		if (gpu_mem_id < 0)
 			return NULL;
+	} else {
+		gpu_mem_t *first_gpu = fmm_default_gpu();
+
+		if (!first_gpu)
+			return NULL;
+		gpu_mem_id = first_gpu - gpu_mem;
 	}
 
 	preferred_gpu_id = gpu_mem[gpu_mem_id].gpu_id;
@@ -1822,12 +2139,6 @@ static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *addr
 	else
 		aperture = svm.dgpu_alt_aperture; /* always coherent */
 
-	if (!mflags.ui32.CoarseGrain || svm.disable_cache)
-		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_COHERENT;
-
-	if (mflags.ui32.Uncached || svm.disable_cache)
-		ioc_flags |= KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED;
-
 	ioc_flags |= fmm_translate_hsa_to_ioc_flags(mflags);
 
 	if (mflags.ui32.AQLQueueMemory)
@@ -1836,6 +2147,12 @@ static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *addr
 	/* Paged memory is allocated as a userptr mapping, non-paged
 	 * memory is allocated from KFD
 	 */
+	/* Align huge page backed memory to the page size, so the CPU and
+	 * GPUVM can both map it with large pages
+	 */
+	if (hsakmt_PageSizeFromFlags(mflags.ui32.PageSize) > alignment)
+		alignment = hsakmt_PageSizeFromFlags(mflags.ui32.PageSize);
+
 	if (!mflags.ui32.NonPaged && svm.userptr_for_paged_mem) {
 		/* Allocate address space */
 		pthread_mutex_lock(&aperture->fmm_mutex);
@@ -1845,9 +2162,8 @@ static void *fmm_allocate_host_gpu(uint32_t gpu_id, uint32_t node_id, void *addr
 			return NULL;
 
 		/* Map anonymous pages */
-		if (mmap(mem, MemorySizeInBytes, PROT_READ | PROT_WRITE,
-			 MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, -1, 0)
-		    == MAP_FAILED)
+		if (fmm_mmap_anonymous(mem, MemorySizeInBytes, PROT_READ | PROT_WRITE,
+				       mflags) == MAP_FAILED)
 			goto out_release_area;
 
 		/* Bind to NUMA node */
@@ -1956,7 +2272,7 @@ static int __fmm_release(vm_object_t *object, manageable_aperture_t *aperture)
 		return -errno;
 	}
 
-	aperture_release_area(aperture, object->start, object->size);
+	fmm_release_object_va(aperture, object);
 	vm_remove_object(aperture, object);
 
 	pthread_mutex_unlock(&aperture->fmm_mutex);
@@ -2434,6 +2750,181 @@ static void release_mmio(void)
 	}
 }
 
+/* Acquire the VM of a GPU for KFD use, apply the SVM memory policy and
+ * map its remapped MMIO page. Called with gpu_activate_mutex held.
+ */
+static HSAKMT_STATUS fmm_activate_gpu_locked(int32_t gpu_mem_id)
+{
+	gpu_mem_t *gpu = &gpu_mem[gpu_mem_id];
+	HSAKMT_STATUS ret;
+
+	/* GPUs the KFD is not aware of have no VM to acquire */
+	if (gpu->vm_acquired || !gpu->has_apertures)
+		return HSAKMT_STATUS_SUCCESS;
+
+	/* Acquire the VM from the DRM render node for KFD use */
+	ret = acquire_vm(gpu->gpu_id, gpu->drm_render_fd);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		return ret;
+
+	if (gpu->svm_memory_policy) {
+		/* Set memory policy to match the SVM apertures */
+		uintptr_t alt_base = (uintptr_t)svm.dgpu_alt_aperture->base;
+		uint64_t alt_size = VOID_PTRS_SUB(svm.dgpu_alt_aperture->limit,
+			svm.dgpu_alt_aperture->base) + 1;
+
+		if (fmm_set_memory_policy(gpu->gpu_id,
+					  svm.disable_cache ?
+					  KFD_IOC_CACHE_POLICY_COHERENT :
+					  KFD_IOC_CACHE_POLICY_NONCOHERENT,
+					  KFD_IOC_CACHE_POLICY_COHERENT,
+					  alt_base, alt_size)) {
+			pr_err("Failed to set mem policy for GPU [0x%x]\n",
+			       gpu->gpu_id);
+			return HSAKMT_STATUS_ERROR;
+		}
+	}
+
+	gpu->vm_acquired = true;
+	all_gpu_id_array[gpu_active_count++] = gpu->gpu_id;
+	all_gpu_id_array_size = gpu_active_count * sizeof(uint32_t);
+	if (!g_first_gpu_mem)
+		g_first_gpu_mem = gpu;
+
+	if (!hsakmt_topology_is_svm_needed(gpu->EngineId))
+		return HSAKMT_STATUS_SUCCESS;
+
+	gpu->mmio_aperture.base = map_mmio(gpu->node_id, gpu->gpu_id,
+					   hsakmt_kfd_fd);
+	if (gpu->mmio_aperture.base)
+		gpu->mmio_aperture.limit = (void *)
+			((char *)gpu->mmio_aperture.base + PAGE_SIZE - 1);
+	else
+		pr_err("Failed to map remapped mmio page on gpu_mem %d\n",
+		       gpu_mem_id);
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+static HSAKMT_STATUS fmm_activate_all_gpus_locked(void)
+{
+	HSAKMT_STATUS ret;
+	uint32_t i;
+
+	for (i = 0; i < gpu_mem_count; i++) {
+		ret = fmm_activate_gpu_locked(i);
+		if (ret != HSAKMT_STATUS_SUCCESS)
+			return ret;
+	}
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+/* Make sure the GPUs in gpu_ids are usable. gpu_ids == NULL requests the
+ * default set, i.e. nothing beyond the declared set, or all GPUs if no set
+ * has been declared yet.
+ */
+HSAKMT_STATUS hsakmt_fmm_activate_gpus(const uint32_t *gpu_ids, uint32_t num_gpu_ids)
+{
+	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
+	uint32_t i;
+
+	if (gpu_active_count == gpu_mem_count)
+		return HSAKMT_STATUS_SUCCESS;
+
+	/* Fast path: everything requested is active already */
+	if (gpu_active_set_declared) {
+		for (i = 0; gpu_ids && i < num_gpu_ids; i++) {
+			int32_t gpu_mem_id = gpu_mem_find_by_gpu_id(gpu_ids[i]);
+
+			if (gpu_mem_id >= 0 && !gpu_mem[gpu_mem_id].vm_acquired &&
+			    gpu_mem[gpu_mem_id].has_apertures)
+				break;
+		}
+		if (!gpu_ids || i == num_gpu_ids)
+			return HSAKMT_STATUS_SUCCESS;
+	}
+
+	pthread_mutex_lock(&gpu_activate_mutex);
+	if (!gpu_active_set_declared) {
+		ret = fmm_activate_all_gpus_locked();
+		goto out;
+	}
+	for (i = 0; gpu_ids && i < num_gpu_ids; i++) {
+		int32_t gpu_mem_id = gpu_mem_find_by_gpu_id(gpu_ids[i]);
+
+		if (gpu_mem_id < 0)
+			continue;
+		ret = fmm_activate_gpu_locked(gpu_mem_id);
+		if (ret != HSAKMT_STATUS_SUCCESS)
+			break;
+	}
+out:
+	pthread_mutex_unlock(&gpu_activate_mutex);
+	return ret;
+}
+
+/* Declare the set of GPUs the process uses. Only those GPUs are activated
+ * from now on, unless a GPU is explicitly requested later. An empty set
+ * only stops implicit activation of all GPUs.
+ */
+HSAKMT_STATUS hsakmt_fmm_declare_active_nodes(const uint32_t *node_ids,
+					      uint32_t num_nodes, bool all)
+{
+	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
+	uint32_t i;
+
+	pthread_mutex_lock(&gpu_activate_mutex);
+	gpu_active_set_declared = true;
+	if (all) {
+		ret = fmm_activate_all_gpus_locked();
+		goto out;
+	}
+	for (i = 0; i < num_nodes; i++) {
+		int32_t gpu_mem_id = gpu_mem_find_by_node_id(node_ids[i]);
+
+		if (gpu_mem_id < 0)
+			continue;
+		ret = fmm_activate_gpu_locked(gpu_mem_id);
+		if (ret != HSAKMT_STATUS_SUCCESS)
+			break;
+	}
+out:
+	pthread_mutex_unlock(&gpu_activate_mutex);
+	return ret;
+}
+
+/* With XNACK enabled any GPU may fault on SVM ranges, so all GPUs need a
+ * VM once the process is using GPUs at all.
+ */
+HSAKMT_STATUS hsakmt_fmm_xnack_enabled(void)
+{
+	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
+
+	pthread_mutex_lock(&gpu_activate_mutex);
+	if (gpu_active_count)
+		ret = fmm_activate_all_gpus_locked();
+	pthread_mutex_unlock(&gpu_activate_mutex);
+	return ret;
+}
+
+/* GPU backing system memory allocations and userptrs that don't name one */
+static gpu_mem_t *fmm_default_gpu(void)
+{
+	uint32_t i;
+
+	if (!g_first_gpu_mem && gpu_mem_count) {
+		pthread_mutex_lock(&gpu_activate_mutex);
+		if (!gpu_active_set_declared)
+			fmm_activate_all_gpus_locked();
+		for (i = 0; !g_first_gpu_mem && i < gpu_mem_count; i++)
+			fmm_activate_gpu_locked(i);
+		pthread_mutex_unlock(&gpu_activate_mutex);
+	}
+
+	return g_first_gpu_mem;
+}
+
 HSAKMT_STATUS hsakmt_fmm_get_amdgpu_device_handle(uint32_t node_id,
 						HsaAMDGPUDeviceHandle *DeviceHandle)
 {
@@ -2559,6 +3050,8 @@ HSAKMT_STATUS hsakmt_fmm_init_process_apertures(unsigned int NumNodes)
 	if (!maxVaAlignStr || sscanf(maxVaAlignStr, "%u", &svm.alignment_order) != 1)
 		svm.alignment_order = 9;
 
+	va_arenas_init();
+
 	gpu_mem_count = 0;
 	g_first_gpu_mem = NULL;
 
@@ -2625,9 +3118,6 @@ HSAKMT_STATUS hsakmt_fmm_init_process_apertures(unsigned int NumNodes)
 			gpu_mem[gpu_mem_count].gpuvm_aperture.ops = &reserved_aperture_ops;
 			pthread_mutex_init(&gpu_mem[gpu_mem_count].gpuvm_aperture.fmm_mutex, NULL);
 
-			if (!g_first_gpu_mem)
-				g_first_gpu_mem = &gpu_mem[gpu_mem_count];
-
 			gpu_mem_count++;
 		}
 	}
@@ -2680,11 +3170,11 @@ HSAKMT_STATUS hsakmt_fmm_init_process_apertures(unsigned int NumNodes)
 		if (gpu_mem_id < 0)
 			continue;
 
-		if (all_gpu_id_array_size == gpu_mem_count) {
+		if (gpu_mem[gpu_mem_id].has_apertures) {
 			ret = HSAKMT_STATUS_ERROR;
 			goto aperture_init_failed;
 		}
-		all_gpu_id_array[all_gpu_id_array_size++] = process_apertures[i].gpu_id;
+		gpu_mem[gpu_mem_id].has_apertures = true;
 
 		/* Add this GPU to the usable_peer_id_arrays of all GPUs that
 		 * this GPU has an IO link to. This GPU can map memory
@@ -2735,6 +3225,7 @@ HSAKMT_STATUS hsakmt_fmm_init_process_apertures(unsigned int NumNodes)
 			 */
 			gpu_mem[gpu_mem_id].gpuvm_aperture.base = NULL;
 			gpu_mem[gpu_mem_id].gpuvm_aperture.limit = NULL;
+			gpu_mem[gpu_mem_id].svm_memory_policy = true;
 
 			/* Update SVM aperture limits and alignment */
 			if (process_apertures[i].gpuvm_base > svm_base)
@@ -2758,14 +3249,7 @@ HSAKMT_STATUS hsakmt_fmm_init_process_apertures(unsigned int NumNodes)
 				NULL,
 				gpu_mem[gpu_mem_id].gpuvm_aperture.align);
 		}
-
-		/* Acquire the VM from the DRM render node for KFD use */
-		ret = acquire_vm(gpu_mem[gpu_mem_id].gpu_id,
-				 gpu_mem[gpu_mem_id].drm_render_fd);
-		if (ret != HSAKMT_STATUS_SUCCESS)
-			goto aperture_init_failed;
 	}
-	all_gpu_id_array_size *= sizeof(uint32_t);
 
 	if (svm_limit) {
 		/* At least one GPU uses GPUVM in canonical address
@@ -2775,32 +3259,6 @@ HSAKMT_STATUS hsakmt_fmm_init_process_apertures(unsigned int NumNodes)
 					 guardPages);
 		if (ret != HSAKMT_STATUS_SUCCESS)
 			goto init_svm_failed;
-
-		for (i = 0 ; i < num_of_sysfs_nodes ; i++) {
-			uintptr_t alt_base;
-			uint64_t alt_size;
-			int err;
-
-			if (!IS_CANONICAL_ADDR(process_apertures[i].gpuvm_limit))
-				continue;
-
-			/* Set memory policy to match the SVM apertures */
-			alt_base = (uintptr_t)svm.dgpu_alt_aperture->base;
-			alt_size = VOID_PTRS_SUB(svm.dgpu_alt_aperture->limit,
-				svm.dgpu_alt_aperture->base) + 1;
-			err = fmm_set_memory_policy(process_apertures[i].gpu_id,
-						    svm.disable_cache ?
-						    KFD_IOC_CACHE_POLICY_COHERENT :
-						    KFD_IOC_CACHE_POLICY_NONCOHERENT,
-						    KFD_IOC_CACHE_POLICY_COHERENT,
-						    alt_base, alt_size);
-			if (err) {
-				pr_err("Failed to set mem policy for GPU [0x%x]\n",
-				       process_apertures[i].gpu_id);
-				ret = HSAKMT_STATUS_ERROR;
-				goto set_memory_policy_failed;
-			}
-		}
 	}
 
 	cpuvm_aperture.align = PAGE_SIZE;
@@ -2811,28 +3269,17 @@ HSAKMT_STATUS hsakmt_fmm_init_process_apertures(unsigned int NumNodes)
 	if (!init_mem_handle_aperture(PAGE_SIZE, guardPages))
 		pr_err("Failed to init mem_handle_aperture\n");
 
-	for (gpu_mem_id = 0; (uint32_t)gpu_mem_id < gpu_mem_count; gpu_mem_id++) {
-		if (!hsakmt_topology_is_svm_needed(gpu_mem[gpu_mem_id].EngineId))
-			continue;
-		gpu_mem[gpu_mem_id].mmio_aperture.base = map_mmio(
-				gpu_mem[gpu_mem_id].node_id,
-				gpu_mem[gpu_mem_id].gpu_id,
-				hsakmt_kfd_fd);
-		if (gpu_mem[gpu_mem_id].mmio_aperture.base)
-			gpu_mem[gpu_mem_id].mmio_aperture.limit = (void *)
-			((char *)gpu_mem[gpu_mem_id].mmio_aperture.base +
-			 PAGE_SIZE - 1);
-		else
-			pr_err("Failed to map remapped mmio page on gpu_mem %d\n",
-					gpu_mem_id);
-	}
+	/* VMs are acquired and MMIO pages mapped when a GPU is first used,
+	 * see hsakmt_fmm_activate_gpus()
+	 */
+	gpu_active_set_declared = false;
+	gpu_active_count = 0;
 
 	free(process_apertures);
 	return ret;
 
 aperture_init_failed:
 init_svm_failed:
-set_memory_policy_failed:
 	free(all_gpu_id_array);
 	all_gpu_id_array = NULL;
 get_aperture_ioctl_failed:
@@ -2846,6 +3293,11 @@ gpu_mem_init_failed:
 void hsakmt_fmm_destroy_process_apertures(void)
 {
 	release_mmio();
+	va_arenas_clear();
+
+	g_first_gpu_mem = NULL;
+	gpu_active_set_declared = false;
+	gpu_active_count = 0;
 
 	if (all_gpu_id_array) {
 		free(all_gpu_id_array);
@@ -2912,6 +3364,11 @@ HSAKMT_STATUS hsakmt_fmm_get_aperture_base_and_limit(aperture_type_e aperture_ty
 		break;
 
 	case FMM_MMIO:
+		/* Mapped on activation; inactive GPUs report no MMIO page
+		 * once the application has declared the GPUs it uses
+		 */
+		if (!gpu_mem[slot].vm_acquired)
+			hsakmt_fmm_activate_gpus(NULL, 0);
 		if (aperture_is_valid(gpu_mem[slot].mmio_aperture.base,
 			gpu_mem[slot].mmio_aperture.limit)) {
 			*aperture_base = PORT_VPTR_TO_UINT64(gpu_mem[slot].mmio_aperture.base);
@@ -3045,10 +3502,21 @@ static HSAKMT_STATUS _fmm_map_to_gpu(manageable_aperture_t *aperture,
 
 		if (!obj->userptr && hsakmt_get_device_id_by_node_id(obj->node_id) &&
 		    gpu_mem_id >= 0) {
-			args.device_ids_array_ptr = (uint64_t)
-				gpu_mem[gpu_mem_id].usable_peer_id_array;
-			args.n_devices =
-				gpu_mem[gpu_mem_id].usable_peer_id_num;
+			/* Only peers whose VM has been acquired can map */
+			uint32_t num_peers = gpu_mem[gpu_mem_id].usable_peer_id_num;
+			uint32_t *peers = alloca(num_peers * sizeof(uint32_t));
+			uint32_t i;
+
+			args.n_devices = 0;
+			for (i = 0; i < num_peers; i++) {
+				uint32_t peer_id =
+					gpu_mem[gpu_mem_id].usable_peer_id_array[i];
+				int32_t peer = gpu_mem_find_by_gpu_id(peer_id);
+
+				if (peer >= 0 && gpu_mem[peer].vm_acquired)
+					peers[args.n_devices++] = peer_id;
+			}
+			args.device_ids_array_ptr = (uint64_t)peers;
 		} else {
 			args.device_ids_array_ptr = (uint64_t)all_gpu_id_array;
 			args.n_devices = all_gpu_id_array_size / sizeof(uint32_t);
@@ -3414,6 +3882,63 @@ int hsakmt_fmm_unmap_from_gpu(void *address)
 	return ret;
 }
 
+int hsakmt_fmm_unmap_from_gpu_batch(void **addresses, uint64_t num_of_addresses)
+{
+	manageable_aperture_t *aperture, *locked = NULL;
+	vm_object_t *object;
+	uint64_t i;
+	uint32_t j;
+	bool userptr, scratch;
+	int ret = 0;
+
+	for (i = 0; i < num_of_addresses; i++) {
+		void *address = addresses[i];
+
+		/* Same workaround as hsaKmtUnmapMemoryToGPU */
+		if (!address)
+			continue;
+
+		scratch = false;
+		for (j = 0; j < gpu_mem_count; j++)
+			if (gpu_mem[j].gpu_id != NON_VALID_GPU_ID &&
+			    address >= gpu_mem[j].scratch_physical.base &&
+			    address <= gpu_mem[j].scratch_physical.limit)
+				scratch = true;
+
+		/* Runs of addresses in one aperture share a single lock hold */
+		object = NULL;
+		aperture = scratch ? NULL : vm_find_aperture(address, &userptr);
+		if (aperture && !userptr) {
+			if (aperture != locked) {
+				if (locked)
+					pthread_mutex_unlock(&locked->fmm_mutex);
+				pthread_mutex_lock(&aperture->fmm_mutex);
+				locked = aperture;
+			}
+			object = vm_find_object_locked(aperture, false, address, 0);
+		}
+
+		/* Scratch, userptrs and APU fallbacks take the single address path */
+		if (!object || object->userptr) {
+			if (locked) {
+				pthread_mutex_unlock(&locked->fmm_mutex);
+				locked = NULL;
+			}
+			if (hsakmt_fmm_unmap_from_gpu(address))
+				ret = -EINVAL;
+			continue;
+		}
+
+		if (_fmm_unmap_from_gpu(aperture, address, NULL, 0, object))
+			ret = -EINVAL;
+	}
+
+	if (locked)
+		pthread_mutex_unlock(&locked->fmm_mutex);
+
+	return ret;
+}
+
 bool hsakmt_fmm_get_handle(void *address, uint64_t *handle)
 {
 	uint32_t i;
@@ -3477,7 +4002,7 @@ static HSAKMT_STATUS fmm_register_user_memory(void *addr,
 	vm_object_t *obj, *exist_obj;
 
 	/* Find first GPU for creating the userptr BO */
-	if (!g_first_gpu_mem)
+	if (!fmm_default_gpu())
 		return HSAKMT_STATUS_ERROR;
 
 	gpu_id = g_first_gpu_mem->gpu_id;
@@ -3810,7 +4335,7 @@ HSAKMT_STATUS hsakmt_fmm_share_memory(void *MemoryAddress,
 		/* Sharing non paged system memory. Use first GPU which was
 		 * used during allocation. See fmm_allocate_host_gpu()
 		 */
-		if (!g_first_gpu_mem)
+		if (!fmm_default_gpu())
 			return HSAKMT_STATUS_ERROR;
 
 		gpu_id = g_first_gpu_mem->gpu_id;
@@ -3995,52 +4520,18 @@ HSAKMT_STATUS hsakmt_fmm_deregister_memory(void *address)
  * and maps nodes_to_map
  */
 
-HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
-		uint32_t *nodes_to_map, uint64_t num_of_nodes,
-		uint64_t *gpuvm_address)
+/* Map a non-userptr object to exactly the nodes in nodes_to_map, the
+ * aperture must be locked and stays locked
+ */
+static HSAKMT_STATUS _fmm_map_to_gpu_nodes_locked(manageable_aperture_t *aperture,
+		vm_object_t *object, void *address, uint64_t size,
+		uint32_t *nodes_to_map, uint64_t num_of_nodes)
 {
-	manageable_aperture_t *aperture = NULL;
-	vm_object_t *object;
 	uint32_t i;
 	uint32_t *registered_node_id_array, registered_node_id_array_size;
 	HSAKMT_STATUS ret;
 	int retcode = 0;
 
-	if (!num_of_nodes || !nodes_to_map || !address)
-		return HSAKMT_STATUS_INVALID_PARAMETER;
-
-	object = vm_find_object(address, size, &aperture);
-	if (!object && !hsakmt_is_svm_api_supported)
-		return HSAKMT_STATUS_ERROR;
-	/* Successful vm_find_object returns with aperture locked */
-
-	/* allocates VA only */
-	if (object && object->handle == 0) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
-		return HSAKMT_STATUS_INVALID_PARAMETER;
-	}
-
-	/* allocates buffer only, should be mapped by GEM API */
-	if (aperture == &mem_handle_aperture) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
-		return HSAKMT_STATUS_INVALID_PARAMETER;
-	}
-
-	/* APU memory is not supported by this function */
-	if (aperture &&
-	   (aperture == &cpuvm_aperture || !aperture->is_cpu_accessible)) {
-		pthread_mutex_unlock(&aperture->fmm_mutex);
-		return HSAKMT_STATUS_ERROR;
-	}
-
-	if ((hsakmt_is_svm_api_supported && !object) || object->userptr) {
-		retcode = _fmm_map_to_gpu_userptr(address, size, gpuvm_address,
-				object, nodes_to_map, num_of_nodes * sizeof(uint32_t));
-		if (object)
-			pthread_mutex_unlock(&aperture->fmm_mutex);
-		return retcode ? HSAKMT_STATUS_ERROR : HSAKMT_STATUS_SUCCESS;
-	}
-
 	/* Verify that all nodes to map are registered already */
 	registered_node_id_array = all_gpu_id_array;
 	registered_node_id_array_size = all_gpu_id_array_size;
@@ -4051,10 +4542,8 @@ HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
 	}
 	for (i = 0 ; i < num_of_nodes; i++) {
 		if (!id_in_array(nodes_to_map[i], registered_node_id_array,
-					registered_node_id_array_size)) {
-			pthread_mutex_unlock(&aperture->fmm_mutex);
+					registered_node_id_array_size))
 			return HSAKMT_STATUS_ERROR;
-		}
 	}
 
 	/* Unmap buffer from all nodes that have this buffer mapped that are not included on nodes_to_map array */
@@ -4076,10 +4565,8 @@ HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
 					temp_node_id_array,
 					temp_node_id_array_size,
 					object);
-			if (ret != HSAKMT_STATUS_SUCCESS) {
-				pthread_mutex_unlock(&aperture->fmm_mutex);
+			if (ret != HSAKMT_STATUS_SUCCESS)
 				return ret;
-			}
 		}
 	}
 
@@ -4102,14 +4589,116 @@ HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
 				map_node_id_array,
 				map_node_id_array_size * sizeof(uint32_t));
 
-	pthread_mutex_unlock(&aperture->fmm_mutex);
-
 	if (retcode != 0)
 		return HSAKMT_STATUS_ERROR;
 
 	return HSAKMT_STATUS_SUCCESS;
 }
 
+HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
+		uint32_t *nodes_to_map, uint64_t num_of_nodes,
+		uint64_t *gpuvm_address)
+{
+	manageable_aperture_t *aperture = NULL;
+	vm_object_t *object;
+	HSAKMT_STATUS ret;
+	int retcode = 0;
+
+	if (!num_of_nodes || !nodes_to_map || !address)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	object = vm_find_object(address, size, &aperture);
+	if (!object && !hsakmt_is_svm_api_supported)
+		return HSAKMT_STATUS_ERROR;
+	/* Successful vm_find_object returns with aperture locked */
+
+	/* allocates VA only */
+	if (object && object->handle == 0) {
+		pthread_mutex_unlock(&aperture->fmm_mutex);
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+	}
+
+	/* allocates buffer only, should be mapped by GEM API */
+	if (aperture == &mem_handle_aperture) {
+		pthread_mutex_unlock(&aperture->fmm_mutex);
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+	}
+
+	/* APU memory is not supported by this function */
+	if (aperture &&
+	   (aperture == &cpuvm_aperture || !aperture->is_cpu_accessible)) {
+		pthread_mutex_unlock(&aperture->fmm_mutex);
+		return HSAKMT_STATUS_ERROR;
+	}
+
+	if ((hsakmt_is_svm_api_supported && !object) || object->userptr) {
+		retcode = _fmm_map_to_gpu_userptr(address, size, gpuvm_address,
+				object, nodes_to_map, num_of_nodes * sizeof(uint32_t));
+		if (object)
+			pthread_mutex_unlock(&aperture->fmm_mutex);
+		return retcode ? HSAKMT_STATUS_ERROR : HSAKMT_STATUS_SUCCESS;
+	}
+
+	ret = _fmm_map_to_gpu_nodes_locked(aperture, object, address, size,
+			nodes_to_map, num_of_nodes);
+
+	pthread_mutex_unlock(&aperture->fmm_mutex);
+
+	return ret;
+}
+
+HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes_batch(HsaMemoryRange *ranges, uint64_t num_of_ranges,
+		uint32_t *nodes_to_map, uint64_t num_of_nodes)
+{
+	manageable_aperture_t *aperture, *locked = NULL;
+	vm_object_t *object;
+	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
+	uint64_t gpuvm_address;
+	uint64_t i;
+	bool userptr;
+
+	if (!num_of_nodes || !nodes_to_map || !ranges)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	for (i = 0; i < num_of_ranges && ret == HSAKMT_STATUS_SUCCESS; i++) {
+		void *address = ranges[i].MemoryAddress;
+		uint64_t size = ranges[i].SizeInBytes;
+
+		/* Runs of ranges in one aperture share a single lock hold */
+		object = NULL;
+		aperture = address ? vm_find_aperture(address, &userptr) : NULL;
+		if (aperture && !userptr && aperture != &mem_handle_aperture &&
+		    aperture->is_cpu_accessible) {
+			if (aperture != locked) {
+				if (locked)
+					pthread_mutex_unlock(&locked->fmm_mutex);
+				pthread_mutex_lock(&aperture->fmm_mutex);
+				locked = aperture;
+			}
+			object = vm_find_object_locked(aperture, false, address, size);
+		}
+
+		/* Userptrs, SVM ranges and errors take the single range path */
+		if (!object || object->userptr || object->handle == 0) {
+			if (locked) {
+				pthread_mutex_unlock(&locked->fmm_mutex);
+				locked = NULL;
+			}
+			ret = hsakmt_fmm_map_to_gpu_nodes(address, size, nodes_to_map,
+					num_of_nodes, &gpuvm_address);
+			continue;
+		}
+
+		ret = _fmm_map_to_gpu_nodes_locked(aperture, object, address, size,
+				nodes_to_map, num_of_nodes);
+	}
+
+	if (locked)
+		pthread_mutex_unlock(&locked->fmm_mutex);
+
+	return ret;
+}
+
 HSAKMT_STATUS hsakmt_fmm_get_mem_info(const void *address, HsaPointerInfo *info)
 {
 	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
@@ -4304,6 +4893,9 @@ void hsakmt_fmm_clear_all_mem(void)
 		drm_render_fds[i] = 0;
 	}
 
+	pthread_mutex_init(&va_arena_mutex, NULL);
+	va_arenas_clear();
+
 	fmm_clear_aperture(&mem_handle_aperture);
 	fmm_clear_aperture(&cpuvm_aperture);
 	fmm_clear_aperture(&svm.apertures[SVM_DEFAULT]);
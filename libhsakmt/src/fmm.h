@@ -48,6 +48,10 @@ typedef struct {
 HSAKMT_STATUS hsakmt_fmm_get_amdgpu_device_handle(uint32_t node_id,  HsaAMDGPUDeviceHandle *DeviceHandle);
 HSAKMT_STATUS hsakmt_fmm_init_process_apertures(unsigned int NumNodes);
 void hsakmt_fmm_destroy_process_apertures(void);
+HSAKMT_STATUS hsakmt_fmm_activate_gpus(const uint32_t *gpu_ids, uint32_t num_gpu_ids);
+HSAKMT_STATUS hsakmt_fmm_declare_active_nodes(const uint32_t *node_ids,
+					      uint32_t num_nodes, bool all);
+HSAKMT_STATUS hsakmt_fmm_xnack_enabled(void);
 
 /* Memory interface */
 void *hsakmt_fmm_allocate_scratch(uint32_t gpu_id, void *address, uint64_t MemorySizeInBytes);
@@ -97,6 +101,9 @@ HSAKMT_STATUS hsakmt_fmm_register_shared_memory(const HsaSharedMemoryHandle *Sha
 					 uint32_t gpu_id_array_size);
 HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes(void *address, uint64_t size,
 		uint32_t *nodes_to_map, uint64_t num_of_nodes, uint64_t *gpuvm_address);
+HSAKMT_STATUS hsakmt_fmm_map_to_gpu_nodes_batch(HsaMemoryRange *ranges, uint64_t num_of_ranges,
+		uint32_t *nodes_to_map, uint64_t num_of_nodes);
+int hsakmt_fmm_unmap_from_gpu_batch(void **addresses, uint64_t num_of_addresses);
 
 int hsakmt_open_drm_render_device(int minor);
 void *hsakmt_mmap_allocate_aligned(int prot, int flags, uint64_t size, uint64_t align,
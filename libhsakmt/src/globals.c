@@ -40,3 +40,5 @@ int hsakmt_page_shift;
 bool hsakmt_is_svm_api_supported;
 /* zfb is mainly used during emulation */
 int hsakmt_zfb_support;
+/* context save areas of destroyed queues kept for reuse */
+unsigned int hsakmt_cwsr_cache_size;
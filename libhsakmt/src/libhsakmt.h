@@ -39,6 +39,7 @@ extern pthread_mutex_t hsakmt_mutex;
 extern bool hsakmt_is_dgpu;
 extern bool hsakmt_is_svm_api_supported;
 extern int hsakmt_zfb_support;
+extern unsigned int hsakmt_cwsr_cache_size;
 
 extern HsaVersionInfo hsakmt_kfd_version_info;
 
@@ -211,6 +212,7 @@ void* hsakmt_allocate_exec_aligned_memory_gpu(uint32_t size, uint32_t align,
 void hsakmt_free_exec_aligned_memory_gpu(void *addr, uint32_t size, uint32_t align);
 HSAKMT_STATUS hsakmt_init_process_doorbells(unsigned int NumNodes);
 void hsakmt_destroy_process_doorbells(void);
+void hsakmt_destroy_cwsr_cache(void);
 HSAKMT_STATUS hsakmt_init_device_debugging_memory(unsigned int NumNodes);
 void hsakmt_destroy_device_debugging_memory(void);
 bool hsakmt_debug_get_reg_status(uint32_t node_id);
@@ -235,8 +237,11 @@ extern int hsakmt_ioctl(int fd, unsigned long request, void *arg);
 	tmp1 > tmp2 ? tmp1 : tmp2; })
 
 void hsakmt_clear_events_page(void);
+void hsakmt_clear_async_ops(void);
 void hsakmt_fmm_clear_all_mem(void);
 void hsakmt_clear_process_doorbells(void);
+void hsakmt_clear_cwsr_cache(void);
+void hsakmt_topology_clear_process_state(void);
 uint32_t hsakmt_get_num_sysfs_nodes(void);
 
 bool hsakmt_is_forked_child(void);
@@ -53,6 +53,10 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtSetMemoryPolicy(HSAuint32 Node,
 	if (result != HSAKMT_STATUS_SUCCESS)
 		return result;
 
+	result = hsakmt_fmm_activate_gpus(&gpu_id, 1);
+	if (result != HSAKMT_STATUS_SUCCESS)
+		return result;
+
 	if (hsakmt_get_gfxv_by_node_id(Node) != GFX_VERSION_KAVERI)
 		/* This is a legacy API useful on Kaveri only. On dGPU
 		 * the alternate aperture is setup and used
@@ -137,6 +141,12 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtAllocMemoryAlign(HSAuint32 PreferredNode,
 		return result;
 	}
 
+	if (gpu_id) {
+		result = hsakmt_fmm_activate_gpus(&gpu_id, 1);
+		if (result != HSAKMT_STATUS_SUCCESS)
+			return result;
+	}
+
 	page_size = hsakmt_PageSizeFromFlags(MemFlags.ui32.PageSize);
 
 	if (Alignment && (Alignment < page_size || !POWER_OF_2(Alignment)))
@@ -292,6 +302,11 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtRegisterMemoryToNodes(void *MemoryAddress,
 
 	ret = hsakmt_validate_nodeid_array(&gpu_id_array,
 			NumberOfNodes, NodeArray);
+	if (ret == HSAKMT_STATUS_SUCCESS) {
+		ret = hsakmt_fmm_activate_gpus(gpu_id_array, NumberOfNodes);
+		if (ret != HSAKMT_STATUS_SUCCESS)
+			free(gpu_id_array);
+	}
 
 	if (ret == HSAKMT_STATUS_SUCCESS) {
 		ret = hsakmt_fmm_register_memory(MemoryAddress, MemorySizeInBytes,
@@ -363,6 +378,11 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtRegisterGraphicsHandleToNodesExt(HSAuint64 Graphic
 	if (NodeArray != NULL || NumberOfNodes != 0) {
 		ret = hsakmt_validate_nodeid_array(&gpu_id_array,
 				NumberOfNodes, NodeArray);
+		if (ret == HSAKMT_STATUS_SUCCESS) {
+			ret = hsakmt_fmm_activate_gpus(gpu_id_array, NumberOfNodes);
+			if (ret != HSAKMT_STATUS_SUCCESS)
+				free(gpu_id_array);
+		}
 	}
 
 	if (ret == HSAKMT_STATUS_SUCCESS) {
@@ -440,6 +460,9 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtRegisterSharedHandleToNodes(const HsaSharedMemoryH
 		ret = hsakmt_validate_nodeid_array(&gpu_id_array, NumberOfNodes, NodeArray);
 		if (ret != HSAKMT_STATUS_SUCCESS)
 			goto error;
+		ret = hsakmt_fmm_activate_gpus(gpu_id_array, NumberOfNodes);
+		if (ret != HSAKMT_STATUS_SUCCESS)
+			goto error;
 	}
 
 	ret = hsakmt_fmm_register_shared_memory(SharedMemoryHandle,
@@ -496,6 +519,8 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtMapMemoryToGPU(void *MemoryAddress,
 					     HSAuint64 MemorySizeInBytes,
 					     HSAuint64 *AlternateVAGPU)
 {
+	HSAKMT_STATUS ret;
+
 	CHECK_KFD_OPEN();
 
 	pr_debug("[%s] address %p\n", __func__, MemoryAddress);
@@ -508,6 +533,10 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtMapMemoryToGPU(void *MemoryAddress,
 	if (AlternateVAGPU)
 		*AlternateVAGPU = 0;
 
+	ret = hsakmt_fmm_activate_gpus(NULL, 0);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		return ret;
+
 	return hsakmt_fmm_map_to_gpu(MemoryAddress, MemorySizeInBytes, AlternateVAGPU);
 }
 
@@ -541,6 +570,12 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtMapMemoryToGPUNodes(void *MemoryAddress,
 	if (ret != HSAKMT_STATUS_SUCCESS)
 		return ret;
 
+	ret = hsakmt_fmm_activate_gpus(gpu_id_array, NumberOfNodes);
+	if (ret != HSAKMT_STATUS_SUCCESS) {
+		free(gpu_id_array);
+		return ret;
+	}
+
 	ret = hsakmt_fmm_map_to_gpu_nodes(MemoryAddress, MemorySizeInBytes,
 		gpu_id_array, NumberOfNodes, AlternateVAGPU);
 
@@ -568,6 +603,102 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtUnmapMemoryToGPU(void *MemoryAddress)
 		return HSAKMT_STATUS_ERROR;
 }
 
+HSAKMT_STATUS HSAKMTAPI hsaKmtMapMemoryToGPUNodesBatch(HsaMemoryRange *Ranges,
+						       HSAuint64 NumberOfRanges,
+						       HsaMemMapFlags MemMapFlags,
+						       HSAuint64 NumberOfNodes,
+						       HSAuint32 *NodeArray)
+{
+	uint32_t *gpu_id_array;
+	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
+	HSAuint64 alternate_va;
+	HSAuint64 i;
+
+	CHECK_KFD_OPEN();
+
+	pr_debug("[%s] %lu ranges number of nodes %lu\n",
+		__func__, NumberOfRanges, NumberOfNodes);
+
+	if (!Ranges && NumberOfRanges)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	for (i = 0; i < NumberOfRanges; i++)
+		if (!Ranges[i].MemoryAddress) {
+			pr_err("FIXME: mapping NULL pointer\n");
+			return HSAKMT_STATUS_ERROR;
+		}
+
+	if (!hsakmt_is_dgpu && NumberOfNodes == 1) {
+		for (i = 0; i < NumberOfRanges && ret == HSAKMT_STATUS_SUCCESS; i++)
+			ret = hsaKmtMapMemoryToGPU(Ranges[i].MemoryAddress,
+					Ranges[i].SizeInBytes, &alternate_va);
+		return ret;
+	}
+
+	/* Node IDs are translated once for the whole batch */
+	ret = hsakmt_validate_nodeid_array(&gpu_id_array,
+				NumberOfNodes, NodeArray);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		return ret;
+
+	ret = hsakmt_fmm_activate_gpus(gpu_id_array, NumberOfNodes);
+	if (ret != HSAKMT_STATUS_SUCCESS) {
+		free(gpu_id_array);
+		return ret;
+	}
+
+	ret = hsakmt_fmm_map_to_gpu_nodes_batch(Ranges, NumberOfRanges,
+		gpu_id_array, NumberOfNodes);
+
+	if (gpu_id_array)
+		free(gpu_id_array);
+
+	return ret;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtUnmapMemoryToGPUBatch(void **MemoryAddresses,
+						    HSAuint64 NumberOfAddresses)
+{
+	CHECK_KFD_OPEN();
+
+	pr_debug("[%s] %lu addresses\n", __func__, NumberOfAddresses);
+
+	if (!MemoryAddresses && NumberOfAddresses)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	if (!hsakmt_fmm_unmap_from_gpu_batch(MemoryAddresses, NumberOfAddresses))
+		return HSAKMT_STATUS_SUCCESS;
+	else
+		return HSAKMT_STATUS_ERROR;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtActivateNodes(HSAuint32 NumberOfNodes,
+					    HSAuint32 *NodeArray)
+{
+	HSAKMT_STATUS ret;
+	HSAint32 xnack = 0;
+	HSAuint32 i;
+
+	CHECK_KFD_OPEN();
+
+	pr_debug("[%s] number of nodes %u\n", __func__, NumberOfNodes);
+
+	if (NumberOfNodes && !NodeArray)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	for (i = 0; i < NumberOfNodes; i++) {
+		ret = hsakmt_validate_nodeid(NodeArray[i], NULL);
+		if (ret != HSAKMT_STATUS_SUCCESS)
+			return ret;
+	}
+
+	/* Faults with XNACK may come from any GPU, keep them all usable */
+	if (NumberOfNodes && hsaKmtGetXNACKMode(&xnack) != HSAKMT_STATUS_SUCCESS)
+		xnack = 0;
+
+	return hsakmt_fmm_declare_active_nodes(NodeArray, NumberOfNodes, xnack > 0);
+}
+
 HSAKMT_STATUS HSAKMTAPI hsaKmtMapGraphicHandle(HSAuint32 NodeId,
 					       HSAuint64 GraphicDeviceHandle,
 					       HSAuint64 GraphicResourceHandle,
@@ -95,13 +95,17 @@ static void child_fork_handler(void)
  * data that is duplicated from the parent process, that is not valid
  * in the child.
  * The topology information is duplicated from the parent is valid
- * in the child process so it is not cleared
+ * in the child process so it is not cleared, only the per process state
+ * set up with it is rebuilt by the next hsaKmtAcquireSystemProperties.
  */
 static void clear_after_fork(void)
 {
 	hsakmt_clear_process_doorbells();
+	hsakmt_clear_cwsr_cache();
 	hsakmt_clear_events_page();
+	hsakmt_clear_async_ops();
 	hsakmt_fmm_clear_all_mem();
+	hsakmt_topology_clear_process_state();
 	hsakmt_destroy_device_debugging_memory();
 	if (hsakmt_kfd_fd) {
 		close(hsakmt_kfd_fd);
@@ -141,6 +145,14 @@ static HSAKMT_STATUS init_vars_from_env(void)
 	if (envvar)
 		hsakmt_zfb_support = atoi(envvar);
 
+	/* Number of queue context save areas kept for reuse after their queues
+	 * are destroyed. 0 releases them immediately.
+	 */
+	hsakmt_cwsr_cache_size = 4;
+	envvar = getenv("HSA_CWSR_CACHE_SIZE");
+	if (envvar)
+		hsakmt_cwsr_cache_size = atoi(envvar);
+
 	return HSAKMT_STATUS_SUCCESS;
 }
 
@@ -24,6 +24,7 @@
  */
 
 #include "libhsakmt.h"
+#include "fmm.h"
 #include "hsakmt/linux/kfd_ioctl.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -105,6 +106,10 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtPcSamplingCreate(HSAuint32 NodeId, HsaPcSamplingIn
         return ret;
     }
 
+    ret = hsakmt_fmm_activate_gpus(&gpu_id, 1);
+    if (ret != HSAKMT_STATUS_SUCCESS)
+        return ret;
+
     args.op = KFD_IOCTL_PCS_OP_CREATE;
     args.gpu_id = gpu_id;
     args.sample_info_ptr = (uint64_t)sample_info;
@@ -37,6 +37,7 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <semaphore.h>
+#include <time.h>
 
 #define BITS_PER_BYTE		CHAR_BIT
 
@@ -76,6 +77,10 @@ struct perf_counts_values {
 };
 
 static HsaCounterProperties **counter_props;
+/* Block table each node's properties were built from. Nodes sharing a table
+ * share one HsaCounterProperties.
+ */
+static const struct perf_counter_block **counter_props_table;
 static unsigned int counter_props_count;
 
 static ssize_t readn(int fd, void *buf, size_t n)
@@ -102,7 +107,12 @@ static ssize_t readn(int fd, void *buf, size_t n)
 HSAKMT_STATUS hsakmt_init_counter_props(unsigned int NumNodes)
 {
 	counter_props = calloc(NumNodes, sizeof(struct HsaCounterProperties *));
-	if (!counter_props) {
+	counter_props_table = calloc(NumNodes, sizeof(struct perf_counter_block *));
+	if (!counter_props || !counter_props_table) {
+		free(counter_props);
+		free(counter_props_table);
+		counter_props = NULL;
+		counter_props_table = NULL;
 		pr_warn("Profiling is not available.\n");
 		return HSAKMT_STATUS_NO_MEMORY;
 	}
@@ -114,18 +124,26 @@ HSAKMT_STATUS hsakmt_init_counter_props(unsigned int NumNodes)
 
 void hsakmt_destroy_counter_props(void)
 {
-	unsigned int i;
+	unsigned int i, j;
 
 	if (!counter_props)
 		return;
 
-	for (i = 0; i < counter_props_count; i++)
-		if (counter_props[i]) {
+	/* Shared properties are freed by the first node holding them */
+	for (i = 0; i < counter_props_count; i++) {
+		if (!counter_props[i])
+			continue;
+		for (j = 0; j < i; j++)
+			if (counter_props[j] == counter_props[i])
+				break;
+		if (j == i)
 			free(counter_props[i]);
-			counter_props[i] = NULL;
-		}
+	}
 
 	free(counter_props);
+	free(counter_props_table);
+	counter_props = NULL;
+	counter_props_table = NULL;
 }
 
 static int blockid2uuid(enum perf_block_id block_id, HSA_UUID *uuid)
@@ -214,16 +232,12 @@ static int blockid2uuid(enum perf_block_id block_id, HSA_UUID *uuid)
 static HSAuint32 get_block_concurrent_limit(uint32_t node_id,
 						HSAuint32 block_id)
 {
-	uint32_t i;
-	HsaCounterBlockProperties *block = &counter_props[node_id]->Blocks[0];
+	const struct perf_counter_block *table = hsakmt_get_block_table(node_id);
 
-	for (i = 0; i < PERFCOUNTER_BLOCKID__MAX; i++) {
-		if (block->Counters[0].BlockIndex == block_id)
-			return block->NumConcurrent;
-		block = (HsaCounterBlockProperties *)&block->Counters[block->NumCounters];
-	}
+	if (!table || block_id >= PERFCOUNTER_BLOCKID__MAX)
+		return 0;
 
-	return 0;
+	return table[block_id].num_of_slots;
 }
 
 static HSAKMT_STATUS perf_trace_ioctl(struct perf_trace_block *block,
@@ -257,13 +271,13 @@ static HSAKMT_STATUS query_trace(int fd, uint64_t *buf)
 HSAKMT_STATUS HSAKMTAPI hsaKmtPmcGetCounterProperties(HSAuint32 NodeId,
 						      HsaCounterProperties **CounterProperties)
 {
-	HSAKMT_STATUS rc = HSAKMT_STATUS_SUCCESS;
 	uint32_t gpu_id, i, block_id;
 	uint32_t counter_props_size = 0;
 	uint32_t total_counters = 0;
 	uint32_t total_concurrent = 0;
-	struct perf_counter_block block = {0};
+	const struct perf_counter_block *table, *block;
 	uint32_t total_blocks = 0;
+	HsaCounterProperties *props;
 	HsaCounterBlockProperties *block_prop;
 
 	if (!counter_props)
@@ -280,14 +294,26 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtPmcGetCounterProperties(HSAuint32 NodeId,
 		return HSAKMT_STATUS_SUCCESS;
 	}
 
-	for (i = 0; i < PERFCOUNTER_BLOCKID__MAX; i++) {
-		rc = hsakmt_get_block_properties(NodeId, i, &block);
-		if (rc != HSAKMT_STATUS_SUCCESS)
-			return rc;
-		total_concurrent += block.num_of_slots;
-		total_counters += block.num_of_counters;
+	table = hsakmt_get_block_table(NodeId);
+	if (!table)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	/* Another node of the same GPU family has the properties already */
+	for (i = 0; i < counter_props_count; i++) {
+		if (counter_props_table[i] == table && counter_props[i]) {
+			counter_props[NodeId] = counter_props[i];
+			counter_props_table[NodeId] = table;
+			*CounterProperties = counter_props[NodeId];
+			return HSAKMT_STATUS_SUCCESS;
+		}
+	}
+
+	for (block_id = 0; block_id < PERFCOUNTER_BLOCKID__MAX; block_id++) {
+		block = &table[block_id];
+		total_concurrent += block->num_of_slots;
+		total_counters += block->num_of_counters;
 		/* If num_of_slots=0, this block doesn't exist */
-		if (block.num_of_slots)
+		if (block->num_of_slots)
 			total_blocks++;
 	}
 
@@ -295,33 +321,27 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtPmcGetCounterProperties(HSAuint32 NodeId,
 			sizeof(HsaCounterBlockProperties) * (total_blocks - 1) +
 			sizeof(HsaCounter) * (total_counters - total_blocks);
 
-	counter_props[NodeId] = malloc(counter_props_size);
-	if (!counter_props[NodeId])
+	props = malloc(counter_props_size);
+	if (!props)
 		return HSAKMT_STATUS_NO_MEMORY;
 
-	counter_props[NodeId]->NumBlocks = total_blocks;
-	counter_props[NodeId]->NumConcurrent = total_concurrent;
+	props->NumBlocks = total_blocks;
+	props->NumConcurrent = total_concurrent;
 
-	block_prop = &counter_props[NodeId]->Blocks[0];
+	block_prop = &props->Blocks[0];
 	for (block_id = 0; block_id < PERFCOUNTER_BLOCKID__MAX; block_id++) {
-		rc = hsakmt_get_block_properties(NodeId, block_id, &block);
-		if (rc != HSAKMT_STATUS_SUCCESS) {
-			free(counter_props[NodeId]);
-			counter_props[NodeId] = NULL;
-			return rc;
-		}
-
-		if (!block.num_of_slots) /* not a valid block */
+		block = &table[block_id];
+		if (!block->num_of_slots) /* not a valid block */
 			continue;
 
 		blockid2uuid(block_id, &block_prop->BlockId);
-		block_prop->NumCounters = block.num_of_counters;
-		block_prop->NumConcurrent = block.num_of_slots;
-		for (i = 0; i < block.num_of_counters; i++) {
+		block_prop->NumCounters = block->num_of_counters;
+		block_prop->NumConcurrent = block->num_of_slots;
+		for (i = 0; i < block->num_of_counters; i++) {
 			block_prop->Counters[i].BlockIndex = block_id;
-			block_prop->Counters[i].CounterId = block.counter_ids[i];
-			block_prop->Counters[i].CounterSizeInBits = block.counter_size_in_bits;
-			block_prop->Counters[i].CounterMask = block.counter_mask;
+			block_prop->Counters[i].CounterId = block->counter_ids[i];
+			block_prop->Counters[i].CounterSizeInBits = block->counter_size_in_bits;
+			block_prop->Counters[i].CounterMask = block->counter_mask;
 			block_prop->Counters[i].Flags.ui32.Global = 1;
 			block_prop->Counters[i].Type = HSA_PROFILE_TYPE_NONPRIV_IMMEDIATE;
 		}
@@ -329,7 +349,9 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtPmcGetCounterProperties(HSAuint32 NodeId,
 		block_prop = (HsaCounterBlockProperties *)&block_prop->Counters[block_prop->NumCounters];
 	}
 
-	*CounterProperties = counter_props[NodeId];
+	counter_props[NodeId] = props;
+	counter_props_table[NodeId] = table;
+	*CounterProperties = props;
 
 	return HSAKMT_STATUS_SUCCESS;
 }
@@ -465,11 +487,16 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtPmcRegisterTrace(HSAuint32 NodeId,
 	trace->state = PERF_TRACE_STATE__STOPPED;
 	trace->num_blocks = num_blocks;
 
+	/* No perf events are opened for the counters yet */
+	fd_ptr = trace->blocks[0].perf_event_fd;
+	for (i = 0; i < total_counters; i++)
+		fd_ptr[i] = -1;
+
 	TraceRoot->NumberOfPasses = 1;
 	TraceRoot->TraceBufferMinSizeBytes = PAGE_ALIGN_UP(min_buf_size);
 	TraceRoot->TraceId = PORT_VPTR_TO_UINT64(trace);
 
-	free(trace);
+	/* The trace is freed by hsaKmtPmcUnregisterTrace */
 	return HSAKMT_STATUS_SUCCESS;
 }
 
@@ -658,3 +685,432 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtPmcStopTrace(HSATraceId TraceId)
 
 	return ret;
 }
+
+/* Counter multiplexing. A session splits its counters into groups that each
+ * fit the per-block concurrency limits, registers a trace per group, and
+ * enables one group at a time. Trace counts are cumulative over the time a
+ * group was enabled, so a counter's estimate over the whole session is its
+ * count scaled by session time over group time.
+ */
+#define HSA_PMC_SESSION_MAGIC4CC	0x53434D50
+
+struct pmc_session_group {
+	HsaPmcTraceRoot root;
+	uint64_t *buf;
+	uint64_t buf_size;
+	uint32_t num_counters;
+	uint32_t *index;		/* trace buffer slot -> session counter */
+	uint64_t enabled_ns;
+};
+
+struct pmc_session {
+	uint32_t magic4cc;
+	uint32_t node_id;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	pthread_t thread;
+	bool thread_running;
+	bool stop_thread;
+	uint32_t slice_us;
+	bool started;
+	uint32_t active;		/* enabled group while started */
+	uint64_t slice_start_ns;
+	uint64_t start_ns;
+	uint64_t run_ns;		/* session time of previous starts */
+	uint32_t num_counters;
+	uint64_t *raw;			/* last counts read, by session counter */
+	uint32_t *group_of;		/* group of each session counter */
+	uint32_t num_groups;
+	struct pmc_session_group groups[0];
+};
+
+static uint64_t pmc_session_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static struct pmc_session *pmc_session_get(HSAPmcSessionId SessionId)
+{
+	struct pmc_session *session =
+			(struct pmc_session *)PORT_UINT64_TO_VPTR(SessionId);
+
+	if (!session || session->magic4cc != HSA_PMC_SESSION_MAGIC4CC)
+		return NULL;
+	return session;
+}
+
+/* Reads the enabled group's counts. Called with the session mutex held. */
+static HSAKMT_STATUS pmc_session_read_active(struct pmc_session *session)
+{
+	struct pmc_session_group *group = &session->groups[session->active];
+	HSAKMT_STATUS ret;
+	uint32_t i;
+
+	ret = hsaKmtPmcQueryTrace(group->root.TraceId);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		return ret;
+
+	for (i = 0; i < group->num_counters; i++)
+		session->raw[group->index[i]] = group->buf[i];
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+/* Called with the session mutex held. */
+static HSAKMT_STATUS pmc_session_switch(struct pmc_session *session, uint32_t next)
+{
+	struct pmc_session_group *group = &session->groups[session->active];
+	uint64_t now;
+	HSAKMT_STATUS ret;
+
+	ret = pmc_session_read_active(session);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		return ret;
+
+	ret = hsaKmtPmcStopTrace(group->root.TraceId);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		return ret;
+
+	now = pmc_session_now();
+	group->enabled_ns += now - session->slice_start_ns;
+
+	group = &session->groups[next];
+	ret = hsaKmtPmcStartTrace(group->root.TraceId, group->buf, group->buf_size);
+	if (ret != HSAKMT_STATUS_SUCCESS) {
+		session->started = false;
+		session->run_ns += now - session->start_ns;
+		return ret;
+	}
+
+	session->active = next;
+	session->slice_start_ns = now;
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+static void *pmc_session_worker(void *arg)
+{
+	struct pmc_session *session = (struct pmc_session *)arg;
+	struct timespec deadline;
+	uint64_t ns;
+
+	pthread_mutex_lock(&session->mutex);
+	while (!session->stop_thread) {
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		ns = deadline.tv_nsec + (uint64_t)session->slice_us * 1000;
+		deadline.tv_sec += ns / 1000000000ULL;
+		deadline.tv_nsec = ns % 1000000000ULL;
+
+		if (pthread_cond_timedwait(&session->cond, &session->mutex,
+					   &deadline) != ETIMEDOUT)
+			continue;
+		if (session->stop_thread || !session->started)
+			continue;
+
+		if (pmc_session_switch(session,
+				(session->active + 1) % session->num_groups) !=
+				HSAKMT_STATUS_SUCCESS)
+			pr_err("Failed to switch counter group.\n");
+	}
+	pthread_mutex_unlock(&session->mutex);
+
+	return NULL;
+}
+
+static void pmc_session_free(struct pmc_session *session)
+{
+	uint32_t g;
+
+	for (g = 0; g < session->num_groups; g++) {
+		if (session->groups[g].root.TraceId)
+			hsaKmtPmcUnregisterTrace(session->node_id,
+						 session->groups[g].root.TraceId);
+		free(session->groups[g].buf);
+		free(session->groups[g].index);
+	}
+	free(session->raw);
+	free(session->group_of);
+	pthread_mutex_destroy(&session->mutex);
+	pthread_cond_destroy(&session->cond);
+	session->magic4cc = 0;
+	free(session);
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtPmcCreateSession(HSAuint32 NodeId,
+					       HSAuint32 NumberOfCounters,
+					       HsaCounter *Counters,
+					       HSAuint32 SliceIntervalUs,
+					       HSAuint32 *NumberOfGroups,
+					       HSAPmcSessionId *SessionId)
+{
+	uint32_t gpu_id, i, g, block, slot;
+	uint32_t num_counters[PERFCOUNTER_BLOCKID__MAX] = {0};
+	uint32_t limit[PERFCOUNTER_BLOCKID__MAX] = {0};
+	uint32_t num_groups = 0;
+	struct pmc_session *session;
+	struct pmc_session_group *group;
+	HsaCounter *group_counters = NULL;
+	HSAKMT_STATUS ret;
+
+	pr_debug("[%s] Number of counters %d\n", __func__, NumberOfCounters);
+
+	if (!counter_props)
+		return HSAKMT_STATUS_NO_MEMORY;
+
+	if (!Counters || !NumberOfGroups || !SessionId || NumberOfCounters == 0)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	if (hsakmt_validate_nodeid(NodeId, &gpu_id) != HSAKMT_STATUS_SUCCESS)
+		return HSAKMT_STATUS_INVALID_NODE_UNIT;
+
+	if (!counter_props[NodeId])
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	/* The k-th counter of a block goes to group k / limit */
+	for (i = 0; i < NumberOfCounters; i++) {
+		block = Counters[i].BlockIndex;
+		if (block >= PERFCOUNTER_BLOCKID__MAX)
+			return HSAKMT_STATUS_INVALID_PARAMETER;
+		if (!limit[block]) {
+			limit[block] = get_block_concurrent_limit(NodeId, block);
+			if (!limit[block]) {
+				pr_err("Invalid block ID: %d\n", block);
+				return HSAKMT_STATUS_INVALID_PARAMETER;
+			}
+		}
+		num_counters[block]++;
+		g = (num_counters[block] + limit[block] - 1) / limit[block];
+		if (g > num_groups)
+			num_groups = g;
+	}
+
+	session = calloc(1, sizeof(*session) +
+			 sizeof(struct pmc_session_group) * num_groups);
+	if (!session)
+		return HSAKMT_STATUS_NO_MEMORY;
+
+	session->node_id = NodeId;
+	session->slice_us = SliceIntervalUs;
+	session->num_counters = NumberOfCounters;
+	session->num_groups = num_groups;
+	pthread_mutex_init(&session->mutex, NULL);
+	pthread_cond_init(&session->cond, NULL);
+
+	ret = HSAKMT_STATUS_NO_MEMORY;
+	session->raw = calloc(NumberOfCounters, sizeof(uint64_t));
+	session->group_of = calloc(NumberOfCounters, sizeof(uint32_t));
+	group_counters = calloc(NumberOfCounters, sizeof(HsaCounter));
+	if (!session->raw || !session->group_of || !group_counters)
+		goto fail;
+
+	memset(num_counters, 0, sizeof(num_counters));
+	for (i = 0; i < NumberOfCounters; i++) {
+		block = Counters[i].BlockIndex;
+		session->group_of[i] = num_counters[block]++ / limit[block];
+		session->groups[session->group_of[i]].num_counters++;
+	}
+
+	for (g = 0; g < num_groups; g++) {
+		group = &session->groups[g];
+		group->index = calloc(group->num_counters, sizeof(uint32_t));
+		if (!group->index)
+			goto fail;
+
+		/* Trace buffers hold the counts ordered by block, then by
+		 * registration order within the block.
+		 */
+		slot = 0;
+		for (block = 0; block < PERFCOUNTER_BLOCKID__MAX; block++)
+			for (i = 0; i < NumberOfCounters; i++)
+				if (session->group_of[i] == g &&
+				    Counters[i].BlockIndex == block) {
+					group_counters[slot] = Counters[i];
+					group->index[slot++] = i;
+				}
+
+		ret = hsaKmtPmcRegisterTrace(NodeId, group->num_counters,
+					     group_counters, &group->root);
+		if (ret != HSAKMT_STATUS_SUCCESS)
+			goto fail;
+
+		ret = HSAKMT_STATUS_NO_MEMORY;
+		group->buf_size = PAGE_ALIGN_UP(MAX(group->root.TraceBufferMinSizeBytes,
+				group->num_counters * sizeof(uint64_t)));
+		if (posix_memalign((void **)&group->buf, PAGE_SIZE, group->buf_size)) {
+			group->buf = NULL;
+			goto fail;
+		}
+	}
+	free(group_counters);
+
+	session->magic4cc = HSA_PMC_SESSION_MAGIC4CC;
+	*NumberOfGroups = num_groups;
+	*SessionId = PORT_VPTR_TO_UINT64(session);
+
+	return HSAKMT_STATUS_SUCCESS;
+
+fail:
+	free(group_counters);
+	pmc_session_free(session);
+	return ret;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtPmcStartSession(HSAPmcSessionId SessionId)
+{
+	struct pmc_session *session = pmc_session_get(SessionId);
+	struct pmc_session_group *group;
+	HSAKMT_STATUS ret;
+
+	pr_debug("[%s] Session ID 0x%lx\n", __func__, SessionId);
+
+	if (!session)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	pthread_mutex_lock(&session->mutex);
+	if (session->started) {
+		pthread_mutex_unlock(&session->mutex);
+		return HSAKMT_STATUS_SUCCESS;
+	}
+
+	group = &session->groups[session->active];
+	ret = hsaKmtPmcStartTrace(group->root.TraceId, group->buf, group->buf_size);
+	if (ret != HSAKMT_STATUS_SUCCESS) {
+		pthread_mutex_unlock(&session->mutex);
+		return ret;
+	}
+
+	session->started = true;
+	session->start_ns = pmc_session_now();
+	session->slice_start_ns = session->start_ns;
+
+	if (session->slice_us && session->num_groups > 1 && !session->thread_running) {
+		session->stop_thread = false;
+		if (pthread_create(&session->thread, NULL, pmc_session_worker, session))
+			pr_err("Failed to create counter rotation thread.\n");
+		else
+			session->thread_running = true;
+	}
+	pthread_mutex_unlock(&session->mutex);
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtPmcRotateSession(HSAPmcSessionId SessionId)
+{
+	struct pmc_session *session = pmc_session_get(SessionId);
+	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
+
+	if (!session)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	pthread_mutex_lock(&session->mutex);
+	if (session->started && session->num_groups > 1)
+		ret = pmc_session_switch(session,
+				(session->active + 1) % session->num_groups);
+	pthread_mutex_unlock(&session->mutex);
+
+	return ret;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtPmcReadSession(HSAPmcSessionId SessionId,
+					     HSAuint32 NumberOfValues,
+					     HSAuint64 *Values)
+{
+	struct pmc_session *session = pmc_session_get(SessionId);
+	uint64_t now, total_ns, group_ns;
+	HSAKMT_STATUS ret;
+	uint32_t i, g;
+
+	if (!session)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	if (!Values || NumberOfValues < session->num_counters)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	pthread_mutex_lock(&session->mutex);
+	now = pmc_session_now();
+	total_ns = session->run_ns;
+	if (session->started) {
+		ret = pmc_session_read_active(session);
+		if (ret != HSAKMT_STATUS_SUCCESS) {
+			pthread_mutex_unlock(&session->mutex);
+			return ret;
+		}
+		total_ns += now - session->start_ns;
+	}
+
+	for (i = 0; i < session->num_counters; i++) {
+		g = session->group_of[i];
+		group_ns = session->groups[g].enabled_ns;
+		if (session->started && g == session->active)
+			group_ns += now - session->slice_start_ns;
+
+		if (!group_ns)
+			Values[i] = 0;
+		else if (group_ns >= total_ns)
+			Values[i] = session->raw[i];
+		else
+			Values[i] = (HSAuint64)((double)session->raw[i] * total_ns / group_ns);
+	}
+	pthread_mutex_unlock(&session->mutex);
+
+	return HSAKMT_STATUS_SUCCESS;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtPmcStopSession(HSAPmcSessionId SessionId)
+{
+	struct pmc_session *session = pmc_session_get(SessionId);
+	struct pmc_session_group *group;
+	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
+	uint64_t now;
+	bool join;
+
+	pr_debug("[%s] Session ID 0x%lx\n", __func__, SessionId);
+
+	if (!session)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	pthread_mutex_lock(&session->mutex);
+	join = session->thread_running;
+	session->stop_thread = true;
+	session->thread_running = false;
+	pthread_cond_signal(&session->cond);
+	pthread_mutex_unlock(&session->mutex);
+
+	if (join)
+		pthread_join(session->thread, NULL);
+
+	pthread_mutex_lock(&session->mutex);
+	if (session->started) {
+		group = &session->groups[session->active];
+		ret = pmc_session_read_active(session);
+		if (ret == HSAKMT_STATUS_SUCCESS)
+			ret = hsaKmtPmcStopTrace(group->root.TraceId);
+
+		now = pmc_session_now();
+		group->enabled_ns += now - session->slice_start_ns;
+		session->run_ns += now - session->start_ns;
+		session->started = false;
+	}
+	pthread_mutex_unlock(&session->mutex);
+
+	return ret;
+}
+
+HSAKMT_STATUS HSAKMTAPI hsaKmtPmcDestroySession(HSAPmcSessionId SessionId)
+{
+	struct pmc_session *session = pmc_session_get(SessionId);
+
+	pr_debug("[%s] Session ID 0x%lx\n", __func__, SessionId);
+
+	if (!session)
+		return HSAKMT_STATUS_INVALID_HANDLE;
+
+	hsaKmtPmcStopSession(SessionId);
+	pmc_session_free(session);
+
+	return HSAKMT_STATUS_SUCCESS;
+}
@@ -1958,50 +1958,53 @@ static struct perf_counter_block navi_blocks[PERFCOUNTER_BLOCKID__MAX] = {
 	},
 };
 
-HSAKMT_STATUS hsakmt_get_block_properties(uint32_t node_id,
-				   enum perf_block_id block_id,
-				   struct perf_counter_block *block)
+const struct perf_counter_block *hsakmt_get_block_table(uint32_t node_id)
 {
 	uint32_t gfxv = hsakmt_get_gfxv_by_node_id(node_id);
 	uint16_t dev_id = hsakmt_get_device_id_by_node_id(node_id);
 
-	if (block_id >= PERFCOUNTER_BLOCKID__MAX ||
-			block_id < PERFCOUNTER_BLOCKID__FIRST)
-		return HSAKMT_STATUS_INVALID_PARAMETER;
-
 	/* Major GFX Version */
 	switch (gfxv >> 16) {
 	case 7:
 		if (gfxv == GFX_VERSION_KAVERI)
-			*block = kaveri_blocks[block_id];
-		else
-			*block = hawaii_blocks[block_id];
-		break;
+			return kaveri_blocks;
+		return hawaii_blocks;
 	case 8:
 		if (gfxv == GFX_VERSION_TONGA)
-			return HSAKMT_STATUS_INVALID_PARAMETER;
-		else if (gfxv == GFX_VERSION_CARRIZO)
-			*block = carrizo_blocks[block_id];
-		else {
-			/*
-			 * Fiji/Polaris/VegaM cards are of the same GFXIP Engine Version (8.0.3).
-			 * Only way to differentiate b/t Fiji and Polaris/VegaM is via DID.
-			 */
-			if (dev_id == 0x7300 || dev_id == 0x730F)
-				*block = fiji_blocks[block_id];
-			else
-				*block = polaris_blocks[block_id];
-		}
-		break;
+			return NULL;
+		if (gfxv == GFX_VERSION_CARRIZO)
+			return carrizo_blocks;
+		/*
+		 * Fiji/Polaris/VegaM cards are of the same GFXIP Engine Version (8.0.3).
+		 * Only way to differentiate b/t Fiji and Polaris/VegaM is via DID.
+		 */
+		if (dev_id == 0x7300 || dev_id == 0x730F)
+			return fiji_blocks;
+		return polaris_blocks;
 	case 9:
-		*block = vega_blocks[block_id];
-		break;
+		return vega_blocks;
 	case 10:
-		*block = navi_blocks[block_id];
-		break;
+		return navi_blocks;
 	default:
-		return HSAKMT_STATUS_INVALID_PARAMETER;
+		return NULL;
 	}
+}
+
+HSAKMT_STATUS hsakmt_get_block_properties(uint32_t node_id,
+				   enum perf_block_id block_id,
+				   struct perf_counter_block *block)
+{
+	const struct perf_counter_block *table;
+
+	if (block_id >= PERFCOUNTER_BLOCKID__MAX ||
+			block_id < PERFCOUNTER_BLOCKID__FIRST)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	table = hsakmt_get_block_table(node_id);
+	if (!table)
+		return HSAKMT_STATUS_INVALID_PARAMETER;
+
+	*block = table[block_id];
 
 	return HSAKMT_STATUS_SUCCESS;
 }
@@ -67,6 +67,11 @@ struct perf_counter_block {
 	uint64_t    counter_mask;
 };
 
+/* Block table of the GPU family of a node, indexed by perf_block_id. NULL if
+ * the family has no counters.
+ */
+const struct perf_counter_block *hsakmt_get_block_table(uint32_t node_id);
+
 HSAKMT_STATUS hsakmt_get_block_properties(uint32_t node_id,
 				   enum perf_block_id block_id,
 				   struct perf_counter_block *block);
@@ -64,6 +64,7 @@ struct queue {
 	uint32_t eop_buffer_size;
 	uint32_t total_mem_alloc_size;
 	uint32_t gfxv;
+	uint32_t node_id;
 	bool use_ats;
 	bool unified_ctx_save_restore;
 	/* This queue structure is allocated from GPU with page aligned size
@@ -454,6 +455,111 @@ static HSAKMT_STATUS register_svm_range(void *mem, uint32_t size,
 	return hsaKmtSVMSetAttr(mem, size, nattr, attrs);
 }
 
+/* Context save areas of destroyed queues, kept for reuse by later queues of
+ * the same node and size. Sizing is per node, so queue churn would otherwise
+ * allocate, map and register tens of MB per queue creation. At most
+ * hsakmt_cwsr_cache_size areas are held.
+ *
+ * Areas can't be shared by live queues or made smaller than KFD expects:
+ * preemption saves the state of every queue of the process at once.
+ */
+struct cwsr_area {
+	struct cwsr_area *next;
+	void *addr;
+	uint32_t size;
+	uint32_t node_id;
+	bool unified;
+	bool use_ats;
+};
+
+static struct cwsr_area *cwsr_cache;
+static unsigned int cwsr_cache_count;
+static pthread_mutex_t cwsr_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void free_cwsr_area(void *addr, uint32_t size, bool unified, bool use_ats)
+{
+	if (unified)
+		munmap(addr, size);
+	else
+		free_exec_aligned_memory(addr, size, PAGE_SIZE, use_ats);
+}
+
+static void *get_cached_cwsr_area(uint32_t node_id, uint32_t size,
+				  bool unified, bool use_ats)
+{
+	struct cwsr_area **prev, *area;
+	void *addr = NULL;
+
+	pthread_mutex_lock(&cwsr_cache_mutex);
+	for (prev = &cwsr_cache; (area = *prev); prev = &area->next) {
+		if (area->node_id == node_id && area->size == size &&
+		    area->unified == unified && area->use_ats == use_ats) {
+			*prev = area->next;
+			cwsr_cache_count--;
+			addr = area->addr;
+			free(area);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&cwsr_cache_mutex);
+
+	return addr;
+}
+
+static void put_cwsr_area(void *addr, uint32_t size, uint32_t node_id,
+			  bool unified, bool use_ats)
+{
+	struct cwsr_area *area = NULL;
+
+	pthread_mutex_lock(&cwsr_cache_mutex);
+	if (cwsr_cache_count < hsakmt_cwsr_cache_size)
+		area = malloc(sizeof(*area));
+	if (area) {
+		area->addr = addr;
+		area->size = size;
+		area->node_id = node_id;
+		area->unified = unified;
+		area->use_ats = use_ats;
+		area->next = cwsr_cache;
+		cwsr_cache = area;
+		cwsr_cache_count++;
+	}
+	pthread_mutex_unlock(&cwsr_cache_mutex);
+
+	if (!area)
+		free_cwsr_area(addr, size, unified, use_ats);
+}
+
+void hsakmt_destroy_cwsr_cache(void)
+{
+	struct cwsr_area *area;
+
+	pthread_mutex_lock(&cwsr_cache_mutex);
+	while ((area = cwsr_cache)) {
+		cwsr_cache = area->next;
+		free_cwsr_area(area->addr, area->size, area->unified, area->use_ats);
+		free(area);
+	}
+	cwsr_cache_count = 0;
+	pthread_mutex_unlock(&cwsr_cache_mutex);
+}
+
+/* This is a special funcion that should be called only from the child process
+ * after a fork(). GPU memory of cached areas is dropped with the rest of the
+ * parent's memory and unified areas are not inherited (MADV_DONTFORK).
+ */
+void hsakmt_clear_cwsr_cache(void)
+{
+	struct cwsr_area *area;
+
+	while ((area = cwsr_cache)) {
+		cwsr_cache = area->next;
+		free(area);
+	}
+	cwsr_cache_count = 0;
+	pthread_mutex_init(&cwsr_cache_mutex, NULL);
+}
+
 static void free_queue(struct queue *q)
 {
 	if (q->eop_buffer)
@@ -461,11 +567,13 @@ static void free_queue(struct queue *q)
 					 q->eop_buffer_size,
 					 PAGE_SIZE, q->use_ats);
 	if (q->unified_ctx_save_restore)
-		munmap(q->ctx_save_restore, q->total_mem_alloc_size);
+		put_cwsr_area(q->ctx_save_restore,
+			      PAGE_ALIGN_UP(q->total_mem_alloc_size),
+			      q->node_id, true, q->use_ats);
 	else if (q->ctx_save_restore)
-		free_exec_aligned_memory(q->ctx_save_restore,
-					 q->total_mem_alloc_size,
-					 PAGE_SIZE, q->use_ats);
+		put_cwsr_area(q->ctx_save_restore,
+			      q->total_mem_alloc_size,
+			      q->node_id, false, q->use_ats);
 
 	free_exec_aligned_memory((void *)q, sizeof(*q), PAGE_SIZE, q->use_ats);
 }
@@ -536,39 +644,51 @@ static int handle_concrete_asic(struct queue *q,
 		 */
 		if (!q->use_ats && hsakmt_is_svm_api_supported) {
 			uint32_t size = PAGE_ALIGN_UP(q->total_mem_alloc_size);
+			void *addr = get_cached_cwsr_area(NodeId, size, true, q->use_ats);
 
-			pr_info("Allocating GTT for CWSR\n");
-			void *addr = hsakmt_mmap_allocate_aligned(PROT_READ | PROT_WRITE,
-						     MAP_ANONYMOUS | MAP_PRIVATE,
-						     size, GPU_HUGE_PAGE_SIZE, 0,
-						     0, (void *)LONG_MAX);
-			if (!addr) {
-				pr_err("mmap failed to alloc ctx area size 0x%x: %s\n",
-					size, strerror(errno));
-			} else {
-				/*
-				 * To avoid fork child process COW MMU notifier
-				 * callback evict parent process queues.
-				 */
-				if (madvise(addr, size, MADV_DONTFORK))
-					pr_err("madvise failed -%d\n", errno);
-
+			/* A cached area is still registered from its previous queue */
+			if (addr) {
 				fill_cwsr_header(q, addr, Event, ErrPayload, node.NumXcc);
-
-				HSAKMT_STATUS r = register_svm_range(addr, size,
-						NodeId, NodeId, 0, true);
-
-				if (r == HSAKMT_STATUS_SUCCESS) {
-					q->ctx_save_restore = addr;
-					q->unified_ctx_save_restore = true;
+				q->ctx_save_restore = addr;
+				q->unified_ctx_save_restore = true;
+			} else {
+				pr_info("Allocating GTT for CWSR\n");
+				addr = hsakmt_mmap_allocate_aligned(PROT_READ | PROT_WRITE,
+							     MAP_ANONYMOUS | MAP_PRIVATE,
+							     size, GPU_HUGE_PAGE_SIZE, 0,
+							     0, (void *)LONG_MAX);
+				if (!addr) {
+					pr_err("mmap failed to alloc ctx area size 0x%x: %s\n",
+						size, strerror(errno));
 				} else {
-					munmap(addr, size);
+					/*
+					 * To avoid fork child process COW MMU notifier
+					 * callback evict parent process queues.
+					 */
+					if (madvise(addr, size, MADV_DONTFORK))
+						pr_err("madvise failed -%d\n", errno);
+
+					fill_cwsr_header(q, addr, Event, ErrPayload, node.NumXcc);
+
+					HSAKMT_STATUS r = register_svm_range(addr, size,
+							NodeId, NodeId, 0, true);
+
+					if (r == HSAKMT_STATUS_SUCCESS) {
+						q->ctx_save_restore = addr;
+						q->unified_ctx_save_restore = true;
+					} else {
+						munmap(addr, size);
+					}
 				}
 			}
 		}
 
 		if (!q->unified_ctx_save_restore) {
-			q->ctx_save_restore = allocate_exec_aligned_memory(
+			q->ctx_save_restore = get_cached_cwsr_area(NodeId,
+							q->total_mem_alloc_size,
+							false, q->use_ats);
+			if (!q->ctx_save_restore)
+				q->ctx_save_restore = allocate_exec_aligned_memory(
 							q->total_mem_alloc_size,
 							q->use_ats, gpu_id, NodeId,
 							false, false, false);
@@ -636,6 +756,10 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtCreateQueueExt(HSAuint32 NodeId,
 	if (result != HSAKMT_STATUS_SUCCESS)
 		return result;
 
+	result = hsakmt_fmm_activate_gpus(&gpu_id, 1);
+	if (result != HSAKMT_STATUS_SUCCESS)
+		return result;
+
 	struct queue *q = allocate_exec_aligned_memory(sizeof(*q),
 			false, gpu_id, NodeId, true, false, true);
 	if (!q)
@@ -644,6 +768,7 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtCreateQueueExt(HSAuint32 NodeId,
 	memset(q, 0, sizeof(*q));
 
 	q->gfxv = hsakmt_get_gfxv_by_node_id(NodeId);
+	q->node_id = NodeId;
 	q->use_ats = false;
 
 	if (q->gfxv == GFX_VERSION_TONGA)
@@ -887,6 +1012,10 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtSetTrapHandler(HSAuint32 Node,
 	if (result != HSAKMT_STATUS_SUCCESS)
 		return result;
 
+	result = hsakmt_fmm_activate_gpus(&gpu_id, 1);
+	if (result != HSAKMT_STATUS_SUCCESS)
+		return result;
+
 	args.gpu_id = gpu_id;
 	args.tba_addr = (uintptr_t)TrapHandlerBaseAddress;
 	args.tma_addr = (uintptr_t)TrapBufferBaseAddress;
@@ -32,14 +32,39 @@ static inline void rbtree_left_rotate(rbtree_node_t **root,
 static inline void rbtree_right_rotate(rbtree_node_t **root,
 		rbtree_node_t *sentinel, rbtree_node_t *node);
 
+static inline unsigned long
+rbtree_node_end(rbtree_node_t *node)
+{
+	return node->key.addr + node->key.size;
+}
+
+/* recompute max_end of node from its own end and its children */
+static inline void
+rbtree_update_max_end(rbtree_node_t *node)
+{
+	unsigned long max_end = rbtree_node_end(node);
+
+	if (node->left->max_end > max_end)
+		max_end = node->left->max_end;
+	if (node->right->max_end > max_end)
+		max_end = node->right->max_end;
+
+	node->max_end = max_end;
+}
+
 static void
 hsakmt_rbtree_insert_value(rbtree_node_t *temp, rbtree_node_t *node,
 		rbtree_node_t *sentinel)
 {
 	rbtree_node_t  **p;
+	unsigned long end = rbtree_node_end(node);
 
 	for ( ;; ) {
 
+		/* node will be in the subtree of every node on the way down */
+		if (temp->max_end < end)
+			temp->max_end = end;
+
 		p = rbtree_key_compare(LKP_ALL, &node->key, &temp->key) < 0 ?
 			&temp->left : &temp->right;
 
@@ -54,6 +79,7 @@ hsakmt_rbtree_insert_value(rbtree_node_t *temp, rbtree_node_t *node,
 	node->parent = temp;
 	node->left = sentinel;
 	node->right = sentinel;
+	node->max_end = end;
 	rbt_red(node);
 }
 
@@ -72,6 +98,7 @@ hsakmt_rbtree_insert(rbtree_t *tree, rbtree_node_t *node)
 		node->parent = NULL;
 		node->left = sentinel;
 		node->right = sentinel;
+		node->max_end = rbtree_node_end(node);
 		rbt_black(node);
 		*root = node;
 
@@ -134,7 +161,7 @@ void
 hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 {
 	unsigned int red;
-	rbtree_node_t  **root, *sentinel, *subst, *temp, *w;
+	rbtree_node_t  **root, *sentinel, *subst, *temp, *w, *n;
 
 	/* a binary tree delete */
 
@@ -213,6 +240,15 @@ hsakmt_rbtree_delete(rbtree_t *tree, rbtree_node_t *node)
 		}
 	}
 
+	/* temp->parent is the lowest node whose subtree lost a node, and
+	 * subst, if it moved, is on its path to the root.
+	 */
+	for (n = temp->parent; ; n = n->parent) {
+		rbtree_update_max_end(n);
+		if (n == *root)
+			break;
+	}
+
 	if (red) {
 		return;
 	}
@@ -312,6 +348,9 @@ rbtree_left_rotate(rbtree_node_t **root, rbtree_node_t *sentinel,
 
 	temp->left = node;
 	node->parent = temp;
+
+	rbtree_update_max_end(node);
+	rbtree_update_max_end(temp);
 }
 
 
@@ -342,6 +381,9 @@ rbtree_right_rotate(rbtree_node_t **root, rbtree_node_t *sentinel,
 
 	temp->right = node;
 	node->parent = temp;
+
+	rbtree_update_max_end(node);
+	rbtree_update_max_end(temp);
 }
 
 
@@ -47,6 +47,8 @@ struct rbtree_node_s {
 	rbtree_node_t   *left;
 	rbtree_node_t   *right;
 	rbtree_node_t   *parent;
+	/* largest key.addr + key.size in the subtree, 0 for the sentinel */
+	unsigned long   max_end;
 	unsigned char   color;
 	unsigned char   data;
 };
@@ -60,6 +62,7 @@ struct rbtree_s {
 
 #define rbtree_init(tree)				\
 	rbtree_sentinel_init(&(tree)->sentinel);	\
+	(tree)->sentinel.max_end = 0;			\
 	(tree)->root = &(tree)->sentinel;
 
 void hsakmt_rbtree_insert(rbtree_t *tree, rbtree_node_t *node);
@@ -149,6 +149,43 @@ rbtree_lookup(rbtree_t *rbtree, rbtree_key_t *key,
 {
 	return rbtree_lookup_nearest(rbtree, key, type, -1);
 }
+
+static inline rbtree_node_t *
+rbtree_lookup_interval_node(rbtree_node_t *node, rbtree_node_t *sentinel,
+		unsigned long addr)
+{
+	rbtree_node_t *n;
+
+	/* max_end prunes subtrees where nothing reaches past addr */
+	while (node != sentinel && node->max_end > addr) {
+		if (node->key.addr > addr) {
+			/* the right subtree starts even later */
+			node = node->left;
+			continue;
+		}
+
+		n = rbtree_lookup_interval_node(node->right, sentinel, addr);
+		if (n)
+			return n;
+
+		if (addr < node->key.addr + node->key.size)
+			return node;
+
+		node = node->left;
+	}
+
+	return NULL;
+}
+
+/*
+ * return the node with the largest key whose [addr, addr + size) covers
+ * addr, nodes may overlap
+ */
+static inline rbtree_node_t *
+rbtree_lookup_interval(rbtree_t *rbtree, unsigned long addr)
+{
+	return rbtree_lookup_interval_node(rbtree->root, &rbtree->sentinel, addr);
+}
 #endif /*_RBTREE_AMD_H_HELPER_*/
 
 #endif /*RBTREE_HELPER*/
@@ -24,6 +24,7 @@
  */
 
 #include "libhsakmt.h"
+#include "fmm.h"
 #include "hsakmt/linux/kfd_ioctl.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -41,7 +42,10 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtSPMAcquire(HSAuint32 PreferredNode)
 		return ret;
 	}
 
-	ret = HSAKMT_STATUS_SUCCESS;
+	ret = hsakmt_fmm_activate_gpus(&gpu_id, 1);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		return ret;
+
 	args.op = KFD_IOCTL_SPM_OP_ACQUIRE;
 	args.gpu_id = gpu_id;
 
@@ -23,6 +23,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include "libhsakmt.h"
+#include "fmm.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -91,6 +92,14 @@ hsaKmtSVMSetAttr(void *start_addr, HSAuint64 size, unsigned int nattr,
 			pr_debug("CPU node invalid for access attribute\n");
 			return HSAKMT_STATUS_INVALID_NODE_UNIT;
 		}
+
+		/* GPUs the range may be placed on or accessed from need a VM */
+		if (args->attrs[i].value &&
+		    attrs[i].type != KFD_IOCTL_SVM_ATTR_NO_ACCESS) {
+			r = hsakmt_fmm_activate_gpus(&args->attrs[i].value, 1);
+			if (r != HSAKMT_STATUS_SUCCESS)
+				return r;
+		}
 	}
 
 	/* Driver does one copy_from_user, with extra attrs size */
@@ -216,7 +225,12 @@ hsaKmtSetGetXNACKMode(HSAint32 * enable)
 HSAKMT_STATUS HSAKMTAPI
 hsaKmtSetXNACKMode(HSAint32 enable)
 {
-	return hsaKmtSetGetXNACKMode(&enable);
+	HSAKMT_STATUS ret = hsaKmtSetGetXNACKMode(&enable);
+
+	if (ret == HSAKMT_STATUS_SUCCESS && enable)
+		ret = hsakmt_fmm_xnack_enabled();
+
+	return ret;
 }
 
 HSAKMT_STATUS HSAKMTAPI
@@ -35,6 +35,9 @@
 #include <limits.h>
 
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/sysinfo.h>
 #include <xf86drm.h>
 #include <amdgpu.h>
@@ -1937,32 +1940,311 @@ try_alt_dir:
 	}
 }
 
+/* Binary copy of the parsed topology, shared through tmpfs by all processes
+ * of the same user. It is keyed by the KFD generation ID and is only used
+ * when nothing in this process changes what the sysfs parse would produce.
+ */
+#define TOPOLOGY_CACHE_DIR "/dev/shm"
+#define TOPOLOGY_CACHE_MAGIC 0x4f504f544b415348ULL /* "HSAKTOPO" */
+#define TOPOLOGY_CACHE_VERSION 1
+
+struct topology_cache_header {
+	uint64_t magic;
+	uint32_t version;
+	uint32_t generation;
+	uint64_t size;
+	uint32_t node_size;
+	uint32_t mem_size;
+	uint32_t cache_size;
+	uint32_t link_size;
+	uint32_t svm_api_supported;
+	int32_t processor_vendor;
+	uint32_t num_sysfs_nodes;
+	uint32_t reserved;
+	HsaSystemProperties system;
+	/* Followed by the user to sysfs node ID map, then for each node its
+	 * HsaNodeProperties and its memory, cache and io_link properties.
+	 */
+};
+
+static bool topology_cache_enabled(uint32_t num_nodes)
+{
+	char *envvar;
+	char per_node_override[32];
+	uint32_t i;
+
+	envvar = getenv("HSA_TOPOLOGY_CACHE");
+	if (envvar && !strcmp(envvar, "0"))
+		return false;
+
+	/* GFX version overrides are applied while parsing node properties */
+	if (getenv("HSA_OVERRIDE_GFX_VERSION"))
+		return false;
+	for (i = 0; i < num_nodes; i++) {
+		snprintf(per_node_override, sizeof(per_node_override), "HSA_OVERRIDE_GFX_VERSION_%d", i);
+		if (getenv(per_node_override))
+			return false;
+	}
+
+	return true;
+}
+
+static void topology_cache_path(char *path, size_t size)
+{
+	snprintf(path, size, "%s/hsakmt-topology-%u", TOPOLOGY_CACHE_DIR, (uint32_t)geteuid());
+}
+
+static void topology_cache_init_header(struct topology_cache_header *hdr,
+				       uint32_t generation,
+				       const HsaSystemProperties *sys_props)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->magic = TOPOLOGY_CACHE_MAGIC;
+	hdr->version = TOPOLOGY_CACHE_VERSION;
+	hdr->generation = generation;
+	hdr->node_size = sizeof(HsaNodeProperties);
+	hdr->mem_size = sizeof(HsaMemoryProperties);
+	hdr->cache_size = sizeof(HsaCacheProperties);
+	hdr->link_size = sizeof(HsaIoLinkProperties);
+	hdr->svm_api_supported = hsakmt_is_svm_api_supported;
+	hdr->processor_vendor = processor_vendor;
+	hdr->num_sysfs_nodes = num_sysfs_nodes;
+	hdr->system = *sys_props;
+}
+
+static bool topology_cache_read(const uint8_t **p, const uint8_t *end,
+				void *dst, size_t size)
+{
+	if ((size_t)(end - *p) < size)
+		return false;
+
+	memcpy(dst, *p, size);
+	*p += size;
+	return true;
+}
+
+/* Load the topology cache written for @generation. The current process has
+ * already discovered @sys_props and the node ID map, the cache must agree
+ * with both and with the GPU ID of every node to be used.
+ */
+static HSAKMT_STATUS topology_cache_load(uint32_t generation,
+					 const HsaSystemProperties *sys_props,
+					 node_props_t **props)
+{
+	struct topology_cache_header hdr, expected;
+	node_props_t *temp_props = NULL;
+	const uint8_t *base, *p, *end;
+	void *map;
+	char path[256];
+	struct stat st;
+	uint32_t i, gpu_id;
+	size_t map_size;
+	int fd;
+	HSAKMT_STATUS ret = HSAKMT_STATUS_ERROR;
+
+	topology_cache_path(path, sizeof(path));
+	fd = open(path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+	if (fd < 0)
+		return HSAKMT_STATUS_ERROR;
+
+	/* Only trust a cache that was written by this user and nobody else can modify */
+	if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_uid != geteuid() ||
+	    (st.st_mode & (S_IWGRP | S_IWOTH)) || st.st_size < (off_t)sizeof(hdr)) {
+		close(fd);
+		return HSAKMT_STATUS_ERROR;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return HSAKMT_STATUS_ERROR;
+
+	base = map;
+	p = base;
+	end = base + st.st_size;
+	topology_cache_read(&p, end, &hdr, sizeof(hdr));
+	topology_cache_init_header(&expected, generation, sys_props);
+	expected.size = st.st_size;
+	expected.processor_vendor = hdr.processor_vendor;
+	if (memcmp(&hdr, &expected, sizeof(hdr))) {
+		pr_debug("Topology cache %s is stale\n", path);
+		goto out;
+	}
+
+	map_size = sys_props->NumNodes * sizeof(uint32_t);
+	if ((size_t)(end - p) < map_size ||
+	    memcmp(p, map_user_to_sysfs_node_id, map_size))
+		goto out;
+	p += map_size;
+
+	temp_props = calloc(sys_props->NumNodes, sizeof(node_props_t));
+	if (!temp_props)
+		goto out;
+
+	for (i = 0; i < sys_props->NumNodes; i++) {
+		node_props_t *node = &temp_props[i];
+
+		if (!topology_cache_read(&p, end, &node->node, sizeof(node->node)) ||
+		    node->node.NumIOLinks > sys_props->NumNodes - 1)
+			goto bad;
+
+		/* The generation ID restarts when the driver is reloaded */
+		if (topology_sysfs_get_gpu_id(map_user_to_sysfs_node_id[i], &gpu_id) !=
+				HSAKMT_STATUS_SUCCESS || gpu_id != node->node.KFDGpuID)
+			goto bad;
+
+		if (node->node.NumMemoryBanks) {
+			node->mem = calloc(node->node.NumMemoryBanks, sizeof(HsaMemoryProperties));
+			if (!node->mem || !topology_cache_read(&p, end, node->mem,
+					node->node.NumMemoryBanks * sizeof(HsaMemoryProperties)))
+				goto bad;
+		}
+
+		if (node->node.NumCaches) {
+			node->cache = calloc(node->node.NumCaches, sizeof(HsaCacheProperties));
+			if (!node->cache || !topology_cache_read(&p, end, node->cache,
+					node->node.NumCaches * sizeof(HsaCacheProperties)))
+				goto bad;
+		}
+
+		/* Keep room for the maximum number of io_links, see topology_take_snapshot */
+		node->link = calloc(sys_props->NumNodes - 1, sizeof(HsaIoLinkProperties));
+		if (!node->link || !topology_cache_read(&p, end, node->link,
+				node->node.NumIOLinks * sizeof(HsaIoLinkProperties)))
+			goto bad;
+	}
+
+	if (p != end)
+		goto bad;
+
+	processor_vendor = hdr.processor_vendor;
+	*props = temp_props;
+	ret = HSAKMT_STATUS_SUCCESS;
+	pr_debug("Loaded topology generation %u from %s\n", generation, path);
+	goto out;
+
+bad:
+	pr_debug("Topology cache %s does not match sysfs\n", path);
+	free_properties(temp_props, sys_props->NumNodes);
+out:
+	munmap(map, st.st_size);
+	return ret;
+}
+
+static void topology_cache_write(uint8_t **p, const void *src, size_t size)
+{
+	if (!size)
+		return;
+
+	memcpy(*p, src, size);
+	*p += size;
+}
+
+/* Publish the topology parsed for @generation. The file is written under a
+ * temporary name and renamed, so readers never see a partial cache.
+ */
+static void topology_cache_store(uint32_t generation,
+				 const HsaSystemProperties *sys_props,
+				 const node_props_t *props)
+{
+	struct topology_cache_header hdr;
+	char path[256], tmp_path[256 + 8];
+	uint8_t *buf, *p;
+	size_t size, done;
+	ssize_t n;
+	uint32_t i;
+	int fd;
+
+	size = sizeof(hdr) + sys_props->NumNodes * sizeof(uint32_t);
+	for (i = 0; i < sys_props->NumNodes; i++)
+		size += sizeof(HsaNodeProperties) +
+			props[i].node.NumMemoryBanks * sizeof(HsaMemoryProperties) +
+			props[i].node.NumCaches * sizeof(HsaCacheProperties) +
+			props[i].node.NumIOLinks * sizeof(HsaIoLinkProperties);
+
+	buf = malloc(size);
+	if (!buf)
+		return;
+
+	topology_cache_init_header(&hdr, generation, sys_props);
+	hdr.size = size;
+
+	p = buf;
+	topology_cache_write(&p, &hdr, sizeof(hdr));
+	topology_cache_write(&p, map_user_to_sysfs_node_id,
+			     sys_props->NumNodes * sizeof(uint32_t));
+	for (i = 0; i < sys_props->NumNodes; i++) {
+		topology_cache_write(&p, &props[i].node, sizeof(HsaNodeProperties));
+		topology_cache_write(&p, props[i].mem,
+				     props[i].node.NumMemoryBanks * sizeof(HsaMemoryProperties));
+		topology_cache_write(&p, props[i].cache,
+				     props[i].node.NumCaches * sizeof(HsaCacheProperties));
+		topology_cache_write(&p, props[i].link,
+				     props[i].node.NumIOLinks * sizeof(HsaIoLinkProperties));
+	}
+
+	topology_cache_path(path, sizeof(path));
+	snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+	fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		pr_debug("Failed to create topology cache %s\n", tmp_path);
+		goto out;
+	}
+
+	for (done = 0; done < size; done += n) {
+		n = write(fd, buf + done, size - done);
+		if (n <= 0)
+			break;
+	}
+	close(fd);
+
+	if (done != size || rename(tmp_path, path)) {
+		pr_debug("Failed to write topology cache %s\n", path);
+		unlink(tmp_path);
+	}
+
+out:
+	free(buf);
+}
+
 HSAKMT_STATUS topology_take_snapshot(void)
 {
 	uint32_t gen_start, gen_end, i, mem_id, cache_id;
 	HsaSystemProperties sys_props;
 	node_props_t *temp_props = 0;
 	HSAKMT_STATUS ret = HSAKMT_STATUS_SUCCESS;
-	struct proc_cpuinfo *cpuinfo;
+	struct proc_cpuinfo *cpuinfo = NULL;
 	const uint32_t num_procs = get_nprocs();
 	uint32_t num_ioLinks;
 	bool p2p_links = false;
 	uint32_t num_p2pLinks = 0;
-
-	cpuinfo = calloc(num_procs, sizeof(struct proc_cpuinfo));
-	if (!cpuinfo) {
-		pr_err("Fail to allocate memory for CPU info\n");
-		return HSAKMT_STATUS_NO_MEMORY;
-	}
-	topology_parse_cpuinfo(cpuinfo, num_procs);
+	bool use_cache, from_cache;
 
 retry:
+	from_cache = false;
 	ret = topology_sysfs_get_generation(&gen_start);
 	if (ret != HSAKMT_STATUS_SUCCESS)
 		goto err;
 	ret = hsakmt_topology_sysfs_get_system_props(&sys_props);
 	if (ret != HSAKMT_STATUS_SUCCESS)
 		goto err;
+
+	use_cache = topology_cache_enabled(sys_props.NumNodes);
+	if (use_cache && topology_cache_load(gen_start, &sys_props,
+					     &temp_props) == HSAKMT_STATUS_SUCCESS) {
+		from_cache = true;
+		goto check_generation;
+	}
+
+	if (!cpuinfo) {
+		cpuinfo = calloc(num_procs, sizeof(struct proc_cpuinfo));
+		if (!cpuinfo) {
+			pr_err("Fail to allocate memory for CPU info\n");
+			return HSAKMT_STATUS_NO_MEMORY;
+		}
+		topology_parse_cpuinfo(cpuinfo, num_procs);
+	}
+
 	if (sys_props.NumNodes > 0) {
 		temp_props = calloc(sys_props.NumNodes * sizeof(node_props_t), 1);
 		if (!temp_props) {
@@ -2084,6 +2366,7 @@ retry:
 		topology_create_indirect_gpu_links(&sys_props, temp_props);
 	}
 
+check_generation:
 	ret = topology_sysfs_get_generation(&gen_end);
 	if (ret != HSAKMT_STATUS_SUCCESS) {
 		free_properties(temp_props, sys_props.NumNodes);
@@ -2096,6 +2379,9 @@ retry:
 		goto retry;
 	}
 
+	if (use_cache && !from_cache)
+		topology_cache_store(gen_end, &sys_props, temp_props);
+
 	if (!g_system) {
 		g_system = malloc(sizeof(HsaSystemProperties));
 		if (!g_system) {
@@ -2161,6 +2447,17 @@ HSAKMT_STATUS hsakmt_gpuid_to_nodeid(uint32_t gpu_id, uint32_t *node_id)
 
 }
 
+/* Set in a forked child once the apertures and doorbells inherited with the
+ * snapshot have been dropped. The snapshot itself stays valid in the child and
+ * is reused instead of walking sysfs again.
+ */
+static bool snapshot_process_state_dropped;
+
+void hsakmt_topology_clear_process_state(void)
+{
+	snapshot_process_state_dropped = true;
+}
+
 HSAKMT_STATUS HSAKMTAPI hsaKmtAcquireSystemProperties(HsaSystemProperties *SystemProperties)
 {
 	HSAKMT_STATUS err = HSAKMT_STATUS_SUCCESS;
@@ -2176,6 +2473,18 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtAcquireSystemProperties(HsaSystemProperties *Syste
 	 * would leak memory.
 	 */
 	if (g_system) {
+		if (snapshot_process_state_dropped) {
+			err = hsakmt_fmm_init_process_apertures(g_system->NumNodes);
+			if (err != HSAKMT_STATUS_SUCCESS)
+				goto out;
+
+			err = hsakmt_init_process_doorbells(g_system->NumNodes);
+			if (err != HSAKMT_STATUS_SUCCESS) {
+				hsakmt_fmm_destroy_process_apertures();
+				goto out;
+			}
+			snapshot_process_state_dropped = false;
+		}
 		*SystemProperties = *g_system;
 		goto out;
 	}
@@ -2213,8 +2522,10 @@ HSAKMT_STATUS HSAKMTAPI hsaKmtReleaseSystemProperties(void)
 	pthread_mutex_lock(&hsakmt_mutex);
 
 	hsakmt_destroy_process_doorbells();
+	hsakmt_destroy_cwsr_cache();
 	hsakmt_fmm_destroy_process_apertures();
 	topology_drop_snapshot();
+	snapshot_process_state_dropped = false;
 
 	pthread_mutex_unlock(&hsakmt_mutex);
 
@@ -0,0 +1,230 @@
+/*
+ * Copyright © 2026 Advanced Micro Devices, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including
+ * the next paragraph) shall be included in all copies or substantial
+ * portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * kmtinfo prints the system topology straight from the thunk's topology
+ * snapshot, one hsaKmtGetNode*Properties call per node and property kind.
+ * Unlike rocrinfo it does not call hsa_init, so no agents, queues, blit
+ * kernels or image support are set up and ROCR_VISIBLE_DEVICES is not applied.
+ * The snapshot is shared through the topology cache in /dev/shm, which makes
+ * it cheap enough for periodic health checks.
+ *
+ * Usage: kmtinfo [-a] [-g count]
+ *   -a        Also print memory banks, caches and IO links of every node.
+ *   -g count  Exit with status 2 unless exactly count GPU nodes are present.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <hsakmt/hsakmt.h>
+
+static const char *heap_name(HSA_HEAPTYPE type)
+{
+	switch (type) {
+	case HSA_HEAPTYPE_SYSTEM:
+		return "system";
+	case HSA_HEAPTYPE_FRAME_BUFFER_PUBLIC:
+		return "fb public";
+	case HSA_HEAPTYPE_FRAME_BUFFER_PRIVATE:
+		return "fb private";
+	case HSA_HEAPTYPE_GPU_GDS:
+		return "gds";
+	case HSA_HEAPTYPE_GPU_LDS:
+		return "lds";
+	case HSA_HEAPTYPE_GPU_SCRATCH:
+		return "scratch";
+	case HSA_HEAPTYPE_DEVICE_SVM:
+		return "svm";
+	case HSA_HEAPTYPE_MMIO_REMAP:
+		return "mmio remap";
+	default:
+		return "unknown";
+	}
+}
+
+static const char *link_name(HSA_IOLINKTYPE type)
+{
+	switch (type) {
+	case HSA_IOLINKTYPE_HYPERTRANSPORT:
+		return "hypertransport";
+	case HSA_IOLINKTYPE_PCIEXPRESS:
+		return "pcie";
+	case HSA_IOLINK_TYPE_QPI_1_1:
+		return "qpi";
+	case HSA_IOLINK_TYPE_INFINIBAND:
+		return "infiniband";
+	case HSA_IOLINK_TYPE_XGMI:
+		return "xgmi";
+	default:
+		return "other";
+	}
+}
+
+static void print_node(HSAuint32 node_id, const HsaNodeProperties *props)
+{
+	char name[HSA_PUBLIC_NAME_SIZE];
+	int i;
+
+	/* The marketing name is UTF-16, keep the ASCII part */
+	for (i = 0; i < HSA_PUBLIC_NAME_SIZE - 1 && props->MarketingName[i]; i++)
+		name[i] = (props->MarketingName[i] < 0x80) ? (char)props->MarketingName[i] : '?';
+	name[i] = '\0';
+
+	if (!props->NumFComputeCores) {
+		printf("Node %u: CPU  %s, %u cores\n", node_id, name, props->NumCPUCores);
+		return;
+	}
+
+	printf("Node %u: GPU  %s, gfx%u%x%x, gpu_id %u\n", node_id, name,
+	       props->EngineId.ui32.Major, props->EngineId.ui32.Minor,
+	       props->EngineId.ui32.Stepping, props->KFDGpuID);
+	printf("  PCI %04x:%02x:%02x.%x, device 0x%04x, uuid %016llx\n", props->Domain,
+	       (props->LocationId >> 8) & 0xFF, (props->LocationId >> 3) & 0x1F,
+	       props->LocationId & 0x7, props->DeviceId, (unsigned long long)props->UniqueID);
+	printf("  %u CUs, %u XCCs, %u SEs, wave %u, %u MHz, local memory %llu MiB\n",
+	       props->NumSIMDPerCU ? props->NumFComputeCores / props->NumSIMDPerCU : 0,
+	       props->NumXcc, props->NumShaderBanks, props->WaveFrontSize,
+	       props->MaxEngineClockMhzFCompute,
+	       (unsigned long long)(props->LocalMemSize >> 20));
+	printf("  SDMA %u + %u xgmi, hive %llx, render minor %d\n", props->NumSdmaEngines,
+	       props->NumSdmaXgmiEngines, (unsigned long long)props->HiveID,
+	       props->DrmRenderMinor);
+}
+
+static HSAKMT_STATUS print_node_details(HSAuint32 node_id, const HsaNodeProperties *props)
+{
+	HsaMemoryProperties *banks = NULL;
+	HsaCacheProperties *caches = NULL;
+	HsaIoLinkProperties *links = NULL;
+	HSAKMT_STATUS ret = HSAKMT_STATUS_NO_MEMORY;
+	HSAuint32 i;
+
+	banks = calloc(props->NumMemoryBanks + 1, sizeof(*banks));
+	caches = calloc(props->NumCaches + 1, sizeof(*caches));
+	links = calloc(props->NumIOLinks + 1, sizeof(*links));
+	if (!banks || !caches || !links)
+		goto out;
+
+	ret = hsaKmtGetNodeMemoryProperties(node_id, props->NumMemoryBanks, banks);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		goto out;
+	for (i = 0; i < props->NumMemoryBanks; i++)
+		printf("  Memory %u: %s, %llu MiB, width %u, %u MHz\n", i,
+		       heap_name(banks[i].HeapType),
+		       (unsigned long long)(banks[i].SizeInBytes >> 20),
+		       banks[i].Width, banks[i].MemoryClockMax);
+
+	ret = hsaKmtGetNodeCacheProperties(node_id,
+			props->NumFComputeCores ? props->FComputeIdLo : props->CComputeIdLo,
+			props->NumCaches, caches);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		goto out;
+	for (i = 0; i < props->NumCaches; i++)
+		printf("  Cache %u: L%u, %u KiB, line %u\n", i, caches[i].CacheLevel,
+		       caches[i].CacheSize, caches[i].CacheLineSize);
+
+	ret = hsaKmtGetNodeIoLinkProperties(node_id, props->NumIOLinks, links);
+	if (ret != HSAKMT_STATUS_SUCCESS)
+		goto out;
+	for (i = 0; i < props->NumIOLinks; i++)
+		printf("  Link %u: to node %u, %s, weight %u, %u-%u MB/s\n", i,
+		       links[i].NodeTo, link_name(links[i].IoLinkType), links[i].Weight,
+		       links[i].MinimumBandwidth, links[i].MaximumBandwidth);
+
+out:
+	free(banks);
+	free(caches);
+	free(links);
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	HsaVersionInfo version;
+	HsaSystemProperties system;
+	HsaNodeProperties props;
+	HSAKMT_STATUS ret;
+	HSAuint32 node_id, gpus = 0;
+	int details = 0, expected_gpus = -1;
+	int opt, status = 0;
+
+	while ((opt = getopt(argc, argv, "ag:")) != -1) {
+		switch (opt) {
+		case 'a':
+			details = 1;
+			break;
+		case 'g':
+			expected_gpus = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-a] [-g count]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	ret = hsaKmtOpenKFD();
+	if (ret != HSAKMT_STATUS_SUCCESS) {
+		fprintf(stderr, "hsaKmtOpenKFD failed: %d\n", ret);
+		return 1;
+	}
+
+	ret = hsaKmtGetVersion(&version);
+	if (ret == HSAKMT_STATUS_SUCCESS)
+		ret = hsaKmtAcquireSystemProperties(&system);
+	if (ret != HSAKMT_STATUS_SUCCESS) {
+		fprintf(stderr, "Topology snapshot failed: %d\n", ret);
+		hsaKmtCloseKFD();
+		return 1;
+	}
+
+	printf("KFD %u.%u, %u nodes\n", version.KernelInterfaceMajorVersion,
+	       version.KernelInterfaceMinorVersion, system.NumNodes);
+
+	for (node_id = 0; node_id < system.NumNodes; node_id++) {
+		ret = hsaKmtGetNodeProperties(node_id, &props);
+		if (ret == HSAKMT_STATUS_SUCCESS) {
+			print_node(node_id, &props);
+			if (props.NumFComputeCores)
+				gpus++;
+			if (details)
+				ret = print_node_details(node_id, &props);
+		}
+		if (ret != HSAKMT_STATUS_SUCCESS) {
+			fprintf(stderr, "Node %u query failed: %d\n", node_id, ret);
+			status = 1;
+		}
+	}
+
+	if (!status && expected_gpus >= 0 && gpus != (HSAuint32)expected_gpus) {
+		fprintf(stderr, "Found %u GPU nodes, expected %d\n", gpus, expected_gpus);
+		status = 2;
+	}
+
+	hsaKmtReleaseSystemProperties();
+	hsaKmtCloseKFD();
+	return status;
+}
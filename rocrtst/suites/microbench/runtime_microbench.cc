@@ -0,0 +1,517 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "suites/microbench/runtime_microbench.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+// Calls per measured batch.  Batches amortize the counter ioctls and clock
+// reads; calls that hold resources use smaller batches.
+static const uint32_t kFastBatch = 1000;
+static const uint32_t kAllocBatch = 64;
+static const uint32_t kCopyBatch = 16;
+
+static const size_t kAllocSizes[] = {256, 4096, 65536};
+static const size_t kCopySize = 4096;
+static const uint32_t kPointerInfoBlocks = 64;
+
+static const char* const kCounterNames[] = {"cycles", "instructions", "cache misses"};
+
+typedef std::chrono::steady_clock Clock;
+
+static double Mean(const std::vector<double>& samples) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+  return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+// Print the mean of samples right aligned in width, or "-" if not counted.
+static void PrintColumn(const std::vector<double>& samples, int width) {
+  std::cout << std::setw(width);
+  if (samples.empty()) {
+    std::cout << "-";
+  } else {
+    std::cout << Mean(samples);
+  }
+}
+
+class RuntimeMicrobench::Counters {
+ public:
+  Counters(void) : leader_(-1), user_only_(false) {
+    if (!Open(false) && (errno == EACCES || errno == EPERM)) {
+      // perf_event_paranoid may still allow user space counting.
+      user_only_ = Open(true);
+    }
+  }
+
+  ~Counters(void) { Close(); }
+
+  bool available(void) const { return leader_ >= 0; }
+  bool user_only(void) const { return user_only_; }
+  bool has(Counter kind) const {
+    for (Counter k : kinds_) {
+      if (k == kind) return true;
+    }
+    return false;
+  }
+
+  void Start(void) {
+    if (leader_ < 0) return;
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  // @Brief: Stop counting and return the counts since Start(), scaled up if
+  // the group was multiplexed.  Unopened counters read as -1.  Returns false
+  // if nothing was counted.
+  bool Stop(double counts[kNumCounters]) {
+    for (int k = 0; k < kNumCounters; k++) {
+      counts[k] = -1.0;
+    }
+    if (leader_ < 0) return false;
+    ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // PERF_FORMAT_GROUP layout: nr, time enabled, time running, values[nr]
+    uint64_t buf[3 + kNumCounters];
+    ssize_t len = read(leader_, buf, sizeof(buf));
+    if (len < static_cast<ssize_t>((3 + kinds_.size()) * sizeof(uint64_t)) ||
+        buf[0] != kinds_.size() || buf[2] == 0) {
+      return false;
+    }
+    double scale = static_cast<double>(buf[1]) / buf[2];
+    for (size_t i = 0; i < kinds_.size(); i++) {
+      counts[kinds_[i]] = buf[3 + i] * scale;
+    }
+    return true;
+  }
+
+ private:
+  bool Open(bool exclude_kernel) {
+    static const uint64_t configs[kNumCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+
+    for (int k = 0; k < kNumCounters; k++) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = configs[k];
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+      attr.disabled = (leader_ < 0) ? 1 : 0;
+      attr.exclude_kernel = exclude_kernel ? 1 : 0;
+      attr.exclude_hv = 1;
+
+      // Count the calling thread on any CPU.
+      int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0));
+      if (fd < 0) {
+        // Without cycles there is no group; other counters are optional.
+        if (leader_ < 0) return false;
+        continue;
+      }
+      if (leader_ < 0) leader_ = fd;
+      fds_.push_back(fd);
+      kinds_.push_back(static_cast<Counter>(k));
+    }
+    return true;
+  }
+
+  void Close(void) {
+    for (int fd : fds_) {
+      close(fd);
+    }
+    fds_.clear();
+    kinds_.clear();
+    leader_ = -1;
+  }
+
+  int leader_;
+  bool user_only_;
+  std::vector<int> fds_;
+  std::vector<Counter> kinds_;
+};
+
+RuntimeMicrobench::RuntimeMicrobench(void) : TestBase() {
+#ifdef ROCRTST_EMULATOR_BUILD
+  set_num_iteration(2);
+#else
+  set_num_iteration(100);
+#endif
+
+  reader_.handle = 0;
+  executable_.handle = 0;
+
+  set_kernel_file_name("dispatch_time_kernels.hsaco");
+  set_kernel_name("empty_kernel");
+
+  set_title("Runtime Hot Path Microbenchmarks");
+  set_description("This test measures the host CPU cost of single runtime "
+      "calls: hsa_signal_store, hsa_queue_add_write_index, "
+      "hsa_amd_pointer_info, hsa_amd_memory_pool_allocate of small sizes, "
+      "hsa_amd_memory_async_copy submission with the copy held back by a "
+      "dependency, and hsa_executable_get_symbol_by_name.  Wall time and, "
+      "where perf_event is permitted, cycles, instructions and cache misses "
+      "of the calling thread are reported per call.");
+}
+
+RuntimeMicrobench::~RuntimeMicrobench() {
+}
+
+void RuntimeMicrobench::SetUp() {
+  hsa_status_t err;
+
+  TestBase::SetUp();
+
+  err = SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  std::string file = rocrtst::LocateKernelFile(kernel_file_name(), *gpu_device1());
+  int fd = open(file.c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0) << "Could not open " << file;
+  err = hsa_code_object_reader_create_from_file(fd, &reader_);
+  close(fd);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = hsa_executable_create_alt(HSA_PROFILE_FULL, HSA_DEFAULT_FLOAT_ROUNDING_MODE_DEFAULT,
+                                  nullptr, &executable_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_executable_load_agent_code_object(executable_, *gpu_device1(), reader_, nullptr,
+                                              nullptr);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_executable_freeze(executable_, nullptr);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  counters_.reset(new Counters());
+}
+
+void RuntimeMicrobench::Begin(void) {
+  counters_->Start();
+  begin_ = Clock::now();
+}
+
+void RuntimeMicrobench::End(const std::string& name, uint32_t ops, uint32_t round) {
+  Clock::time_point end = Clock::now();
+  double counts[kNumCounters];
+  bool counted = counters_->Stop(counts);
+  if (round < warmup_iterations()) {
+    return;
+  }
+
+  Series* series = nullptr;
+  for (Series& s : results_) {
+    if (s.name == name) {
+      series = &s;
+      break;
+    }
+  }
+  if (series == nullptr) {
+    results_.push_back(Series());
+    series = &results_.back();
+    series->name = name;
+  }
+
+  series->ns.push_back(std::chrono::duration<double, std::nano>(end - begin_).count() / ops);
+  for (int k = 0; counted && k < kNumCounters; k++) {
+    if (counts[k] >= 0.0) {
+      series->counts[k].push_back(counts[k] / ops);
+    }
+  }
+}
+
+void RuntimeMicrobench::Run() {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+
+  RunSignalStore();
+  RunQueueWriteIndex();
+  RunPointerInfo();
+  for (size_t size : kAllocSizes) {
+    RunPoolAllocate(size);
+  }
+  RunAsyncCopySubmit();
+  RunSymbolLookup();
+}
+
+void RuntimeMicrobench::RunSignalStore(void) {
+  hsa_status_t err;
+  hsa_signal_t signal;
+  err = hsa_signal_create(0, 0, NULL, &signal);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  for (uint32_t r = 0; r < rounds(); r++) {
+    Begin();
+    for (uint32_t i = 0; i < kFastBatch; i++) {
+      hsa_signal_store_relaxed(signal, i);
+    }
+    End("hsa_signal_store_relaxed", kFastBatch, r);
+
+    Begin();
+    for (uint32_t i = 0; i < kFastBatch; i++) {
+      hsa_signal_store_screlease(signal, i);
+    }
+    End("hsa_signal_store_screlease", kFastBatch, r);
+  }
+
+  hsa_signal_destroy(signal);
+}
+
+void RuntimeMicrobench::RunQueueWriteIndex(void) {
+  hsa_status_t err;
+  hsa_queue_t* queue = nullptr;
+  err = rocrtst::CreateQueue(*gpu_device1(), &queue);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  // The doorbell is never rung, so the packet processor ignores the index.
+  for (uint32_t r = 0; r < rounds(); r++) {
+    Begin();
+    for (uint32_t i = 0; i < kFastBatch; i++) {
+      hsa_queue_add_write_index_relaxed(queue, 1);
+    }
+    End("hsa_queue_add_write_index_relaxed", kFastBatch, r);
+
+    Begin();
+    for (uint32_t i = 0; i < kFastBatch; i++) {
+      hsa_queue_add_write_index_scacq_screl(queue, 1);
+    }
+    End("hsa_queue_add_write_index_scacq_screl", kFastBatch, r);
+  }
+
+  err = hsa_queue_destroy(queue);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+}
+
+void RuntimeMicrobench::RunPointerInfo(void) {
+  hsa_status_t err;
+  std::vector<void*> blocks(kPointerInfoBlocks, nullptr);
+  for (void*& block : blocks) {
+    err = hsa_amd_memory_pool_allocate(cpu_pool(), 4096, 0, &block);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  }
+
+  // Query interior pointers so the lookup has to find the enclosing block.
+  hsa_amd_pointer_info_t info;
+  for (uint32_t r = 0; r < rounds(); r++) {
+    Begin();
+    for (uint32_t i = 0; i < kFastBatch; i++) {
+      info.size = sizeof(info);
+      err = hsa_amd_pointer_info(static_cast<char*>(blocks[i % kPointerInfoBlocks]) + 64,
+                                 &info, nullptr, nullptr, nullptr);
+      ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+    }
+    End("hsa_amd_pointer_info", kFastBatch, r);
+  }
+
+  for (void* block : blocks) {
+    hsa_amd_memory_pool_free(block);
+  }
+}
+
+void RuntimeMicrobench::RunPoolAllocate(size_t size) {
+  hsa_status_t err;
+  const std::string name = "hsa_amd_memory_pool_allocate, " + std::to_string(size) + " bytes";
+  std::vector<void*> ptrs(kAllocBatch, nullptr);
+
+  // Only allocation is measured; the batch is freed between rounds.
+  for (uint32_t r = 0; r < rounds(); r++) {
+    Begin();
+    for (void*& ptr : ptrs) {
+      err = hsa_amd_memory_pool_allocate(device_pool(), size, 0, &ptr);
+      ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+    }
+    End(name, kAllocBatch, r);
+
+    for (void*& ptr : ptrs) {
+      err = hsa_amd_memory_pool_free(ptr);
+      ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+      ptr = nullptr;
+    }
+  }
+}
+
+void RuntimeMicrobench::RunAsyncCopySubmit(void) {
+  hsa_status_t err;
+  void* src = nullptr;
+  void* dst = nullptr;
+  err = hsa_amd_memory_pool_allocate(cpu_pool(), kCopySize, 0, &src);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  err = hsa_amd_memory_pool_allocate(device_pool(), kCopySize, 0, &dst);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  err = hsa_amd_agents_allow_access(1, gpu_device1(), NULL, src);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  // Every copy waits on dep, which is released only after the batch has been
+  // submitted, so no transfer overlaps the measurement.
+  hsa_signal_t dep, done;
+  err = hsa_signal_create(1, 0, NULL, &dep);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  err = hsa_signal_create(kCopyBatch, 0, NULL, &done);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  for (uint32_t r = 0; r < rounds(); r++) {
+    hsa_signal_store_relaxed(dep, 1);
+    hsa_signal_store_relaxed(done, kCopyBatch);
+
+    Begin();
+    for (uint32_t i = 0; i < kCopyBatch; i++) {
+      err = hsa_amd_memory_async_copy(dst, *gpu_device1(), src, *cpu_device(), kCopySize, 1,
+                                      &dep, done);
+      ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+    }
+    End("hsa_amd_memory_async_copy submit", kCopyBatch, r);
+
+    hsa_signal_store_screlease(dep, 0);
+    while (hsa_signal_wait_scacquire(done, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX,
+                                     HSA_WAIT_STATE_BLOCKED) != 0) {
+    }
+  }
+
+  hsa_signal_destroy(dep);
+  hsa_signal_destroy(done);
+  hsa_amd_memory_pool_free(src);
+  hsa_amd_memory_pool_free(dst);
+}
+
+void RuntimeMicrobench::RunSymbolLookup(void) {
+  hsa_status_t err;
+  const std::string name = kernel_name() + ".kd";
+  hsa_agent_t agent = *gpu_device1();
+
+  hsa_executable_symbol_t symbol;
+  for (uint32_t r = 0; r < rounds(); r++) {
+    Begin();
+    for (uint32_t i = 0; i < kFastBatch; i++) {
+      err = hsa_executable_get_symbol_by_name(executable_, name.c_str(), &agent, &symbol);
+      ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+    }
+    End("hsa_executable_get_symbol_by_name", kFastBatch, r);
+  }
+}
+
+void RuntimeMicrobench::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void RuntimeMicrobench::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  if (counters_ == nullptr || !counters_->available()) {
+    std::cout << "Hardware counters unavailable (see /proc/sys/kernel/perf_event_paranoid), "
+                 "reporting time only" << std::endl;
+  } else if (counters_->user_only()) {
+    std::cout << "Hardware counters exclude kernel time" << std::endl;
+  }
+
+  std::cout << std::left << std::setw(48) << "Operation" << std::right << std::setw(10)
+            << "ns/op" << std::setw(12) << "cycles/op" << std::setw(12) << "instr/op"
+            << std::setw(8) << "IPC" << std::setw(14) << "misses/op" << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  for (const Series& series : results_) {
+    std::cout << std::left << std::setw(48) << series.name << std::right << std::setw(10)
+              << Mean(series.ns);
+    PrintColumn(series.counts[kCycles], 12);
+    PrintColumn(series.counts[kInstructions], 12);
+    double cycles = Mean(series.counts[kCycles]);
+    std::cout << std::setw(8);
+    if (cycles > 0.0 && !series.counts[kInstructions].empty()) {
+      std::cout << std::setprecision(2) << Mean(series.counts[kInstructions]) / cycles
+                << std::setprecision(1);
+    } else {
+      std::cout << "-";
+    }
+    PrintColumn(series.counts[kCacheMisses], 14);
+    std::cout << std::endl;
+
+    ReportMetric(series.name + " time", "ns/op", series.ns, false);
+    for (int k = 0; k < kNumCounters; k++) {
+      if (!series.counts[k].empty()) {
+        ReportMetric(series.name + " " + kCounterNames[k], kCounterNames[k] + std::string("/op"),
+                     series.counts[k], false);
+      }
+    }
+  }
+  std::cout << std::defaultfloat;
+}
+
+void RuntimeMicrobench::Close() {
+  if (executable_.handle != 0) {
+    hsa_executable_destroy(executable_);
+    executable_.handle = 0;
+  }
+  if (reader_.handle != 0) {
+    hsa_code_object_reader_destroy(reader_);
+    reader_.handle = 0;
+  }
+  TestBase::Close();
+}
@@ -0,0 +1,131 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_MICROBENCH_RUNTIME_MICROBENCH_H_
+#define ROCRTST_SUITES_MICROBENCH_RUNTIME_MICROBENCH_H_
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "common/base_rocr.h"
+#include "common/common.h"
+#include "hsa/hsa.h"
+
+// @Brief: This class is defined to measure the host CPU cost of single
+// runtime calls on hot paths: signal stores, queue write index updates,
+// pointer info queries, small pool allocations, async copy submission and
+// symbol lookup by name.  Besides wall time, the calling thread's cycles,
+// instructions and cache misses are counted with perf_event for each batch
+// of calls and reported per call, so regressions in per-call CPU cost show
+// up in --baseline comparisons.
+
+class RuntimeMicrobench : public TestBase {
+ public:
+  // @Brief: Constructor
+  RuntimeMicrobench(void);
+
+  // @Brief: Destructor
+  virtual ~RuntimeMicrobench(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  enum Counter {kCycles = 0, kInstructions, kCacheMisses, kNumCounters};
+
+  // @Brief: perf_event counter group of the calling thread
+  class Counters;
+
+  // @Brief: Per call samples of one operation, one per measured batch
+  struct Series {
+    std::string name;
+    std::vector<double> ns;
+    std::vector<double> counts[kNumCounters];
+  };
+
+  // @Brief: Start timing and counting a batch
+  void Begin(void);
+
+  // @Brief: Stop the batch started by Begin() and record it as ops calls of
+  // name, unless round is a warmup round
+  void End(const std::string& name, uint32_t ops, uint32_t round);
+
+  void RunSignalStore(void);
+  void RunQueueWriteIndex(void);
+  void RunPointerInfo(void);
+  void RunPoolAllocate(size_t size);
+  void RunAsyncCopySubmit(void);
+  void RunSymbolLookup(void);
+
+  // @Brief: Rounds run per operation, warmup rounds included
+  uint32_t rounds(void) const { return warmup_iterations() + num_iteration(); }
+
+  std::unique_ptr<Counters> counters_;
+
+  std::chrono::steady_clock::time_point begin_;
+
+  // @Brief: Executable holding kernel_name(), for symbol lookups
+  hsa_code_object_reader_t reader_;
+  hsa_executable_t executable_;
+
+  // @Brief: Measured series, in the order they were first recorded
+  std::vector<Series> results_;
+};
+
+#endif  // ROCRTST_SUITES_MICROBENCH_RUNTIME_MICROBENCH_H_
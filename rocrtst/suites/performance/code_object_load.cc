@@ -0,0 +1,321 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <string>
+
+#include "suites/performance/code_object_load.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+// Must match code_object_load_kernels.cl.
+static const uint32_t kNumKernels = 10000;
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+static std::string KernelSymbolName(uint32_t index) {
+  char name[32];
+  snprintf(name, sizeof(name), "big_%04u.kd", index);
+  return name;
+}
+
+static hsa_status_t CountSymbols(hsa_executable_t exec, hsa_agent_t agent,
+                                 hsa_executable_symbol_t symbol, void* data) {
+  (*reinterpret_cast<uint32_t*>(data))++;
+  return HSA_STATUS_SUCCESS;
+}
+
+static hsa_status_t CountAllSymbols(hsa_executable_t exec, hsa_executable_symbol_t symbol,
+                                    void* data) {
+  (*reinterpret_cast<uint32_t*>(data))++;
+  return HSA_STATUS_SUCCESS;
+}
+
+struct SameIsaGpus {
+  char name[64];
+  std::vector<hsa_agent_t>* gpus;
+};
+
+static hsa_status_t FindSameIsaGpus(hsa_agent_t agent, void* data) {
+  SameIsaGpus* search = reinterpret_cast<SameIsaGpus*>(data);
+  hsa_status_t err;
+
+  hsa_device_type_t type;
+  err = hsa_agent_get_info(agent, HSA_AGENT_INFO_DEVICE, &type);
+  if (err != HSA_STATUS_SUCCESS || type != HSA_DEVICE_TYPE_GPU) {
+    return err;
+  }
+
+  char name[64] = {0};
+  err = hsa_agent_get_info(agent, HSA_AGENT_INFO_NAME, name);
+  if (err != HSA_STATUS_SUCCESS) {
+    return err;
+  }
+  if (strcmp(name, search->name) == 0) {
+    search->gpus->push_back(agent);
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+CodeObjectLoad::CodeObjectLoad(void) : TestBase() {
+#ifdef ROCRTST_EMULATOR_BUILD
+  iterations_ = 1;
+#else
+  iterations_ = 5;
+#endif
+
+  set_kernel_file_name("code_object_load_kernels.hsaco");
+
+  set_title("Code Object Load Scaling");
+  set_description("This test loads a code object holding 10000 kernels and "
+      "measures code object reader creation, executable load per agent, "
+      "freeze, symbol lookup by name and symbol iteration, with the code "
+      "object loaded on one GPU and on all GPUs of the same ISA.");
+}
+
+CodeObjectLoad::~CodeObjectLoad() {
+}
+
+void CodeObjectLoad::SetUp() {
+  hsa_status_t err;
+
+  TestBase::SetUp();
+
+  err = SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  SameIsaGpus search;
+  memset(search.name, 0, sizeof(search.name));
+  err = hsa_agent_get_info(*gpu_device1(), HSA_AGENT_INFO_NAME, search.name);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  search.gpus = &gpus_;
+  err = hsa_iterate_agents(FindSameIsaGpus, &search);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_FALSE(gpus_.empty());
+
+  code_object_file_ = rocrtst::LocateKernelFile(kernel_file_name(), *gpu_device1());
+  std::ifstream file(code_object_file_, std::ios::binary);
+  ASSERT_TRUE(file.good()) << "Could not open " << code_object_file_;
+  code_object_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  ASSERT_FALSE(code_object_.empty());
+}
+
+void CodeObjectLoad::AddSample(const std::string& name, double seconds, uint32_t per_op) {
+  for (Series& series : results_) {
+    if (series.name == name) {
+      series.samples.push_back(seconds);
+      return;
+    }
+  }
+  Series series;
+  series.name = name;
+  series.samples.push_back(seconds);
+  series.per_op = per_op;
+  results_.push_back(series);
+}
+
+void CodeObjectLoad::RunLoad(const std::vector<hsa_agent_t>& agents) {
+  hsa_status_t err;
+  const std::string suffix = ", " + std::to_string(agents.size()) + " agent(s)";
+
+  for (uint32_t it = 0; it < iterations_; it++) {
+    Clock::time_point start = Clock::now();
+    int fd = open(code_object_file_.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    hsa_code_object_reader_t file_reader;
+    err = hsa_code_object_reader_create_from_file(fd, &file_reader);
+    Clock::time_point end = Clock::now();
+    close(fd);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    AddSample("Reader create from file" + suffix, Seconds(start, end), 1);
+    err = hsa_code_object_reader_destroy(file_reader);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    start = Clock::now();
+    hsa_code_object_reader_t reader;
+    err = hsa_code_object_reader_create_from_memory(&code_object_[0], code_object_.size(),
+                                                    &reader);
+    end = Clock::now();
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    AddSample("Reader create from memory" + suffix, Seconds(start, end), 1);
+
+    hsa_executable_t exec;
+    err = hsa_executable_create_alt(HSA_PROFILE_FULL, HSA_DEFAULT_FLOAT_ROUNDING_MODE_DEFAULT,
+                                    nullptr, &exec);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    start = Clock::now();
+    for (hsa_agent_t agent : agents) {
+      err = hsa_executable_load_agent_code_object(exec, agent, reader, nullptr, nullptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    end = Clock::now();
+    AddSample("Load, per agent" + suffix, Seconds(start, end) / agents.size(), 1);
+
+    start = Clock::now();
+    err = hsa_executable_freeze(exec, nullptr);
+    end = Clock::now();
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    AddSample("Freeze" + suffix, Seconds(start, end), 1);
+
+    // Names are built before timing so only the lookup is measured.
+    std::vector<std::string> names;
+    names.reserve(kNumKernels);
+    for (uint32_t k = 0; k < kNumKernels; k++) {
+      names.push_back(KernelSymbolName(k));
+    }
+
+    start = Clock::now();
+    for (hsa_agent_t agent : agents) {
+      for (const std::string& name : names) {
+        hsa_executable_symbol_t symbol;
+        err = hsa_executable_get_symbol_by_name(exec, name.c_str(), &agent, &symbol);
+        ASSERT_EQ(HSA_STATUS_SUCCESS, err) << name;
+      }
+    }
+    end = Clock::now();
+    AddSample("Symbol lookup by name" + suffix, Seconds(start, end),
+              kNumKernels * agents.size());
+
+    uint32_t count = 0;
+    start = Clock::now();
+    for (hsa_agent_t agent : agents) {
+      err = hsa_executable_iterate_agent_symbols(exec, agent, CountSymbols, &count);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    end = Clock::now();
+    ASSERT_GE(count, kNumKernels * agents.size());
+    AddSample("Iterate agent symbols" + suffix, Seconds(start, end), count);
+
+    count = 0;
+    start = Clock::now();
+    err = hsa_executable_iterate_symbols(exec, CountAllSymbols, &count);
+    end = Clock::now();
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    AddSample("hsa_executable_iterate_symbols" + suffix, Seconds(start, end), count);
+
+    start = Clock::now();
+    err = hsa_executable_destroy(exec);
+    end = Clock::now();
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    AddSample("Executable destroy" + suffix, Seconds(start, end), 1);
+
+    err = hsa_code_object_reader_destroy(reader);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+}
+
+void CodeObjectLoad::Run(void) {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+
+  RunLoad(std::vector<hsa_agent_t>(1, *gpu_device1()));
+  if (gpus_.size() > 1) {
+    RunLoad(gpus_);
+  }
+}
+
+void CodeObjectLoad::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void CodeObjectLoad::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << "Code object: " << code_object_file_ << ", " << code_object_.size()
+            << " bytes, " << kNumKernels << " kernels" << std::endl;
+  std::cout << std::left << std::setw(48) << "Step" << std::right
+            << std::setw(12) << "mean(ms)" << std::setw(12) << "min(ms)"
+            << std::setw(14) << "mean(uS/op)" << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  for (const Series& series : results_) {
+    double sum = std::accumulate(series.samples.begin(), series.samples.end(), 0.0);
+    double mean = sum / series.samples.size();
+    double min = *std::min_element(series.samples.begin(), series.samples.end());
+    std::cout << std::left << std::setw(48) << series.name << std::right
+              << std::setw(12) << mean * 1000.0 << std::setw(12) << min * 1000.0;
+    if (series.per_op > 1) {
+      std::cout << std::setw(14) << mean * 1000000.0 / series.per_op;
+    }
+    std::cout << std::endl;
+
+    std::vector<double> ms;
+    for (double s : series.samples) {
+      ms.push_back(s * 1000.0);
+    }
+    ReportMetric(series.name, "ms", ms, false);
+  }
+  std::cout << std::defaultfloat;
+}
+
+void CodeObjectLoad::Close() {
+  TestBase::Close();
+}
@@ -0,0 +1,116 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_CODE_OBJECT_LOAD_H_
+#define ROCRTST_SUITES_PERFORMANCE_CODE_OBJECT_LOAD_H_
+#include <string>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "common/base_rocr.h"
+#include "common/common.h"
+#include "hsa/hsa.h"
+
+// @Brief: This class is defined to measure code object loading at scale
+// using a code object with 10000 kernels: reader creation, load per agent,
+// freeze, symbol lookup by name and symbol iteration, on one agent and on
+// every GPU of the same ISA.
+
+class CodeObjectLoad : public TestBase {
+ public:
+  // @Brief: Constructor
+  CodeObjectLoad(void);
+
+  // @Brief: Destructor
+  virtual ~CodeObjectLoad(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: Durations of one step across iterations, in seconds, divided
+  // by per_op to report per operation cost
+  struct Series {
+    std::string name;
+    std::vector<double> samples;
+    uint32_t per_op;
+  };
+
+  // @Brief: Load, freeze, look up and iterate with the code object loaded
+  // on each of agents
+  void RunLoad(const std::vector<hsa_agent_t>& agents);
+
+  // @Brief: Add a sample to the series called name, creating it if needed
+  void AddSample(const std::string& name, double seconds, uint32_t per_op);
+
+  // @Brief: Number of times each measurement is repeated
+  uint32_t iterations_;
+
+  // @Brief: GPUs with the same ISA as gpu_device1
+  std::vector<hsa_agent_t> gpus_;
+
+  // @Brief: Code object file contents
+  std::vector<char> code_object_;
+
+  // @Brief: Path of the code object file
+  std::string code_object_file_;
+
+  // @Brief: Series in the order first seen
+  std::vector<Series> results_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_CODE_OBJECT_LOAD_H_
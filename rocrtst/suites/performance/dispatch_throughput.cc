@@ -0,0 +1,370 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "suites/performance/dispatch_throughput.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+// Batches a producer keeps in flight before waiting for the oldest.
+static const uint32_t kBatchesInFlight = 4;
+
+static const uint32_t kQueueSize = 4096;
+
+static const uint32_t kProducerCounts[] = {1, 2, 4, 8};
+static const uint32_t kQueueCounts[] = {1, 4};
+static const uint32_t kBatchSizes[] = {1, 16, 64};
+
+typedef std::chrono::steady_clock Clock;
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  size_t idx = static_cast<size_t>(p * sorted.size());
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+DispatchThroughput::DispatchThroughput(bool interruptSignals) : TestBase(),
+                                         interrupt_signals_(interruptSignals) {
+#ifdef ROCRTST_EMULATOR_BUILD
+  packets_per_producer_ = 64;
+#else
+  packets_per_producer_ = 16384;
+#endif
+
+  memset(&aql(), 0, sizeof(hsa_kernel_dispatch_packet_t));
+
+  set_kernel_file_name("dispatch_time_kernels.hsaco");
+  set_kernel_name("empty_kernel");
+
+  std::string name = "Dispatch Throughput";
+  std::string desc = "This test measures sustained dispatch throughput of "
+      "empty kernels while sweeping producer threads, queue count, packets "
+      "per doorbell and trailing barrier-AND packets. It reports packets/s "
+      "and p50/p99/p999 latency from doorbell to batch completion as JSON. ";
+
+  if (interruptSignals) {
+    name += ", Interrupt Signals";
+    desc += "Completion signals are interrupt signals.";
+  } else {
+    name += ", Default Signals";
+    desc += "Completion signals are default (polled) signals.";
+  }
+
+  set_title(name);
+  set_description(desc);
+}
+
+DispatchThroughput::~DispatchThroughput() {
+}
+
+void DispatchThroughput::SetUp() {
+  hsa_status_t err;
+
+  // Interrupt signals are only created while interrupts are enabled.
+  set_enable_interrupt(true);
+
+  TestBase::SetUp();
+
+  err = SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_agent_t* gpu_dev = gpu_device1();
+
+  uint32_t max_queues = 0;
+  err = hsa_agent_get_info(*gpu_dev, HSA_AGENT_INFO_QUEUES_MAX, &max_queues);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  uint32_t num_queues = *std::max_element(std::begin(kQueueCounts),
+                                          std::end(kQueueCounts));
+  num_queues = std::min(num_queues, max_queues);
+  for (uint32_t i = 0; i < num_queues; i++) {
+    hsa_queue_t* q = nullptr;
+    err = rocrtst::CreateQueue(*gpu_dev, &q, kQueueSize);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+    ASSERT_NE(q, nullptr);
+    queues_.push_back(q);
+  }
+  set_main_queue(queues_[0]);
+
+  err = rocrtst::LoadKernelFromObjFile(this, gpu_dev);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  // Fill up the kernel packet except header
+  err = rocrtst::InitializeAQLPacket(this, &aql());
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  aql().workgroup_size_x = 1;
+  aql().grid_size_x = 1;
+  aql().completion_signal.handle = 0;
+}
+
+hsa_status_t DispatchThroughput::CreateSignal(hsa_signal_t* signal) {
+  if (interrupt_signals_) {
+    return hsa_signal_create(0, 0, NULL, signal);
+  }
+  return hsa_amd_signal_create(0, 0, NULL, HSA_AMD_SIGNAL_AMD_GPU_ONLY,
+                               signal);
+}
+
+void DispatchThroughput::Run() {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+
+  for (uint32_t producers : kProducerCounts) {
+    for (uint32_t queues : kQueueCounts) {
+      // Extra queues would sit idle.
+      if (queues > producers || queues > queues_.size()) {
+        continue;
+      }
+      for (uint32_t batch : kBatchSizes) {
+        for (int barrier = 0; barrier < 2; barrier++) {
+          Config config = {producers, queues, batch, barrier != 0};
+          Result result;
+          RunConfig(config, &result);
+          results_.push_back(result);
+
+          if (verbosity() >= VERBOSE_PROGRESS) {
+            std::cout << ".";
+            fflush(stdout);
+          }
+        }
+      }
+    }
+  }
+
+  if (verbosity() >= VERBOSE_PROGRESS) {
+    std::cout << std::endl;
+  }
+}
+
+void DispatchThroughput::RunConfig(const Config& config, Result* result) {
+  std::vector<std::vector<double>> latency(config.producers);
+  std::vector<std::thread> threads;
+
+  Clock::time_point start = Clock::now();
+  for (uint32_t i = 0; i < config.producers; i++) {
+    threads.push_back(std::thread(&DispatchThroughput::Produce, this,
+                                  queues_[i % config.queues], config,
+                                  &latency[i]));
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  double elapsed =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<double> all;
+  for (const std::vector<double>& l : latency) {
+    all.insert(all.end(), l.begin(), l.end());
+  }
+  std::sort(all.begin(), all.end());
+
+  result->config = config;
+  result->packets = static_cast<uint64_t>(config.producers) *
+                    (packets_per_producer_ / config.batch) *
+                    (config.batch + (config.barrier ? 1 : 0));
+  result->packets_per_sec = result->packets / elapsed;
+  result->p50 = Percentile(all, 0.50);
+  result->p99 = Percentile(all, 0.99);
+  result->p999 = Percentile(all, 0.999);
+}
+
+void DispatchThroughput::Produce(hsa_queue_t* queue, const Config& config,
+                                 std::vector<double>* latency) {
+  hsa_status_t err;
+  hsa_signal_t signals[kBatchesInFlight];
+  Clock::time_point submitted[kBatchesInFlight];
+
+  for (uint32_t i = 0; i < kBatchesInFlight; i++) {
+    err = CreateSignal(&signals[i]);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  }
+
+  const uint32_t queue_mask = queue->size - 1;
+  hsa_kernel_dispatch_packet_t* q_base_addr =
+      reinterpret_cast<hsa_kernel_dispatch_packet_t*>(queue->base_address);
+  const uint32_t batches = packets_per_producer_ / config.batch;
+  const uint32_t count = config.batch + (config.barrier ? 1 : 0);
+
+  const uint16_t kernel_header =
+      HSA_PACKET_TYPE_KERNEL_DISPATCH << HSA_PACKET_HEADER_TYPE;
+  const uint16_t signal_header = kernel_header |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+  const uint16_t barrier_header =
+      (HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE) |
+      (1 << HSA_PACKET_HEADER_BARRIER) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+
+  hsa_kernel_dispatch_packet_t packet = aql();
+
+  for (uint32_t b = 0; b < batches + kBatchesInFlight; b++) {
+    uint32_t slot = b % kBatchesInFlight;
+
+    if (b >= kBatchesInFlight) {
+      while (hsa_signal_wait_scacquire(signals[slot], HSA_SIGNAL_CONDITION_EQ,
+                   0, UINT64_MAX, HSA_WAIT_STATE_BLOCKED) != 0) {
+      }
+      latency->push_back(std::chrono::duration<double>(
+                             Clock::now() - submitted[slot]).count());
+    }
+
+    if (b >= batches) {
+      continue;
+    }
+
+    hsa_signal_store_relaxed(signals[slot], 1);
+
+    uint64_t index = hsa_queue_add_write_index_scacq_screl(queue, count);
+
+    // Wait for the packet processor to free the slots.
+    while (index + count - hsa_queue_load_read_index_scacquire(queue) >
+           queue->size) {
+    }
+
+    for (uint32_t j = 0; j < config.batch; j++) {
+      bool signals_batch = !config.barrier && (j == config.batch - 1);
+      packet.completion_signal.handle = signals_batch ? signals[slot].handle : 0;
+      rocrtst::WriteAQLToQueueLoc(queue, index + j, &packet);
+    }
+
+    if (config.barrier) {
+      hsa_barrier_and_packet_t* barrier =
+          reinterpret_cast<hsa_barrier_and_packet_t*>(
+              &q_base_addr[(index + config.batch) & queue_mask]);
+      memset(reinterpret_cast<uint8_t*>(barrier) + sizeof(uint32_t), 0,
+             sizeof(*barrier) - sizeof(uint32_t));
+      barrier->completion_signal = signals[slot];
+    }
+
+    // Publish the batch back to front so the packet processor never stops
+    // inside it.
+    for (uint32_t j = count; j-- > 0;) {
+      uint16_t header;
+      uint16_t setup;
+      if (j == config.batch) {
+        header = barrier_header;
+        setup = 0;
+      } else {
+        bool signals_batch = !config.barrier && (j == config.batch - 1);
+        header = signals_batch ? signal_header : kernel_header;
+        setup = aql().setup;
+      }
+      rocrtst::AtomicSetPacketHeader(header, setup,
+                                     &q_base_addr[(index + j) & queue_mask]);
+    }
+
+    submitted[slot] = Clock::now();
+    hsa_signal_store_screlease(queue->doorbell_signal, index + count - 1);
+  }
+
+  for (uint32_t i = 0; i < kBatchesInFlight; i++) {
+    hsa_signal_destroy(signals[i]);
+  }
+}
+
+void DispatchThroughput::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void DispatchThroughput::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << "{\"test\": \"dispatch_throughput\", \"signal\": \""
+            << (interrupt_signals_ ? "interrupt" : "default")
+            << "\", \"results\": [" << std::endl;
+  for (size_t i = 0; i < results_.size(); i++) {
+    const Result& r = results_[i];
+    std::cout << "  {\"producers\": " << r.config.producers
+              << ", \"queues\": " << r.config.queues
+              << ", \"batch\": " << r.config.batch
+              << ", \"barrier\": " << (r.config.barrier ? "true" : "false")
+              << ", \"packets\": " << r.packets
+              << ", \"packets_per_sec\": " << r.packets_per_sec
+              << ", \"latency_us\": {\"p50\": " << r.p50 * 1e6
+              << ", \"p99\": " << r.p99 * 1e6
+              << ", \"p999\": " << r.p999 * 1e6 << "}}"
+              << ((i + 1 < results_.size()) ? "," : "") << std::endl;
+  }
+  std::cout << "]}" << std::endl;
+
+  for (const Result& r : results_) {
+    std::string name = std::to_string(r.config.producers) + " producers, " +
+        std::to_string(r.config.queues) + " queues, batch " +
+        std::to_string(r.config.batch) + (r.config.barrier ? ", barrier" : "");
+    ReportMetric(name + " throughput", "packets/s", r.packets_per_sec, true);
+    ReportMetric(name + " p50 latency", "uS", r.p50 * 1e6, false);
+  }
+  return;
+}
+
+void DispatchThroughput::Close() {
+  // main_queue() is destroyed by the base class.
+  for (size_t i = 1; i < queues_.size(); i++) {
+    hsa_queue_destroy(queues_[i]);
+  }
+  queues_.clear();
+
+  TestBase::Close();
+  return;
+}
@@ -0,0 +1,126 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_DISPATCH_THROUGHPUT_H_
+#define ROCRTST_SUITES_PERFORMANCE_DISPATCH_THROUGHPUT_H_
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "common/base_rocr.h"
+#include "common/common.h"
+#include "hsa/hsa.h"
+
+// @Brief: This class is defined to measure sustained dispatch throughput of
+// empty kernels from several producer threads, sweeping producers, queues,
+// packets per doorbell and trailing barrier packets.  Results are printed as
+// JSON so runs can be compared across runtime changes.
+
+class DispatchThroughput : public TestBase {
+ public:
+  // @Brief: Constructor
+  explicit DispatchThroughput(bool interruptSignals);
+
+  // @Brief: Destructor
+  virtual ~DispatchThroughput(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: One point of the sweep
+  struct Config {
+    uint32_t producers;
+    uint32_t queues;
+    uint32_t batch;
+    bool barrier;
+  };
+
+  // @Brief: Measurements of one sweep point, latencies in seconds
+  struct Result {
+    Config config;
+    uint64_t packets;
+    double packets_per_sec;
+    double p50;
+    double p99;
+    double p999;
+  };
+
+  // @Brief: Run one sweep point
+  void RunConfig(const Config& config, Result* result);
+
+  // @Brief: Producer thread body, submits batches to queue and records the
+  // time from doorbell to completion of each batch
+  void Produce(hsa_queue_t* queue, const Config& config,
+               std::vector<double>* latency);
+
+  // @Brief: Create a completion signal of the type under test
+  hsa_status_t CreateSignal(hsa_signal_t* signal);
+
+  // @Brief: Use interrupt signals rather than default (polled) signals
+  bool interrupt_signals_;
+
+  // @Brief: Queues shared by the producers
+  std::vector<hsa_queue_t*> queues_;
+
+  // @Brief: Kernel packets each producer submits per sweep point
+  uint32_t packets_per_producer_;
+
+  // @Brief: Measured sweep points
+  std::vector<Result> results_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_DISPATCH_THROUGHPUT_H_
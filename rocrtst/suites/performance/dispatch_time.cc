@@ -166,7 +166,7 @@ void DispatchTime::Run() {
 }
 
 size_t DispatchTime::RealIterationNum() {
-  return num_iteration() * 1.2 + 1;
+  return num_iteration() * 1.2 + warmup_iterations();
 }
 
 void DispatchTime::RunSingle() {
@@ -226,13 +226,14 @@ void DispatchTime::RunSingle() {
     std::cout << std::endl;
   }
 
-  // Abandon the first result and after sort, delete the last 2% value
-  timer.erase(timer.begin());
+  // Abandon the warmup results and after sort, delete the last 2% value
+  timer.erase(timer.begin(), timer.begin() + std::min<size_t>(warmup_iterations(), timer.size()));
   std::sort(timer.begin(), timer.end());
 
-  timer.erase(timer.begin() + num_iteration(), timer.end());
+  timer.erase(timer.begin() + std::min<size_t>(num_iteration(), timer.size()), timer.end());
 
   dispatch_time_mean_ = rocrtst::CalcMean(timer);
+  samples_ = timer;
 
   return;
 }
@@ -316,13 +317,14 @@ void DispatchTime::RunMulti() {
 
   std::cout << std::endl;
 
-  // Abandon the first result and after sort, delete the last 2% value
-  timer.erase(timer.begin());
+  // Abandon the warmup results and after sort, delete the last 2% value
+  timer.erase(timer.begin(), timer.begin() + std::min<size_t>(warmup_iterations(), timer.size()));
   std::sort(timer.begin(), timer.end());
 
-  timer.erase(timer.begin() + num_iteration(), timer.end());
+  timer.erase(timer.begin() + std::min<size_t>(num_iteration(), timer.size()), timer.end());
 
   dispatch_time_mean_ = rocrtst::CalcMean(timer);
+  samples_ = timer;
 
   return;
 }
@@ -346,6 +348,12 @@ void DispatchTime::DisplayResults(void) const {
   }
 
   std::cout << " uS" << std::endl;
+
+  std::vector<double> per_dispatch;
+  for (double t : samples_) {
+    per_dispatch.push_back(t * 1e6 / (launch_single_ ? 1 : num_batch_));
+  }
+  ReportMetric("time to completion", "uS", per_dispatch, false);
   return;
 }
 
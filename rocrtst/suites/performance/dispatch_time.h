@@ -103,6 +103,9 @@ class DispatchTime : public TestBase {
   // @Brief: Ave. dispatch time
   double dispatch_time_mean_;
 
+  // @Brief: Kept samples, in seconds per batch
+  std::vector<double> samples_;
+
   char* orig_iterrupt_env_;
 };
 
@@ -0,0 +1,468 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "suites/performance/image_perf.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+#include "hsa/hsa_ext_image.h"
+
+// Square 2D images of this edge, in pixels, for bandwidth and rate tests.
+static const size_t kTransferEdge = 2048;
+static const size_t kCreateEdge = 1024;
+static const size_t kMaxPixelBytes = 16;
+
+struct Format {
+  const char* name;
+  hsa_ext_image_format_t format;
+  size_t pixel_bytes;
+};
+
+static const Format kFormats[] = {
+    {"R8 unorm", {HSA_EXT_IMAGE_CHANNEL_TYPE_UNORM_INT8, HSA_EXT_IMAGE_CHANNEL_ORDER_R}, 1},
+    {"RGBA8 unorm", {HSA_EXT_IMAGE_CHANNEL_TYPE_UNORM_INT8, HSA_EXT_IMAGE_CHANNEL_ORDER_RGBA}, 4},
+    {"R32 uint", {HSA_EXT_IMAGE_CHANNEL_TYPE_UNSIGNED_INT32, HSA_EXT_IMAGE_CHANNEL_ORDER_R}, 4},
+    {"RGBA16 half", {HSA_EXT_IMAGE_CHANNEL_TYPE_HALF_FLOAT, HSA_EXT_IMAGE_CHANNEL_ORDER_RGBA}, 8},
+    {"RGBA32 float", {HSA_EXT_IMAGE_CHANNEL_TYPE_FLOAT, HSA_EXT_IMAGE_CHANNEL_ORDER_RGBA}, 16},
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+static hsa_ext_image_descriptor_t Descriptor2D(size_t edge, const hsa_ext_image_format_t& format) {
+  hsa_ext_image_descriptor_t desc;
+  memset(&desc, 0, sizeof(desc));
+  desc.geometry = HSA_EXT_IMAGE_GEOMETRY_2D;
+  desc.width = edge;
+  desc.height = edge;
+  desc.format = format;
+  return desc;
+}
+
+static hsa_status_t CollectGpus(hsa_agent_t agent, void* data) {
+  std::vector<hsa_agent_t>* gpus = reinterpret_cast<std::vector<hsa_agent_t>*>(data);
+  hsa_device_type_t type;
+  hsa_status_t err = hsa_agent_get_info(agent, HSA_AGENT_INFO_DEVICE, &type);
+  if (err == HSA_STATUS_SUCCESS && type == HSA_DEVICE_TYPE_GPU) {
+    gpus->push_back(agent);
+  }
+  return err;
+}
+
+ImagePerf::ImagePerf(void) : TestBase(), unsupported_(false), host_buf_(nullptr) {
+#ifdef ROCRTST_EMULATOR_BUILD
+  iterations_ = 2;
+#else
+  iterations_ = 100;
+#endif
+
+  set_title("Image Extension Performance");
+  set_description("On one GPU of each ISA, this test measures the first use "
+      "latency of image creation, import, export and copy, image "
+      "create/destroy rate per format, import and export bandwidth for "
+      "linear and opaque (tiled) layouts and image copy bandwidth.");
+}
+
+ImagePerf::~ImagePerf() {
+}
+
+void ImagePerf::SetUp() {
+  hsa_status_t err;
+
+  TestBase::SetUp();
+
+  err = SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  bool supported = false;
+  err = hsa_system_extension_supported(HSA_EXTENSION_IMAGES, 1, 0, &supported);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  if (!supported) {
+    unsupported_ = true;
+    return;
+  }
+
+  std::vector<hsa_agent_t> agents;
+  err = hsa_iterate_agents(CollectGpus, &agents);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  for (hsa_agent_t agent : agents) {
+    char name[64] = {0};
+    err = hsa_agent_get_info(agent, HSA_AGENT_INFO_NAME, name);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    bool seen = false;
+    for (const Gpu& gpu : gpus_) {
+      seen |= (gpu.name == name);
+    }
+    if (seen) {
+      continue;
+    }
+
+    Gpu gpu;
+    gpu.agent = agent;
+    gpu.name = name;
+    gpu.pool.handle = 0;
+    err = hsa_amd_agent_iterate_memory_pools(agent, rocrtst::FindStandardPool, &gpu.pool);
+    ASSERT_EQ(HSA_STATUS_INFO_BREAK, err);
+    gpus_.push_back(gpu);
+  }
+
+  const size_t host_size = kTransferEdge * kTransferEdge * kMaxPixelBytes;
+  err = hsa_amd_memory_pool_allocate(cpu_pool(), host_size, 0, &host_buf_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  memset(host_buf_, 0x5a, host_size);
+
+  std::vector<hsa_agent_t> access;
+  for (const Gpu& gpu : gpus_) {
+    access.push_back(gpu.agent);
+  }
+  err = hsa_amd_agents_allow_access(access.size(), &access[0], nullptr, host_buf_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void ImagePerf::AddRow(const Gpu& gpu, const std::string& name, double value,
+                       const std::string& unit) {
+  Row row;
+  row.agent = gpu.name;
+  row.name = name;
+  row.value = value;
+  row.unit = unit;
+  results_.push_back(row);
+}
+
+bool ImagePerf::CreateImage(const Gpu& gpu, const hsa_ext_image_descriptor_t& desc,
+                            hsa_ext_image_data_layout_t layout, size_t row_pitch,
+                            hsa_ext_image_t* image, void** data) {
+  hsa_status_t err;
+  hsa_ext_image_data_info_t info;
+
+  uint32_t caps = 0;
+  if (layout == HSA_EXT_IMAGE_DATA_LAYOUT_LINEAR) {
+    err = hsa_ext_image_get_capability_with_layout(gpu.agent, desc.geometry, &desc.format,
+                                                   layout, &caps);
+  } else {
+    err = hsa_ext_image_get_capability(gpu.agent, desc.geometry, &desc.format, &caps);
+  }
+  if (err != HSA_STATUS_SUCCESS || (caps & HSA_EXT_IMAGE_CAPABILITY_READ_WRITE) == 0) {
+    return false;
+  }
+
+  if (layout == HSA_EXT_IMAGE_DATA_LAYOUT_LINEAR) {
+    err = hsa_ext_image_data_get_info_with_layout(gpu.agent, &desc, HSA_ACCESS_PERMISSION_RW,
+                                                  layout, row_pitch, 0, &info);
+  } else {
+    err = hsa_ext_image_data_get_info(gpu.agent, &desc, HSA_ACCESS_PERMISSION_RW, &info);
+  }
+  EXPECT_EQ(HSA_STATUS_SUCCESS, err);
+  if (err != HSA_STATUS_SUCCESS) {
+    return false;
+  }
+
+  // Pool allocations are page aligned, which covers image alignment.
+  err = hsa_amd_memory_pool_allocate(gpu.pool, info.size, 0, data);
+  EXPECT_EQ(HSA_STATUS_SUCCESS, err);
+  if (err != HSA_STATUS_SUCCESS) {
+    return false;
+  }
+
+  if (layout == HSA_EXT_IMAGE_DATA_LAYOUT_LINEAR) {
+    err = hsa_ext_image_create_with_layout(gpu.agent, &desc, *data, HSA_ACCESS_PERMISSION_RW,
+                                           layout, row_pitch, 0, image);
+  } else {
+    err = hsa_ext_image_create(gpu.agent, &desc, *data, HSA_ACCESS_PERMISSION_RW, image);
+  }
+  EXPECT_EQ(HSA_STATUS_SUCCESS, err);
+  if (err != HSA_STATUS_SUCCESS) {
+    hsa_amd_memory_pool_free(*data);
+    return false;
+  }
+  return true;
+}
+
+void ImagePerf::DestroyImage(const Gpu& gpu, hsa_ext_image_t image, void* data) {
+  EXPECT_EQ(HSA_STATUS_SUCCESS, hsa_ext_image_destroy(gpu.agent, image));
+  EXPECT_EQ(HSA_STATUS_SUCCESS, hsa_amd_memory_pool_free(data));
+}
+
+void ImagePerf::Run(void) {
+  if (!rocrtst::CheckProfile(this) || unsupported_) {
+    return;
+  }
+
+  TestBase::Run();
+
+  for (const Gpu& gpu : gpus_) {
+    RunFirstUse(gpu);
+    RunCreateRate(gpu);
+    RunTransfer(gpu, HSA_EXT_IMAGE_DATA_LAYOUT_LINEAR);
+    RunTransfer(gpu, HSA_EXT_IMAGE_DATA_LAYOUT_OPAQUE);
+    RunCopy(gpu);
+  }
+}
+
+void ImagePerf::RunFirstUse(const Gpu& gpu) {
+  hsa_status_t err;
+  const Format& fmt = kFormats[1];
+  hsa_ext_image_descriptor_t desc = Descriptor2D(64, fmt.format);
+  hsa_ext_image_data_info_t info;
+  err = hsa_ext_image_data_get_info(gpu.agent, &desc, HSA_ACCESS_PERMISSION_RW, &info);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  void* data[2];
+  for (void*& d : data) {
+    err = hsa_amd_memory_pool_allocate(gpu.pool, info.size, 0, &d);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+
+  // The first call of each kind on an agent includes the lazy setup of the
+  // agent's image manager and image blit kernels.
+  hsa_ext_image_t image[2];
+  for (int pass = 0; pass < 2; pass++) {
+    const std::string which = (pass == 0) ? "First " : "Second ";
+
+    Clock::time_point start = Clock::now();
+    err = hsa_ext_image_create(gpu.agent, &desc, data[0], HSA_ACCESS_PERMISSION_RW, &image[0]);
+    AddRow(gpu, which + "image create", Seconds(start, Clock::now()) * 1e6, "uS");
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    err = hsa_ext_image_create(gpu.agent, &desc, data[1], HSA_ACCESS_PERMISSION_RW, &image[1]);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    hsa_ext_image_region_t region;
+    memset(&region, 0, sizeof(region));
+    region.range = {static_cast<uint32_t>(desc.width), static_cast<uint32_t>(desc.height), 1};
+
+    start = Clock::now();
+    err = hsa_ext_image_import(gpu.agent, host_buf_, 0, 0, image[0], &region);
+    AddRow(gpu, which + "image import", Seconds(start, Clock::now()) * 1e6, "uS");
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    start = Clock::now();
+    err = hsa_ext_image_copy(gpu.agent, image[0], &region.offset, image[1], &region.offset,
+                             &region.range);
+    AddRow(gpu, which + "image copy", Seconds(start, Clock::now()) * 1e6, "uS");
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    start = Clock::now();
+    err = hsa_ext_image_export(gpu.agent, image[1], host_buf_, 0, 0, &region);
+    AddRow(gpu, which + "image export", Seconds(start, Clock::now()) * 1e6, "uS");
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    for (hsa_ext_image_t& img : image) {
+      err = hsa_ext_image_destroy(gpu.agent, img);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+  }
+
+  for (void* d : data) {
+    hsa_amd_memory_pool_free(d);
+  }
+}
+
+void ImagePerf::RunCreateRate(const Gpu& gpu) {
+  hsa_status_t err;
+
+  for (const Format& fmt : kFormats) {
+    hsa_ext_image_descriptor_t desc = Descriptor2D(kCreateEdge, fmt.format);
+
+    uint32_t caps = 0;
+    err = hsa_ext_image_get_capability(gpu.agent, desc.geometry, &desc.format, &caps);
+    if (err != HSA_STATUS_SUCCESS || caps == HSA_EXT_IMAGE_CAPABILITY_NOT_SUPPORTED) {
+      continue;
+    }
+
+    hsa_ext_image_data_info_t info;
+    err = hsa_ext_image_data_get_info(gpu.agent, &desc, HSA_ACCESS_PERMISSION_RW, &info);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    void* data;
+    err = hsa_amd_memory_pool_allocate(gpu.pool, info.size, 0, &data);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < iterations_; i++) {
+      hsa_ext_image_t image;
+      err = hsa_ext_image_create(gpu.agent, &desc, data, HSA_ACCESS_PERMISSION_RW, &image);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      err = hsa_ext_image_destroy(gpu.agent, image);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    double elapsed = Seconds(start, Clock::now());
+    AddRow(gpu, std::string("Create/destroy, ") + fmt.name, iterations_ / elapsed, "pairs/s");
+
+    hsa_amd_memory_pool_free(data);
+  }
+}
+
+void ImagePerf::RunTransfer(const Gpu& gpu, hsa_ext_image_data_layout_t layout) {
+  hsa_status_t err;
+  const std::string layout_name =
+      (layout == HSA_EXT_IMAGE_DATA_LAYOUT_LINEAR) ? "linear" : "opaque";
+  const uint32_t passes = std::max<uint32_t>(iterations_ / 10, 1);
+
+  for (const Format& fmt : kFormats) {
+    hsa_ext_image_descriptor_t desc = Descriptor2D(kTransferEdge, fmt.format);
+    hsa_ext_image_t image;
+    void* data;
+    if (!CreateImage(gpu, desc, layout, desc.width * fmt.pixel_bytes, &image, &data)) {
+      continue;
+    }
+
+    hsa_ext_image_region_t region;
+    memset(&region, 0, sizeof(region));
+    region.range = {static_cast<uint32_t>(desc.width), static_cast<uint32_t>(desc.height), 1};
+    const double bytes = static_cast<double>(desc.width * desc.height * fmt.pixel_bytes);
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < passes; i++) {
+      err = hsa_ext_image_import(gpu.agent, host_buf_, 0, 0, image, &region);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    double elapsed = Seconds(start, Clock::now());
+    AddRow(gpu, "Import " + layout_name + ", " + fmt.name, bytes * passes / elapsed / 1e9,
+           "GB/s");
+
+    start = Clock::now();
+    for (uint32_t i = 0; i < passes; i++) {
+      err = hsa_ext_image_export(gpu.agent, image, host_buf_, 0, 0, &region);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    elapsed = Seconds(start, Clock::now());
+    AddRow(gpu, "Export " + layout_name + ", " + fmt.name, bytes * passes / elapsed / 1e9,
+           "GB/s");
+
+    DestroyImage(gpu, image, data);
+  }
+}
+
+void ImagePerf::RunCopy(const Gpu& gpu) {
+  hsa_status_t err;
+  const uint32_t passes = std::max<uint32_t>(iterations_ / 10, 1);
+
+  for (const Format& fmt : kFormats) {
+    hsa_ext_image_descriptor_t desc = Descriptor2D(kTransferEdge, fmt.format);
+    hsa_ext_image_t src, dst;
+    void* src_data;
+    void* dst_data;
+    if (!CreateImage(gpu, desc, HSA_EXT_IMAGE_DATA_LAYOUT_OPAQUE, 0, &src, &src_data)) {
+      continue;
+    }
+    if (!CreateImage(gpu, desc, HSA_EXT_IMAGE_DATA_LAYOUT_OPAQUE, 0, &dst, &dst_data)) {
+      DestroyImage(gpu, src, src_data);
+      continue;
+    }
+
+    hsa_dim3_t origin = {0, 0, 0};
+    hsa_dim3_t range = {static_cast<uint32_t>(desc.width), static_cast<uint32_t>(desc.height), 1};
+    const double bytes = static_cast<double>(desc.width * desc.height * fmt.pixel_bytes);
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < passes; i++) {
+      err = hsa_ext_image_copy(gpu.agent, src, &origin, dst, &origin, &range);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    double elapsed = Seconds(start, Clock::now());
+    AddRow(gpu, std::string("Copy, ") + fmt.name, bytes * passes / elapsed / 1e9, "GB/s");
+
+    DestroyImage(gpu, src, src_data);
+    DestroyImage(gpu, dst, dst_data);
+  }
+}
+
+void ImagePerf::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void ImagePerf::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  if (unsupported_) {
+    std::cout << "Image extension is not supported." << std::endl;
+    return;
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::string agent;
+  for (const Row& row : results_) {
+    if (row.agent != agent) {
+      agent = row.agent;
+      std::cout << std::endl << agent << std::endl;
+    }
+    std::cout << "  " << std::left << std::setw(40) << row.name << std::right
+              << std::setw(14) << row.value << " " << row.unit << std::endl;
+
+    const bool higher_is_better = row.unit.find("/s") != std::string::npos;
+    ReportMetric(row.agent + " " + row.name, row.unit, row.value, higher_is_better);
+  }
+  std::cout << std::defaultfloat;
+}
+
+void ImagePerf::Close() {
+  if (host_buf_ != nullptr) {
+    hsa_amd_memory_pool_free(host_buf_);
+    host_buf_ = nullptr;
+  }
+
+  TestBase::Close();
+}
@@ -0,0 +1,139 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_IMAGE_PERF_H_
+#define ROCRTST_SUITES_PERFORMANCE_IMAGE_PERF_H_
+#include <string>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "common/base_rocr.h"
+#include "common/common.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_image.h"
+
+// @Brief: This class is defined to measure the image extension on one GPU
+// of each distinct ISA: first use latency of image creation, import and
+// copy, image create/destroy rate per format, import/export bandwidth for
+// linear and opaque (tiled) layouts and image to image copy bandwidth.
+
+class ImagePerf : public TestBase {
+ public:
+  // @Brief: Constructor
+  ImagePerf(void);
+
+  // @Brief: Destructor
+  virtual ~ImagePerf(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: A GPU and the pool its images are allocated from
+  struct Gpu {
+    hsa_agent_t agent;
+    hsa_amd_memory_pool_t pool;
+    std::string name;
+  };
+
+  // @Brief: One result row
+  struct Row {
+    std::string agent;
+    std::string name;
+    double value;
+    std::string unit;
+  };
+
+  // @Brief: Time the first image create, import, export and copy on gpu
+  void RunFirstUse(const Gpu& gpu);
+
+  // @Brief: Image create/destroy pairs per second for each format
+  void RunCreateRate(const Gpu& gpu);
+
+  // @Brief: Import and export bandwidth for layout
+  void RunTransfer(const Gpu& gpu, hsa_ext_image_data_layout_t layout);
+
+  // @Brief: Image to image copy bandwidth
+  void RunCopy(const Gpu& gpu);
+
+  // @Brief: Create an image of desc backed by new memory from gpu's pool,
+  // row_pitch is only used by the linear layout
+  bool CreateImage(const Gpu& gpu, const hsa_ext_image_descriptor_t& desc,
+                   hsa_ext_image_data_layout_t layout, size_t row_pitch,
+                   hsa_ext_image_t* image, void** data);
+
+  // @Brief: Destroy an image made by CreateImage
+  void DestroyImage(const Gpu& gpu, hsa_ext_image_t image, void* data);
+
+  void AddRow(const Gpu& gpu, const std::string& name, double value, const std::string& unit);
+
+  // @Brief: Number of times each measurement is repeated
+  uint32_t iterations_;
+
+  // @Brief: Set if the runtime has no image extension
+  bool unsupported_;
+
+  // @Brief: One GPU per distinct ISA
+  std::vector<Gpu> gpus_;
+
+  // @Brief: Host staging buffer for import and export
+  void* host_buf_;
+
+  std::vector<Row> results_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_IMAGE_PERF_H_
@@ -0,0 +1,239 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+
+#include "suites/performance/init_time.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+static const char* kPhaseNames[HSA_AMD_INIT_PHASE_COUNT] = {
+    "hsa_init (runtime load)", "Driver open and apertures", "Topology snapshot",
+    "Agent construction", "Extensions", "Agent init (blit/scratch/trap)", "Tools"};
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+struct AgentTimes {
+  std::string name;
+  hsa_amd_agent_init_times_t times;
+};
+
+static hsa_status_t CollectAgentTimes(hsa_agent_t agent, void* data) {
+  std::vector<AgentTimes>* agents = reinterpret_cast<std::vector<AgentTimes>*>(data);
+  hsa_status_t err;
+
+  char name[64] = {0};
+  err = hsa_agent_get_info(agent, HSA_AGENT_INFO_NAME, name);
+  if (err != HSA_STATUS_SUCCESS) {
+    return err;
+  }
+
+  AgentTimes entry;
+  entry.name = std::string(name) + " #" + std::to_string(agents->size());
+  err = hsa_agent_get_info(agent, static_cast<hsa_agent_info_t>(HSA_AMD_AGENT_INFO_INIT_TIMES),
+                           &entry.times);
+  if (err != HSA_STATUS_SUCCESS) {
+    return err;
+  }
+  agents->push_back(entry);
+  return HSA_STATUS_SUCCESS;
+}
+
+InitTime::InitTime(void) : TestBase(), phases_unsupported_(false) {
+#ifdef ROCRTST_EMULATOR_BUILD
+  set_num_iteration(2);
+#else
+  set_num_iteration(20);
+#endif
+
+  set_title("Runtime Startup and Shutdown Time");
+  set_description("This test repeatedly calls hsa_init and hsa_shut_down "
+      "and reports their wall time, the duration of each hsa_init phase "
+      "(driver open, topology snapshot, agent construction, extensions, "
+      "agent init and tools) and each agent's construction and init time.");
+}
+
+InitTime::~InitTime() {
+}
+
+void InitTime::SetUp() {
+  // hsa_init is timed by Run, TestBase::SetUp() is not used.
+  return;
+}
+
+void InitTime::AddSample(const std::string& name, double seconds) {
+  for (Series& series : results_) {
+    if (series.name == name) {
+      series.samples.push_back(seconds);
+      return;
+    }
+  }
+  Series series;
+  series.name = name;
+  series.samples.push_back(seconds);
+  results_.push_back(series);
+}
+
+void InitTime::RecordPhases(void) {
+  hsa_status_t err;
+
+  uint64_t freq = 0;
+  err = hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY, &freq);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  ASSERT_NE(0u, freq);
+
+  hsa_amd_init_phase_times_t phases;
+  err = hsa_system_get_info(static_cast<hsa_system_info_t>(HSA_AMD_SYSTEM_INFO_INIT_PHASE_TIMES),
+                            &phases);
+  if (err != HSA_STATUS_SUCCESS) {
+    phases_unsupported_ = true;
+    return;
+  }
+
+  for (int i = 0; i < HSA_AMD_INIT_PHASE_COUNT; i++) {
+    if (phases.start[i] == 0 || phases.end[i] < phases.start[i]) {
+      continue;
+    }
+    AddSample(std::string("  phase: ") + kPhaseNames[i],
+              static_cast<double>(phases.end[i] - phases.start[i]) / freq);
+  }
+
+  std::vector<AgentTimes> agents;
+  err = hsa_iterate_agents(CollectAgentTimes, &agents);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  for (const AgentTimes& agent : agents) {
+    const hsa_amd_agent_init_times_t& t = agent.times;
+    if (t.create_start != 0 && t.create_end >= t.create_start) {
+      AddSample("  agent create: " + agent.name,
+                static_cast<double>(t.create_end - t.create_start) / freq);
+    }
+    if (t.init_start != 0 && t.init_end >= t.init_start) {
+      AddSample("  agent init: " + agent.name,
+                static_cast<double>(t.init_end - t.init_start) / freq);
+    }
+  }
+}
+
+void InitTime::Run(void) {
+  hsa_status_t err;
+
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+
+  for (uint32_t i = 0; i < static_cast<uint32_t>(num_iteration()); i++) {
+    Clock::time_point start = Clock::now();
+    err = rocrtst::InitAndSetupHSA(this);
+    Clock::time_point inited = Clock::now();
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    RecordPhases();
+
+    Clock::time_point stop = Clock::now();
+    err = hsa_shut_down();
+    Clock::time_point done = Clock::now();
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+    AddSample("hsa_init", Seconds(start, inited));
+    AddSample("hsa_shut_down", Seconds(stop, done));
+  }
+}
+
+void InitTime::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void InitTime::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  if (phases_unsupported_) {
+    std::cout << "Runtime does not report init phase times." << std::endl;
+  }
+
+  std::cout << std::left << std::setw(56) << "Step" << std::right
+            << std::setw(12) << "mean(ms)" << std::setw(12) << "min(ms)"
+            << std::setw(12) << "max(ms)" << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  for (const Series& series : results_) {
+    double sum = std::accumulate(series.samples.begin(), series.samples.end(), 0.0);
+    auto range = std::minmax_element(series.samples.begin(), series.samples.end());
+    std::cout << std::left << std::setw(56) << series.name << std::right
+              << std::setw(12) << sum * 1000.0 / series.samples.size()
+              << std::setw(12) << *range.first * 1000.0
+              << std::setw(12) << *range.second * 1000.0 << std::endl;
+
+    std::vector<double> ms;
+    for (double s : series.samples) {
+      ms.push_back(s * 1000.0);
+    }
+    ReportMetric(series.name.substr(series.name.find_first_not_of(' ')), "ms", ms, false);
+  }
+  std::cout << std::defaultfloat;
+}
+
+void InitTime::Close() {
+  // TestBase::SetUp() not used, every hsa_init was already shut down.
+  return;
+}
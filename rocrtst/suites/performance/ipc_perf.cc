@@ -0,0 +1,426 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "suites/performance/ipc_perf.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/os.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+static const uint32_t kChildCounts[] = {1, 2, 4, 8};
+static const uint32_t kMaxChildren = 8;
+static const uint32_t kBuffers = 32;
+static const size_t kBufferSize = 2 * 1024 * 1024;
+static const uint32_t kPingPongs = 1000;
+
+// Bound on any cross process wait, so a failed peer can't hang the run.
+static const double kTimeoutSec = 60.0;
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+struct IpcPerf::Shared {
+  std::atomic<uint32_t> ready;
+  std::atomic<uint32_t> done;
+  std::atomic<int> go;
+  hsa_amd_ipc_memory_t buffers[kBuffers];
+  hsa_amd_ipc_signal_t ping[kMaxChildren];
+  hsa_amd_ipc_signal_t pong[kMaxChildren];
+  // Per child means in microseconds, written before the child counts done.
+  double attach_us[kMaxChildren];
+  double detach_us[kMaxChildren];
+  double import_us[kMaxChildren];
+  int status[kMaxChildren];
+};
+
+// Spin until value reaches target, false on timeout.
+template <typename T>
+static bool WaitFor(const std::atomic<T>& value, T target) {
+  Clock::time_point start = Clock::now();
+  while (value.load() < target) {
+    if (Seconds(start, Clock::now()) > kTimeoutSec) {
+      return false;
+    }
+    sched_yield();
+  }
+  return true;
+}
+
+static bool SendFds(int sock, const std::vector<int>& fds) {
+  char dummy = 0;
+  struct iovec iov = {&dummy, 1};
+  std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = &control[0];
+  msg.msg_controllen = control.size();
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+  memcpy(CMSG_DATA(cmsg), &fds[0], sizeof(int) * fds.size());
+  return sendmsg(sock, &msg, 0) == 1;
+}
+
+static bool RecvFds(int sock, std::vector<int>* fds, size_t count) {
+  char dummy;
+  struct iovec iov = {&dummy, 1};
+  std::vector<char> control(CMSG_SPACE(sizeof(int) * count));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = &control[0];
+  msg.msg_controllen = control.size();
+  if (recvmsg(sock, &msg, 0) != 1) {
+    return false;
+  }
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == nullptr || cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(sizeof(int) * count)) {
+    return false;
+  }
+  fds->resize(count);
+  memcpy(&(*fds)[0], CMSG_DATA(cmsg), sizeof(int) * count);
+  return true;
+}
+
+IpcPerf::IpcPerf(bool legacy) : TestBase(), legacy_(legacy) {
+  set_title(std::string("IPC Multi-Process Performance (") +
+            (legacy ? "legacy" : "socket") + " IPC mode)");
+  set_description("This test forks 1 to 8 child processes. The parent "
+      "exports GPU buffers as IPC memory handles and dmabufs and creates an "
+      "IPC signal pair per child. It reports IPC handle create time, child "
+      "attach, detach and dmabuf import time and signal ping-pong latency "
+      "between the parent and every child at once, per process count.");
+}
+
+IpcPerf::~IpcPerf() {
+}
+
+void IpcPerf::SetUp() {
+  // Children inherit the mode.  Each process initializes the runtime after
+  // fork, so TestBase::SetUp() is not used here.
+  rocrtst::SetEnv("HSA_ENABLE_IPC_MODE_LEGACY", legacy_ ? "1" : "0");
+  SetupPrint();
+}
+
+int IpcPerf::ChildMain(Shared* shared, uint32_t index, int sock) {
+  hsa_status_t err;
+
+  if (hsa_init() != HSA_STATUS_SUCCESS) {
+    return 1;
+  }
+
+  hsa_agent_t gpu;
+  gpu.handle = 0;
+  hsa_iterate_agents(rocrtst::FindGPUDevice, &gpu);
+  if (gpu.handle == 0) {
+    return 2;
+  }
+
+  shared->ready++;
+  if (!WaitFor(shared->go, 1)) {
+    return 3;
+  }
+
+  // IPC memory attach and detach of every exported buffer.
+  void* mapped[kBuffers];
+  Clock::time_point start = Clock::now();
+  for (uint32_t b = 0; b < kBuffers; b++) {
+    err = hsa_amd_ipc_memory_attach(&shared->buffers[b], kBufferSize, 1, &gpu, &mapped[b]);
+    if (err != HSA_STATUS_SUCCESS) {
+      return 4;
+    }
+  }
+  shared->attach_us[index] = Seconds(start, Clock::now()) * 1e6 / kBuffers;
+
+  start = Clock::now();
+  for (uint32_t b = 0; b < kBuffers; b++) {
+    if (hsa_amd_ipc_memory_detach(mapped[b]) != HSA_STATUS_SUCCESS) {
+      return 5;
+    }
+  }
+  shared->detach_us[index] = Seconds(start, Clock::now()) * 1e6 / kBuffers;
+
+  // dmabuf import of every exported buffer.
+  std::vector<int> fds;
+  if (!RecvFds(sock, &fds, kBuffers)) {
+    return 6;
+  }
+  start = Clock::now();
+  for (uint32_t b = 0; b < kBuffers; b++) {
+    size_t size = 0;
+    err = hsa_amd_interop_map_buffer(1, &gpu, fds[b], 0, &size, &mapped[b], nullptr, nullptr);
+    if (err != HSA_STATUS_SUCCESS) {
+      return 7;
+    }
+  }
+  shared->import_us[index] = Seconds(start, Clock::now()) * 1e6 / kBuffers;
+  for (uint32_t b = 0; b < kBuffers; b++) {
+    hsa_amd_interop_unmap_buffer(mapped[b]);
+    close(fds[b]);
+  }
+
+  // Echo the parent's pings.
+  hsa_signal_t ping, pong;
+  if (hsa_amd_ipc_signal_attach(&shared->ping[index], &ping) != HSA_STATUS_SUCCESS ||
+      hsa_amd_ipc_signal_attach(&shared->pong[index], &pong) != HSA_STATUS_SUCCESS) {
+    return 8;
+  }
+  shared->done++;
+  for (uint32_t i = 1; i <= kPingPongs; i++) {
+    if (hsa_signal_wait_scacquire(ping, HSA_SIGNAL_CONDITION_EQ, i,
+                                  static_cast<uint64_t>(kTimeoutSec * 1e9),
+                                  HSA_WAIT_STATE_ACTIVE) != i) {
+      return 9;
+    }
+    hsa_signal_store_screlease(pong, i);
+  }
+  hsa_signal_destroy(ping);
+  hsa_signal_destroy(pong);
+
+  hsa_shut_down();
+  return 0;
+}
+
+void IpcPerf::RunProcesses(uint32_t children) {
+  hsa_status_t err;
+
+  Shared* shared = reinterpret_cast<Shared*>(
+      mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  ASSERT_NE(shared, MAP_FAILED);
+  memset(reinterpret_cast<void*>(shared), 0, sizeof(Shared));
+
+  // Fork before the parent initializes the runtime.
+  std::vector<pid_t> pids;
+  std::vector<int> socks;
+  for (uint32_t c = 0; c < children; c++) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    pid_t pid = fork();
+    ASSERT_NE(-1, pid);
+    if (pid == 0) {
+      close(sv[0]);
+      _exit(ChildMain(shared, c, sv[1]));
+    }
+    close(sv[1]);
+    pids.push_back(pid);
+    socks.push_back(sv[0]);
+  }
+
+  err = rocrtst::InitAndSetupHSA(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = rocrtst::SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = rocrtst::SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  Result result;
+  memset(&result, 0, sizeof(result));
+  result.processes = children + 1;
+
+  // Export
+  std::vector<void*> buffers(kBuffers, nullptr);
+  for (uint32_t b = 0; b < kBuffers; b++) {
+    err = hsa_amd_memory_pool_allocate(device_pool(), kBufferSize, 0, &buffers[b]);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+
+  Clock::time_point start = Clock::now();
+  for (uint32_t b = 0; b < kBuffers; b++) {
+    err = hsa_amd_ipc_memory_create(buffers[b], kBufferSize, &shared->buffers[b]);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+  result.ipc_create = Seconds(start, Clock::now()) * 1e6 / kBuffers;
+
+  std::vector<int> fds(kBuffers, -1);
+  start = Clock::now();
+  for (uint32_t b = 0; b < kBuffers; b++) {
+    uint64_t offset = 0;
+    err = hsa_amd_portable_export_dmabuf(buffers[b], kBufferSize, &fds[b], &offset);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+  result.dmabuf_export = Seconds(start, Clock::now()) * 1e6 / kBuffers;
+
+  std::vector<hsa_signal_t> pings(children), pongs(children);
+  for (uint32_t c = 0; c < children; c++) {
+    err = hsa_amd_signal_create(0, 0, nullptr, HSA_AMD_SIGNAL_IPC, &pings[c]);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    err = hsa_amd_signal_create(0, 0, nullptr, HSA_AMD_SIGNAL_IPC, &pongs[c]);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    err = hsa_amd_ipc_signal_create(pings[c], &shared->ping[c]);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    err = hsa_amd_ipc_signal_create(pongs[c], &shared->pong[c]);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+
+  // Children start importing together once all of them are initialized.
+  ASSERT_TRUE(WaitFor(shared->ready, children)) << "children did not start";
+  shared->go = 1;
+  for (uint32_t c = 0; c < children; c++) {
+    ASSERT_TRUE(SendFds(socks[c], fds));
+  }
+  ASSERT_TRUE(WaitFor(shared->done, children)) << "children did not finish importing";
+
+  // One parent thread per child ping-pongs with it, all at once.
+  std::vector<double> rtt(children, 0.0);
+  std::vector<std::thread> threads;
+  for (uint32_t c = 0; c < children; c++) {
+    threads.push_back(std::thread([&, c]() {
+      Clock::time_point begin = Clock::now();
+      for (uint32_t i = 1; i <= kPingPongs; i++) {
+        hsa_signal_store_screlease(pings[c], i);
+        if (hsa_signal_wait_scacquire(pongs[c], HSA_SIGNAL_CONDITION_EQ, i,
+                                      static_cast<uint64_t>(kTimeoutSec * 1e9),
+                                      HSA_WAIT_STATE_ACTIVE) != i) {
+          return;
+        }
+      }
+      rtt[c] = Seconds(begin, Clock::now()) / kPingPongs;
+    }));
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  for (uint32_t c = 0; c < children; c++) {
+    int status = -1;
+    waitpid(pids[c], &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        << "child " << c << " failed with status " << status;
+    close(socks[c]);
+
+    EXPECT_GT(rtt[c], 0.0) << "ping-pong with child " << c << " timed out";
+    result.signal_ping_pong += rtt[c] * 1e6 / 2 / children;
+    result.ipc_attach += shared->attach_us[c] / children;
+    result.ipc_detach += shared->detach_us[c] / children;
+    result.dmabuf_import += shared->import_us[c] / children;
+  }
+  results_.push_back(result);
+
+  for (uint32_t c = 0; c < children; c++) {
+    hsa_signal_destroy(pings[c]);
+    hsa_signal_destroy(pongs[c]);
+  }
+  for (uint32_t b = 0; b < kBuffers; b++) {
+    hsa_amd_portable_close_dmabuf(fds[b]);
+    hsa_amd_memory_pool_free(buffers[b]);
+  }
+  munmap(shared, sizeof(Shared));
+
+  err = hsa_shut_down();
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void IpcPerf::Run(void) {
+  TestBase::Run();
+
+  for (uint32_t children : kChildCounts) {
+    RunProcesses(children);
+    if (::testing::Test::HasFatalFailure()) {
+      return;
+    }
+  }
+}
+
+void IpcPerf::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void IpcPerf::DisplayResults(void) const {
+  TestBase::DisplayResults();
+
+  std::cout << "Mean uS per buffer (" << kBuffers << " x " << kBufferSize / 1024
+            << " KB) or per one way signal" << std::endl;
+  std::cout << std::setw(10) << "processes" << std::setw(12) << "ipc create"
+            << std::setw(12) << "ipc attach" << std::setw(12) << "ipc detach"
+            << std::setw(14) << "dmabuf export" << std::setw(14) << "dmabuf import"
+            << std::setw(12) << "signal" << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  for (const Result& r : results_) {
+    std::cout << std::setw(10) << r.processes << std::setw(12) << r.ipc_create
+              << std::setw(12) << r.ipc_attach << std::setw(12) << r.ipc_detach
+              << std::setw(14) << r.dmabuf_export << std::setw(14) << r.dmabuf_import
+              << std::setw(12) << r.signal_ping_pong << std::endl;
+
+    const std::string procs = ", " + std::to_string(r.processes) + " processes";
+    ReportMetric("IPC create" + procs, "uS", r.ipc_create, false);
+    ReportMetric("IPC attach" + procs, "uS", r.ipc_attach, false);
+    ReportMetric("IPC detach" + procs, "uS", r.ipc_detach, false);
+    ReportMetric("dmabuf export" + procs, "uS", r.dmabuf_export, false);
+    ReportMetric("dmabuf import" + procs, "uS", r.dmabuf_import, false);
+    ReportMetric("signal ping-pong" + procs, "uS", r.signal_ping_pong, false);
+  }
+  std::cout << std::defaultfloat;
+}
+
+void IpcPerf::Close() {
+  // Every RunProcesses() shuts the runtime down itself.
+  ClosePrint();
+}
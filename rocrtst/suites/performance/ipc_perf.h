@@ -0,0 +1,113 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_IPC_PERF_H_
+#define ROCRTST_SUITES_PERFORMANCE_IPC_PERF_H_
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "common/base_rocr.h"
+#include "common/common.h"
+#include "hsa/hsa.h"
+
+// @Brief: This class is defined to measure inter-process sharing as a
+// function of process count: IPC memory handle create and attach (in the
+// IPC mode selected at construction), IPC signal ping-pong latency and
+// dmabuf export and import.  The parent process exports, forked children
+// import.
+
+class IpcPerf : public TestBase {
+ public:
+  // @Brief: Constructor, legacy selects HSA_ENABLE_IPC_MODE_LEGACY
+  explicit IpcPerf(bool legacy);
+
+  // @Brief: Destructor
+  virtual ~IpcPerf(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  struct Shared;
+
+  // @Brief: Mean times of one process count, in microseconds
+  struct Result {
+    uint32_t processes;
+    double ipc_create;
+    double ipc_attach;
+    double ipc_detach;
+    double dmabuf_export;
+    double dmabuf_import;
+    double signal_ping_pong;
+  };
+
+  // @Brief: Fork children, export from this process and collect the
+  // children's import timings
+  void RunProcesses(uint32_t children);
+
+  // @Brief: Body of a forked child, returns its exit status
+  static int ChildMain(Shared* shared, uint32_t index, int sock);
+
+  bool legacy_;
+
+  std::vector<Result> results_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_IPC_PERF_H_
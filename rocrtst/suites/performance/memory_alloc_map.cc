@@ -0,0 +1,404 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "suites/performance/memory_alloc_map.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+static const size_t kAllocSizes[] = {4 * 1024, 64 * 1024, 2 * 1024 * 1024,
+                                     64 * 1024 * 1024};
+static const uint32_t kThreadCounts[] = {1, 2, 4, 8};
+static const size_t kLockSizes[] = {4 * 1024, 64 * 1024, 1024 * 1024,
+                                    16 * 1024 * 1024, 256 * 1024 * 1024};
+static const uint32_t kMapCounts[] = {1, 16, 256};
+static const uint32_t kLiveCounts[] = {1, 16, 256, 4096};
+static const size_t kLiveAllocSize = 4096;
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+MemoryAllocMap::MemoryAllocMap(void) : TestBase() {
+#ifdef ROCRTST_EMULATOR_BUILD
+  iterations_ = 4;
+#else
+  iterations_ = 1000;
+#endif
+
+  set_title("Memory Allocation and Mapping Scaling");
+  set_description("This test measures how the cost of memory calls scales: "
+      "hsa_amd_memory_pool_allocate/free by size and thread count, "
+      "hsa_amd_agents_allow_access by agent count, hsa_amd_memory_lock by "
+      "size, hsa_amd_vmem_map/set_access by mapping count and "
+      "hsa_amd_pointer_info by live allocation count.");
+}
+
+MemoryAllocMap::~MemoryAllocMap() {
+}
+
+void MemoryAllocMap::SetUp() {
+  hsa_status_t err;
+
+  TestBase::SetUp();
+
+  err = SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = hsa_iterate_agents(rocrtst::IterateGPUAgents, &gpus_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void MemoryAllocMap::Run() {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+
+  RunPoolAllocate();
+  RunAllowAccess();
+  RunMemoryLock();
+  RunVmemMap();
+  RunPointerInfo();
+}
+
+void MemoryAllocMap::RunPoolAllocate(void) {
+  hsa_amd_memory_pool_t pool = device_pool();
+
+  for (size_t size : kAllocSizes) {
+    Curve curve;
+    curve.name = "Pool allocate/free, " + std::to_string(size) + " bytes";
+    curve.x_label = "threads";
+    curve.y_label = "pairs/s";
+
+    // Large sizes are bounded by the pool, not the allocator.
+    uint32_t iterations = std::max<uint32_t>(
+        iterations_ / std::max<size_t>(size / (2 * 1024 * 1024), 1), 1);
+
+    for (uint32_t threads : kThreadCounts) {
+      std::vector<std::thread> workers;
+      std::vector<hsa_status_t> status(threads, HSA_STATUS_SUCCESS);
+
+      Clock::time_point start = Clock::now();
+      for (uint32_t t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&, t]() {
+          for (uint32_t i = 0; i < iterations; i++) {
+            void* ptr = nullptr;
+            hsa_status_t err = hsa_amd_memory_pool_allocate(pool, size, 0, &ptr);
+            if (err == HSA_STATUS_SUCCESS) {
+              err = hsa_amd_memory_pool_free(ptr);
+            }
+            if (err != HSA_STATUS_SUCCESS) {
+              status[t] = err;
+              return;
+            }
+          }
+        }));
+      }
+      for (std::thread& w : workers) {
+        w.join();
+      }
+      double elapsed = Seconds(start, Clock::now());
+
+      for (hsa_status_t err : status) {
+        ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      }
+      curve.points.push_back(std::make_pair(static_cast<double>(threads),
+                                            threads * iterations / elapsed));
+    }
+    results_.push_back(curve);
+  }
+}
+
+void MemoryAllocMap::RunAllowAccess(void) {
+  hsa_status_t err;
+  Curve curve;
+  curve.name = "Agents allow access, 2 MB system buffer";
+  curve.x_label = "agents";
+  curve.y_label = "uS/call";
+
+  const size_t size = 2 * 1024 * 1024;
+  for (uint32_t agents = 1; agents <= gpus_.size(); agents++) {
+    double total = 0.0;
+    for (uint32_t i = 0; i < iterations_; i++) {
+      void* ptr = nullptr;
+      err = hsa_amd_memory_pool_allocate(cpu_pool(), size, 0, &ptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+      Clock::time_point start = Clock::now();
+      err = hsa_amd_agents_allow_access(agents, &gpus_[0], NULL, ptr);
+      total += Seconds(start, Clock::now());
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+      err = hsa_amd_memory_pool_free(ptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    curve.points.push_back(std::make_pair(static_cast<double>(agents),
+                                          total * 1e6 / iterations_));
+  }
+  results_.push_back(curve);
+}
+
+void MemoryAllocMap::RunMemoryLock(void) {
+  hsa_status_t err;
+  Curve lock_curve;
+  lock_curve.name = "Memory lock";
+  lock_curve.x_label = "bytes";
+  lock_curve.y_label = "uS/call";
+  Curve unlock_curve;
+  unlock_curve.name = "Memory unlock";
+  unlock_curve.x_label = "bytes";
+  unlock_curve.y_label = "uS/call";
+
+  const size_t page = 4096;
+  for (size_t size : kLockSizes) {
+    void* host = nullptr;
+    ASSERT_EQ(0, posix_memalign(&host, page, size));
+    // Fault the pages in so the lock measures pinning, not first touch.
+    memset(host, 0, size);
+
+    uint32_t iterations = std::max<uint32_t>(
+        iterations_ / std::max<size_t>(size / (16 * 1024 * 1024), 1), 1);
+    double locking = 0.0;
+    double unlocking = 0.0;
+    for (uint32_t i = 0; i < iterations; i++) {
+      void* agent_ptr = nullptr;
+      Clock::time_point start = Clock::now();
+      err = hsa_amd_memory_lock(host, size, &gpus_[0], gpus_.size(),
+                                &agent_ptr);
+      Clock::time_point locked = Clock::now();
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+      err = hsa_amd_memory_unlock(host);
+      unlocking += Seconds(locked, Clock::now());
+      locking += Seconds(start, locked);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    free(host);
+
+    lock_curve.points.push_back(std::make_pair(static_cast<double>(size),
+                                               locking * 1e6 / iterations));
+    unlock_curve.points.push_back(std::make_pair(static_cast<double>(size),
+                                                 unlocking * 1e6 / iterations));
+  }
+  results_.push_back(lock_curve);
+  results_.push_back(unlock_curve);
+}
+
+void MemoryAllocMap::RunVmemMap(void) {
+  hsa_status_t err;
+  Curve map_curve;
+  map_curve.name = "VMM map";
+  map_curve.x_label = "mappings";
+  map_curve.y_label = "maps/s";
+  Curve access_curve;
+  access_curve.name = "VMM set access";
+  access_curve.x_label = "mappings";
+  access_curve.y_label = "calls/s";
+
+  rocrtst::pool_info_t pool_i;
+  err = rocrtst::AcquirePoolInfo(device_pool(), &pool_i);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  if (!pool_i.alloc_allowed || pool_i.alloc_granule == 0) {
+    return;
+  }
+  const size_t granule = pool_i.alloc_granule;
+
+  std::vector<hsa_amd_memory_access_desc_t> desc(gpus_.size());
+  for (size_t i = 0; i < gpus_.size(); i++) {
+    desc[i].permissions = HSA_ACCESS_PERMISSION_RW;
+    desc[i].agent_handle = gpus_[i];
+  }
+
+  for (uint32_t count : kMapCounts) {
+    void* va = nullptr;
+    err = hsa_amd_vmem_address_reserve(&va, count * granule, 0, 0);
+    if (err != HSA_STATUS_SUCCESS) {
+      // VMM is not supported by this kernel driver.
+      return;
+    }
+
+    std::vector<hsa_amd_vmem_alloc_handle_t> handles(count);
+    for (uint32_t i = 0; i < count; i++) {
+      err = hsa_amd_vmem_handle_create(device_pool(), granule,
+                                       MEMORY_TYPE_NONE, 0, &handles[i]);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+
+    uint32_t rounds = std::max(iterations_ / count, 1u);
+    double mapping = 0.0;
+    double access = 0.0;
+    for (uint32_t r = 0; r < rounds; r++) {
+      Clock::time_point start = Clock::now();
+      for (uint32_t i = 0; i < count; i++) {
+        err = hsa_amd_vmem_map(static_cast<char*>(va) + i * granule, granule,
+                               0, handles[i], 0);
+        ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      }
+      Clock::time_point mapped = Clock::now();
+      for (uint32_t i = 0; i < count; i++) {
+        err = hsa_amd_vmem_set_access(static_cast<char*>(va) + i * granule,
+                                      granule, &desc[0], desc.size());
+        ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      }
+      Clock::time_point accessible = Clock::now();
+      mapping += Seconds(start, mapped);
+      access += Seconds(mapped, accessible);
+
+      for (uint32_t i = 0; i < count; i++) {
+        err = hsa_amd_vmem_unmap(static_cast<char*>(va) + i * granule, granule);
+        ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      }
+    }
+
+    for (hsa_amd_vmem_alloc_handle_t handle : handles) {
+      hsa_amd_vmem_handle_release(handle);
+    }
+    hsa_amd_vmem_address_free(va, count * granule);
+
+    map_curve.points.push_back(std::make_pair(static_cast<double>(count),
+                                              rounds * count / mapping));
+    access_curve.points.push_back(std::make_pair(static_cast<double>(count),
+                                                 rounds * count / access));
+  }
+  results_.push_back(map_curve);
+  results_.push_back(access_curve);
+}
+
+void MemoryAllocMap::RunPointerInfo(void) {
+  hsa_status_t err;
+  Curve curve;
+  curve.name = "Pointer info, 4 KB allocations";
+  curve.x_label = "live allocations";
+  curve.y_label = "nS/call";
+
+  std::vector<void*> live;
+  for (uint32_t count : kLiveCounts) {
+    while (live.size() < count) {
+      void* ptr = nullptr;
+      err = hsa_amd_memory_pool_allocate(device_pool(), kLiveAllocSize, 0,
+                                         &ptr);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+      live.push_back(ptr);
+    }
+
+    // Look up interior pointers in a scattered order.
+    const uint32_t lookups = iterations_ * 10;
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < lookups; i++) {
+      hsa_amd_pointer_info_t info;
+      info.size = sizeof(info);
+      const char* ptr = static_cast<const char*>(live[(i * 7919u) % count]);
+      err = hsa_amd_pointer_info(ptr + (i % kLiveAllocSize), &info, NULL,
+                                 NULL, NULL);
+      ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+    }
+    double elapsed = Seconds(start, Clock::now());
+    curve.points.push_back(std::make_pair(static_cast<double>(count),
+                                          elapsed * 1e9 / lookups));
+  }
+
+  for (void* ptr : live) {
+    hsa_amd_memory_pool_free(ptr);
+  }
+  results_.push_back(curve);
+}
+
+void MemoryAllocMap::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void MemoryAllocMap::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  for (const Curve& curve : results_) {
+    std::cout << curve.name << std::endl;
+    std::cout << "  " << std::setw(16) << curve.x_label << "  "
+              << std::setw(16) << curve.y_label << std::endl;
+    for (const std::pair<double, double>& point : curve.points) {
+      std::cout << "  " << std::setw(16) << std::fixed << std::setprecision(0)
+                << point.first << "  " << std::setw(16)
+                << std::setprecision(2) << point.second << std::endl;
+    }
+    std::cout.unsetf(std::ios_base::floatfield);
+    std::cout << std::setprecision(6);
+
+    // Rates are per second, everything else is a cost.
+    const bool higher_is_better = curve.y_label.find("/s") != std::string::npos;
+    for (const std::pair<double, double>& point : curve.points) {
+      ReportMetric(curve.name + ", " + std::to_string(static_cast<uint64_t>(point.first)) +
+                   " " + curve.x_label, curve.y_label, point.second, higher_is_better);
+    }
+  }
+  return;
+}
+
+void MemoryAllocMap::Close() {
+  TestBase::Close();
+  return;
+}
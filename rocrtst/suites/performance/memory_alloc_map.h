@@ -0,0 +1,123 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_MEMORY_ALLOC_MAP_H_
+#define ROCRTST_SUITES_PERFORMANCE_MEMORY_ALLOC_MAP_H_
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "common/base_rocr.h"
+#include "common/common.h"
+#include "hsa/hsa.h"
+
+// @Brief: This class is defined to measure the cost of memory allocation and
+// mapping calls as their inputs grow: pool allocate/free per size and thread
+// count, agents_allow_access per agent count, memory_lock per size, VMM
+// map/set_access per mapping count and pointer_info per live allocation
+// count.  Each is reported as a curve so allocator changes can be compared
+// against a saved baseline.
+
+class MemoryAllocMap : public TestBase {
+ public:
+  // @Brief: Constructor
+  MemoryAllocMap(void);
+
+  // @Brief: Destructor
+  virtual ~MemoryAllocMap(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: One measured curve, y as a function of x
+  struct Curve {
+    std::string name;
+    std::string x_label;
+    std::string y_label;
+    std::vector<std::pair<double, double>> points;
+  };
+
+  // @Brief: hsa_amd_memory_pool_allocate/free pairs per second, one curve
+  // per size class over producer thread count
+  void RunPoolAllocate(void);
+
+  // @Brief: Microseconds per hsa_amd_agents_allow_access over agent count
+  void RunAllowAccess(void);
+
+  // @Brief: Microseconds per hsa_amd_memory_lock and unlock over size
+  void RunMemoryLock(void);
+
+  // @Brief: Mappings per second of hsa_amd_vmem_map and
+  // hsa_amd_vmem_set_access over mapping count
+  void RunVmemMap(void);
+
+  // @Brief: Nanoseconds per hsa_amd_pointer_info over live allocations
+  void RunPointerInfo(void);
+
+  // @Brief: Number of timed calls per point
+  uint32_t iterations_;
+
+  // @Brief: GPU agents allow_access and set_access grant access to
+  std::vector<hsa_agent_t> gpus_;
+
+  // @Brief: Measured curves
+  std::vector<Curve> results_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_MEMORY_ALLOC_MAP_H_
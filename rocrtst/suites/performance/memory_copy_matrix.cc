@@ -0,0 +1,466 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "suites/performance/memory_copy_matrix.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+// Bytes moved per bandwidth point, bounding the repeat count of small sizes.
+static const size_t kBytesPerPoint = 1024 * 1024 * 1024;
+static const uint32_t kMinReps = 4;
+static const uint32_t kMaxReps = 1000;
+static const uint32_t kLatencyReps = 20;
+
+// Rect copies move rows of at most this many bytes, with a padded pitch.
+static const size_t kRectRow = 64 * 1024;
+static const size_t kRectPad = 256;
+
+static const uint32_t kMaxEngines = 32;
+
+typedef std::chrono::steady_clock Clock;
+
+static const char* LinkName(hsa_amd_link_info_type_t type) {
+  switch (type) {
+    case HSA_AMD_LINK_INFO_TYPE_HYPERTRANSPORT:
+      return "HT";
+    case HSA_AMD_LINK_INFO_TYPE_QPI:
+      return "QPI";
+    case HSA_AMD_LINK_INFO_TYPE_PCIE:
+      return "PCIe";
+    case HSA_AMD_LINK_INFO_TYPE_INFINBAND:
+      return "IB";
+    case HSA_AMD_LINK_INFO_TYPE_XGMI:
+      return "XGMI";
+    default:
+      return "unknown";
+  }
+}
+
+MemoryCopyMatrix::MemoryCopyMatrix(void) : TestBase() {
+  signal_.handle = 0;
+
+#ifdef ROCRTST_EMULATOR_BUILD
+  sizes_ = {4 * 1024, 64 * 1024};
+#else
+  sizes_ = {4 * 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024,
+            64 * 1024 * 1024};
+#endif
+
+  set_title("Copy Bandwidth Matrix");
+  set_description("This test measures copy bandwidth and latency between "
+      "every pair of agents on each available SDMA engine, through blit "
+      "kernels, in both directions at once and as rect copies, over a sweep "
+      "of sizes. Each pair is annotated with the link hops reported by "
+      "HSA_AMD_AGENT_MEMORY_POOL_INFO_LINK_INFO.");
+}
+
+MemoryCopyMatrix::~MemoryCopyMatrix() {
+}
+
+void MemoryCopyMatrix::SetUp() {
+  hsa_status_t err;
+
+  TestBase::SetUp();
+
+  err = SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  std::vector<hsa_agent_t> cpus;
+  err = hsa_iterate_agents(rocrtst::IterateCPUAgents, &cpus);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  err = hsa_iterate_agents(rocrtst::IterateGPUAgents, &gpus_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  for (size_t i = 0; i < cpus.size() + gpus_.size(); i++) {
+    Endpoint ep;
+    bool is_cpu = i < cpus.size();
+    ep.agent = is_cpu ? cpus[i] : gpus_[i - cpus.size()];
+    ep.type = is_cpu ? HSA_DEVICE_TYPE_CPU : HSA_DEVICE_TYPE_GPU;
+    ep.name = (is_cpu ? "CPU" : "GPU") +
+              std::to_string(is_cpu ? i : i - cpus.size());
+    ep.pool.handle = 0;
+    err = hsa_amd_agent_iterate_memory_pools(ep.agent,
+                                             rocrtst::FindStandardPool,
+                                             &ep.pool);
+    if (err != HSA_STATUS_INFO_BREAK || ep.pool.handle == 0) {
+      continue;
+    }
+    endpoints_.push_back(ep);
+  }
+
+  err = hsa_signal_create(0, 0, NULL, &signal_);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+}
+
+void MemoryCopyMatrix::Run() {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+
+  for (uint32_t src = 0; src < endpoints_.size(); src++) {
+    for (uint32_t dst = 0; dst < endpoints_.size(); dst++) {
+      // A GPU copying within itself is measured, a CPU copying within itself
+      // is memcpy.
+      if (src == dst && endpoints_[src].type == HSA_DEVICE_TYPE_CPU) {
+        continue;
+      }
+      Pair pair;
+      RunPair(src, dst, &pair);
+      results_.push_back(pair);
+
+      if (verbosity() >= VERBOSE_PROGRESS) {
+        std::cout << ".";
+        fflush(stdout);
+      }
+    }
+  }
+
+  if (verbosity() >= VERBOSE_PROGRESS) {
+    std::cout << std::endl;
+  }
+}
+
+double MemoryCopyMatrix::TimeCopies(uint32_t reps,
+                     const std::function<hsa_status_t(hsa_signal_t)>& issue) {
+  hsa_signal_store_relaxed(signal_, reps);
+
+  Clock::time_point start = Clock::now();
+  for (uint32_t i = 0; i < reps; i++) {
+    if (issue(signal_) != HSA_STATUS_SUCCESS) {
+      // Account for the copies never issued and let the rest drain.
+      hsa_signal_subtract_relaxed(signal_, reps - i);
+      while (hsa_signal_wait_scacquire(signal_, HSA_SIGNAL_CONDITION_EQ, 0,
+                   UINT64_MAX, HSA_WAIT_STATE_BLOCKED) != 0) {
+      }
+      return -1.0;
+    }
+  }
+  while (hsa_signal_wait_scacquire(signal_, HSA_SIGNAL_CONDITION_EQ, 0,
+               UINT64_MAX, HSA_WAIT_STATE_BLOCKED) != 0) {
+  }
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void MemoryCopyMatrix::Sweep(const std::string& name, void* dst, void* src,
+                  const std::function<hsa_status_t(void*, void*, size_t,
+                                                   hsa_signal_t)>& issue,
+                  Method* method) {
+  method->name = name;
+  method->latency_us = -1.0;
+
+  for (size_t size : sizes_) {
+    uint32_t reps = static_cast<uint32_t>(std::min<size_t>(
+        std::max<size_t>(kBytesPerPoint / size, kMinReps), kMaxReps));
+    double t = TimeCopies(reps, [&](hsa_signal_t signal) {
+      return issue(dst, src, size, signal);
+    });
+    method->gbps.push_back((t > 0.0) ? reps * size / t / 1e9 : -1.0);
+  }
+
+  // Latency of the smallest copy, each waited on alone.
+  double total = 0.0;
+  for (uint32_t i = 0; i < kLatencyReps; i++) {
+    double t = TimeCopies(1, [&](hsa_signal_t signal) {
+      return issue(dst, src, sizes_[0], signal);
+    });
+    if (t < 0.0) {
+      return;
+    }
+    total += t;
+  }
+  method->latency_us = total * 1e6 / kLatencyReps;
+}
+
+void MemoryCopyMatrix::RunPair(uint32_t src, uint32_t dst, Pair* pair) {
+  hsa_status_t err;
+  const Endpoint& s = endpoints_[src];
+  const Endpoint& d = endpoints_[dst];
+
+  pair->src = src;
+  pair->dst = dst;
+  pair->bidir_gbps = -1.0;
+
+  // Link hops from the source agent to the destination's memory.
+  uint32_t hops = 0;
+  err = hsa_amd_agent_memory_pool_get_info(s.agent, d.pool,
+            HSA_AMD_AGENT_MEMORY_POOL_INFO_NUM_LINK_HOPS, &hops);
+  if (err == HSA_STATUS_SUCCESS && hops != 0) {
+    pair->links.resize(hops);
+    err = hsa_amd_agent_memory_pool_get_info(s.agent, d.pool,
+              HSA_AMD_AGENT_MEMORY_POOL_INFO_LINK_INFO, &pair->links[0]);
+    if (err != HSA_STATUS_SUCCESS) {
+      pair->links.clear();
+    }
+  }
+
+  // Rect copies pad every row, so buffers are twice the largest size.  The
+  // second pair of buffers carries the reverse direction.
+  const size_t bytes = sizes_.back() * 2;
+  void* src_buf = nullptr;
+  void* dst_buf = nullptr;
+  void* rev_src = nullptr;
+  void* rev_dst = nullptr;
+  ASSERT_EQ(HSA_STATUS_SUCCESS,
+            hsa_amd_memory_pool_allocate(s.pool, bytes, 0, &src_buf));
+  ASSERT_EQ(HSA_STATUS_SUCCESS,
+            hsa_amd_memory_pool_allocate(d.pool, bytes, 0, &dst_buf));
+  ASSERT_EQ(HSA_STATUS_SUCCESS,
+            hsa_amd_memory_pool_allocate(d.pool, bytes, 0, &rev_src));
+  ASSERT_EQ(HSA_STATUS_SUCCESS,
+            hsa_amd_memory_pool_allocate(s.pool, bytes, 0, &rev_dst));
+  void* bufs[] = {src_buf, dst_buf, rev_src, rev_dst};
+  for (void* buf : bufs) {
+    err = hsa_amd_agents_allow_access(gpus_.size(), &gpus_[0], NULL, buf);
+    ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+  }
+
+  hsa_agent_t s_agent = s.agent;
+  hsa_agent_t d_agent = d.agent;
+  bool has_gpu = (s.type == HSA_DEVICE_TYPE_GPU) ||
+                 (d.type == HSA_DEVICE_TYPE_GPU);
+  hsa_agent_t gpu = (s.type == HSA_DEVICE_TYPE_GPU) ? s.agent : d.agent;
+
+  if (!has_gpu) {
+    Method method;
+    Sweep("Default", dst_buf, src_buf,
+          [&](void* to, void* from, size_t size, hsa_signal_t signal) {
+            return hsa_amd_memory_async_copy(to, d_agent, from, s_agent, size,
+                                             0, NULL, signal);
+          }, &method);
+    pair->methods.push_back(method);
+  } else {
+    uint32_t engines = 0;
+    err = hsa_amd_memory_copy_engine_status(d.agent, s.agent, &engines);
+    if (err != HSA_STATUS_SUCCESS) {
+      engines = 0;
+    }
+    for (uint32_t e = 0; e < kMaxEngines; e++) {
+      if ((engines & (1u << e)) == 0) {
+        continue;
+      }
+      hsa_amd_sdma_engine_id_t engine =
+          static_cast<hsa_amd_sdma_engine_id_t>(1u << e);
+      Method method;
+      Sweep("SDMA" + std::to_string(e), dst_buf, src_buf,
+            [&](void* to, void* from, size_t size, hsa_signal_t signal) {
+              return hsa_amd_memory_async_copy_on_engine(to, d_agent, from,
+                         s_agent, size, 0, NULL, signal, engine, true);
+            }, &method);
+      pair->methods.push_back(method);
+    }
+
+    // A copy from the GPU to itself runs as a blit kernel, which reaches the
+    // other side's memory through the access granted above.
+    Method blit;
+    Sweep("Blit", dst_buf, src_buf,
+          [&](void* to, void* from, size_t size, hsa_signal_t signal) {
+            return hsa_amd_memory_async_copy(to, gpu, from, gpu, size, 0,
+                                             NULL, signal);
+          }, &blit);
+    pair->methods.push_back(blit);
+
+    hsa_amd_copy_direction_t dir =
+        (s.type == HSA_DEVICE_TYPE_CPU) ? hsaHostToDevice :
+        ((d.type == HSA_DEVICE_TYPE_CPU) ? hsaDeviceToHost : hsaDeviceToDevice);
+    Method rect;
+    Sweep("Rect", dst_buf, src_buf,
+          [&](void* to, void* from, size_t size, hsa_signal_t signal) {
+            size_t width = std::min(size, kRectRow);
+            size_t rows = size / width;
+            size_t pitch = (rows > 1) ? width + kRectPad : width;
+            hsa_pitched_ptr_t to_ptr = {to, pitch, pitch * rows};
+            hsa_pitched_ptr_t from_ptr = {from, pitch, pitch * rows};
+            hsa_dim3_t offset = {0, 0, 0};
+            hsa_dim3_t range = {static_cast<uint32_t>(width),
+                                static_cast<uint32_t>(rows), 1};
+            return hsa_amd_memory_async_copy_rect(&to_ptr, &offset, &from_ptr,
+                       &offset, &range, gpu, dir, 0, NULL, signal);
+          }, &rect);
+    pair->methods.push_back(rect);
+  }
+
+  // Both directions at once at the largest size, on the runtime's choice of
+  // engines.
+  if (src != dst) {
+    const size_t size = sizes_.back();
+    uint32_t reps = static_cast<uint32_t>(std::min<size_t>(
+        std::max<size_t>(kBytesPerPoint / size, kMinReps), kMaxReps));
+    uint32_t issued = 0;
+    double t = TimeCopies(reps * 2, [&](hsa_signal_t signal) {
+      bool forward = (issued++ % 2) == 0;
+      return forward ?
+          hsa_amd_memory_async_copy(dst_buf, d_agent, src_buf, s_agent, size,
+                                    0, NULL, signal) :
+          hsa_amd_memory_async_copy(rev_dst, s_agent, rev_src, d_agent, size,
+                                    0, NULL, signal);
+    });
+    if (t > 0.0) {
+      pair->bidir_gbps = 2.0 * reps * size / t / 1e9;
+    }
+  }
+
+  for (void* buf : bufs) {
+    hsa_amd_memory_pool_free(buf);
+  }
+}
+
+double MemoryCopyMatrix::BestGbps(const Pair& pair) {
+  double best = -1.0;
+  for (const Method& method : pair.methods) {
+    for (double gbps : method.gbps) {
+      best = std::max(best, gbps);
+    }
+  }
+  return best;
+}
+
+void MemoryCopyMatrix::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void MemoryCopyMatrix::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << std::fixed << std::setprecision(2);
+
+  // Best GB/s of each pair, source down and destination across.
+  std::cout << "Best GB/s (src \\ dst)" << std::endl << std::setw(8) << "";
+  for (const Endpoint& ep : endpoints_) {
+    std::cout << std::setw(10) << ep.name;
+  }
+  std::cout << std::endl;
+  for (uint32_t src = 0; src < endpoints_.size(); src++) {
+    std::cout << std::setw(8) << endpoints_[src].name;
+    for (uint32_t dst = 0; dst < endpoints_.size(); dst++) {
+      std::string cell = "-";
+      for (const Pair& pair : results_) {
+        if (pair.src == src && pair.dst == dst) {
+          std::ostringstream gbps;
+          gbps << std::fixed << std::setprecision(2) << BestGbps(pair);
+          cell = gbps.str();
+        }
+      }
+      std::cout << std::setw(10) << cell;
+    }
+    std::cout << std::endl;
+  }
+
+  for (const Pair& pair : results_) {
+    std::cout << std::endl << endpoints_[pair.src].name << " -> "
+              << endpoints_[pair.dst].name << ":";
+    if (pair.links.empty()) {
+      std::cout << " no link info";
+    }
+    for (const hsa_amd_memory_pool_link_info_t& link : pair.links) {
+      std::cout << " [" << LinkName(link.link_type) << ", "
+                << link.min_bandwidth << "-" << link.max_bandwidth
+                << " MB/s, numa " << link.numa_distance << "]";
+    }
+    std::cout << std::endl;
+
+    std::cout << "  " << std::setw(8) << "method";
+    for (size_t size : sizes_) {
+      std::cout << std::setw(10) << (std::to_string(size / 1024) + "K");
+    }
+    std::cout << std::setw(12) << "lat (uS)" << std::endl;
+    for (const Method& method : pair.methods) {
+      std::cout << "  " << std::setw(8) << method.name;
+      for (double gbps : method.gbps) {
+        if (gbps < 0.0) {
+          std::cout << std::setw(10) << "n/a";
+        } else {
+          std::cout << std::setw(10) << gbps;
+        }
+      }
+      if (method.latency_us < 0.0) {
+        std::cout << std::setw(12) << "n/a";
+      } else {
+        std::cout << std::setw(12) << method.latency_us;
+      }
+      std::cout << std::endl;
+    }
+    if (pair.bidir_gbps >= 0.0) {
+      std::cout << "  Bidirectional: " << pair.bidir_gbps << " GB/s"
+                << std::endl;
+    }
+
+    const std::string name = endpoints_[pair.src].name + " -> " + endpoints_[pair.dst].name;
+    ReportMetric(name + " best", "GB/s", BestGbps(pair), true);
+    if (pair.bidir_gbps >= 0.0) {
+      ReportMetric(name + " bidirectional", "GB/s", pair.bidir_gbps, true);
+    }
+  }
+
+  std::cout.unsetf(std::ios_base::floatfield);
+  std::cout << std::setprecision(6);
+  return;
+}
+
+void MemoryCopyMatrix::Close() {
+  if (signal_.handle != 0) {
+    hsa_signal_destroy(signal_);
+    signal_.handle = 0;
+  }
+  TestBase::Close();
+  return;
+}
@@ -0,0 +1,147 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_MEMORY_COPY_MATRIX_H_
+#define ROCRTST_SUITES_PERFORMANCE_MEMORY_COPY_MATRIX_H_
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "common/base_rocr.h"
+#include "common/common.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+// @Brief: This class is defined to measure copy bandwidth and latency between
+// every pair of agents: per SDMA engine, through blit kernels, with traffic
+// in both directions at once and as rect copies, over a sweep of sizes.  The
+// report annotates each pair with the link hops the runtime reports, to check
+// node health and engine load balancing.
+
+class MemoryCopyMatrix : public TestBase {
+ public:
+  // @Brief: Constructor
+  MemoryCopyMatrix(void);
+
+  // @Brief: Destructor
+  virtual ~MemoryCopyMatrix(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: An agent and the pool copies to and from it use
+  struct Endpoint {
+    hsa_agent_t agent;
+    hsa_device_type_t type;
+    hsa_amd_memory_pool_t pool;
+    std::string name;
+  };
+
+  // @Brief: One copy method's bandwidth in GB/s per swept size, and latency
+  // of the smallest copy in uS
+  struct Method {
+    std::string name;
+    std::vector<double> gbps;
+    double latency_us;
+  };
+
+  // @Brief: Everything measured from one endpoint to another
+  struct Pair {
+    uint32_t src;
+    uint32_t dst;
+    std::vector<hsa_amd_memory_pool_link_info_t> links;
+    std::vector<Method> methods;
+    // @Brief: Aggregate GB/s of the largest size copied both ways at once
+    double bidir_gbps;
+  };
+
+  // @Brief: Measure all methods between two endpoints
+  void RunPair(uint32_t src, uint32_t dst, Pair* pair);
+
+  // @Brief: Sweep sizes with issue(dst, src, size, signal) and return the
+  // result as a method
+  void Sweep(const std::string& name, void* dst, void* src,
+             const std::function<hsa_status_t(void*, void*, size_t,
+                                              hsa_signal_t)>& issue,
+             Method* method);
+
+  // @Brief: Seconds for reps back to back copies issued by issue()
+  double TimeCopies(uint32_t reps,
+                    const std::function<hsa_status_t(hsa_signal_t)>& issue);
+
+  // @Brief: Best bandwidth of a pair over all methods
+  static double BestGbps(const Pair& pair);
+
+  // @Brief: Agents and pools under test
+  std::vector<Endpoint> endpoints_;
+
+  // @Brief: GPU agents, granted access to every buffer
+  std::vector<hsa_agent_t> gpus_;
+
+  // @Brief: Sizes swept for every method
+  std::vector<size_t> sizes_;
+
+  // @Brief: Completion signal shared by all copies
+  hsa_signal_t signal_;
+
+  // @Brief: Measured pairs
+  std::vector<Pair> results_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_MEMORY_COPY_MATRIX_H_
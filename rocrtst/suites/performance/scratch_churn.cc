@@ -0,0 +1,367 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "suites/performance/scratch_churn.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "common/os.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+static const uint32_t kNumQueues = 4;
+static const uint32_t kGridSize = 64 * 1024;
+static const uint32_t kWorkGroupSize = 256;
+
+// Per work-item private segment sizes, in bytes.
+static const uint32_t kGrowingSizes[] = {1024, 2048, 4096, 8192, 16384};
+static const uint32_t kChurnSizes[] = {1024, 3072, 6144, 12288, 16384};
+
+// Scratch usage is sampled this often for this long once queues go idle.
+static const uint32_t kReclaimPollMs = 10;
+static const uint32_t kReclaimWindowMs = 2000;
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+ScratchChurn::ScratchChurn(bool async_reclaim, bool alt)
+    : TestBase(), async_reclaim_(async_reclaim), alt_(alt), out_(nullptr) {
+#ifdef ROCRTST_EMULATOR_BUILD
+  iterations_ = 2;
+#else
+  iterations_ = 50;
+#endif
+
+  set_kernel_file_name("scratch_kernels.hsaco");
+  set_kernel_name("scratch_kernel");
+
+  std::string variant = std::string(" (async reclaim ") + (async_reclaim ? "on" : "off") +
+      ", alt " + (alt ? "on" : "off") + ")";
+  set_title("Scratch Allocation Churn" + variant);
+  set_description("This test dispatches a scratch using kernel with growing "
+      "and varying private segment sizes across several queues. It reports "
+      "the cost of the first dispatch at a new size, which includes the "
+      "runtime handling insufficient scratch, churn throughput, and the "
+      "scratch memory reserved, in use and cached by the agent, including "
+      "how it is reclaimed once queues go idle.");
+}
+
+ScratchChurn::~ScratchChurn() {
+}
+
+void ScratchChurn::SetUp() {
+  hsa_status_t err;
+
+  // Scratch policy flags are read by hsa_init.
+  rocrtst::SetEnv("HSA_ENABLE_SCRATCH_ASYNC_RECLAIM", async_reclaim_ ? "1" : "0");
+  rocrtst::SetEnv("HSA_ENABLE_SCRATCH_ALT", alt_ ? "1" : "0");
+
+  TestBase::SetUp();
+
+  err = SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  err = SetPoolsTypical(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_agent_t* gpu_dev = gpu_device1();
+
+  for (uint32_t q = 0; q < kNumQueues; q++) {
+    hsa_queue_t* queue = nullptr;
+    err = rocrtst::CreateQueue(*gpu_dev, &queue, 1024);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+    queues_.push_back(queue);
+
+    hsa_signal_t signal;
+    err = hsa_signal_create(0, 0, NULL, &signal);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+    signals_.push_back(signal);
+  }
+
+  err = rocrtst::LoadKernelFromObjFile(this, gpu_dev);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  err = hsa_amd_memory_pool_allocate(device_pool(), kGridSize * sizeof(int), 0,
+                                     reinterpret_cast<void**>(&out_));
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  struct __attribute__((aligned(16))) {
+    int* out;
+    int n;
+  } args;
+  args.out = out_;
+  args.n = 1;
+  err = rocrtst::AllocAndSetKernArgs(this, &args, sizeof(args));
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  err = rocrtst::InitializeAQLPacket(this, &aql());
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  aql().workgroup_size_x = kWorkGroupSize;
+  aql().grid_size_x = kGridSize;
+}
+
+void ScratchChurn::Dispatch(uint32_t q, uint32_t private_size) {
+  hsa_queue_t* queue = queues_[q];
+  const uint32_t queue_mask = queue->size - 1;
+  hsa_kernel_dispatch_packet_t* q_base_addr =
+      reinterpret_cast<hsa_kernel_dispatch_packet_t*>(queue->base_address);
+  const uint16_t header =
+      (HSA_PACKET_TYPE_KERNEL_DISPATCH << HSA_PACKET_HEADER_TYPE) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+
+  hsa_kernel_dispatch_packet_t packet = aql();
+  packet.private_segment_size = std::max(private_size, aql().private_segment_size);
+  packet.completion_signal = signals_[q];
+  hsa_signal_store_relaxed(signals_[q], 1);
+
+  uint64_t index = hsa_queue_add_write_index_relaxed(queue, 1);
+  rocrtst::WriteAQLToQueueLoc(queue, index, &packet);
+  rocrtst::AtomicSetPacketHeader(header, packet.setup, &q_base_addr[index & queue_mask]);
+  hsa_signal_store_screlease(queue->doorbell_signal, index);
+}
+
+void ScratchChurn::Wait(uint32_t q) {
+  while (hsa_signal_wait_scacquire(signals_[q], HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX,
+                                   HSA_WAIT_STATE_BLOCKED) != 0) {
+  }
+}
+
+ScratchChurn::Usage ScratchChurn::GetUsage(void) {
+  Usage usage = {0, 0, 0};
+  hsa_agent_t agent = *gpu_device1();
+  hsa_agent_get_info(agent,
+                     static_cast<hsa_agent_info_t>(HSA_AMD_AGENT_INFO_SCRATCH_RESERVED_SIZE),
+                     &usage.reserved);
+  hsa_agent_get_info(agent, static_cast<hsa_agent_info_t>(HSA_AMD_AGENT_INFO_SCRATCH_IN_USE_SIZE),
+                     &usage.in_use);
+  hsa_agent_get_info(agent, static_cast<hsa_agent_info_t>(HSA_AMD_AGENT_INFO_SCRATCH_CACHED_SIZE),
+                     &usage.cached);
+  return usage;
+}
+
+void ScratchChurn::Run(void) {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+
+  RunGrowing();
+  RunChurn();
+  RunReclaim();
+}
+
+void ScratchChurn::RunGrowing(void) {
+  // Warm up each queue without scratch beyond the kernel's own.
+  for (uint32_t q = 0; q < kNumQueues; q++) {
+    Dispatch(q, 0);
+    Wait(q);
+  }
+
+  for (uint32_t size : kGrowingSizes) {
+    for (uint32_t q = 0; q < kNumQueues; q++) {
+      Clock::time_point start = Clock::now();
+      Dispatch(q, size);
+      Wait(q);
+      double first = Seconds(start, Clock::now());
+
+      double repeat = 0.0;
+      for (uint32_t i = 0; i < iterations_; i++) {
+        start = Clock::now();
+        Dispatch(q, size);
+        Wait(q);
+        repeat += Seconds(start, Clock::now());
+      }
+
+      Row row;
+      row.name = "Grow to " + std::to_string(size) + " B, queue " + std::to_string(q);
+      row.time = first;
+      row.baseline = repeat / iterations_;
+      row.usage = GetUsage();
+      results_.push_back(row);
+    }
+  }
+}
+
+void ScratchChurn::RunChurn(void) {
+  const uint32_t num_sizes = sizeof(kChurnSizes) / sizeof(kChurnSizes[0]);
+  const uint32_t rounds = iterations_ * 4;
+
+  // Fixed LCG so every variant sees the same sequence.
+  uint32_t seed = 12345;
+  size_t peak_reserved = 0;
+
+  Clock::time_point start = Clock::now();
+  for (uint32_t r = 0; r < rounds; r++) {
+    for (uint32_t q = 0; q < kNumQueues; q++) {
+      seed = seed * 1103515245 + 12345;
+      Dispatch(q, kChurnSizes[(seed >> 16) % num_sizes]);
+    }
+    for (uint32_t q = 0; q < kNumQueues; q++) {
+      Wait(q);
+    }
+    peak_reserved = std::max(peak_reserved, GetUsage().reserved);
+  }
+  double elapsed = Seconds(start, Clock::now());
+
+  Row row;
+  row.name = "Churn, " + std::to_string(rounds * kNumQueues) + " dispatches, per dispatch";
+  row.time = elapsed / (rounds * kNumQueues);
+  row.baseline = 0.0;
+  row.usage = GetUsage();
+  results_.push_back(row);
+
+  row.name = "Churn, peak reserved";
+  row.time = 0.0;
+  row.usage.reserved = peak_reserved;
+  results_.push_back(row);
+}
+
+void ScratchChurn::RunReclaim(void) {
+  // Scratch held while idle, sampled until it stops changing or the window
+  // closes.
+  Usage last = GetUsage();
+  Clock::time_point start = Clock::now();
+  Clock::time_point changed = start;
+  while (Seconds(start, Clock::now()) * 1000 < kReclaimWindowMs) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(kReclaimPollMs));
+    Usage now = GetUsage();
+    if (now.reserved != last.reserved || now.in_use != last.in_use ||
+        now.cached != last.cached) {
+      changed = Clock::now();
+      last = now;
+    }
+  }
+
+  Row row;
+  row.name = "Idle, last change after";
+  row.time = Seconds(start, changed);
+  row.baseline = 0.0;
+  row.usage = last;
+  results_.push_back(row);
+
+  // A large request on one queue has to reclaim what the idle queues hold.
+  const uint32_t largest = kGrowingSizes[sizeof(kGrowingSizes) / sizeof(kGrowingSizes[0]) - 1];
+  start = Clock::now();
+  Dispatch(0, largest * 2);
+  Wait(0);
+  row.name = "Single queue " + std::to_string(largest * 2) + " B after idle";
+  row.time = Seconds(start, Clock::now());
+  row.usage = GetUsage();
+  results_.push_back(row);
+}
+
+void ScratchChurn::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void ScratchChurn::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  std::cout << std::left << std::setw(46) << "Step" << std::right
+            << std::setw(11) << "time(uS)" << std::setw(11) << "base(uS)"
+            << std::setw(12) << "resv(MB)" << std::setw(12) << "used(MB)"
+            << std::setw(12) << "cache(MB)" << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  for (const Row& row : results_) {
+    std::cout << std::left << std::setw(46) << row.name << std::right;
+    if (row.time > 0.0) {
+      std::cout << std::setw(11) << row.time * 1000000.0;
+    } else {
+      std::cout << std::setw(11) << "-";
+    }
+    if (row.baseline > 0.0) {
+      std::cout << std::setw(11) << row.baseline * 1000000.0;
+    } else {
+      std::cout << std::setw(11) << "-";
+    }
+    std::cout << std::setw(12) << row.usage.reserved / (1024.0 * 1024.0)
+              << std::setw(12) << row.usage.in_use / (1024.0 * 1024.0)
+              << std::setw(12) << row.usage.cached / (1024.0 * 1024.0) << std::endl;
+
+    if (row.time > 0.0) {
+      ReportMetric(row.name, "uS", row.time * 1e6, false);
+    }
+  }
+  std::cout << std::defaultfloat;
+}
+
+void ScratchChurn::Close() {
+  hsa_status_t err;
+
+  for (hsa_queue_t* queue : queues_) {
+    err = hsa_queue_destroy(queue);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  }
+  queues_.clear();
+  for (hsa_signal_t signal : signals_) {
+    hsa_signal_destroy(signal);
+  }
+  signals_.clear();
+  if (out_ != nullptr) {
+    hsa_amd_memory_pool_free(out_);
+    out_ = nullptr;
+  }
+
+  TestBase::Close();
+}
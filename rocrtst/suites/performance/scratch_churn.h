@@ -0,0 +1,140 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_SCRATCH_CHURN_H_
+#define ROCRTST_SUITES_PERFORMANCE_SCRATCH_CHURN_H_
+#include <string>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "common/base_rocr.h"
+#include "common/common.h"
+#include "hsa/hsa.h"
+
+// @Brief: This class is defined to measure scratch allocation behavior:
+// dispatches with growing and varying private segment sizes across several
+// queues, reporting the cost of the first dispatch at a new size (scratch
+// allocation), churn throughput and the scratch memory reserved, in use and
+// cached by the agent, including how it is reclaimed once queues go idle.
+
+class ScratchChurn : public TestBase {
+ public:
+  // @Brief: Constructor, selects HSA_ENABLE_SCRATCH_ASYNC_RECLAIM and
+  // HSA_ENABLE_SCRATCH_ALT for the run
+  ScratchChurn(bool async_reclaim, bool alt);
+
+  // @Brief: Destructor
+  virtual ~ScratchChurn(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: Scratch memory of the agent, in bytes
+  struct Usage {
+    size_t reserved;
+    size_t in_use;
+    size_t cached;
+  };
+
+  // @Brief: One row of results
+  struct Row {
+    std::string name;
+    // @Brief: Time in seconds, 0 if not measured
+    double time;
+    // @Brief: Baseline time in seconds, 0 if not measured
+    double baseline;
+    Usage usage;
+  };
+
+  // @Brief: Write a dispatch with the given private segment size to queue q
+  // and ring its doorbell
+  void Dispatch(uint32_t q, uint32_t private_size);
+
+  // @Brief: Wait for the last dispatch on queue q
+  void Wait(uint32_t q);
+
+  // @Brief: Read the agent's scratch usage
+  Usage GetUsage(void);
+
+  // @Brief: First dispatch at each growing size on each queue against a
+  // repeat dispatch at the same size
+  void RunGrowing(void);
+
+  // @Brief: Dispatches with pseudo random sizes on all queues at once
+  void RunChurn(void);
+
+  // @Brief: Scratch usage over time once every queue is idle, then after a
+  // large dispatch on a single queue
+  void RunReclaim(void);
+
+  bool async_reclaim_;
+  bool alt_;
+
+  // @Brief: Number of times each measurement is repeated
+  uint32_t iterations_;
+
+  std::vector<hsa_queue_t*> queues_;
+  std::vector<hsa_signal_t> signals_;
+
+  // @Brief: Kernel output buffer, one int per work-item
+  int* out_;
+
+  std::vector<Row> results_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_SCRATCH_CHURN_H_
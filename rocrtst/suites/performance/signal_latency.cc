@@ -0,0 +1,434 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "suites/performance/signal_latency.h"
+#include "common/base_rocr_utils.h"
+#include "common/common.h"
+#include "common/helper_funcs.h"
+#include "gtest/gtest.h"
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+static const uint32_t kWaitAnyCounts[] = {1, 10, 100, 1000, 10000};
+static const uint32_t kHandlerCounts[] = {1, 100, 10000};
+
+// Histogram rows double in width from 1 uS up to 2^kHistogramRows uS.
+static const int kHistogramRows = 20;
+static const int kHistogramBar = 50;
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  size_t idx = static_cast<size_t>(p * sorted.size());
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+SignalLatency::SignalLatency(void) : TestBase() {
+#ifdef ROCRTST_EMULATOR_BUILD
+  samples_ = 10;
+#else
+  samples_ = 10000;
+#endif
+
+  memset(&aql(), 0, sizeof(hsa_kernel_dispatch_packet_t));
+
+  set_kernel_file_name("dispatch_time_kernels.hsaco");
+  set_kernel_name("empty_kernel");
+
+  set_title("Signal Wait and Wake Latency");
+  set_description("This test measures signal latency with interrupts "
+      "enabled: from a kernel's end timestamp to the host waking on its "
+      "completion signal, host to host signal ping-pong, "
+      "hsa_amd_signal_wait_any wake over 1 to 10000 signals and async "
+      "signal handler latency and throughput. Each is shown as a histogram.");
+}
+
+SignalLatency::~SignalLatency() {
+}
+
+void SignalLatency::SetUp() {
+  hsa_status_t err;
+
+  // Waits must sleep on interrupts for wake latency to mean anything.
+  set_enable_interrupt(true);
+
+  TestBase::SetUp();
+
+  err = SetDefaultAgents(this);
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  hsa_agent_t* gpu_dev = gpu_device1();
+
+  hsa_queue_t* q = nullptr;
+  err = rocrtst::CreateQueue(*gpu_dev, &q);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  ASSERT_NE(q, nullptr);
+  set_main_queue(q);
+
+  err = hsa_amd_profiling_set_profiler_enabled(q, 1);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  err = rocrtst::LoadKernelFromObjFile(this, gpu_dev);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  // Fill up the kernel packet except header
+  err = rocrtst::InitializeAQLPacket(this, &aql());
+  ASSERT_EQ(HSA_STATUS_SUCCESS, err);
+
+  aql().workgroup_size_x = 1;
+  aql().grid_size_x = 1;
+}
+
+void SignalLatency::Run() {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::Run();
+
+  RunGpuToHost();
+  RunHostToHost();
+  for (uint32_t count : kWaitAnyCounts) {
+    RunWaitAny(count);
+  }
+  for (uint32_t count : kHandlerCounts) {
+    RunAsyncHandler(count);
+  }
+}
+
+void SignalLatency::RunGpuToHost(void) {
+  hsa_status_t err;
+  Series series;
+  series.name = "GPU to host wake";
+  series.throughput = 0.0;
+
+  uint64_t freq = 0;
+  err = hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY, &freq);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  hsa_queue_t* queue = main_queue();
+  const uint32_t queue_mask = queue->size - 1;
+  hsa_kernel_dispatch_packet_t* q_base_addr =
+      reinterpret_cast<hsa_kernel_dispatch_packet_t*>(queue->base_address);
+  const uint16_t header =
+      (HSA_PACKET_TYPE_KERNEL_DISPATCH << HSA_PACKET_HEADER_TYPE) |
+      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+
+  for (uint32_t i = 0; i < samples_; i++) {
+    hsa_signal_store_relaxed(aql().completion_signal, 1);
+
+    uint64_t index = hsa_queue_add_write_index_relaxed(queue, 1);
+    rocrtst::WriteAQLToQueueLoc(queue, index, &aql());
+    rocrtst::AtomicSetPacketHeader(header, aql().setup,
+                                   &q_base_addr[index & queue_mask]);
+    hsa_signal_store_screlease(queue->doorbell_signal, index);
+
+    while (hsa_signal_wait_scacquire(aql().completion_signal,
+                 HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX,
+                 HSA_WAIT_STATE_BLOCKED) != 0) {
+    }
+    uint64_t woke = 0;
+    err = hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP, &woke);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+    // Dispatch times are returned in the system timestamp domain.
+    hsa_amd_profiling_dispatch_time_t time;
+    err = hsa_amd_profiling_get_dispatch_time(*gpu_device1(),
+                                              aql().completion_signal, &time);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+    uint64_t ticks = (woke > time.end) ? woke - time.end : 0;
+    series.samples.push_back(static_cast<double>(ticks) / freq);
+  }
+
+  results_.push_back(series);
+}
+
+void SignalLatency::RunHostToHost(void) {
+  hsa_status_t err;
+  Series series;
+  series.name = "Host to host wake";
+
+  hsa_signal_t ping, pong;
+  err = hsa_signal_create(1, 0, NULL, &ping);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  err = hsa_signal_create(1, 0, NULL, &pong);
+  ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+
+  const uint32_t samples = samples_;
+  std::thread echo([&]() {
+    for (uint32_t i = 0; i < samples; i++) {
+      while (hsa_signal_wait_scacquire(ping, HSA_SIGNAL_CONDITION_EQ, 0,
+                   UINT64_MAX, HSA_WAIT_STATE_BLOCKED) != 0) {
+      }
+      hsa_signal_store_relaxed(ping, 1);
+      hsa_signal_store_screlease(pong, 0);
+    }
+  });
+
+  Clock::time_point begin = Clock::now();
+  for (uint32_t i = 0; i < samples; i++) {
+    Clock::time_point start = Clock::now();
+    hsa_signal_store_screlease(ping, 0);
+    while (hsa_signal_wait_scacquire(pong, HSA_SIGNAL_CONDITION_EQ, 0,
+                 UINT64_MAX, HSA_WAIT_STATE_BLOCKED) != 0) {
+    }
+    hsa_signal_store_relaxed(pong, 1);
+    series.samples.push_back(Seconds(start, Clock::now()) / 2);
+  }
+  series.throughput = 2 * samples / Seconds(begin, Clock::now());
+  echo.join();
+
+  hsa_signal_destroy(ping);
+  hsa_signal_destroy(pong);
+  results_.push_back(series);
+}
+
+void SignalLatency::RunWaitAny(uint32_t count) {
+  hsa_status_t err;
+  Series series;
+  series.name = "Wait any, " + std::to_string(count) + " signals";
+  series.throughput = 0.0;
+
+  std::vector<hsa_signal_t> signals(count);
+  std::vector<hsa_signal_condition_t> conds(count, HSA_SIGNAL_CONDITION_EQ);
+  std::vector<hsa_signal_value_t> values(count, 0);
+  for (uint32_t i = 0; i < count; i++) {
+    err = hsa_signal_create(1, 0, NULL, &signals[i]);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  }
+
+  // The setter waits for the waiter to be armed, then gives it time to fall
+  // asleep so the sample covers a real wake.
+  const uint32_t samples = std::min(samples_, 1000u);
+  std::atomic<uint32_t> armed(0);
+  std::atomic<int64_t> stored(0);
+  std::thread setter([&]() {
+    for (uint32_t i = 0; i < samples; i++) {
+      while (armed.load() != i + 1) {
+        std::this_thread::yield();
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      stored.store(Clock::now().time_since_epoch().count());
+      hsa_signal_store_screlease(signals[(i * 7919u) % count], 0);
+    }
+  });
+
+  for (uint32_t i = 0; i < samples; i++) {
+    armed.store(i + 1);
+    hsa_signal_value_t value;
+    uint32_t idx = hsa_amd_signal_wait_any(count, &signals[0], &conds[0],
+                       &values[0], UINT64_MAX, HSA_WAIT_STATE_BLOCKED, &value);
+    Clock::time_point woke = Clock::now();
+    ASSERT_LT(idx, count);
+    Clock::time_point start(Clock::duration(stored.load()));
+    series.samples.push_back(Seconds(start, woke));
+    hsa_signal_store_relaxed(signals[idx], 1);
+  }
+  setter.join();
+
+  for (hsa_signal_t s : signals) {
+    hsa_signal_destroy(s);
+  }
+  results_.push_back(series);
+}
+
+namespace {
+struct HandlerSample {
+  Clock::time_point stored;
+  Clock::time_point ran;
+  std::atomic<uint32_t>* done;
+};
+}  // namespace
+
+static bool LatencyHandler(hsa_signal_value_t value, void* arg) {
+  HandlerSample* sample = reinterpret_cast<HandlerSample*>(arg);
+  sample->ran = Clock::now();
+  sample->done->fetch_add(1);
+  return false;
+}
+
+void SignalLatency::RunAsyncHandler(uint32_t count) {
+  hsa_status_t err;
+  Series series;
+  series.name = "Async handler, " + std::to_string(count) + " handlers";
+
+  std::vector<hsa_signal_t> signals(count);
+  for (uint32_t i = 0; i < count; i++) {
+    err = hsa_signal_create(1, 0, NULL, &signals[i]);
+    ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+  }
+
+  std::atomic<uint32_t> done(0);
+  std::vector<HandlerSample> handlers(count);
+  const uint32_t rounds = std::max(samples_ / count, 1u);
+  double busy = 0.0;
+
+  for (uint32_t r = 0; r < rounds; r++) {
+    done.store(0);
+    for (uint32_t i = 0; i < count; i++) {
+      hsa_signal_store_relaxed(signals[i], 1);
+      handlers[i].done = &done;
+      err = hsa_amd_signal_async_handler(signals[i], HSA_SIGNAL_CONDITION_EQ,
+                                         0, LatencyHandler, &handlers[i]);
+      ASSERT_EQ(err, HSA_STATUS_SUCCESS);
+    }
+
+    Clock::time_point first = Clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+      handlers[i].stored = Clock::now();
+      hsa_signal_store_screlease(signals[i], 0);
+    }
+    while (done.load() != count) {
+      std::this_thread::yield();
+    }
+
+    Clock::time_point last = first;
+    for (const HandlerSample& h : handlers) {
+      series.samples.push_back(Seconds(h.stored, h.ran));
+      last = std::max(last, h.ran);
+    }
+    busy += Seconds(first, last);
+  }
+  series.throughput = (busy > 0.0) ? rounds * count / busy : 0.0;
+
+  for (hsa_signal_t s : signals) {
+    hsa_signal_destroy(s);
+  }
+  results_.push_back(series);
+}
+
+void SignalLatency::PrintHistogram(const Series& series) {
+  std::vector<double> sorted(series.samples);
+  std::sort(sorted.begin(), sorted.end());
+
+  std::cout << series.name << ": " << sorted.size() << " samples, p50 "
+            << Percentile(sorted, 0.50) * 1e6 << " uS, p99 "
+            << Percentile(sorted, 0.99) * 1e6 << " uS, p999 "
+            << Percentile(sorted, 0.999) * 1e6 << " uS, max "
+            << (sorted.empty() ? 0.0 : sorted.back() * 1e6) << " uS";
+  if (series.throughput != 0.0) {
+    std::cout << ", " << series.throughput << " events/s";
+  }
+  std::cout << std::endl;
+
+  // Row 0 holds samples under 1 uS, row k those in [2^(k-1), 2^k) uS and the
+  // last row everything longer.
+  std::vector<uint32_t> rows(kHistogramRows + 1, 0);
+  for (double s : sorted) {
+    double us = s * 1e6;
+    int row = 0;
+    while (row < kHistogramRows && us >= 1.0) {
+      us /= 2;
+      row++;
+    }
+    rows[row]++;
+  }
+
+  uint32_t peak = *std::max_element(rows.begin(), rows.end());
+  int lo = 0, hi = kHistogramRows;
+  while (lo < hi && rows[lo] == 0) lo++;
+  while (hi > lo && rows[hi] == 0) hi--;
+  for (int row = lo; row <= hi && peak != 0; row++) {
+    uint64_t from = (row == 0) ? 0 : (1ull << (row - 1));
+    uint64_t to = 1ull << row;
+    std::cout << "  [" << std::setw(7) << from << ", " << std::setw(7);
+    if (row == kHistogramRows) {
+      std::cout << "inf";
+    } else {
+      std::cout << to;
+    }
+    std::cout << ") uS " << std::setw(8) << rows[row] << " "
+              << std::string(rows[row] * kHistogramBar / peak, '#')
+              << std::endl;
+  }
+}
+
+void SignalLatency::DisplayTestInfo(void) {
+  TestBase::DisplayTestInfo();
+}
+
+void SignalLatency::DisplayResults(void) const {
+  if (!rocrtst::CheckProfile(this)) {
+    return;
+  }
+
+  TestBase::DisplayResults();
+
+  for (const Series& series : results_) {
+    PrintHistogram(series);
+
+    std::vector<double> us;
+    for (double s : series.samples) {
+      us.push_back(s * 1e6);
+    }
+    ReportMetric(series.name + " latency", "uS", us, false);
+    if (series.throughput > 0.0) {
+      ReportMetric(series.name + " throughput", "events/s", series.throughput, true);
+    }
+  }
+  return;
+}
+
+void SignalLatency::Close() {
+  TestBase::Close();
+  return;
+}
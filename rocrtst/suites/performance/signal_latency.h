@@ -0,0 +1,118 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_PERFORMANCE_SIGNAL_LATENCY_H_
+#define ROCRTST_SUITES_PERFORMANCE_SIGNAL_LATENCY_H_
+#include <string>
+#include <vector>
+
+#include "suites/test_common/test_base.h"
+#include "common/base_rocr.h"
+#include "common/common.h"
+#include "hsa/hsa.h"
+
+// @Brief: This class is defined to measure signal wait and wake latency:
+// GPU completion to host wake, host to host wake, hsa_amd_signal_wait_any
+// over growing signal counts and async signal handler latency and throughput.
+// Latencies are reported as log2 histograms.
+
+class SignalLatency : public TestBase {
+ public:
+  // @Brief: Constructor
+  SignalLatency(void);
+
+  // @Brief: Destructor
+  virtual ~SignalLatency(void);
+
+  // @Brief: Set up the environment for the test
+  virtual void SetUp(void);
+
+  // @Brief: Run the test case
+  virtual void Run(void);
+
+  // @Brief: Display  results we got
+  virtual void DisplayResults(void) const;
+
+  // @Brief: Display information about what this test does
+  virtual void DisplayTestInfo(void);
+
+  // @Brief: Clean up and close the runtime
+  virtual void Close(void);
+
+ private:
+  // @Brief: Latency samples of one measurement, in seconds
+  struct Series {
+    std::string name;
+    std::vector<double> samples;
+    // @Brief: Events per second, 0 if not measured
+    double throughput;
+  };
+
+  // @Brief: Time from a kernel's end timestamp to the waiting host thread
+  // waking on its completion signal
+  void RunGpuToHost(void);
+
+  // @Brief: Half the round trip of two host threads ping-ponging signals
+  void RunHostToHost(void);
+
+  // @Brief: Time from a store to one of count signals to
+  // hsa_amd_signal_wait_any returning
+  void RunWaitAny(uint32_t count);
+
+  // @Brief: Time from a store to its async handler running, with count
+  // handlers registered at once
+  void RunAsyncHandler(uint32_t count);
+
+  // @Brief: Print samples as a log2 histogram in microseconds
+  static void PrintHistogram(const Series& series);
+
+  // @Brief: Number of samples taken per measurement
+  uint32_t samples_;
+
+  // @Brief: Measured series
+  std::vector<Series> results_;
+};
+
+#endif  // ROCRTST_SUITES_PERFORMANCE_SIGNAL_LATENCY_H_
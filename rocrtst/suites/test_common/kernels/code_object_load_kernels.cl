@@ -0,0 +1,79 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+// 10000 small kernels named big_0000 to big_9999, used to measure code
+// object loading and symbol lookup at scale.  Each kernel writes its own
+// index so the compiler cannot fold them together.
+
+#define BIG_KERNEL(name, idx)                                                  \
+  __kernel void name(__global int* out) { out[get_global_id(0)] = idx; }
+
+#define BIG_KERNEL_1(n) BIG_KERNEL(big_##n, 1##n)
+#define BIG_KERNEL_10(n)                                                       \
+  BIG_KERNEL_1(n##0) BIG_KERNEL_1(n##1) BIG_KERNEL_1(n##2)                     \
+  BIG_KERNEL_1(n##3) BIG_KERNEL_1(n##4) BIG_KERNEL_1(n##5)                     \
+  BIG_KERNEL_1(n##6) BIG_KERNEL_1(n##7) BIG_KERNEL_1(n##8)                     \
+  BIG_KERNEL_1(n##9)
+#define BIG_KERNEL_100(n)                                                      \
+  BIG_KERNEL_10(n##0) BIG_KERNEL_10(n##1) BIG_KERNEL_10(n##2)                  \
+  BIG_KERNEL_10(n##3) BIG_KERNEL_10(n##4) BIG_KERNEL_10(n##5)                  \
+  BIG_KERNEL_10(n##6) BIG_KERNEL_10(n##7) BIG_KERNEL_10(n##8)                  \
+  BIG_KERNEL_10(n##9)
+#define BIG_KERNEL_1000(n)                                                     \
+  BIG_KERNEL_100(n##0) BIG_KERNEL_100(n##1) BIG_KERNEL_100(n##2)               \
+  BIG_KERNEL_100(n##3) BIG_KERNEL_100(n##4) BIG_KERNEL_100(n##5)               \
+  BIG_KERNEL_100(n##6) BIG_KERNEL_100(n##7) BIG_KERNEL_100(n##8)               \
+  BIG_KERNEL_100(n##9)
+
+BIG_KERNEL_1000(0)
+BIG_KERNEL_1000(1)
+BIG_KERNEL_1000(2)
+BIG_KERNEL_1000(3)
+BIG_KERNEL_1000(4)
+BIG_KERNEL_1000(5)
+BIG_KERNEL_1000(6)
+BIG_KERNEL_1000(7)
+BIG_KERNEL_1000(8)
+BIG_KERNEL_1000(9)
@@ -59,9 +59,19 @@
 #include "suites/functional/deallocation_notifier.h"
 #include "suites/functional/virtual_memory.h"
 #include "suites/performance/dispatch_time.h"
+#include "suites/performance/dispatch_throughput.h"
 #include "suites/performance/memory_async_copy.h"
+#include "suites/performance/memory_alloc_map.h"
 #include "suites/performance/memory_async_copy_numa.h"
+#include "suites/performance/memory_copy_matrix.h"
+#include "suites/performance/signal_latency.h"
+#include "suites/performance/init_time.h"
+#include "suites/performance/code_object_load.h"
+#include "suites/performance/scratch_churn.h"
+#include "suites/performance/image_perf.h"
+#include "suites/performance/ipc_perf.h"
 #include "suites/performance/enqueueLatency.h"
+#include "suites/microbench/runtime_microbench.h"
 #include "suites/negative/memory_allocate_negative_tests.h"
 #include "suites/negative/queue_validation.h"
 #include "suites/stress/memory_concurrent_tests.h"
@@ -69,6 +79,7 @@
 #include "suites/test_common/test_case_template.h"
 #include "suites/test_common/main.h"
 #include "suites/test_common/test_common.h"
+#include "suites/test_common/perf_report.h"
 #include "suites/functional/concurrent_init.h"
 #include "suites/functional/concurrent_init_shutdown.h"
 #include "suites/functional/concurrent_shutdown.h"
@@ -85,6 +96,7 @@ static void SetFlags(TestBase *test) {
   assert(sRocrtstGlvalues != nullptr);
 
   test->set_num_iteration(sRocrtstGlvalues->num_iterations);
+  test->set_warmup_iterations(sRocrtstGlvalues->warmup_iterations);
   test->set_verbosity(sRocrtstGlvalues->verbosity);
   test->set_monitor_verbosity(sRocrtstGlvalues->monitor_verbosity);
 }
@@ -542,6 +554,76 @@ TEST(rocrtstPerf, AQL_Dispatch_Time_Multi_Interrupt) {
   RunGenericTest(&dt);
 }
 
+TEST(rocrtstPerf, AQL_Dispatch_Throughput_Default_Signal) {
+  DispatchThroughput dt(false);
+  RunGenericTest(&dt);
+}
+
+TEST(rocrtstPerf, AQL_Dispatch_Throughput_Interrupt_Signal) {
+  DispatchThroughput dt(true);
+  RunGenericTest(&dt);
+}
+
+TEST(rocrtstPerf, Signal_Wait_Wake_Latency) {
+  SignalLatency sl;
+  RunGenericTest(&sl);
+}
+
+TEST(rocrtstPerf, Memory_Alloc_Map_Scaling) {
+  MemoryAllocMap mam;
+  RunGenericTest(&mam);
+}
+
+TEST(rocrtstPerf, Memory_Copy_Bandwidth_Matrix) {
+  MemoryCopyMatrix mcm;
+  RunGenericTest(&mcm);
+}
+
+TEST(rocrtstPerf, Runtime_Init_Shutdown_Time) {
+  InitTime it;
+  RunGenericTest(&it);
+}
+
+TEST(rocrtstPerf, Code_Object_Load_Scaling) {
+  CodeObjectLoad col;
+  RunGenericTest(&col);
+}
+
+TEST(rocrtstPerf, Scratch_Churn_Default) {
+  ScratchChurn sc(true, true);
+  RunGenericTest(&sc);
+}
+
+TEST(rocrtstPerf, Scratch_Churn_No_Alt) {
+  ScratchChurn sc(true, false);
+  RunGenericTest(&sc);
+}
+
+TEST(rocrtstPerf, Scratch_Churn_No_Async_Reclaim) {
+  ScratchChurn sc(false, false);
+  RunGenericTest(&sc);
+}
+
+TEST(rocrtstPerf, Image_Extension_Performance) {
+  ImagePerf ip;
+  RunGenericTest(&ip);
+}
+
+TEST(rocrtstPerf, IPC_Multi_Process_Socket) {
+  IpcPerf ip(false);
+  RunGenericTest(&ip);
+}
+
+TEST(rocrtstPerf, IPC_Multi_Process_Legacy) {
+  IpcPerf ip(true);
+  RunGenericTest(&ip);
+}
+
+TEST(rocrtstMicrobench, Runtime_Hot_Path_Microbench) {
+  RuntimeMicrobench rm;
+  RunGenericTest(&rm);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -555,10 +637,16 @@ int main(int argc, char** argv) {
   settings.verbosity = 1;
   settings.monitor_verbosity = 0;
   settings.num_iterations = 5;
+  settings.warmup_iterations = 1;
+  settings.output_format = "json";
+  settings.regression_threshold = 0.05;
 
   if (ProcessCmdline(&settings, argc, argv)) {
     return 1;
   }
+  if (ApplyPinning(settings)) {
+    return 1;
+  }
   sRocrtstGlvalues = &settings;
 
   if (settings.monitor_verbosity > 0) {
@@ -569,5 +657,20 @@ int main(int argc, char** argv) {
     }
     DumpMonitorInfo();
   }
-  return RUN_ALL_TESTS();
+  int ret = RUN_ALL_TESTS();
+
+  const PerfReport& report = PerfReport::Instance();
+  if (!settings.output_file.empty()) {
+    PerfReport::Format format = (settings.output_format == "csv") ?
+                                PerfReport::FORMAT_CSV : PerfReport::FORMAT_JSON;
+    if (!report.Write(settings.output_file, format)) {
+      std::cout << "Failed to write " << settings.output_file << std::endl;
+      ret = ret ? ret : 1;
+    }
+  }
+  if (!settings.baseline_file.empty() && report.Compare(settings.baseline_file,
+                                                        settings.regression_threshold) != 0) {
+    ret = ret ? ret : 1;
+  }
+  return ret;
 }
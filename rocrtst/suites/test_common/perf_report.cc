@@ -0,0 +1,266 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "suites/test_common/perf_report.h"
+
+// Two sided 95% Student's t critical values for 1 to 30 degrees of freedom.
+static const double kStudentT95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+static double StudentT95(size_t dof) {
+  const size_t table = sizeof(kStudentT95) / sizeof(kStudentT95[0]);
+  if (dof == 0) {
+    return 0.0;
+  }
+  return (dof <= table) ? kStudentT95[dof - 1] : 1.96;
+}
+
+// Quote a string for JSON, or for CSV when csv is set.
+static std::string Quote(const std::string& s, bool csv) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"') {
+      out += csv ? "\"\"" : "\\\"";
+    } else if (c == '\\' && !csv) {
+      out += "\\\\";
+    } else {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+PerfStats ComputePerfStats(std::vector<double> samples) {
+  PerfStats stats = {0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  if (samples.empty()) {
+    return stats;
+  }
+
+  std::sort(samples.begin(), samples.end());
+  const size_t n = samples.size();
+  stats.count = n;
+  stats.min = samples.front();
+  stats.max = samples.back();
+  stats.median = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+
+  double sum = 0.0;
+  for (double s : samples) {
+    sum += s;
+  }
+  stats.mean = sum / n;
+
+  if (n > 1) {
+    double sq = 0.0;
+    for (double s : samples) {
+      sq += (s - stats.mean) * (s - stats.mean);
+    }
+    stats.stddev = std::sqrt(sq / (n - 1));
+    stats.ci95 = StudentT95(n - 1) * stats.stddev / std::sqrt(static_cast<double>(n));
+  }
+  return stats;
+}
+
+PerfReport& PerfReport::Instance(void) {
+  static PerfReport report;
+  return report;
+}
+
+void PerfReport::Add(const std::string& name, const std::string& unit,
+                     const std::vector<double>& samples, bool higher_is_better) {
+  Metric metric;
+  metric.name = name;
+  metric.unit = unit;
+  metric.higher_is_better = higher_is_better;
+  metric.stats = ComputePerfStats(samples);
+
+  for (Metric& m : metrics_) {
+    if (m.name == name) {
+      m = metric;
+      return;
+    }
+  }
+  metrics_.push_back(metric);
+}
+
+bool PerfReport::Write(const std::string& path, Format format) const {
+  std::ofstream out(path);
+  if (!out.good()) {
+    return false;
+  }
+  out << std::setprecision(9);
+
+  if (format == FORMAT_CSV) {
+    out << "name,unit,higher_is_better,count,mean,stddev,median,min,max,ci95" << std::endl;
+    for (const Metric& m : metrics_) {
+      out << Quote(m.name, true) << "," << Quote(m.unit, true) << ","
+          << (m.higher_is_better ? 1 : 0) << "," << m.stats.count << "," << m.stats.mean << ","
+          << m.stats.stddev << "," << m.stats.median << "," << m.stats.min << ","
+          << m.stats.max << "," << m.stats.ci95 << std::endl;
+    }
+    return out.good();
+  }
+
+  // One metric per line keeps the file diffable and easy to read back.
+  out << "{\"metrics\": [" << std::endl;
+  for (size_t i = 0; i < metrics_.size(); i++) {
+    const Metric& m = metrics_[i];
+    out << "  {\"name\": " << Quote(m.name, false) << ", \"unit\": " << Quote(m.unit, false)
+        << ", \"higher_is_better\": " << (m.higher_is_better ? "true" : "false")
+        << ", \"count\": " << m.stats.count << ", \"mean\": " << m.stats.mean
+        << ", \"stddev\": " << m.stats.stddev << ", \"median\": " << m.stats.median
+        << ", \"min\": " << m.stats.min << ", \"max\": " << m.stats.max
+        << ", \"ci95\": " << m.stats.ci95 << "}" << ((i + 1 < metrics_.size()) ? "," : "")
+        << std::endl;
+  }
+  out << "]}" << std::endl;
+  return out.good();
+}
+
+bool PerfReport::ReadBaseline(const std::string& path, std::map<std::string, double>* means) {
+  std::ifstream in(path);
+  if (!in.good()) {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(in, line)) {
+    // Both formats start each metric line with its quoted name.
+    size_t start = line.find('"');
+    if (start == std::string::npos) {
+      continue;
+    }
+
+    std::string name;
+    size_t pos = std::string::npos;
+    bool json = (line.compare(start, 8, "\"name\": ") == 0);
+    if (json) {
+      start += 8;
+    }
+    for (size_t i = start + 1; i < line.size(); i++) {
+      if (!json && line[i] == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+        name += '"';
+        i++;
+      } else if (json && line[i] == '\\' && i + 1 < line.size()) {
+        name += line[++i];
+      } else if (line[i] == '"') {
+        pos = i + 1;
+        break;
+      } else {
+        name += line[i];
+      }
+    }
+    if (pos == std::string::npos) {
+      continue;
+    }
+
+    double mean;
+    if (json) {
+      size_t key = line.find("\"mean\": ", pos);
+      if (key == std::string::npos) {
+        continue;
+      }
+      mean = std::strtod(line.c_str() + key + 8, nullptr);
+    } else {
+      // name,unit,higher_is_better,count,mean
+      std::stringstream fields(line.substr(pos));
+      std::string field;
+      std::vector<std::string> cols;
+      while (std::getline(fields, field, ',')) {
+        cols.push_back(field);
+      }
+      // cols[0] is empty, the text between the name and its comma.
+      if (cols.size() < 5) {
+        continue;
+      }
+      mean = std::strtod(cols[4].c_str(), nullptr);
+    }
+    (*means)[name] = mean;
+  }
+  return true;
+}
+
+int PerfReport::Compare(const std::string& path, double threshold) const {
+  std::map<std::string, double> baseline;
+  if (!ReadBaseline(path, &baseline)) {
+    std::cout << "Could not read baseline " << path << std::endl;
+    return -1;
+  }
+
+  int regressions = 0;
+  std::cout << std::endl << "Comparison against baseline " << path << ", threshold "
+            << threshold * 100 << "%" << std::endl;
+  for (const Metric& m : metrics_) {
+    auto it = baseline.find(m.name);
+    if (it == baseline.end() || it->second == 0.0) {
+      continue;
+    }
+
+    const double base = it->second;
+    const double change = (m.stats.mean - base) / std::fabs(base);
+    const double worse = m.higher_is_better ? -change : change;
+    const bool outside_ci = std::fabs(m.stats.mean - base) > m.stats.ci95;
+    const bool regressed = (worse > threshold) && outside_ci;
+    const bool improved = (-worse > threshold) && outside_ci;
+    if (regressed) {
+      regressions++;
+    }
+
+    std::cout << (regressed ? "REGRESSION " : (improved ? "improved   " : "ok         "))
+              << std::showpos << std::fixed << std::setprecision(1) << change * 100 << "%"
+              << std::noshowpos << std::defaultfloat << "  " << m.name << " (" << m.stats.mean
+              << " vs " << base << " " << m.unit << ")" << std::endl;
+  }
+  std::cout << regressions << " regression(s)" << std::endl;
+  return regressions;
+}
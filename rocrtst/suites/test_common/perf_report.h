@@ -0,0 +1,113 @@
+/*
+ * =============================================================================
+ *   ROC Runtime Conformance Release License
+ * =============================================================================
+ * The University of Illinois/NCSA
+ * Open Source License (NCSA)
+ *
+ * Copyright (c) 2024, Advanced Micro Devices, Inc.
+ * All rights reserved.
+ *
+ * Developed by:
+ *
+ *                 AMD Research and AMD ROC Software Development
+ *
+ *                 Advanced Micro Devices, Inc.
+ *
+ *                 www.amd.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal with the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in
+ *    the documentation and/or other materials provided with the distribution.
+ *  - Neither the names of <Name of Development Group, Name of Institution>,
+ *    nor the names of its contributors may be used to endorse or promote
+ *    products derived from this Software without specific prior written
+ *    permission.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS WITH THE SOFTWARE.
+ *
+ */
+
+#ifndef ROCRTST_SUITES_TEST_COMMON_PERF_REPORT_H_
+#define ROCRTST_SUITES_TEST_COMMON_PERF_REPORT_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// @Brief: Summary statistics of a set of samples.  ci95 is the half width
+// of the 95% confidence interval of the mean.
+struct PerfStats {
+  size_t count;
+  double mean;
+  double stddev;
+  double median;
+  double min;
+  double max;
+  double ci95;
+};
+
+// @Brief: Compute statistics of samples; all zero if samples is empty
+PerfStats ComputePerfStats(std::vector<double> samples);
+
+// @Brief: Process wide collection of performance metrics.  Tests add
+// metrics through TestBase::ReportMetric(); main() writes them out as JSON
+// or CSV and compares them against a stored baseline.
+class PerfReport {
+ public:
+  enum Format {FORMAT_JSON = 0, FORMAT_CSV};
+
+  struct Metric {
+    std::string name;
+    std::string unit;
+    bool higher_is_better;
+    PerfStats stats;
+  };
+
+  static PerfReport& Instance(void);
+
+  // @Brief: Add a metric, replacing an earlier one of the same name
+  void Add(const std::string& name, const std::string& unit, const std::vector<double>& samples,
+           bool higher_is_better);
+
+  // @Brief: Write all metrics to path. Returns false if the file can't be
+  // written.
+  bool Write(const std::string& path, Format format) const;
+
+  // @Brief: Compare metrics against a baseline file written by Write() in
+  // either format.  A metric regresses if its mean is worse than the
+  // baseline mean by more than threshold (a fraction) and the baseline mean
+  // lies outside the metric's 95% confidence interval.  Prints a line per
+  // common metric and returns the number of regressions, or -1 if the
+  // baseline can't be read.
+  int Compare(const std::string& path, double threshold) const;
+
+  bool empty(void) const { return metrics_.empty(); }
+
+ private:
+  PerfReport(void) {}
+
+  // @Brief: Read name -> mean from a file written by Write()
+  static bool ReadBaseline(const std::string& path, std::map<std::string, double>* means);
+
+  std::vector<Metric> metrics_;
+};
+
+#endif  // ROCRTST_SUITES_TEST_COMMON_PERF_REPORT_H_
@@ -47,6 +47,7 @@
 
 #include "suites/test_common/test_base.h"
 #include "suites/test_common/test_common.h"
+#include "suites/test_common/perf_report.h"
 #include "common/base_rocr_utils.h"
 #include "gtest/gtest.h"
 
@@ -60,7 +61,7 @@ static const char kCloseLabel[] = "TEST CLEAN UP";
 static const char kResultsLabel[] = "TEST RESULTS";
 
 
-TestBase::TestBase() : description_("") {
+TestBase::TestBase() : description_(""), warmup_iterations_(0) {
 }
 TestBase::~TestBase() {
 }
@@ -149,3 +150,14 @@ void TestBase::set_description(std::string d) {
   }
 }
 
+void TestBase::ReportMetric(const std::string& metric, const std::string& unit,
+                            const std::vector<double>& samples,
+                            bool higher_is_better) const {
+  PerfReport::Instance().Add(title() + "/" + metric, unit, samples,
+                             higher_is_better);
+}
+
+void TestBase::ReportMetric(const std::string& metric, const std::string& unit,
+                            double value, bool higher_is_better) const {
+  ReportMetric(metric, unit, std::vector<double>(1, value), higher_is_better);
+}
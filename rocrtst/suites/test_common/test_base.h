@@ -85,8 +85,23 @@ class TestBase : public rocrtst::BaseRocR {
   // @Brief: Emit close output string only.  For tests with custom close.
   void ClosePrint(void);
 
+  // @Brief: Add a metric to the run's performance report, named
+  // "<title>/<metric>".  Statistics are computed over samples.
+  void ReportMetric(const std::string& metric, const std::string& unit,
+                    const std::vector<double>& samples,
+                    bool higher_is_better) const;
+
+  // @Brief: Single sample convenience form of ReportMetric()
+  void ReportMetric(const std::string& metric, const std::string& unit,
+                    double value, bool higher_is_better) const;
+
+  // @Brief: Number of untimed iterations to run before measuring
+  void set_warmup_iterations(uint32_t num) { warmup_iterations_ = num; }
+  uint32_t warmup_iterations(void) const { return warmup_iterations_; }
+
  private:
   std::string description_;
+  uint32_t warmup_iterations_;
 };
 
 #endif  // ROCRTST_SUITES_TEST_COMMON_TEST_BASE_H_
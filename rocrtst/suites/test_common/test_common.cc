@@ -44,7 +44,9 @@
  */
 
 #include <assert.h>
+#include <sched.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <getopt.h>
 
 #include <iostream>
@@ -59,10 +61,17 @@ static const struct option long_options[] = {
   {"iterations", required_argument, nullptr, 'i'},
   {"verbose", required_argument, nullptr, 'v'},
   {"monitor_verbose", required_argument, nullptr, 'm'},
+  {"warmup", required_argument, nullptr, 'w'},
+  {"cpu_list", required_argument, nullptr, 'c'},
+  {"gpu_list", required_argument, nullptr, 'g'},
+  {"output", required_argument, nullptr, 'o'},
+  {"format", required_argument, nullptr, 'f'},
+  {"baseline", required_argument, nullptr, 'b'},
+  {"threshold", required_argument, nullptr, 't'},
 
   {nullptr, 0, nullptr, 0}
 };
-static const char* short_options = "i:v:m:r";
+static const char* short_options = "i:v:m:w:c:g:o:f:b:t:r";
 
 static void PrintHelp(void) {
   std::cout <<
@@ -82,7 +91,35 @@ static void PrintHelp(void) {
      "   0    -- don't read or print out any GPU monitor information;\n"
      "   1    -- print out all available monitor information before the first "
                  "test and after each test\n"
-     "   >= 2 -- print out even more monitor information (test specific)\n";
+     "   >= 2 -- print out even more monitor information (test specific)\n"
+     "--warmup, -w <number of untimed iterations before measuring>; used by "
+         "tests that support it\n"
+     "--cpu_list, -c <cpu>[,<cpu>...]; pin the process to these CPUs\n"
+     "--gpu_list, -g <gpu>[,<gpu>...]; expose only these GPUs to the "
+         "runtime (sets ROCR_VISIBLE_DEVICES)\n"
+     "--output, -o <file>; write performance metrics to file\n"
+     "--format, -f <json|csv>; format of the --output file, default json\n"
+     "--baseline, -b <file>; compare performance metrics with a file "
+         "written by --output. The exit status is non-zero if any metric "
+         "regressed\n"
+     "--threshold, -t <percent>; how much worse than the baseline a metric "
+         "must be, with the baseline outside its 95% confidence interval, to "
+         "count as a regression, default 5\n";
+}
+
+// Parse a comma separated list of CPU indices.
+static bool ParseCpuList(const std::string& list, std::vector<uint32_t>* cpus) {
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    char* end = nullptr;
+    unsigned long cpu = strtoul(item.c_str(), &end, 10);  // NOLINT
+    if (item.empty() || *end != '\0') {
+      return false;
+    }
+    cpus->push_back(static_cast<uint32_t>(cpu));
+  }
+  return !cpus->empty();
 }
 
 uint32_t ProcessCmdline(RocrTstGlobals* test, int arg_cnt, char** arg_list) {
@@ -111,6 +148,41 @@ uint32_t ProcessCmdline(RocrTstGlobals* test, int arg_cnt, char** arg_list) {
         test->monitor_verbosity = std::stoi(optarg);
         break;
 
+      case 'w':
+        test->warmup_iterations = std::stoi(optarg);
+        break;
+
+      case 'c':
+        if (!ParseCpuList(optarg, &test->cpu_list)) {
+          std::cout << "Invalid CPU list " << optarg << std::endl;
+          return 1;
+        }
+        break;
+
+      case 'g':
+        test->gpu_list = optarg;
+        break;
+
+      case 'o':
+        test->output_file = optarg;
+        break;
+
+      case 'f':
+        test->output_format = optarg;
+        if (test->output_format != "json" && test->output_format != "csv") {
+          PrintHelp();
+          return 1;
+        }
+        break;
+
+      case 'b':
+        test->baseline_file = optarg;
+        break;
+
+      case 't':
+        test->regression_threshold = std::stod(optarg) / 100.0;
+        break;
+
       case 'r':
         PrintHelp();
         return 1;
@@ -123,6 +195,30 @@ uint32_t ProcessCmdline(RocrTstGlobals* test, int arg_cnt, char** arg_list) {
   return 0;
 }
 
+int ApplyPinning(const RocrTstGlobals& test) {
+  if (!test.gpu_list.empty()) {
+    setenv("ROCR_VISIBLE_DEVICES", test.gpu_list.c_str(), 1);
+  }
+
+  if (!test.cpu_list.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t cpu : test.cpu_list) {
+      if (cpu >= CPU_SETSIZE) {
+        std::cout << "CPU " << cpu << " is out of range" << std::endl;
+        return 1;
+      }
+      CPU_SET(cpu, &set);
+    }
+    // Threads created later, including the runtime's, inherit the mask.
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+      std::cout << "Failed to set CPU affinity" << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
 template<typename T>
 static std::string IntegerToString(T intVal, bool hex = true) {
   std::stringstream stream;
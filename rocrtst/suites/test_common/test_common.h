@@ -47,16 +47,34 @@
 #define ROCRTST_SUITES_TEST_COMMON_TEST_COMMON_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 struct RocrTstGlobals {
   uint32_t verbosity;
   uint32_t monitor_verbosity;
   uint32_t num_iterations;
+  uint32_t warmup_iterations;
+  // CPUs to pin the process to; empty leaves affinity alone.
+  std::vector<uint32_t> cpu_list;
+  // GPUs to expose to the runtime through ROCR_VISIBLE_DEVICES; empty
+  // leaves it alone.
+  std::string gpu_list;
+  // Performance report file and format ("json" or "csv"); empty for none.
+  std::string output_file;
+  std::string output_format;
+  // Baseline report to compare against; empty for none.
+  std::string baseline_file;
+  // Fraction a metric may get worse before it is a regression.
+  double regression_threshold;
 };
 
 uint32_t ProcessCmdline(RocrTstGlobals* test, int arg_cnt, char** arg_list);
 
+// @Brief: Apply CPU and GPU pinning options.  Must run before hsa_init.
+// Returns non-zero on failure.
+int ApplyPinning(const RocrTstGlobals& test);
+
 int DumpMonitorInfo(void);
 
 #endif  // ROCRTST_SUITES_TEST_COMMON_TEST_COMMON_H_
@@ -48,6 +48,10 @@ static const CoreApiTable* coreApiTable;
 static const AmdExtTable* amdExtTable;
 static const ToolsApiTable* toolsApiTable;
 
+// Set while the hot queue index and signal entry points below are the runtime's own, which then
+// call it directly instead of through coreApiTable.
+static bool directDispatch;
+
 void hsa_table_interface_init(const HsaApiTable* apiTable) {
     hsaApiTable = apiTable;
     coreApiTable = apiTable->core_;
@@ -59,6 +63,64 @@ const HsaApiTable* hsa_table_interface_get_table() {
   return hsaApiTable;
 }
 
+void hsa_table_interface_set_direct(bool enable) {
+  directDispatch = enable &&
+#define HOT_ENTRY_UNCHANGED(name) (coreApiTable->name##_fn == rocr::HSA::name)
+      HOT_ENTRY_UNCHANGED(hsa_queue_add_write_index_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_add_write_index_scacq_screl) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_add_write_index_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_add_write_index_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_cas_write_index_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_cas_write_index_scacq_screl) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_cas_write_index_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_cas_write_index_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_load_read_index_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_load_read_index_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_load_write_index_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_load_write_index_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_store_read_index_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_store_read_index_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_store_write_index_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_queue_store_write_index_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_add_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_add_scacq_screl) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_add_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_add_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_and_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_and_scacq_screl) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_and_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_and_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_cas_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_cas_scacq_screl) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_cas_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_cas_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_exchange_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_exchange_scacq_screl) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_exchange_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_exchange_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_load_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_load_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_or_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_or_scacq_screl) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_or_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_or_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_silent_store_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_silent_store_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_store_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_store_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_subtract_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_subtract_scacq_screl) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_subtract_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_subtract_screlease) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_wait_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_wait_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_xor_relaxed) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_xor_scacq_screl) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_xor_scacquire) &&
+      HOT_ENTRY_UNCHANGED(hsa_signal_xor_screlease);
+#undef HOT_ENTRY_UNCHANGED
+}
+
 // Pass through stub functions
 hsa_status_t HSA_API hsa_init() {
   // We initialize the api tables here once more since the code above is prone to a
@@ -179,75 +241,92 @@ hsa_status_t HSA_API hsa_queue_inactivate(hsa_queue_t* queue) {
 }
 
 uint64_t HSA_API hsa_queue_load_read_index_scacquire(const hsa_queue_t* queue) {
+  if (directDispatch) return rocr::HSA::hsa_queue_load_read_index_scacquire(queue);
   return coreApiTable->hsa_queue_load_read_index_scacquire_fn(queue);
 }
 
 uint64_t HSA_API hsa_queue_load_read_index_relaxed(const hsa_queue_t* queue) {
+  if (directDispatch) return rocr::HSA::hsa_queue_load_read_index_relaxed(queue);
   return coreApiTable->hsa_queue_load_read_index_relaxed_fn(queue);
 }
 
 uint64_t HSA_API hsa_queue_load_write_index_scacquire(const hsa_queue_t* queue) {
+  if (directDispatch) return rocr::HSA::hsa_queue_load_write_index_scacquire(queue);
   return coreApiTable->hsa_queue_load_write_index_scacquire_fn(queue);
 }
 
 uint64_t HSA_API hsa_queue_load_write_index_relaxed(const hsa_queue_t* queue) {
+  if (directDispatch) return rocr::HSA::hsa_queue_load_write_index_relaxed(queue);
   return coreApiTable->hsa_queue_load_write_index_relaxed_fn(queue);
 }
 
 void HSA_API hsa_queue_store_write_index_relaxed(const hsa_queue_t* queue,
                                                  uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_store_write_index_relaxed(queue, value);
   return coreApiTable->hsa_queue_store_write_index_relaxed_fn(queue, value);
 }
 
 void HSA_API hsa_queue_store_write_index_screlease(const hsa_queue_t* queue, uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_store_write_index_screlease(queue, value);
   return coreApiTable->hsa_queue_store_write_index_screlease_fn(queue, value);
 }
 
 uint64_t HSA_API hsa_queue_cas_write_index_scacq_screl(const hsa_queue_t* queue, uint64_t expected,
                                                        uint64_t value) {
+  if (directDispatch)
+    return rocr::HSA::hsa_queue_cas_write_index_scacq_screl(queue, expected, value);
   return coreApiTable->hsa_queue_cas_write_index_scacq_screl_fn(queue, expected, value);
 }
 
 uint64_t HSA_API hsa_queue_cas_write_index_scacquire(const hsa_queue_t* queue, uint64_t expected,
                                                      uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_cas_write_index_scacquire(queue, expected, value);
   return coreApiTable->hsa_queue_cas_write_index_scacquire_fn(queue, expected, value);
 }
 
 uint64_t HSA_API hsa_queue_cas_write_index_relaxed(const hsa_queue_t* queue,
                                                    uint64_t expected,
                                                    uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_cas_write_index_relaxed(queue, expected, value);
   return coreApiTable->hsa_queue_cas_write_index_relaxed_fn(queue, expected,
                                                            value);
 }
 
 uint64_t HSA_API hsa_queue_cas_write_index_screlease(const hsa_queue_t* queue, uint64_t expected,
                                                      uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_cas_write_index_screlease(queue, expected, value);
   return coreApiTable->hsa_queue_cas_write_index_screlease_fn(queue, expected, value);
 }
 
 uint64_t HSA_API hsa_queue_add_write_index_scacq_screl(const hsa_queue_t* queue, uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_add_write_index_scacq_screl(queue, value);
   return coreApiTable->hsa_queue_add_write_index_scacq_screl_fn(queue, value);
 }
 
 uint64_t HSA_API hsa_queue_add_write_index_scacquire(const hsa_queue_t* queue, uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_add_write_index_scacquire(queue, value);
   return coreApiTable->hsa_queue_add_write_index_scacquire_fn(queue, value);
 }
 
 uint64_t HSA_API hsa_queue_add_write_index_relaxed(const hsa_queue_t* queue,
                                                    uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_add_write_index_relaxed(queue, value);
   return coreApiTable->hsa_queue_add_write_index_relaxed_fn(queue, value);
 }
 
 uint64_t HSA_API hsa_queue_add_write_index_screlease(const hsa_queue_t* queue, uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_add_write_index_screlease(queue, value);
   return coreApiTable->hsa_queue_add_write_index_screlease_fn(queue, value);
 }
 
 void HSA_API hsa_queue_store_read_index_relaxed(const hsa_queue_t* queue,
                                                 uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_store_read_index_relaxed(queue, value);
   return coreApiTable->hsa_queue_store_read_index_relaxed_fn(queue, value);
 }
 
 void HSA_API hsa_queue_store_read_index_screlease(const hsa_queue_t* queue, uint64_t value) {
+  if (directDispatch) return rocr::HSA::hsa_queue_store_read_index_screlease(queue, value);
   return coreApiTable->hsa_queue_store_read_index_screlease_fn(queue, value);
 }
 
@@ -301,27 +380,33 @@ hsa_status_t HSA_API hsa_signal_destroy(hsa_signal_t signal) {
 }
 
 hsa_signal_value_t HSA_API hsa_signal_load_relaxed(hsa_signal_t signal) {
+  if (directDispatch) return rocr::HSA::hsa_signal_load_relaxed(signal);
   return coreApiTable->hsa_signal_load_relaxed_fn(signal);
 }
 
 hsa_signal_value_t HSA_API hsa_signal_load_scacquire(hsa_signal_t signal) {
+  if (directDispatch) return rocr::HSA::hsa_signal_load_scacquire(signal);
   return coreApiTable->hsa_signal_load_scacquire_fn(signal);
 }
 
 void HSA_API
     hsa_signal_store_relaxed(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_store_relaxed(signal, value);
   return coreApiTable->hsa_signal_store_relaxed_fn(signal, value);
 }
 
 void HSA_API hsa_signal_store_screlease(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_store_screlease(signal, value);
   return coreApiTable->hsa_signal_store_screlease_fn(signal, value);
 }
 
 void HSA_API hsa_signal_silent_store_relaxed(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_silent_store_relaxed(signal, value);
   return coreApiTable->hsa_signal_silent_store_relaxed_fn(signal, value);
 }
 
 void HSA_API hsa_signal_silent_store_screlease(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_silent_store_screlease(signal, value);
   return coreApiTable->hsa_signal_silent_store_screlease_fn(signal, value);
 }
 
@@ -331,6 +416,9 @@ hsa_signal_value_t HSA_API
                             hsa_signal_value_t compare_value,
                             uint64_t timeout_hint,
                             hsa_wait_state_t wait_expectancy_hint) {
+  if (directDispatch)
+    return rocr::HSA::hsa_signal_wait_relaxed(signal, condition, compare_value, timeout_hint,
+                                              wait_expectancy_hint);
   return coreApiTable->hsa_signal_wait_relaxed_fn(
       signal, condition, compare_value, timeout_hint, wait_expectancy_hint);
 }
@@ -340,6 +428,9 @@ hsa_signal_value_t HSA_API hsa_signal_wait_scacquire(hsa_signal_t signal,
                                                      hsa_signal_value_t compare_value,
                                                      uint64_t timeout_hint,
                                                      hsa_wait_state_t wait_expectancy_hint) {
+  if (directDispatch)
+    return rocr::HSA::hsa_signal_wait_scacquire(signal, condition, compare_value, timeout_hint,
+                                                wait_expectancy_hint);
   return coreApiTable->hsa_signal_wait_scacquire_fn(signal, condition, compare_value, timeout_hint,
                                                     wait_expectancy_hint);
 }
@@ -377,130 +468,158 @@ hsa_status_t HSA_API hsa_signal_group_wait_any_scacquire(hsa_signal_group_t sign
 
 void HSA_API
     hsa_signal_and_relaxed(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_and_relaxed(signal, value);
   return coreApiTable->hsa_signal_and_relaxed_fn(signal, value);
 }
 
 void HSA_API hsa_signal_and_scacquire(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_and_scacquire(signal, value);
   return coreApiTable->hsa_signal_and_scacquire_fn(signal, value);
 }
 
 void HSA_API hsa_signal_and_screlease(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_and_screlease(signal, value);
   return coreApiTable->hsa_signal_and_screlease_fn(signal, value);
 }
 
 void HSA_API hsa_signal_and_scacq_screl(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_and_scacq_screl(signal, value);
   return coreApiTable->hsa_signal_and_scacq_screl_fn(signal, value);
 }
 
 void HSA_API
     hsa_signal_or_relaxed(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_or_relaxed(signal, value);
   return coreApiTable->hsa_signal_or_relaxed_fn(signal, value);
 }
 
 void HSA_API hsa_signal_or_scacquire(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_or_scacquire(signal, value);
   return coreApiTable->hsa_signal_or_scacquire_fn(signal, value);
 }
 
 void HSA_API hsa_signal_or_screlease(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_or_screlease(signal, value);
   return coreApiTable->hsa_signal_or_screlease_fn(signal, value);
 }
 
 void HSA_API hsa_signal_or_scacq_screl(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_or_scacq_screl(signal, value);
   return coreApiTable->hsa_signal_or_scacq_screl_fn(signal, value);
 }
 
 void HSA_API
     hsa_signal_xor_relaxed(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_xor_relaxed(signal, value);
   return coreApiTable->hsa_signal_xor_relaxed_fn(signal, value);
 }
 
 void HSA_API hsa_signal_xor_scacquire(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_xor_scacquire(signal, value);
   return coreApiTable->hsa_signal_xor_scacquire_fn(signal, value);
 }
 
 void HSA_API hsa_signal_xor_screlease(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_xor_screlease(signal, value);
   return coreApiTable->hsa_signal_xor_screlease_fn(signal, value);
 }
 
 void HSA_API hsa_signal_xor_scacq_screl(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_xor_scacq_screl(signal, value);
   return coreApiTable->hsa_signal_xor_scacq_screl_fn(signal, value);
 }
 
 void HSA_API
     hsa_signal_add_relaxed(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_add_relaxed(signal, value);
   return coreApiTable->hsa_signal_add_relaxed_fn(signal, value);
 }
 
 void HSA_API hsa_signal_add_scacquire(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_add_scacquire(signal, value);
   return coreApiTable->hsa_signal_add_scacquire_fn(signal, value);
 }
 
 void HSA_API hsa_signal_add_screlease(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_add_screlease(signal, value);
   return coreApiTable->hsa_signal_add_screlease_fn(signal, value);
 }
 
 void HSA_API hsa_signal_add_scacq_screl(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_add_scacq_screl(signal, value);
   return coreApiTable->hsa_signal_add_scacq_screl_fn(signal, value);
 }
 
 void HSA_API
     hsa_signal_subtract_relaxed(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_subtract_relaxed(signal, value);
   return coreApiTable->hsa_signal_subtract_relaxed_fn(signal, value);
 }
 
 void HSA_API hsa_signal_subtract_scacquire(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_subtract_scacquire(signal, value);
   return coreApiTable->hsa_signal_subtract_scacquire_fn(signal, value);
 }
 
 void HSA_API hsa_signal_subtract_screlease(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_subtract_screlease(signal, value);
   return coreApiTable->hsa_signal_subtract_screlease_fn(signal, value);
 }
 
 void HSA_API hsa_signal_subtract_scacq_screl(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_subtract_scacq_screl(signal, value);
   return coreApiTable->hsa_signal_subtract_scacq_screl_fn(signal, value);
 }
 
 hsa_signal_value_t HSA_API
     hsa_signal_exchange_relaxed(hsa_signal_t signal, hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_exchange_relaxed(signal, value);
   return coreApiTable->hsa_signal_exchange_relaxed_fn(signal, value);
 }
 
 hsa_signal_value_t HSA_API hsa_signal_exchange_scacquire(hsa_signal_t signal,
                                                          hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_exchange_scacquire(signal, value);
   return coreApiTable->hsa_signal_exchange_scacquire_fn(signal, value);
 }
 
 hsa_signal_value_t HSA_API hsa_signal_exchange_screlease(hsa_signal_t signal,
                                                          hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_exchange_screlease(signal, value);
   return coreApiTable->hsa_signal_exchange_screlease_fn(signal, value);
 }
 
 hsa_signal_value_t HSA_API hsa_signal_exchange_scacq_screl(hsa_signal_t signal,
                                                            hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_exchange_scacq_screl(signal, value);
   return coreApiTable->hsa_signal_exchange_scacq_screl_fn(signal, value);
 }
 
 hsa_signal_value_t HSA_API hsa_signal_cas_relaxed(hsa_signal_t signal,
                                                   hsa_signal_value_t expected,
                                                   hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_cas_relaxed(signal, expected, value);
   return coreApiTable->hsa_signal_cas_relaxed_fn(signal, expected, value);
 }
 
 hsa_signal_value_t HSA_API hsa_signal_cas_scacquire(hsa_signal_t signal,
                                                     hsa_signal_value_t expected,
                                                     hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_cas_scacquire(signal, expected, value);
   return coreApiTable->hsa_signal_cas_scacquire_fn(signal, expected, value);
 }
 
 hsa_signal_value_t HSA_API hsa_signal_cas_screlease(hsa_signal_t signal,
                                                     hsa_signal_value_t expected,
                                                     hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_cas_screlease(signal, expected, value);
   return coreApiTable->hsa_signal_cas_screlease_fn(signal, expected, value);
 }
 
 hsa_signal_value_t HSA_API hsa_signal_cas_scacq_screl(hsa_signal_t signal,
                                                       hsa_signal_value_t expected,
                                                       hsa_signal_value_t value) {
+  if (directDispatch) return rocr::HSA::hsa_signal_cas_scacq_screl(signal, expected, value);
   return coreApiTable->hsa_signal_cas_scacq_screl_fn(signal, expected, value);
 }
 
@@ -1312,6 +1431,483 @@ hsa_status_t HSA_API hsa_amd_enable_logging(uint8_t* flags, void* file) {
   return amdExtTable->hsa_amd_enable_logging_fn(flags, file);
 }
 
+hsa_status_t HSA_API hsa_amd_signal_wait_policy(hsa_signal_t signal,
+                                                hsa_amd_signal_wait_policy_t policy) {
+  return amdExtTable->hsa_amd_signal_wait_policy_fn(signal, policy);
+}
+
+hsa_status_t HSA_API hsa_amd_signal_wait_set_create(hsa_amd_signal_wait_set_t* wait_set) {
+  return amdExtTable->hsa_amd_signal_wait_set_create_fn(wait_set);
+}
+
+hsa_status_t HSA_API hsa_amd_signal_wait_set_destroy(hsa_amd_signal_wait_set_t wait_set) {
+  return amdExtTable->hsa_amd_signal_wait_set_destroy_fn(wait_set);
+}
+
+hsa_status_t HSA_API hsa_amd_signal_wait_set_add(hsa_amd_signal_wait_set_t wait_set,
+                                                 hsa_signal_t signal,
+                                                 hsa_signal_condition_t condition,
+                                                 hsa_signal_value_t compare_value) {
+  return amdExtTable->hsa_amd_signal_wait_set_add_fn(wait_set, signal, condition, compare_value);
+}
+
+hsa_status_t HSA_API hsa_amd_signal_wait_set_remove(hsa_amd_signal_wait_set_t wait_set,
+                                                    hsa_signal_t signal) {
+  return amdExtTable->hsa_amd_signal_wait_set_remove_fn(wait_set, signal);
+}
+
+hsa_status_t HSA_API hsa_amd_signal_wait_set_wait(hsa_amd_signal_wait_set_t wait_set,
+                                                  uint64_t timeout_hint, hsa_wait_state_t wait_hint,
+                                                  uint32_t max_ready, hsa_signal_t* ready_signals,
+                                                  hsa_signal_value_t* ready_values,
+                                                  uint32_t* ready_count) {
+  return amdExtTable->hsa_amd_signal_wait_set_wait_fn(wait_set, timeout_hint, wait_hint, max_ready,
+                                                      ready_signals, ready_values, ready_count);
+}
+
+hsa_status_t HSA_API hsa_amd_signal_async_handler_with_flags(
+    hsa_signal_t signal, hsa_signal_condition_t cond, hsa_signal_value_t value,
+    hsa_amd_signal_handler handler, void* arg, uint64_t flags) {
+  return amdExtTable->hsa_amd_signal_async_handler_with_flags_fn(
+    signal, cond, value, handler, arg, flags);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_async_copy_batch(const hsa_amd_memory_copy_descriptor_t* copies,
+                                                     uint32_t num_copies, hsa_agent_t dst_agent,
+                                                     hsa_agent_t src_agent,
+                                                     uint32_t num_dep_signals,
+                                                     const hsa_signal_t* dep_signals,
+                                                     hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_memory_async_copy_batch_fn(copies, num_copies, dst_agent, src_agent,
+                                                         num_dep_signals, dep_signals,
+                                                         completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_lock_cache_invalidate(void* ptr, size_t size) {
+  return amdExtTable->hsa_amd_memory_lock_cache_invalidate_fn(ptr, size);
+}
+
+hsa_status_t HSA_API hsa_amd_queue_kernarg_alloc(const hsa_queue_t* queue, size_t size,
+                                                 size_t alignment, uint64_t packet_id,
+                                                 void** kernarg_address) {
+  return amdExtTable->hsa_amd_queue_kernarg_alloc_fn(queue, size, alignment, packet_id,
+                                                     kernarg_address);
+}
+
+hsa_status_t HSA_API hsa_amd_queue_submit_batch(hsa_queue_t* queue, const void* packets,
+                                                uint32_t packet_count, uint64_t* first_index) {
+  return amdExtTable->hsa_amd_queue_submit_batch_fn(queue, packets, packet_count, first_index);
+}
+
+hsa_status_t HSA_API hsa_amd_queue_create(
+    hsa_agent_t agent, uint32_t size, hsa_queue_type32_t type,
+    void (*callback)(hsa_status_t status, hsa_queue_t* source, void* data), void* data,
+    uint32_t private_segment_size, uint32_t group_segment_size, uint64_t flags,
+    hsa_queue_t** queue) {
+  return amdExtTable->hsa_amd_queue_create_fn(agent, size, type, callback, data,
+                                              private_segment_size, group_segment_size, flags,
+                                              queue);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_async_copy_on_engine_with_priority(
+    void* dst, hsa_agent_t dst_agent, const void* src, hsa_agent_t src_agent, size_t size,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal,
+    hsa_amd_sdma_engine_id_t engine_id, bool force_copy_on_sdma,
+    hsa_amd_queue_priority_t priority) {
+  return amdExtTable->hsa_amd_memory_async_copy_on_engine_with_priority_fn(
+    dst, dst_agent, src, src_agent, size, num_dep_signals, dep_signals, completion_signal,
+    engine_id, force_copy_on_sdma, priority);
+}
+
+hsa_status_t HSA_API hsa_amd_copy_list_create(hsa_agent_t agent, hsa_amd_sdma_engine_id_t engine_id,
+                                              const hsa_amd_copy_command_t* commands,
+                                              uint32_t num_commands, hsa_amd_copy_list_t* list) {
+  return amdExtTable->hsa_amd_copy_list_create_fn(agent, engine_id, commands, num_commands, list);
+}
+
+hsa_status_t HSA_API hsa_amd_copy_list_submit(hsa_amd_copy_list_t list, uint32_t num_dep_signals,
+                                              const hsa_signal_t* dep_signals,
+                                              hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_copy_list_submit_fn(list, num_dep_signals, dep_signals,
+                                                  completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_copy_list_destroy(hsa_amd_copy_list_t list) {
+  return amdExtTable->hsa_amd_copy_list_destroy_fn(list);
+}
+
+hsa_status_t HSA_API hsa_amd_agents_allow_access_batch(uint32_t num_agents,
+                                                       const hsa_agent_t* agents,
+                                                       const uint32_t* flags, uint32_t num_ptrs,
+                                                       const void* const* ptrs) {
+  return amdExtTable->hsa_amd_agents_allow_access_batch_fn(num_agents, agents, flags, num_ptrs,
+                                                           ptrs);
+}
+
+hsa_status_t HSA_API hsa_amd_signal_get_eventfd(hsa_signal_t signal, int* fd) {
+  return amdExtTable->hsa_amd_signal_get_eventfd_fn(signal, fd);
+}
+
+hsa_status_t HSA_API hsa_amd_executable_freeze_async(hsa_executable_t executable,
+                                                     const char* options,
+                                                     hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_executable_freeze_async_fn(executable, options, completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_executables_destroy(uint32_t num_executables,
+                                                 const hsa_executable_t* executables) {
+  return amdExtTable->hsa_amd_executables_destroy_fn(num_executables, executables);
+}
+
+hsa_status_t HSA_API hsa_amd_queue_dispatch_timestamps_enable(hsa_queue_t* queue,
+                                                              uint32_t record_count) {
+  return amdExtTable->hsa_amd_queue_dispatch_timestamps_enable_fn(queue, record_count);
+}
+
+hsa_status_t HSA_API hsa_amd_queue_dispatch_timestamp_signal(const hsa_queue_t* queue,
+                                                             uint64_t packet_id,
+                                                             hsa_signal_t* signal) {
+  return amdExtTable->hsa_amd_queue_dispatch_timestamp_signal_fn(queue, packet_id, signal);
+}
+
+hsa_status_t HSA_API hsa_amd_queue_dispatch_timestamps_read(hsa_queue_t* queue,
+                                                            uint32_t max_records,
+                                                            hsa_amd_dispatch_timestamp_t* records,
+                                                            uint32_t* record_count,
+                                                            uint64_t* dropped) {
+  return amdExtTable->hsa_amd_queue_dispatch_timestamps_read_fn(queue, max_records, records,
+                                                                 record_count, dropped);
+}
+
+hsa_status_t HSA_API hsa_amd_runtime_metrics_get(hsa_amd_runtime_metrics_t* metrics) {
+  return amdExtTable->hsa_amd_runtime_metrics_get_fn(metrics);
+}
+
+hsa_status_t HSA_API hsa_amd_svm_profile_get_ranges(hsa_amd_svm_range_stats_t* ranges,
+                                                    uint32_t max_ranges, uint32_t* range_count) {
+  return amdExtTable->hsa_amd_svm_profile_get_ranges_fn(ranges, max_ranges, range_count);
+}
+
+hsa_status_t HSA_API hsa_amd_runtime_trace_flush(void) {
+  return amdExtTable->hsa_amd_runtime_trace_flush_fn();
+}
+
+hsa_status_t HSA_API hsa_amd_spm_stream_start(hsa_agent_t agent, size_t buffer_size,
+                                              uint32_t buffer_count,
+                                              hsa_amd_spm_stream_callback_t callback,
+                                              void* user_data, const char* file) {
+  return amdExtTable->hsa_amd_spm_stream_start_fn(agent, buffer_size, buffer_count, callback,
+                                                  user_data, file);
+}
+
+hsa_status_t HSA_API hsa_amd_spm_stream_stop(hsa_agent_t agent) {
+  return amdExtTable->hsa_amd_spm_stream_stop_fn(agent);
+}
+
+hsa_status_t HSA_API hsa_amd_profiling_get_clock_params(hsa_agent_t agent,
+                                                        const hsa_amd_clock_params_t** params) {
+  return amdExtTable->hsa_amd_profiling_get_clock_params_fn(agent, params);
+}
+
+hsa_status_t HSA_API hsa_amd_ipc_memory_attach_batch(const hsa_amd_ipc_memory_t* handles,
+                                                     const size_t* lens, uint32_t count,
+                                                     uint32_t num_agents,
+                                                     const hsa_agent_t* mapping_agents,
+                                                     void** mapped_ptrs) {
+  return amdExtTable->hsa_amd_ipc_memory_attach_batch_fn(handles, lens, count, num_agents,
+                                                         mapping_agents, mapped_ptrs);
+}
+
+hsa_status_t HSA_API hsa_amd_vmem_map_batch(const hsa_amd_vmem_map_desc_t* maps, size_t map_cnt,
+                                            uint64_t flags) {
+  return amdExtTable->hsa_amd_vmem_map_batch_fn(maps, map_cnt, flags);
+}
+
+hsa_status_t HSA_API hsa_amd_vmem_set_access_batch(const hsa_amd_vmem_range_t* ranges,
+                                                   size_t range_cnt,
+                                                   const hsa_amd_memory_access_desc_t* desc,
+                                                   size_t desc_cnt) {
+  return amdExtTable->hsa_amd_vmem_set_access_batch_fn(ranges, range_cnt, desc, desc_cnt);
+}
+
+hsa_status_t HSA_API hsa_amd_svm_prefetch_batch_async(const hsa_amd_svm_prefetch_range_t* ranges,
+                                                      size_t range_count,
+                                                      uint32_t num_dep_signals,
+                                                      const hsa_signal_t* dep_signals,
+                                                      hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_svm_prefetch_batch_async_fn(ranges, range_count, num_dep_signals,
+                                                          dep_signals, completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_portable_export_dmabuf_bulk(const void* const* ptrs,
+                                                         const size_t* sizes, size_t count,
+                                                         int* dmabuf, uint64_t* offsets) {
+  return amdExtTable->hsa_amd_portable_export_dmabuf_bulk_fn(ptrs, sizes, count, dmabuf, offsets);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_async_copy_strided(const hsa_amd_memory_copy_strided_t* blocks,
+                                                       uint32_t num_blocks, hsa_agent_t dst_agent,
+                                                       hsa_agent_t src_agent,
+                                                       uint32_t num_dep_signals,
+                                                       const hsa_signal_t* dep_signals,
+                                                       hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_memory_async_copy_strided_fn(blocks, num_blocks, dst_agent, src_agent,
+                                                           num_dep_signals, dep_signals,
+                                                           completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_fill_async(void* ptr, const void* pattern,
+                                               uint32_t pattern_size, size_t count,
+                                               uint32_t num_dep_signals,
+                                               const hsa_signal_t* dep_signals,
+                                               hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_memory_fill_async_fn(ptr, pattern, pattern_size, count,
+                                                   num_dep_signals, dep_signals, completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_copy_context_create(hsa_agent_t agent, uint32_t engine_ids_mask,
+                                                 hsa_amd_copy_context_t* context) {
+  return amdExtTable->hsa_amd_copy_context_create_fn(agent, engine_ids_mask, context);
+}
+
+hsa_status_t HSA_API hsa_amd_copy_context_submit(hsa_amd_copy_context_t context, void* dst,
+                                                 const void* src, size_t size,
+                                                 uint32_t num_dep_signals,
+                                                 const hsa_signal_t* dep_signals,
+                                                 hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_copy_context_submit_fn(context, dst, src, size, num_dep_signals,
+                                                     dep_signals, completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_copy_context_destroy(hsa_amd_copy_context_t context) {
+  return amdExtTable->hsa_amd_copy_context_destroy_fn(context);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_async_copy_stream(const void* src, hsa_agent_t src_agent,
+                                                      size_t size,
+                                                      hsa_amd_copy_stream_callback_t callback,
+                                                      void* user_data, uint32_t num_dep_signals,
+                                                      const hsa_signal_t* dep_signals,
+                                                      hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_memory_async_copy_stream_fn(src, src_agent, size, callback, user_data,
+                                                          num_dep_signals, dep_signals,
+                                                          completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_aie_buffer_host_access(void* ptr, bool host_access) {
+  return amdExtTable->hsa_amd_aie_buffer_host_access_fn(ptr, host_access);
+}
+
+hsa_status_t HSA_API hsa_amd_cu_partitions_create(hsa_agent_t agent, uint32_t num_partitions,
+                                                  hsa_amd_cu_partitions_t* partitions) {
+  return amdExtTable->hsa_amd_cu_partitions_create_fn(agent, num_partitions, partitions);
+}
+
+hsa_status_t HSA_API hsa_amd_cu_partitions_bind_queue(hsa_amd_cu_partitions_t partitions,
+                                                      hsa_queue_t* queue, uint32_t index) {
+  return amdExtTable->hsa_amd_cu_partitions_bind_queue_fn(partitions, queue, index);
+}
+
+hsa_status_t HSA_API hsa_amd_cu_partitions_rebalance(hsa_amd_cu_partitions_t partitions) {
+  return amdExtTable->hsa_amd_cu_partitions_rebalance_fn(partitions);
+}
+
+hsa_status_t HSA_API hsa_amd_cu_partitions_destroy(hsa_amd_cu_partitions_t partitions) {
+  return amdExtTable->hsa_amd_cu_partitions_destroy_fn(partitions);
+}
+
+hsa_status_t HSA_API hsa_amd_queue_cu_set_dispatch_mask(const hsa_queue_t* queue,
+                                                        uint32_t num_cu_mask_count,
+                                                        const uint32_t* cu_mask) {
+  return amdExtTable->hsa_amd_queue_cu_set_dispatch_mask_fn(queue, num_cu_mask_count, cu_mask);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_pool_allocate_async(hsa_amd_memory_pool_t memory_pool,
+                                                        size_t size, uint32_t flags,
+                                                        hsa_signal_t dep_signal, void** ptr) {
+  return amdExtTable->hsa_amd_memory_pool_allocate_async_fn(memory_pool, size, flags, dep_signal,
+                                                            ptr);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_pool_free_async(void* ptr, hsa_signal_t dep_signal) {
+  return amdExtTable->hsa_amd_memory_pool_free_async_fn(ptr, dep_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_register_memory_pressure_callback(
+    hsa_amd_memory_pressure_callback_t callback, void* data) {
+  return amdExtTable->hsa_amd_register_memory_pressure_callback_fn(callback, data);
+}
+
+hsa_status_t HSA_API hsa_amd_deregister_memory_pressure_callback(
+    hsa_amd_memory_pressure_callback_t callback, void* data) {
+  return amdExtTable->hsa_amd_deregister_memory_pressure_callback_fn(callback, data);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_pool_allocate_interleaved(
+    const hsa_amd_memory_pool_t* pools, size_t pool_count, size_t size, size_t granularity,
+    const hsa_amd_memory_access_desc_t* desc, size_t desc_cnt, void** ptr) {
+  return amdExtTable->hsa_amd_memory_pool_allocate_interleaved_fn(pools, pool_count, size,
+                                                                  granularity, desc, desc_cnt, ptr);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_pool_free_interleaved(void* ptr) {
+  return amdExtTable->hsa_amd_memory_pool_free_interleaved_fn(ptr);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_pool_allocate_batch(hsa_amd_memory_pool_t memory_pool,
+                                                        size_t count, const size_t* sizes,
+                                                        uint32_t flags, uint32_t batch_flags,
+                                                        uint32_t num_agents,
+                                                        const hsa_agent_t* agents, void** ptrs) {
+  return amdExtTable->hsa_amd_memory_pool_allocate_batch_fn(memory_pool, count, sizes, flags,
+                                                            batch_flags, num_agents, agents, ptrs);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_pool_reserve(hsa_amd_memory_pool_t memory_pool, size_t size) {
+  return amdExtTable->hsa_amd_memory_pool_reserve_fn(memory_pool, size);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_pool_release_reservation(hsa_amd_memory_pool_t memory_pool) {
+  return amdExtTable->hsa_amd_memory_pool_release_reservation_fn(memory_pool);
+}
+
+hsa_status_t HSA_API hsa_amd_dispatch_graph_create(hsa_agent_t agent, const void* packets,
+                                                   uint32_t packet_count,
+                                                   const uint32_t* kernarg_sizes,
+                                                   hsa_amd_dispatch_graph_t* graph) {
+  return amdExtTable->hsa_amd_dispatch_graph_create_fn(agent, packets, packet_count, kernarg_sizes,
+                                                       graph);
+}
+
+hsa_status_t HSA_API hsa_amd_dispatch_graph_launch(hsa_amd_dispatch_graph_t graph,
+                                                   hsa_queue_t* queue, uint32_t update_count,
+                                                   const hsa_amd_dispatch_graph_update_t* updates,
+                                                   hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_dispatch_graph_launch_fn(graph, queue, update_count, updates,
+                                                       completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_dispatch_graph_destroy(hsa_amd_dispatch_graph_t graph) {
+  return amdExtTable->hsa_amd_dispatch_graph_destroy_fn(graph);
+}
+
+hsa_status_t HSA_API hsa_amd_queue_suspend(hsa_queue_t* queue) {
+  return amdExtTable->hsa_amd_queue_suspend_fn(queue);
+}
+
+hsa_status_t HSA_API hsa_amd_queue_resume(hsa_queue_t* queue) {
+  return amdExtTable->hsa_amd_queue_resume_fn(queue);
+}
+
+hsa_status_t HSA_API hsa_amd_profiling_set_dispatch_filter(hsa_queue_t* queue,
+                                                           uint32_t kernel_object_count,
+                                                           const uint64_t* kernel_objects,
+                                                           uint32_t sample_interval) {
+  return amdExtTable->hsa_amd_profiling_set_dispatch_filter_fn(queue, kernel_object_count,
+                                                               kernel_objects, sample_interval);
+}
+
+hsa_status_t HSA_API hsa_amd_system_get_properties(hsa_amd_system_properties_t* properties,
+                                                   void* (*alloc)(size_t)) {
+  return amdExtTable->hsa_amd_system_get_properties_fn(properties, alloc);
+}
+
+hsa_status_t HSA_API hsa_amd_gpu_fault_records_get(hsa_amd_gpu_fault_record_t* records,
+                                                   uint32_t* count) {
+  return amdExtTable->hsa_amd_gpu_fault_records_get_fn(records, count);
+}
+
+hsa_status_t HSA_API hsa_amd_completion_queue_create(uint32_t size,
+                                                     hsa_amd_completion_queue_t* queue) {
+  return amdExtTable->hsa_amd_completion_queue_create_fn(size, queue);
+}
+
+hsa_status_t HSA_API hsa_amd_completion_queue_destroy(hsa_amd_completion_queue_t queue) {
+  return amdExtTable->hsa_amd_completion_queue_destroy_fn(queue);
+}
+
+hsa_status_t HSA_API hsa_amd_completion_queue_signal_create(hsa_amd_completion_queue_t queue,
+                                                            hsa_signal_value_t initial_value,
+                                                            uint64_t tag, hsa_signal_t* signal) {
+  return amdExtTable->hsa_amd_completion_queue_signal_create_fn(queue, initial_value, tag, signal);
+}
+
+hsa_status_t HSA_API hsa_amd_completion_queue_dequeue(hsa_amd_completion_queue_t queue,
+                                                      uint64_t timeout_hint,
+                                                      hsa_wait_state_t wait_hint,
+                                                      uint32_t max_records,
+                                                      hsa_amd_completion_record_t* records,
+                                                      uint32_t* count) {
+  return amdExtTable->hsa_amd_completion_queue_dequeue_fn(queue, timeout_hint, wait_hint,
+                                                          max_records, records, count);
+}
+
+hsa_status_t HSA_API hsa_amd_topology_get(hsa_amd_topology_t* topology, void* (*alloc)(size_t)) {
+  return amdExtTable->hsa_amd_topology_get_fn(topology, alloc);
+}
+
+hsa_status_t HSA_API hsa_amd_runtime_thread_policy_set(hsa_amd_thread_class_t thread_class,
+                                                       const hsa_amd_thread_policy_t* policy) {
+  return amdExtTable->hsa_amd_runtime_thread_policy_set_fn(thread_class, policy);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_async_copy_gang(void* dst, hsa_agent_t dst_agent,
+                                                    const void* src, hsa_agent_t src_agent,
+                                                    size_t size, uint32_t num_dep_signals,
+                                                    const hsa_signal_t* dep_signals,
+                                                    hsa_signal_t completion_signal,
+                                                    const hsa_amd_gang_copy_policy_t* policy) {
+  return amdExtTable->hsa_amd_memory_async_copy_gang_fn(dst, dst_agent, src, src_agent, size,
+                                                        num_dep_signals, dep_signals,
+                                                        completion_signal, policy);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_copy_engine_hints(hsa_agent_t dst_agent,
+                                                      hsa_agent_t src_agent,
+                                                      hsa_amd_copy_engine_hints_t* hints) {
+  return amdExtTable->hsa_amd_memory_copy_engine_hints_fn(dst_agent, src_agent, hints);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_set_device_only(void* ptr, bool device_only) {
+  return amdExtTable->hsa_amd_memory_set_device_only_fn(ptr, device_only);
+}
+
+hsa_status_t HSA_API hsa_amd_progress_counter_create(hsa_agent_t agent, uint64_t initial_value,
+                                                     uint32_t flags,
+                                                     hsa_amd_progress_counter_t* counter,
+                                                     hsa_amd_progress_counter_abi_t** abi) {
+  return amdExtTable->hsa_amd_progress_counter_create_fn(agent, initial_value, flags, counter, abi);
+}
+
+hsa_status_t HSA_API hsa_amd_progress_counter_destroy(hsa_amd_progress_counter_t counter) {
+  return amdExtTable->hsa_amd_progress_counter_destroy_fn(counter);
+}
+
+hsa_status_t HSA_API hsa_amd_progress_counter_wait(hsa_amd_progress_counter_t counter,
+                                                   uint64_t threshold, uint64_t timeout_hint,
+                                                   hsa_wait_state_t wait_hint, uint64_t* value) {
+  return amdExtTable->hsa_amd_progress_counter_wait_fn(counter, threshold, timeout_hint, wait_hint,
+                                                       value);
+}
+
+hsa_status_t HSA_API hsa_amd_memory_migrate_async(void* ptr, size_t size,
+                                                  hsa_amd_memory_pool_t memory_pool,
+                                                  uint32_t flags, uint32_t num_dep_signals,
+                                                  const hsa_signal_t* dep_signals,
+                                                  hsa_signal_t completion_signal) {
+  return amdExtTable->hsa_amd_memory_migrate_async_fn(ptr, size, memory_pool, flags,
+                                                      num_dep_signals, dep_signals,
+                                                      completion_signal);
+}
+
+hsa_status_t HSA_API hsa_amd_interop_cache_invalidate(int interop_handle) {
+  return amdExtTable->hsa_amd_interop_cache_invalidate_fn(interop_handle);
+}
+
+hsa_status_t HSA_API hsa_amd_profiling_get_agent_tick(hsa_agent_t agent, uint64_t* agent_tick) {
+  return amdExtTable->hsa_amd_profiling_get_agent_tick_fn(agent, agent_tick);
+}
+
 // Tools only table interfaces.
 namespace rocr {
 
@@ -1331,4 +1927,11 @@ hsa_status_t hsa_amd_queue_intercept_register(hsa_queue_t* queue,
   return amdExtTable->hsa_amd_queue_intercept_register_fn(queue, callback, user_data);
 }
 
+// Mirrors Amd Extension Apis
+hsa_status_t hsa_amd_queue_intercept_register_batch(hsa_queue_t* queue,
+                                                    hsa_amd_queue_intercept_handler callback,
+                                                    void* user_data) {
+  return amdExtTable->hsa_amd_queue_intercept_register_batch_fn(queue, callback, user_data);
+}
+
 }  // namespace rocr
@@ -128,10 +128,33 @@ KfdDriver::AllocateMemory(const core::MemoryRegion &mem_region,
            ? 1
            : kmt_alloc_flags.ui32.GTTAccess);
 
-  kmt_alloc_flags.ui32.Uncached =
-      (alloc_flags & core::MemoryRegion::AllocateUncached
-            ? 1
-            : kmt_alloc_flags.ui32.Uncached);
+  // Coarse grain memory from a fine grain region, cached without coherence.
+  if (alloc_flags & core::MemoryRegion::AllocateCoarseGrain) {
+    kmt_alloc_flags.ui32.CoarseGrain = 1;
+    kmt_alloc_flags.ui32.ExtendedCoherent = 0;
+  }
+
+  // Uncached memory is always fine grain.
+  if (alloc_flags & core::MemoryRegion::AllocateUncached) {
+    kmt_alloc_flags.ui32.Uncached = 1;
+    kmt_alloc_flags.ui32.CoarseGrain = 0;
+  }
+
+  // Huge pages only change how system memory is backed, VRAM fragments are
+  // handled by the driver.
+  if (m_region.IsSystem() && (alloc_flags & core::MemoryRegion::AllocateHugePage)) {
+    const size_t kHugePage1G = 1024 * 1024 * 1024;
+    kmt_alloc_flags.ui32.PageSize =
+        (size % kHugePage1G == 0) ? HSA_PAGE_SIZE_1GB : HSA_PAGE_SIZE_2MB;
+  }
+
+  // Large pages need physically contiguous backing and a VA aligned to the fragment so the GPU
+  // can use large PTE fragments.  Contiguity is best effort in the thunk.
+  size_t alignment = 0;
+  if (m_region.IsLocalMemory() && (alloc_flags & core::MemoryRegion::AllocateLargePage)) {
+    kmt_alloc_flags.ui32.Contiguous = 1;
+    alignment = 2 * 1024 * 1024;
+  }
 
   if (m_region.IsLocalMemory()) {
     // Allocate physically contiguous memory. AllocateKfdMemory function call
@@ -172,10 +195,10 @@ KfdDriver::AllocateMemory(const core::MemoryRegion &mem_region,
 
   //// Allocate memory.
   //// If it fails attempt to release memory from the block allocator and retry.
-  *mem = AllocateKfdMemory(kmt_alloc_flags, node_id, size);
+  *mem = AllocateKfdMemory(kmt_alloc_flags, node_id, size, alignment);
   if (*mem == nullptr) {
     m_region.owner()->Trim();
-    *mem = AllocateKfdMemory(kmt_alloc_flags, node_id, size);
+    *mem = AllocateKfdMemory(kmt_alloc_flags, node_id, size, alignment);
   }
 
   if (*mem != nullptr) {
@@ -250,9 +273,11 @@ hsa_status_t KfdDriver::DestroyQueue(core::Queue &queue) const {
 }
 
 void *KfdDriver::AllocateKfdMemory(const HsaMemFlags &flags, uint32_t node_id,
-                                   size_t size) {
+                                   size_t size, size_t alignment) {
   void *mem = nullptr;
-  const HSAKMT_STATUS status = hsaKmtAllocMemory(node_id, size, flags, &mem);
+  const HSAKMT_STATUS status =
+      (alignment == 0) ? hsaKmtAllocMemory(node_id, size, flags, &mem)
+                       : hsaKmtAllocMemoryAlign(node_id, size, alignment, flags, &mem);
   return (status == HSAKMT_STATUS_SUCCESS) ? mem : nullptr;
 }
 
@@ -45,6 +45,7 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 
+#include <cerrno>
 #include <memory>
 #include <string>
 
@@ -192,6 +193,7 @@ XdnaDriver::AllocateMemory(const core::MemoryRegion &mem_region,
 
   vmem_handle_mappings.emplace(create_bo_args.handle, mapped_mem);
   vmem_addr_mappings.emplace(mapped_mem, create_bo_args.handle);
+  vmem_size_mappings.emplace(mapped_mem, size);
 
   return HSA_STATUS_SUCCESS;
 }
@@ -210,6 +212,11 @@ hsa_status_t XdnaDriver::FreeMemory(void *mem, size_t size) {
 
   vmem_handle_mappings.erase(handle);
   vmem_addr_mappings.erase(it);
+  vmem_size_mappings.erase(mem);
+  {
+    ScopedAcquire<KernelMutex> lock(&device_owned_lock_);
+    device_owned_.erase(reinterpret_cast<uint64_t>(mem));
+  }
 
   return HSA_STATUS_SUCCESS;
 }
@@ -251,6 +258,8 @@ hsa_status_t XdnaDriver::DestroyQueue(core::Queue &queue) const {
     return HSA_STATUS_ERROR;
   }
 
+  FreeCmdPool(aie_queue.GetHwCtxHandle());
+
   return HSA_STATUS_SUCCESS;
 }
 
@@ -345,26 +354,125 @@ hsa_status_t XdnaDriver::SyncBos(const std::vector<uint64_t>& bo_addrs,
                                  const std::vector<uint32_t>& bo_sizes) {
   if (bo_addrs.size() != bo_sizes.size()) return HSA_STATUS_ERROR;
 
+  ScopedAcquire<KernelMutex> lock(&device_owned_lock_);
   for (int i = 0; i < bo_addrs.size(); i++) {
+    // The host has not touched buffers it released to the device.
+    if (device_owned_.count(bo_addrs[i]) != 0) continue;
     FlushCpuCache(reinterpret_cast<void*>(bo_addrs[i]), 0, bo_sizes[i]);
   }
 
   return HSA_STATUS_SUCCESS;
 }
 
-hsa_status_t XdnaDriver::ExecCmdAndWait(amdxdna_drm_exec_cmd* exec_cmd, uint32_t hw_ctx_handle) {
-  // Submit the cmd
-  if (ioctl(fd_, DRM_IOCTL_AMDXDNA_EXEC_CMD, exec_cmd)) return HSA_STATUS_ERROR;
+hsa_status_t XdnaDriver::SetHostAccess(void* ptr, bool host_access) {
+  auto it = vmem_size_mappings.find(ptr);
+  if (it == vmem_size_mappings.end()) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+
+  const uint64_t addr = reinterpret_cast<uint64_t>(ptr);
+  {
+    ScopedAcquire<KernelMutex> lock(&device_owned_lock_);
+    if (host_access) {
+      if (device_owned_.erase(addr) == 0) return HSA_STATUS_SUCCESS;
+    } else {
+      if (!device_owned_.insert(addr).second) return HSA_STATUS_SUCCESS;
+    }
+  }
+
+  // Writes back host stores before the device owns the buffer and drops
+  // stale lines before the host reads what the device wrote.
+  FlushCpuCache(ptr, 0, it->second);
+  return HSA_STATUS_SUCCESS;
+}
 
-  // Waiting for command to finish
+hsa_status_t XdnaDriver::WaitCmdChain(CmdChain& chain) {
   amdxdna_drm_wait_cmd wait_cmd = {};
-  wait_cmd.hwctx = hw_ctx_handle;
+  wait_cmd.hwctx = chain.hw_ctx_handle;
   wait_cmd.timeout = DEFAULT_TIMEOUT_VAL;
-  wait_cmd.seq = exec_cmd->seq;
+  wait_cmd.seq = chain.seq;
+
+  // The wait times out while the chain runs, keep waiting until it retires.
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  while (ioctl(fd_, DRM_IOCTL_AMDXDNA_WAIT_CMD, &wait_cmd)) {
+    if (errno == ETIME || errno == EINTR) continue;
+    status = HSA_STATUS_ERROR;
+    break;
+  }
 
-  if (ioctl(fd_, DRM_IOCTL_AMDXDNA_WAIT_CMD, &wait_cmd)) return HSA_STATUS_ERROR;
+  // BOs of a chain that did not retire must not be rewritten by a later submission.
+  ReleaseCmdChain(chain, status == HSA_STATUS_SUCCESS);
 
-  return HSA_STATUS_SUCCESS;
+  // Syncing BOs after we execute the command
+  if (SyncBos(chain.bo_addrs, chain.bo_sizes)) return HSA_STATUS_ERROR;
+
+  return status;
+}
+
+void XdnaDriver::ReleaseCmdChain(CmdChain& chain, bool reuse) {
+  std::vector<CmdBo> bos;
+  bos.reserve(chain.cmd_handles.size() + 1);
+  for (int i = 0; i < chain.cmd_handles.size(); i++)
+    bos.push_back({chain.cmd_handles[i], chain.cmd_sizes[i], chain.cmds[i]});
+  if (chain.chain != nullptr) bos.push_back({chain.chain_handle, chain.chain_size, chain.chain});
+  chain.cmd_handles.clear();
+  chain.cmds.clear();
+  chain.cmd_sizes.clear();
+  chain.chain = nullptr;
+
+  if (reuse) {
+    ScopedAcquire<KernelMutex> lock(&cmd_pool_lock_);
+    std::vector<CmdBo>& pool = cmd_pool_[chain.hw_ctx_handle];
+    while (!bos.empty() && pool.size() < kCmdPoolLimit) {
+      pool.push_back(bos.back());
+      bos.pop_back();
+    }
+  }
+
+  for (const CmdBo& bo : bos) FreeCmd(bo);
+}
+
+hsa_status_t XdnaDriver::AcquireCmd(uint32_t hw_ctx_handle, uint32_t size, uint32_t* handle,
+                                    amdxdna_cmd** cmd, uint32_t* bo_size) {
+  *bo_size = AlignUp(size, kCmdBoGranularity);
+  {
+    ScopedAcquire<KernelMutex> lock(&cmd_pool_lock_);
+    auto it = cmd_pool_.find(hw_ctx_handle);
+    if (it != cmd_pool_.end()) {
+      std::vector<CmdBo>& pool = it->second;
+      // Take the smallest free BO that fits.
+      auto best = pool.end();
+      for (auto bo = pool.begin(); bo != pool.end(); bo++)
+        if (bo->size >= *bo_size && (best == pool.end() || bo->size < best->size)) best = bo;
+      if (best != pool.end()) {
+        *handle = best->handle;
+        *cmd = best->cmd;
+        *bo_size = best->size;
+        *best = pool.back();
+        pool.pop_back();
+        return HSA_STATUS_SUCCESS;
+      }
+    }
+  }
+
+  return CreateCmd(*bo_size, handle, cmd);
+}
+
+void XdnaDriver::FreeCmd(const CmdBo& bo) const {
+  munmap(bo.cmd, bo.size);
+  drm_gem_close close_bo_args{0};
+  close_bo_args.handle = bo.handle;
+  ioctl(fd_, DRM_IOCTL_GEM_CLOSE, &close_bo_args);
+}
+
+void XdnaDriver::FreeCmdPool(uint32_t hw_ctx_handle) const {
+  std::vector<CmdBo> pool;
+  {
+    ScopedAcquire<KernelMutex> lock(&cmd_pool_lock_);
+    auto it = cmd_pool_.find(hw_ctx_handle);
+    if (it == cmd_pool_.end()) return;
+    pool.swap(it->second);
+    cmd_pool_.erase(it);
+  }
+  for (const CmdBo& bo : pool) FreeCmd(bo);
 }
 
 hsa_status_t XdnaDriver::RegisterCmdBOs(
@@ -435,7 +543,12 @@ hsa_status_t XdnaDriver::CreateCmd(uint32_t size, uint32_t* handle, amdxdna_cmd*
   *cmd = static_cast<amdxdna_cmd*>(mmap(nullptr, create_cmd_bo.size, PROT_READ | PROT_WRITE,
                                         MAP_SHARED, fd_, cmd_bo_get_bo_info.map_offset));
 
-  if (cmd == MAP_FAILED) return HSA_STATUS_ERROR;
+  if (*cmd == MAP_FAILED) {
+    drm_gem_close close_bo_args{0};
+    close_bo_args.handle = create_cmd_bo.handle;
+    ioctl(fd_, DRM_IOCTL_GEM_CLOSE, &close_bo_args);
+    return HSA_STATUS_ERROR;
+  }
 
   *handle = create_cmd_bo.handle;
 
@@ -443,24 +556,27 @@ hsa_status_t XdnaDriver::CreateCmd(uint32_t size, uint32_t* handle, amdxdna_cmd*
 }
 
 hsa_status_t XdnaDriver::SubmitCmdChain(hsa_amd_aie_ert_packet_t* first_pkt, uint32_t num_pkts,
-                                        uint32_t num_operands, uint32_t hw_ctx_handle) {
+                                        uint32_t num_operands, uint32_t hw_ctx_handle,
+                                        CmdChain& chain) {
   // Storing the metadata of the BOs that store the operands and metadata
   // of the commands we are going to submit
   std::vector<uint32_t> bo_args;
-  std::vector<uint32_t> bo_sizes;
-  std::vector<uint64_t> bo_addrs;
+  std::vector<uint32_t>& bo_sizes = chain.bo_sizes;
+  std::vector<uint64_t>& bo_addrs = chain.bo_addrs;
   bo_args.reserve(num_operands);
   bo_sizes.reserve(num_operands);
   bo_addrs.reserve(num_operands);
 
   // Storing the commands that we are going to submit and the
-  // corresponding metadata
-  std::vector<uint32_t> cmd_handles;
-  std::vector<uint32_t> cmd_sizes;
-  std::vector<amdxdna_cmd*> cmds;
+  // corresponding metadata, the chain owns them until WaitCmdChain
+  std::vector<uint32_t>& cmd_handles = chain.cmd_handles;
+  std::vector<uint32_t>& cmd_sizes = chain.cmd_sizes;
+  std::vector<amdxdna_cmd*>& cmds = chain.cmds;
   cmd_handles.reserve(num_pkts);
   cmd_sizes.reserve(num_pkts);
   cmds.reserve(num_pkts);
+  chain.hw_ctx_handle = hw_ctx_handle;
+  MAKE_NAMED_SCOPE_GUARD(chainGuard, [&]() { ReleaseCmdChain(chain, true); });
 
   // Iterating over all the contiguous HSA_AMD_AIE_ERT_CMD_CHAIN packets
   for (int pkt_iter = 0; pkt_iter < num_pkts; pkt_iter++) {
@@ -479,7 +595,8 @@ hsa_status_t XdnaDriver::SubmitCmdChain(hsa_amd_aie_ert_packet_t* first_pkt, uin
     uint32_t cmd_bo_handle = 0;
     amdxdna_cmd* cmd = nullptr;
     uint32_t cmd_size = sizeof(amdxdna_cmd) + pkt->count * sizeof(uint32_t);
-    if (CreateCmd(cmd_size, &cmd_bo_handle, &cmd)) return HSA_STATUS_ERROR;
+    if (AcquireCmd(hw_ctx_handle, cmd_size, &cmd_bo_handle, &cmd, &cmd_size))
+      return HSA_STATUS_ERROR;
 
     // Filling in the fields of the command
     cmd->state = pkt->state;
@@ -501,8 +618,13 @@ hsa_status_t XdnaDriver::SubmitCmdChain(hsa_amd_aie_ert_packet_t* first_pkt, uin
   // Creating a packet that contains the command chain
   uint32_t cmd_chain_bo_handle = 0;
   amdxdna_cmd* cmd_chain = nullptr;
-  int cmd_chain_size = (cmd_handles.size() + 1) * sizeof(uint32_t);
-  if (CreateCmd(cmd_chain_size, &cmd_chain_bo_handle, &cmd_chain)) return HSA_STATUS_ERROR;
+  uint32_t cmd_chain_size = (cmd_handles.size() + 1) * sizeof(uint32_t);
+  if (AcquireCmd(hw_ctx_handle, cmd_chain_size, &cmd_chain_bo_handle, &cmd_chain,
+                 &cmd_chain_size))
+    return HSA_STATUS_ERROR;
+  chain.chain = cmd_chain;
+  chain.chain_handle = cmd_chain_bo_handle;
+  chain.chain_size = cmd_chain_size;
 
   // Writing information to the command buffer
   amdxdna_cmd_chain* cmd_chain_payload = reinterpret_cast<amdxdna_cmd_chain*>(cmd_chain->data);
@@ -537,25 +659,11 @@ hsa_status_t XdnaDriver::SubmitCmdChain(hsa_amd_aie_ert_packet_t* first_pkt, uin
   exec_cmd_0.cmd_count = 1;
   exec_cmd_0.arg_count = bo_args.size();
 
-  // Executing all commands in the command chain
-  ExecCmdAndWait(&exec_cmd_0, hw_ctx_handle);
-
-  // Unmapping and closing the cmd BOs
-  drm_gem_close close_bo_args{0};
-  for (int i = 0; i < cmd_handles.size(); i++) {
-    if (munmap(cmds[i], cmd_sizes[i]) != 0) return HSA_STATUS_ERROR;
-    close_bo_args.handle = cmd_handles[i];
-    ioctl(fd_, DRM_IOCTL_GEM_CLOSE, &close_bo_args);
-  }
-
-  // Unmapping and closing the cmd_chain BO
-  if (munmap(cmd_chain, cmd_chain_size) != 0) return HSA_STATUS_ERROR;
-  close_bo_args.handle = cmd_chain_bo_handle;
-  ioctl(fd_, DRM_IOCTL_GEM_CLOSE, &close_bo_args);
-
-  // Syncing BOs after we execute the command
-  if (SyncBos(bo_addrs, bo_sizes)) return HSA_STATUS_ERROR;
+  // Executing all commands in the command chain, completion is collected by WaitCmdChain
+  if (ioctl(fd_, DRM_IOCTL_AMDXDNA_EXEC_CMD, &exec_cmd_0)) return HSA_STATUS_ERROR;
+  chain.seq = exec_cmd_0.seq;
 
+  chainGuard.Dismiss();
   return HSA_STATUS_SUCCESS;
 }
 
@@ -120,7 +120,7 @@ class Agent : public Checked<0xF6BC25EB17E6F917> {
   // @param [in] type CPU or GPU or other.
   explicit Agent(Driver &driver, uint32_t node_id, DeviceType type)
       : node_id_(node_id), device_type_(uint32_t(type)), driver_(&driver),
-        profiling_enabled_(false), enabled_(false) {
+        profiling_enabled_(false), enabled_(false), init_times_() {
     public_handle_ = Convert(this);
   }
 
@@ -167,6 +167,42 @@ class Agent : public Checked<0xF6BC25EB17E6F917> {
     return HSA_STATUS_ERROR;
   }
 
+  // @brief Submit a batch of DMA copies between the same agent pair. This
+  // call does not wait until the copies are finished.
+  //
+  // @details All semantics and params are identical to DmaCopy except that
+  // @p out_signal is decremented once, after every copy in @p copies is done.
+  //
+  // @param [in] copies Array of copy descriptors.
+  // @param [in] count Number of descriptors, must be non-zero.
+  //
+  // @retval HSA_STATUS_SUCCESS The copies were submitted successfully.
+  virtual hsa_status_t DmaCopyBatch(const hsa_amd_memory_copy_descriptor_t* copies,
+                                    uint32_t count, core::Agent& dst_agent,
+                                    core::Agent& src_agent,
+                                    std::vector<core::Signal*>& dep_signals,
+                                    core::Signal& out_signal) {
+    return HSA_STATUS_ERROR;
+  }
+
+  // @brief Submit a list of strided block copies between the same agent
+  // pair. This call does not wait until the copies are finished.
+  //
+  // @details All semantics and params are identical to DmaCopyBatch except
+  // that each descriptor is a strided block.
+  //
+  // @param [in] blocks Array of block descriptors.
+  // @param [in] count Number of descriptors, must be non-zero.
+  //
+  // @retval HSA_STATUS_SUCCESS The copies were submitted successfully.
+  virtual hsa_status_t DmaCopyStrided(const hsa_amd_memory_copy_strided_t* blocks,
+                                      uint32_t count, core::Agent& dst_agent,
+                                      core::Agent& src_agent,
+                                      std::vector<core::Signal*>& dep_signals,
+                                      core::Signal& out_signal) {
+    return HSA_STATUS_ERROR;
+  }
+
   // @brief Submit DMA copy command to move data from src to dst on engine_id.
   // This call does not wait until the copy is finished
   //
@@ -184,7 +220,27 @@ class Agent : public Checked<0xF6BC25EB17E6F917> {
                                std::vector<core::Signal*>& dep_signals,
                                core::Signal& out_signal,
                                int engine_offset,
-                               bool force_copy_on_sdma) {
+                               bool force_copy_on_sdma,
+                               hsa_amd_queue_priority_t priority) {
+    return HSA_STATUS_ERROR;
+  }
+
+  // @brief Submit DMA copy command split across several engines.  This call does not wait until
+  // the copy is finished.
+  //
+  // @details All semantics and params are identical to DmaCopy except for the gang policy.
+  //
+  // @param [in] width Number of engines, 0 for the link's bandwidth factor.
+  // @param [in] leader Leader selection.
+  // @param [in] leader_offset Leading engine, numbered as for DmaCopyOnEngine, with
+  // HSA_AMD_GANG_LEADER_ENGINE.
+  //
+  // @retval HSA_STATUS_SUCCESS The copy was submitted.
+  virtual hsa_status_t DmaCopyGang(void* dst, core::Agent& dst_agent, const void* src,
+                                   core::Agent& src_agent, size_t size,
+                                   std::vector<core::Signal*>& dep_signals,
+                                   core::Signal& out_signal, uint32_t width,
+                                   hsa_amd_gang_leader_t leader, int leader_offset) {
     return HSA_STATUS_ERROR;
   }
 
@@ -201,6 +257,18 @@ class Agent : public Checked<0xF6BC25EB17E6F917> {
     return HSA_STATUS_ERROR;
   }
 
+  // @brief Rank the DMA engines able to serve a copy direction.
+  //
+  // @param [in] dst_agent Destination agent.
+  // @param [in] src_agent Source agent.
+  // @param [out] hints Ranked engines, link properties are left to the caller.
+  //
+  // @retval HSA_STATUS_SUCCESS The engines were ranked.
+  virtual hsa_status_t DmaCopyEngineHints(core::Agent& dst_agent, core::Agent& src_agent,
+                                          hsa_amd_copy_engine_hints_t* hints) {
+    return HSA_STATUS_ERROR;
+  }
+
   // @brief Submit DMA command to set the content of a pointer and wait
   // until it is finished.
   //
@@ -215,6 +283,22 @@ class Agent : public Checked<0xF6BC25EB17E6F917> {
     return HSA_STATUS_ERROR;
   }
 
+  // @brief Submit a DMA fill of a repeating pattern. This call does not wait
+  // until the fill is finished.
+  //
+  // @param [in] ptr Address of the memory to be set, aligned to the pattern.
+  // @param [in] pattern Pattern of @p pattern_dwords uint32_t, 1 or 4.
+  // @param [in] size Number of bytes to set, a multiple of the pattern size.
+  // @param [in] dep_signals Array of signals to wait on before the fill.
+  // @param [in] out_signal Signal decremented once the fill is done.
+  //
+  // @retval HSA_STATUS_SUCCESS The fill was submitted successfully.
+  virtual hsa_status_t DmaFillAsync(void* ptr, const uint32_t* pattern, uint32_t pattern_dwords,
+                                    size_t size, std::vector<core::Signal*>& dep_signals,
+                                    core::Signal& out_signal) {
+    return HSA_STATUS_ERROR;
+  }
+
   // @brief Invoke the user provided callback for each region accessible by
   // this agent.
   //
@@ -320,10 +404,26 @@ class Agent : public Checked<0xF6BC25EB17E6F917> {
 
   __forceinline void Enable() { enabled_ = true; }
 
+  // @brief Timestamps of this agent's setup during hsa_init.
+  __forceinline hsa_amd_agent_init_times_t& init_times() { return init_times_; }
+  __forceinline const hsa_amd_agent_init_times_t& init_times() const { return init_times_; }
+
   virtual void Trim() {
     for (auto region : regions()) region->Trim();
   }
 
+  // @brief Trim for callers outside the allocation path, which already holds the memory lock.
+  void TrimCaches() {
+    ScopedAcquire<KernelMutex> lock(&agent_memory_lock_);
+    Trim();
+  }
+
+  // @brief Releases region caches idle for at least idle_ms, see MemoryRegion::TrimIdle.
+  void TrimIdleCaches(uint64_t idle_ms) {
+    ScopedAcquire<KernelMutex> lock(&agent_memory_lock_);
+    for (auto region : regions()) region->TrimIdle(idle_ms);
+  }
+
 protected:
   // Intention here is to have a polymorphic update procedure for public_handle_
   // which is callable on any Agent* but only from some class dervied from
@@ -364,6 +464,8 @@ protected:
 
   bool enabled_;
 
+  hsa_amd_agent_init_times_t init_times_;
+
   // Used by an Agent's MemoryRegions to ensure serial memory operation on the device.
   // Serial memory operations are needed to ensure, among other things, that allocation failures are
   // due to true OOM conditions and per region caching (Trim and Allocate must be serial and
@@ -43,9 +43,13 @@
 #ifndef HSA_RUNTIME_CORE_INC_AMD_HW_AQL_AIE_COMMAND_PROCESSOR_H_
 #define HSA_RUNTIME_CORE_INC_AMD_HW_AQL_AIE_COMMAND_PROCESSOR_H_
 
+#include <deque>
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include "core/inc/amd_aie_agent.h"
+#include "core/inc/amd_xdna_driver.h"
 #include "core/inc/queue.h"
 #include "core/inc/runtime.h"
 #include "core/inc/signal.h"
@@ -132,9 +136,62 @@ private:
 
   /// @brief Called when the doorbell is rung to iterate over
   /// all packets and submit them. Submissions is done by
-  // calling into the XdnaDriver.
-  hsa_status_t SubmitCmd(XdnaDriver& driver, void* queue_base, uint64_t read_dispatch_id,
-                         uint64_t write_dispatch_id);
+  // calling into the XdnaDriver.  Returns without waiting for the
+  /// packets to execute, the completion thread retires them.
+  hsa_status_t SubmitCmd(XdnaDriver& driver, void* queue_base, uint64_t write_dispatch_id);
+
+  /// @brief Command chain submitted to the driver and the index of the packet
+  /// following its last one.  Barrier packets are retired with an empty chain.
+  struct Submission {
+    XdnaDriver::CmdChain chain;
+    uint64_t end_id;
+    /// @brief Completion signals of the packets, decremented once they retire.
+    std::vector<hsa_signal_t> completion_signals;
+  };
+
+  /// @brief Submits the barrier packet at submit_index_ if its dependencies
+  /// are satisfied, otherwise arranges for SubmitCmd to run again once the
+  /// first outstanding one is.  Called with submit_lock_ held.
+  ///
+  /// @return True if the barrier was submitted.
+  bool SubmitBarrier(const hsa_barrier_and_packet_t* barrier);
+
+  /// @brief Async handler resuming submission when a barrier dependency resolves.
+  static bool BarrierHandler(hsa_signal_value_t value, void* arg);
+
+  /// @brief Link from pending barrier handlers to the queue, cut by Inactivate
+  /// so handlers firing later leave the queue alone.
+  struct BarrierLink {
+    KernelMutex lock;
+    AieAqlQueue* queue;
+  };
+  std::shared_ptr<BarrierLink> barrier_link_;
+
+  /// @brief True while an async handler waits on a barrier dependency.
+  bool barrier_blocked_ = false;
+
+  /// @brief Completion thread entry.  Waits for submissions in order and
+  /// advances read_dispatch_id past each one as it retires.
+  static void CompletionRun(void* queue);
+  void CompletionLoop();
+
+  /// @brief Stops the completion thread after all submissions have retired.
+  void StopCompletionThread();
+
+  /// @brief Serializes doorbell submissions and guards the fields below.
+  KernelMutex submit_lock_;
+
+  /// @brief Index of the first packet not yet submitted to the driver.
+  uint64_t submit_index_ = 0;
+
+  /// @brief Submissions in flight, oldest first.
+  std::deque<Submission> pending_;
+
+  /// @brief Asks the completion thread to exit once pending_ is empty.
+  bool completion_exit_ = false;
+
+  os::Thread completion_thread_ = nullptr;
+  os::EventHandle completion_event_ = nullptr;
 
   /// @brief Handle for an application context on the AIE device.
   ///
@@ -48,6 +48,7 @@
 #include "core/inc/queue.h"
 #include "core/inc/amd_gpu_agent.h"
 #include "core/util/locks.h"
+#include "core/util/ring_allocator.h"
 
 namespace rocr {
 namespace AMD {
@@ -65,19 +66,35 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   // Acquires/releases queue resources and requests HW schedule/deschedule.
   AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id,
            ScratchInfo& scratch, core::HsaEventCallback callback,
-           void* err_data, bool is_kv = false);
+           void* err_data, bool is_kv = false, bool device_ring = false,
+           const core::Agent* host_agent = nullptr);
 
   ~AqlQueue();
 
   /// @brief Queue interfaces
   hsa_status_t Inactivate() override;
 
-  /// @brief Change the scheduling priority of the queue
+  /// @brief Change the scheduling priority of the queue.  With HSA_QUEUE_PRIORITY_INTERVAL set
+  /// the change is only recorded and later applied by the agent's priority updater.
   hsa_status_t SetPriority(HSA_QUEUE_PRIORITY priority) override;
 
+  /// @brief Applies the latest priority recorded by SetPriority, if any.
+  void ApplyPendingPriority();
+
+  /// @brief Unmaps the queue from the hardware, its waves saved by CWSR, or maps it again.
+  hsa_status_t SetSuspended(bool suspended) override;
+
   /// @brief Destroy ref counted queue
   void Destroy() override;
 
+  /// @brief Returns an idle queue to the state of a newly created one so the agent's queue pool
+  /// can hand it out again.  Read and write indices keep counting from their current values.
+  /// @return false if the queue is busy, faulted or suspended and must be destroyed instead.
+  bool ResetForReuse();
+
+  /// @brief Hand a pooled queue to a new owner.
+  void Reuse(core::HsaEventCallback callback, void* err_data);
+
   /// @brief Atomically reads the Read index of with Acquire semantics
   ///
   /// @return uint64_t Value of read index
@@ -196,6 +213,10 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   /// @return hsa_status_t
   hsa_status_t GetCUMasking(uint32_t num_cu_mask_count, uint32_t* cu_mask) override;
 
+  /// @brief Narrows the CU mask of dispatches submitted after this call with a PM4 packet in the
+  /// queue instead of a KFD call.
+  hsa_status_t SetDispatchCUMasking(uint32_t num_cu_mask_count, const uint32_t* cu_mask) override;
+
   // @brief Submits a block of PM4 and waits until it has been executed.
   void ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b,
                   hsa_fence_scope_t acquireFence = HSA_FENCE_SCOPE_NONE,
@@ -214,6 +235,20 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   /// @brief Provide information about the queue
   hsa_status_t GetInfo(hsa_queue_info_attribute_t attribute, void* value) override;
 
+  /// @brief Allocate kernarg memory from the queue's kernarg ring.
+  hsa_status_t AllocKernarg(size_t size, size_t alignment, uint64_t packet_id,
+                            void** kernarg_address) override;
+
+  /// @brief Allocate the dispatch timestamp ring and enable profiling.
+  hsa_status_t EnableDispatchTimestamps(uint32_t record_count) override;
+
+  /// @brief Hand out the next dispatch timestamp record as a completion signal.
+  hsa_status_t AllocDispatchTimestamp(uint64_t packet_id, hsa_signal_t* signal) override;
+
+  /// @brief Copy out and release completed dispatch timestamp records.
+  hsa_status_t ReadDispatchTimestamps(uint32_t max_records, hsa_amd_dispatch_timestamp_t* records,
+                                      uint32_t* record_count, uint64_t* dropped) override;
+
   /// @brief Enable use of GWS from this queue.
   hsa_status_t EnableGWS(int gws_slot_count);
 
@@ -227,6 +262,32 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   /// @brief Async reclaim alternate scratch memory
   void AsyncReclaimAltScratch();
 
+  /// @brief Periodic scratch bookkeeping: ages the demand histogram, reclaims main scratch that
+  /// has stayed well above predicted demand and returns shared arena leases while the queue is
+  /// idle.
+  /// @return Main scratch size the next scratch request is expected to need, 0 if unknown.
+  size_t ScratchMonitorTick();
+
+  /// @brief Builds the vendor packets bracketing a dispatch selected by a profiling filter.  on
+  /// turns CP timestamps on for the following dispatch, off turns them back off once it has
+  /// completed.  Only supported on gfx9 and later.
+  hsa_status_t ProfilingTogglePackets(core::AqlPacket* on, core::AqlPacket* off);
+
+  /// @brief Records read index progress since the previous sample.  now is in
+  /// os::ReadAccurateClock units.
+  void SampleTelemetry(uint64_t now);
+
+  /// @brief Counts monitor samples finding the ring at least three quarters full, see
+  /// HSA_QUEUE_GROW_HITS.
+  /// @return Number of packets pending in the ring.
+  uint64_t SampleHighWater();
+
+  /// @brief Ring size in packets the queue was created with, before any growth.
+  uint32_t initial_size() const { return initial_size_pkts_; }
+
+  /// @brief CPU agent requested for the queue's host memory, null for the GPU's nearest CPU.
+  const core::Agent* host_agent() const { return host_agent_; }
+
  protected:
   bool _IsA(Queue::rtti_t id) const override { return id == &rtti_id(); }
 
@@ -238,10 +299,22 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   void AllocRegisteredRingBuffer(uint32_t queue_size_pkts);
   void FreeRegisteredRingBuffer();
 
+  /// @brief Moves an idle queue to a new ring of queue_size_pkts packets.  The old ring is kept if
+  /// the new one can not be allocated or attached.
+  bool GrowRing(uint32_t queue_size_pkts);
+
   /// @brief Abstracts the file handle use for double mapping queues.
   void CloseRingBufferFD(const char* ring_buf_shm_path, int fd) const;
   int CreateRingBufferFD(const char* ring_buf_shm_path, uint32_t ring_buf_phys_size_bytes) const;
 
+  /// @brief Rings the pre-AQL doorbells under legacy_doorbell_lock.  Kept out of StoreRelaxed
+  /// so the hardware doorbell path stays a fence and a store.
+  void StoreLegacyDoorbell(hsa_signal_value_t value);
+
+  /// @brief Publishes value and rings the hardware doorbell on behalf of all submitters if no
+  /// other thread is already doing so, see HSA_DOORBELL_COMBINE_NS.
+  void CombineDoorbell(uint64_t value);
+
   /// @brief Define the Scratch Buffer Descriptor and related parameters
   /// that enable kernel access scratch memory
   void InitScratchSRD();
@@ -264,6 +337,21 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   /// @brief Halt the queue without destroying it or fencing memory.
   void Suspend();
 
+  /// @brief Updates the driver's queue priority now, dropping any pending request.
+  hsa_status_t UpdatePriority(HSA_QUEUE_PRIORITY priority);
+
+  /// @brief Places an AQL packet running ib in the ring without waiting for it.  signal may be
+  /// null.  Returns the packet's index.
+  uint64_t SubmitPM4IB(const uint32_t* ib, size_t ib_size_dw, hsa_fence_scope_t acquireFence,
+                       hsa_fence_scope_t releaseFence, hsa_signal_t signal);
+
+  /// @brief Fills packet with a gfx9+ vendor AQL packet that runs ib.
+  void BuildPM4IBPacket(const uint32_t* ib, size_t ib_size_dw, uint16_t header,
+                        hsa_signal_t signal, void* packet) const;
+
+  /// @brief Writes the dispatch mask IB for mask to the next free IB slot.
+  hsa_status_t BuildDispatchMaskIB(const std::vector<uint32_t>& mask);
+
   /// @brief Handle insufficient scratch
   void HandleInsufficientScratch(hsa_signal_value_t& error_code, hsa_signal_value_t& waitVal,
                                  bool& changeWait);
@@ -291,6 +379,14 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   // Cached value of HsaNodeProperties.HSA_CAPABILITY.DoorbellType
   int doorbell_type_;
 
+  // Doorbell combiner, see CombineDoorbell.  Window in os::ReadAccurateClock ticks the elected
+  // thread waits before ringing, 0 if combining is off, and the highest doorbell value plus one
+  // published and rung so far.
+  uint64_t combine_window_;
+  std::atomic<uint64_t> combine_published_;
+  std::atomic<uint64_t> combine_rung_;
+  SpinMutex combine_lock_;
+
   // Handle of agent, which queue is attached to
   GpuAgent* agent_;
 
@@ -299,6 +395,22 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   // Handle of scratch memory descriptor
   ScratchInfo queue_scratch_;
 
+  // Telemetry reported through HSA_AMD_QUEUE_INFO_TELEMETRY and the read index and time of the
+  // sample it was computed from.  telemetry_stall_start_ is the time the current stall started,
+  // 0 if not stalled.
+  hsa_amd_queue_telemetry_t telemetry_;
+  uint64_t telemetry_read_index_;
+  uint64_t telemetry_time_;
+  uint64_t telemetry_stall_start_;
+  KernelMutex telemetry_lock_;
+
+  // Creation time ring size and the number of monitor samples that found the ring near full.
+  uint32_t initial_size_pkts_;
+  std::atomic<uint32_t> high_water_hits_;
+
+  // Serializes queue_scratch_ updates between the event handler and the elastic scratch monitor.
+  KernelMutex scratch_lock_{"AqlQueue::scratch_lock_"};
+
   AMD::callback_t<core::HsaEventCallback> errors_callback_;
 
   void* errors_data_;
@@ -306,11 +418,48 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   // Is KV device queue
   bool is_kv_queue_;
 
+  // CPU agent whose NUMA node backs the host side ring, kernarg ring and IB, and its allocator.
+  const core::Agent* host_agent_;
+  std::function<void*(size_t size, size_t align, core::MemoryRegion::AllocateFlags flags)>
+      host_allocator_;
+
   // GPU-visible indirect buffer holding PM4 commands.
   void* pm4_ib_buf_;
   uint32_t pm4_ib_size_b_;
   KernelMutex pm4_ib_mutex_;
 
+  // IBs setting COMPUTE_STATIC_THREAD_MGMT_SE* for dispatch CU masks, one per distinct mask.
+  // Guarded by mask_lock_.
+  struct DispatchMaskIB {
+    std::vector<uint32_t> mask;
+    uint32_t* ib;
+    uint32_t size_dw;
+  };
+  static const uint32_t kDispatchMaskIBSize = 0x200;
+  static const uint32_t kDispatchMaskIBCount = 32;
+  void* dispatch_mask_buf_;
+  std::vector<DispatchMaskIB> dispatch_mask_ibs_;
+
+  // IBs writing the queue properties with profiling on and off, see ProfilingTogglePackets.
+  // Built once under pm4_ib_mutex_.
+  static const uint32_t kProfileIBSizeDw = 8;
+  uint32_t* profile_ib_buf_;
+
+  // Kernarg ring, allocated on first use.
+  void* kernarg_ring_buf_;
+  RingAllocator kernarg_ring_;
+  KernelMutex kernarg_ring_lock_;
+
+  // Dispatch timestamp ring.  Records are signal shaped so the CP writes the dispatch start and
+  // end ticks into them and then decrements their value to 0.  Records between tail and head are
+  // unread, ts_ring_packet_ids_ holds the packet id each was taken for.
+  amd_signal_t* ts_ring_;
+  std::vector<uint64_t> ts_ring_packet_ids_;
+  uint64_t ts_ring_head_;
+  uint64_t ts_ring_tail_;
+  uint64_t ts_ring_dropped_;
+  KernelMutex ts_ring_lock_;
+
   // Error handler control variable.
   std::atomic<uint32_t> dynamicScratchState, exceptionState;
   enum { ERROR_HANDLER_DONE = 1, ERROR_HANDLER_TERMINATE = 2, ERROR_HANDLER_SCRATCH_RETRY = 4 };
@@ -318,6 +467,16 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
   // Queue currently suspended or scheduled
   bool suspended_;
 
+  // Queue descheduled by SetSuspended.  Guards hsaKmtUpdateQueue calls so priority changes
+  // do not map a preempted queue.
+  bool preempted_;
+  KernelMutex preempt_lock_;
+
+  // Priority recorded by an asynchronous SetPriority and not yet given to the driver.
+  // Protected by preempt_lock_.
+  HSA_QUEUE_PRIORITY requested_priority_;
+  bool priority_pending_;
+
   // Thunk dispatch and wavefront scheduling priority
   HSA_QUEUE_PRIORITY priority_;
 
@@ -347,7 +506,7 @@ class AqlQueue : public core::Queue, private core::LocalSignal, public core::Doo
 KernelMutex& queue_lock() {
   // This allocation is meant to last until the last thread has exited.
   // It is intentionally not freed.
-  static KernelMutex* queue_lock_ = new KernelMutex();
+  static KernelMutex* queue_lock_ = new KernelMutex("queue_lock_");
   return *queue_lock_;
 }
 
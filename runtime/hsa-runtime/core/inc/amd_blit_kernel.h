@@ -110,6 +110,14 @@ class BlitKernel : public core::Blit {
   virtual hsa_status_t SubmitLinearFillCommand(void* ptr, uint32_t value,
                                                size_t count) override;
 
+  /// @brief Submit an AQL packet filling with a 1 or 4 dword pattern. The call
+  /// is non blocking.  4 dword patterns need a 16 byte aligned destination and
+  /// size, and are not supported before gfx9.
+  virtual hsa_status_t SubmitLinearFillCommand(void* ptr, const uint32_t* pattern,
+                                               uint32_t pattern_dwords, size_t size,
+                                               std::vector<core::Signal*>& dep_signals,
+                                               core::Signal& out_signal) override;
+
   virtual hsa_status_t EnableProfiling(bool enable) override;
 
   virtual uint64_t PendingBytes() override;
@@ -151,6 +159,14 @@ class BlitKernel : public core::Blit {
       uint32_t fill_value;
       uint32_t num_workitems;
     } fill;
+
+    struct __ALIGNED__(16) {
+      uint64_t phase1_dst_start;
+      uint64_t phase2_dst_start;
+      uint64_t phase2_dst_end;
+      uint32_t pattern[4];
+      uint32_t num_workitems;
+    } fill_pattern;
   };
 
   // Index after which bytes will have been written.
@@ -173,6 +189,9 @@ class BlitKernel : public core::Blit {
 
   KernelArgs* ObtainAsyncKernelCopyArg();
 
+  /// Writes barrier packets for dep_signals from write_index, returns the index following them.
+  uint64_t WriteDependencyBarriers(uint64_t write_index, std::vector<core::Signal*>& dep_signals);
+
   void RecordBlitHistory(uint64_t size, uint64_t index);
 
   /// AQL code object and size for each kernel.
@@ -180,6 +199,9 @@ class BlitKernel : public core::Blit {
     CopyAligned,
     CopyMisaligned,
     Fill,
+    CopyAlignedNT,
+    FillNT,
+    FillPattern,
   };
 
   struct KernelCode {
@@ -222,6 +244,12 @@ class BlitKernel : public core::Blit {
 
   /// Number of CUs on the underlying agent.
   int num_cus_;
+
+  /// True if the unrolled non-temporal kernels are available for large copies and fills.
+  bool streaming_;
+
+  /// Wavefronts per CU launched by the non-temporal kernels.
+  int streaming_waves_per_cu_;
 };
 }  // namespace amd
 }  // namespace rocr
@@ -60,19 +60,119 @@ namespace AMD {
 
 class BlitSdmaBase : public core::Blit {
  public:
+  // Default and smallest ring size, HSA_SDMA_RING_SIZE grows rings up to kMaxQueueSize.
   static const size_t kQueueSize;
+  static const size_t kMaxQueueSize;
   static const size_t kCopyPacketSize;
   static const size_t kMaxSingleCopySize;
   static const size_t kMaxSingleFillSize;
   virtual bool isSDMA() const override { return true; }
   virtual hsa_status_t Initialize(const core::Agent& agent, bool use_xgmi,
-                                  size_t linear_copy_size_override, int rec_engine) = 0;
+                                  size_t linear_copy_size_override, int rec_engine,
+                                  HSA_QUEUE_PRIORITY priority = HSA_QUEUE_PRIORITY_MAXIMUM) = 0;
   virtual hsa_status_t SubmitCopyRectCommand(const hsa_pitched_ptr_t* dst,
                                              const hsa_dim3_t* dst_offset,
                                              const hsa_pitched_ptr_t* src,
                                              const hsa_dim3_t* src_offset, const hsa_dim3_t* range,
                                              std::vector<core::Signal*>& dep_signals,
                                              core::Signal& out_signal) = 0;
+
+  /// @brief Encodes copy list commands into a packet stream for SubmitCommandStream.
+  ///
+  /// @param stream (output) Encoded packets.
+  /// @param bytes (output) Number of bytes copied or filled by the stream.
+  virtual hsa_status_t BuildCommandStream(const hsa_amd_copy_command_t* commands, uint32_t count,
+                                          std::vector<uint32_t>& stream, uint64_t& bytes) = 0;
+
+  /// @brief Submits a stream from BuildCommandStream with a single completion sequence.
+  virtual hsa_status_t SubmitCommandStream(const std::vector<uint32_t>& stream, uint64_t bytes,
+                                           std::vector<core::Signal*>& dep_signals,
+                                           core::Signal& out_signal) = 0;
+
+  /// @brief Copies a stream from BuildCommandStream into an indirect buffer the engine fetches
+  /// from, so it can be launched without writing the stream into the ring.
+  ///
+  /// @return The indirect buffer, nullptr if the stream can not be captured.
+  virtual void* CaptureCommandStream(const std::vector<uint32_t>& stream) = 0;
+
+  /// @brief Frees an indirect buffer once the engine has executed all submissions using it.
+  virtual void ReleaseCommandStream(void* indirect_buffer) = 0;
+
+  /// @brief Makes every submission send its own completion interrupt.  Blits destroyed while
+  /// signals may still be waited on must not defer interrupts to a later SubmitInterrupt.
+  virtual void DisableInterruptDeferral() = 0;
+
+  /// @brief Launches size_dw DWORDs of a captured stream with a single completion sequence.
+  virtual hsa_status_t SubmitIndirectCommandStream(const void* indirect_buffer, uint32_t size_dw,
+                                                   uint64_t bytes,
+                                                   std::vector<core::Signal*>& dep_signals,
+                                                   core::Signal& out_signal) = 0;
+};
+
+/// @brief SDMA packet stream recorded once by hsa_amd_copy_list_create and placed on its
+/// engine's ring by each hsa_amd_copy_list_submit.
+class CopyList : public core::Checked<0x3B8E61D7A5C2F094> {
+ public:
+  static __forceinline hsa_amd_copy_list_t Convert(CopyList* list) {
+    const hsa_amd_copy_list_t handle = {static_cast<uint64_t>(reinterpret_cast<uintptr_t>(list))};
+    return handle;
+  }
+  static __forceinline CopyList* Convert(hsa_amd_copy_list_t list) {
+    return reinterpret_cast<CopyList*>(static_cast<uintptr_t>(list.handle));
+  }
+
+  CopyList(GpuAgent* agent, BlitSdmaBase* blit)
+      : agent_(agent), blit_(blit), indirect_buffer_(nullptr), size_dw_(0), bytes_(0) {}
+  ~CopyList();
+
+  /// @brief Encodes commands and, when possible, captures them into an indirect buffer so
+  /// each submission only writes the launch and completion packets to the ring.
+  hsa_status_t Record(const hsa_amd_copy_command_t* commands, uint32_t count);
+
+  hsa_status_t Submit(std::vector<core::Signal*>& dep_signals, core::Signal& out_signal);
+
+ private:
+  GpuAgent* agent_;
+  BlitSdmaBase* blit_;
+  // Encoded packets, empty once captured.
+  std::vector<uint32_t> stream_;
+  void* indirect_buffer_;
+  uint32_t size_dw_;
+  uint64_t bytes_;
+  DISALLOW_COPY_AND_ASSIGN(CopyList);
+};
+
+/// @brief SDMA engine bound once by hsa_amd_copy_context_create.  Copies submitted on a
+/// context go straight to the engine's ring, in submission order.  With HSA_SDMA_CONTEXT_RING
+/// the context owns a queue of its own on the engine, so contexts used from different threads
+/// do not contend for a shared ring.
+class CopyContext : public core::Checked<0x7C41D2B98E05A36F> {
+ public:
+  static __forceinline hsa_amd_copy_context_t Convert(CopyContext* context) {
+    const hsa_amd_copy_context_t handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(context))};
+    return handle;
+  }
+  static __forceinline CopyContext* Convert(hsa_amd_copy_context_t context) {
+    return reinterpret_cast<CopyContext*>(static_cast<uintptr_t>(context.handle));
+  }
+
+  CopyContext(GpuAgent* agent, core::Blit* blit, uint32_t engine_offset, bool owns_blit)
+      : agent_(agent), blit_(blit), engine_offset_(engine_offset), owns_blit_(owns_blit) {}
+  ~CopyContext();
+
+  hsa_status_t Submit(void* dst, const void* src, size_t size,
+                      std::vector<core::Signal*>& dep_signals, core::Signal& out_signal);
+
+  uint32_t engine_offset() const { return engine_offset_; }
+
+ private:
+  GpuAgent* agent_;
+  core::Blit* blit_;
+  uint32_t engine_offset_;
+  // blit_ is a private queue, drained and destroyed with the context.
+  bool owns_blit_;
+  DISALLOW_COPY_AND_ASSIGN(CopyContext);
 };
 
 // RingIndexTy: 32/64-bit monotonic ring index, counting in bytes.
@@ -90,9 +190,13 @@ class BlitSdma : public BlitSdmaBase {
   ///
   /// @param agent Pointer to the agent that will execute the PM4 commands.
   ///
+  /// @param priority Priority of the SDMA queue on its engine.
+  ///
   /// @return hsa_status_t
   virtual hsa_status_t Initialize(const core::Agent& agent, bool use_xgmi,
-                                  size_t linear_copy_size_override, int rec_eng) override;
+                                  size_t linear_copy_size_override, int rec_eng,
+                                  HSA_QUEUE_PRIORITY priority =
+                                      HSA_QUEUE_PRIORITY_MAXIMUM) override;
 
   /// @brief Marks the queue object as invalid and uncouples its link with
   /// the underlying compute device's control block. Use of queue object
@@ -129,6 +233,22 @@ class BlitSdma : public BlitSdmaBase {
       std::vector<core::Signal*>& dep_signals,
       core::Signal& out_signal, std::vector<core::Signal*>& gang_signals) override;
 
+  /// @brief Submit a batch of linear copies. Packets for the whole batch are
+  /// reserved, written and committed together with a single completion
+  /// sequence and doorbell. Batches too large for one reservation are split.
+  virtual hsa_status_t SubmitLinearCopyBatchCommand(const hsa_amd_memory_copy_descriptor_t* copies,
+                                                    uint32_t count,
+                                                    std::vector<core::Signal*>& dep_signals,
+                                                    core::Signal& out_signal) override;
+
+  /// @brief Submit a list of strided blocks as one packet stream.  Blocks with
+  /// DWORD multiple pitches are copied with sub-window packets, other rows and
+  /// contiguous runs with linear packets.  Split like linear batches.
+  virtual hsa_status_t SubmitStridedCopyCommand(const hsa_amd_memory_copy_strided_t* blocks,
+                                                uint32_t count,
+                                                std::vector<core::Signal*>& dep_signals,
+                                                core::Signal& out_signal) override;
+
   virtual hsa_status_t SubmitCopyRectCommand(const hsa_pitched_ptr_t* dst,
                                              const hsa_dim3_t* dst_offset,
                                              const hsa_pitched_ptr_t* src,
@@ -144,9 +264,37 @@ class BlitSdma : public BlitSdmaBase {
   virtual hsa_status_t SubmitLinearFillCommand(void* ptr, uint32_t value,
                                                size_t count) override;
 
+  /// @brief Submit a fill of a 1 dword pattern.  Wider patterns are not
+  /// supported by the engine.
+  virtual hsa_status_t SubmitLinearFillCommand(void* ptr, const uint32_t* pattern,
+                                               uint32_t pattern_dwords, size_t size,
+                                               std::vector<core::Signal*>& dep_signals,
+                                               core::Signal& out_signal) override;
+
+  virtual hsa_status_t BuildCommandStream(const hsa_amd_copy_command_t* commands, uint32_t count,
+                                          std::vector<uint32_t>& stream,
+                                          uint64_t& bytes) override;
+
+  virtual hsa_status_t SubmitCommandStream(const std::vector<uint32_t>& stream, uint64_t bytes,
+                                           std::vector<core::Signal*>& dep_signals,
+                                           core::Signal& out_signal) override;
+
+  virtual void* CaptureCommandStream(const std::vector<uint32_t>& stream) override;
+
+  virtual void ReleaseCommandStream(void* indirect_buffer) override;
+
+  virtual hsa_status_t SubmitIndirectCommandStream(const void* indirect_buffer, uint32_t size_dw,
+                                                   uint64_t bytes,
+                                                   std::vector<core::Signal*>& dep_signals,
+                                                   core::Signal& out_signal) override;
+
   virtual hsa_status_t EnableProfiling(bool enable) override;
 
   virtual uint64_t PendingBytes() override;
+
+  virtual void SubmitInterrupt(core::Signal& signal) override;
+
+  virtual void DisableInterruptDeferral() override { defer_interrupts_ = false; }
   virtual void GangLeader(bool gang_leader) override { gang_leader_ = gang_leader; }
   virtual bool GangLeader() const override { return gang_leader_; }
 
@@ -219,9 +367,14 @@ class BlitSdma : public BlitSdmaBase {
 
   void BuildGCRCommand(char* cmd_addr, bool invalidate);
 
+  void BuildIndirectCommand(char* cmd_addr, const void* indirect_buffer, uint32_t size_dw);
+
+  /// @param indirect cmds is an indirect buffer packet, which must end on an 8 DWORD boundary
+  /// of the ring.
   hsa_status_t SubmitCommand(const void* cmds, size_t cmd_size, uint64_t size,
                              const std::vector<core::Signal*>& dep_signals,
-                             core::Signal& out_signal, std::vector<core::Signal*>& gang_signals);
+                             core::Signal& out_signal, std::vector<core::Signal*>& gang_signals,
+                             bool indirect = false);
 
   hsa_status_t SubmitBlockingCommand(const void* cmds, size_t cmd_size, uint64_t size);
 
@@ -231,6 +384,9 @@ class BlitSdma : public BlitSdmaBase {
   /// Base address of the Queue buffer at construction time.
   char* queue_start_addr_;
 
+  /// Size of the ring in bytes, a power of two no smaller than kQueueSize.
+  size_t queue_size_;
+
   // Pending bytes tracking
   // bytes_written_ is indexed with wrapped command queue indices (which are in bytes).
   // The data_ index corresponding to a command queue index is the first uint64_t index which begins
@@ -259,7 +415,10 @@ class BlitSdma : public BlitSdmaBase {
 
   // Internal signals for blocking APIs
   core::unique_signal_ptr signals_[2];
-  KernelMutex lock_;
+
+  // Completion target of all but the last submission of a split batch copy. Never waited on.
+  core::unique_signal_ptr batch_signal_;
+  KernelMutex lock_{"BlitSdma::lock_"};
   bool parity_;
 
   /// Queue resource descriptor for doorbell, read
@@ -288,6 +447,8 @@ class BlitSdma : public BlitSdmaBase {
 
   static const uint32_t gcr_command_size_;
 
+  static const uint32_t indirect_command_size_;
+
   // Max copy size of a single linear copy command packet.
   size_t max_single_linear_copy_size_;
 
@@ -312,6 +473,9 @@ class BlitSdma : public BlitSdmaBase {
   /// True if SDMA blit is ganged
   bool is_ganged_;
 
+  /// True if completion interrupts are skipped while no thread sleeps on the signal.
+  bool defer_interrupts_;
+
   /// Minimum submission size in bytes.
   size_t min_submission_size_;
 };
@@ -46,7 +46,16 @@
 namespace rocr {
 namespace amd {
 namespace coredump {
-hsa_status_t dump_gpu_core();
+struct DumpOptions {
+  /* Threads copying segment data, 0 picks one per online CPU.  */
+  uint32_t threads = 0;
+  /* Stream the dump through zstd, only honored when built with zstd.  */
+  bool compress = false;
+  /* Leave out read-only (code) mappings.  */
+  bool skip_readonly = false;
+};
+
+hsa_status_t dump_gpu_core(const DumpOptions& options = DumpOptions());
 }   //  namespace coredump
 }   //  namespace amd
 }   //  namespace rocr
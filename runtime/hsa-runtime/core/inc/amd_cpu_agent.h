@@ -45,6 +45,7 @@
 #ifndef HSA_RUNTIME_CORE_INC_AMD_CPU_AGENT_H_
 #define HSA_RUNTIME_CORE_INC_AMD_CPU_AGENT_H_
 
+#include <memory>
 #include <vector>
 
 #include "hsakmt/hsakmt.h"
@@ -53,9 +54,12 @@
 #include "core/inc/agent.h"
 #include "core/inc/queue.h"
 #include "core/inc/cache.h"
+#include "core/util/locks.h"
 
 namespace rocr {
 namespace AMD {
+class HostExecutor;
+
 // @brief Class to represent a CPU device.
 class CpuAgent : public core::Agent {
  public:
@@ -113,12 +117,26 @@ class CpuAgent : public core::Agent {
                        size_t size, std::vector<core::Signal*>& dep_signals,
                        core::Signal& out_signal) override;
 
+  // @brief Override from core::Agent.
+  hsa_status_t DmaCopyBatch(const hsa_amd_memory_copy_descriptor_t* copies, uint32_t count,
+                            core::Agent& dst_agent, core::Agent& src_agent,
+                            std::vector<core::Signal*>& dep_signals,
+                            core::Signal& out_signal) override;
+
+  // @brief Override from core::Agent.
+  hsa_status_t DmaCopyStrided(const hsa_amd_memory_copy_strided_t* blocks, uint32_t count,
+                              core::Agent& dst_agent, core::Agent& src_agent,
+                              std::vector<core::Signal*>& dep_signals,
+                              core::Signal& out_signal) override;
+
   // @brief Returns number of data caches.
   __forceinline size_t num_cache() const { return cache_props_.size(); }
 
   // @brief Returns Hive ID
   __forceinline uint64_t HiveId() const override { return  properties_.HiveID; }
 
+  __forceinline const HsaNodeProperties& properties() const { return properties_; }
+
   // @brief Returns data cache property.
   //
   // @param [in] idx Cache level.
@@ -168,6 +186,15 @@ class CpuAgent : public core::Agent {
   // @brief Array of regions owned by this agent.
   std::vector<const core::MemoryRegion*> regions_;
 
+  // @brief Queue limits reported through GetInfo, in packets.
+  static const uint32_t kMaxQueues = 128;
+  static const uint32_t kMinQueueSize = 64;
+  static const uint32_t kMaxQueueSize = 0x40000;
+
+  // @brief Thread pool running this agent's queues, created with the first queue.
+  std::unique_ptr<HostExecutor> executor_;
+  KernelMutex executor_lock_;
+
   DISALLOW_COPY_AND_ASSIGN(CpuAgent);
 };
 
@@ -0,0 +1,207 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+#ifndef HSA_RUNTIME_CORE_INC_AMD_CPU_QUEUE_H_
+#define HSA_RUNTIME_CORE_INC_AMD_CPU_QUEUE_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "core/inc/agent.h"
+#include "core/inc/host_queue.h"
+#include "core/util/locks.h"
+#include "core/util/os.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace AMD {
+
+/// @brief Work stealing thread pool running the packets of a CPU agent's queues.
+///
+/// Each worker owns a task deque, taking its own work newest first and stealing the oldest task
+/// of another worker when it runs dry.  Workers are bound to the cores of the agent so packet
+/// functions run next to the agent's memory.
+class HostExecutor {
+ public:
+  typedef void (*TaskFunc)(void* arg);
+
+  /// @brief Starts threads workers bound to cpus.
+  HostExecutor(const std::vector<uint32_t>& cpus, uint32_t threads);
+
+  /// @brief Stops the workers, tasks still queued are dropped.
+  ~HostExecutor();
+
+  /// @brief Queues func(arg) on the calling worker, or on the next worker round robin when called
+  /// from outside the pool.
+  void Submit(TaskFunc func, void* arg);
+
+ private:
+  struct Task {
+    TaskFunc func;
+    void* arg;
+  };
+
+  struct Worker {
+    HostExecutor* owner;
+    uint32_t index;
+    KernelMutex lock;
+    std::deque<Task> tasks;
+    os::EventHandle wake;
+    std::atomic<bool> idle;
+    os::Thread thread;
+  };
+
+  // Stops and joins the started workers.
+  void Stop();
+
+  static void WorkerRun(void* worker);
+  void WorkerLoop(Worker* worker);
+
+  // Takes the newest task of worker.
+  bool Pop(Worker* worker, Task* task);
+
+  // Takes the oldest task of any other worker.
+  bool Steal(Worker* thief, Task* task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<uint32_t> cpus_;
+  std::atomic<uint32_t> next_;
+  std::atomic<bool> exit_;
+
+  // Worker running on the calling thread, if any.
+  static thread_local Worker* current_;
+
+  DISALLOW_COPY_AND_ASSIGN(HostExecutor);
+};
+
+/// @brief Agent dispatch queue of a CPU agent.
+///
+/// Packets are consumed by a HostExecutor task that is scheduled by the doorbell and runs at most
+/// once at a time.  HSA_AMD_AGENT_DISPATCH_HOST_CALL packets are handed to the pool as separate
+/// tasks so independent packets run in parallel; a packet with the barrier bit waits for those
+/// still running.  Barrier-AND and barrier-OR dependencies are waited on by async signal handlers
+/// rather than by a worker.
+class CpuQueue : public core::HostQueue {
+ public:
+  /// @brief Takes ownership of doorbell, which must start at -1.
+  CpuQueue(core::Agent* agent, HostExecutor* executor, core::Signal* doorbell, uint32_t size,
+           hsa_queue_type32_t type, core::HsaEventCallback callback, void* data);
+
+  /// @brief Waits for running packets to finish.
+  ~CpuQueue();
+
+  hsa_status_t Inactivate() override;
+
+  hsa_status_t GetInfo(hsa_queue_info_attribute_t attribute, void* value) override;
+
+ private:
+  struct Dispatch {
+    CpuQueue* queue;
+    hsa_agent_dispatch_packet_t packet;
+  };
+
+  /// @brief Link from pending async handlers to the queue, cut by Inactivate so handlers firing
+  /// later leave the queue alone.
+  struct HandlerLink {
+    KernelMutex lock;
+    CpuQueue* queue;
+  };
+
+  // Queues a processing pass unless one is queued or running, which then makes another pass.
+  void Schedule();
+
+  static void ProcessRun(void* queue);
+
+  // Consumes packets until the ring is empty or a packet must wait.
+  hsa_status_t ProcessPackets();
+
+  // True if a barrier packet's dependencies are met, else arms a handler rescheduling the queue.
+  bool BarrierReady(const hsa_barrier_and_packet_t& packet, bool and_barrier, uint64_t index);
+
+  // Runs a host call packet.
+  static void DispatchRun(void* dispatch);
+
+  // Decrements a packet's completion signal, if any, with release semantics.
+  static void Complete(hsa_signal_t completion);
+
+  // Async handlers rescheduling the queue when the doorbell rings or a dependency resolves.
+  static bool DoorbellHandler(hsa_signal_value_t value, void* arg);
+  static bool DependencyHandler(hsa_signal_value_t value, void* arg);
+
+  // Registers handler on signal with a reference to link_.
+  bool WakeOn(hsa_signal_t signal, hsa_signal_condition_t cond, hsa_signal_value_t value,
+              hsa_amd_signal_handler handler);
+
+  core::Agent* agent_;
+  HostExecutor* executor_;
+  core::Signal* doorbell_;
+  core::HsaEventCallback errors_callback_;
+  void* errors_data_;
+
+  std::atomic<bool> active_;
+
+  // A processing pass is queued or running, and a pass was requested since the running one began.
+  std::atomic<bool> scheduled_;
+  std::atomic<bool> rescan_;
+
+  // Host call packets not yet complete, and whether a barrier packet waits for them.
+  std::atomic<uint32_t> inflight_;
+  std::atomic<bool> barrier_waiting_;
+
+  // Pool tasks referencing the queue.
+  std::atomic<uint32_t> tasks_;
+
+  // Doorbell handler armed, and the packet whose dependencies have a handler armed.
+  std::atomic<bool> doorbell_armed_;
+  std::atomic<uint64_t> dependency_index_;
+
+  std::shared_ptr<HandlerLink> link_;
+
+  DISALLOW_COPY_AND_ASSIGN(CpuQueue);
+};
+
+}  // namespace AMD
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_AMD_CPU_QUEUE_H_
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+#ifndef HSA_RUNTIME_CORE_INC_AMD_CU_PARTITIONS_H_
+#define HSA_RUNTIME_CORE_INC_AMD_CU_PARTITIONS_H_
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "inc/hsa_ext_amd.h"
+#include "core/inc/checked.h"
+#include "core/inc/queue.h"
+#include "core/util/locks.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace AMD {
+
+class GpuAgent;
+
+/// @brief Split of a GPU's CUs into disjoint partitions, see hsa_amd_cu_partitions_create.
+///
+/// CUs are handed out in slices of one CU per shader array.  KFD distributes consecutive CU mask
+/// bits across shader engines and arrays, so a partition holding a run of whole slices is
+/// balanced across the chip.  Rebalance moves slices between partitions and only rewrites the
+/// masks of queues whose partition changed.
+class CuPartitions : public core::Checked<0x51E8C0A3D94B27F6> {
+ public:
+  static __forceinline hsa_amd_cu_partitions_t Convert(CuPartitions* partitions) {
+    const hsa_amd_cu_partitions_t handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(partitions))};
+    return handle;
+  }
+  static __forceinline CuPartitions* Convert(hsa_amd_cu_partitions_t partitions) {
+    return reinterpret_cast<CuPartitions*>(static_cast<uintptr_t>(partitions.handle));
+  }
+
+  /// @brief Splits the agent's slices evenly over count partitions, count must not exceed
+  /// slice_count().
+  CuPartitions(GpuAgent* agent, uint32_t count);
+
+  /// @brief Returns bound queues to the full device.
+  ~CuPartitions();
+
+  /// @brief Number of slices the agent's CUs form.
+  static uint32_t slice_count(GpuAgent* agent);
+
+  /// @brief Masks queue to a partition, or back to the full device for HSA_AMD_CU_PARTITION_NONE.
+  hsa_status_t Bind(core::Queue* queue, uint32_t index);
+
+  /// @brief Resizes partitions in proportion to the packets outstanding on their queues, keeping
+  /// at least one slice in each.
+  hsa_status_t Rebalance();
+
+ private:
+  // Recomputes each partition's first slice from slices_.
+  void Layout();
+
+  // Sets queue's CU mask to partition index.
+  hsa_status_t Apply(core::Queue* queue, uint32_t index);
+
+  GpuAgent* agent_;
+  uint32_t cu_count_;
+  uint32_t slice_size_;
+
+  // Slice count and first slice of each partition.
+  std::vector<uint32_t> slices_;
+  std::vector<uint32_t> first_;
+
+  // Bound queues and their partition.
+  std::vector<std::pair<core::Queue*, uint32_t>> queues_;
+  KernelMutex lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(CuPartitions);
+};
+
+}  // namespace AMD
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_AMD_CU_PARTITIONS_H_
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+
+#ifndef HSA_RUNTIME_CORE_INC_AMD_DISPATCH_GRAPH_H_
+#define HSA_RUNTIME_CORE_INC_AMD_DISPATCH_GRAPH_H_
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "inc/hsa_ext_amd.h"
+#include "core/inc/checked.h"
+#include "core/inc/interrupt_signal.h"
+#include "core/inc/queue.h"
+#include "core/util/locks.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace AMD {
+
+class GpuAgent;
+
+/// @brief Kernel dispatch and barrier packets recorded once by hsa_amd_dispatch_graph_create and
+/// placed on a queue as one batch by each hsa_amd_dispatch_graph_launch.
+///
+/// When kernel arguments were captured the image ends with a barrier decrementing inflight_,
+/// which counts launches still running so the arguments are only rewritten once the GPU is done
+/// reading them.
+class DispatchGraph : public core::Checked<0x2E7A94C1B05D83F6> {
+ public:
+  static __forceinline hsa_amd_dispatch_graph_t Convert(DispatchGraph* graph) {
+    const hsa_amd_dispatch_graph_t handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(graph))};
+    return handle;
+  }
+  static __forceinline DispatchGraph* Convert(hsa_amd_dispatch_graph_t graph) {
+    return reinterpret_cast<DispatchGraph*>(static_cast<uintptr_t>(graph.handle));
+  }
+
+  explicit DispatchGraph(GpuAgent* agent);
+
+  /// @brief Waits for outstanding launches.
+  ~DispatchGraph();
+
+  /// @brief Copies the packets and the kernel arguments to capture, kernarg_sizes may be null.
+  hsa_status_t Record(const core::AqlPacket* packets, uint32_t count,
+                      const uint32_t* kernarg_sizes);
+
+  hsa_status_t Launch(core::Queue* queue, uint32_t update_count,
+                      const hsa_amd_dispatch_graph_update_t* updates,
+                      hsa_signal_t completion_signal);
+
+  GpuAgent* agent() const { return agent_; }
+
+ private:
+  GpuAgent* agent_;
+
+  // Recorded packets followed by the trailing barrier, if any.
+  std::vector<core::AqlPacket> image_;
+  uint32_t packet_count_;
+
+  // Completion signal the last recorded packet was given.
+  hsa_signal_t last_signal_;
+
+  // Captured kernel arguments and the offset and size of each packet's block, size 0 if none.
+  uint8_t* kernargs_;
+  std::vector<std::pair<size_t, uint32_t>> kernarg_blocks_;
+
+  core::InterruptSignal* inflight_;
+
+  // Serializes launches.
+  KernelMutex lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(DispatchGraph);
+};
+
+}  // namespace AMD
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_AMD_DISPATCH_GRAPH_H_
@@ -151,9 +151,9 @@ class RvdFilter {
 
   /// @brief Build the list of Gpu device UUIDs as enumerated by ROCt
   ///
-  /// @param numNodes Number of ROCm devices present on system, includes
-  /// both Cpu and Gpu's devices
-  void BuildDeviceUuidList(uint32_t numNodes);
+  /// @param nodeProps Topology snapshot of the properties of every ROCm
+  /// node present on system, includes both Cpu and Gpu's devices
+  void BuildDeviceUuidList(const std::vector<HsaNodeProperties>& nodeProps);
 
   /// @brief Build the list of Gpu devices that will be enumerated to user
   ///
@@ -45,6 +45,7 @@
 #ifndef HSA_RUNTIME_CORE_INC_AMD_GPU_AGENT_H_
 #define HSA_RUNTIME_CORE_INC_AMD_GPU_AGENT_H_
 
+#include <atomic>
 #include <vector>
 #include <list>
 #include <map>
@@ -52,6 +53,7 @@
 #include "hsakmt/hsakmt.h"
 
 #include "core/inc/agent.h"
+#include "core/inc/amd_spm_stream.h"
 #include "core/inc/blit.h"
 #include "core/inc/cache.h"
 #include "core/inc/driver.h"
@@ -66,6 +68,10 @@
 namespace rocr {
 namespace AMD {
 class MemoryRegion;
+class AqlQueue;
+class SharedHwQueue;
+class CopyList;
+class CopyContext;
 
 typedef ScratchCache::ScratchInfo ScratchInfo;
 
@@ -151,6 +157,11 @@ class GpuAgentInt : public core::Agent {
    // @brief Invalidate caches on the agent which may hold code object data.
    virtual void InvalidateCodeCaches() = 0;
 
+   // @brief Invalidate the lines of [@p base, @p base + @p size) in the
+   // caches which may hold code object data, leaving the rest of the caches
+   // shared with other work on the agent intact where the hardware allows.
+   virtual void InvalidateCodeCaches(const void* base, size_t size) = 0;
+
    // @brief Sets the coherency type of this agent.
    //
    // @param [in] type New coherency type.
@@ -293,17 +304,57 @@ class GpuAgent : public GpuAgentInt {
                        std::vector<core::Signal*>& dep_signals,
                        core::Signal& out_signal) override;
 
+  // @brief Override from core::Agent.
+  hsa_status_t DmaCopyBatch(const hsa_amd_memory_copy_descriptor_t* copies, uint32_t count,
+                            core::Agent& dst_agent, core::Agent& src_agent,
+                            std::vector<core::Signal*>& dep_signals,
+                            core::Signal& out_signal) override;
+
+  // @brief Override from core::Agent.
+  hsa_status_t DmaCopyStrided(const hsa_amd_memory_copy_strided_t* blocks, uint32_t count,
+                              core::Agent& dst_agent, core::Agent& src_agent,
+                              std::vector<core::Signal*>& dep_signals,
+                              core::Signal& out_signal) override;
+
   // @brief Override from core::Agent.
   hsa_status_t DmaCopyOnEngine(void* dst, core::Agent& dst_agent, const void* src,
                        core::Agent& src_agent, size_t size,
                        std::vector<core::Signal*>& dep_signals,
                        core::Signal& out_signal, int engine_offset,
-                       bool force_copy_on_sdma) override;
+                       bool force_copy_on_sdma, hsa_amd_queue_priority_t priority) override;
+
+  // @brief Override from core::Agent.
+  hsa_status_t DmaCopyGang(void* dst, core::Agent& dst_agent, const void* src,
+                           core::Agent& src_agent, size_t size,
+                           std::vector<core::Signal*>& dep_signals, core::Signal& out_signal,
+                           uint32_t width, hsa_amd_gang_leader_t leader,
+                           int leader_offset) override;
+
+  // @brief Records a copy list for the SDMA engine at engine_offset, numbered as for
+  // DmaCopyOnEngine.
+  hsa_status_t CreateCopyList(int engine_offset, const hsa_amd_copy_command_t* commands,
+                              uint32_t count, CopyList** list);
+
+  // @brief Binds a copy context to one SDMA engine of engine_ids_mask, preferring an idle one.
+  // Bit i of the mask is the engine at offset i + 1, numbered as for DmaCopyOnEngine.
+  hsa_status_t CreateCopyContext(uint32_t engine_ids_mask, CopyContext** context);
+
+  // @brief Spreads a CU mask in KFD's numbering over the COMPUTE_STATIC_THREAD_MGMT_SE values of
+  // one XCC the way KFD fills a queue's MQD.  Returns false if the XCC has more than four SEs.
+  bool MapCUMask(const std::vector<uint32_t>& mask, uint32_t xcc, uint32_t (&se_mask)[4]) const;
+
+  // @brief Fills HSA_AMD_AGENT_INFO_PARTITION_LAYOUT from the agent's properties, its sibling
+  // partition agents and the device's memory partition mode.
+  void GetPartitionLayout(hsa_amd_agent_partition_layout_t* layout) const;
 
   // @brief Override from core::Agent.
   hsa_status_t DmaCopyStatus(core::Agent& dst_agent, core::Agent& src_agent,
                              uint32_t *engine_ids_mask) override;
 
+  // @brief Override from core::Agent.
+  hsa_status_t DmaCopyEngineHints(core::Agent& dst_agent, core::Agent& src_agent,
+                                  hsa_amd_copy_engine_hints_t* hints) override;
+
   // @brief Override from core::Agent.
   hsa_status_t DmaCopyRect(const hsa_pitched_ptr_t* dst, const hsa_dim3_t* dst_offset,
                            const hsa_pitched_ptr_t* src, const hsa_dim3_t* src_offset,
@@ -313,6 +364,11 @@ class GpuAgent : public GpuAgentInt {
   // @brief Override from core::Agent.
   hsa_status_t DmaFill(void* ptr, uint32_t value, size_t count) override;
 
+  // @brief Override from core::Agent.
+  hsa_status_t DmaFillAsync(void* ptr, const uint32_t* pattern, uint32_t pattern_dwords,
+                            size_t size, std::vector<core::Signal*>& dep_signals,
+                            core::Signal& out_signal) override;
+
   // @brief Override from core::Agent.
   hsa_status_t GetInfo(hsa_agent_info_t attribute, void* value) const override;
 
@@ -323,6 +379,32 @@ class GpuAgent : public GpuAgentInt {
                            uint32_t group_segment_size,
                            core::Queue** queue) override;
 
+  // @brief Create a queue with its ring buffer in device memory if @p device_ring is set.
+  // The plain override follows HSA_ALLOCATE_QUEUE_DEV_MEM.  Host memory of the queue comes from
+  // CPU agent @p host_agent, or from the nearest CPU if null.
+  hsa_status_t QueueCreate(size_t size, hsa_queue_type32_t queue_type,
+                           core::HsaEventCallback event_callback, void* data,
+                           uint32_t private_segment_size, uint32_t group_segment_size,
+                           bool device_ring, core::Queue** queue,
+                           const core::Agent* host_agent = nullptr);
+
+  // @brief Returns true if the host can map all of device local memory (large BAR).
+  bool HostAccessibleLocalMemory() const { return host_accessible_local_; }
+
+  // @brief Count allocations of device local memory the CPU was granted write access to.
+  void HostWritableLocalMemory(int delta) { host_writable_local_ += delta; }
+
+  // @brief The CPU of this or another process may write device local memory for the rest of the
+  // process lifetime, e.g. through an exported or imported allocation.
+  void PinHdpFlush() { hdp_flush_pinned_ = true; }
+
+  // @brief Returns true if CPU writes to device local memory may be held in the HDP, so SDMA
+  // reads of local memory must flush it first.
+  bool HdpFlushRequired() const {
+    return hdp_flush_pinned_.load(std::memory_order_relaxed) ||
+        host_writable_local_.load(std::memory_order_relaxed) != 0;
+  }
+
   // @brief Decrement GWS ref count.
   void GWSRelease();
 
@@ -345,6 +427,9 @@ class GpuAgent : public GpuAgentInt {
   // @brief Override from AMD::GpuAgentInt.
   void InvalidateCodeCaches() override;
 
+  // @brief Override from AMD::GpuAgentInt.
+  void InvalidateCodeCaches(const void* base, size_t size) override;
+
   // @brief Override from AMD::GpuAgentInt.
   bool current_coherency_type(hsa_amd_coherency_type_t type) override;
 
@@ -408,6 +493,7 @@ class GpuAgent : public GpuAgentInt {
   // @brief Order the device is surfaced in hsa_iterate_agents counting only
   // GPU devices.
   __forceinline uint32_t enumeration_index() const { return enum_index_; }
+  void enumeration_index(uint32_t index) { enum_index_ = index; }
 
   // @brief returns true if agent uses MES scheduler
   __forceinline const bool isMES() const { return (isa_->GetMajorVersion() >= 11) ? true : false; };
@@ -419,9 +505,16 @@ class GpuAgent : public GpuAgentInt {
     // If we did not update t1 since agent initialization, force a SyncClock. Otherwise computing
     // the SystemClockCounter to GPUClockCounter ratio in TranslateTime(tick) results to a division
     // by 0.
+    ScopedAcquire<KernelMutex> lock(&t1_lock_);
     if (t0_.GPUClockCounter == t1_.GPUClockCounter) SyncClocks();
   }
 
+  // @brief Clock conversion parameters, see hsa_amd_profiling_get_clock_params.
+  const hsa_amd_clock_params_t* clock_params() const { return &clock_params_; }
+
+  // @brief Current agent tick, estimated from the system clock while clock_params_ cover it.
+  uint64_t ReadClock();
+
   // @brief Override from AMD::GpuAgentInt.
   __forceinline bool is_xgmi_cpu_gpu() const { return xgmi_cpu_gpu_; }
 
@@ -433,6 +526,29 @@ class GpuAgent : public GpuAgentInt {
   // @brief If agent supports it, release scratch memory for all AQL queues on this agent.
   void AsyncReclaimScratchQueues();
 
+  // @brief Forget an AQL queue that is being destroyed.
+  void RemoveAqlQueue(core::Queue* queue);
+
+  // @brief Keep a destroyed queue for reuse by QueueCreate.
+  // @retval false The pool is disabled or full, or the queue can not be reused.
+  bool PoolQueue(AqlQueue* queue);
+
+  // @brief Destroys the queues kept for reuse.
+  void TrimQueuePool();
+
+  // @brief Binds a virtual queue to the least loaded shared hardware queue of @p priority.
+  // A new hardware queue is created while fewer than HSA_VIRTUAL_QUEUE_LIMIT exist, or if none
+  // has the priority yet.  Shared queues live until the agent is destroyed.
+  hsa_status_t AcquireSharedQueue(uint32_t size, HSA_QUEUE_PRIORITY priority, bool device_ring,
+                                  SharedHwQueue** queue);
+
+  // @brief Drops a binding made by AcquireSharedQueue.
+  void ReleaseSharedQueue(SharedHwQueue* queue);
+
+  // @brief Wakes the priority updater, starting it if needed, to apply priorities recorded by
+  // AqlQueue::SetPriority.  Returns false if the updater could not be started.
+  bool RequestPriorityUpdate();
+
   // @brief Returns true if scratch reclaim is enabled
   __forceinline bool AsyncScratchReclaimEnabled() const override {
     // TODO: Need to update min CP FW ucode version once it is released
@@ -444,12 +560,23 @@ class GpuAgent : public GpuAgentInt {
 
   hsa_status_t SetAsyncScratchThresholds(size_t use_once_limit) override;
 
+  // @brief Starts the runtime managed SPM stream, see hsa_amd_spm_stream_start.
+  hsa_status_t SpmStreamStart(size_t buffer_size, uint32_t buffer_count,
+                              hsa_amd_spm_stream_callback_t callback, void* user_data,
+                              const char* file);
+
+  // @brief Stops the SPM stream after delivering its remaining data.
+  hsa_status_t SpmStreamStop();
+
   __forceinline size_t ScratchSingleLimitAsyncThreshold() const {
     return scratch_limit_async_threshold_;
   }
 
   void Trim() override;
 
+  // @brief Bytes and number of scratch allocations mapped for queues, in use or cached.
+  void ScratchUsage(uint64_t* bytes, uint64_t* count);
+
   const std::function<void*(size_t size, size_t align, core::MemoryRegion::AllocateFlags flags)>&
   system_allocator() const {
     return system_allocator_;
@@ -457,6 +584,11 @@ class GpuAgent : public GpuAgentInt {
 
   const std::function<void(void*)>& system_deallocator() const { return system_deallocator_; }
 
+  // @brief Returns an allocator for the kernarg pool of CPU agent @p cpu, or system_allocator()
+  // if @p cpu is null.  Memory is released with system_deallocator().
+  std::function<void*(size_t size, size_t align, core::MemoryRegion::AllocateFlags flags)>
+  SystemAllocatorFor(const core::Agent* cpu) const;
+
   const std::function<void*(size_t size, core::MemoryRegion::AllocateFlags flags)>&
   finegrain_allocator() const {
     return finegrain_allocator_;
@@ -479,10 +611,18 @@ class GpuAgent : public GpuAgentInt {
   core::Queue* CreateInterceptibleQueue(void (*callback)(hsa_status_t status, hsa_queue_t* source, void* data),
                                         void* data, const uint32_t size);
 
+  // @brief Create a hardware AQL queue, or recycle a pooled one.  Arguments are those of
+  // QueueCreate, already validated.
+  hsa_status_t CreateAqlQueue(size_t size, hsa_queue_type32_t queue_type,
+                              core::HsaEventCallback event_callback, void* data,
+                              uint32_t private_segment_size, bool device_ring,
+                              core::Queue** queue, const core::Agent* host_agent = nullptr);
+
   // @brief Create SDMA blit object.
   //
   // @retval NULL if SDMA blit creation and initialization failed.
-  core::Blit* CreateBlitSdma(bool use_xgmi, int rec_eng);
+  core::Blit* CreateBlitSdma(bool use_xgmi, int rec_eng,
+                             HSA_QUEUE_PRIORITY priority = HSA_QUEUE_PRIORITY_MAXIMUM);
 
   // @brief Create Kernel blit object using provided compute queue.
   //
@@ -502,7 +642,7 @@ class GpuAgent : public GpuAgentInt {
       hsa_status_t (*callback)(hsa_region_t region, void* data),
       void* data) const;
 
-  // @brief Update ::t1_ tick count.
+  // @brief Update ::t1_ tick count and ::clock_params_.  Called with ::t1_lock_ held.
   void SyncClocks();
 
   // @brief Binds the second-level trap handler to this node.
@@ -521,7 +661,18 @@ class GpuAgent : public GpuAgentInt {
   hsa_status_t PcSamplingStart(pcs::PcsRuntime::PcSamplingSession& session) override;
   hsa_status_t PcSamplingStop(pcs::PcsRuntime::PcSamplingSession& session) override;
   hsa_status_t PcSamplingFlush(pcs::PcsRuntime::PcSamplingSession& session) override;
-  hsa_status_t PcSamplingFlushHostTrapDeviceBuffers(pcs::PcsRuntime::PcSamplingSession& session);
+  hsa_status_t PcSamplingFlushHostTrapDeviceBuffers();
+
+  // @brief Removes @p session from the hosttrap sessions of this agent, releasing the hosttrap
+  // buffers with the last one.
+  void PcSamplingDetach(pcs::PcsRuntime::PcSamplingSession& session);
+
+  // @brief Hands @p session its unread host buffer data in chunks of its buffer size. With
+  // @p drain the last partial chunk is handed over as well.
+  void PcSamplingDeliverHostTrapData(pcs::PcsRuntime::PcSamplingSession& session, bool drain);
+
+  // @brief Wakes up and joins the hosttrap thread.
+  void PcSamplingStopHostTrapThread();
 
   static void PcSamplingThreadRun(void* agent);
   void PcSamplingThread();
@@ -556,6 +707,27 @@ class GpuAgent : public GpuAgentInt {
   // Blit objects managed by an instance of GpuAgent
   std::vector<lazy_ptr<core::Blit>> blits_;
 
+  // @brief Load estimate of one blits_ engine for GetBalancedBlit.
+  struct EngineLoad {
+    uint64_t pending_bytes;  // Pending bytes at the last sample, plus bytes routed since.
+    uint64_t timestamp;      // ReadAccurateClock at the last sample, 0 if never sampled.
+    double bytes_per_tick;   // Moving average of drained bytes per clock tick, 0 if unknown.
+  };
+  std::vector<EngineLoad> engine_load_;
+
+  // Protects engine_load_
+  KernelMutex engine_load_lock_;
+
+  // @brief Priority classes for DmaCopyOnEngine besides the default blits_.
+  enum BlitPriorityEnum { BlitPriorityLow, BlitPriorityHigh, BlitPriorityCount };
+
+  // Per direction blits of each priority class, on rings separate from blits_ so latency critical
+  // copies do not queue behind bulk traffic.
+  lazy_ptr<core::Blit> priority_blits_[BlitPriorityCount][DefaultBlitCount];
+
+  // Compute queues backing blit kernels of each priority class.
+  lazy_ptr<core::Queue> priority_queues_[BlitPriorityCount];
+
   // List of agents connected via xGMI
   std::vector<const core::Agent*> xgmi_peer_list_;
 
@@ -576,13 +748,13 @@ class GpuAgent : public GpuAgentInt {
   KernelMutex coherency_lock_;
 
   // @brief Mutex to protect access to scratch pool.
-  KernelMutex scratch_lock_;
+  mutable KernelMutex scratch_lock_{"GpuAgent::scratch_lock_"};
 
   // @brief Mutex to protect access to ::t1_.
   KernelMutex t1_lock_;
 
   // @brief Mutex to protect access to blit objects.
-  KernelMutex blit_lock_;
+  KernelMutex blit_lock_{"GpuAgent::blit_lock_"};
 
   // @brief Mutex to protect sdma gang submissions.
   KernelMutex sdma_gang_lock_;
@@ -594,9 +766,15 @@ class GpuAgent : public GpuAgentInt {
 
   double historical_clock_ratio_;
 
+  // @brief TranslateTime parameters for t1_, published under a sequence count by SyncClocks.
+  hsa_amd_clock_params_t clock_params_;
+
   // @brief s_memrealtime nominal clock frequency
   uint64_t wallclock_frequency_;
 
+  // @brief Active CUs of each shader array of the first XCC, as reported by libdrm.
+  uint32_t cu_bitmap_[4][4];
+
   // @brief Array of GPU cache property.
   std::vector<HsaCacheProperties> cache_props_;
 
@@ -650,6 +828,10 @@ class GpuAgent : public GpuAgentInt {
   // @brief Setup GWS accessing queue.
   void InitGWS();
 
+  // @brief With HSA_COOP_CU_COUNT, masks the GWS queue to the CUs reported as the cooperative
+  // compute unit count so a grid sized from that count stays resident.
+  void LimitCooperativeCUs(AqlQueue* queue);
+
   // @brief Set-up memory allocators
   void InitAllocators();
 
@@ -671,6 +853,35 @@ class GpuAgent : public GpuAgentInt {
   // caller must hold scratch_lock_.
   void ReleaseScratch(void* base, size_t size, bool large);
 
+  // @brief Start the scratch monitor if HSA_SCRATCH_ELASTIC, HSA_SCRATCH_SHARED,
+  // HSA_QUEUE_TELEMETRY or HSA_QUEUE_GROW_HITS is set.
+  // caller must hold aql_queues_lock_.
+  void StartScratchMonitor();
+
+  // @brief Stop and join the scratch monitor.
+  void StopScratchMonitor();
+
+  // @brief Scratch monitor thread entry.
+  static void ScratchMonitorRun(void* agent);
+
+  // @brief Periodically ages queue scratch demand, shrinks idle queues, returns shared arena
+  // leases and warms the scratch cache with the main scratch sizes queues are predicted to
+  // request next.  Also samples queue telemetry.
+  void ScratchMonitor();
+
+  // @brief Stop and join the priority updater.
+  void StopPriorityUpdater();
+
+  // @brief Priority updater thread entry.
+  static void PriorityUpdaterRun(void* agent);
+
+  // @brief Applies pending queue priorities in batches at most once per
+  // HSA_QUEUE_PRIORITY_INTERVAL milliseconds.
+  void PriorityUpdater();
+
+  // @brief Map free scratch cache nodes of the given sizes ahead of demand.
+  void WarmScratchCache(std::vector<size_t>& sizes);
+
   // Bind index of peer device that is connected via xGMI links
   lazy_ptr<core::Blit>& GetXgmiBlit(const core::Agent& peer_agent);
 
@@ -685,6 +896,11 @@ class GpuAgent : public GpuAgentInt {
   // Bind the Blit object that will drive the copy operation by engine ID
   lazy_ptr<core::Blit>& GetBlitObject(uint32_t engine_id);
 
+  // Bind the SDMA engine with the earliest expected completion of a copy of size bytes.
+  // Returns nullptr if no SDMA engine can serve the copy.
+  lazy_ptr<core::Blit>* GetBalancedBlit(const core::Agent& dst_agent,
+                                        const core::Agent& src_agent, size_t size);
+
   // @brief initialize libdrm handle
   void InitLibDrm();
 
@@ -706,6 +922,36 @@ class GpuAgent : public GpuAgentInt {
   // @brief list of AQL queues owned by this agent. Indexed by queue pointer
   std::vector<core::Queue*> aql_queues_;
 
+  // @brief Protects aql_queues_.
+  KernelMutex aql_queues_lock_;
+
+  // @brief Destroyed queues kept for reuse, see PoolQueue.
+  std::vector<AqlQueue*> queue_pool_;
+  KernelMutex queue_pool_lock_;
+
+  // @brief Deepest ring occupancy seen by the scratch monitor, see
+  // HSA_AMD_AGENT_INFO_QUEUE_RECOMMENDED_SIZE.
+  std::atomic<uint64_t> queue_peak_depth_;
+
+  // @brief Hardware queues backing virtual queues, see AcquireSharedQueue.
+  std::vector<SharedHwQueue*> shared_queues_;
+  KernelMutex shared_queues_lock_;
+
+  // @brief Runtime managed SPM capture, if started.
+  std::unique_ptr<SpmStream> spm_stream_;
+  KernelMutex spm_stream_lock_;
+
+  // @brief Scratch monitor thread and its wakeup event.
+  os::Thread scratch_monitor_thread_;
+  os::EventHandle scratch_monitor_event_;
+  std::atomic<bool> scratch_monitor_exit_;
+
+  // @brief Priority updater thread, its wakeup event and the lock serializing its start.
+  os::Thread priority_update_thread_;
+  os::EventHandle priority_update_event_;
+  std::atomic<bool> priority_update_exit_;
+  KernelMutex priority_update_lock_;
+
   // Sets and Tracks pending SDMA status check or request counts
   void SetCopyRequestRefCount(bool set);
   void SetCopyStatusCheckRefCount(bool set);
@@ -754,13 +1000,14 @@ class GpuAgent : public GpuAgentInt {
     /* Hosttrap data - stored on device so that trap_handler code can access efficiently */
     pcs_hosttrap_sampling_data_t* device_data;
 
-    /* Hosttrap host buffer - stored on host */
+    /* Hosttrap host buffer - stored on host, a ring shared by all hosttrap sessions. Each
+     * session reads it at its own index, data is only overwritten once every session has
+     * read it or had it counted as lost.
+     */
     uint8_t* host_buffer;
     size_t host_buffer_size;
-    uint8_t* host_buffer_wrap_pos;
-    uint8_t* host_write_ptr;
-    uint8_t* host_read_ptr;
-    size_t lost_sample_count;
+    size_t sample_size;
+    uint64_t host_write_index;  // Bytes written to the ring so far
     std::mutex host_buffer_mutex;
 
     uint32_t which_buffer;
@@ -772,7 +1019,8 @@ class GpuAgent : public GpuAgentInt {
     hsa_signal_t exec_pm4_signal;
 
     os::Thread thread;
-    pcs::PcsRuntime::PcSamplingSession* session;
+    std::atomic<uint32_t> active_sessions;
+    std::vector<pcs::PcsRuntime::PcSamplingSession*> sessions;
   } pcs_hosttrap_t;
 
   pcs_hosttrap_t pcs_hosttrap_data_;
@@ -786,6 +1034,33 @@ class GpuAgent : public GpuAgentInt {
   // Check if SDMA engine by ID is free
   bool DmaEngineIsFree(uint32_t engine_id);
 
+  // Collect the blit indices of the SDMA engines that may serve a copy in this direction.
+  void GetCopyEngines(const core::Agent& dst_agent, const core::Agent& src_agent,
+                      std::vector<uint32_t>& engines);
+
+  // Recommended SDMA engine IDs for copies to peer, 0 if there are none.
+  uint32_t GetRecommendedEngines(const core::Agent& peer) const;
+
+  // Collect the blit indices of the engines in a recommended SDMA engine ID mask.
+  void GetRecommendedEngines(uint32_t rec_sdma_eng_id_mask, std::vector<uint32_t>& engines);
+
+  // Gang width of copies to dst_agent from the bandwidth factor of the link.
+  unsigned int GetGangFactor(const core::Agent& dst_agent, bool& has_aux_gang) const;
+
+  // Pair each SDMA engine of engines with its queued bytes, least busy first.
+  void GetEngineLoad(const std::vector<uint32_t>& engines,
+                     std::vector<std::pair<uint64_t, uint32_t>>& load);
+
+  // Splits a copy evenly over gang_blits, the first one leading.  Requires sdma_gang_lock_.
+  hsa_status_t SubmitGangCopy(void* dst, const void* src, size_t size,
+                              std::vector<core::Signal*>& dep_signals, core::Signal& out_signal,
+                              const std::vector<lazy_ptr<core::Blit>*>& gang_blits);
+
+  // Collect the SDMA engines a striped copy may use, leader engine first.
+  // Leaves stripe_blits empty if the copy would not run on SDMA.
+  void GetStripeBlits(const core::Agent& dst_agent, const core::Agent& src_agent,
+                      size_t size, std::vector<lazy_ptr<core::Blit>*>& stripe_blits);
+
   std::map<uint64_t,unsigned int> gang_peers_info_;
 
   std::map<uint64_t, uint32_t> rec_sdma_eng_id_peers_info_;
@@ -794,6 +1069,15 @@ class GpuAgent : public GpuAgentInt {
 
   // @bried XGMI CPU<->GPU
   bool xgmi_cpu_gpu_;
+
+  // @brief All of local memory is CPU visible.
+  bool host_accessible_local_;
+
+  // @brief Allocations of local memory the CPU may write, see HostWritableLocalMemory.
+  std::atomic<int64_t> host_writable_local_;
+
+  // @brief Set once local memory may be written by a CPU outside host_writable_local_.
+  std::atomic<bool> hdp_flush_pinned_;
 };
 
 }  // namespace amd
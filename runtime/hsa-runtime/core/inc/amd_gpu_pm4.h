@@ -56,6 +56,7 @@
 #define PM4_HDR_IT_OPCODE_WAIT_REG_MEM                    0x3C
 #define PM4_HDR_IT_OPCODE_COPY_DATA                       0x40
 #define PM4_HDR_IT_OPCODE_DMA_DATA                        0x50
+#define PM4_HDR_IT_OPCODE_SET_SH_REG                      0x76
 
 #define PM4_HDR_SHADER_TYPE(x)                            (((x) & 0x1) << 1)
 #define PM4_HDR_IT_OPCODE(x)                              (((x) & 0xFF) << 8)
@@ -81,12 +82,19 @@
 #  define PM4_ACQUIRE_MEM_COHER_CNTL_SH_ICACHE_ACTION_ENA  (1 << 29)
 #define PM4_ACQUIRE_MEM_DW2_COHER_SIZE(x)                  (((x) & 0xFFFFFFFF) << 0)
 #define PM4_ACQUIRE_MEM_DW3_COHER_SIZE_HI(x)               (((x) & 0xFF) << 0)
+#define PM4_ACQUIRE_MEM_DW4_COHER_BASE_LO(x)               (((x) & 0xFFFFFFFF) << 0)
+#define PM4_ACQUIRE_MEM_DW5_COHER_BASE_HI(x)               (((x) & 0xFFFFFF) << 0)
 #define PM4_ACQUIRE_MEM_DW7_GCR_CNTL(x)                    (((x) & 0x7FFFF) << 0)
 #  define PM4_ACQUIRE_MEM_GCR_CNTL_GLI_INV(x)              (((x) & 0x3) << 0)
+#  define PM4_ACQUIRE_MEM_GCR_CNTL_GL1_RANGE(x)            (((x) & 0x3) << 2)
 #  define PM4_ACQUIRE_MEM_GCR_CNTL_GLK_INV                 (1 << 7)
 #  define PM4_ACQUIRE_MEM_GCR_CNTL_GLV_INV                 (1 << 8)
 #  define PM4_ACQUIRE_MEM_GCR_CNTL_GL1_INV                 (1 << 9)
 #  define PM4_ACQUIRE_MEM_GCR_CNTL_GL2_INV                 (1 << 14)
+#  define PM4_ACQUIRE_MEM_GCR_CNTL_GL2_RANGE(x)            (((x) & 0x3) << 11)
+#    define PM4_ACQUIRE_MEM_GCR_ALL                        0
+#    define PM4_ACQUIRE_MEM_GCR_GLI_ALL                    1
+#    define PM4_ACQUIRE_MEM_GCR_RANGE                      2
 
 #define PM4_RELEASE_MEM_DW1_EVENT_INDEX(x)                 (((x) & 0xF) << 8)
 #  define PM4_RELEASE_MEM_EVENT_INDEX_AQL                  0x7
@@ -140,6 +148,10 @@
 #define PM4_WRITE_DATA_DW3_DST_MEM_ADDR_HI(x)          (((x) & 0xFFFFFFFF) << 0)
 #define PM4_WRITE_DATA_DW4_DATA(x)                     (((x) & 0xFFFFFFFF) << 0)
 
+#define PM4_SET_SH_REG_DW1_REG_OFFSET(x)               (((x) & 0xFFFF) << 0)
+#  define PM4_SH_REG_COMPUTE_STATIC_THREAD_MGMT_SE0    0x216
+#  define PM4_SH_REG_COMPUTE_STATIC_THREAD_MGMT_SE2    0x219
+
 // clang-format on
 
 #endif  // header guard
@@ -51,6 +51,7 @@
 #include <memory>
 #include <sstream>
 #include <cassert>
+#include <string_view>
 #include <unordered_map>
 
 namespace rocr {
@@ -174,6 +175,30 @@ namespace code {
       hsa_status_t GetInfo(hsa_code_symbol_info_t attribute, void *value) override;
     };
 
+    /// @brief Read-only view of the NT_AMDGPU_METADATA msgpack note of a v3 or later code
+    /// object.  Nothing is copied or decoded up front: the first lookup indexes the kernels by
+    /// their .symbol name, and each lookup then decodes a single field of a single kernel.
+    class KernelMetadata {
+    public:
+      KernelMetadata(const void* data = nullptr, size_t size = 0)
+        : data_(static_cast<const uint8_t*>(data)), size_(size), indexed_(false) {}
+
+      /// @brief Reads unsigned integer @p field, such as ".kernarg_segment_align", of the
+      /// kernel whose descriptor symbol is @p kernel.
+      bool GetUInt(std::string_view kernel, std::string_view field, uint64_t* value);
+      /// @brief Reads string @p field, such as ".name".  @p value points into the note.
+      bool GetString(std::string_view kernel, std::string_view field, std::string_view* value);
+
+    private:
+      bool FindField(std::string_view kernel, std::string_view field, size_t* pos);
+      void BuildIndex();
+
+      const uint8_t* data_;
+      size_t size_;
+      bool indexed_;
+      std::unordered_map<std::string_view, size_t> kernels_;  // .symbol to kernel map offset.
+    };
+
     class AmdHsaCode {
     private:
       std::ostringstream out;
@@ -192,6 +217,7 @@ namespace code {
       amd::elf::Section* debugInfo;
       amd::elf::Section* debugLine;
       amd::elf::Section* debugAbbrev;
+      std::unique_ptr<KernelMetadata> kernelMetadata;
 
       bool PullElf();
       bool PullElfV1();
@@ -272,6 +298,8 @@ namespace code {
 
       bool GetIsa(std::string& isaName, unsigned *genericVersion = nullptr);
       bool GetCodeObjectVersion(uint32_t* major, uint32_t* minor);
+      /// @brief Metadata view over this code object's note, empty if there is none.
+      KernelMetadata& GetKernelMetadata();
       hsa_status_t GetInfo(hsa_code_object_info_t attribute, void *value);
       hsa_status_t GetSymbol(const char *module_name, const char *symbol_name, hsa_code_symbol_t *sym);
       hsa_status_t IterateSymbols(hsa_code_object_t code_object,
@@ -360,6 +388,36 @@ namespace code {
       Section* AddHsaHlDebug(const std::string& name, const void* data, size_t size);
     };
 
+    /// @brief Target of a code object as encoded in its ELF header.  Features are -1 when the
+    /// code object runs with the feature in any state, 0 when off and 1 when on.
+    struct CodeObjectTarget {
+      unsigned mach;
+      int xnack;
+      int sramecc;
+      unsigned genericVersion;
+    };
+
+    /// @brief Code object of an offload bundle.  offset and size locate the ELF in the bundle.
+    struct BundledCodeObject {
+      uint64_t offset;
+      uint64_t size;
+      CodeObjectTarget target;
+    };
+
+    /// @brief Reads the target of a v3 or later AMDHSA code object from its ELF header alone.
+    /// Returns false for anything else, including v2 code objects whose target is in a note.
+    bool GetCodeObjectTarget(const void* image, size_t size, CodeObjectTarget* target);
+
+    /// @brief Lists the AMDHSA code objects of a clang offload bundle from the bundle header and
+    /// the ELF header of each entry.  Entries for other targets are skipped.  Returns false if
+    /// bundle is not an uncompressed offload bundle or an entry lies outside it.
+    bool IndexOffloadBundle(const void* bundle, size_t size,
+                            std::vector<BundledCodeObject>& code_objects);
+
+    /// @returns EF_AMDGPU_MACH value for a processor or generic target name without features,
+    /// such as "gfx90a" or "gfx9-4-generic", 0 if unknown.
+    unsigned GetMachForProcessor(const std::string& processor);
+
     class AmdHsaCodeManager {
     private:
       typedef std::unordered_map<uint64_t, AmdHsaCode*> CodeMap;
@@ -177,6 +177,39 @@ public:
 
   virtual bool SegmentFreeze(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) = 0;
 
+  /// @brief Writes the data copied into @p seg so far to @p agent. Copy
+  /// sources need only stay valid until this returns, and contexts that stage
+  /// copies on the host may do nothing here.
+  virtual bool SegmentUpload(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) {
+    return true;
+  }
+
+  /// @brief Allows [@p offset, @p offset + @p size) of @p seg to stay off the
+  /// agent until SegmentMakeResident asks for it. Returns false if the context
+  /// loads whole segments, in which case nothing needs to be made resident.
+  virtual bool SegmentDefer(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg,
+                            size_t offset, size_t size) {
+    return false;
+  }
+
+  /// @brief Makes a range passed to SegmentDefer present on the agent. Before
+  /// @p seg is frozen this only cancels the deferral.
+  virtual bool SegmentMakeResident(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg,
+                                   size_t offset, size_t size) {
+    return true;
+  }
+
+  /// @brief Starts freezing @p seg without waiting for the copy to the agent
+  /// to finish, so that the copies of many segments can overlap. Must be
+  /// followed by SegmentFreezeFinish.
+  virtual bool SegmentFreezeStart(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) {
+    return SegmentFreeze(segment, agent, seg, size);
+  }
+
+  virtual bool SegmentFreezeFinish(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) {
+    return true;
+  }
+
   virtual bool ImageExtensionSupported() = 0;
 
   virtual hsa_status_t ImageCreate(
@@ -360,8 +393,34 @@ public:
     const std::string &uri,
     hsa_loaded_code_object_t *loaded_code_object = nullptr) = 0;
 
+  /// @brief Loads @p code_object once for each of the @p num_agents agents in
+  /// @p agents, parsing it only once. @p loaded_code_objects, if not null,
+  /// receives one handle per agent.
+  virtual hsa_status_t LoadCodeObject(
+    const hsa_agent_t *agents,
+    size_t num_agents,
+    hsa_code_object_t code_object,
+    const char *options,
+    const std::string &uri,
+    hsa_loaded_code_object_t *loaded_code_objects = nullptr) = 0;
+
   virtual hsa_status_t Freeze(const char *options) = 0;
 
+  /// @brief Describes the kernels of the frozen executable, of all agents or
+  /// of @p agent only. Follows the counting protocol of
+  /// hsa_ven_amd_loader_executable_get_kernels.
+  virtual hsa_status_t GetKernels(const hsa_agent_t *agent, uint32_t *num_kernels,
+                                  hsa_ven_amd_loader_kernel_info_t *kernels) = 0;
+
+  /// @brief First half of Freeze. Starts the uploads of all segments and
+  /// moves the executable to the frozen state. Code of the executable may not
+  /// run until FreezeFinish has returned.
+  virtual hsa_status_t FreezeStart(const char *options) = 0;
+
+  /// @brief Second half of Freeze. Waits for the uploads started by
+  /// FreezeStart and invalidates the agents' code caches.
+  virtual hsa_status_t FreezeFinish() = 0;
+
   virtual hsa_status_t Validate(uint32_t *result) = 0;
 
   /// @note needed for hsa v1.0.
@@ -465,9 +524,18 @@ public:
   /// @brief Freezes @p executable
   virtual hsa_status_t FreezeExecutable(Executable *executable, const char *options) = 0;
 
+  /// @brief Freezes @p executable in two steps, the code of the executable
+  /// may not run before FreezeExecutableFinish has returned.
+  virtual hsa_status_t FreezeExecutableStart(Executable *executable, const char *options) = 0;
+  virtual hsa_status_t FreezeExecutableFinish(Executable *executable) = 0;
+
   /// @brief Destroys @p executable
   virtual void DestroyExecutable(Executable *executable) = 0;
 
+  /// @brief Destroys the @p count executables in @p executables, notifying
+  /// the debugger of all of their code objects at once.
+  virtual void DestroyExecutables(Executable *const *executables, size_t count) = 0;
+
   /// @brief Invokes @p callback for each created executable
   virtual hsa_status_t IterateExecutables(
     hsa_status_t (*callback)(
@@ -489,6 +557,12 @@ public:
   /// invalid address, returns null pointer.
   virtual uint64_t FindHostAddress(uint64_t device_address) = 0;
 
+  /// @brief Finds the handle of the loaded code object of a frozen
+  /// executable to which @p device_address belongs, and stores its load delta
+  /// in @p load_delta. Returns NULL handle if device address is invalid.
+  virtual hsa_loaded_code_object_t FindLoadedCodeObject(
+    uint64_t device_address, int64_t *load_delta) = 0;
+
   /// @brief Print loader help.
   virtual void PrintHelp(std::ostream& out) = 0;
 
@@ -81,9 +81,10 @@ public:
   hsa_status_t DestroyQueue(core::Queue &queue) const override;
 
 private:
-  /// @brief Allocate agent accessible memory (system / local memory).
+  /// @brief Allocate agent accessible memory (system / local memory).  A non-zero
+  /// @p alignment aligns the virtual address.
   static void *AllocateKfdMemory(const HsaMemFlags &flags, uint32_t node_id,
-                                 size_t size);
+                                 size_t size, size_t alignment = 0);
 
   /// @brief Free agent accessible memory (system / local memory).
   static bool FreeKfdMemory(void *mem, size_t size);
@@ -70,6 +70,18 @@ class LoaderContext final : public rocr::amd::hsa::loader::Context {
 
   bool SegmentFreeze(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) override;
 
+  bool SegmentUpload(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) override;
+
+  bool SegmentDefer(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t offset,
+                    size_t size) override;
+
+  bool SegmentMakeResident(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg,
+                           size_t offset, size_t size) override;
+
+  bool SegmentFreezeStart(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) override;
+
+  bool SegmentFreezeFinish(amdgpu_hsa_elf_segment_t segment, hsa_agent_t agent, void* seg, size_t size) override;
+
   bool ImageExtensionSupported() override;
 
   hsa_status_t ImageCreate(hsa_agent_t agent, hsa_access_permission_t image_permission,
@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// AMD specific HSA backend.
+
+#ifndef HSA_RUNTIME_CORE_INC_AMD_LOCK_CACHE_H_
+#define HSA_RUNTIME_CORE_INC_AMD_LOCK_CACHE_H_
+
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "core/util/locks.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace AMD {
+
+/// @brief LRU cache of the host memory registrations made by MemoryRegion::Lock.
+///
+/// Unlocked ranges stay registered and mapped to their GPU nodes so that a later lock of the same
+/// or a contained page range reuses the registration instead of going back to the driver.  Up to
+/// the given capacity of unreferenced registrations is retained, least recently used are released
+/// first.  Ranges must be invalidated before their pages are returned to the OS.
+class LockCache {
+ public:
+  LockCache() = default;
+  ~LockCache() = default;
+
+  /// @brief Looks for a registration by @p owner covering the pages of [ptr, ptr + size) that is
+  /// mapped to at least @p nodes.  On a hit a reference is taken for @p ptr and the agent address
+  /// is returned in @p agent_ptr.
+  bool Acquire(const void* owner, void* ptr, size_t size, const std::vector<uint32_t>& nodes,
+               void** agent_ptr);
+
+  /// @brief Records a new registration of [ptr, ptr + size) with one reference for @p ptr.
+  /// Returns false, leaving the registration untracked, if @p ptr is already locked.
+  bool Insert(const void* owner, void* ptr, size_t size, const std::vector<uint32_t>& nodes,
+              void* agent_ptr);
+
+  /// @brief Drops a reference taken for @p ptr.  Returns false if @p ptr is not tracked.
+  bool Release(void* ptr, size_t capacity);
+
+  /// @brief Releases unreferenced registrations overlapping [ptr, ptr + size).
+  void Evict(const void* ptr, size_t size);
+
+  /// @brief Releases registrations overlapping [ptr, ptr + size).  Referenced registrations are
+  /// released by their last unlock.
+  void Invalidate(const void* ptr, size_t size);
+
+  /// @brief Releases every registration.
+  void Flush();
+
+ private:
+  struct Entry {
+    const void* owner;
+    uintptr_t base;
+    size_t size;
+    // Page aligned extent of the registration.
+    uintptr_t start;
+    uintptr_t end;
+    std::vector<uint32_t> nodes;
+    uintptr_t agent_base;
+    uint32_t refs;
+    bool stale;
+    std::list<Entry*>::iterator lru;
+  };
+
+  void Destroy(Entry* entry);
+
+  template <typename Pred> void Sweep(const void* ptr, size_t size, Pred pred);
+
+  // Registrations by base address.
+  std::map<uintptr_t, Entry*> entries_;
+
+  // Largest page aligned extent seen, bounds the backward search through entries_.
+  size_t max_extent_ = 0;
+
+  // Locked addresses and their outstanding lock count.
+  std::map<uintptr_t, std::pair<Entry*, uint32_t>> handles_;
+
+  // Unreferenced registrations, most recently used first.
+  std::list<Entry*> lru_;
+
+  KernelMutex lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockCache);
+};
+
+}  // namespace AMD
+}  // namespace rocr
+
+#endif  // header guard
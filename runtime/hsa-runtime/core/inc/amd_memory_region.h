@@ -48,9 +48,11 @@
 #include "hsakmt/hsakmt.h"
 
 #include "core/inc/agent.h"
+#include "core/inc/amd_lock_cache.h"
 #include "core/inc/runtime.h"
 #include "core/inc/memory_region.h"
-#include "core/util/simple_heap.h"
+#include "core/util/tlsf_heap.h"
+#include "core/util/slab_heap.h"
 #include "core/util/locks.h"
 
 #include "inc/hsa_ext_amd.h"
@@ -85,9 +87,17 @@ class MemoryRegion : public core::MemoryRegion {
   static bool MakeKfdMemoryResident(size_t num_node, const uint32_t* nodes, const void* ptr,
                                     size_t size, uint64_t* alternate_va, HsaMemMapFlags map_flag);
 
+  /// @brief Pin several ranges to the same nodes in one call.
+  static bool MakeKfdMemoryResident(size_t num_node, const uint32_t* nodes,
+                                    const HsaMemoryRange* ranges, size_t num_ranges,
+                                    HsaMemMapFlags map_flag);
+
   /// @brief Unpin memory.
   static bool MakeKfdMemoryUnresident(const void* ptr);
 
+  /// @brief Unpin several allocations in one call.
+  static bool MakeKfdMemoryUnresident(void** ptrs, size_t num_ptrs);
+
   MemoryRegion(bool fine_grain, bool kernarg, bool full_profile, bool extended_scope_fine_grain,
                bool user_visible, core::Agent* owner, const HsaMemoryProperties& mem_props);
 
@@ -97,6 +107,9 @@ class MemoryRegion : public core::MemoryRegion {
 
   hsa_status_t Free(void* address, size_t size) const;
 
+  void FreeBatch(const std::vector<std::pair<void*, size_t>>& blocks,
+                 std::vector<void*>& failed) const;
+
   hsa_status_t IPCFragmentExport(void* address) const;
 
   hsa_status_t GetInfo(hsa_region_info_t attribute, void* value) const;
@@ -111,6 +124,11 @@ class MemoryRegion : public core::MemoryRegion {
   hsa_status_t AllowAccess(uint32_t num_agents, const hsa_agent_t* agents,
                            const void* ptr, size_t size) const;
 
+  /// @brief Grants access to a batch of allocations of this region.  Ranges needing the same
+  /// mapping are mapped together.
+  hsa_status_t AllowAccess(uint32_t num_agents, const hsa_agent_t* agents,
+                           const HsaMemoryRange* ranges, size_t num_ranges) const;
+
   hsa_status_t CanMigrate(const MemoryRegion& dst, bool& result) const;
 
   hsa_status_t Migrate(uint32_t flag, const void* ptr) const;
@@ -120,6 +138,14 @@ class MemoryRegion : public core::MemoryRegion {
 
   hsa_status_t Unlock(void* host_ptr) const;
 
+  /// @brief Drop cached lock registrations overlapping [ptr, ptr + size).
+  static void InvalidateLockCache(const void* ptr, size_t size) {
+    lock_cache_.Invalidate(ptr, size);
+  }
+
+  /// @brief Release all cached lock registrations.
+  static void FlushLockCache() { lock_cache_.Flush(); }
+
   HSAuint64 GetBaseAddress() const { return mem_props_.VirtualBaseAddress; }
 
   HSAuint64 GetPhysicalSize() const { return mem_props_.SizeInBytes; }
@@ -131,6 +157,12 @@ class MemoryRegion : public core::MemoryRegion {
 
   void Trim() const;
 
+  void TrimIdle(uint64_t idle_ms) const;
+
+  hsa_status_t Reserve(size_t size) const override;
+
+  hsa_status_t ReleaseReservation() const override;
+
   HSAuint64 GetCacheSize() const { return fragment_allocator_.cache_size(); }
 
   __forceinline bool IsLocalMemory() const {
@@ -173,7 +205,12 @@ class MemoryRegion : public core::MemoryRegion {
   __forceinline const HsaMemMapFlags &map_flags() const { return map_flag_; }
 
   void *fragment_alloc(size_t size) const {
-    return fragment_allocator_.alloc(size);
+    const size_t block_allocs = fragment_allocator_.block_allocs();
+    void* mem = fragment_allocator_.alloc(size);
+    core::Metrics::Count((fragment_allocator_.block_allocs() == block_allocs)
+                             ? HSA_AMD_RUNTIME_COUNTER_FRAGMENT_ALLOC_HITS
+                             : HSA_AMD_RUNTIME_COUNTER_FRAGMENT_ALLOC_MISSES);
+    return mem;
   }
   bool fragment_free(void *mem) const { return fragment_allocator_.free(mem); }
 
@@ -189,12 +226,18 @@ private:
   // Used to collect total system memory
   static size_t max_sysmem_alloc_size_;
 
+  // Registrations retained across Lock/Unlock, shared by all system regions.
+  static LockCache lock_cache_;
+
   HSAuint64 virtual_size_;
 
   // Protects against concurrent allow_access calls to fragments of the same block by virtue of all
   // fragments of the block routing to the same MemoryRegion.
   mutable KernelMutex access_lock_;
 
+  // VRAM fragment size backing AllocateLargePage allocations.
+  static const size_t kLargePageSize = 2 * 1024 * 1024;
+
   static __forceinline const size_t& kPageSize() {
     static size_t kPageSize_ = sysconf(_SC_PAGESIZE);
     return kPageSize_;
@@ -221,7 +264,20 @@ private:
     size_t block_size() const { return block_size_; }
   };
 
-  mutable SimpleHeap<BlockAllocator> fragment_allocator_;
+  mutable TlsfHeap<BlockAllocator> fragment_allocator_;
+
+  // Carves slabs for small allocations out of fragment_allocator_.
+  class SlabAllocator {
+   private:
+    const MemoryRegion& region_;
+   public:
+    explicit SlabAllocator(const MemoryRegion& region) : region_(region) {}
+    void* alloc(size_t size) const;
+    void free(void* ptr) const;
+  };
+
+  // Must be destroyed before fragment_allocator_ which backs it.
+  mutable SlabHeap<SlabAllocator> slab_allocator_;
 };
 
 }  // namespace amd
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+#ifndef HSA_RUNTIME_CORE_INC_AMD_SPM_STREAM_H_
+#define HSA_RUNTIME_CORE_INC_AMD_SPM_STREAM_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "inc/hsa_ext_amd.h"
+#include "core/util/locks.h"
+#include "core/util/os.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace AMD {
+
+class GpuAgent;
+
+/// @brief Runtime managed SPM capture, see hsa_amd_spm_stream_start.
+///
+/// The capture thread keeps KFD supplied with free buffers and queues filled ones, the delivery
+/// thread hands filled buffers to the callback and the file sink.  A slow consumer therefore only
+/// costs data once every buffer is waiting for delivery.
+class SpmStream {
+ public:
+  SpmStream(GpuAgent* agent, size_t buffer_size, uint32_t buffer_count,
+            hsa_amd_spm_stream_callback_t callback, void* user_data, FILE* file);
+  ~SpmStream();
+
+  /// @brief Acquires SPM and starts the threads.
+  hsa_status_t Start();
+
+ private:
+  struct Filled {
+    uint32_t index;
+    uint32_t size;
+    bool data_loss;
+  };
+
+  static void CaptureRun(void* stream);
+  void CaptureLoop();
+  static void DeliverRun(void* stream);
+  void DeliverLoop();
+
+  // Writes one buffer to file_ in the encoding described at hsa_amd_spm_stream_start.
+  void WriteEncoded(const uint8_t* data, uint32_t size, bool data_loss);
+
+  GpuAgent* agent_;
+  const uint32_t buffer_size_;
+  hsa_amd_spm_stream_callback_t callback_;
+  void* user_data_;
+  FILE* file_;
+
+  std::vector<std::unique_ptr<uint8_t[]>> buffers_;
+  std::deque<uint32_t> free_;
+  std::deque<Filled> filled_;
+  KernelMutex lock_;
+  os::EventHandle free_event_;
+  os::EventHandle filled_event_;
+
+  os::Thread capture_thread_;
+  os::Thread deliver_thread_;
+  std::atomic<bool> capture_exit_;
+  std::atomic<bool> deliver_exit_;
+  bool acquired_;
+
+  std::vector<uint32_t> encoded_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpmStream);
+};
+
+}  // namespace AMD
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_AMD_SPM_STREAM_H_
@@ -0,0 +1,328 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+//
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+//
+// Developed by:
+//
+//                 AMD Research and AMD HSA Software Development
+//
+//                 Advanced Micro Devices, Inc.
+//
+//                 www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HSA_RUNTIME_CORE_INC_AMD_VIRTUAL_QUEUE_H_
+#define HSA_RUNTIME_CORE_INC_AMD_VIRTUAL_QUEUE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "core/inc/runtime.h"
+#include "core/inc/queue.h"
+#include "core/inc/signal.h"
+#include "core/inc/interrupt_signal.h"
+#include "core/util/locks.h"
+
+namespace rocr {
+namespace AMD {
+
+class GpuAgent;
+class VirtualQueue;
+
+// @brief Hardware AQL queue that several VirtualQueues forward their packets into.
+// Forwarding is serialized by the queue lock.  A source that finds the ring full is parked and
+// resumed, in the order it parked, when a retry barrier placed behind the ring contents completes.
+class SharedHwQueue {
+ public:
+  // Reference to a virtual queue for asynchronous resumes.  Holders may outlive the queue, which
+  // clears the pointer under the lock when it is destroyed.
+  struct Link {
+    KernelMutex lock;
+    VirtualQueue* queue;
+  };
+
+  SharedHwQueue(HSA_QUEUE_PRIORITY priority, bool device_ring);
+  ~SharedHwQueue();
+
+  // @brief Takes ownership of the hardware queue, created with HandleError as its callback.
+  void Init(core::Queue* queue);
+
+  core::Queue* queue() const { return queue_.get(); }
+  HSA_QUEUE_PRIORITY priority() const { return priority_; }
+  bool deviceRing() const { return device_ring_; }
+
+  // @brief Writes up to count packets of source to the ring and rings the doorbell.
+  // @retval Number of packets written.  If short, source is parked until the ring drains.
+  uint64_t Submit(const std::shared_ptr<Link>& source, const core::AqlPacket* packets,
+                  uint64_t count);
+
+  void Attach(VirtualQueue* queue);
+  void Detach(VirtualQueue* queue, const std::shared_ptr<Link>& link);
+
+  // @brief Gives up the place in line of a source that no longer waits for ring space.
+  void Unpark(const std::shared_ptr<Link>& link);
+
+  // @brief Profiling stays enabled while any attached queue asks for it.
+  void SetProfiling(bool enabled);
+
+  void ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b, hsa_fence_scope_t acquireFence,
+                  hsa_fence_scope_t releaseFence, hsa_signal_t* signal);
+
+  // @brief Reports errors of the hardware queue to every attached queue's callback.
+  static void HandleError(hsa_status_t status, hsa_queue_t* source, void* data);
+
+  // Attached queue count, guarded by the owning agent's shared queue lock.
+  uint32_t load_;
+
+ private:
+  static bool HandleRetry(hsa_signal_value_t value, void* arg);
+
+  // True if a retry barrier is on the ring and has not been processed.  See
+  // core::InterceptQueue::IsPendingRetryPoint for the read index assumption this relies on.
+  bool IsPendingRetryPoint(uint64_t read_index) const { return retry_index_ > read_index; }
+
+  std::unique_ptr<core::Queue> queue_;
+  const HSA_QUEUE_PRIORITY priority_;
+  const bool device_ring_;
+
+  // Protects the ring write index and all members below.
+  KernelMutex lock_;
+
+  std::vector<VirtualQueue*> queues_;
+
+  // Sources waiting for ring space, oldest first.
+  std::deque<std::shared_ptr<Link>> parked_;
+
+  // Ring index of the last retry barrier and the signal its completion decrements.
+  uint64_t retry_index_;
+  core::InterruptSignal* retry_signal_;
+  std::atomic<bool> quit_;
+
+  uint32_t profiling_;
+
+  static const hsa_signal_value_t RETRY_MAX = 0xFFFFFFFFFFFFFFFFull;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedHwQueue);
+};
+
+// @brief Software AQL queue whose packets are forwarded to a SharedHwQueue.
+// Lets many queues run on a bounded number of hardware queues (HSA_VIRTUAL_QUEUE_LIMIT) rather
+// than oversubscribing the hardware scheduler.  Forwarding happens on doorbell ring for host
+// submissions and on an asynchronous signal event for device submissions, as with
+// core::InterceptQueue.  Barrier packets whose dependencies are unsatisfied are held back until
+// they are, so a wait does not stall the other queues sharing the ring nor deadlock on a packet
+// queued behind it.
+class VirtualQueue : public core::Queue, private core::LocalSignal, public core::DoorbellSignal {
+ public:
+  VirtualQueue(GpuAgent* agent, SharedHwQueue* shared, uint32_t size, hsa_queue_type32_t type,
+               core::HsaEventCallback callback, void* data);
+  ~VirtualQueue();
+
+  hsa_status_t Inactivate() override {
+    active_ = false;
+    return HSA_STATUS_SUCCESS;
+  }
+
+  // @brief Moves the queue to a shared queue of the new priority once its packets forwarded so
+  // far have completed.
+  hsa_status_t SetPriority(HSA_QUEUE_PRIORITY priority) override;
+
+  // @brief Stops or restarts forwarding.  Packets already on the shared queue are not recalled,
+  // since preempting it would stall every queue sharing it.
+  hsa_status_t SetSuspended(bool suspended) override;
+
+  uint64_t LoadReadIndexAcquire() override {
+    return atomic::Load(&amd_queue_.read_dispatch_id, std::memory_order_acquire);
+  }
+  uint64_t LoadReadIndexRelaxed() override {
+    return atomic::Load(&amd_queue_.read_dispatch_id, std::memory_order_relaxed);
+  }
+  void StoreReadIndexRelaxed(uint64_t value) override { assert(false); }
+  void StoreReadIndexRelease(uint64_t value) override { assert(false); }
+
+  uint64_t LoadWriteIndexRelaxed() override {
+    return atomic::Load(&amd_queue_.write_dispatch_id, std::memory_order_relaxed);
+  }
+  uint64_t LoadWriteIndexAcquire() override {
+    return atomic::Load(&amd_queue_.write_dispatch_id, std::memory_order_acquire);
+  }
+  void StoreWriteIndexRelaxed(uint64_t value) override {
+    atomic::Store(&amd_queue_.write_dispatch_id, value, std::memory_order_relaxed);
+  }
+  void StoreWriteIndexRelease(uint64_t value) override {
+    atomic::Store(&amd_queue_.write_dispatch_id, value, std::memory_order_release);
+  }
+  uint64_t CasWriteIndexAcqRel(uint64_t expected, uint64_t value) override {
+    return atomic::Cas(&amd_queue_.write_dispatch_id, value, expected, std::memory_order_acq_rel);
+  }
+  uint64_t CasWriteIndexAcquire(uint64_t expected, uint64_t value) override {
+    return atomic::Cas(&amd_queue_.write_dispatch_id, value, expected, std::memory_order_acquire);
+  }
+  uint64_t CasWriteIndexRelaxed(uint64_t expected, uint64_t value) override {
+    return atomic::Cas(&amd_queue_.write_dispatch_id, value, expected, std::memory_order_relaxed);
+  }
+  uint64_t CasWriteIndexRelease(uint64_t expected, uint64_t value) override {
+    return atomic::Cas(&amd_queue_.write_dispatch_id, value, expected, std::memory_order_release);
+  }
+  uint64_t AddWriteIndexAcqRel(uint64_t value) override {
+    return atomic::Add(&amd_queue_.write_dispatch_id, value, std::memory_order_acq_rel);
+  }
+  uint64_t AddWriteIndexAcquire(uint64_t value) override {
+    return atomic::Add(&amd_queue_.write_dispatch_id, value, std::memory_order_acquire);
+  }
+  uint64_t AddWriteIndexRelaxed(uint64_t value) override {
+    return atomic::Add(&amd_queue_.write_dispatch_id, value, std::memory_order_relaxed);
+  }
+  uint64_t AddWriteIndexRelease(uint64_t value) override {
+    return atomic::Add(&amd_queue_.write_dispatch_id, value, std::memory_order_release);
+  }
+
+  // CU masks belong to the hardware queue and would apply to every queue sharing it.
+  hsa_status_t SetCUMasking(uint32_t num_cu_mask_count, const uint32_t* cu_mask) override {
+    return HSA_STATUS_ERROR_INVALID_QUEUE;
+  }
+  hsa_status_t GetCUMasking(uint32_t num_cu_mask_count, uint32_t* cu_mask) override;
+  hsa_status_t SetDispatchCUMasking(uint32_t num_cu_mask_count, const uint32_t* cu_mask) override {
+    return HSA_STATUS_ERROR_INVALID_QUEUE;
+  }
+
+  void ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b,
+                  hsa_fence_scope_t acquireFence = HSA_FENCE_SCOPE_NONE,
+                  hsa_fence_scope_t releaseFence = HSA_FENCE_SCOPE_NONE,
+                  hsa_signal_t* signal = NULL) override;
+
+  void SetProfiling(bool enabled) override;
+
+  hsa_status_t GetInfo(hsa_queue_info_attribute_t attribute, void* value) override;
+
+  // @brief Forwards the valid packets the shared queue has room for.
+  void Process();
+
+  // @brief Error callback of the queue, see SharedHwQueue::HandleError.
+  void ReportError(hsa_status_t status) {
+    errors_callback_(status, public_handle(), errors_data_);
+  }
+
+  /// @brief Update signal value using Relaxed semantics
+  ///
+  /// @param value Value of signal to update with
+  void StoreRelaxed(hsa_signal_value_t value) override { Process(); }
+
+  /// @brief Update signal value using Release semantics
+  ///
+  /// @param value Value of signal to update with
+  void StoreRelease(hsa_signal_value_t value) override {
+    std::atomic_thread_fence(std::memory_order_release);
+    StoreRelaxed(value);
+  }
+
+  static __forceinline bool IsType(core::Signal* signal) { return signal->IsType(&rtti_id()); }
+  static __forceinline bool IsType(core::Queue* queue) { return queue->IsType(&rtti_id()); }
+
+ protected:
+  bool _IsA(core::Queue::rtti_t id) const override { return id == &rtti_id(); }
+
+ private:
+  // @brief Returns true if packet may be forwarded now.  Otherwise fills pending with the
+  // dependency signals to wait for, all of which must be satisfied for a barrier AND and any
+  // one of them for a barrier OR.
+  static bool Ready(const core::AqlPacket* packet, std::vector<hsa_signal_t>* pending);
+
+  // @brief Resumes forwarding when one of signals reaches zero.  Returns false if no handler
+  // could be registered.
+  bool WaitFor(const std::vector<hsa_signal_t>& signals);
+
+  // @brief Submits to the shared queue, tracking whether this queue is parked on it.
+  uint64_t Forward(const core::AqlPacket* packets, uint64_t count);
+
+  // @brief Switches to a shared queue of priority_ once the current one has drained.
+  // @retval false Forwarding must wait for the switch.
+  bool Rebind();
+
+  static bool HandleAsyncDoorbell(hsa_signal_value_t value, void* arg);
+  static bool HandleDependency(hsa_signal_value_t value, void* arg);
+
+  GpuAgent* agent_;
+  SharedHwQueue* shared_;
+  std::shared_ptr<SharedHwQueue::Link> link_;
+
+  // Serializes packet forwarding.
+  KernelMutex lock_;
+
+  // Index of the next packet to forward.
+  uint64_t next_packet_;
+
+  // Set while a dependency handler is registered to resume forwarding.
+  bool waiting_;
+
+  // Set while parked on shared_, and when parked by the current Process call.
+  bool parked_;
+  bool stalled_;
+
+  // Requested priority and the completion signal of the barrier ending the current binding.
+  HSA_QUEUE_PRIORITY priority_;
+  core::InterruptSignal* handoff_signal_;
+  bool handoff_pending_;
+
+  bool profiling_;
+
+  // Set while forwarding is suspended by SetSuspended.
+  bool suspended_;
+
+  core::HsaEventCallback errors_callback_;
+  void* errors_data_;
+
+  // Event signal to use for device side doorbell rings and control flag.
+  core::InterruptSignal* async_doorbell_;
+  std::atomic<bool> quit_;
+
+  std::atomic<bool> active_;
+
+  // Packet buffer presented to producers.
+  core::SharedArray<core::AqlPacket, 4096> buffer_;
+
+  static const hsa_signal_value_t DOORBELL_MAX = 0xFFFFFFFFFFFFFFFFull;
+
+  static __forceinline int& rtti_id() {
+    static int rtti_id_ = 0;
+    return rtti_id_;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(VirtualQueue);
+};
+
+}  // namespace AMD
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_AMD_VIRTUAL_QUEUE_H_
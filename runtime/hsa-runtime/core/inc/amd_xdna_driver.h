@@ -44,11 +44,13 @@
 
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "core/driver/xdna/uapi/amdxdna_accel.h"
 #include "core/inc/amd_aie_agent.h"
 #include "core/inc/driver.h"
 #include "core/inc/memory_region.h"
+#include "core/util/locks.h"
 
 /// @brief struct amdxdna_cmd_chain - Interpretation of data payload for
 /// ERT_CMD_CHAIN
@@ -158,9 +160,40 @@ public:
   hsa_status_t CreateQueue(core::Queue &queue) const override;
   hsa_status_t DestroyQueue(core::Queue &queue) const override;
 
-  // @brief Submits num_pkts packets in a command chain to the XDNA driver
+  /// @brief Command chain in flight on the device and the BOs it holds until it completes.
+  struct CmdChain {
+    /// @brief Sequence number assigned by the driver on submission.
+    uint64_t seq = 0;
+    uint32_t hw_ctx_handle = 0;
+    uint32_t chain_handle = 0;
+    uint32_t chain_size = 0;
+    amdxdna_cmd* chain = nullptr;
+    std::vector<uint32_t> cmd_handles;
+    std::vector<uint32_t> cmd_sizes;
+    std::vector<amdxdna_cmd*> cmds;
+    /// @brief Operand buffers synced again once the chain completes.
+    std::vector<uint64_t> bo_addrs;
+    std::vector<uint32_t> bo_sizes;
+  };
+
+  /// @brief Submits num_pkts packets in a command chain to the XDNA driver without waiting for
+  /// them to execute.  Each successful submission must be completed with WaitCmdChain.
   hsa_status_t SubmitCmdChain(hsa_amd_aie_ert_packet_t* first_pkt, uint32_t num_pkts,
-                              uint32_t num_operands, uint32_t hw_ctx_handle);
+                              uint32_t num_operands, uint32_t hw_ctx_handle, CmdChain& chain);
+
+  /// @brief Hands a buffer between the host and the device.  Buffers start out
+  /// host accessible and are synced before and after every command using
+  /// them.  A buffer released to the device is synced once here and skipped
+  /// by commands until the host takes it back.
+  ///
+  /// @param ptr Base address of a buffer allocated on the AIE agent.
+  /// @param host_access True before the host reads or writes the buffer, false
+  /// once it is done.
+  hsa_status_t SetHostAccess(void* ptr, bool host_access);
+
+  /// @brief Blocks until a submitted command chain completes then returns its command BOs to the
+  /// pool of its hardware context.
+  hsa_status_t WaitCmdChain(CmdChain& chain);
 
  private:
   hsa_status_t QueryDriverVersion();
@@ -189,17 +222,35 @@ public:
                               hsa_amd_aie_ert_start_kernel_data_t* cmd_pkt_payload,
                               const std::unordered_map<void*, uint32_t>& vmem_addr_mappings);
 
-  /// @brief Syncs all BOs referenced in bo_args
+  /// @brief Syncs all BOs referenced in bo_args, except those owned by the device
   ///
   /// @param bo_args vector containing handles of BOs to sync
   hsa_status_t SyncBos(const std::vector<uint64_t>& bo_args, const std::vector<uint32_t>& bo_sizes);
 
-  /// @brief Executes a command and waits for its completion
+  /// @brief Releases the command BOs of a chain.
   ///
-  /// @param exec_cmd Structure containing the details of the command to execute
-  /// @param hw_ctx_handle the handle of the hardware context to run this
-  /// command
-  hsa_status_t ExecCmdAndWait(amdxdna_drm_exec_cmd* exec_cmd, uint32_t hw_ctx_handle);
+  /// @param reuse Return the BOs to the pool, false if the device may still read them.
+  void ReleaseCmdChain(CmdChain& chain, bool reuse);
+
+  /// @brief Command BO kept mapped for reuse by later command chains.
+  struct CmdBo {
+    uint32_t handle;
+    uint32_t size;
+    amdxdna_cmd* cmd;
+  };
+
+  /// @brief Takes a command BO of at least size bytes from the pool of a hardware context,
+  /// creating one when none is free.
+  ///
+  /// @param bo_size Size of the BO returned, size rounded up to kCmdBoGranularity.
+  hsa_status_t AcquireCmd(uint32_t hw_ctx_handle, uint32_t size, uint32_t* handle,
+                          amdxdna_cmd** cmd, uint32_t* bo_size);
+
+  /// @brief Unmaps and closes a command BO.
+  void FreeCmd(const CmdBo& bo) const;
+
+  /// @brief Frees the pooled command BOs of a hardware context.
+  void FreeCmdPool(uint32_t hw_ctx_handle) const;
 
   /// TODO: Remove this in the future and rely on the core Runtime
   /// object to track handle allocations. Using the VMEM API for mapping XDNA
@@ -207,6 +258,12 @@ public:
   /// to manage some of this for now.
   std::unordered_map<uint32_t, void *> vmem_handle_mappings;
   std::unordered_map<void*, uint32_t> vmem_addr_mappings;
+  std::unordered_map<void*, size_t> vmem_size_mappings;
+
+  /// @brief Base addresses of buffers released to the device by SetHostAccess,
+  /// which SyncBos skips.
+  KernelMutex device_owned_lock_;
+  std::unordered_set<uint64_t> device_owned_;
 
   /// @brief Virtual address range allocated for the device heap.
   ///
@@ -219,6 +276,17 @@ public:
   void *dev_heap_aligned = nullptr;
   static constexpr size_t dev_heap_size = 64 * 1024 * 1024;
   static constexpr size_t dev_heap_align = 64 * 1024 * 1024;
+
+  /// @brief Free command BOs of each hardware context.  Creating and mapping a BO
+  /// costs several ioctls, which dominate submission of small inferences.
+  mutable KernelMutex cmd_pool_lock_;
+  mutable std::unordered_map<uint32_t, std::vector<CmdBo>> cmd_pool_;
+
+  /// @brief Command BO sizes are rounded up to this so BOs fit a range of commands.
+  static constexpr uint32_t kCmdBoGranularity = 4096;
+
+  /// @brief Most free command BOs kept per hardware context.
+  static constexpr size_t kCmdPoolLimit = 64;
 };
 
 } // namespace AMD
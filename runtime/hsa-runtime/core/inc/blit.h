@@ -46,6 +46,7 @@
 #include <stdint.h>
 
 #include "core/inc/agent.h"
+#include "core/inc/signal.h"
 
 namespace rocr {
 namespace core {
@@ -91,6 +92,81 @@ class Blit {
       std::vector<core::Signal*>& dep_signals, core::Signal& out_signal,
       std::vector<core::Signal*>& gang_signals) = 0;
 
+  /// @brief Submit a batch of linear copies which complete together. The call
+  /// is non blocking. The copies start after all dependent signals are
+  /// satisfied. After every copy is completed, the out signal is decremented
+  /// once.
+  ///
+  /// @details The default implementation issues one copy at a time; the out
+  /// signal is raised by count - 1 up front so that only the last completion
+  /// takes it to its final value.
+  ///
+  /// @param copies Array of copy descriptors.
+  /// @param count Number of descriptors in @p copies, must be non-zero.
+  /// @param dep_signals Arrays of dependent signal.
+  /// @param out_signal Output signal.
+  virtual hsa_status_t SubmitLinearCopyBatchCommand(
+      const hsa_amd_memory_copy_descriptor_t* copies, uint32_t count,
+      std::vector<core::Signal*>& dep_signals, core::Signal& out_signal) {
+    std::vector<core::Signal*> gang_signals(0);
+    out_signal.AddRelaxed(count - 1);
+    for (uint32_t i = 0; i < count; i++) {
+      hsa_status_t stat = SubmitLinearCopyCommand(copies[i].dst, copies[i].src, copies[i].size,
+                                                  dep_signals, out_signal, gang_signals);
+      if (stat != HSA_STATUS_SUCCESS) {
+        // Retire the copies which were never submitted.
+        out_signal.SubRelaxed(count - 1 - i);
+        return stat;
+      }
+    }
+    return HSA_STATUS_SUCCESS;
+  }
+
+  /// @brief Submit a list of strided block copies which complete together.
+  /// Semantics are those of SubmitLinearCopyBatchCommand.
+  ///
+  /// @details The default implementation submits every contiguous run of the
+  /// blocks as one copy of a linear batch.
+  ///
+  /// @param blocks Array of block descriptors.
+  /// @param count Number of descriptors in @p blocks, must be non-zero.
+  /// @param dep_signals Arrays of dependent signal.
+  /// @param out_signal Output signal.
+  virtual hsa_status_t SubmitStridedCopyCommand(const hsa_amd_memory_copy_strided_t* blocks,
+                                                uint32_t count,
+                                                std::vector<core::Signal*>& dep_signals,
+                                                core::Signal& out_signal) {
+    std::vector<hsa_amd_memory_copy_descriptor_t> copies;
+    for (uint32_t i = 0; i < count; i++) AppendStridedRuns(blocks[i], copies);
+    // An all empty list still has to complete.
+    if (copies.empty()) copies.push_back({nullptr, nullptr, 0});
+    return SubmitLinearCopyBatchCommand(&copies[0], copies.size(), dep_signals, out_signal);
+  }
+
+  /// @brief Appends the rows of @p block to @p copies as linear copies.  Rows
+  /// continuing the last copy in both source and destination extend it.
+  static void AppendStridedRuns(const hsa_amd_memory_copy_strided_t& block,
+                                std::vector<hsa_amd_memory_copy_descriptor_t>& copies) {
+    if (block.width == 0) return;
+    for (size_t z = 0; z < block.depth; z++) {
+      for (size_t y = 0; y < block.height; y++) {
+        uint8_t* dst = reinterpret_cast<uint8_t*>(block.dst) + z * block.dst_slice +
+            y * block.dst_pitch;
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(block.src) + z * block.src_slice +
+            y * block.src_pitch;
+        if (!copies.empty()) {
+          hsa_amd_memory_copy_descriptor_t& last = copies.back();
+          if ((reinterpret_cast<uint8_t*>(last.dst) + last.size == dst) &&
+              (reinterpret_cast<const uint8_t*>(last.src) + last.size == src)) {
+            last.size += block.width;
+            continue;
+          }
+        }
+        copies.push_back({dst, src, block.width});
+      }
+    }
+  }
+
   /// @brief Submit a linear fill command to the the underlying compute device's
   /// control block. The call is blocking until the command execution is
   /// finished.
@@ -101,6 +177,20 @@ class Blit {
   virtual hsa_status_t SubmitLinearFillCommand(void* ptr, uint32_t value,
                                                size_t num) = 0;
 
+  /// @brief Submit a linear fill of a repeating pattern. The call is non
+  /// blocking. The fill starts after all dependent signals are satisfied and
+  /// decrements the out signal once done.
+  ///
+  /// @param ptr Memory address of the fill destination, aligned to the pattern.
+  /// @param pattern Pattern of @p pattern_dwords uint32_t, 1 or 4.
+  /// @param size Number of bytes to fill, a multiple of the pattern size.
+  /// @param dep_signals Arrays of dependent signal.
+  /// @param out_signal Output signal.
+  virtual hsa_status_t SubmitLinearFillCommand(void* ptr, const uint32_t* pattern,
+                                               uint32_t pattern_dwords, size_t size,
+                                               std::vector<core::Signal*>& dep_signals,
+                                               core::Signal& out_signal) = 0;
+
   /// @brief Enable profiling of the asynchronous copy command. The timestamp
   /// of each copy request will be stored in the completion signal structure.
   ///
@@ -117,6 +207,10 @@ class Blit {
   /// must be exact.
   virtual uint64_t PendingBytes() = 0;
 
+  /// @brief Sends the completion interrupt of a signal whose interrupt was deferred by an earlier
+  /// command.  Only blits that defer interrupts need to implement this.
+  virtual void SubmitInterrupt(core::Signal& signal) {}
+
   virtual void GangLeader(bool gang_leader) = 0;
   virtual bool GangLeader() const { return false; };
 };
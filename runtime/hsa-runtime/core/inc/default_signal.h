@@ -52,6 +52,8 @@
 namespace rocr {
 namespace core {
 
+class IPCDoorbell;
+
 /// @brief Operations for a simple pure memory based signal.
 /// @brief See base class Signal.
 class BusyWaitSignal : public Signal {
@@ -65,6 +67,14 @@ class BusyWaitSignal : public Signal {
   /// @brief See base class Signal.
   explicit BusyWaitSignal(SharedSignal* abi_block, bool enableIPC);
 
+  ~BusyWaitSignal();
+
+  /// @brief Attaches the host doorbell used to wake waiters in other processes.  Takes
+  /// ownership of @p doorbell.
+  void SetDoorbell(IPCDoorbell* doorbell);
+
+  IPCDoorbell* doorbell() const { return doorbell_.load(std::memory_order_acquire); }
+
   // Below are various methods corresponding to the APIs, which load/store the
   // signal value or modify the existing signal value automically and with
   // specified memory ordering semantics.
@@ -162,6 +172,14 @@ class BusyWaitSignal : public Signal {
     return rtti_id_;
   }
 
+  /// @brief Wakes doorbell waiters after a host update of the signal value.
+  __forceinline void Ring() {
+    if (doorbell_.load(std::memory_order_relaxed) != nullptr) RingDoorbell();
+  }
+  void RingDoorbell();
+
+  std::atomic<IPCDoorbell*> doorbell_;
+
   DISALLOW_COPY_AND_ASSIGN(BusyWaitSignal);
 };
 
@@ -174,7 +192,10 @@ class DefaultSignal : private LocalSignal, public BusyWaitSignal {
 
   /// @brief See base class Signal.
   explicit DefaultSignal(hsa_signal_value_t initial_value, bool enableIPC = false)
-      : LocalSignal(initial_value, enableIPC), BusyWaitSignal(signal(), enableIPC) {}
+      : LocalSignal(initial_value, enableIPC), BusyWaitSignal(signal(), enableIPC) {
+    // Host stores only write the value unless an IPC doorbell may need ringing.
+    if (!enableIPC) signal()->host_store = SharedSignal::kHostStoreValue;
+  }
 
  protected:
   bool _IsA(rtti_t id) const {
@@ -360,6 +360,369 @@ hsa_status_t hsa_amd_queue_get_info(hsa_queue_t* queue, hsa_queue_info_attribute
 // Mirrors Amd Extension Apis
 hsa_status_t HSA_API hsa_amd_enable_logging(uint8_t* flags, void* file);
 
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_signal_wait_policy(hsa_signal_t signal,
+                                                hsa_amd_signal_wait_policy_t policy);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_signal_wait_set_create(hsa_amd_signal_wait_set_t* wait_set);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_signal_wait_set_destroy(hsa_amd_signal_wait_set_t wait_set);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_signal_wait_set_add(hsa_amd_signal_wait_set_t wait_set,
+                                                 hsa_signal_t signal,
+                                                 hsa_signal_condition_t condition,
+                                                 hsa_signal_value_t compare_value);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_signal_wait_set_remove(hsa_amd_signal_wait_set_t wait_set,
+                                                    hsa_signal_t signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_signal_wait_set_wait(hsa_amd_signal_wait_set_t wait_set,
+                                                  uint64_t timeout_hint, hsa_wait_state_t wait_hint,
+                                                  uint32_t max_ready, hsa_signal_t* ready_signals,
+                                                  hsa_signal_value_t* ready_values,
+                                                  uint32_t* ready_count);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_signal_async_handler_with_flags(
+    hsa_signal_t signal, hsa_signal_condition_t cond, hsa_signal_value_t value,
+    hsa_amd_signal_handler handler, void* arg, uint64_t flags);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_async_copy_batch(const hsa_amd_memory_copy_descriptor_t* copies,
+                                                     uint32_t num_copies, hsa_agent_t dst_agent,
+                                                     hsa_agent_t src_agent,
+                                                     uint32_t num_dep_signals,
+                                                     const hsa_signal_t* dep_signals,
+                                                     hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_lock_cache_invalidate(void* ptr, size_t size);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_queue_kernarg_alloc(const hsa_queue_t* queue, size_t size,
+                                                 size_t alignment, uint64_t packet_id,
+                                                 void** kernarg_address);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_queue_submit_batch(hsa_queue_t* queue, const void* packets,
+                                                uint32_t packet_count, uint64_t* first_index);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_queue_create(
+    hsa_agent_t agent, uint32_t size, hsa_queue_type32_t type,
+    void (*callback)(hsa_status_t status, hsa_queue_t* source, void* data), void* data,
+    uint32_t private_segment_size, uint32_t group_segment_size, uint64_t flags,
+    hsa_queue_t** queue);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_async_copy_on_engine_with_priority(
+    void* dst, hsa_agent_t dst_agent, const void* src, hsa_agent_t src_agent, size_t size,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal,
+    hsa_amd_sdma_engine_id_t engine_id, bool force_copy_on_sdma, hsa_amd_queue_priority_t priority);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_copy_list_create(hsa_agent_t agent, hsa_amd_sdma_engine_id_t engine_id,
+                                              const hsa_amd_copy_command_t* commands,
+                                              uint32_t num_commands, hsa_amd_copy_list_t* list);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_copy_list_submit(hsa_amd_copy_list_t list, uint32_t num_dep_signals,
+                                              const hsa_signal_t* dep_signals,
+                                              hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_copy_list_destroy(hsa_amd_copy_list_t list);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_agents_allow_access_batch(uint32_t num_agents,
+                                                       const hsa_agent_t* agents,
+                                                       const uint32_t* flags, uint32_t num_ptrs,
+                                                       const void* const* ptrs);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_signal_get_eventfd(hsa_signal_t signal, int* fd);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_executable_freeze_async(hsa_executable_t executable,
+                                                     const char* options,
+                                                     hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_executables_destroy(uint32_t num_executables,
+                                                 const hsa_executable_t* executables);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_queue_dispatch_timestamps_enable(hsa_queue_t* queue,
+                                                              uint32_t record_count);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_queue_dispatch_timestamp_signal(const hsa_queue_t* queue,
+                                                             uint64_t packet_id,
+                                                             hsa_signal_t* signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_queue_dispatch_timestamps_read(hsa_queue_t* queue,
+                                                            uint32_t max_records,
+                                                            hsa_amd_dispatch_timestamp_t* records,
+                                                            uint32_t* record_count,
+                                                            uint64_t* dropped);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_runtime_metrics_get(hsa_amd_runtime_metrics_t* metrics);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_svm_profile_get_ranges(hsa_amd_svm_range_stats_t* ranges,
+                                                    uint32_t max_ranges, uint32_t* range_count);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_runtime_trace_flush(void);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_spm_stream_start(hsa_agent_t agent, size_t buffer_size,
+                                              uint32_t buffer_count,
+                                              hsa_amd_spm_stream_callback_t callback,
+                                              void* user_data, const char* file);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_spm_stream_stop(hsa_agent_t agent);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_profiling_get_clock_params(hsa_agent_t agent,
+                                                        const hsa_amd_clock_params_t** params);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_ipc_memory_attach_batch(const hsa_amd_ipc_memory_t* handles,
+                                                     const size_t* lens, uint32_t count,
+                                                     uint32_t num_agents,
+                                                     const hsa_agent_t* mapping_agents,
+                                                     void** mapped_ptrs);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_vmem_map_batch(const hsa_amd_vmem_map_desc_t* maps, size_t map_cnt,
+                                            uint64_t flags);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_vmem_set_access_batch(const hsa_amd_vmem_range_t* ranges,
+                                                   size_t range_cnt,
+                                                   const hsa_amd_memory_access_desc_t* desc,
+                                                   size_t desc_cnt);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_svm_prefetch_batch_async(const hsa_amd_svm_prefetch_range_t* ranges,
+                                                      size_t range_count,
+                                                      uint32_t num_dep_signals,
+                                                      const hsa_signal_t* dep_signals,
+                                                      hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_portable_export_dmabuf_bulk(const void* const* ptrs,
+                                                         const size_t* sizes, size_t count,
+                                                         int* dmabuf, uint64_t* offsets);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_async_copy_strided(const hsa_amd_memory_copy_strided_t* blocks,
+                                                       uint32_t num_blocks, hsa_agent_t dst_agent,
+                                                       hsa_agent_t src_agent,
+                                                       uint32_t num_dep_signals,
+                                                       const hsa_signal_t* dep_signals,
+                                                       hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_fill_async(void* ptr, const void* pattern,
+                                               uint32_t pattern_size, size_t count,
+                                               uint32_t num_dep_signals,
+                                               const hsa_signal_t* dep_signals,
+                                               hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_copy_context_create(hsa_agent_t agent, uint32_t engine_ids_mask,
+                                                 hsa_amd_copy_context_t* context);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_copy_context_submit(hsa_amd_copy_context_t context, void* dst,
+                                                 const void* src, size_t size,
+                                                 uint32_t num_dep_signals,
+                                                 const hsa_signal_t* dep_signals,
+                                                 hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_copy_context_destroy(hsa_amd_copy_context_t context);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_async_copy_stream(const void* src, hsa_agent_t src_agent,
+                                                      size_t size,
+                                                      hsa_amd_copy_stream_callback_t callback,
+                                                      void* user_data, uint32_t num_dep_signals,
+                                                      const hsa_signal_t* dep_signals,
+                                                      hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_aie_buffer_host_access(void* ptr, bool host_access);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_cu_partitions_create(hsa_agent_t agent, uint32_t num_partitions,
+                                                  hsa_amd_cu_partitions_t* partitions);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_cu_partitions_bind_queue(hsa_amd_cu_partitions_t partitions,
+                                                      hsa_queue_t* queue, uint32_t index);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_cu_partitions_rebalance(hsa_amd_cu_partitions_t partitions);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_cu_partitions_destroy(hsa_amd_cu_partitions_t partitions);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_queue_cu_set_dispatch_mask(const hsa_queue_t* queue,
+                                                        uint32_t num_cu_mask_count,
+                                                        const uint32_t* cu_mask);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_pool_allocate_async(hsa_amd_memory_pool_t memory_pool,
+                                                        size_t size, uint32_t flags,
+                                                        hsa_signal_t dep_signal, void** ptr);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_pool_free_async(void* ptr, hsa_signal_t dep_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_register_memory_pressure_callback(
+    hsa_amd_memory_pressure_callback_t callback, void* data);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_deregister_memory_pressure_callback(
+    hsa_amd_memory_pressure_callback_t callback, void* data);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_pool_allocate_interleaved(
+    const hsa_amd_memory_pool_t* pools, size_t pool_count, size_t size, size_t granularity,
+    const hsa_amd_memory_access_desc_t* desc, size_t desc_cnt, void** ptr);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_pool_free_interleaved(void* ptr);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_pool_allocate_batch(
+    hsa_amd_memory_pool_t memory_pool, size_t count, const size_t* sizes, uint32_t flags,
+    uint32_t batch_flags, uint32_t num_agents, const hsa_agent_t* agents, void** ptrs);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_pool_reserve(hsa_amd_memory_pool_t memory_pool, size_t size);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_pool_release_reservation(hsa_amd_memory_pool_t memory_pool);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_dispatch_graph_create(hsa_agent_t agent, const void* packets,
+                                                   uint32_t packet_count,
+                                                   const uint32_t* kernarg_sizes,
+                                                   hsa_amd_dispatch_graph_t* graph);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_dispatch_graph_launch(hsa_amd_dispatch_graph_t graph,
+                                                   hsa_queue_t* queue, uint32_t update_count,
+                                                   const hsa_amd_dispatch_graph_update_t* updates,
+                                                   hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_dispatch_graph_destroy(hsa_amd_dispatch_graph_t graph);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_queue_suspend(hsa_queue_t* queue);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_queue_resume(hsa_queue_t* queue);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_profiling_set_dispatch_filter(hsa_queue_t* queue,
+                                                           uint32_t kernel_object_count,
+                                                           const uint64_t* kernel_objects,
+                                                           uint32_t sample_interval);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_system_get_properties(hsa_amd_system_properties_t* properties,
+                                                   void* (*alloc)(size_t));
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_gpu_fault_records_get(hsa_amd_gpu_fault_record_t* records,
+                                                   uint32_t* count);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_completion_queue_create(uint32_t size,
+                                                     hsa_amd_completion_queue_t* queue);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_completion_queue_destroy(hsa_amd_completion_queue_t queue);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_completion_queue_signal_create(hsa_amd_completion_queue_t queue,
+                                                            hsa_signal_value_t initial_value,
+                                                            uint64_t tag, hsa_signal_t* signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_completion_queue_dequeue(hsa_amd_completion_queue_t queue,
+                                                      uint64_t timeout_hint,
+                                                      hsa_wait_state_t wait_hint,
+                                                      uint32_t max_records,
+                                                      hsa_amd_completion_record_t* records,
+                                                      uint32_t* count);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_topology_get(hsa_amd_topology_t* topology, void* (*alloc)(size_t));
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_runtime_thread_policy_set(hsa_amd_thread_class_t thread_class,
+                                                       const hsa_amd_thread_policy_t* policy);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_async_copy_gang(void* dst, hsa_agent_t dst_agent,
+                                                    const void* src, hsa_agent_t src_agent,
+                                                    size_t size, uint32_t num_dep_signals,
+                                                    const hsa_signal_t* dep_signals,
+                                                    hsa_signal_t completion_signal,
+                                                    const hsa_amd_gang_copy_policy_t* policy);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_copy_engine_hints(hsa_agent_t dst_agent,
+                                                      hsa_agent_t src_agent,
+                                                      hsa_amd_copy_engine_hints_t* hints);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_set_device_only(void* ptr, bool device_only);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_progress_counter_create(hsa_agent_t agent, uint64_t initial_value,
+                                                     uint32_t flags,
+                                                     hsa_amd_progress_counter_t* counter,
+                                                     hsa_amd_progress_counter_abi_t** abi);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_progress_counter_destroy(hsa_amd_progress_counter_t counter);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_progress_counter_wait(hsa_amd_progress_counter_t counter,
+                                                   uint64_t threshold, uint64_t timeout_hint,
+                                                   hsa_wait_state_t wait_hint, uint64_t* value);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_memory_migrate_async(void* ptr, size_t size,
+                                                  hsa_amd_memory_pool_t memory_pool,
+                                                  uint32_t flags, uint32_t num_dep_signals,
+                                                  const hsa_signal_t* dep_signals,
+                                                  hsa_signal_t completion_signal);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_interop_cache_invalidate(int interop_handle);
+
+// Mirrors Amd Extension Apis
+hsa_status_t HSA_API hsa_amd_profiling_get_agent_tick(hsa_agent_t agent, uint64_t* agent_tick);
+
 }  // namespace amd
 }  // namespace rocr
 
@@ -55,6 +55,13 @@ namespace rocr {
 namespace core {
 struct ImageExtTableInternal : public ImageExtTable {
   decltype(::hsa_amd_image_get_info_max_dim)* hsa_amd_image_get_info_max_dim_fn;
+  decltype(::hsa_amd_image_blit)* hsa_amd_image_blit_fn;
+  decltype(::hsa_amd_image_blit_async)* hsa_amd_image_blit_async_fn;
+  decltype(::hsa_amd_image_import_async)* hsa_amd_image_import_async_fn;
+  decltype(::hsa_amd_image_export_async)* hsa_amd_image_export_async_fn;
+  decltype(::hsa_amd_image_copy_async)* hsa_amd_image_copy_async_fn;
+  decltype(::hsa_amd_image_clear_async)* hsa_amd_image_clear_async_fn;
+  decltype(::hsa_amd_image_create_batch)* hsa_amd_image_create_batch_fn;
 };
 
 struct PcSamplingExtTableInternal : public PcSamplingExtTable {};
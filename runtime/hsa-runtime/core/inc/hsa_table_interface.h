@@ -49,4 +49,8 @@ void hsa_table_interface_init(const HsaApiTable* apiTable);
 
 const HsaApiTable* hsa_table_interface_get_table();
 
+// Lets the hot queue index and signal entry points bypass the API table when enable is set and no
+// tool has replaced any of them.
+void hsa_table_interface_set_direct(bool enable);
+
 #endif // RUNTIME_HSA_RUNTIME_CORE_INC_HSA_TABLE_INTERFACE_H_
\ No newline at end of file
@@ -84,6 +84,30 @@ namespace rocr {
       hsa_executable_t executable,
       void *data),
     void *data);
+
+  hsa_status_t
+    hsa_ven_amd_loader_executable_load_agents_code_object(
+    hsa_executable_t executable,
+    uint32_t num_agents,
+    const hsa_agent_t *agents,
+    hsa_code_object_reader_t code_object_reader,
+    const char *options,
+    hsa_loaded_code_object_t *loaded_code_objects);
+
+  hsa_status_t
+    hsa_ven_amd_loader_executable_get_kernels(
+    hsa_executable_t executable,
+    const hsa_agent_t *agent,
+    uint32_t *num_kernels,
+    hsa_ven_amd_loader_kernel_info_t *kernels);
+
+  hsa_status_t
+    hsa_ven_amd_loader_select_bundled_code_objects(
+    const void *bundle,
+    size_t bundle_size,
+    uint32_t num_agents,
+    const hsa_agent_t *agents,
+    hsa_ven_amd_loader_bundled_code_object_t *code_objects);
 }  // namespace rocr
 
 #endif
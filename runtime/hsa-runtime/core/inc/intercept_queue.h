@@ -74,6 +74,7 @@ class QueueWrapper : public Queue {
   hsa_status_t SetPriority(HSA_QUEUE_PRIORITY priority) override {
     return wrapped->SetPriority(priority);
   }
+  hsa_status_t SetSuspended(bool suspended) override { return wrapped->SetSuspended(suspended); }
   uint64_t LoadReadIndexAcquire() override { return wrapped->LoadReadIndexAcquire(); }
   uint64_t LoadReadIndexRelaxed() override { return wrapped->LoadReadIndexRelaxed(); }
   uint64_t LoadWriteIndexRelaxed() override { return wrapped->LoadWriteIndexRelaxed(); }
@@ -120,6 +121,9 @@ class QueueWrapper : public Queue {
   hsa_status_t GetCUMasking(uint32_t num_cu_mask_count, uint32_t* cu_mask) override {
     return wrapped->GetCUMasking(num_cu_mask_count, cu_mask);
   }
+  hsa_status_t SetDispatchCUMasking(uint32_t num_cu_mask_count, const uint32_t* cu_mask) override {
+    return wrapped->SetDispatchCUMasking(num_cu_mask_count, cu_mask);
+  }
   void ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b,
                   hsa_fence_scope_t acquireFence = HSA_FENCE_SCOPE_NONE,
                   hsa_fence_scope_t releaseFence = HSA_FENCE_SCOPE_NONE,
@@ -198,9 +202,14 @@ class InterceptQueue : public QueueProxy, private LocalSignal, public DoorbellSi
   explicit InterceptQueue(std::unique_ptr<Queue> queue);
   ~InterceptQueue();
 
-  void AddInterceptor(hsa_amd_queue_intercept_handler interceptor, void* data) {
+  // @brief Add a packet rewrite callback.
+  // Batch callbacks may be handed runs of consecutive packets in one call, other callbacks always
+  // see a single packet per call.
+  void AddInterceptor(hsa_amd_queue_intercept_handler interceptor, void* data,
+                      bool batch = false) {
     assert(interceptor != nullptr && "Packet intercept callback was nullptr.");
-    interceptors.push_back(std::make_pair(interceptor, data));
+    Interceptor entry = {interceptor, data, batch};
+    interceptors.push_back(entry);
   }
 
   hsa_status_t Inactivate() override {
@@ -208,6 +217,14 @@ class InterceptQueue : public QueueProxy, private LocalSignal, public DoorbellSi
     return wrapped->Inactivate();
   }
 
+  // @brief Restrict dispatch profiling to kernels in kernel_objects and/or one in every interval
+  // dispatches.  A count and interval of zero removes the filter.
+  hsa_status_t SetProfilingFilter(const uint64_t* kernel_objects, uint32_t count,
+                                  uint32_t interval);
+
+  // Replaces any profiling filter with whole queue profiling.
+  void SetProfiling(bool enabled) override;
+
  private:
   // Serialize packet interception processing.
   KernelMutex lock_;
@@ -236,13 +253,34 @@ class InterceptQueue : public QueueProxy, private LocalSignal, public DoorbellSi
   SharedArray<AqlPacket, 4096> buffer_;
 
   // Packet transform callbacks
-  std::vector<std::pair<AMD::callback_t<hsa_amd_queue_intercept_handler>, void*>> interceptors;
+  struct Interceptor {
+    AMD::callback_t<hsa_amd_queue_intercept_handler> handler;
+    void* data;
+    bool batch;
+  };
+  std::vector<Interceptor> interceptors;
+
+  // Dispatch profiling filter state, the filter runs just ahead of the final submit interceptor.
+  bool profile_filter_;
+  std::vector<uint64_t> profile_kernels_;
+  uint32_t profile_interval_;
+  uint64_t profile_counter_;
+  AqlPacket profile_on_;
+  AqlPacket profile_off_;
+
+  // Brackets selected kernel dispatches with packets toggling the wrapped queue's profiling.
+  static void ProfileFilter(const void* pkts, uint64_t pkt_count, uint64_t user_pkt_index,
+                            void* data, hsa_amd_queue_intercept_packet_writer writer);
 
   static const hsa_signal_value_t DOORBELL_MAX = 0xFFFFFFFFFFFFFFFFull;
 
   static bool HandleAsyncDoorbell(hsa_signal_value_t value, void* arg);
   static void PacketWriter(const void* pkts, uint64_t pkt_count);
 
+  // Invoke interceptor Cursor.interceptor_index on pkts, splitting them into single packet calls
+  // if it does not accept batches.
+  static void Invoke(const AqlPacket* pkts, uint64_t pkt_count);
+
   // Submit packets to the wrapped queue and return number of packets that were
   // submitted.
   uint64_t Submit(const AqlPacket* packets, uint64_t count);
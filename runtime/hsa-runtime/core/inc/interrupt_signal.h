@@ -73,19 +73,42 @@ class InterruptSignal : private LocalSignal, public Signal {
     };
     using unique_event_ptr = ::std::unique_ptr<HsaEvent, Deleter>;
 
-    EventPool() : allEventsAllocated(false) {}
+    EventPool() : allEventsAllocated(false), next_shared_(0) { NewEpoch(); }
+    ~EventPool() { live_epoch_.store(0, std::memory_order_release); }
 
     HsaEvent* alloc();
     void free(HsaEvent* evt);
-    void clear() {
-      events_.clear();
-      allEventsAllocated = false;
-    }
+
+    /// @brief Returns an event which other signals may be using as well, or nullptr if KFD
+    /// can't track waiters per event.  Shared events are never handed to free().
+    HsaEvent* alloc_shared();
+    void clear();
 
    private:
+    // KFD events are a limited resource so thread magazines are kept small.
+    static const uint32_t kMagazineSize = 16;
+    static const uint32_t kMagazineBatch = kMagazineSize / 2;
+    typedef Magazine<HsaEvent, kMagazineSize> magazine_t;
+
+    static magazine_t& magazine();
+    static void ReturnBatch(void* pool, HsaEvent** items, uint32_t count);
+
+    void NewEpoch();
+
     HybridMutex lock_;
     std::vector<unique_event_ptr> events_;
     bool allEventsAllocated;
+
+    // Events owned by the pool for HSA_SIGNAL_SHARED_EVENTS.
+    std::vector<unique_event_ptr> shared_events_;
+    // Every event alloc() created.  None are destroyed before clear(), so once KFD is out of
+    // events these are lent to further signals.
+    std::vector<HsaEvent*> created_;
+    uint32_t next_shared_;
+
+    // Thread magazines are only valid for the pool generation they were filled from.
+    uint64_t epoch_;
+    static std::atomic<uint64_t> live_epoch_;
   };
 
   static HsaEvent* CreateEvent(HSA_EVENTTYPE type, bool manual_reset);
@@ -190,6 +213,10 @@ class InterruptSignal : private LocalSignal, public Signal {
   /// @brief See base class Signal.
   __forceinline HsaEvent* EopEvent() { return event_; }
 
+  /// @brief Returns an eventfd which is signaled whenever event_ fires.  The
+  /// fd is created on first use and owned by the signal.
+  hsa_status_t GetEventFd(int* fd);
+
  protected:
   bool _IsA(rtti_t id) const { return id == &rtti_id(); }
 
@@ -201,6 +228,12 @@ class InterruptSignal : private LocalSignal, public Signal {
   /// closes or not.
   bool free_event_;
 
+  /// @variable Pollable fd exporting event_, -1 until requested.
+  int event_fd_;
+
+  /// @variable Serializes creation of event_fd_.
+  KernelMutex event_fd_lock_;
+
   /// Used to obtain a globally unique value (address) for rtti.
   static __forceinline int& rtti_id() {
     static int rtti_id_ = 0;
@@ -44,6 +44,7 @@
 #define HSA_RUNTME_CORE_INC_IPC_SIGNAL_H_
 
 #include <atomic>
+#include <string>
 #include <utility>
 
 #include "core/inc/signal.h"
@@ -66,6 +67,47 @@ class SharedMemory {
   void* ptr_;
 };
 
+/// @brief Host doorbell of an IPC signal.  A shared memory page holding a wake sequence which
+/// waiters in any process on the host sleep on (futex) until a host update of the signal rings it.
+class IPCDoorbell {
+ public:
+  /// @brief Creates the doorbell of an exported signal and records its name in @p abi_block.
+  static IPCDoorbell* Create(SharedSignal* abi_block);
+
+  /// @brief Opens the doorbell recorded in @p abi_block, nullptr if there is none.
+  static IPCDoorbell* Open(const SharedSignal* abi_block);
+
+  ~IPCDoorbell();
+
+  uint32_t Sequence() const { return page_->sequence.load(std::memory_order_seq_cst); }
+
+  void AddWaiter() { page_->waiters.fetch_add(1, std::memory_order_seq_cst); }
+
+  void RemoveWaiter() { page_->waiters.fetch_sub(1, std::memory_order_relaxed); }
+
+  /// @brief Wakes all waiters.  Called after the signal value changed.
+  void Ring();
+
+  /// @brief Sleeps for at most @p timeout_us unless the sequence moved past @p seq.
+  void Wait(uint32_t seq, uint32_t timeout_us);
+
+ private:
+  struct Page {
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> waiters;
+  };
+
+  IPCDoorbell(Page* page, uint64_t id, bool owner) : page_(page), id_(id), owner_(owner) {}
+
+  static std::string Name(uint64_t id);
+
+  Page* page_;
+  uint64_t id_;
+  bool owner_;
+
+  DISALLOW_COPY_AND_ASSIGN(IPCDoorbell);
+};
+
 /// @brief Container for ipc signal abi block.
 class SharedMemorySignal {
  public:
@@ -106,7 +148,9 @@ class IPCSignal : private SharedMemorySignal, public BusyWaitSignal {
   static KernelMutex lock_;
 
   explicit IPCSignal(SharedMemorySignal&& abi_block)
-      : SharedMemorySignal(std::move(abi_block)), BusyWaitSignal(signal(), true) {}
+      : SharedMemorySignal(std::move(abi_block)), BusyWaitSignal(signal(), true) {
+    SetDoorbell(IPCDoorbell::Open(signal()));
+  }
 
   DISALLOW_COPY_AND_ASSIGN(IPCSignal);
 };
@@ -46,6 +46,7 @@
 #include <cassert>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
 #include "core/inc/amd_hsa_code.hpp"
@@ -174,10 +175,31 @@ class Isa final: public amd::hsa::common::Signed<0xB13594F2BD8F212D> {
   }
 
   /// @returns This Isa's processor name.
-  std::string GetProcessorName() const;
+  const std::string &GetProcessorName() const {
+    return processor_;
+  }
 
   /// @returns This Isa's name consisting of the target triple and target ID.
-  std::string GetIsaName() const;
+  const std::string &GetIsaName() const {
+    return name_;
+  }
+
+  /// @returns Registry interned id of this Isa's processor name, shared by all
+  /// feature variants of the processor.
+  uint32_t GetProcessorId() const {
+    return processor_id_;
+  }
+
+  /// @returns Interned processor id of this Isa's generic target, 0 if none.
+  uint32_t GetGenericProcessorId() const {
+    return generic_processor_id_;
+  }
+
+  /// @returns Minimum code object generic version accepted if this Isa is a
+  /// generic target, 0 otherwise.
+  unsigned GetMinGenericVersion() const {
+    return min_generic_version_;
+  }
 
   /// @brief Query value of requested @p attribute and record it in @p value.
   bool GetInfo(const hsa_isa_info_t &attribute, void *value) const;
@@ -193,12 +215,19 @@ class Isa final: public amd::hsa::common::Signed<0xB13594F2BD8F212D> {
   Isa()
       : version_(Version(-1, -1, -1)),
         sramecc_(IsaFeature::Unsupported),
-        xnack_(IsaFeature::Unsupported) {}
+        xnack_(IsaFeature::Unsupported),
+        processor_id_(0),
+        generic_processor_id_(0),
+        min_generic_version_(0) {}
   private:
 
   // @brief Isa's target ID name.
   std::string targetid_;
 
+  // @brief Isa's full name and processor name, built once at registration.
+  std::string name_;
+  std::string processor_;
+
   // @brief Isa's generic version, if it exists. "" otherwise.
   std::string generic_;
 
@@ -214,6 +243,12 @@ class Isa final: public amd::hsa::common::Signed<0xB13594F2BD8F212D> {
   /// @brief Isa's supported wavefront.
   Wavefront wavefront_;
 
+  /// @brief Interned identities, see GetProcessorId, GetGenericProcessorId and
+  /// GetMinGenericVersion.
+  uint32_t processor_id_;
+  uint32_t generic_processor_id_;
+  unsigned min_generic_version_;
+
   /// @brief Isa's friends.
   friend class IsaRegistry;
 }; // class Isa
@@ -223,7 +258,7 @@ class Isa final: public amd::hsa::common::Signed<0xB13594F2BD8F212D> {
 class IsaRegistry final {
  public:
   /// @returns Isa for requested @p full_name, null pointer if not supported.
-  static const Isa *GetIsa(const std::string &full_name);
+  static const Isa *GetIsa(std::string_view full_name);
 
   /// @returns Isa for requested @p version, null pointer if not supported.
   static const Isa *GetIsa(const Isa::Version &version,
@@ -243,6 +278,10 @@ class IsaRegistry final {
 
   /// @returns Supported instruction set architectures.
   static const IsaMap& GetSupportedIsas();
+
+  /// @returns Supported instruction set architectures keyed by views of their
+  /// names, so lookups need no std::string.
+  static const std::unordered_map<std::string_view, const Isa *> &GetIsaIndex();
 }; // class IsaRegistry
 
 } // namespace core
@@ -45,9 +45,12 @@
 #ifndef HSA_RUNTME_CORE_INC_MEMORY_REGION_H_
 #define HSA_RUNTME_CORE_INC_MEMORY_REGION_H_
 
+#include <atomic>
+#include <utility>
 #include <vector>
 
 #include "core/inc/hsa_internal.h"
+#include "inc/hsa_ext_amd.h"
 #include "core/inc/checked.h"
 #include "core/util/utils.h"
 
@@ -66,6 +69,10 @@ class MemoryRegion : public Checked<0x9C961F19EE175BB3> {
         user_visible_(user_visible),
         owner_(owner) {
     assert(owner_ != NULL);
+    for (int i = 0; i < HSA_AMD_MEMORY_USAGE_COUNT; i++) {
+      usage_bytes_[i] = 0;
+      usage_count_[i] = 0;
+    }
   }
 
   virtual ~MemoryRegion() {}
@@ -106,6 +113,9 @@ class MemoryRegion : public Checked<0x9C961F19EE175BB3> {
     AllocateGTTAccess = (1 << 9),
     AllocateContiguous = (1 << 10), // Physically contiguous memory
     AllocateUncached = (1 << 11),   // Uncached memory
+    AllocateHugePage = (1 << 12),   // Huge page backed system memory
+    AllocateLargePage = (1 << 13),  // Contiguous, 2MB aligned VRAM for large GPU PTE fragments
+    AllocateCoarseGrain = (1 << 14),  // Coarse grain memory from a fine grain region
   };
 
   typedef uint32_t AllocateFlags;
@@ -114,6 +124,10 @@ class MemoryRegion : public Checked<0x9C961F19EE175BB3> {
 
   virtual hsa_status_t Free(void* address, size_t size) const = 0;
 
+  // Frees several allocations of this region, returning those which failed in failed.
+  virtual void FreeBatch(const std::vector<std::pair<void*, size_t>>& blocks,
+                         std::vector<void*>& failed) const = 0;
+
   // Prepares suballocated memory for IPC export.
   virtual hsa_status_t IPCFragmentExport(void* address) const = 0;
 
@@ -127,6 +141,18 @@ class MemoryRegion : public Checked<0x9C961F19EE175BB3> {
   // Releases any cached memory that may be held within the allocator.
   virtual void Trim() const {}
 
+  // Releases cached memory which has gone unused for at least idle_ms.
+  virtual void TrimIdle(uint64_t idle_ms) const {}
+
+  // Sets aside size bytes for later allocations, see hsa_amd_memory_pool_reserve.
+  virtual hsa_status_t Reserve(size_t size) const {
+    return static_cast<hsa_status_t>(HSA_STATUS_ERROR_INVALID_MEMORY_POOL);
+  }
+
+  virtual hsa_status_t ReleaseReservation() const {
+    return static_cast<hsa_status_t>(HSA_STATUS_ERROR_INVALID_MEMORY_POOL);
+  }
+
   __forceinline bool fine_grain() const { return fine_grain_; }
 
   __forceinline bool extended_scope_fine_grain() const { return extended_scope_fine_grain_; }
@@ -139,6 +165,23 @@ class MemoryRegion : public Checked<0x9C961F19EE175BB3> {
 
   __forceinline core::Agent* owner() const { return owner_; }
 
+  // Accounts allocations of this region made through Runtime::AllocateMemory.  Negative values
+  // account frees.
+  __forceinline void AddUsage(hsa_amd_memory_usage_category_t category, int64_t bytes,
+                              int64_t count) const {
+    usage_bytes_[category].fetch_add(bytes, std::memory_order_relaxed);
+    usage_count_[category].fetch_add(count, std::memory_order_relaxed);
+  }
+
+  // Snapshot of the accounted usage.  Categories not allocated through Runtime::AllocateMemory are
+  // left for the region to fill in.
+  void GetUsage(hsa_amd_memory_pool_usage_t* usage) const {
+    for (int i = 0; i < HSA_AMD_MEMORY_USAGE_COUNT; i++) {
+      usage->bytes[i] = usage_bytes_[i].load(std::memory_order_relaxed);
+      usage->count[i] = usage_count_[i].load(std::memory_order_relaxed);
+    }
+  }
+
  private:
   const bool fine_grain_;
   const bool kernarg_;
@@ -147,6 +190,9 @@ class MemoryRegion : public Checked<0x9C961F19EE175BB3> {
   const bool user_visible_;
 
   core::Agent* owner_;
+
+  mutable std::atomic<int64_t> usage_bytes_[HSA_AMD_MEMORY_USAGE_COUNT];
+  mutable std::atomic<int64_t> usage_count_[HSA_AMD_MEMORY_USAGE_COUNT];
 };
 }  // namespace core
 }  // namespace rocr
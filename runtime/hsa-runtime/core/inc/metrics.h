@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// Runtime-internal counters and histograms.
+
+#ifndef HSA_RUNTIME_CORE_INC_METRICS_H_
+#define HSA_RUNTIME_CORE_INC_METRICS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <string>
+
+#include "inc/hsa_ext_amd.h"
+#include "core/util/os.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace core {
+
+/// @brief Process wide counters and log2 histograms of runtime hot paths.
+///
+/// Each thread updates a block of its own, so an update is an uncontended relaxed load and store.
+/// Readers sum the blocks of live threads with the totals folded in by threads that have exited.
+class Metrics {
+ public:
+  static const uint32_t kBuckets = HSA_AMD_RUNTIME_HISTOGRAM_BUCKETS;
+
+  static __forceinline void Count(hsa_amd_runtime_counter_t counter, uint64_t n = 1) {
+    Bump(Local().counters[counter], n);
+  }
+
+  static __forceinline void Record(hsa_amd_runtime_histogram_t histogram, uint64_t value) {
+    Bump(Local().histograms[histogram][Bucket(value)], 1);
+  }
+
+  /// @brief Histogram bucket of value, see HSA_AMD_RUNTIME_HISTOGRAM_BUCKETS.
+  static __forceinline uint32_t Bucket(uint64_t value) {
+    if (value == 0) return 0;
+    return Min<uint32_t>(64 - __builtin_clzll(value), kBuckets - 1);
+  }
+
+  /// @brief Sums all threads' blocks into metrics.
+  static void Snapshot(hsa_amd_runtime_metrics_t* metrics);
+
+  /// @brief Writes the non-zero counters and histogram buckets as text.
+  static void Dump(FILE* file);
+
+ private:
+  struct Block {
+    std::atomic<uint64_t> counters[HSA_AMD_RUNTIME_COUNTER_COUNT];
+    std::atomic<uint64_t> histograms[HSA_AMD_RUNTIME_HISTOGRAM_COUNT][kBuckets];
+  };
+
+  // Registers the calling thread's block and folds it into the retired totals at thread exit.
+  struct ThreadBlock {
+    ThreadBlock();
+    ~ThreadBlock();
+    Block* block;
+  };
+
+  static __forceinline Block& Local() {
+    static thread_local ThreadBlock local;
+    return *local.block;
+  }
+
+  // Only the owning thread writes a block, so no atomic read-modify-write is needed.
+  static __forceinline void Bump(std::atomic<uint64_t>& value, uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+};
+
+/// @brief Periodically appends Metrics::Dump output to the file named by HSA_METRICS_DUMP.
+class MetricsDumper {
+ public:
+  MetricsDumper();
+  ~MetricsDumper();
+
+ private:
+  static void DumpRun(void* dumper);
+  void DumpLoop();
+
+  FILE* file_;
+  os::Thread thread_;
+  os::EventHandle event_;
+  std::atomic<bool> exit_;
+
+  DISALLOW_COPY_AND_ASSIGN(MetricsDumper);
+};
+
+}  // namespace core
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_METRICS_H_
@@ -50,6 +50,7 @@
 #include "core/common/shared.h"
 #include "core/inc/checked.h"
 #include "core/inc/memory_region.h"
+#include "core/util/locks.h"
 #include "core/util/utils.h"
 #include "inc/amd_hsa_queue.h"
 #include "inc/hsa_ext_amd.h"
@@ -156,6 +157,9 @@ class Queue;
 struct SharedQueue {
   amd_queue_t amd_queue;
   Queue* core_queue;
+  // Set when the write index is amd_queue.write_dispatch_id alone, so adding to it needs no call
+  // into core_queue.
+  bool direct_write_index;
 };
 
 class LocalQueue {
@@ -180,14 +184,22 @@ class Queue : public Checked<0xFA3906A679F9DB49>, private LocalQueue {
  public:
   Queue(int mem_flags = 0) : LocalQueue(mem_flags), amd_queue_(queue()->amd_queue) {
     queue()->core_queue = this;
+    queue()->direct_write_index = false;
     public_handle_ = Convert(this);
     pcie_write_ordering_ = false;
+    device_ring_ = false;
+    doorbell_requested_ = 0;
+    doorbell_rung_ = 0;
   }
 
   Queue(int agent_node_id, int mem_flags) : LocalQueue(agent_node_id, mem_flags), amd_queue_(queue()->amd_queue) {
     queue()->core_queue = this;
+    queue()->direct_write_index = false;
     public_handle_ = Convert(this);
     pcie_write_ordering_ = false;
+    device_ring_ = false;
+    doorbell_requested_ = 0;
+    doorbell_rung_ = 0;
   }
 
   virtual ~Queue() {}
@@ -216,6 +228,18 @@ class Queue : public Checked<0xFA3906A679F9DB49>, private LocalQueue {
         : nullptr;
   }
 
+  /// @brief Adds to queue's write index without the core object when its owner allows it.
+  /// Returns false, leaving the index alone, if the add must go through Convert.
+  static __forceinline bool AddWriteIndexDirect(const hsa_queue_t* queue, uint64_t value,
+                                                std::memory_order order, uint64_t* old) {
+    if (queue == nullptr) return false;
+    SharedQueue* shared = reinterpret_cast<SharedQueue*>(
+        reinterpret_cast<uintptr_t>(queue) - offsetof(SharedQueue, amd_queue.hsa_queue));
+    if (!shared->direct_write_index) return false;
+    *old = atomic::Add(&shared->amd_queue.write_dispatch_id, value, order);
+    return true;
+  }
+
   /// @brief Inactivate the queue object. Once inactivate a
   /// queue cannot be used anymore and must be destroyed
   ///
@@ -225,6 +249,10 @@ class Queue : public Checked<0xFA3906A679F9DB49>, private LocalQueue {
   /// @brief Change the scheduling priority of the queue
   virtual hsa_status_t SetPriority(HSA_QUEUE_PRIORITY priority) = 0;
 
+  /// @brief Deschedules the queue, preserving its state, or schedules it again.  Packets may be
+  /// written while the queue is suspended.
+  virtual hsa_status_t SetSuspended(bool suspended) { return HSA_STATUS_ERROR_INVALID_QUEUE; }
+
   /// @brief Reads the Read Index of Queue using Acquire semantics
   ///
   /// @return uint64_t Value of Read index
@@ -347,6 +375,17 @@ class Queue : public Checked<0xFA3906A679F9DB49>, private LocalQueue {
   /// @return hsa_status_t
   virtual hsa_status_t GetCUMasking(uint32_t num_cu_mask_count, uint32_t* cu_mask) = 0;
 
+  /// @brief Set the CU mask of dispatches that follow in the queue
+  ///
+  /// @param num_cu_mask_count size of mask bit array, 0 returns to the queue's CU mask
+  ///
+  /// @param cu_mask pointer to cu mask
+  ///
+  /// @return hsa_status_t
+  virtual hsa_status_t SetDispatchCUMasking(uint32_t num_cu_mask_count, const uint32_t* cu_mask) {
+    return HSA_STATUS_ERROR_INVALID_QUEUE;
+  }
+
   /// @brief Submits a block of PM4.
   ///
   /// @param cmd_data pointer to command buffer
@@ -374,6 +413,36 @@ class Queue : public Checked<0xFA3906A679F9DB49>, private LocalQueue {
   /// @ brief Returns queue queries about the queue
   virtual hsa_status_t GetInfo(hsa_queue_info_attribute_t attribute, void* value) = 0;
 
+  /// @brief Allocates kernarg memory for the packet at packet_id from a ring owned by the queue.
+  /// The memory is reclaimed once the read index has moved past packet_id.
+  virtual hsa_status_t AllocKernarg(size_t size, size_t alignment, uint64_t packet_id,
+                                    void** kernarg_address) {
+    return HSA_STATUS_ERROR_INVALID_QUEUE;
+  }
+
+  /// @brief Allocates a ring of record_count dispatch timestamp records and enables profiling.
+  virtual hsa_status_t EnableDispatchTimestamps(uint32_t record_count) {
+    return HSA_STATUS_ERROR_INVALID_QUEUE;
+  }
+
+  /// @brief Hands out the next timestamp record as a completion signal for the packet at
+  /// packet_id.
+  virtual hsa_status_t AllocDispatchTimestamp(uint64_t packet_id, hsa_signal_t* signal) {
+    return HSA_STATUS_ERROR_INVALID_QUEUE;
+  }
+
+  /// @brief Copies out and releases completed timestamp records, oldest first.
+  virtual hsa_status_t ReadDispatchTimestamps(uint32_t max_records,
+                                              hsa_amd_dispatch_timestamp_t* records,
+                                              uint32_t* record_count, uint64_t* dropped) {
+    return HSA_STATUS_ERROR_INVALID_QUEUE;
+  }
+
+  /// @brief Writes count AQL packets to consecutive slots reserved with a single write index
+  /// update, publishes their headers in order and rings the doorbell once for the batch.
+  /// Doorbell rings from concurrent producers are coalesced.
+  virtual hsa_status_t SubmitBatch(const void* packets, uint32_t count, uint64_t* first_index);
+
   /// @ brief Reports async queue errors to stderr if no other error handler was registered.
   static void DefaultErrorHandler(hsa_status_t status, hsa_queue_t* source, void* data);
 
@@ -390,6 +459,18 @@ class Queue : public Checked<0xFA3906A679F9DB49>, private LocalQueue {
 
   void setPcieOrdering(bool val) { pcie_write_ordering_ = val; }
 
+  /// @brief True if the ring buffer is in device memory mapped write-combined on the host.
+  bool deviceRing() const { return device_ring_; }
+
+  void setDeviceRing(bool val) { device_ring_ = val; }
+
+  /// @brief Lets AddWriteIndexDirect update the write index for this queue.
+  void setDirectWriteIndex(bool val) { queue()->direct_write_index = val; }
+
+  /// @brief True if host writes to the ring must be fenced before the header and doorbell stores.
+  /// Write-combined stores over PCIe may otherwise reach the device out of order.
+  bool needsRingFence() const { return device_ring_ && !pcie_write_ordering_; }
+
  protected:
   static void set_public_handle(Queue* ptr, hsa_queue_t* handle) {
     ptr->do_set_public_handle(handle);
@@ -412,6 +493,14 @@ class Queue : public Checked<0xFA3906A679F9DB49>, private LocalQueue {
 
   bool pcie_write_ordering_;
 
+  bool device_ring_;
+
+  // Highest end index a SubmitBatch producer has asked to be rung and the highest rung so far.
+  std::atomic<uint64_t> doorbell_requested_;
+  std::atomic<uint64_t> doorbell_rung_;
+  // Serializes doorbell stores so the packet processor never sees the write index go back.
+  SpinMutex doorbell_lock_;
+
   DISALLOW_COPY_AND_ASSIGN(Queue);
 };
 }   //  namespace core
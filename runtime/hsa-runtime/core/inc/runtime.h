@@ -45,7 +45,10 @@
 #ifndef HSA_RUNTME_CORE_INC_RUNTIME_H_
 #define HSA_RUNTME_CORE_INC_RUNTIME_H_
 
+#include <atomic>
 #include <vector>
+#include <deque>
+#include <list>
 #include <map>
 #include <memory>
 #include <tuple>
@@ -70,6 +73,9 @@
 #include "core/inc/memory_region.h"
 #include "core/inc/signal.h"
 #include "core/inc/svm_profiler.h"
+#include "core/inc/metrics.h"
+#include "core/inc/timeline.h"
+#include "core/util/address_map.h"
 #include "core/util/flag.h"
 #include "core/util/locks.h"
 #include "core/util/os.h"
@@ -124,6 +130,23 @@ class Runtime {
     hsa_amd_memory_pool_link_info_t info;
   };
 
+  /// @brief Attributes allocations made on this thread through AllocateMemory to a usage category
+  /// of the pool while in scope.  The outermost scope wins, so generic internal allocators can set
+  /// a fallback without hiding their caller's category.
+  class MemoryUsageScope {
+   public:
+    explicit MemoryUsageScope(hsa_amd_memory_usage_category_t category) : prior_(current_) {
+      if (current_ == HSA_AMD_MEMORY_USAGE_USER) current_ = category;
+    }
+    ~MemoryUsageScope() { current_ = prior_; }
+
+    static hsa_amd_memory_usage_category_t current() { return current_; }
+
+   private:
+    hsa_amd_memory_usage_category_t prior_;
+    static thread_local hsa_amd_memory_usage_category_t current_;
+  };
+
   struct KfdVersion_t {
     HsaVersionInfo version;
     bool supports_exception_debugging;
@@ -138,7 +161,8 @@ class Runtime {
   static hsa_status_t Release();
 
   /// @brief Checks if connection to kernel driver is opened.
-  /// @retval True if the connection to kernel driver is opened.
+  /// @retval True if the connection to kernel driver is opened.  False in a forked child until
+  /// it initializes its own runtime.
   static bool IsOpen();
 
   // @brief Callback handler for HW Exceptions.
@@ -153,6 +177,10 @@ class Runtime {
   /// @brief Singleton object of the runtime.
   static Runtime* runtime_singleton_;
 
+  /// @brief Set in a forked child, with flag().fork_safe(), while runtime_singleton_ still
+  /// belongs to the parent.
+  static std::atomic<bool> forked_;
+
   /// @brief Insert agent into agent list ::agents_.
   /// @param [in] agent Pointer to the agent object.
   void RegisterAgent(Agent* agent, bool Enabled);
@@ -186,6 +214,43 @@ class Runtime {
   /// @retval The link information between source and destination nodes.
   const LinkInfo GetLinkInfo(uint32_t node_id_from, uint32_t node_id_to);
 
+  /// @brief All-pairs routes between CPU and GPU agents and the host resources nearest each GPU.
+  struct Topology {
+    struct Nearest {
+      Agent* gpu;
+      Agent* cpu;
+      int32_t numa_node;
+      uint32_t first_core;
+      uint32_t num_cores;
+      uint32_t first_nic;
+      uint32_t num_nics;
+    };
+
+    std::vector<Agent*> agents;
+    // Row major agents.size() squared matrices, see hsa_amd_topology_t.
+    std::vector<uint32_t> hops;
+    std::vector<uint32_t> numa_distance;
+    std::vector<uint32_t> bandwidth;
+    std::vector<uint32_t> latency;
+    std::vector<Nearest> nearest;
+    std::vector<uint32_t> cores;
+    std::vector<hsa_amd_topology_nic_t> nics;
+  };
+
+  /// @brief Derives topology() from the link matrix.  Called once agents are registered.
+  void BuildTopologyMatrix();
+
+  const Topology& topology() const { return topology_; }
+
+  /// @brief Creates a runtime internal thread placed and scheduled per the policy of its class.
+  /// @param [in] gpu GPU the thread serves, NULL if it is not tied to one.
+  os::Thread CreateThread(hsa_amd_thread_class_t thread_class, os::ThreadEntry entry, void* arg,
+                          const Agent* gpu = nullptr);
+
+  /// @brief Replaces the policy of a class of internal threads and applies it to live ones.
+  hsa_status_t SetThreadPolicy(hsa_amd_thread_class_t thread_class,
+                               const hsa_amd_thread_policy_t* policy);
+
   /// @brief Invoke the user provided call back for each agent in the agent
   /// list.
   ///
@@ -219,6 +284,40 @@ class Runtime {
   /// @retval ::HSA_STATUS_SUCCESS if @p ptr is successfully released.
   hsa_status_t FreeMemory(void* ptr);
 
+  /// @brief Allocate memory on a region, preferring blocks parked by FreeMemoryAsync whose release
+  /// has retired or is @p dependency, which the caller orders the new allocation's use after.
+  ///
+  /// @param [in] dependency Signal ordering use of the allocation, may be null.
+  hsa_status_t AllocateMemoryAsync(const MemoryRegion* region, size_t size,
+                                   MemoryRegion::AllocateFlags alloc_flags, Signal* dependency,
+                                   void** address);
+
+  /// @brief Free memory previously allocated with AllocateMemory once @p release completes.
+  /// The block is parked in a per region reuse cache until then.
+  ///
+  /// @param [in] release Signal completing the last use of @p ptr, may be null.
+  hsa_status_t FreeMemoryAsync(void* ptr, Signal* release);
+
+  /// @brief Allocate @p count buffers on a region and grant @p agents access to all of them in one
+  /// call, see hsa_amd_memory_pool_allocate_batch.  Buffers are released with FreeMemory.
+  ///
+  /// @param [in] shared_block Carve the buffers from a single allocation, released with the last
+  /// buffer.
+  hsa_status_t AllocateMemoryBatch(const MemoryRegion* region, size_t count, const size_t* sizes,
+                                   MemoryRegion::AllocateFlags alloc_flags, bool shared_block,
+                                   uint32_t num_agents, const hsa_agent_t* agents, void** ptrs);
+
+  hsa_status_t RegisterMemoryPressureCallback(hsa_amd_memory_pressure_callback_t callback,
+                                              void* data);
+
+  hsa_status_t DeregisterMemoryPressureCallback(hsa_amd_memory_pressure_callback_t callback,
+                                                void* data);
+
+  /// @brief Releases runtime caches, cheapest to rebuild first, until @p size bytes of
+  /// @p agent's memory are available, then invokes memory pressure callbacks.
+  /// Must not be called with @p agent's agent_memory_lock_ held.
+  void RelieveMemoryPressure(Agent* agent, size_t size, hsa_amd_memory_pressure_level_t level);
+
   hsa_status_t RegisterReleaseNotifier(void* ptr, hsa_amd_deallocation_callback_t callback,
                                        void* user_data);
 
@@ -255,6 +354,40 @@ class Runtime {
                           core::Agent* src_agent, size_t size,
                           std::vector<core::Signal*>& dep_signals, core::Signal& completion_signal);
 
+  /// @brief Non-blocking batch of memory copies between one agent pair.
+  ///
+  /// @details All semantics and params are identical to CopyMemory except
+  /// that @p completion_signal is decremented once, after every copy in
+  /// @p copies is done.
+  hsa_status_t CopyMemoryBatch(const hsa_amd_memory_copy_descriptor_t* copies, uint32_t count,
+                               core::Agent* dst_agent, core::Agent* src_agent,
+                               std::vector<core::Signal*>& dep_signals,
+                               core::Signal& completion_signal);
+
+  /// @brief Non-blocking copy of strided blocks between one agent pair.
+  ///
+  /// @details All semantics and params are identical to CopyMemoryBatch
+  /// except that each descriptor is a strided block.
+  hsa_status_t CopyMemoryStrided(const hsa_amd_memory_copy_strided_t* blocks, uint32_t count,
+                                 core::Agent* dst_agent, core::Agent* src_agent,
+                                 std::vector<core::Signal*>& dep_signals,
+                                 core::Signal& completion_signal);
+
+  /// @brief Non-blocking copy of device memory through pinned staging chunks,
+  /// handing each chunk to @p callback in order as it lands.
+  ///
+  /// @param [in] src Device memory to read.
+  /// @param [in] src_agent GPU owning @p src.
+  /// @param [in] size Number of bytes to read.
+  /// @param [in] callback Consumer of each chunk, run on the async signal handler thread.
+  /// @param [in] user_data Passed to @p callback.
+  /// @param [in] dep_signals Signals to wait on before the first chunk is read.
+  /// @param [in] completion_signal Decremented after the last callback returns.
+  hsa_status_t CopyMemoryStream(const void* src, core::Agent* src_agent, size_t size,
+                                hsa_amd_copy_stream_callback_t callback, void* user_data,
+                                std::vector<core::Signal*>& dep_signals,
+                                core::Signal& completion_signal);
+
   /// @brief Non-blocking memory copy from src to dst on engine_id.
   ///
   /// @details All semantics and params are dentical to CopyMemory
@@ -271,7 +404,23 @@ class Runtime {
   hsa_status_t CopyMemoryOnEngine(void* dst, core::Agent* dst_agent, const void* src,
                           core::Agent* src_agent, size_t size,
                           std::vector<core::Signal*>& dep_signals, core::Signal& completion_signal,
-                          hsa_amd_sdma_engine_id_t  engine_id, bool force_copy_on_sdma);
+                          hsa_amd_sdma_engine_id_t  engine_id, bool force_copy_on_sdma,
+                          hsa_amd_queue_priority_t priority = HSA_AMD_QUEUE_PRIORITY_NORMAL);
+
+  /// @brief Submit a copy split across several SDMA engines.
+  ///
+  /// @details All semantics and params are identical to CopyMemory
+  ///  with the exception of policy.
+  ///
+  /// @param [in] policy Number of engines and leader selection.
+  ///
+  /// @retval ::HSA_STATUS_SUCCESS if copy command has been submitted
+  /// successfully to the agent DMA queues.
+  hsa_status_t CopyMemoryGang(void* dst, core::Agent* dst_agent, const void* src,
+                              core::Agent* src_agent, size_t size,
+                              std::vector<core::Signal*>& dep_signals,
+                              core::Signal& completion_signal,
+                              const hsa_amd_gang_copy_policy_t& policy);
 
   /// @brief Return SDMA availability status for copy direction
   ///
@@ -284,6 +433,14 @@ class Runtime {
   hsa_status_t CopyMemoryStatus(core::Agent* dst_agent, core::Agent* src_agent,
                                 uint32_t *engine_ids_mask);
 
+  /// @brief Rank the SDMA engines for a copy direction and report the link.
+  ///
+  /// @param [in] dst_agent Destination agent.
+  /// @param [in] src_agent Source agent.
+  /// @param [out] hints Ranked engines and link bandwidth.
+  hsa_status_t CopyEngineHints(core::Agent* dst_agent, core::Agent* src_agent,
+                               hsa_amd_copy_engine_hints_t* hints);
+
   /// @brief Fill the first @p count of uint32_t in ptr with value.
   ///
   /// @param [in] ptr Memory address to be filled.
@@ -293,6 +450,21 @@ class Runtime {
   /// @retval ::HSA_STATUS_SUCCESS if memory fill is successful and completed.
   hsa_status_t FillMemory(void* ptr, uint32_t value, size_t count);
 
+  /// @brief Non-blocking fill of @p count copies of a @p pattern_size byte
+  /// pattern at ptr.
+  ///
+  /// @param [in] ptr Memory address to be filled.
+  /// @param [in] pattern Pattern of 1, 2, 4, 8 or 16 bytes.
+  /// @param [in] pattern_size Size of @p pattern in bytes.
+  /// @param [in] count Number of patterns to write.
+  /// @param [in] dep_signals Signals to wait on before the fill.
+  /// @param [in] completion_signal Signal decremented once the fill is done.
+  ///
+  /// @retval ::HSA_STATUS_SUCCESS if the fill has been submitted.
+  hsa_status_t FillMemoryAsync(void* ptr, const void* pattern, uint32_t pattern_size,
+                               size_t count, std::vector<core::Signal*>& dep_signals,
+                               core::Signal& completion_signal);
+
   /// @brief Set agents as the whitelist to access ptr.
   ///
   /// @param [in] num_agents The number of agent handles in @p agents array.
@@ -305,6 +477,15 @@ class Runtime {
   hsa_status_t AllowAccess(uint32_t num_agents, const hsa_agent_t* agents,
                            const void* ptr);
 
+  /// @brief Allow agents access to a batch of allocations.  Allocations are grouped by memory
+  /// region and each group is mapped in as few driver calls as possible.
+  ///
+  /// @param [in] num_ptrs The number of pointers in @p ptrs array.
+  /// @param [in] ptrs Pointers of memory previously allocated via
+  /// core::Runtime::AllocateMemory or mapped via VMM.
+  hsa_status_t AllowAccess(uint32_t num_agents, const hsa_agent_t* agents, uint32_t num_ptrs,
+                           const void* const* ptrs);
+
   /// @brief Query system information.
   ///
   /// @param [in] attribute System info attribute to query.
@@ -323,12 +504,15 @@ class Runtime {
   /// comparison satisfy @p cond, the @p handler will be called.
   /// @param [in] arg Pointer to the argument that will be provided to @p
   /// handler.
+  /// @param [in] dedicated Service @p handler on the thread reserved for
+  /// latency critical handlers instead of the signal's shard.
   ///
   /// @retval ::HSA_STATUS_SUCCESS Registration is successful.
   hsa_status_t SetAsyncSignalHandler(hsa_signal_t signal,
                                      hsa_signal_condition_t cond,
                                      hsa_signal_value_t value,
-                                     hsa_amd_signal_handler handler, void* arg);
+                                     hsa_amd_signal_handler handler, void* arg,
+                                     bool dedicated = false);
 
   hsa_status_t InteropMap(uint32_t num_agents, Agent** agents,
                           int interop_handle, uint32_t flags, size_t* size,
@@ -337,6 +521,9 @@ class Runtime {
 
   hsa_status_t InteropUnmap(void* ptr);
 
+  /// @brief Drops cached mappings of a graphics buffer, or of all buffers for handle -1.
+  hsa_status_t InteropCacheInvalidate(int interop_handle);
+
   struct PtrInfoBlockData {
     void* base;
     size_t length;
@@ -349,11 +536,23 @@ class Runtime {
 
   hsa_status_t SetPtrInfoData(const void* ptr, void* userptr);
 
+  /// @brief Mark a device memory allocation as never written by the CPU.
+  ///
+  /// @param [in] ptr Base of an allocation made with AllocateMemory.
+  /// @param [in] device_only Whether the CPU does not write the allocation.
+  hsa_status_t SetDeviceOnly(void* ptr, bool device_only);
+
   hsa_status_t IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* handle);
 
   hsa_status_t IPCAttach(const hsa_amd_ipc_memory_t* handle, size_t len, uint32_t num_agents,
                          Agent** mapping_agents, void** mapped_ptr);
 
+  /// @brief Attaches many IPC handles, fetching the DMA buf FDs of each exporting process
+  /// in a single socket round trip.
+  hsa_status_t IPCAttachBatch(const hsa_amd_ipc_memory_t* handles, const size_t* lens,
+                              uint32_t count, uint32_t num_agents, Agent** mapping_agents,
+                              void** mapped_ptrs);
+
   hsa_status_t IPCDetach(void* ptr);
 
   hsa_status_t SetSvmAttrib(void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list,
@@ -362,11 +561,30 @@ class Runtime {
   hsa_status_t GetSvmAttrib(void* ptr, size_t size, hsa_amd_svm_attribute_pair_t* attribute_list,
                             size_t attribute_count);
 
+  /// @brief Drops cached SVM attributes of query ranges overlapping [ptr, ptr + size).
+  void InvalidateSvmAttribs(uint64_t ptr, uint64_t size);
+
   hsa_status_t SvmPrefetch(void* ptr, size_t size, hsa_agent_t agent, uint32_t num_dep_signals,
                            const hsa_signal_t* dep_signals, hsa_signal_t completion_signal);
 
+  /// @brief Prefetches several ranges under one dependency set and completion signal.  Ranges
+  /// are resolved in order and coalesced per destination before reaching KFD.
+  hsa_status_t SvmPrefetchBatch(const hsa_amd_svm_prefetch_range_t* ranges, size_t range_count,
+                                uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                hsa_signal_t completion_signal);
+
+  /// @brief Migrates an SVM range to the memory of region's owner through the prefetch path.
+  /// Fails for ranges overlapping runtime allocations, whose backing can not move.
+  hsa_status_t MigrateAsync(void* ptr, size_t size, const MemoryRegion* region,
+                            uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                            hsa_signal_t completion_signal);
+
   hsa_status_t DmaBufExport(const void* ptr, size_t size, int* dmabuf, uint64_t* offset);
 
+  /// @brief Exports count ranges of one allocation as a single dma-buf.
+  hsa_status_t DmaBufExportRanges(const void* const* ptrs, const size_t* sizes, size_t count,
+                                  int* dmabuf, uint64_t* offsets);
+
   hsa_status_t DmaBufClose(int dmabuf);
 
   hsa_status_t VMemoryAddressReserve(void** ptr, size_t size, uint64_t address, uint64_t alignment, uint64_t flags);
@@ -379,14 +597,73 @@ class Runtime {
 
   hsa_status_t VMemoryHandleRelease(hsa_amd_vmem_alloc_handle_t memoryHandle);
 
+  /// @brief Frees cached memory handles owned by @p agent, or all of them if @p agent is null.
+  /// May be called with the owner's agent_memory_lock_ held.
+  void VMemoryHandleCacheTrim(const Agent* agent);
+
+  /// @brief Frees blocks parked by FreeMemoryAsync whose release has retired until at most
+  /// @p limit bytes remain cached.
+  void AsyncFreeCacheTrim(size_t limit);
+
+  /// @brief Raises a memory error event for memory the driver failed to free.
+  void FreeFailed(const MemoryRegion* region, void* ptr);
+
+  /// @brief Starts the thread releasing memory freed with flag().deferred_free() set, and
+  /// delivering callbacks with flag().deferred_free_notify() set.
+  void StartDeferredFree();
+
+  /// @brief Stops the deferred free thread and releases anything still queued.
+  void StopDeferredFree();
+
+  static void DeferredFreeRun(void* runtime);
+  void DeferredFreeLoop();
+
+  /// @brief pthread_atfork handlers installed with flag().fork_safe().
+  static void PrepareFork();
+  static void ParentFork();
+  static void ChildFork();
+
+  /// @brief Drops the runtime inherited from the parent in a forked child.  It is abandoned
+  /// rather than unloaded since its threads do not exist in the child and its driver state
+  /// belongs to the parent.  Requires bootstrap_lock().
+  static void DropForkedRuntime();
+
+  /// @brief Releases memory queued for deferred free and held in runtime caches during Unload.
+  /// Only queued frees are completed with flag().fast_shutdown().
+  void ReleaseCachedMemory();
+
+  static void ReleaseCachedMemoryRun(void* runtime);
+
+  /// @brief Deletes @p agents concurrently, one thread per agent, and clears the list.
+  void DeleteAgents(std::vector<Agent*>& agents);
+
+  /// @brief Starts the thread watching GPU free memory against flag().memory_pressure_watermark()
+  /// and releasing fragment blocks idle for flag().fragment_cache_idle_ms().
+  void StartMemoryPressureMonitor();
+
+  void StopMemoryPressureMonitor();
+
+  static void MemoryPressureMonitorRun(void* runtime);
+  void MemoryPressureMonitor();
+
   hsa_status_t VMemoryHandleMap(void* va, size_t size, size_t in_offset,
                                 hsa_amd_vmem_alloc_handle_t memoryHandle, uint64_t flags);
 
+  /// @brief Maps many handles under a single acquisition of the memory lock.  Either all
+  /// entries are mapped or none.
+  hsa_status_t VMemoryHandleMapBatch(const hsa_amd_vmem_map_desc_t* maps, size_t map_cnt,
+                                     uint64_t flags);
+
   hsa_status_t VMemoryHandleUnmap(void* va, size_t size);
 
   hsa_status_t VMemorySetAccess(void* va, size_t size, const hsa_amd_memory_access_desc_t* desc,
                                 size_t desc_cnt);
 
+  /// @brief Applies the same access descriptors to many mapped ranges under a single
+  /// acquisition of the memory lock.
+  hsa_status_t VMemorySetAccessBatch(const hsa_amd_vmem_range_t* ranges, size_t range_cnt,
+                                     const hsa_amd_memory_access_desc_t* desc, size_t desc_cnt);
+
   hsa_status_t VMemoryGetAccess(const void* va, hsa_access_permission_t* perms,
                                 hsa_agent_t agent_handle);
 
@@ -403,6 +680,14 @@ class Runtime {
                                                    const core::MemoryRegion** mem_region,
                                                    hsa_amd_memory_type_t* type);
 
+  /// @brief Backs @p size bytes of new address space with @p granularity sized stripes taken from
+  /// @p regions in round robin order, see hsa_amd_memory_pool_allocate_interleaved.
+  hsa_status_t InterleavedAllocate(const std::vector<const MemoryRegion*>& regions, size_t size,
+                                   size_t granularity, const hsa_amd_memory_access_desc_t* desc,
+                                   size_t desc_cnt, void** ptr);
+
+  hsa_status_t InterleavedFree(void* ptr);
+
   hsa_status_t EnableLogging(uint8_t* flags, void* file);
 
   const std::vector<Agent*>& cpu_agents() { return cpu_agents_; }
@@ -444,11 +729,16 @@ class Runtime {
 
   const Flag& flag() const { return flag_; }
 
+  AMD::SvmProfileControl* svm_profile() const { return svm_profile_.get(); }
+
   ExtensionEntryPoints extensions_;
 
   hsa_status_t SetCustomSystemEventHandler(hsa_amd_system_event_callback_t callback,
                                            void* data);
 
+  /// @brief Copies up to @p count of the most recent fault records, oldest first.
+  hsa_status_t GetFaultRecords(hsa_amd_gpu_fault_record_t* records, uint32_t* count);
+
   hsa_status_t SetInternalQueueCreateNotifier(hsa_amd_runtime_queue_notifier callback,
                                               void* user_data);
 
@@ -460,6 +750,14 @@ class Runtime {
 
   uint64_t sys_clock_freq() const { return sys_clock_freq_; }
 
+  // Record the start/end of an hsa_init phase in the system timestamp domain.
+  void InitPhaseBegin(hsa_amd_init_phase_t phase) {
+    init_phases_.start[phase] = os::ReadSystemClock();
+  }
+  void InitPhaseEnd(hsa_amd_init_phase_t phase) {
+    init_phases_.end[phase] = os::ReadSystemClock();
+  }
+
   void KfdVersion(const HsaVersionInfo& version) {
     kfd_version.version = version;
     if (version.KernelInterfaceMajorVersion == 1 &&
@@ -505,14 +803,25 @@ class Runtime {
           size_requested(0),
           alloc_flags(core::MemoryRegion::AllocateNoFlags),
           user_ptr(nullptr),
-          ldrm_bo(NULL) {}
+          ldrm_bo(NULL),
+          parked(false),
+          usage(HSA_AMD_MEMORY_USAGE_USER),
+          batch_base(nullptr),
+          host_writable(false),
+          device_only(false) {}
     AllocationRegion(const MemoryRegion* region_arg, size_t size_arg, size_t size_requested,
                      MemoryRegion::AllocateFlags alloc_flags)
         : region(region_arg),
           size(size_arg),
           size_requested(size_requested),
           alloc_flags(alloc_flags),
-          user_ptr(nullptr) {}
+          user_ptr(nullptr),
+          ldrm_bo(NULL),
+          parked(false),
+          usage(HSA_AMD_MEMORY_USAGE_USER),
+          batch_base(nullptr),
+          host_writable(false),
+          device_only(false) {}
 
     struct notifier_t {
       void* ptr;
@@ -527,8 +836,29 @@ class Runtime {
     void* user_ptr;
     std::unique_ptr<std::vector<notifier_t>> notifiers;
     amdgpu_bo_handle ldrm_bo;
+    bool parked;  // Released by FreeMemoryAsync and held in async_free_cache_.
+    hsa_amd_memory_usage_category_t usage;
+    void* batch_base;  // Shared block the buffer was carved from, see batch_blocks_.
+    bool host_writable;  // Device memory the CPU was granted access to.
+    bool device_only;    // The user promised the CPU does not write it.
   };
 
+  // An allocation removed from allocation_map_ whose memory has yet to be released.
+  struct ReleasedAllocation {
+    void* ptr;
+    const MemoryRegion* region;
+    size_t size;
+    MemoryRegion::AllocateFlags alloc_flags;
+    std::unique_ptr<std::vector<AllocationRegion::notifier_t>> notifiers;
+  };
+
+  /// @brief Runs notifiers and frees a batch of allocations, grouping driver frees by region.
+  hsa_status_t ReleaseAllocations(std::vector<ReleasedAllocation>& batch);
+
+  /// @brief Runs deallocation callbacks, or queues them for the deferred free thread when
+  /// flag().deferred_free_notify() is set.
+  void NotifyRelease(std::unique_ptr<std::vector<AllocationRegion::notifier_t>> notifiers);
+
   struct AsyncEventsControl {
     AsyncEventsControl() : async_events_thread_(NULL) {}
     void Shutdown();
@@ -564,10 +894,14 @@ class Runtime {
   struct PrefetchRange;
   typedef std::map<uintptr_t, PrefetchRange> prefetch_map_t;
 
-  struct PrefetchOp {
+  struct PrefetchSpan {
     void* base;
     size_t size;
     uint32_t node_id;
+  };
+
+  struct PrefetchOp {
+    std::vector<PrefetchSpan> spans;  // Disjoint, one KFD prefetch each.
     int remaining_deps;
     hsa_signal_t completion;
     std::vector<hsa_signal_t> dep_signals;
@@ -576,8 +910,10 @@ class Runtime {
 
   struct PrefetchRange {
     PrefetchRange() {}
-    PrefetchRange(size_t Bytes, PrefetchOp* Op) : bytes(Bytes), op(Op) {}
+    PrefetchRange(size_t Bytes, uint32_t NodeId, PrefetchOp* Op)
+        : bytes(Bytes), node_id(NodeId), op(Op) {}
     size_t bytes;
+    uint32_t node_id;
     PrefetchOp* op;
     prefetch_map_t::iterator prev;
     prefetch_map_t::iterator next;
@@ -630,6 +966,12 @@ class Runtime {
   std::vector<std::pair<AMD::callback_t<hsa_amd_system_event_callback_t>, void*>>
   GetSystemEventHandlers();
 
+  /// @brief Records a received GPU fault and returns its sequence number.
+  uint64_t RecordFault(hsa_amd_gpu_fault_record_t record);
+
+  /// @brief Flags the record of fault @p sequence as handled if it is still kept.
+  void MarkFaultHandled(uint64_t sequence);
+
   /// @brief Get the index of ::link_matrix_.
   /// @param [in] node_id_from Node id of the source node.
   /// @param [in] node_id_to Node id of the destination node.
@@ -642,11 +984,16 @@ class Runtime {
   /// @brief Get the highest used node id.
   uint32_t max_node_id() const { return agents_by_node_.rbegin()->first; }
 
-  // Mutex object to protect multithreaded access to ::allocation_map_.
-  // Also ensures atomicity of pointer info queries by interlocking
-  // KFD map/unmap, register/unregister, and access to hsaKmtQueryPointerInfo
-  // registered & mapped arrays.
-  KernelSharedMutex memory_lock_;
+  // Ensures atomicity of pointer info queries by interlocking KFD map/unmap,
+  // register/unregister, and access to hsaKmtQueryPointerInfo registered & mapped
+  // arrays.  Pointer queries hold it shared, operations changing mappings hold it
+  // exclusive.
+  // ::allocation_map_ is internally synchronized and does not require this lock.
+  KernelSharedMutex memory_lock_{"Runtime::memory_lock_"};
+
+  // Serializes changes to the virtual memory handle maps and handle reference counts.  The range
+  // maps are internally synchronized so lookups such as VMemoryGetAccess do not take it.
+  KernelMutex vmem_lock_;
 
   // Array containing driver interfaces for compatible agent kernel-mode
   // drivers. Currently supports AIE agents.
@@ -685,6 +1032,17 @@ class Runtime {
   // Matrix of IO link.
   std::vector<LinkInfo> link_matrix_;
 
+  // Routes and nearest resources derived from link_matrix_.
+  Topology topology_;
+
+  // Policies set by hsa_amd_runtime_thread_policy_set, the flag's are used until set.
+  Flag::ThreadPolicy thread_policy_[HSA_AMD_THREAD_CLASS_COUNT];
+  KernelMutex thread_policy_lock_;
+
+  /// @brief Converts the policy of a thread class to the cores and scheduling for @p gpu.
+  /// Requires thread_policy_lock_.
+  os::ThreadPolicy ResolveThreadPolicy(uint32_t thread_class, const Agent* gpu);
+
   // Loader instance.
   amd::hsa::loader::Loader* loader_;
 
@@ -695,15 +1053,109 @@ class Runtime {
   amd::hsa::code::AmdHsaCodeManager code_manager_;
 
   // Contains the region, address, and size of previously allocated memory.
-  std::map<const void*, AllocationRegion> allocation_map_;
+  ShardedAddressMap<AllocationRegion> allocation_map_;
+
+  // Fills attribs from a snapshot of every KFD attribute of [base, base + len), taken with one
+  // query and kept until invalidated.
+  void GetCachedSvmAttribs(void* base, size_t len, std::vector<HSA_SVM_ATTRIBUTE>& attribs);
+
+  // SVM attribute snapshots by page aligned query range, see HSA_SVM_ATTRIB_CACHE.
+  KernelMutex svm_attrib_lock_;
+  std::map<std::pair<uintptr_t, size_t>, std::vector<HSA_SVM_ATTRIBUTE>> svm_attrib_cache_;
+
+  // dma-buf exported per allocation base, callers receive duplicates of the descriptor.  offset is
+  // that of the allocation base within the buffer.  Closed when the allocation is freed.
+  struct DmaBufExportEntry {
+    int fd;
+    uint64_t offset;
+  };
+  KernelMutex dmabuf_export_lock_;
+  std::map<const void*, DmaBufExportEntry> dmabuf_exports_;
+
+  // Closes the cached export of the allocation at base, if any.
+  void DmaBufExportRelease(const void* base);
+
+  // Records the CPU mapping a new device memory allocation gets, if any.
+  void TrackHostMapping(AllocationRegion& entry);
+
+  // Records CPU write access granted to the device memory allocation at ptr.
+  void TrackHostAccess(uint32_t num_agents, const hsa_agent_t* agents, const void* ptr);
+
+  // Keeps HDP flushes on for device memory of agent, or of every GPU if agent is nullptr, once
+  // the memory is shared with other processes or devices whose CPU writes can't be tracked.
+  void PinHdpFlush(const Agent* agent);
+
+  // Pinned system memory chunk staging hsa_memory_copy traffic that the GPU can't address directly.
+  // done completes the DMA into or out of ptr, hop the first leg of a peer copy.
+  struct StagingChunk {
+    void* ptr;
+    core::Signal* done;
+    core::Signal* hop;
+  };
+  KernelMutex staging_lock_;
+  std::vector<StagingChunk> staging_pool_;
+
+  // Takes up to count chunks from the pool, allocating any shortfall near node_id.
+  void AcquireStagingChunks(uint32_t count, int node_id, std::vector<StagingChunk>& chunks);
+
+  // Returns chunks to the pool, freeing those beyond its bound.
+  void ReleaseStagingChunks(std::vector<StagingChunk>& chunks);
+
+  // Completes a small async copy with the CPU if its dependencies have retired and both sides are
+  // host accessible.  Returns false if the copy must be submitted to an engine.
+  bool HostCopy(void* dst, const void* src, size_t size, std::vector<core::Signal*>& dep_signals,
+                core::Signal& completion_signal);
+
+  // Synchronous copy between GPUs over their direct link, when one side's allocation is already
+  // mapped to the other's agent.  Returns HSA_STATUS_ERROR_INVALID_AGENT if not possible.
+  hsa_status_t PeerCopy(void* dst, core::Agent* dst_agent, const void* src,
+                        core::Agent* src_agent, size_t size);
+
+  // Held shared by PeerCopy and exclusive by AllowAccess, so peer mappings outlive the copies
+  // using them.
+  KernelSharedMutex peer_access_lock_;
+
+  // Synchronous copy through staging chunks, pipelining host memcpy with DMA.  A non-GPU agent
+  // marks pageable memory accessed by the CPU.
+  hsa_status_t StagedCopy(void* dst, core::Agent* dst_agent, const void* src,
+                          core::Agent* src_agent, size_t size);
+
+  // State of a CopyMemoryStream, advanced by StreamChunkHandler as each chunk's DMA retires.
+  struct StagingStream {
+    const uint8_t* src;
+    core::Agent* src_agent;
+    size_t size;
+    size_t chunk_size;
+    size_t count;
+    hsa_amd_copy_stream_callback_t callback;
+    void* user_data;
+    std::vector<StagingChunk> chunks;
+    // Index of the next chunk handed to callback.
+    size_t next;
+    core::Signal* completion_signal;
+  };
+
+  // Starts the DMA of chunk index of stream into its staging chunk.
+  hsa_status_t StreamChunkFill(StagingStream* stream, size_t index,
+                               std::vector<core::Signal*>& dep_signals);
+
+  static bool StreamChunkHandler(hsa_signal_value_t value, void* arg);
 
   // Pending prefetch containers.
   KernelMutex prefetch_lock_;
   prefetch_map_t prefetch_map_;
 
+  // Trims pending ranges overlapping [base, base + len) and records it as part of op.
+  // Must be called with prefetch_lock_ held.
+  void InsertPrefetchRange(PrefetchOp* op, uintptr_t base, size_t len, uint32_t node_id);
+
   // Allocator using ::system_region_
   std::function<void*(size_t size, size_t align, MemoryRegion::AllocateFlags flags, int agent_node_id)> system_allocator_;
 
+  // Kernarg capable system pool of the CPU nearest to each node, indexed by node id.  Built once
+  // topology is loaded and read without locking by ::system_allocator_.
+  std::vector<const MemoryRegion*> node_system_pool_;
+
   // Deallocator using ::system_region_
   std::function<void(void*)> system_deallocator_;
 
@@ -717,12 +1169,19 @@ class Runtime {
     bool monitor_exceptions;
   };
 
-  struct AsyncEventsInfo asyncSignals_;
+  // Async signal handlers are sharded by signal across up to kMaxAsyncEventShards threads so a
+  // slow handler only delays the signals which share its shard.
+  static constexpr uint32_t kMaxAsyncEventShards = 16;
+  struct AsyncEventsInfo asyncSignals_[kMaxAsyncEventShards];
+  struct AsyncEventsInfo asyncCritical_;
   struct AsyncEventsInfo asyncExceptions_;
 
   // System clock frequency.
   uint64_t sys_clock_freq_;
 
+  // Phase timestamps of the last Load().
+  hsa_amd_init_phase_times_t init_phases_;
+
   // Number of Numa Nodes
   size_t num_nodes_;
 
@@ -745,6 +1204,12 @@ class Runtime {
   // System event handler lock
   KernelMutex system_event_lock_;
 
+  // Most recent GPU faults, oldest first, and the number of faults received.
+  static const size_t kMaxFaultRecords = 64;
+  std::deque<hsa_amd_gpu_fault_record_t> fault_records_;
+  uint64_t fault_count_;
+  KernelMutex fault_records_lock_;
+
   // Internal queue creation notifier
   AMD::callback_t<hsa_amd_runtime_queue_notifier> internal_queue_create_notifier_;
 
@@ -767,13 +1232,51 @@ class Runtime {
 
   std::unique_ptr<AMD::SvmProfileControl> svm_profile_;
 
+  // Periodic metrics dump, if requested.
+  std::unique_ptr<MetricsDumper> metrics_dump_;
+
   // IPC DMA buf unix domain socket server dmabuf FD passing
   int ipc_sock_server_fd_;
   std::map<uint64_t, int> ipc_sock_server_conns_;
   KernelMutex ipc_sock_server_lock_;
+  std::atomic<bool> ipc_sock_server_stop_{false};
+  std::atomic<uint32_t> ipc_sock_server_threads_{0};
+
+  // Attached IPC mappings shared between attaches of the same handle, length and agent set.
+  // Unreferenced mappings are kept oldest first on ipc_attach_idle_ until evicted or reused.
+  struct IPCAttachEntry {
+    std::vector<uint32_t> key;
+    uint32_t ref_count;
+    std::list<void*>::iterator idle;
+  };
+  std::map<std::vector<uint32_t>, void*> ipc_attach_cache_;
+  std::map<void*, IPCAttachEntry> ipc_attach_mappings_;
+  std::list<void*> ipc_attach_idle_;
+  // Interop mappings shared between maps of the same graphics buffer to the same agent set.
+  // Unreferenced mappings are kept oldest first on interop_idle_ until evicted or reused.  An
+  // empty key marks an invalidated mapping, released at its last unmap.
+  struct InteropEntry {
+    std::vector<uint64_t> key;
+    uint32_t ref_count;
+    std::list<void*>::iterator idle;
+    size_t size;
+    size_t metadata_size;
+    const void* metadata;
+  };
+  std::map<std::vector<uint64_t>, void*> interop_cache_;
+  std::map<void*, InteropEntry> interop_mappings_;
+  std::list<void*> interop_idle_;
+  KernelMutex interop_lock_;
+
+  // DMA buf FDs fetched by a batched attach, keyed by exporter and export handle.
+  std::map<std::pair<uint32_t, uint64_t>, int> ipc_prefetched_fds_;
+  KernelMutex ipc_attach_lock_;
 
  private:
   void CheckVirtualMemApiSupport();
+
+  /// @brief Picks the system pool nearest to each node for ::system_allocator_.
+  void InitNodeSystemPools();
   int GetAmdgpuDeviceArgs(Agent* agent, amdgpu_bo_handle bo, int* drm_fd, uint64_t* cpu_addr);
 
   bool virtual_mem_api_supported_;
@@ -788,10 +1291,11 @@ class Runtime {
     size_t size;
     int use_count;
   };
-  std::map<const void*, AddressHandle> reserved_address_map_;  // Indexed by VA
+  ShardedAddressMap<AddressHandle> reserved_address_map_;  // Indexed by VA range
 
   struct MemoryHandle {
-    MemoryHandle() : region(NULL), size(0), ref_count(0), thunk_handle(NULL), alloc_flag(0) {}
+    MemoryHandle()
+        : region(NULL), size(0), ref_count(0), thunk_handle(NULL), alloc_flag(0), shared(false) {}
     MemoryHandle(const MemoryRegion* region, size_t size, uint64_t flags_unused,
                  ThunkHandle thunk_handle, MemoryRegion::AllocateFlags alloc_flag)
         : region(region),
@@ -799,7 +1303,8 @@ class Runtime {
           ref_count(1),
           use_count(0),
           thunk_handle(thunk_handle),
-          alloc_flag(alloc_flag) {}
+          alloc_flag(alloc_flag),
+          shared(false) {}
 
     static __forceinline hsa_amd_vmem_alloc_handle_t Convert(void* handle) {
       hsa_amd_vmem_alloc_handle_t ret_handle = {
@@ -815,9 +1320,65 @@ class Runtime {
     int use_count;
     ThunkHandle thunk_handle;  // handle returned by hsaKmtAllocMemory(NoAddress = 1)
     MemoryRegion::AllocateFlags alloc_flag;
+    bool shared;  // Exported or imported, never recycled.
   };
   std::map<ThunkHandle, MemoryHandle> memory_handle_map_;
 
+  // Released memory handles kept for reuse by VMemoryHandleCreate, keyed by region, size and
+  // allocation flags.  Bounded by flag().vmem_handle_cache_size() bytes.
+  typedef std::tuple<const MemoryRegion*, size_t, MemoryRegion::AllocateFlags> VMemoryHandleKey;
+  std::multimap<VMemoryHandleKey, ThunkHandle> vmem_handle_cache_;
+  size_t vmem_handle_cache_bytes_;
+  KernelMutex vmem_handle_cache_lock_;
+
+  // Shared blocks of AllocateMemoryBatch by base address.  refs counts the buffers carved from the
+  // block which are still allocated.
+  struct BatchBlock {
+    size_t size;
+    MemoryRegion::AllocateFlags alloc_flags;
+    size_t refs;
+  };
+  std::map<void*, BatchBlock> batch_blocks_;
+  KernelMutex batch_lock_;
+
+  // Interleaved allocations by base address, holding their size and stripe size.
+  std::map<const void*, std::pair<size_t, size_t>> interleaved_allocs_;
+  KernelMutex interleaved_lock_;
+
+  // Blocks released by FreeMemoryAsync, keyed by region, allocation flags and size.  Each holds a
+  // reference on its release signal, null once nothing remains to wait for.  Bounded by
+  // flag().async_free_cache_size() bytes.
+  typedef std::tuple<const MemoryRegion*, MemoryRegion::AllocateFlags, size_t> AsyncFreeKey;
+  struct AsyncFreeBlock {
+    void* ptr;
+    Signal* release;
+  };
+  std::multimap<AsyncFreeKey, AsyncFreeBlock> async_free_cache_;
+  size_t async_free_cache_bytes_;
+  KernelMutex async_free_cache_lock_;
+
+  // Allocations freed while flag().deferred_free() is set, released in batches by
+  // deferred_free_thread_.  The thread handle is null when frees must complete inline.
+  std::vector<ReleasedAllocation> deferred_frees_;
+  // Deallocation callbacks queued while flag().deferred_free_notify() is set.
+  std::vector<std::unique_ptr<std::vector<AllocationRegion::notifier_t>>> deferred_notifiers_;
+  KernelMutex deferred_free_lock_;
+  os::Thread deferred_free_thread_;
+  os::EventHandle deferred_free_event_;
+  std::atomic<bool> deferred_free_exit_;
+
+  // Application callbacks releasing memory under pressure, see RelieveMemoryPressure.
+  std::vector<std::pair<AMD::callback_t<hsa_amd_memory_pressure_callback_t>, void*>>
+      memory_pressure_callbacks_;
+  KernelMutex memory_pressure_lock_;
+
+  os::Thread memory_pressure_thread_;
+  os::EventHandle memory_pressure_event_;
+  std::atomic<bool> memory_pressure_exit_;
+
+  /// @brief Returns a released memory handle to the reuse cache or frees it if the cache is full.
+  void VMemoryHandleFree(const MemoryHandle& handle);
+
   struct MappedHandle;
   struct MappedHandleAllowedAgent {
     MappedHandleAllowedAgent()
@@ -872,7 +1433,7 @@ class Runtime {
     amdgpu_bo_handle ldrm_bo;
     std::map<Agent*, MappedHandleAllowedAgent> allowed_agents;
   };
-  std::map<const void*, MappedHandle> mapped_handle_map_;  // Indexed by VA
+  ShardedAddressMap<MappedHandle> mapped_handle_map_;  // Indexed by VA range
 
   hsa_status_t VMemoryMapAllowAccess(const void *va,
                                      hsa_access_permission_t perm,
@@ -882,6 +1443,9 @@ class Runtime {
   VMemorySetAccessPerHandle(void *va, MappedHandle &MappedHandle,
                             const hsa_amd_memory_access_desc_t *desc,
                             const size_t desc_cnt);
+  hsa_status_t VMemoryHandleMapLocked(void* va, size_t size, size_t in_offset,
+                                      hsa_amd_vmem_alloc_handle_t memoryHandle, uint64_t flags);
+  hsa_status_t VMemoryHandleUnmapLocked(void* va, size_t size);
 
   // Frees runtime memory when the runtime library is unloaded if safe to do so.
   // Failure to release the runtime indicates an incorrect application but is
@@ -894,6 +1458,34 @@ class Runtime {
                        amdgpu_bo_import_result *res,
                        unsigned int numNodes, HSAuint32 *nodes,
                        void **importAddress, HSAuint64 *importSize);
+
+  int IPCImportDmaBufFd(int dmabuf_fd, amdgpu_bo_import_result *res,
+                        unsigned int numNodes, HSAuint32 *nodes,
+                        void **importAddress, HSAuint64 *importSize);
+  void IPCClientFetchFds(uint32_t conn_handle, const std::vector<uint64_t>& handles);
+
+  static std::vector<uint32_t> IPCAttachKey(const hsa_amd_ipc_memory_t* handle, size_t len,
+                                            uint32_t num_agents, Agent** agents);
+
+  /// @brief Imports and maps an IPC handle, bypassing the attach cache.
+  hsa_status_t IPCAttachMapping(const hsa_amd_ipc_memory_t* handle, size_t len,
+                                uint32_t num_agents, Agent** agents, void** mapped_ptr);
+
+  /// @brief Unmaps and releases an IPC mapping, bypassing the attach cache.
+  hsa_status_t IPCDetachMapping(void* ptr);
+
+  /// @brief Identifies a graphics buffer and agent set for the interop cache.  Returns false if
+  /// the handle can not be identified.
+  static bool InteropKey(int interop_handle, uint32_t num_agents, Agent** agents,
+                         std::vector<uint64_t>* key);
+
+  /// @brief Imports and maps a graphics buffer, bypassing the interop cache.
+  hsa_status_t InteropMapping(uint32_t num_agents, Agent** agents, int interop_handle,
+                              size_t* size, void** ptr, size_t* metadata_size,
+                              const void** metadata);
+
+  /// @brief Unmaps and releases an interop mapping, bypassing the interop cache.
+  hsa_status_t InteropUnmapping(void* ptr);
 };
 
 }  // namespace core
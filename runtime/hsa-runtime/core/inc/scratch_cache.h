@@ -84,6 +84,56 @@ class ScratchCache {
   typedef map_t::iterator ref_t;
   typedef ::std::function<void(void*, size_t, bool)> deallocator_t;
 
+  // @brief Log2 histogram of the per-thread scratch sizes requested by a queue's dispatches.
+  // Bucket b counts requests in [16B << b, 32B << b) and remembers the largest request seen in
+  // it.  Counts are halved every kDecaySamples requests, and by the elastic scratch monitor when
+  // the queue stops requesting, so the histogram follows recent demand.
+  struct ScratchDemand {
+    static const uint32_t kBuckets = 16;
+    static const uint32_t kDecaySamples = 64;
+
+    uint32_t count[kBuckets];
+    uint64_t max[kBuckets];
+    uint32_t samples;
+    uint32_t idle_ticks;
+    uint32_t over_ticks;
+    uint32_t queue_idle_ticks;
+    // Main scratch size expected to satisfy the next request, 0 if there is no history.
+    size_t predicted_size;
+
+    void record(uint64_t thread_bytes) {
+      uint32_t b = 0;
+      for (uint64_t v = thread_bytes >> 5; v != 0 && b < kBuckets - 1; v >>= 1) b++;
+      count[b]++;
+      if (thread_bytes > max[b]) max[b] = thread_bytes;
+      idle_ticks = 0;
+      if (++samples == kDecaySamples) decay();
+    }
+
+    void decay() {
+      for (uint32_t b = 0; b < kBuckets; b++) {
+        count[b] >>= 1;
+        if (count[b] == 0) max[b] = 0;
+      }
+      samples = 0;
+    }
+
+    // @brief Smallest per-thread size covering pct percent of recent requests, 0 if none.
+    uint64_t predict(uint32_t pct) const {
+      uint64_t total = 0;
+      for (uint32_t b = 0; b < kBuckets; b++) total += count[b];
+      if (total == 0) return 0;
+
+      const uint64_t threshold = (total * pct + 99) / 100;
+      uint64_t sum = 0;
+      for (uint32_t b = 0; b < kBuckets; b++) {
+        sum += count[b];
+        if (sum >= threshold) return max[b];
+      }
+      return 0;
+    }
+  };
+
   // @brief Contains scratch memory information.
   struct ScratchInfo {
     // Size to satisfy the present dispatch without throttling.
@@ -119,6 +169,8 @@ class ScratchCache {
     void* alt_queue_base;
     ptrdiff_t alt_queue_process_offset;
     ScratchCache::ref_t alt_scratch_node;
+
+    ScratchDemand demand;
   };
 
   ScratchCache(const ScratchCache& rhs) = delete;
@@ -130,13 +182,16 @@ class ScratchCache {
 
   ~ScratchCache() { assert(map.empty() && "ScratchCache not empty at shutdown."); }
 
-  bool allocMain(ScratchInfo& info) {
+  // @param shared When set, small requests may also bind a free small node of up to twice the
+  // requested size so queues sharing the arena reuse each other's returned scratch.
+  bool allocMain(ScratchInfo& info, bool shared = false) {
     ref_t it = map.upper_bound(info.main_size - 1);
     if (it == map.end()) return false;
 
-    // Small requests must have an exact size match and be small.
+    // Small requests must be small and, outside the shared arena, have an exact size match.
     if (!info.large) {
-      while ((it != map.end()) && (it->first == info.main_size)) {
+      const size_t max_size = shared ? info.main_size * 2 : info.main_size;
+      while ((it != map.end()) && (it->first <= max_size)) {
         if (it->second.isFree() && (!it->second.large)) {
           it->second.alloc();
           info.main_queue_base = it->second.base;
@@ -211,12 +266,13 @@ class ScratchCache {
     return ret;
   }
 
-  bool allocAlt(ScratchInfo& info) {
+  bool allocAlt(ScratchInfo& info, bool shared = false) {
     ref_t it = map.upper_bound(info.alt_size - 1);
     if (it == map.end()) return false;
 
-    // Alt requests should have exact size
-    while ((it != map.end()) && (it->first == info.alt_size)) {
+    // Alt requests should have exact size, or up to twice that in the shared arena.
+    const size_t max_size = shared ? info.alt_size * 2 : info.alt_size;
+    while ((it != map.end()) && (it->first <= max_size)) {
       if (it->second.isFree() && (!it->second.large)) {
         it->second.alloc();
         info.alt_queue_base = it->second.base;
@@ -251,9 +307,29 @@ class ScratchCache {
     info.alt_scratch_node = it;
   }
 
+  // @brief Returns true if a free small node of exactly size bytes is cached.
+  bool hasFree(size_t size) const {
+    auto range = map.equal_range(size);
+    for (auto it = range.first; it != range.second; it++)
+      if (it->second.isFree() && (!it->second.large)) return true;
+    return false;
+  }
+
+  // @brief Adds mapped scratch memory to the cache as a free small node.
+  void insertFree(size_t size, void* base) {
+    node n;
+    n.base = base;
+    n.large = false;
+    map.insert(std::make_pair(size, n));
+    available_bytes_ += size;
+  }
+
   size_t free_bytes() const { return available_bytes_; }
   size_t reserved_bytes() const { return reserved_.first; }
 
+  // Scratch allocations held, including the reserve.
+  size_t node_count() const { return map.size() + (reserved_.first != 0 ? 1 : 0); }
+
   void reserve(size_t bytes, void* base) {
     assert(!reserved_.first && "Already reserved memory.");
 
@@ -53,6 +53,7 @@ namespace AMD {
 // Reference: http://people.freedesktop.org/~agd5f/dma_packets.txt
 
 const unsigned int SDMA_OP_COPY = 1;
+const unsigned int SDMA_OP_INDIRECT = 4;
 const unsigned int SDMA_OP_FENCE = 5;
 const unsigned int SDMA_OP_TRAP = 6;
 const unsigned int SDMA_OP_POLL_REGMEM = 8;
@@ -412,6 +413,55 @@ typedef struct SDMA_PKT_CONSTANT_FILL_TAG {
   static const size_t kMaxSize_ = 0x3fffe0;
 } SDMA_PKT_CONSTANT_FILL;
 
+typedef struct SDMA_PKT_INDIRECT_TAG {
+  union {
+    struct {
+      unsigned int op : 8;
+      unsigned int sub_op : 8;
+      unsigned int vmid : 4;
+      unsigned int reserved_0 : 11;
+      unsigned int priv : 1;
+    };
+    unsigned int DW_0_DATA;
+  } HEADER_UNION;
+
+  union {
+    struct {
+      unsigned int ib_base_31_0 : 32;
+    };
+    unsigned int DW_1_DATA;
+  } BASE_LO_UNION;
+
+  union {
+    struct {
+      unsigned int ib_base_63_32 : 32;
+    };
+    unsigned int DW_2_DATA;
+  } BASE_HI_UNION;
+
+  union {
+    struct {
+      unsigned int ib_size : 20;
+      unsigned int reserved_0 : 12;
+    };
+    unsigned int DW_3_DATA;
+  } IB_SIZE_UNION;
+
+  union {
+    struct {
+      unsigned int csa_addr_31_0 : 32;
+    };
+    unsigned int DW_4_DATA;
+  } CSA_ADDR_LO_UNION;
+
+  union {
+    struct {
+      unsigned int csa_addr_63_32 : 32;
+    };
+    unsigned int DW_5_DATA;
+  } CSA_ADDR_HI_UNION;
+} SDMA_PKT_INDIRECT;
+
 typedef struct SDMA_PKT_FENCE_TAG {
   union {
     struct {
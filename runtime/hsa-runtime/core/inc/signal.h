@@ -48,6 +48,7 @@
 #include <map>
 #include <functional>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
@@ -60,8 +61,11 @@
 
 #include "core/util/utils.h"
 #include "core/util/locks.h"
+#include "core/util/magazine.h"
+#include "core/util/timer.h"
 
 #include "inc/amd_hsa_signal.h"
+#include "inc/hsa_ext_amd.h"
 
 // Allow hsa_signal_t to be keys in STL structures.
 namespace std {
@@ -78,6 +82,7 @@ template <> struct less<hsa_signal_t> {
 namespace rocr {
 namespace core {
 class Agent;
+class Blit;
 class Signal;
 
 /// @brief ABI and object conversion struct for signals.  May be shared between processes.
@@ -86,14 +91,25 @@ struct SharedSignal {
   uint64_t sdma_start_ts;
   Signal* core_signal;
   Check<0x71FCCA6A3D5D5276, true> id;
-  uint8_t reserved[8];
+  uint64_t ipc_doorbell;  // Names the host doorbell of an exported IPC signal, 0 if none.
   uint64_t sdma_end_ts;
-  uint8_t reserved2[24];
+  uint32_t host_store;  // HostStore, how a host store may bypass core_signal.
+  uint8_t reserved2[20];
+
+  /// @brief Host stores that need nothing from core_signal.
+  enum HostStore : uint32_t {
+    kHostStoreObject = 0,   // Call core_signal.
+    kHostStoreValue = 1,    // Write amd_signal.value.
+    kHostStoreDoorbell = 2,        // Write the value to amd_signal.hardware_doorbell_ptr.
+    kHostStoreDoorbellFenced = 3  // As kHostStoreDoorbell after draining write-combined stores.
+  };
 
   SharedSignal() {
     memset(&amd_signal, 0, sizeof(amd_signal));
     amd_signal.kind = AMD_SIGNAL_KIND_INVALID;
     core_signal = nullptr;
+    ipc_doorbell = 0;
+    host_store = kHostStoreObject;
   }
 
   bool IsValid() const { return (Convert(this).handle != 0) && id.IsValid(); }
@@ -161,21 +177,40 @@ static_assert(sizeof(SharedSignal) == 128,
 #define SIGNAL_PREALLOC_BLOCKS 512 //16K Signals
 
 /// @brief Pool class for SharedSignal suitable for use with Shared.
+/// Each thread keeps a small magazine of free signals which is refilled from and returned to the
+/// shared free list in batches.
 class SharedSignalPool_t : private BaseShared {
  public:
-  SharedSignalPool_t() : block_size_(SIGNAL_PREALLOC_BLOCKS * minblock_) {}
-  ~SharedSignalPool_t() { clear(); }
+  SharedSignalPool_t() : block_size_(SIGNAL_PREALLOC_BLOCKS * minblock_) { NewEpoch(); }
+  ~SharedSignalPool_t() {
+    clear();
+    live_epoch_.store(0, std::memory_order_release);
+  }
 
   SharedSignal* alloc();
   void free(SharedSignal* ptr);
   void clear();
 
  private:
+  static const uint32_t kMagazineSize = 64;
+  static const uint32_t kMagazineBatch = kMagazineSize / 2;
+  typedef Magazine<SharedSignal, kMagazineSize> magazine_t;
+
+  static magazine_t& magazine();
+  static void ReturnBatch(void* pool, SharedSignal** items, uint32_t count);
+
+  void NewEpoch();
+  SharedSignal* Refill(magazine_t& cache);
+
   static const size_t minblock_ = 4096 / sizeof(SharedSignal);
   HybridMutex lock_;
   std::vector<SharedSignal*> free_list_;
   std::vector<std::pair<void*, size_t>> block_list_;
   size_t block_size_;
+
+  // Thread magazines are only valid for the pool generation they were filled from.
+  uint64_t epoch_;
+  static std::atomic<uint64_t> live_epoch_;
 };
 
 class LocalSignal {
@@ -205,6 +240,9 @@ class Signal {
 
     waiting_ = 0;
     retained_ = 1;
+    deferred_interrupt_ = nullptr;
+    wait_policy_ = HSA_AMD_SIGNAL_WAIT_POLICY_DEFAULT;
+    wait_latency_ns_ = 0;
 
     if (enableIPC) {
       abi_block->core_signal = nullptr;
@@ -259,6 +297,34 @@ class Signal {
     }
   }
 
+  /// @brief Stores to signal without the core object when its owner allows it.  Returns false if
+  /// the store must go through Convert.  Only StoreRelaxed/StoreRelease semantics are covered.
+  static __forceinline bool StoreDirect(hsa_signal_t signal, hsa_signal_value_t value,
+                                        std::memory_order order) {
+    if (signal.handle == 0) return false;
+    SharedSignal* shared = SharedSignal::Convert(signal);
+    switch (shared->host_store) {
+      case SharedSignal::kHostStoreValue:
+        if (!shared->IsValid()) return false;
+        atomic::Store(&shared->amd_signal.value, int64_t(value), order);
+        return true;
+      case SharedSignal::kHostStoreDoorbell:
+        if (!shared->IsValid()) return false;
+        if (order != std::memory_order_relaxed) std::atomic_thread_fence(std::memory_order_release);
+        atomic::Store(shared->amd_signal.hardware_doorbell_ptr, uint64_t(value),
+                      std::memory_order_release);
+        return true;
+      case SharedSignal::kHostStoreDoorbellFenced:
+        if (!shared->IsValid()) return false;
+        _mm_sfence();
+        atomic::Store(shared->amd_signal.hardware_doorbell_ptr, uint64_t(value),
+                      std::memory_order_release);
+        return true;
+      default:
+        return false;
+    }
+  }
+
   static Signal* DuplicateHandle(hsa_signal_t signal) {
     if (signal.handle == 0) return nullptr;
     SharedSignal* shared = SharedSignal::Convert(signal);
@@ -385,6 +451,28 @@ class Signal {
   /// @brief Decrements the waiting indicator.
   void WaitingDec() { waiting_--; }
 
+  /// @brief Records that blit skipped the completion interrupt of a command on this signal.
+  /// Fails, so the interrupt must be sent, if a thread may already be sleeping on the signal or a
+  /// different blit holds a deferred interrupt.
+  bool DeferInterrupt(Blit* blit);
+
+  /// @brief Has the blit holding a deferred interrupt send it.  Must be called after WaitingInc()
+  /// and before sleeping on the signal's event.
+  void FlushDeferredInterrupt();
+
+  /// @brief Selects the host wait policy and discards the latency history.
+  void set_wait_policy(hsa_amd_signal_wait_policy_t policy) {
+    wait_latency_ns_.store(0, std::memory_order_relaxed);
+    wait_policy_.store(policy, std::memory_order_relaxed);
+  }
+
+  /// @brief Returns how long a blocked waiter should poll before sleeping.
+  /// @param fixed Polling window used by the fixed policy and when no history is available.
+  timer::fast_clock::duration SpinBudget(timer::fast_clock::duration fixed) const;
+
+  /// @brief Folds the latency of a satisfied wait into the completion history.
+  void RecordWaitLatency(timer::fast_clock::duration elapsed);
+
   // Prep for copy profiling.  Store copy agent and ready API block.
   __forceinline void async_copy_agent(core::Agent* agent) {
     async_copy_agent_ = agent;
@@ -423,9 +511,20 @@ class Signal {
   /// Value of zero means no waits.
   std::atomic<uint32_t> waiting_;
 
+  friend class SignalWaitSet;
+
+  /// @variable Blit which skipped a completion interrupt for this signal, if any.
+  std::atomic<Blit*> deferred_interrupt_;
+
   /// @variable Pointer to agent used to perform an async copy.
   core::Agent* async_copy_agent_;
 
+  /// @variable Host wait policy, one of hsa_amd_signal_wait_policy_t.
+  std::atomic<uint32_t> wait_policy_;
+
+  /// @variable Exponentially weighted average of satisfied wait latency in ns, 0 if unknown.
+  std::atomic<uint64_t> wait_latency_ns_;
+
  private:
   static KernelMutex ipcLock_;
   static std::map<decltype(hsa_signal_t::handle), Signal*> ipcMap_;
@@ -647,6 +746,211 @@ class SignalGroup : public Checked<0xBD35DDDD578F091> {
   DISALLOW_COPY_AND_ASSIGN(SignalGroup);
 };
 
+/// @brief Shares driver waits on an interrupt event among the threads of the process.
+/// Only one thread at a time sleeps on an event in the driver, the others sleep on a futex and
+/// are woken when its wait returns.  Without event age tracking this also keeps a single thread
+/// consuming the event, so later waiters may sleep rather than poll.
+class EventWaitMux {
+ public:
+  /// @brief Wake generation of event.  Read before checking the condition waited for, so that a
+  /// driver wait returning after the check ends the following Wait at once.
+  static uint32_t Generation(HsaEvent* event) {
+    return SlotOf(event).generation.load(std::memory_order_acquire);
+  }
+
+  /// @brief Sleeps until event fires, wait_ms expires or a driver wait on event returns after
+  /// generation was read.  May return early, callers must recheck their condition.
+  /// @param lead If false only follow a driver wait already in progress, return at once if none.
+  /// @return false if it returned at once without sleeping.
+  static bool Wait(HsaEvent* event, uint32_t generation, uint32_t wait_ms, uint64_t* event_age,
+                   bool lead);
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> generation;
+    std::atomic<HsaEvent*> sleeper;  // Event waited on in the driver, nullptr if none.
+  };
+
+  // Events hash to slots, events sharing a slot only cost spurious wakeups.
+  static constexpr uint32_t kSlotCount = 64;
+  static Slot slots_[kSlotCount];
+
+  static Slot& SlotOf(HsaEvent* event) {
+    return slots_[(uintptr_t(event) >> 6) % kSlotCount];
+  }
+};
+
+/// @brief Persistent set of signal-condition pairs which are waited on together.
+/// Members are registered once.  Signals sharing an interrupt event are deduplicated as the set
+/// changes rather than on every wait, and after a sleep only members of the events which fired
+/// are rechecked.  Satisfied members are tracked in a bitmap and removed as they are reported.
+/// Calls on one set must be serialized by the caller.
+class SignalWaitSet : public Checked<0x6D2F0C8E41B7A953> {
+ public:
+  static __forceinline hsa_amd_signal_wait_set_t Convert(SignalWaitSet* set) {
+    const hsa_amd_signal_wait_set_t handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(set))};
+    return handle;
+  }
+  static __forceinline SignalWaitSet* Convert(hsa_amd_signal_wait_set_t set) {
+    return reinterpret_cast<SignalWaitSet*>(static_cast<uintptr_t>(set.handle));
+  }
+
+  SignalWaitSet() : ready_count_(0), unevented_(0) {}
+  ~SignalWaitSet();
+
+  /// @brief Registers a signal.  The signal is retained until it is removed or reported.
+  hsa_status_t Add(hsa_signal_t signal, hsa_signal_condition_t cond, hsa_signal_value_t value);
+
+  /// @brief Unregisters a signal without reporting it.
+  hsa_status_t Remove(hsa_signal_t signal);
+
+  /// @brief Waits until a member is satisfied, then removes and reports up to max_ready
+  /// satisfied members.  Returns with count zero on timeout or if the set is empty.
+  void Wait(uint64_t timeout, hsa_wait_state_t wait_hint, uint32_t max_ready,
+            hsa_signal_t* ready, hsa_signal_value_t* values, uint32_t* count);
+
+  uint32_t Count() const { return uint32_t(slot_of_.size()); }
+
+ private:
+  static const uint32_t kNoEvent = UINT32_MAX;
+
+  struct Member {
+    Signal* signal;  // nullptr for free slots.
+    hsa_signal_condition_t cond;
+    hsa_signal_value_t value;
+    uint32_t event;  // Index into events_ or kNoEvent.
+  };
+
+  static bool Satisfied(const Member& member, hsa_signal_value_t& value);
+
+  bool IsReady(uint32_t slot) const { return (ready_[slot / 64] >> (slot % 64)) & 1; }
+  void SetReady(uint32_t slot) {
+    ready_[slot / 64] |= uint64_t(1) << (slot % 64);
+    ready_count_++;
+  }
+  void ClearReady(uint32_t slot) {
+    if (!IsReady(slot)) return;
+    ready_[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    ready_count_--;
+  }
+
+  /// @brief Marks the slot ready if its condition holds.
+  void Poll(uint32_t slot);
+
+  /// @brief Checks every member.  Returns true if any member has another waiter.
+  bool PollAll();
+
+  /// @brief Moves up to max ready members to the output arrays.
+  void Harvest(uint32_t max, hsa_signal_t* ready, hsa_signal_value_t* values, uint32_t* count);
+
+  void ReleaseSlot(uint32_t slot);
+
+  std::vector<Member> members_;
+  std::vector<uint32_t> free_slots_;
+  std::unordered_map<uint64_t, uint32_t> slot_of_;
+
+  /// @variable Bitmap over members_ of slots found satisfied and not yet reported.
+  std::vector<uint64_t> ready_;
+  uint32_t ready_count_;
+
+  /// @variable Deduplicated interrupt events, their last observed ages and their members.
+  std::vector<HsaEvent*> events_;
+  std::vector<uint64_t> event_age_;
+  std::vector<uint64_t> prior_age_;
+  std::vector<std::vector<uint32_t>> event_members_;
+  std::unordered_map<HsaEvent*, uint32_t> event_index_;
+
+  /// @variable Number of members without an interrupt event.  Such members force polling.
+  uint32_t unevented_;
+
+  DISALLOW_COPY_AND_ASSIGN(SignalWaitSet);
+};
+
+/// @brief Hands out tagged completion signals and reports the tags of completed ones in batches.
+/// All signals share one interrupt event, so the consumer sleeps on a single event and a burst of
+/// completions costs one wakeup.  Signal creation may race with Dequeue(), calls to Dequeue() must
+/// be serialized by the caller.
+class CompletionQueue : public Checked<0x8F14B2E6C03D7A59> {
+ public:
+  static __forceinline hsa_amd_completion_queue_t Convert(CompletionQueue* queue) {
+    const hsa_amd_completion_queue_t handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(queue))};
+    return handle;
+  }
+  static __forceinline CompletionQueue* Convert(hsa_amd_completion_queue_t queue) {
+    return reinterpret_cast<CompletionQueue*>(static_cast<uintptr_t>(queue.handle));
+  }
+
+  explicit CompletionQueue(uint32_t size);
+  ~CompletionQueue();
+
+  /// @brief Creates a signal owned by the queue which reports tag once its value drops below 1.
+  hsa_status_t CreateSignal(hsa_signal_value_t initial_value, uint64_t tag, hsa_signal_t* signal);
+
+  /// @brief Waits until a signal completes, then reports and destroys up to max_records
+  /// completed signals.  Returns with count zero on timeout or if no signal is outstanding.
+  void Dequeue(uint64_t timeout, hsa_wait_state_t wait_hint, uint32_t max_records,
+               hsa_amd_completion_record_t* records, uint32_t* count);
+
+ private:
+  struct Entry {
+    Signal* signal;
+    uint64_t tag;
+  };
+
+  /// @brief Moves completed entries to records, keeping the rest in creation order.
+  void Reap(uint32_t max_records, hsa_amd_completion_record_t* records, uint32_t* count);
+
+  const uint32_t size_;
+
+  /// @variable Interrupt event shared by all signals, nullptr if they have to be polled.
+  HsaEvent* event_;
+  bool free_event_;
+
+  /// @variable Outstanding signals in creation order.
+  std::vector<Entry> pending_;
+  KernelMutex lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompletionQueue);
+};
+
+/// @brief Monotonic counter in fine grain system memory through which producers report partial
+/// progress.  The layout, hsa_amd_progress_counter_abi_t, is shared with producers.  Waiters spin,
+/// then publish their threshold and sleep until a producer crossing it raises the interrupt.
+/// Calls to Wait() must be serialized by the caller.
+class ProgressCounter : public Checked<0x3B9E6A1D57C4F208> {
+ public:
+  static __forceinline hsa_amd_progress_counter_t Convert(ProgressCounter* counter) {
+    const hsa_amd_progress_counter_t handle = {
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(counter))};
+    return handle;
+  }
+  static __forceinline ProgressCounter* Convert(hsa_amd_progress_counter_t counter) {
+    return reinterpret_cast<ProgressCounter*>(static_cast<uintptr_t>(counter.handle));
+  }
+
+  /// @brief Places the counter on the NUMA node nearest node_id.  Throws if it can not be
+  /// allocated.
+  ProgressCounter(int node_id, uint64_t initial_value, bool interrupt);
+  ~ProgressCounter();
+
+  hsa_amd_progress_counter_abi_t* abi() const { return abi_; }
+
+  /// @brief Waits until the value reaches threshold or the timeout expires and returns the value
+  /// observed last.
+  uint64_t Wait(uint64_t threshold, uint64_t timeout, hsa_wait_state_t wait_hint);
+
+ private:
+  hsa_amd_progress_counter_abi_t* abi_;
+
+  /// @variable Interrupt event raised by producers, nullptr if waiters have to poll.
+  HsaEvent* event_;
+  bool free_event_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProgressCounter);
+};
+
 class SignalDeleter {
  public:
   void operator()(Signal* ptr) { ptr->DestroySignal(); }
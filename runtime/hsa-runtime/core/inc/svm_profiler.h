@@ -43,27 +43,72 @@
 #ifndef HSA_RUNTME_CORE_INC_SVM_PROFILER_H_
 #define HSA_RUNTME_CORE_INC_SVM_PROFILER_H_
 
+#include <map>
+#include <memory>
 #include <vector>
 #include <string>
 #include <thread>
+#include "core/util/locks.h"
 #include "core/util/os.h"
+#include "inc/hsa_ext_amd.h"
 
 namespace rocr {
 namespace AMD {
 
+    // Watches fault driven migrations and settles ranges which bounce between agents by giving
+    // them a preferred location and letting the other agents access them in place.
+    // Only used from the SMI poll thread.
+    class SvmMigrationPolicy {
+    public:
+      explicit SvmMigrationPolicy(uint32_t threshold);
+
+      // Returns true if the event caused the attributes of a range to be changed.
+      bool Observe(const hsa_amd_svm_event_record_t& record);
+
+    private:
+      struct RangeState {
+        RangeState() : window_start(0), last_dst(0), bounces(0), lo(0), hi(0), settled(false) {}
+        uint64_t window_start;
+        uint32_t last_dst;
+        uint32_t bounces;
+        // Extent of the migrations seen, the only part known to be SVM.
+        uint64_t lo;
+        uint64_t hi;
+        bool settled;
+        std::map<uint32_t, uint32_t> demand;  // Faults and migrations by KFD gpu_id, 0 is CPU.
+      };
+
+      bool Settle(RangeState& range);
+
+      uint32_t threshold_;
+      uint32_t cpu_node_;
+      std::map<uint32_t, uint32_t> gpu_nodes_;  // KFD gpu_id to node id.
+      std::map<uint64_t, RangeState> ranges_;
+    };
+
     class SvmProfileControl {
     public:
       SvmProfileControl();
       ~SvmProfileControl();
 
+      // Copies up to max_ranges range counts in address order, returns the number of ranges.
+      uint32_t GetRanges(hsa_amd_svm_range_stats_t* ranges, uint32_t max_ranges);
+
     private:
       template <typename... Args> std::string format(const char* format, Args... arg);
       void PollSmi();
       static void PollSmiRun(void* profileControl);
+      // Adds an event to the counts of the ranges it touches.
+      void Aggregate(const hsa_amd_svm_event_record_t& record);
       int event;
       bool exit;
       os::Thread poll_smi_thread_;
       std::vector<char> format_buffer;
+      // Size of the counted address ranges, 0 if counting is disabled.
+      uint64_t granule_;
+      KernelMutex ranges_lock_;
+      std::map<uint64_t, hsa_amd_svm_range_stats_t> ranges_;
+      std::unique_ptr<SvmMigrationPolicy> policy_;
     };
 
 } // namespace AMD
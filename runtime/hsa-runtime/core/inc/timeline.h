@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+// Timeline trace of runtime activity in Chrome trace event format.
+
+#ifndef HSA_RUNTIME_CORE_INC_TIMELINE_H_
+#define HSA_RUNTIME_CORE_INC_TIMELINE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+
+#include "core/util/os.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+namespace core {
+
+/// @brief Records timestamped spans of runtime activity and writes them as a Chrome trace
+/// (JSON array format), which Perfetto and chrome://tracing both load.
+///
+/// Each thread appends to a ring of its own, so recording is two clock reads and a store.  Spans
+/// are drained to the file named by HSA_TIMELINE_TRACE on Flush and at shutdown.  A full ring
+/// drops new spans until the next flush.
+class Timeline {
+ public:
+  enum Event : uint32_t {
+    kQueueCreate,
+    kScratchAlloc,
+    kScratchFree,
+    kScratchReclaim,
+    kCopy,
+    kSignalWait,
+    kIpcAttach,
+    kCodeObjectLoad,
+    kEventCount
+  };
+
+  static __forceinline bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  static void Record(Event event, uint64_t start, uint64_t end, uint64_t arg);
+
+  /// @brief Opens the trace file if HSA_TIMELINE_TRACE is set and starts recording.
+  static void Start();
+
+  /// @brief Stops recording, writes out all spans and closes the trace file.
+  static void Stop();
+
+  /// @brief Writes out the spans recorded so far.
+  static void Flush();
+
+ private:
+  struct Span {
+    uint64_t start;
+    uint64_t end;
+    uint64_t arg;
+    Event event;
+  };
+
+  // Single producer, single consumer ring.  The owning thread advances tail, Flush advances head.
+  struct Buffer {
+    Span* spans;
+    uint64_t mask;
+    int tid;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+    std::atomic<uint64_t> dropped;
+    std::atomic<bool> retired;
+  };
+
+  // Registers the calling thread's ring and retires it at thread exit.
+  struct ThreadBuffer {
+    ThreadBuffer();
+    ~ThreadBuffer();
+    Buffer* buffer;
+  };
+
+  static void Drain(Buffer* buffer);
+
+  static std::atomic<bool> enabled_;
+};
+
+/// @brief Records the lifetime of the enclosing scope as a span when tracing is enabled.
+class TimelineSpan {
+ public:
+  __forceinline explicit TimelineSpan(Timeline::Event event, uint64_t arg = 0)
+      : event_(event), arg_(arg), start_(Timeline::Enabled() ? os::ReadAccurateClock() : 0) {}
+
+  __forceinline ~TimelineSpan() {
+    if (start_ != 0) Timeline::Record(event_, start_, os::ReadAccurateClock(), arg_);
+  }
+
+  void set_arg(uint64_t arg) { arg_ = arg; }
+
+ private:
+  Timeline::Event event_;
+  uint64_t arg_;
+  uint64_t start_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimelineSpan);
+};
+
+}  // namespace core
+}  // namespace rocr
+
+#endif  // HSA_RUNTIME_CORE_INC_TIMELINE_H_
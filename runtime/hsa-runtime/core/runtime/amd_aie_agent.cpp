@@ -316,6 +316,7 @@ void AieAgent::InitAllocators() {
       system_allocator_ =
           [region](size_t size, size_t align,
                    core::MemoryRegion::AllocateFlags alloc_flags) -> void * {
+        core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_INTERNAL);
         void *mem(nullptr);
         return (core::Runtime::runtime_singleton_->AllocateMemory(
                     region, size, alloc_flags, &mem) == HSA_STATUS_SUCCESS)
@@ -72,6 +72,9 @@ AieAqlQueue::AieAqlQueue(AieAgent *agent, size_t req_size_pkts,
         HSA_STATUS_ERROR_INVALID_AGENT,
         "Attempting to create an AIE queue on a non-AIE agent.");
   }
+  barrier_link_ = std::make_shared<BarrierLink>();
+  barrier_link_->queue = this;
+
   queue_size_bytes_ = req_size_pkts * sizeof(core::AqlPacket);
   ring_buf_ = agent_.system_allocator()(queue_size_bytes_, 4096,
                                         core::MemoryRegion::AllocateNoFlags);
@@ -99,6 +102,21 @@ AieAqlQueue::AieAqlQueue(AieAgent *agent, size_t req_size_pkts,
 
   auto &drv = static_cast<XdnaDriver &>(agent_.driver());
   drv.CreateQueue(*this);
+
+  // Packets complete on a thread of their own so ringing the doorbell does
+  // not wait for the NPU.
+  completion_event_ = os::CreateOsEvent(true, false);
+  if (completion_event_ != nullptr)
+    completion_thread_ = core::Runtime::runtime_singleton_->CreateThread(
+        HSA_AMD_THREAD_CLASS_BACKGROUND, CompletionRun, this);
+  if (completion_thread_ == nullptr) {
+    Inactivate();
+    agent_.system_deallocator()(ring_buf_);
+    if (completion_event_ != nullptr) os::DestroyOsEvent(completion_event_);
+    throw AMD::hsa_exception(
+        HSA_STATUS_ERROR_OUT_OF_RESOURCES,
+        "Could not start the completion thread of an AIE queue.");
+  }
 }
 
 AieAqlQueue::~AieAqlQueue() {
@@ -113,6 +131,12 @@ hsa_status_t AieAqlQueue::Inactivate() {
   hsa_status_t status(HSA_STATUS_SUCCESS);
 
   if (active) {
+    // Barrier dependencies resolving from here on must not resubmit.
+    {
+      ScopedAcquire<KernelMutex> lock(&barrier_link_->lock);
+      barrier_link_->queue = nullptr;
+    }
+    StopCompletionThread();
     auto &drv = static_cast<XdnaDriver &>(agent_.driver());
     status = drv.DestroyQueue(*this);
     hw_ctx_handle_ = std::numeric_limits<uint32_t>::max();
@@ -196,15 +220,35 @@ uint64_t AieAqlQueue::AddWriteIndexAcqRel(uint64_t value) {
 
 void AieAqlQueue::StoreRelaxed(hsa_signal_value_t value) {
   auto& driver = static_cast<XdnaDriver&>(agent_.driver());
-  SubmitCmd(driver, amd_queue_.hsa_queue.base_address, amd_queue_.read_dispatch_id,
-            amd_queue_.write_dispatch_id);
+  SubmitCmd(driver, amd_queue_.hsa_queue.base_address,
+            atomic::Load(&amd_queue_.write_dispatch_id, std::memory_order_acquire));
 }
 
-hsa_status_t AieAqlQueue::SubmitCmd(XdnaDriver& driver, void* queue_base, uint64_t read_dispatch_id,
+hsa_status_t AieAqlQueue::SubmitCmd(XdnaDriver& driver, void* queue_base,
                                     uint64_t write_dispatch_id) {
-  uint64_t cur_id = read_dispatch_id;
+  ScopedAcquire<KernelMutex> lock(&submit_lock_);
+  if (completion_exit_) return HSA_STATUS_ERROR_INVALID_QUEUE;
+
+  // A barrier waiting on a dependency holds back every packet behind it.
+  if (barrier_blocked_) return HSA_STATUS_SUCCESS;
+
+  const uint64_t queue_size = amd_queue_.hsa_queue.size;
+  auto packet = [&](uint64_t id) {
+    return static_cast<hsa_amd_aie_ert_packet_t*>(queue_base) + (id % queue_size);
+  };
+
+  uint64_t& cur_id = submit_index_;
   while (cur_id < write_dispatch_id) {
-    hsa_amd_aie_ert_packet_t* pkt = static_cast<hsa_amd_aie_ert_packet_t*>(queue_base) + cur_id;
+    hsa_amd_aie_ert_packet_t* pkt = packet(cur_id);
+
+    const uint16_t type = (pkt->header.header >> HSA_PACKET_HEADER_TYPE) &
+        ((1 << HSA_PACKET_HEADER_WIDTH_TYPE) - 1);
+    if (type == HSA_PACKET_TYPE_BARRIER_AND) {
+      if (!SubmitBarrier(reinterpret_cast<hsa_barrier_and_packet_t*>(pkt)))
+        return HSA_STATUS_SUCCESS;
+      cur_id++;
+      continue;
+    }
 
     // Get the packet header information
     if (pkt->header.header != HSA_PACKET_TYPE_VENDOR_SPECIFIC ||
@@ -215,25 +259,36 @@ hsa_status_t AieAqlQueue::SubmitCmd(XdnaDriver& driver, void* queue_base, uint64
     switch (pkt->opcode) {
       case HSA_AMD_AIE_ERT_START_CU: {
         // Iterating over future packets and seeing how many contiguous HSA_AMD_AIE_ERT_START_CU
-        // packets there are. All can be combined into a single chain.
+        // packets there are. All can be combined into a single chain, which may not wrap
+        // around the end of the ring.
         int num_cont_start_cu_pkts = 1;
         int num_operands = 0;
-        for (int peak_pkt_id = cur_id + 1; peak_pkt_id < write_dispatch_id; peak_pkt_id++) {
-          hsa_amd_aie_ert_packet_t* peak_pkt =
-              static_cast<hsa_amd_aie_ert_packet_t*>(queue_base) + peak_pkt_id;
-          if (peak_pkt->opcode != HSA_AMD_AIE_ERT_START_CU) {
+        for (uint64_t peak_pkt_id = cur_id + 1;
+             peak_pkt_id < write_dispatch_id && peak_pkt_id % queue_size != 0; peak_pkt_id++) {
+          hsa_amd_aie_ert_packet_t* peak_pkt = packet(peak_pkt_id);
+          if (peak_pkt->header.header != HSA_PACKET_TYPE_VENDOR_SPECIFIC ||
+              peak_pkt->opcode != HSA_AMD_AIE_ERT_START_CU) {
             break;
           }
           num_operands += GetOperandCount(peak_pkt->count);
           num_cont_start_cu_pkts++;
         }
 
+        Submission submission;
+        for (int i = 0; i < num_cont_start_cu_pkts; i++) {
+          const hsa_signal_t& signal = packet(cur_id + i)->completion_signal;
+          if (signal.handle != 0) submission.completion_signals.push_back(signal);
+        }
+
         // Call into the driver to submit from cur_id to write_dispatch_id
-        if (driver.SubmitCmdChain(pkt, num_cont_start_cu_pkts, num_operands, hw_ctx_handle_) !=
-            HSA_STATUS_SUCCESS)
+        if (driver.SubmitCmdChain(pkt, num_cont_start_cu_pkts, num_operands, hw_ctx_handle_,
+                                  submission.chain) != HSA_STATUS_SUCCESS)
           return HSA_STATUS_ERROR;
 
         cur_id += num_cont_start_cu_pkts;
+        submission.end_id = cur_id;
+        pending_.push_back(std::move(submission));
+        os::SetOsEvent(completion_event_);
         break;
       }
       default: {
@@ -245,6 +300,100 @@ hsa_status_t AieAqlQueue::SubmitCmd(XdnaDriver& driver, void* queue_base, uint64
   return HSA_STATUS_SUCCESS;
 }
 
+bool AieAqlQueue::SubmitBarrier(const hsa_barrier_and_packet_t* barrier) {
+  for (const hsa_signal_t& dep : barrier->dep_signal) {
+    if (dep.handle == 0) continue;
+    if (core::Signal::Convert(dep)->LoadAcquire() == 0) continue;
+
+    // The async event thread resumes submission once the dependency resolves,
+    // so neither the doorbell nor the completion thread blocks on it.
+    auto* link = new std::shared_ptr<BarrierLink>(barrier_link_);
+    if (core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
+            dep, HSA_SIGNAL_CONDITION_EQ, 0, BarrierHandler, link) != HSA_STATUS_SUCCESS) {
+      // Retried on the next doorbell.
+      delete link;
+      return false;
+    }
+    barrier_blocked_ = true;
+    return false;
+  }
+
+  // Retired in order behind the packets before it.
+  Submission submission;
+  submission.end_id = submit_index_ + 1;
+  if (barrier->completion_signal.handle != 0)
+    submission.completion_signals.push_back(barrier->completion_signal);
+  pending_.push_back(std::move(submission));
+  os::SetOsEvent(completion_event_);
+  return true;
+}
+
+bool AieAqlQueue::BarrierHandler(hsa_signal_value_t value, void* arg) {
+  auto* link = reinterpret_cast<std::shared_ptr<BarrierLink>*>(arg);
+  {
+    ScopedAcquire<KernelMutex> lock(&(*link)->lock);
+    AieAqlQueue* queue = (*link)->queue;
+    if (queue != nullptr) {
+      {
+        ScopedAcquire<KernelMutex> submit_lock(&queue->submit_lock_);
+        queue->barrier_blocked_ = false;
+      }
+      // Picks up at the barrier, which checks its remaining dependencies.
+      queue->StoreRelaxed(0);
+    }
+  }
+  delete link;
+  return false;
+}
+
+void AieAqlQueue::CompletionRun(void* queue) {
+  reinterpret_cast<AieAqlQueue*>(queue)->CompletionLoop();
+}
+
+void AieAqlQueue::CompletionLoop() {
+  auto& driver = static_cast<XdnaDriver&>(agent_.driver());
+  while (true) {
+    Submission* submission;
+    {
+      ScopedAcquire<KernelMutex> lock(&submit_lock_);
+      if (pending_.empty()) {
+        if (completion_exit_) return;
+        lock.Release();
+        os::WaitForOsEvent(completion_event_, 1000);
+        continue;
+      }
+      // Only this thread removes entries and appending keeps references valid.
+      submission = &pending_.front();
+    }
+
+    // Chains run in submission order on the context, so retiring in order
+    // advances the read index monotonically.
+    if (submission->chain.chain != nullptr &&
+        driver.WaitCmdChain(submission->chain) != HSA_STATUS_SUCCESS)
+      debug_warning(false && "AIE command chain failed.");
+    for (const hsa_signal_t& signal : submission->completion_signals)
+      core::Signal::Convert(signal)->SubRelease(1);
+    atomic::Store(&amd_queue_.read_dispatch_id, submission->end_id, std::memory_order_release);
+
+    ScopedAcquire<KernelMutex> lock(&submit_lock_);
+    pending_.pop_front();
+  }
+}
+
+void AieAqlQueue::StopCompletionThread() {
+  if (completion_thread_ == nullptr) return;
+  {
+    ScopedAcquire<KernelMutex> lock(&submit_lock_);
+    completion_exit_ = true;
+  }
+  os::SetOsEvent(completion_event_);
+  os::WaitForThread(completion_thread_);
+  os::CloseThread(completion_thread_);
+  os::DestroyOsEvent(completion_event_);
+  completion_thread_ = nullptr;
+  completion_event_ = nullptr;
+}
+
 void AieAqlQueue::StoreRelease(hsa_signal_value_t value) {
   std::atomic_thread_fence(std::memory_order_release);
   StoreRelaxed(value);
@@ -56,6 +56,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
 
 #include "core/inc/runtime.h"
 #include "core/inc/amd_memory_region.h"
@@ -69,12 +70,20 @@
 #include "core/inc/amd_gpu_pm4.h"
 #include "core/inc/hsa_amd_tool_int.hpp"
 #include "core/inc/amd_core_dump.hpp"
+#include "core/inc/metrics.h"
 
 namespace rocr {
 namespace AMD {
 
+namespace {
+uint64_t ClockToNs(uint64_t ticks) {
+  return uint64_t(double(ticks) * 1e9 / double(os::AccurateClockFrequency()));
+}
+}  // namespace
+
 AqlQueue::AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id, ScratchInfo& scratch,
-                   core::HsaEventCallback callback, void* err_data, bool is_kv)
+                   core::HsaEventCallback callback, void* err_data, bool is_kv,
+                   bool device_ring, const core::Agent* host_agent)
     : Queue(agent->node_id(), agent->isMES() ? (MemoryRegion::AllocateGTTAccess | MemoryRegion::AllocateNonPaged) : 0),
       LocalSignal(0, false),
       DoorbellSignal(signal()),
@@ -82,16 +91,37 @@ AqlQueue::AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id, Scr
       ring_buf_alloc_bytes_(0),
       queue_id_(HSA_QUEUEID(-1)),
       active_(false),
+      combine_window_(0),
+      combine_published_(0),
+      combine_rung_(0),
       agent_(agent),
       queue_scratch_(scratch),
+      telemetry_(),
+      telemetry_read_index_(0),
+      telemetry_time_(0),
+      telemetry_stall_start_(0),
+      initial_size_pkts_(0),
+      high_water_hits_(0),
       errors_callback_(callback),
       errors_data_(err_data),
       is_kv_queue_(is_kv),
+      host_agent_(host_agent),
+      host_allocator_(agent->SystemAllocatorFor(host_agent)),
       pm4_ib_buf_(nullptr),
       pm4_ib_size_b_(0x1000),
+      dispatch_mask_buf_(nullptr),
+      profile_ib_buf_(nullptr),
+      kernarg_ring_buf_(nullptr),
+      ts_ring_(nullptr),
+      ts_ring_head_(0),
+      ts_ring_tail_(0),
+      ts_ring_dropped_(0),
       dynamicScratchState(0),
       exceptionState(0),
       suspended_(false),
+      preempted_(false),
+      requested_priority_(HSA_QUEUE_PRIORITY_NORMAL),
+      priority_pending_(false),
       priority_(HSA_QUEUE_PRIORITY_NORMAL),
       exception_signal_(nullptr) {
   // When queue_full_workaround_ is set to 1, the ring buffer is internally
@@ -117,6 +147,7 @@ AqlQueue::AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id, Scr
   uint32_t queue_size_pkts = uint32_t(req_size_pkts);
   queue_size_pkts = Min(queue_size_pkts, max_pkts);
   queue_size_pkts = Max(queue_size_pkts, min_pkts);
+  initial_size_pkts_ = queue_size_pkts;
 
   uint32_t queue_size_bytes = queue_size_pkts * sizeof(core::AqlPacket);
   if ((queue_size_bytes & (queue_size_bytes - 1)) != 0)
@@ -124,6 +155,8 @@ AqlQueue::AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id, Scr
                              "Requested queue with non-power of two packet capacity.\n");
 
   // Allocate the AQL packet ring buffer.
+  assert(host_allocator_ && "Queue host agent has no kernarg pool.");
+  setDeviceRing(device_ring);
   AllocRegisteredRingBuffer(queue_size_pkts);
   if (ring_buf_ == nullptr) throw std::bad_alloc();
   MAKE_NAMED_SCOPE_GUARD(RingGuard, [&]() { FreeRegisteredRingBuffer(); });
@@ -328,8 +361,7 @@ AqlQueue::AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id, Scr
   }
 
   // Allocate IB for icache flushes.
-  pm4_ib_buf_ =
-      agent_->system_allocator()(pm4_ib_size_b_, 0x1000, core::MemoryRegion::AllocateExecutable);
+  pm4_ib_buf_ = host_allocator_(pm4_ib_size_b_, 0x1000, core::MemoryRegion::AllocateExecutable);
   if (pm4_ib_buf_ == nullptr)
     throw AMD::hsa_exception(HSA_STATUS_ERROR_OUT_OF_RESOURCES, "PM4 IB allocation failed.\n");
 
@@ -341,6 +373,19 @@ AqlQueue::AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id, Scr
   active_ = true;
   setPcieOrdering(agent->is_xgmi_cpu_gpu());
 
+  // Publish the inline paths used by hsa_queue_add_write_index_* and hsa_signal_store_* when
+  // the write index and doorbell are plain hardware-visible stores.
+  setDirectWriteIndex(true);
+  // Fenced rings get their own kind so the check is resolved here rather than per doorbell.
+  // Combined doorbells must reach StoreRelaxed, so they keep the object path.
+  const uint32_t combine_ns = core::Runtime::runtime_singleton_->flag().doorbell_combine_ns();
+  if (doorbell_type_ == 2 && combine_ns != 0)
+    combine_window_ = Max<uint64_t>(1, uint64_t(combine_ns) * os::AccurateClockFrequency() /
+                                           1000000000ull);
+  else if (doorbell_type_ == 2)
+    signal()->host_store = needsRingFence() ? core::SharedSignal::kHostStoreDoorbellFenced
+                                            : core::SharedSignal::kHostStoreDoorbell;
+
   PM4IBGuard.Dismiss();
   RingGuard.Dismiss();
   QueueGuard.Dismiss();
@@ -349,6 +394,9 @@ AqlQueue::AqlQueue(GpuAgent* agent, size_t req_size_pkts, HSAuint32 node_id, Scr
 }
 
 AqlQueue::~AqlQueue() {
+  // Stop agent-driven scratch management from reaching this queue.
+  agent_->RemoveAqlQueue(this);
+
   // Remove error handler synchronously.
   // Sequences error handler callbacks with queue destroy.
   dynamicScratchState |= ERROR_HANDLER_TERMINATE;
@@ -385,6 +433,10 @@ AqlQueue::~AqlQueue() {
     }
   }
   agent_->system_deallocator()(pm4_ib_buf_);
+  if (dispatch_mask_buf_ != nullptr) agent_->system_deallocator()(dispatch_mask_buf_);
+  if (profile_ib_buf_ != nullptr) agent_->system_deallocator()(profile_ib_buf_);
+  if (kernarg_ring_buf_ != nullptr) agent_->system_deallocator()(kernarg_ring_buf_);
+  if (ts_ring_ != nullptr) agent_->system_deallocator()(ts_ring_);
 }
 
 void AqlQueue::Destroy() {
@@ -392,9 +444,71 @@ void AqlQueue::Destroy() {
     agent_->GWSRelease();
     return;
   }
+  if (agent_->PoolQueue(this)) return;
   delete this;
 }
 
+bool AqlQueue::ResetForReuse() {
+  if (!active_ || suspended_ || preempted_ || dynamicScratchState != 0 || exceptionState != 0)
+    return false;
+  if (LoadReadIndexAcquire() != LoadWriteIndexRelaxed()) return false;
+  if (HSA::hsa_signal_load_relaxed(amd_queue_.queue_inactive_signal) != 0) return false;
+
+  // A queue that repeatedly ran near full is handed to its next owner with twice the ring.
+  const uint32_t grow_hits = core::Runtime::runtime_singleton_->flag().queue_grow_hits();
+  uint32_t max_pkts = 0;
+  agent_->GetInfo(HSA_AGENT_INFO_QUEUE_MAX_SIZE, &max_pkts);
+  if (grow_hits != 0 && high_water_hits_ >= grow_hits && amd_queue_.hsa_queue.size < max_pkts &&
+      !GrowRing(amd_queue_.hsa_queue.size * 2))
+    debug_print("Queue %lu ring growth failed, keeping %u packets.\n", amd_queue_.hsa_queue.id,
+                amd_queue_.hsa_queue.size);
+  high_water_hits_ = 0;
+
+  // All packets have been consumed, so the ring may be rewritten.
+  const uint32_t queue_size_pkts = amd_queue_.hsa_queue.size;
+  for (uint32_t pkt_id = 0; pkt_id < queue_size_pkts; ++pkt_id) {
+    (((core::AqlPacket*)ring_buf_)[pkt_id]).dispatch.header = HSA_PACKET_TYPE_INVALID;
+  }
+
+  // The next owner has to ask for its own timestamp ring.
+  if (ts_ring_ != nullptr) {
+    agent_->system_deallocator()(ts_ring_);
+    ts_ring_ = nullptr;
+    ts_ring_packet_ids_.clear();
+    ts_ring_head_ = ts_ring_tail_ = ts_ring_dropped_ = 0;
+  }
+
+  {
+    // The next owner starts with fresh telemetry.
+    ScopedAcquire<KernelMutex> lock(&telemetry_lock_);
+    telemetry_ = {};
+    telemetry_time_ = telemetry_stall_start_ = 0;
+  }
+
+  SetProfiling(false);
+  if ((priority_ != HSA_QUEUE_PRIORITY_NORMAL || priority_pending_) &&
+      UpdatePriority(HSA_QUEUE_PRIORITY_NORMAL) != HSA_STATUS_SUCCESS)
+    return false;
+  if (!core::Runtime::runtime_singleton_->flag().cu_mask_skip_init()) {
+    hsa_status_t err = SetCUMasking(0, nullptr);
+    if (err != HSA_STATUS_SUCCESS && err != hsa_status_t(HSA_STATUS_CU_MASK_REDUCED)) return false;
+  }
+
+  // Scratch bound to the queue can only be handed back with asynchronous reclaim, otherwise the
+  // next owner inherits it.
+  ScopedAcquire<KernelMutex> lock(&scratch_lock_);
+  AsyncReclaimMainScratch();
+  AsyncReclaimAltScratch();
+  memset(&queue_scratch_.demand, 0, sizeof(queue_scratch_.demand));
+  queue_scratch_.demand.predicted_size = queue_scratch_.main_size;
+  return true;
+}
+
+void AqlQueue::Reuse(core::HsaEventCallback callback, void* err_data) {
+  errors_callback_ = callback;
+  errors_data_ = err_data;
+}
+
 uint64_t AqlQueue::LoadReadIndexAcquire() {
   return atomic::Load(&amd_queue_.read_dispatch_id, std::memory_order_acquire);
 }
@@ -417,6 +531,8 @@ void AqlQueue::StoreWriteIndexRelaxed(uint64_t value) {
 }
 
 void AqlQueue::StoreWriteIndexRelease(uint64_t value) {
+  // Release ordering does not cover write-combined stores to a device ring.
+  if (needsRingFence()) _mm_sfence();
   atomic::Store(&amd_queue_.write_dispatch_id, value,
                 std::memory_order_release);
 }
@@ -459,12 +575,49 @@ uint64_t AqlQueue::AddWriteIndexRelease(uint64_t value) {
 }
 
 void AqlQueue::StoreRelaxed(hsa_signal_value_t value) {
+  // Drain write-combined packet stores to a device ring before the doorbell reaches the CP.
+  if (needsRingFence()) _mm_sfence();
+
   if (doorbell_type_ == 2) {
+    if (combine_window_ != 0) {
+      CombineDoorbell(uint64_t(value));
+      return;
+    }
     // Hardware doorbell supports AQL semantics.
     atomic::Store(signal_.hardware_doorbell_ptr, uint64_t(value), std::memory_order_release);
     return;
   }
+  StoreLegacyDoorbell(value);
+}
+
+void AqlQueue::CombineDoorbell(uint64_t value) {
+  // The packet processor stops at the first INVALID header, so ringing for the highest published
+  // index also covers every lower one.
+  uint64_t published = combine_published_.load(std::memory_order_relaxed);
+  while (published < value + 1 &&
+         !combine_published_.compare_exchange_weak(published, value + 1,
+                                                   std::memory_order_acq_rel)) {
+  }
 
+  // Whoever takes the lock rings for everyone.  Values published after the ringer's last look
+  // are caught by the re-check once it lets go, so no submitter has to wait for its ring.
+  while (combine_published_.load(std::memory_order_acquire) >
+             combine_rung_.load(std::memory_order_acquire) &&
+         combine_lock_.Try()) {
+    // Give concurrent submitters a bounded window to publish before paying for the MMIO write.
+    const uint64_t deadline = os::ReadAccurateClock() + combine_window_;
+    while (os::ReadAccurateClock() < deadline) _mm_pause();
+
+    const uint64_t target = combine_published_.load(std::memory_order_acquire);
+    if (target > combine_rung_.load(std::memory_order_relaxed)) {
+      atomic::Store(signal_.hardware_doorbell_ptr, target - 1, std::memory_order_release);
+      combine_rung_.store(target, std::memory_order_release);
+    }
+    combine_lock_.Release();
+  }
+}
+
+void AqlQueue::StoreLegacyDoorbell(hsa_signal_value_t value) {
   // Acquire spinlock protecting the legacy doorbell.
   while (atomic::Cas(&amd_queue_.legacy_doorbell_lock, 1U, 0U,
                      std::memory_order_acquire) != 0) {
@@ -547,12 +700,117 @@ hsa_status_t AqlQueue::GetInfo(hsa_queue_info_attribute_t attribute, void* value
       else
         return HSA_STATUS_ERROR_INVALID_QUEUE;
       break;
+    case HSA_AMD_QUEUE_INFO_SCRATCH_DEMAND_HISTOGRAM: {
+      ScopedAcquire<KernelMutex> lock(&scratch_lock_);
+      memcpy(value, queue_scratch_.demand.count, sizeof(queue_scratch_.demand.count));
+      break;
+    }
+    case HSA_AMD_QUEUE_INFO_TELEMETRY: {
+      ScopedAcquire<KernelMutex> lock(&telemetry_lock_);
+      hsa_amd_queue_telemetry_t* telemetry = reinterpret_cast<hsa_amd_queue_telemetry_t*>(value);
+      *telemetry = telemetry_;
+      if (telemetry_stall_start_ != 0)
+        telemetry->stall_ns = ClockToNs(os::ReadAccurateClock() - telemetry_stall_start_);
+      break;
+    }
     default:
       return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   }
   return HSA_STATUS_SUCCESS;
 }
 
+hsa_status_t AqlQueue::AllocKernarg(size_t size, size_t alignment, uint64_t packet_id,
+                                    void** kernarg_address) {
+  // Ring holds kernarg_ring_packet_bytes of kernargs per queue slot on average.
+  const size_t kernarg_ring_packet_bytes = 256;
+  const size_t kernarg_ring_min_bytes = 64 * 1024;
+
+  if (size == 0 || alignment == 0 || !IsPowerOfTwo(alignment) || alignment > 4096)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  ScopedAcquire<KernelMutex> lock(&kernarg_ring_lock_);
+  if (kernarg_ring_buf_ == nullptr) {
+    size_t ring_bytes = size_t(amd_queue_.hsa_queue.size) * kernarg_ring_packet_bytes;
+    if (ring_bytes < kernarg_ring_min_bytes) ring_bytes = kernarg_ring_min_bytes;
+    kernarg_ring_buf_ = host_allocator_(ring_bytes, 0x1000, core::MemoryRegion::AllocateNoFlags);
+    if (kernarg_ring_buf_ == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+    kernarg_ring_.init(kernarg_ring_buf_, ring_bytes, amd_queue_.hsa_queue.size);
+  }
+
+  // Large kernargs would starve the ring, they belong in the kernarg pool.
+  if (size > kernarg_ring_.size() / 4) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  *kernarg_address = kernarg_ring_.alloc(size, alignment, packet_id, LoadReadIndexAcquire());
+  return (*kernarg_address != nullptr) ? HSA_STATUS_SUCCESS : HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+}
+
+hsa_status_t AqlQueue::EnableDispatchTimestamps(uint32_t record_count) {
+  ScopedAcquire<KernelMutex> lock(&ts_ring_lock_);
+  if (ts_ring_ != nullptr) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  ts_ring_ = reinterpret_cast<amd_signal_t*>(host_allocator_(
+      size_t(record_count) * sizeof(amd_signal_t), 0x1000, core::MemoryRegion::AllocateNoFlags));
+  if (ts_ring_ == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  memset(ts_ring_, 0, size_t(record_count) * sizeof(amd_signal_t));
+  for (uint32_t i = 0; i < record_count; i++) ts_ring_[i].kind = AMD_SIGNAL_KIND_USER;
+  ts_ring_packet_ids_.resize(record_count);
+
+  SetProfiling(true);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t AqlQueue::AllocDispatchTimestamp(uint64_t packet_id, hsa_signal_t* signal) {
+  ScopedAcquire<KernelMutex> lock(&ts_ring_lock_);
+  if (ts_ring_ == nullptr) return HSA_STATUS_ERROR_INVALID_QUEUE;
+
+  const uint64_t size = ts_ring_packet_ids_.size();
+  if (ts_ring_head_ - ts_ring_tail_ == size) {
+    // Overwrite the oldest unread record, but only once the CP is done with it.
+    if (atomic::Load(&ts_ring_[ts_ring_tail_ % size].value, std::memory_order_acquire) != 0)
+      return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+    ts_ring_tail_++;
+    ts_ring_dropped_++;
+  }
+
+  amd_signal_t& record = ts_ring_[ts_ring_head_ % size];
+  record.start_ts = record.end_ts = 0;
+  // Published to the CP by the release store of the packet header.
+  atomic::Store(&record.value, int64_t(1), std::memory_order_relaxed);
+  ts_ring_packet_ids_[ts_ring_head_ % size] = packet_id;
+  ts_ring_head_++;
+
+  signal->handle = reinterpret_cast<uint64_t>(&record);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t AqlQueue::ReadDispatchTimestamps(uint32_t max_records,
+                                              hsa_amd_dispatch_timestamp_t* records,
+                                              uint32_t* record_count, uint64_t* dropped) {
+  ScopedAcquire<KernelMutex> lock(&ts_ring_lock_);
+  if (ts_ring_ == nullptr) return HSA_STATUS_ERROR_INVALID_QUEUE;
+
+  const uint64_t size = ts_ring_packet_ids_.size();
+  uint32_t count = 0;
+  while (count < max_records && ts_ring_tail_ != ts_ring_head_) {
+    const amd_signal_t& record = ts_ring_[ts_ring_tail_ % size];
+    if (atomic::Load(&record.value, std::memory_order_acquire) != 0) break;
+
+    // Translate the end time first, as GpuAgent::TranslateTime(signal, time) does.
+    records[count].packet_id = ts_ring_packet_ids_[ts_ring_tail_ % size];
+    records[count].end = agent_->TranslateTime(record.end_ts);
+    records[count].start = agent_->TranslateTime(record.start_ts);
+    count++;
+    ts_ring_tail_++;
+  }
+
+  *record_count = count;
+  if (dropped != nullptr) {
+    *dropped = ts_ring_dropped_;
+    ts_ring_dropped_ = 0;
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
 uint32_t AqlQueue::ComputeRingBufferMinPkts() {
   // From CP_HQD_PQ_CONTROL.QUEUE_SIZE specification:
   //   Size of the primary queue (PQ) will be: 2^(HQD_QUEUE_SIZE+1) DWs.
@@ -723,11 +981,12 @@ void AqlQueue::AllocRegisteredRingBuffer(uint32_t queue_size_pkts) {
     ring_buf_alloc_bytes_ = queue_size_pkts * sizeof(core::AqlPacket);
     assert(IsMultipleOf(ring_buf_alloc_bytes_, 4096) && "Ring buffer sizes must be 4KiB aligned.");
 
-    if (core::Runtime::runtime_singleton_->flag().dev_mem_queue()) {
+    core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_RING_BUFFER);
+    if (deviceRing()) {
       ring_buf_ = agent_->finegrain_allocator()(ring_buf_alloc_bytes_,
                                                 core::MemoryRegion::AllocateUncached);
     } else {
-      ring_buf_ = agent_->system_allocator()(
+      ring_buf_ = host_allocator_(
           ring_buf_alloc_bytes_, 0x1000,
           core::MemoryRegion::AllocateExecutable |
           (queue_full_workaround_ ? core::MemoryRegion::AllocateDoubleMap : 0));
@@ -753,7 +1012,7 @@ void AqlQueue::FreeRegisteredRingBuffer() {
 #endif
   } else {
     if (ring_buf_) {
-      if (core::Runtime::runtime_singleton_->flag().dev_mem_queue()) {
+      if (deviceRing()) {
         agent_->finegrain_deallocator()(ring_buf_);
       } else {
         agent_->system_deallocator()(ring_buf_);
@@ -765,6 +1024,39 @@ void AqlQueue::FreeRegisteredRingBuffer() {
   ring_buf_alloc_bytes_ = 0;
 }
 
+bool AqlQueue::GrowRing(uint32_t queue_size_pkts) {
+  void* ring = ring_buf_;
+  uint32_t ring_bytes = ring_buf_alloc_bytes_;
+
+  ring_buf_ = nullptr;
+  AllocRegisteredRingBuffer(queue_size_pkts);
+  // The queue is idle, read and write indices carry over and wrap at the new size.
+  const bool attached = ring_buf_ != nullptr &&
+      hsaKmtUpdateQueue(queue_id_, 100, priority_, ring_buf_, ring_buf_alloc_bytes_, NULL) ==
+          HSAKMT_STATUS_SUCCESS;
+
+  // Release whichever ring is not kept.
+  if (attached) {
+    std::swap(ring_buf_, ring);
+    std::swap(ring_buf_alloc_bytes_, ring_bytes);
+  }
+  if (ring_buf_ != nullptr) FreeRegisteredRingBuffer();
+  ring_buf_ = ring;
+  ring_buf_alloc_bytes_ = ring_bytes;
+  if (!attached) return false;
+
+  amd_queue_.hsa_queue.base_address = ring_buf_;
+  amd_queue_.hsa_queue.size = queue_size_pkts;
+
+  // The kernarg ring is sized by packet slots, the next AllocKernarg sizes a new one.
+  ScopedAcquire<KernelMutex> lock(&kernarg_ring_lock_);
+  if (kernarg_ring_buf_ != nullptr) {
+    agent_->system_deallocator()(kernarg_ring_buf_);
+    kernarg_ring_buf_ = nullptr;
+  }
+  return true;
+}
+
 void AqlQueue::CloseRingBufferFD(const char* ring_buf_shm_path, int fd) const {
 #ifdef __linux__
 #if !defined(HAVE_MEMFD_CREATE)
@@ -827,11 +1119,54 @@ hsa_status_t AqlQueue::SetPriority(HSA_QUEUE_PRIORITY priority) {
     return HSA_STATUS_ERROR_INVALID_QUEUE;
   }
 
+  if (core::Runtime::runtime_singleton_->flag().queue_priority_interval() != 0) {
+    {
+      ScopedAcquire<KernelMutex> lock(&preempt_lock_);
+      requested_priority_ = priority;
+      priority_pending_ = true;
+    }
+    // Only the latest request per queue reaches the driver.
+    if (!agent_->RequestPriorityUpdate()) ApplyPendingPriority();
+    return HSA_STATUS_SUCCESS;
+  }
+  return UpdatePriority(priority);
+}
+
+hsa_status_t AqlQueue::UpdatePriority(HSA_QUEUE_PRIORITY priority) {
+  ScopedAcquire<KernelMutex> lock(&preempt_lock_);
+  priority_pending_ = false;
   priority_ = priority;
-  auto err = hsaKmtUpdateQueue(queue_id_, 100, priority_, ring_buf_, ring_buf_alloc_bytes_, NULL);
+  auto err = hsaKmtUpdateQueue(queue_id_, preempted_ ? 0 : 100, priority_, ring_buf_,
+                               ring_buf_alloc_bytes_, NULL);
   return (err == HSAKMT_STATUS_SUCCESS ? HSA_STATUS_SUCCESS : HSA_STATUS_ERROR_OUT_OF_RESOURCES);
 }
 
+void AqlQueue::ApplyPendingPriority() {
+  ScopedAcquire<KernelMutex> lock(&preempt_lock_);
+  if (!priority_pending_) return;
+  priority_pending_ = false;
+  if (suspended_ || !active_ || requested_priority_ == priority_) return;
+
+  priority_ = requested_priority_;
+  auto err = hsaKmtUpdateQueue(queue_id_, preempted_ ? 0 : 100, priority_, ring_buf_,
+                               ring_buf_alloc_bytes_, NULL);
+  if (err != HSAKMT_STATUS_SUCCESS) debug_warning("Deferred queue priority update failed.");
+}
+
+hsa_status_t AqlQueue::SetSuspended(bool suspended) {
+  ScopedAcquire<KernelMutex> lock(&preempt_lock_);
+  if (!active_ || suspended_) return HSA_STATUS_ERROR_INVALID_QUEUE;
+  if (preempted_ == suspended) return HSA_STATUS_SUCCESS;
+
+  // A zero queue percentage unmaps the queue.  KFD preempts it through CWSR before returning, so
+  // the waves in flight resume where they stopped once the queue is mapped again.
+  auto err = hsaKmtUpdateQueue(queue_id_, suspended ? 0 : 100, priority_, ring_buf_,
+                               ring_buf_alloc_bytes_, NULL);
+  if (err != HSAKMT_STATUS_SUCCESS) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  preempted_ = suspended;
+  return HSA_STATUS_SUCCESS;
+}
+
 void AqlQueue::CheckScratchLimits() {
   auto& scratch = queue_scratch_;
   if (!scratch.async_reclaim) return;
@@ -862,6 +1197,7 @@ void AqlQueue::FreeMainScratchSpace() {
 void AqlQueue::AsyncReclaimMainScratch() {
   auto& scratch = queue_scratch_;
   if (!scratch.async_reclaim || !scratch.main_size) return;
+  core::TimelineSpan span(core::Timeline::kScratchReclaim, 0);
 
   // Notify CP that we are trying to reclaim scratch. CP will assume scratch is reclaimed on next
   // dispatch
@@ -885,6 +1221,103 @@ void AqlQueue::AsyncReclaimMainScratch() {
   }
 }
 
+size_t AqlQueue::ScratchMonitorTick() {
+  // Ticks without a scratch request before the demand histogram is aged.
+  const uint32_t decay_ticks = 10;
+  // Consecutive idle ticks main scratch must stay above twice the prediction before it is
+  // reclaimed.
+  const uint32_t shrink_ticks = 3;
+  // Consecutive idle ticks before a shared arena lease is returned.
+  const uint32_t lease_ticks = 2;
+
+  const bool elastic = core::Runtime::runtime_singleton_->flag().scratch_elastic();
+  const bool shared = core::Runtime::runtime_singleton_->flag().scratch_shared();
+
+  // Never stall the monitor behind the event handler, try again on the next tick.
+  if (!scratch_lock_.Try()) return 0;
+  MAKE_SCOPE_GUARD([&]() { scratch_lock_.Release(); });
+
+  auto& scratch = queue_scratch_;
+  auto& demand = scratch.demand;
+
+  const bool idle = LoadReadIndexRelaxed() == LoadWriteIndexRelaxed();
+  demand.queue_idle_ticks = idle ? demand.queue_idle_ticks + 1 : 0;
+
+  // Shared arena: scratch is leased while the queue has work.  Hand it back to the agent's cache
+  // once the queue has been idle for a while so other queues can bind the same memory; the next
+  // scratch dispatch on this queue traps and leases again, normally from the cache.
+  // Use-once scratch is already returned after every dispatch.
+  if (shared && demand.queue_idle_ticks >= lease_ticks) {
+    if (!scratch.large) AsyncReclaimMainScratch();
+    AsyncReclaimAltScratch();
+  }
+
+  if (!elastic) return 0;
+
+  if (++demand.idle_ticks == decay_ticks) {
+    demand.idle_ticks = 0;
+    demand.decay();
+    if (demand.predict(90) == 0) demand.predicted_size = 0;
+  }
+
+  if (idle && !scratch.large && scratch.main_size > 2 * demand.predicted_size) {
+    if (++demand.over_ticks >= shrink_ticks) {
+      demand.over_ticks = 0;
+      AsyncReclaimMainScratch();
+    }
+  } else {
+    demand.over_ticks = 0;
+  }
+
+  // Only ask for warm cache when the queue does not already hold enough scratch.
+  return (scratch.main_size < demand.predicted_size) ? demand.predicted_size : 0;
+}
+
+void AqlQueue::SampleTelemetry(uint64_t now) {
+  const uint64_t read = LoadReadIndexRelaxed();
+  const uint64_t write = LoadWriteIndexRelaxed();
+  // Reserved slots whose packets are not yet published count as pending.
+  const uint64_t depth = (write > read) ? write - read : 0;
+  core::Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_QUEUE_DEPTH, depth);
+
+  ScopedAcquire<KernelMutex> lock(&telemetry_lock_);
+  auto& info = telemetry_;
+  info.samples++;
+  info.depth = depth;
+  info.peak_depth = Max(info.peak_depth, depth);
+  info.occupancy = uint32_t(Min<uint64_t>(depth, amd_queue_.hsa_queue.size) * 100 /
+                            amd_queue_.hsa_queue.size);
+
+  if (telemetry_time_ != 0 && now > telemetry_time_) {
+    info.packets_per_second = uint64_t(double(read - telemetry_read_index_) *
+                                       double(os::AccurateClockFrequency()) /
+                                       double(now - telemetry_time_));
+
+    // A stall started when the read index was last seen to move.
+    if (depth != 0 && read == telemetry_read_index_) {
+      if (telemetry_stall_start_ == 0) telemetry_stall_start_ = telemetry_time_;
+      info.stall_ns = ClockToNs(now - telemetry_stall_start_);
+      info.max_stall_ns = Max(info.max_stall_ns, info.stall_ns);
+    } else if (telemetry_stall_start_ != 0) {
+      core::Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_QUEUE_STALL_MS,
+                            ClockToNs(now - telemetry_stall_start_) / 1000000);
+      telemetry_stall_start_ = 0;
+      info.stall_ns = 0;
+    }
+  }
+
+  telemetry_read_index_ = read;
+  telemetry_time_ = now;
+}
+
+uint64_t AqlQueue::SampleHighWater() {
+  const uint64_t read = LoadReadIndexRelaxed();
+  const uint64_t write = LoadWriteIndexRelaxed();
+  const uint64_t depth = (write > read) ? write - read : 0;
+  if (depth * 4 >= uint64_t(amd_queue_.hsa_queue.size) * 3) high_water_hits_++;
+  return depth;
+}
+
 void AqlQueue::FreeAltScratchSpace() {
   auto& scratch = queue_scratch_;
   agent_->ReleaseQueueAltScratch(scratch);
@@ -899,6 +1332,7 @@ void AqlQueue::FreeAltScratchSpace() {
 void AqlQueue::AsyncReclaimAltScratch() {
   auto& scratch = queue_scratch_;
   if (!scratch.async_reclaim || !scratch.alt_size) return;
+  core::TimelineSpan span(core::Timeline::kScratchReclaim, 1);
 
   // Notify CP that we are trying to reclaim scratch. CP will assume scratch is reclaimed on next
   // dispatch
@@ -924,7 +1358,10 @@ void AqlQueue::AsyncReclaimAltScratch() {
 
 void AqlQueue::HandleInsufficientScratch(hsa_signal_value_t& error_code,
                                          hsa_signal_value_t& waitVal, bool& changeWait) {
+  core::Metrics::Count(HSA_AMD_RUNTIME_COUNTER_SCRATCH_TRAPS);
+
   // Insufficient scratch - recoverable, don't process dynamic scratch if errors are present.
+  ScopedAcquire<KernelMutex> lock(&scratch_lock_);
   auto& scratch = queue_scratch_;
 
   /*******************************************************************************************
@@ -1047,6 +1484,7 @@ void AqlQueue::HandleInsufficientScratch(hsa_signal_value_t& error_code,
 
   tool::notify_event_scratch_alloc_start(
       public_handle(), HSA_AMD_EVENT_SCRATCH_ALLOC_FLAG_NONE, dispatch_id);
+  core::TimelineSpan span(core::Timeline::kScratchAlloc, dispatch_id);
 
   uint32_t device_slots = calc_device_slots();
   uint32_t groups = calc_dispatch_groups(*pkt);
@@ -1063,6 +1501,9 @@ void AqlQueue::HandleInsufficientScratch(hsa_signal_value_t& error_code,
   const uint64_t device_size = size_per_thread * lanes_per_wave * device_slots;
   const uint64_t dispatch_size = size_per_thread * lanes_per_wave * dispatch_slots;
 
+  const bool elastic = core::Runtime::runtime_singleton_->flag().scratch_elastic();
+  if (elastic) scratch.demand.record(size_per_thread);
+
   // scratch.use_alt_limit will be 0 if alt scratch is not supported or disabled
   if (dispatch_size < scratch.use_alt_limit && dispatch_slots < device_slots) {
     // Try to use ALT scratch
@@ -1102,6 +1543,22 @@ void AqlQueue::HandleInsufficientScratch(hsa_signal_value_t& error_code,
   scratch.dispatch_size = dispatch_size;
   scratch.dispatch_slots = dispatch_slots;
 
+  if (elastic) {
+    // Size main scratch for the bulk of recent demand rather than only this dispatch so that a
+    // stream of slightly larger kernels does not trap and regrow one after another.  Only grow
+    // within the use-once limit, where the allocation stays bound to the queue.
+    const uint64_t align = scratch.mem_alignment_size / lanes_per_wave;
+    const uint64_t predicted_per_thread =
+        AlignUp(scratch.demand.predict(90), align);
+    const uint64_t predicted_size = predicted_per_thread * lanes_per_wave * device_slots;
+    if (predicted_per_thread > size_per_thread && predicted_size <= scratch.use_once_limit) {
+      scratch.main_size = predicted_size;
+      scratch.main_size_per_thread = predicted_per_thread;
+      scratch.dispatch_size = predicted_per_thread * lanes_per_wave * dispatch_slots;
+    }
+    scratch.demand.predicted_size = AlignUp(scratch.main_size, 4096);
+  }
+
   agent_->AcquireQueueMainScratch(scratch);
 
   if (scratch.retry) {
@@ -1166,7 +1623,9 @@ bool AqlQueue::DynamicQueueEventsHandler(hsa_signal_value_t error_code, void* ar
     if (error_code == 512) {  // Large scratch reclaim
       tool::notify_event_scratch_free_start(queue->public_handle(),
                                             HSA_AMD_EVENT_SCRATCH_ALLOC_FLAG_USE_ONCE);
+      core::TimelineSpan span(core::Timeline::kScratchFree);
 
+      ScopedAcquire<KernelMutex> lock(&queue->scratch_lock_);
       auto& scratch = queue->queue_scratch_;
       queue->agent_->ReleaseQueueMainScratch(scratch);
       scratch.main_queue_base = nullptr;
@@ -1342,9 +1801,15 @@ bool AqlQueue::ExceptionHandler(hsa_signal_value_t error_code, void* arg) {
   if (!core::Runtime::runtime_singleton_->KfdVersion().supports_core_dump &&
                 queue->agent_->supported_isas()[0]->GetMajorVersion() != 11) {
 
+    const Flag& flag = core::Runtime::runtime_singleton_->flag();
+    amd::coredump::DumpOptions options;
+    options.threads = flag.coredump_threads();
+    options.compress = flag.coredump_compress();
+    options.skip_readonly = flag.coredump_skip_readonly();
+
     if (pcs::PcsRuntime::instance()->SessionsActive())
       fprintf(stderr, "GPU core dump skipped because PC Sampling active\n");
-    else if (amd::coredump::dump_gpu_core())
+    else if (amd::coredump::dump_gpu_core(options))
       fprintf(stderr, "GPU core dump failed\n");
     // supports_core_dump flag is overwritten to avoid generate core dump file again
     // caught by a different exception handler. Such as VMFaultHandler.
@@ -1443,6 +1908,97 @@ hsa_status_t AqlQueue::GetCUMasking(uint32_t num_cu_mask_count, uint32_t* cu_mas
   return HSA_STATUS_SUCCESS;
 }
 
+hsa_status_t AqlQueue::SetDispatchCUMasking(uint32_t num_cu_mask_count, const uint32_t* cu_mask) {
+  ScopedAcquire<KernelMutex> lock(&mask_lock_);
+  if (cu_mask_.empty()) return HSA_STATUS_ERROR;
+
+  // The override can only narrow the queue's own mask, which already has the global mask applied.
+  std::vector<uint32_t> mask = cu_mask_;
+  bool clipped = false;
+  if (num_cu_mask_count != 0) {
+    for (size_t i = 0; i < mask.size(); i++) {
+      uint32_t user = (i < num_cu_mask_count / 32) ? cu_mask[i] : 0;
+      clipped |= ((user & ~mask[i]) != 0);
+      mask[i] &= user;
+    }
+    for (size_t i = mask.size(); i < num_cu_mask_count / 32; i++) clipped |= (cu_mask[i] != 0);
+  }
+
+  bool empty = true;
+  for (uint32_t dword : mask) empty &= (dword == 0);
+  if (empty) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  if (agent_->supported_isas()[0]->GetMajorVersion() >= 10) {
+    for (int i = 0; i < mask.size() * 32; i += 2) {
+      uint32_t cu_pair = (mask[i / 32] >> (i % 32)) & 0x3;
+      if (cu_pair && cu_pair != 0x3) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+  }
+
+  auto ib = std::find_if(dispatch_mask_ibs_.begin(), dispatch_mask_ibs_.end(),
+                         [&](const DispatchMaskIB& entry) { return entry.mask == mask; });
+
+  if (ib == dispatch_mask_ibs_.end()) {
+    hsa_status_t err = BuildDispatchMaskIB(mask);
+    if (err != HSA_STATUS_SUCCESS) return err;
+    ib = dispatch_mask_ibs_.end() - 1;
+  }
+
+  SubmitPM4IB(ib->ib, ib->size_dw, HSA_FENCE_SCOPE_NONE, HSA_FENCE_SCOPE_NONE, hsa_signal_t{0});
+  return clipped ? (hsa_status_t)HSA_STATUS_CU_MASK_REDUCED : HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t AqlQueue::BuildDispatchMaskIB(const std::vector<uint32_t>& mask) {
+  if (dispatch_mask_buf_ == nullptr) {
+    dispatch_mask_buf_ = host_allocator_(kDispatchMaskIBSize * kDispatchMaskIBCount, 0x1000,
+                                         core::MemoryRegion::AllocateExecutable);
+    if (dispatch_mask_buf_ == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
+  // IBs are immutable once submitted.  When all are taken, wait until the CP has moved past every
+  // packet that may still reference one before reusing the buffer.
+  if (dispatch_mask_ibs_.size() == kDispatchMaskIBCount) {
+    core::Queue* queue = core::Queue::Convert(public_handle());
+    const uint64_t write_idx = queue->LoadWriteIndexRelaxed();
+    while (queue->LoadReadIndexAcquire() < write_idx) os::YieldThread();
+    dispatch_mask_ibs_.clear();
+  }
+
+  const uint32_t major = agent_->supported_isas()[0]->GetMajorVersion();
+  const uint32_t num_xcc = std::max(agent_->properties().NumXcc, 1u);
+  uint32_t* ib = reinterpret_cast<uint32_t*>(uintptr_t(dispatch_mask_buf_) +
+                                             dispatch_mask_ibs_.size() * kDispatchMaskIBSize);
+  uint32_t i = 0;
+
+  constexpr uint32_t pred_exec_cmd_sz = 2;
+  constexpr uint32_t set_sh_reg_cmd_sz = 4;
+  for (uint32_t xcc = 0; xcc < num_xcc; xcc++) {
+    uint32_t se_mask[4];
+    if (!agent_->MapCUMask(mask, xcc, se_mask)) return HSA_STATUS_ERROR;
+
+    // XCCs number their CUs differently so each gets its own values.
+    if (num_xcc > 1) {
+      ib[i++] = PM4_HDR(PM4_HDR_IT_OPCODE_PRED_EXEC, pred_exec_cmd_sz, major);
+      ib[i++] = PM4_PRED_EXEC_DW2_EXEC_COUNT(2 * set_sh_reg_cmd_sz) |
+          PM4_PRED_EXEC_DW2_VIRTUALXCCID_SELECT(1 << xcc);
+    }
+
+    // SE0/SE1 and SE2/SE3 are register pairs with a gap between them.
+    ib[i++] = PM4_HDR(PM4_HDR_IT_OPCODE_SET_SH_REG, set_sh_reg_cmd_sz, major);
+    ib[i++] = PM4_SET_SH_REG_DW1_REG_OFFSET(PM4_SH_REG_COMPUTE_STATIC_THREAD_MGMT_SE0);
+    ib[i++] = se_mask[0];
+    ib[i++] = se_mask[1];
+    ib[i++] = PM4_HDR(PM4_HDR_IT_OPCODE_SET_SH_REG, set_sh_reg_cmd_sz, major);
+    ib[i++] = PM4_SET_SH_REG_DW1_REG_OFFSET(PM4_SH_REG_COMPUTE_STATIC_THREAD_MGMT_SE2);
+    ib[i++] = se_mask[2];
+    ib[i++] = se_mask[3];
+    assert(i * sizeof(uint32_t) <= kDispatchMaskIBSize && "Dispatch mask IB overflow.");
+  }
+
+  dispatch_mask_ibs_.push_back({mask, ib, i});
+  return HSA_STATUS_SUCCESS;
+}
+
 void AqlQueue::SetProfiling(bool enabled) {
   Queue::SetProfiling(enabled);
 
@@ -1459,6 +2015,106 @@ void AqlQueue::ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b, hsa_fence_scope
   // pm4_ib_buf_ is a shared resource, so mutually exclude here.
   ScopedAcquire<KernelMutex> lock(&pm4_ib_mutex_);
 
+  // Copy client PM4 command into IB.
+  assert(cmd_size_b < pm4_ib_size_b_ && "PM4 exceeds IB size");
+  memcpy(pm4_ib_buf_, cmd_data, cmd_size_b);
+
+  hsa_signal_t local_signal = {0};
+  hsa_status_t err;
+  if (agent_->supported_isas()[0]->GetMajorVersion() >= 9 && !in_signal) {
+    err = hsa_signal_create(1, 0, NULL, &local_signal);
+    assert(err == HSA_STATUS_SUCCESS);
+  }
+
+  core::Queue* queue = core::Queue::Convert(public_handle());
+  uint64_t write_idx = SubmitPM4IB(static_cast<const uint32_t*>(pm4_ib_buf_),
+                                   cmd_size_b / sizeof(uint32_t), acquireFence, releaseFence,
+                                   in_signal ? *in_signal : local_signal);
+
+  // Wait for the packet to be consumed.
+  if (agent_->supported_isas()[0]->GetMajorVersion() <= 8) {
+    while (queue->LoadReadIndexRelaxed() <= write_idx)
+      os::YieldThread();
+
+    if (in_signal) hsa_signal_store_screlease(*in_signal, 0);
+  } else if (!in_signal) {
+    // On gfx9 and newer, if in_signal is not provided, we block and wait for own signal
+    hsa_signal_value_t ret;
+    ret = hsa_signal_wait_scacquire(local_signal, HSA_SIGNAL_CONDITION_LT, 1, (uint64_t)-1,
+                                    HSA_WAIT_STATE_ACTIVE);
+    err = hsa_signal_destroy(local_signal);
+    assert(ret == 0 && err == HSA_STATUS_SUCCESS);
+  }
+}
+
+void AqlQueue::BuildPM4IBPacket(const uint32_t* ib, size_t ib_size_dw, uint16_t header,
+                                hsa_signal_t signal, void* packet) const {
+  // Construct an AQL packet to jump to the PM4 IB.
+  struct amd_aql_pm4_ib {
+    uint16_t header;
+    uint16_t ven_hdr;
+    uint32_t ib_jump_cmd[4];
+    uint32_t dw_cnt_remain;
+    uint32_t reserved[8];
+    hsa_signal_t completion_signal;
+  };
+
+  constexpr uint32_t AMD_AQL_FORMAT_PM4_IB = 0x1;
+
+  amd_aql_pm4_ib aql_pm4_ib{};
+  aql_pm4_ib.header = header;
+  aql_pm4_ib.ven_hdr = AMD_AQL_FORMAT_PM4_IB;
+  aql_pm4_ib.ib_jump_cmd[0] = PM4_HDR(PM4_HDR_IT_OPCODE_INDIRECT_BUFFER, 4,
+                                      agent_->supported_isas()[0]->GetMajorVersion());
+  aql_pm4_ib.ib_jump_cmd[1] = PM4_INDIRECT_BUFFER_DW1_IB_BASE_LO(uint32_t(uintptr_t(ib) >> 2));
+  aql_pm4_ib.ib_jump_cmd[2] = PM4_INDIRECT_BUFFER_DW2_IB_BASE_HI(uint32_t(uintptr_t(ib) >> 32));
+  aql_pm4_ib.ib_jump_cmd[3] =
+      PM4_INDIRECT_BUFFER_DW3_IB_SIZE(uint32_t(ib_size_dw)) | PM4_INDIRECT_BUFFER_DW3_IB_VALID(1);
+  aql_pm4_ib.dw_cnt_remain = 0xA;
+  aql_pm4_ib.completion_signal = signal;
+
+  memcpy(packet, &aql_pm4_ib, sizeof(aql_pm4_ib));
+}
+
+hsa_status_t AqlQueue::ProfilingTogglePackets(core::AqlPacket* on, core::AqlPacket* off) {
+  const uint32_t major = agent_->supported_isas()[0]->GetMajorVersion();
+  if (major < 9) return HSA_STATUS_ERROR_INVALID_QUEUE;
+
+  ScopedAcquire<KernelMutex> lock(&pm4_ib_mutex_);
+  if (profile_ib_buf_ == nullptr) {
+    profile_ib_buf_ = reinterpret_cast<uint32_t*>(
+        host_allocator_(0x1000, 0x1000, core::MemoryRegion::AllocateExecutable));
+    if (profile_ib_buf_ == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+    // The IBs rewrite the whole properties dword.  Of the other bits only USE_SCRATCH_ONCE
+    // changes at runtime, and it is cleared again once the dispatch that set it has run.
+    uint32_t props = amd_queue_.queue_properties;
+    AMD_HSA_BITS_SET(props, AMD_QUEUE_PROPERTIES_USE_SCRATCH_ONCE, 0);
+    const uint64_t addr = uint64_t(uintptr_t(&amd_queue_.queue_properties));
+    constexpr uint32_t write_data_cmd_sz = 5;
+    for (uint32_t enable = 0; enable < 2; enable++) {
+      uint32_t* ib = profile_ib_buf_ + enable * kProfileIBSizeDw;
+      AMD_HSA_BITS_SET(props, AMD_QUEUE_PROPERTIES_ENABLE_PROFILING, enable);
+      ib[0] = PM4_HDR(PM4_HDR_IT_OPCODE_WRITE_DATA, write_data_cmd_sz, major);
+      ib[1] = PM4_WRITE_DATA_DW1(PM4_WRITE_DATA_DST_SEL_TC_L2 |
+                                 PM4_WRITE_DATA_WR_CONFIRM_WAIT_CONFIRMATION);
+      ib[2] = PM4_WRITE_DATA_DW2_DST_MEM_ADDR_LO(addr);
+      ib[3] = PM4_WRITE_DATA_DW3_DST_MEM_ADDR_HI(addr >> 32);
+      ib[4] = PM4_WRITE_DATA_DW4_DATA(props);
+    }
+  }
+
+  const uint16_t header = HSA_PACKET_TYPE_VENDOR_SPECIFIC << HSA_PACKET_HEADER_TYPE;
+  BuildPM4IBPacket(profile_ib_buf_ + kProfileIBSizeDw, 5, header, hsa_signal_t{0}, on);
+  // The barrier keeps timestamps on until the profiled dispatch has written its end time.
+  BuildPM4IBPacket(profile_ib_buf_, 5, header | (1 << HSA_PACKET_HEADER_BARRIER),
+                   hsa_signal_t{0}, off);
+  return HSA_STATUS_SUCCESS;
+}
+
+uint64_t AqlQueue::SubmitPM4IB(const uint32_t* ib, size_t ib_size_dw,
+                               hsa_fence_scope_t acquireFence, hsa_fence_scope_t releaseFence,
+                               hsa_signal_t signal) {
   // Obtain reference to any container queue.
   core::Queue* queue = core::Queue::Convert(public_handle());
 
@@ -1474,26 +2130,20 @@ void AqlQueue::ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b, hsa_fence_scope
   uint32_t* queue_slot =
       (uint32_t*)(uintptr_t(queue->amd_queue_.hsa_queue.base_address) + (slot_idx * slot_size_b));
 
-  // Copy client PM4 command into IB.
-  assert(cmd_size_b < pm4_ib_size_b_ && "PM4 exceeds IB size");
-  memcpy(pm4_ib_buf_, cmd_data, cmd_size_b);
-
   // Construct a PM4 command to execute the IB.
   constexpr uint32_t ib_jump_size_dw = 4;
 
   uint32_t ib_jump_cmd[ib_jump_size_dw] = {
       PM4_HDR(PM4_HDR_IT_OPCODE_INDIRECT_BUFFER, ib_jump_size_dw,
                               agent_->supported_isas()[0]->GetMajorVersion()),
-      PM4_INDIRECT_BUFFER_DW1_IB_BASE_LO(uint32_t(uintptr_t(pm4_ib_buf_) >> 2)),
-      PM4_INDIRECT_BUFFER_DW2_IB_BASE_HI(uint32_t(uintptr_t(pm4_ib_buf_) >> 32)),
-      (PM4_INDIRECT_BUFFER_DW3_IB_SIZE(uint32_t(cmd_size_b / sizeof(uint32_t))) |
+      PM4_INDIRECT_BUFFER_DW1_IB_BASE_LO(uint32_t(uintptr_t(ib) >> 2)),
+      PM4_INDIRECT_BUFFER_DW2_IB_BASE_HI(uint32_t(uintptr_t(ib) >> 32)),
+      (PM4_INDIRECT_BUFFER_DW3_IB_SIZE(uint32_t(ib_size_dw)) |
        PM4_INDIRECT_BUFFER_DW3_IB_VALID(1))};
 
   // To respect multi-producer semantics, first buffer commands for the queue slot.
   constexpr uint32_t slot_size_dw = uint32_t(slot_size_b / sizeof(uint32_t));
   uint32_t slot_data[slot_size_dw];
-  hsa_signal_t local_signal = {0};
-  hsa_status_t err;
 
   if (agent_->supported_isas()[0]->GetMajorVersion() <= 8) {
     // Construct a set of PM4 to fit inside the AQL packet slot.
@@ -1535,37 +2185,11 @@ void AqlQueue::ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b, hsa_fence_scope
     rel_mem[5] = 0;
     rel_mem[6] = 0;
   } else if (agent_->supported_isas()[0]->GetMajorVersion() >= 9) {
-    // Construct an AQL packet to jump to the PM4 IB.
-    struct amd_aql_pm4_ib {
-      uint16_t header;
-      uint16_t ven_hdr;
-      uint32_t ib_jump_cmd[4];
-      uint32_t dw_cnt_remain;
-      uint32_t reserved[8];
-      hsa_signal_t completion_signal;
-    };
-
-    if (!in_signal) {
-      err = hsa_signal_create(1, 0, NULL, &local_signal);
-      assert(err == HSA_STATUS_SUCCESS);
-    }
-
-    constexpr uint32_t AMD_AQL_FORMAT_PM4_IB = 0x1;
-
-    amd_aql_pm4_ib aql_pm4_ib{};
-    aql_pm4_ib.header = HSA_PACKET_TYPE_VENDOR_SPECIFIC << HSA_PACKET_HEADER_TYPE |
-                        (acquireFence << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
-                        (releaseFence << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
-
-    aql_pm4_ib.ven_hdr = AMD_AQL_FORMAT_PM4_IB;
-    aql_pm4_ib.ib_jump_cmd[0] = ib_jump_cmd[0];
-    aql_pm4_ib.ib_jump_cmd[1] = ib_jump_cmd[1];
-    aql_pm4_ib.ib_jump_cmd[2] = ib_jump_cmd[2];
-    aql_pm4_ib.ib_jump_cmd[3] = ib_jump_cmd[3];
-    aql_pm4_ib.dw_cnt_remain = 0xA;
-    aql_pm4_ib.completion_signal = in_signal ? *in_signal : local_signal;
-
-    memcpy(slot_data, &aql_pm4_ib, sizeof(aql_pm4_ib));
+    BuildPM4IBPacket(ib, ib_size_dw,
+                     HSA_PACKET_TYPE_VENDOR_SPECIFIC << HSA_PACKET_HEADER_TYPE |
+                         (acquireFence << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
+                         (releaseFence << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE),
+                     signal, slot_data);
   } else {
     assert(false && "AqlQueue::ExecutePM4 not implemented");
   }
@@ -1574,30 +2198,18 @@ void AqlQueue::ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b, hsa_fence_scope
   // Overwrite the AQL invalid header (first dword) last.
   // This prevents the slot from being read until it's fully written.
   memcpy(&queue_slot[1], &slot_data[1], slot_size_b - sizeof(uint32_t));
-  if (core::Runtime::runtime_singleton_->flag().dev_mem_queue() && !agent_->is_xgmi_cpu_gpu()) {
+  if (queue->needsRingFence()) {
     // Ensure the packet body is written as header may get reordered when writing over PCIE
     _mm_sfence();
   }
   atomic::Store(&queue_slot[0], slot_data[0], std::memory_order_release);
 
   // Submit the packet slot.
-  core::Signal* doorbell = core::Signal::Convert(queue->amd_queue_.hsa_queue.doorbell_signal);
-  doorbell->StoreRelease(write_idx);
-
-  // Wait for the packet to be consumed.
-  if (agent_->supported_isas()[0]->GetMajorVersion() <= 8) {
-    while (queue->LoadReadIndexRelaxed() <= write_idx)
-      os::YieldThread();
+  hsa_signal_t doorbell = queue->amd_queue_.hsa_queue.doorbell_signal;
+  if (!core::Signal::StoreDirect(doorbell, write_idx, std::memory_order_release))
+    core::Signal::Convert(doorbell)->StoreRelease(write_idx);
 
-    if (in_signal) hsa_signal_store_screlease(*in_signal, 0);
-  } else if (!in_signal) {
-    // On gfx9 and newer, if in_signal is not provided, we block and wait for own signal
-    hsa_signal_value_t ret;
-    ret = hsa_signal_wait_scacquire(local_signal, HSA_SIGNAL_CONDITION_LT, 1, (uint64_t)-1,
-                                    HSA_WAIT_STATE_ACTIVE);
-    err = hsa_signal_destroy(local_signal);
-    assert(ret == 0 && err == HSA_STATUS_SUCCESS);
-  }
+  return write_idx;
 }
 
 void AqlQueue::FillBufRsrcWord0() {
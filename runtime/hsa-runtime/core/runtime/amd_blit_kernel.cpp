@@ -914,6 +914,17 @@ DEFINE_KERNEL_PARAM_FUNC(kCopyMisalignedUnroll)
 DEFINE_KERNEL_PARAM_FUNC(kFillVecWidth)
 DEFINE_KERNEL_PARAM_FUNC(kFillUnroll)
 
+// Unroll of blit_copyAlignedNT.s and blit_fillNT.s, vector width is that of the generic kernels.
+static const int kCopyAlignedNTUnroll = 4;
+static const int kFillNTUnroll = 4;
+
+// Unroll of blit_fillPattern.s, which stores one 16 byte pattern per work-item per iteration.
+static const int kFillPatternUnroll = 1;
+
+// Non-temporal kernels are used once their bulk phase covers this many blocks, keeping the
+// remainder left to the narrow tail phases small.
+static const uint64_t kStreamingMinBlocks = 2;
+
 static unsigned extractAqlBits(unsigned v, unsigned pos, unsigned width) {
   return (v >> pos) & ((1 << width) - 1);
 };
@@ -927,7 +938,9 @@ BlitKernel::BlitKernel(core::Queue* queue)
       bytes_queued_(0),
       last_queued_(0),
       pending_search_index_(0),
-      num_cus_(0) {
+      num_cus_(0),
+      streaming_(false),
+      streaming_waves_per_cu_(0) {
   completion_signal_.handle = 0;
 }
 
@@ -945,6 +958,7 @@ hsa_status_t BlitKernel::Initialize(const core::Agent& agent) {
   }
 
   const AMD::GpuAgent& gpuAgent = static_cast<const AMD::GpuAgent&>(agent);
+  core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_KERNARG);
   kernarg_async_ = reinterpret_cast<KernelArgs*>(
       gpuAgent.system_allocator()(queue_->public_handle()->size * AlignUp(sizeof(KernelArgs), 16),
                                   16, core::MemoryRegion::AllocateNoFlags));
@@ -960,6 +974,20 @@ hsa_status_t BlitKernel::Initialize(const core::Agent& agent) {
       {KernelType::CopyMisaligned, "CopyMisaligned"},
       {KernelType::Fill, "Fill"}};
 
+  // Non-temporal kernels are built for gfx9 and later.  HBM parts keep more waves in flight per
+  // CU to cover its latency.
+  const core::Isa* isa = gpuAgent.supported_isas()[0];
+  streaming_ = (isa->GetMajorVersion() >= 9);
+  const bool hbm = (isa->GetMajorVersion() == 9) &&
+      ((isa->GetMinorVersion() == 4) ||
+       ((isa->GetMinorVersion() == 0) && (isa->GetStepping() == 10)));
+  streaming_waves_per_cu_ = hbm ? 8 : 4;
+  if (streaming_) {
+    kernel_names[KernelType::CopyAlignedNT] = "CopyAlignedNT";
+    kernel_names[KernelType::FillNT] = "FillNT";
+    kernel_names[KernelType::FillPattern] = "FillPattern";
+  }
+
   for (auto kernel_name : kernel_names) {
     KernelCode& kernel = kernels_[kernel_name.first];
     gpuAgent.AssembleShader(kernel_name.second, AMD::GpuAgent::AssembleTarget::AQL, kernel.code_buf_,
@@ -1038,54 +1066,7 @@ hsa_status_t BlitKernel::SubmitLinearCopyCommand(
 
   uint64_t write_index_temp = write_index;
 
-  // Insert barrier packets to handle dependent signals.
-  // Barrier bit keeps signal checking traffic from competing with a copy.
-  const uint16_t kBarrierPacketHeader = (HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE) |
-      (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
-      (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
-
-  hsa_barrier_and_packet_t barrier_packet = {0};
-  barrier_packet.header = HSA_PACKET_TYPE_INVALID;
-
-  hsa_barrier_and_packet_t* queue_buffer =
-      reinterpret_cast<hsa_barrier_and_packet_t*>(
-          queue_->public_handle()->base_address);
-
-  const size_t dep_signal_count = dep_signals.size();
-  for (size_t i = 0; i < dep_signal_count; ++i) {
-    const size_t idx = i % 5;
-    barrier_packet.dep_signal[idx] = core::Signal::Convert(dep_signals[i]);
-    if (i == (dep_signal_count - 1) || idx == 4) {
-      std::atomic_thread_fence(std::memory_order_acquire);
-      queue_buffer[(write_index)&queue_bitmask_] = barrier_packet;
-      std::atomic_thread_fence(std::memory_order_release);
-      queue_buffer[(write_index)&queue_bitmask_].header = kBarrierPacketHeader;
-
-      LogPrint(HSA_AMD_LOG_FLAG_BLIT_KERNEL_PKTS,
-      "HWq=%p, id=%d, Barrier Header = "
-      "0x%x (type=%d, barrier=%d, acquire=%d, release=%d), "
-      "dep_signal=[0x%zx 0x%zx 0x%zx 0x%zx 0x%zx], completion_signal=0x%zx "
-      "rptr=%u, wptr=%u",
-      queue_->public_handle()->base_address, queue_->public_handle()->id,
-      kBarrierPacketHeader,
-      extractAqlBits(kBarrierPacketHeader,
-                    HSA_PACKET_HEADER_TYPE, HSA_PACKET_HEADER_WIDTH_TYPE),
-      extractAqlBits(kBarrierPacketHeader,
-                    HSA_PACKET_HEADER_BARRIER, HSA_PACKET_HEADER_WIDTH_BARRIER),
-      extractAqlBits(kBarrierPacketHeader, HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE,
-                    HSA_PACKET_HEADER_WIDTH_SCACQUIRE_FENCE_SCOPE),
-      extractAqlBits(kBarrierPacketHeader, HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE,
-                    HSA_PACKET_HEADER_WIDTH_SCRELEASE_FENCE_SCOPE),
-      barrier_packet.dep_signal[0], barrier_packet.dep_signal[1], barrier_packet.dep_signal[2],
-      barrier_packet.dep_signal[3], barrier_packet.dep_signal[4],
-      barrier_packet.completion_signal, queue_->LoadReadIndexRelaxed(), write_index);
-
-      ++write_index;
-
-      memset(&barrier_packet, 0, sizeof(hsa_barrier_and_packet_t));
-      barrier_packet.header = HSA_PACKET_TYPE_INVALID;
-    }
-  }
+  write_index = WriteDependencyBarriers(write_index, dep_signals);
 
   // Insert dispatch packet for copy kernel.
   KernelArgs* args = ObtainAsyncKernelCopyArg();
@@ -1100,6 +1081,17 @@ hsa_status_t BlitKernel::SubmitLinearCopyCommand(
 
     // Compute the size of each copy phase.
     num_workitems = 64 * 4 * num_cus_;
+    int unroll = kCopyAlignedUnroll();
+
+    // Large copies stream through the wider non-temporal kernel.
+    const int streaming_workitems = 64 * streaming_waves_per_cu_ * num_cus_;
+    const uint64_t streaming_block =
+        streaming_workitems * sizeof(uint32_t) * kCopyAlignedNTUnroll * kCopyAlignedVecWidth();
+    if (streaming_ && (size >= kStreamingMinBlocks * streaming_block)) {
+      kernel_code = &kernels_[KernelType::CopyAlignedNT];
+      num_workitems = streaming_workitems;
+      unroll = kCopyAlignedNTUnroll;
+    }
 
     // Phase 1 (byte copy) ends when destination is 0x100-aligned.
     uintptr_t src_start = uintptr_t(src);
@@ -1109,7 +1101,7 @@ hsa_status_t BlitKernel::SubmitLinearCopyCommand(
 
     // Phase 2 (unrolled dwordx4 copy) ends when last whole block fits.
     uint64_t phase2_block = num_workitems * sizeof(uint32_t) *
-                            kCopyAlignedUnroll() * kCopyAlignedVecWidth();
+                            unroll * kCopyAlignedVecWidth();
     uint64_t phase2_size = ((size - phase1_size) / phase2_block) * phase2_block;
 
     // Phase 3 (dword copy) ends when last whole dword fits.
@@ -1163,8 +1155,62 @@ hsa_status_t BlitKernel::SubmitLinearCopyCommand(
   return HSA_STATUS_SUCCESS;
 }
 
+uint64_t BlitKernel::WriteDependencyBarriers(uint64_t write_index,
+                                            std::vector<core::Signal*>& dep_signals) {
+  // Barrier bit keeps signal checking traffic from competing with a copy.
+  const uint16_t kBarrierPacketHeader = (HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE) |
+      (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
+      (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+
+  hsa_barrier_and_packet_t barrier_packet = {0};
+  barrier_packet.header = HSA_PACKET_TYPE_INVALID;
+
+  hsa_barrier_and_packet_t* queue_buffer =
+      reinterpret_cast<hsa_barrier_and_packet_t*>(
+          queue_->public_handle()->base_address);
+
+  const size_t dep_signal_count = dep_signals.size();
+  for (size_t i = 0; i < dep_signal_count; ++i) {
+    const size_t idx = i % 5;
+    barrier_packet.dep_signal[idx] = core::Signal::Convert(dep_signals[i]);
+    if (i == (dep_signal_count - 1) || idx == 4) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      queue_buffer[(write_index)&queue_bitmask_] = barrier_packet;
+      std::atomic_thread_fence(std::memory_order_release);
+      queue_buffer[(write_index)&queue_bitmask_].header = kBarrierPacketHeader;
+
+      LogPrint(HSA_AMD_LOG_FLAG_BLIT_KERNEL_PKTS,
+      "HWq=%p, id=%d, Barrier Header = "
+      "0x%x (type=%d, barrier=%d, acquire=%d, release=%d), "
+      "dep_signal=[0x%zx 0x%zx 0x%zx 0x%zx 0x%zx], completion_signal=0x%zx "
+      "rptr=%u, wptr=%u",
+      queue_->public_handle()->base_address, queue_->public_handle()->id,
+      kBarrierPacketHeader,
+      extractAqlBits(kBarrierPacketHeader,
+                    HSA_PACKET_HEADER_TYPE, HSA_PACKET_HEADER_WIDTH_TYPE),
+      extractAqlBits(kBarrierPacketHeader,
+                    HSA_PACKET_HEADER_BARRIER, HSA_PACKET_HEADER_WIDTH_BARRIER),
+      extractAqlBits(kBarrierPacketHeader, HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE,
+                    HSA_PACKET_HEADER_WIDTH_SCACQUIRE_FENCE_SCOPE),
+      extractAqlBits(kBarrierPacketHeader, HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE,
+                    HSA_PACKET_HEADER_WIDTH_SCRELEASE_FENCE_SCOPE),
+      barrier_packet.dep_signal[0], barrier_packet.dep_signal[1], barrier_packet.dep_signal[2],
+      barrier_packet.dep_signal[3], barrier_packet.dep_signal[4],
+      barrier_packet.completion_signal, queue_->LoadReadIndexRelaxed(), write_index);
+
+      ++write_index;
+
+      memset(&barrier_packet, 0, sizeof(hsa_barrier_and_packet_t));
+      barrier_packet.header = HSA_PACKET_TYPE_INVALID;
+    }
+  }
+
+  return write_index;
+}
+
 hsa_status_t BlitKernel::SubmitLinearFillCommand(void* ptr, uint32_t value,
                                                  size_t count) {
+  // Protect completion_signal_.
   std::lock_guard<std::mutex> guard(lock_);
 
   // Reject misaligned base address.
@@ -1172,46 +1218,110 @@ hsa_status_t BlitKernel::SubmitLinearFillCommand(void* ptr, uint32_t value,
     return HSA_STATUS_ERROR;
   }
 
-  // Compute the size of each fill phase.
-  int num_workitems = 64 * num_cus_;
+  HSA::hsa_signal_store_relaxed(completion_signal_, 1);
 
-  // Phase 1 (unrolled dwordx4 copy) ends when last whole block fits.
-  uintptr_t dst_start = uintptr_t(ptr);
-  uint64_t fill_size = count * sizeof(uint32_t);
+  std::vector<core::Signal*> dep_signals(0);
 
-  uint64_t phase1_block =
-      num_workitems * sizeof(uint32_t) * kFillUnroll() * kFillVecWidth();
-  uint64_t phase1_size = (fill_size / phase1_block) * phase1_block;
+  hsa_status_t stat = SubmitLinearFillCommand(ptr, &value, 1, count * sizeof(uint32_t),
+                                              dep_signals,
+                                              *core::Signal::Convert(completion_signal_));
 
-  KernelArgs* args = ObtainAsyncKernelCopyArg();
-  args->fill.phase1_dst_start = dst_start;
-  args->fill.phase2_dst_start = dst_start + phase1_size;
-  args->fill.phase2_dst_end = dst_start + fill_size;
-  args->fill.fill_value = value;
-  args->fill.num_workitems = num_workitems;
+  if (stat != HSA_STATUS_SUCCESS) {
+    return stat;
+  }
 
-  // Submit dispatch packet.
-  HSA::hsa_signal_store_relaxed(completion_signal_, 1);
+  // Wait for the packet to finish.
+  if (HSA::hsa_signal_wait_scacquire(completion_signal_, HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1),
+                                     HSA_WAIT_STATE_ACTIVE) != 0) {
+    // Signal wait returned unexpected value.
+    return HSA_STATUS_ERROR;
+  }
+
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t BlitKernel::SubmitLinearFillCommand(void* ptr, const uint32_t* pattern,
+                                                 uint32_t pattern_dwords, size_t size,
+                                                 std::vector<core::Signal*>& dep_signals,
+                                                 core::Signal& out_signal) {
+  const size_t pattern_size = pattern_dwords * sizeof(uint32_t);
+  if ((pattern_dwords != 1 && pattern_dwords != 4) ||
+      !IsMultipleOf(uintptr_t(ptr), pattern_size) || !IsMultipleOf(size, pattern_size)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  // Wide patterns need the pattern kernel, which is not built before gfx9.
+  if ((pattern_dwords != 1) && (kernels_.find(KernelType::FillPattern) == kernels_.end())) {
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+
+  // Reserve write index for barrier(s) + dispatch packet.
+  const uint32_t num_barrier_packet = uint32_t((dep_signals.size() + 4) / 5);
+  const uint32_t total_num_packet = num_barrier_packet + 1;
 
   uint64_t write_index;
   {
     std::lock_guard<std::mutex> lock(reservation_lock_);
-    write_index = AcquireWriteIndex(1);
-    RecordBlitHistory(fill_size, write_index);
+    write_index = AcquireWriteIndex(total_num_packet);
+    RecordBlitHistory(size, write_index + total_num_packet - 1);
   }
 
-  PopulateQueue(write_index, uintptr_t(kernels_[KernelType::Fill].code_buf_),
-                args, num_workitems, completion_signal_);
+  const uint64_t write_index_temp = write_index;
+  write_index = WriteDependencyBarriers(write_index, dep_signals);
+
+  // Insert dispatch packet for fill kernel.
+  uintptr_t dst_start = uintptr_t(ptr);
+  KernelArgs* args = ObtainAsyncKernelCopyArg();
+  KernelCode* kernel_code = nullptr;
+  int num_workitems = 0;
+
+  if (pattern_dwords == 1) {
+    // Compute the size of each fill phase.
+    num_workitems = 64 * num_cus_;
+    int unroll = kFillUnroll();
+    kernel_code = &kernels_[KernelType::Fill];
+
+    // Large fills stream through the wider non-temporal kernel.
+    const int streaming_workitems = 64 * streaming_waves_per_cu_ * num_cus_;
+    const uint64_t streaming_block =
+        streaming_workitems * sizeof(uint32_t) * kFillNTUnroll * kFillVecWidth();
+    if (streaming_ && (size >= kStreamingMinBlocks * streaming_block)) {
+      kernel_code = &kernels_[KernelType::FillNT];
+      num_workitems = streaming_workitems;
+      unroll = kFillNTUnroll;
+    }
 
-  ReleaseWriteIndex(write_index, 1);
+    // Phase 1 (unrolled dwordx4 copy) ends when last whole block fits.
+    uint64_t phase1_block =
+        num_workitems * sizeof(uint32_t) * unroll * kFillVecWidth();
+    uint64_t phase1_size = (size / phase1_block) * phase1_block;
 
-  // Wait for the packet to finish.
-  if (HSA::hsa_signal_wait_scacquire(completion_signal_, HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1),
-                                     HSA_WAIT_STATE_ACTIVE) != 0) {
-    // Signal wait returned unexpected value.
-    return HSA_STATUS_ERROR;
+    args->fill.phase1_dst_start = dst_start;
+    args->fill.phase2_dst_start = dst_start + phase1_size;
+    args->fill.phase2_dst_end = dst_start + size;
+    args->fill.fill_value = pattern[0];
+    args->fill.num_workitems = num_workitems;
+  } else {
+    kernel_code = &kernels_[KernelType::FillPattern];
+
+    // Phase 1 (dwordx4 fill) ends when last whole block fits, phase 2 masks off the tail.
+    num_workitems = 64 * num_cus_;
+    uint64_t phase1_block = num_workitems * pattern_size * kFillPatternUnroll;
+    uint64_t phase1_size = (size / phase1_block) * phase1_block;
+
+    args->fill_pattern.phase1_dst_start = dst_start;
+    args->fill_pattern.phase2_dst_start = dst_start + phase1_size;
+    args->fill_pattern.phase2_dst_end = dst_start + size;
+    memcpy(args->fill_pattern.pattern, pattern, pattern_size);
+    args->fill_pattern.num_workitems = num_workitems;
   }
 
+  hsa_signal_t signal = {(core::Signal::Convert(&out_signal)).handle};
+  PopulateQueue(write_index, uintptr_t(kernel_code->code_buf_), args, num_workitems, signal);
+
+  // Submit barrier(s) and dispatch packets.
+  ReleaseWriteIndex(write_index_temp, total_num_packet);
+
   return HSA_STATUS_SUCCESS;
 }
 
@@ -1234,9 +1344,10 @@ uint64_t BlitKernel::AcquireWriteIndex(uint32_t num_packet) {
 
 void BlitKernel::ReleaseWriteIndex(uint64_t write_index, uint32_t num_packet) {
   // Update doorbel register with last packet id.
-  core::Signal* doorbell =
-      core::Signal::Convert(queue_->public_handle()->doorbell_signal);
-  doorbell->StoreRelease(write_index + num_packet - 1);
+  hsa_signal_t doorbell = queue_->public_handle()->doorbell_signal;
+  if (!core::Signal::StoreDirect(doorbell, write_index + num_packet - 1,
+                                 std::memory_order_release))
+    core::Signal::Convert(doorbell)->StoreRelease(write_index + num_packet - 1);
 }
 
 void BlitKernel::PopulateQueue(uint64_t index, uint64_t code_handle, void* args,
@@ -1272,7 +1383,7 @@ void BlitKernel::PopulateQueue(uint64_t index, uint64_t code_handle, void* args,
   std::atomic_thread_fence(std::memory_order_acquire);
   queue_buffer[index & queue_bitmask_] = packet;
   std::atomic_thread_fence(std::memory_order_release);
-  if (core::Runtime::runtime_singleton_->flag().dev_mem_queue() && !queue_->needsPcieOrdering()) {
+  if (queue_->needsRingFence()) {
     // Ensure the packet body is written as header may get reordered when writing over PCIE
     _mm_sfence();
   }
@@ -53,6 +53,7 @@
 #include "core/inc/runtime.h"
 #include "core/inc/sdma_registers.h"
 #include "core/inc/signal.h"
+#include "core/inc/default_signal.h"
 #include "core/inc/interrupt_signal.h"
 
 namespace rocr {
@@ -71,6 +72,7 @@ inline uint32_t ptrhigh32(const void* p) {
 }
 
 const size_t BlitSdmaBase::kQueueSize = 1024 * 1024;
+const size_t BlitSdmaBase::kMaxQueueSize = 64 * 1024 * 1024;
 const size_t BlitSdmaBase::kCopyPacketSize = sizeof(SDMA_PKT_COPY_LINEAR);
 const size_t BlitSdmaBase::kMaxSingleCopySize = SDMA_PKT_COPY_LINEAR::kMaxSize_;
 const size_t BlitSdmaBase::kMaxSingleFillSize = SDMA_PKT_CONSTANT_FILL::kMaxSize_;
@@ -112,10 +114,21 @@ template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bo
 const uint32_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
                         useGCR>::gcr_command_size_ = sizeof(SDMA_PKT_GCR);
 
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+const uint32_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
+                        useGCR>::indirect_command_size_ = sizeof(SDMA_PKT_INDIRECT);
+
+// Indirect buffer packets must end on an 8 DWORD boundary of the ring.
+static const uint32_t kIndirectAlignment = 8 * sizeof(uint32_t);
+
+// Largest indirect buffer, in DWORDs, the packet's size field can describe.
+static const uint32_t kMaxIndirectSize = (1 << 20) - 1;
+
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
 BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::BlitSdma()
     : agent_(NULL),
       queue_start_addr_(NULL),
+      queue_size_(kQueueSize),
       bytes_queued_(0),
       parity_(false),
       cached_reserve_index_(0),
@@ -124,6 +137,7 @@ BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::BlitSdma()
       hdp_flush_support_(false),
       gang_leader_(false),
       is_ganged_(false),
+      defer_interrupts_(false),
       min_submission_size_(0) {
   std::memset(&queue_resource_, 0, sizeof(queue_resource_));
 }
@@ -133,7 +147,8 @@ BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::~BlitSdma()
 
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
 hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::Initialize(
-    const core::Agent& agent, bool use_xgmi, size_t linear_copy_size_override, int rec_eng) {
+    const core::Agent& agent, bool use_xgmi, size_t linear_copy_size_override, int rec_eng,
+    HSA_QUEUE_PRIORITY priority) {
   if (queue_start_addr_ != NULL) {
     // Already initialized.
     return HSA_STATUS_SUCCESS;
@@ -175,17 +190,27 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
     hdp_flush_support_ = link.info.link_type != HSA_AMD_LINK_INFO_TYPE_XGMI;
   }
 
+  // Rings grow in powers of two from the default, a deeper ring lets bursts of submissions queue
+  // up behind slow transfers instead of waiting for the engine to free space.
+  queue_size_ = kQueueSize;
+  while (queue_size_ < core::Runtime::runtime_singleton_->flag().sdma_ring_size() &&
+         queue_size_ < kMaxQueueSize)
+    queue_size_ <<= 1;
+
+  defer_interrupts_ = core::Runtime::runtime_singleton_->flag().sdma_coalesce_interrupts();
+
   // Allocate queue buffer.
+  core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_RING_BUFFER);
   queue_start_addr_ =
-      (char*)agent_->system_allocator()(kQueueSize, 0x1000, core::MemoryRegion::AllocateExecutable);
+      (char*)agent_->system_allocator()(queue_size_, 0x1000, core::MemoryRegion::AllocateExecutable);
 
   if (queue_start_addr_ == NULL) {
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
   MAKE_NAMED_SCOPE_GUARD(cleanupOnException, [&]() { Destroy(agent); };);
-  std::memset(queue_start_addr_, 0, kQueueSize);
+  std::memset(queue_start_addr_, 0, queue_size_);
 
-  bytes_written_.resize(kQueueSize);
+  bytes_written_.resize(queue_size_);
 
   // Access kernel driver to initialize the queue control block
   // This call binds user mode queue object to underlying compute
@@ -195,8 +220,8 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
   const HSA_QUEUE_TYPE kQueueType_ = rec_eng >= 0 ? HSA_QUEUE_SDMA_BY_ENG_ID :
                                      (use_xgmi ? HSA_QUEUE_SDMA_XGMI : HSA_QUEUE_SDMA);
   if (HSAKMT_STATUS_SUCCESS != hsaKmtCreateQueueExt(agent_->node_id(), kQueueType_, 100,
-                                                    HSA_QUEUE_PRIORITY_MAXIMUM, rec_eng,
-                                                    queue_start_addr_, kQueueSize, NULL,
+                                                    priority, rec_eng,
+                                                    queue_start_addr_, queue_size_, NULL,
                                                     &queue_resource_)) {
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
@@ -206,6 +231,7 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
 
   signals_[0].reset(new core::InterruptSignal(0));
   signals_[1].reset(new core::InterruptSignal(0));
+  batch_signal_.reset(new core::DefaultSignal(0));
 
   max_single_linear_copy_size_ = linear_copy_size_override;
 
@@ -236,6 +262,7 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
 
   signals_[0].reset();
   signals_[1].reset();
+  batch_signal_.reset();
 
   return HSA_STATUS_SUCCESS;
 }
@@ -276,7 +303,7 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
 hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::SubmitCommand(
     const void* cmd, size_t cmd_size, uint64_t size, const std::vector<core::Signal*>& dep_signals,
-    core::Signal& out_signal, std::vector<core::Signal*>& gang_signals) {
+    core::Signal& out_signal, std::vector<core::Signal*>& gang_signals, bool indirect) {
 
   uint32_t num_poll_command = 0;
 
@@ -338,25 +365,29 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
           ? (fence_command_size_ + trap_command_size_)
           : 0;
 
-  // Add space for acquire or release Hdp flush command
-  uint32_t flush_cmd_size = 0;
-  if (core::Runtime::runtime_singleton_->flag().enable_sdma_hdp_flush()) {
-    if ((HwIndexMonotonic) && (hdp_flush_support_)) {
-      flush_cmd_size = flush_command_size_;
-    }
-  }
+  // Add space for acquire or release Hdp flush command.  The HDP only holds CPU writes to device
+  // memory, skip the flush while the CPU can't write any of the agent's memory.
+  const bool hdp_flush = HwIndexMonotonic && hdp_flush_support_ &&
+      core::Runtime::runtime_singleton_->flag().enable_sdma_hdp_flush() &&
+      agent_->HdpFlushRequired();
+  uint32_t flush_cmd_size = hdp_flush ? flush_command_size_ : 0;
 
   // Add space for cache flush.
   if (useGCR) flush_cmd_size += gcr_command_size_ * 2;
 
+  // Add space for NOPs aligning the end of an indirect buffer packet.
+  const uint32_t align_size = indirect ? kIndirectAlignment - sizeof(uint32_t) : 0;
+
   const uint32_t total_command_size = total_poll_command_size + cmd_size + sync_command_size +
-      total_timestamp_command_size + interrupt_command_size + flush_cmd_size + total_gang_command_size;
-  const uint32_t pad_size = total_command_size < min_submission_size_ ?
-                            min_submission_size_ - total_command_size : 0;
+      total_timestamp_command_size + interrupt_command_size + flush_cmd_size +
+      total_gang_command_size + align_size;
+  uint32_t pad_size = total_command_size < min_submission_size_ ?
+                      min_submission_size_ - total_command_size : 0;
 
   RingIndexTy curr_index;
   char* command_addr;
   uint64_t prior_bytes, post_bytes;
+  bool defer_interrupt;
   {
     std::lock_guard<std::mutex> lock(reservation_lock_);
     command_addr = AcquireWriteAddress(total_command_size + pad_size, curr_index);
@@ -366,6 +397,12 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
     prior_bytes = bytes_queued_;
     bytes_queued_ += size;
     post_bytes = bytes_queued_;
+
+    // Skip the interrupt while nobody sleeps on the signal, a waiter that later goes to sleep has
+    // it sent by SubmitInterrupt.  Deciding under the reservation lock places that interrupt behind
+    // this command on the ring.
+    defer_interrupt = (interrupt_command_size != 0) && defer_interrupts_ &&
+        out_signal.DeferInterrupt(this);
   }
   uint32_t wrapped_index = WrapIntoRing(curr_index);
 
@@ -397,13 +434,11 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
   }
 
   // Issue a Hdp flush cmd
-  if (core::Runtime::runtime_singleton_->flag().enable_sdma_hdp_flush()) {
-    if ((HwIndexMonotonic) && (hdp_flush_support_)) {
-      BuildHdpFlushCommand(command_addr);
-      command_addr += flush_command_size_;
-      bytes_written_[wrapped_index] = prior_bytes;
-      wrapped_index += flush_command_size_;
-    }
+  if (hdp_flush) {
+    BuildHdpFlushCommand(command_addr);
+    command_addr += flush_command_size_;
+    bytes_written_[wrapped_index] = prior_bytes;
+    wrapped_index += flush_command_size_;
   }
 
   // Issue cache invalidate
@@ -414,6 +449,19 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
     wrapped_index += gcr_command_size_;
   }
 
+  // Zero DWORDs are single DWORD NOPs, use them to align the indirect buffer packet and add
+  // the unused part of the reserved alignment to the final padding.
+  if (indirect) {
+    const uint32_t nop_size =
+        (kIndirectAlignment - (wrapped_index + cmd_size) % kIndirectAlignment) %
+        kIndirectAlignment;
+    memset(command_addr, 0, nop_size);
+    command_addr += nop_size;
+    bytes_written_.fill(wrapped_index, wrapped_index + nop_size, prior_bytes);
+    wrapped_index += nop_size;
+    pad_size += align_size - nop_size;
+  }
+
   // Do the command after all polls are satisfied.
   memcpy(command_addr, cmd, cmd_size);
   command_addr += cmd_size;
@@ -485,8 +533,9 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
     wrapped_index += fence_command_size_;
   }
 
-  // Update mailbox event and send interrupt to IH.
-  if (out_signal.signal_.event_mailbox_ptr != 0) {
+  // Update mailbox event and send interrupt to IH.  A deferred interrupt leaves its space to the
+  // trailing padding.
+  if (interrupt_command_size != 0 && !defer_interrupt) {
     BuildFenceCommand(command_addr,
                       reinterpret_cast<uint32_t*>(out_signal.signal_.event_mailbox_ptr),
                       static_cast<uint32_t>(out_signal.signal_.event_id));
@@ -503,10 +552,11 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>:
   // Pad size is DWORD aligned since all commands are dword aligned.
   // Insert NOP header DWORD with value of the number of null DWORDs shifted
   // by 16 bits to pad total submission.
-  if (pad_size) {
-    memset(command_addr, 0, pad_size);
+  const uint32_t nop_size = pad_size + (defer_interrupt ? interrupt_command_size : 0);
+  if (nop_size) {
+    memset(command_addr, 0, nop_size);
     uint32_t *dword_command_addr = reinterpret_cast<uint32_t*>(command_addr);
-    dword_command_addr[0] = (pad_size/4 - 1) << 16;
+    dword_command_addr[0] = (nop_size/4 - 1) << 16;
   }
 
   ReleaseWriteAddress(curr_index, total_command_size + pad_size);
@@ -549,6 +599,193 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
                        out_signal, gang_signals);
 }
 
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::
+    SubmitLinearCopyBatchCommand(const hsa_amd_memory_copy_descriptor_t* copies, uint32_t count,
+                                 std::vector<core::Signal*>& dep_signals,
+                                 core::Signal& out_signal) {
+  const size_t max_copy_size = max_single_linear_copy_size_ ? max_single_linear_copy_size_ :
+                               kMaxSingleCopySize;
+
+  // Limit each submission to a quarter of the ring so a batch never has to wait for the whole
+  // ring to drain and other submitters can interleave.
+  const uint32_t max_packets = queue_size_ / 4 / sizeof(SDMA_PKT_COPY_LINEAR);
+
+  std::vector<SDMA_PKT_COPY_LINEAR> buff;
+  std::vector<core::Signal*> no_signals(0);
+  std::vector<core::Signal*> gang_signals(0);
+  uint64_t bytes = 0;
+  bool first = true;
+
+  // Submit the assembled packets.  The engine executes and retires submissions in order, so
+  // only the final one needs to signal out_signal.  Dependencies are only polled by the first.
+  auto flush = [&](bool last) {
+    hsa_status_t stat =
+        SubmitCommand(&buff[0], buff.size() * sizeof(SDMA_PKT_COPY_LINEAR), bytes,
+                      first ? dep_signals : no_signals, last ? out_signal : *batch_signal_,
+                      gang_signals);
+    first = false;
+    buff.clear();
+    bytes = 0;
+    return stat;
+  };
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint8_t* dst = reinterpret_cast<uint8_t*>(copies[i].dst);
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(copies[i].src);
+    size_t size = copies[i].size;
+    while (size != 0) {
+      // Split copies which would overflow the current submission.
+      const size_t room = (max_packets - buff.size()) * max_copy_size;
+      const size_t chunk = std::min(size, room);
+      const uint32_t num_copy_command = (chunk + max_copy_size - 1) / max_copy_size;
+      const size_t offset = buff.size();
+      buff.resize(offset + num_copy_command);
+      BuildCopyCommand(reinterpret_cast<char*>(&buff[offset]), num_copy_command, dst, src, chunk);
+      bytes += chunk;
+      dst += chunk;
+      src += chunk;
+      size -= chunk;
+
+      if (buff.size() == max_packets && (size != 0 || i + 1 < count)) {
+        hsa_status_t stat = flush(false);
+        if (stat != HSA_STATUS_SUCCESS) return stat;
+      }
+    }
+  }
+
+  // An all empty batch still has to complete, submit a lone completion sequence.
+  if (buff.empty()) return SubmitCommand(nullptr, 0, 0, first ? dep_signals : no_signals,
+                                         out_signal, gang_signals);
+  return flush(true);
+}
+
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::
+    SubmitStridedCopyCommand(const hsa_amd_memory_copy_strided_t* blocks, uint32_t count,
+                             std::vector<core::Signal*>& dep_signals,
+                             core::Signal& out_signal) {
+  const size_t max_copy_size = max_single_linear_copy_size_ ? max_single_linear_copy_size_ :
+                               kMaxSingleCopySize;
+  // Same submission bound as linear batches.
+  const size_t max_bytes = queue_size_ / 4;
+  const bool rect_supported = (agent_->supported_isas()[0]->GetMajorVersion() >= 9);
+
+  std::vector<char> buff;
+  std::vector<hsa_amd_memory_copy_descriptor_t> runs;
+  std::vector<core::Signal*> no_signals(0);
+  std::vector<core::Signal*> gang_signals(0);
+  uint64_t bytes = 0;
+  bool first = true;
+
+  auto flush = [&](bool last) {
+    hsa_status_t stat =
+        SubmitCommand(buff.empty() ? nullptr : &buff[0], buff.size(), bytes,
+                      first ? dep_signals : no_signals, last ? out_signal : *batch_signal_,
+                      gang_signals);
+    first = false;
+    buff.clear();
+    bytes = 0;
+    return stat;
+  };
+
+  // Writes pending contiguous runs as linear packets.
+  auto emit_runs = [&]() {
+    for (auto& run : runs) {
+      uint8_t* dst = reinterpret_cast<uint8_t*>(run.dst);
+      const uint8_t* src = reinterpret_cast<const uint8_t*>(run.src);
+      size_t size = run.size;
+      while (size != 0) {
+        const size_t room =
+            (max_bytes - buff.size()) / sizeof(SDMA_PKT_COPY_LINEAR) * max_copy_size;
+        if (room == 0) {
+          hsa_status_t stat = flush(false);
+          if (stat != HSA_STATUS_SUCCESS) return stat;
+          continue;
+        }
+        const size_t chunk = std::min(size, room);
+        const uint32_t num_copy_command = (chunk + max_copy_size - 1) / max_copy_size;
+        const size_t offset = buff.size();
+        buff.resize(offset + num_copy_command * sizeof(SDMA_PKT_COPY_LINEAR));
+        BuildCopyCommand(&buff[offset], num_copy_command, dst, src, chunk);
+        bytes += chunk;
+        dst += chunk;
+        src += chunk;
+        size -= chunk;
+      }
+    }
+    runs.clear();
+    return HSA_STATUS_SUCCESS;
+  };
+
+  std::vector<SDMA_PKT_COPY_LINEAR_RECT> rect;
+  auto append = [&](size_t size) {
+    assert(size == sizeof(SDMA_PKT_COPY_LINEAR_RECT) && "SDMA packet size missmatch");
+    rect.emplace_back(SDMA_PKT_COPY_LINEAR_RECT());
+    return &rect.back();
+  };
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (blocks[i].width == 0) continue;
+
+    // A single row of slices is a 2D block with the slice as pitch.
+    hsa_amd_memory_copy_strided_t block = blocks[i];
+    if (block.height == 1) {
+      block.height = block.depth;
+      block.dst_pitch = block.dst_slice;
+      block.src_pitch = block.src_slice;
+      block.depth = 1;
+    }
+    if (block.depth == 1) {
+      block.dst_slice = block.dst_pitch * block.height;
+      block.src_slice = block.src_pitch * block.height;
+    }
+
+    rect.clear();
+    if (rect_supported && (block.height > 1) && (block.width <= UINT32_MAX) &&
+        (block.height <= UINT32_MAX) && (block.depth <= UINT32_MAX) &&
+        (block.dst_pitch % 4 == 0) && (block.src_pitch % 4 == 0) &&
+        (block.dst_slice % 4 == 0) && (block.src_slice % 4 == 0)) {
+      // Bases are DWORD aligned, their remainder is carried as an x offset.
+      hsa_pitched_ptr_t dst = {reinterpret_cast<void*>(uintptr_t(block.dst) & ~3ull),
+                               block.dst_pitch, block.dst_slice};
+      hsa_pitched_ptr_t src = {reinterpret_cast<void*>(uintptr_t(block.src) & ~3ull),
+                               block.src_pitch, block.src_slice};
+      hsa_dim3_t dst_offset = {uint32_t(uintptr_t(block.dst) & 3), 0, 0};
+      hsa_dim3_t src_offset = {uint32_t(uintptr_t(block.src) & 3), 0, 0};
+      hsa_dim3_t range = {uint32_t(block.width), uint32_t(block.height), uint32_t(block.depth)};
+      try {
+        BuildCopyRectCommand(append, &dst, &dst_offset, &src, &src_offset, &range);
+      } catch (const AMD::hsa_exception&) {
+        // Pitch or slice not representable by the engine, copy it by rows.
+        rect.clear();
+      }
+    }
+
+    if (rect.empty()) {
+      AppendStridedRuns(blocks[i], runs);
+      continue;
+    }
+
+    hsa_status_t stat = emit_runs();
+    if (stat != HSA_STATUS_SUCCESS) return stat;
+    for (auto& pkt : rect) {
+      if (buff.size() + sizeof(pkt) > max_bytes) {
+        stat = flush(false);
+        if (stat != HSA_STATUS_SUCCESS) return stat;
+      }
+      const size_t offset = buff.size();
+      buff.resize(offset + sizeof(pkt));
+      memcpy(&buff[offset], &pkt, sizeof(pkt));
+    }
+    bytes += block.width * block.height * block.depth;
+  }
+
+  hsa_status_t stat = emit_runs();
+  if (stat != HSA_STATUS_SUCCESS) return stat;
+  return flush(true);
+}
+
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
 hsa_status_t
 BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::SubmitCopyRectCommand(
@@ -638,6 +875,154 @@ hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
   return SubmitBlockingCommand(&buff[0], buff.size() * sizeof(SDMA_PKT_CONSTANT_FILL), size);
 }
 
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::
+    SubmitLinearFillCommand(void* ptr, const uint32_t* pattern, uint32_t pattern_dwords,
+                            size_t size, std::vector<core::Signal*>& dep_signals,
+                            core::Signal& out_signal) {
+  // Constant fill repeats a single dword.
+  if (pattern_dwords != 1 || !IsMultipleOf(ptr, sizeof(uint32_t)) ||
+      !IsMultipleOf(size, sizeof(uint32_t)))
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  const uint32_t num_fill_command = (size + kMaxSingleFillSize - 1) / kMaxSingleFillSize;
+
+  std::vector<SDMA_PKT_CONSTANT_FILL> buff(num_fill_command);
+  BuildFillCommand(reinterpret_cast<char*>(&buff[0]), num_fill_command, ptr, pattern[0],
+                   size / sizeof(uint32_t));
+
+  std::vector<core::Signal*> gang_signals(0);
+  return SubmitCommand(&buff[0], buff.size() * sizeof(SDMA_PKT_CONSTANT_FILL), size, dep_signals,
+                       out_signal, gang_signals);
+}
+
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::
+    BuildCommandStream(const hsa_amd_copy_command_t* commands, uint32_t count,
+                       std::vector<uint32_t>& stream, uint64_t& bytes) {
+  const size_t max_copy_size = max_single_linear_copy_size_ ? max_single_linear_copy_size_ :
+                               kMaxSingleCopySize;
+
+  stream.clear();
+  bytes = 0;
+
+  // Grows the stream by size bytes and returns where to build the new packets.
+  auto append = [&](size_t size) {
+    assert(IsMultipleOf(size, sizeof(uint32_t)) && "SDMA packets are DWORD sized");
+    const size_t offset = stream.size();
+    stream.resize(offset + size / sizeof(uint32_t));
+    return reinterpret_cast<char*>(&stream[offset]);
+  };
+
+  for (uint32_t i = 0; i < count; i++) {
+    const hsa_amd_copy_command_t& command = commands[i];
+    switch (command.type) {
+      case HSA_AMD_COPY_COMMAND_COPY: {
+        const size_t size = command.copy.size;
+        if (size == 0) break;
+        const uint32_t num_copy_command = (size + max_copy_size - 1) / max_copy_size;
+        BuildCopyCommand(append(num_copy_command * linear_copy_command_size_), num_copy_command,
+                         command.copy.dst, command.copy.src, size);
+        bytes += size;
+        break;
+      }
+      case HSA_AMD_COPY_COMMAND_FILL: {
+        if (command.fill.count == 0) break;
+        if (!IsMultipleOf(command.fill.ptr, sizeof(uint32_t)))
+          return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+        const size_t size = command.fill.count * sizeof(uint32_t);
+        const uint32_t num_fill_command = (size + kMaxSingleFillSize - 1) / kMaxSingleFillSize;
+        BuildFillCommand(append(num_fill_command * fill_command_size_), num_fill_command,
+                         command.fill.ptr, command.fill.value, command.fill.count);
+        bytes += size;
+        break;
+      }
+      case HSA_AMD_COPY_COMMAND_WAIT: {
+        // Poll checks 32 bit values, match the upper half before the lower half.
+        uint32_t* signal_addr = reinterpret_cast<uint32_t*>(
+            core::Signal::Convert(command.wait.signal)->ValueLocation());
+        const uint64_t value = static_cast<uint64_t>(command.wait.value);
+        BuildPollCommand(append(poll_command_size_), &signal_addr[1],
+                         static_cast<uint32_t>(value >> 32));
+        BuildPollCommand(append(poll_command_size_), &signal_addr[0],
+                         static_cast<uint32_t>(value));
+        break;
+      }
+      case HSA_AMD_COPY_COMMAND_SIGNAL: {
+        // The value at submission is unknown when recording, so only an atomic decrement works.
+        if (!platform_atomic_support_) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+        core::Signal* signal = core::Signal::Convert(command.signal.signal);
+
+        // Make prior writes visible to whoever observes the signal.
+        if (useGCR) BuildGCRCommand(append(gcr_command_size_), false);
+        BuildAtomicDecrementCommand(append(atomic_command_size_), signal->ValueLocation());
+
+        if (signal->signal_.event_mailbox_ptr != 0) {
+          BuildFenceCommand(append(fence_command_size_),
+                            reinterpret_cast<uint32_t*>(signal->signal_.event_mailbox_ptr),
+                            static_cast<uint32_t>(signal->signal_.event_id));
+          BuildTrapCommand(append(trap_command_size_), signal->signal_.event_id);
+        }
+        break;
+      }
+      default:
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+  }
+
+  return HSA_STATUS_SUCCESS;
+}
+
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::
+    SubmitCommandStream(const std::vector<uint32_t>& stream, uint64_t bytes,
+                        std::vector<core::Signal*>& dep_signals, core::Signal& out_signal) {
+  std::vector<core::Signal*> gang_signals(0);
+
+  return SubmitCommand(stream.empty() ? nullptr : &stream[0], stream.size() * sizeof(uint32_t),
+                       bytes, dep_signals, out_signal, gang_signals);
+}
+
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+void* BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::CaptureCommandStream(
+    const std::vector<uint32_t>& stream) {
+  if (!core::Runtime::runtime_singleton_->flag().sdma_indirect_copy_list() || stream.empty() ||
+      stream.size() > kMaxIndirectSize)
+    return nullptr;
+
+  const size_t size = stream.size() * sizeof(uint32_t);
+  core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_BLIT);
+  void* indirect_buffer =
+      agent_->system_allocator()(size, 0x1000, core::MemoryRegion::AllocateExecutable);
+  if (indirect_buffer == nullptr) return nullptr;
+
+  memcpy(indirect_buffer, &stream[0], size);
+  return indirect_buffer;
+}
+
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+void BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::ReleaseCommandStream(
+    void* indirect_buffer) {
+  // The engine retires submissions in order, an empty blocking submission drains any launch
+  // which may still fetch from the buffer.
+  SubmitBlockingCommand(nullptr, 0, 0);
+  agent_->system_deallocator()(indirect_buffer);
+}
+
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::
+    SubmitIndirectCommandStream(const void* indirect_buffer, uint32_t size_dw, uint64_t bytes,
+                                std::vector<core::Signal*>& dep_signals,
+                                core::Signal& out_signal) {
+  SDMA_PKT_INDIRECT packet;
+  BuildIndirectCommand(reinterpret_cast<char*>(&packet), indirect_buffer, size_dw);
+
+  std::vector<core::Signal*> gang_signals(0);
+
+  return SubmitCommand(&packet, indirect_command_size_, bytes, dep_signals, out_signal,
+                       gang_signals, true);
+}
+
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
 hsa_status_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::EnableProfiling(
     bool enable) {
@@ -648,7 +1033,7 @@ template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bo
 char* BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::AcquireWriteAddress(
     uint32_t cmd_size, RingIndexTy& curr_index) {
   // Ring is full when all but one byte is written.
-  if (cmd_size >= kQueueSize) {
+  if (cmd_size >= queue_size_) {
     return nullptr;
   }
 
@@ -725,7 +1110,7 @@ void BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset,
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
 void BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::ReleaseWriteAddress(
     RingIndexTy curr_index, uint32_t cmd_size) {
-  if (cmd_size > kQueueSize) {
+  if (cmd_size > queue_size_) {
     assert(false && "cmd_addr is outside the queue buffer range");
     return;
   }
@@ -737,7 +1122,7 @@ template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bo
 void BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::PadRingToEnd(
     RingIndexTy curr_index) {
   // Reserve region from here to the end of the ring.
-  RingIndexTy new_index = curr_index + (kQueueSize - WrapIntoRing(curr_index));
+  RingIndexTy new_index = curr_index + (queue_size_ - WrapIntoRing(curr_index));
 
   // Check whether the engine has finished using this region.
   if (CanWriteUpto(new_index) == false) {
@@ -761,7 +1146,7 @@ void BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::PadRing
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
 uint32_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::WrapIntoRing(
     RingIndexTy index) {
-  return index & (kQueueSize - 1);
+  return index & (queue_size_ - 1);
 }
 
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
@@ -775,15 +1160,15 @@ bool BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::CanWrit
     read_index = hw_read_index;
   } else {
     // Calculate distance from commit index to HW read index.
-    // Commit index is always < kQueueSize away from HW read index.
+    // Commit index is always < queue_size_ away from HW read index.
     RingIndexTy commit_index = atomic::Load(&cached_commit_index_, std::memory_order_relaxed);
     RingIndexTy dist_to_read_index = WrapIntoRing(commit_index - hw_read_index);
     read_index = commit_index - dist_to_read_index;
   }
 
   // Check whether the read pointer has passed the given index.
-  // At most we can submit (kQueueSize - 1) bytes at a time.
-  return (upto_index - read_index) < kQueueSize;
+  // At most we can submit (queue_size_ - 1) bytes at a time.
+  return (upto_index - read_index) < queue_size_;
 }
 
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
@@ -1126,6 +1511,58 @@ void BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::BuildGC
   addr->WORD2_UNION.GCR_CONTROL_GL2_RANGE = 0;
 }
 
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+void BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::BuildIndirectCommand(
+    char* cmd_addr, const void* indirect_buffer, uint32_t size_dw) {
+  assert(IsMultipleOf(indirect_buffer, 32) && "Indirect buffer must be 32 byte aligned");
+  SDMA_PKT_INDIRECT* packet_addr = reinterpret_cast<SDMA_PKT_INDIRECT*>(cmd_addr);
+
+  memset(packet_addr, 0, sizeof(SDMA_PKT_INDIRECT));
+
+  // The engine fetches with the queue's VMID, vmid and the context save area stay 0.
+  packet_addr->HEADER_UNION.op = SDMA_OP_INDIRECT;
+  packet_addr->BASE_LO_UNION.ib_base_31_0 = ptrlow32(indirect_buffer);
+  packet_addr->BASE_HI_UNION.ib_base_63_32 = ptrhigh32(indirect_buffer);
+  packet_addr->IB_SIZE_UNION.ib_size = size_dw;
+}
+
+template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
+void BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::SubmitInterrupt(
+    core::Signal& signal) {
+  const uint32_t command_size = fence_command_size_ + trap_command_size_;
+  const uint32_t pad_size =
+      command_size < min_submission_size_ ? min_submission_size_ - command_size : 0;
+
+  RingIndexTy curr_index;
+  char* command_addr;
+  uint64_t bytes;
+  {
+    std::lock_guard<std::mutex> lock(reservation_lock_);
+    command_addr = AcquireWriteAddress(command_size + pad_size, curr_index);
+    if (command_addr == nullptr) return;
+    bytes = bytes_queued_;
+  }
+  uint32_t wrapped_index = WrapIntoRing(curr_index);
+
+  BuildFenceCommand(command_addr, reinterpret_cast<uint32_t*>(signal.signal_.event_mailbox_ptr),
+                    static_cast<uint32_t>(signal.signal_.event_id));
+  command_addr += fence_command_size_;
+  bytes_written_[wrapped_index] = bytes;
+  wrapped_index += fence_command_size_;
+
+  BuildTrapCommand(command_addr, signal.signal_.event_id);
+  command_addr += trap_command_size_;
+  bytes_written_[wrapped_index] = bytes;
+
+  if (pad_size) {
+    memset(command_addr, 0, pad_size);
+    uint32_t* dword_command_addr = reinterpret_cast<uint32_t*>(command_addr);
+    dword_command_addr[0] = (pad_size / 4 - 1) << 16;
+  }
+
+  ReleaseWriteAddress(curr_index, command_size + pad_size);
+}
+
 template <typename RingIndexTy, bool HwIndexMonotonic, int SizeToCountOffset, bool useGCR>
 uint64_t BlitSdma<RingIndexTy, HwIndexMonotonic, SizeToCountOffset, useGCR>::PendingBytes() {
   RingIndexTy commit = atomic::Load(&cached_commit_index_, std::memory_order_acquire);
@@ -1146,5 +1583,57 @@ template class BlitSdma<uint32_t, false, 0, false>;
 template class BlitSdma<uint64_t, true, -1, false>;
 template class BlitSdma<uint64_t, true, -1, true>;
 
+CopyList::~CopyList() {
+  if (indirect_buffer_ != nullptr) blit_->ReleaseCommandStream(indirect_buffer_);
+}
+
+hsa_status_t CopyList::Record(const hsa_amd_copy_command_t* commands, uint32_t count) {
+  hsa_status_t err = blit_->BuildCommandStream(commands, count, stream_, bytes_);
+  if (err != HSA_STATUS_SUCCESS) return err;
+
+  size_dw_ = static_cast<uint32_t>(stream_.size());
+  indirect_buffer_ = blit_->CaptureCommandStream(stream_);
+  if (indirect_buffer_ != nullptr) {
+    std::vector<uint32_t>().swap(stream_);
+    return HSA_STATUS_SUCCESS;
+  }
+
+  // Uncaptured streams are written to the ring, each submission must fit along with its
+  // dependency and completion packets.
+  if (stream_.size() * sizeof(uint32_t) > BlitSdmaBase::kQueueSize / 4)
+    return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t CopyList::Submit(std::vector<core::Signal*>& dep_signals, core::Signal& out_signal) {
+  if (agent_->profiling_enabled()) out_signal.async_copy_agent(agent_);
+  if (indirect_buffer_ != nullptr)
+    return blit_->SubmitIndirectCommandStream(indirect_buffer_, size_dw_, bytes_, dep_signals,
+                                              out_signal);
+  return blit_->SubmitCommandStream(stream_, bytes_, dep_signals, out_signal);
+}
+
+CopyContext::~CopyContext() {
+  if (!owns_blit_) return;
+
+  // Destroying the queue drops whatever it still holds, wait for a trailing completion first.
+  core::Signal* drained = new core::DefaultSignal(1);
+  MAKE_SCOPE_GUARD([&]() { drained->DestroySignal(); });
+  std::vector<core::Signal*> no_signals(0);
+  if (blit_->SubmitLinearCopyBatchCommand(nullptr, 0, no_signals, *drained) == HSA_STATUS_SUCCESS)
+    drained->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, -1, HSA_WAIT_STATE_BLOCKED);
+
+  blit_->Destroy(*agent_);
+  delete blit_;
+}
+
+hsa_status_t CopyContext::Submit(void* dst, const void* src, size_t size,
+                                 std::vector<core::Signal*>& dep_signals,
+                                 core::Signal& out_signal) {
+  if (agent_->profiling_enabled()) out_signal.async_copy_agent(agent_);
+  std::vector<core::Signal*> gang_signals(0);
+  return blit_->SubmitLinearCopyCommand(dst, src, size, dep_signals, out_signal, gang_signals);
+}
+
 }  // namespace amd
 }  // namespace rocr
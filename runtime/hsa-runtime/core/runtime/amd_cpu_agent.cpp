@@ -46,9 +46,12 @@
 #include <cstring>
 #include <thread>
 
+#include "core/inc/blit.h"
+#include "core/inc/amd_cpu_queue.h"
 #include "core/inc/amd_memory_region.h"
 #include "core/inc/driver.h"
 #include "core/inc/host_queue.h"
+#include "core/inc/interrupt_signal.h"
 
 #include "inc/hsa_ext_image.h"
 
@@ -221,7 +224,7 @@ hsa_status_t CpuAgent::GetInfo(hsa_agent_info_t attribute, void* value) const {
       std::memcpy(value, "CPU", sizeof("CPU"));
       break;
     case HSA_AGENT_INFO_FEATURE:
-      *((hsa_agent_feature_t*)value) = static_cast<hsa_agent_feature_t>(0);
+      *((hsa_agent_feature_t*)value) = HSA_AGENT_FEATURE_AGENT_DISPATCH;
       break;
     case HSA_AGENT_INFO_MACHINE_MODEL:
 #if defined(HSA_LARGE_MODEL)
@@ -263,13 +266,14 @@ hsa_status_t CpuAgent::GetInfo(hsa_agent_info_t attribute, void* value) const {
       *((uint32_t*)value) = 0;
       break;
     case HSA_AGENT_INFO_QUEUES_MAX:
-      *((uint32_t*)value) = 0;
+      *((uint32_t*)value) = kMaxQueues;
       break;
     case HSA_AGENT_INFO_QUEUE_MIN_SIZE:
-      *((uint32_t*)value) = 0;
+    case HSA_AMD_AGENT_INFO_QUEUE_RECOMMENDED_SIZE:
+      *((uint32_t*)value) = kMinQueueSize;
       break;
     case HSA_AGENT_INFO_QUEUE_MAX_SIZE:
-      *((uint32_t*)value) = 0;
+      *((uint32_t*)value) = kMaxQueueSize;
       break;
     case HSA_AGENT_INFO_QUEUE_TYPE:
       *((hsa_queue_type32_t*)value) = HSA_QUEUE_TYPE_MULTI;
@@ -415,6 +419,17 @@ hsa_status_t CpuAgent::GetInfo(hsa_agent_info_t attribute, void* value) const {
     case HSA_AMD_AGENT_INFO_AQL_EXTENSIONS:
       memset(value, 0, sizeof(uint8_t) * 8);
       break;
+    case HSA_AMD_AGENT_INFO_SCRATCH_RESERVED_SIZE:
+    case HSA_AMD_AGENT_INFO_SCRATCH_IN_USE_SIZE:
+    case HSA_AMD_AGENT_INFO_SCRATCH_CACHED_SIZE:
+      *((size_t*)value) = 0;
+      break;
+    case HSA_AMD_AGENT_INFO_INIT_TIMES:
+      *((hsa_amd_agent_init_times_t*)value) = init_times();
+      break;
+    case HSA_AMD_AGENT_INFO_PARTITION_LAYOUT:
+      memset(value, 0, sizeof(hsa_amd_agent_partition_layout_t));
+      break;
     default:
       return HSA_STATUS_ERROR_INVALID_ARGUMENT;
       break;
@@ -427,8 +442,27 @@ hsa_status_t CpuAgent::QueueCreate(size_t size, hsa_queue_type32_t queue_type,
                                    void* data, uint32_t private_segment_size,
                                    uint32_t group_segment_size,
                                    core::Queue** queue) {
-  // No HW AQL packet processor on CPU device.
-  return HSA_STATUS_ERROR;
+  if (!IsPowerOfTwo(size) || size < kMinQueueSize || size > kMaxQueueSize)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  // No HW AQL packet processor on CPU device, agent dispatch packets run on a thread pool bound
+  // to the agent's cores.
+  {
+    ScopedAcquire<KernelMutex> lock(&executor_lock_);
+    if (!executor_) {
+      std::vector<uint32_t> cpus(properties_.NumCPUCores);
+      for (uint32_t i = 0; i < cpus.size(); i++) cpus[i] = properties_.CComputeIdLo + i;
+      uint32_t threads = core::Runtime::runtime_singleton_->flag().cpu_queue_threads();
+      if (threads == 0 || threads > cpus.size()) threads = cpus.size();
+      executor_.reset(new HostExecutor(cpus, threads));
+    }
+  }
+
+  core::Signal* doorbell = new core::InterruptSignal(-1);
+  MAKE_NAMED_SCOPE_GUARD(doorbellGuard, [&]() { doorbell->DestroySignal(); });
+  *queue = new CpuQueue(this, executor_.get(), doorbell, size, queue_type, event_callback, data);
+  doorbellGuard.Dismiss();
+  return HSA_STATUS_SUCCESS;
 }
 
 hsa_status_t CpuAgent::DmaCopy(void* dst, core::Agent& dst_agent, const void* src,
@@ -463,5 +497,52 @@ hsa_status_t CpuAgent::DmaCopy(void* dst, core::Agent& dst_agent, const void* sr
   return HSA_STATUS_SUCCESS;
 }
 
+hsa_status_t CpuAgent::DmaCopyBatch(const hsa_amd_memory_copy_descriptor_t* copies,
+                                    uint32_t count, core::Agent& dst_agent,
+                                    core::Agent& src_agent,
+                                    std::vector<core::Signal*>& dep_signals,
+                                    core::Signal& out_signal) {
+  // For cpu to cpu, fire and forget one copy thread for the whole batch.
+  const bool profiling_enabled = (dst_agent.profiling_enabled() || src_agent.profiling_enabled());
+  if (profiling_enabled) out_signal.async_copy_agent(this);
+  std::thread(
+      [](std::vector<hsa_amd_memory_copy_descriptor_t> copies,
+         std::vector<core::Signal*> dep_signals, core::Signal* completion_signal,
+         bool profiling_enabled) {
+        for (core::Signal* dep : dep_signals) {
+          dep->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX, HSA_WAIT_STATE_BLOCKED);
+        }
+
+        if (profiling_enabled) {
+          core::Runtime::runtime_singleton_->GetSystemInfo(HSA_SYSTEM_INFO_TIMESTAMP,
+                                                           &completion_signal->signal_.start_ts);
+        }
+
+        for (auto& copy : copies) memcpy(copy.dst, copy.src, copy.size);
+
+        if (profiling_enabled) {
+          core::Runtime::runtime_singleton_->GetSystemInfo(HSA_SYSTEM_INFO_TIMESTAMP,
+                                                           &completion_signal->signal_.end_ts);
+        }
+
+        completion_signal->SubRelease(1);
+      },
+      std::vector<hsa_amd_memory_copy_descriptor_t>(copies, copies + count), dep_signals,
+      &out_signal, profiling_enabled)
+      .detach();
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t CpuAgent::DmaCopyStrided(const hsa_amd_memory_copy_strided_t* blocks,
+                                      uint32_t count, core::Agent& dst_agent,
+                                      core::Agent& src_agent,
+                                      std::vector<core::Signal*>& dep_signals,
+                                      core::Signal& out_signal) {
+  std::vector<hsa_amd_memory_copy_descriptor_t> copies;
+  for (uint32_t i = 0; i < count; i++) core::Blit::AppendStridedRuns(blocks[i], copies);
+  if (copies.empty()) copies.push_back({nullptr, nullptr, 0});
+  return DmaCopyBatch(&copies[0], copies.size(), dst_agent, src_agent, dep_signals, out_signal);
+}
+
 }  // namespace amd
 }  // namespace rocr
@@ -0,0 +1,400 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+#include "core/inc/amd_cpu_queue.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "core/inc/runtime.h"
+
+namespace rocr {
+namespace AMD {
+
+thread_local HostExecutor::Worker* HostExecutor::current_ = nullptr;
+
+HostExecutor::HostExecutor(const std::vector<uint32_t>& cpus, uint32_t threads)
+    : cpus_(cpus), next_(0), exit_(false) {
+  MAKE_NAMED_SCOPE_GUARD(workerGuard, [&]() { Stop(); });
+
+  threads = std::max(threads, 1u);
+  for (uint32_t i = 0; i < threads; i++) {
+    std::unique_ptr<Worker> worker(new Worker());
+    worker->owner = this;
+    worker->index = i;
+    worker->idle = false;
+    worker->thread = nullptr;
+    worker->wake = os::CreateOsEvent(true, false);
+    if (worker->wake == nullptr)
+      throw AMD::hsa_exception(HSA_STATUS_ERROR_OUT_OF_RESOURCES,
+                               "Host executor event creation failed.");
+    workers_.push_back(std::move(worker));
+  }
+
+  // Start only once every worker exists, so stealing never sees a partial pool.
+  for (auto& worker : workers_) {
+    worker->thread = os::CreateThread(WorkerRun, worker.get());
+    if (worker->thread == nullptr)
+      throw AMD::hsa_exception(HSA_STATUS_ERROR_OUT_OF_RESOURCES,
+                               "Host executor thread creation failed.");
+  }
+
+  workerGuard.Dismiss();
+}
+
+HostExecutor::~HostExecutor() { Stop(); }
+
+void HostExecutor::Stop() {
+  exit_.store(true);
+  for (auto& worker : workers_) {
+    if (worker->wake != nullptr) os::SetOsEvent(worker->wake);
+  }
+  for (auto& worker : workers_) {
+    if (worker->thread != nullptr) {
+      os::WaitForThread(worker->thread);
+      os::CloseThread(worker->thread);
+    }
+    if (worker->wake != nullptr) os::DestroyOsEvent(worker->wake);
+  }
+  workers_.clear();
+}
+
+void HostExecutor::Submit(TaskFunc func, void* arg) {
+  Worker* target = ((current_ != nullptr) && (current_->owner == this))
+      ? current_
+      : workers_[next_.fetch_add(1, std::memory_order_relaxed) % workers_.size()].get();
+  {
+    ScopedAcquire<KernelMutex> lock(&target->lock);
+    target->tasks.push_back({func, arg});
+  }
+
+  // Idle workers publish idle before their last look at the deques, so one of the two sides
+  // always sees the other.
+  if (target->idle.load()) {
+    os::SetOsEvent(target->wake);
+    return;
+  }
+  for (auto& worker : workers_) {
+    if (worker->idle.load()) {
+      os::SetOsEvent(worker->wake);
+      return;
+    }
+  }
+}
+
+void HostExecutor::WorkerRun(void* worker) {
+  Worker* self = reinterpret_cast<Worker*>(worker);
+  self->owner->WorkerLoop(self);
+}
+
+void HostExecutor::WorkerLoop(Worker* worker) {
+  current_ = worker;
+  if (!cpus_.empty()) os::SetThreadAffinity(&cpus_[0], cpus_.size());
+
+  Task task;
+  while (true) {
+    if (Pop(worker, &task) || Steal(worker, &task)) {
+      task.func(task.arg);
+      continue;
+    }
+
+    worker->idle.store(true);
+    if (exit_.load()) break;
+    if (Pop(worker, &task) || Steal(worker, &task)) {
+      worker->idle.store(false);
+      task.func(task.arg);
+      continue;
+    }
+    os::WaitForOsEvent(worker->wake, 0xFFFFFFFF);
+    worker->idle.store(false);
+  }
+  current_ = nullptr;
+}
+
+bool HostExecutor::Pop(Worker* worker, Task* task) {
+  ScopedAcquire<KernelMutex> lock(&worker->lock);
+  if (worker->tasks.empty()) return false;
+  *task = worker->tasks.back();
+  worker->tasks.pop_back();
+  return true;
+}
+
+bool HostExecutor::Steal(Worker* thief, Task* task) {
+  const size_t count = workers_.size();
+  for (size_t i = 1; i < count; i++) {
+    Worker* victim = workers_[(thief->index + i) % count].get();
+    ScopedAcquire<KernelMutex> lock(&victim->lock);
+    if (victim->tasks.empty()) continue;
+    *task = victim->tasks.front();
+    victim->tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+CpuQueue::CpuQueue(core::Agent* agent, HostExecutor* executor, core::Signal* doorbell,
+                   uint32_t size, hsa_queue_type32_t type, core::HsaEventCallback callback,
+                   void* data)
+    : core::HostQueue(
+          core::MemoryRegion::Convert(core::Runtime::runtime_singleton_->system_regions_fine()[0]),
+          size, type, HSA_QUEUE_FEATURE_AGENT_DISPATCH, core::Signal::Convert(doorbell)),
+      agent_(agent),
+      executor_(executor),
+      doorbell_(doorbell),
+      errors_callback_(callback),
+      errors_data_(data),
+      active_(true),
+      scheduled_(false),
+      rescan_(false),
+      inflight_(0),
+      barrier_waiting_(false),
+      tasks_(0),
+      doorbell_armed_(false),
+      dependency_index_(UINT64_MAX) {
+  link_ = std::make_shared<HandlerLink>();
+  link_->queue = this;
+
+  // The first packet's doorbell store wakes the queue.
+  Schedule();
+}
+
+CpuQueue::~CpuQueue() {
+  Inactivate();
+  while (tasks_.load() != 0) os::YieldThread();
+  doorbell_->DestroySignal();
+}
+
+hsa_status_t CpuQueue::Inactivate() {
+  if (active_.exchange(false)) {
+    ScopedAcquire<KernelMutex> lock(&link_->lock);
+    link_->queue = nullptr;
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t CpuQueue::GetInfo(hsa_queue_info_attribute_t attribute, void* value) {
+  switch (attribute) {
+    case HSA_AMD_QUEUE_INFO_AGENT:
+      *static_cast<hsa_agent_t*>(value) = agent_->public_handle();
+      break;
+    default:
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+void CpuQueue::Schedule() {
+  rescan_.store(true);
+  if (scheduled_.exchange(true)) return;
+  tasks_++;
+  executor_->Submit(ProcessRun, this);
+}
+
+void CpuQueue::ProcessRun(void* queue) {
+  CpuQueue* self = reinterpret_cast<CpuQueue*>(queue);
+  hsa_status_t status;
+  do {
+    self->rescan_.store(false);
+    status = self->ProcessPackets();
+    self->scheduled_.store(false);
+  } while ((status == HSA_STATUS_SUCCESS) && self->rescan_.load() &&
+           !self->scheduled_.exchange(true));
+
+  if (status == HSA_STATUS_SUCCESS) {
+    self->tasks_--;
+    return;
+  }
+
+  // The callback may destroy the queue, so it runs after the task lets go of it.
+  core::HsaEventCallback callback = self->errors_callback_;
+  void* data = self->errors_data_;
+  hsa_queue_t* handle = self->public_handle();
+  self->tasks_--;
+  if (callback != nullptr) callback(status, handle, data);
+}
+
+hsa_status_t CpuQueue::ProcessPackets() {
+  core::AqlPacket* ring = reinterpret_cast<core::AqlPacket*>(amd_queue_.hsa_queue.base_address);
+  const uint32_t mask = amd_queue_.hsa_queue.size - 1;
+
+  while (active_.load(std::memory_order_relaxed)) {
+    const uint64_t index = LoadReadIndexRelaxed();
+    core::AqlPacket* slot = &ring[index & mask];
+    const uint16_t header = atomic::Load(&slot->packet.header, std::memory_order_acquire);
+    const uint8_t type = core::AqlPacket::type(header);
+
+    if (type == HSA_PACKET_TYPE_INVALID) {
+      // Producers ring the doorbell with the index of the packet they wrote.
+      if (!doorbell_armed_.exchange(true) &&
+          !WakeOn(amd_queue_.hsa_queue.doorbell_signal, HSA_SIGNAL_CONDITION_GTE, index,
+                  DoorbellHandler))
+        doorbell_armed_.store(false);
+      return HSA_STATUS_SUCCESS;
+    }
+
+    if ((header & (1 << HSA_PACKET_HEADER_BARRIER)) && (inflight_.load() != 0)) {
+      barrier_waiting_.store(true);
+      // The last host call may have finished before seeing barrier_waiting_.
+      if (inflight_.load() != 0) return HSA_STATUS_SUCCESS;
+      barrier_waiting_.store(false);
+    }
+
+    hsa_signal_t completion = {0};
+    switch (type) {
+      case HSA_PACKET_TYPE_AGENT_DISPATCH: {
+        if (slot->agent.type != HSA_AMD_AGENT_DISPATCH_HOST_CALL || slot->agent.arg[0] == 0) {
+          active_.store(false);
+          return HSA_STATUS_ERROR_INVALID_PACKET_FORMAT;
+        }
+        Dispatch* dispatch = new Dispatch();
+        dispatch->queue = this;
+        memcpy(&dispatch->packet, &slot->agent, sizeof(dispatch->packet));
+        inflight_++;
+        tasks_++;
+        executor_->Submit(DispatchRun, dispatch);
+        break;
+      }
+      case HSA_PACKET_TYPE_BARRIER_AND:
+      case HSA_PACKET_TYPE_BARRIER_OR:
+        if (!BarrierReady(slot->barrier_and, type == HSA_PACKET_TYPE_BARRIER_AND, index))
+          return HSA_STATUS_SUCCESS;
+        completion = slot->barrier_and.completion_signal;
+        break;
+      default:
+        active_.store(false);
+        return HSA_STATUS_ERROR_INVALID_PACKET_FORMAT;
+    }
+
+    // Free the slot before publishing the read index so the producer may reuse it.
+    atomic::Store(&slot->packet.header, uint16_t(HSA_PACKET_TYPE_INVALID), std::memory_order_relaxed);
+    StoreReadIndexRelease(index + 1);
+    Complete(completion);
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+bool CpuQueue::BarrierReady(const hsa_barrier_and_packet_t& packet, bool and_barrier,
+                            uint64_t index) {
+  bool any_dep = false;
+  for (const hsa_signal_t& dep : packet.dep_signal) {
+    if (dep.handle == 0) continue;
+    any_dep = true;
+    const bool met = (core::Signal::Convert(dep)->LoadAcquire() == 0);
+    if (met && !and_barrier) return true;
+    if (!met && and_barrier) {
+      if (dependency_index_.exchange(index) != index)
+        if (!WakeOn(dep, HSA_SIGNAL_CONDITION_EQ, 0, DependencyHandler))
+          dependency_index_.store(UINT64_MAX);
+      return false;
+    }
+  }
+  if (and_barrier || !any_dep) return true;
+
+  // Barrier-OR with every dependency unmet, any of them resolving wakes the queue.
+  if (dependency_index_.exchange(index) != index) {
+    for (const hsa_signal_t& dep : packet.dep_signal) {
+      if (dep.handle != 0) WakeOn(dep, HSA_SIGNAL_CONDITION_EQ, 0, DependencyHandler);
+    }
+  }
+  return false;
+}
+
+void CpuQueue::DispatchRun(void* dispatch) {
+  Dispatch* task = reinterpret_cast<Dispatch*>(dispatch);
+  CpuQueue* queue = task->queue;
+  const hsa_agent_dispatch_packet_t& packet = task->packet;
+
+  hsa_amd_host_call_t call = reinterpret_cast<hsa_amd_host_call_t>(packet.arg[0]);
+  call(packet.arg[1], packet.arg[2], packet.arg[3], packet.return_address);
+  Complete(packet.completion_signal);
+  delete task;
+
+  if ((queue->inflight_.fetch_sub(1) == 1) && queue->barrier_waiting_.exchange(false))
+    queue->Schedule();
+  queue->tasks_--;
+}
+
+void CpuQueue::Complete(hsa_signal_t completion) {
+  if (completion.handle != 0) core::Signal::Convert(completion)->SubRelease(1);
+}
+
+bool CpuQueue::WakeOn(hsa_signal_t signal, hsa_signal_condition_t cond, hsa_signal_value_t value,
+                      hsa_amd_signal_handler handler) {
+  auto* link = new std::shared_ptr<HandlerLink>(link_);
+  if (core::Runtime::runtime_singleton_->SetAsyncSignalHandler(signal, cond, value, handler,
+                                                               link) != HSA_STATUS_SUCCESS) {
+    delete link;
+    return false;
+  }
+  return true;
+}
+
+bool CpuQueue::DoorbellHandler(hsa_signal_value_t value, void* arg) {
+  auto* link = reinterpret_cast<std::shared_ptr<HandlerLink>*>(arg);
+  {
+    ScopedAcquire<KernelMutex> lock(&(*link)->lock);
+    CpuQueue* queue = (*link)->queue;
+    if (queue != nullptr) {
+      queue->doorbell_armed_.store(false);
+      queue->Schedule();
+    }
+  }
+  delete link;
+  return false;
+}
+
+bool CpuQueue::DependencyHandler(hsa_signal_value_t value, void* arg) {
+  auto* link = reinterpret_cast<std::shared_ptr<HandlerLink>*>(arg);
+  {
+    ScopedAcquire<KernelMutex> lock(&(*link)->lock);
+    CpuQueue* queue = (*link)->queue;
+    if (queue != nullptr) {
+      // The barrier may have another unmet dependency to arm.
+      queue->dependency_index_.store(UINT64_MAX);
+      queue->Schedule();
+    }
+  }
+  delete link;
+  return false;
+}
+
+}  // namespace AMD
+}  // namespace rocr
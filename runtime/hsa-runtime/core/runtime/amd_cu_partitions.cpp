@@ -0,0 +1,178 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+#include "core/inc/amd_cu_partitions.h"
+
+#include <algorithm>
+
+#include "core/inc/amd_gpu_agent.h"
+
+namespace rocr {
+namespace AMD {
+
+static uint32_t SliceSize(GpuAgent* agent) {
+  const HsaNodeProperties& props = agent->properties();
+  return std::max(props.NumShaderBanks * props.NumArrays, 1u);
+}
+
+static uint32_t CuCount(GpuAgent* agent) {
+  uint32_t cu_count = 0;
+  agent->GetInfo((hsa_agent_info_t)HSA_AMD_AGENT_INFO_COMPUTE_UNIT_COUNT, &cu_count);
+  return cu_count;
+}
+
+uint32_t CuPartitions::slice_count(GpuAgent* agent) {
+  return CuCount(agent) / SliceSize(agent);
+}
+
+CuPartitions::CuPartitions(GpuAgent* agent, uint32_t count)
+    : agent_(agent), cu_count_(CuCount(agent)), slice_size_(SliceSize(agent)) {
+  assert(count != 0 && count <= slice_count(agent) && "Too many CU partitions.");
+  const uint32_t slices = cu_count_ / slice_size_;
+  slices_.resize(count, slices / count);
+  for (uint32_t i = 0; i < slices % count; i++) slices_[i]++;
+  Layout();
+}
+
+CuPartitions::~CuPartitions() {
+  for (auto& bound : queues_) bound.first->SetCUMasking(0, nullptr);
+}
+
+void CuPartitions::Layout() {
+  first_.resize(slices_.size());
+  uint32_t next = 0;
+  for (size_t i = 0; i < slices_.size(); i++) {
+    first_[i] = next;
+    next += slices_[i];
+  }
+}
+
+hsa_status_t CuPartitions::Apply(core::Queue* queue, uint32_t index) {
+  uint32_t begin = first_[index] * slice_size_;
+  uint32_t end = begin + slices_[index] * slice_size_;
+  // CUs left over from the last whole slice go to the last partition.
+  if (index == slices_.size() - 1) end = cu_count_;
+
+  std::vector<uint32_t> mask((cu_count_ + 31) / 32, 0);
+  for (uint32_t cu = begin; cu < end; cu++) mask[cu / 32] |= 1u << (cu % 32);
+  hsa_status_t err = queue->SetCUMasking(mask.size() * 32, mask.data());
+  return (err == hsa_status_t(HSA_STATUS_CU_MASK_REDUCED)) ? HSA_STATUS_SUCCESS : err;
+}
+
+hsa_status_t CuPartitions::Bind(core::Queue* queue, uint32_t index) {
+  if (index != HSA_AMD_CU_PARTITION_NONE && index >= slices_.size())
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  hsa_agent_t queue_agent;
+  if (queue->GetInfo(HSA_AMD_QUEUE_INFO_AGENT, &queue_agent) != HSA_STATUS_SUCCESS ||
+      queue_agent.handle != agent_->public_handle().handle)
+    return HSA_STATUS_ERROR_INVALID_QUEUE;
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  auto it = std::find_if(queues_.begin(), queues_.end(),
+                         [&](const std::pair<core::Queue*, uint32_t>& bound) {
+                           return bound.first == queue;
+                         });
+
+  if (index == HSA_AMD_CU_PARTITION_NONE) {
+    if (it == queues_.end()) return HSA_STATUS_SUCCESS;
+    queues_.erase(it);
+    return queue->SetCUMasking(0, nullptr);
+  }
+
+  hsa_status_t err = Apply(queue, index);
+  if (err != HSA_STATUS_SUCCESS) return err;
+  if (it == queues_.end())
+    queues_.push_back({queue, index});
+  else
+    it->second = index;
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t CuPartitions::Rebalance() {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+
+  const uint32_t count = slices_.size();
+  std::vector<uint64_t> load(count, 0);
+  uint64_t total_load = 0;
+  for (auto& bound : queues_) {
+    core::Queue* queue = bound.first;
+    const uint64_t pending = queue->LoadWriteIndexRelaxed() - queue->LoadReadIndexRelaxed();
+    load[bound.second] += pending;
+    total_load += pending;
+  }
+  if (total_load == 0) return HSA_STATUS_SUCCESS;
+
+  // Every partition keeps a slice, the rest follow the load by largest remainder.
+  const uint32_t spare = cu_count_ / slice_size_ - count;
+  std::vector<uint32_t> slices(count, 1);
+  std::vector<std::pair<uint64_t, uint32_t>> remainders(count);
+  uint32_t assigned = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const uint64_t share = load[i] * spare;
+    slices[i] += share / total_load;
+    assigned += share / total_load;
+    remainders[i] = {share % total_load, i};
+  }
+  std::sort(remainders.begin(), remainders.end(),
+            [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) {
+              return a.first > b.first;
+            });
+  for (uint32_t i = 0; assigned < spare; i++, assigned++) slices[remainders[i].second]++;
+
+  std::vector<uint32_t> old_first = first_;
+  std::vector<uint32_t> old_slices = slices_;
+  slices_ = slices;
+  Layout();
+
+  // Queues of partitions that kept their CUs are left alone, each mask change is an ioctl.
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  for (auto& bound : queues_) {
+    const uint32_t index = bound.second;
+    if (first_[index] == old_first[index] && slices_[index] == old_slices[index]) continue;
+    hsa_status_t err = Apply(bound.first, index);
+    if (err != HSA_STATUS_SUCCESS) status = err;
+  }
+  return status;
+}
+
+}  // namespace AMD
+}  // namespace rocr
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+
+#include "core/inc/amd_dispatch_graph.h"
+
+#include <cstring>
+
+#include "core/inc/amd_gpu_agent.h"
+#include "core/inc/runtime.h"
+
+namespace rocr {
+namespace AMD {
+
+static const uint16_t kBarrierHeader = (HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE) |
+    (1 << HSA_PACKET_HEADER_BARRIER) |
+    (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_ACQUIRE_FENCE_SCOPE) |
+    (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_RELEASE_FENCE_SCOPE);
+
+// Alignment of each packet's captured kernel arguments.
+static const size_t kKernargAlign = 64;
+
+DispatchGraph::DispatchGraph(GpuAgent* agent)
+    : agent_(agent), packet_count_(0), last_signal_({0}), kernargs_(nullptr) {
+  inflight_ = new core::InterruptSignal(0);
+}
+
+DispatchGraph::~DispatchGraph() {
+  if (kernargs_ != nullptr) {
+    inflight_->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, -1, HSA_WAIT_STATE_BLOCKED);
+    agent_->system_deallocator()(kernargs_);
+  }
+  inflight_->DestroySignal();
+}
+
+hsa_status_t DispatchGraph::Record(const core::AqlPacket* packets, uint32_t count,
+                                   const uint32_t* kernarg_sizes) {
+  size_t kernarg_bytes = 0;
+  kernarg_blocks_.assign(count, std::make_pair(size_t(0), 0u));
+  for (uint32_t i = 0; i < count; i++) {
+    const uint16_t header = packets[i].packet.header;
+    const uint8_t type = core::AqlPacket::type(header);
+    if (!core::AqlPacket::IsValid(header) ||
+        (type != HSA_PACKET_TYPE_KERNEL_DISPATCH && type != HSA_PACKET_TYPE_BARRIER_AND &&
+         type != HSA_PACKET_TYPE_BARRIER_OR))
+      return HSA_STATUS_ERROR_INVALID_PACKET_FORMAT;
+
+    const uint32_t size = (kernarg_sizes != nullptr) ? kernarg_sizes[i] : 0;
+    if (size == 0) continue;
+    if (type != HSA_PACKET_TYPE_KERNEL_DISPATCH || packets[i].dispatch.kernarg_address == nullptr)
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+    kernarg_blocks_[i] = std::make_pair(kernarg_bytes, size);
+    kernarg_bytes += AlignUp(size_t(size), kKernargAlign);
+  }
+
+  if (kernarg_bytes != 0) {
+    core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_KERNARG);
+    kernargs_ = reinterpret_cast<uint8_t*>(agent_->system_allocator()(
+        kernarg_bytes, kKernargAlign, core::MemoryRegion::AllocateNoFlags));
+    if (kernargs_ == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
+  image_.assign(packets, packets + count);
+  packet_count_ = count;
+  for (uint32_t i = 0; i < count; i++) {
+    if (kernarg_blocks_[i].second == 0) continue;
+    uint8_t* args = kernargs_ + kernarg_blocks_[i].first;
+    memcpy(args, packets[i].dispatch.kernarg_address, kernarg_blocks_[i].second);
+    image_[i].dispatch.kernarg_address = args;
+  }
+
+  // The completion signal sits at the same offset in every packet type.
+  last_signal_ = image_[count - 1].barrier_and.completion_signal;
+
+  if (kernargs_ != nullptr) {
+    core::AqlPacket barrier;
+    barrier.packet.body = {};
+    barrier.barrier_and.completion_signal = core::Signal::Convert(inflight_);
+    barrier.barrier_and.header = kBarrierHeader;
+    image_.push_back(barrier);
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t DispatchGraph::Launch(core::Queue* queue, uint32_t update_count,
+                                   const hsa_amd_dispatch_graph_update_t* updates,
+                                   hsa_signal_t completion_signal) {
+  if (image_.size() > queue->amd_queue_.hsa_queue.size) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  for (uint32_t i = 0; i < update_count; i++) {
+    const hsa_amd_dispatch_graph_update_t& update = updates[i];
+    if (update.packet_index >= packet_count_ || update.data == nullptr)
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    const uint32_t block_size = kernarg_blocks_[update.packet_index].second;
+    if (block_size == 0 || update.offset > block_size || update.size > block_size - update.offset)
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+
+  if (update_count != 0) {
+    // Earlier launches may still be reading the arguments.
+    inflight_->WaitAcquire(HSA_SIGNAL_CONDITION_EQ, 0, -1, HSA_WAIT_STATE_BLOCKED);
+    for (uint32_t i = 0; i < update_count; i++) {
+      const hsa_amd_dispatch_graph_update_t& update = updates[i];
+      memcpy(kernargs_ + kernarg_blocks_[update.packet_index].first + update.offset, update.data,
+             update.size);
+    }
+  }
+
+  image_[packet_count_ - 1].barrier_and.completion_signal =
+      (completion_signal.handle != 0) ? completion_signal : last_signal_;
+
+  if (kernargs_ != nullptr) inflight_->AddRelaxed(1);
+  hsa_status_t err = queue->SubmitBatch(&image_[0], image_.size(), nullptr);
+  if (err != HSA_STATUS_SUCCESS && kernargs_ != nullptr) inflight_->SubRelaxed(1);
+  return err;
+}
+
+}  // namespace AMD
+}  // namespace rocr
@@ -90,15 +90,10 @@ void RvdFilter::BuildRvdTokenList() {
   }
 }
 
-void RvdFilter::BuildDeviceUuidList(uint32_t numNodes) {
-  HSAKMT_STATUS status;
-  HsaNodeProperties props = {0};
-  for (HSAuint32 idx = 0; idx < numNodes; idx++) {
-    // Query for node properties and ignore Cpu devices
-    status = hsaKmtGetNodeProperties(idx, &props);
-    if (status != HSAKMT_STATUS_SUCCESS) {
-      continue;
-    }
+void RvdFilter::BuildDeviceUuidList(const std::vector<HsaNodeProperties>& nodeProps) {
+  devUuidList_.reserve(nodeProps.size());
+  for (const HsaNodeProperties& props : nodeProps) {
+    // Ignore Cpu devices and nodes whose properties could not be queried
     if (props.NumFComputeCores == 0) {
       continue;
     }
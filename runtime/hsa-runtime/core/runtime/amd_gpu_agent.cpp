@@ -59,6 +59,7 @@
 #include "core/inc/amd_blit_sdma.h"
 #include "core/inc/amd_gpu_pm4.h"
 #include "core/inc/amd_memory_region.h"
+#include "core/inc/amd_virtual_queue.h"
 #include "core/inc/default_signal.h"
 #include "core/inc/interrupt_signal.h"
 #include "core/inc/isa.h"
@@ -109,6 +110,13 @@ GpuAgent::GpuAgent(HSAuint32 node, const HsaNodeProperties& node_props, bool xna
       enum_index_(index),
       ape1_base_(0),
       ape1_size_(0),
+      queue_peak_depth_(0),
+      scratch_monitor_thread_(NULL),
+      scratch_monitor_event_(NULL),
+      scratch_monitor_exit_(false),
+      priority_update_thread_(NULL),
+      priority_update_event_(NULL),
+      priority_update_exit_(false),
       pending_copy_req_ref_(0),
       pending_copy_stat_check_ref_(0),
       sdma_blit_used_mask_(0),
@@ -117,13 +125,19 @@ GpuAgent::GpuAgent(HSAuint32 node, const HsaNodeProperties& node_props, bool xna
           [this](void* base, size_t size, bool large) { ReleaseScratch(base, size, large); }),
       trap_handler_tma_region_(NULL),
       pcs_hosttrap_data_(),
-      xgmi_cpu_gpu_(false) {
+      xgmi_cpu_gpu_(false),
+      host_accessible_local_(false),
+      host_writable_local_(0),
+      hdp_flush_pinned_(false) {
   const bool is_apu_node = (properties_.NumCPUCores > 0);
   profile_ = (is_apu_node) ? HSA_PROFILE_FULL : HSA_PROFILE_BASE;
 
   HSAKMT_STATUS err = hsaKmtGetClockCounters(node_id(), &t0_);
   t1_ = t0_;
   historical_clock_ratio_ = 0.0;
+  // Empty range until the first SyncClocks.
+  clock_params_ = {};
+  clock_params_.agent_tick_min = UINT64_MAX;
   assert(err == HSAKMT_STATUS_SUCCESS && "hsaGetClockCounters error");
 
   const core::Isa *isa_base;
@@ -213,6 +227,7 @@ GpuAgent::GpuAgent(HSAuint32 node, const HsaNodeProperties& node_props, bool xna
 
 #if !defined(__linux__)
   wallclock_frequency_ = 0;
+  memset(cu_bitmap_, 0, sizeof(cu_bitmap_));
 #else
   // Get wallclock freq from libdrm.
   amdgpu_gpu_info info;
@@ -221,6 +236,7 @@ GpuAgent::GpuAgent(HSAuint32 node, const HsaNodeProperties& node_props, bool xna
 
   // Reported by libdrm in KHz.
   wallclock_frequency_ = uint64_t(info.gpu_counter_freq) * 1000ull;
+  memcpy(cu_bitmap_, info.cu_bitmap, sizeof(cu_bitmap_));
 #endif
 
   auto& firstCpu = core::Runtime::runtime_singleton_->cpu_agents()[0];
@@ -239,6 +255,16 @@ GpuAgent::GpuAgent(HSAuint32 node, const HsaNodeProperties& node_props, bool xna
 }
 
 GpuAgent::~GpuAgent() {
+  StopScratchMonitor();
+  StopPriorityUpdater();
+  spm_stream_.reset();
+
+  for (auto shared : shared_queues_) delete shared;
+  shared_queues_.clear();
+
+  for (auto queue : queue_pool_) delete queue;
+  queue_pool_.clear();
+
   if (this->Enabled()) {
     for (auto& blit : blits_) {
       if (!blit.empty()) {
@@ -246,6 +272,14 @@ GpuAgent::~GpuAgent() {
         assert(status == HSA_STATUS_SUCCESS);
       }
     }
+    for (auto& blits : priority_blits_) {
+      for (auto& blit : blits) {
+        if (!blit.empty()) {
+          hsa_status_t status = blit->Destroy(*this);
+          assert(status == HSA_STATUS_SUCCESS);
+        }
+      }
+    }
 
     if (ape1_base_ != 0) {
       _aligned_free(reinterpret_cast<void*>(ape1_base_));
@@ -254,12 +288,17 @@ GpuAgent::~GpuAgent() {
     scratch_cache_.trim(true);
     scratch_cache_.free_reserve();
 
-    if (scratch_pool_.base() != NULL) {
+    // The scratch aperture backing is the largest per agent reservation, leave it to process exit
+    // when shutting down fast.
+    if ((scratch_pool_.base() != NULL) &&
+        !core::Runtime::runtime_singleton_->flag().fast_shutdown()) {
       hsaKmtFreeMemory(scratch_pool_.base(), scratch_pool_.size());
     }
 
     for (int i = 0; i < QueueCount; i++)
       queues_[i].reset();
+    for (int i = 0; i < BlitPriorityCount; i++)
+      priority_queues_[i].reset();
 
     system_deallocator()(doorbell_queue_map_);
 
@@ -362,6 +401,45 @@ void GpuAgent::AssembleShader(const char* func_name, AssembleTarget assemble_tar
            {kCodeFill10, sizeof(kCodeFill10), 19, 8},                       // gfx10
            {kCodeFill11, sizeof(kCodeFill11), 19, 8},                       // gfx11
            {kCodeFill12, sizeof(kCodeFill12), 19, 8},                       // gfx12
+       }},
+      {"CopyAlignedNT",
+       {
+           {NULL, 0, 0, 0},                                                 // gfx7
+           {NULL, 0, 0, 0},                                                 // gfx8
+           {kCodeCopyAlignedNT9, sizeof(kCodeCopyAlignedNT9), 32, 24},      // gfx9
+           {kCodeCopyAlignedNT9, sizeof(kCodeCopyAlignedNT9), 32, 24},      // gfx90a
+           {kCodeCopyAlignedNT940, sizeof(kCodeCopyAlignedNT940), 32, 24},  // gfx940
+           {kCodeCopyAlignedNT9, sizeof(kCodeCopyAlignedNT9), 32, 24},      // gfx942
+           {kCodeCopyAlignedNT10, sizeof(kCodeCopyAlignedNT10), 32, 24},    // gfx1010
+           {kCodeCopyAlignedNT10, sizeof(kCodeCopyAlignedNT10), 32, 24},    // gfx10
+           {kCodeCopyAlignedNT11, sizeof(kCodeCopyAlignedNT11), 32, 24},    // gfx11
+           {kCodeCopyAlignedNT12, sizeof(kCodeCopyAlignedNT12), 32, 24},    // gfx12
+       }},
+      {"FillNT",
+       {
+           {NULL, 0, 0, 0},                                                 // gfx7
+           {NULL, 0, 0, 0},                                                 // gfx8
+           {kCodeFillNT9, sizeof(kCodeFillNT9), 19, 8},                     // gfx9
+           {kCodeFillNT9, sizeof(kCodeFillNT9), 19, 8},                     // gfx90a
+           {kCodeFillNT940, sizeof(kCodeFillNT940), 19, 8},                 // gfx940
+           {kCodeFillNT9, sizeof(kCodeFillNT9), 19, 8},                     // gfx942
+           {kCodeFillNT10, sizeof(kCodeFillNT10), 19, 8},                   // gfx1010
+           {kCodeFillNT10, sizeof(kCodeFillNT10), 19, 8},                   // gfx10
+           {kCodeFillNT11, sizeof(kCodeFillNT11), 19, 8},                   // gfx11
+           {kCodeFillNT12, sizeof(kCodeFillNT12), 19, 8},                   // gfx12
+       }},
+      {"FillPattern",
+       {
+           {NULL, 0, 0, 0},                                                 // gfx7
+           {NULL, 0, 0, 0},                                                 // gfx8
+           {kCodeFillPattern9, sizeof(kCodeFillPattern9), 17, 8},           // gfx9
+           {kCodeFillPattern9, sizeof(kCodeFillPattern9), 17, 8},           // gfx90a
+           {kCodeFillPattern940, sizeof(kCodeFillPattern940), 17, 8},       // gfx940
+           {kCodeFillPattern9, sizeof(kCodeFillPattern9), 17, 8},           // gfx942
+           {kCodeFillPattern10, sizeof(kCodeFillPattern10), 17, 8},         // gfx1010
+           {kCodeFillPattern10, sizeof(kCodeFillPattern10), 17, 8},         // gfx10
+           {kCodeFillPattern11, sizeof(kCodeFillPattern11), 17, 8},         // gfx11
+           {kCodeFillPattern12, sizeof(kCodeFillPattern12), 17, 8},         // gfx12
        }}};
 
   auto compiled_shader_it = compiled_shaders.find(func_name);
@@ -416,6 +494,7 @@ void GpuAgent::AssembleShader(const char* func_name, AssembleTarget assemble_tar
       (assemble_target == AssembleTarget::AQL ? sizeof(amd_kernel_code_t) : 0);
   code_buf_size = AlignUp(header_size + asic_shader->size, 0x1000);
 
+  core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_CODE_OBJECT);
   code_buf = system_allocator()(code_buf_size, 0x1000, core::MemoryRegion::AllocateExecutable);
   assert(code_buf != NULL && "Code buffer allocation failed");
 
@@ -736,14 +815,17 @@ core::Queue* GpuAgent::CreateInterceptibleQueue(void (*callback)(hsa_status_t st
   uint32_t size = std::max(in_size, minAqlSize_);
   size = std::min(size, maxAqlSize_);
 
-  QueueCreate(size, HSA_QUEUE_TYPE_MULTI, callback, data, 0, 0, &queue);
+  // Internal queues always get a hardware queue of their own.
+  if (!IsPowerOfTwo(size)) return nullptr;
+  CreateAqlQueue(size, HSA_QUEUE_TYPE_MULTI, callback, data, 0,
+                 core::Runtime::runtime_singleton_->flag().dev_mem_queue(), &queue);
   if (queue != nullptr)
     core::Runtime::runtime_singleton_->InternalQueueCreateNotify(core::Queue::Convert(queue),
                                                                  this->public_handle());
   return queue;
 }
 
-core::Blit* GpuAgent::CreateBlitSdma(bool use_xgmi, int rec_eng) {
+core::Blit* GpuAgent::CreateBlitSdma(bool use_xgmi, int rec_eng, HSA_QUEUE_PRIORITY priority) {
   AMD::BlitSdmaBase* sdma;
   size_t copy_size_override = 0;
   const size_t copy_size_overrides[2] = {0x3fffff, 0x3fffffff};
@@ -779,7 +861,8 @@ core::Blit* GpuAgent::CreateBlitSdma(bool use_xgmi, int rec_eng) {
 
   rec_eng = uses_rec_sdma_eng_id_mask_ || !use_xgmi ? rec_eng : -1;
 
-  if (sdma->Initialize(*this, use_xgmi, copy_size_override, rec_eng) != HSA_STATUS_SUCCESS) {
+  if (sdma->Initialize(*this, use_xgmi, copy_size_override, rec_eng, priority) !=
+      HSA_STATUS_SUCCESS) {
     sdma->Destroy(*this);
     delete sdma;
     sdma = nullptr;
@@ -811,7 +894,7 @@ void GpuAgent::InitDma() {
     if (priority != HSA_QUEUE_PRIORITY_NORMAL)
       if (queue->SetPriority(priority) != HSA_STATUS_SUCCESS)
         throw AMD::hsa_exception(HSA_STATUS_ERROR,
-                                "Failed to increase queue priority for PC Sampling");
+                                "Failed to set internal queue priority");
     return queue;
   };
 
@@ -826,7 +909,9 @@ void GpuAgent::InitDma() {
   queues_[QueuePCSampling].reset([queue_lambda, this]() { return queue_lambda(HSA_QUEUE_PRIORITY_MAXIMUM); });
 
   // Decide which engine to use for blits.
-  auto blit_lambda = [this](bool use_xgmi, lazy_ptr<core::Queue>& queue, bool isHostToDev, uint32_t rec_eng) {
+  auto blit_lambda = [this](bool use_xgmi, lazy_ptr<core::Queue>& queue, bool isHostToDev,
+                            uint32_t rec_eng,
+                            HSA_QUEUE_PRIORITY sdma_priority = HSA_QUEUE_PRIORITY_MAXIMUM) {
     Flag::SDMA_OVERRIDE sdma_override = core::Runtime::runtime_singleton_->flag().enable_sdma();
 
     // User SDMA queues are unstable on gfx8 and unsupported on gfx1013.
@@ -864,7 +949,7 @@ void GpuAgent::InitDma() {
       if (!properties_.NumSdmaXgmiEngines)
         rec_eng = -1;
 
-      auto ret = CreateBlitSdma(use_xgmi, rec_eng);
+      auto ret = CreateBlitSdma(use_xgmi, rec_eng, sdma_priority);
       if (ret != nullptr) return ret;
     }
 
@@ -884,6 +969,7 @@ void GpuAgent::InitDma() {
   // sdma-xgmi engines
   uint32_t blit_cnt_ = DefaultBlitCount + properties_.NumSdmaXgmiEngines;
   blits_.resize(blit_cnt_);
+  engine_load_.assign(blit_cnt_, EngineLoad());
 
   // Initialize blit objects used for D2D, H2D, D2H, and
   // P2P copy operations.
@@ -915,6 +1001,28 @@ void GpuAgent::InitDma() {
         [blit_lambda, this, eng]() { return blit_lambda(true, queues_[QueueUtility], false, eng); });
   }
 
+  // Priority classes get their own compute queue and SDMA rings per direction.  Internal SDMA
+  // queues already run at maximum priority, so the high class differs by not sharing a ring.
+  for (int cls = 0; cls < BlitPriorityCount; cls++) {
+    const bool high = (cls == BlitPriorityHigh);
+    const HSA_QUEUE_PRIORITY priority = high ? HSA_QUEUE_PRIORITY_HIGH : HSA_QUEUE_PRIORITY_MINIMUM;
+    const HSA_QUEUE_PRIORITY sdma_priority = high ? HSA_QUEUE_PRIORITY_MAXIMUM : priority;
+
+    priority_queues_[cls].reset([queue_lambda, priority]() { return queue_lambda(priority); });
+    priority_blits_[cls][BlitDevToDev].reset([this, cls]() {
+      auto ret = CreateBlitKernel((*priority_queues_[cls]).get());
+      if (ret == nullptr)
+        throw AMD::hsa_exception(HSA_STATUS_ERROR_OUT_OF_RESOURCES, "Blit creation failed.");
+      return ret;
+    });
+    priority_blits_[cls][BlitHostToDev].reset([blit_lambda, this, cls, sdma_priority]() {
+      return blit_lambda(false, priority_queues_[cls], true, 0, sdma_priority);
+    });
+    priority_blits_[cls][BlitDevToHost].reset([blit_lambda, this, cls, sdma_priority]() {
+      return blit_lambda(false, priority_queues_[cls], false, 1, sdma_priority);
+    });
+  }
+
   // GWS queues.
   InitGWS();
 }
@@ -930,6 +1038,7 @@ void GpuAgent::InitGWS() {
 
     auto err = static_cast<AqlQueue*>(queue.get())->EnableGWS(1);
     if (err != HSA_STATUS_SUCCESS) throw AMD::hsa_exception(err, "GWS allocation failed.");
+    LimitCooperativeCUs(static_cast<AqlQueue*>(queue.get()));
 
     gws_queue_.ref_ct_ = 0;
     return queue.release();
@@ -940,9 +1049,35 @@ void GpuAgent::GWSRelease() {
   ScopedAcquire<KernelMutex> lock(&gws_queue_.lock_);
   gws_queue_.ref_ct_--;
   if (gws_queue_.ref_ct_ != 0) return;
+
+  // KFD grants GWS to a single queue per process, so the queue is kept for the next cooperative
+  // user rather than paying for queue creation and GWS allocation again.  A queue left busy or
+  // faulted is rebuilt.
+  AqlQueue* queue = static_cast<AqlQueue*>((*gws_queue_.queue_).get());
+  if (queue != nullptr && queue->ResetForReuse()) {
+    LimitCooperativeCUs(queue);
+    return;
+  }
   InitGWS();
 }
 
+void GpuAgent::LimitCooperativeCUs(AqlQueue* queue) {
+  if (!core::Runtime::runtime_singleton_->flag().coop_cu_count()) return;
+
+  uint32_t coop_count = 0;
+  uint32_t cu_count = 0;
+  GetInfo((hsa_agent_info_t)HSA_AMD_AGENT_INFO_COOPERATIVE_COMPUTE_UNIT_COUNT, &coop_count);
+  GetInfo((hsa_agent_info_t)HSA_AMD_AGENT_INFO_COMPUTE_UNIT_COUNT, &cu_count);
+  if (coop_count == 0 || coop_count >= cu_count) return;
+
+  // KFD spreads consecutive mask bits across shader engines, so the low bits stay balanced.
+  std::vector<uint32_t> mask((cu_count + 31) / 32, 0);
+  for (uint32_t i = 0; i < coop_count; i++) mask[i / 32] |= 1u << (i % 32);
+  hsa_status_t err = queue->SetCUMasking(mask.size() * 32, mask.data());
+  if (err != HSA_STATUS_SUCCESS && err != hsa_status_t(HSA_STATUS_CU_MASK_REDUCED))
+    debug_warning(false && "Cooperative CU limit could not be applied.");
+}
+
 void GpuAgent::PreloadBlits() {
   for (auto& blit : blits_) {
     blit.touch();
@@ -996,19 +1131,46 @@ void GpuAgent::RegisterRecSdmaEngIdMaskPeer(core::Agent& peer, uint32_t rec_sdma
   bool rec_eng_enabled = core::Runtime::runtime_singleton_->flag().enable_sdma_recommended_eng() !=
                          Flag::SDMA_DISABLE;
 
+  const bool rec_eng_supported = (kfd_version.KernelInterfaceMajorVersion > 1 ||
+                                  (kfd_version.KernelInterfaceMajorVersion == 1 &&
+                                   kfd_version.KernelInterfaceMinorVersion >= 17)) &&
+                                 isa_->GetMajorVersion() == 9 && isa_->GetMinorVersion() >= 4 &&
+                                 rec_eng_enabled;
+
   // Assume all recommended masks with single recommended engine (IsPowerOfTwo)
-  // will only support targeting that engine and will not gang.
+  // will only support targeting that engine and will not gang.  Masks naming
+  // several engines are ganged across by DmaCopy.
   // Also assume support is uniform for every device in the system.
-  uses_rec_sdma_eng_id_mask_ = (kfd_version.KernelInterfaceMajorVersion > 1 ||
-                                 (kfd_version.KernelInterfaceMajorVersion == 1 &&
-                                  kfd_version.KernelInterfaceMinorVersion >= 17)) &&
-                               isa_->GetMajorVersion() == 9 && isa_->GetMinorVersion() >= 4 &&
-                               IsPowerOfTwo(rec_sdma_eng_id_mask) && rec_eng_enabled;
+  uses_rec_sdma_eng_id_mask_ = rec_eng_supported && IsPowerOfTwo(rec_sdma_eng_id_mask);
 
-  rec_sdma_eng_id_peers_info_[peer.public_handle().handle] = uses_rec_sdma_eng_id_mask_ ?
+  rec_sdma_eng_id_peers_info_[peer.public_handle().handle] = rec_eng_supported ?
                                                              rec_sdma_eng_id_mask : 0;
 }
 
+uint32_t GpuAgent::GetRecommendedEngines(const core::Agent& peer) const {
+  auto it = rec_sdma_eng_id_peers_info_.find(peer.public_handle().handle);
+  return (it != rec_sdma_eng_id_peers_info_.end()) ? it->second : 0;
+}
+
+unsigned int GpuAgent::GetGangFactor(const core::Agent& dst_agent, bool& has_aux_gang) const {
+  unsigned int gang_factor = 1;
+  if (dst_agent.device_type() == core::Agent::kAmdGpuDevice) {
+    auto it = gang_peers_info_.find(dst_agent.public_handle().handle);
+    if (it != gang_peers_info_.end()) gang_factor = it->second;
+  }
+  // Use non-D2D (auxillary) SDMA engines in the event of xGMI D2D support
+  // when xGMI SDMA context is not available.
+  has_aux_gang = gang_factor > 1 &&
+                 gang_factor >= properties_.NumSdmaEngines &&
+                 !!!properties_.NumSdmaXgmiEngines;
+  if (gang_factor > 1) {
+    gang_factor = has_aux_gang ?
+                      std::min(gang_factor, properties_.NumSdmaEngines) :
+                      std::min(gang_factor, properties_.NumSdmaXgmiEngines);
+  }
+  return gang_factor;
+}
+
 // Destroy gang signal
 static bool GangCopyCompleteHandler(hsa_signal_value_t, void *arg ) {
   core::Signal *gang_signal = reinterpret_cast<core::Signal*>(arg);
@@ -1026,12 +1188,15 @@ hsa_status_t GpuAgent::DmaCopy(void* dst, core::Agent& dst_agent,
                                size_t size,
                                std::vector<core::Signal*>& dep_signals,
                                core::Signal& out_signal) {
-  // Recommended SDMA engine copies only have gang factor 1
-  uint32_t rec_sdma_eng = ffs(rec_sdma_eng_id_peers_info_[dst_agent.public_handle().handle]);
+  const bool gang_enabled =
+      core::Runtime::runtime_singleton_->flag().enable_sdma_gang() != Flag::SDMA_DISABLE;
 
-  if (rec_sdma_eng)
+  // Recommended SDMA engine copies only have gang factor 1
+  const uint32_t rec_sdma_eng_mask = GetRecommendedEngines(dst_agent);
+  if (rec_sdma_eng_mask && IsPowerOfTwo(rec_sdma_eng_mask))
     return DmaCopyOnEngine(dst, dst_agent, src, src_agent, size,
-                           dep_signals, out_signal, rec_sdma_eng, false);
+                           dep_signals, out_signal, ffs(rec_sdma_eng_mask), false,
+                           HSA_AMD_QUEUE_PRIORITY_NORMAL);
 
   if (profiling_enabled()) {
     // Track the agent so we could translate the resulting timestamp to system
@@ -1039,23 +1204,67 @@ hsa_status_t GpuAgent::DmaCopy(void* dst, core::Agent& dst_agent,
     out_signal.async_copy_agent(core::Agent::Convert(this->public_handle()));
   }
 
+  // Several recommended engines gang the copy, the least busy one leading.
+  if (rec_sdma_eng_mask) {
+    std::vector<uint32_t> engines;
+    GetRecommendedEngines(rec_sdma_eng_mask, engines);
+    const size_t width = gang_enabled ? std::max<size_t>(size / 4096, 1) : 1;
+
+    ScopedAcquire<KernelMutex> lock(&sdma_gang_lock_);
+    std::vector<std::pair<uint64_t, uint32_t>> load;
+    GetEngineLoad(engines, load);
+    std::vector<lazy_ptr<core::Blit>*> gang_blits;
+    for (auto& entry : load) {
+      if (gang_blits.size() == width) break;
+      lazy_ptr<core::Blit>& blit = GetBlitObject(entry.second);
+      if (blit->isSDMA()) gang_blits.push_back(&blit);
+    }
+    if (!gang_blits.empty())
+      return SubmitGangCopy(dst, src, size, dep_signals, out_signal, gang_blits);
+  }
+
   // Calculate the number of gang items
+  bool has_aux_gang = false;
   unsigned int gang_factor = 1;
-  if (core::Runtime::runtime_singleton_->flag().enable_sdma_gang() != Flag::SDMA_DISABLE &&
-      size >= 4096 && dst_agent.device_type() == core::Agent::kAmdGpuDevice)
-    gang_factor = gang_peers_info_[dst_agent.public_handle().handle];
-  // Use non-D2D (auxillary) SDMA engines in the event of xGMI D2D support
-  // when xGMI SDMA context is not available.
-  bool has_aux_gang = gang_factor > 1 &&
-                      gang_factor >= properties_.NumSdmaEngines &&
-                      !!!properties_.NumSdmaXgmiEngines;
-  if (gang_factor > 1) {
-    gang_factor = has_aux_gang ?
-                      std::min(gang_factor, properties_.NumSdmaEngines) :
-                      std::min(gang_factor, properties_.NumSdmaXgmiEngines);
-  }
+  if (gang_enabled && size >= 4096) gang_factor = GetGangFactor(dst_agent, has_aux_gang);
 
   ScopedAcquire<KernelMutex> lock(&sdma_gang_lock_);
+
+  // Blit objects driving each gang item
+  std::vector<lazy_ptr<core::Blit>*> gang_blits;
+  for (int i = 0; gang_factor > 1 && i < gang_factor; i++)
+    gang_blits.push_back(has_aux_gang ? &blits_[i + 1] : &blits_[i + DefaultBlitCount]);
+
+  // Stripe large copies across every free SDMA engine that can serve the
+  // direction.  Stripes complete through the gang signals so the user's
+  // completion signal is only decremented once, by the leader.
+  const size_t stripe_size = core::Runtime::runtime_singleton_->flag().sdma_stripe_size();
+  if (gang_factor == 1 && stripe_size != 0 && size >= stripe_size &&
+      core::Runtime::runtime_singleton_->flag().enable_sdma_gang() != Flag::SDMA_DISABLE) {
+    GetStripeBlits(dst_agent, src_agent, size, gang_blits);
+    if (gang_blits.size() > 1)
+      gang_factor = gang_blits.size();
+    else
+      gang_blits.clear();
+  }
+
+  if (gang_factor > 1)
+    return SubmitGangCopy(dst, src, size, dep_signals, out_signal, gang_blits);
+
+  SetCopyRequestRefCount(true);
+  MAKE_SCOPE_GUARD([&]() { SetCopyRequestRefCount(false); });
+  lazy_ptr<core::Blit>& blit = GetBlitObject(dst_agent, src_agent, size);
+  blit->GangLeader(false);
+  std::vector<core::Signal*> gang_signals;
+  return blit->SubmitLinearCopyCommand(dst, src, size, dep_signals, out_signal, gang_signals);
+}
+
+hsa_status_t GpuAgent::SubmitGangCopy(void* dst, const void* src, size_t size,
+                                      std::vector<core::Signal*>& dep_signals,
+                                      core::Signal& out_signal,
+                                      const std::vector<lazy_ptr<core::Blit>*>& gang_blits) {
+  size_t gang_factor = gang_blits.size();
+
   // Manage internal gang signals
   std::vector<core::Signal*> gang_signals;
   if (gang_factor > 1) {
@@ -1069,6 +1278,7 @@ hsa_status_t GpuAgent::DmaCopy(void* dst, core::Agent& dst_agent,
       // Fall back to non-gang copy
       if (!gang_signal->IsValid()) {
         for (int j = 0; j < gang_signals.size(); j++) gang_signals[j]->DestroySignal();
+        gang_signals.clear();
         gang_factor = 1;
         break;
       }
@@ -1088,9 +1298,7 @@ hsa_status_t GpuAgent::DmaCopy(void* dst, core::Agent& dst_agent,
     // Set leader and gang status to blit
     SetCopyRequestRefCount(true);
     MAKE_SCOPE_GUARD([&]() { SetCopyRequestRefCount(false); });
-    lazy_ptr<core::Blit>& blit = gang_factor > 1 ?
-                                 (has_aux_gang ? blits_[i + 1] : blits_[i + DefaultBlitCount]) :
-                                 GetBlitObject(dst_agent, src_agent, size);
+    lazy_ptr<core::Blit>& blit = *gang_blits[i];
     blit->GangLeader(gang_factor > 1 && !i);
 
     hsa_status_t stat;
@@ -1118,13 +1326,248 @@ hsa_status_t GpuAgent::DmaCopy(void* dst, core::Agent& dst_agent,
   return HSA_STATUS_SUCCESS;
 }
 
+hsa_status_t GpuAgent::DmaCopyGang(void* dst, core::Agent& dst_agent, const void* src,
+                                   core::Agent& src_agent, size_t size,
+                                   std::vector<core::Signal*>& dep_signals,
+                                   core::Signal& out_signal, uint32_t width,
+                                   hsa_amd_gang_leader_t leader, int leader_offset) {
+  std::vector<uint32_t> engines;
+  GetCopyEngines(dst_agent, src_agent, engines);
+  if (leader == HSA_AMD_GANG_LEADER_ENGINE &&
+      std::find(engines.begin(), engines.end(), uint32_t(leader_offset)) == engines.end())
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  if (profiling_enabled()) {
+    // Track the agent so we could translate the resulting timestamp to system
+    // domain correctly.
+    out_signal.async_copy_agent(core::Agent::Convert(this->public_handle()));
+  }
+
+  // Default to the bandwidth factor RegisterGangPeer recorded for the xGMI link to the peer.
+  if (width == 0) {
+    const core::Agent& peer =
+        (dst_agent.public_handle().handle == public_handle_.handle) ? src_agent : dst_agent;
+    auto it = gang_peers_info_.find(peer.public_handle().handle);
+    width = (it != gang_peers_info_.end()) ? it->second : 1;
+  }
+  // Parts smaller than a page are not worth an engine.
+  width = std::min<size_t>(width, std::max<size_t>(size / 4096, 1));
+
+  ScopedAcquire<KernelMutex> lock(&sdma_gang_lock_);
+
+  std::vector<std::pair<uint64_t, uint32_t>> load;
+  GetEngineLoad(engines, load);
+
+  lazy_ptr<core::Blit>& plain = GetBlitObject(dst_agent, src_agent, size);
+  std::vector<lazy_ptr<core::Blit>*> gang_blits;
+  if (width > 1 && load.size() > 1) {
+    uint32_t first = load[0].second;
+    if (leader == HSA_AMD_GANG_LEADER_ENGINE) {
+      first = leader_offset;
+    } else if (leader == HSA_AMD_GANG_LEADER_DEFAULT) {
+      const uint32_t engine = &plain - &blits_[0];
+      for (auto& entry : load) {
+        if (entry.second == engine) first = engine;
+      }
+    }
+    gang_blits.push_back(&GetBlitObject(first));
+    for (auto& entry : load) {
+      if (gang_blits.size() == width) break;
+      if (entry.second != first) gang_blits.push_back(&GetBlitObject(entry.second));
+    }
+    // Engines are created on first use, only SDMA engines can gang.
+    gang_blits.erase(std::remove_if(gang_blits.begin(), gang_blits.end(),
+                                    [](lazy_ptr<core::Blit>* blit) { return !(*blit)->isSDMA(); }),
+                     gang_blits.end());
+  }
+  if (gang_blits.empty()) gang_blits.push_back(&plain);
+
+  return SubmitGangCopy(dst, src, size, dep_signals, out_signal, gang_blits);
+}
+
+hsa_status_t GpuAgent::DmaCopyBatch(const hsa_amd_memory_copy_descriptor_t* copies,
+                                    uint32_t count, core::Agent& dst_agent,
+                                    core::Agent& src_agent,
+                                    std::vector<core::Signal*>& dep_signals,
+                                    core::Signal& out_signal) {
+  uint64_t size = 0;
+  for (uint32_t i = 0; i < count; i++) size += copies[i].size;
+
+  if (profiling_enabled()) {
+    // Track the agent so we could translate the resulting timestamp to system
+    // domain correctly.
+    out_signal.async_copy_agent(core::Agent::Convert(this->public_handle()));
+  }
+
+  // Batches are never ganged, the whole batch goes to one engine so it can be
+  // written in as few submissions as possible.
+  SetCopyRequestRefCount(true);
+  MAKE_SCOPE_GUARD([&]() { SetCopyRequestRefCount(false); });
+  lazy_ptr<core::Blit>& blit = GetBlitObject(dst_agent, src_agent, size);
+
+  return blit->SubmitLinearCopyBatchCommand(copies, count, dep_signals, out_signal);
+}
+
+hsa_status_t GpuAgent::DmaCopyStrided(const hsa_amd_memory_copy_strided_t* blocks,
+                                      uint32_t count, core::Agent& dst_agent,
+                                      core::Agent& src_agent,
+                                      std::vector<core::Signal*>& dep_signals,
+                                      core::Signal& out_signal) {
+  uint64_t size = 0;
+  for (uint32_t i = 0; i < count; i++)
+    size += blocks[i].width * blocks[i].height * blocks[i].depth;
+
+  if (profiling_enabled()) {
+    // Track the agent so we could translate the resulting timestamp to system
+    // domain correctly.
+    out_signal.async_copy_agent(core::Agent::Convert(this->public_handle()));
+  }
+
+  // As batches, the whole list goes to one engine.
+  SetCopyRequestRefCount(true);
+  MAKE_SCOPE_GUARD([&]() { SetCopyRequestRefCount(false); });
+  lazy_ptr<core::Blit>& blit = GetBlitObject(dst_agent, src_agent, size);
+
+  return blit->SubmitStridedCopyCommand(blocks, count, dep_signals, out_signal);
+}
+
+hsa_status_t GpuAgent::CreateCopyList(int engine_offset, const hsa_amd_copy_command_t* commands,
+                                      uint32_t count, CopyList** list) {
+  // Copy lists are SDMA packet streams, the blit kernel at BlitDevToDev can not run them.
+  if (engine_offset <= BlitDevToDev ||
+      engine_offset > properties_.NumSdmaEngines + properties_.NumSdmaXgmiEngines) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  SetCopyRequestRefCount(true);
+  MAKE_SCOPE_GUARD([&]() { SetCopyRequestRefCount(false); });
+  lazy_ptr<core::Blit>& blit = GetBlitObject(engine_offset);
+  if (!blit->isSDMA()) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  std::unique_ptr<CopyList> copy_list(
+      new CopyList(this, static_cast<BlitSdmaBase*>((*blit).get())));
+  hsa_status_t err = copy_list->Record(commands, count);
+  if (err != HSA_STATUS_SUCCESS) return err;
+
+  *list = copy_list.release();
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t GpuAgent::CreateCopyContext(uint32_t engine_ids_mask, CopyContext** context) {
+  const uint32_t num_engines = properties_.NumSdmaEngines + properties_.NumSdmaXgmiEngines;
+  if (engine_ids_mask == 0 || (num_engines < 32 && (engine_ids_mask >> num_engines) != 0)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  // Prefer an engine nobody else is using, else the first of the set.
+  uint32_t engine_offset = ffs(engine_ids_mask);
+  for (uint32_t mask = engine_ids_mask; mask != 0; mask &= mask - 1) {
+    const uint32_t offset = ffs(mask);
+    if (DmaEngineIsFree(offset)) {
+      engine_offset = offset;
+      break;
+    }
+  }
+
+  // A private queue on the engine keeps the context off the ring other submitters share.
+  if (core::Runtime::runtime_singleton_->flag().sdma_context_ring()) {
+    const bool use_xgmi = engine_offset >= DefaultBlitCount;
+    core::Blit* blit = CreateBlitSdma(use_xgmi, engine_offset - 1, HSA_QUEUE_PRIORITY_MAXIMUM);
+    if (blit != nullptr) {
+      // Signals can outlive the private queue, so none may hold an interrupt on it.
+      static_cast<BlitSdmaBase*>(blit)->DisableInterruptDeferral();
+      *context = new CopyContext(this, blit, engine_offset, true);
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
+  SetCopyRequestRefCount(true);
+  MAKE_SCOPE_GUARD([&]() { SetCopyRequestRefCount(false); });
+  lazy_ptr<core::Blit>& blit = GetBlitObject(engine_offset);
+  if (!blit->isSDMA()) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  *context = new CopyContext(this, (*blit).get(), engine_offset, false);
+  return HSA_STATUS_SUCCESS;
+}
+
+void GpuAgent::GetPartitionLayout(hsa_amd_agent_partition_layout_t* layout) const {
+  memset(layout, 0, sizeof(*layout));
+  layout->num_xcc = std::max(properties_.NumXcc, 1u);
+  layout->cu_per_xcc =
+      properties_.NumFComputeCores / (properties_.NumSIMDPerCU * layout->num_xcc);
+
+  // Compute partitions of one device are agents sharing its PCI location, in node order.
+  std::vector<uint32_t> nodes;
+  auto collect = [&](const std::vector<core::Agent*>& agents) {
+    for (core::Agent* agent : agents) {
+      const HsaNodeProperties& props = static_cast<GpuAgent*>(agent)->properties();
+      if ((props.Domain == properties_.Domain) && (props.LocationId == properties_.LocationId))
+        nodes.push_back(agent->node_id());
+    }
+  };
+  collect(core::Runtime::runtime_singleton_->gpu_agents());
+  collect(core::Runtime::runtime_singleton_->disabled_gpu_agents());
+  std::sort(nodes.begin(), nodes.end());
+  layout->num_compute_partitions = std::max<uint32_t>(nodes.size(), 1);
+  layout->compute_partition = std::lower_bound(nodes.begin(), nodes.end(), node_id()) -
+      nodes.begin();
+
+  // Memory partitions are spread evenly over compute partitions, or shared when there are fewer.
+  const uint32_t num_mem = os::GetPciMemoryPartitions(properties_.Domain, properties_.LocationId);
+  layout->num_memory_partitions = num_mem;
+  if (num_mem == 0) return;
+  const uint32_t num_compute = layout->num_compute_partitions;
+  layout->memory_partition = layout->compute_partition * num_mem / num_compute;
+  layout->num_local_memory_partitions = std::max(num_mem / num_compute, 1u);
+}
+
+bool GpuAgent::MapCUMask(const std::vector<uint32_t>& mask, uint32_t xcc,
+                         uint32_t (&se_mask)[4]) const {
+  const uint32_t num_xcc = std::max(properties_.NumXcc, 1u);
+  const uint32_t num_se = properties_.NumShaderBanks / num_xcc;
+  const uint32_t num_sh = properties_.NumArrays;
+  if (num_se > 4 || num_sh > 2) return false;
+
+  // Mirrors mqd_symmetrically_map_cu_mask: CU i of the mask goes to the next SH, round robin over
+  // SEs then SHs, and XCCs take every num_xcc-th CU.  WGP devices enable CUs in pairs.
+  const uint32_t major = isa_->GetMajorVersion();
+  const bool wgp_mode = major >= 10;
+  const uint32_t en_mask = wgp_mode ? 0x3 : 0x1;
+  const uint32_t cu_inc = wgp_mode ? 2 : 1;
+  const uint32_t inc = cu_inc * num_xcc;
+
+  // libdrm only reports the first XCC, the others are assumed to be harvested alike.
+  uint32_t cu_per_sh[4][2] = {};
+  for (uint32_t se = 0; se < num_se; se++)
+    for (uint32_t sh = 0; sh < num_sh; sh++)
+      cu_per_sh[se][sh] = __builtin_popcount(cu_bitmap_[se][sh]);
+
+  for (uint32_t se = 0; se < 4; se++) se_mask[se] = 0;
+
+  const uint32_t cu_mask_count = mask.size() * 32;
+  uint32_t i = xcc;
+  for (uint32_t cu = 0; cu < 16; cu += cu_inc) {
+    for (uint32_t sh = 0; sh < num_sh; sh++) {
+      for (uint32_t se = 0; se < num_se; se++) {
+        if (cu_per_sh[se][sh] > cu) {
+          if (mask[i / 32] & (en_mask << (i % 32))) se_mask[se] |= en_mask << (cu + sh * 16);
+          i += inc;
+          if (i >= cu_mask_count) return true;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 hsa_status_t GpuAgent::DmaCopyOnEngine(void* dst, core::Agent& dst_agent,
                                const void* src, core::Agent& src_agent,
                                size_t size,
                                std::vector<core::Signal*>& dep_signals,
                                core::Signal& out_signal,
                                int engine_offset,
-                               bool force_copy_on_sdma) {
+                               bool force_copy_on_sdma,
+                               hsa_amd_queue_priority_t priority) {
   // At this point it is guaranteed that one of
   // the two devices is a GPU, potentially both
   assert(((src_agent.device_type() == core::Agent::kAmdGpuDevice) ||
@@ -1173,7 +1616,12 @@ hsa_status_t GpuAgent::DmaCopyOnEngine(void* dst, core::Agent& dst_agent,
 
   SetCopyRequestRefCount(true);
   MAKE_SCOPE_GUARD([&]() { SetCopyRequestRefCount(false); });
-  lazy_ptr<core::Blit>& blit = GetBlitObject(engine_offset);
+  // Priority classes cover host, device and PCIe peer copies.  xGMI engines are shared.
+  lazy_ptr<core::Blit>& blit =
+      (priority != HSA_AMD_QUEUE_PRIORITY_NORMAL && engine_offset < DefaultBlitCount)
+      ? priority_blits_[priority == HSA_AMD_QUEUE_PRIORITY_HIGH ? BlitPriorityHigh
+                                                                : BlitPriorityLow][engine_offset]
+      : GetBlitObject(engine_offset);
 
   if (profiling_enabled()) {
     // Track the agent so we could translate the resulting timestamp to system
@@ -1198,6 +1646,179 @@ bool GpuAgent::DmaEngineIsFree(uint32_t engine_offset) {
   return is_free;
 }
 
+void GpuAgent::GetCopyEngines(const core::Agent& dst_agent, const core::Agent& src_agent,
+                              std::vector<uint32_t>& engines) {
+  // Same candidate engines as DmaCopyStatus reports for this direction.
+  bool is_xgmi = src_agent.device_type() == core::Agent::kAmdGpuDevice &&
+                 dst_agent.device_type() == core::Agent::kAmdGpuDevice &&
+                 dst_agent.HiveId() && src_agent.HiveId() == dst_agent.HiveId() &&
+                 properties_.NumSdmaXgmiEngines;
+  if (!is_xgmi) {
+    bool is_h2d_blit = (src_agent.device_type() == core::Agent::kAmdCpuDevice &&
+                        dst_agent.device_type() == core::Agent::kAmdGpuDevice);
+    // Due to a RAS issue, GFX90a can only support H2D copies on SDMA0
+    bool limit_h2d_blit = isa_->GetVersion() == core::Isa::Version(9, 0, 10);
+    if (is_h2d_blit || !limit_h2d_blit) engines.push_back(BlitHostToDev);
+    if (properties_.NumSdmaEngines > 1) engines.push_back(BlitDevToHost);
+  }
+  for (int i = 0; i < properties_.NumSdmaXgmiEngines; i++) engines.push_back(DefaultBlitCount + i);
+}
+
+void GpuAgent::GetStripeBlits(const core::Agent& dst_agent, const core::Agent& src_agent,
+                              size_t size, std::vector<lazy_ptr<core::Blit>*>& stripe_blits) {
+  // The engine a plain copy would use leads the stripe.
+  lazy_ptr<core::Blit>& leader = GetBlitObject(dst_agent, src_agent, size);
+  if (!leader->isSDMA()) return;
+  stripe_blits.push_back(&leader);
+
+  std::vector<uint32_t> engines;
+  GetCopyEngines(dst_agent, src_agent, engines);
+  for (uint32_t engine : engines) {
+    if (&blits_[engine] == &leader || !DmaEngineIsFree(engine)) continue;
+    lazy_ptr<core::Blit>& blit = GetBlitObject(engine);
+    if (blit->isSDMA()) stripe_blits.push_back(&blit);
+  }
+}
+
+void GpuAgent::GetRecommendedEngines(uint32_t rec_sdma_eng_id_mask,
+                                     std::vector<uint32_t>& engines) {
+  // Engine ID bit n is blits_ index n + 1, as for DmaCopyOnEngine.
+  for (uint32_t mask = rec_sdma_eng_id_mask; mask != 0; mask &= mask - 1) {
+    const uint32_t engine = ffs(mask);
+    if (engine < DefaultBlitCount + properties_.NumSdmaXgmiEngines) engines.push_back(engine);
+  }
+}
+
+void GpuAgent::GetEngineLoad(const std::vector<uint32_t>& engines,
+                             std::vector<std::pair<uint64_t, uint32_t>>& load) {
+  {
+    SetCopyStatusCheckRefCount(true);
+    MAKE_SCOPE_GUARD([&]() { SetCopyStatusCheckRefCount(false); });
+    for (uint32_t engine : engines) {
+      const bool used = !!(sdma_blit_used_mask_ & (1 << engine));
+      if (used && !blits_[engine]->isSDMA()) continue;
+      load.push_back(std::make_pair(used ? blits_[engine]->PendingBytes() : 0, engine));
+    }
+  }
+  std::sort(load.begin(), load.end());
+}
+
+lazy_ptr<core::Blit>* GpuAgent::GetBalancedBlit(const core::Agent& dst_agent,
+                                                const core::Agent& src_agent, size_t size) {
+  // Nominal link rates in MB/s for links that do not report their bandwidth.
+  const uint32_t kNominalPcieMBps = 16000;
+  const uint32_t kNominalXgmiMBps = 32000;
+
+  std::vector<uint32_t> engines;
+  GetCopyEngines(dst_agent, src_agent, engines);
+  if (engines.empty()) return nullptr;
+
+  // Seed the rate of engines without a measurement from the link to the peer.  xGMI engines
+  // serving a PCIe copy are assumed to run at half rate.
+  const core::Agent& peer =
+      (dst_agent.public_handle().handle == public_handle_.handle) ? src_agent : dst_agent;
+  const core::Runtime::LinkInfo link =
+      core::Runtime::runtime_singleton_->GetLinkInfo(node_id(), peer.node_id());
+  const bool xgmi_link = (link.info.link_type == HSA_AMD_LINK_INFO_TYPE_XGMI);
+  uint32_t link_mbps = link.info.max_bandwidth;
+  if (link_mbps == 0) link_mbps = xgmi_link ? kNominalXgmiMBps : kNominalPcieMBps;
+  const double seed_rate = double(link_mbps) * 1e6 / double(os::AccurateClockFrequency());
+
+  const uint64_t now = os::ReadAccurateClock();
+  int best = -1;
+  double best_time = 0;
+  {
+    ScopedAcquire<KernelMutex> lock(&engine_load_lock_);
+    for (uint32_t engine : engines) {
+      EngineLoad& load = engine_load_[engine];
+      uint64_t pending = 0;
+      if (sdma_blit_used_mask_ & (1 << engine)) {
+        if (!blits_[engine]->isSDMA()) continue;
+        pending = blits_[engine]->PendingBytes();
+      }
+
+      // Only an engine that stayed busy since the last sample gives a true drain rate.
+      if (load.timestamp != 0 && now > load.timestamp && pending != 0 &&
+          load.pending_bytes > pending) {
+        double rate = double(load.pending_bytes - pending) / double(now - load.timestamp);
+        load.bytes_per_tick =
+            (load.bytes_per_tick == 0) ? rate : 0.75 * load.bytes_per_tick + 0.25 * rate;
+      }
+      load.pending_bytes = pending;
+      load.timestamp = now;
+
+      double rate = load.bytes_per_tick;
+      if (rate == 0) rate = (engine >= DefaultBlitCount && !xgmi_link) ? seed_rate / 2 : seed_rate;
+
+      const double completion = double(pending + size) / rate;
+      if (best == -1 || completion < best_time) {
+        best = engine;
+        best_time = completion;
+      }
+    }
+    if (best == -1) return nullptr;
+    core::Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_SDMA_PENDING_BYTES,
+                          engine_load_[best].pending_bytes);
+    engine_load_[best].pending_bytes += size;
+  }
+
+  lazy_ptr<core::Blit>& blit = GetBlitObject(best);
+  if (!blit->isSDMA()) return nullptr;
+  return &blit;
+}
+
+hsa_status_t GpuAgent::DmaCopyEngineHints(core::Agent& dst_agent, core::Agent& src_agent,
+                                          hsa_amd_copy_engine_hints_t* hints) {
+  assert(((src_agent.device_type() == core::Agent::kAmdGpuDevice) ||
+          (dst_agent.device_type() == core::Agent::kAmdGpuDevice)) &&
+         ("Both devices are CPU agents which is not expected"));
+
+  const bool gang_enabled =
+      core::Runtime::runtime_singleton_->flag().enable_sdma_gang() != Flag::SDMA_DISABLE;
+  const uint32_t rec_sdma_eng_mask = GetRecommendedEngines(dst_agent);
+
+  std::vector<uint32_t> engines;
+  GetCopyEngines(dst_agent, src_agent, engines);
+  std::vector<uint32_t> rec_engines;
+  GetRecommendedEngines(rec_sdma_eng_mask, rec_engines);
+  for (uint32_t engine : rec_engines) {
+    if (std::find(engines.begin(), engines.end(), engine) == engines.end())
+      engines.push_back(engine);
+  }
+
+  // Recommended engines first, the rest stay ordered by queued bytes.
+  std::vector<std::pair<uint64_t, uint32_t>> load;
+  GetEngineLoad(engines, load);
+  auto is_recommended = [&](uint32_t engine) {
+    return !!(rec_sdma_eng_mask & (1 << (engine - 1)));
+  };
+  std::stable_partition(load.begin(), load.end(),
+                        [&](const std::pair<uint64_t, uint32_t>& entry) {
+                          return is_recommended(entry.second);
+                        });
+
+  const uint32_t max_hints = sizeof(hints->engines) / sizeof(hints->engines[0]);
+  hints->num_engines = 0;
+  for (auto& entry : load) {
+    if (hints->num_engines == max_hints) break;
+    hsa_amd_copy_engine_hint_t& hint = hints->engines[hints->num_engines++];
+    hint.engine_id = static_cast<hsa_amd_sdma_engine_id_t>(1 << (entry.second - 1));
+    hint.recommended = is_recommended(entry.second);
+    hint.idle = (entry.first == 0);
+    hint.pending_bytes = entry.first;
+  }
+
+  // Same gang width DmaCopy would use for a large copy.
+  bool has_aux_gang;
+  hints->gang_factor = 1;
+  if (gang_enabled && rec_sdma_eng_mask)
+    hints->gang_factor = std::max<uint32_t>(rec_engines.size(), 1);
+  else if (gang_enabled)
+    hints->gang_factor = std::max(GetGangFactor(dst_agent, has_aux_gang), 1u);
+
+  return HSA_STATUS_SUCCESS;
+}
+
 hsa_status_t GpuAgent::DmaCopyStatus(core::Agent& dst_agent, core::Agent& src_agent,
                                      uint32_t *engine_ids_mask) {
   assert(((src_agent.device_type() == core::Agent::kAmdGpuDevice) ||
@@ -1278,6 +1899,22 @@ hsa_status_t GpuAgent::DmaFill(void* ptr, uint32_t value, size_t count) {
   return blits_[BlitDevToDev]->SubmitLinearFillCommand(ptr, value, count);
 }
 
+hsa_status_t GpuAgent::DmaFillAsync(void* ptr, const uint32_t* pattern, uint32_t pattern_dwords,
+                                    size_t size, std::vector<core::Signal*>& dep_signals,
+                                    core::Signal& out_signal) {
+  if (profiling_enabled()) {
+    // Track the agent so we could translate the resulting timestamp to system
+    // domain correctly.
+    out_signal.async_copy_agent(core::Agent::Convert(this->public_handle()));
+  }
+
+  // Fills go through the blit kernel, the only engine able to repeat wide patterns.
+  SetCopyRequestRefCount(true);
+  MAKE_SCOPE_GUARD([&]() { SetCopyRequestRefCount(false); });
+  return blits_[BlitDevToDev]->SubmitLinearFillCommand(ptr, pattern, pattern_dwords, size,
+                                                        dep_signals, out_signal);
+}
+
 hsa_status_t GpuAgent::EnableDmaProfiling(bool enable) {
   for (auto& blit : blits_) {
     if (!blit.empty()) {
@@ -1640,6 +2277,36 @@ hsa_status_t GpuAgent::GetInfo(hsa_agent_info_t attribute, void* value) const {
       memset(value, 0, sizeof(uint8_t) * 8);
       /* Not yet implemented */
       break;
+    case HSA_AMD_AGENT_INFO_SCRATCH_RESERVED_SIZE: {
+      ScopedAcquire<KernelMutex> lock(&scratch_lock_);
+      *((size_t*)value) = scratch_cache_.reserved_bytes();
+      break;
+    }
+    case HSA_AMD_AGENT_INFO_SCRATCH_IN_USE_SIZE: {
+      ScopedAcquire<KernelMutex> lock(&scratch_lock_);
+      *((size_t*)value) = scratch_pool_.size() - scratch_pool_.remaining() -
+          scratch_cache_.free_bytes();
+      break;
+    }
+    case HSA_AMD_AGENT_INFO_SCRATCH_CACHED_SIZE: {
+      ScopedAcquire<KernelMutex> lock(&scratch_lock_);
+      *((size_t*)value) = scratch_cache_.free_bytes();
+      break;
+    }
+    case HSA_AMD_AGENT_INFO_INIT_TIMES:
+      *((hsa_amd_agent_init_times_t*)value) = init_times();
+      break;
+    case HSA_AMD_AGENT_INFO_QUEUE_RECOMMENDED_SIZE: {
+      // Room for a few dispatches per CU in flight, or twice the deepest backlog observed.
+      const uint32_t num_cu = properties_.NumFComputeCores / properties_.NumSIMDPerCU;
+      uint64_t pkts = Max<uint64_t>(uint64_t(num_cu) * 4, queue_peak_depth_ * 2);
+      pkts = Min<uint64_t>(NextPow2(pkts), maxAqlSize_);
+      *((uint32_t*)value) = Max(uint32_t(pkts), minAqlSize_);
+      break;
+    }
+    case HSA_AMD_AGENT_INFO_PARTITION_LAYOUT:
+      GetPartitionLayout(reinterpret_cast<hsa_amd_agent_partition_layout_t*>(value));
+      break;
     default:
       return HSA_STATUS_ERROR_INVALID_ARGUMENT;
       break;
@@ -1652,6 +2319,18 @@ hsa_status_t GpuAgent::QueueCreate(size_t size, hsa_queue_type32_t queue_type,
                                    void* data, uint32_t private_segment_size,
                                    uint32_t group_segment_size,
                                    core::Queue** queue) {
+  return QueueCreate(size, queue_type, event_callback, data, private_segment_size,
+                     group_segment_size, core::Runtime::runtime_singleton_->flag().dev_mem_queue(),
+                     queue);
+}
+
+hsa_status_t GpuAgent::QueueCreate(size_t size, hsa_queue_type32_t queue_type,
+                                   core::HsaEventCallback event_callback, void* data,
+                                   uint32_t private_segment_size, uint32_t group_segment_size,
+                                   bool device_ring, core::Queue** queue,
+                                   const core::Agent* host_agent) {
+  core::TimelineSpan span(core::Timeline::kQueueCreate, size);
+
   // Handle GWS queues.
   if (queue_type == HSA_QUEUE_TYPE_COOPERATIVE) {
     ScopedAcquire<KernelMutex> lock(&gws_queue_.lock_);
@@ -1679,8 +2358,6 @@ hsa_status_t GpuAgent::QueueCreate(size_t size, hsa_queue_type32_t queue_type,
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
-  // Allocate scratch memory
-  ScratchInfo scratch = {0};
   if (private_segment_size == UINT_MAX) {
     private_segment_size = (profile_ == HSA_PROFILE_BASE) ? 0 : scratch_per_thread_;
   }
@@ -1689,6 +2366,46 @@ hsa_status_t GpuAgent::QueueCreate(size_t size, hsa_queue_type32_t queue_type,
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
 
+  // Multiplex user queues onto a bounded set of hardware queues when asked to.
+  if (core::Runtime::runtime_singleton_->flag().virtual_queue_limit() != 0 &&
+      host_agent == nullptr && !is_kv_device_) {
+    SharedHwQueue* shared;
+    hsa_status_t err = AcquireSharedQueue(size, HSA_QUEUE_PRIORITY_NORMAL, device_ring, &shared);
+    if (err != HSA_STATUS_SUCCESS) return err;
+    MAKE_NAMED_SCOPE_GUARD(sharedGuard, [&]() { ReleaseSharedQueue(shared); });
+    *queue = new VirtualQueue(this, shared, size, queue_type, event_callback, data);
+    sharedGuard.Dismiss();
+    return HSA_STATUS_SUCCESS;
+  }
+
+  return CreateAqlQueue(size, queue_type, event_callback, data, private_segment_size,
+                        device_ring, queue, host_agent);
+}
+
+hsa_status_t GpuAgent::CreateAqlQueue(size_t size, hsa_queue_type32_t queue_type,
+                                      core::HsaEventCallback event_callback, void* data,
+                                      uint32_t private_segment_size, bool device_ring,
+                                      core::Queue** queue, const core::Agent* host_agent) {
+  // Recycle a pooled queue created with the same size, its ring may since have grown.  Its
+  // scratch grows on demand if this queue asks for more than it holds.
+  if (!is_kv_device_) {
+    ScopedAcquire<KernelMutex> lock(&queue_pool_lock_);
+    for (auto it = queue_pool_.begin(); it != queue_pool_.end(); it++) {
+      if ((*it)->initial_size() == size &&
+          (*it)->amd_queue_.hsa_queue.type == queue_type && (*it)->deviceRing() == device_ring &&
+          (*it)->host_agent() == host_agent) {
+        AqlQueue* aql_queue = *it;
+        queue_pool_.erase(it);
+        aql_queue->Reuse(event_callback, data);
+        *queue = aql_queue;
+        return HSA_STATUS_SUCCESS;
+      }
+    }
+  }
+
+  // Allocate scratch memory
+  ScratchInfo scratch = {0};
+
   // Asynchronous reclaim flag bit is set by CP FW on queue-connect, we will update this when
   // we get the first scratch request.
   scratch.async_reclaim = false;
@@ -1714,6 +2431,8 @@ hsa_status_t GpuAgent::QueueCreate(size_t size, hsa_queue_type32_t queue_type,
       return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
     }
   }
+  // The initial allocation is the demand baseline until the queue requests scratch itself.
+  scratch.demand.predicted_size = scratch.main_size;
 
   // Ensure utility queue has been created.
   // Deferring longer risks exhausting queue count before ISA upload and invalidation capability is
@@ -1721,10 +2440,14 @@ hsa_status_t GpuAgent::QueueCreate(size_t size, hsa_queue_type32_t queue_type,
   queues_[QueueUtility].touch();
 
   // Create an HW AQL queue
-  auto aql_queue =
-      new AqlQueue(this, size, node_id(), scratch, event_callback, data, is_kv_device_);
+  auto aql_queue = new AqlQueue(this, size, node_id(), scratch, event_callback, data,
+                                is_kv_device_, device_ring, host_agent);
   *queue = aql_queue;
-  aql_queues_.push_back(aql_queue);
+  {
+    ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
+    aql_queues_.push_back(aql_queue);
+    StartScratchMonitor();
+  }
 
   if (doorbell_queue_map_) {
     // Calculate index of the queue doorbell within the doorbell aperture.
@@ -1780,6 +2503,7 @@ void GpuAgent::AcquireQueueMainScratch(ScratchInfo& scratch) {
 
   ScopedAcquire<KernelMutex> lock(&scratch_lock_);
   const size_t small_limit = scratch_pool_.size() >> 3;
+  const bool shared = core::Runtime::runtime_singleton_->flag().scratch_shared();
   bool use_reclaim = true;
 
   large = (scratch.main_size > scratch.use_once_limit) ||
@@ -1815,7 +2539,7 @@ void GpuAgent::AcquireQueueMainScratch(ScratchInfo& scratch) {
   [&]() {
     // Check scratch cache
     scratch.large = large;
-    if (scratch_cache_.allocMain(scratch)) return;
+    if (scratch_cache_.allocMain(scratch, shared)) return;
 
     // Attempt new allocation.
     for (int i = 0; i < 3; i++) {
@@ -1955,7 +2679,8 @@ void GpuAgent::AcquireQueueAltScratch(ScratchInfo& scratch) {
   // Used to allow exit from nested loops.
   [&]() {
     // Check scratch cache
-    if (scratch_cache_.allocAlt(scratch)) return;
+    if (scratch_cache_.allocAlt(scratch, core::Runtime::runtime_singleton_->flag().scratch_shared()))
+      return;
 
     // Attempt new allocation.
     for (int i = 0; i < 2; i++) {
@@ -2019,8 +2744,48 @@ void GpuAgent::ReleaseScratch(void* base, size_t size, bool large) {
   ClearScratchNotifiers();
 }
 
+hsa_status_t GpuAgent::SpmStreamStart(size_t buffer_size, uint32_t buffer_count,
+                                      hsa_amd_spm_stream_callback_t callback, void* user_data,
+                                      const char* file) {
+  ScopedAcquire<KernelMutex> lock(&spm_stream_lock_);
+  if (spm_stream_ != nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  FILE* sink = nullptr;
+  if (file != nullptr) {
+    sink = fopen(file, "wb");
+    if (sink == nullptr) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::unique_ptr<SpmStream> stream;
+  try {
+    stream.reset(new SpmStream(this, buffer_size, buffer_count, callback, user_data, sink));
+  } catch (const std::bad_alloc&) {
+    if (sink != nullptr) fclose(sink);
+    return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
+  hsa_status_t err = stream->Start();
+  if (err != HSA_STATUS_SUCCESS) return err;
+
+  spm_stream_ = std::move(stream);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t GpuAgent::SpmStreamStop() {
+  std::unique_ptr<SpmStream> stream;
+  {
+    ScopedAcquire<KernelMutex> lock(&spm_stream_lock_);
+    if (spm_stream_ == nullptr) return HSA_STATUS_ERROR_INVALID_AGENT;
+    stream = std::move(spm_stream_);
+  }
+  // Joins the stream threads outside the lock, the callback may query the agent.
+  stream.reset();
+  return HSA_STATUS_SUCCESS;
+}
+
 // Go through all the AQL queues and try to release scratch memory
 void GpuAgent::AsyncReclaimScratchQueues() {
+  ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
   for (auto iter : aql_queues_) {
     auto aqlQueue = static_cast<AqlQueue*>(iter);
     aqlQueue->AsyncReclaimMainScratch();
@@ -2033,6 +2798,7 @@ hsa_status_t GpuAgent::SetAsyncScratchThresholds(size_t use_once_limit) {
 
   scratch_limit_async_threshold_ = use_once_limit;
 
+  ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
   for (auto iter : aql_queues_) {
     auto aqlQueue = static_cast<AqlQueue*>(iter);
     aqlQueue->CheckScratchLimits();
@@ -2041,6 +2807,234 @@ hsa_status_t GpuAgent::SetAsyncScratchThresholds(size_t use_once_limit) {
   return HSA_STATUS_SUCCESS;
 }
 
+void GpuAgent::RemoveAqlQueue(core::Queue* queue) {
+  ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
+  auto it = std::find(aql_queues_.begin(), aql_queues_.end(), queue);
+  if (it != aql_queues_.end()) aql_queues_.erase(it);
+}
+
+bool GpuAgent::PoolQueue(AqlQueue* queue) {
+  const size_t pool_size = core::Runtime::runtime_singleton_->flag().queue_pool_size();
+  if (pool_size == 0 || is_kv_device_) return false;
+
+  {
+    ScopedAcquire<KernelMutex> lock(&queue_pool_lock_);
+    if (queue_pool_.size() >= pool_size) return false;
+  }
+
+  if (!queue->ResetForReuse()) return false;
+
+  ScopedAcquire<KernelMutex> lock(&queue_pool_lock_);
+  if (queue_pool_.size() >= pool_size) return false;
+  queue_pool_.push_back(queue);
+  return true;
+}
+
+void GpuAgent::ScratchUsage(uint64_t* bytes, uint64_t* count) {
+  ScopedAcquire<KernelMutex> lock(&scratch_lock_);
+  *bytes = scratch_pool_.size() - scratch_pool_.remaining();
+  *count = scratch_cache_.node_count();
+}
+
+void GpuAgent::TrimQueuePool() {
+  std::vector<AqlQueue*> pooled;
+  {
+    ScopedAcquire<KernelMutex> lock(&queue_pool_lock_);
+    pooled.swap(queue_pool_);
+  }
+  for (auto queue : pooled) delete queue;
+}
+
+hsa_status_t GpuAgent::AcquireSharedQueue(uint32_t size, HSA_QUEUE_PRIORITY priority,
+                                          bool device_ring, SharedHwQueue** queue) {
+  const size_t limit = core::Runtime::runtime_singleton_->flag().virtual_queue_limit();
+  ScopedAcquire<KernelMutex> lock(&shared_queues_lock_);
+
+  SharedHwQueue* best = nullptr;
+  for (auto shared : shared_queues_) {
+    if (shared->priority() != priority || shared->deviceRing() != device_ring) continue;
+    if (best == nullptr || shared->load_ < best->load_) best = shared;
+  }
+
+  // Spread queues over new hardware queues until the limit is reached.
+  if (best == nullptr || (best->load_ != 0 && shared_queues_.size() < limit)) {
+    std::unique_ptr<SharedHwQueue> shared(new SharedHwQueue(priority, device_ring));
+    const uint32_t private_segment_size =
+        (profile_ == HSA_PROFILE_BASE) ? 0 : scratch_per_thread_;
+    core::Queue* hw_queue;
+    hsa_status_t err = CreateAqlQueue(size, HSA_QUEUE_TYPE_MULTI, SharedHwQueue::HandleError,
+                                      shared.get(), private_segment_size, device_ring, &hw_queue);
+    if (err == HSA_STATUS_SUCCESS) {
+      shared->Init(hw_queue);
+      best = shared.release();
+      shared_queues_.push_back(best);
+    } else if (best == nullptr) {
+      return err;
+    }
+  }
+
+  best->load_++;
+  *queue = best;
+  return HSA_STATUS_SUCCESS;
+}
+
+void GpuAgent::ReleaseSharedQueue(SharedHwQueue* queue) {
+  ScopedAcquire<KernelMutex> lock(&shared_queues_lock_);
+  assert(queue->load_ != 0 && "Unbalanced shared queue release.");
+  queue->load_--;
+}
+
+void GpuAgent::StartScratchMonitor() {
+  const auto& flag = core::Runtime::runtime_singleton_->flag();
+  if (scratch_monitor_thread_ != NULL ||
+      !(flag.scratch_elastic() || flag.scratch_shared() || flag.queue_telemetry() ||
+        flag.queue_grow_hits()))
+    return;
+
+  scratch_monitor_event_ = os::CreateOsEvent(true, false);
+  if (scratch_monitor_event_ == NULL) return;
+
+  scratch_monitor_exit_ = false;
+  scratch_monitor_thread_ = core::Runtime::runtime_singleton_->CreateThread(
+      HSA_AMD_THREAD_CLASS_BACKGROUND, ScratchMonitorRun, (void*)this, this);
+  if (scratch_monitor_thread_ == NULL) {
+    debug_warning("Failed to start scratch monitor thread.");
+    os::DestroyOsEvent(scratch_monitor_event_);
+    scratch_monitor_event_ = NULL;
+  }
+}
+
+void GpuAgent::StopScratchMonitor() {
+  if (scratch_monitor_thread_ == NULL) return;
+
+  scratch_monitor_exit_ = true;
+  os::SetOsEvent(scratch_monitor_event_);
+  os::WaitForThread(scratch_monitor_thread_);
+  os::CloseThread(scratch_monitor_thread_);
+  os::DestroyOsEvent(scratch_monitor_event_);
+  scratch_monitor_thread_ = NULL;
+  scratch_monitor_event_ = NULL;
+}
+
+void GpuAgent::ScratchMonitorRun(void* agent) {
+  reinterpret_cast<GpuAgent*>(agent)->ScratchMonitor();
+}
+
+void GpuAgent::ScratchMonitor() {
+  const uint32_t tick_ms = 100;
+  const bool telemetry = core::Runtime::runtime_singleton_->flag().queue_telemetry();
+  const bool grow = core::Runtime::runtime_singleton_->flag().queue_grow_hits() != 0;
+  std::vector<size_t> warm;
+
+  while (true) {
+    os::WaitForOsEvent(scratch_monitor_event_, tick_ms);
+    if (scratch_monitor_exit_) return;
+
+    warm.clear();
+    {
+      const uint64_t now = telemetry ? os::ReadAccurateClock() : 0;
+      ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
+      for (auto iter : aql_queues_) {
+        AqlQueue* queue = static_cast<AqlQueue*>(iter);
+        size_t size = queue->ScratchMonitorTick();
+        if (size != 0) warm.push_back(size);
+        if (telemetry) queue->SampleTelemetry(now);
+        if (grow) {
+          const uint64_t depth = queue->SampleHighWater();
+          if (depth > queue_peak_depth_) queue_peak_depth_ = depth;
+        }
+      }
+    }
+    if (!warm.empty()) WarmScratchCache(warm);
+  }
+}
+
+bool GpuAgent::RequestPriorityUpdate() {
+  ScopedAcquire<KernelMutex> lock(&priority_update_lock_);
+  if (priority_update_thread_ == NULL) {
+    priority_update_event_ = os::CreateOsEvent(true, false);
+    if (priority_update_event_ == NULL) return false;
+
+    priority_update_exit_ = false;
+    priority_update_thread_ = core::Runtime::runtime_singleton_->CreateThread(
+        HSA_AMD_THREAD_CLASS_BACKGROUND, PriorityUpdaterRun, (void*)this, this);
+    if (priority_update_thread_ == NULL) {
+      debug_warning("Failed to start queue priority updater thread.");
+      os::DestroyOsEvent(priority_update_event_);
+      priority_update_event_ = NULL;
+      return false;
+    }
+  }
+  os::SetOsEvent(priority_update_event_);
+  return true;
+}
+
+void GpuAgent::StopPriorityUpdater() {
+  if (priority_update_thread_ == NULL) return;
+
+  priority_update_exit_ = true;
+  os::SetOsEvent(priority_update_event_);
+  os::WaitForThread(priority_update_thread_);
+  os::CloseThread(priority_update_thread_);
+  os::DestroyOsEvent(priority_update_event_);
+  priority_update_thread_ = NULL;
+  priority_update_event_ = NULL;
+}
+
+void GpuAgent::PriorityUpdaterRun(void* agent) {
+  reinterpret_cast<GpuAgent*>(agent)->PriorityUpdater();
+}
+
+void GpuAgent::PriorityUpdater() {
+  const uint32_t interval_ms = core::Runtime::runtime_singleton_->flag().queue_priority_interval();
+
+  while (true) {
+    os::WaitForOsEvent(priority_update_event_, 0xFFFFFFFF);
+    if (priority_update_exit_) return;
+
+    {
+      // Queues leave aql_queues_ before they are destroyed.
+      ScopedAcquire<KernelMutex> lock(&aql_queues_lock_);
+      for (auto iter : aql_queues_) static_cast<AqlQueue*>(iter)->ApplyPendingPriority();
+    }
+
+    // Requests made while sleeping coalesce into the next batch.
+    os::Sleep(interval_ms);
+  }
+}
+
+void GpuAgent::WarmScratchCache(std::vector<size_t>& sizes) {
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+  ScopedAcquire<KernelMutex> lock(&scratch_lock_);
+  // Warm nodes are small allocations, keep them and bound scratch under the small limit used by
+  // AcquireQueueMainScratch so warming never forces a dispatch onto use-once scratch.
+  const size_t small_limit = scratch_pool_.size() >> 3;
+
+  for (size_t size : sizes) {
+    if (scratch_cache_.hasFree(size)) continue;
+    const size_t mapped =
+        scratch_pool_.size() - scratch_pool_.remaining() - scratch_cache_.reserved_bytes();
+    if (mapped + size > small_limit) return;
+
+    void* base = scratch_pool_.alloc(size);
+    if (base == nullptr) return;
+    if (base > scratch_pool_.high_split()) {
+      scratch_pool_.free(base);
+      return;
+    }
+
+    HSAuint64 alternate_va;
+    if ((profile_ != HSA_PROFILE_FULL) &&
+        (hsaKmtMapMemoryToGPU(base, size, &alternate_va) != HSAKMT_STATUS_SUCCESS)) {
+      scratch_pool_.free(base);
+      return;
+    }
+    scratch_cache_.insertFree(size, base);
+  }
+}
+
 void GpuAgent::TranslateTime(core::Signal* signal, hsa_amd_profiling_dispatch_time_t& time) {
   uint64_t start, end;
   signal->GetRawTs(false, start, end);
@@ -2078,6 +3072,10 @@ uint64_t GpuAgent::TranslateTime(uint64_t tick) {
   // Limit errors due to relative frequency drift to ~0.5us.  Sync clocks at 16Hz.
   const int64_t max_extrapolation = core::Runtime::runtime_singleton_->sys_clock_freq() >> 4;
 
+  // Ticks within the published range convert the same as below without the lock.
+  uint64_t system_tick = 0;
+  if (hsa_amd_clock_params_convert(&clock_params_, tick, &system_tick)) return system_tick;
+
   ScopedAcquire<KernelMutex> lock(&t1_lock_);
   // Limit errors due to correlated pair certainty to ~0.5us.
   // extrapolated time < (0.5us / half clock read certainty) * delay between clock measures
@@ -2094,7 +3092,6 @@ uint64_t GpuAgent::TranslateTime(uint64_t tick) {
   // return sysLarge;
 
   // Good for ~3.5 months.
-  uint64_t system_tick = 0;
   int64_t elapsed = 0;
   double ratio;
 
@@ -2121,6 +3118,17 @@ uint64_t GpuAgent::TranslateTime(uint64_t tick) {
   return system_tick;
 }
 
+uint64_t GpuAgent::ReadClock() {
+  // The published range extends past the last sample, so recent times need no clock sample.
+  uint64_t tick;
+  if (hsa_amd_clock_params_convert_system(&clock_params_, os::ReadSystemClock(), &tick))
+    return tick;
+
+  ScopedAcquire<KernelMutex> lock(&t1_lock_);
+  SyncClocks();
+  return t1_.GPUClockCounter;
+}
+
 bool GpuAgent::current_coherency_type(hsa_amd_coherency_type_t type) {
   if (!is_kv_device_) {
     current_coherency_type_ = type;
@@ -2168,6 +3176,26 @@ uint16_t GpuAgent::GetSdmaMicrocodeVersion() const {
 void GpuAgent::SyncClocks() {
   HSAKMT_STATUS err = hsaKmtGetClockCounters(node_id(), &t1_);
   assert(err == HSAKMT_STATUS_SUCCESS && "hsaGetClockCounters error");
+  if (t1_.GPUClockCounter == t0_.GPUClockCounter) return;
+
+  // Same bounds as TranslateTime: extrapolate at most a quarter of the sampled interval and at
+  // most max_extrapolation system ticks past t1_.
+  const double ratio = double(t1_.SystemClockCounter - t0_.SystemClockCounter) /
+      double(t1_.GPUClockCounter - t0_.GPUClockCounter);
+  const uint64_t max_extrapolation = core::Runtime::runtime_singleton_->sys_clock_freq() >> 4;
+  uint64_t range = (t1_.GPUClockCounter - t0_.GPUClockCounter) >> 2;
+  range = Min(range, uint64_t(double(max_extrapolation) / ratio));
+  if (range != 0) range--;
+
+  const uint64_t sequence = clock_params_.sequence;
+  atomic::Store(&clock_params_.sequence, sequence + 1, std::memory_order_relaxed);
+  atomic::Fence(std::memory_order_release);
+  clock_params_.agent_tick = t1_.GPUClockCounter;
+  clock_params_.system_tick = t1_.SystemClockCounter;
+  clock_params_.ratio = ratio;
+  clock_params_.agent_tick_min = t0_.GPUClockCounter;
+  clock_params_.agent_tick_max = t1_.GPUClockCounter + range;
+  atomic::Store(&clock_params_.sequence, sequence + 2, std::memory_order_release);
 }
 
 hsa_status_t GpuAgent::UpdateTrapHandlerWithPCS(void* pcs_hosttrap_buffers, void* pcs_stochastic_buffers) {
@@ -2263,7 +3291,9 @@ void GpuAgent::BindTrapHandler() {
   assert(err == HSAKMT_STATUS_SUCCESS && "hsaKmtSetTrapHandler() failed");
 }
 
-void GpuAgent::InvalidateCodeCaches() {
+void GpuAgent::InvalidateCodeCaches() { InvalidateCodeCaches(nullptr, 0); }
+
+void GpuAgent::InvalidateCodeCaches(const void* base, size_t size) {
   // Check for microcode cache invalidation support.
   // This is deprecated in later microcode builds.
   if (isa_->GetMajorVersion() == 7) {
@@ -2280,7 +3310,18 @@ void GpuAgent::InvalidateCodeCaches() {
     assert(false && "Code cache invalidation not implemented for this agent");
   }
 
-  // Invalidate caches which may hold lines of code object allocation.
+  // Invalidate caches which may hold lines of code object allocation. A null
+  // base covers the whole address space, the range is in 256 byte units.
+  const bool ranged = base != nullptr;
+  uint64_t coher_base = 0;
+  uint64_t coher_size = 0xFFFFFFFFFFull;
+  if (ranged) {
+    const uintptr_t start = AlignDown(reinterpret_cast<uintptr_t>(base), 256);
+    const uintptr_t end = AlignUp(reinterpret_cast<uintptr_t>(base) + size, 256);
+    coher_base = start >> 8;
+    coher_size = (end - start) >> 8;
+  }
+
   uint32_t cache_inv[8] = {0};
   uint32_t cache_inv_size_dw;
 
@@ -2293,11 +3334,16 @@ void GpuAgent::InvalidateCodeCaches() {
 
       cache_inv_size_dw = 7;
   } else {
+      // The scalar and vector L0 caches are always invalidated in full.
+      const uint32_t gcr_range = ranged ? PM4_ACQUIRE_MEM_GCR_RANGE : PM4_ACQUIRE_MEM_GCR_ALL;
       cache_inv[7] = PM4_ACQUIRE_MEM_DW7_GCR_CNTL(
-          PM4_ACQUIRE_MEM_GCR_CNTL_GLI_INV(1) |
+          PM4_ACQUIRE_MEM_GCR_CNTL_GLI_INV(ranged ? PM4_ACQUIRE_MEM_GCR_RANGE
+                                                  : PM4_ACQUIRE_MEM_GCR_GLI_ALL) |
+          PM4_ACQUIRE_MEM_GCR_CNTL_GL1_RANGE(gcr_range) |
           PM4_ACQUIRE_MEM_GCR_CNTL_GLK_INV |
           PM4_ACQUIRE_MEM_GCR_CNTL_GLV_INV |
           PM4_ACQUIRE_MEM_GCR_CNTL_GL1_INV |
+          PM4_ACQUIRE_MEM_GCR_CNTL_GL2_RANGE(gcr_range) |
           PM4_ACQUIRE_MEM_GCR_CNTL_GL2_INV);
 
       cache_inv_size_dw = 8;
@@ -2305,8 +3351,10 @@ void GpuAgent::InvalidateCodeCaches() {
 
   cache_inv[0] = PM4_HDR(PM4_HDR_IT_OPCODE_ACQUIRE_MEM, cache_inv_size_dw,
              isa_->GetMajorVersion());
-  cache_inv[2] = PM4_ACQUIRE_MEM_DW2_COHER_SIZE(0xFFFFFFFF);
-  cache_inv[3] = PM4_ACQUIRE_MEM_DW3_COHER_SIZE_HI(0xFF);
+  cache_inv[2] = PM4_ACQUIRE_MEM_DW2_COHER_SIZE(uint32_t(coher_size));
+  cache_inv[3] = PM4_ACQUIRE_MEM_DW3_COHER_SIZE_HI(uint32_t(coher_size >> 32));
+  cache_inv[4] = PM4_ACQUIRE_MEM_DW4_COHER_BASE_LO(uint32_t(coher_base));
+  cache_inv[5] = PM4_ACQUIRE_MEM_DW5_COHER_BASE_HI(uint32_t(coher_base >> 32));
 
   // Submit the command to the utility queue and wait for it to complete.
   queues_[QueueUtility]->ExecutePM4(cache_inv, cache_inv_size_dw * sizeof(uint32_t));
@@ -2373,6 +3421,11 @@ lazy_ptr<core::Blit>& GpuAgent::GetBlitObject(const core::Agent& dst_agent,
       return blits_[BlitDevToDev];
   }
 
+  if (core::Runtime::runtime_singleton_->flag().sdma_load_balance()) {
+    lazy_ptr<core::Blit>* blit = GetBalancedBlit(dst_agent, src_agent, size);
+    if (blit != nullptr) return *blit;
+  }
+
   // Acquire Hive Id of Src and Dst devices - ignore hive id for CPU devices.
   // CPU-GPU connections should always use the host (aka pcie) facing SDMA engines, even if the
   // connection is XGMI.
@@ -2413,35 +3466,47 @@ lazy_ptr<core::Blit>& GpuAgent::GetBlitObject(const core::Agent& dst_agent,
 
 void GpuAgent::Trim() {
   Agent::Trim();
+  core::Runtime::runtime_singleton_->VMemoryHandleCacheTrim(this);
   AsyncReclaimScratchQueues();
   ScopedAcquire<KernelMutex> lock(&scratch_lock_);
   scratch_cache_.trim(false);
 }
 
-void GpuAgent::InitAllocators() {
-  for (auto pool : GetNearestCpuAgent()->regions()) {
+std::function<void*(size_t size, size_t align, core::MemoryRegion::AllocateFlags flags)>
+GpuAgent::SystemAllocatorFor(const core::Agent* cpu) const {
+  if (cpu == nullptr) return system_allocator_;
+
+  for (auto pool : cpu->regions()) {
     if (pool->kernarg()) {
-      system_allocator_ = [pool](size_t size, size_t alignment,
-                                 MemoryRegion::AllocateFlags alloc_flags) -> void* {
+      return [pool](size_t size, size_t alignment,
+                    MemoryRegion::AllocateFlags alloc_flags) -> void* {
         assert(alignment <= 4096);
+        core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_INTERNAL);
         void* ptr = nullptr;
         return (HSA_STATUS_SUCCESS ==
                 core::Runtime::runtime_singleton_->AllocateMemory(pool, size, alloc_flags, &ptr))
             ? ptr
             : nullptr;
       };
-
-      system_deallocator_ = [](void* ptr) { core::Runtime::runtime_singleton_->FreeMemory(ptr); };
     }
   }
+  return nullptr;
+}
+
+void GpuAgent::InitAllocators() {
+  system_allocator_ = SystemAllocatorFor(GetNearestCpuAgent());
+  system_deallocator_ = [](void* ptr) { core::Runtime::runtime_singleton_->FreeMemory(ptr); };
   assert(system_allocator_ && "Nearest NUMA node did not have a kernarg pool.");
 
   // Setup fine-grain allocator
   for (auto region : regions()) {
     const AMD::MemoryRegion* amd_region = (const AMD::MemoryRegion*)region;
     if (amd_region->IsLocalMemory() && amd_region->fine_grain()) {
+      // Thunk reports the frame buffer as public only when all of it is CPU visible.
+      host_accessible_local_ = amd_region->IsPublic();
       finegrain_allocator_ = [region](size_t size,
                                       MemoryRegion::AllocateFlags alloc_flags) -> void* {
+        core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_INTERNAL);
         void* ptr = nullptr;
         return (HSA_STATUS_SUCCESS ==
                 core::Runtime::runtime_singleton_->AllocateMemory(region, size, alloc_flags, &ptr))
@@ -2547,6 +3612,7 @@ hsa_status_t GpuAgent::PcSamplingCreate(pcs::PcsRuntime::PcSamplingSession& sess
   session.GetHsaKmtSamplingInfo(&sampleInfo);
   HSAKMT_STATUS retkmt = hsaKmtPcSamplingCreate(node_id(), &sampleInfo, &thunkId);
   if (retkmt != HSAKMT_STATUS_SUCCESS) {
+    PcSamplingDetach(session);
     return (retkmt == HSAKMT_STATUS_KERNEL_ALREADY_OPENED) ? (hsa_status_t)HSA_STATUS_ERROR_RESOURCE_BUSY
             : HSA_STATUS_ERROR;
   }
@@ -2563,10 +3629,21 @@ hsa_status_t GpuAgent::PcSamplingCreateFromId(HsaPcSamplingTraceId ioctlId,
   pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
 
   if (session.method() == HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1) {
-    // TODO: For now can only have 1 hosttrap session at a time. As a final solution, we want to be
-    // able to support multiple sessions at a time. But this makes the session.HandleSampleData more
-    // complicated if multiple sessions have different buffer sizes.
-    if (ht_data.session) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+    // Further hosttrap sessions read the samples of the first one from the shared host buffer,
+    // they must sample the same way and fit into the host buffer sized for the first session.
+    if (!ht_data.sessions.empty()) {
+      const pcs::PcsRuntime::PcSamplingSession& first = *ht_data.sessions.front();
+      if (session.units() != first.units() || session.interval() != first.interval() ||
+          session.buffer_size() > first.buffer_size())
+        return (hsa_status_t)HSA_STATUS_ERROR_RESOURCE_BUSY;
+
+      std::lock_guard<std::mutex> lock(ht_data.host_buffer_mutex);
+      session.read_index = ht_data.host_write_index;
+      session.lost_sample_count = 0;
+      session.SetThunkId(ioctlId);
+      ht_data.sessions.push_back(&session);
+      return HSA_STATUS_SUCCESS;
+    }
 
     // This is current amd_aql_queue->pm4_ib_size_b_
     ht_data.cmd_data_sz = 0x1000;
@@ -2708,45 +3785,58 @@ hsa_status_t GpuAgent::PcSamplingCreateFromId(HsaPcSamplingTraceId ioctlId,
       return HSA_STATUS_ERROR;
     }
 
-    ht_data.lost_sample_count = 0;
-    ht_data.host_buffer_wrap_pos = 0;
-    ht_data.host_write_ptr = ht_data.host_buffer;
-    ht_data.host_read_ptr = ht_data.host_write_ptr;
+    ht_data.sample_size = session.sample_size();
+    ht_data.host_write_index = 0;
+    session.read_index = 0;
+    session.lost_sample_count = 0;
 
-    ht_data.session = &session;
+    ht_data.sessions.push_back(&session);
     freeHostTrapResources.Dismiss();
 
-    if (UpdateTrapHandlerWithPCS(ht_data.device_data, NULL) != HSA_STATUS_SUCCESS) return HSA_STATUS_ERROR;
+    if (UpdateTrapHandlerWithPCS(ht_data.device_data, NULL) != HSA_STATUS_SUCCESS) {
+      PcSamplingDetach(session);
+      return HSA_STATUS_ERROR;
+    }
   }
 
   session.SetThunkId(ioctlId);
-  ht_data.session = &session;
 
   return HSA_STATUS_SUCCESS;
 }
 
-hsa_status_t GpuAgent::PcSamplingDestroy(pcs::PcsRuntime::PcSamplingSession& session) {
-  if (PcSamplingStop(session) != HSA_STATUS_SUCCESS) return HSA_STATUS_ERROR;
+void GpuAgent::PcSamplingDetach(pcs::PcsRuntime::PcSamplingSession& session) {
+  if (session.method() != HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1) return;
 
   pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
-  HSAKMT_STATUS retKmt = hsaKmtPcSamplingDestroy(node_id(), session.ThunkId());
-  ht_data.session = NULL;
+  {
+    std::lock_guard<std::mutex> lock(ht_data.host_buffer_mutex);
+    auto it = std::find(ht_data.sessions.begin(), ht_data.sessions.end(), &session);
+    if (it == ht_data.sessions.end()) return;
+    ht_data.sessions.erase(it);
+    if (!ht_data.sessions.empty()) return;
+  }
 
-  if (session.method() == HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1) {
-    free(ht_data.cmd_data);
-    system_deallocator()(ht_data.old_val);
-    HSA::hsa_signal_destroy(ht_data.exec_pm4_signal);
-    HSA::hsa_signal_destroy(ht_data.device_data->done_sig0);
-    HSA::hsa_signal_destroy(ht_data.device_data->done_sig1);
-    finegrain_deallocator()(ht_data.device_data);
-    system_deallocator()(ht_data.host_buffer);
+  // Last hosttrap session on this agent, release the buffers.
+  free(ht_data.cmd_data);
+  system_deallocator()(ht_data.old_val);
+  HSA::hsa_signal_destroy(ht_data.exec_pm4_signal);
+  HSA::hsa_signal_destroy(ht_data.device_data->done_sig0);
+  HSA::hsa_signal_destroy(ht_data.device_data->done_sig1);
+  finegrain_deallocator()(ht_data.device_data);
+  system_deallocator()(ht_data.host_buffer);
 
-    ht_data.device_data = NULL;
-    ht_data.host_buffer = NULL;
-    ht_data.session = NULL;
+  ht_data.device_data = NULL;
+  ht_data.host_buffer = NULL;
+
+  UpdateTrapHandlerWithPCS(NULL, NULL);
+}
+
+hsa_status_t GpuAgent::PcSamplingDestroy(pcs::PcsRuntime::PcSamplingSession& session) {
+  if (PcSamplingStop(session) != HSA_STATUS_SUCCESS) return HSA_STATUS_ERROR;
+
+  HSAKMT_STATUS retKmt = hsaKmtPcSamplingDestroy(node_id(), session.ThunkId());
+  PcSamplingDetach(session);
 
-    UpdateTrapHandlerWithPCS(NULL, NULL);
-  }
   return (retKmt == HSAKMT_STATUS_SUCCESS) ? HSA_STATUS_SUCCESS : HSA_STATUS_ERROR;
 }
 
@@ -2757,17 +3847,22 @@ hsa_status_t GpuAgent::PcSamplingStart(pcs::PcsRuntime::PcSamplingSession& sessi
 
   auto method = session.method();
   if (method == HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1) {
-    if (ht_data.session->isActive()) {
-      debug_warning("Already have a Host trap session in progress!");
-      return (hsa_status_t)HSA_STATUS_ERROR_RESOURCE_BUSY;
-    }
-    ht_data.session->start();
+    session.start();
     // This thread will handle all hosttrap sessions on this agent
     // In the future, there will be another thread to handle stochastic sessions.
-    ht_data.thread = os::CreateThread(PcSamplingThreadRun, (void*)this);
-    if (!ht_data.thread)
-      throw AMD::hsa_exception(HSA_STATUS_ERROR_OUT_OF_RESOURCES,
-                               "Failed to start PC Sampling thread.");
+    if (ht_data.active_sessions++ == 0) {
+      // Undo the wake up of the previous thread, if any.
+      HSA::hsa_signal_store_screlease(ht_data.device_data->done_sig0, 1);
+      HSA::hsa_signal_store_screlease(ht_data.device_data->done_sig1, 1);
+      ht_data.thread = core::Runtime::runtime_singleton_->CreateThread(
+          HSA_AMD_THREAD_CLASS_PC_SAMPLING, PcSamplingThreadRun, (void*)this, this);
+      if (!ht_data.thread) {
+        ht_data.active_sessions--;
+        session.stop();
+        throw AMD::hsa_exception(HSA_STATUS_ERROR_OUT_OF_RESOURCES,
+                                 "Failed to start PC Sampling thread.");
+      }
+    }
   }
 
   if (hsaKmtPcSamplingStart(node_id(), session.ThunkId()) == HSAKMT_STATUS_SUCCESS)
@@ -2775,15 +3870,25 @@ hsa_status_t GpuAgent::PcSamplingStart(pcs::PcsRuntime::PcSamplingSession& sessi
 
   debug_print("Failed to start PC sampling session with thunkId:%d\n", session.ThunkId());
   if (method == HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1) {
-    ht_data.session->stop();
-    os::WaitForThread(ht_data.thread);
-    os::CloseThread(ht_data.thread);
-    ht_data.thread = NULL;
+    session.stop();
+    if (--ht_data.active_sessions == 0) PcSamplingStopHostTrapThread();
   }
 
   return HSA_STATUS_ERROR;
 }
 
+void GpuAgent::PcSamplingStopHostTrapThread() {
+  pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
+
+  // Wake up pcs_hosttrap_thread_ if it is waiting for data
+  HSA::hsa_signal_store_screlease(ht_data.device_data->done_sig0, -1);
+  HSA::hsa_signal_store_screlease(ht_data.device_data->done_sig1, -1);
+
+  os::WaitForThread(ht_data.thread);
+  os::CloseThread(ht_data.thread);
+  ht_data.thread = NULL;
+}
+
 hsa_status_t GpuAgent::PcSamplingStop(pcs::PcsRuntime::PcSamplingSession& session) {
   if (!session.isActive()) return HSA_STATUS_SUCCESS;
 
@@ -2792,24 +3897,18 @@ hsa_status_t GpuAgent::PcSamplingStop(pcs::PcsRuntime::PcSamplingSession& sessio
   session.stop();
 
   HSAKMT_STATUS retKmt = hsaKmtPcSamplingStop(node_id(), session.ThunkId());
-  if (retKmt != HSAKMT_STATUS_SUCCESS)
-    throw AMD::hsa_exception(HSA_STATUS_ERROR, "Failed to stop PC Sampling session.");
 
-  if (session.method() == HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1) {
-    // Wake up pcs_hosttrap_thread_ if it is waiting for data
-    HSA::hsa_signal_store_screlease(ht_data.device_data->done_sig0, -1);
-    HSA::hsa_signal_store_screlease(ht_data.device_data->done_sig1, -1);
+  // The thread keeps serving the other hosttrap sessions of this agent.
+  if (session.method() == HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1 && --ht_data.active_sessions == 0)
+    PcSamplingStopHostTrapThread();
 
-    os::WaitForThread(ht_data.thread);
-    os::CloseThread(ht_data.thread);
-    ht_data.thread = NULL;
-  }
+  if (retKmt != HSAKMT_STATUS_SUCCESS)
+    throw AMD::hsa_exception(HSA_STATUS_ERROR, "Failed to stop PC Sampling session.");
 
   return HSA_STATUS_SUCCESS;
 }
 
-hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
-    pcs::PcsRuntime::PcSamplingSession& session) {
+hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers() {
   pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
   uint32_t& which_buffer = ht_data.which_buffer;
   uint32_t* cmd_data = ht_data.cmd_data;
@@ -2824,6 +3923,9 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
    * Host-buffer = buffer inside ROCr
    * User-buffer = Session buffer size specified in PCSamplingSessionCreate
    *
+   * All hosttrap sessions on the agent share the Host-buffer, each with its own rptr. The
+   * examples below show a single session.
+   *
    * Conditions for the buffer sizes:
    * Host buffer is at least 2 times bigger than device buffer and Host buffer
    * is also at least 2 times bigger than User-Buffer.
@@ -2841,7 +3943,7 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
    *    - User has created a new session with buffer size = 7*N
    *
    *    Device-Buffer[---][---]
-   *    Host-Buffer[--------------] wptr=0 rptr=0 wrap_pos=0
+   *    Host-Buffer[--------------] wptr=0 rptr=0
    *    User-Buffer[-------]
    *
    *    -- Device Buffer has size 3*N
@@ -2860,7 +3962,7 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
    *
    *    State at end:
    *    Device-Buffer[---][=--]
-   *    Host-Buffer[===-----------] wptr=3 rptr=0, wrap_pos=0
+   *    Host-Buffer[===-----------] wptr=3 rptr=0
    *    User-Buffer[-------]
    *
    * 3. Device Buffer#2 hits watermark
@@ -2875,7 +3977,7 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
    *
    *    State at end:
    *    Device-Buffer[=--][---]
-   *    Host-Buffer[======--------] wptr=6 rptr=0 wrap_pos=0
+   *    Host-Buffer[======--------] wptr=6 rptr=0
    *    User-Buffer[-------]
    *
    * 4. Device Buffer#1 hits watermark
@@ -2901,35 +4003,35 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
    *    -- User processes User-Buffer
    *
    *    Device-Buffer[=--][---]
-   *    Host-Buffer[-------==-----] wptr=9 rptr=7 wrap_pos=0
+   *    Host-Buffer[-------==-----] wptr=9 rptr=7
    *    User-Buffer[-------]
    *
    * 6. Device Buffer#1 hits watermark
    *    State at end:
    *    Device-Buffer[---][=--]
-   *    Host-Buffer[-------=====--] wptr=12 rptr=7 wrap_pos=0
+   *    Host-Buffer[-------=====--] wptr=12 rptr=7
    *    User-Buffer[-------]
    *
    * 7. Device Buffer#2 hits watermark
    *    State at beginning:
    *    Device-Buffer[---][===]
-   *    Host-Buffer[-------=====--] wptr=12 rptr=7 wrap_pos=0
+   *    Host-Buffer[-------=====--] wptr=12 rptr=7
    *    User-Buffer[-------]
    *
    *    -- We do not have enough space after wptr. The CP-DMA copy
-   *    -- can only copy a contiguous range, so copy to the
-   *    -- beginning of Host-Buffer and set wrap_pos
+   *    -- can only copy a contiguous range, so the copy is split
+   *    -- into the end and the beginning of Host-Buffer
    *
    *    Device-Buffer[=--][---]
-   *    Host-Buffer[===----=====--] wptr=3 rptr=7 wrap_pos=12
+   *    Host-Buffer[=------=======] wptr=1 rptr=7
    *    User-Buffer[-------]
    *
    *    -- We have enough data to fill User-Buffer. Callback user data-ready to
-   *    -- copy 7*N to user. We copy the tail end (index 7-12) of Host-Buffer
-   *    -- before copying the beginning of Host-Buffer (index 0-2).
+   *    -- copy 7*N to user, the tail end (index 7-13) of Host-Buffer. Data
+   *    -- that wraps around is handed over as two ranges.
    *
    *    Device-Buffer[=--][---]
-   *    Host-Buffer[--=-----------] wptr=3 rptr=2 wrap_pos=0
+   *    Host-Buffer[=-------------] wptr=1 rptr=0
    *    User-Buffer[=======]
    *
    *     -- User processes User-Buffer
@@ -2937,7 +4039,7 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
    * 8. Device Buffer#1 hits watermark
    *    State at end:
    *    Device-Buffer[---][=--]
-   *    Host-Buffer[--====--------] wptr=6 rptr=2 wrap_pos=0
+   *    Host-Buffer[====----------] wptr=4 rptr=0
    *    User-Buffer[-------]
    */
 
@@ -2954,9 +4056,6 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
 
   uint32_t pred_exec_cmd_sz = 0;
 
-  uint8_t* host_buffer_begin = ht_data.host_buffer;
-  uint8_t* host_buffer_end = ht_data.host_buffer + ht_data.host_buffer_size;
-
   uint64_t buf_write_val = (uint64_t) & (ht_data.device_data->buf_write_val);
   uint64_t buf_written_val[] = {(uint64_t) & (ht_data.device_data->buf_written_val0),
                                 (uint64_t) & (ht_data.device_data->buf_written_val1)};
@@ -2966,7 +4065,7 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
 
   uint8_t* buffer[] = {(uint8_t*)ht_data.device_data + buf_offset,
                        (uint8_t*)ht_data.device_data + buf_offset +
-                           ht_data.device_data->buf_size * session.sample_size()};
+                           ht_data.device_data->buf_size * ht_data.sample_size};
 
   next_buffer = (which_buffer + 1) % 2;
   reset_write_val = (uint64_t)next_buffer << 63;
@@ -3025,29 +4124,43 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
   /* If the number of entries in old_val is larger than buf_size, then there was a buffer overflow
    * and the 2nd level trap handler code will skip recording samples, causing lost samples
    */
+  size_t lost_samples = 0;
   if (*old_val > (uint64_t)ht_data.device_data->buf_size) {
-    ht_data.lost_sample_count = *old_val - (uint64_t)ht_data.device_data->buf_size;
+    lost_samples = *old_val - (uint64_t)ht_data.device_data->buf_size;
     *old_val = (uint64_t)ht_data.device_data->buf_size;
   }
 
-  to_copy = *old_val * session.sample_size();
+  to_copy = *old_val * ht_data.sample_size;
 
-  /* Make sure there is enough space after host_write_ptr */
-  if (ht_data.host_write_ptr + to_copy >= host_buffer_end) {
-    // Need to wrap around
-    ht_data.host_buffer_wrap_pos = ht_data.host_write_ptr;
-    ht_data.host_write_ptr = host_buffer_begin;
+  /* Sessions that have not read the data about to be overwritten lose it */
+  for (pcs::PcsRuntime::PcSamplingSession* session : ht_data.sessions) {
+    session->lost_sample_count += lost_samples;
+    const uint64_t unread = ht_data.host_write_index - session->read_index;
+    if (unread + to_copy > ht_data.host_buffer_size) {
+      const uint64_t dropped = unread + to_copy - ht_data.host_buffer_size;
+      session->read_index += dropped;
+      session->lost_sample_count += dropped / ht_data.sample_size;
+    }
   }
 
+  /* The copy is split in two where it wraps around the end of the host buffer */
+  const size_t write_offset = ht_data.host_write_index % ht_data.host_buffer_size;
+  const size_t to_copy_before_wrap = std::min<size_t>(to_copy, ht_data.host_buffer_size -
+                                                      write_offset);
+  struct {
+    uint8_t* dst;
+    uint32_t size;
+  } copy_ranges[] = {{ht_data.host_buffer + write_offset, (uint32_t)to_copy_before_wrap},
+                     {ht_data.host_buffer, (uint32_t)(to_copy - to_copy_before_wrap)}};
+
   i = 0;
   memset(cmd_data, 0, cmd_data_sz);
 
   if (properties_.NumXcc > 1) {
-    const uint32_t n = ceil(to_copy / (32 * 1024 * 1024));
+    // The execute count is filled in once all packets are known.
     pred_exec_cmd_sz = 2;
     cmd_data[i++] = PM4_HDR(PM4_HDR_IT_OPCODE_PRED_EXEC, pred_exec_cmd_sz, isa_->GetMajorVersion());
-    cmd_data[i++] =
-        PM4_PRED_EXEC_DW2_EXEC_COUNT(0x13 + 7 * n) | PM4_PRED_EXEC_DW2_VIRTUALXCCID_SELECT(0x1);
+    i++;
   }
 
   /*
@@ -3076,27 +4189,28 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
   unsigned int num_copy_command = 0;
   uint8_t* buffer_temp = buffer[which_buffer];
 
-  for (copy_bytes = CP_DMA_DATA_TRANSFER_CNT_MAX; 0 < to_copy; to_copy -= copy_bytes) {
-    num_copy_command++;
+  for (const auto& range : copy_ranges) {
+    uint8_t* dst = range.dst;
+    for (uint32_t remaining = range.size; 0 < remaining; remaining -= copy_bytes) {
+      num_copy_command++;
+      copy_bytes = std::min<uint64_t>(remaining, CP_DMA_DATA_TRANSFER_CNT_MAX);
+      to_copy -= copy_bytes;
 
-    /* DMA_DATA PACKETS, copy buffer using CPDMA */
-    cmd_data[i++] = PM4_HDR(PM4_HDR_IT_OPCODE_DMA_DATA, dma_data_cmd_sz, isa_->GetMajorVersion());
-    cmd_data[i++] = PM4_DMA_DATA_DW1(PM4_DMA_DATA_DST_SEL_DST_ADDR_USING_L2 |
-                                     PM4_DMA_DATA_SRC_SEL_SRC_ADDR_USING_L2);
-    cmd_data[i++] = PM4_DMA_DATA_DW2_SRC_ADDR_LO((uint64_t)buffer_temp);
-    cmd_data[i++] = PM4_DMA_DATA_DW3_SRC_ADDR_HI(((uint64_t)buffer_temp) >> 32);
-    cmd_data[i++] = PM4_DMA_DATA_DW4_DST_ADDR_LO((uint64_t)ht_data.host_write_ptr);
-    cmd_data[i++] = PM4_DMA_DATA_DW5_DST_ADDR_HI(((uint64_t)ht_data.host_write_ptr) >> 32);
-
-    if (copy_bytes >= to_copy) {
-      copy_bytes = to_copy;
+      /* DMA_DATA PACKETS, copy buffer using CPDMA */
       cmd_data[i++] =
-          PM4_DMA_DATA_DW6(PM4_DMA_DATA_BYTE_COUNT(copy_bytes) | PM4_DMA_DATA_DIS_WC_LAST);
-    } else {
-      cmd_data[i++] = PM4_DMA_DATA_DW6(PM4_DMA_DATA_BYTE_COUNT(copy_bytes) | PM4_DMA_DATA_DIS_WC);
+          PM4_HDR(PM4_HDR_IT_OPCODE_DMA_DATA, dma_data_cmd_sz, isa_->GetMajorVersion());
+      cmd_data[i++] = PM4_DMA_DATA_DW1(PM4_DMA_DATA_DST_SEL_DST_ADDR_USING_L2 |
+                                       PM4_DMA_DATA_SRC_SEL_SRC_ADDR_USING_L2);
+      cmd_data[i++] = PM4_DMA_DATA_DW2_SRC_ADDR_LO((uint64_t)buffer_temp);
+      cmd_data[i++] = PM4_DMA_DATA_DW3_SRC_ADDR_HI(((uint64_t)buffer_temp) >> 32);
+      cmd_data[i++] = PM4_DMA_DATA_DW4_DST_ADDR_LO((uint64_t)dst);
+      cmd_data[i++] = PM4_DMA_DATA_DW5_DST_ADDR_HI(((uint64_t)dst) >> 32);
+      cmd_data[i++] = PM4_DMA_DATA_DW6(PM4_DMA_DATA_BYTE_COUNT(copy_bytes) |
+                                       ((to_copy == 0) ? PM4_DMA_DATA_DIS_WC_LAST
+                                                       : PM4_DMA_DATA_DIS_WC));
+      buffer_temp += copy_bytes;
+      dst += copy_bytes;
     }
-    buffer_temp += copy_bytes;
-    ht_data.host_write_ptr += copy_bytes;
   }
 
   /* WRITE_DATA, Reset buf_written_val */
@@ -3110,6 +4224,11 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
   unsigned int cmd_sz = pred_exec_cmd_sz + wait_reg_mem_cmd_sz +
       (num_copy_command * dma_data_cmd_sz) + write_data_cmd_sz;
 
+  if (pred_exec_cmd_sz) {
+    cmd_data[1] = PM4_PRED_EXEC_DW2_EXEC_COUNT(cmd_sz - pred_exec_cmd_sz) |
+        PM4_PRED_EXEC_DW2_VIRTUALXCCID_SELECT(0x1);
+  }
+
   HSA::hsa_signal_store_screlease(exec_pm4_signal, 1);
   queues_[QueuePCSampling]->ExecutePM4(cmd_data, cmd_sz * sizeof(uint32_t), HSA_FENCE_SCOPE_NONE,
                                        HSA_FENCE_SCOPE_SYSTEM, &exec_pm4_signal);
@@ -3122,23 +4241,48 @@ hsa_status_t GpuAgent::PcSamplingFlushHostTrapDeviceBuffers(
 
   which_buffer = next_buffer;
 
+  /* Translate the timestamps once for all sessions, then publish the samples to them */
+  for (const auto& range : copy_ranges) {
+    perf_sample_hosttrap_v1_t* samples = reinterpret_cast<perf_sample_hosttrap_v1_t*>(range.dst);
+    for (size_t n = 0; n < range.size / sizeof(perf_sample_hosttrap_v1_t); n++)
+      samples[n].timestamp = TranslateTime(samples[n].timestamp);
+  }
+  ht_data.host_write_index += to_copy_before_wrap + copy_ranges[1].size;
+
   return HSA_STATUS_SUCCESS;
 }
 
+void GpuAgent::PcSamplingDeliverHostTrapData(pcs::PcsRuntime::PcSamplingSession& session,
+                                             bool drain) {
+  pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
+
+  while (true) {
+    const uint64_t unread = ht_data.host_write_index - session.read_index;
+    assert(unread <= ht_data.host_buffer_size);
+    if (unread == 0 || (!drain && unread < session.buffer_size())) break;
+
+    // Hand out the samples in place, data wrapping around the end of the host buffer is passed
+    // as a second range.
+    const size_t bytes = std::min<uint64_t>(unread, session.buffer_size());
+    const size_t offset = session.read_index % ht_data.host_buffer_size;
+    const size_t bytes_before_wrap = std::min(bytes, ht_data.host_buffer_size - offset);
+    session.HandleSampleData(ht_data.host_buffer + offset, bytes_before_wrap,
+                             (bytes_before_wrap < bytes) ? ht_data.host_buffer : NULL,
+                             bytes - bytes_before_wrap, session.lost_sample_count);
+    session.read_index += bytes;
+    session.lost_sample_count = 0;
+  }
+}
+
 void GpuAgent::PcSamplingThread() {
-  // TODO: Implement lost sample count
   // TODO: Implement latency
 
   pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
-  pcs::PcsRuntime::PcSamplingSession& session = *ht_data.session;
   uint32_t& which_buffer = ht_data.which_buffer;
 
-  uint8_t* host_buffer_begin = ht_data.host_buffer;
-  uint8_t* host_buffer_end = ht_data.host_buffer + ht_data.host_buffer_size;
-
   hsa_signal_t done_sig[] = {ht_data.device_data->done_sig0, ht_data.device_data->done_sig1};
 
-  while (ht_data.session->isActive()) {
+  while (ht_data.active_sessions > 0) {
     do {
       hsa_signal_value_t val = HSA::hsa_signal_wait_scacquire(
           done_sig[which_buffer], HSA_SIGNAL_CONDITION_LT, 1, UINT64_MAX, HSA_WAIT_STATE_BLOCKED);
@@ -3148,65 +4292,13 @@ void GpuAgent::PcSamplingThread() {
     HSA::hsa_signal_store_screlease(done_sig[which_buffer], 1);
 
     std::lock_guard<std::mutex> lock(ht_data.host_buffer_mutex);
-    if (PcSamplingFlushHostTrapDeviceBuffers(session) != HSA_STATUS_SUCCESS)
+    if (PcSamplingFlushHostTrapDeviceBuffers() != HSA_STATUS_SUCCESS)
       goto thread_exit;
 
-    size_t bytes_before_wrap;
-    size_t bytes_after_wrap;
-
-    assert(ht_data.host_read_ptr >= host_buffer_begin && ht_data.host_read_ptr < host_buffer_end);
-    assert(ht_data.host_write_ptr >= host_buffer_begin && ht_data.host_write_ptr < host_buffer_end);
-    assert(ht_data.host_buffer_wrap_pos ? (ht_data.host_read_ptr > ht_data.host_write_ptr)
-                                        : (ht_data.host_read_ptr <= ht_data.host_write_ptr));
-
-    if (ht_data.host_buffer_wrap_pos) {
-      assert(ht_data.host_buffer_wrap_pos <= host_buffer_end &&
-             ht_data.host_buffer_wrap_pos > host_buffer_begin);
-      assert(ht_data.host_read_ptr <= ht_data.host_buffer_wrap_pos);
-
-      // Wrapped around
-      bytes_before_wrap = ht_data.host_buffer_wrap_pos - ht_data.host_read_ptr;
-      bytes_after_wrap = ht_data.host_write_ptr - host_buffer_begin;
-
-      while (bytes_before_wrap >= session.buffer_size()) {
-        session.HandleSampleData(ht_data.host_read_ptr, session.buffer_size(), NULL, 0,
-                                 ht_data.lost_sample_count);
-        ht_data.host_read_ptr += session.buffer_size();
-        bytes_before_wrap = ht_data.host_buffer_wrap_pos - ht_data.host_read_ptr;
-        ht_data.lost_sample_count = 0;
-      }
-
-      if (bytes_before_wrap + bytes_after_wrap >= session.buffer_size()) {
-        session.HandleSampleData(ht_data.host_read_ptr, bytes_before_wrap, host_buffer_begin,
-                                 (session.buffer_size() - bytes_before_wrap), 0);
-        ht_data.host_read_ptr = host_buffer_begin + (session.buffer_size() - bytes_before_wrap);
-        bytes_before_wrap = 0;
-        ht_data.host_buffer_wrap_pos = 0;
-        bytes_after_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-        ht_data.lost_sample_count = 0;
-      }
-
-      while (bytes_after_wrap >= session.buffer_size()) {
-        session.HandleSampleData(ht_data.host_read_ptr, session.buffer_size(), NULL, 0,
-                                 ht_data.lost_sample_count);
-        ht_data.host_read_ptr += session.buffer_size();
-        bytes_before_wrap = 0;
-        bytes_after_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-        ht_data.lost_sample_count = 0;
-      }
-    } else {
-      bytes_before_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-
-      while (bytes_before_wrap >= session.buffer_size()) {
-        assert(ht_data.host_read_ptr >= host_buffer_begin &&
-               ht_data.host_read_ptr + session.buffer_size() < host_buffer_end);
-        session.HandleSampleData(ht_data.host_read_ptr, session.buffer_size(), NULL, 0,
-                                 ht_data.lost_sample_count);
-        ht_data.host_read_ptr += session.buffer_size();
-        bytes_before_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-        ht_data.lost_sample_count = 0;
-      }
-    }
+    // Every active session reads the same samples, stopped sessions keep theirs until they are
+    // started again or the data is overwritten.
+    for (pcs::PcsRuntime::PcSamplingSession* session : ht_data.sessions)
+      if (session->isActive()) PcSamplingDeliverHostTrapData(*session, false);
   }
 thread_exit:
   debug_print("PcSamplingThread::Exiting\n");
@@ -3221,68 +4313,12 @@ void GpuAgent::PcSamplingThreadRun(void* _agent) {
 hsa_status_t GpuAgent::PcSamplingFlush(pcs::PcsRuntime::PcSamplingSession& session) {
   pcs_hosttrap_t& ht_data = pcs_hosttrap_data_;
 
-  uint8_t* host_buffer_begin = ht_data.host_buffer;
-  uint8_t* host_buffer_end = ht_data.host_buffer + ht_data.host_buffer_size;
-
-  size_t bytes_before_wrap;
-  size_t bytes_after_wrap;
-
   std::lock_guard<std::mutex> lock(ht_data.host_buffer_mutex);
-  if (PcSamplingFlushHostTrapDeviceBuffers(session) != HSA_STATUS_SUCCESS)
+  if (PcSamplingFlushHostTrapDeviceBuffers() != HSA_STATUS_SUCCESS)
     return HSA_STATUS_ERROR;
 
-  assert(ht_data.host_read_ptr >= host_buffer_begin && ht_data.host_read_ptr < host_buffer_end);
-  assert(ht_data.host_write_ptr >= host_buffer_begin && ht_data.host_write_ptr < host_buffer_end);
-  assert(ht_data.host_buffer_wrap_pos ? (ht_data.host_read_ptr > ht_data.host_write_ptr)
-                                      : (ht_data.host_read_ptr <= ht_data.host_write_ptr));
-
-  if (ht_data.host_buffer_wrap_pos) {
-    assert(ht_data.host_buffer_wrap_pos <= host_buffer_end &&
-           ht_data.host_buffer_wrap_pos > host_buffer_begin);
-    assert(ht_data.host_read_ptr <= ht_data.host_buffer_wrap_pos);
-
-    // Wrapped around
-    bytes_before_wrap = ht_data.host_buffer_wrap_pos - ht_data.host_read_ptr;
-    bytes_after_wrap = ht_data.host_write_ptr - host_buffer_begin;
-
-    while (bytes_before_wrap > 0) {
-      size_t bytes_to_copy = std::min(bytes_before_wrap, session.buffer_size());
-
-      session.HandleSampleData(ht_data.host_read_ptr, bytes_to_copy, NULL, 0,
-                               ht_data.lost_sample_count);
-      ht_data.host_read_ptr += bytes_to_copy;
-      bytes_before_wrap = ht_data.host_buffer_wrap_pos - ht_data.host_read_ptr;
-      ht_data.lost_sample_count = 0;
-    }
-
-    assert(ht_data.host_read_ptr == ht_data.host_buffer_wrap_pos);
-    ht_data.host_buffer_wrap_pos = 0;
-    ht_data.host_read_ptr = host_buffer_begin;
-
-    while (bytes_after_wrap > 0) {
-      size_t bytes_to_copy = std::min(bytes_after_wrap, session.buffer_size());
-
-      session.HandleSampleData(ht_data.host_read_ptr, bytes_to_copy, NULL, 0,
-                               ht_data.lost_sample_count);
-      ht_data.host_read_ptr += bytes_to_copy;
-      bytes_after_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-      ht_data.lost_sample_count = 0;
-    }
-  } else {
-    bytes_before_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-
-    while (bytes_before_wrap) {
-      size_t bytes_to_copy = std::min(bytes_before_wrap, session.buffer_size());
-      assert(ht_data.host_read_ptr >= host_buffer_begin &&
-             ht_data.host_read_ptr + bytes_to_copy <= host_buffer_end);
-
-      session.HandleSampleData(ht_data.host_read_ptr, bytes_to_copy, NULL, 0,
-                               ht_data.lost_sample_count);
-      ht_data.host_read_ptr += bytes_to_copy;
-      bytes_before_wrap = ht_data.host_write_ptr - ht_data.host_read_ptr;
-      ht_data.lost_sample_count = 0;
-    }
-  }
+  // Other sessions get the flushed samples on their next data ready callback.
+  PcSamplingDeliverHostTrapData(session, true);
   return HSA_STATUS_SUCCESS;
 }
 
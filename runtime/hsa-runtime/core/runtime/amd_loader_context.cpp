@@ -75,6 +75,11 @@ public:
   virtual bool Copy(size_t offset, const void *src, size_t size) = 0;
   virtual void Free() = 0;
   virtual bool Freeze() = 0;
+  virtual bool Upload() { return true; }
+  virtual bool Defer(size_t offset, size_t size) { return false; }
+  virtual bool MakeResident(size_t offset, size_t size) { return true; }
+  virtual bool FreezeStart() { return Freeze(); }
+  virtual bool FreezeFinish() { return true; }
 
 protected:
   SegmentMemory() {}
@@ -253,31 +258,60 @@ public:
        ptr_(nullptr),
        host_ptr_(nullptr),
        size_(0),
-       is_code_(is_code) {}
+       is_code_(is_code),
+       direct_(false),
+       zero_(false) {
+   copy_signal_.handle = 0;
+ }
  ~RegionMemory() {}
 
  void* Address(size_t offset = 0) const override {
    assert(this->Allocated());
    return (char*)ptr_ + offset; }
-  void* HostAddress(size_t offset = 0) const override
-    { assert(this->Allocated()); return (char*)host_ptr_ + offset; }
+  void* HostAddress(size_t offset = 0) const override {
+    assert(this->Allocated());
+    return nullptr != host_ptr_ ? (char*)host_ptr_ + offset : nullptr;
+  }
   bool Allocated() const override
     { return nullptr != ptr_; }
 
   bool Allocate(size_t size, size_t align, bool zero) override;
   bool Copy(size_t offset, const void *src, size_t size) override;
   void Free() override;
+  bool Upload() override;
   bool Freeze() override;
+  bool FreezeStart() override;
+  bool FreezeFinish() override;
 
 private:
   RegionMemory(const RegionMemory&);
   RegionMemory& operator=(const RegionMemory&);
 
+  // Copies up to this size are relocation values and are captured by value.
+  static const size_t kPatchSize = 64;
+
+  struct PendingCopy {
+    size_t offset;
+    const void* src;
+    size_t size;
+  };
+
+  bool UploadRange(size_t offset, const void* src, size_t size);
+
   const core::MemoryRegion* region_;
   void *ptr_;
   void *host_ptr_;
   size_t size_;
   bool is_code_;
+  // Completion signal of the copy started by FreezeStart, if any.
+  hsa_signal_t copy_signal_;
+  // Set if no host copy is kept and copies are written straight to the agent
+  // memory by Upload, see HSA_LOADER_DIRECT_UPLOAD.
+  bool direct_;
+  bool zero_;
+  std::vector<PendingCopy> bulk_copies_;
+  std::vector<PendingCopy> patches_;  // src is an offset into patch_data_.
+  std::vector<uint8_t> patch_data_;
 };
 
 const core::MemoryRegion* RegionMemory::AgentLocal(hsa_agent_t agent, bool is_code) {
@@ -300,6 +334,7 @@ const core::MemoryRegion* RegionMemory::System(bool is_code) {
 }
 
 bool RegionMemory::Allocate(size_t size, size_t align, bool zero) {
+  core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_CODE_OBJECT);
   assert(!this->Allocated());
   assert(0 < size);
   assert(0 < align && 0 == (align & (align - 1)));
@@ -311,6 +346,16 @@ bool RegionMemory::Allocate(size_t size, size_t align, bool zero) {
     return false;
   }
   assert(0 == ((uintptr_t)ptr_) % align);
+
+  core::Agent* agent = region_->owner();
+  if (core::Runtime::runtime_singleton_->flag().loader_direct_upload() && agent != NULL &&
+      agent->device_type() == core::Agent::kAmdGpuDevice) {
+    direct_ = true;
+    zero_ = zero;
+    size_ = size;
+    return true;
+  }
+
   if (HSA_STATUS_SUCCESS !=
       core::Runtime::runtime_singleton_->AllocateMemory(
           RegionMemory::System(false), size, core::MemoryRegion::AllocateNoFlags, &host_ptr_)) {
@@ -327,10 +372,85 @@ bool RegionMemory::Allocate(size_t size, size_t align, bool zero) {
 }
 
 bool RegionMemory::Copy(size_t offset, const void* src, size_t size) {
-  assert(this->Allocated() && nullptr != host_ptr_);
+  assert(this->Allocated());
   assert(nullptr != src);
   assert(0 < size);
-  memcpy((char*)host_ptr_ + offset, src, size);
+
+  if (!direct_) {
+    assert(nullptr != host_ptr_);
+    memcpy((char*)host_ptr_ + offset, src, size);
+    return true;
+  }
+
+  if (size > kPatchSize) {
+    bulk_copies_.push_back({offset, src, size});
+    return true;
+  }
+
+  // Relocations are mostly applied in address order, so adjacent values are
+  // merged into one upload.
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
+  if (!patches_.empty() && patches_.back().offset + patches_.back().size == offset) {
+    patches_.back().size += size;
+  } else {
+    patches_.push_back({offset, reinterpret_cast<const void*>(patch_data_.size()), size});
+  }
+  patch_data_.insert(patch_data_.end(), bytes, bytes + size);
+  return true;
+}
+
+bool RegionMemory::UploadRange(size_t offset, const void* src, size_t size) {
+  core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_CODE_OBJECT);
+  core::Agent* agent = region_->owner();
+  const AMD::MemoryRegion* system_region =
+      static_cast<const AMD::MemoryRegion*>(RegionMemory::System(false));
+
+  // Pin the source in place, usually the code object reader's file mapping.
+  hsa_agent_t agent_handle = agent->public_handle();
+  void* agent_src = nullptr;
+  if (HSA_STATUS_SUCCESS ==
+      system_region->Lock(1, &agent_handle, const_cast<void*>(src), size, &agent_src)) {
+    hsa_status_t err = agent->DmaCopy((char*)ptr_ + offset, agent_src, size);
+    system_region->Unlock(const_cast<void*>(src));
+    return HSA_STATUS_SUCCESS == err;
+  }
+
+  // Mappings which cannot be pinned, such as read only file pages, go through
+  // a staging buffer that only lives for this copy.
+  void* staging = nullptr;
+  if (HSA_STATUS_SUCCESS !=
+      core::Runtime::runtime_singleton_->AllocateMemory(
+          system_region, size, core::MemoryRegion::AllocateNoFlags, &staging)) {
+    return false;
+  }
+  memcpy(staging, src, size);
+  hsa_status_t err = agent->DmaCopy((char*)ptr_ + offset, staging, size);
+  HSA::hsa_memory_free(staging);
+  return HSA_STATUS_SUCCESS == err;
+}
+
+bool RegionMemory::Upload() {
+  if (!direct_) return true;
+  assert(this->Allocated());
+
+  if (zero_) {
+    const size_t count = AlignUp(size_, sizeof(uint32_t)) / sizeof(uint32_t);
+    if (HSA_STATUS_SUCCESS != region_->owner()->DmaFill(ptr_, 0, count)) return false;
+    zero_ = false;
+  }
+
+  for (const PendingCopy& copy : bulk_copies_) {
+    if (!UploadRange(copy.offset, copy.src, copy.size)) return false;
+  }
+  bulk_copies_.clear();
+
+  // Relocation values go last since they patch the bulk data.
+  for (const PendingCopy& patch : patches_) {
+    const uint8_t* src = patch_data_.data() + reinterpret_cast<uintptr_t>(patch.src);
+    if (!UploadRange(patch.offset, src, patch.size)) return false;
+  }
+  patches_.clear();
+  patch_data_.clear();
   return true;
 }
 
@@ -344,24 +464,343 @@ void RegionMemory::Free()
   ptr_ = nullptr;
   host_ptr_ = nullptr;
   size_ = 0;
+  bulk_copies_.clear();
+  patches_.clear();
+  patch_data_.clear();
 }
 
 bool RegionMemory::Freeze() {
+  return FreezeStart() && FreezeFinish();
+}
+
+bool RegionMemory::FreezeStart() {
+  assert(copy_signal_.handle == 0);
+  // Agent memory already holds everything but copies made after the load.
+  if (direct_) return Upload();
   assert(this->Allocated() && nullptr != host_ptr_);
 
   core::Agent* agent = region_->owner();
-  if (agent != NULL && agent->device_type() == core::Agent::kAmdGpuDevice) {
-    if (HSA_STATUS_SUCCESS != agent->DmaCopy(ptr_, host_ptr_, size_)) {
-      return false;
-    }
-  } else {
+  if (agent == NULL || agent->device_type() != core::Agent::kAmdGpuDevice) {
     memcpy(ptr_, host_ptr_, size_);
+    return true;
+  }
+
+  // Queue the upload on the agent's host to device engine. The staging buffer
+  // is fine grain system memory and so is visible to the copy engine.
+  if (HSA_STATUS_SUCCESS == HSA::hsa_signal_create(1, 0, NULL, &copy_signal_)) {
+    std::vector<core::Signal*> dep_signals;
+    core::Agent* host_agent = RegionMemory::System(false)->owner();
+    if (HSA_STATUS_SUCCESS ==
+        core::Runtime::runtime_singleton_->CopyMemory(ptr_, agent, host_ptr_, host_agent, size_,
+                                                      dep_signals,
+                                                      *core::Signal::Convert(copy_signal_))) {
+      return true;
+    }
+    HSA::hsa_signal_destroy(copy_signal_);
+    copy_signal_.handle = 0;
+  }
+
+  return HSA_STATUS_SUCCESS == agent->DmaCopy(ptr_, host_ptr_, size_);
+}
+
+bool RegionMemory::FreezeFinish() {
+  if (copy_signal_.handle != 0) {
+    HSA::hsa_signal_wait_scacquire(copy_signal_, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX,
+                                   HSA_WAIT_STATE_BLOCKED);
+    HSA::hsa_signal_destroy(copy_signal_);
+    copy_signal_.handle = 0;
   }
 
   // Invalidate agent caches which may hold lines of the new allocation.
   if (is_code_ && (region_->owner()->device_type() == core::Agent::kAmdGpuDevice))
-    ((AMD::GpuAgent*)region_->owner())->InvalidateCodeCaches();
+    ((AMD::GpuAgent*)region_->owner())->InvalidateCodeCaches(ptr_, size_);
+
+  return true;
+}
+
+// Agent code memory of which only the parts in use are backed. The segment
+// VA is reserved up front and populated in chunks with the virtual memory
+// API, so deferred kernels cost neither device memory nor upload time until
+// they are made resident. A complete host copy is kept to upload from.
+class LazyCodeMemory final: public SegmentMemory {
+public:
+  // Code segments smaller than this are loaded whole.
+  static const size_t kMinSize = 1024 * 1024;
+
+  LazyCodeMemory(const core::MemoryRegion* region)
+      : SegmentMemory(),
+        region_(region),
+        ptr_(nullptr),
+        host_ptr_(nullptr),
+        size_(0),
+        reserved_size_(0),
+        chunk_size_(0),
+        frozen_(false) {
+    copy_signal_.handle = 0;
+  }
+  ~LazyCodeMemory() {}
+
+  void* Address(size_t offset = 0) const override {
+    assert(this->Allocated());
+    return (char*)ptr_ + offset;
+  }
+  void* HostAddress(size_t offset = 0) const override {
+    assert(this->Allocated());
+    return (char*)host_ptr_ + offset;
+  }
+  bool Allocated() const override { return nullptr != ptr_; }
+
+  bool Allocate(size_t size, size_t align, bool zero) override;
+  bool Copy(size_t offset, const void* src, size_t size) override;
+  void Free() override;
+  bool Defer(size_t offset, size_t size) override;
+  bool MakeResident(size_t offset, size_t size) override;
+  bool Freeze() override { return FreezeStart() && FreezeFinish(); }
+  bool FreezeStart() override;
+  bool FreezeFinish() override;
+
+private:
+  LazyCodeMemory(const LazyCodeMemory&);
+  LazyCodeMemory& operator=(const LazyCodeMemory&);
+
+  enum ChunkState : uint8_t {
+    kChunkAbsent,    // Not backed, loaded at freeze unless fully deferred.
+    kChunkRequired,  // Not backed, loaded at freeze.
+    kChunkResident
+  };
+
+  struct Mapping {
+    void* va;
+    size_t size;
+    hsa_amd_vmem_alloc_handle_t handle;
+  };
+
+  size_t ChunkBytes(size_t chunk) const {
+    return std::min(chunk_size_, size_ - chunk * chunk_size_);
+  }
+  // Backs chunks [first, first + count) and returns the copy that fills them.
+  bool MapChunks(size_t first, size_t count, hsa_amd_memory_copy_descriptor_t* copy);
+
+  const core::MemoryRegion* region_;
+  void* ptr_;
+  void* host_ptr_;
+  size_t size_;
+  size_t reserved_size_;
+  size_t chunk_size_;
+  bool frozen_;
+  std::vector<ChunkState> chunks_;
+  std::vector<size_t> deferred_bytes_;
+  std::vector<Mapping> mappings_;
+  hsa_signal_t copy_signal_;
+  KernelMutex lock_;
+};
+
+bool LazyCodeMemory::Allocate(size_t size, size_t align, bool zero) {
+  core::Runtime::MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_CODE_OBJECT);
+  assert(!this->Allocated());
+  assert(0 < size);
+  assert(0 < align && 0 == (align & (align - 1)));
+
+  // Chunks bound the granularity of residency, larger ones mean fewer buffer
+  // objects for the eagerly loaded parts.
+  const size_t page_size = static_cast<const AMD::MemoryRegion*>(region_)->GetPageSize();
+  chunk_size_ = AlignUp(size_t(64 * 1024), page_size);
+  reserved_size_ = AlignUp(size, chunk_size_);
+  if (HSA_STATUS_SUCCESS !=
+      core::Runtime::runtime_singleton_->VMemoryAddressReserve(
+          &ptr_, reserved_size_, 0, std::max(align, chunk_size_), 0)) {
+    ptr_ = nullptr;
+    return false;
+  }
+
+  if (HSA_STATUS_SUCCESS !=
+      core::Runtime::runtime_singleton_->AllocateMemory(
+          RegionMemory::System(false), size, core::MemoryRegion::AllocateNoFlags, &host_ptr_)) {
+    core::Runtime::runtime_singleton_->VMemoryAddressFree(ptr_, reserved_size_);
+    ptr_ = nullptr;
+    host_ptr_ = nullptr;
+    return false;
+  }
+  if (zero) {
+    memset(host_ptr_, 0x0, size);
+  }
+
+  size_ = size;
+  const size_t chunks = reserved_size_ / chunk_size_;
+  chunks_.assign(chunks, kChunkAbsent);
+  deferred_bytes_.assign(chunks, 0);
+  return true;
+}
+
+bool LazyCodeMemory::Copy(size_t offset, const void* src, size_t size) {
+  assert(this->Allocated());
+  assert(nullptr != src);
+  assert(0 < size);
+  memcpy((char*)host_ptr_ + offset, src, size);
+  return true;
+}
+
+void LazyCodeMemory::Free() {
+  assert(this->Allocated());
+  for (const Mapping& mapping : mappings_) {
+    core::Runtime::runtime_singleton_->VMemoryHandleUnmap(mapping.va, mapping.size);
+    core::Runtime::runtime_singleton_->VMemoryHandleRelease(mapping.handle);
+  }
+  mappings_.clear();
+  core::Runtime::runtime_singleton_->VMemoryAddressFree(ptr_, reserved_size_);
+  HSA::hsa_memory_free(host_ptr_);
+  ptr_ = nullptr;
+  host_ptr_ = nullptr;
+  size_ = 0;
+  chunks_.clear();
+  deferred_bytes_.clear();
+}
+
+bool LazyCodeMemory::Defer(size_t offset, size_t size) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  assert(!frozen_ && offset + size <= size_);
+
+  // Deferred ranges never overlap, so a chunk may stay absent once all of
+  // its bytes have been deferred.
+  const size_t end = offset + size;
+  while (offset < end) {
+    const size_t chunk = offset / chunk_size_;
+    const size_t chunk_end = std::min((chunk + 1) * chunk_size_, end);
+    deferred_bytes_[chunk] += chunk_end - offset;
+    offset = chunk_end;
+  }
+  return true;
+}
+
+bool LazyCodeMemory::MapChunks(size_t first, size_t count,
+                               hsa_amd_memory_copy_descriptor_t* copy) {
+  core::Runtime* runtime = core::Runtime::runtime_singleton_;
+  Mapping mapping;
+  mapping.va = (char*)ptr_ + first * chunk_size_;
+  mapping.size = count * chunk_size_;
+
+  if (HSA_STATUS_SUCCESS !=
+      runtime->VMemoryHandleCreate(
+          region_, mapping.size,
+          core::MemoryRegion::AllocateMemoryOnly | core::MemoryRegion::AllocateExecutable, 0,
+          &mapping.handle)) {
+    return false;
+  }
+  if (HSA_STATUS_SUCCESS != runtime->VMemoryHandleMap(mapping.va, mapping.size, 0,
+                                                      mapping.handle, 0)) {
+    runtime->VMemoryHandleRelease(mapping.handle);
+    return false;
+  }
+  hsa_amd_memory_access_desc_t access = {HSA_ACCESS_PERMISSION_RW,
+                                         region_->owner()->public_handle()};
+  if (HSA_STATUS_SUCCESS != runtime->VMemorySetAccess(mapping.va, mapping.size, &access, 1)) {
+    runtime->VMemoryHandleUnmap(mapping.va, mapping.size);
+    runtime->VMemoryHandleRelease(mapping.handle);
+    return false;
+  }
+  mappings_.push_back(mapping);
+
+  for (size_t i = first; i < first + count; ++i) chunks_[i] = kChunkResident;
+
+  const size_t offset = first * chunk_size_;
+  copy->dst = mapping.va;
+  copy->src = (char*)host_ptr_ + offset;
+  copy->size = std::min(mapping.size, size_ - offset);
+  return true;
+}
+
+bool LazyCodeMemory::MakeResident(size_t offset, size_t size) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  assert(offset + size <= size_);
+  if (size == 0) return true;
+
+  const size_t first = offset / chunk_size_;
+  const size_t last = (offset + size - 1) / chunk_size_;
+  if (!frozen_) {
+    for (size_t i = first; i <= last; ++i) chunks_[i] = kChunkRequired;
+    return true;
+  }
+
+  core::Agent* agent = region_->owner();
+  size_t uploaded_first = last + 1, uploaded_end = first;
+  for (size_t i = first; i <= last;) {
+    if (chunks_[i] == kChunkResident) {
+      ++i;
+      continue;
+    }
+    size_t count = 1;
+    while (i + count <= last && chunks_[i + count] != kChunkResident) ++count;
+
+    hsa_amd_memory_copy_descriptor_t copy;
+    if (!MapChunks(i, count, &copy)) return false;
+    if (HSA_STATUS_SUCCESS != agent->DmaCopy(copy.dst, copy.src, copy.size)) return false;
+    uploaded_first = std::min(uploaded_first, i);
+    uploaded_end = i + count;
+    i += count;
+  }
 
+  if (uploaded_first < uploaded_end) {
+    static_cast<AMD::GpuAgent*>(agent)->InvalidateCodeCaches(
+        Address(uploaded_first * chunk_size_), (uploaded_end - uploaded_first) * chunk_size_);
+  }
+  return true;
+}
+
+bool LazyCodeMemory::FreezeStart() {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  assert(this->Allocated() && !frozen_);
+  assert(copy_signal_.handle == 0);
+  frozen_ = true;
+
+  // Back the runs of chunks which hold anything not deferred.
+  std::vector<hsa_amd_memory_copy_descriptor_t> copies;
+  const size_t chunks = chunks_.size();
+  for (size_t i = 0; i < chunks;) {
+    const auto needed = [&](size_t chunk) {
+      return chunks_[chunk] == kChunkRequired || deferred_bytes_[chunk] < ChunkBytes(chunk);
+    };
+    if (!needed(i)) {
+      ++i;
+      continue;
+    }
+    size_t count = 1;
+    while (i + count < chunks && needed(i + count)) ++count;
+
+    hsa_amd_memory_copy_descriptor_t copy;
+    if (!MapChunks(i, count, &copy)) return false;
+    copies.push_back(copy);
+    i += count;
+  }
+  if (copies.empty()) return true;
+
+  core::Agent* agent = region_->owner();
+  if (HSA_STATUS_SUCCESS == HSA::hsa_signal_create(1, 0, NULL, &copy_signal_)) {
+    std::vector<core::Signal*> dep_signals;
+    core::Agent* host_agent = RegionMemory::System(false)->owner();
+    if (HSA_STATUS_SUCCESS ==
+        core::Runtime::runtime_singleton_->CopyMemoryBatch(
+            copies.data(), uint32_t(copies.size()), agent, host_agent, dep_signals,
+            *core::Signal::Convert(copy_signal_))) {
+      return true;
+    }
+    HSA::hsa_signal_destroy(copy_signal_);
+    copy_signal_.handle = 0;
+  }
+
+  for (const hsa_amd_memory_copy_descriptor_t& copy : copies) {
+    if (HSA_STATUS_SUCCESS != agent->DmaCopy(copy.dst, copy.src, copy.size)) return false;
+  }
+  return true;
+}
+
+bool LazyCodeMemory::FreezeFinish() {
+  if (copy_signal_.handle != 0) {
+    HSA::hsa_signal_wait_scacquire(copy_signal_, HSA_SIGNAL_CONDITION_EQ, 0, UINT64_MAX,
+                                   HSA_WAIT_STATE_BLOCKED);
+    HSA::hsa_signal_destroy(copy_signal_);
+    copy_signal_.handle = 0;
+  }
+  static_cast<AMD::GpuAgent*>(region_->owner())->InvalidateCodeCaches(ptr_, size_);
   return true;
 }
 
@@ -457,6 +896,12 @@ void* LoaderContext::SegmentAlloc(amdgpu_hsa_elf_segment_t segment,
   case AMDGPU_HSA_SEGMENT_CODE_AGENT: {
     switch (agent_profile) {
     case HSA_PROFILE_BASE:
+      if (core::Runtime::runtime_singleton_->flag().loader_lazy_code() &&
+          core::Runtime::runtime_singleton_->VirtualMemApiSupported() &&
+          size >= LazyCodeMemory::kMinSize) {
+        mem = new (std::nothrow) LazyCodeMemory(RegionMemory::AgentLocal(agent, true));
+        break;
+      }
       mem = new (std::nothrow) RegionMemory(RegionMemory::AgentLocal(agent, true), true);
       break;
     case HSA_PROFILE_FULL:
@@ -533,6 +978,53 @@ bool LoaderContext::SegmentFreeze(amdgpu_hsa_elf_segment_t segment, // not used.
   return ((SegmentMemory*)seg)->Freeze();
 }
 
+bool LoaderContext::SegmentDefer(amdgpu_hsa_elf_segment_t segment, // not used.
+                                 hsa_agent_t agent,                // not used.
+                                 void* seg,
+                                 size_t offset,
+                                 size_t size)
+{
+  assert(nullptr != seg);
+  return ((SegmentMemory*)seg)->Defer(offset, size);
+}
+
+bool LoaderContext::SegmentMakeResident(amdgpu_hsa_elf_segment_t segment, // not used.
+                                        hsa_agent_t agent,                // not used.
+                                        void* seg,
+                                        size_t offset,
+                                        size_t size)
+{
+  assert(nullptr != seg);
+  return ((SegmentMemory*)seg)->MakeResident(offset, size);
+}
+
+bool LoaderContext::SegmentFreezeStart(amdgpu_hsa_elf_segment_t segment, // not used.
+                                       hsa_agent_t agent,                // not used.
+                                       void* seg,
+                                       size_t size)                      // not used.
+{
+  assert(nullptr != seg);
+  return ((SegmentMemory*)seg)->FreezeStart();
+}
+
+bool LoaderContext::SegmentUpload(amdgpu_hsa_elf_segment_t segment, // not used.
+                                  hsa_agent_t agent,                // not used.
+                                  void* seg,
+                                  size_t size)                      // not used.
+{
+  assert(nullptr != seg);
+  return ((SegmentMemory*)seg)->Upload();
+}
+
+bool LoaderContext::SegmentFreezeFinish(amdgpu_hsa_elf_segment_t segment, // not used.
+                                        hsa_agent_t agent,                // not used.
+                                        void* seg,
+                                        size_t size)                      // not used.
+{
+  assert(nullptr != seg);
+  return ((SegmentMemory*)seg)->FreezeFinish();
+}
+
 bool LoaderContext::ImageExtensionSupported() {
   hsa_status_t hsa_status = HSA_STATUS_SUCCESS;
   bool result = false;
@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/inc/amd_lock_cache.h"
+
+#include <algorithm>
+#include <unistd.h>
+
+#include "core/inc/amd_memory_region.h"
+
+namespace rocr {
+namespace AMD {
+
+static size_t PageSize() {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
+bool LockCache::Acquire(const void* owner, void* ptr, size_t size,
+                        const std::vector<uint32_t>& nodes, void** agent_ptr) {
+  const uintptr_t start = AlignDown(reinterpret_cast<uintptr_t>(ptr), PageSize());
+  const uintptr_t end = AlignUp(reinterpret_cast<uintptr_t>(ptr) + size, PageSize());
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  if (entries_.empty()) return false;
+
+  // Any covering registration has a base below end and within max_extent_ of start.
+  auto it = entries_.lower_bound(end);
+  while (it != entries_.begin()) {
+    --it;
+    Entry* entry = it->second;
+    if (entry->base + max_extent_ <= start) break;
+    if (entry->stale || entry->owner != owner || entry->start > start || entry->end < end)
+      continue;
+    bool mapped = std::all_of(nodes.begin(), nodes.end(), [&](uint32_t node) {
+      return std::find(entry->nodes.begin(), entry->nodes.end(), node) != entry->nodes.end();
+    });
+    if (!mapped) continue;
+
+    auto handle = handles_.find(reinterpret_cast<uintptr_t>(ptr));
+    if (handle != handles_.end()) {
+      // The same address may only be held through one registration.
+      if (handle->second.first != entry) continue;
+      handle->second.second++;
+    } else {
+      handles_[reinterpret_cast<uintptr_t>(ptr)] = std::make_pair(entry, 1u);
+    }
+
+    if (entry->refs++ == 0) {
+      lru_.erase(entry->lru);
+      entry->lru = lru_.end();
+    }
+    *agent_ptr = reinterpret_cast<void*>(entry->agent_base +
+                                         (reinterpret_cast<uintptr_t>(ptr) - entry->base));
+    return true;
+  }
+  return false;
+}
+
+bool LockCache::Insert(const void* owner, void* ptr, size_t size,
+                       const std::vector<uint32_t>& nodes, void* agent_ptr) {
+  const uintptr_t base = reinterpret_cast<uintptr_t>(ptr);
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  // An address already held through another registration stays uncached.
+  if (entries_.find(base) != entries_.end() || handles_.find(base) != handles_.end())
+    return false;
+
+  Entry* entry = new Entry();
+  entry->owner = owner;
+  entry->base = base;
+  entry->size = size;
+  entry->start = AlignDown(base, PageSize());
+  entry->end = AlignUp(base + size, PageSize());
+  entry->nodes = nodes;
+  entry->agent_base = reinterpret_cast<uintptr_t>(agent_ptr);
+  entry->refs = 1;
+  entry->stale = false;
+  entry->lru = lru_.end();
+
+  entries_[base] = entry;
+  handles_[base] = std::make_pair(entry, 1u);
+  max_extent_ = std::max(max_extent_, size_t(entry->end - base));
+  return true;
+}
+
+bool LockCache::Release(void* ptr, size_t capacity) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  auto handle = handles_.find(reinterpret_cast<uintptr_t>(ptr));
+  if (handle == handles_.end()) return false;
+
+  Entry* entry = handle->second.first;
+  if (--handle->second.second == 0) handles_.erase(handle);
+  if (--entry->refs != 0) return true;
+
+  if (entry->stale || capacity == 0) {
+    Destroy(entry);
+    return true;
+  }
+
+  lru_.push_front(entry);
+  entry->lru = lru_.begin();
+  while (lru_.size() > capacity) Destroy(lru_.back());
+  return true;
+}
+
+template <typename Pred> void LockCache::Sweep(const void* ptr, size_t size, Pred pred) {
+  const uintptr_t start = AlignDown(reinterpret_cast<uintptr_t>(ptr), PageSize());
+  const uintptr_t end = AlignUp(reinterpret_cast<uintptr_t>(ptr) + size, PageSize());
+
+  auto it = entries_.lower_bound(end);
+  while (it != entries_.begin()) {
+    --it;
+    Entry* entry = it->second;
+    if (entry->base + max_extent_ <= start) break;
+    if (entry->end <= start || entry->start >= end) continue;
+    if (entry->refs == 0) {
+      // Destroy erases the current element, continue from its successor.
+      it = entries_.upper_bound(entry->base);
+      Destroy(entry);
+      continue;
+    }
+    pred(entry);
+  }
+}
+
+void LockCache::Evict(const void* ptr, size_t size) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  Sweep(ptr, size, [](Entry*) {});
+}
+
+void LockCache::Invalidate(const void* ptr, size_t size) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  Sweep(ptr, size, [](Entry* entry) { entry->stale = true; });
+}
+
+void LockCache::Flush() {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  handles_.clear();
+  while (!entries_.empty()) {
+    Entry* entry = entries_.begin()->second;
+    entry->refs = 0;
+    Destroy(entry);
+  }
+  lru_.clear();
+  max_extent_ = 0;
+}
+
+void LockCache::Destroy(Entry* entry) {
+  MemoryRegion::MakeKfdMemoryUnresident(reinterpret_cast<void*>(entry->base));
+  MemoryRegion::DeregisterMemory(reinterpret_cast<void*>(entry->base));
+
+  if (entry->lru != lru_.end()) lru_.erase(entry->lru);
+  entries_.erase(entry->base);
+  delete entry;
+}
+
+}  // namespace AMD
+}  // namespace rocr
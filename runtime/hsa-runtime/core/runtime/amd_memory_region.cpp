@@ -57,6 +57,8 @@ namespace AMD {
 // Tracks aggregate size of system memory available on platform
 size_t MemoryRegion::max_sysmem_alloc_size_ = 0;
 
+LockCache MemoryRegion::lock_cache_;
+
 bool MemoryRegion::RegisterMemory(void* ptr, size_t size, const HsaMemFlags& MemFlags) {
   assert(ptr != NULL);
   assert(size != 0);
@@ -80,11 +82,29 @@ bool MemoryRegion::MakeKfdMemoryResident(size_t num_node, const uint32_t* nodes,
   return (status == HSAKMT_STATUS_SUCCESS);
 }
 
+bool MemoryRegion::MakeKfdMemoryResident(size_t num_node, const uint32_t* nodes,
+                                         const HsaMemoryRange* ranges, size_t num_ranges,
+                                         HsaMemMapFlags map_flag) {
+  assert(num_node > 0);
+  assert(nodes != NULL);
+
+  const HSAKMT_STATUS status =
+      hsaKmtMapMemoryToGPUNodesBatch(const_cast<HsaMemoryRange*>(ranges), num_ranges, map_flag,
+                                     num_node, const_cast<uint32_t*>(nodes));
+
+  return (status == HSAKMT_STATUS_SUCCESS);
+}
+
 bool MemoryRegion::MakeKfdMemoryUnresident(const void* ptr) {
   const HSAKMT_STATUS status = hsaKmtUnmapMemoryToGPU(const_cast<void*>(ptr));
   return (status == HSAKMT_STATUS_SUCCESS);
 }
 
+bool MemoryRegion::MakeKfdMemoryUnresident(void** ptrs, size_t num_ptrs) {
+  const HSAKMT_STATUS status = hsaKmtUnmapMemoryToGPUBatch(ptrs, num_ptrs);
+  return (status == HSAKMT_STATUS_SUCCESS);
+}
+
 MemoryRegion::MemoryRegion(bool fine_grain, bool kernarg, bool full_profile,
                            bool extended_scope_fine_grain, bool user_visible, core::Agent* owner,
                            const HsaMemoryProperties& mem_props)
@@ -93,7 +113,8 @@ MemoryRegion::MemoryRegion(bool fine_grain, bool kernarg, bool full_profile,
       mem_props_(mem_props),
       max_single_alloc_size_(0),
       virtual_size_(0),
-      fragment_allocator_(BlockAllocator(*this)) {
+      fragment_allocator_(BlockAllocator(*this)),
+      slab_allocator_(SlabAllocator(*this)) {
   virtual_size_ = GetPhysicalSize();
 
   // extended_scope_fine_grain and fine_grain memory regions are mutually exclusive
@@ -154,6 +175,18 @@ MemoryRegion::MemoryRegion(bool fine_grain, bool kernarg, bool full_profile,
 MemoryRegion::~MemoryRegion() {}
 
 hsa_status_t MemoryRegion::Allocate(size_t& size, AllocateFlags alloc_flags, void** address, int agent_node_id) const {
+  // Small ordinary VRAM allocations are served by the slab layer without taking the region lock.
+  // Mirrors the conditions for sub-allocation in the driver.
+  if (address != nullptr && size != 0 && size <= SlabHeap<SlabAllocator>::kMaxSize &&
+      IsLocalMemory() && ((alloc_flags & ~AllocateRestrict) == 0) &&
+      !core::Runtime::runtime_singleton_->flag().disable_fragment_alloc() &&
+      !core::Runtime::runtime_singleton_->flag().disable_slab_alloc()) {
+    size = AlignUp(size, kPageSize());
+    *address = slab_allocator_.alloc(size);
+    assert(*address != nullptr && "Slab allocation failed, allocator is expected to throw.");
+    return HSA_STATUS_SUCCESS;
+  }
+
   ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
   return AllocateImpl(size, alloc_flags, address, agent_node_id);
 }
@@ -176,16 +209,45 @@ hsa_status_t MemoryRegion::AllocateImpl(size_t& size, AllocateFlags alloc_flags,
   }
 
   size = AlignUp(size, kPageSize());
+  if (IsSystem() && (alloc_flags & AllocateHugePage)) size = AlignUp(size, 2 * 1024 * 1024);
+
+  // Large VRAM allocations default to large pages, the padding is small relative to the size.
+  // Requests which a reservation may serve are left to the fragment allocator, reserved blocks
+  // themselves are direct.
+  if (IsLocalMemory() && ((alloc_flags & AllocateMemoryOnly) == 0)) {
+    const size_t threshold = core::Runtime::runtime_singleton_->flag().large_page_threshold();
+    if ((threshold != 0) && (size >= threshold) &&
+        ((alloc_flags & AllocateDirect) || (fragment_allocator_.reserved_size() == 0)))
+      alloc_flags |= AllocateLargePage;
+    if (alloc_flags & AllocateLargePage) size = AlignUp(size, kLargePageSize);
+  }
 
   return owner()->driver().AllocateMemory(*this, alloc_flags, address, size,
                                           agent_node_id);
 }
 
 hsa_status_t MemoryRegion::Free(void* address, size_t size) const {
+  if (slab_allocator_.free(address)) return HSA_STATUS_SUCCESS;
+
   ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
   return FreeImpl(address, size);
 }
 
+void MemoryRegion::FreeBatch(const std::vector<std::pair<void*, size_t>>& blocks,
+                             std::vector<void*>& failed) const {
+  std::vector<const std::pair<void*, size_t>*> remaining;
+  for (auto& block : blocks) {
+    if (!slab_allocator_.free(block.first)) remaining.push_back(&block);
+  }
+  if (remaining.empty()) return;
+
+  // One lock acquisition covers the whole batch of unmaps and driver frees.
+  ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
+  for (auto block : remaining) {
+    if (FreeImpl(block->first, block->second) != HSA_STATUS_SUCCESS) failed.push_back(block->first);
+  }
+}
+
 hsa_status_t MemoryRegion::FreeImpl(void* address, size_t size) const {
   if (fragment_allocator_.free(address)) return HSA_STATUS_SUCCESS;
 
@@ -371,6 +433,53 @@ hsa_status_t MemoryRegion::GetPoolInfo(hsa_amd_memory_pool_info_t attribute,
           break;
       }
       break;
+    case HSA_AMD_MEMORY_POOL_INFO_SLAB_CACHE_HITS:
+      *((uint64_t*)value) = slab_allocator_.hits();
+      break;
+    case HSA_AMD_MEMORY_POOL_INFO_SLAB_CACHE_MISSES:
+      *((uint64_t*)value) = slab_allocator_.misses();
+      break;
+    case HSA_AMD_MEMORY_POOL_INFO_SLAB_RESERVED_SIZE:
+      *((size_t*)value) = slab_allocator_.reserved_size();
+      break;
+    case HSA_AMD_MEMORY_POOL_INFO_SLAB_ALLOCATED_SIZE:
+      *((size_t*)value) = slab_allocator_.allocated_size();
+      break;
+    case HSA_AMD_MEMORY_POOL_INFO_FRAGMENT_FREE_SIZE: {
+      ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
+      *((size_t*)value) = fragment_allocator_.free_size();
+      break;
+    }
+    case HSA_AMD_MEMORY_POOL_INFO_RESERVED_SIZE:
+      *((size_t*)value) = fragment_allocator_.reserved_size();
+      break;
+    case HSA_AMD_MEMORY_POOL_INFO_FRAGMENTATION: {
+      hsa_amd_memory_pool_fragmentation_t* frag =
+          reinterpret_cast<hsa_amd_memory_pool_fragmentation_t*>(value);
+      ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
+      const auto stats = fragment_allocator_.stats();
+      frag->free_size = stats.free_size;
+      frag->largest_free_size = stats.largest_free;
+      frag->free_fragments = stats.free_fragments;
+      frag->blocks = stats.blocks;
+      frag->cached_blocks = stats.cache_blocks;
+      frag->cache_size = stats.cache_size;
+      break;
+    }
+    case HSA_AMD_MEMORY_POOL_INFO_USAGE: {
+      hsa_amd_memory_pool_usage_t* usage = reinterpret_cast<hsa_amd_memory_pool_usage_t*>(value);
+      GetUsage(usage);
+      // Read without the memory lock, like GetCacheSize, so polling never stalls allocation.
+      usage->bytes[HSA_AMD_MEMORY_USAGE_FRAGMENT_CACHE] = fragment_allocator_.cache_size();
+      usage->count[HSA_AMD_MEMORY_USAGE_FRAGMENT_CACHE] = fragment_allocator_.cache_blocks();
+      if (IsLocalMemory() && !fine_grain() &&
+          (owner()->device_type() == core::Agent::kAmdGpuDevice)) {
+        static_cast<GpuAgent*>(owner())->ScratchUsage(
+            &usage->bytes[HSA_AMD_MEMORY_USAGE_SCRATCH],
+            &usage->count[HSA_AMD_MEMORY_USAGE_SCRATCH]);
+      }
+      break;
+    }
     default:
       return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   }
@@ -464,98 +573,172 @@ hsa_status_t MemoryRegion::GetAgentPoolInfo(
 hsa_status_t MemoryRegion::AllowAccess(uint32_t num_agents,
                                        const hsa_agent_t* agents,
                                        const void* ptr, size_t size) const {
-  if (num_agents == 0 || agents == NULL || ptr == NULL || size == 0) {
+  HsaMemoryRange range = {const_cast<void*>(ptr), size};
+  return AllowAccess(num_agents, agents, &range, 1);
+}
+
+hsa_status_t MemoryRegion::AllowAccess(uint32_t num_agents, const hsa_agent_t* agents,
+                                       const HsaMemoryRange* ranges, size_t num_ranges) const {
+  if (num_agents == 0 || agents == NULL || ranges == NULL || num_ranges == 0) {
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
+  for (size_t i = 0; i < num_ranges; ++i) {
+    if (ranges[i].MemoryAddress == NULL || ranges[i].SizeInBytes == 0)
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
   if (!IsSystem() && !IsLocalMemory()) {
     return HSA_STATUS_ERROR;
   }
 
-  // Adjust for fragments.  Make accessibility sticky for fragments since this will satisfy the
-  // union of accessible agents between the fragments in the block.
-  hsa_amd_pointer_info_t info;
-  uint32_t agent_count = 0;
-  hsa_agent_t* accessible = nullptr;
-  MAKE_SCOPE_GUARD([&]() { free(accessible); });
-  core::Runtime::PtrInfoBlockData blockInfo;
-  std::vector<uint64_t> union_agents;
-  info.size = sizeof(info);
+  // Consecutive ranges with the same nodes and flags are mapped in one call.
+  std::vector<HsaMemoryRange> batch;
+  std::vector<uint32_t> batch_nodes;
+  HsaMemMapFlags batch_flag = map_flag_;
+  std::vector<void*> unresident;
+
+  auto flush = [&]() {
+    // Sequence with pointer info since queries to other fragments of the block may be adjusted by
+    // this call.  Pointer info queries hold the lock shared.
+    ScopedAcquire<KernelSharedMutex> lock(&core::Runtime::runtime_singleton_->memory_lock_);
+    bool resident;
+    if (batch.size() == 1) {
+      uint64_t alternate_va = 0;
+      resident = AMD::MemoryRegion::MakeKfdMemoryResident(
+          batch_nodes.size(), &batch_nodes[0], batch[0].MemoryAddress, batch[0].SizeInBytes,
+          &alternate_va, batch_flag);
+    } else {
+      resident = AMD::MemoryRegion::MakeKfdMemoryResident(batch_nodes.size(), &batch_nodes[0],
+                                                          &batch[0], batch.size(), batch_flag);
+    }
+    batch.clear();
+    return resident;
+  };
 
   ScopedAcquire<KernelMutex> lock(&access_lock_);
 
-  if (core::Runtime::runtime_singleton_->PtrInfo(const_cast<void*>(ptr), &info, malloc,
-                                                 &agent_count, &accessible,
-                                                 &blockInfo) == HSA_STATUS_SUCCESS) {
-    /*  Thunk may return type = HSA_EXT_POINTER_TYPE_UNKNOWN for userptrs */
-    if (info.type != HSA_EXT_POINTER_TYPE_UNKNOWN &&
-        (blockInfo.length != size || info.sizeInBytes != size)) {
-      for (int i = 0; i < num_agents; i++) union_agents.push_back(agents[i].handle);
-      for (int i = 0; i < agent_count; i++) union_agents.push_back(accessible[i].handle);
-      std::sort(union_agents.begin(), union_agents.end());
-      const auto& last = std::unique(union_agents.begin(), union_agents.end());
-      union_agents.erase(last, union_agents.end());
-
-      agents = reinterpret_cast<hsa_agent_t*>(&union_agents[0]);
-      num_agents = union_agents.size();
-      size = blockInfo.length;
-      ptr = blockInfo.base;
+  for (size_t r = 0; r < num_ranges; ++r) {
+    const void* ptr = ranges[r].MemoryAddress;
+    size_t size = ranges[r].SizeInBytes;
+    const hsa_agent_t* range_agents = agents;
+    uint32_t range_num_agents = num_agents;
+
+    // Adjust for fragments.  Make accessibility sticky for fragments since this will satisfy the
+    // union of accessible agents between the fragments in the block.
+    hsa_amd_pointer_info_t info;
+    uint32_t agent_count = 0;
+    hsa_agent_t* accessible = nullptr;
+    MAKE_SCOPE_GUARD([&]() { free(accessible); });
+    core::Runtime::PtrInfoBlockData blockInfo;
+    std::vector<uint64_t> union_agents;
+    // GPU nodes the thunk has the range mapped to, valid when mapped_known.
+    std::vector<uint32_t> mapped_nodes;
+    bool mapped_known = false;
+    info.size = sizeof(info);
+
+    if (core::Runtime::runtime_singleton_->PtrInfo(const_cast<void*>(ptr), &info, malloc,
+                                                   &agent_count, &accessible,
+                                                   &blockInfo) == HSA_STATUS_SUCCESS) {
+      if (info.type != HSA_EXT_POINTER_TYPE_UNKNOWN) {
+        for (uint32_t i = 0; i < agent_count; i++) {
+          const core::Agent* agent = core::Agent::Convert(accessible[i]);
+          if (agent->device_type() == core::Agent::kAmdGpuDevice)
+            mapped_nodes.push_back(agent->node_id());
+        }
+        std::sort(mapped_nodes.begin(), mapped_nodes.end());
+        mapped_nodes.erase(std::unique(mapped_nodes.begin(), mapped_nodes.end()),
+                           mapped_nodes.end());
+        mapped_known = true;
+      }
+
+      /*  Thunk may return type = HSA_EXT_POINTER_TYPE_UNKNOWN for userptrs */
+      if (info.type != HSA_EXT_POINTER_TYPE_UNKNOWN &&
+          (blockInfo.length != size || info.sizeInBytes != size)) {
+        for (int i = 0; i < num_agents; i++) union_agents.push_back(agents[i].handle);
+        for (int i = 0; i < agent_count; i++) union_agents.push_back(accessible[i].handle);
+        std::sort(union_agents.begin(), union_agents.end());
+        const auto& last = std::unique(union_agents.begin(), union_agents.end());
+        union_agents.erase(last, union_agents.end());
+
+        range_agents = reinterpret_cast<hsa_agent_t*>(&union_agents[0]);
+        range_num_agents = union_agents.size();
+        size = blockInfo.length;
+        ptr = blockInfo.base;
+      }
     }
-  }
 
-  bool cpu_in_list = false;
+    bool cpu_in_list = false;
 
-  std::vector<uint32_t> whitelist_nodes;
-  for (uint32_t i = 0; i < num_agents; ++i) {
-    core::Agent* agent = core::Agent::Convert(agents[i]);
-    if (agent == NULL || !agent->IsValid()) {
-      return HSA_STATUS_ERROR_INVALID_AGENT;
+    std::vector<uint32_t> whitelist_nodes;
+    for (uint32_t i = 0; i < range_num_agents; ++i) {
+      core::Agent* agent = core::Agent::Convert(range_agents[i]);
+      if (agent == NULL || !agent->IsValid()) {
+        return HSA_STATUS_ERROR_INVALID_AGENT;
+      }
+
+      switch (agent->device_type()) {
+      case core::Agent::kAmdGpuDevice:
+        whitelist_nodes.push_back(agent->node_id());
+        break;
+      case core::Agent::kAmdCpuDevice:
+        cpu_in_list = true;
+        break;
+      case core::Agent::kAmdAieDevice:
+      default:
+        return HSA_STATUS_ERROR_INVALID_AGENT;
+      }
     }
 
-    switch (agent->device_type()) {
-    case core::Agent::kAmdGpuDevice:
-      whitelist_nodes.push_back(agent->node_id());
-      break;
-    case core::Agent::kAmdCpuDevice:
-      cpu_in_list = true;
-      break;
-    case core::Agent::kAmdAieDevice:
-    default:
-      return HSA_STATUS_ERROR_INVALID_AGENT;
+    if (whitelist_nodes.size() == 0 && IsSystem()) {
+      assert(cpu_in_list);
+      // This is a system region and only CPU agents in the whitelist.
+      // Remove old mappings.
+      unresident.push_back(const_cast<void*>(ptr));
+      continue;
     }
-  }
 
-  if (whitelist_nodes.size() == 0 && IsSystem()) {
-    assert(cpu_in_list);
-    // This is a system region and only CPU agents in the whitelist.
-    // Remove old mappings.
-    AMD::MemoryRegion::MakeKfdMemoryUnresident(ptr);
-    return HSA_STATUS_SUCCESS;
-  }
+    // If this is a local memory region, the owning gpu always needs to be in
+    // the whitelist.
+    if (IsLocalMemory() &&
+        std::find(whitelist_nodes.begin(), whitelist_nodes.end(), owner()->node_id()) ==
+            whitelist_nodes.end()) {
+      whitelist_nodes.push_back(owner()->node_id());
+    }
 
-  // If this is a local memory region, the owning gpu always needs to be in
-  // the whitelist.
-  if (IsLocalMemory() &&
-      std::find(whitelist_nodes.begin(), whitelist_nodes.end(), owner()->node_id()) ==
-          whitelist_nodes.end()) {
-    whitelist_nodes.push_back(owner()->node_id());
-  }
+    HsaMemMapFlags map_flag = map_flag_;
+    map_flag.ui32.HostAccess |= (cpu_in_list) ? 1 : 0;
+
+    // Skip ranges already mapped to exactly the requested GPUs, repeated grants are common and each
+    // re-map walks the whole allocation in the driver.  Host access to device memory can't be read
+    // back from the thunk so those grants are always applied.
+    if (mapped_known && (!cpu_in_list || IsSystem())) {
+      std::vector<uint32_t> wanted(whitelist_nodes);
+      std::sort(wanted.begin(), wanted.end());
+      wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+      if (wanted == mapped_nodes) continue;
+    }
 
-  HsaMemMapFlags map_flag = map_flag_;
-  map_flag.ui32.HostAccess |= (cpu_in_list) ? 1 : 0;
+    if (!batch.empty() && (whitelist_nodes != batch_nodes || map_flag.Value != batch_flag.Value)) {
+      if (!flush()) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+    }
 
-  {  // Sequence with pointer info since queries to other fragments of the block may be adjusted by
-     // this call.
-    ScopedAcquire<KernelSharedMutex::Shared> lock(
-        core::Runtime::runtime_singleton_->memory_lock_.shared());
-    uint64_t alternate_va = 0;
-    if (!AMD::MemoryRegion::MakeKfdMemoryResident(
-      whitelist_nodes.size(), &whitelist_nodes[0], ptr,
-      size, &alternate_va, map_flag)) {
-        return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+    if (batch.empty()) {
+      batch_nodes.swap(whitelist_nodes);
+      batch_flag = map_flag;
     }
+    HsaMemoryRange range = {const_cast<void*>(ptr), size};
+    batch.push_back(range);
   }
 
+  if (unresident.size() == 1) {
+    AMD::MemoryRegion::MakeKfdMemoryUnresident(unresident[0]);
+  } else if (!unresident.empty()) {
+    AMD::MemoryRegion::MakeKfdMemoryUnresident(&unresident[0], unresident.size());
+  }
+
+  if (!batch.empty() && !flush()) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
   return HSA_STATUS_SUCCESS;
 }
 
@@ -616,6 +799,14 @@ hsa_status_t MemoryRegion::Lock(uint32_t num_agents, const hsa_agent_t* agents,
     return HSA_STATUS_SUCCESS;
   }
 
+  const bool use_cache = core::Runtime::runtime_singleton_->flag().memory_lock_cache_size() != 0;
+  if (use_cache) {
+    if (lock_cache_.Acquire(this, host_ptr, size, whitelist_nodes, agent_ptr))
+      return HSA_STATUS_SUCCESS;
+    // Retire idle registrations of these pages so they aren't registered twice.
+    lock_cache_.Evict(host_ptr, size);
+  }
+
   // Call kernel driver to register and pin the memory.
   if (RegisterMemory(host_ptr, size, mem_flag_)) {
     uint64_t alternate_va = 0;
@@ -627,6 +818,7 @@ hsa_status_t MemoryRegion::Lock(uint32_t num_agents, const hsa_agent_t* agents,
         *agent_ptr = host_ptr;
       }
 
+      if (use_cache) lock_cache_.Insert(this, host_ptr, size, whitelist_nodes, *agent_ptr);
       return HSA_STATUS_SUCCESS;
     }
     AMD::MemoryRegion::DeregisterMemory(host_ptr);
@@ -645,6 +837,10 @@ hsa_status_t MemoryRegion::Unlock(void* host_ptr) const {
     return HSA_STATUS_SUCCESS;
   }
 
+  if (lock_cache_.Release(
+          host_ptr, core::Runtime::runtime_singleton_->flag().memory_lock_cache_size()))
+    return HSA_STATUS_SUCCESS;
+
   MakeKfdMemoryUnresident(host_ptr);
   DeregisterMemory(host_ptr);
 
@@ -659,6 +855,41 @@ hsa_status_t MemoryRegion::AssignAgent(void* ptr, size_t size,
 
 void MemoryRegion::Trim() const { fragment_allocator_.trim(); }
 
+void MemoryRegion::TrimIdle(uint64_t idle_ms) const {
+  fragment_allocator_.trimIdle(std::chrono::milliseconds(idle_ms));
+}
+
+hsa_status_t MemoryRegion::Reserve(size_t size) const {
+  // Reservations are served by the fragment allocator, which only handles device memory.
+  if (!IsLocalMemory() || core::Runtime::runtime_singleton_->flag().disable_fragment_alloc())
+    return static_cast<hsa_status_t>(HSA_STATUS_ERROR_INVALID_MEMORY_POOL);
+
+  ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
+  // Throws on failure, like fragment_alloc.
+  fragment_allocator_.reserve(size);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t MemoryRegion::ReleaseReservation() const {
+  if (!IsLocalMemory() || core::Runtime::runtime_singleton_->flag().disable_fragment_alloc())
+    return static_cast<hsa_status_t>(HSA_STATUS_ERROR_INVALID_MEMORY_POOL);
+
+  ScopedAcquire<KernelMutex> lock(&owner()->agent_memory_lock_);
+  fragment_allocator_.unreserve();
+  return HSA_STATUS_SUCCESS;
+}
+
+void* MemoryRegion::SlabAllocator::alloc(size_t size) const {
+  ScopedAcquire<KernelMutex> lock(&region_.owner()->agent_memory_lock_);
+  return region_.fragment_allocator_.alloc(size);
+}
+
+void MemoryRegion::SlabAllocator::free(void* ptr) const {
+  ScopedAcquire<KernelMutex> lock(&region_.owner()->agent_memory_lock_);
+  bool err = region_.fragment_allocator_.free(ptr);
+  assert(err && "Slab not owned by the fragment allocator.");
+}
+
 void* MemoryRegion::BlockAllocator::alloc(size_t request_size, size_t& allocated_size) const {
   void* ret;
   size_t bsize = AlignUp(request_size, block_size());
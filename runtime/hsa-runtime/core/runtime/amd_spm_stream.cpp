@@ -0,0 +1,263 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+#include "core/inc/amd_spm_stream.h"
+
+#include <string.h>
+
+#include "hsakmt/hsakmt.h"
+#include "core/inc/amd_gpu_agent.h"
+
+namespace rocr {
+namespace AMD {
+
+namespace {
+
+// Longest time a partially filled buffer is held before it is handed over.
+const uint32_t kSwapIntervalMs = 100;
+
+const uint32_t kFileMagic = 0x4D505348;  // "HSPM"
+const uint32_t kRunFlag = 0x80000000;
+
+}  // namespace
+
+SpmStream::SpmStream(GpuAgent* agent, size_t buffer_size, uint32_t buffer_count,
+                     hsa_amd_spm_stream_callback_t callback, void* user_data, FILE* file)
+    : agent_(agent),
+      buffer_size_(uint32_t(buffer_size)),
+      callback_(callback),
+      user_data_(user_data),
+      file_(file),
+      free_event_(nullptr),
+      filled_event_(nullptr),
+      capture_thread_(nullptr),
+      deliver_thread_(nullptr),
+      capture_exit_(false),
+      deliver_exit_(false),
+      acquired_(false) {
+  for (uint32_t i = 0; i < buffer_count; i++) {
+    buffers_.emplace_back(new uint8_t[buffer_size_]);
+    free_.push_back(i);
+  }
+}
+
+SpmStream::~SpmStream() {
+  if (capture_thread_ != nullptr) {
+    capture_exit_ = true;
+    os::SetOsEvent(free_event_);
+    os::WaitForThread(capture_thread_);
+    os::CloseThread(capture_thread_);
+  }
+  if (deliver_thread_ != nullptr) {
+    deliver_exit_ = true;
+    os::SetOsEvent(filled_event_);
+    os::WaitForThread(deliver_thread_);
+    os::CloseThread(deliver_thread_);
+  }
+  if (acquired_) hsaKmtSPMRelease(agent_->node_id());
+  if (free_event_ != nullptr) os::DestroyOsEvent(free_event_);
+  if (filled_event_ != nullptr) os::DestroyOsEvent(filled_event_);
+  if (file_ != nullptr) fclose(file_);
+}
+
+hsa_status_t SpmStream::Start() {
+  free_event_ = os::CreateOsEvent(true, false);
+  filled_event_ = os::CreateOsEvent(true, false);
+  if (free_event_ == nullptr || filled_event_ == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  if (hsaKmtSPMAcquire(agent_->node_id()) != HSAKMT_STATUS_SUCCESS) return HSA_STATUS_ERROR;
+  acquired_ = true;
+
+  deliver_thread_ = core::Runtime::runtime_singleton_->CreateThread(
+      HSA_AMD_THREAD_CLASS_BACKGROUND, DeliverRun, this, agent_);
+  if (deliver_thread_ == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  capture_thread_ = core::Runtime::runtime_singleton_->CreateThread(
+      HSA_AMD_THREAD_CLASS_BACKGROUND, CaptureRun, this, agent_);
+  if (capture_thread_ == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  return HSA_STATUS_SUCCESS;
+}
+
+void SpmStream::CaptureRun(void* stream) { reinterpret_cast<SpmStream*>(stream)->CaptureLoop(); }
+
+void SpmStream::CaptureLoop() {
+  const uint32_t node = agent_->node_id();
+  uint32_t timeout = 0;
+  uint32_t copied = 0;
+  bool data_loss = false;
+  bool starved = false;
+
+  auto queue_filled = [&](uint32_t index) {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    if (copied == 0) {
+      free_.push_front(index);
+      return;
+    }
+    filled_.push_back({index, copied, data_loss || starved});
+    starved = false;
+    os::SetOsEvent(filled_event_);
+  };
+
+  uint32_t current;
+  {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    current = free_.front();
+    free_.pop_front();
+  }
+  if (hsaKmtSPMSetDestBuffer(node, buffer_size_, &timeout, &copied, buffers_[current].get(),
+                             &data_loss) != HSAKMT_STATUS_SUCCESS) {
+    debug_warning("Failed to start SPM stream.");
+    return;
+  }
+
+  while (!capture_exit_) {
+    uint32_t next;
+    {
+      ScopedAcquire<KernelMutex> lock(&lock_);
+      if (free_.empty()) {
+        // Every other buffer awaits delivery, KFD drops data once the current one is full.
+        starved = true;
+        lock.Release();
+        os::WaitForOsEvent(free_event_, kSwapIntervalMs);
+        continue;
+      }
+      next = free_.front();
+      free_.pop_front();
+    }
+
+    // Returns once the current buffer is full, or with its partial data after the interval.
+    timeout = kSwapIntervalMs;
+    if (hsaKmtSPMSetDestBuffer(node, buffer_size_, &timeout, &copied, buffers_[next].get(),
+                               &data_loss) != HSAKMT_STATUS_SUCCESS) {
+      debug_warning("SPM stream buffer swap failed.");
+      ScopedAcquire<KernelMutex> lock(&lock_);
+      free_.push_front(next);
+      break;
+    }
+    queue_filled(current);
+    current = next;
+  }
+
+  // Collect the data of the last buffer.
+  timeout = 0;
+  if (hsaKmtSPMSetDestBuffer(node, buffer_size_, &timeout, &copied, nullptr, &data_loss) ==
+      HSAKMT_STATUS_SUCCESS)
+    queue_filled(current);
+}
+
+void SpmStream::DeliverRun(void* stream) { reinterpret_cast<SpmStream*>(stream)->DeliverLoop(); }
+
+void SpmStream::DeliverLoop() {
+  while (true) {
+    os::WaitForOsEvent(filled_event_, 1000);
+    // Exit is only requested after capture has stopped, so reading it first drains all data.
+    bool exit = deliver_exit_;
+
+    while (true) {
+      Filled filled;
+      {
+        ScopedAcquire<KernelMutex> lock(&lock_);
+        if (filled_.empty()) break;
+        filled = filled_.front();
+        filled_.pop_front();
+      }
+
+      const uint8_t* data = buffers_[filled.index].get();
+      if (callback_ != nullptr)
+        callback_(agent_->public_handle(), data, filled.size, filled.data_loss, user_data_);
+      if (file_ != nullptr) WriteEncoded(data, filled.size, filled.data_loss);
+
+      ScopedAcquire<KernelMutex> lock(&lock_);
+      free_.push_back(filled.index);
+      os::SetOsEvent(free_event_);
+    }
+
+    if (exit) return;
+  }
+}
+
+void SpmStream::WriteEncoded(const uint8_t* data, uint32_t size, bool data_loss) {
+  const uint32_t words = size / sizeof(uint32_t);
+  auto word = [data](uint32_t i) {
+    uint32_t value;
+    memcpy(&value, data + i * sizeof(uint32_t), sizeof(value));
+    return value;
+  };
+
+  // Runs of 3 or more equal words are stored as a run, everything else as literals.
+  encoded_.clear();
+  uint32_t i = 0;
+  uint32_t literal_start = 0;
+  auto flush_literals = [&](uint32_t end) {
+    while (literal_start != end) {
+      uint32_t count = Min(end - literal_start, kRunFlag - 1);
+      encoded_.push_back(count);
+      for (uint32_t j = 0; j < count; j++) encoded_.push_back(word(literal_start + j));
+      literal_start += count;
+    }
+  };
+  while (i < words) {
+    uint32_t run = 1;
+    while (i + run < words && run < kRunFlag - 1 && word(i + run) == word(i)) run++;
+    if (run < 3) {
+      i += run;
+      continue;
+    }
+    flush_literals(i);
+    encoded_.push_back(kRunFlag | run);
+    encoded_.push_back(word(i));
+    i += run;
+    literal_start = i;
+  }
+  flush_literals(words);
+
+  const uint32_t tail = size - words * sizeof(uint32_t);
+  const uint32_t header[4] = {kFileMagic, size,
+                              uint32_t(encoded_.size() * sizeof(uint32_t) + tail),
+                              uint32_t(data_loss)};
+  fwrite(header, sizeof(header), 1, file_);
+  fwrite(encoded_.data(), sizeof(uint32_t), encoded_.size(), file_);
+  if (tail != 0) fwrite(data + words * sizeof(uint32_t), 1, tail, file_);
+}
+
+}  // namespace AMD
+}  // namespace rocr
@@ -115,23 +115,26 @@ CpuAgent* DiscoverCpu(HSAuint32 node_id, HsaNodeProperties& node_prop) {
     return nullptr;
   }
 
+  uint64_t create_start = os::ReadSystemClock();
   CpuAgent* cpu = new CpuAgent(node_id, node_prop);
+  cpu->init_times().create_start = create_start;
+  cpu->init_times().create_end = os::ReadSystemClock();
   cpu->Enable();
   core::Runtime::runtime_singleton_->RegisterAgent(cpu, true);
 
   return cpu;
 }
 
-GpuAgent* DiscoverGpu(HSAuint32 node_id, HsaNodeProperties& node_prop, bool xnack_mode,
-                      bool enabled) {
+// Constructs the GpuAgent of a node without registering it. Different nodes may be
+// constructed concurrently, the enumeration index is assigned at registration.
+static GpuAgent* CreateGpu(HSAuint32 node_id, HsaNodeProperties& node_prop, bool xnack_mode) {
   GpuAgent* gpu = nullptr;
   if (node_prop.NumFComputeCores == 0) {
       // Ignore non GPUs.
       return nullptr;
   }
   try {
-    gpu = new GpuAgent(node_id, node_prop, xnack_mode,
-                       core::Runtime::runtime_singleton_->gpu_agents().size());
+    gpu = new GpuAgent(node_id, node_prop, xnack_mode, 0);
 
     const HsaVersionInfo& kfd_version = core::Runtime::runtime_singleton_->KfdVersion().version;
 
@@ -157,8 +160,7 @@ GpuAgent* DiscoverGpu(HSAuint32 node_id, HsaNodeProperties& node_prop, bool xnac
       if (gpu->supported_isas()[0]->GetProcessorName() == "gfx908") {
         node_prop.Capability.ui32.SRAM_EDCSupport = 1;
         delete gpu;
-        gpu = new GpuAgent(node_id, node_prop, xnack_mode,
-                           core::Runtime::runtime_singleton_->gpu_agents().size());
+        gpu = new GpuAgent(node_id, node_prop, xnack_mode, 0);
       }
     }
   } catch (const hsa_exception& e) {
@@ -173,8 +175,6 @@ GpuAgent* DiscoverGpu(HSAuint32 node_id, HsaNodeProperties& node_prop, bool xnac
       throw;
     }
   }
-  if (enabled) gpu->Enable();
-  core::Runtime::runtime_singleton_->RegisterAgent(gpu, enabled);
   return gpu;
 }
 
@@ -257,26 +257,59 @@ void RegisterLinkInfo(uint32_t node_id, uint32_t num_link) {
 }
 
 /**
- * Process the list of Gpus that are surfaced to user
+ * Instantiate the user visible Gpus followed by the disabled ones. Agents
+ * are constructed in parallel and registered in list order.
  */
-static void SurfaceGpuList(std::vector<int32_t>& gpu_list, bool xnack_mode, bool enabled) {
-  // Process user visible Gpu devices
-  const int32_t invalidIdx = -1;
-  int32_t list_sz = gpu_list.size();
-  HsaNodeProperties node_prop = {0};
-  for (int32_t idx = 0; idx < list_sz; idx++) {
-    if (gpu_list[idx] == invalidIdx) {
-      break;
+static void SurfaceGpuLists(const std::vector<HsaNodeProperties>& node_props,
+                            const std::vector<int32_t>& gpu_usr_list,
+                            const std::vector<int32_t>& gpu_disabled, bool xnack_mode) {
+  struct GpuNode {
+    HSAuint32 node_id;
+    HsaNodeProperties node_prop;
+    bool enabled;
+    GpuAgent* gpu;
+  };
+  std::vector<GpuNode> nodes;
+
+  // Gather the nodes of a list up to its first invalid entry
+  auto collect = [&nodes, &node_props](const std::vector<int32_t>& gpu_list, bool enabled) {
+    const int32_t invalidIdx = -1;
+    for (int32_t node_id : gpu_list) {
+      if (node_id == invalidIdx) {
+        break;
+      }
+
+      // Properties come from the topology snapshot, agent creation may adjust its copy
+      GpuNode node = {HSAuint32(node_id), node_props[node_id], enabled, nullptr};
+
+      // The IO links of this node have already been registered
+      assert((node.node_prop.NumFComputeCores != 0) &&
+             "Improper node used for GPU device discovery.");
+      nodes.push_back(node);
     }
+  };
+  collect(gpu_usr_list, true);
+  collect(gpu_disabled, false);
 
-    // Obtain properties of the node
-    HSAKMT_STATUS err_val = hsaKmtGetNodeProperties(gpu_list[idx], &node_prop);
-    assert(err_val == HSAKMT_STATUS_SUCCESS && "Error in getting Node Properties");
+  try {
+    ParallelFor(nodes.size(), core::Runtime::runtime_singleton_->flag().agent_init_threads(),
+                [&nodes, xnack_mode](size_t i) {
+                  uint64_t create_start = os::ReadSystemClock();
+                  nodes[i].gpu = CreateGpu(nodes[i].node_id, nodes[i].node_prop, xnack_mode);
+                  if (nodes[i].gpu == nullptr) return;
+                  nodes[i].gpu->init_times().create_start = create_start;
+                  nodes[i].gpu->init_times().create_end = os::ReadSystemClock();
+                });
+  } catch (...) {
+    for (auto& node : nodes) delete node.gpu;
+    throw;
+  }
 
-    // Instantiate a Gpu device. The IO links
-    // of this node have already been registered
-    assert((node_prop.NumFComputeCores != 0) && "Improper node used for GPU device discovery.");
-    DiscoverGpu(gpu_list[idx], node_prop, xnack_mode, enabled);
+  for (auto& node : nodes) {
+    if (node.gpu == nullptr) continue;
+    node.gpu->enumeration_index(core::Runtime::runtime_singleton_->gpu_agents().size());
+    if (node.enabled) node.gpu->Enable();
+    core::Runtime::runtime_singleton_->RegisterAgent(node.gpu, node.enabled);
   }
 }
 
@@ -304,14 +337,32 @@ void BuildTopology() {
   HsaSystemProperties props;
   hsaKmtReleaseSystemProperties();
 
+  core::Runtime::runtime_singleton_->InitPhaseBegin(HSA_AMD_INIT_PHASE_TOPOLOGY_SNAPSHOT);
   if (hsaKmtAcquireSystemProperties(&props) != HSAKMT_STATUS_SUCCESS) {
     return;
   }
+  core::Runtime::runtime_singleton_->InitPhaseEnd(HSA_AMD_INIT_PHASE_TOPOLOGY_SNAPSHOT);
+  core::Runtime::runtime_singleton_->InitPhaseBegin(HSA_AMD_INIT_PHASE_AGENT_CREATE);
+
+  // Per-GPU VMs are only acquired for the GPUs surfaced to the user,
+  // keep topology queries below from activating every GPU.
+  hsaKmtActivateNodes(0, nullptr);
 
   core::Runtime::runtime_singleton_->SetLinkCount(props.NumNodes);
 
+  // Snapshot the properties of every node once. Device filtering and agent
+  // discovery below work from this copy rather than querying each node again.
+  // Nodes that fail the query are left zeroed and so discover no agents.
+  std::vector<HsaNodeProperties> node_props(props.NumNodes);
+  for (HSAuint32 node_id = 0; node_id < props.NumNodes; node_id++) {
+    if (hsaKmtGetNodeProperties(node_id, &node_props[node_id]) != HSAKMT_STATUS_SUCCESS) {
+      node_props[node_id] = HsaNodeProperties();
+    }
+  }
+
   // Query if env ROCR_VISIBLE_DEVICES is defined. If defined
   // determine number and order of GPU devices to be surfaced
+  // before any agent is created
   RvdFilter rvdFilter;
   int32_t invalidIdx = -1;
   uint32_t visibleCnt = 0;
@@ -320,7 +371,7 @@ void BuildTopology() {
   bool filter = RvdFilter::FilterDevices();
   if (filter) {
     rvdFilter.BuildRvdTokenList();
-    rvdFilter.BuildDeviceUuidList(props.NumNodes);
+    rvdFilter.BuildDeviceUuidList(node_props);
     visibleCnt = rvdFilter.BuildUsrDeviceList();
     for (int32_t idx = 0; idx < visibleCnt; idx++) {
       gpu_usr_list.push_back(invalidIdx);
@@ -330,10 +381,7 @@ void BuildTopology() {
   // Discover agents on every node in the platform.
   int32_t kfdIdx = 0;
   for (HSAuint32 node_id = 0; node_id < props.NumNodes; node_id++) {
-    HsaNodeProperties node_prop = {0};
-    if (hsaKmtGetNodeProperties(node_id, &node_prop) != HSAKMT_STATUS_SUCCESS) {
-      continue;
-    }
+    HsaNodeProperties& node_prop = node_props[node_id];
 
     // Instantiate a Cpu device
     const CpuAgent* cpu = DiscoverCpu(node_id, node_prop);
@@ -367,9 +415,19 @@ void BuildTopology() {
   bool xnack_mode = BindXnackMode();
   core::Runtime::runtime_singleton_->XnackEnabled(xnack_mode);
 
+  // Acquire the VMs of the user visible Gpus, disabled ones stay inactive
+  std::vector<HSAuint32> active_nodes;
+  for (int32_t node_id : gpu_usr_list) {
+    if (node_id == invalidIdx) break;
+    active_nodes.push_back(node_id);
+  }
+  if (!active_nodes.empty() &&
+      hsaKmtActivateNodes(active_nodes.size(), &active_nodes[0]) != HSAKMT_STATUS_SUCCESS) {
+    return;
+  }
+
   // Instantiate ROCr objects to encapsulate Gpu devices
-  SurfaceGpuList(gpu_usr_list, xnack_mode, true);
-  SurfaceGpuList(gpu_disabled, xnack_mode, false);
+  SurfaceGpuLists(node_props, gpu_usr_list, gpu_disabled, xnack_mode);
 
   // Parse HSA_CU_MASK with GPU and CU count limits.
   uint32_t maxGpu = core::Runtime::runtime_singleton_->gpu_agents().size();
@@ -415,13 +473,20 @@ void BuildTopology() {
       ((AMD::GpuAgent*)src_gpu)->RegisterRecSdmaEngIdMaskPeer(*dst_gpu, rec_sdma_eng_id_mask);
     }
   }
+
+  // Precompute the agent distance matrices and nearest host resources for hsa_amd_topology_get.
+  core::Runtime::runtime_singleton_->BuildTopologyMatrix();
+
+  core::Runtime::runtime_singleton_->InitPhaseEnd(HSA_AMD_INIT_PHASE_AGENT_CREATE);
 }
 
 bool Load() {
   bool gpu_found = false;
   bool aie_found = false;
 
+  core::Runtime::runtime_singleton_->InitPhaseBegin(HSA_AMD_INIT_PHASE_DRIVER_OPEN);
   DiscoverDrivers(gpu_found, aie_found);
+  core::Runtime::runtime_singleton_->InitPhaseEnd(HSA_AMD_INIT_PHASE_DRIVER_OPEN);
 
   if (!(gpu_found || aie_found)) {
     return false;
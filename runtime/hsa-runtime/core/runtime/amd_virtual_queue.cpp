@@ -0,0 +1,530 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+//
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+//
+// Developed by:
+//
+//                 AMD Research and AMD HSA Software Development
+//
+//                 Advanced Micro Devices, Inc.
+//
+//                 www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/inc/amd_virtual_queue.h"
+
+#include <algorithm>
+
+#include "core/inc/amd_aql_queue.h"
+#include "core/inc/amd_gpu_agent.h"
+#include "core/util/utils.h"
+#include "inc/hsa_api_trace.h"
+
+namespace rocr {
+namespace AMD {
+
+static const uint16_t kInvalidHeader = (HSA_PACKET_TYPE_INVALID << HSA_PACKET_HEADER_TYPE) |
+    (1 << HSA_PACKET_HEADER_BARRIER) |
+    (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_ACQUIRE_FENCE_SCOPE) |
+    (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_RELEASE_FENCE_SCOPE);
+
+static const uint16_t kBarrierHeader = (HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE) |
+    (1 << HSA_PACKET_HEADER_BARRIER) |
+    (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_ACQUIRE_FENCE_SCOPE) |
+    (HSA_FENCE_SCOPE_NONE << HSA_PACKET_HEADER_RELEASE_FENCE_SCOPE);
+
+SharedHwQueue::SharedHwQueue(HSA_QUEUE_PRIORITY priority, bool device_ring)
+    : load_(0),
+      priority_(priority),
+      device_ring_(device_ring),
+      retry_index_(0),
+      quit_(false),
+      profiling_(0) {
+  retry_signal_ = new core::InterruptSignal(RETRY_MAX);
+  MAKE_NAMED_SCOPE_GUARD(sigGuard, [&]() { retry_signal_->DestroySignal(); });
+
+  auto err = core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
+      core::Signal::Convert(retry_signal_), HSA_SIGNAL_CONDITION_NE, RETRY_MAX, HandleRetry,
+      this);
+  if (err != HSA_STATUS_SUCCESS)
+    throw AMD::hsa_exception(err, "Retry handler registration failed.\n");
+
+  sigGuard.Dismiss();
+}
+
+SharedHwQueue::~SharedHwQueue() {
+  // Same shutdown handshake as core::InterceptQueue's async doorbell.
+  retry_signal_->StoreRelaxed(RETRY_MAX);
+  quit_ = true;
+  hsa_signal_value_t val = retry_signal_->ExchRelaxed(1);
+  if (val != 0) retry_signal_->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, -1, HSA_WAIT_STATE_BLOCKED);
+  retry_signal_->DestroySignal();
+  queue_.reset();
+}
+
+void SharedHwQueue::Init(core::Queue* queue) {
+  queue_.reset(queue);
+  if (priority_ != HSA_QUEUE_PRIORITY_NORMAL) queue_->SetPriority(priority_);
+}
+
+bool SharedHwQueue::HandleRetry(hsa_signal_value_t value, void* arg) {
+  SharedHwQueue* shared = reinterpret_cast<SharedHwQueue*>(arg);
+  if (shared->quit_) {
+    shared->retry_signal_->StoreRelaxed(0);
+    return false;
+  }
+  shared->retry_signal_->StoreRelaxed(RETRY_MAX);
+
+  std::vector<std::shared_ptr<Link>> parked;
+  {
+    ScopedAcquire<KernelMutex> lock(&shared->lock_);
+    parked.assign(shared->parked_.begin(), shared->parked_.end());
+  }
+
+  // Resume in parking order.  A source that still does not fit keeps later ones parked.
+  for (auto& link : parked) {
+    ScopedAcquire<KernelMutex> lock(&link->lock);
+    if (link->queue != nullptr) link->queue->Process();
+  }
+  return true;
+}
+
+uint64_t SharedHwQueue::Submit(const std::shared_ptr<Link>& source,
+                               const core::AqlPacket* packets, uint64_t count) {
+  if (count == 0) return 0;
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+
+  // Sources parked earlier go first.
+  auto parked = std::find(parked_.begin(), parked_.end(), source);
+  const bool turn = parked_.empty() || parked == parked_.begin();
+
+  core::AqlPacket* ring =
+      reinterpret_cast<core::AqlPacket*>(queue_->amd_queue_.hsa_queue.base_address);
+  const uint64_t size = queue_->amd_queue_.hsa_queue.size;
+  const uint64_t mask = size - 1;
+
+  uint64_t write = queue_->LoadWriteIndexRelaxed();
+  uint64_t read = queue_->LoadReadIndexRelaxed();
+  uint64_t free_slots = size - (write - read);
+  bool pending_retry_point = IsPendingRetryPoint(read);
+
+  // Keep one slot for a retry barrier unless one is already on the ring.
+  uint64_t submit_count = 0;
+  if (turn) {
+    uint64_t reserve = pending_retry_point ? 0 : 1;
+    submit_count = (free_slots > reserve) ? Min(count, free_slots - reserve) : 0;
+  }
+
+  if (submit_count == count) {
+    if (parked != parked_.end()) parked_.erase(parked);
+  } else {
+    if (parked == parked_.end()) parked_.push_back(source);
+
+    if (!pending_retry_point && free_slots != 0) {
+      uint64_t barrier = queue_->AddWriteIndexRelaxed(1);
+      assert(barrier == write && "Shared queue has been updated outside of its lock.\n");
+      ++write;
+
+      // Completion of the barrier resumes the parked sources.
+      ring[barrier & mask].packet.body = {};
+      ring[barrier & mask].barrier_and.completion_signal = core::Signal::Convert(retry_signal_);
+      if (queue_->needsRingFence()) {
+        // Ensure the packet body is written as header may get reordered when writing over PCIE
+        _mm_sfence();
+      }
+      atomic::Store(&ring[barrier & mask].barrier_and.header, kBarrierHeader,
+                    std::memory_order_release);
+      HSA::hsa_signal_store_screlease(queue_->amd_queue_.hsa_queue.doorbell_signal, barrier);
+
+      retry_index_ = barrier;
+    }
+  }
+
+  if (submit_count == 0) return 0;
+
+  // Leave the first header INVALID until the rest of the packets are in place.
+  queue_->AddWriteIndexRelaxed(submit_count);
+  ring[write & mask].packet.body = packets[0].packet.body;
+  for (uint64_t i = 1; i < submit_count; i++) ring[(write + i) & mask] = packets[i];
+  if (queue_->needsRingFence()) {
+    // Ensure the packet body is written as header may get reordered when writing over PCIE
+    _mm_sfence();
+  }
+  atomic::Store(&ring[write & mask].packet.header, packets[0].packet.header,
+                std::memory_order_release);
+  HSA::hsa_signal_store_screlease(queue_->amd_queue_.hsa_queue.doorbell_signal,
+                                  write + submit_count - 1);
+  return submit_count;
+}
+
+void SharedHwQueue::Attach(VirtualQueue* queue) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  queues_.push_back(queue);
+}
+
+void SharedHwQueue::Detach(VirtualQueue* queue, const std::shared_ptr<Link>& link) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  queues_.erase(std::remove(queues_.begin(), queues_.end(), queue), queues_.end());
+  parked_.erase(std::remove(parked_.begin(), parked_.end(), link), parked_.end());
+}
+
+void SharedHwQueue::Unpark(const std::shared_ptr<Link>& link) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  parked_.erase(std::remove(parked_.begin(), parked_.end(), link), parked_.end());
+}
+
+void SharedHwQueue::SetProfiling(bool enabled) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  if (enabled) {
+    if (profiling_++ == 0) queue_->SetProfiling(true);
+  } else {
+    assert(profiling_ != 0 && "Unbalanced shared queue profiling.");
+    if (--profiling_ == 0) queue_->SetProfiling(false);
+  }
+}
+
+void SharedHwQueue::ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b,
+                               hsa_fence_scope_t acquireFence, hsa_fence_scope_t releaseFence,
+                               hsa_signal_t* signal) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  queue_->ExecutePM4(cmd_data, cmd_size_b, acquireFence, releaseFence, signal);
+}
+
+void SharedHwQueue::HandleError(hsa_status_t status, hsa_queue_t* source, void* data) {
+  SharedHwQueue* shared = reinterpret_cast<SharedHwQueue*>(data);
+  std::vector<VirtualQueue*> queues;
+  {
+    ScopedAcquire<KernelMutex> lock(&shared->lock_);
+    queues = shared->queues_;
+  }
+  for (auto queue : queues) queue->ReportError(status);
+}
+
+VirtualQueue::VirtualQueue(GpuAgent* agent, SharedHwQueue* shared, uint32_t size,
+                           hsa_queue_type32_t type, core::HsaEventCallback callback, void* data)
+    : Queue(),
+      LocalSignal(0, false),
+      DoorbellSignal(signal()),
+      agent_(agent),
+      shared_(shared),
+      next_packet_(0),
+      waiting_(false),
+      parked_(false),
+      stalled_(false),
+      priority_(shared->priority()),
+      handoff_signal_(nullptr),
+      handoff_pending_(false),
+      profiling_(false),
+      suspended_(false),
+      errors_callback_(callback),
+      errors_data_(data),
+      quit_(false),
+      active_(true) {
+  // Start from the shared queue's ABI fields so dispatch related state reads the same.
+  memcpy(&amd_queue_, &shared->queue()->amd_queue_, sizeof(amd_queue_t));
+  amd_queue_.read_dispatch_id = 0;
+  amd_queue_.write_dispatch_id = 0;
+  amd_queue_.hsa_queue.type = type;
+  amd_queue_.hsa_queue.size = size;
+  amd_queue_.hsa_queue.id = GetQueueId();
+  setDirectWriteIndex(true);
+
+  buffer_ = core::SharedArray<core::AqlPacket, 4096>(size);
+  amd_queue_.hsa_queue.base_address = reinterpret_cast<void*>(&buffer_[0]);
+  for (uint32_t pkt_id = 0; pkt_id < size; ++pkt_id)
+    buffer_[pkt_id].packet.header = HSA_PACKET_TYPE_INVALID;
+
+  link_ = std::make_shared<SharedHwQueue::Link>();
+  link_->queue = this;
+
+  handoff_signal_ = new core::InterruptSignal(0);
+  MAKE_NAMED_SCOPE_GUARD(handoffGuard, [&]() { handoff_signal_->DestroySignal(); });
+
+  // Device side rings land on async_doorbell_, see core::InterceptQueue.
+  async_doorbell_ = new core::InterruptSignal(DOORBELL_MAX);
+  MAKE_NAMED_SCOPE_GUARD(sigGuard, [&]() { async_doorbell_->DestroySignal(); });
+  this->signal_ = async_doorbell_->signal_;
+  amd_queue_.hsa_queue.doorbell_signal = core::Signal::Convert(this);
+
+  auto err = core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
+      core::Signal::Convert(async_doorbell_), HSA_SIGNAL_CONDITION_NE,
+      async_doorbell_->LoadRelaxed(), HandleAsyncDoorbell, this);
+  if (err != HSA_STATUS_SUCCESS)
+    throw AMD::hsa_exception(err, "Doorbell handler registration failed.\n");
+
+  shared_->Attach(this);
+
+  sigGuard.Dismiss();
+  handoffGuard.Dismiss();
+}
+
+VirtualQueue::~VirtualQueue() {
+  active_ = false;
+
+  // Pending dependency and retry handlers find the link cleared.
+  {
+    ScopedAcquire<KernelMutex> lock(&link_->lock);
+    link_->queue = nullptr;
+  }
+
+  async_doorbell_->StoreRelaxed(DOORBELL_MAX);
+  quit_ = true;
+  hsa_signal_value_t val = async_doorbell_->ExchRelaxed(1);
+  if (val != 0)
+    async_doorbell_->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, -1, HSA_WAIT_STATE_BLOCKED);
+  async_doorbell_->DestroySignal();
+
+  if (profiling_) shared_->SetProfiling(false);
+  shared_->Detach(this, link_);
+  agent_->ReleaseSharedQueue(shared_);
+  handoff_signal_->DestroySignal();
+}
+
+bool VirtualQueue::HandleAsyncDoorbell(hsa_signal_value_t value, void* arg) {
+  VirtualQueue* queue = reinterpret_cast<VirtualQueue*>(arg);
+  if (queue->quit_) {
+    queue->async_doorbell_->StoreRelaxed(0);
+    return false;
+  }
+  queue->async_doorbell_->StoreRelaxed(DOORBELL_MAX);
+  queue->Process();
+  return true;
+}
+
+bool VirtualQueue::HandleDependency(hsa_signal_value_t value, void* arg) {
+  auto link = reinterpret_cast<std::shared_ptr<SharedHwQueue::Link>*>(arg);
+  {
+    ScopedAcquire<KernelMutex> lock(&(*link)->lock);
+    VirtualQueue* queue = (*link)->queue;
+    if (queue != nullptr) {
+      {
+        ScopedAcquire<KernelMutex> lock(&queue->lock_);
+        queue->waiting_ = false;
+      }
+      queue->Process();
+    }
+  }
+  delete link;
+  return false;
+}
+
+bool VirtualQueue::Ready(const core::AqlPacket* packet, std::vector<hsa_signal_t>* pending) {
+  const uint8_t type = core::AqlPacket::type(packet->packet.header);
+  if (type != HSA_PACKET_TYPE_BARRIER_AND && type != HSA_PACKET_TYPE_BARRIER_OR) return true;
+
+  // barrier_and and barrier_or share their layout.
+  const hsa_signal_t* deps = packet->barrier_and.dep_signal;
+  pending->clear();
+  for (int i = 0; i < 5; i++) {
+    if (deps[i].handle == 0) continue;
+    bool done = core::Signal::Convert(deps[i])->LoadRelaxed() == 0;
+    if (type == HSA_PACKET_TYPE_BARRIER_OR && done) return true;
+    if (!done) pending->push_back(deps[i]);
+  }
+  return pending->empty();
+}
+
+bool VirtualQueue::WaitFor(const std::vector<hsa_signal_t>& signals) {
+  bool registered = false;
+  for (auto signal : signals) {
+    auto arg = new std::shared_ptr<SharedHwQueue::Link>(link_);
+    auto err = core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
+        signal, HSA_SIGNAL_CONDITION_EQ, 0, HandleDependency, arg);
+    if (err != HSA_STATUS_SUCCESS) {
+      delete arg;
+      continue;
+    }
+    registered = true;
+  }
+  waiting_ = registered;
+  return registered;
+}
+
+bool VirtualQueue::Rebind() {
+  if (!handoff_pending_) {
+    core::AqlPacket barrier;
+    barrier.packet.body = {};
+    barrier.barrier_and.completion_signal = core::Signal::Convert(handoff_signal_);
+    barrier.barrier_and.header = kBarrierHeader;
+    handoff_signal_->StoreRelaxed(1);
+    if (Forward(&barrier, 1) == 0) return false;
+    handoff_pending_ = true;
+  }
+
+  if (handoff_signal_->LoadRelaxed() != 0) {
+    WaitFor({core::Signal::Convert(handoff_signal_)});
+    return false;
+  }
+  handoff_pending_ = false;
+
+  SharedHwQueue* next;
+  if (agent_->AcquireSharedQueue(amd_queue_.hsa_queue.size, priority_, shared_->deviceRing(),
+                                 &next) != HSA_STATUS_SUCCESS) {
+    // Stay where we are.
+    priority_ = shared_->priority();
+    return true;
+  }
+
+  if (profiling_) {
+    shared_->SetProfiling(false);
+    next->SetProfiling(true);
+  }
+  shared_->Detach(this, link_);
+  agent_->ReleaseSharedQueue(shared_);
+  parked_ = false;
+  shared_ = next;
+  shared_->Attach(this);
+  return true;
+}
+
+hsa_status_t VirtualQueue::SetPriority(HSA_QUEUE_PRIORITY priority) {
+  if (priority < HSA_QUEUE_PRIORITY_MINIMUM || priority > HSA_QUEUE_PRIORITY_MAXIMUM)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    priority_ = priority;
+  }
+  Process();
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t VirtualQueue::SetSuspended(bool suspended) {
+  {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    if (!active_) return HSA_STATUS_ERROR_INVALID_QUEUE;
+    suspended_ = suspended;
+  }
+  if (!suspended) Process();
+  return HSA_STATUS_SUCCESS;
+}
+
+uint64_t VirtualQueue::Forward(const core::AqlPacket* packets, uint64_t count) {
+  uint64_t written = shared_->Submit(link_, packets, count);
+  parked_ = written < count;
+  stalled_ |= parked_;
+  return written;
+}
+
+void VirtualQueue::Process() {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  stalled_ = false;
+
+  if (active_ && !suspended_ && !waiting_ && (shared_->priority() == priority_ || Rebind())) {
+    core::AqlPacket* ring = &buffer_[0];
+    const uint64_t size = amd_queue_.hsa_queue.size;
+    const uint64_t mask = size - 1;
+
+    uint64_t end = LoadWriteIndexAcquire();
+    if (end > next_packet_ + size) end = next_packet_ + size;
+
+    std::vector<hsa_signal_t> pending;
+    uint64_t i = next_packet_;
+    while (i < end) {
+      // Forward the run of valid, ready packets that is contiguous in the ring.
+      const uint64_t run_end = Min(end, AlignDown(i, size) + size);
+      uint64_t count = 0;
+      bool blocked = false;
+      while (i + count < run_end) {
+        const core::AqlPacket* packet = &ring[(i + count) & mask];
+        uint16_t header = atomic::Load(&packet->packet.header, std::memory_order_acquire);
+        if (!core::AqlPacket::IsValid(header)) break;
+        if (!Ready(packet, &pending)) {
+          blocked = true;
+          break;
+        }
+        ++count;
+      }
+
+      // A blocked barrier at the head waits on the host.  If no handler can be registered it is
+      // forwarded and waits on the ring instead.
+      if (count == 0) {
+        if (!blocked || WaitFor(pending)) break;
+        count = 1;
+      }
+
+      uint64_t written = Forward(&ring[i & mask], count);
+      for (uint64_t j = 0; j < written; j++)
+        atomic::Store(&ring[(i + j) & mask].packet.header, kInvalidHeader,
+                      std::memory_order_release);
+      i += written;
+
+      if (written < count) break;
+    }
+
+    next_packet_ = i;
+    atomic::Store(&amd_queue_.read_dispatch_id, next_packet_, std::memory_order_release);
+  }
+
+  // Only a queue that is short of ring space may hold its place in line.
+  if (parked_ && !stalled_) {
+    shared_->Unpark(link_);
+    parked_ = false;
+  }
+}
+
+hsa_status_t VirtualQueue::GetCUMasking(uint32_t num_cu_mask_count, uint32_t* cu_mask) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  return shared_->queue()->GetCUMasking(num_cu_mask_count, cu_mask);
+}
+
+void VirtualQueue::ExecutePM4(uint32_t* cmd_data, size_t cmd_size_b,
+                              hsa_fence_scope_t acquireFence, hsa_fence_scope_t releaseFence,
+                              hsa_signal_t* signal) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  shared_->ExecutePM4(cmd_data, cmd_size_b, acquireFence, releaseFence, signal);
+}
+
+void VirtualQueue::SetProfiling(bool enabled) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  core::Queue::SetProfiling(enabled);
+  if (enabled != profiling_) shared_->SetProfiling(enabled);
+  profiling_ = enabled;
+}
+
+hsa_status_t VirtualQueue::GetInfo(hsa_queue_info_attribute_t attribute, void* value) {
+  switch (attribute) {
+    case HSA_AMD_QUEUE_INFO_AGENT:
+    case HSA_AMD_QUEUE_INFO_SCRATCH_DEMAND_HISTOGRAM: {
+      ScopedAcquire<KernelMutex> lock(&lock_);
+      return shared_->queue()->GetInfo(attribute, value);
+    }
+    // The doorbell belongs to the shared queue, and telemetry is sampled per hardware queue.
+    case HSA_AMD_QUEUE_INFO_DOORBELL_ID:
+    case HSA_AMD_QUEUE_INFO_TELEMETRY:
+      return HSA_STATUS_ERROR_INVALID_QUEUE;
+  }
+  return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+}
+
+}  // namespace AMD
+}  // namespace rocr
@@ -41,6 +41,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "core/inc/default_signal.h"
+#include "core/inc/ipc_signal.h"
+#include "core/inc/metrics.h"
 #include "core/util/timer.h"
 
 #if defined(__i386__) || defined(__x86_64__)
@@ -52,11 +54,21 @@ namespace rocr {
 namespace core {
 
 BusyWaitSignal::BusyWaitSignal(SharedSignal* abi_block, bool enableIPC)
-    : Signal(abi_block, enableIPC) {
+    : Signal(abi_block, enableIPC), doorbell_(nullptr) {
   signal_.kind = AMD_SIGNAL_KIND_USER;
   signal_.event_mailbox_ptr = uint64_t(NULL);
 }
 
+BusyWaitSignal::~BusyWaitSignal() { delete doorbell_.load(std::memory_order_relaxed); }
+
+void BusyWaitSignal::SetDoorbell(IPCDoorbell* doorbell) {
+  IPCDoorbell* expected = nullptr;
+  if (!doorbell_.compare_exchange_strong(expected, doorbell, std::memory_order_release))
+    delete doorbell;
+}
+
+void BusyWaitSignal::RingDoorbell() { doorbell_.load(std::memory_order_relaxed)->Ring(); }
+
 hsa_signal_value_t BusyWaitSignal::LoadRelaxed() {
   return hsa_signal_value_t(
       atomic::Load(&signal_.value, std::memory_order_relaxed));
@@ -69,10 +81,12 @@ hsa_signal_value_t BusyWaitSignal::LoadAcquire() {
 
 void BusyWaitSignal::StoreRelaxed(hsa_signal_value_t value) {
   atomic::Store(&signal_.value, int64_t(value), std::memory_order_relaxed);
+  Ring();
 }
 
 void BusyWaitSignal::StoreRelease(hsa_signal_value_t value) {
   atomic::Store(&signal_.value, int64_t(value), std::memory_order_release);
+  Ring();
 }
 
 hsa_signal_value_t BusyWaitSignal::WaitRelaxed(hsa_signal_condition_t condition,
@@ -83,7 +97,19 @@ hsa_signal_value_t BusyWaitSignal::WaitRelaxed(hsa_signal_condition_t condition,
 
   waiting_++;
   MAKE_SCOPE_GUARD([&]() { waiting_--; });
+  TimelineSpan span(Timeline::kSignalWait, Convert(this).handle);
+
+  // IPC signals sleep on their doorbell so host updates from any process wake them at once.
+  // GPU updates do not ring it, so sleeps stay short.
+  IPCDoorbell* doorbell = doorbell_.load(std::memory_order_acquire);
+  if (doorbell != nullptr) doorbell->AddWaiter();
+  MAKE_SCOPE_GUARD([&]() {
+    if (doorbell != nullptr) doorbell->RemoveWaiter();
+  });
+  uint32_t doorbell_seq = 0;
   bool condition_met = false;
+  bool polled = false;
+  bool slept = false;
   int64_t value;
 
   const uint32_t &signal_abort_timeout =
@@ -96,8 +122,9 @@ hsa_signal_value_t BusyWaitSignal::WaitRelaxed(hsa_signal_condition_t condition,
   start_time = timer::fast_clock::now();
 
   // Set a polling timeout value
-  // Should be a few times bigger than null kernel latency
-  const timer::fast_clock::duration kMaxElapsed = std::chrono::microseconds(200);
+  // Should be a few times bigger than null kernel latency, shortened or lengthened by the
+  // signal's wait policy.
+  const timer::fast_clock::duration kMaxElapsed = SpinBudget(std::chrono::microseconds(200));
 
   uint64_t hsa_freq;
   HSA::hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY, &hsa_freq);
@@ -112,6 +139,7 @@ hsa_signal_value_t BusyWaitSignal::WaitRelaxed(hsa_signal_condition_t condition,
   while (true) {
     if (!IsValid()) return 0;
 
+    if (doorbell != nullptr) doorbell_seq = doorbell->Sequence();
     value = atomic::Load(&signal_.value, std::memory_order_relaxed);
 
     switch (condition) {
@@ -134,7 +162,13 @@ hsa_signal_value_t BusyWaitSignal::WaitRelaxed(hsa_signal_condition_t condition,
       default:
         return 0;
     }
-    if (condition_met) return hsa_signal_value_t(value);
+    if (condition_met) {
+      // Only waits which had to poll say anything about completion latency.
+      if (polled) RecordWaitLatency(timer::fast_clock::now() - start_time);
+      if (polled && !slept) Metrics::Count(HSA_AMD_RUNTIME_COUNTER_SIGNAL_WAIT_SPINS);
+      return hsa_signal_value_t(value);
+    }
+    polled = true;
 
     time = timer::fast_clock::now();
     if (time - start_time > fast_timeout) {
@@ -152,7 +186,12 @@ hsa_signal_value_t BusyWaitSignal::WaitRelaxed(hsa_signal_condition_t condition,
     }
 
     if (time - start_time > kMaxElapsed) {
-      os::uSleep(20);
+      slept = true;
+      Metrics::Count(HSA_AMD_RUNTIME_COUNTER_SIGNAL_WAIT_SLEEPS);
+      if (doorbell != nullptr)
+        doorbell->Wait(doorbell_seq, 20);
+      else
+        os::uSleep(20);
 #if defined(__i386__) || defined(__x86_64__)
     } else if (g_use_mwaitx) {
       _mm_mwaitx(0, 60000, MWAITX_ECX_TIMER_ENABLE);  // 60000 ~20us on a 1.5Ghz CPU
@@ -173,130 +212,162 @@ hsa_signal_value_t BusyWaitSignal::WaitAcquire(hsa_signal_condition_t condition,
 
 void BusyWaitSignal::AndRelaxed(hsa_signal_value_t value) {
   atomic::And(&signal_.value, int64_t(value), std::memory_order_relaxed);
+  Ring();
 }
 
 void BusyWaitSignal::AndAcquire(hsa_signal_value_t value) {
   atomic::And(&signal_.value, int64_t(value), std::memory_order_acquire);
+  Ring();
 }
 
 void BusyWaitSignal::AndRelease(hsa_signal_value_t value) {
   atomic::And(&signal_.value, int64_t(value), std::memory_order_release);
+  Ring();
 }
 
 void BusyWaitSignal::AndAcqRel(hsa_signal_value_t value) {
   atomic::And(&signal_.value, int64_t(value), std::memory_order_acq_rel);
+  Ring();
 }
 
 void BusyWaitSignal::OrRelaxed(hsa_signal_value_t value) {
   atomic::Or(&signal_.value, int64_t(value), std::memory_order_relaxed);
+  Ring();
 }
 
 void BusyWaitSignal::OrAcquire(hsa_signal_value_t value) {
   atomic::Or(&signal_.value, int64_t(value), std::memory_order_acquire);
+  Ring();
 }
 
 void BusyWaitSignal::OrRelease(hsa_signal_value_t value) {
   atomic::Or(&signal_.value, int64_t(value), std::memory_order_release);
+  Ring();
 }
 
 void BusyWaitSignal::OrAcqRel(hsa_signal_value_t value) {
   atomic::Or(&signal_.value, int64_t(value), std::memory_order_acq_rel);
+  Ring();
 }
 
 void BusyWaitSignal::XorRelaxed(hsa_signal_value_t value) {
   atomic::Xor(&signal_.value, int64_t(value), std::memory_order_relaxed);
+  Ring();
 }
 
 void BusyWaitSignal::XorAcquire(hsa_signal_value_t value) {
   atomic::Xor(&signal_.value, int64_t(value), std::memory_order_acquire);
+  Ring();
 }
 
 void BusyWaitSignal::XorRelease(hsa_signal_value_t value) {
   atomic::Xor(&signal_.value, int64_t(value), std::memory_order_release);
+  Ring();
 }
 
 void BusyWaitSignal::XorAcqRel(hsa_signal_value_t value) {
   atomic::Xor(&signal_.value, int64_t(value), std::memory_order_acq_rel);
+  Ring();
 }
 
 void BusyWaitSignal::AddRelaxed(hsa_signal_value_t value) {
   atomic::Add(&signal_.value, int64_t(value), std::memory_order_relaxed);
+  Ring();
 }
 
 void BusyWaitSignal::AddAcquire(hsa_signal_value_t value) {
   atomic::Add(&signal_.value, int64_t(value), std::memory_order_acquire);
+  Ring();
 }
 
 void BusyWaitSignal::AddRelease(hsa_signal_value_t value) {
   atomic::Add(&signal_.value, int64_t(value), std::memory_order_release);
+  Ring();
 }
 
 void BusyWaitSignal::AddAcqRel(hsa_signal_value_t value) {
   atomic::Add(&signal_.value, int64_t(value), std::memory_order_acq_rel);
+  Ring();
 }
 
 void BusyWaitSignal::SubRelaxed(hsa_signal_value_t value) {
   atomic::Sub(&signal_.value, int64_t(value), std::memory_order_relaxed);
+  Ring();
 }
 
 void BusyWaitSignal::SubAcquire(hsa_signal_value_t value) {
   atomic::Sub(&signal_.value, int64_t(value), std::memory_order_acquire);
+  Ring();
 }
 
 void BusyWaitSignal::SubRelease(hsa_signal_value_t value) {
   atomic::Sub(&signal_.value, int64_t(value), std::memory_order_release);
+  Ring();
 }
 
 void BusyWaitSignal::SubAcqRel(hsa_signal_value_t value) {
   atomic::Sub(&signal_.value, int64_t(value), std::memory_order_acq_rel);
+  Ring();
 }
 
 hsa_signal_value_t BusyWaitSignal::ExchRelaxed(hsa_signal_value_t value) {
-  return hsa_signal_value_t(atomic::Exchange(&signal_.value, int64_t(value),
-                                             std::memory_order_relaxed));
+  hsa_signal_value_t ret = hsa_signal_value_t(
+      atomic::Exchange(&signal_.value, int64_t(value), std::memory_order_relaxed));
+  Ring();
+  return ret;
 }
 
 hsa_signal_value_t BusyWaitSignal::ExchAcquire(hsa_signal_value_t value) {
-  return hsa_signal_value_t(atomic::Exchange(&signal_.value, int64_t(value),
-                                             std::memory_order_acquire));
+  hsa_signal_value_t ret = hsa_signal_value_t(
+      atomic::Exchange(&signal_.value, int64_t(value), std::memory_order_acquire));
+  Ring();
+  return ret;
 }
 
 hsa_signal_value_t BusyWaitSignal::ExchRelease(hsa_signal_value_t value) {
-  return hsa_signal_value_t(atomic::Exchange(&signal_.value, int64_t(value),
-                                             std::memory_order_release));
+  hsa_signal_value_t ret = hsa_signal_value_t(
+      atomic::Exchange(&signal_.value, int64_t(value), std::memory_order_release));
+  Ring();
+  return ret;
 }
 
 hsa_signal_value_t BusyWaitSignal::ExchAcqRel(hsa_signal_value_t value) {
-  return hsa_signal_value_t(atomic::Exchange(&signal_.value, int64_t(value),
-                                             std::memory_order_acq_rel));
+  hsa_signal_value_t ret = hsa_signal_value_t(
+      atomic::Exchange(&signal_.value, int64_t(value), std::memory_order_acq_rel));
+  Ring();
+  return ret;
 }
 
 hsa_signal_value_t BusyWaitSignal::CasRelaxed(hsa_signal_value_t expected,
                                               hsa_signal_value_t value) {
-  return hsa_signal_value_t(atomic::Cas(&signal_.value, int64_t(value),
-                                        int64_t(expected),
-                                        std::memory_order_relaxed));
+  hsa_signal_value_t ret = hsa_signal_value_t(
+      atomic::Cas(&signal_.value, int64_t(value), int64_t(expected), std::memory_order_relaxed));
+  Ring();
+  return ret;
 }
 
 hsa_signal_value_t BusyWaitSignal::CasAcquire(hsa_signal_value_t expected,
                                               hsa_signal_value_t value) {
-  return hsa_signal_value_t(atomic::Cas(&signal_.value, int64_t(value),
-                                        int64_t(expected),
-                                        std::memory_order_acquire));
+  hsa_signal_value_t ret = hsa_signal_value_t(
+      atomic::Cas(&signal_.value, int64_t(value), int64_t(expected), std::memory_order_acquire));
+  Ring();
+  return ret;
 }
 
 hsa_signal_value_t BusyWaitSignal::CasRelease(hsa_signal_value_t expected,
                                               hsa_signal_value_t value) {
-  return hsa_signal_value_t(atomic::Cas(&signal_.value, int64_t(value),
-                                        int64_t(expected),
-                                        std::memory_order_release));
+  hsa_signal_value_t ret = hsa_signal_value_t(
+      atomic::Cas(&signal_.value, int64_t(value), int64_t(expected), std::memory_order_release));
+  Ring();
+  return ret;
 }
 
 hsa_signal_value_t BusyWaitSignal::CasAcqRel(hsa_signal_value_t expected,
                                              hsa_signal_value_t value) {
-  return hsa_signal_value_t(atomic::Cas(&signal_.value, int64_t(value),
-                                        int64_t(expected),
-                                        std::memory_order_acq_rel));
+  hsa_signal_value_t ret = hsa_signal_value_t(
+      atomic::Cas(&signal_.value, int64_t(value), int64_t(expected), std::memory_order_acq_rel));
+  Ring();
+  return ret;
 }
 
 }  // namespace core
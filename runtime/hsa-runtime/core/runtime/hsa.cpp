@@ -343,8 +343,13 @@ static size_t get_extension_table_length(uint16_t extension, uint16_t major, uin
       {"hsa_ven_amd_loader_1_01_pfn_t", sizeof(hsa_ven_amd_loader_1_01_pfn_t)},
       {"hsa_ven_amd_loader_1_02_pfn_t", sizeof(hsa_ven_amd_loader_1_02_pfn_t)},
       {"hsa_ven_amd_loader_1_03_pfn_t", sizeof(hsa_ven_amd_loader_1_03_pfn_t)},
+      {"hsa_ven_amd_loader_1_04_pfn_t", sizeof(hsa_ven_amd_loader_1_04_pfn_t)},
+      {"hsa_ven_amd_loader_1_05_pfn_t", sizeof(hsa_ven_amd_loader_1_05_pfn_t)},
+      {"hsa_ven_amd_loader_1_06_pfn_t", sizeof(hsa_ven_amd_loader_1_06_pfn_t)},
       {"hsa_ven_amd_aqlprofile_1_00_pfn_t", sizeof(hsa_ven_amd_aqlprofile_1_00_pfn_t)},
-      {"hsa_ven_amd_pc_sampling_1_00_pfn_t", sizeof(hsa_ven_amd_pc_sampling_1_00_pfn_t)}};
+      {"hsa_ven_amd_pc_sampling_1_00_pfn_t", sizeof(hsa_ven_amd_pc_sampling_1_00_pfn_t)},
+      {"hsa_ven_amd_pc_sampling_1_01_pfn_t", sizeof(hsa_ven_amd_pc_sampling_1_01_pfn_t)},
+      {"hsa_ven_amd_pc_sampling_1_02_pfn_t", sizeof(hsa_ven_amd_pc_sampling_1_02_pfn_t)}};
   static const size_t num_tables = sizeof(sizes) / sizeof(sizes_t);
 
   if (minor > 99) return 0;
@@ -438,15 +443,20 @@ hsa_status_t hsa_system_get_major_extension_table(uint16_t extension, uint16_t v
     if (version_major != core::Runtime::runtime_singleton_->extensions_.pcs_api.version.major_id) {
       return HSA_STATUS_ERROR;
     }
-    hsa_ven_amd_pc_sampling_1_00_pfn_t ext_table;
+    hsa_ven_amd_pc_sampling_1_02_pfn_t ext_table;
+    ext_table.hsa_ven_amd_pcs_iterate_configuration = hsa_ven_amd_pcs_iterate_configuration;
     ext_table.hsa_ven_amd_pcs_create = hsa_ven_amd_pcs_create;
     ext_table.hsa_ven_amd_pcs_create_from_id = hsa_ven_amd_pcs_create_from_id;
     ext_table.hsa_ven_amd_pcs_destroy = hsa_ven_amd_pcs_destroy;
     ext_table.hsa_ven_amd_pcs_start = hsa_ven_amd_pcs_start;
     ext_table.hsa_ven_amd_pcs_stop = hsa_ven_amd_pcs_stop;
     ext_table.hsa_ven_amd_pcs_flush = hsa_ven_amd_pcs_flush;
+    ext_table.hsa_ven_amd_pcs_data_view = hsa_ven_amd_pcs_data_view;
+    ext_table.hsa_ven_amd_pcs_aggregate = hsa_ven_amd_pcs_aggregate;
 
     memcpy(table, &ext_table, Min(sizeof(ext_table), table_length));
+
+    return HSA_STATUS_SUCCESS;
   }
 
   if (extension == HSA_EXTENSION_FINALIZER) {
@@ -470,7 +480,7 @@ hsa_status_t hsa_system_get_major_extension_table(uint16_t extension, uint16_t v
 
   if (extension == HSA_EXTENSION_AMD_LOADER) {
     if (version_major != 1) return HSA_STATUS_ERROR;
-    hsa_ven_amd_loader_1_03_pfn_t ext_table;
+    hsa_ven_amd_loader_1_06_pfn_t ext_table;
     ext_table.hsa_ven_amd_loader_query_host_address =
         hsa_ven_amd_loader_query_host_address;
     ext_table.hsa_ven_amd_loader_query_segment_descriptors =
@@ -485,6 +495,12 @@ hsa_status_t hsa_system_get_major_extension_table(uint16_t extension, uint16_t v
         hsa_ven_amd_loader_code_object_reader_create_from_file_with_offset_size;
     ext_table.hsa_ven_amd_loader_iterate_executables =
         hsa_ven_amd_loader_iterate_executables;
+    ext_table.hsa_ven_amd_loader_executable_load_agents_code_object =
+        hsa_ven_amd_loader_executable_load_agents_code_object;
+    ext_table.hsa_ven_amd_loader_executable_get_kernels =
+        hsa_ven_amd_loader_executable_get_kernels;
+    ext_table.hsa_ven_amd_loader_select_bundled_code_objects =
+        hsa_ven_amd_loader_select_bundled_code_objects;
 
     memcpy(table, &ext_table, Min(sizeof(ext_table), table_length));
 
@@ -1007,6 +1023,8 @@ uint64_t hsa_queue_cas_write_index_screlease(const hsa_queue_t* queue, uint64_t
 /// @return uint64_t Value of write index before the update
 uint64_t hsa_queue_add_write_index_scacq_screl(const hsa_queue_t* queue, uint64_t value) {
   TRY;
+  uint64_t old;
+  if (core::Queue::AddWriteIndexDirect(queue, value, std::memory_order_acq_rel, &old)) return old;
   core::Queue* cmd_queue = core::Queue::Convert(queue);
   assert(IsValid(cmd_queue));
   return cmd_queue->AddWriteIndexAcqRel(value);
@@ -1022,6 +1040,8 @@ uint64_t hsa_queue_add_write_index_scacq_screl(const hsa_queue_t* queue, uint64_
 /// @return uint64_t Value of write index before the update
 uint64_t hsa_queue_add_write_index_scacquire(const hsa_queue_t* queue, uint64_t value) {
   TRY;
+  uint64_t old;
+  if (core::Queue::AddWriteIndexDirect(queue, value, std::memory_order_acquire, &old)) return old;
   core::Queue* cmd_queue = core::Queue::Convert(queue);
   assert(IsValid(cmd_queue));
   return cmd_queue->AddWriteIndexAcquire(value);
@@ -1038,6 +1058,8 @@ uint64_t hsa_queue_add_write_index_scacquire(const hsa_queue_t* queue, uint64_t
 uint64_t hsa_queue_add_write_index_relaxed(const hsa_queue_t* queue,
                                                    uint64_t value) {
   TRY;
+  uint64_t old;
+  if (core::Queue::AddWriteIndexDirect(queue, value, std::memory_order_relaxed, &old)) return old;
   core::Queue* cmd_queue = core::Queue::Convert(queue);
   assert(IsValid(cmd_queue));
   return cmd_queue->AddWriteIndexRelaxed(value);
@@ -1053,6 +1075,8 @@ uint64_t hsa_queue_add_write_index_relaxed(const hsa_queue_t* queue,
 /// @return uint64_t Value of write index before the update
 uint64_t hsa_queue_add_write_index_screlease(const hsa_queue_t* queue, uint64_t value) {
   TRY;
+  uint64_t old;
+  if (core::Queue::AddWriteIndexDirect(queue, value, std::memory_order_release, &old)) return old;
   core::Queue* cmd_queue = core::Queue::Convert(queue);
   assert(IsValid(cmd_queue));
   return cmd_queue->AddWriteIndexRelease(value);
@@ -1210,6 +1234,7 @@ hsa_signal_value_t hsa_signal_load_scacquire(hsa_signal_t hsa_signal) {
 void hsa_signal_store_relaxed(hsa_signal_t hsa_signal,
                                       hsa_signal_value_t value) {
   TRY;
+  if (core::Signal::StoreDirect(hsa_signal, value, std::memory_order_relaxed)) return;
   core::Signal* signal = core::Signal::Convert(hsa_signal);
   assert(IsValid(signal));
   signal->StoreRelaxed(value);
@@ -1218,6 +1243,7 @@ void hsa_signal_store_relaxed(hsa_signal_t hsa_signal,
 
 void hsa_signal_store_screlease(hsa_signal_t hsa_signal, hsa_signal_value_t value) {
   TRY;
+  if (core::Signal::StoreDirect(hsa_signal, value, std::memory_order_release)) return;
   core::Signal* signal = core::Signal::Convert(hsa_signal);
   assert(IsValid(signal));
   signal->StoreRelease(value);
@@ -2264,6 +2290,7 @@ hsa_status_t hsa_executable_load_code_object(
   CodeObjectReaderImpl reader;
   reader.SetMemory(code_object_p, amd::elf::ElfSize(code_object_p));
 
+  core::TimelineSpan span(core::Timeline::kCodeObjectLoad, agent.handle);
   return exec->LoadCodeObject(agent, code_object, options, reader.GetUri());
   CATCH;
 }
@@ -2289,6 +2316,7 @@ hsa_status_t hsa_executable_load_program_code_object(
 
   hsa_code_object_t code_object =
       {reinterpret_cast<uint64_t>(reader->GetCodeObjectMemory())};
+  core::TimelineSpan span(core::Timeline::kCodeObjectLoad, 0);
   return exec->LoadCodeObject(
       {0}, code_object, options, reader->GetUri(), loaded_code_object);
   CATCH;
@@ -2316,6 +2344,7 @@ hsa_status_t hsa_executable_load_agent_code_object(
 
   hsa_code_object_t code_object =
       {reinterpret_cast<uint64_t>(reader->GetCodeObjectMemory())};
+  core::TimelineSpan span(core::Timeline::kCodeObjectLoad, agent.handle);
   return exec->LoadCodeObject( agent, code_object, options,
                               reader->GetUri(), loaded_code_object);
   CATCH;
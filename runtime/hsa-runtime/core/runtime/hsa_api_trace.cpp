@@ -53,6 +53,9 @@ namespace AMD {
 hsa_status_t hsa_amd_queue_intercept_register(hsa_queue_t* queue,
                                               hsa_amd_queue_intercept_handler callback,
                                               void* user_data);
+hsa_status_t hsa_amd_queue_intercept_register_batch(hsa_queue_t* queue,
+                                                    hsa_amd_queue_intercept_handler callback,
+                                                    void* user_data);
 hsa_status_t hsa_amd_queue_intercept_create(
     hsa_agent_t agent_handle, uint32_t size, hsa_queue_type32_t type,
     void (*callback)(hsa_status_t status, hsa_queue_t* source, void* data), void* data,
@@ -87,11 +90,11 @@ void HsaApiTable::Init() {
   // they can add preprocessor macros on the new functions
 
   constexpr size_t expected_core_api_table_size = 1016;
-  constexpr size_t expected_amd_ext_table_size = 584;
+  constexpr size_t expected_amd_ext_table_size = 1216;
   constexpr size_t expected_image_ext_table_size = 128;
   constexpr size_t expected_finalizer_ext_table_size = 64;
   constexpr size_t expected_tools_table_size = 64;
-  constexpr size_t expected_pc_sampling_ext_table_size = 72;
+  constexpr size_t expected_pc_sampling_ext_table_size = 88;
 
   static_assert(sizeof(CoreApiTable) == expected_core_api_table_size,
                 "HSA core API table size changed, bump HSA_CORE_API_TABLE_STEP_VERSION and set "
@@ -474,6 +477,91 @@ void HsaApiTable::UpdateAmdExts() {
   amd_ext_api.hsa_amd_agent_set_async_scratch_limit_fn = AMD::hsa_amd_agent_set_async_scratch_limit;
   amd_ext_api.hsa_amd_queue_get_info_fn = AMD::hsa_amd_queue_get_info;
   amd_ext_api.hsa_amd_enable_logging_fn = AMD::hsa_amd_enable_logging;
+  amd_ext_api.hsa_amd_signal_wait_policy_fn = AMD::hsa_amd_signal_wait_policy;
+  amd_ext_api.hsa_amd_signal_wait_set_create_fn = AMD::hsa_amd_signal_wait_set_create;
+  amd_ext_api.hsa_amd_signal_wait_set_destroy_fn = AMD::hsa_amd_signal_wait_set_destroy;
+  amd_ext_api.hsa_amd_signal_wait_set_add_fn = AMD::hsa_amd_signal_wait_set_add;
+  amd_ext_api.hsa_amd_signal_wait_set_remove_fn = AMD::hsa_amd_signal_wait_set_remove;
+  amd_ext_api.hsa_amd_signal_wait_set_wait_fn = AMD::hsa_amd_signal_wait_set_wait;
+  amd_ext_api.hsa_amd_signal_async_handler_with_flags_fn =
+      AMD::hsa_amd_signal_async_handler_with_flags;
+  amd_ext_api.hsa_amd_memory_async_copy_batch_fn = AMD::hsa_amd_memory_async_copy_batch;
+  amd_ext_api.hsa_amd_memory_lock_cache_invalidate_fn = AMD::hsa_amd_memory_lock_cache_invalidate;
+  amd_ext_api.hsa_amd_queue_kernarg_alloc_fn = AMD::hsa_amd_queue_kernarg_alloc;
+  amd_ext_api.hsa_amd_queue_intercept_register_batch_fn =
+      AMD::hsa_amd_queue_intercept_register_batch;
+  amd_ext_api.hsa_amd_queue_submit_batch_fn = AMD::hsa_amd_queue_submit_batch;
+  amd_ext_api.hsa_amd_queue_create_fn = AMD::hsa_amd_queue_create;
+  amd_ext_api.hsa_amd_memory_async_copy_on_engine_with_priority_fn =
+      AMD::hsa_amd_memory_async_copy_on_engine_with_priority;
+  amd_ext_api.hsa_amd_copy_list_create_fn = AMD::hsa_amd_copy_list_create;
+  amd_ext_api.hsa_amd_copy_list_submit_fn = AMD::hsa_amd_copy_list_submit;
+  amd_ext_api.hsa_amd_copy_list_destroy_fn = AMD::hsa_amd_copy_list_destroy;
+  amd_ext_api.hsa_amd_agents_allow_access_batch_fn = AMD::hsa_amd_agents_allow_access_batch;
+  amd_ext_api.hsa_amd_signal_get_eventfd_fn = AMD::hsa_amd_signal_get_eventfd;
+  amd_ext_api.hsa_amd_executable_freeze_async_fn = AMD::hsa_amd_executable_freeze_async;
+  amd_ext_api.hsa_amd_executables_destroy_fn = AMD::hsa_amd_executables_destroy;
+  amd_ext_api.hsa_amd_queue_dispatch_timestamps_enable_fn =
+      AMD::hsa_amd_queue_dispatch_timestamps_enable;
+  amd_ext_api.hsa_amd_queue_dispatch_timestamp_signal_fn =
+      AMD::hsa_amd_queue_dispatch_timestamp_signal;
+  amd_ext_api.hsa_amd_queue_dispatch_timestamps_read_fn =
+      AMD::hsa_amd_queue_dispatch_timestamps_read;
+  amd_ext_api.hsa_amd_runtime_metrics_get_fn = AMD::hsa_amd_runtime_metrics_get;
+  amd_ext_api.hsa_amd_svm_profile_get_ranges_fn = AMD::hsa_amd_svm_profile_get_ranges;
+  amd_ext_api.hsa_amd_runtime_trace_flush_fn = AMD::hsa_amd_runtime_trace_flush;
+  amd_ext_api.hsa_amd_spm_stream_start_fn = AMD::hsa_amd_spm_stream_start;
+  amd_ext_api.hsa_amd_spm_stream_stop_fn = AMD::hsa_amd_spm_stream_stop;
+  amd_ext_api.hsa_amd_profiling_get_clock_params_fn = AMD::hsa_amd_profiling_get_clock_params;
+  amd_ext_api.hsa_amd_ipc_memory_attach_batch_fn = AMD::hsa_amd_ipc_memory_attach_batch;
+  amd_ext_api.hsa_amd_vmem_map_batch_fn = AMD::hsa_amd_vmem_map_batch;
+  amd_ext_api.hsa_amd_vmem_set_access_batch_fn = AMD::hsa_amd_vmem_set_access_batch;
+  amd_ext_api.hsa_amd_svm_prefetch_batch_async_fn = AMD::hsa_amd_svm_prefetch_batch_async;
+  amd_ext_api.hsa_amd_portable_export_dmabuf_bulk_fn = AMD::hsa_amd_portable_export_dmabuf_bulk;
+  amd_ext_api.hsa_amd_memory_async_copy_strided_fn = AMD::hsa_amd_memory_async_copy_strided;
+  amd_ext_api.hsa_amd_memory_fill_async_fn = AMD::hsa_amd_memory_fill_async;
+  amd_ext_api.hsa_amd_copy_context_create_fn = AMD::hsa_amd_copy_context_create;
+  amd_ext_api.hsa_amd_copy_context_submit_fn = AMD::hsa_amd_copy_context_submit;
+  amd_ext_api.hsa_amd_copy_context_destroy_fn = AMD::hsa_amd_copy_context_destroy;
+  amd_ext_api.hsa_amd_memory_async_copy_stream_fn = AMD::hsa_amd_memory_async_copy_stream;
+  amd_ext_api.hsa_amd_aie_buffer_host_access_fn = AMD::hsa_amd_aie_buffer_host_access;
+  amd_ext_api.hsa_amd_cu_partitions_create_fn = AMD::hsa_amd_cu_partitions_create;
+  amd_ext_api.hsa_amd_cu_partitions_bind_queue_fn = AMD::hsa_amd_cu_partitions_bind_queue;
+  amd_ext_api.hsa_amd_cu_partitions_rebalance_fn = AMD::hsa_amd_cu_partitions_rebalance;
+  amd_ext_api.hsa_amd_cu_partitions_destroy_fn = AMD::hsa_amd_cu_partitions_destroy;
+  amd_ext_api.hsa_amd_queue_cu_set_dispatch_mask_fn = AMD::hsa_amd_queue_cu_set_dispatch_mask;
+  amd_ext_api.hsa_amd_memory_pool_allocate_async_fn = AMD::hsa_amd_memory_pool_allocate_async;
+  amd_ext_api.hsa_amd_memory_pool_free_async_fn = AMD::hsa_amd_memory_pool_free_async;
+  amd_ext_api.hsa_amd_register_memory_pressure_callback_fn = AMD::hsa_amd_register_memory_pressure_callback;
+  amd_ext_api.hsa_amd_deregister_memory_pressure_callback_fn = AMD::hsa_amd_deregister_memory_pressure_callback;
+  amd_ext_api.hsa_amd_memory_pool_allocate_interleaved_fn = AMD::hsa_amd_memory_pool_allocate_interleaved;
+  amd_ext_api.hsa_amd_memory_pool_free_interleaved_fn = AMD::hsa_amd_memory_pool_free_interleaved;
+  amd_ext_api.hsa_amd_memory_pool_allocate_batch_fn = AMD::hsa_amd_memory_pool_allocate_batch;
+  amd_ext_api.hsa_amd_memory_pool_reserve_fn = AMD::hsa_amd_memory_pool_reserve;
+  amd_ext_api.hsa_amd_memory_pool_release_reservation_fn = AMD::hsa_amd_memory_pool_release_reservation;
+  amd_ext_api.hsa_amd_dispatch_graph_create_fn = AMD::hsa_amd_dispatch_graph_create;
+  amd_ext_api.hsa_amd_dispatch_graph_launch_fn = AMD::hsa_amd_dispatch_graph_launch;
+  amd_ext_api.hsa_amd_dispatch_graph_destroy_fn = AMD::hsa_amd_dispatch_graph_destroy;
+  amd_ext_api.hsa_amd_queue_suspend_fn = AMD::hsa_amd_queue_suspend;
+  amd_ext_api.hsa_amd_queue_resume_fn = AMD::hsa_amd_queue_resume;
+  amd_ext_api.hsa_amd_profiling_set_dispatch_filter_fn = AMD::hsa_amd_profiling_set_dispatch_filter;
+  amd_ext_api.hsa_amd_system_get_properties_fn = AMD::hsa_amd_system_get_properties;
+  amd_ext_api.hsa_amd_gpu_fault_records_get_fn = AMD::hsa_amd_gpu_fault_records_get;
+  amd_ext_api.hsa_amd_completion_queue_create_fn = AMD::hsa_amd_completion_queue_create;
+  amd_ext_api.hsa_amd_completion_queue_destroy_fn = AMD::hsa_amd_completion_queue_destroy;
+  amd_ext_api.hsa_amd_completion_queue_signal_create_fn = AMD::hsa_amd_completion_queue_signal_create;
+  amd_ext_api.hsa_amd_completion_queue_dequeue_fn = AMD::hsa_amd_completion_queue_dequeue;
+  amd_ext_api.hsa_amd_topology_get_fn = AMD::hsa_amd_topology_get;
+  amd_ext_api.hsa_amd_runtime_thread_policy_set_fn = AMD::hsa_amd_runtime_thread_policy_set;
+  amd_ext_api.hsa_amd_memory_async_copy_gang_fn = AMD::hsa_amd_memory_async_copy_gang;
+  amd_ext_api.hsa_amd_memory_copy_engine_hints_fn = AMD::hsa_amd_memory_copy_engine_hints;
+  amd_ext_api.hsa_amd_memory_set_device_only_fn = AMD::hsa_amd_memory_set_device_only;
+  amd_ext_api.hsa_amd_progress_counter_create_fn = AMD::hsa_amd_progress_counter_create;
+  amd_ext_api.hsa_amd_progress_counter_destroy_fn = AMD::hsa_amd_progress_counter_destroy;
+  amd_ext_api.hsa_amd_progress_counter_wait_fn = AMD::hsa_amd_progress_counter_wait;
+  amd_ext_api.hsa_amd_memory_migrate_async_fn = AMD::hsa_amd_memory_migrate_async;
+  amd_ext_api.hsa_amd_interop_cache_invalidate_fn = AMD::hsa_amd_interop_cache_invalidate;
+  amd_ext_api.hsa_amd_profiling_get_agent_tick_fn = AMD::hsa_amd_profiling_get_agent_tick;
 }
 
 void HsaApiTable::UpdateTools() {
@@ -51,9 +51,14 @@
 
 #include "core/inc/agent.h"
 #include "core/inc/amd_aie_agent.h"
+#include "core/inc/amd_blit_sdma.h"
 #include "core/inc/amd_cpu_agent.h"
+#include "core/inc/amd_cu_partitions.h"
+#include "core/inc/amd_dispatch_graph.h"
 #include "core/inc/amd_gpu_agent.h"
 #include "core/inc/amd_memory_region.h"
+#include "core/inc/amd_xdna_driver.h"
+#include "core/inc/cache.h"
 #include "core/inc/default_signal.h"
 #include "core/inc/exceptions.h"
 #include "core/inc/intercept_queue.h"
@@ -91,6 +96,41 @@ struct ValidityError<core::Queue*> {
   enum { value = HSA_STATUS_ERROR_INVALID_QUEUE };
 };
 
+template <>
+struct ValidityError<core::SignalWaitSet*> {
+  enum { value = HSA_STATUS_ERROR_INVALID_ARGUMENT };
+};
+
+template <>
+struct ValidityError<core::CompletionQueue*> {
+  enum { value = HSA_STATUS_ERROR_INVALID_ARGUMENT };
+};
+
+template <>
+struct ValidityError<core::ProgressCounter*> {
+  enum { value = HSA_STATUS_ERROR_INVALID_ARGUMENT };
+};
+
+template <>
+struct ValidityError<AMD::CopyList*> {
+  enum { value = HSA_STATUS_ERROR_INVALID_ARGUMENT };
+};
+
+template <>
+struct ValidityError<AMD::CopyContext*> {
+  enum { value = HSA_STATUS_ERROR_INVALID_ARGUMENT };
+};
+
+template <>
+struct ValidityError<AMD::CuPartitions*> {
+  enum { value = HSA_STATUS_ERROR_INVALID_ARGUMENT };
+};
+
+template <>
+struct ValidityError<AMD::DispatchGraph*> {
+  enum { value = HSA_STATUS_ERROR_INVALID_ARGUMENT };
+};
+
 template <class T>
 struct ValidityError<const T*> {
   enum { value = ValidityError<T*>::value };
@@ -249,6 +289,40 @@ hsa_status_t hsa_amd_memory_fill(void* ptr, uint32_t value, size_t count) {
   CATCH;
 }
 
+hsa_status_t hsa_amd_memory_fill_async(void* ptr, const void* pattern, uint32_t pattern_size,
+                                       size_t count, uint32_t num_dep_signals,
+                                       const hsa_signal_t* dep_signals,
+                                       hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(ptr);
+  IS_BAD_PTR(pattern);
+  IS_ZERO(count);
+
+  if ((pattern_size == 0) || (pattern_size > 16) || !IsPowerOfTwo(pattern_size)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if ((num_dep_signals == 0 && dep_signals != nullptr) ||
+      (num_dep_signals > 0 && dep_signals == nullptr)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::vector<core::Signal*> dep_signal_list(num_dep_signals);
+  for (size_t i = 0; i < num_dep_signals; ++i) {
+    core::Signal* dep_signal_obj = core::Signal::Convert(dep_signals[i]);
+    IS_VALID(dep_signal_obj);
+    dep_signal_list[i] = dep_signal_obj;
+  }
+
+  core::Signal* out_signal_obj = core::Signal::Convert(completion_signal);
+  IS_VALID(out_signal_obj);
+
+  return core::Runtime::runtime_singleton_->FillMemoryAsync(ptr, pattern, pattern_size, count,
+                                                            dep_signal_list, *out_signal_obj);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_memory_async_copy(void* dst, hsa_agent_t dst_agent_handle, const void* src,
                                        hsa_agent_t src_agent_handle, size_t size,
                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
@@ -292,15 +366,168 @@ hsa_status_t hsa_amd_memory_async_copy(void* dst, hsa_agent_t dst_agent_handle,
   CATCH;
 }
 
+hsa_status_t hsa_amd_memory_async_copy_batch(const hsa_amd_memory_copy_descriptor_t* copies,
+                                             uint32_t num_copies, hsa_agent_t dst_agent_handle,
+                                             hsa_agent_t src_agent_handle,
+                                             uint32_t num_dep_signals,
+                                             const hsa_signal_t* dep_signals,
+                                             hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(copies);
+  IS_ZERO(num_copies);
+
+  if ((num_dep_signals == 0 && dep_signals != nullptr) ||
+      (num_dep_signals > 0 && dep_signals == nullptr)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  for (uint32_t i = 0; i < num_copies; i++) {
+    if (copies[i].size != 0) {
+      IS_BAD_PTR(copies[i].dst);
+      IS_BAD_PTR(copies[i].src);
+    }
+  }
+
+  core::Agent* dst_agent = core::Agent::Convert(dst_agent_handle);
+  IS_VALID(dst_agent);
+
+  core::Agent* src_agent = core::Agent::Convert(src_agent_handle);
+  IS_VALID(src_agent);
+
+  std::vector<core::Signal*> dep_signal_list(num_dep_signals);
+  for (size_t i = 0; i < num_dep_signals; ++i) {
+    core::Signal* dep_signal_obj = core::Signal::Convert(dep_signals[i]);
+    IS_VALID(dep_signal_obj);
+    dep_signal_list[i] = dep_signal_obj;
+  }
+
+  core::Signal* out_signal_obj = core::Signal::Convert(completion_signal);
+  IS_VALID(out_signal_obj);
+
+  bool rev_copy_dir = core::Runtime::runtime_singleton_->flag().rev_copy_dir();
+  return core::Runtime::runtime_singleton_->CopyMemoryBatch(
+      copies, num_copies, (rev_copy_dir ? src_agent : dst_agent),
+      (rev_copy_dir ? dst_agent : src_agent), dep_signal_list, *out_signal_obj);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_async_copy_strided(const hsa_amd_memory_copy_strided_t* blocks,
+                                               uint32_t num_blocks, hsa_agent_t dst_agent_handle,
+                                               hsa_agent_t src_agent_handle,
+                                               uint32_t num_dep_signals,
+                                               const hsa_signal_t* dep_signals,
+                                               hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(blocks);
+  IS_ZERO(num_blocks);
+
+  if ((num_dep_signals == 0 && dep_signals != nullptr) ||
+      (num_dep_signals > 0 && dep_signals == nullptr)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  for (uint32_t i = 0; i < num_blocks; i++) {
+    const hsa_amd_memory_copy_strided_t& block = blocks[i];
+    if (block.width == 0) continue;
+    IS_BAD_PTR(block.dst);
+    IS_BAD_PTR(block.src);
+    IS_ZERO(block.height);
+    IS_ZERO(block.depth);
+    if ((block.height > 1) && ((block.dst_pitch < block.width) || (block.src_pitch < block.width)))
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    if (block.depth > 1) {
+      const size_t dst_rows = (block.height - 1) * block.dst_pitch + block.width;
+      const size_t src_rows = (block.height - 1) * block.src_pitch + block.width;
+      if ((block.dst_slice < dst_rows) || (block.src_slice < src_rows))
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+  }
+
+  core::Agent* dst_agent = core::Agent::Convert(dst_agent_handle);
+  IS_VALID(dst_agent);
+
+  core::Agent* src_agent = core::Agent::Convert(src_agent_handle);
+  IS_VALID(src_agent);
+
+  std::vector<core::Signal*> dep_signal_list(num_dep_signals);
+  for (size_t i = 0; i < num_dep_signals; ++i) {
+    core::Signal* dep_signal_obj = core::Signal::Convert(dep_signals[i]);
+    IS_VALID(dep_signal_obj);
+    dep_signal_list[i] = dep_signal_obj;
+  }
+
+  core::Signal* out_signal_obj = core::Signal::Convert(completion_signal);
+  IS_VALID(out_signal_obj);
+
+  bool rev_copy_dir = core::Runtime::runtime_singleton_->flag().rev_copy_dir();
+  return core::Runtime::runtime_singleton_->CopyMemoryStrided(
+      blocks, num_blocks, (rev_copy_dir ? src_agent : dst_agent),
+      (rev_copy_dir ? dst_agent : src_agent), dep_signal_list, *out_signal_obj);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_async_copy_stream(const void* src, hsa_agent_t src_agent_handle,
+                                              size_t size,
+                                              hsa_amd_copy_stream_callback_t callback,
+                                              void* user_data, uint32_t num_dep_signals,
+                                              const hsa_signal_t* dep_signals,
+                                              hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(src);
+  IS_BAD_PTR(callback);
+  IS_ZERO(size);
+
+  if ((num_dep_signals == 0 && dep_signals != nullptr) ||
+      (num_dep_signals > 0 && dep_signals == nullptr)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  core::Agent* src_agent = core::Agent::Convert(src_agent_handle);
+  IS_VALID(src_agent);
+
+  std::vector<core::Signal*> dep_signal_list(num_dep_signals);
+  for (size_t i = 0; i < num_dep_signals; ++i) {
+    core::Signal* dep_signal_obj = core::Signal::Convert(dep_signals[i]);
+    IS_VALID(dep_signal_obj);
+    dep_signal_list[i] = dep_signal_obj;
+  }
+
+  core::Signal* out_signal_obj = core::Signal::Convert(completion_signal);
+  IS_VALID(out_signal_obj);
+
+  return core::Runtime::runtime_singleton_->CopyMemoryStream(src, src_agent, size, callback,
+                                                             user_data, dep_signal_list,
+                                                             *out_signal_obj);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_memory_async_copy_on_engine(void* dst, hsa_agent_t dst_agent_handle,
                                        const void* src, hsa_agent_t src_agent_handle, size_t size,
                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
                                        hsa_signal_t completion_signal, hsa_amd_sdma_engine_id_t engine_id,
                                        bool force_copy_on_sdma) {
+  return AMD::hsa_amd_memory_async_copy_on_engine_with_priority(
+      dst, dst_agent_handle, src, src_agent_handle, size, num_dep_signals, dep_signals,
+      completion_signal, engine_id, force_copy_on_sdma, HSA_AMD_QUEUE_PRIORITY_NORMAL);
+}
+
+hsa_status_t hsa_amd_memory_async_copy_on_engine_with_priority(
+    void* dst, hsa_agent_t dst_agent_handle, const void* src, hsa_agent_t src_agent_handle,
+    size_t size, uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+    hsa_signal_t completion_signal, hsa_amd_sdma_engine_id_t engine_id, bool force_copy_on_sdma,
+    hsa_amd_queue_priority_t priority) {
   TRY;
   IS_BAD_PTR(dst);
   IS_BAD_PTR(src);
 
+  if ((priority != HSA_AMD_QUEUE_PRIORITY_LOW) && (priority != HSA_AMD_QUEUE_PRIORITY_NORMAL) &&
+      (priority != HSA_AMD_QUEUE_PRIORITY_HIGH)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
   if ((num_dep_signals == 0 && dep_signals != nullptr) ||
       (num_dep_signals > 0 && dep_signals == nullptr)) {
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
@@ -329,7 +556,58 @@ hsa_status_t hsa_amd_memory_async_copy_on_engine(void* dst, hsa_agent_t dst_agen
     return core::Runtime::runtime_singleton_->CopyMemoryOnEngine(
         dst, (rev_copy_dir ? src_agent : dst_agent),
         src, (rev_copy_dir ? dst_agent : src_agent),
-        size, dep_signal_list, *out_signal_obj, engine_id, force_copy_on_sdma);
+        size, dep_signal_list, *out_signal_obj, engine_id, force_copy_on_sdma, priority);
+  }
+
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_async_copy_gang(void* dst, hsa_agent_t dst_agent_handle,
+                                            const void* src, hsa_agent_t src_agent_handle,
+                                            size_t size, uint32_t num_dep_signals,
+                                            const hsa_signal_t* dep_signals,
+                                            hsa_signal_t completion_signal,
+                                            const hsa_amd_gang_copy_policy_t* policy) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(dst);
+  IS_BAD_PTR(src);
+  IS_BAD_PTR(policy);
+
+  if (policy->leader != HSA_AMD_GANG_LEADER_DEFAULT &&
+      policy->leader != HSA_AMD_GANG_LEADER_LEAST_BUSY &&
+      policy->leader != HSA_AMD_GANG_LEADER_ENGINE) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if ((num_dep_signals == 0 && dep_signals != nullptr) ||
+      (num_dep_signals > 0 && dep_signals == nullptr)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  core::Agent* dst_agent = core::Agent::Convert(dst_agent_handle);
+  IS_VALID(dst_agent);
+
+  core::Agent* src_agent = core::Agent::Convert(src_agent_handle);
+  IS_VALID(src_agent);
+
+  std::vector<core::Signal*> dep_signal_list(num_dep_signals);
+  for (size_t i = 0; i < num_dep_signals; ++i) {
+    core::Signal* dep_signal_obj = core::Signal::Convert(dep_signals[i]);
+    IS_VALID(dep_signal_obj);
+    dep_signal_list[i] = dep_signal_obj;
+  }
+
+  core::Signal* out_signal_obj = core::Signal::Convert(completion_signal);
+  IS_VALID(out_signal_obj);
+
+  bool rev_copy_dir = core::Runtime::runtime_singleton_->flag().rev_copy_dir();
+  if (size > 0) {
+    return core::Runtime::runtime_singleton_->CopyMemoryGang(
+        dst, (rev_copy_dir ? src_agent : dst_agent),
+        src, (rev_copy_dir ? dst_agent : src_agent),
+        size, dep_signal_list, *out_signal_obj, *policy);
   }
 
   return HSA_STATUS_SUCCESS;
@@ -347,6 +625,23 @@ hsa_status_t hsa_amd_memory_copy_engine_status(hsa_agent_t dst_agent_handle, hsa
   return core::Runtime::runtime_singleton_->CopyMemoryStatus(dst_agent, src_agent, engine_ids_mask);
 }
 
+hsa_status_t hsa_amd_memory_copy_engine_hints(hsa_agent_t dst_agent_handle,
+                                             hsa_agent_t src_agent_handle,
+                                             hsa_amd_copy_engine_hints_t* hints) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(hints);
+
+  core::Agent* dst_agent = core::Agent::Convert(dst_agent_handle);
+  IS_VALID(dst_agent);
+
+  core::Agent* src_agent = core::Agent::Convert(src_agent_handle);
+  IS_VALID(src_agent);
+
+  return core::Runtime::runtime_singleton_->CopyEngineHints(dst_agent, src_agent, hints);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_memory_async_copy_rect(
     const hsa_pitched_ptr_t* dst, const hsa_dim3_t* dst_offset, const hsa_pitched_ptr_t* src,
     const hsa_dim3_t* src_offset, const hsa_dim3_t* range, hsa_agent_t copy_agent,
@@ -406,6 +701,24 @@ hsa_status_t hsa_amd_profiling_set_profiler_enabled(hsa_queue_t* queue, int enab
   CATCH;
 }
 
+hsa_status_t hsa_amd_profiling_set_dispatch_filter(hsa_queue_t* queue,
+                                                   uint32_t kernel_object_count,
+                                                   const uint64_t* kernel_objects,
+                                                   uint32_t sample_interval) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(queue);
+  if (kernel_object_count != 0) IS_BAD_PTR(kernel_objects);
+
+  core::Queue* cmd_queue = core::Queue::Convert(queue);
+  IS_VALID(cmd_queue);
+  if (!core::InterceptQueue::IsType(cmd_queue)) return HSA_STATUS_ERROR_INVALID_QUEUE;
+
+  core::InterceptQueue* iQueue = static_cast<core::InterceptQueue*>(cmd_queue);
+  return iQueue->SetProfilingFilter(kernel_objects, kernel_object_count, sample_interval);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_profiling_async_copy_enable(bool enable) {
   TRY;
   IS_OPEN();
@@ -508,6 +821,35 @@ hsa_status_t hsa_amd_profiling_convert_tick_to_system_domain(hsa_agent_t agent_h
   CATCH;
 }
 
+hsa_status_t hsa_amd_profiling_get_clock_params(hsa_agent_t agent_handle,
+                                                const hsa_amd_clock_params_t** params) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(params);
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  IS_VALID(agent);
+  if (agent->device_type() != core::Agent::kAmdGpuDevice) return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  *params = static_cast<AMD::GpuAgent*>(agent)->clock_params();
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_profiling_get_agent_tick(hsa_agent_t agent_handle, uint64_t* agent_tick) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(agent_tick);
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  IS_VALID(agent);
+  if (agent->device_type() != core::Agent::kAmdGpuDevice) return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  *agent_tick = static_cast<AMD::GpuAgent*>(agent)->ReadClock();
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
 hsa_status_t hsa_amd_signal_create(hsa_signal_value_t initial_value, uint32_t num_consumers,
                                    const hsa_agent_t* consumers, uint64_t attributes,
                                    hsa_signal_t* hsa_signal) {
@@ -570,6 +912,36 @@ hsa_status_t hsa_amd_signal_value_pointer(hsa_signal_t hsa_signal,
   CATCH;
 }
 
+hsa_status_t hsa_amd_signal_get_eventfd(hsa_signal_t hsa_signal, int* fd) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(fd);
+  core::Signal* signal = core::Signal::Convert(hsa_signal);
+  IS_VALID(signal);
+
+  if (!core::InterruptSignal::IsType(signal)) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  return static_cast<core::InterruptSignal*>(signal)->GetEventFd(fd);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_signal_wait_policy(hsa_signal_t hsa_signal,
+                                        hsa_amd_signal_wait_policy_t policy) {
+  TRY;
+  IS_OPEN();
+  core::Signal* signal = core::Signal::Convert(hsa_signal);
+  IS_VALID(signal);
+
+  if (policy != HSA_AMD_SIGNAL_WAIT_POLICY_DEFAULT && policy != HSA_AMD_SIGNAL_WAIT_POLICY_FIXED &&
+      policy != HSA_AMD_SIGNAL_WAIT_POLICY_ADAPTIVE)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  signal->set_wait_policy(policy);
+  return HSA_STATUS_SUCCESS;
+
+  CATCH;
+}
+
 uint32_t hsa_amd_signal_wait_any(uint32_t signal_count, hsa_signal_t* hsa_signals,
                                  hsa_signal_condition_t* conds, hsa_signal_value_t* values,
                                  uint64_t timeout_hint, hsa_wait_state_t wait_hint,
@@ -590,44 +962,219 @@ uint32_t hsa_amd_signal_wait_any(uint32_t signal_count, hsa_signal_t* hsa_signal
   CATCHRET(uint32_t);
 }
 
-hsa_status_t hsa_amd_signal_async_handler(hsa_signal_t hsa_signal, hsa_signal_condition_t cond,
-                                          hsa_signal_value_t value, hsa_amd_signal_handler handler,
-                                          void* arg) {
+hsa_status_t hsa_amd_signal_wait_set_create(hsa_amd_signal_wait_set_t* wait_set) {
   TRY;
   IS_OPEN();
-  IS_BAD_PTR(handler);
-
-  core::Signal* signal = core::Signal::Convert(hsa_signal);
-  IS_VALID(signal);
-  if (core::g_use_interrupt_wait && (!core::InterruptSignal::IsType(signal)))
-    return HSA_STATUS_ERROR_INVALID_SIGNAL;
-  return core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
-      hsa_signal, cond, value, handler, arg);
+  IS_BAD_PTR(wait_set);
+  core::SignalWaitSet* set = new core::SignalWaitSet();
+  CHECK_ALLOC(set);
+  *wait_set = core::SignalWaitSet::Convert(set);
+  return HSA_STATUS_SUCCESS;
   CATCH;
 }
 
-hsa_status_t hsa_amd_async_function(void (*callback)(void* arg), void* arg) {
+hsa_status_t hsa_amd_signal_wait_set_destroy(hsa_amd_signal_wait_set_t wait_set) {
   TRY;
   IS_OPEN();
-
-  IS_BAD_PTR(callback);
-  static const hsa_signal_t null_signal = {0};
-  return core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
-      null_signal, HSA_SIGNAL_CONDITION_EQ, 0, (hsa_amd_signal_handler)callback,
-      arg);
+  core::SignalWaitSet* set = core::SignalWaitSet::Convert(wait_set);
+  IS_VALID(set);
+  delete set;
+  return HSA_STATUS_SUCCESS;
   CATCH;
 }
 
-hsa_status_t hsa_amd_queue_cu_set_mask(const hsa_queue_t* queue, uint32_t num_cu_mask_count,
-                                       const uint32_t* cu_mask) {
+hsa_status_t hsa_amd_signal_wait_set_add(hsa_amd_signal_wait_set_t wait_set,
+                                         hsa_signal_t hsa_signal,
+                                         hsa_signal_condition_t condition,
+                                         hsa_signal_value_t compare_value) {
   TRY;
   IS_OPEN();
-
-  core::Queue* cmd_queue = core::Queue::Convert(queue);
-  IS_VALID(cmd_queue);
-  if (num_cu_mask_count != 0) IS_BAD_PTR(cu_mask);
-  if (num_cu_mask_count % 32 != 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
-  return cmd_queue->SetCUMasking(num_cu_mask_count, cu_mask);
+  core::SignalWaitSet* set = core::SignalWaitSet::Convert(wait_set);
+  IS_VALID(set);
+  core::Signal* signal = core::Signal::Convert(hsa_signal);
+  IS_VALID(signal);
+  return set->Add(hsa_signal, condition, compare_value);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_signal_wait_set_remove(hsa_amd_signal_wait_set_t wait_set,
+                                            hsa_signal_t hsa_signal) {
+  TRY;
+  IS_OPEN();
+  core::SignalWaitSet* set = core::SignalWaitSet::Convert(wait_set);
+  IS_VALID(set);
+  return set->Remove(hsa_signal);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_signal_wait_set_wait(hsa_amd_signal_wait_set_t wait_set,
+                                          uint64_t timeout_hint, hsa_wait_state_t wait_hint,
+                                          uint32_t max_ready, hsa_signal_t* ready_signals,
+                                          hsa_signal_value_t* ready_values,
+                                          uint32_t* ready_count) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(ready_signals);
+  IS_BAD_PTR(ready_count);
+  core::SignalWaitSet* set = core::SignalWaitSet::Convert(wait_set);
+  IS_VALID(set);
+  set->Wait(timeout_hint, wait_hint, max_ready, ready_signals, ready_values, ready_count);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_completion_queue_create(uint32_t size, hsa_amd_completion_queue_t* queue) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(queue);
+  IS_ZERO(size);
+  core::CompletionQueue* cq = new core::CompletionQueue(size);
+  CHECK_ALLOC(cq);
+  *queue = core::CompletionQueue::Convert(cq);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_completion_queue_destroy(hsa_amd_completion_queue_t queue) {
+  TRY;
+  IS_OPEN();
+  core::CompletionQueue* cq = core::CompletionQueue::Convert(queue);
+  IS_VALID(cq);
+  delete cq;
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_completion_queue_signal_create(hsa_amd_completion_queue_t queue,
+                                                    hsa_signal_value_t initial_value, uint64_t tag,
+                                                    hsa_signal_t* signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(signal);
+  core::CompletionQueue* cq = core::CompletionQueue::Convert(queue);
+  IS_VALID(cq);
+  return cq->CreateSignal(initial_value, tag, signal);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_completion_queue_dequeue(hsa_amd_completion_queue_t queue,
+                                              uint64_t timeout_hint, hsa_wait_state_t wait_hint,
+                                              uint32_t max_records,
+                                              hsa_amd_completion_record_t* records,
+                                              uint32_t* count) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(records);
+  IS_BAD_PTR(count);
+  core::CompletionQueue* cq = core::CompletionQueue::Convert(queue);
+  IS_VALID(cq);
+  cq->Dequeue(timeout_hint, wait_hint, max_records, records, count);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_progress_counter_create(hsa_agent_t agent_handle, uint64_t initial_value,
+                                             uint32_t flags, hsa_amd_progress_counter_t* counter,
+                                             hsa_amd_progress_counter_abi_t** abi) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(counter);
+  IS_BAD_PTR(abi);
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  IS_VALID(agent);
+  if ((flags & ~uint32_t(HSA_AMD_PROGRESS_COUNTER_INTERRUPT)) != 0)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  core::ProgressCounter* pc = new core::ProgressCounter(
+      agent->node_id(), initial_value, (flags & HSA_AMD_PROGRESS_COUNTER_INTERRUPT) != 0);
+  CHECK_ALLOC(pc);
+  *counter = core::ProgressCounter::Convert(pc);
+  *abi = pc->abi();
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_progress_counter_destroy(hsa_amd_progress_counter_t counter) {
+  TRY;
+  IS_OPEN();
+  core::ProgressCounter* pc = core::ProgressCounter::Convert(counter);
+  IS_VALID(pc);
+  delete pc;
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_progress_counter_wait(hsa_amd_progress_counter_t counter, uint64_t threshold,
+                                           uint64_t timeout_hint, hsa_wait_state_t wait_hint,
+                                           uint64_t* value) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(value);
+  core::ProgressCounter* pc = core::ProgressCounter::Convert(counter);
+  IS_VALID(pc);
+  *value = pc->Wait(threshold, timeout_hint, wait_hint);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_signal_async_handler(hsa_signal_t hsa_signal, hsa_signal_condition_t cond,
+                                          hsa_signal_value_t value, hsa_amd_signal_handler handler,
+                                          void* arg) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(handler);
+
+  core::Signal* signal = core::Signal::Convert(hsa_signal);
+  IS_VALID(signal);
+  if (core::g_use_interrupt_wait && (!core::InterruptSignal::IsType(signal)))
+    return HSA_STATUS_ERROR_INVALID_SIGNAL;
+  return core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
+      hsa_signal, cond, value, handler, arg);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_signal_async_handler_with_flags(hsa_signal_t hsa_signal,
+                                                     hsa_signal_condition_t cond,
+                                                     hsa_signal_value_t value,
+                                                     hsa_amd_signal_handler handler, void* arg,
+                                                     uint64_t flags) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(handler);
+  if ((flags & ~uint64_t(HSA_AMD_SIGNAL_HANDLER_LATENCY_CRITICAL)) != 0)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  core::Signal* signal = core::Signal::Convert(hsa_signal);
+  IS_VALID(signal);
+  if (core::g_use_interrupt_wait && (!core::InterruptSignal::IsType(signal)))
+    return HSA_STATUS_ERROR_INVALID_SIGNAL;
+  return core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
+      hsa_signal, cond, value, handler, arg, flags & HSA_AMD_SIGNAL_HANDLER_LATENCY_CRITICAL);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_async_function(void (*callback)(void* arg), void* arg) {
+  TRY;
+  IS_OPEN();
+
+  IS_BAD_PTR(callback);
+  static const hsa_signal_t null_signal = {0};
+  return core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
+      null_signal, HSA_SIGNAL_CONDITION_EQ, 0, (hsa_amd_signal_handler)callback,
+      arg);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_queue_cu_set_mask(const hsa_queue_t* queue, uint32_t num_cu_mask_count,
+                                       const uint32_t* cu_mask) {
+  TRY;
+  IS_OPEN();
+
+  core::Queue* cmd_queue = core::Queue::Convert(queue);
+  IS_VALID(cmd_queue);
+  if (num_cu_mask_count != 0) IS_BAD_PTR(cu_mask);
+  if (num_cu_mask_count % 32 != 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  return cmd_queue->SetCUMasking(num_cu_mask_count, cu_mask);
   CATCH;
 }
 
@@ -645,6 +1192,104 @@ hsa_status_t hsa_amd_queue_cu_get_mask(const hsa_queue_t* queue, uint32_t num_cu
   CATCH;
 }
 
+hsa_status_t hsa_amd_queue_cu_set_dispatch_mask(const hsa_queue_t* queue,
+                                                uint32_t num_cu_mask_count,
+                                                const uint32_t* cu_mask) {
+  TRY;
+  IS_OPEN();
+
+  core::Queue* cmd_queue = core::Queue::Convert(queue);
+  IS_VALID(cmd_queue);
+  if (num_cu_mask_count != 0) IS_BAD_PTR(cu_mask);
+  if (num_cu_mask_count % 32 != 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  return cmd_queue->SetDispatchCUMasking(num_cu_mask_count, cu_mask);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_cu_partitions_create(hsa_agent_t agent_handle, uint32_t num_partitions,
+                                          hsa_amd_cu_partitions_t* partitions) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(partitions);
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  IS_VALID(agent);
+  if (agent->device_type() != core::Agent::kAmdGpuDevice) return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  AMD::GpuAgent* gpu_agent = static_cast<AMD::GpuAgent*>(agent);
+  if (num_partitions == 0 || num_partitions > AMD::CuPartitions::slice_count(gpu_agent))
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  *partitions = AMD::CuPartitions::Convert(new AMD::CuPartitions(gpu_agent, num_partitions));
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_cu_partitions_bind_queue(hsa_amd_cu_partitions_t partitions,
+                                              hsa_queue_t* queue, uint32_t index) {
+  TRY;
+  IS_OPEN();
+
+  AMD::CuPartitions* cu_partitions = AMD::CuPartitions::Convert(partitions);
+  IS_VALID(cu_partitions);
+  core::Queue* cmd_queue = core::Queue::Convert(queue);
+  IS_VALID(cmd_queue);
+
+  return cu_partitions->Bind(cmd_queue, index);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_cu_partitions_rebalance(hsa_amd_cu_partitions_t partitions) {
+  TRY;
+  IS_OPEN();
+
+  AMD::CuPartitions* cu_partitions = AMD::CuPartitions::Convert(partitions);
+  IS_VALID(cu_partitions);
+
+  return cu_partitions->Rebalance();
+  CATCH;
+}
+
+hsa_status_t hsa_amd_cu_partitions_destroy(hsa_amd_cu_partitions_t partitions) {
+  TRY;
+  IS_OPEN();
+
+  AMD::CuPartitions* cu_partitions = AMD::CuPartitions::Convert(partitions);
+  IS_VALID(cu_partitions);
+
+  delete cu_partitions;
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_migrate_async(void* ptr, size_t size,
+                                          hsa_amd_memory_pool_t memory_pool, uint32_t flags,
+                                          uint32_t num_dep_signals,
+                                          const hsa_signal_t* dep_signals,
+                                          hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(ptr);
+  IS_ZERO(size);
+  if (flags != 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  if ((num_dep_signals != 0) && (dep_signals == nullptr)) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  hsa_region_t region = {memory_pool.handle};
+  const AMD::MemoryRegion* mem_region = AMD::MemoryRegion::Convert(region);
+  if (mem_region == nullptr || !mem_region->IsValid() ||
+      !(mem_region->IsLocalMemory() || mem_region->IsSystem()))
+    return static_cast<hsa_status_t>(HSA_STATUS_ERROR_INVALID_MEMORY_POOL);
+
+  for (uint32_t i = 0; i < num_dep_signals; i++) {
+    core::Signal* dep = core::Signal::Convert(dep_signals[i]);
+    IS_VALID(dep);
+  }
+
+  return core::Runtime::runtime_singleton_->MigrateAsync(ptr, size, mem_region, num_dep_signals,
+                                                         dep_signals, completion_signal);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_memory_lock(void* host_ptr, size_t size,
                                  hsa_agent_t* agents, int num_agent,
                                  void** agent_ptr) {
@@ -716,6 +1361,17 @@ hsa_status_t hsa_amd_memory_unlock(void* host_ptr) {
   CATCH;
 }
 
+hsa_status_t hsa_amd_memory_lock_cache_invalidate(void* ptr, size_t size) {
+  TRY;
+  IS_OPEN();
+
+  if (ptr == nullptr || size == 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  AMD::MemoryRegion::InvalidateLockCache(ptr, size);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
 hsa_status_t hsa_amd_memory_pool_get_info(hsa_amd_memory_pool_t memory_pool,
                                           hsa_amd_memory_pool_info_t attribute, void* value) {
   TRY;
@@ -768,12 +1424,50 @@ hsa_status_t hsa_amd_agent_iterate_memory_pools(
   CATCH;
 }
 
+// Coarse grain requests conflict with the fine grain and uncached requests.
+static bool ValidPoolAllocateFlags(uint32_t flags) {
+  return !((flags & HSA_AMD_MEMORY_POOL_COARSE_GRAIN_FLAG) &&
+           (flags & (HSA_AMD_MEMORY_POOL_PCIE_FLAG | HSA_AMD_MEMORY_POOL_UNCACHED_FLAG)));
+}
+
+// Translates hsa_amd_memory_pool_allocate flags to region allocation flags.
+static MemoryRegion::AllocateFlags PoolAllocateFlags(uint32_t flags) {
+  MemoryRegion::AllocateFlags alloc_flag = core::MemoryRegion::AllocateRestrict;
+
+  if (flags & HSA_AMD_MEMORY_POOL_PCIE_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocatePCIeRW;
+
+  if (flags & HSA_AMD_MEMORY_POOL_CONTIGUOUS_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateContiguous;
+
+  if (flags & HSA_AMD_MEMORY_POOL_EXECUTABLE_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateExecutable;
+
+  if (flags & HSA_AMD_MEMORY_POOL_HUGEPAGE_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateHugePage;
+
+  if (flags & HSA_AMD_MEMORY_POOL_LARGE_PAGE_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateLargePage;
+
+  if (flags & HSA_AMD_MEMORY_POOL_COARSE_GRAIN_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateCoarseGrain;
+
+  if (flags & HSA_AMD_MEMORY_POOL_UNCACHED_FLAG)
+    alloc_flag |= core::MemoryRegion::AllocateUncached;
+
+#ifdef SANITIZER_AMDGPU
+  alloc_flag |= core::MemoryRegion::AllocateAsan;
+#endif
+
+  return alloc_flag;
+}
+
 hsa_status_t hsa_amd_memory_pool_allocate(hsa_amd_memory_pool_t memory_pool, size_t size,
                                           uint32_t flags, void** ptr) {
   TRY;
   IS_OPEN();
 
-  if (size == 0 || ptr == NULL) {
+  if (size == 0 || ptr == NULL || !ValidPoolAllocateFlags(flags)) {
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
@@ -784,27 +1478,55 @@ hsa_status_t hsa_amd_memory_pool_allocate(hsa_amd_memory_pool_t memory_pool, siz
     return (hsa_status_t)HSA_STATUS_ERROR_INVALID_MEMORY_POOL;
   }
 
-  MemoryRegion::AllocateFlags alloc_flag = core::MemoryRegion::AllocateRestrict;
+  return core::Runtime::runtime_singleton_->AllocateMemory(mem_region, size,
+                                                           PoolAllocateFlags(flags), ptr);
+  CATCH;
+}
 
-  if (flags & HSA_AMD_MEMORY_POOL_PCIE_FLAG)
-    alloc_flag |= core::MemoryRegion::AllocatePCIeRW;
+hsa_status_t hsa_amd_memory_pool_free(void* ptr) {
+  return HSA::hsa_memory_free(ptr);
+}
 
-  if (flags & HSA_AMD_MEMORY_POOL_CONTIGUOUS_FLAG)
-    alloc_flag |= core::MemoryRegion::AllocateContiguous;
+hsa_status_t hsa_amd_memory_pool_allocate_async(hsa_amd_memory_pool_t memory_pool, size_t size,
+                                                uint32_t flags, hsa_signal_t dep_signal,
+                                                void** ptr) {
+  TRY;
+  IS_OPEN();
 
-  if (flags & HSA_AMD_MEMORY_POOL_EXECUTABLE_FLAG)
-    alloc_flag |= core::MemoryRegion::AllocateExecutable;
+  if (size == 0 || ptr == NULL || !ValidPoolAllocateFlags(flags)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
 
-#ifdef SANITIZER_AMDGPU
-  alloc_flag |= core::MemoryRegion::AllocateAsan;
-#endif
+  hsa_region_t region = {memory_pool.handle};
+  const core::MemoryRegion* mem_region = core::MemoryRegion::Convert(region);
+
+  if (mem_region == NULL || !mem_region->IsValid()) {
+    return (hsa_status_t)HSA_STATUS_ERROR_INVALID_MEMORY_POOL;
+  }
+
+  core::Signal* dep_signal_obj = nullptr;
+  if (dep_signal.handle != 0) {
+    dep_signal_obj = core::Signal::Convert(dep_signal);
+    IS_VALID(dep_signal_obj);
+  }
 
-  return core::Runtime::runtime_singleton_->AllocateMemory(mem_region, size, alloc_flag, ptr);
+  return core::Runtime::runtime_singleton_->AllocateMemoryAsync(
+      mem_region, size, PoolAllocateFlags(flags), dep_signal_obj, ptr);
   CATCH;
 }
 
-hsa_status_t hsa_amd_memory_pool_free(void* ptr) {
-  return HSA::hsa_memory_free(ptr);
+hsa_status_t hsa_amd_memory_pool_free_async(void* ptr, hsa_signal_t dep_signal) {
+  TRY;
+  IS_OPEN();
+
+  core::Signal* dep_signal_obj = nullptr;
+  if (dep_signal.handle != 0) {
+    dep_signal_obj = core::Signal::Convert(dep_signal);
+    IS_VALID(dep_signal_obj);
+  }
+
+  return core::Runtime::runtime_singleton_->FreeMemoryAsync(ptr, dep_signal_obj);
+  CATCH;
 }
 
 hsa_status_t hsa_amd_agents_allow_access(uint32_t num_agents, const hsa_agent_t* agents,
@@ -821,6 +1543,22 @@ hsa_status_t hsa_amd_agents_allow_access(uint32_t num_agents, const hsa_agent_t*
   CATCH;
 }
 
+hsa_status_t hsa_amd_agents_allow_access_batch(uint32_t num_agents, const hsa_agent_t* agents,
+                                               const uint32_t* flags, uint32_t num_ptrs,
+                                               const void* const* ptrs) {
+  TRY;
+  IS_OPEN();
+
+  if (num_agents == 0 || agents == NULL || flags != NULL || num_ptrs == 0 || ptrs == NULL) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  for (uint32_t i = 0; i < num_ptrs; i++) IS_BAD_PTR(ptrs[i]);
+
+  return core::Runtime::runtime_singleton_->AllowAccess(num_agents, agents, num_ptrs, ptrs);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_memory_pool_can_migrate(hsa_amd_memory_pool_t src_memory_pool,
                                              hsa_amd_memory_pool_t dst_memory_pool, bool* result) {
   TRY;
@@ -897,11 +1635,248 @@ hsa_status_t hsa_amd_agent_memory_pool_get_info(
   CATCH;
 }
 
-hsa_status_t hsa_amd_interop_map_buffer(uint32_t num_agents,
-                                        hsa_agent_t* agents, int interop_handle,
-                                        uint32_t flags, size_t* size,
-                                        void** ptr, size_t* metadata_size,
-                                        const void** metadata) {
+hsa_status_t hsa_amd_system_get_properties(hsa_amd_system_properties_t* properties,
+                                           void* (*alloc)(size_t)) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(properties);
+  IS_BAD_PTR(alloc);
+  if (properties->size < sizeof(hsa_amd_system_properties_t))
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  // Same order as hsa_iterate_agents.
+  std::vector<core::Agent*> agents;
+  for (const std::vector<core::Agent*>* list : {&core::Runtime::runtime_singleton_->cpu_agents(),
+                                                &core::Runtime::runtime_singleton_->gpu_agents(),
+                                                &core::Runtime::runtime_singleton_->aie_agents()})
+    agents.insert(agents.end(), list->begin(), list->end());
+
+  auto append_pool = [](hsa_amd_memory_pool_t pool, void* data) {
+    static_cast<std::vector<hsa_amd_memory_pool_t>*>(data)->push_back(pool);
+    return HSA_STATUS_SUCCESS;
+  };
+  auto append_cache = [](hsa_cache_t cache, void* data) {
+    static_cast<std::vector<hsa_cache_t>*>(data)->push_back(cache);
+    return HSA_STATUS_SUCCESS;
+  };
+
+  std::vector<hsa_amd_memory_pool_t> pools;
+  std::vector<hsa_cache_t> caches;
+  std::vector<std::pair<uint32_t, uint32_t>> pool_ranges, cache_ranges;
+  for (core::Agent* agent : agents) {
+    uint32_t first_pool = pools.size(), first_cache = caches.size();
+    hsa_status_t status =
+        AMD::hsa_amd_agent_iterate_memory_pools(core::Agent::Convert(agent), append_pool, &pools);
+    if (status != HSA_STATUS_SUCCESS) return status;
+    status = agent->IterateCache(append_cache, &caches);
+    if (status != HSA_STATUS_SUCCESS) return status;
+    pool_ranges.emplace_back(first_pool, pools.size() - first_pool);
+    cache_ranges.emplace_back(first_cache, caches.size() - first_cache);
+  }
+
+  // Agent to pool links, skipping pairs that can never be accessed.
+  std::vector<hsa_amd_agent_pool_link_t> links;
+  std::vector<std::pair<uint32_t, uint32_t>> link_ranges;
+  std::vector<hsa_amd_memory_pool_link_info_t> hops;
+  for (core::Agent* agent : agents) {
+    uint32_t first_link = links.size();
+    for (hsa_amd_memory_pool_t pool : pools) {
+      const AMD::MemoryRegion* region = AMD::MemoryRegion::Convert(hsa_region_t{pool.handle});
+      hsa_amd_agent_pool_link_t link = {};
+      link.agent = core::Agent::Convert(agent);
+      link.pool = pool;
+      if (region->GetAgentPoolInfo(*agent, HSA_AMD_AGENT_MEMORY_POOL_INFO_ACCESS, &link.access) !=
+              HSA_STATUS_SUCCESS ||
+          link.access == HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED)
+        continue;
+      region->GetAgentPoolInfo(*agent, HSA_AMD_AGENT_MEMORY_POOL_INFO_NUM_LINK_HOPS,
+                               &link.num_hops);
+      if (link.num_hops != 0) {
+        hops.assign(link.num_hops, hsa_amd_memory_pool_link_info_t{});
+        if (region->GetAgentPoolInfo(*agent, HSA_AMD_AGENT_MEMORY_POOL_INFO_LINK_INFO,
+                                     hops.data()) == HSA_STATUS_SUCCESS)
+          link.link = hops[0];
+      }
+      links.push_back(link);
+    }
+    link_ranges.emplace_back(first_link, links.size() - first_link);
+  }
+
+  // One block holds all four arrays.
+  const size_t agents_size = AlignUp(agents.size() * sizeof(hsa_amd_agent_properties_t), 8);
+  const size_t pools_size = AlignUp(pools.size() * sizeof(hsa_amd_memory_pool_properties_t), 8);
+  const size_t caches_size = AlignUp(caches.size() * sizeof(hsa_amd_cache_properties_t), 8);
+  const size_t links_size = links.size() * sizeof(hsa_amd_agent_pool_link_t);
+  uint8_t* block =
+      static_cast<uint8_t*>(alloc(agents_size + pools_size + caches_size + links_size));
+  if (block == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  memset(block, 0, agents_size + pools_size + caches_size + links_size);
+  auto* agent_props = reinterpret_cast<hsa_amd_agent_properties_t*>(block);
+  auto* pool_props = reinterpret_cast<hsa_amd_memory_pool_properties_t*>(block + agents_size);
+  auto* cache_props =
+      reinterpret_cast<hsa_amd_cache_properties_t*>(block + agents_size + pools_size);
+  auto* link_props = reinterpret_cast<hsa_amd_agent_pool_link_t*>(block + agents_size +
+                                                                  pools_size + caches_size);
+
+  // Attributes an agent or pool does not support are left zero.
+  for (size_t i = 0; i < agents.size(); i++) {
+    core::Agent* agent = agents[i];
+    hsa_amd_agent_properties_t& props = agent_props[i];
+    auto info = [agent](uint32_t attribute, void* value) {
+      agent->GetInfo(static_cast<hsa_agent_info_t>(attribute), value);
+    };
+    props.agent = core::Agent::Convert(agent);
+    info(HSA_AGENT_INFO_DEVICE, &props.device_type);
+    info(HSA_AMD_AGENT_INFO_DRIVER_NODE_ID, &props.node_id);
+    info(HSA_AGENT_INFO_NAME, props.name);
+    info(HSA_AGENT_INFO_VENDOR_NAME, props.vendor_name);
+    info(HSA_AMD_AGENT_INFO_PRODUCT_NAME, props.product_name);
+    info(HSA_AMD_AGENT_INFO_UUID, props.uuid);
+    info(HSA_AMD_AGENT_INFO_CHIP_ID, &props.chip_id);
+    info(HSA_AMD_AGENT_INFO_ASIC_REVISION, &props.asic_revision);
+    info(HSA_AMD_AGENT_INFO_DOMAIN, &props.domain);
+    info(HSA_AMD_AGENT_INFO_BDFID, &props.bdfid);
+    info(HSA_AMD_AGENT_INFO_COMPUTE_UNIT_COUNT, &props.compute_unit_count);
+    info(HSA_AMD_AGENT_INFO_NUM_SIMDS_PER_CU, &props.simds_per_cu);
+    info(HSA_AMD_AGENT_INFO_NUM_SHADER_ENGINES, &props.shader_engines);
+    info(HSA_AMD_AGENT_INFO_MAX_WAVES_PER_CU, &props.max_waves_per_cu);
+    info(HSA_AGENT_INFO_WAVEFRONT_SIZE, &props.wavefront_size);
+    info(HSA_AMD_AGENT_INFO_MAX_CLOCK_FREQUENCY, &props.max_clock_frequency);
+    info(HSA_AMD_AGENT_INFO_CACHELINE_SIZE, &props.cacheline_size);
+    info(HSA_AGENT_INFO_QUEUE_MIN_SIZE, &props.queue_min_size);
+    info(HSA_AGENT_INFO_QUEUE_MAX_SIZE, &props.queue_max_size);
+    props.first_pool = pool_ranges[i].first;
+    props.num_pools = pool_ranges[i].second;
+    props.first_cache = cache_ranges[i].first;
+    props.num_caches = cache_ranges[i].second;
+    props.first_link = link_ranges[i].first;
+    props.num_links = link_ranges[i].second;
+
+    for (uint32_t j = props.first_pool; j < props.first_pool + props.num_pools; j++) {
+      const AMD::MemoryRegion* region = AMD::MemoryRegion::Convert(hsa_region_t{pools[j].handle});
+      hsa_amd_memory_pool_properties_t& pool = pool_props[j];
+      pool.pool = pools[j];
+      pool.owner = props.agent;
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_SEGMENT, &pool.segment);
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS, &pool.global_flags);
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_LOCATION, &pool.location);
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_SIZE, &pool.size);
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_ALLOC_MAX_SIZE, &pool.alloc_max_size);
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE, &pool.alloc_granule);
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_REC_GRANULE,
+                          &pool.alloc_rec_granule);
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALIGNMENT,
+                          &pool.alloc_alignment);
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED, &pool.alloc_allowed);
+      region->GetPoolInfo(HSA_AMD_MEMORY_POOL_INFO_ACCESSIBLE_BY_ALL, &pool.accessible_by_all);
+    }
+
+    for (uint32_t j = props.first_cache; j < props.first_cache + props.num_caches; j++) {
+      core::Cache* cache = core::Cache::Convert(caches[j]);
+      uint8_t level = 0;
+      cache->GetInfo(HSA_CACHE_INFO_LEVEL, &level);
+      cache_props[j].cache = caches[j];
+      cache_props[j].agent = props.agent;
+      cache_props[j].level = level;
+      cache_props[j].size = 0;
+      cache->GetInfo(HSA_CACHE_INFO_SIZE, &cache_props[j].size);
+    }
+  }
+  if (!links.empty()) memcpy(link_props, links.data(), links_size);
+
+  properties->size = sizeof(hsa_amd_system_properties_t);
+  properties->num_agents = agents.size();
+  properties->num_pools = pools.size();
+  properties->num_caches = caches.size();
+  properties->num_links = links.size();
+  properties->agents = agent_props;
+  properties->pools = pool_props;
+  properties->caches = cache_props;
+  properties->links = link_props;
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_topology_get(hsa_amd_topology_t* topology, void* (*alloc)(size_t)) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(topology);
+  IS_BAD_PTR(alloc);
+  if (topology->size < sizeof(hsa_amd_topology_t)) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  const core::Runtime::Topology& topo = core::Runtime::runtime_singleton_->topology();
+  const size_t count = topo.agents.size();
+  const size_t matrix = count * count;
+
+  // One block holds all arrays, 8 byte aligned members first.
+  const size_t agents_size = count * sizeof(hsa_agent_t);
+  const size_t nearest_size = AlignUp(topo.nearest.size() * sizeof(hsa_amd_topology_nearest_t), 8);
+  const size_t nics_size = AlignUp(topo.nics.size() * sizeof(hsa_amd_topology_nic_t), 8);
+  const size_t words = 4 * matrix + topo.cores.size();
+  const size_t total = agents_size + nearest_size + nics_size + words * sizeof(uint32_t);
+  uint8_t* block = static_cast<uint8_t*>(alloc(total));
+  if (block == nullptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  memset(block, 0, total);
+  auto* agents = reinterpret_cast<hsa_agent_t*>(block);
+  auto* nearest = reinterpret_cast<hsa_amd_topology_nearest_t*>(block + agents_size);
+  auto* nics = reinterpret_cast<hsa_amd_topology_nic_t*>(block + agents_size + nearest_size);
+  auto* hops = reinterpret_cast<uint32_t*>(block + agents_size + nearest_size + nics_size);
+  uint32_t* numa_distance = hops + matrix;
+  uint32_t* bandwidth = numa_distance + matrix;
+  uint32_t* latency = bandwidth + matrix;
+  uint32_t* cores = latency + matrix;
+
+  for (size_t i = 0; i < count; i++) agents[i] = core::Agent::Convert(topo.agents[i]);
+  for (size_t i = 0; i < topo.nearest.size(); i++) {
+    const core::Runtime::Topology::Nearest& src = topo.nearest[i];
+    nearest[i].gpu = core::Agent::Convert(src.gpu);
+    nearest[i].cpu = src.cpu ? core::Agent::Convert(src.cpu) : hsa_agent_t{0};
+    nearest[i].numa_node = src.numa_node;
+    nearest[i].first_core = src.first_core;
+    nearest[i].num_cores = src.num_cores;
+    nearest[i].first_nic = src.first_nic;
+    nearest[i].num_nics = src.num_nics;
+  }
+  if (!topo.nics.empty())
+    memcpy(nics, topo.nics.data(), topo.nics.size() * sizeof(hsa_amd_topology_nic_t));
+  if (matrix != 0) {
+    memcpy(hops, topo.hops.data(), matrix * sizeof(uint32_t));
+    memcpy(numa_distance, topo.numa_distance.data(), matrix * sizeof(uint32_t));
+    memcpy(bandwidth, topo.bandwidth.data(), matrix * sizeof(uint32_t));
+    memcpy(latency, topo.latency.data(), matrix * sizeof(uint32_t));
+  }
+  if (!topo.cores.empty()) memcpy(cores, topo.cores.data(), topo.cores.size() * sizeof(uint32_t));
+
+  topology->size = sizeof(hsa_amd_topology_t);
+  topology->num_agents = count;
+  topology->num_gpus = topo.nearest.size();
+  topology->num_cores = topo.cores.size();
+  topology->num_nics = topo.nics.size();
+  topology->agents = agents;
+  topology->hops = hops;
+  topology->numa_distance = numa_distance;
+  topology->bandwidth = bandwidth;
+  topology->latency = latency;
+  topology->nearest = nearest;
+  topology->cores = cores;
+  topology->nics = nics;
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_runtime_thread_policy_set(hsa_amd_thread_class_t thread_class,
+                                               const hsa_amd_thread_policy_t* policy) {
+  TRY;
+  IS_OPEN();
+  return core::Runtime::runtime_singleton_->SetThreadPolicy(thread_class, policy);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_interop_map_buffer(uint32_t num_agents,
+                                        hsa_agent_t* agents, int interop_handle,
+                                        uint32_t flags, size_t* size,
+                                        void** ptr, size_t* metadata_size,
+                                        const void** metadata) {
   static const int tinyArraySize=8;
   TRY;
   IS_OPEN();
@@ -944,6 +1919,13 @@ hsa_status_t hsa_amd_interop_unmap_buffer(void* ptr) {
   CATCH;
 }
 
+hsa_status_t hsa_amd_interop_cache_invalidate(int interop_handle) {
+  TRY;
+  IS_OPEN();
+  return core::Runtime::runtime_singleton_->InteropCacheInvalidate(interop_handle);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_pointer_info(const void* ptr, hsa_amd_pointer_info_t* info, void* (*alloc)(size_t),
                                   uint32_t* num_accessible, hsa_agent_t** accessible) {
   TRY;
@@ -1001,6 +1983,40 @@ hsa_status_t hsa_amd_ipc_memory_attach(const hsa_amd_ipc_memory_t* ipc, size_t l
   CATCH;
 }
 
+hsa_status_t hsa_amd_ipc_memory_attach_batch(const hsa_amd_ipc_memory_t* handles,
+                                             const size_t* lens, uint32_t count,
+                                             uint32_t num_agents,
+                                             const hsa_agent_t* mapping_agents,
+                                             void** mapped_ptrs) {
+  static const int tinyArraySize = 8;
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(handles);
+  IS_BAD_PTR(lens);
+  IS_BAD_PTR(mapped_ptrs);
+  if (num_agents != 0) IS_BAD_PTR(mapping_agents);
+
+  core::Agent** core_agents = nullptr;
+  if (num_agents > tinyArraySize)
+    core_agents = new core::Agent*[num_agents];
+  else
+    core_agents = (core::Agent**)alloca(sizeof(core::Agent*) * num_agents);
+  if (core_agents == NULL) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  MAKE_SCOPE_GUARD([&]() {
+    if (num_agents > tinyArraySize) delete[] core_agents;
+  });
+
+  for (uint32_t i = 0; i < num_agents; i++) {
+    core::Agent* device = core::Agent::Convert(mapping_agents[i]);
+    IS_VALID(device);
+    core_agents[i] = device;
+  }
+
+  return core::Runtime::runtime_singleton_->IPCAttachBatch(handles, lens, count, num_agents,
+                                                           core_agents, mapped_ptrs);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_ipc_memory_detach(void* mapped_ptr) {
   TRY;
   IS_OPEN();
@@ -1075,6 +2091,21 @@ hsa_status_t hsa_amd_queue_intercept_register(hsa_queue_t* queue,
   CATCH;
 }
 
+hsa_status_t hsa_amd_queue_intercept_register_batch(hsa_queue_t* queue,
+                                                    hsa_amd_queue_intercept_handler callback,
+                                                    void* user_data) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(callback);
+  core::Queue* cmd_queue = core::Queue::Convert(queue);
+  IS_VALID(cmd_queue);
+  if (!core::InterceptQueue::IsType(cmd_queue)) return HSA_STATUS_ERROR_INVALID_QUEUE;
+  core::InterceptQueue* iQueue = static_cast<core::InterceptQueue*>(cmd_queue);
+  iQueue->AddInterceptor(callback, user_data, true);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
 hsa_status_t hsa_amd_register_system_event_handler(hsa_amd_system_event_callback_t callback,
                                                    void* data) {
   TRY;
@@ -1083,6 +2114,33 @@ hsa_status_t hsa_amd_register_system_event_handler(hsa_amd_system_event_callback
   CATCH;
 }
 
+hsa_status_t hsa_amd_gpu_fault_records_get(hsa_amd_gpu_fault_record_t* records, uint32_t* count) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(count);
+  if (*count != 0) IS_BAD_PTR(records);
+  return core::Runtime::runtime_singleton_->GetFaultRecords(records, count);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_register_memory_pressure_callback(
+    hsa_amd_memory_pressure_callback_t callback, void* data) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(callback);
+  return core::Runtime::runtime_singleton_->RegisterMemoryPressureCallback(callback, data);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_deregister_memory_pressure_callback(
+    hsa_amd_memory_pressure_callback_t callback, void* data) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(callback);
+  return core::Runtime::runtime_singleton_->DeregisterMemoryPressureCallback(callback, data);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_queue_set_priority(hsa_queue_t* queue,
                                                 hsa_amd_queue_priority_t priority) {
   TRY;
@@ -1110,6 +2168,26 @@ hsa_status_t hsa_amd_queue_set_priority(hsa_queue_t* queue,
   CATCH;
 }
 
+hsa_status_t hsa_amd_queue_suspend(hsa_queue_t* queue) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(queue);
+  core::Queue* cmd_queue = core::Queue::Convert(queue);
+  IS_VALID(cmd_queue);
+  return cmd_queue->SetSuspended(true);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_queue_resume(hsa_queue_t* queue) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(queue);
+  core::Queue* cmd_queue = core::Queue::Convert(queue);
+  IS_VALID(cmd_queue);
+  return cmd_queue->SetSuspended(false);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_register_deallocation_callback(void* ptr,
                                                     hsa_amd_deallocation_callback_t callback,
                                                     void* user_data) {
@@ -1176,6 +2254,23 @@ hsa_status_t hsa_amd_svm_prefetch_async(void* ptr, size_t size, hsa_agent_t agen
   CATCH;
 }
 
+hsa_status_t hsa_amd_svm_prefetch_batch_async(const hsa_amd_svm_prefetch_range_t* ranges,
+                                              size_t range_count, uint32_t num_dep_signals,
+                                              const hsa_signal_t* dep_signals,
+                                              hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(ranges);
+  IS_ZERO(range_count);
+  for (size_t i = 0; i < range_count; i++) {
+    const core::Agent* agent = core::Agent::Convert(ranges[i].agent);
+    IS_VALID(agent);
+  }
+  return core::Runtime::runtime_singleton_->SvmPrefetchBatch(ranges, range_count, num_dep_signals,
+                                                             dep_signals, completion_signal);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_spm_acquire(hsa_agent_t preferred_agent) {
   TRY;
   IS_OPEN();
@@ -1222,6 +2317,38 @@ hsa_status_t hsa_amd_spm_set_dest_buffer(hsa_agent_t preferred_agent, size_t siz
   CATCH;
 }
 
+hsa_status_t hsa_amd_spm_stream_start(hsa_agent_t agent_handle, size_t buffer_size,
+                                      uint32_t buffer_count,
+                                      hsa_amd_spm_stream_callback_t callback, void* user_data,
+                                      const char* file) {
+  TRY;
+  IS_OPEN();
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  if (agent == NULL || !agent->IsValid() || agent->device_type() != core::Agent::kAmdGpuDevice)
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  if (buffer_size == 0 || buffer_size > UINT32_MAX || buffer_count < 2 ||
+      (callback == nullptr && file == nullptr))
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  return static_cast<AMD::GpuAgent*>(agent)->SpmStreamStart(buffer_size, buffer_count, callback,
+                                                           user_data, file);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_spm_stream_stop(hsa_agent_t agent_handle) {
+  TRY;
+  IS_OPEN();
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  if (agent == NULL || !agent->IsValid() || agent->device_type() != core::Agent::kAmdGpuDevice)
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  return static_cast<AMD::GpuAgent*>(agent)->SpmStreamStop();
+  CATCH;
+}
+
 hsa_status_t hsa_amd_portable_export_dmabuf(const void* ptr, size_t size, int* dmabuf,
                                             uint64_t* offset) {
   TRY;
@@ -1234,6 +2361,24 @@ hsa_status_t hsa_amd_portable_export_dmabuf(const void* ptr, size_t size, int* d
   CATCH;
 }
 
+hsa_status_t hsa_amd_portable_export_dmabuf_bulk(const void* const* ptrs, const size_t* sizes,
+                                                 size_t count, int* dmabuf, uint64_t* offsets) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(ptrs);
+  IS_BAD_PTR(sizes);
+  IS_BAD_PTR(dmabuf);
+  IS_BAD_PTR(offsets);
+  IS_ZERO(count);
+  for (size_t i = 0; i < count; i++) {
+    IS_BAD_PTR(ptrs[i]);
+    IS_ZERO(sizes[i]);
+  }
+  return core::Runtime::runtime_singleton_->DmaBufExportRanges(ptrs, sizes, count, dmabuf,
+                                                               offsets);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_portable_close_dmabuf(int dmabuf) {
   TRY;
   return core::Runtime::runtime_singleton_->DmaBufClose(dmabuf);
@@ -1339,6 +2484,124 @@ hsa_status_t hsa_amd_vmem_set_access(void* va, size_t size,
   CATCH;
 }
 
+hsa_status_t hsa_amd_vmem_map_batch(const hsa_amd_vmem_map_desc_t* maps, size_t map_cnt,
+                                    uint64_t flags) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(maps);
+  IS_ZERO(map_cnt);
+
+  return core::Runtime::runtime_singleton_->VMemoryHandleMapBatch(maps, map_cnt, flags);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_pool_allocate_interleaved(
+    const hsa_amd_memory_pool_t* pools, size_t pool_count, size_t size, size_t granularity,
+    const hsa_amd_memory_access_desc_t* desc, size_t desc_cnt, void** ptr) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(pools);
+  IS_ZERO(pool_count);
+  IS_ZERO(size);
+  IS_BAD_PTR(desc);
+  IS_ZERO(desc_cnt);
+  IS_BAD_PTR(ptr);
+  IS_TRUE(core::Runtime::runtime_singleton_->VirtualMemApiSupported());
+
+  std::vector<const core::MemoryRegion*> regions;
+  for (size_t i = 0; i < pool_count; i++) {
+    hsa_region_t region = {pools[i].handle};
+    const core::MemoryRegion* mem_region = core::MemoryRegion::Convert(region);
+    if (mem_region == NULL || !mem_region->IsValid())
+      return (hsa_status_t)HSA_STATUS_ERROR_INVALID_MEMORY_POOL;
+    regions.push_back(mem_region);
+  }
+
+  return core::Runtime::runtime_singleton_->InterleavedAllocate(regions, size, granularity, desc,
+                                                                desc_cnt, ptr);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_pool_free_interleaved(void* ptr) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(ptr);
+  return core::Runtime::runtime_singleton_->InterleavedFree(ptr);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_pool_reserve(hsa_amd_memory_pool_t memory_pool, size_t size) {
+  TRY;
+  IS_OPEN();
+  IS_ZERO(size);
+
+  hsa_region_t region = {memory_pool.handle};
+  const core::MemoryRegion* mem_region = core::MemoryRegion::Convert(region);
+  if (mem_region == nullptr || !mem_region->IsValid())
+    return (hsa_status_t)HSA_STATUS_ERROR_INVALID_MEMORY_POOL;
+
+  return mem_region->Reserve(size);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_pool_release_reservation(hsa_amd_memory_pool_t memory_pool) {
+  TRY;
+  IS_OPEN();
+
+  hsa_region_t region = {memory_pool.handle};
+  const core::MemoryRegion* mem_region = core::MemoryRegion::Convert(region);
+  if (mem_region == nullptr || !mem_region->IsValid())
+    return (hsa_status_t)HSA_STATUS_ERROR_INVALID_MEMORY_POOL;
+
+  return mem_region->ReleaseReservation();
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_pool_allocate_batch(hsa_amd_memory_pool_t memory_pool, size_t count,
+                                                const size_t* sizes, uint32_t flags,
+                                                uint32_t batch_flags, uint32_t num_agents,
+                                                const hsa_agent_t* agents, void** ptrs) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(sizes);
+  IS_BAD_PTR(ptrs);
+  IS_ZERO(count);
+  if (count > UINT32_MAX) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  if ((num_agents != 0) && (agents == nullptr)) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  for (size_t i = 0; i < count; i++) IS_ZERO(sizes[i]);
+  if (!ValidPoolAllocateFlags(flags)) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  hsa_region_t region = {memory_pool.handle};
+  const core::MemoryRegion* mem_region = core::MemoryRegion::Convert(region);
+  if (mem_region == nullptr || !mem_region->IsValid())
+    return (hsa_status_t)HSA_STATUS_ERROR_INVALID_MEMORY_POOL;
+
+  return core::Runtime::runtime_singleton_->AllocateMemoryBatch(
+      mem_region, count, sizes, PoolAllocateFlags(flags),
+      (batch_flags & HSA_AMD_MEMORY_BATCH_SHARED_BLOCK) != 0, num_agents, agents, ptrs);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_vmem_set_access_batch(const hsa_amd_vmem_range_t* ranges, size_t range_cnt,
+                                           const hsa_amd_memory_access_desc_t* desc,
+                                           size_t desc_cnt) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(ranges);
+  IS_ZERO(range_cnt);
+  IS_BAD_PTR(desc);
+  IS_ZERO(desc_cnt);
+
+  for (size_t i = 0; i < range_cnt; i++) {
+    IS_BAD_PTR(ranges[i].va);
+    IS_ZERO(ranges[i].size);
+  }
+
+  return core::Runtime::runtime_singleton_->VMemorySetAccessBatch(ranges, range_cnt, desc,
+                                                                  desc_cnt);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_vmem_get_access(void* va, hsa_access_permission_t* perms,
                                      hsa_agent_t agent_handle) {
   TRY;
@@ -1431,6 +2694,476 @@ hsa_status_t HSA_API hsa_amd_queue_get_info(hsa_queue_t* _queue,
   CATCH;
 }
 
+hsa_status_t hsa_amd_queue_kernarg_alloc(const hsa_queue_t* _queue, size_t size,
+                                         size_t alignment, uint64_t packet_id,
+                                         void** kernarg_address) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(kernarg_address);
+
+  core::Queue* queue = core::Queue::Convert(_queue);
+  IS_VALID(queue);
+
+  return queue->AllocKernarg(size, alignment, packet_id, kernarg_address);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_queue_dispatch_timestamps_enable(hsa_queue_t* _queue,
+                                                      uint32_t record_count) {
+  TRY;
+  IS_OPEN();
+  IS_ZERO(record_count);
+
+  core::Queue* queue = core::Queue::Convert(_queue);
+  IS_VALID(queue);
+
+  return queue->EnableDispatchTimestamps(record_count);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_queue_dispatch_timestamp_signal(const hsa_queue_t* _queue,
+                                                     uint64_t packet_id, hsa_signal_t* signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(signal);
+
+  core::Queue* queue = core::Queue::Convert(_queue);
+  IS_VALID(queue);
+
+  return queue->AllocDispatchTimestamp(packet_id, signal);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_queue_dispatch_timestamps_read(hsa_queue_t* _queue, uint32_t max_records,
+                                                    hsa_amd_dispatch_timestamp_t* records,
+                                                    uint32_t* record_count, uint64_t* dropped) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(records);
+  IS_BAD_PTR(record_count);
+
+  core::Queue* queue = core::Queue::Convert(_queue);
+  IS_VALID(queue);
+
+  return queue->ReadDispatchTimestamps(max_records, records, record_count, dropped);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_runtime_metrics_get(hsa_amd_runtime_metrics_t* metrics) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(metrics);
+
+  core::Metrics::Snapshot(metrics);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_svm_profile_get_ranges(hsa_amd_svm_range_stats_t* ranges,
+                                            uint32_t max_ranges, uint32_t* range_count) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(range_count);
+  if (max_ranges != 0) IS_BAD_PTR(ranges);
+
+  AMD::SvmProfileControl* profile = core::Runtime::runtime_singleton_->svm_profile();
+  if (profile == nullptr) {
+    *range_count = 0;
+    return HSA_STATUS_SUCCESS;
+  }
+  *range_count = profile->GetRanges(ranges, max_ranges);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_runtime_trace_flush() {
+  TRY;
+  IS_OPEN();
+  core::Timeline::Flush();
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_queue_submit_batch(hsa_queue_t* _queue, const void* packets,
+                                        uint32_t packet_count, uint64_t* first_index) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(packets);
+
+  core::Queue* queue = core::Queue::Convert(_queue);
+  IS_VALID(queue);
+
+  return queue->SubmitBatch(packets, packet_count, first_index);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_dispatch_graph_create(hsa_agent_t agent_handle, const void* packets,
+                                           uint32_t packet_count, const uint32_t* kernarg_sizes,
+                                           hsa_amd_dispatch_graph_t* graph) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(packets);
+  IS_BAD_PTR(graph);
+  IS_ZERO(packet_count);
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  IS_VALID(agent);
+  if (agent->device_type() != core::Agent::kAmdGpuDevice) return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  std::unique_ptr<AMD::DispatchGraph> dispatch_graph(
+      new AMD::DispatchGraph(static_cast<AMD::GpuAgent*>(agent)));
+  hsa_status_t status = dispatch_graph->Record(
+      reinterpret_cast<const core::AqlPacket*>(packets), packet_count, kernarg_sizes);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  *graph = AMD::DispatchGraph::Convert(dispatch_graph.release());
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_dispatch_graph_launch(hsa_amd_dispatch_graph_t graph, hsa_queue_t* _queue,
+                                           uint32_t update_count,
+                                           const hsa_amd_dispatch_graph_update_t* updates,
+                                           hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+
+  AMD::DispatchGraph* dispatch_graph = AMD::DispatchGraph::Convert(graph);
+  IS_VALID(dispatch_graph);
+
+  core::Queue* queue = core::Queue::Convert(_queue);
+  IS_VALID(queue);
+
+  hsa_agent_t queue_agent;
+  if (queue->GetInfo(HSA_AMD_QUEUE_INFO_AGENT, &queue_agent) != HSA_STATUS_SUCCESS ||
+      queue_agent.handle != dispatch_graph->agent()->public_handle().handle)
+    return HSA_STATUS_ERROR_INVALID_QUEUE;
+
+  if (update_count != 0) IS_BAD_PTR(updates);
+
+  if (completion_signal.handle != 0) {
+    core::Signal* signal = core::Signal::Convert(completion_signal);
+    IS_VALID(signal);
+  }
+
+  return dispatch_graph->Launch(queue, update_count, updates, completion_signal);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_dispatch_graph_destroy(hsa_amd_dispatch_graph_t graph) {
+  TRY;
+  IS_OPEN();
+
+  AMD::DispatchGraph* dispatch_graph = AMD::DispatchGraph::Convert(graph);
+  IS_VALID(dispatch_graph);
+
+  delete dispatch_graph;
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+namespace {
+struct ExecutableFreeze {
+  amd::hsa::loader::Executable* executable;
+  core::Signal* completion_signal;
+};
+
+// Completes hsa_amd_executable_freeze_async on the async events thread.
+bool FinishExecutableFreeze(hsa_signal_value_t, void* arg) {
+  ExecutableFreeze* freeze = reinterpret_cast<ExecutableFreeze*>(arg);
+  core::Runtime::runtime_singleton_->loader()->FreezeExecutableFinish(freeze->executable);
+  freeze->completion_signal->SubRelease(1);
+  delete freeze;
+  return false;
+}
+}  // namespace
+
+hsa_status_t hsa_amd_executable_freeze_async(hsa_executable_t executable, const char* options,
+                                             hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+
+  amd::hsa::loader::Executable* exec = amd::hsa::loader::Executable::Object(executable);
+  if (!exec) return HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+  core::Signal* signal = core::Signal::Convert(completion_signal);
+  IS_VALID(signal);
+
+  amd::hsa::loader::Loader* loader = core::Runtime::runtime_singleton_->loader();
+  hsa_status_t status = loader->FreezeExecutableStart(exec, options);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  // A null signal runs the handler as soon as the async events thread gets to it.
+  static const hsa_signal_t null_signal = {0};
+  ExecutableFreeze* freeze = new ExecutableFreeze{exec, signal};
+  status = core::Runtime::runtime_singleton_->SetAsyncSignalHandler(
+      null_signal, HSA_SIGNAL_CONDITION_EQ, 0, FinishExecutableFreeze, freeze);
+  if (status != HSA_STATUS_SUCCESS) FinishExecutableFreeze(0, freeze);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_executables_destroy(uint32_t num_executables,
+                                         const hsa_executable_t* executables) {
+  TRY;
+  IS_OPEN();
+  if (num_executables == 0) return HSA_STATUS_SUCCESS;
+  IS_BAD_PTR(executables);
+
+  std::vector<amd::hsa::loader::Executable*> execs(num_executables);
+  std::set<amd::hsa::loader::Executable*> unique_execs;
+  for (uint32_t i = 0; i < num_executables; ++i) {
+    execs[i] = amd::hsa::loader::Executable::Object(executables[i]);
+    if (!execs[i]) return HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+    if (!unique_execs.insert(execs[i]).second) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  core::Runtime::runtime_singleton_->loader()->DestroyExecutables(execs.data(), execs.size());
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_queue_create(
+    hsa_agent_t agent_handle, uint32_t size, hsa_queue_type32_t type,
+    void (*callback)(hsa_status_t status, hsa_queue_t* source, void* data), void* data,
+    uint32_t private_segment_size, uint32_t group_segment_size, uint64_t flags,
+    hsa_queue_t** queue) {
+  TRY;
+  IS_OPEN();
+
+  const bool numa_hint = (flags & HSA_AMD_QUEUE_CREATE_NUMA_HINT) != 0;
+  const uint64_t known_flags =
+      uint64_t(HSA_AMD_QUEUE_CREATE_DEVICE_RING | HSA_AMD_QUEUE_CREATE_NUMA_HINT) |
+      (numa_hint ? 0xFFFFFFFF00000000ull : 0);
+  if ((flags & ~known_flags) != 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  if (flags == 0)
+    return HSA::hsa_queue_create(agent_handle, size, type, callback, data, private_segment_size,
+                                 group_segment_size, queue);
+
+  if ((queue == nullptr) || (size == 0) || (!IsPowerOfTwo(size)) ||
+      (type > HSA_QUEUE_TYPE_COOPERATIVE)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  IS_VALID(agent);
+  if (agent->device_type() != core::Agent::kAmdGpuDevice) return HSA_STATUS_ERROR_INVALID_AGENT;
+  AMD::GpuAgent* gpu_agent = static_cast<AMD::GpuAgent*>(agent);
+
+  // Cooperative queues are shared and keep the ring they were created with.
+  if (type == HSA_QUEUE_TYPE_COOPERATIVE) return HSA_STATUS_ERROR_INVALID_QUEUE_CREATION;
+
+  bool device_ring = core::Runtime::runtime_singleton_->flag().dev_mem_queue();
+  if (flags & HSA_AMD_QUEUE_CREATE_DEVICE_RING) {
+    if (!gpu_agent->HostAccessibleLocalMemory() && !gpu_agent->is_xgmi_cpu_gpu())
+      return HSA_STATUS_ERROR_INVALID_QUEUE_CREATION;
+    device_ring = true;
+  }
+
+  const core::Agent* host_agent = nullptr;
+  if (numa_hint) {
+    const uint32_t node = uint32_t(flags >> 32);
+    for (auto cpu : core::Runtime::runtime_singleton_->cpu_agents()) {
+      if (cpu->node_id() == node) host_agent = cpu;
+    }
+    if ((host_agent == nullptr) || !gpu_agent->SystemAllocatorFor(host_agent))
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (callback == nullptr) callback = core::Queue::DefaultErrorHandler;
+
+  core::Queue* cmd_queue = nullptr;
+  hsa_status_t status =
+      gpu_agent->QueueCreate(size, type, callback, data, private_segment_size, group_segment_size,
+                             device_ring, &cmd_queue, host_agent);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  assert(cmd_queue != nullptr && "Queue not returned but status was success.\n");
+  *queue = core::Queue::Convert(cmd_queue);
+  return status;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_copy_list_create(hsa_agent_t agent_handle,
+                                      hsa_amd_sdma_engine_id_t engine_id,
+                                      const hsa_amd_copy_command_t* commands,
+                                      uint32_t num_commands, hsa_amd_copy_list_t* list) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(commands);
+  IS_BAD_PTR(list);
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  IS_VALID(agent);
+  if (agent->device_type() != core::Agent::kAmdGpuDevice) return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  // engine_id is single bitset unique.
+  int engine_offset = ffs(engine_id);
+  if (!engine_id || !!((engine_id >> engine_offset))) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  for (uint32_t i = 0; i < num_commands; i++) {
+    const hsa_amd_copy_command_t& command = commands[i];
+    switch (command.type) {
+      case HSA_AMD_COPY_COMMAND_COPY:
+        if (command.copy.size != 0) {
+          IS_BAD_PTR(command.copy.dst);
+          IS_BAD_PTR(command.copy.src);
+        }
+        break;
+      case HSA_AMD_COPY_COMMAND_FILL:
+        if (command.fill.count != 0) IS_BAD_PTR(command.fill.ptr);
+        break;
+      case HSA_AMD_COPY_COMMAND_WAIT: {
+        core::Signal* signal = core::Signal::Convert(command.wait.signal);
+        IS_VALID(signal);
+        break;
+      }
+      case HSA_AMD_COPY_COMMAND_SIGNAL: {
+        core::Signal* signal = core::Signal::Convert(command.signal.signal);
+        IS_VALID(signal);
+        break;
+      }
+      default:
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+  }
+
+  AMD::CopyList* copy_list = nullptr;
+  hsa_status_t status = static_cast<AMD::GpuAgent*>(agent)->CreateCopyList(
+      engine_offset, commands, num_commands, &copy_list);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  *list = AMD::CopyList::Convert(copy_list);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_copy_list_submit(hsa_amd_copy_list_t list, uint32_t num_dep_signals,
+                                      const hsa_signal_t* dep_signals,
+                                      hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+
+  AMD::CopyList* copy_list = AMD::CopyList::Convert(list);
+  IS_VALID(copy_list);
+
+  if ((num_dep_signals == 0 && dep_signals != nullptr) ||
+      (num_dep_signals > 0 && dep_signals == nullptr)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::vector<core::Signal*> dep_signal_list(num_dep_signals);
+  for (size_t i = 0; i < num_dep_signals; ++i) {
+    core::Signal* dep_signal_obj = core::Signal::Convert(dep_signals[i]);
+    IS_VALID(dep_signal_obj);
+    dep_signal_list[i] = dep_signal_obj;
+  }
+
+  core::Signal* out_signal_obj = core::Signal::Convert(completion_signal);
+  IS_VALID(out_signal_obj);
+
+  return copy_list->Submit(dep_signal_list, *out_signal_obj);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_copy_list_destroy(hsa_amd_copy_list_t list) {
+  TRY;
+  IS_OPEN();
+
+  AMD::CopyList* copy_list = AMD::CopyList::Convert(list);
+  IS_VALID(copy_list);
+
+  delete copy_list;
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_copy_context_create(hsa_agent_t agent_handle, uint32_t engine_ids_mask,
+                                         hsa_amd_copy_context_t* context) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(context);
+
+  core::Agent* agent = core::Agent::Convert(agent_handle);
+  IS_VALID(agent);
+  if (agent->device_type() != core::Agent::kAmdGpuDevice) return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  AMD::CopyContext* copy_context = nullptr;
+  hsa_status_t status =
+      static_cast<AMD::GpuAgent*>(agent)->CreateCopyContext(engine_ids_mask, &copy_context);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  *context = AMD::CopyContext::Convert(copy_context);
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_copy_context_submit(hsa_amd_copy_context_t context, void* dst,
+                                         const void* src, size_t size, uint32_t num_dep_signals,
+                                         const hsa_signal_t* dep_signals,
+                                         hsa_signal_t completion_signal) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(dst);
+  IS_BAD_PTR(src);
+
+  AMD::CopyContext* copy_context = AMD::CopyContext::Convert(context);
+  IS_VALID(copy_context);
+
+  if ((num_dep_signals == 0 && dep_signals != nullptr) ||
+      (num_dep_signals > 0 && dep_signals == nullptr)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  std::vector<core::Signal*> dep_signal_list(num_dep_signals);
+  for (size_t i = 0; i < num_dep_signals; ++i) {
+    core::Signal* dep_signal_obj = core::Signal::Convert(dep_signals[i]);
+    IS_VALID(dep_signal_obj);
+    dep_signal_list[i] = dep_signal_obj;
+  }
+
+  core::Signal* out_signal_obj = core::Signal::Convert(completion_signal);
+  IS_VALID(out_signal_obj);
+
+  if (size == 0) return HSA_STATUS_SUCCESS;
+
+  return copy_context->Submit(dst, src, size, dep_signal_list, *out_signal_obj);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_copy_context_destroy(hsa_amd_copy_context_t context) {
+  TRY;
+  IS_OPEN();
+
+  AMD::CopyContext* copy_context = AMD::CopyContext::Convert(context);
+  IS_VALID(copy_context);
+
+  delete copy_context;
+  return HSA_STATUS_SUCCESS;
+  CATCH;
+}
+
+hsa_status_t hsa_amd_memory_set_device_only(void* ptr, bool device_only) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(ptr);
+  return core::Runtime::runtime_singleton_->SetDeviceOnly(ptr, device_only);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_aie_buffer_host_access(void* ptr, bool host_access) {
+  TRY;
+  IS_OPEN();
+  IS_BAD_PTR(ptr);
+
+  if (core::Runtime::runtime_singleton_->aie_agents().empty()) return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  auto& driver = static_cast<AMD::XdnaDriver&>(
+      core::Runtime::runtime_singleton_->AgentDriver(core::DriverType::XDNA));
+  return driver.SetHostAccess(ptr, host_access);
+  CATCH;
+}
+
 hsa_status_t hsa_amd_enable_logging(uint8_t* flags, void *file) {
   TRY;
   return core::Runtime::runtime_singleton_->EnableLogging(flags, file);
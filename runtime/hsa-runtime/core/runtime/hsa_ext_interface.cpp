@@ -96,6 +96,13 @@ void ExtensionEntryPoints::InitImageExtTable() {
   image_api.hsa_ext_sampler_create_fn = hsa_ext_null;
   image_api.hsa_ext_sampler_destroy_fn = hsa_ext_null;
   image_api.hsa_amd_image_get_info_max_dim_fn = hsa_ext_null;
+  image_api.hsa_amd_image_blit_fn = hsa_ext_null;
+  image_api.hsa_amd_image_blit_async_fn = hsa_ext_null;
+  image_api.hsa_amd_image_import_async_fn = hsa_ext_null;
+  image_api.hsa_amd_image_export_async_fn = hsa_ext_null;
+  image_api.hsa_amd_image_copy_async_fn = hsa_ext_null;
+  image_api.hsa_amd_image_clear_async_fn = hsa_ext_null;
+  image_api.hsa_amd_image_create_batch_fn = hsa_ext_null;
   image_api.hsa_ext_image_get_capability_with_layout_fn = hsa_ext_null;
   image_api.hsa_ext_image_data_get_info_with_layout_fn = hsa_ext_null;
   image_api.hsa_ext_image_create_with_layout_fn = hsa_ext_null;
@@ -115,6 +122,8 @@ void ExtensionEntryPoints::InitPcSamplingExtTable() {
   pcs_api.hsa_ven_amd_pcs_start_fn = hsa_ext_null;
   pcs_api.hsa_ven_amd_pcs_stop_fn = hsa_ext_null;
   pcs_api.hsa_ven_amd_pcs_flush_fn = hsa_ext_null;
+  pcs_api.hsa_ven_amd_pcs_data_view_fn = hsa_ext_null;
+  pcs_api.hsa_ven_amd_pcs_aggregate_fn = hsa_ext_null;
 }
 
 // Initialize Amd Ext table for Api related to Images
@@ -524,6 +533,20 @@ hsa_status_t HSA_API hsa_ven_amd_pcs_flush(hsa_ven_amd_pcs_t pc_sampling) {
       pc_sampling);
 }
 
+hsa_status_t HSA_API hsa_ven_amd_pcs_data_view(void* hsa_callback_data,
+                                               hsa_ven_amd_pcs_data_view_t* view) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.pcs_api
+      .hsa_ven_amd_pcs_data_view_fn(hsa_callback_data, view);
+}
+
+hsa_status_t HSA_API
+hsa_ven_amd_pcs_aggregate(hsa_ven_amd_pcs_t pc_sampling,
+                          hsa_ven_amd_pcs_histogram_callback_t histogram_callback,
+                          void* client_callback_data) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.pcs_api
+      .hsa_ven_amd_pcs_aggregate_fn(pc_sampling, histogram_callback, client_callback_data);
+}
+
 //---------------------------------------------------------------------------//
 //  Stubs for internal extension functions
 //---------------------------------------------------------------------------//
@@ -535,3 +558,78 @@ hsa_status_t hsa_amd_image_get_info_max_dim(hsa_agent_t component,
   return rocr::core::Runtime::runtime_singleton_->extensions_.image_api
       .hsa_amd_image_get_info_max_dim_fn(component, attribute, value);
 }
+
+// Use the function pointer from local instance Image Extension
+hsa_status_t hsa_amd_image_blit(hsa_agent_t agent, uint32_t num_blits,
+                                const hsa_amd_image_blit_t* blits) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.image_api.hsa_amd_image_blit_fn(
+      agent, num_blits, blits);
+}
+
+// Use the function pointer from local instance Image Extension
+hsa_status_t hsa_amd_image_blit_async(hsa_agent_t agent, uint32_t num_blits,
+                                      const hsa_amd_image_blit_t* blits,
+                                      uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                      hsa_signal_t completion_signal) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.image_api.hsa_amd_image_blit_async_fn(
+      agent, num_blits, blits, num_dep_signals, dep_signals, completion_signal);
+}
+
+// Use the function pointer from local instance Image Extension
+hsa_status_t hsa_amd_image_import_async(hsa_agent_t agent, const void* src_memory,
+                                        size_t src_row_pitch, size_t src_slice_pitch,
+                                        hsa_ext_image_t dst_image,
+                                        const hsa_ext_image_region_t* image_region,
+                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                        hsa_signal_t completion_signal) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.image_api
+      .hsa_amd_image_import_async_fn(agent, src_memory, src_row_pitch, src_slice_pitch,
+                                     dst_image, image_region, num_dep_signals, dep_signals,
+                                     completion_signal);
+}
+
+// Use the function pointer from local instance Image Extension
+hsa_status_t hsa_amd_image_export_async(hsa_agent_t agent, hsa_ext_image_t src_image,
+                                        void* dst_memory, size_t dst_row_pitch,
+                                        size_t dst_slice_pitch,
+                                        const hsa_ext_image_region_t* image_region,
+                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                        hsa_signal_t completion_signal) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.image_api
+      .hsa_amd_image_export_async_fn(agent, src_image, dst_memory, dst_row_pitch,
+                                     dst_slice_pitch, image_region, num_dep_signals,
+                                     dep_signals, completion_signal);
+}
+
+// Use the function pointer from local instance Image Extension
+hsa_status_t hsa_amd_image_copy_async(hsa_agent_t agent, hsa_ext_image_t src_image,
+                                      const hsa_dim3_t* src_offset, hsa_ext_image_t dst_image,
+                                      const hsa_dim3_t* dst_offset, const hsa_dim3_t* range,
+                                      uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                      hsa_signal_t completion_signal) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.image_api.hsa_amd_image_copy_async_fn(
+      agent, src_image, src_offset, dst_image, dst_offset, range, num_dep_signals,
+      dep_signals, completion_signal);
+}
+
+// Use the function pointer from local instance Image Extension
+hsa_status_t hsa_amd_image_clear_async(hsa_agent_t agent, hsa_ext_image_t image,
+                                       const void* data,
+                                       const hsa_ext_image_region_t* image_region,
+                                       uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                       hsa_signal_t completion_signal) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.image_api
+      .hsa_amd_image_clear_async_fn(agent, image, data, image_region, num_dep_signals,
+                                    dep_signals, completion_signal);
+}
+
+// Use the function pointer from local instance Image Extension
+hsa_status_t hsa_amd_image_create_batch(hsa_agent_t agent, uint32_t num_images,
+                                        const hsa_ext_image_descriptor_t* image_descriptors,
+                                        const void* const* image_data,
+                                        hsa_access_permission_t access_permission,
+                                        hsa_ext_image_t* images) {
+  return rocr::core::Runtime::runtime_singleton_->extensions_.image_api
+      .hsa_amd_image_create_batch_fn(agent, num_images, image_descriptors, image_data,
+                                     access_permission, images);
+}
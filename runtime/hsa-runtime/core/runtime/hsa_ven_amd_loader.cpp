@@ -42,7 +42,9 @@
 
 #include "core/inc/hsa_ven_amd_loader_impl.h"
 
+#include "core/inc/amd_hsa_code.hpp"
 #include "core/inc/amd_hsa_loader.hpp"
+#include "core/inc/isa.h"
 #include "core/inc/runtime.h"
 
 namespace rocr {
@@ -300,4 +302,153 @@ hsa_ven_amd_loader_iterate_executables(
   } catch(...) { return AMD::handleException(); }
 }
 
+hsa_status_t
+hsa_ven_amd_loader_executable_load_agents_code_object(
+    hsa_executable_t executable,
+    uint32_t num_agents,
+    const hsa_agent_t *agents,
+    hsa_code_object_reader_t code_object_reader,
+    const char *options,
+    hsa_loaded_code_object_t *loaded_code_objects) {
+  try {
+    if (!Runtime::runtime_singleton_->IsOpen()) {
+      return HSA_STATUS_ERROR_NOT_INITIALIZED;
+    }
+    if ((nullptr == agents) || (0 == num_agents)) {
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (uint32_t i = 0; i < num_agents; ++i) {
+      const core::Agent *agent = core::Agent::Convert(agents[i]);
+      if ((nullptr == agent) || !agent->IsValid()) {
+        return HSA_STATUS_ERROR_INVALID_AGENT;
+      }
+      for (uint32_t j = 0; j < i; ++j) {
+        if (agents[j].handle == agents[i].handle) {
+          return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+        }
+      }
+    }
+
+    Executable *exec = Executable::Object(executable);
+    if (!exec) {
+      return HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+    }
+
+    CodeObjectReaderImpl *reader = CodeObjectReaderImpl::Object(code_object_reader);
+    if (!reader) {
+      return HSA_STATUS_ERROR_INVALID_CODE_OBJECT_READER;
+    }
+
+    hsa_code_object_t code_object =
+        {reinterpret_cast<uint64_t>(reader->GetCodeObjectMemory())};
+    return exec->LoadCodeObject(agents, num_agents, code_object, options, reader->GetUri(),
+                                loaded_code_objects);
+  } catch(...) { return AMD::handleException(); }
+}
+
+hsa_status_t
+hsa_ven_amd_loader_executable_get_kernels(
+    hsa_executable_t executable,
+    const hsa_agent_t *agent,
+    uint32_t *num_kernels,
+    hsa_ven_amd_loader_kernel_info_t *kernels) {
+  try {
+    if (!Runtime::runtime_singleton_->IsOpen()) {
+      return HSA_STATUS_ERROR_NOT_INITIALIZED;
+    }
+    if ((nullptr == num_kernels) || ((nullptr == kernels) != (0 == *num_kernels))) {
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+
+    Executable *exec = Executable::Object(executable);
+    if (!exec) {
+      return HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+    }
+
+    return exec->GetKernels(agent, num_kernels, kernels);
+  } catch(...) { return AMD::handleException(); }
+}
+
+hsa_status_t
+hsa_ven_amd_loader_select_bundled_code_objects(
+    const void *bundle,
+    size_t bundle_size,
+    uint32_t num_agents,
+    const hsa_agent_t *agents,
+    hsa_ven_amd_loader_bundled_code_object_t *code_objects) {
+  try {
+    if (!Runtime::runtime_singleton_->IsOpen()) {
+      return HSA_STATUS_ERROR_NOT_INITIALIZED;
+    }
+    if ((nullptr == bundle) || (nullptr == agents) || (nullptr == code_objects) ||
+        (0 == num_agents)) {
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+
+    std::vector<code::BundledCodeObject> bundled;
+    if (!code::IndexOffloadBundle(bundle, bundle_size, bundled)) {
+      return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
+    }
+
+    // Names are only handled once per agent, code objects are matched on e_flags values.
+    auto feature = [](IsaFeature f) {
+      return (f == IsaFeature::Enabled) ? 1 : (f == IsaFeature::Disabled) ? 0 : -1;
+    };
+    for (uint32_t i = 0; i < num_agents; ++i) {
+      const core::Agent *agent = core::Agent::Convert(agents[i]);
+      if ((nullptr == agent) || !agent->IsValid()) {
+        return HSA_STATUS_ERROR_INVALID_AGENT;
+      }
+      code_objects[i] = {0, 0};
+      if (agent->supported_isas().empty()) continue;
+
+      const Isa *isa = agent->supported_isas()[0];
+      const unsigned mach = code::GetMachForProcessor(isa->GetProcessorName());
+      const int xnack = feature(isa->GetXnack());
+      const int sramecc = feature(isa->GetSramecc());
+
+      // Generic names carry the triple prefix and the agent's features.
+      unsigned generic_mach = 0;
+      unsigned generic_version = 1;
+      const std::string &generic = isa->GetIsaGeneric();
+      if (!generic.empty()) {
+        std::string processor = generic.substr(generic.find("--") + 2);
+        generic_mach = code::GetMachForProcessor(processor.substr(0, processor.find(':')));
+        auto it = IsaRegistry::GetSupportedGenericVersions().find(generic);
+        if (it != IsaRegistry::GetSupportedGenericVersions().end()) generic_version = it->second;
+      }
+
+      // Processor specific code beats generic code, exact feature settings beat "any".
+      int best = -1;
+      for (const auto &code_object : bundled) {
+        const code::CodeObjectTarget &target = code_object.target;
+        int score;
+        if (target.mach == mach) {
+          score = 4;
+        } else if ((generic_mach != 0) && (target.mach == generic_mach) &&
+                   (target.genericVersion >= generic_version)) {
+          score = 0;
+        } else {
+          continue;
+        }
+        if (target.xnack != -1) {
+          if (target.xnack != xnack) continue;
+          score++;
+        }
+        if (target.sramecc != -1) {
+          if (target.sramecc != sramecc) continue;
+          score++;
+        }
+        if (score > best) {
+          best = score;
+          code_objects[i].offset = code_object.offset;
+          code_objects[i].size = code_object.size;
+        }
+      }
+    }
+    return HSA_STATUS_SUCCESS;
+  } catch(...) { return AMD::handleException(); }
+}
+
 } // namespace rocr
@@ -40,6 +40,8 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include "core/inc/intercept_queue.h"
 #include "core/inc/amd_aql_queue.h"
 #include "core/util/utils.h"
@@ -117,13 +119,19 @@ InterceptQueue::InterceptQueue(std::unique_ptr<Queue> queue)
       next_packet_(0),
       retry_index_(0),
       quit_(false),
-      active_(true) {
+      active_(true),
+      profile_filter_(false),
+      profile_interval_(0),
+      profile_counter_(0) {
   // Initial retry_index_ value must ensure that
   // InterceptQueue::IsPendingRetryPoint will return false before the first
   // retry barrier packet is inserted.
   assert(!IsPendingRetryPoint(next_packet_) &&
          "Packet intercept error: initial retry index is incompatible with IsPendingRetryPoint.\n");
   buffer_ = SharedArray<AqlPacket, 4096>(wrapped->amd_queue_.hsa_queue.size);
+  // Packets are forwarded into the wrapped queue's ring, so fence as it requires.
+  setDeviceRing(wrapped->deviceRing());
+  setPcieOrdering(wrapped->needsPcieOrdering());
   amd_queue_.hsa_queue.base_address = reinterpret_cast<void*>(&buffer_[0]);
 
   // Fill the ring buffer with invalid packet headers.
@@ -148,7 +156,7 @@ InterceptQueue::InterceptQueue(std::unique_ptr<Queue> queue)
     throw AMD::hsa_exception(err, "Doorbell handler registration failed.\n");
 
   // Install copy submission interceptor.
-  AddInterceptor(Submit, this);
+  AddInterceptor(Submit, this, true);
 
   sigGuard.Dismiss();
 }
@@ -178,12 +186,94 @@ bool InterceptQueue::HandleAsyncDoorbell(hsa_signal_value_t value, void* arg) {
   return true;
 }
 
+hsa_status_t InterceptQueue::SetProfilingFilter(const uint64_t* kernel_objects, uint32_t count,
+                                                uint32_t interval) {
+  if (!AMD::AqlQueue::IsType(wrapped.get())) return HSA_STATUS_ERROR_INVALID_QUEUE;
+  AMD::AqlQueue* aqlQueue = static_cast<AMD::AqlQueue*>(wrapped.get());
+
+  ScopedAcquire<KernelMutex> lock(&lock_);
+
+  // Filtered dispatches enable profiling themselves, the queue default is off.
+  wrapped->SetProfiling(false);
+
+  if (count == 0 && interval == 0) {
+    if (profile_filter_) {
+      interceptors.erase(interceptors.begin() + 1);
+      profile_filter_ = false;
+    }
+    profile_kernels_.clear();
+    return HSA_STATUS_SUCCESS;
+  }
+
+  hsa_status_t err = aqlQueue->ProfilingTogglePackets(&profile_on_, &profile_off_);
+  if (err != HSA_STATUS_SUCCESS) return err;
+
+  profile_kernels_.assign(kernel_objects, kernel_objects + count);
+  std::sort(profile_kernels_.begin(), profile_kernels_.end());
+  profile_kernels_.erase(std::unique(profile_kernels_.begin(), profile_kernels_.end()),
+                         profile_kernels_.end());
+  profile_interval_ = interval;
+  profile_counter_ = 0;
+
+  if (!profile_filter_) {
+    Interceptor entry = {ProfileFilter, this, true};
+    interceptors.insert(interceptors.begin() + 1, entry);
+    profile_filter_ = true;
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+void InterceptQueue::SetProfiling(bool enabled) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  if (profile_filter_) {
+    interceptors.erase(interceptors.begin() + 1);
+    profile_filter_ = false;
+    profile_kernels_.clear();
+  }
+  wrapped->SetProfiling(enabled);
+}
+
+void InterceptQueue::ProfileFilter(const void* pkts, uint64_t pkt_count, uint64_t user_pkt_index,
+                                   void* data, hsa_amd_queue_intercept_packet_writer writer) {
+  InterceptQueue* queue = reinterpret_cast<InterceptQueue*>(data);
+  const AqlPacket* packets = reinterpret_cast<const AqlPacket*>(pkts);
+
+  // Pass runs of unselected packets through untouched, wrap each selected dispatch.
+  uint64_t run = 0;
+  for (uint64_t i = 0; i < pkt_count; i++) {
+    if (AqlPacket::type(packets[i].packet.header) != HSA_PACKET_TYPE_KERNEL_DISPATCH) continue;
+
+    bool selected = std::binary_search(queue->profile_kernels_.begin(),
+                                       queue->profile_kernels_.end(),
+                                       packets[i].dispatch.kernel_object);
+    if (queue->profile_interval_ != 0 &&
+        queue->profile_counter_++ % queue->profile_interval_ == 0)
+      selected = true;
+    if (!selected) continue;
+
+    if (i != run) writer(&packets[run], i - run);
+    AqlPacket bracket[3] = {queue->profile_on_, packets[i], queue->profile_off_};
+    writer(bracket, 3);
+    run = i + 1;
+  }
+  if (run != pkt_count) writer(&packets[run], pkt_count - run);
+}
+
+void InterceptQueue::Invoke(const AqlPacket* pkts, uint64_t pkt_count) {
+  auto& entry = Cursor.queue->interceptors[Cursor.interceptor_index];
+  if (entry.batch || pkt_count <= 1) {
+    entry.handler(pkts, pkt_count, Cursor.pkt_index, entry.data, PacketWriter);
+    return;
+  }
+  for (uint64_t i = 0; i < pkt_count; i++)
+    entry.handler(&pkts[i], 1, Cursor.pkt_index, entry.data, PacketWriter);
+}
+
 void InterceptQueue::PacketWriter(const void* pkts, uint64_t pkt_count) {
   assert(Cursor.interceptor_index > 0 &&
          "Packet intercept error: final submit handler must not call PacketWritter.\n");
   --Cursor.interceptor_index;
-  auto& handler = Cursor.queue->interceptors[Cursor.interceptor_index];
-  handler.first(pkts, pkt_count, Cursor.pkt_index, handler.second, PacketWriter);
+  Invoke(reinterpret_cast<const AqlPacket*>(pkts), pkt_count);
   // Restore index as the same rewrite handler may call the PacketWriter more than once.
   ++Cursor.interceptor_index;
 }
@@ -193,12 +283,16 @@ void InterceptQueue::Submit(const void* pkts, uint64_t pkt_count, uint64_t user_
   InterceptQueue* queue = reinterpret_cast<InterceptQueue*>(data);
   const AqlPacket* packets = (const AqlPacket*)pkts;
 
-  // Submit final packet transform to hardware.
-  uint64_t submitted_count = queue->Submit(packets, pkt_count);
-  if (submitted_count == pkt_count) return;
+  // Once a rewrite has overflowed, later packets of the same rewrite or batch must queue behind
+  // it to preserve submission order.
+  uint64_t submitted_count = 0;
+  if (queue->overflow_.empty()) {
+    // Submit final packet transform to hardware.
+    submitted_count = queue->Submit(packets, pkt_count);
+    if (submitted_count == pkt_count) return;
+  }
 
   // Could not submit all the final packets, stash unsubmitted ones for later.
-  assert(queue->overflow_.empty() && "Packet intercept error: overflow buffer not empty.\n");
   for (uint64_t i = submitted_count; i < pkt_count; i++)
     queue->overflow_.push_back(packets[i]);
 }
@@ -256,7 +350,7 @@ uint64_t InterceptQueue::Submit(const AqlPacket* packets, uint64_t count) {
       // Submit barrier which will wake async queue processing.
       ring[barrier & mask].packet.body = {};
       ring[barrier & mask].barrier_and.completion_signal = Signal::Convert(async_doorbell_);
-      if (Runtime::runtime_singleton_->flag().dev_mem_queue() && !needsPcieOrdering()) {
+      if (needsRingFence()) {
         // Ensure the packet body is written as header may get reordered when writing over PCIE
         _mm_sfence();
       }
@@ -303,7 +397,7 @@ uint64_t InterceptQueue::Submit(const AqlPacket* packets, uint64_t count) {
         ++packets_index;
       }
       if (write_index != 0) {
-        if (Runtime::runtime_singleton_->flag().dev_mem_queue() && !needsPcieOrdering()) {
+        if (needsRingFence()) {
           // Ensure the packet body is written as header may get reordered when writing over PCIE
           _mm_sfence();
         }
@@ -358,6 +452,10 @@ void InterceptQueue::StoreRelaxed(hsa_signal_value_t value) {
   if (end > next_packet_ + amd_queue_.hsa_queue.size)
     end = next_packet_ + amd_queue_.hsa_queue.size;
 
+  // Batches may be handed to the outermost interceptor when it accepts them.  A batch is the run
+  // of valid packets that is contiguous in the ring.
+  const bool batch = interceptors.back().batch;
+
   uint64_t i = next_packet_;
   while (i < end) {
     // Load the packet header as atomic acquire as it may have been written by
@@ -367,20 +465,31 @@ void InterceptQueue::StoreRelaxed(hsa_signal_value_t value) {
     uint16_t header = atomic::Load(&ring[i & mask].packet.header, std::memory_order_acquire);
     if (!AqlPacket::IsValid(header)) break;
 
+    uint64_t count = 1;
+    if (batch) {
+      const uint64_t run_end = Min(end, AlignDown(i, uint64_t(mask) + 1) + mask + 1);
+      while (i + count < run_end) {
+        header = atomic::Load(&ring[(i + count) & mask].packet.header, std::memory_order_acquire);
+        if (!AqlPacket::IsValid(header)) break;
+        ++count;
+      }
+    }
+
     // Process callbacks.
     Cursor.interceptor_index = interceptors.size() - 1;
     Cursor.pkt_index = i;
-    auto& handler = interceptors[Cursor.interceptor_index];
-    handler.first(&ring[i & mask], 1, i, handler.second, PacketWriter);
-    if (Runtime::runtime_singleton_->flag().dev_mem_queue() && !needsPcieOrdering()) {
+    Invoke(&ring[i & mask], count);
+    if (needsRingFence()) {
       // Ensure the packet body is written as header may get reordered when writing over PCIE
       _mm_sfence();
     }
-    // Invalidate consumed packet.
-    atomic::Store(&ring[i & mask].packet.header, kInvalidHeader, std::memory_order_release);
+    // Invalidate consumed packets.
+    for (uint64_t j = 0; j < count; j++)
+      atomic::Store(&ring[(i + j) & mask].packet.header, kInvalidHeader,
+                    std::memory_order_release);
 
-    // Packet has now been processed so advance the read index.
-    ++i;
+    // Packets have now been processed so advance the read index.
+    i += count;
 
     // Only allow the rewrite of one packet to be on the overflow queue. When
     // packets are put on the overflow queue a barrier packet will also be
@@ -399,7 +508,9 @@ void InterceptQueue::StoreRelaxed(hsa_signal_value_t value) {
 hsa_status_t InterceptQueue::GetInfo(hsa_queue_info_attribute_t attribute, void* value) {
   switch (attribute) {
     case HSA_AMD_QUEUE_INFO_AGENT:
-    case HSA_AMD_QUEUE_INFO_DOORBELL_ID: {
+    case HSA_AMD_QUEUE_INFO_DOORBELL_ID:
+    case HSA_AMD_QUEUE_INFO_SCRATCH_DEMAND_HISTOGRAM:
+    case HSA_AMD_QUEUE_INFO_TELEMETRY: {
       if (!AMD::AqlQueue::IsType(wrapped.get())) return HSA_STATUS_ERROR_INVALID_QUEUE;
 
       AMD::AqlQueue* aqlQueue = static_cast<AMD::AqlQueue*>(wrapped.get());
@@ -41,6 +41,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "core/inc/interrupt_signal.h"
+#include "core/inc/metrics.h"
 #include "core/inc/runtime.h"
 #include "core/util/timer.h"
 #include "core/util/locks.h"
@@ -53,25 +54,106 @@
 namespace rocr {
 namespace core {
 
+std::atomic<uint64_t> InterruptSignal::EventPool::live_epoch_(0);
+
+InterruptSignal::EventPool::magazine_t& InterruptSignal::EventPool::magazine() {
+  static thread_local magazine_t cache;
+  return cache;
+}
+
+void InterruptSignal::EventPool::NewEpoch() {
+  static std::atomic<uint64_t> epoch_source(0);
+  epoch_ = ++epoch_source;
+  live_epoch_.store(epoch_, std::memory_order_release);
+}
+
+void InterruptSignal::EventPool::ReturnBatch(void* pool, HsaEvent** items, uint32_t count) {
+  EventPool* self = reinterpret_cast<EventPool*>(pool);
+  ScopedAcquire<HybridMutex> lock(&self->lock_);
+  for (uint32_t i = 0; i < count; i++) self->events_.push_back(unique_event_ptr(items[i]));
+}
+
+void InterruptSignal::EventPool::clear() {
+  magazine().Drain();
+  events_.clear();
+  shared_events_.clear();
+  created_.clear();
+  allEventsAllocated = false;
+  // Events cached by other threads are abandoned, KFD releases them with the process.
+  NewEpoch();
+}
+
 HsaEvent* InterruptSignal::EventPool::alloc() {
+  magazine_t& cache = magazine();
+  cache.Attach(this, epoch_, &live_epoch_, ReturnBatch);
+
+  HsaEvent* ret = cache.Pop();
+  if (ret != nullptr) return ret;
+
   ScopedAcquire<HybridMutex> lock(&lock_);
   if (events_.empty()) {
     if (!allEventsAllocated) {
       HsaEvent* evt = InterruptSignal::CreateEvent(HSA_EVENTTYPE_SIGNAL, false);
-      if (evt == nullptr) allEventsAllocated = true;
+      if (evt == nullptr)
+        allEventsAllocated = true;
+      else
+        created_.push_back(evt);
       return evt;
     }
     return nullptr;
   }
-  HsaEvent* ret = events_.back().release();
+  ret = events_.back().release();
   events_.pop_back();
+
+  // Move a batch into the calling thread's magazine for subsequent allocations.
+  uint32_t count = Min<size_t>(kMagazineBatch, events_.size());
+  HsaEvent** dst = cache.Reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    dst[i] = events_.back().release();
+    events_.pop_back();
+  }
+  cache.Commit(count);
   return ret;
 }
 
 void InterruptSignal::EventPool::free(HsaEvent* evt) {
   if (evt == nullptr) return;
+
+  magazine_t& cache = magazine();
+  cache.Attach(this, epoch_, &live_epoch_, ReturnBatch);
+  if (cache.Push(evt)) return;
+
+  // Magazine is full, return a batch to the shared list.
+  uint32_t count = kMagazineBatch;
+  HsaEvent** items = cache.Take(count);
+  {
+    ScopedAcquire<HybridMutex> lock(&lock_);
+    for (uint32_t i = 0; i < count; i++) events_.push_back(unique_event_ptr(items[i]));
+  }
+  cache.Push(evt);
+}
+
+HsaEvent* InterruptSignal::EventPool::alloc_shared() {
+  // Without event age a wakeup is consumed by whichever waiter sees it first, so waiters on
+  // other signals sharing the event could sleep through their own completion.
+  if (!Runtime::runtime_singleton_->KfdVersion().supports_event_age) return nullptr;
+
   ScopedAcquire<HybridMutex> lock(&lock_);
-  events_.push_back(unique_event_ptr(evt));
+  const uint32_t limit = Runtime::runtime_singleton_->flag().signal_shared_events();
+  if (shared_events_.size() < limit && !allEventsAllocated) {
+    HsaEvent* evt = InterruptSignal::CreateEvent(HSA_EVENTTYPE_SIGNAL, false);
+    if (evt != nullptr) {
+      shared_events_.push_back(unique_event_ptr(evt));
+      return evt;
+    }
+    allEventsAllocated = true;
+  }
+
+  // Waiters recheck their own signal's value on every wakeup, so spreading signals over the
+  // available events only costs spurious wakeups.
+  if (!shared_events_.empty()) return shared_events_[next_shared_++ % shared_events_.size()].get();
+  if (!created_.empty()) return created_[next_shared_++ % created_.size()];
+  return nullptr;
 }
 
 HsaEvent* InterruptSignal::CreateEvent(HSA_EVENTTYPE type, bool manual_reset) {
@@ -98,13 +180,21 @@ HsaEvent* InterruptSignal::CreateEvent(HSA_EVENTTYPE type, bool manual_reset) {
 void InterruptSignal::DestroyEvent(HsaEvent* evt) { hsaKmtDestroyEvent(evt); }
 
 InterruptSignal::InterruptSignal(hsa_signal_value_t initial_value, HsaEvent* use_event)
-    : LocalSignal(initial_value, false), Signal(signal()) {
+    : LocalSignal(initial_value, false), Signal(signal()), event_fd_(-1) {
   if (use_event != nullptr) {
     event_ = use_event;
     free_event_ = false;
   } else {
-    event_ = Runtime::runtime_singleton_->GetEventPool()->alloc();
-    free_event_ = true;
+    EventPool* pool = Runtime::runtime_singleton_->GetEventPool();
+    const bool shared = Runtime::runtime_singleton_->flag().signal_shared_events() != 0;
+    event_ = shared ? pool->alloc_shared() : nullptr;
+    free_event_ = false;
+    if (event_ == nullptr) {
+      event_ = pool->alloc();
+      free_event_ = (event_ != nullptr);
+    }
+    // Share an event rather than degrade to polling once KFD has no more to give.
+    if (event_ == nullptr) event_ = pool->alloc_shared();
   }
 
   if (event_ != nullptr) {
@@ -118,9 +208,32 @@ InterruptSignal::InterruptSignal(hsa_signal_value_t initial_value, HsaEvent* use
 }
 
 InterruptSignal::~InterruptSignal() {
+  // Stop the driver library from watching the event before it is recycled.
+  if (event_fd_ != -1) {
+    hsaKmtCloseEventFd(event_fd_);
+    WaitingDec();
+  }
   if (free_event_) Runtime::runtime_singleton_->GetEventPool()->free(event_);
 }
 
+hsa_status_t InterruptSignal::GetEventFd(int* fd) {
+  if (event_ == nullptr) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  ScopedAcquire<KernelMutex> lock(&event_fd_lock_);
+  if (event_fd_ == -1) {
+    HsaEvent* evt = event_;
+    if (hsaKmtOpenEventFd(&evt, 1, &event_fd_) != HSAKMT_STATUS_SUCCESS) {
+      event_fd_ = -1;
+      return HSA_STATUS_ERROR;
+    }
+    // Host side updates only signal the event while someone waits on it, the
+    // exported fd is a permanent waiter.
+    WaitingInc();
+  }
+  *fd = event_fd_;
+  return HSA_STATUS_SUCCESS;
+}
+
 hsa_signal_value_t InterruptSignal::LoadRelaxed() {
   return hsa_signal_value_t(
       atomic::Load(&signal_.value, std::memory_order_relaxed));
@@ -149,17 +262,21 @@ hsa_signal_value_t InterruptSignal::WaitRelaxed(
 
   uint32_t prior = waiting_++;
   MAKE_SCOPE_GUARD([&]() { waiting_--; });
+  TimelineSpan span(Timeline::kSignalWait, Convert(this).handle);
 
   uint64_t event_age = 1;
 
   const uint32_t &signal_abort_timeout =
     core::Runtime::runtime_singleton_->flag().signal_abort_timeout();
 
+  // Only one thread per event sleeps in the driver, the others follow it through the mux.
+  // Without event age tracking only the first waiter may consume the event, a race could
+  // otherwise leave some threads asleep with the interrupt missed.  Later waiters sleep while
+  // it is in the driver and poll otherwise.
+  bool lead = true;
   if (!core::Runtime::runtime_singleton_->KfdVersion().supports_event_age) {
-      event_age = 0;
-      // Allow only the first waiter to sleep. Without event age tracking,
-      // race condition can cause some threads to sleep without wakeup since missing interrupt.
-      if (prior != 0) wait_hint = HSA_WAIT_STATE_ACTIVE;
+    event_age = 0;
+    lead = (prior == 0);
   }
 
   int64_t value;
@@ -167,8 +284,9 @@ hsa_signal_value_t InterruptSignal::WaitRelaxed(
   timer::fast_clock::time_point start_time = timer::fast_clock::now();
 
   // Set a polling timeout value
-  // Should be a few times bigger than null kernel latency
-  const timer::fast_clock::duration kMaxElapsed = std::chrono::microseconds(200);
+  // Should be a few times bigger than null kernel latency, shortened or lengthened by the
+  // signal's wait policy.
+  const timer::fast_clock::duration kMaxElapsed = SpinBudget(std::chrono::microseconds(200));
 
   uint64_t hsa_freq;
   HSA::hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY, &hsa_freq);
@@ -177,6 +295,8 @@ hsa_signal_value_t InterruptSignal::WaitRelaxed(
           double(timeout) / double(hsa_freq));
 
   bool condition_met = false;
+  bool polled = false;
+  bool slept = false;
 
 #if defined(__i386__) || defined(__x86_64__)
   if (g_use_mwaitx) _mm_monitorx(const_cast<int64_t*>(&signal_.value), 0, 0);
@@ -185,6 +305,7 @@ hsa_signal_value_t InterruptSignal::WaitRelaxed(
   while (true) {
     if (!IsValid()) return 0;
 
+    const uint32_t generation = EventWaitMux::Generation(event_);
     value = atomic::Load(&signal_.value, std::memory_order_relaxed);
 
     switch (condition) {
@@ -207,7 +328,13 @@ hsa_signal_value_t InterruptSignal::WaitRelaxed(
       default:
         return 0;
     }
-    if (condition_met) return hsa_signal_value_t(value);
+    if (condition_met) {
+      // Only waits which had to poll say anything about completion latency.
+      if (polled) RecordWaitLatency(timer::fast_clock::now() - start_time);
+      if (polled && !slept) Metrics::Count(HSA_AMD_RUNTIME_COUNTER_SIGNAL_WAIT_SPINS);
+      return hsa_signal_value_t(value);
+    }
+    polled = true;
 
     timer::fast_clock::time_point time = timer::fast_clock::now();
     if (time - start_time > fast_timeout) {
@@ -254,7 +381,11 @@ hsa_signal_value_t InterruptSignal::WaitRelaxed(
     if (signal_abort_timeout)
       wait_ms = std::min(wait_ms, signal_abort_timeout * 1000);
 
-    hsaKmtWaitOnEvent_Ext(event_, wait_ms, &event_age);
+    FlushDeferredInterrupt();
+    if (EventWaitMux::Wait(event_, generation, wait_ms, &event_age, lead)) {
+      slept = true;
+      Metrics::Count(HSA_AMD_RUNTIME_COUNTER_SIGNAL_WAIT_SLEEPS);
+    }
   }
 }
 
@@ -42,6 +42,13 @@
 
 #include "core/inc/ipc_signal.h"
 
+#include <climits>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include <utility>
 
 #include "core/inc/runtime.h"
@@ -68,10 +75,80 @@ SharedMemory::~SharedMemory() {
   assert(err == HSA_STATUS_SUCCESS && "IPC detach failed.");
 }
 
+std::string IPCDoorbell::Name(uint64_t id) {
+  char name[32];
+  snprintf(name, sizeof(name), "/hsa_doorbell_%016lx", id);
+  return name;
+}
+
+IPCDoorbell* IPCDoorbell::Create(SharedSignal* abi_block) {
+  static std::atomic<uint32_t> counter(0);
+  uint64_t id = (uint64_t(getpid()) << 32) | ++counter;
+  std::string name = Name(id);
+
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+  if (fd == -1) return nullptr;
+  MAKE_SCOPE_GUARD([&]() { close(fd); });
+  MAKE_NAMED_SCOPE_GUARD(unlinkGuard, [&]() { shm_unlink(name.c_str()); });
+  if (ftruncate(fd, sizeof(Page)) == -1) return nullptr;
+
+  void* page = mmap(nullptr, sizeof(Page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (page == MAP_FAILED) return nullptr;
+  unlinkGuard.Dismiss();
+
+  abi_block->ipc_doorbell = id;
+  return new IPCDoorbell(reinterpret_cast<Page*>(page), id, true);
+}
+
+IPCDoorbell* IPCDoorbell::Open(const SharedSignal* abi_block) {
+  if (abi_block->ipc_doorbell == 0 ||
+      !Runtime::runtime_singleton_->flag().ipc_signal_doorbell())
+    return nullptr;
+
+  int fd = shm_open(Name(abi_block->ipc_doorbell).c_str(), O_RDWR | O_CLOEXEC, 0);
+  if (fd == -1) return nullptr;
+  MAKE_SCOPE_GUARD([&]() { close(fd); });
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || size_t(st.st_size) < sizeof(Page)) return nullptr;
+
+  void* page = mmap(nullptr, sizeof(Page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (page == MAP_FAILED) return nullptr;
+  return new IPCDoorbell(reinterpret_cast<Page*>(page), abi_block->ipc_doorbell, false);
+}
+
+IPCDoorbell::~IPCDoorbell() {
+  munmap(page_, sizeof(Page));
+  if (owner_) shm_unlink(Name(id_).c_str());
+}
+
+void IPCDoorbell::Ring() {
+  // Order the signal update before the sequence bump, pairing with AddWaiter() in Wait's caller.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  page_->sequence.fetch_add(1, std::memory_order_seq_cst);
+  if (page_->waiters.load(std::memory_order_seq_cst) != 0)
+    syscall(SYS_futex, &page_->sequence, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void IPCDoorbell::Wait(uint32_t seq, uint32_t timeout_us) {
+  struct timespec ts;
+  ts.tv_sec = timeout_us / 1000000;
+  ts.tv_nsec = (timeout_us % 1000000) * 1000;
+  syscall(SYS_futex, &page_->sequence, FUTEX_WAIT, seq, &ts, nullptr, 0);
+}
+
 void IPCSignal::CreateHandle(Signal* signal, hsa_amd_ipc_signal_t* ipc_handle) {
   if (!signal->isIPC())
     throw AMD::hsa_exception(HSA_STATUS_ERROR_INVALID_ARGUMENT, "Signal must be IPC enabled.");
   SharedSignal* shared = SharedSignal::Convert(Convert(signal));
+
+  // Give the signal a host doorbell before it can be attached elsewhere.
+  if (BusyWaitSignal::IsType(signal) &&
+      Runtime::runtime_singleton_->flag().ipc_signal_doorbell()) {
+    BusyWaitSignal* busy = static_cast<BusyWaitSignal*>(signal);
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    if (busy->doorbell() == nullptr) busy->SetDoorbell(IPCDoorbell::Create(shared));
+  }
   hsa_status_t err = Runtime::runtime_singleton_->IPCCreate(shared, 4096, ipc_handle);
   if (err != HSA_STATUS_SUCCESS) throw AMD::hsa_exception(err, "IPC memory create failed.");
 }
@@ -78,13 +78,7 @@ static __forceinline std::string strip_features(const std::string &isa_name) {
 bool Isa::IsCompatible(const Isa &code_object_isa,
                        const Isa &agent_isa, unsigned int codeGenericVersion) {
 
-  bool code_obj_isa_is_generic = false;
-  auto generic_it = IsaRegistry::GetSupportedGenericVersions().find(
-                                                 code_object_isa.GetIsaName());
-
-  if (generic_it != IsaRegistry::GetSupportedGenericVersions().end()) {
-    code_obj_isa_is_generic = true;
-  }
+  const unsigned min_generic_version = code_object_isa.GetMinGenericVersion();
 
   assert(code_object_isa.IsSrameccSupported() == agent_isa.IsSrameccSupported()
                                  && agent_isa.GetSramecc() != IsaFeature::Any);
@@ -99,16 +93,15 @@ bool Isa::IsCompatible(const Isa &code_object_isa,
       code_object_isa.GetXnack() != agent_isa.GetXnack())
     return false;
 
-  if (code_obj_isa_is_generic) {
+  if (min_generic_version != 0) {
       // Verify the generic code object corresponds to the generic for
       // this isa agent.
-      if (strip_features(agent_isa.GetIsaGeneric()) !=
-                              strip_features(code_object_isa.GetIsaName())) {
+      if (agent_isa.GetGenericProcessorId() != code_object_isa.GetProcessorId()) {
         return false;
       }
       // Verify the generic code object version is greater than or equal to
       // the generic version for this isa agent.
-      if (codeGenericVersion < generic_it->second) {
+      if (codeGenericVersion < min_generic_version) {
         return false;
       }
   } else if (code_object_isa.GetVersion() != agent_isa.GetVersion()) {
@@ -118,19 +111,11 @@ bool Isa::IsCompatible(const Isa &code_object_isa,
   return true;
 }
 
-std::string Isa::GetProcessorName() const {
-  return strip_features(targetid_);
-}
-
 static __forceinline std::string prepend_isa_prefix(const std::string &isa_name) {
   constexpr char hsa_isa_name_prefix[] = "amdgcn-amd-amdhsa--";
   return hsa_isa_name_prefix + isa_name;
 }
 
-std::string Isa::GetIsaName() const {
-  return prepend_isa_prefix(targetid_);
-}
-
 bool Isa::GetInfo(const hsa_isa_info_t &attribute, void *value) const {
   if (!value) {
     return false;
@@ -138,12 +123,12 @@ bool Isa::GetInfo(const hsa_isa_info_t &attribute, void *value) const {
 
   switch (attribute) {
     case HSA_ISA_INFO_NAME_LENGTH: {
-      std::string isa_name = GetIsaName();
+      const std::string &isa_name = GetIsaName();
       *((uint32_t*)value) = static_cast<uint32_t>(isa_name.size() + 1);
       return true;
     }
     case HSA_ISA_INFO_NAME: {
-      std::string isa_name = GetIsaName();
+      const std::string &isa_name = GetIsaName();
       memset(value, 0x0, isa_name.size() + 1);
       memcpy(value, isa_name.c_str(), isa_name.size());
       return true;
@@ -229,10 +214,21 @@ hsa_round_method_t Isa::GetRoundMethod(
   return HSA_ROUND_METHOD_SINGLE;
 }
 
-const Isa *IsaRegistry::GetIsa(const std::string &full_name) {
-  auto isareg_iter = GetSupportedIsas().find(full_name);
-  return isareg_iter == GetSupportedIsas().end() ?
-                                              nullptr : &isareg_iter->second;
+const Isa *IsaRegistry::GetIsa(std::string_view full_name) {
+  const auto &index = GetIsaIndex();
+  auto isareg_iter = index.find(full_name);
+  return isareg_iter == index.end() ? nullptr : isareg_iter->second;
+}
+
+const std::unordered_map<std::string_view, const Isa *> &IsaRegistry::GetIsaIndex() {
+  // Keys view the names held by the registry, which is never modified once built.
+  static const std::unordered_map<std::string_view, const Isa *> index = [] {
+    std::unordered_map<std::string_view, const Isa *> map;
+    for (const auto &isareg : GetSupportedIsas())
+      map.emplace(isareg.second.GetIsaName(), &isareg.second);
+    return map;
+  }();
+  return index;
 }
 
 const Isa *IsaRegistry::GetIsa(const Isa::Version &version, IsaFeature sramecc, IsaFeature xnack) {
@@ -450,6 +446,25 @@ const IsaRegistry::IsaMap& IsaRegistry::GetSupportedIsas() {
   ISAREG_ENTRY_GEN("gfx1201",                12, 0, 1, unsupported, unsupported, 32, "gfx12-generic")
 #undef ISAREG_ENTRY_GEN
 
+  // Intern names and processor ids once so compatibility checks compare integers.
+  std::unordered_map<std::string, uint32_t> processor_ids;
+  for (auto &isareg : *supported_isas) {
+    Isa &isa = isareg.second;
+    isa.name_ = isareg.first;
+    isa.processor_ = strip_features(isa.targetid_);
+    isa.processor_id_ =
+        processor_ids.emplace(isa.processor_, uint32_t(processor_ids.size() + 1)).first->second;
+    auto generic_it = GetSupportedGenericVersions().find(isa.name_);
+    if (generic_it != GetSupportedGenericVersions().end())
+      isa.min_generic_version_ = generic_it->second;
+  }
+  for (auto &isareg : *supported_isas) {
+    Isa &isa = isareg.second;
+    if (!isa.generic_.empty())
+      isa.generic_processor_id_ = processor_ids[strip_features(isa.generic_.substr(
+          isa.generic_.find("--") + 2))];
+  }
+
   return *supported_isas;
 }
 
@@ -0,0 +1,229 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/inc/metrics.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "core/inc/runtime.h"
+#include "core/util/locks.h"
+
+namespace rocr {
+namespace core {
+
+namespace {
+
+const char* kCounterNames[HSA_AMD_RUNTIME_COUNTER_COUNT] = {
+    "scratch_traps", "signal_wait_spins", "signal_wait_sleeps", "fragment_alloc_hits",
+    "fragment_alloc_misses", "lock_acquires", "lock_contended"};
+
+const char* kHistogramNames[HSA_AMD_RUNTIME_HISTOGRAM_COUNT] = {
+    "copy_submit_ns", "sdma_pending_bytes", "allocation_bytes", "async_handler_signals",
+    "queue_depth", "queue_stall_ms", "lock_wait_ns"};
+
+struct Registry {
+  KernelMutex lock;
+  std::vector<void*> live;
+  // Totals of exited threads.
+  hsa_amd_runtime_metrics_t retired = {};
+};
+
+// Leaked so thread exit after static destruction still finds it.
+Registry& registry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+}  // namespace
+
+Metrics::ThreadBlock::ThreadBlock() : block(new Block()) {
+  for (auto& counter : block->counters) counter.store(0, std::memory_order_relaxed);
+  for (auto& histogram : block->histograms)
+    for (auto& bucket : histogram) bucket.store(0, std::memory_order_relaxed);
+
+  Registry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  reg.live.push_back(block);
+}
+
+Metrics::ThreadBlock::~ThreadBlock() {
+  Registry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  for (uint32_t i = 0; i < HSA_AMD_RUNTIME_COUNTER_COUNT; i++)
+    reg.retired.counters[i] += block->counters[i].load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < HSA_AMD_RUNTIME_HISTOGRAM_COUNT; i++)
+    for (uint32_t j = 0; j < kBuckets; j++)
+      reg.retired.histograms[i][j] += block->histograms[i][j].load(std::memory_order_relaxed);
+  reg.live.erase(std::find(reg.live.begin(), reg.live.end(), block));
+  lock.Release();
+  delete block;
+}
+
+void Metrics::Snapshot(hsa_amd_runtime_metrics_t* metrics) {
+  Registry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  *metrics = reg.retired;
+  for (void* entry : reg.live) {
+    const Block* block = reinterpret_cast<const Block*>(entry);
+    for (uint32_t i = 0; i < HSA_AMD_RUNTIME_COUNTER_COUNT; i++)
+      metrics->counters[i] += block->counters[i].load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < HSA_AMD_RUNTIME_HISTOGRAM_COUNT; i++)
+      for (uint32_t j = 0; j < kBuckets; j++)
+        metrics->histograms[i][j] += block->histograms[i][j].load(std::memory_order_relaxed);
+  }
+  lock.Release();
+
+#ifdef HSA_LOCK_STATS
+  LockStats::Iterate(
+      [](const LockStats& stats, void* data) {
+        auto* metrics = reinterpret_cast<hsa_amd_runtime_metrics_t*>(data);
+        metrics->counters[HSA_AMD_RUNTIME_COUNTER_LOCK_ACQUIRES] +=
+            stats.acquires.load(std::memory_order_relaxed);
+        metrics->counters[HSA_AMD_RUNTIME_COUNTER_LOCK_CONTENDED] +=
+            stats.contended.load(std::memory_order_relaxed);
+        for (uint32_t j = 0; j < kBuckets; j++)
+          metrics->histograms[HSA_AMD_RUNTIME_HISTOGRAM_LOCK_WAIT_NS][j] +=
+              stats.wait_ns_histogram[j].load(std::memory_order_relaxed);
+      },
+      metrics);
+#endif
+}
+
+void Metrics::Dump(FILE* file) {
+  hsa_amd_runtime_metrics_t metrics;
+  Snapshot(&metrics);
+
+  fprintf(file, "rocr metrics pid %d\n", os::GetProcessId());
+  for (uint32_t i = 0; i < HSA_AMD_RUNTIME_COUNTER_COUNT; i++)
+    if (metrics.counters[i] != 0)
+      fprintf(file, "  %s %lu\n", kCounterNames[i], metrics.counters[i]);
+
+  // Buckets are printed as the lower bound of their range.
+  for (uint32_t i = 0; i < HSA_AMD_RUNTIME_HISTOGRAM_COUNT; i++) {
+    bool empty = true;
+    for (uint32_t j = 0; j < kBuckets; j++) {
+      if (metrics.histograms[i][j] == 0) continue;
+      if (empty) fprintf(file, "  %s", kHistogramNames[i]);
+      empty = false;
+      fprintf(file, " %lu:%lu", (j == 0) ? 0ul : (1ul << (j - 1)), metrics.histograms[i][j]);
+    }
+    if (!empty) fprintf(file, "\n");
+  }
+
+#ifdef HSA_LOCK_STATS
+  // One line per contended lock followed by the sites that held it while others waited.
+  LockStats::Iterate(
+      [](const LockStats& stats, void* data) {
+        FILE* file = reinterpret_cast<FILE*>(data);
+        const uint64_t contended = stats.contended.load(std::memory_order_relaxed);
+        if (contended == 0) return;
+        fprintf(file, "  lock %s acquires %lu contended %lu wait_ns", stats.name,
+                stats.acquires.load(std::memory_order_relaxed), contended);
+        for (uint32_t j = 0; j < kBuckets; j++) {
+          const uint64_t count = stats.wait_ns_histogram[j].load(std::memory_order_relaxed);
+          if (count != 0) fprintf(file, " %lu:%lu", (j == 0) ? 0ul : (1ul << (j - 1)), count);
+        }
+        fprintf(file, "\n");
+        const uint32_t num_sites = stats.num_sites.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < num_sites; i++) {
+          const uint64_t count = stats.sites[i].contended.load(std::memory_order_relaxed);
+          if (count != 0)
+            fprintf(file, "    holder %s:%u %lu\n", stats.sites[i].site.file,
+                    stats.sites[i].site.line, count);
+        }
+      },
+      file);
+#endif
+  fflush(file);
+}
+
+MetricsDumper::MetricsDumper() : file_(nullptr), thread_(nullptr), event_(nullptr), exit_(false) {
+  const Flag& flag = Runtime::runtime_singleton_->flag();
+  if (flag.metrics_dump().empty()) return;
+
+  file_ = fopen(flag.metrics_dump().c_str(), "a");
+  if (file_ == nullptr) return;
+
+  if (flag.metrics_dump_interval() == 0) return;
+
+  event_ = os::CreateOsEvent(true, false);
+  if (event_ == nullptr) return;
+
+  thread_ =
+      Runtime::runtime_singleton_->CreateThread(HSA_AMD_THREAD_CLASS_BACKGROUND, DumpRun, this);
+  if (thread_ == nullptr) {
+    debug_warning("Failed to start metrics dump thread.");
+    os::DestroyOsEvent(event_);
+    event_ = nullptr;
+  }
+}
+
+MetricsDumper::~MetricsDumper() {
+  if (thread_ != nullptr) {
+    exit_ = true;
+    os::SetOsEvent(event_);
+    os::WaitForThread(thread_);
+    os::CloseThread(thread_);
+    os::DestroyOsEvent(event_);
+  }
+  if (file_ != nullptr) {
+    Metrics::Dump(file_);
+    fclose(file_);
+  }
+}
+
+void MetricsDumper::DumpRun(void* dumper) {
+  reinterpret_cast<MetricsDumper*>(dumper)->DumpLoop();
+}
+
+void MetricsDumper::DumpLoop() {
+  const uint32_t interval_ms = Runtime::runtime_singleton_->flag().metrics_dump_interval();
+  while (true) {
+    os::WaitForOsEvent(event_, interval_ms);
+    if (exit_) return;
+    Metrics::Dump(file_);
+  }
+}
+
+}  // namespace core
+}  // namespace rocr
@@ -41,7 +41,13 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "core/inc/queue.h"
+
+#include <emmintrin.h>
+
 #include "core/inc/runtime.h"
+#include "core/inc/signal.h"
+#include "core/util/atomic_helpers.h"
+#include "core/util/os.h"
 
 namespace rocr {
 namespace core {
@@ -58,5 +64,65 @@ void Queue::DefaultErrorHandler(hsa_status_t status, hsa_queue_t* source, void*
   }
 }
 
+hsa_status_t Queue::SubmitBatch(const void* packets, uint32_t count, uint64_t* first_index) {
+  const uint32_t size = amd_queue_.hsa_queue.size;
+  if (packets == nullptr || count == 0 || count > size) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  const AqlPacket* src = reinterpret_cast<const AqlPacket*>(packets);
+  for (uint32_t i = 0; i < count; i++)
+    if (!AqlPacket::IsValid(src[i].packet.header)) return HSA_STATUS_ERROR_INVALID_PACKET_FORMAT;
+
+  // One write index update reserves the whole batch, so concurrent producers never interleave.
+  const uint64_t index = AddWriteIndexRelaxed(count);
+  const uint64_t end = index + count;
+  while (end - LoadReadIndexAcquire() > size) os::YieldThread();
+
+  AqlPacket* ring = reinterpret_cast<AqlPacket*>(amd_queue_.hsa_queue.base_address);
+  const uint64_t mask = size - 1;
+
+  // Stream the packet bodies past the cache with the header kept INVALID, then publish the
+  // headers in order once the bodies are globally visible.
+  for (uint32_t i = 0; i < count; i++) {
+    const __m128i* in = reinterpret_cast<const __m128i*>(&src[i]);
+    __m128i* out = reinterpret_cast<__m128i*>(&ring[(index + i) & mask]);
+    _mm_stream_si128(out, _mm_insert_epi16(_mm_loadu_si128(in), HSA_PACKET_TYPE_INVALID, 0));
+    for (int chunk = 1; chunk < 4; chunk++)
+      _mm_stream_si128(out + chunk, _mm_loadu_si128(in + chunk));
+  }
+  _mm_sfence();
+
+  for (uint32_t i = 0; i < count; i++) {
+    const uint32_t dword0 = *reinterpret_cast<const uint32_t*>(&src[i]);
+    atomic::Store(reinterpret_cast<uint32_t*>(&ring[(index + i) & mask]), dword0,
+                  std::memory_order_release);
+  }
+
+  if (first_index != nullptr) *first_index = index;
+
+  // Coalesce doorbell rings.  The packet processor stops at the first INVALID header, so ringing
+  // past slots another producer is still writing is safe.  Whoever holds the lock rings for the
+  // highest requested index; everyone else only waits until their batch is covered.
+  uint64_t requested = doorbell_requested_.load(std::memory_order_relaxed);
+  while (requested < end &&
+         !doorbell_requested_.compare_exchange_weak(requested, end, std::memory_order_acq_rel)) {
+  }
+
+  while (doorbell_rung_.load(std::memory_order_acquire) < end) {
+    if (!doorbell_lock_.Try()) {
+      _mm_pause();
+      continue;
+    }
+    const uint64_t target = doorbell_requested_.load(std::memory_order_acquire);
+    if (target > doorbell_rung_.load(std::memory_order_relaxed)) {
+      hsa_signal_t doorbell = amd_queue_.hsa_queue.doorbell_signal;
+      if (!Signal::StoreDirect(doorbell, target - 1, std::memory_order_release))
+        Signal::Convert(doorbell)->StoreRelease(target - 1);
+      doorbell_rung_.store(target, std::memory_order_release);
+    }
+    doorbell_lock_.Release();
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
 }  // namespace core
 }  // namespace rocr
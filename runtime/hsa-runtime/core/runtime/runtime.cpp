@@ -48,11 +48,13 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <fcntl.h>
 #include <link.h>
 #include <dlfcn.h>
 #include <amdgpu_drm.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/un.h>
 #include <iostream>
 #include <thread>
@@ -72,6 +74,7 @@
 #include "core/inc/amd_memory_region.h"
 #include "core/inc/amd_topology.h"
 #include "core/inc/signal.h"
+#include "core/inc/default_signal.h"
 #include "core/inc/interrupt_signal.h"
 #include "core/inc/hsa_ext_amd_impl.h"
 #include "core/inc/hsa_api_trace_int.h"
@@ -80,6 +83,7 @@
 #include "inc/hsa_ven_amd_aqlprofile.h"
 #include "core/inc/amd_core_dump.hpp"
 #include "core/inc/host_queue.h"
+#include "loader/code_object_cache.hpp"
 
 #ifndef HSA_VERSION_MAJOR
 #define HSA_VERSION_MAJOR 1
@@ -109,6 +113,11 @@ bool g_use_interrupt_wait;
 bool g_use_mwaitx;
 Runtime* Runtime::runtime_singleton_ = NULL;
 
+std::atomic<bool> Runtime::forked_(false);
+
+thread_local hsa_amd_memory_usage_category_t Runtime::MemoryUsageScope::current_ =
+    HSA_AMD_MEMORY_USAGE_USER;
+
 
 __forceinline static bool& loaded() {
   static bool loaded_ = true;
@@ -118,7 +127,8 @@ __forceinline static bool& loaded() {
 class RuntimeCleanup {
  public:
   ~RuntimeCleanup() {
-    if (!Runtime::IsOpen()) {
+    // A runtime inherited across fork is never torn down by the child.
+    if (!Runtime::IsOpen() && !Runtime::forked_) {
       delete Runtime::runtime_singleton_;
     }
 
@@ -134,6 +144,8 @@ hsa_status_t Runtime::Acquire() {
 
   ScopedAcquire<KernelMutex> boot(&bootstrap_lock());
 
+  DropForkedRuntime();
+
   if (runtime_singleton_ == NULL) {
     memset(log_flags, 0, sizeof(log_flags));
     runtime_singleton_ = new Runtime();
@@ -164,6 +176,8 @@ hsa_status_t Runtime::Release() {
 
   ScopedAcquire<KernelMutex> boot(&bootstrap_lock());
 
+  DropForkedRuntime();
+
   if (runtime_singleton_ == nullptr) return HSA_STATUS_ERROR_NOT_INITIALIZED;
 
   if (runtime_singleton_->ref_count_ == 1) {
@@ -183,7 +197,31 @@ hsa_status_t Runtime::Release() {
 
 bool Runtime::IsOpen() {
   return (Runtime::runtime_singleton_ != NULL) &&
-         (Runtime::runtime_singleton_->ref_count_ != 0);
+         (Runtime::runtime_singleton_->ref_count_ != 0) && !forked_.load(std::memory_order_relaxed);
+}
+
+void Runtime::PrepareFork() {
+  bootstrap_lock().Acquire();
+  amd::hsa::loader::CodeObjectCache::Instance().LockForFork();
+}
+
+void Runtime::ParentFork() {
+  amd::hsa::loader::CodeObjectCache::Instance().UnlockAfterFork();
+  bootstrap_lock().Release();
+}
+
+void Runtime::ChildFork() {
+  // The driver connection is reopened by the thunk, which keeps its topology snapshot, and parsed
+  // code objects stay cached, so the child's hsa_init skips discovery and parsing.
+  amd::hsa::loader::CodeObjectCache::Instance().UnlockAfterFork();
+  if (runtime_singleton_ != nullptr) forked_ = true;
+  bootstrap_lock().Release();
+}
+
+void Runtime::DropForkedRuntime() {
+  if (!forked_) return;
+  runtime_singleton_ = nullptr;
+  forked_ = false;
 }
 
 // Register agent information only.  Must not call anything that may use the registered information
@@ -221,9 +259,16 @@ void Runtime::RegisterAgent(Agent* agent, bool Enabled) {
           system_allocator_ = [pool](size_t size, size_t alignment,
                                      MemoryRegion::AllocateFlags alloc_flags, int agent_node_id) -> void* {
             assert(alignment <= 4096);
+            MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_INTERNAL);
+            // Place memory used on behalf of an agent on that agent's nearest NUMA node.
+            const MemoryRegion* node_pool = pool;
+            const auto& node_pools = core::Runtime::runtime_singleton_->node_system_pool_;
+            if ((agent_node_id >= 0) && (size_t(agent_node_id) < node_pools.size()) &&
+                (node_pools[agent_node_id] != nullptr))
+              node_pool = node_pools[agent_node_id];
             void* ptr = NULL;
             return (HSA_STATUS_SUCCESS ==
-                    core::Runtime::runtime_singleton_->AllocateMemory(pool, size, alloc_flags,
+                    core::Runtime::runtime_singleton_->AllocateMemory(node_pool, size, alloc_flags,
                                                                       &ptr, agent_node_id))
                 ? ptr
                 : NULL;
@@ -262,11 +307,8 @@ void Runtime::RegisterDriver(std::unique_ptr<Driver> &driver) {
 void Runtime::DestroyAgents() {
   agents_by_node_.clear();
 
-  std::for_each(gpu_agents_.begin(), gpu_agents_.end(), DeleteObject());
-  gpu_agents_.clear();
-
-  std::for_each(disabled_gpu_agents_.begin(), disabled_gpu_agents_.end(), DeleteObject());
-  disabled_gpu_agents_.clear();
+  DeleteAgents(gpu_agents_);
+  DeleteAgents(disabled_gpu_agents_);
 
   gpu_ids_.clear();
 
@@ -278,6 +320,7 @@ void Runtime::DestroyAgents() {
 
   region_gpu_ = NULL;
 
+  node_system_pool_.clear();
   system_regions_fine_.clear();
   system_regions_coarse_.clear();
 }
@@ -319,6 +362,174 @@ uint32_t Runtime::GetIndexLinkInfo(uint32_t node_id_from, uint32_t node_id_to) {
   return ((node_id_from * num_nodes_) + node_id_to);
 }
 
+void Runtime::BuildTopologyMatrix() {
+  // Best known route between each pair of nodes.  Bandwidth and latency are 0 when unknown.
+  struct Route {
+    uint64_t weight;
+    uint32_t hops;
+    uint32_t bandwidth;
+    uint32_t latency;
+  };
+  const uint64_t kNoRoute = UINT64_MAX;
+  const size_t n = num_nodes_;
+  std::vector<Route> routes(n * n, Route{kNoRoute, 0, 0, 0});
+  for (size_t i = 0; i < n; i++) {
+    routes[i * n + i].weight = 0;
+    for (size_t j = 0; j < n; j++) {
+      const LinkInfo& link = link_matrix_[i * n + j];
+      if (i == j || link.num_hop == 0) continue;
+      routes[i * n + j] = {link.info.numa_distance, 1, link.info.max_bandwidth,
+                           link.info.min_latency};
+    }
+  }
+
+  // Floyd-Warshall on link weight.  The thunk also reports indirect links whose weight is the
+  // sum of the hops they stand for but which carry no bandwidth, so among routes of equal
+  // weight the one with known bandwidth wins, which also recovers the real hop count.
+  auto better = [](const Route& a, const Route& b) {
+    if (a.weight != b.weight) return a.weight < b.weight;
+    if ((a.bandwidth != 0) != (b.bandwidth != 0)) return a.bandwidth != 0;
+    return a.hops < b.hops;
+  };
+  for (size_t k = 0; k < n; k++) {
+    for (size_t i = 0; i < n; i++) {
+      const Route& ik = routes[i * n + k];
+      if (i == k || ik.weight == kNoRoute) continue;
+      for (size_t j = 0; j < n; j++) {
+        const Route& kj = routes[k * n + j];
+        if (j == k || i == j || kj.weight == kNoRoute) continue;
+        Route via = {ik.weight + kj.weight, ik.hops + kj.hops,
+                     (ik.bandwidth && kj.bandwidth) ? Min(ik.bandwidth, kj.bandwidth) : 0,
+                     (ik.latency && kj.latency) ? ik.latency + kj.latency : 0};
+        if (better(via, routes[i * n + j])) routes[i * n + j] = via;
+      }
+    }
+  }
+
+  Topology& topo = topology_;
+  topo = Topology();
+  topo.agents.insert(topo.agents.end(), cpu_agents_.begin(), cpu_agents_.end());
+  topo.agents.insert(topo.agents.end(), gpu_agents_.begin(), gpu_agents_.end());
+
+  const size_t count = topo.agents.size();
+  topo.hops.resize(count * count);
+  topo.numa_distance.resize(count * count);
+  topo.bandwidth.resize(count * count);
+  topo.latency.resize(count * count);
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = 0; j < count; j++) {
+      const Route& route = routes[topo.agents[i]->node_id() * n + topo.agents[j]->node_id()];
+      const size_t idx = i * count + j;
+      const bool reachable = (route.weight != kNoRoute);
+      topo.hops[idx] = reachable ? route.hops : UINT32_MAX;
+      topo.numa_distance[idx] = reachable ? uint32_t(Min<uint64_t>(route.weight, UINT32_MAX - 1))
+                                          : UINT32_MAX;
+      topo.bandwidth[idx] = route.bandwidth;
+      topo.latency[idx] = route.latency;
+    }
+  }
+
+  const std::vector<os::NetDevice> nics = os::GetNetDevices();
+  for (Agent* gpu : gpu_agents_) {
+    AMD::GpuAgent* agent = static_cast<AMD::GpuAgent*>(gpu);
+    Topology::Nearest nearest = {};
+    nearest.gpu = gpu;
+    nearest.cpu = agent->GetNearestCpuAgent();
+    nearest.numa_node =
+        os::GetPciNumaNode(agent->properties().Domain, agent->properties().LocationId);
+
+    nearest.first_core = uint32_t(topo.cores.size());
+    if (nearest.cpu != nullptr) {
+      // CPU agent cores are numbered like the OS numbers them, see CpuAgent::QueueCreate.
+      const HsaNodeProperties& cpu = static_cast<AMD::CpuAgent*>(nearest.cpu)->properties();
+      for (uint32_t c = 0; c < cpu.NumCPUCores; c++) topo.cores.push_back(cpu.CComputeIdLo + c);
+    }
+    nearest.num_cores = uint32_t(topo.cores.size()) - nearest.first_core;
+
+    nearest.first_nic = uint32_t(topo.nics.size());
+    for (const os::NetDevice& nic : nics) {
+      if (nearest.numa_node < 0 || nic.numa_node != nearest.numa_node) continue;
+      hsa_amd_topology_nic_t entry = {};
+      strncpy(entry.name, nic.name.c_str(), sizeof(entry.name) - 1);
+      entry.domain = nic.domain;
+      entry.bdfid = nic.bdfid;
+      topo.nics.push_back(entry);
+    }
+    nearest.num_nics = uint32_t(topo.nics.size()) - nearest.first_nic;
+    topo.nearest.push_back(nearest);
+  }
+}
+
+static_assert(Flag::kThreadClasses == HSA_AMD_THREAD_CLASS_COUNT, "Thread class mismatch");
+
+os::ThreadPolicy Runtime::ResolveThreadPolicy(uint32_t thread_class, const Agent* gpu) {
+  const Flag::ThreadPolicy& policy = thread_policy_[thread_class].set
+      ? thread_policy_[thread_class]
+      : flag().thread_policy(thread_class);
+
+  os::ThreadPolicy ret;
+  ret.sched = os::ThreadPolicy::Sched(policy.sched);
+  ret.priority = policy.priority;
+  switch (policy.affinity) {
+    case HSA_AMD_THREAD_AFFINITY_CPUS:
+      ret.cpus = policy.cpus;
+      break;
+    case HSA_AMD_THREAD_AFFINITY_ANY:
+      break;
+    case HSA_AMD_THREAD_AFFINITY_NUMA_LOCAL:
+      // Threads created before topology discovery find no GPUs and stay unrestricted.
+      for (const Topology::Nearest& nearest : topology_.nearest) {
+        if (gpu != nullptr && nearest.gpu != gpu) continue;
+        std::vector<uint32_t> cpus = os::GetNumaNodeCpus(nearest.numa_node);
+        if (cpus.empty()) {
+          const auto first = topology_.cores.begin() + nearest.first_core;
+          cpus.assign(first, first + nearest.num_cores);
+        }
+        ret.cpus.insert(ret.cpus.end(), cpus.begin(), cpus.end());
+      }
+      std::sort(ret.cpus.begin(), ret.cpus.end());
+      ret.cpus.erase(std::unique(ret.cpus.begin(), ret.cpus.end()), ret.cpus.end());
+      break;
+  }
+  return ret;
+}
+
+os::Thread Runtime::CreateThread(hsa_amd_thread_class_t thread_class, os::ThreadEntry entry,
+                                 void* arg, const Agent* gpu) {
+  ScopedAcquire<KernelMutex> lock(&thread_policy_lock_);
+  const os::ThreadPolicy policy = ResolveThreadPolicy(thread_class, gpu);
+  return os::CreateThread(entry, arg, 0, thread_class, gpu, &policy);
+}
+
+hsa_status_t Runtime::SetThreadPolicy(hsa_amd_thread_class_t thread_class,
+                                      const hsa_amd_thread_policy_t* policy) {
+  if (uint32_t(thread_class) >= HSA_AMD_THREAD_CLASS_COUNT)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  Flag::ThreadPolicy entry;
+  entry.set = true;
+  if (policy != nullptr) {
+    if (uint32_t(policy->affinity) > HSA_AMD_THREAD_AFFINITY_CPUS ||
+        uint32_t(policy->sched) > HSA_AMD_THREAD_SCHED_RR)
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    if (policy->affinity == HSA_AMD_THREAD_AFFINITY_CPUS) {
+      if (policy->num_cpus == 0 || policy->cpus == nullptr)
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+      entry.cpus.assign(policy->cpus, policy->cpus + policy->num_cpus);
+    }
+    entry.affinity = policy->affinity;
+    entry.sched = policy->sched;
+    entry.priority = policy->priority;
+  }
+
+  ScopedAcquire<KernelMutex> lock(&thread_policy_lock_);
+  thread_policy_[thread_class] = std::move(entry);
+  os::SetThreadPolicy(thread_class, [&](const void* gpu) {
+    return ResolveThreadPolicy(thread_class, static_cast<const Agent*>(gpu));
+  });
+  return HSA_STATUS_SUCCESS;
+}
+
 hsa_status_t Runtime::IterateAgent(hsa_status_t (*callback)(hsa_agent_t agent,
                                                             void* data),
                                    void* data) {
@@ -343,12 +554,21 @@ hsa_status_t Runtime::IterateAgent(hsa_status_t (*callback)(hsa_agent_t agent,
 hsa_status_t Runtime::AllocateMemory(const MemoryRegion* region, size_t size,
                                      MemoryRegion::AllocateFlags alloc_flags,
                                      void** address, int agent_node_id) {
+  Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_ALLOCATION_BYTES, size);
   size_t size_requested = size;  // region->Allocate(...) may align-up size to granularity
   hsa_status_t status = region->Allocate(size, alloc_flags, address, agent_node_id);
+  if (status == HSA_STATUS_ERROR_OUT_OF_RESOURCES) {
+    RelieveMemoryPressure(region->owner(), size_requested, HSA_AMD_MEMORY_PRESSURE_CRITICAL);
+    size = size_requested;
+    status = region->Allocate(size, alloc_flags, address, agent_node_id);
+  }
   // Track the allocation result so that it could be freed properly.
   if (status == HSA_STATUS_SUCCESS) {
-    ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-    allocation_map_[*address] = AllocationRegion(region, size, size_requested, alloc_flags);
+    AllocationRegion entry(region, size, size_requested, alloc_flags);
+    entry.usage = MemoryUsageScope::current();
+    region->AddUsage(entry.usage, size, 1);
+    TrackHostMapping(entry);
+    allocation_map_.Insert(*address, size, std::move(entry));
   }
 
   return status;
@@ -363,140 +583,671 @@ hsa_status_t Runtime::FreeMemory(void* ptr) {
   size_t size = 0;
   std::unique_ptr<std::vector<AllocationRegion::notifier_t>> notifiers;
   MemoryRegion::AllocateFlags alloc_flags = core::MemoryRegion::AllocateNoFlags;
+  void* batch_base = nullptr;
 
   {
-    ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-
-    std::map<const void*, AllocationRegion>::iterator it = allocation_map_.find(ptr);
-
-    if (it == allocation_map_.end()) {
+    AllocationRegion entry;
+    bool found = false;
+    bool parked = false;
+    // Imported fragments can't be released with FreeMemory.
+    bool erased = allocation_map_.EraseIf(ptr,
+                                          [&](const AllocationRegion& candidate) {
+                                            found = true;
+                                            parked = candidate.parked;
+                                            return (candidate.region != nullptr) && !parked;
+                                          },
+                                          &entry);
+
+    if (!found || parked) {
       debug_warning(false && "Can't find address in allocation map");
       return HSA_STATUS_ERROR_INVALID_ALLOCATION;
     }
-    region = it->second.region;
-    size = it->second.size;
-    alloc_flags = it->second.alloc_flags;
 
-    // Imported fragments can't be released with FreeMemory.
-    if (region == nullptr) {
+    if (!erased) {
       assert(false && "Can't release imported memory with free.");
       return HSA_STATUS_ERROR_INVALID_ARGUMENT;
     }
 
-    notifiers = std::move(it->second.notifiers);
+    region = entry.region;
+    size = entry.size;
+    alloc_flags = entry.alloc_flags;
+    notifiers = std::move(entry.notifiers);
+    batch_base = entry.batch_base;
+    region->AddUsage(entry.usage, -static_cast<int64_t>(size), -1);
+    if (entry.host_writable && !entry.device_only)
+      static_cast<AMD::GpuAgent*>(region->owner())->HostWritableLocalMemory(-1);
+  }
 
-    allocation_map_.erase(it);
+  // Descriptors already handed out keep the memory alive on their own.
+  DmaBufExportRelease(ptr);
+
+  // Buffers carved from a shared block release the block with the last of them.
+  if (batch_base != nullptr) {
+    ScopedAcquire<KernelMutex> lock(&batch_lock_);
+    auto it = batch_blocks_.find(batch_base);
+    assert(it != batch_blocks_.end() && "Batch block missing.");
+    if (--it->second.refs != 0) {
+      lock.Release();
+      NotifyRelease(std::move(notifiers));
+      return HSA_STATUS_SUCCESS;
+    }
+    ptr = batch_base;
+    size = it->second.size;
+    alloc_flags = it->second.alloc_flags;
+    batch_blocks_.erase(it);
+  }
+
+  // Callbacks delivered in the background don't hold up the free.
+  if (notifiers && flag().deferred_free_notify()) NotifyRelease(std::move(notifiers));
+
+  ReleasedAllocation released = {ptr, region, size, alloc_flags, std::move(notifiers)};
+
+  if (flag().deferred_free()) {
+    ScopedAcquire<KernelMutex> lock(&deferred_free_lock_);
+    if (deferred_free_thread_ != NULL) {
+      deferred_frees_.push_back(std::move(released));
+      os::SetOsEvent(deferred_free_event_);
+      return HSA_STATUS_SUCCESS;
+    }
   }
 
+  std::vector<ReleasedAllocation> batch;
+  batch.push_back(std::move(released));
+  return ReleaseAllocations(batch);
+}
+
+void Runtime::NotifyRelease(std::unique_ptr<std::vector<AllocationRegion::notifier_t>> notifiers) {
+  if (!notifiers) return;
+
+  if (flag().deferred_free_notify()) {
+    ScopedAcquire<KernelMutex> lock(&deferred_free_lock_);
+    if (deferred_free_thread_ != NULL) {
+      deferred_notifiers_.push_back(std::move(notifiers));
+      os::SetOsEvent(deferred_free_event_);
+      return;
+    }
+  }
+
+  for (auto& notifier : *notifiers) notifier.callback(notifier.ptr, notifier.user_data);
+}
+
+hsa_status_t Runtime::ReleaseAllocations(std::vector<ReleasedAllocation>& batch) {
   // Notifiers can't run while holding the lock or the callback won't be able to manage memory.
   // The memory triggering the notification has already been removed from the memory map so can't
   // be double released during the callback.
-  if (notifiers) {
-    for (auto& notifier : *notifiers) {
-      notifier.callback(notifier.ptr, notifier.user_data);
+  for (auto& released : batch) {
+    if (released.notifiers) {
+      for (auto& notifier : *released.notifiers) {
+        notifier.callback(notifier.ptr, notifier.user_data);
+      }
     }
+
+    if (released.alloc_flags & core::MemoryRegion::AllocateAsan)
+      assert(hsaKmtReturnAsanHeaderPage(released.ptr) == HSAKMT_STATUS_SUCCESS);
   }
 
-  if (alloc_flags & core::MemoryRegion::AllocateAsan)
-    assert(hsaKmtReturnAsanHeaderPage(ptr) == HSAKMT_STATUS_SUCCESS);
+  // Each region's blocks are released under one acquisition of its owner's memory lock.
+  std::stable_sort(batch.begin(), batch.end(),
+                   [](const ReleasedAllocation& lhs, const ReleasedAllocation& rhs) {
+                     return lhs.region < rhs.region;
+                   });
+
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  std::vector<std::pair<void*, size_t>> blocks;
+  std::vector<void*> failed;
+  for (size_t first = 0; first < batch.size();) {
+    const MemoryRegion* region = batch[first].region;
+    blocks.clear();
+    size_t last = first;
+    for (; (last < batch.size()) && (batch[last].region == region); last++)
+      blocks.push_back(std::make_pair(batch[last].ptr, batch[last].size));
+    first = last;
+
+    failed.clear();
+    region->FreeBatch(blocks, failed);
+    for (void* ptr : failed) {
+      FreeFailed(region, ptr);
+      status = HSA_STATUS_ERROR;
+    }
+  }
+  return status;
+}
 
-  const hsa_status_t err = region->Free(ptr, size);
-  if (err != HSA_STATUS_SUCCESS) {
-    // hsaKmtFreeMemory failed to free this pointer. Throw a memory error event
-
-    // Note: This should be treated as a fatal exception by the System Event Handler because:
-    //  - This leaves allocation_map_ in an inconsistent state as this pointer entry has already
-    //  been removed.
-    //  - We already called back the notifier, but did not actually free.
-    //  - We removed the ASAN Header but did not actually free.
-    //
-    // But this is a very unlikely use case and calling region->Free(..) before updating
-    // allocation_map_ would require us to hold the memory_lock_ for much longer and we would not be
-    // able to call hsaKmtReturnAsanHeaderPage after calling region->Free(..)
-
-    const core::Agent* agentOwner = region->owner();
-    hsa_status_t custom_handler_status = HSA_STATUS_ERROR;
-    auto system_event_handlers = runtime_singleton_->GetSystemEventHandlers();
-
-    if (!system_event_handlers.empty()) {
-      hsa_amd_event_t memory_error_event;
-      memory_error_event.event_type = HSA_AMD_GPU_MEMORY_ERROR_EVENT;
-      hsa_amd_gpu_memory_error_info_t& error_info = memory_error_event.memory_error;
-
-      error_info.virtual_address = reinterpret_cast<const uint64_t>(ptr);
-      error_info.error_reason_mask = HSA_AMD_MEMORY_ERROR_MEMORY_IN_USE;
-      error_info.agent = Agent::Convert(agentOwner);
-
-      for (auto& callback : system_event_handlers) {
-        hsa_status_t err = callback.first(&memory_error_event, callback.second);
-        if (err == HSA_STATUS_SUCCESS) custom_handler_status = HSA_STATUS_SUCCESS;
-      }
-    }
-    // No custom VM fault handler registered or it failed.
-    if (custom_handler_status != HSA_STATUS_SUCCESS) {
-      fprintf(stderr,
-              "Memory critical error by agent node-%u (Agent handle: %p) on address %p. Reason: "
-              "Memory in use. \n",
-              agentOwner->node_id(), reinterpret_cast<void*>(agentOwner->public_handle().handle),
-              ptr);
-
-      assert(false && "GPU memory error.");
-      std::abort();
+void Runtime::FreeFailed(const MemoryRegion* region, void* ptr) {
+  // hsaKmtFreeMemory failed to free this pointer. Throw a memory error event
+
+  // Note: This should be treated as a fatal exception by the System Event Handler because:
+  //  - This leaves allocation_map_ in an inconsistent state as this pointer entry has already
+  //  been removed.
+  //  - We already called back the notifier, but did not actually free.
+  //  - We removed the ASAN Header but did not actually free.
+  //
+  // But this is a very unlikely use case and calling region->Free(..) before updating
+  // allocation_map_ would require us to hold the memory_lock_ for much longer and we would not be
+  // able to call hsaKmtReturnAsanHeaderPage after calling region->Free(..)
+
+  const core::Agent* agentOwner = region->owner();
+  hsa_status_t custom_handler_status = HSA_STATUS_ERROR;
+  auto system_event_handlers = runtime_singleton_->GetSystemEventHandlers();
+
+  if (!system_event_handlers.empty()) {
+    hsa_amd_event_t memory_error_event;
+    memory_error_event.event_type = HSA_AMD_GPU_MEMORY_ERROR_EVENT;
+    hsa_amd_gpu_memory_error_info_t& error_info = memory_error_event.memory_error;
+
+    error_info.virtual_address = reinterpret_cast<const uint64_t>(ptr);
+    error_info.error_reason_mask = HSA_AMD_MEMORY_ERROR_MEMORY_IN_USE;
+    error_info.agent = Agent::Convert(agentOwner);
+
+    for (auto& callback : system_event_handlers) {
+      hsa_status_t err = callback.first(&memory_error_event, callback.second);
+      if (err == HSA_STATUS_SUCCESS) custom_handler_status = HSA_STATUS_SUCCESS;
     }
-    return HSA_STATUS_ERROR;
   }
+  // No custom VM fault handler registered or it failed.
+  if (custom_handler_status != HSA_STATUS_SUCCESS) {
+    fprintf(stderr,
+            "Memory critical error by agent node-%u (Agent handle: %p) on address %p. Reason: "
+            "Memory in use. \n",
+            agentOwner->node_id(), reinterpret_cast<void*>(agentOwner->public_handle().handle),
+            ptr);
 
+    assert(false && "GPU memory error.");
+    std::abort();
+  }
+}
+
+void Runtime::StartDeferredFree() {
+  if (!flag().deferred_free() && !flag().deferred_free_notify()) return;
+
+  deferred_free_event_ = os::CreateOsEvent(true, false);
+  if (deferred_free_event_ == NULL) return;
+
+  deferred_free_exit_ = false;
+  os::Thread thread = CreateThread(HSA_AMD_THREAD_CLASS_BACKGROUND, DeferredFreeRun, this);
+  if (thread == NULL) {
+    debug_warning("Failed to start deferred free thread.");
+    os::DestroyOsEvent(deferred_free_event_);
+    deferred_free_event_ = NULL;
+    return;
+  }
+
+  ScopedAcquire<KernelMutex> lock(&deferred_free_lock_);
+  deferred_free_thread_ = thread;
+}
+
+void Runtime::StopDeferredFree() {
+  os::Thread thread;
+  {
+    // Later frees complete on the calling thread.
+    ScopedAcquire<KernelMutex> lock(&deferred_free_lock_);
+    thread = deferred_free_thread_;
+    deferred_free_thread_ = NULL;
+  }
+  if (thread == NULL) return;
+
+  deferred_free_exit_ = true;
+  os::SetOsEvent(deferred_free_event_);
+  os::WaitForThread(thread);
+  os::CloseThread(thread);
+  os::DestroyOsEvent(deferred_free_event_);
+  deferred_free_event_ = NULL;
+
+  // Callbacks and frees queued while the reclaimer was finishing its last batch.
+  for (auto& notifiers : deferred_notifiers_)
+    for (auto& notifier : *notifiers) notifier.callback(notifier.ptr, notifier.user_data);
+  deferred_notifiers_.clear();
+  if (!deferred_frees_.empty()) ReleaseAllocations(deferred_frees_);
+  deferred_frees_.clear();
+}
+
+void Runtime::ReleaseCachedMemory() {
+  StopDeferredFree();
+
+  // The process is about to exit and the driver reclaims everything at once.
+  if (flag().fast_shutdown()) return;
+
+  VMemoryHandleCacheTrim(nullptr);
+
+  {
+    ScopedAcquire<KernelMutex> lock(&staging_lock_);
+    for (auto& chunk : staging_pool_) {
+      system_deallocator_(chunk.ptr);
+      chunk.done->DestroySignal();
+      chunk.hop->DestroySignal();
+    }
+    staging_pool_.clear();
+  }
+
+  // Work ordered before outstanding async frees must have completed by shutdown.
+  {
+    ScopedAcquire<KernelMutex> lock(&async_free_cache_lock_);
+    for (auto& block : async_free_cache_) {
+      if (block.second.release != nullptr) block.second.release->Release();
+      block.second.release = nullptr;
+    }
+  }
+  AsyncFreeCacheTrim(0);
+}
+
+void Runtime::ReleaseCachedMemoryRun(void* runtime) {
+  reinterpret_cast<Runtime*>(runtime)->ReleaseCachedMemory();
+}
+
+void Runtime::DeleteAgents(std::vector<Agent*>& agents) {
+  // Agent teardown is dominated by driver calls that do not contend across devices.
+  std::vector<os::Thread> threads;
+  for (Agent*& agent : agents) {
+    os::Thread thread = (agents.size() > 1)
+        ? CreateThread(HSA_AMD_THREAD_CLASS_BACKGROUND,
+                       [](void* agent) { delete reinterpret_cast<Agent*>(agent); }, agent)
+        : NULL;
+    if (thread == NULL) {
+      delete agent;
+    } else {
+      threads.push_back(thread);
+    }
+    agent = nullptr;
+  }
+  for (os::Thread thread : threads) {
+    os::WaitForThread(thread);
+    os::CloseThread(thread);
+  }
+  agents.clear();
+}
+
+void Runtime::DeferredFreeRun(void* runtime) {
+  reinterpret_cast<Runtime*>(runtime)->DeferredFreeLoop();
+}
+
+void Runtime::DeferredFreeLoop() {
+  std::vector<ReleasedAllocation> batch;
+  std::vector<std::unique_ptr<std::vector<AllocationRegion::notifier_t>>> notify;
+  while (true) {
+    os::WaitForOsEvent(deferred_free_event_, 0xFFFFFFFF);
+
+    // Everything queued since the last wake is notified and released as one batch.
+    {
+      ScopedAcquire<KernelMutex> lock(&deferred_free_lock_);
+      batch.swap(deferred_frees_);
+      notify.swap(deferred_notifiers_);
+    }
+    for (auto& notifiers : notify)
+      for (auto& notifier : *notifiers) notifier.callback(notifier.ptr, notifier.user_data);
+    notify.clear();
+    if (!batch.empty()) ReleaseAllocations(batch);
+    batch.clear();
+
+    if (deferred_free_exit_) return;
+  }
+}
+
+hsa_status_t Runtime::AllocateMemoryAsync(const MemoryRegion* region, size_t size,
+                                          MemoryRegion::AllocateFlags alloc_flags,
+                                          Signal* dependency, void** address) {
+  void* ptr = nullptr;
+  {
+    ScopedAcquire<KernelMutex> lock(&async_free_cache_lock_);
+    // Smallest fitting block whose release retired or is ordered before the caller's use.  Blocks
+    // over twice the request are left for larger allocations.
+    auto it = async_free_cache_.lower_bound(AsyncFreeKey(region, alloc_flags, size));
+    while ((it != async_free_cache_.end()) && (std::get<0>(it->first) == region) &&
+           (std::get<1>(it->first) == alloc_flags) && (std::get<2>(it->first) <= 2 * size)) {
+      Signal* release = it->second.release;
+      if ((release == nullptr) || (release == dependency) || (release->LoadAcquire() == 0)) {
+        ptr = it->second.ptr;
+        if (release != nullptr) release->Release();
+        async_free_cache_bytes_ -= std::get<2>(it->first);
+        async_free_cache_.erase(it);
+        break;
+      }
+      ++it;
+    }
+  }
+
+  if (ptr != nullptr) {
+    Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_ALLOCATION_BYTES, size);
+    allocation_map_.Find(ptr, [&](AllocationRegion& entry) {
+      entry.parked = false;
+      entry.size_requested = size;
+    });
+    *address = ptr;
+    return HSA_STATUS_SUCCESS;
+  }
+
+  // Retired blocks of other sizes or pools are released by AllocateMemory if it runs out.
+  return AllocateMemory(region, size, alloc_flags, address);
+}
+
+hsa_status_t Runtime::AllocateMemoryBatch(const MemoryRegion* region, size_t count,
+                                          const size_t* sizes,
+                                          MemoryRegion::AllocateFlags alloc_flags,
+                                          bool shared_block, uint32_t num_agents,
+                                          const hsa_agent_t* agents, void** ptrs) {
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+
+  if (!shared_block) {
+    size_t allocated = 0;
+    for (; allocated < count; allocated++) {
+      status = AllocateMemory(region, sizes[allocated], alloc_flags, &ptrs[allocated]);
+      if (status != HSA_STATUS_SUCCESS) break;
+    }
+    if ((status == HSA_STATUS_SUCCESS) && (num_agents != 0))
+      status = AllowAccess(num_agents, agents, static_cast<uint32_t>(count), ptrs);
+    if (status != HSA_STATUS_SUCCESS) {
+      for (size_t i = 0; i < allocated; i++) FreeMemory(ptrs[i]);
+    }
+    return status;
+  }
+
+  // Keep every buffer at the alignment individual allocations get.
+  size_t align = 0;
+  status = region->GetInfo(HSA_REGION_INFO_RUNTIME_ALLOC_ALIGNMENT, &align);
+  if ((status != HSA_STATUS_SUCCESS) || (align == 0))
+    return static_cast<hsa_status_t>(HSA_STATUS_ERROR_INVALID_MEMORY_POOL);
+
+  std::vector<size_t> offsets(count);
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_ALLOCATION_BYTES, sizes[i]);
+    offsets[i] = total;
+    total += AlignUp(sizes[i], align);
+  }
+
+  void* base = nullptr;
+  size_t size = total;
+  status = region->Allocate(size, alloc_flags, &base, 0);
+  if (status == HSA_STATUS_ERROR_OUT_OF_RESOURCES) {
+    RelieveMemoryPressure(region->owner(), total, HSA_AMD_MEMORY_PRESSURE_CRITICAL);
+    size = total;
+    status = region->Allocate(size, alloc_flags, &base, 0);
+  }
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  {
+    ScopedAcquire<KernelMutex> lock(&batch_lock_);
+    BatchBlock block = {size, alloc_flags, count};
+    batch_blocks_[base] = block;
+  }
+
+  const hsa_amd_memory_usage_category_t usage = MemoryUsageScope::current();
+  for (size_t i = 0; i < count; i++) {
+    ptrs[i] = reinterpret_cast<uint8_t*>(base) + offsets[i];
+    // The last buffer accounts for any rounding of the block by the region.
+    const size_t buffer_size = ((i + 1 < count) ? offsets[i + 1] : size) - offsets[i];
+    AllocationRegion entry(region, buffer_size, sizes[i], alloc_flags);
+    entry.usage = usage;
+    entry.batch_base = base;
+    region->AddUsage(usage, buffer_size, 1);
+    TrackHostMapping(entry);
+    allocation_map_.Insert(ptrs[i], buffer_size, std::move(entry));
+  }
+
+  // One grant covers every buffer.
+  if (num_agents != 0) {
+    {
+      ScopedAcquire<KernelSharedMutex> lock(&peer_access_lock_);
+      status = reinterpret_cast<const AMD::MemoryRegion*>(region)->AllowAccess(num_agents, agents,
+                                                                              base, size);
+    }
+    if (status != HSA_STATUS_SUCCESS) {
+      for (size_t i = 0; i < count; i++) FreeMemory(ptrs[i]);
+    } else if (reinterpret_cast<const AMD::MemoryRegion*>(region)->IsLocalMemory()) {
+      for (size_t i = 0; i < count; i++) TrackHostAccess(num_agents, agents, ptrs[i]);
+    }
+  }
+  return status;
+}
+
+hsa_status_t Runtime::FreeMemoryAsync(void* ptr, Signal* release) {
+  if (ptr == nullptr) {
+    return HSA_STATUS_SUCCESS;
+  }
+
+  const MemoryRegion* region = nullptr;
+  size_t size = 0;
+  MemoryRegion::AllocateFlags alloc_flags = core::MemoryRegion::AllocateNoFlags;
+  std::unique_ptr<std::vector<AllocationRegion::notifier_t>> notifiers;
+
+  // The entry stays in allocation_map_ while parked so pointer queries and the eventual free
+  // still find it.  Imported fragments and blocks already parked can't be released.
+  bool found = allocation_map_.Find(ptr, [&](AllocationRegion& entry) {
+    if ((entry.region == nullptr) || entry.parked) return;
+    entry.parked = true;
+    region = entry.region;
+    size = entry.size;
+    alloc_flags = entry.alloc_flags;
+    notifiers = std::move(entry.notifiers);
+  });
+
+  if (!found || (region == nullptr)) {
+    debug_warning(false && "Can't find address in allocation map");
+    return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+  }
+
+  DmaBufExportRelease(ptr);
+
+  // The allocation is dead to the caller even though the block lives on in the cache, so notify
+  // now.  A reused block starts with no notifiers.
+  NotifyRelease(std::move(notifiers));
+
+  if (release != nullptr) release->Retain();
+  {
+    ScopedAcquire<KernelMutex> lock(&async_free_cache_lock_);
+    async_free_cache_.emplace(AsyncFreeKey(region, alloc_flags, size),
+                              AsyncFreeBlock{ptr, release});
+    async_free_cache_bytes_ += size;
+  }
+
+  AsyncFreeCacheTrim(flag().async_free_cache_size());
   return HSA_STATUS_SUCCESS;
 }
 
-hsa_status_t Runtime::RegisterReleaseNotifier(void* ptr, hsa_amd_deallocation_callback_t callback,
-                                              void* user_data) {
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-  auto mem = allocation_map_.upper_bound(ptr);
-  if (mem != allocation_map_.begin()) {
-    mem--;
-
-    // No support for imported fragments yet.
-    if (mem->second.region == nullptr) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
-
-    if ((mem->first <= ptr) &&
-        (ptr < reinterpret_cast<const uint8_t*>(mem->first) + mem->second.size)) {
-      auto& notifiers = mem->second.notifiers;
-      if (!notifiers) notifiers.reset(new std::vector<AllocationRegion::notifier_t>);
-      AllocationRegion::notifier_t notifier = {
-          ptr, AMD::callback_t<hsa_amd_deallocation_callback_t>(callback), user_data};
-      notifiers->push_back(notifier);
+void Runtime::AsyncFreeCacheTrim(size_t limit) {
+  std::vector<void*> retired;
+  {
+    ScopedAcquire<KernelMutex> lock(&async_free_cache_lock_);
+    for (auto it = async_free_cache_.begin();
+         (it != async_free_cache_.end()) && (async_free_cache_bytes_ > limit);) {
+      Signal* release = it->second.release;
+      if ((release != nullptr) && (release->LoadAcquire() != 0)) {
+        ++it;
+        continue;
+      }
+      if (release != nullptr) release->Release();
+      retired.push_back(it->second.ptr);
+      async_free_cache_bytes_ -= std::get<2>(it->first);
+      it = async_free_cache_.erase(it);
+    }
+  }
+
+  // Notifiers already ran when the blocks were parked.
+  for (void* ptr : retired) {
+    allocation_map_.Find(ptr, [](AllocationRegion& entry) { entry.parked = false; });
+    FreeMemory(ptr);
+  }
+}
+
+hsa_status_t Runtime::RegisterMemoryPressureCallback(hsa_amd_memory_pressure_callback_t callback,
+                                                     void* data) {
+  ScopedAcquire<KernelMutex> lock(&memory_pressure_lock_);
+  memory_pressure_callbacks_.push_back(
+      std::make_pair(AMD::callback_t<hsa_amd_memory_pressure_callback_t>(callback), data));
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t Runtime::DeregisterMemoryPressureCallback(
+    hsa_amd_memory_pressure_callback_t callback, void* data) {
+  ScopedAcquire<KernelMutex> lock(&memory_pressure_lock_);
+  for (auto it = memory_pressure_callbacks_.begin(); it != memory_pressure_callbacks_.end(); it++) {
+    if ((it->first == callback) && (it->second == data)) {
+      memory_pressure_callbacks_.erase(it);
       return HSA_STATUS_SUCCESS;
     }
   }
-  return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+  return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+}
+
+void Runtime::RelieveMemoryPressure(Agent* agent, size_t size,
+                                    hsa_amd_memory_pressure_level_t level) {
+  // Allocations made while relieving, including from callbacks, fail normally.
+  static thread_local bool relieving = false;
+  if (relieving) return;
+  relieving = true;
+  MAKE_SCOPE_GUARD([&]() { relieving = false; });
+
+  // Free memory is only known for GPU nodes, system memory goes through every stage.
+  const bool gpu = (agent->device_type() == Agent::DeviceType::kAmdGpuDevice);
+  auto relieved = [&]() {
+    HSAuint64 available = 0;
+    return gpu && (hsaKmtAvailableMemory(agent->node_id(), &available) == HSAKMT_STATUS_SUCCESS) &&
+        (available >= size);
+  };
+
+  // Frees still queued for the deferred free thread cost nothing to complete here.
+  std::vector<ReleasedAllocation> pending;
+  {
+    ScopedAcquire<KernelMutex> lock(&deferred_free_lock_);
+    pending.swap(deferred_frees_);
+  }
+  if (!pending.empty()) {
+    ReleaseAllocations(pending);
+    if (relieved()) return;
+  }
+
+  // Fragment blocks, cached memory handles and idle scratch.
+  agent->TrimCaches();
+  if (relieved()) return;
+
+  if (gpu) {
+    static_cast<AMD::GpuAgent*>(agent)->TrimQueuePool();
+    if (relieved()) return;
+  }
+
+  std::vector<StagingChunk> chunks;
+  {
+    ScopedAcquire<KernelMutex> lock(&staging_lock_);
+    chunks.swap(staging_pool_);
+  }
+  for (auto& chunk : chunks) {
+    system_deallocator_(chunk.ptr);
+    chunk.done->DestroySignal();
+    chunk.hop->DestroySignal();
+  }
+  AsyncFreeCacheTrim(0);
+  if (relieved()) return;
+
+  std::vector<std::pair<AMD::callback_t<hsa_amd_memory_pressure_callback_t>, void*>> callbacks;
+  {
+    ScopedAcquire<KernelMutex> lock(&memory_pressure_lock_);
+    callbacks = memory_pressure_callbacks_;
+  }
+  for (auto& callback : callbacks) {
+    callback.first(Agent::Convert(agent), level, size, callback.second);
+  }
+}
+
+void Runtime::StartMemoryPressureMonitor() {
+  if (((flag().memory_pressure_watermark() == 0) && (flag().fragment_cache_idle_ms() == 0)) ||
+      gpu_agents_.empty())
+    return;
+
+  memory_pressure_event_ = os::CreateOsEvent(true, false);
+  if (memory_pressure_event_ == NULL) return;
+
+  memory_pressure_exit_ = false;
+  memory_pressure_thread_ =
+      CreateThread(HSA_AMD_THREAD_CLASS_BACKGROUND, MemoryPressureMonitorRun, this);
+  if (memory_pressure_thread_ == NULL) {
+    debug_warning("Failed to start memory pressure monitor thread.");
+    os::DestroyOsEvent(memory_pressure_event_);
+    memory_pressure_event_ = NULL;
+  }
+}
+
+void Runtime::StopMemoryPressureMonitor() {
+  if (memory_pressure_thread_ == NULL) return;
+
+  memory_pressure_exit_ = true;
+  os::SetOsEvent(memory_pressure_event_);
+  os::WaitForThread(memory_pressure_thread_);
+  os::CloseThread(memory_pressure_thread_);
+  os::DestroyOsEvent(memory_pressure_event_);
+  memory_pressure_thread_ = NULL;
+  memory_pressure_event_ = NULL;
+}
+
+void Runtime::MemoryPressureMonitorRun(void* runtime) {
+  reinterpret_cast<Runtime*>(runtime)->MemoryPressureMonitor();
+}
+
+void Runtime::MemoryPressureMonitor() {
+  const uint32_t tick_ms = 100;
+  const size_t watermark = flag().memory_pressure_watermark();
+  const uint64_t idle_ms = flag().fragment_cache_idle_ms();
+  std::vector<bool> low(gpu_agents_.size(), false);
+
+  while (true) {
+    os::WaitForOsEvent(memory_pressure_event_, tick_ms);
+    if (memory_pressure_exit_) return;
+
+    if (idle_ms != 0) {
+      for (auto agent : gpu_agents_) agent->TrimIdleCaches(idle_ms);
+    }
+    if (watermark == 0) continue;
+
+    for (size_t i = 0; i < gpu_agents_.size(); i++) {
+      HSAuint64 available = 0;
+      if (hsaKmtAvailableMemory(gpu_agents_[i]->node_id(), &available) != HSAKMT_STATUS_SUCCESS)
+        continue;
+
+      // Relieve once per crossing, trimming on every tick would defeat the caches.
+      const bool was_low = low[i];
+      low[i] = (available < watermark);
+      if (low[i] && !was_low)
+        RelieveMemoryPressure(gpu_agents_[i], watermark, HSA_AMD_MEMORY_PRESSURE_LOW);
+    }
+  }
+}
+
+hsa_status_t Runtime::RegisterReleaseNotifier(void* ptr, hsa_amd_deallocation_callback_t callback,
+                                              void* user_data) {
+  bool found = allocation_map_.FindContaining(
+      ptr, [&](const void* base, size_t size, AllocationRegion& mem) {
+        // No support for imported fragments yet.
+        if (mem.region == nullptr) return false;
+
+        auto& notifiers = mem.notifiers;
+        if (!notifiers) notifiers.reset(new std::vector<AllocationRegion::notifier_t>);
+        AllocationRegion::notifier_t notifier = {
+            ptr, AMD::callback_t<hsa_amd_deallocation_callback_t>(callback), user_data};
+        notifiers->push_back(notifier);
+        return true;
+      });
+  return found ? HSA_STATUS_SUCCESS : HSA_STATUS_ERROR_INVALID_ALLOCATION;
 }
 
 hsa_status_t Runtime::DeregisterReleaseNotifier(void* ptr,
                                                 hsa_amd_deallocation_callback_t callback) {
   hsa_status_t ret = HSA_STATUS_ERROR_INVALID_ARGUMENT;
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-  auto mem = allocation_map_.upper_bound(ptr);
-  if (mem != allocation_map_.begin()) {
-    mem--;
-    if ((mem->first <= ptr) &&
-        (ptr < reinterpret_cast<const uint8_t*>(mem->first) + mem->second.size)) {
-      auto& notifiers = mem->second.notifiers;
-      if (!notifiers) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
-      for (size_t i = 0; i < notifiers->size(); i++) {
-        if (((*notifiers)[i].ptr == ptr) && ((*notifiers)[i].callback) == callback) {
-          (*notifiers)[i] = std::move((*notifiers)[notifiers->size() - 1]);
-          notifiers->pop_back();
-          i--;
-          ret = HSA_STATUS_SUCCESS;
-        }
+  allocation_map_.FindContaining(ptr, [&](const void* base, size_t size, AllocationRegion& mem) {
+    auto& notifiers = mem.notifiers;
+    if (!notifiers) return true;
+    for (size_t i = 0; i < notifiers->size(); i++) {
+      if (((*notifiers)[i].ptr == ptr) && ((*notifiers)[i].callback) == callback) {
+        (*notifiers)[i] = std::move((*notifiers)[notifiers->size() - 1]);
+        notifiers->pop_back();
+        i--;
+        ret = HSA_STATUS_SUCCESS;
       }
     }
-  }
+    return true;
+  });
   return ret;
 }
 
 hsa_status_t Runtime::CopyMemory(void* dst, const void* src, size_t size) {
+  TimelineSpan span(Timeline::kCopy, size);
   void* source = const_cast<void*>(src);
 
   // Choose agents from pointer info
@@ -542,49 +1293,298 @@ hsa_status_t Runtime::CopyMemory(void* dst, const void* src, size_t size) {
   // Same GPU
   if (src_agent->node_id() == dst_agent->node_id()) return dst_agent->DmaCopy(dst, source, size);
 
+  // Pageable system memory is staged through pinned chunks rather than locked for the copy.
+  if (src_lock || dst_lock) return StagedCopy(dst, dst_agent, source, src_agent, size);
+
   // GPU-CPU
-  // Must ensure that system memory is visible to the GPU during the copy.
-  const AMD::MemoryRegion* system_region =
-      static_cast<const AMD::MemoryRegion*>(system_regions_fine_[0]);
-
-  void* gpuPtr = nullptr;
-  const auto& locked_copy = [&](void*& ptr, core::Agent* locking_agent) {
-    void* tmp;
-    hsa_agent_t agent = locking_agent->public_handle();
-    hsa_status_t err = system_region->Lock(1, &agent, ptr, size, &tmp);
-    if (err != HSA_STATUS_SUCCESS) throw AMD::hsa_exception(err, "Lock failed in hsa_memory_copy.");
-    gpuPtr = ptr;
-    ptr = tmp;
+  if (is_src_system) return dst_agent->DmaCopy(dst, source, size);
+  if (is_dst_system) return src_agent->DmaCopy(dst, source, size);
+
+  // GPU-GPU
+  hsa_status_t err = PeerCopy(dst, dst_agent, source, src_agent, size);
+  if (err != HSA_STATUS_ERROR_INVALID_AGENT) return err;
+
+  /*
+  Non-peer GPUs, or allocations not mapped to the peer, go through system memory.  We can't map
+  the peer ourselves since hsa_amd_agents_allow_access requires the caller to specify all allowed
+  agents.
+  */
+  return StagedCopy(dst, dst_agent, source, src_agent, size);
+}
+
+hsa_status_t Runtime::PeerCopy(void* dst, core::Agent* dst_agent, const void* src,
+                               core::Agent* src_agent, size_t size) {
+  if (GetLinkInfo(src_agent->node_id(), dst_agent->node_id()).num_hop != 1)
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  // Holding this shared keeps AllowAccess from revoking the peer mapping until the copy retires.
+  ScopedAcquire<KernelSharedMutex::Shared> lock(peer_access_lock_.shared());
+
+  // Only runtime allocations, whose mappings change through AllowAccess, qualify.
+  const auto& mapped_to = [&](const void* ptr, core::Agent* agent) {
+    bool owned = allocation_map_.FindContainingShared(
+        ptr, [&](const void* base, size_t len, const AllocationRegion& entry) {
+          return (entry.region != nullptr) &&
+              (uintptr_t(ptr) + size <= uintptr_t(base) + len);
+        });
+    if (!owned) return false;
+
+    hsa_amd_pointer_info_t info;
+    uint32_t count = 0;
+    hsa_agent_t* accessible = nullptr;
+    MAKE_SCOPE_GUARD([&]() { free(accessible); });
+    info.size = sizeof(info);
+    if (PtrInfo(ptr, &info, malloc, &count, &accessible) != HSA_STATUS_SUCCESS) return false;
+    for (uint32_t i = 0; i < count; i++)
+      if (accessible[i].handle == agent->public_handle().handle) return true;
+    return false;
   };
 
-  MAKE_SCOPE_GUARD([&]() {
-    if (gpuPtr != nullptr) system_region->Unlock(gpuPtr);
+  // Either side's engine can drive the copy provided it sees the other allocation.
+  core::Agent* copy_agent;
+  if (mapped_to(dst, src_agent))
+    copy_agent = src_agent;
+  else if (mapped_to(src, dst_agent))
+    copy_agent = dst_agent;
+  else
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  core::Signal* signal = new core::DefaultSignal(1);
+  MAKE_SCOPE_GUARD([&]() { signal->DestroySignal(); });
+  std::vector<core::Signal*> no_deps;
+  hsa_status_t err =
+      copy_agent->DmaCopy(dst, *dst_agent, src, *src_agent, size, no_deps, *signal);
+  if (err != HSA_STATUS_SUCCESS) return err;
+  signal->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, -1, HSA_WAIT_STATE_BLOCKED);
+  return HSA_STATUS_SUCCESS;
+}
+
+void Runtime::AcquireStagingChunks(uint32_t count, int node_id,
+                                   std::vector<StagingChunk>& chunks) {
+  {
+    ScopedAcquire<KernelMutex> lock(&staging_lock_);
+    while ((chunks.size() < count) && !staging_pool_.empty()) {
+      chunks.push_back(staging_pool_.back());
+      staging_pool_.pop_back();
+    }
+  }
+
+  MemoryUsageScope usage(HSA_AMD_MEMORY_USAGE_BLIT);
+  while (chunks.size() < count) {
+    StagingChunk chunk;
+    chunk.ptr = system_allocator_(flag().staging_chunk_size(), 0x1000,
+                                  core::MemoryRegion::AllocateNoFlags, node_id);
+    if (chunk.ptr == nullptr) return;
+    chunk.done = new core::DefaultSignal(0);
+    chunk.hop = new core::DefaultSignal(0);
+    chunks.push_back(chunk);
+  }
+}
+
+void Runtime::ReleaseStagingChunks(std::vector<StagingChunk>& chunks) {
+  {
+    // Room for a few concurrent copies, excess is freed.
+    ScopedAcquire<KernelMutex> lock(&staging_lock_);
+    const size_t limit = 4 * flag().staging_chunk_count();
+    while (!chunks.empty() && (staging_pool_.size() < limit)) {
+      staging_pool_.push_back(chunks.back());
+      chunks.pop_back();
+    }
+  }
+
+  for (auto& chunk : chunks) {
+    system_deallocator_(chunk.ptr);
+    chunk.done->DestroySignal();
+    chunk.hop->DestroySignal();
+  }
+  chunks.clear();
+}
+
+hsa_status_t Runtime::StagedCopy(void* dst, core::Agent* dst_agent, const void* src,
+                                 core::Agent* src_agent, size_t size) {
+  const bool src_gpu = (src_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
+  const bool dst_gpu = (dst_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
+  core::Agent* host = cpu_agents_[0];
+  const size_t chunk_size = flag().staging_chunk_size();
+  const size_t count = (size + chunk_size - 1) / chunk_size;
+
+  std::vector<StagingChunk> chunks;
+  AcquireStagingChunks(std::min<size_t>(flag().staging_chunk_count(), count),
+                       (src_gpu ? src_agent : dst_agent)->node_id(), chunks);
+  if (chunks.empty()) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  MAKE_SCOPE_GUARD([&]() { ReleaseStagingChunks(chunks); });
+
+  const auto& wait = [](core::Signal* signal) {
+    signal->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, -1, HSA_WAIT_STATE_BLOCKED);
+  };
+
+  // Drain every chunk before they return to the pool, also on failure.
+  MAKE_NAMED_SCOPE_GUARD(drain_all, [&]() {
+    for (auto& chunk : chunks) {
+      wait(chunk.hop);
+      wait(chunk.done);
+    }
   });
 
-  if (src_lock) locked_copy(source, dst_agent);
-  if (dst_lock) locked_copy(dst, src_agent);
-  if (is_src_system) return dst_agent->DmaCopy(dst, source, size);
-  if (is_dst_system) return src_agent->DmaCopy(dst, source, size);
+  std::vector<core::Signal*> no_deps;
+  const auto& dma = [&](core::Agent* copy_agent, void* to, core::Agent* to_agent,
+                        const void* from, core::Agent* from_agent, size_t len,
+                        std::vector<core::Signal*>& deps, core::Signal* signal) {
+    signal->StoreRelaxed(1);
+    hsa_status_t err = copy_agent->DmaCopy(to, *to_agent, from, *from_agent, len, deps, *signal);
+    if (err != HSA_STATUS_SUCCESS) signal->StoreRelaxed(0);
+    return err;
+  };
 
-  /*
-  GPU-GPU - functional support, not a performance path.
+  // Fills chunk from the source, by DMA for device memory.  Peer copies signal hop so the second
+  // leg can chain on it without a host round trip.
+  const auto& fill = [&](StagingChunk& chunk, size_t offset, size_t len) {
+    const void* from = reinterpret_cast<const uint8_t*>(src) + offset;
+    if (!src_gpu) {
+      memcpy(chunk.ptr, from, len);
+      return HSA_STATUS_SUCCESS;
+    }
+    return dma(src_agent, chunk.ptr, host, from, src_agent, len, no_deps,
+               dst_gpu ? chunk.hop : chunk.done);
+  };
 
-  This goes through system memory because we have to support copying between non-peer GPUs
-  and we can't use P2P pointers even if the GPUs are peers.  Because hsa_amd_agents_allow_access
-  requires the caller to specify all allowed agents we can't assume that a peer mapped pointer
-  would remain mapped for the duration of the copy.
-  */
-  void* temp = system_allocator_(size, 0, core::MemoryRegion::AllocateNoFlags, 0);
-  MAKE_SCOPE_GUARD([&]() { system_deallocator_(temp); });
-  hsa_status_t err = src_agent->DmaCopy(temp, source, size);
-  if (err == HSA_STATUS_SUCCESS) err = dst_agent->DmaCopy(dst, temp, size);
+  // Moves chunk to the destination, by DMA for device memory.
+  const auto& drain = [&](StagingChunk& chunk, size_t offset, size_t len) {
+    void* to = reinterpret_cast<uint8_t*>(dst) + offset;
+    if (!dst_gpu) {
+      memcpy(to, chunk.ptr, len);
+      return HSA_STATUS_SUCCESS;
+    }
+    std::vector<core::Signal*> deps;
+    if (src_gpu) deps.push_back(chunk.hop);
+    return dma(dst_agent, to, dst_agent, chunk.ptr, host, len, deps, chunk.done);
+  };
+
+  const auto& length = [&](size_t index) {
+    return std::min(chunk_size, size - index * chunk_size);
+  };
+
+  hsa_status_t err = HSA_STATUS_SUCCESS;
+  if (dst_gpu) {
+    // Host or peer to device: refill a chunk as soon as its previous DMA out retires.
+    for (size_t i = 0; (i < count) && (err == HSA_STATUS_SUCCESS); i++) {
+      StagingChunk& chunk = chunks[i % chunks.size()];
+      wait(chunk.done);
+      err = fill(chunk, i * chunk_size, length(i));
+      if (err == HSA_STATUS_SUCCESS) err = drain(chunk, i * chunk_size, length(i));
+    }
+    return err;
+  }
+
+  // Device to host: keep every chunk's DMA in flight while the CPU copies out the oldest.
+  for (size_t i = 0; (i < chunks.size()) && (err == HSA_STATUS_SUCCESS); i++)
+    err = fill(chunks[i], i * chunk_size, length(i));
+  for (size_t i = 0; (i < count) && (err == HSA_STATUS_SUCCESS); i++) {
+    StagingChunk& chunk = chunks[i % chunks.size()];
+    wait(chunk.done);
+    err = drain(chunk, i * chunk_size, length(i));
+    const size_t next = i + chunks.size();
+    if ((err == HSA_STATUS_SUCCESS) && (next < count))
+      err = fill(chunk, next * chunk_size, length(next));
+  }
   return err;
 }
 
+hsa_status_t Runtime::StreamChunkFill(StagingStream* stream, size_t index,
+                                      std::vector<core::Signal*>& dep_signals) {
+  StagingChunk& chunk = stream->chunks[index % stream->chunks.size()];
+  const size_t offset = index * stream->chunk_size;
+  const size_t len = std::min(stream->chunk_size, stream->size - offset);
+  chunk.done->StoreRelaxed(1);
+  hsa_status_t err = stream->src_agent->DmaCopy(chunk.ptr, *cpu_agents_[0], stream->src + offset,
+                                                *stream->src_agent, len, dep_signals, *chunk.done);
+  if (err != HSA_STATUS_SUCCESS) chunk.done->StoreRelaxed(0);
+  return err;
+}
+
+bool Runtime::StreamChunkHandler(hsa_signal_value_t value, void* arg) {
+  StagingStream* stream = reinterpret_cast<StagingStream*>(arg);
+  Runtime* runtime = runtime_singleton_;
+
+  // Hand the landed chunk over, then reuse it for the chunk chunks.size() ahead.
+  const size_t index = stream->next++;
+  StagingChunk& chunk = stream->chunks[index % stream->chunks.size()];
+  const size_t offset = index * stream->chunk_size;
+  hsa_status_t err = stream->callback(chunk.ptr, offset,
+                                      std::min(stream->chunk_size, stream->size - offset),
+                                      stream->user_data);
+
+  const size_t refill = index + stream->chunks.size();
+  if ((err == HSA_STATUS_SUCCESS) && (refill < stream->count)) {
+    std::vector<core::Signal*> no_deps;
+    err = runtime->StreamChunkFill(stream, refill, no_deps);
+  }
+
+  if ((err == HSA_STATUS_SUCCESS) && (stream->next < stream->count)) {
+    hsa_signal_t next = core::Signal::Convert(
+        stream->chunks[stream->next % stream->chunks.size()].done);
+    err = runtime->SetAsyncSignalHandler(next, HSA_SIGNAL_CONDITION_EQ, 0, StreamChunkHandler,
+                                         stream);
+    if (err == HSA_STATUS_SUCCESS) return false;
+  }
+
+  // Done or abandoned, chunks still in flight drain before returning to the pool.
+  for (auto& pending : stream->chunks)
+    pending.done->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, -1, HSA_WAIT_STATE_BLOCKED);
+  runtime->ReleaseStagingChunks(stream->chunks);
+  stream->completion_signal->SubRelease(1);
+  delete stream;
+  return false;
+}
+
+hsa_status_t Runtime::CopyMemoryStream(const void* src, core::Agent* src_agent, size_t size,
+                                       hsa_amd_copy_stream_callback_t callback, void* user_data,
+                                       std::vector<core::Signal*>& dep_signals,
+                                       core::Signal& completion_signal) {
+  if (src_agent->device_type() != core::Agent::DeviceType::kAmdGpuDevice)
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  std::unique_ptr<StagingStream> stream(new StagingStream());
+  stream->src = reinterpret_cast<const uint8_t*>(src);
+  stream->src_agent = src_agent;
+  stream->size = size;
+  stream->chunk_size = flag().staging_chunk_size();
+  stream->count = (size + stream->chunk_size - 1) / stream->chunk_size;
+  stream->callback = callback;
+  stream->user_data = user_data;
+  stream->next = 0;
+  stream->completion_signal = &completion_signal;
+
+  AcquireStagingChunks(std::min<size_t>(flag().staging_chunk_count(), stream->count),
+                       src_agent->node_id(), stream->chunks);
+  if (stream->chunks.empty()) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  // Every chunk's DMA is in flight while the callback consumes the oldest.  Only the first
+  // wave waits on the dependencies, refills are issued after it has landed.
+  hsa_status_t err = HSA_STATUS_SUCCESS;
+  for (size_t i = 0; (i < stream->chunks.size()) && (err == HSA_STATUS_SUCCESS); i++)
+    err = StreamChunkFill(stream.get(), i, dep_signals);
+
+  if (err == HSA_STATUS_SUCCESS)
+    err = SetAsyncSignalHandler(core::Signal::Convert(stream->chunks[0].done),
+                                HSA_SIGNAL_CONDITION_EQ, 0, StreamChunkHandler, stream.get());
+
+  if (err != HSA_STATUS_SUCCESS) {
+    for (auto& chunk : stream->chunks)
+      chunk.done->WaitRelaxed(HSA_SIGNAL_CONDITION_EQ, 0, -1, HSA_WAIT_STATE_BLOCKED);
+    ReleaseStagingChunks(stream->chunks);
+    return err;
+  }
+
+  stream.release();
+  return HSA_STATUS_SUCCESS;
+}
+
 hsa_status_t Runtime::CopyMemory(void* dst, core::Agent* dst_agent, const void* src,
                                  core::Agent* src_agent, size_t size,
                                  std::vector<core::Signal*>& dep_signals,
                                  core::Signal& completion_signal) {
+  TimelineSpan span(Timeline::kCopy, size);
   auto lookupAgent = [this](core::Agent* agent, const void* ptr) {
     hsa_amd_pointer_info_t info;
     PtrInfoBlockData block;
@@ -601,46 +1601,252 @@ hsa_status_t Runtime::CopyMemory(void* dst, core::Agent* dst_agent, const void*
   const bool src_gpu = (src_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
   core::Agent* copy_agent = (src_gpu) ? src_agent : dst_agent;
 
+  if ((size <= flag().host_copy_size()) && !copy_agent->profiling_enabled() &&
+      HostCopy(dst, src, size, dep_signals, completion_signal))
+    return HSA_STATUS_SUCCESS;
+
   // Lookup owning agent if blit kernel is selected or if flag override is set.
   if ((dst_agent == src_agent) || flag().discover_copy_agents()) {
     dst_agent = lookupAgent(dst_agent, dst);
     src_agent = lookupAgent(src_agent, src);
   }
-  return copy_agent->DmaCopy(dst, *dst_agent, src, *src_agent, size, dep_signals,
-                             completion_signal);
+  const uint64_t start = os::ReadAccurateClock();
+  hsa_status_t err = copy_agent->DmaCopy(dst, *dst_agent, src, *src_agent, size, dep_signals,
+                                         completion_signal);
+  Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_COPY_SUBMIT_NS,
+                  (os::ReadAccurateClock() - start) * 1000000000ull / os::AccurateClockFrequency());
+  return err;
+}
+
+bool Runtime::HostCopy(void* dst, const void* src, size_t size,
+                       std::vector<core::Signal*>& dep_signals, core::Signal& completion_signal) {
+  // Only when nothing is left to wait for, the CPU must not block on the caller's behalf.
+  for (auto dep : dep_signals)
+    if (dep->LoadAcquire() != 0) return false;
+
+  // Both sides must be runtime known memory the CPU reaches at the given address: system memory,
+  // or device memory behind a large BAR.
+  const auto& host_accessible = [&](const void* ptr) {
+    hsa_amd_pointer_info_t info;
+    info.size = sizeof(info);
+    if (PtrInfo(ptr, &info, nullptr, nullptr, nullptr) != HSA_STATUS_SUCCESS) return false;
+    if ((info.type == HSA_EXT_POINTER_TYPE_UNKNOWN) || (info.hostBaseAddress == nullptr))
+      return false;
+    return (info.hostBaseAddress <= ptr) &&
+        (uintptr_t(ptr) + size <= uintptr_t(info.hostBaseAddress) + info.sizeInBytes);
+  };
+  if (!host_accessible(dst) || !host_accessible(src)) return false;
+
+  memcpy(dst, src, size);
+  // Drain write combined stores to the BAR before signaling.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  completion_signal.SubRelease(1);
+  return true;
+}
+
+hsa_status_t Runtime::CopyMemoryBatch(const hsa_amd_memory_copy_descriptor_t* copies,
+                                      uint32_t count, core::Agent* dst_agent,
+                                      core::Agent* src_agent,
+                                      std::vector<core::Signal*>& dep_signals,
+                                      core::Signal& completion_signal) {
+  const bool src_gpu = (src_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
+  core::Agent* copy_agent = (src_gpu) ? src_agent : dst_agent;
+  return copy_agent->DmaCopyBatch(copies, count, *dst_agent, *src_agent, dep_signals,
+                                  completion_signal);
+}
+
+hsa_status_t Runtime::CopyMemoryStrided(const hsa_amd_memory_copy_strided_t* blocks,
+                                        uint32_t count, core::Agent* dst_agent,
+                                        core::Agent* src_agent,
+                                        std::vector<core::Signal*>& dep_signals,
+                                        core::Signal& completion_signal) {
+  const bool src_gpu = (src_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
+  core::Agent* copy_agent = (src_gpu) ? src_agent : dst_agent;
+  return copy_agent->DmaCopyStrided(blocks, count, *dst_agent, *src_agent, dep_signals,
+                                    completion_signal);
 }
 
 hsa_status_t Runtime::CopyMemoryOnEngine(void* dst, core::Agent* dst_agent, const void* src,
                                  core::Agent* src_agent, size_t size,
                                  std::vector<core::Signal*>& dep_signals,
                                  core::Signal& completion_signal,
-                                 hsa_amd_sdma_engine_id_t engine_id, bool force_copy_on_sdma) {
+                                 hsa_amd_sdma_engine_id_t engine_id, bool force_copy_on_sdma,
+                                 hsa_amd_queue_priority_t priority) {
   const bool src_gpu = (src_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
   core::Agent* copy_agent = (src_gpu) ? src_agent : dst_agent;
 
+  TimelineSpan span(Timeline::kCopy, size);
+
   // engine_id is single bitset unique.
   int engine_offset = ffs(engine_id);
   if (!engine_id || !!((engine_id >> engine_offset))) {
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
-  return copy_agent->DmaCopyOnEngine(dst, *dst_agent, src, *src_agent, size, dep_signals,
-                             completion_signal, engine_offset, force_copy_on_sdma);
+  const uint64_t start = os::ReadAccurateClock();
+  hsa_status_t err =
+      copy_agent->DmaCopyOnEngine(dst, *dst_agent, src, *src_agent, size, dep_signals,
+                                  completion_signal, engine_offset, force_copy_on_sdma, priority);
+  Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_COPY_SUBMIT_NS,
+                  (os::ReadAccurateClock() - start) * 1000000000ull / os::AccurateClockFrequency());
+  return err;
+}
+
+hsa_status_t Runtime::CopyMemoryGang(void* dst, core::Agent* dst_agent, const void* src,
+                                     core::Agent* src_agent, size_t size,
+                                     std::vector<core::Signal*>& dep_signals,
+                                     core::Signal& completion_signal,
+                                     const hsa_amd_gang_copy_policy_t& policy) {
+  const bool src_gpu = (src_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
+  core::Agent* copy_agent = (src_gpu) ? src_agent : dst_agent;
+
+  TimelineSpan span(Timeline::kCopy, size);
+
+  // leader_engine is single bitset unique when it picks the leader.
+  int leader_offset = ffs(policy.leader_engine);
+  if (policy.leader == HSA_AMD_GANG_LEADER_ENGINE &&
+      (!policy.leader_engine || !!((policy.leader_engine >> leader_offset)))) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  const uint64_t start = os::ReadAccurateClock();
+  hsa_status_t err = copy_agent->DmaCopyGang(dst, *dst_agent, src, *src_agent, size, dep_signals,
+                                             completion_signal, policy.width, policy.leader,
+                                             leader_offset);
+  Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_COPY_SUBMIT_NS,
+                  (os::ReadAccurateClock() - start) * 1000000000ull / os::AccurateClockFrequency());
+  return err;
+}
+
+hsa_status_t Runtime::CopyMemoryStatus(core::Agent* dst_agent, core::Agent* src_agent,
+                                       uint32_t *engine_ids_mask) {
+  const bool src_gpu = (src_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
+  core::Agent* copy_agent = (src_gpu) ? src_agent : dst_agent;
+
+  if (dst_agent == src_agent) {
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+
+  return copy_agent->DmaCopyStatus(*dst_agent, *src_agent, engine_ids_mask);
+}
+
+hsa_status_t Runtime::CopyEngineHints(core::Agent* dst_agent, core::Agent* src_agent,
+                                      hsa_amd_copy_engine_hints_t* hints) {
+  const bool src_gpu = (src_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
+  const bool dst_gpu = (dst_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
+  core::Agent* copy_agent = (src_gpu) ? src_agent : dst_agent;
+
+  if (dst_agent == src_agent || (!src_gpu && !dst_gpu)) {
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+
+  const LinkInfo link = GetLinkInfo(src_agent->node_id(), dst_agent->node_id());
+  hints->min_bandwidth = link.info.min_bandwidth;
+  hints->max_bandwidth = link.info.max_bandwidth;
+
+  return copy_agent->DmaCopyEngineHints(*dst_agent, *src_agent, hints);
+}
+
+// Returns the GPU to fill [ptr, endPtr) with, or nullptr if the range is not GPU mapped.
+// Selects GPU fill for SVM and Locked allocations if a GPU address is given and is mapped.
+static core::Agent* FillAgent(void* ptr, ptrdiff_t endPtr, const hsa_amd_pointer_info_t& info,
+                              uint32_t agent_count, const hsa_agent_t* accessible) {
+  if (info.agentBaseAddress > ptr ||
+      endPtr > (ptrdiff_t)info.agentBaseAddress + info.sizeInBytes)
+    return nullptr;
+
+  core::Agent* blit_agent = core::Agent::Convert(info.agentOwner);
+  if (blit_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice) return blit_agent;
+
+  for (uint32_t i = 0; i < agent_count; i++) {
+    if (core::Agent::Convert(accessible[i])->device_type() ==
+        core::Agent::DeviceType::kAmdGpuDevice) {
+      return core::Agent::Convert(accessible[i]);
+    }
+  }
+  return nullptr;
+}
+
+hsa_status_t Runtime::FillMemory(void* ptr, uint32_t value, size_t count) {
+  // Choose blit agent from pointer info
+  hsa_amd_pointer_info_t info;
+  uint32_t agent_count;
+  hsa_agent_t* accessible = nullptr;
+  info.size = sizeof(info);
+  MAKE_SCOPE_GUARD([&]() { free(accessible); });
+  hsa_status_t err = PtrInfo(ptr, &info, malloc, &agent_count, &accessible);
+  if (err != HSA_STATUS_SUCCESS) return err;
+
+  ptrdiff_t endPtr = (ptrdiff_t)ptr + count * sizeof(uint32_t);
+
+  // Check for GPU fill
+  core::Agent* blit_agent = FillAgent(ptr, endPtr, info, agent_count, accessible);
+  if (blit_agent) return blit_agent->DmaFill(ptr, value, count);
+
+  // Host and unmapped SVM addresses copy via host.
+  if (info.hostBaseAddress <= ptr && endPtr <= (ptrdiff_t)info.hostBaseAddress + info.sizeInBytes) {
+    memset(ptr, value, count * sizeof(uint32_t));
+    return HSA_STATUS_SUCCESS;
+  }
+
+  return HSA_STATUS_ERROR_INVALID_ALLOCATION;
 }
 
-hsa_status_t Runtime::CopyMemoryStatus(core::Agent* dst_agent, core::Agent* src_agent,
-                                       uint32_t *engine_ids_mask) {
-  const bool src_gpu = (src_agent->device_type() == core::Agent::DeviceType::kAmdGpuDevice);
-  core::Agent* copy_agent = (src_gpu) ? src_agent : dst_agent;
+namespace {
+// Fill of host memory, run by the async signal handler once its dependencies are satisfied.
+struct HostFillRequest {
+  void* ptr;
+  uint8_t pattern[16];
+  uint32_t pattern_size;
+  size_t size;
+  std::vector<core::Signal*> dep_signals;
+  core::Signal* completion_signal;
+};
+}  // namespace
 
-  if (dst_agent == src_agent) {
-    return HSA_STATUS_ERROR_INVALID_AGENT;
+static bool HostFillHandler(hsa_signal_value_t value, void* arg) {
+  HostFillRequest* request = reinterpret_cast<HostFillRequest*>(arg);
+
+  // Wait on the next unsatisfied dependency, if any.
+  for (core::Signal* dep : request->dep_signals) {
+    if (dep->LoadRelaxed() != 0) {
+      Runtime::runtime_singleton_->SetAsyncSignalHandler(core::Signal::Convert(dep),
+                                                         HSA_SIGNAL_CONDITION_EQ, 0,
+                                                         HostFillHandler, request);
+      return false;
+    }
   }
+  std::atomic_thread_fence(std::memory_order_acquire);
 
-  return copy_agent->DmaCopyStatus(*dst_agent, *src_agent, engine_ids_mask);
+  // The pattern is replicated to 16 bytes, the tail is a whole number of patterns.
+  uint8_t* dst = reinterpret_cast<uint8_t*>(request->ptr);
+  if (request->pattern_size == 1) {
+    memset(dst, request->pattern[0], request->size);
+  } else {
+    size_t offset = 0;
+    for (; offset + sizeof(request->pattern) <= request->size; offset += sizeof(request->pattern))
+      memcpy(dst + offset, request->pattern, sizeof(request->pattern));
+    memcpy(dst + offset, request->pattern, request->size - offset);
+  }
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  request->completion_signal->SubRelease(1);
+  delete request;
+  return false;
 }
 
-hsa_status_t Runtime::FillMemory(void* ptr, uint32_t value, size_t count) {
+hsa_status_t Runtime::FillMemoryAsync(void* ptr, const void* pattern, uint32_t pattern_size,
+                                      size_t count, std::vector<core::Signal*>& dep_signals,
+                                      core::Signal& completion_signal) {
+  // Replicate the pattern to 4 dwords, patterns repeating within a dword collapse to one.
+  uint32_t expanded[4];
+  for (uint32_t i = 0; i < sizeof(expanded); i += pattern_size)
+    memcpy(reinterpret_cast<uint8_t*>(expanded) + i, pattern, pattern_size);
+  const bool uniform =
+      (expanded[0] == expanded[1]) && (expanded[0] == expanded[2]) && (expanded[0] == expanded[3]);
+  const uint32_t pattern_dwords = uniform ? 1 : 4;
+  const size_t size = count * pattern_size;
+
   // Choose blit agent from pointer info
   hsa_amd_pointer_info_t info;
   uint32_t agent_count;
@@ -650,29 +1856,23 @@ hsa_status_t Runtime::FillMemory(void* ptr, uint32_t value, size_t count) {
   hsa_status_t err = PtrInfo(ptr, &info, malloc, &agent_count, &accessible);
   if (err != HSA_STATUS_SUCCESS) return err;
 
-  ptrdiff_t endPtr = (ptrdiff_t)ptr + count * sizeof(uint32_t);
+  ptrdiff_t endPtr = (ptrdiff_t)ptr + size;
 
-  // Check for GPU fill
-  // Selects GPU fill for SVM and Locked allocations if a GPU address is given and is mapped.
-  if (info.agentBaseAddress <= ptr &&
-      endPtr <= (ptrdiff_t)info.agentBaseAddress + info.sizeInBytes) {
-    core::Agent* blit_agent = core::Agent::Convert(info.agentOwner);
-    if (blit_agent->device_type() != core::Agent::DeviceType::kAmdGpuDevice) {
-      blit_agent = nullptr;
-      for (uint32_t i = 0; i < agent_count; i++) {
-        if (core::Agent::Convert(accessible[i])->device_type() ==
-            core::Agent::DeviceType::kAmdGpuDevice) {
-          blit_agent = core::Agent::Convert(accessible[i]);
-          break;
-        }
-      }
-    }
-    if (blit_agent) return blit_agent->DmaFill(ptr, value, count);
-  }
+  core::Agent* blit_agent = FillAgent(ptr, endPtr, info, agent_count, accessible);
+  if (blit_agent)
+    return blit_agent->DmaFillAsync(ptr, expanded, pattern_dwords, size, dep_signals,
+                                    completion_signal);
 
-  // Host and unmapped SVM addresses copy via host.
+  // Host and unmapped SVM addresses fill via host.
   if (info.hostBaseAddress <= ptr && endPtr <= (ptrdiff_t)info.hostBaseAddress + info.sizeInBytes) {
-    memset(ptr, value, count * sizeof(uint32_t));
+    HostFillRequest* request = new HostFillRequest();
+    request->ptr = ptr;
+    memcpy(request->pattern, expanded, sizeof(expanded));
+    request->pattern_size = pattern_size;
+    request->size = size;
+    request->dep_signals = dep_signals;
+    request->completion_signal = &completion_signal;
+    HostFillHandler(0, request);
     return HSA_STATUS_SUCCESS;
   }
 
@@ -684,28 +1884,130 @@ hsa_status_t Runtime::AllowAccess(uint32_t num_agents,
   const AMD::MemoryRegion* amd_region = NULL;
   size_t alloc_size = 0;
 
-  {
-    ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
+  bool found = allocation_map_.FindShared(ptr, [&](const AllocationRegion& entry) {
+    amd_region = reinterpret_cast<const AMD::MemoryRegion*>(entry.region);
+    alloc_size = entry.size;
+  });
+
+  if (!found) {
+    /* See if this address was mapped via VMM */
+    ScopedAcquire<KernelMutex> lock(&vmem_lock_);
+    return VMemoryMapAllowAccess(ptr, HSA_ACCESS_PERMISSION_RW, agents, num_agents);
+  }
+
+  // Imported IPC handle entries inside allocation_map_ do not have an amd_region because they
+  // were allocated in the other process. Access is already granted during IPCAttach().
+  if (!amd_region) return HSA_STATUS_SUCCESS;
+
+  ScopedAcquire<KernelSharedMutex> lock(&peer_access_lock_);
+  hsa_status_t err = amd_region->AllowAccess(num_agents, agents, ptr, alloc_size);
+  if (err == HSA_STATUS_SUCCESS && amd_region->IsLocalMemory())
+    TrackHostAccess(num_agents, agents, ptr);
+  return err;
+}
+
+hsa_status_t Runtime::AllowAccess(uint32_t num_agents, const hsa_agent_t* agents,
+                                  uint32_t num_ptrs, const void* const* ptrs) {
+  // Allocations of a region are granted together, in the order regions are first seen.
+  std::vector<std::pair<const AMD::MemoryRegion*, std::vector<HsaMemoryRange>>> groups;
+
+  for (uint32_t i = 0; i < num_ptrs; i++) {
+    const void* ptr = ptrs[i];
+    const AMD::MemoryRegion* amd_region = NULL;
+    size_t alloc_size = 0;
 
-    std::map<const void*, AllocationRegion>::const_iterator it = allocation_map_.find(ptr);
+    bool found = allocation_map_.FindShared(ptr, [&](const AllocationRegion& entry) {
+      amd_region = reinterpret_cast<const AMD::MemoryRegion*>(entry.region);
+      alloc_size = entry.size;
+    });
 
-    if (it == allocation_map_.end()) {
+    if (!found) {
       /* See if this address was mapped via VMM */
-      return VMemoryMapAllowAccess(ptr, HSA_ACCESS_PERMISSION_RW, agents,
-                                   num_agents);
+      ScopedAcquire<KernelMutex> lock(&vmem_lock_);
+      hsa_status_t err =
+          VMemoryMapAllowAccess(ptr, HSA_ACCESS_PERMISSION_RW, agents, num_agents);
+      if (err != HSA_STATUS_SUCCESS) return err;
+      continue;
     }
 
-    amd_region = reinterpret_cast<const AMD::MemoryRegion*>(it->second.region);
+    // Imported IPC handles were granted access during IPCAttach().
+    if (!amd_region) continue;
+
+    auto group = std::find_if(groups.begin(), groups.end(),
+                              [&](const std::pair<const AMD::MemoryRegion*,
+                                                  std::vector<HsaMemoryRange>>& entry) {
+                                return entry.first == amd_region;
+                              });
+    if (group == groups.end()) {
+      groups.emplace_back(amd_region, std::vector<HsaMemoryRange>());
+      group = groups.end() - 1;
+    }
+    HsaMemoryRange range = {const_cast<void*>(ptr), alloc_size};
+    group->second.push_back(range);
+  }
 
-    // Imported IPC handle entries inside allocation_map_ do not have an amd_region because they
-    // were allocated in the other process. Access is already granted during IPCAttach().
-    if (!amd_region)
-      return HSA_STATUS_SUCCESS;
+  ScopedAcquire<KernelSharedMutex> lock(&peer_access_lock_);
+  for (auto& group : groups) {
+    hsa_status_t err =
+        group.first->AllowAccess(num_agents, agents, &group.second[0], group.second.size());
+    if (err != HSA_STATUS_SUCCESS) return err;
+    if (group.first->IsLocalMemory()) {
+      for (auto& range : group.second) TrackHostAccess(num_agents, agents, range.MemoryAddress);
+    }
+  }
+
+  return HSA_STATUS_SUCCESS;
+}
+
+void Runtime::TrackHostAccess(uint32_t num_agents, const hsa_agent_t* agents, const void* ptr) {
+  bool cpu_in_list = false;
+  for (uint32_t i = 0; i < num_agents; i++)
+    cpu_in_list |= (Agent::Convert(agents[i])->device_type() == Agent::kAmdCpuDevice);
+  if (!cpu_in_list) return;
+
+  // Access is not revoked before the memory is freed, so each allocation is counted once.
+  allocation_map_.Find(ptr, [&](AllocationRegion& entry) {
+    if (entry.host_writable) return;
+    entry.host_writable = true;
+    if (!entry.device_only)
+      static_cast<AMD::GpuAgent*>(entry.region->owner())->HostWritableLocalMemory(1);
+  });
+}
+
+void Runtime::TrackHostMapping(AllocationRegion& entry) {
+  if (entry.region->owner()->device_type() != Agent::kAmdGpuDevice) return;
+
+  // Public device memory is mapped for the CPU when it is allocated.
+  const AMD::MemoryRegion* amd_region = reinterpret_cast<const AMD::MemoryRegion*>(entry.region);
+  if (!amd_region->IsLocalMemory() || !amd_region->IsPublic() ||
+      (entry.alloc_flags & MemoryRegion::AllocateMemoryOnly))
+    return;
+  entry.host_writable = true;
+  static_cast<AMD::GpuAgent*>(entry.region->owner())->HostWritableLocalMemory(1);
+}
 
-    alloc_size = it->second.size;
+void Runtime::PinHdpFlush(const Agent* agent) {
+  for (Agent* gpu : gpu_agents_) {
+    if (agent == nullptr || agent == gpu) static_cast<AMD::GpuAgent*>(gpu)->PinHdpFlush();
   }
+}
 
-  return amd_region->AllowAccess(num_agents, agents, ptr, alloc_size);
+hsa_status_t Runtime::SetDeviceOnly(void* ptr, bool device_only) {
+  hsa_status_t err = HSA_STATUS_SUCCESS;
+  bool found = allocation_map_.Find(ptr, [&](AllocationRegion& entry) {
+    const AMD::MemoryRegion* amd_region =
+        reinterpret_cast<const AMD::MemoryRegion*>(entry.region);
+    if (amd_region == nullptr || !amd_region->IsLocalMemory()) {
+      err = HSA_STATUS_ERROR_INVALID_ARGUMENT;
+      return;
+    }
+    if (entry.device_only == device_only) return;
+    entry.device_only = device_only;
+    if (entry.host_writable)
+      static_cast<AMD::GpuAgent*>(entry.region->owner())
+          ->HostWritableLocalMemory(device_only ? -1 : 1);
+  });
+  return found ? err : HSA_STATUS_ERROR_INVALID_ALLOCATION;
 }
 
 hsa_status_t Runtime::GetSystemInfo(hsa_system_info_t attribute, void* value) {
@@ -823,6 +2125,10 @@ hsa_status_t Runtime::GetSystemInfo(hsa_system_info_t attribute, void* value) {
       *((uint16_t*)value) = HSA_AMD_INTERFACE_VERSION_MINOR;
       break;
     }
+    case HSA_AMD_SYSTEM_INFO_INIT_PHASE_TIMES: {
+      *((hsa_amd_init_phase_times_t*)value) = init_phases_;
+      break;
+    }
     default:
       return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   }
@@ -833,17 +2139,28 @@ hsa_status_t Runtime::SetAsyncSignalHandler(hsa_signal_t signal,
                                             hsa_signal_condition_t cond,
                                             hsa_signal_value_t value,
                                             hsa_amd_signal_handler handler,
-                                            void* arg) {
+                                            void* arg, bool dedicated) {
 
-  struct AsyncEventsInfo* asyncInfo = &asyncSignals_;
+  struct AsyncEventsInfo* asyncInfo = &asyncSignals_[0];
 
   if (signal.handle != 0) {
     // Indicate that this signal is in use.
     hsa_signal_handle(signal)->Retain();
 
     core::Signal* coreSignal = core::Signal::Convert(signal);
-    if (coreSignal->EopEvent() && coreSignal->EopEvent()->EventData.EventType != HSA_EVENTTYPE_SIGNAL)
+    if (coreSignal->EopEvent() &&
+        coreSignal->EopEvent()->EventData.EventType != HSA_EVENTTYPE_SIGNAL) {
       asyncInfo = &asyncExceptions_;
+    } else if (dedicated) {
+      asyncInfo = &asyncCritical_;
+    } else {
+      // All handlers of one signal land on the same shard, keeping their relative order.
+      uint32_t shards = flag().async_event_threads();
+      if (shards == 0) shards = 1;
+      if (shards > kMaxAsyncEventShards) shards = kMaxAsyncEventShards;
+      const uint64_t hash = (signal.handle >> 6) * 0x9E3779B97F4A7C15ull;
+      asyncInfo = &asyncSignals_[(hash >> 32) % shards];
+    }
   }
 
   ScopedAcquire<HybridMutex> scope_lock(&asyncInfo->control.lock);
@@ -862,7 +2179,7 @@ hsa_status_t Runtime::SetAsyncSignalHandler(hsa_signal_t signal,
     // Start event monitoring thread
     asyncInfo->control.exit = false;
     asyncInfo->control.async_events_thread_ =
-        os::CreateThread(AsyncEventsLoop, asyncInfo);
+        CreateThread(HSA_AMD_THREAD_CLASS_ASYNC_EVENTS, AsyncEventsLoop, asyncInfo);
     if (asyncInfo->control.async_events_thread_ == NULL) {
       assert(false && "Asyncronous events thread creation error.");
       return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
@@ -876,10 +2193,61 @@ hsa_status_t Runtime::SetAsyncSignalHandler(hsa_signal_t signal,
   return HSA_STATUS_SUCCESS;
 }
 
+// Maps of the same graphics buffer to the same set of agents share one mapping.  A dma-buf is
+// identified by its inode, which can not be reused while a cached import holds the buffer.
+bool Runtime::InteropKey(int interop_handle, uint32_t num_agents, Agent** agents,
+                         std::vector<uint64_t>* key) {
+  struct stat st;
+  if (fstat(interop_handle, &st) != 0) return false;
+  key->clear();
+  key->push_back(uint64_t(st.st_dev));
+  key->push_back(uint64_t(st.st_ino));
+  for (uint32_t i = 0; i < num_agents; i++) key->push_back(agents[i]->node_id());
+  std::sort(key->begin() + 2, key->end());
+  return true;
+}
+
 hsa_status_t Runtime::InteropMap(uint32_t num_agents, Agent** agents,
                                  int interop_handle, uint32_t flags,
                                  size_t* size, void** ptr,
                                  size_t* metadata_size, const void** metadata) {
+  std::vector<uint64_t> key;
+  const bool cacheable = InteropKey(interop_handle, num_agents, agents, &key);
+
+  if (cacheable) {
+    ScopedAcquire<KernelMutex> lock(&interop_lock_);
+    auto it = interop_cache_.find(key);
+    if (it != interop_cache_.end()) {
+      InteropEntry& entry = interop_mappings_[it->second];
+      if (entry.ref_count++ == 0) interop_idle_.erase(entry.idle);
+      *size = entry.size;
+      *ptr = it->second;
+      if (metadata_size != NULL) *metadata_size = entry.metadata_size;
+      if (metadata != NULL) *metadata = entry.metadata;
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
+  size_t meta_size = 0;
+  const void* meta = nullptr;
+  hsa_status_t err =
+      InteropMapping(num_agents, agents, interop_handle, size, ptr, &meta_size, &meta);
+  if (err != HSA_STATUS_SUCCESS) return err;
+  if (metadata_size != NULL) *metadata_size = meta_size;
+  if (metadata != NULL) *metadata = meta;
+  if (!cacheable) return HSA_STATUS_SUCCESS;
+
+  // A concurrent map of the same buffer may have been cached first, in which case this mapping
+  // stays private and is released on unmap.
+  ScopedAcquire<KernelMutex> lock(&interop_lock_);
+  if (interop_cache_.emplace(key, *ptr).second)
+    interop_mappings_[*ptr] = {std::move(key), 1, interop_idle_.end(), *size, meta_size, meta};
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t Runtime::InteropMapping(uint32_t num_agents, Agent** agents, int interop_handle,
+                                     size_t* size, void** ptr, size_t* metadata_size,
+                                     const void** metadata) {
   static const int tinyArraySize=8;
   HsaGraphicsResourceInfo info;
 
@@ -916,24 +2284,99 @@ hsa_status_t Runtime::InteropMap(uint32_t num_agents, Agent** agents,
     }
   }
 
-  if (metadata_size != NULL) *metadata_size = info.MetadataSizeInBytes;
-  if (metadata != NULL) *metadata = info.Metadata;
+  *metadata_size = info.MetadataSizeInBytes;
+  *metadata = info.Metadata;
 
   *size = info.SizeInBytes;
   *ptr = info.MemoryAddress;
 
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-  allocation_map_[info.MemoryAddress] = AllocationRegion(
-      nullptr, info.SizeInBytes, info.SizeInBytes, core::MemoryRegion::AllocateNoFlags);
+  allocation_map_.Insert(info.MemoryAddress, info.SizeInBytes,
+                         AllocationRegion(nullptr, info.SizeInBytes, info.SizeInBytes,
+                                          core::MemoryRegion::AllocateNoFlags));
+  // Graphics buffers may be written by the CPU through the graphics stack.
+  PinHdpFlush(nullptr);
 
   return HSA_STATUS_SUCCESS;
 }
 
 hsa_status_t Runtime::InteropUnmap(void* ptr) {
+  std::vector<void*> evicted;
+  {
+    ScopedAcquire<KernelMutex> lock(&interop_lock_);
+    auto it = interop_mappings_.find(ptr);
+    if (it == interop_mappings_.end()) {
+      lock.Release();
+      return InteropUnmapping(ptr);
+    }
+    if (it->second.ref_count == 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    if (--it->second.ref_count != 0) return HSA_STATUS_SUCCESS;
+
+    if (it->second.key.empty()) {
+      interop_mappings_.erase(it);
+      lock.Release();
+      return InteropUnmapping(ptr);
+    }
+
+    // Keep the mapping for a later map, releasing the oldest unreferenced ones over the limit.
+    it->second.idle = interop_idle_.insert(interop_idle_.end(), ptr);
+    while (interop_idle_.size() > flag().interop_cache_size()) {
+      auto entry = interop_mappings_.find(interop_idle_.front());
+      interop_idle_.pop_front();
+      interop_cache_.erase(entry->second.key);
+      evicted.push_back(entry->first);
+      interop_mappings_.erase(entry);
+    }
+  }
+
+  hsa_status_t err = HSA_STATUS_SUCCESS;
+  for (void* mapping : evicted) {
+    hsa_status_t status = InteropUnmapping(mapping);
+    if (err == HSA_STATUS_SUCCESS) err = status;
+  }
+  return err;
+}
+
+hsa_status_t Runtime::InteropCacheInvalidate(int interop_handle) {
+  std::vector<uint64_t> key;
+  if ((interop_handle != -1) && !InteropKey(interop_handle, 0, nullptr, &key))
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  std::vector<void*> released;
+  {
+    ScopedAcquire<KernelMutex> lock(&interop_lock_);
+    auto it = interop_cache_.begin();
+    while (it != interop_cache_.end()) {
+      // Keys start with the buffer's identity, the agent set follows.
+      if (!key.empty() && !std::equal(key.begin(), key.end(), it->first.begin())) {
+        it++;
+        continue;
+      }
+      auto entry = interop_mappings_.find(it->second);
+      if (entry->second.ref_count == 0) {
+        interop_idle_.erase(entry->second.idle);
+        released.push_back(entry->first);
+        interop_mappings_.erase(entry);
+      } else {
+        entry->second.key.clear();
+      }
+      it = interop_cache_.erase(it);
+    }
+  }
+
+  hsa_status_t err = HSA_STATUS_SUCCESS;
+  for (void* mapping : released) {
+    hsa_status_t status = InteropUnmapping(mapping);
+    if (err == HSA_STATUS_SUCCESS) err = status;
+  }
+  return err;
+}
+
+hsa_status_t Runtime::InteropUnmapping(void* ptr) {
   if(hsaKmtUnmapMemoryToGPU(ptr)!=HSAKMT_STATUS_SUCCESS)
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   if(hsaKmtDeregisterMemory(ptr)!=HSAKMT_STATUS_SUCCESS)
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  allocation_map_.Erase(ptr, nullptr);
   return HSA_STATUS_SUCCESS;
 }
 
@@ -964,9 +2407,9 @@ hsa_status_t Runtime::PtrInfo(const void* ptr, hsa_amd_pointer_info_t* info, voi
 
   bool allocation_map_entry_found = false;
 
-  {  // memory_lock protects access to the NMappedNodes array and fragment user data since these may
-     // change with calls to memory APIs.
-    ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
+  {  // memory_lock protects access to the NMappedNodes array since it may change with calls to
+     // memory APIs.  Queries only read thunk state so may proceed concurrently.
+    ScopedAcquire<KernelSharedMutex::Shared> lock(memory_lock_.shared());
 
     // We don't care if this returns an error code.
     // The type will be HSA_EXT_POINTER_TYPE_UNKNOWN if so.
@@ -1009,21 +2452,18 @@ hsa_status_t Runtime::PtrInfo(const void* ptr, hsa_amd_pointer_info_t* info, voi
       assert(nodeAgents != agents_by_node_.end() && "Node id not found!");
       block_info->agentOwner = nodeAgents->second[0];
     }
-    auto fragment = allocation_map_.upper_bound(ptr);
-    if (fragment != allocation_map_.begin()) {
-      fragment--;
-      if ((fragment->first <= ptr) &&
-          (ptr < reinterpret_cast<const uint8_t*>(fragment->first) + fragment->second.size_requested)) {
-        // agent and host address must match here. Only lock memory is allowed to have differing
-        // addresses but lock memory has type HSA_EXT_POINTER_TYPE_LOCKED and cannot be
-        // suballocated.
-        retInfo.agentBaseAddress = const_cast<void*>(fragment->first);
-        retInfo.hostBaseAddress = retInfo.agentBaseAddress;
-        retInfo.sizeInBytes = fragment->second.size_requested;
-        retInfo.userData = fragment->second.user_ptr;
-        allocation_map_entry_found = true;
-      }
-    }
+    allocation_map_entry_found = allocation_map_.FindContainingShared(
+        ptr, [&](const void* base, size_t size, const AllocationRegion& fragment) {
+          if (uintptr_t(ptr) - uintptr_t(base) >= fragment.size_requested) return false;
+          // agent and host address must match here. Only lock memory is allowed to have
+          // differing addresses but lock memory has type HSA_EXT_POINTER_TYPE_LOCKED and cannot
+          // be suballocated.
+          retInfo.agentBaseAddress = const_cast<void*>(base);
+          retInfo.hostBaseAddress = retInfo.agentBaseAddress;
+          retInfo.sizeInBytes = fragment.size_requested;
+          retInfo.userData = fragment.user_ptr;
+          return true;
+        });
   }  // end lock scope
 
   // Return type UNKNOWN for released fragments.  Do not report the underlying block info to users!
@@ -1082,131 +2522,168 @@ hsa_status_t Runtime::PtrInfo(const void* ptr, hsa_amd_pointer_info_t* info, voi
 }
 
 hsa_status_t Runtime::SetPtrInfoData(const void* ptr, void* userptr) {
-  {  // Use allocation map if possible to handle fragments.
-    ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-    const auto& it = allocation_map_.find(ptr);
-    if (it != allocation_map_.end()) {
-      it->second.user_ptr = userptr;
-      return HSA_STATUS_SUCCESS;
-    }
-  }
+  // Use allocation map if possible to handle fragments.
+  if (allocation_map_.Find(ptr, [&](AllocationRegion& entry) { entry.user_ptr = userptr; }))
+    return HSA_STATUS_SUCCESS;
+
   // Cover entries not in the allocation map (graphics, lock,...)
   if (hsaKmtSetMemoryUserData(ptr, userptr) == HSAKMT_STATUS_SUCCESS)
     return HSA_STATUS_SUCCESS;
   return HSA_STATUS_ERROR_INVALID_ARGUMENT;
 }
 
-// Send the dmabuf_fd to from process via Unix socket
-static int SendDmaBufFd(int socket, int dmabuf_fd) {
-  char iov_buf[1];
+// Send dmabuf FDs to another process via Unix socket.  One status byte per requested handle
+// ('y' exported, 'n' not found) is followed by the exported FDs in request order.
+static int SendDmaBufFds(int socket, const char* status, size_t count, const int* fds,
+                         size_t num_fds) {
   struct msghdr msg = {0};
-  char buf[CMSG_SPACE(sizeof(dmabuf_fd))];
+  std::vector<char> buf(CMSG_SPACE(sizeof(int) * num_fds), 0);
 
-  memset(buf, 0, sizeof(buf));
-  memset(iov_buf, 0, sizeof(iov_buf));
-  iov_buf[0] = 'y';
-
-  struct iovec io = {.iov_base = iov_buf, .iov_len = 1};
+  struct iovec io = {.iov_base = const_cast<char*>(status), .iov_len = count};
 
   msg.msg_iov = &io;
   msg.msg_iovlen = 1;
-  msg.msg_control = buf;
-  msg.msg_controllen = sizeof(buf);
+  msg.msg_control = buf.data();
+  msg.msg_controllen = buf.size();
 
   struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
   cmsg->cmsg_level = SOL_SOCKET;
   cmsg->cmsg_type = SCM_RIGHTS;
-  cmsg->cmsg_len = CMSG_LEN(sizeof(dmabuf_fd));
-
-  memcpy(CMSG_DATA(cmsg), &dmabuf_fd, sizeof(dmabuf_fd));
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int) * num_fds);
 
-  msg.msg_controllen = CMSG_SPACE(sizeof(dmabuf_fd));
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * num_fds);
 
-  size_t sent = sendmsg(socket, &msg, 0);
+  ssize_t sent = sendmsg(socket, &msg, 0);
 
   return (sent < 0) ? -1 : 0;
 }
 
-// Receive the dmabuf_fd to from process via Unix socket
-static int ReceiveDmaBufFd(int socket) {
+// Receive dmabuf FDs from another process via Unix socket.  Fills fds[i] for every handle the
+// exporter found, -1 otherwise.  Returns the number of FDs received or -1.
+static int ReceiveDmaBufFds(int socket, size_t count, int* fds) {
   struct msghdr msg = {0};
 
-  // The struct iovec is needed, even if it points to minimal data
-  char m_buffer[1];
-  struct iovec io = {.iov_base = m_buffer, .iov_len = sizeof(m_buffer)};
+  std::vector<char> status(count);
+  struct iovec io = {.iov_base = status.data(), .iov_len = count};
   msg.msg_iov = &io;
   msg.msg_iovlen = 1;
 
-  char c_buffer[256];
-  msg.msg_control = c_buffer;
-  msg.msg_controllen = sizeof(c_buffer);
+  std::vector<char> c_buffer(CMSG_SPACE(sizeof(int) * count));
+  msg.msg_control = c_buffer.data();
+  msg.msg_controllen = c_buffer.size();
 
-  size_t rcv = recvmsg(socket, &msg, MSG_WAITALL);
-  if (rcv < 0) return -1;
-
-  while (!rcv)
-    rcv = recvmsg(socket, &msg, MSG_WAITALL);
+  ssize_t rcv;
+  do {
+    rcv = recvmsg(socket, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+  } while (rcv == -1 && errno == EINTR);
+  if (rcv <= 0) return -1;
 
   struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
-
-  int fd;
-  memcpy(&fd, CMSG_DATA(cmsg), sizeof(fd));
-
-  return fd;
+  if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+    return -1;
+
+  size_t num_fds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+  std::vector<int> received(num_fds);
+  memcpy(received.data(), CMSG_DATA(cmsg), sizeof(int) * num_fds);
+
+  size_t next = 0;
+  for (size_t i = 0; i < count; i++)
+    fds[i] = (size_t(rcv) > i && status[i] == 'y' && next < num_fds) ? received[next++] : -1;
+  for (; next < num_fds; next++) close(received[next]);
+  return num_fds;
 }
 
 #define IPC_SOCK_SERVER_DMABUF_FD_HANDLE_LENGTH 64
 #define IPC_SOCK_SERVER_NAME_LENGTH 32
 #define IPC_SOCK_SERVER_CONN_CLOSE_HANDLE UINT64_MAX
+// Requests starting with this tag carry a count, followed by that many binary handles.
+#define IPC_SOCK_SERVER_BATCH_TAG "batch"
+#define IPC_SOCK_SERVER_BATCH_MAX 64
+#define IPC_SOCK_SERVER_THREADS 4
+
+static bool ReadAll(int fd, void* buf, size_t size) {
+  uint8_t* ptr = reinterpret_cast<uint8_t*>(buf);
+  while (size > 0) {
+    ssize_t ret = read(fd, ptr, size);
+    if (ret == -1 && errno == EINTR) continue;
+    if (ret <= 0) return false;
+    ptr += ret;
+    size -= ret;
+  }
+  return true;
+}
+
 void Runtime::AsyncIPCSockServerConnLoop(void*) {
    auto& ipc_sock_server_fd_ = runtime_singleton_->ipc_sock_server_fd_;
    auto& ipc_sock_server_conns_ = runtime_singleton_->ipc_sock_server_conns_;
    auto& ipc_sock_server_lock_ = runtime_singleton_->ipc_sock_server_lock_;
+   auto& ipc_sock_server_stop_ = runtime_singleton_->ipc_sock_server_stop_;
 
-   int connection_fd;
    char buf[IPC_SOCK_SERVER_DMABUF_FD_HANDLE_LENGTH];
-   // Wait until the client has connected
-   while (1) {
-     connection_fd = accept(ipc_sock_server_fd_, NULL, NULL);
+   // Several of these loops accept on the same socket, so a slow client only holds up its own
+   // connection.
+   while (!ipc_sock_server_stop_) {
+     int connection_fd = accept4(ipc_sock_server_fd_, NULL, NULL, SOCK_CLOEXEC);
      if (connection_fd == -1) continue;
      MAKE_SCOPE_GUARD([&]() { close(connection_fd); });
-     if (read(connection_fd, buf, sizeof(buf)) == -1)
-       continue;
-
-     // Request to kill the server.
-     uint64_t conn_handle = strtoull(buf, NULL, 10);
-     if (conn_handle == IPC_SOCK_SERVER_CONN_CLOSE_HANDLE)
-       break;
-
-     int dmabuf_fd = -1;
-     uint64_t fragOffset;
-     void *ptr = NULL;
-     size_t len = 0;
-
-     // Search for registered export pointer
-     ScopedAcquire<KernelMutex> lock(&ipc_sock_server_lock_);
-     for (auto& conns : ipc_sock_server_conns_) {
-       if (conn_handle == conns.first) {
-         ptr = reinterpret_cast<void *>(conn_handle);
-         len = conns.second;
+     if (!ReadAll(connection_fd, buf, sizeof(buf))) continue;
+     buf[sizeof(buf) - 1] = '\0';
+
+     std::vector<uint64_t> conn_handles;
+     const size_t tag_len = strlen(IPC_SOCK_SERVER_BATCH_TAG);
+     if (strncmp(buf, IPC_SOCK_SERVER_BATCH_TAG, tag_len) == 0) {
+       unsigned long count = strtoul(buf + tag_len, NULL, 10);
+       if (count == 0 || count > IPC_SOCK_SERVER_BATCH_MAX) continue;
+       conn_handles.resize(count);
+       if (!ReadAll(connection_fd, conn_handles.data(), count * sizeof(uint64_t))) continue;
+     } else {
+       uint64_t conn_handle = strtoull(buf, NULL, 10);
+       // Request to kill the server.
+       if (conn_handle == IPC_SOCK_SERVER_CONN_CLOSE_HANDLE) {
+         ipc_sock_server_stop_ = true;
+         shutdown(ipc_sock_server_fd_, SHUT_RDWR);  // Wakes the other accepting loops.
          break;
        }
+       conn_handles.push_back(conn_handle);
      }
 
-     if (!ptr) continue;
+     // Export a DMA Buf FD for every registered export pointer.
+     std::vector<char> status(conn_handles.size(), 'n');
+     std::vector<int> dmabuf_fds;
+     MAKE_SCOPE_GUARD([&]() {
+       for (int fd : dmabuf_fds) close(fd);
+     });
+     for (size_t i = 0; i < conn_handles.size(); i++) {
+       size_t len;
+       {
+         ScopedAcquire<KernelMutex> lock(&ipc_sock_server_lock_);
+         auto conn = ipc_sock_server_conns_.find(conn_handles[i]);
+         if (conn == ipc_sock_server_conns_.end()) continue;
+         len = conn->second;
+       }
+
+       int dmabuf_fd;
+       uint64_t fragOffset;
+       if (hsaKmtExportDMABufHandle(reinterpret_cast<void*>(conn_handles[i]), len, &dmabuf_fd,
+                                    &fragOffset) != HSAKMT_STATUS_SUCCESS)
+         continue;
+       dmabuf_fds.push_back(dmabuf_fd);
+       status[i] = 'y';
+     }
+     if (dmabuf_fds.empty()) continue;
 
-     // Export DMA Buf FD and wait for client import
-     int err = hsaKmtExportDMABufHandle(ptr, len, &dmabuf_fd, &fragOffset);
-     if (err != HSAKMT_STATUS_SUCCESS) continue;
-     SendDmaBufFd(connection_fd, dmabuf_fd);
-     err = read(connection_fd, buf, sizeof(buf));
-     close(dmabuf_fd);
-     if (err == -1) break; // Client failed to confirm import so end server
+     // Send the FDs and wait for client import.
+     if (SendDmaBufFds(connection_fd, status.data(), status.size(), dmabuf_fds.data(),
+                       dmabuf_fds.size()) == 0)
+       ReadAll(connection_fd, buf, sizeof(buf));
    }
 
-   // Clean up
-   ipc_sock_server_conns_.clear();
-   close(ipc_sock_server_fd_);
+   // Clean up once the last loop has exited.
+   if (--runtime_singleton_->ipc_sock_server_threads_ == 0) {
+     ScopedAcquire<KernelMutex> lock(&ipc_sock_server_lock_);
+     ipc_sock_server_conns_.clear();
+     close(ipc_sock_server_fd_);
+   }
 }
 
 hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* handle) {
@@ -1234,6 +2711,9 @@ hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* han
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   }
 
+  // The importing process may write the memory from its CPU.
+  PinHdpFlush(Agent::Convert(info.agentOwner));
+
   bool useFrag = (block.base != ptr || block.length != len);
   // Assume all pointers and blocks are 4Kb aligned.
   uint32_t fragOffset = (reinterpret_cast<uint8_t*>(ptr) -
@@ -1254,8 +2734,11 @@ hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* han
     if (useFrag) {
       handle->handle[6] |= 0x80000000 | fragOffset;
       // Prevent realloction of fragment for better performance.
-      ScopedAcquire<KernelSharedMutex::Shared> lock(memory_lock_.shared());
-      err = allocation_map_[ptr].region->IPCFragmentExport(ptr);
+      // The shard lock keeps the fragment from being released during the export.
+      err = HSA_STATUS_ERROR_INVALID_ALLOCATION;
+      allocation_map_.FindShared(ptr, [&](const AllocationRegion& entry) {
+        err = entry.region->IPCFragmentExport(ptr);
+      });
       assert(err == HSA_STATUS_SUCCESS && "Region inconsistent with address map.");
     }
     return err;
@@ -1273,6 +2756,10 @@ hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* han
   // System sub allocations are not supported for now.
   if (handle->handle[3] && useFrag) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
   handle->handle[4] = agent->node_id();
+  // Export generation, so a handle to a freed and reallocated address never matches an
+  // importer's cached attachment of the old allocation.
+  static std::atomic<uint32_t> export_generation(0);
+  handle->handle[5] = ++export_generation;
   if (useFrag) handle->handle[6] |= 0x80000000 | fragOffset;
 
   // Work around to defer export on import call to minimize FD creation.
@@ -1309,14 +2796,19 @@ hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* han
     int err = bind(ipc_sock_server_fd_, (struct sockaddr *)&address, sizeof(struct sockaddr_un));
     assert(!err && "Connection to export DMA buffer not made!");
     if (err) return HSA_STATUS_ERROR;
-    err = listen(ipc_sock_server_fd_, 1);
+    err = listen(ipc_sock_server_fd_, SOMAXCONN);
     assert(!err && "Connection to export DMA buffer not made!");
     if (err) return HSA_STATUS_ERROR;
 
-    // Spin server client acceptance into a socket server thread.
+    // Spin server client acceptance into socket server threads.
     // Socket server needs to last for the lifetime of the runtime instance
     // as the attach life cycle is unknown.
-    os::CreateThread(AsyncIPCSockServerConnLoop, NULL);
+    ipc_sock_server_stop_ = false;
+    ipc_sock_server_threads_ = IPC_SOCK_SERVER_THREADS;
+    for (int i = 0; i < IPC_SOCK_SERVER_THREADS; i++) {
+      if (CreateThread(HSA_AMD_THREAD_CLASS_IPC_SERVER, AsyncIPCSockServerConnLoop, NULL) == NULL)
+        ipc_sock_server_threads_--;
+    }
   }
 
   ipc_sock_server_conns_[reinterpret_cast<uint64_t>(ptr)] = len;
@@ -1327,24 +2819,20 @@ hsa_status_t Runtime::IPCCreate(void* ptr, size_t len, hsa_amd_ipc_memory_t* han
   return HSA_STATUS_SUCCESS;
 }
 
-int Runtime::IPCClientImport(uint32_t conn_handle, uint64_t dmabuf_fd_handle,
-                             amdgpu_bo_import_result *res,
-                             unsigned int numNodes, HSAuint32 *nodes,
-                             void **importAddress, HSAuint64 *importSize) {
+// Connect to the socket server of exporting process conn_handle.
+static int IPCClientConnect(uint32_t conn_handle) {
     struct sockaddr_un address;
-    int dmabuf_fd = -1, socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    int socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
     assert(socket_fd > -1 && "DMA buffer could not be imported for IPC!");
     if (socket_fd == -1) return -1;
 
-    // Set 10 second timeout for ReceiveDmaBufFd
+    // Set 10 second timeout for ReceiveDmaBufFds
     struct timeval tv;
     tv.tv_sec = 10;
     tv.tv_usec = 0;
     setsockopt(socket_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof tv);
 
-    char buf[IPC_SOCK_SERVER_DMABUF_FD_HANDLE_LENGTH];
     memset(&address, 0, sizeof(struct sockaddr_un));
-    memset(buf, 0, sizeof(buf));
     address.sun_family = AF_UNIX;
     snprintf(address.sun_path, IPC_SOCK_SERVER_NAME_LENGTH, "xhsa%i", conn_handle);
     address.sun_path[0] = 0; // first NULL char creates unlisted abstract socket
@@ -1359,19 +2847,54 @@ int Runtime::IPCClientImport(uint32_t conn_handle, uint64_t dmabuf_fd_handle,
       }
     }
 
-    MAKE_SCOPE_GUARD([&]() { close(socket_fd); });
+    if (timeoutMs >= timeoutLimitMs) {
+      close(socket_fd);
+      return -1;
+    }
+    return socket_fd;
+}
+
+int Runtime::IPCClientImport(uint32_t conn_handle, uint64_t dmabuf_fd_handle,
+                             amdgpu_bo_import_result *res,
+                             unsigned int numNodes, HSAuint32 *nodes,
+                             void **importAddress, HSAuint64 *importSize) {
+    // Use an FD fetched ahead of time by a batched attach.
+    if (dmabuf_fd_handle != IPC_SOCK_SERVER_CONN_CLOSE_HANDLE) {
+      ScopedAcquire<KernelMutex> lock(&ipc_attach_lock_);
+      auto it = ipc_prefetched_fds_.find(std::make_pair(conn_handle, dmabuf_fd_handle));
+      if (it != ipc_prefetched_fds_.end()) {
+        int dmabuf_fd = it->second;
+        ipc_prefetched_fds_.erase(it);
+        lock.Release();
+        return IPCImportDmaBufFd(dmabuf_fd, res, numNodes, nodes, importAddress, importSize);
+      }
+    }
 
-    if (timeoutMs >= timeoutLimitMs) return -1;
+    int socket_fd = IPCClientConnect(conn_handle);
+    if (socket_fd == -1) return -1;
+    MAKE_SCOPE_GUARD([&]() { close(socket_fd); });
 
     // Ping server to export and send DMABUF FD on handle
+    char buf[IPC_SOCK_SERVER_DMABUF_FD_HANDLE_LENGTH];
+    memset(buf, 0, sizeof(buf));
     snprintf(buf, sizeof(buf), "%li", dmabuf_fd_handle);
     if (write(socket_fd, buf, sizeof(buf)) == -1) return -1;
 
     if (dmabuf_fd_handle == IPC_SOCK_SERVER_CONN_CLOSE_HANDLE) return 0;
 
-    dmabuf_fd = ReceiveDmaBufFd(socket_fd);
-    if (dmabuf_fd == -1) return -1;
+    int dmabuf_fd;
+    if (ReceiveDmaBufFds(socket_fd, 1, &dmabuf_fd) != 1) return -1;
+
+    int err = IPCImportDmaBufFd(dmabuf_fd, res, numNodes, nodes, importAddress, importSize);
+
+    // Ping socket server to close exporter
+    if (write(socket_fd, buf, sizeof(buf)) == -1) return -1;
+    return err;
+}
 
+int Runtime::IPCImportDmaBufFd(int dmabuf_fd, amdgpu_bo_import_result *res,
+                               unsigned int numNodes, HSAuint32 *nodes,
+                               void **importAddress, HSAuint64 *importSize) {
     HsaGraphicsResourceInfo info;
     HSA_REGISTER_MEM_FLAGS regFlags;
     regFlags.ui32.requiresVAddr = !!res ? 0 : 1;
@@ -1387,16 +2910,125 @@ int Runtime::IPCClientImport(uint32_t conn_handle, uint64_t dmabuf_fd_handle,
         err = amdgpu_bo_import(agent->libDrmDev(), amdgpu_bo_handle_type_dma_buf_fd,
                                dmabuf_fd, res);
       }
-      close(dmabuf_fd);
     }
-
-    // Ping socket server to close exporter
-    if (write(socket_fd, buf, sizeof(buf)) == -1) return -1;
+    close(dmabuf_fd);
     return err;
 }
 
+void Runtime::IPCClientFetchFds(uint32_t conn_handle, const std::vector<uint64_t>& handles) {
+    for (size_t first = 0; first < handles.size(); first += IPC_SOCK_SERVER_BATCH_MAX) {
+      size_t count = Min(handles.size() - first, size_t(IPC_SOCK_SERVER_BATCH_MAX));
+
+      int socket_fd = IPCClientConnect(conn_handle);
+      if (socket_fd == -1) return;
+      MAKE_SCOPE_GUARD([&]() { close(socket_fd); });
+
+      char buf[IPC_SOCK_SERVER_DMABUF_FD_HANDLE_LENGTH];
+      memset(buf, 0, sizeof(buf));
+      snprintf(buf, sizeof(buf), IPC_SOCK_SERVER_BATCH_TAG "%zu", count);
+      if (write(socket_fd, buf, sizeof(buf)) == -1) return;
+      if (write(socket_fd, &handles[first], count * sizeof(uint64_t)) == -1) return;
+
+      std::vector<int> fds(count);
+      if (ReceiveDmaBufFds(socket_fd, count, fds.data()) <= 0) return;
+
+      // Ping socket server to close exporter
+      if (write(socket_fd, buf, sizeof(buf)) == -1) {
+        for (int fd : fds)
+          if (fd != -1) close(fd);
+        return;
+      }
+
+      ScopedAcquire<KernelMutex> lock(&ipc_attach_lock_);
+      for (size_t i = 0; i < count; i++) {
+        if (fds[i] == -1) continue;
+        if (!ipc_prefetched_fds_.emplace(std::make_pair(conn_handle, handles[first + i]), fds[i])
+                 .second)
+          close(fds[i]);
+      }
+    }
+}
+
+hsa_status_t Runtime::IPCAttachBatch(const hsa_amd_ipc_memory_t* handles, const size_t* lens,
+                                     uint32_t count, uint32_t num_agents, Agent** agents,
+                                     void** mapped_ptrs) {
+  // Fetch the FDs of all uncached DMA buf handles with one request per exporting process.
+  std::map<uint32_t, std::vector<uint64_t>> requests;
+  if (ipc_dmabuf_supported_) {
+    ScopedAcquire<KernelMutex> lock(&ipc_attach_lock_);
+    for (uint32_t i = 0; i < count; i++) {
+      if (ipc_attach_cache_.count(IPCAttachKey(&handles[i], lens[i], num_agents, agents)))
+        continue;
+      uint64_t dmaBufFDHandle = (uint64_t(handles[i].handle[1]) << 32) | handles[i].handle[0];
+      requests[handles[i].handle[2]].push_back(dmaBufFDHandle);
+    }
+  }
+  for (auto& request : requests) IPCClientFetchFds(request.first, request.second);
+
+  // Release any fetched FD an attach did not consume.
+  MAKE_SCOPE_GUARD([&]() {
+    ScopedAcquire<KernelMutex> lock(&ipc_attach_lock_);
+    for (auto& request : requests) {
+      for (uint64_t dmaBufFDHandle : request.second) {
+        auto it = ipc_prefetched_fds_.find(std::make_pair(request.first, dmaBufFDHandle));
+        if (it == ipc_prefetched_fds_.end()) continue;
+        close(it->second);
+        ipc_prefetched_fds_.erase(it);
+      }
+    }
+  });
+
+  for (uint32_t i = 0; i < count; i++) {
+    hsa_status_t err = IPCAttach(&handles[i], lens[i], num_agents, agents, &mapped_ptrs[i]);
+    if (err != HSA_STATUS_SUCCESS) {
+      while (i-- > 0) IPCDetach(mapped_ptrs[i]);
+      return err;
+    }
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+// Attaches of the same handle and length to the same set of agents share one mapping.
+std::vector<uint32_t> Runtime::IPCAttachKey(const hsa_amd_ipc_memory_t* handle, size_t len,
+                                            uint32_t num_agents, Agent** agents) {
+  std::vector<uint32_t> key(std::begin(handle->handle), std::end(handle->handle));
+  key.push_back(uint32_t(len));
+  key.push_back(uint32_t(uint64_t(len) >> 32));
+  for (uint32_t i = 0; i < num_agents; i++) key.push_back(agents[i]->node_id());
+  std::sort(key.end() - num_agents, key.end());
+  return key;
+}
+
 hsa_status_t Runtime::IPCAttach(const hsa_amd_ipc_memory_t* handle, size_t len, uint32_t num_agents,
                                 Agent** agents, void** mapped_ptr) {
+  TimelineSpan span(Timeline::kIpcAttach, len);
+
+  std::vector<uint32_t> key = IPCAttachKey(handle, len, num_agents, agents);
+
+  {
+    ScopedAcquire<KernelMutex> lock(&ipc_attach_lock_);
+    auto it = ipc_attach_cache_.find(key);
+    if (it != ipc_attach_cache_.end()) {
+      IPCAttachEntry& entry = ipc_attach_mappings_[it->second];
+      if (entry.ref_count++ == 0) ipc_attach_idle_.erase(entry.idle);
+      *mapped_ptr = it->second;
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
+  hsa_status_t err = IPCAttachMapping(handle, len, num_agents, agents, mapped_ptr);
+  if (err != HSA_STATUS_SUCCESS) return err;
+
+  // A concurrent attach of the same handle may have been cached first, in which case this
+  // mapping stays private and is released on detach.
+  ScopedAcquire<KernelMutex> lock(&ipc_attach_lock_);
+  if (ipc_attach_cache_.emplace(key, *mapped_ptr).second)
+    ipc_attach_mappings_[*mapped_ptr] = {std::move(key), 1, ipc_attach_idle_.end()};
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t Runtime::IPCAttachMapping(const hsa_amd_ipc_memory_t* handle, size_t len,
+                                       uint32_t num_agents, Agent** agents, void** mapped_ptr) {
   static const int tinyArraySize = 8;
   void* importAddress;
   HSAuint64 importSize;
@@ -1412,10 +3044,11 @@ hsa_status_t Runtime::IPCAttach(const hsa_amd_ipc_memory_t* handle, size_t len,
       importAddress = reinterpret_cast<uint8_t*>(importAddress) + fragOffset;
       len = Min(len, importSize - fragOffset);
     }
-    ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-    allocation_map_[importAddress] =
-        AllocationRegion(nullptr, len, len, core::MemoryRegion::AllocateNoFlags);
-    allocation_map_[importAddress].ldrm_bo = ldrm_bo;
+    AllocationRegion entry(nullptr, len, len, core::MemoryRegion::AllocateNoFlags);
+    entry.ldrm_bo = ldrm_bo;
+    allocation_map_.Insert(importAddress, len, std::move(entry));
+    // The exporting process may write the memory from its CPU.
+    PinHdpFlush(nullptr);
   };
 
   auto importMemory = [&](unsigned int numNodes, HSAuint32 *nodes,
@@ -1519,21 +3152,62 @@ hsa_status_t Runtime::IPCAttach(const hsa_amd_ipc_memory_t* handle, size_t len,
 }
 
 hsa_status_t Runtime::IPCDetach(void* ptr) {
+  std::vector<void*> evicted;
+  {
+    ScopedAcquire<KernelMutex> lock(&ipc_attach_lock_);
+    auto it = ipc_attach_mappings_.find(ptr);
+    if (it == ipc_attach_mappings_.end()) {
+      lock.Release();
+      return IPCDetachMapping(ptr);
+    }
+    if (it->second.ref_count == 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    if (--it->second.ref_count != 0) return HSA_STATUS_SUCCESS;
+
+    // Keep the mapping for a later attach, releasing the oldest unreferenced ones over the limit.
+    it->second.idle = ipc_attach_idle_.insert(ipc_attach_idle_.end(), ptr);
+    while (ipc_attach_idle_.size() > flag().ipc_attach_cache_size()) {
+      auto entry = ipc_attach_mappings_.find(ipc_attach_idle_.front());
+      ipc_attach_idle_.pop_front();
+      ipc_attach_cache_.erase(entry->second.key);
+      evicted.push_back(entry->first);
+      ipc_attach_mappings_.erase(entry);
+    }
+  }
+
+  hsa_status_t err = HSA_STATUS_SUCCESS;
+  for (void* mapping : evicted) {
+    hsa_status_t status = IPCDetachMapping(mapping);
+    if (err == HSA_STATUS_SUCCESS) err = status;
+  }
+  return err;
+}
+
+hsa_status_t Runtime::IPCDetachMapping(void* ptr) {
   bool ldrmImportCleaned = false;
   {  // Handle imported fragments.
     ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-    const auto& it = allocation_map_.find(ptr);
-    if (it != allocation_map_.end()) {
-      if (it->second.region != nullptr) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
-      if (it->second.ldrm_bo) {
-         if (amdgpu_bo_va_op(it->second.ldrm_bo, 0, it->second.size,
-                             reinterpret_cast<uint64_t>(ptr), 0, AMDGPU_VA_OP_UNMAP))
-           return HSA_STATUS_ERROR_INVALID_ARGUMENT;
-         if (amdgpu_bo_free(it->second.ldrm_bo)) // auto unmaps from cpu
-           return HSA_STATUS_ERROR_INVALID_ARGUMENT;
-         ldrmImportCleaned = true;
-      }
-      allocation_map_.erase(it);
+    hsa_status_t err = HSA_STATUS_SUCCESS;
+    bool found = allocation_map_.Find(ptr, [&](AllocationRegion& entry) {
+      if (entry.region != nullptr) {
+        err = HSA_STATUS_ERROR_INVALID_ARGUMENT;
+        return;
+      }
+      if (entry.ldrm_bo) {
+        if (amdgpu_bo_va_op(entry.ldrm_bo, 0, entry.size, reinterpret_cast<uint64_t>(ptr), 0,
+                            AMDGPU_VA_OP_UNMAP)) {
+          err = HSA_STATUS_ERROR_INVALID_ARGUMENT;
+          return;
+        }
+        if (amdgpu_bo_free(entry.ldrm_bo)) {  // auto unmaps from cpu
+          err = HSA_STATUS_ERROR_INVALID_ARGUMENT;
+          return;
+        }
+        ldrmImportCleaned = true;
+      }
+    });
+    if (found) {
+      if (err != HSA_STATUS_SUCCESS) return err;
+      allocation_map_.Erase(ptr, nullptr);
       lock.Release();  // Can't hold memory lock when using pointer info.
 
       PtrInfoBlockData block;
@@ -1557,6 +3231,10 @@ hsa_status_t Runtime::IPCDetach(void* ptr) {
 void Runtime::AsyncEventsLoop(void* _eventsInfo) {
   struct AsyncEventsInfo* eventsInfo = reinterpret_cast<struct AsyncEventsInfo*>(_eventsInfo);
 
+  // Fault and exception handlers may spend a long time diagnosing, keep them from competing
+  // with the threads of healthy queues.
+  if (eventsInfo->monitor_exceptions) os::LowerThreadPriority();
+
   auto& async_events_control_ = eventsInfo->control;
   auto& async_events_ = eventsInfo->events;
   auto& new_async_events_ = eventsInfo->new_events;
@@ -1604,6 +3282,7 @@ void Runtime::AsyncEventsLoop(void* _eventsInfo) {
           hsa_events.resize(unique_evts + 10);
           event_age.resize(unique_evts + 10);
        }
+       hsa_signals[idx]->FlushDeferredInterrupt();
        hsa_events[unique_evts] = hsa_event;
        if (init_age) {
          event_age[unique_evts] = runtime_singleton_->KfdVersion().supports_event_age ? 1 : 0;
@@ -1623,6 +3302,9 @@ void Runtime::AsyncEventsLoop(void* _eventsInfo) {
   };
 
   while (!async_events_control_.exit) {
+    // Slot 0 is the wake signal.
+    Metrics::Record(HSA_AMD_RUNTIME_HISTOGRAM_ASYNC_HANDLER_SIGNALS, async_events_.Size() - 1);
+
     // Wait for a signal
     hsa_signal_value_t value;
     uint32_t index = 0;
@@ -1810,6 +3492,19 @@ bool Runtime::HwExceptionHandler(hsa_signal_value_t val, void* arg) {
 
   HsaHwException& exception = exception_event->EventData.EventData.HwException;
 
+  // Find the faulty agent
+  auto it = runtime_singleton_->agents_by_node_.find(exception.NodeId);
+  assert(it != runtime_singleton_->agents_by_node_.end() && "Can't find faulty agent.");
+  const hsa_amd_hw_exception_reset_cause_t reset_cause =
+      (exception.ResetCause == HSA_EVENTID_HW_EXCEPTION_ECC) ? HSA_AMD_HW_EXCEPTION_CAUSE_ECC
+                                                             : HSA_AMD_HW_EXCEPTION_CAUSE_GPU_HANG;
+
+  hsa_amd_gpu_fault_record_t record = {};
+  record.event_type = HSA_AMD_GPU_HW_EXCEPTION_EVENT;
+  record.agent = Agent::Convert(it->second.front());
+  record.reset_cause = reset_cause;
+  const uint64_t sequence = runtime_singleton_->RecordFault(record);
+
   hsa_status_t custom_handler_status = HSA_STATUS_ERROR;
   auto system_event_handlers = runtime_singleton_->GetSystemEventHandlers();
   // If custom handler is registered, pack the fault info and call the handler
@@ -1818,25 +3513,18 @@ bool Runtime::HwExceptionHandler(hsa_signal_value_t val, void* arg) {
     hsa_amd_event_t hw_exception_event;
     hw_exception_event.event_type = HSA_AMD_GPU_HW_EXCEPTION_EVENT;
     hsa_amd_gpu_hw_exception_info_t& exception_info = hw_exception_event.hw_exception;
-
-    // Find the faulty agent
-    auto it = runtime_singleton_->agents_by_node_.find(exception.NodeId);
-    assert(it != runtime_singleton_->agents_by_node_.end() && "Can't find faulty agent.");
-    Agent* faulty_agent = it->second.front();
-    exception_info.agent = Agent::Convert(faulty_agent);
+    exception_info.agent = record.agent;
 
     // This field is not set by KFD at the moment
     exception_info.reset_type = HSA_AMD_HW_EXCEPTION_RESET_TYPE_OTHER;
-
-    exception_info.reset_cause = (exception.ResetCause == HSA_EVENTID_HW_EXCEPTION_ECC)
-        ? HSA_AMD_HW_EXCEPTION_CAUSE_ECC
-        : HSA_AMD_HW_EXCEPTION_CAUSE_GPU_HANG;
+    exception_info.reset_cause = reset_cause;
 
     for (auto& callback : system_event_handlers) {
       hsa_status_t err = callback.first(&hw_exception_event, callback.second);
       if (err == HSA_STATUS_SUCCESS) custom_handler_status = HSA_STATUS_SUCCESS;
     }
   }
+  if (custom_handler_status == HSA_STATUS_SUCCESS) runtime_singleton_->MarkFaultHandled(sequence);
 
   if (custom_handler_status != HSA_STATUS_SUCCESS) {
     core::Agent* faultingAgent = runtime_singleton_->agents_by_node_[exception.NodeId][0];
@@ -1866,56 +3554,67 @@ bool Runtime::VMFaultHandler(hsa_signal_value_t val, void* arg) {
   HsaMemoryAccessFault& fault =
       vm_fault_event->EventData.EventData.MemoryAccessFault;
 
+  // Find the faulty agent
+  auto it = runtime_singleton_->agents_by_node_.find(fault.NodeId);
+  assert(it != runtime_singleton_->agents_by_node_.end() && "Can't find faulty agent.");
+  Agent* fault_agent = it->second.front();
+
+  uint32_t fault_reason_mask = 0;
+  if (fault.Failure.NotPresent == 1) {
+    fault_reason_mask |= HSA_AMD_MEMORY_FAULT_PAGE_NOT_PRESENT;
+  }
+  if (fault.Failure.ReadOnly == 1) {
+    fault_reason_mask |= HSA_AMD_MEMORY_FAULT_READ_ONLY;
+  }
+  if (fault.Failure.NoExecute == 1) {
+    fault_reason_mask |= HSA_AMD_MEMORY_FAULT_NX;
+  }
+  if (fault.Failure.GpuAccess == 1) {
+    fault_reason_mask |= HSA_AMD_MEMORY_FAULT_HOST_ONLY;
+  }
+  if (fault.Failure.Imprecise == 1) {
+    fault_reason_mask |= HSA_AMD_MEMORY_FAULT_IMPRECISE;
+  }
+  if (fault.Failure.ECC == 1 && fault.Failure.ErrorType == 0) {
+    fault_reason_mask |= HSA_AMD_MEMORY_FAULT_DRAMECC;
+  }
+  if (fault.Failure.ErrorType == 1) {
+    fault_reason_mask |= HSA_AMD_MEMORY_FAULT_SRAMECC;
+  }
+  if (fault.Failure.ErrorType == 2) {
+    fault_reason_mask |= HSA_AMD_MEMORY_FAULT_DRAMECC;
+  }
+  if (fault.Failure.ErrorType == 3) {
+    fault_reason_mask |= HSA_AMD_MEMORY_FAULT_HANG;
+  }
+
+  // Record the fault before any handler runs so it can be inspected while they work.
+  hsa_amd_gpu_fault_record_t record = {};
+  record.event_type = HSA_AMD_GPU_MEMORY_FAULT_EVENT;
+  record.agent = Agent::Convert(fault_agent);
+  record.virtual_address = fault.VirtualAddress;
+  record.fault_reason_mask = fault_reason_mask;
+  const uint64_t sequence = runtime_singleton_->RecordFault(record);
+
   hsa_status_t custom_handler_status = HSA_STATUS_ERROR;
   auto system_event_handlers = runtime_singleton_->GetSystemEventHandlers();
   Agent* faulty_agent = nullptr;
-  // If custom handler is registered, pack the fault info and call the handler
-  if (!system_event_handlers.empty()) {
-    hsa_amd_event_t memory_fault_event;
-    memory_fault_event.event_type = HSA_AMD_GPU_MEMORY_FAULT_EVENT;
-    hsa_amd_gpu_memory_fault_info_t& fault_info = memory_fault_event.memory_fault;
-
-    // Find the faulty agent
-    auto it = runtime_singleton_->agents_by_node_.find(fault.NodeId);
-    assert(it != runtime_singleton_->agents_by_node_.end() && "Can't find faulty agent.");
-    faulty_agent = it->second.front();
-    fault_info.agent = Agent::Convert(faulty_agent);
-
-    fault_info.virtual_address = fault.VirtualAddress;
-    fault_info.fault_reason_mask = 0;
-    if (fault.Failure.NotPresent == 1) {
-      fault_info.fault_reason_mask |= HSA_AMD_MEMORY_FAULT_PAGE_NOT_PRESENT;
-    }
-    if (fault.Failure.ReadOnly == 1) {
-      fault_info.fault_reason_mask |= HSA_AMD_MEMORY_FAULT_READ_ONLY;
-    }
-    if (fault.Failure.NoExecute == 1) {
-      fault_info.fault_reason_mask |= HSA_AMD_MEMORY_FAULT_NX;
-    }
-    if (fault.Failure.GpuAccess == 1) {
-      fault_info.fault_reason_mask |= HSA_AMD_MEMORY_FAULT_HOST_ONLY;
-    }
-    if (fault.Failure.Imprecise == 1) {
-      fault_info.fault_reason_mask |= HSA_AMD_MEMORY_FAULT_IMPRECISE;
-    }
-    if (fault.Failure.ECC == 1 && fault.Failure.ErrorType == 0) {
-      fault_info.fault_reason_mask |= HSA_AMD_MEMORY_FAULT_DRAMECC;
-    }
-    if (fault.Failure.ErrorType == 1) {
-      fault_info.fault_reason_mask |= HSA_AMD_MEMORY_FAULT_SRAMECC;
-    }
-    if (fault.Failure.ErrorType == 2) {
-      fault_info.fault_reason_mask |= HSA_AMD_MEMORY_FAULT_DRAMECC;
-    }
-    if (fault.Failure.ErrorType == 3) {
-      fault_info.fault_reason_mask |= HSA_AMD_MEMORY_FAULT_HANG;
-    }
+  // If custom handler is registered, pack the fault info and call the handler
+  if (!system_event_handlers.empty()) {
+    faulty_agent = fault_agent;
+    hsa_amd_event_t memory_fault_event;
+    memory_fault_event.event_type = HSA_AMD_GPU_MEMORY_FAULT_EVENT;
+    hsa_amd_gpu_memory_fault_info_t& fault_info = memory_fault_event.memory_fault;
+    fault_info.agent = record.agent;
+    fault_info.virtual_address = fault.VirtualAddress;
+    fault_info.fault_reason_mask = fault_reason_mask;
 
     for (auto& callback : system_event_handlers) {
       hsa_status_t err = callback.first(&memory_fault_event, callback.second);
       if (err == HSA_STATUS_SUCCESS) custom_handler_status = HSA_STATUS_SUCCESS;
     }
   }
+  if (custom_handler_status == HSA_STATUS_SUCCESS) runtime_singleton_->MarkFaultHandled(sequence);
 
   // No custom VM fault handler registered or it failed.
   if (custom_handler_status != HSA_STATUS_SUCCESS) {
@@ -1940,7 +3639,7 @@ bool Runtime::VMFaultHandler(hsa_signal_value_t val, void* arg) {
         reason += "Unknown";
       }
 
-      faulty_agent = runtime_singleton_->agents_by_node_[fault.NodeId][0];
+      faulty_agent = fault_agent;
 
       fprintf(
           stderr,
@@ -1959,9 +3658,14 @@ bool Runtime::VMFaultHandler(hsa_signal_value_t val, void* arg) {
         faulty_agent->supported_isas()[0]->GetMajorVersion() != 11 &&
                       !runtime_singleton_->KfdVersion().supports_core_dump) {
 
+      amd::coredump::DumpOptions options;
+      options.threads = runtime_singleton_->flag().coredump_threads();
+      options.compress = runtime_singleton_->flag().coredump_compress();
+      options.skip_readonly = runtime_singleton_->flag().coredump_skip_readonly();
+
       if (pcs::PcsRuntime::instance()->SessionsActive())
         fprintf(stderr, "GPU core dump skipped because PC Sampling active\n");
-      else if (amd::coredump::dump_gpu_core())
+      else if (amd::coredump::dump_gpu_core(options))
         fprintf(stderr, "GPU core dump failed\n");
     }
     assert(false && "GPU memory access fault.");
@@ -1972,18 +3676,33 @@ bool Runtime::VMFaultHandler(hsa_signal_value_t val, void* arg) {
 }
 
 void Runtime::PrintMemoryMapNear(void* ptr) {
-  runtime_singleton_->memory_lock_.Acquire();
-  auto it = runtime_singleton_->allocation_map_.upper_bound(ptr);
+  // The allocation index is unordered across shards so take a sorted snapshot.  This is only used
+  // when reporting fatal faults.
+  struct MapEntry {
+    const void* base;
+    size_t size;
+    const MemoryRegion* region;
+  };
+  std::vector<MapEntry> snapshot;
+  runtime_singleton_->allocation_map_.ForEachShared(
+      [&](const void* base, size_t size, const AllocationRegion& entry) {
+        snapshot.push_back({base, entry.size, entry.region});
+      });
+  std::sort(snapshot.begin(), snapshot.end(),
+            [](const MapEntry& lhs, const MapEntry& rhs) { return lhs.base < rhs.base; });
+
+  auto it = std::upper_bound(snapshot.begin(), snapshot.end(), ptr,
+                             [](const void* p, const MapEntry& entry) { return p < entry.base; });
   for (int i = 0; i < 2; i++) {
-    if (it != runtime_singleton_->allocation_map_.begin()) it--;
+    if (it != snapshot.begin()) it--;
   }
   fprintf(stderr, "Nearby memory map:\n");
   auto start = it;
   for (int i = 0; i < 3; i++) {
-    if (it == runtime_singleton_->allocation_map_.end()) break;
+    if (it == snapshot.end()) break;
     std::string kind = "Non-HSA";
-    if (it->second.region != nullptr) {
-      const AMD::MemoryRegion* region = static_cast<const AMD::MemoryRegion*>(it->second.region);
+    if (it->region != nullptr) {
+      const AMD::MemoryRegion* region = static_cast<const AMD::MemoryRegion*>(it->region);
       if (region->IsSystem())
         kind = "System";
       else if (region->IsLocalMemory())
@@ -1993,20 +3712,19 @@ void Runtime::PrintMemoryMapNear(void* ptr) {
       else if (region->IsLDS())
         kind = "LDS";
     }
-    fprintf(stderr, "%p, 0x%lx, %s\n", it->first, it->second.size, kind.c_str());
+    fprintf(stderr, "%p, 0x%lx, %s\n", it->base, it->size, kind.c_str());
     it++;
   }
   fprintf(stderr, "\n");
   it = start;
-  runtime_singleton_->memory_lock_.Release();
   hsa_amd_pointer_info_t info = {};
   PtrInfoBlockData block = {};
   uint32_t count = 0;
   hsa_agent_t* canAccess = nullptr;
   info.size = sizeof(info);
   for (int i = 0; i < 3; i++) {
-    if (it == runtime_singleton_->allocation_map_.end()) break;
-    hsa_status_t err = runtime_singleton_->PtrInfo(const_cast<void*>(it->first), &info, 
+    if (it == snapshot.end()) break;
+    hsa_status_t err = runtime_singleton_->PtrInfo(const_cast<void*>(it->base), &info,
                                                     malloc, &count, &canAccess, &block);
     if (err == HSA_STATUS_SUCCESS) {
       fprintf(stderr, "PtrInfo:\n\tAddress: %p-%p/%p-%p\n\tSize: 0x%lx\n\tType: %u\n\tOwner: %p\n",
@@ -2026,14 +3744,25 @@ void Runtime::PrintMemoryMapNear(void* ptr) {
 Runtime::Runtime()
     : region_gpu_(nullptr),
       sys_clock_freq_(0),
+      init_phases_(),
       vm_fault_event_(nullptr),
       vm_fault_signal_(nullptr),
       hw_exception_event_(nullptr),
       hw_exception_signal_(nullptr),
+      fault_count_(0),
       ref_count_(0),
-      kfd_version{} {
-
-  asyncSignals_.monitor_exceptions = false;
+      kfd_version{},
+      vmem_handle_cache_bytes_(0),
+      async_free_cache_bytes_(0),
+      deferred_free_thread_(NULL),
+      deferred_free_event_(NULL),
+      deferred_free_exit_(false),
+      memory_pressure_thread_(NULL),
+      memory_pressure_event_(NULL),
+      memory_pressure_exit_(false) {
+
+  for (auto& shard : asyncSignals_) shard.monitor_exceptions = false;
+  asyncCritical_.monitor_exceptions = false;
   asyncExceptions_.monitor_exceptions = true;
   g_use_interrupt_wait = true;
   g_use_mwaitx = true;
@@ -2048,6 +3777,8 @@ Runtime::Runtime()
 }
 
 hsa_status_t Runtime::Load() {
+  InitPhaseBegin(HSA_AMD_INIT_PHASE_TOTAL);
+
   os::cpuid_t cpuinfo;
 
   // Assume features are not supported if parse CPUID fails
@@ -2060,6 +3791,12 @@ hsa_status_t Runtime::Load() {
   }
 
   flag_.Refresh();
+
+  // Handlers can't be removed, later loads find them already registered.
+  if (flag_.fork_safe()) os::RegisterForkHandlers(PrepareFork, ParentFork, ChildFork);
+
+  Timeline::Start();
+
   g_use_interrupt_wait = flag_.enable_interrupt();
   g_use_mwaitx = flag_.check_mwaitx(cpuinfo.mwaitx);
 
@@ -2067,6 +3804,8 @@ hsa_status_t Runtime::Load() {
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
 
+  InitNodeSystemPools();
+
   // Setup system clock frequency for the first time.
   if (sys_clock_freq_ == 0) {
     sys_clock_freq_ = os::SystemClockFrequency();
@@ -2078,20 +3817,34 @@ hsa_status_t Runtime::Load() {
   loader_ = amd::hsa::loader::Loader::Create(&loader_context_);
 
   // Load extensions
+  InitPhaseBegin(HSA_AMD_INIT_PHASE_EXTENSIONS);
   LoadExtensions();
-
-  // Initialize per GPU scratch, blits, and trap handler
-  for (core::Agent* agent : gpu_agents_) {
-    hsa_status_t status =
-        reinterpret_cast<AMD::GpuAgentInt*>(agent)->PostToolsInit();
-
+  InitPhaseEnd(HSA_AMD_INIT_PHASE_EXTENSIONS);
+
+  // Initialize per GPU scratch, blits, and trap handler.  Agents do not depend on each other
+  // here so they are set up in parallel.
+  InitPhaseBegin(HSA_AMD_INIT_PHASE_AGENT_INIT);
+  std::vector<hsa_status_t> init_status(gpu_agents_.size(), HSA_STATUS_SUCCESS);
+  ParallelFor(gpu_agents_.size(), flag_.agent_init_threads(), [this, &init_status](size_t i) {
+    hsa_amd_agent_init_times_t& times = gpu_agents_[i]->init_times();
+    times.init_start = os::ReadSystemClock();
+    init_status[i] = reinterpret_cast<AMD::GpuAgentInt*>(gpu_agents_[i])->PostToolsInit();
+    times.init_end = os::ReadSystemClock();
+  });
+  InitPhaseEnd(HSA_AMD_INIT_PHASE_AGENT_INIT);
+  for (hsa_status_t status : init_status) {
     if (status != HSA_STATUS_SUCCESS) {
       return status;
     }
   }
 
   // Load tools libraries
+  InitPhaseBegin(HSA_AMD_INIT_PHASE_TOOLS);
   LoadTools();
+  InitPhaseEnd(HSA_AMD_INIT_PHASE_TOOLS);
+
+  // Tools intercept at load, so the table is final here.
+  hsa_table_interface_set_direct(flag().direct_api_dispatch());
 
   // Initialize libdrm helper function
   CheckVirtualMemApiSupport();
@@ -2102,6 +3855,12 @@ hsa_status_t Runtime::Load() {
   // Load svm profiler
   svm_profile_.reset(new AMD::SvmProfileControl);
 
+  metrics_dump_.reset(new MetricsDumper);
+
+  StartDeferredFree();
+  StartMemoryPressureMonitor();
+
+  InitPhaseEnd(HSA_AMD_INIT_PHASE_TOTAL);
   return HSA_STATUS_SUCCESS;
 }
 
@@ -2111,21 +3870,52 @@ void Runtime::Unload() {
     IPCClientImport(getpid(), IPC_SOCK_SERVER_CONN_CLOSE_HANDLE,
                     NULL, 0, NULL, NULL, NULL);
 
+  // Release IPC mappings kept for reuse.
+  for (void* ptr : ipc_attach_idle_) IPCDetachMapping(ptr);
+  ipc_attach_idle_.clear();
+  ipc_attach_mappings_.clear();
+  ipc_attach_cache_.clear();
+
+  // Release interop mappings kept for reuse.
+  for (void* ptr : interop_idle_) InteropUnmapping(ptr);
+  interop_idle_.clear();
+  interop_mappings_.clear();
+  interop_cache_.clear();
+
+  for (auto& exported : dmabuf_exports_) close(exported.second.fd);
+  dmabuf_exports_.clear();
+
+  StopMemoryPressureMonitor();
+
+  // Queued and cached memory is released while the rest of the runtime shuts down.  Agents and
+  // their regions must outlive it.
+  os::Thread release_thread =
+      CreateThread(HSA_AMD_THREAD_CLASS_BACKGROUND, ReleaseCachedMemoryRun, this);
+  if (release_thread == NULL) ReleaseCachedMemory();
+
   svm_profile_.reset(nullptr);
 
+  metrics_dump_.reset(nullptr);
+
+  Timeline::Stop();
+
+  hsa_table_interface_set_direct(false);
   UnloadTools();
   UnloadExtensions();
 
   amd::hsa::loader::Loader::Destroy(loader_);
   loader_ = nullptr;
 
-  std::for_each(gpu_agents_.begin(), gpu_agents_.end(), DeleteObject());
-  gpu_agents_.clear();
+  if (release_thread != NULL) {
+    os::WaitForThread(release_thread);
+    os::CloseThread(release_thread);
+  }
 
-  std::for_each(disabled_gpu_agents_.begin(), disabled_gpu_agents_.end(), DeleteObject());
-  disabled_gpu_agents_.clear();
+  DeleteAgents(gpu_agents_);
+  DeleteAgents(disabled_gpu_agents_);
 
-  asyncSignals_.control.Shutdown();
+  for (auto& shard : asyncSignals_) shard.control.Shutdown();
+  asyncCritical_.control.Shutdown();
   asyncExceptions_.control.Shutdown();
 
   if (vm_fault_signal_ != nullptr) {
@@ -2146,6 +3936,8 @@ void Runtime::Unload() {
 
   EventPool.clear();
 
+  AMD::MemoryRegion::FlushLockCache();
+
   DestroyAgents();
 
   CloseTools();
@@ -2264,6 +4056,24 @@ int Runtime::GetAmdgpuDeviceArgs(Agent* agent, amdgpu_bo_handle bo, int* drm_fd,
   return HSA_STATUS_SUCCESS;
 }
 
+void Runtime::InitNodeSystemPools() {
+  if (agents_by_node_.empty()) return;
+
+  std::vector<const MemoryRegion*> pools(max_node_id() + 1, nullptr);
+  auto kernarg_pool = [](const Agent* cpu) -> const MemoryRegion* {
+    for (auto pool : cpu->regions())
+      if (pool->kernarg()) return pool;
+    return nullptr;
+  };
+
+  for (auto cpu : cpu_agents_) pools[cpu->node_id()] = kernarg_pool(cpu);
+  for (auto gpu : gpu_agents_) {
+    const Agent* cpu = static_cast<AMD::GpuAgent*>(gpu)->GetNearestCpuAgent();
+    if (cpu != nullptr) pools[gpu->node_id()] = kernarg_pool(cpu);
+  }
+  node_system_pool_.swap(pools);
+}
+
 void Runtime::CheckVirtualMemApiSupport() {
   virtual_mem_api_supported_ = false;
 
@@ -2550,6 +4360,31 @@ Runtime::GetSystemEventHandlers() {
   return system_event_handlers_;
 }
 
+uint64_t Runtime::RecordFault(hsa_amd_gpu_fault_record_t record) {
+  record.timestamp = os::ReadSystemClock();
+  record.handled = false;
+  ScopedAcquire<KernelMutex> lock(&fault_records_lock_);
+  record.sequence = ++fault_count_;
+  if (fault_records_.size() == kMaxFaultRecords) fault_records_.pop_front();
+  fault_records_.push_back(record);
+  return record.sequence;
+}
+
+void Runtime::MarkFaultHandled(uint64_t sequence) {
+  ScopedAcquire<KernelMutex> lock(&fault_records_lock_);
+  if (fault_records_.empty() || sequence < fault_records_.front().sequence) return;
+  const uint64_t index = sequence - fault_records_.front().sequence;
+  if (index < fault_records_.size()) fault_records_[index].handled = true;
+}
+
+hsa_status_t Runtime::GetFaultRecords(hsa_amd_gpu_fault_record_t* records, uint32_t* count) {
+  ScopedAcquire<KernelMutex> lock(&fault_records_lock_);
+  const size_t n = std::min<size_t>(*count, fault_records_.size());
+  std::copy(fault_records_.end() - n, fault_records_.end(), records);
+  *count = uint32_t(n);
+  return HSA_STATUS_SUCCESS;
+}
+
 hsa_status_t Runtime::SetInternalQueueCreateNotifier(hsa_amd_runtime_queue_notifier callback,
                                                      void* user_data) {
   if (internal_queue_create_notifier_) {
@@ -2730,6 +4565,8 @@ hsa_status_t Runtime::SetSvmAttrib(void* ptr, size_t size,
   uint8_t* base = AlignDown((uint8_t*)ptr, 4096);
   uint8_t* end = AlignUp((uint8_t*)ptr + size, 4096);
   size_t len = end - base;
+  // Invalidate even on failure, KFD may have applied part of the update.
+  MAKE_SCOPE_GUARD([&]() { InvalidateSvmAttribs(uintptr_t(base), len); });
   HSAKMT_STATUS error = hsaKmtSVMSetAttr(base, len, attribs.size(), &attribs[0]);
   if (error != HSAKMT_STATUS_SUCCESS)
     throw AMD::hsa_exception(HSA_STATUS_ERROR, "hsaKmtSVMSetAttr failed.");
@@ -2737,6 +4574,77 @@ hsa_status_t Runtime::SetSvmAttrib(void* ptr, size_t size,
   return HSA_STATUS_SUCCESS;
 }
 
+void Runtime::InvalidateSvmAttribs(uint64_t ptr, uint64_t size) {
+  if (!flag().svm_attrib_cache()) return;
+
+  ScopedAcquire<KernelMutex> lock(&svm_attrib_lock_);
+  const uint64_t end = ptr + size;
+  auto stop = svm_attrib_cache_.lower_bound(std::make_pair(uintptr_t(end), size_t(0)));
+  for (auto it = svm_attrib_cache_.begin(); it != stop;) {
+    if (it->first.first + it->first.second > ptr)
+      it = svm_attrib_cache_.erase(it);
+    else
+      it++;
+  }
+}
+
+void Runtime::GetCachedSvmAttribs(void* base, size_t len,
+                                  std::vector<HSA_SVM_ATTRIBUTE>& attribs) {
+  // Snapshot layout: granularity, preferred location, access for each GPU in gpu_agents_ order,
+  // clear flags and set flags.
+  const auto key = std::make_pair(uintptr_t(base), len);
+  std::vector<HSA_SVM_ATTRIBUTE> snapshot;
+  {
+    ScopedAcquire<KernelMutex> lock(&svm_attrib_lock_);
+    auto it = svm_attrib_cache_.find(key);
+    if (it != svm_attrib_cache_.end()) snapshot = it->second;
+  }
+
+  if (snapshot.empty()) {
+    snapshot.push_back({HSA_SVM_ATTR_GRANULARITY, 0});
+    snapshot.push_back({HSA_SVM_ATTR_PREFERRED_LOC, 0});
+    for (auto agent : gpu_agents_) snapshot.push_back({HSA_SVM_ATTR_ACCESS, agent->node_id()});
+    snapshot.push_back({HSA_SVM_ATTR_CLR_FLAGS, 0});
+    snapshot.push_back({HSA_SVM_ATTR_SET_FLAGS, 0});
+
+    HSAKMT_STATUS error = hsaKmtSVMGetAttr(base, len, snapshot.size(), &snapshot[0]);
+    if (error != HSAKMT_STATUS_SUCCESS)
+      throw AMD::hsa_exception(HSA_STATUS_ERROR, "hsaKmtSVMGetAttr failed.");
+
+    ScopedAcquire<KernelMutex> lock(&svm_attrib_lock_);
+    // Bound the cache, queries of many distinct ranges start over.
+    if (svm_attrib_cache_.size() >= 1024) svm_attrib_cache_.clear();
+    svm_attrib_cache_[key] = snapshot;
+  }
+
+  for (auto& attrib : attribs) {
+    switch (attrib.type) {
+      case HSA_SVM_ATTR_GRANULARITY:
+        attrib = snapshot[0];
+        break;
+      case HSA_SVM_ATTR_PREFERRED_LOC:
+        attrib = snapshot[1];
+        break;
+      case HSA_SVM_ATTR_ACCESS:
+        for (size_t i = 0; i < gpu_agents_.size(); i++) {
+          if (gpu_agents_[i]->node_id() == attrib.value) {
+            attrib = snapshot[2 + i];
+            break;
+          }
+        }
+        break;
+      case HSA_SVM_ATTR_CLR_FLAGS:
+        attrib = snapshot[snapshot.size() - 2];
+        break;
+      case HSA_SVM_ATTR_SET_FLAGS:
+        attrib = snapshot[snapshot.size() - 1];
+        break;
+      default:
+        assert(false && "Unexpected SVM attribute query.");
+    }
+  }
+}
+
 hsa_status_t Runtime::GetSvmAttrib(void* ptr, size_t size,
                                    hsa_amd_svm_attribute_pair_t* attribute_list,
                                    size_t attribute_count) {
@@ -2816,9 +4724,13 @@ hsa_status_t Runtime::GetSvmAttrib(void* ptr, size_t size,
   uint8_t* end = AlignUp((uint8_t*)ptr + size, 4096);
   size_t len = end - base;
   if (attribs.size() != 0) {
-    HSAKMT_STATUS error = hsaKmtSVMGetAttr(base, len, attribs.size(), &attribs[0]);
-    if (error != HSAKMT_STATUS_SUCCESS)
-      throw AMD::hsa_exception(HSA_STATUS_ERROR, "hsaKmtSVMGetAttr failed.");
+    if (flag().svm_attrib_cache()) {
+      GetCachedSvmAttribs(base, len, attribs);
+    } else {
+      HSAKMT_STATUS error = hsaKmtSVMGetAttr(base, len, attribs.size(), &attribs[0]);
+      if (error != HSAKMT_STATUS_SUCCESS)
+        throw AMD::hsa_exception(HSA_STATUS_ERROR, "hsaKmtSVMGetAttr failed.");
+    }
   }
 
   for (uint32_t i = 0; i < attribute_count; i++) {
@@ -2896,21 +4808,123 @@ hsa_status_t Runtime::GetSvmAttrib(void* ptr, size_t size,
 hsa_status_t Runtime::SvmPrefetch(void* ptr, size_t size, hsa_agent_t agent,
                                   uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
                                   hsa_signal_t completion_signal) {
-  uintptr_t base = reinterpret_cast<uintptr_t>(AlignDown(ptr, 4096));
-  uintptr_t end = AlignUp(reinterpret_cast<uintptr_t>(ptr) + size, 4096);
-  size_t len = end - base;
+  const hsa_amd_svm_prefetch_range_t range = {ptr, size, agent};
+  return SvmPrefetchBatch(&range, 1, num_dep_signals, dep_signals, completion_signal);
+}
+
+void Runtime::InsertPrefetchRange(PrefetchOp* op, uintptr_t base, size_t len, uint32_t node_id) {
+  uintptr_t end = base + len;
+
+  // Remove all fully overlapped and trim partially overlapped ranges.
+  // Get iteration bounds
+  auto start = prefetch_map_.upper_bound(base);
+  if (start != prefetch_map_.begin()) start--;
+  auto stop = prefetch_map_.lower_bound(end);
+
+  auto isEndNode = [&](decltype(start) node) { return node->second.next == prefetch_map_.end(); };
+  auto isFirstNode = [&](decltype(start) node) {
+    return node->second.prev == prefetch_map_.end();
+  };
+
+  // Trim and remove old ranges.
+  while (start != stop) {
+    uintptr_t startBase = start->first;
+    uintptr_t startEnd = startBase + start->second.bytes;
+
+    auto ibase = Max(startBase, base);
+    auto iend = Min(startEnd, end);
+    // Check for overlap
+    if (ibase < iend) {
+      // Second range check
+      if (iend < startEnd) {
+        auto ret = prefetch_map_.insert(std::make_pair(
+            iend, PrefetchRange(startEnd - iend, start->second.node_id, start->second.op)));
+        assert(ret.second && "Prefetch map insert failed during range split.");
+
+        auto it = ret.first;
+        it->second.prev = start;
+        it->second.next = start->second.next;
+        start->second.next = it;
+        if (!isEndNode(it)) it->second.next->second.prev = it;
+      }
+
+      // Is the first interval of the old range valid
+      if (startBase < ibase) {
+        start->second.bytes = ibase - startBase;
+      } else {
+        if (isFirstNode(start)) {
+          start->second.op->prefetch_map_entry = start->second.next;
+          if (!isEndNode(start)) start->second.next->second.prev = prefetch_map_.end();
+        } else {
+          start->second.prev->second.next = start->second.next;
+          if (!isEndNode(start)) start->second.next->second.prev = start->second.prev;
+        }
+        start = prefetch_map_.erase(start);
+        continue;
+      }
+    }
+    start++;
+  }
+
+  // Insert new range at the head of the op's list.
+  auto ret = prefetch_map_.insert(std::make_pair(base, PrefetchRange(len, node_id, op)));
+  assert(ret.second && "Prefetch map insert failed.");
+
+  auto it = ret.first;
+  it->second.prev = prefetch_map_.end();
+  it->second.next = op->prefetch_map_entry;
+  if (op->prefetch_map_entry != prefetch_map_.end()) op->prefetch_map_entry->second.prev = it;
+  op->prefetch_map_entry = it;
+}
+
+hsa_status_t Runtime::SvmPrefetchBatch(const hsa_amd_svm_prefetch_range_t* ranges,
+                                       size_t range_count, uint32_t num_dep_signals,
+                                       const hsa_signal_t* dep_signals,
+                                       hsa_signal_t completion_signal) {
+  // Resolve the batch to disjoint spans, later ranges replacing the destination of earlier ones
+  // as if each had been prefetched in turn.  Keyed by base, value is end and node.
+  std::map<uintptr_t, std::pair<uintptr_t, uint32_t>> spans;
+  for (size_t i = 0; i < range_count; i++) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(AlignDown(ranges[i].ptr, 4096));
+    uintptr_t end = AlignUp(reinterpret_cast<uintptr_t>(ranges[i].ptr) + ranges[i].size, 4096);
+    if (base == end) continue;
+
+    Agent* dest = Agent::Convert(ranges[i].agent);
+    uint32_t node_id = (dest->device_type() == Agent::kAmdCpuDevice) ? 0 : dest->node_id();
+
+    auto it = spans.upper_bound(base);
+    if (it != spans.begin()) it--;
+    while (it != spans.end() && it->first < end) {
+      uintptr_t spanBase = it->first;
+      auto span = it->second;
+      if (span.first <= base) {
+        it++;
+        continue;
+      }
+      it = spans.erase(it);
+      if (spanBase < base) spans[spanBase] = std::make_pair(base, span.second);
+      if (end < span.first) spans[end] = span;
+    }
+    spans[base] = std::make_pair(end, node_id);
+  }
 
   PrefetchOp* op = new PrefetchOp();
   MAKE_NAMED_SCOPE_GUARD(OpGuard, [&]() { delete op; });
 
-  Agent* dest = Agent::Convert(agent);
-  if (dest->device_type() == Agent::kAmdCpuDevice)
-    op->node_id = 0;
-  else
-    op->node_id = dest->node_id();
+  // Merge touching spans with the same destination so each reaches KFD as one call.
+  for (auto& span : spans) {
+    if (!op->spans.empty()) {
+      PrefetchSpan& last = op->spans.back();
+      if ((last.node_id == span.second.second) &&
+          (reinterpret_cast<uintptr_t>(last.base) + last.size == span.first)) {
+        last.size += span.second.first - span.first;
+        continue;
+      }
+    }
+    op->spans.push_back(
+        {reinterpret_cast<void*>(span.first), span.second.first - span.first, span.second.second});
+  }
 
-  op->base = reinterpret_cast<void*>(base);
-  op->size = len;
   op->completion = completion_signal;
   if (num_dep_signals > 1) {
     op->remaining_deps = num_dep_signals - 1;
@@ -2921,64 +4935,9 @@ hsa_status_t Runtime::SvmPrefetch(void* ptr, size_t size, hsa_agent_t agent,
 
   {
     ScopedAcquire<KernelMutex> lock(&prefetch_lock_);
-    // Remove all fully overlapped and trim partially overlapped ranges.
-    // Get iteration bounds
-    auto start = prefetch_map_.upper_bound(base);
-    if (start != prefetch_map_.begin()) start--;
-    auto stop = prefetch_map_.lower_bound(end);
-
-    auto isEndNode = [&](decltype(start) node) { return node->second.next == prefetch_map_.end(); };
-    auto isFirstNode = [&](decltype(start) node) {
-      return node->second.prev == prefetch_map_.end();
-    };
-
-    // Trim and remove old ranges.
-    while (start != stop) {
-      uintptr_t startBase = start->first;
-      uintptr_t startEnd = startBase + start->second.bytes;
-
-      auto ibase = Max(startBase, base);
-      auto iend = Min(startEnd, end);
-      // Check for overlap
-      if (ibase < iend) {
-        // Second range check
-        if (iend < startEnd) {
-          auto ret = prefetch_map_.insert(
-              std::make_pair(iend, PrefetchRange(startEnd - iend, start->second.op)));
-          assert(ret.second && "Prefetch map insert failed during range split.");
-
-          auto it = ret.first;
-          it->second.prev = start;
-          it->second.next = start->second.next;
-          start->second.next = it;
-          if (!isEndNode(it)) it->second.next->second.prev = it;
-        }
-
-        // Is the first interval of the old range valid
-        if (startBase < ibase) {
-          start->second.bytes = ibase - startBase;
-        } else {
-          if (isFirstNode(start)) {
-            start->second.op->prefetch_map_entry = start->second.next;
-            if (!isEndNode(start)) start->second.next->second.prev = prefetch_map_.end();
-          } else {
-            start->second.prev->second.next = start->second.next;
-            if (!isEndNode(start)) start->second.next->second.prev = start->second.prev;
-          }
-          start = prefetch_map_.erase(start);
-          continue;
-        }
-      }
-      start++;
-    }
-
-    // Insert new range.
-    auto ret = prefetch_map_.insert(std::make_pair(base, PrefetchRange(len, op)));
-    assert(ret.second && "Prefetch map insert failed.");
-
-    auto it = ret.first;
-    op->prefetch_map_entry = it;
-    it->second.next = it->second.prev = prefetch_map_.end();
+    op->prefetch_map_entry = prefetch_map_.end();
+    for (auto& span : op->spans)
+      InsertPrefetchRange(op, reinterpret_cast<uintptr_t>(span.base), span.size, span.node_id);
   }
 
   // Remove the prefetch's ranges from the map.
@@ -3005,9 +4964,11 @@ hsa_status_t Runtime::SvmPrefetch(void* ptr, size_t size, hsa_agent_t agent,
 
     HSA_SVM_ATTRIBUTE attrib;
     attrib.type = HSA_SVM_ATTR_PREFETCH_LOC;
-    attrib.value = op->node_id;
-    HSAKMT_STATUS error = hsaKmtSVMSetAttr(op->base, op->size, 1, &attrib);
-    assert(error == HSAKMT_STATUS_SUCCESS && "KFD Prefetch failed.");
+    for (auto& span : op->spans) {
+      attrib.value = span.node_id;
+      HSAKMT_STATUS error = hsaKmtSVMSetAttr(span.base, span.size, 1, &attrib);
+      assert(error == HSAKMT_STATUS_SUCCESS && "KFD Prefetch failed.");
+    }
 
     removePrefetchRanges(op);
 
@@ -3034,6 +4995,22 @@ hsa_status_t Runtime::SvmPrefetch(void* ptr, size_t size, hsa_agent_t agent,
   return HSA_STATUS_SUCCESS;
 }
 
+hsa_status_t Runtime::MigrateAsync(void* ptr, size_t size, const MemoryRegion* region,
+                                   uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                   hsa_signal_t completion_signal) {
+  // Buffer objects keep their backing for life, only SVM ranges can be moved in place.
+  const uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + size;
+  auto owned = [&](const void* addr) {
+    return allocation_map_.FindContainingShared(
+        addr, [](const void*, size_t, const AllocationRegion&) { return true; });
+  };
+  if (owned(ptr) || owned(reinterpret_cast<const void*>(end - 1)))
+    return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+
+  return SvmPrefetch(ptr, size, region->owner()->public_handle(), num_dep_signals, dep_signals,
+                     completion_signal);
+}
+
 Agent* Runtime::GetSVMPrefetchAgent(void* ptr, size_t size) {
   uintptr_t base = reinterpret_cast<uintptr_t>(AlignDown(ptr, 4096));
   uintptr_t end = AlignUp(reinterpret_cast<uintptr_t>(ptr) + size, 4096);
@@ -3048,7 +5025,7 @@ Agent* Runtime::GetSVMPrefetchAgent(void* ptr, size_t size) {
   // KFD returns -1 for no or mixed destinations.
   uint32_t prefetch_node = -2;
   if (start != stop) {
-    prefetch_node = start->second.op->node_id;
+    prefetch_node = start->second.node_id;
   }
 
   while (start != stop) {
@@ -3060,7 +5037,7 @@ Agent* Runtime::GetSVMPrefetchAgent(void* ptr, size_t size) {
     // Check for intersection with the query
     if (ibase < iend) {
       // If prefetch locations are different then we report null agent.
-      if (prefetch_node != start->second.op->node_id) return nullptr;
+      if (prefetch_node != start->second.node_id) return nullptr;
 
       // Push leading gap to an array for checking KFD.
       if (base < ibase) holes.push_back(std::make_pair(base, ibase - base));
@@ -3090,42 +5067,97 @@ Agent* Runtime::GetSVMPrefetchAgent(void* ptr, size_t size) {
 }
 
 hsa_status_t Runtime::DmaBufExport(const void* ptr, size_t size, int* dmabuf, uint64_t* offset) {
+  return DmaBufExportRanges(&ptr, &size, 1, dmabuf, offset);
+}
+
+hsa_status_t Runtime::DmaBufExportRanges(const void* const* ptrs, const size_t* sizes,
+                                         size_t count, int* dmabuf, uint64_t* offsets) {
 #ifdef __linux__
   ScopedAcquire<KernelSharedMutex::Shared> lock(memory_lock_.shared());
-  // Lookup containing allocation.
-  auto mem = allocation_map_.upper_bound(ptr);
-  if (mem != allocation_map_.begin()) {
-    mem--;
-    if ((mem->first <= ptr) &&
-        (ptr < reinterpret_cast<const uint8_t*>(mem->first) + mem->second.size)) {
-      // Check size is in bounds.
-      if (uintptr_t(ptr) - uintptr_t(mem->first) + size <= mem->second.size) {
+  hsa_status_t ret = HSA_STATUS_ERROR_INVALID_ALLOCATION;
+  const void* alloc_base = nullptr;
+  size_t alloc_bytes = 0;
+  const Agent* owner = nullptr;
+  // Lookup the allocation containing the first range, the others must be in it too.
+  allocation_map_.FindContainingShared(
+      ptrs[0], [&](const void* base, size_t alloc_size, const AllocationRegion& mem) {
+        // Check sizes are in bounds.
+        for (size_t i = 0; i < count; i++) {
+          if ((uintptr_t(ptrs[i]) < uintptr_t(base)) ||
+              (uintptr_t(ptrs[i]) - uintptr_t(base) + sizes[i] > mem.size))
+            return true;
+        }
+
         // Check allocation is on GPU
-        if (mem->second.region->owner()->device_type() != Agent::kAmdGpuDevice)
-          return HSA_STATUS_ERROR_INVALID_AGENT;
-
-        int fd;
-        uint64_t off;
-        HSAKMT_STATUS err = hsaKmtExportDMABufHandle(const_cast<void*>(ptr), size, &fd, &off);
-        if (err == HSAKMT_STATUS_SUCCESS) {
-          *dmabuf = fd;
-          *offset = off;
-          return HSA_STATUS_SUCCESS;
+        if ((mem.region == nullptr) ||
+            (mem.region->owner()->device_type() != Agent::kAmdGpuDevice)) {
+          ret = HSA_STATUS_ERROR_INVALID_AGENT;
+          return true;
         }
 
-        assert((err != HSAKMT_STATUS_INVALID_PARAMETER) &&
-               "Thunk does not recognize an expected allocation.");
-        if (err == HSAKMT_STATUS_ERROR) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
-        return HSA_STATUS_ERROR;
-      }
+        alloc_base = base;
+        alloc_bytes = mem.size;
+        owner = mem.region->owner();
+        ret = HSA_STATUS_SUCCESS;
+        return true;
+      });
+  if (ret != HSA_STATUS_SUCCESS) return ret;
+
+  // The importer may write the memory from a CPU.
+  PinHdpFlush(owner);
+
+  // The allocation is exported once, later requests get a duplicate of that descriptor.
+  DmaBufExportEntry entry;
+  bool cached = false;
+  {
+    ScopedAcquire<KernelMutex> export_lock(&dmabuf_export_lock_);
+    auto it = dmabuf_exports_.find(alloc_base);
+    if (it != dmabuf_exports_.end()) {
+      entry = it->second;
+      cached = true;
     }
   }
-  return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+
+  if (!cached) {
+    HSAKMT_STATUS err = hsaKmtExportDMABufHandle(const_cast<void*>(alloc_base), alloc_bytes,
+                                                 &entry.fd, &entry.offset);
+    if (err != HSAKMT_STATUS_SUCCESS) {
+      assert((err != HSAKMT_STATUS_INVALID_PARAMETER) &&
+             "Thunk does not recognize an expected allocation.");
+      return (err == HSAKMT_STATUS_ERROR) ? HSA_STATUS_ERROR_OUT_OF_RESOURCES : HSA_STATUS_ERROR;
+    }
+
+    ScopedAcquire<KernelMutex> export_lock(&dmabuf_export_lock_);
+    auto inserted = dmabuf_exports_.emplace(alloc_base, entry);
+    if (!inserted.second) {
+      // Lost a race with another export of this allocation.
+      close(entry.fd);
+      entry = inserted.first->second;
+    }
+  }
+
+  int fd = fcntl(entry.fd, F_DUPFD_CLOEXEC, 0);
+  if (fd == -1) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  *dmabuf = fd;
+  for (size_t i = 0; i < count; i++)
+    offsets[i] = entry.offset + (uintptr_t(ptrs[i]) - uintptr_t(alloc_base));
+  return HSA_STATUS_SUCCESS;
 #else
   return HSA_STATUS_ERROR_NOT_INITIALIZED;
 #endif
 }
 
+void Runtime::DmaBufExportRelease(const void* base) {
+#ifdef __linux__
+  ScopedAcquire<KernelMutex> lock(&dmabuf_export_lock_);
+  auto it = dmabuf_exports_.find(base);
+  if (it == dmabuf_exports_.end()) return;
+  close(it->second.fd);
+  dmabuf_exports_.erase(it);
+#endif
+}
+
 hsa_status_t Runtime::DmaBufClose(int dmabuf) {
 #ifdef __linux__
   int err = close(dmabuf);
@@ -3144,7 +5176,7 @@ hsa_status_t Runtime::VMemoryAddressReserve(void** va, size_t size, uint64_t add
   if (!alignment)
     alignment = sysconf(_SC_PAGE_SIZE);
 
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
 
   memFlags.ui32.OnlyAddress = 1;
   memFlags.ui32.FixedAddress = 1;
@@ -3157,27 +5189,30 @@ hsa_status_t Runtime::VMemoryAddressReserve(void** va, size_t size, uint64_t add
       return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
 
-  reserved_address_map_[addr] = AddressHandle(size);
+  reserved_address_map_.Insert(addr, size, AddressHandle(size));
   *va = addr;
   return HSA_STATUS_SUCCESS;
 }
 
 hsa_status_t Runtime::VMemoryAddressFree(void* va, size_t size) {
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-  std::map<const void*, AddressHandle>::iterator it = reserved_address_map_.find(va);
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  bool found = reserved_address_map_.FindShared(va, [&](const AddressHandle& addressHandle) {
+    if (size != addressHandle.size)
+      status = HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    else if (addressHandle.use_count > 0)
+      status = HSA_STATUS_ERROR_RESOURCE_FREE;
+  });
 
-  if (it == reserved_address_map_.end()) {
+  if (!found) {
     debug_warning(false && "Can't find address in reserved address");
     return HSA_STATUS_ERROR_INVALID_ALLOCATION;
   }
-
-  if (size != it->second.size) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
-
-  if (it->second.use_count > 0) return HSA_STATUS_ERROR_RESOURCE_FREE;
+  if (status != HSA_STATUS_SUCCESS) return status;
 
   if (hsaKmtFreeMemory(va, size) != HSAKMT_STATUS_SUCCESS) return HSA_STATUS_ERROR;
 
-  reserved_address_map_.erase(it);
+  reserved_address_map_.Erase(va, nullptr);
   return HSA_STATUS_SUCCESS;
 }
 
@@ -3190,10 +5225,21 @@ hsa_status_t Runtime::VMemoryHandleCreate(const MemoryRegion* region, size_t siz
   if (!IsMultipleOf(size, memRegion->GetPageSize()))
     return HSA_STATUS_ERROR_INVALID_ARGUMENT;
 
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-  void *user_mode_driver_handle;
-  hsa_status_t status =
-      region->Allocate(size, alloc_flags, &user_mode_driver_handle, 0);
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
+  void* user_mode_driver_handle = nullptr;
+  {
+    ScopedAcquire<KernelMutex> cache_lock(&vmem_handle_cache_lock_);
+    auto it = vmem_handle_cache_.find(std::make_tuple(region, size, alloc_flags));
+    if (it != vmem_handle_cache_.end()) {
+      user_mode_driver_handle = it->second;
+      vmem_handle_cache_bytes_ -= size;
+      vmem_handle_cache_.erase(it);
+    }
+  }
+
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  if (user_mode_driver_handle == nullptr)
+    status = region->Allocate(size, alloc_flags, &user_mode_driver_handle, 0);
   if (status == HSA_STATUS_SUCCESS) {
     memory_handle_map_.emplace(std::piecewise_construct,
                                std::forward_as_tuple(user_mode_driver_handle),
@@ -3207,7 +5253,7 @@ hsa_status_t Runtime::VMemoryHandleCreate(const MemoryRegion* region, size_t siz
 }
 
 hsa_status_t Runtime::VMemoryHandleRelease(hsa_amd_vmem_alloc_handle_t memoryOnlyHandle) {
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
   auto memoryHandleIt = memory_handle_map_.find(reinterpret_cast<void*>(memoryOnlyHandle.handle));
 
   if (memoryHandleIt == memory_handle_map_.end()) {
@@ -3225,12 +5271,120 @@ hsa_status_t Runtime::VMemoryHandleRelease(hsa_amd_vmem_alloc_handle_t memoryOnl
 
     if (memoryHandleIt->second.use_count > 0) return HSA_STATUS_SUCCESS;
 
-    memoryHandleIt->second.region->Free(memoryHandleIt->first, memoryHandleIt->second.size);
+    VMemoryHandleFree(memoryHandleIt->second);
     memory_handle_map_.erase(memoryHandleIt);
   }
   return HSA_STATUS_SUCCESS;
 }
 
+void Runtime::VMemoryHandleFree(const MemoryHandle& handle) {
+  if (!handle.shared) {
+    ScopedAcquire<KernelMutex> lock(&vmem_handle_cache_lock_);
+    if (vmem_handle_cache_bytes_ + handle.size <= flag().vmem_handle_cache_size()) {
+      vmem_handle_cache_.emplace(std::make_tuple(handle.region, handle.size, handle.alloc_flag),
+                                 handle.thunk_handle);
+      vmem_handle_cache_bytes_ += handle.size;
+      return;
+    }
+  }
+  // Freed outside the cache lock, Trim takes it under agent_memory_lock_.
+  handle.region->Free(handle.thunk_handle, handle.size);
+}
+
+void Runtime::VMemoryHandleCacheTrim(const Agent* agent) {
+  ScopedAcquire<KernelMutex> lock(&vmem_handle_cache_lock_);
+  for (auto it = vmem_handle_cache_.begin(); it != vmem_handle_cache_.end();) {
+    const MemoryRegion* region = std::get<0>(it->first);
+    if (agent != nullptr && region->owner() != agent) {
+      ++it;
+      continue;
+    }
+    // Memory only handles bypass the region's allocators, release them to the driver directly
+    // since the caller may already hold agent_memory_lock_.
+    const size_t size = std::get<1>(it->first);
+    region->owner()->driver().FreeMemory(it->second, size);
+    vmem_handle_cache_bytes_ -= size;
+    it = vmem_handle_cache_.erase(it);
+  }
+}
+
+hsa_status_t Runtime::InterleavedAllocate(const std::vector<const MemoryRegion*>& regions,
+                                          size_t size, size_t granularity,
+                                          const hsa_amd_memory_access_desc_t* desc,
+                                          size_t desc_cnt, void** ptr) {
+  if (granularity == 0) granularity = 2 * 1024 * 1024;
+  for (auto region : regions) {
+    // Mapping memory handles goes through the owning GPU's render node.
+    if (region->owner()->device_type() != Agent::kAmdGpuDevice)
+      return static_cast<hsa_status_t>(HSA_STATUS_ERROR_INVALID_MEMORY_POOL);
+    if (!IsMultipleOf(granularity, static_cast<const AMD::MemoryRegion*>(region)->GetPageSize()))
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  size = AlignUp(size, granularity);
+  const size_t stripes = size / granularity;
+
+  void* va = nullptr;
+  hsa_status_t status = VMemoryAddressReserve(&va, size, 0, granularity, 0);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  std::vector<hsa_amd_vmem_map_desc_t> maps;
+  maps.reserve(stripes);
+  for (size_t i = 0; i < stripes; i++) {
+    hsa_amd_vmem_map_desc_t map;
+    map.va = reinterpret_cast<uint8_t*>(va) + i * granularity;
+    map.size = granularity;
+    map.offset = 0;
+    status = VMemoryHandleCreate(regions[i % regions.size()], granularity,
+                                 MemoryRegion::AllocateMemoryOnly, 0, &map.handle);
+    if (status != HSA_STATUS_SUCCESS) break;
+    maps.push_back(map);
+  }
+
+  bool mapped = false;
+  if (status == HSA_STATUS_SUCCESS) {
+    status = VMemoryHandleMapBatch(&maps[0], maps.size(), 0);
+    mapped = (status == HSA_STATUS_SUCCESS);
+  }
+
+  // The mappings keep their handles alive and free them when unmapped.
+  for (auto& map : maps) VMemoryHandleRelease(map.handle);
+
+  if (status == HSA_STATUS_SUCCESS) status = VMemorySetAccess(va, size, desc, desc_cnt);
+
+  if (status != HSA_STATUS_SUCCESS) {
+    if (mapped) {
+      for (auto& map : maps) VMemoryHandleUnmap(map.va, map.size);
+    }
+    VMemoryAddressFree(va, size);
+    return status;
+  }
+
+  ScopedAcquire<KernelMutex> lock(&interleaved_lock_);
+  interleaved_allocs_[va] = std::make_pair(size, granularity);
+  *ptr = va;
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t Runtime::InterleavedFree(void* ptr) {
+  size_t size, granularity;
+  {
+    ScopedAcquire<KernelMutex> lock(&interleaved_lock_);
+    auto it = interleaved_allocs_.find(ptr);
+    if (it == interleaved_allocs_.end()) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+    size = it->second.first;
+    granularity = it->second.second;
+    interleaved_allocs_.erase(it);
+  }
+
+  for (size_t offset = 0; offset < size; offset += granularity) {
+    hsa_status_t status =
+        VMemoryHandleUnmap(reinterpret_cast<uint8_t*>(ptr) + offset, granularity);
+    assert(status == HSA_STATUS_SUCCESS && "Interleaved stripe unmap failed.");
+  }
+  return VMemoryAddressFree(ptr, size);
+}
+
 __forceinline uint64_t drm_perm(hsa_access_permission_t perm) {
   switch (perm) {
     case HSA_ACCESS_PERMISSION_RO:
@@ -3268,35 +5422,49 @@ __forceinline int mmap_perm(hsa_access_permission_t perms) {
 hsa_status_t Runtime::VMemoryHandleMap(void* va, size_t size, size_t in_offset,
                                        hsa_amd_vmem_alloc_handle_t memoryOnlyHandle,
                                        uint64_t flags) {
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
+  return VMemoryHandleMapLocked(va, size, in_offset, memoryOnlyHandle, flags);
+}
+
+hsa_status_t Runtime::VMemoryHandleMapBatch(const hsa_amd_vmem_map_desc_t* maps, size_t map_cnt,
+                                            uint64_t flags) {
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
+  for (size_t i = 0; i < map_cnt; i++) {
+    hsa_status_t status =
+        VMemoryHandleMapLocked(maps[i].va, maps[i].size, maps[i].offset, maps[i].handle, flags);
+    if (status != HSA_STATUS_SUCCESS) {
+      // Leave nothing of the batch mapped.
+      while (i-- > 0) VMemoryHandleUnmapLocked(maps[i].va, maps[i].size);
+      return status;
+    }
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+// Note: VMemoryHandleMapLocked should be called with &vmem_lock_ held
+hsa_status_t Runtime::VMemoryHandleMapLocked(void* va, size_t size, size_t in_offset,
+                                             hsa_amd_vmem_alloc_handle_t memoryOnlyHandle,
+                                             uint64_t flags) {
   int drm_fd, dmabuf_fd = 0;
   uint64_t offset = 0, ret;
   uint64_t drm_cpu_addr = 0;
   amdgpu_bo_handle ldrm_bo = 0;
-  bool reservedAddressFound = false;
+  AddressHandle* addressHandle = nullptr;
 
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-  auto reservedAddressIt = reserved_address_map_.upper_bound(va);
-  if (reservedAddressIt != reserved_address_map_.begin()) {
-    reservedAddressIt--;
-    if ((reservedAddressIt->first <= va) &&
-        ((reinterpret_cast<uint8_t*>(va) + size) <=
-         (reinterpret_cast<const uint8_t*>(reservedAddressIt->first) + reservedAddressIt->second.size))) {
-      reservedAddressFound = true;
-    }
-  }
-  if (!reservedAddressFound) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  if (va == nullptr || size == 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  reserved_address_map_.FindContaining(
+      va, [&](const void* base, size_t base_size, AddressHandle& reserved) {
+        if ((reinterpret_cast<uint8_t*>(va) + size) >
+            (reinterpret_cast<const uint8_t*>(base) + base_size))
+          return false;
+        addressHandle = &reserved;
+        return true;
+      });
+  if (addressHandle == nullptr) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
 
   /* Confirm that this VA range has not been mapped yet */
-  auto upperMappedHandleIt = mapped_handle_map_.upper_bound(va);
-  if (upperMappedHandleIt != mapped_handle_map_.begin()) {
-    upperMappedHandleIt--;
-    if ((reinterpret_cast<const uint8_t*>(upperMappedHandleIt->first) + upperMappedHandleIt->second.size) > va)
-      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
-  }
-  auto lowerMappedHandleIt = mapped_handle_map_.lower_bound(va);
-  if (lowerMappedHandleIt != mapped_handle_map_.end()) {
-    if (reinterpret_cast<uint8_t*>(va) + size > lowerMappedHandleIt->first) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
-  }
+  if (mapped_handle_map_.Overlaps(va, size)) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
 
   auto memoryHandleIt = memory_handle_map_.find(reinterpret_cast<void*>(memoryOnlyHandle.handle));
   if (memoryHandleIt == memory_handle_map_.end()) {
@@ -3311,68 +5479,81 @@ hsa_status_t Runtime::VMemoryHandleMap(void* va, size_t size, size_t in_offset,
   AMD::GpuAgent* agent = static_cast<AMD::GpuAgent*>(memoryHandleIt->second.agentOwner());
   amdgpu_bo_import_result res;
   ret = amdgpu_bo_import(agent->libDrmDev(), amdgpu_bo_handle_type_dma_buf_fd, dmabuf_fd, &res);
-  if (ret) return HSA_STATUS_ERROR;
-
   close(dmabuf_fd);
+  if (ret) return HSA_STATUS_ERROR;
 
   ldrm_bo = res.buf_handle;
   ret = GetAmdgpuDeviceArgs(agent, ldrm_bo, &drm_fd, &drm_cpu_addr);
   if (ret) return HSA_STATUS_ERROR;
 
-  mapped_handle_map_.emplace(std::piecewise_construct,
-          std::forward_as_tuple(va),
-          std::forward_as_tuple(&memoryHandleIt->second, &reservedAddressIt->second, offset, size, drm_fd,
-                   reinterpret_cast<void*>(drm_cpu_addr), HSA_ACCESS_PERMISSION_NONE, ldrm_bo));
+  mapped_handle_map_.Insert(va, size,
+                            MappedHandle(&memoryHandleIt->second, addressHandle, offset, size,
+                                         drm_fd, reinterpret_cast<void*>(drm_cpu_addr),
+                                         HSA_ACCESS_PERMISSION_NONE, ldrm_bo));
 
-  reservedAddressIt->second.use_count++;
+  addressHandle->use_count++;
   memoryHandleIt->second.use_count++;
 
   return HSA_STATUS_SUCCESS;
 }
 
 hsa_status_t Runtime::VMemoryHandleUnmap(void* va, size_t size) {
-  int ret;
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
+  return VMemoryHandleUnmapLocked(va, size);
+}
+
+// Note: VMemoryHandleUnmapLocked should be called with &vmem_lock_ held
+hsa_status_t Runtime::VMemoryHandleUnmapLocked(void* va, size_t size) {
+  hsa_status_t status = HSA_STATUS_ERROR_INVALID_ALLOCATION;
+  MemoryHandle* memoryHandle = nullptr;
 
-  auto mappedHandleIt = mapped_handle_map_.find(va);
-  if (mappedHandleIt == mapped_handle_map_.end()) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+  // Concurrent lookups of this range wait on its shard until the mapping is torn down.
+  mapped_handle_map_.Find(va, [&](MappedHandle& mappedHandle) {
+    int ret;
+
+    if (mappedHandle.size != size) {
+      status = HSA_STATUS_ERROR_INVALID_ARGUMENT;
+      return;
+    }
 
-  if (mappedHandleIt->second.size != size) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    status = HSA_STATUS_ERROR;
+    for (auto agentPermsIt = mappedHandle.allowed_agents.begin();
+         agentPermsIt != mappedHandle.allowed_agents.end();) {
+      assert(va == agentPermsIt->second.va);
+      if (agentPermsIt->second.ldrm_bo)
+        ret = amdgpu_bo_va_op(agentPermsIt->second.ldrm_bo, mappedHandle.offset, size,
+                              reinterpret_cast<uint64_t>(va), 0, AMDGPU_VA_OP_UNMAP);
+      else
+        ret = munmap(va, size);
+      if (ret) return;
+      agentPermsIt = mappedHandle.allowed_agents.erase(agentPermsIt);
+    }
 
-  for (auto agentPermsIt = mappedHandleIt->second.allowed_agents.begin();
-       agentPermsIt != mappedHandleIt->second.allowed_agents.end();) {
-    assert(va == agentPermsIt->second.va);
-    if (agentPermsIt->second.ldrm_bo)
-      ret = amdgpu_bo_va_op(agentPermsIt->second.ldrm_bo, mappedHandleIt->second.offset, size,
-                            reinterpret_cast<uint64_t>(va), 0, AMDGPU_VA_OP_UNMAP);
+    if (mappedHandle.ldrm_bo)
+      ret = amdgpu_bo_free(mappedHandle.ldrm_bo);
     else
       ret = munmap(va, size);
-    if (ret) return HSA_STATUS_ERROR;
-    agentPermsIt = mappedHandleIt->second.allowed_agents.erase(agentPermsIt);
-  }
 
-  if (mappedHandleIt->second.ldrm_bo)
-    ret = amdgpu_bo_free(mappedHandleIt->second.ldrm_bo);
-  else
-    ret = munmap(va, size);
+    if (ret) return;
 
-  if (ret) return HSA_STATUS_ERROR;
+    assert(mappedHandle.address_handle->use_count >= 1);
+    mappedHandle.address_handle->use_count--;
+    assert(mappedHandle.mem_handle->use_count >= 1);
+    mappedHandle.mem_handle->use_count--;
+
+    memoryHandle = mappedHandle.mem_handle;
+    status = HSA_STATUS_SUCCESS;
+  });
+  if (status != HSA_STATUS_SUCCESS) return status;
 
-  assert(mappedHandleIt->second.address_handle->use_count >= 1);
-  mappedHandleIt->second.address_handle->use_count--;
-  assert(mappedHandleIt->second.mem_handle->use_count >= 1);
-  mappedHandleIt->second.mem_handle->use_count--;
+  mapped_handle_map_.Erase(va, nullptr);
 
-  if (!mappedHandleIt->second.mem_handle->use_count &&
-      !mappedHandleIt->second.mem_handle->ref_count) {
+  if (!memoryHandle->use_count && !memoryHandle->ref_count) {
     // User called VMemoryHandleRelease while this mapping was still outstanding. We need to delete
     // the MemoryHandle as is the last MappedHandle that was using it
-    mappedHandleIt->second.mem_handle->region->Free(mappedHandleIt->second.mem_handle->thunk_handle,
-                                                    mappedHandleIt->second.mem_handle->size);
-    memory_handle_map_.erase(mappedHandleIt->second.mem_handle->thunk_handle);
+    VMemoryHandleFree(*memoryHandle);
+    memory_handle_map_.erase(memoryHandle->thunk_handle);
   }
-
-  mapped_handle_map_.erase(mappedHandleIt);
   return HSA_STATUS_SUCCESS;
 }
 
@@ -3422,8 +5603,11 @@ hsa_status_t Runtime::MappedHandleAllowedAgent::EnableAccess(hsa_access_permissi
   } else { // GPU Memory
     int ret;
     if (!ldrm_bo) return HSA_STATUS_ERROR;
+    uint64_t drm_flags = drm_perm(perms);
+    if (mappedHandle->mem_handle->alloc_flag & core::MemoryRegion::AllocateExecutable)
+      drm_flags |= AMDGPU_VM_PAGE_EXECUTABLE;
     ret = amdgpu_bo_va_op(ldrm_bo, mappedHandle->offset, mappedHandle->size,
-                          reinterpret_cast<uint64_t>(va), drm_perm(perms), AMDGPU_VA_OP_MAP);
+                          reinterpret_cast<uint64_t>(va), drm_flags, AMDGPU_VA_OP_MAP);
     if (ret) return HSA_STATUS_ERROR;
   }
   permissions = perms;
@@ -3442,7 +5626,8 @@ hsa_status_t Runtime::MappedHandleAllowedAgent::RemoveAccess() {
   return (ret) ? HSA_STATUS_ERROR : HSA_STATUS_SUCCESS;
 }
 
-// Note: VMemorySetAccessPerHandle should be called with &memory_lock_ held
+// Note: VMemorySetAccessPerHandle should be called with &vmem_lock_ held and the handle's shard
+// locked
 hsa_status_t
 Runtime::VMemorySetAccessPerHandle(void *va, MappedHandle &mappedHandle,
                                    const hsa_amd_memory_access_desc_t *desc,
@@ -3450,6 +5635,11 @@ Runtime::VMemorySetAccessPerHandle(void *va, MappedHandle &mappedHandle,
   for (int i = 0; i < desc_cnt; i++) {
     Agent *targetAgent = Agent::Convert(desc[i].agent_handle);
 
+    // Mappings are remapped freely, so CPU access to a handle is not counted per allocation.
+    if (targetAgent->device_type() == Agent::kAmdCpuDevice &&
+        desc[i].permissions != HSA_ACCESS_PERMISSION_NONE)
+      PinHdpFlush(mappedHandle.agentOwner());
+
     const size_t &size = mappedHandle.size;
     const hsa_access_permission_t &perm = desc[i].permissions;
 
@@ -3486,8 +5676,14 @@ Runtime::VMemorySetAccessPerHandle(void *va, MappedHandle &mappedHandle,
 hsa_status_t Runtime::VMemorySetAccess(void* va, size_t size,
                                        const hsa_amd_memory_access_desc_t* desc,
                                        const size_t desc_cnt) {
-  std::list<std::pair<void*, MappedHandle*>> mappedHandles;
-  bool reservedAddressFound = false;
+  const hsa_amd_vmem_range_t range = {va, size};
+  return VMemorySetAccessBatch(&range, 1, desc, desc_cnt);
+}
+
+hsa_status_t Runtime::VMemorySetAccessBatch(const hsa_amd_vmem_range_t* ranges, size_t range_cnt,
+                                            const hsa_amd_memory_access_desc_t* desc,
+                                            const size_t desc_cnt) {
+  std::vector<void*> mappedHandles;
 
   // Validate all agents
   for (int i = 0; i < desc_cnt; i++) {
@@ -3496,43 +5692,46 @@ hsa_status_t Runtime::VMemorySetAccess(void* va, size_t size,
     if (targetAgent == NULL || !targetAgent->IsValid()) return HSA_STATUS_ERROR_INVALID_AGENT;
   }
 
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
-
-  auto reservedAddressIt = reserved_address_map_.upper_bound(va);
-  if (reservedAddressIt != reserved_address_map_.begin()) {
-    reservedAddressIt--;
-    if ((reservedAddressIt->first <= va) &&
-        ((reinterpret_cast<uint8_t*>(va) + size) <=
-         (reinterpret_cast<const uint8_t*>(reservedAddressIt->first) +
-          reservedAddressIt->second.size))) {
-      reservedAddressFound = true;
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
+
+  for (size_t r = 0; r < range_cnt; r++) {
+    void* va = ranges[r].va;
+    size_t size = ranges[r].size;
+
+    bool reservedAddressFound = reserved_address_map_.FindContainingShared(
+        va, [&](const void* base, size_t base_size, const AddressHandle&) {
+          return (reinterpret_cast<uint8_t*>(va) + size) <=
+              (reinterpret_cast<const uint8_t*>(base) + base_size);
+        });
+    if (!reservedAddressFound) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+    // va + size may consist of multiple MappedHandle's. Build a list lf MappedHandles within this
+    // VA range
+    uint8_t* va_chunk = reinterpret_cast<uint8_t*>(va);
+    while (va_chunk < reinterpret_cast<uint8_t*>(va) + size) {
+      size_t chunk_size = 0;
+      // Cannot find a contiguous list of MappedHandles for the full VA range
+      if (!mapped_handle_map_.FindShared(
+              va_chunk, [&](const MappedHandle& mappedHandle) { chunk_size = mappedHandle.size; }))
+        return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+
+      mappedHandles.push_back(va_chunk);
+      va_chunk += chunk_size;
     }
   }
-  if (!reservedAddressFound) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
-
-  // va + size may consist of multiple MappedHandle's. Build a list lf MappedHandles within this VA
-  // range
-  uint8_t* va_chunk = reinterpret_cast<uint8_t*>(va);
-  while (va_chunk < reinterpret_cast<uint8_t*>(va) + size) {
-    auto mappedHandleIt = mapped_handle_map_.find(va_chunk);
-    // Cannot find a contiguous list of MappedHandles for the full VA range
-    if (mappedHandleIt == mapped_handle_map_.end()) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
-
-    mappedHandles.push_back(std::make_pair(va_chunk, &mappedHandleIt->second));
-    va_chunk += mappedHandleIt->second.size;
-  }
 
-  hsa_status_t status;
-  for (auto mappedHandleIt : mappedHandles) {
-    status = VMemorySetAccessPerHandle(mappedHandleIt.first,
-                                       *mappedHandleIt.second, desc, desc_cnt);
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  for (void* va_chunk : mappedHandles) {
+    mapped_handle_map_.Find(va_chunk, [&](MappedHandle& mappedHandle) {
+      status = VMemorySetAccessPerHandle(va_chunk, mappedHandle, desc, desc_cnt);
+    });
     if (status != HSA_STATUS_SUCCESS)
       return status;
   }
   return HSA_STATUS_SUCCESS;
 }
 
-// Note: VMemoryMapAllowAccess should be called with &memory_lock_ held
+// Note: VMemoryMapAllowAccess should be called with &vmem_lock_ held
 hsa_status_t Runtime::VMemoryMapAllowAccess(const void *va,
                                             const hsa_access_permission_t perm,
                                             const hsa_agent_t *agents,
@@ -3552,37 +5751,36 @@ hsa_status_t Runtime::VMemoryMapAllowAccess(const void *va,
     desc[i].agent_handle = agents[i];
   }
 
-  std::list<std::pair<void *, MappedHandle *>> mappedHandles;
-
-  auto mappedHandleIt = mapped_handle_map_.upper_bound(va);
-  if (mappedHandleIt != mapped_handle_map_.begin()) {
-    mappedHandleIt--;
-
-    if ((reinterpret_cast<const uint8_t *>(mappedHandleIt->first) +
-         mappedHandleIt->second.size) > va) {
-      // We found a mapped handle. See if there are more contiguous mapped
-      // handles and add them to the list
-
-      uint8_t *va_chunk = (uint8_t *)mappedHandleIt->first;
-      do {
-        mappedHandles.push_back(
-            std::make_pair(va_chunk, &mappedHandleIt->second));
-        va_chunk += mappedHandleIt->second.size;
-
-        mappedHandleIt++;
-        if (mappedHandleIt == mapped_handle_map_.end())
-          break;
-      } while (va_chunk == mappedHandleIt->first);
-    }
+  std::vector<void *> mappedHandles;
+
+  uint8_t *va_chunk = nullptr;
+  size_t chunk_size = 0;
+  mapped_handle_map_.FindContainingShared(
+      va, [&](const void *base, size_t size, const MappedHandle &) {
+        va_chunk = (uint8_t *)base;
+        chunk_size = size;
+        return true;
+      });
+
+  // We found a mapped handle. See if there are more contiguous mapped
+  // handles and add them to the list
+  while (va_chunk != nullptr) {
+    mappedHandles.push_back(va_chunk);
+    va_chunk += chunk_size;
+    if (!mapped_handle_map_.FindShared(va_chunk, [&](const MappedHandle &mappedHandle) {
+          chunk_size = mappedHandle.size;
+        }))
+      break;
   }
 
   if (mappedHandles.empty())
     return HSA_STATUS_ERROR_INVALID_ALLOCATION;
 
-  hsa_status_t status;
-  for (auto mappedHandleIt : mappedHandles) {
-    status = VMemorySetAccessPerHandle(
-        mappedHandleIt.first, *mappedHandleIt.second, desc, num_agents);
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  for (void *chunk : mappedHandles) {
+    mapped_handle_map_.Find(chunk, [&](MappedHandle &mappedHandle) {
+      status = VMemorySetAccessPerHandle(chunk, mappedHandle, desc, num_agents);
+    });
     if (status != HSA_STATUS_SUCCESS)
       return status;
   }
@@ -3592,33 +5790,24 @@ hsa_status_t Runtime::VMemoryMapAllowAccess(const void *va,
 hsa_status_t Runtime::VMemoryGetAccess(const void* va, hsa_access_permission_t* perms,
                                        hsa_agent_t agent_handle) {
   *perms = HSA_ACCESS_PERMISSION_NONE;
-  bool mappedHandleFound = false;
-
-  ScopedAcquire<KernelSharedMutex> lock(&memory_lock_);
+  hsa_access_permission_t allowed = HSA_ACCESS_PERMISSION_NONE;
+  Agent* agent = Agent::Convert(agent_handle);
 
-  auto mappedHandleIt = mapped_handle_map_.upper_bound(va);
-  if (mappedHandleIt != mapped_handle_map_.begin()) {
-    mappedHandleIt--;
-    if ((mappedHandleIt->first <= va) &&
-        reinterpret_cast<const uint8_t*>(va) <=
-         (reinterpret_cast<const uint8_t*>(mappedHandleIt->first) + mappedHandleIt->second.size)) {
-      mappedHandleFound = true;
-    }
-  }
+  // Lock free with respect to vmem_lock_, only the shard holding va is locked shared.
+  bool mappedHandleFound = mapped_handle_map_.FindContainingShared(
+      va, [&](const void*, size_t, const MappedHandle& mappedHandle) {
+        auto agentPermsIt = mappedHandle.allowed_agents.find(agent);
+        if (agentPermsIt != mappedHandle.allowed_agents.end())
+          allowed = agentPermsIt->second.permissions;
+        return true;
+      });
   if (!mappedHandleFound) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
 
-  Agent* agent = Agent::Convert(agent_handle);
   if (agent == NULL || !agent->IsValid() || agent->device_type() != core::Agent::kAmdGpuDevice)
     return HSA_STATUS_ERROR_INVALID_AGENT;
 
-  auto agentPermsIt = mappedHandleIt->second.allowed_agents.find(agent);
-  if (agentPermsIt != mappedHandleIt->second.allowed_agents.end()) {
-    *perms = agentPermsIt->second.permissions;
-    return HSA_STATUS_SUCCESS;
-  }
-
-  /* Set access was not called on this memory handle */
-  *perms = HSA_ACCESS_PERMISSION_NONE;
+  /* NONE if set access was not called on this memory handle */
+  *perms = allowed;
   return HSA_STATUS_SUCCESS;
 }
 
@@ -3626,6 +5815,7 @@ hsa_status_t Runtime::VMemoryExportShareableHandle(int* dmabuf_fd,
                                                    hsa_amd_vmem_alloc_handle_t handle,
                                                    uint64_t flags) {
   *dmabuf_fd = -1;
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
   auto memoryHandle = memory_handle_map_.find((void*)handle.handle);
   if (memoryHandle == memory_handle_map_.end()) {
     debug_warning(false && "Can't find memory handle");
@@ -3637,7 +5827,10 @@ hsa_status_t Runtime::VMemoryExportShareableHandle(int* dmabuf_fd,
   ret = hsaKmtExportDMABufHandle(memoryHandle->second.thunk_handle, memoryHandle->second.size,
                                  dmabuf_fd, &offset);
   if (ret != HSAKMT_STATUS_SUCCESS) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  PinHdpFlush(memoryHandle->second.agentOwner());
 
+  // Another process may still reference the memory, never hand it out again.
+  memoryHandle->second.shared = true;
   return HSA_STATUS_SUCCESS;
 }
 
@@ -3678,7 +5871,7 @@ hsa_status_t Runtime::VMemoryImportShareableHandle(int dmabuf_fd,
   size_t size = info.SizeInBytes;
   int gpuid = info.NodeId;
 
-
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
   auto memoryHandleIt = memory_handle_map_.find(thunk_handle);
   if (memoryHandleIt != memory_handle_map_.end()) {
     /* This handle was already imported, increment ref_count and return */
@@ -3699,20 +5892,24 @@ hsa_status_t Runtime::VMemoryImportShareableHandle(int dmabuf_fd,
   MemoryRegion::AllocateFlags alloc_flag = core::MemoryRegion::AllocateNoFlags;
   if (ptrInfo.MemFlags.ui32.NoSubstitute) alloc_flag |= core::MemoryRegion::AllocatePinned;
 
-  memory_handle_map_.emplace(std::piecewise_construct,
+  auto imported = memory_handle_map_.emplace(std::piecewise_construct,
           std::forward_as_tuple(thunk_handle),
           std::forward_as_tuple(region, size, 0, thunk_handle, alloc_flag));
+  imported.first->second.shared = true;
   *memoryOnlyHandle = MemoryHandle::Convert(thunk_handle);
+  PinHdpFlush(region->owner());
 
   return HSA_STATUS_SUCCESS;
 }
 
 hsa_status_t Runtime::VMemoryRetainAllocHandle(hsa_amd_vmem_alloc_handle_t* mapped_handle,
                                                void* va) {
-  auto mappedHandleIt = mapped_handle_map_.find(va);
-  if (mappedHandleIt == mapped_handle_map_.end()) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
+  MemoryHandle* memoryHandle = nullptr;
+  if (!mapped_handle_map_.FindShared(
+          va, [&](const MappedHandle& mappedHandle) { memoryHandle = mappedHandle.mem_handle; }))
+    return HSA_STATUS_ERROR_INVALID_ALLOCATION;
 
-  MemoryHandle* memoryHandle = mappedHandleIt->second.mem_handle;
   memoryHandle->ref_count++;
   *mapped_handle = MemoryHandle::Convert(memoryHandle->thunk_handle);
 
@@ -3722,6 +5919,7 @@ hsa_status_t Runtime::VMemoryRetainAllocHandle(hsa_amd_vmem_alloc_handle_t* mapp
 hsa_status_t Runtime::VMemoryGetAllocPropertiesFromHandle(hsa_amd_vmem_alloc_handle_t allocHandle,
                                                           const core::MemoryRegion** mem_region,
                                                           hsa_amd_memory_type_t* type) {
+  ScopedAcquire<KernelMutex> lock(&vmem_lock_);
   auto memoryHandleIt = memory_handle_map_.find(reinterpret_cast<void*>(allocHandle.handle));
   if (memoryHandleIt == memory_handle_map_.end()) return HSA_STATUS_ERROR_INVALID_ALLOCATION;
 
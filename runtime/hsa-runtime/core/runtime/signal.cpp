@@ -48,6 +48,10 @@
 #include <algorithm>
 #include "core/util/timer.h"
 #include "core/inc/runtime.h"
+#include "core/inc/blit.h"
+#include "core/inc/default_signal.h"
+#include "core/inc/interrupt_signal.h"
+#include "core/util/os.h"
 
 namespace rocr {
 namespace core {
@@ -55,21 +59,59 @@ namespace core {
 KernelMutex Signal::ipcLock_;
 std::map<decltype(hsa_signal_t::handle), Signal*> Signal::ipcMap_;
 
+std::atomic<uint64_t> SharedSignalPool_t::live_epoch_(0);
+
+EventWaitMux::Slot EventWaitMux::slots_[EventWaitMux::kSlotCount] = {};
+
+SharedSignalPool_t::magazine_t& SharedSignalPool_t::magazine() {
+  static thread_local magazine_t cache;
+  return cache;
+}
+
+void SharedSignalPool_t::NewEpoch() {
+  static std::atomic<uint64_t> epoch_source(0);
+  epoch_ = ++epoch_source;
+  live_epoch_.store(epoch_, std::memory_order_release);
+}
+
+void SharedSignalPool_t::ReturnBatch(void* pool, SharedSignal** items, uint32_t count) {
+  SharedSignalPool_t* self = reinterpret_cast<SharedSignalPool_t*>(pool);
+  ScopedAcquire<HybridMutex> lock(&self->lock_);
+  self->free_list_.insert(self->free_list_.end(), items, items + count);
+}
+
 void SharedSignalPool_t::clear() {
+  magazine().Drain();
+
   ifdebug {
     size_t capacity = 0;
     for (auto& block : block_list_) capacity += block.second;
     if (capacity != free_list_.size())
-      debug_print("Warning: Resource leak detected by SharedSignalPool, %ld Signals leaked.\n",
-                  capacity - free_list_.size());
+      debug_print(
+          "Warning: Resource leak detected by SharedSignalPool, %ld Signals leaked or held in "
+          "thread caches.\n",
+          capacity - free_list_.size());
   }
 
   for (auto& block : block_list_) free_()(block.first);
   block_list_.clear();
   free_list_.clear();
+
+  // Invalidate signals cached by other threads, their storage was just released.
+  NewEpoch();
 }
 
 SharedSignal* SharedSignalPool_t::alloc() {
+  magazine_t& cache = magazine();
+  cache.Attach(this, epoch_, &live_epoch_, ReturnBatch);
+
+  SharedSignal* ret = cache.Pop();
+  if (ret == nullptr) ret = Refill(cache);
+  new (ret) SharedSignal();
+  return ret;
+}
+
+SharedSignal* SharedSignalPool_t::Refill(magazine_t& cache) {
   ScopedAcquire<HybridMutex> lock(&lock_);
   if (free_list_.empty()) {
     SharedSignal* block = reinterpret_cast<SharedSignal*>(
@@ -94,8 +136,14 @@ SharedSignal* SharedSignalPool_t::alloc() {
   }
 
   SharedSignal* ret = free_list_.back();
-  new (ret) SharedSignal();
   free_list_.pop_back();
+
+  // Move a batch into the calling thread's magazine for subsequent allocations.
+  uint32_t count = Min<size_t>(kMagazineBatch, free_list_.size());
+  SharedSignal** dst = cache.Reserve(count);
+  std::copy(free_list_.end() - count, free_list_.end(), dst);
+  free_list_.resize(free_list_.size() - count);
+  cache.Commit(count);
   return ret;
 }
 
@@ -103,9 +151,9 @@ void SharedSignalPool_t::free(SharedSignal* ptr) {
   if (ptr == nullptr) return;
 
   ptr->~SharedSignal();
-  ScopedAcquire<HybridMutex> lock(&lock_);
 
   ifdebug {
+    ScopedAcquire<HybridMutex> lock(&lock_);
     bool valid = false;
     for (auto& block : block_list_) {
       if ((block.first <= ptr) &&
@@ -117,7 +165,18 @@ void SharedSignalPool_t::free(SharedSignal* ptr) {
     assert(valid && "Object does not belong to pool.");
   }
 
-  free_list_.push_back(ptr);
+  magazine_t& cache = magazine();
+  cache.Attach(this, epoch_, &live_epoch_, ReturnBatch);
+  if (cache.Push(ptr)) return;
+
+  // Magazine is full, return a batch to the shared list.
+  uint32_t count = kMagazineBatch;
+  SharedSignal** items = cache.Take(count);
+  {
+    ScopedAcquire<HybridMutex> lock(&lock_);
+    free_list_.insert(free_list_.end(), items, items + count);
+  }
+  cache.Push(ptr);
 }
 
 LocalSignal::LocalSignal(hsa_signal_value_t initial_value, bool exportable)
@@ -177,6 +236,82 @@ Signal::~Signal() {
   }
 }
 
+bool Signal::DeferInterrupt(Blit* blit) {
+  Blit* expected = nullptr;
+  if (!deferred_interrupt_.compare_exchange_strong(expected, blit) && expected != blit)
+    return false;
+  // A waiter that raised waiting_ before the mark was published may not have seen it, so it will
+  // sleep without flushing.  Take the mark back and send the interrupt instead.  Waiters raise
+  // waiting_ before checking the mark, so one of the two sides always observes the other.
+  if (InWaiting()) {
+    expected = blit;
+    deferred_interrupt_.compare_exchange_strong(expected, nullptr);
+    return false;
+  }
+  return true;
+}
+
+void Signal::FlushDeferredInterrupt() {
+  if (deferred_interrupt_.load(std::memory_order_relaxed) == nullptr) return;
+  Blit* blit = deferred_interrupt_.exchange(nullptr);
+  if (blit != nullptr) blit->SubmitInterrupt(*this);
+}
+
+timer::fast_clock::duration Signal::SpinBudget(timer::fast_clock::duration fixed) const {
+  uint32_t policy = wait_policy_.load(std::memory_order_relaxed);
+  if (policy == HSA_AMD_SIGNAL_WAIT_POLICY_DEFAULT)
+    policy = Runtime::runtime_singleton_->flag().adaptive_signal_wait()
+        ? HSA_AMD_SIGNAL_WAIT_POLICY_ADAPTIVE
+        : HSA_AMD_SIGNAL_WAIT_POLICY_FIXED;
+  if (policy != HSA_AMD_SIGNAL_WAIT_POLICY_ADAPTIVE) return fixed;
+
+  uint64_t latency = wait_latency_ns_.load(std::memory_order_relaxed);
+  if (latency == 0) return fixed;
+
+  // Poll for twice the typical latency so most completions are caught without a sleep.  Waits
+  // which usually outlast the ceiling gain nothing from polling, so sleep at once.
+  const std::chrono::nanoseconds kMinSpin = std::chrono::microseconds(5);
+  const std::chrono::nanoseconds kMaxSpin = std::chrono::milliseconds(1);
+  std::chrono::nanoseconds spin(latency * 2);
+  if (spin > kMaxSpin) return timer::fast_clock::duration(0);
+  return std::max(spin, kMinSpin);
+}
+
+void Signal::RecordWaitLatency(timer::fast_clock::duration elapsed) {
+  uint64_t sample = timer::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  sample = std::max<uint64_t>(sample, 1);
+  // Racing updates may drop a sample, which only slows convergence.
+  uint64_t avg = wait_latency_ns_.load(std::memory_order_relaxed);
+  avg = (avg == 0) ? sample : avg - avg / 8 + sample / 8;
+  wait_latency_ns_.store(std::max<uint64_t>(avg, 1), std::memory_order_relaxed);
+}
+
+bool EventWaitMux::Wait(HsaEvent* event, uint32_t generation, uint32_t wait_ms,
+                        uint64_t* event_age, bool lead) {
+  Slot& slot = SlotOf(event);
+  HsaEvent* none = nullptr;
+  if (lead && slot.sleeper.compare_exchange_strong(none, event, std::memory_order_acq_rel)) {
+    if (slot.generation.load(std::memory_order_acquire) == generation)
+      hsaKmtWaitOnEvent_Ext(event, wait_ms, event_age);
+    // Always advance, followers may have joined after generation moved on.
+    slot.sleeper.store(nullptr, std::memory_order_relaxed);
+    slot.generation.fetch_add(1, std::memory_order_acq_rel);
+    os::FutexWake(&slot.generation, true);
+    return true;
+  }
+
+  if (slot.sleeper.load(std::memory_order_acquire) == event) {
+    os::FutexWait(&slot.generation, generation, wait_ms);
+    return true;
+  }
+
+  // The slot is busy with another event.  A leader is allowed to consume event, so it may still
+  // sleep in the driver.
+  if (!lead) return false;
+  hsaKmtWaitOnEvent_Ext(event, wait_ms, event_age);
+  return true;
+}
+
 uint32_t Signal::WaitAny(uint32_t signal_count, const hsa_signal_t* hsa_signals,
                          const hsa_signal_condition_t* conds, const hsa_signal_value_t* values,
                          uint64_t timeout, hsa_wait_state_t wait_hint,
@@ -197,10 +332,10 @@ uint32_t Signal::WaitAny(uint32_t signal_count, const hsa_signal_t* hsa_signals,
     for (uint32_t i = 0; i < signal_count; i++) signals[i]->waiting_--;
   });
 
-  if (!core::Runtime::runtime_singleton_->KfdVersion().supports_event_age)
-      // Allow only the first waiter to sleep. Without event age tracking,
-      // race condition can cause some threads to sleep without wakeup since missing interrupt.
-      if (prior != 0) wait_hint = HSA_WAIT_STATE_ACTIVE;
+  // Allow only the first waiter to consume events. Without event age tracking,
+  // race condition can cause some threads to sleep without wakeup since missing interrupt.
+  const bool lead =
+      core::Runtime::runtime_singleton_->KfdVersion().supports_event_age || (prior == 0);
 
   // Ensure that all signals in the list can be slept on.
   if (wait_hint != HSA_WAIT_STATE_ACTIVE) {
@@ -226,6 +361,10 @@ uint32_t Signal::WaitAny(uint32_t signal_count, const hsa_signal_t* hsa_signals,
     std::sort(evts, evts + signal_count);
     HsaEvent** end = std::unique(evts, evts + signal_count);
     unique_evts = uint32_t(end - evts);
+
+    // A single event is shared with other waiters through EventWaitMux, later waiters on
+    // several events must poll.
+    if (!lead && (unique_evts != 1)) wait_hint = HSA_WAIT_STATE_ACTIVE;
   }
   MAKE_SCOPE_GUARD([&]() {
     if (signal_count > small_size) delete[] evts;
@@ -253,6 +392,8 @@ uint32_t Signal::WaitAny(uint32_t signal_count, const hsa_signal_t* hsa_signals,
 
   bool condition_met = false;
   while (true) {
+    const uint32_t generation = (unique_evts == 1) ? EventWaitMux::Generation(evts[0]) : 0;
+
     // Cannot mwaitx - polling multiple signals
     for (uint32_t i = 0; i < signal_count; i++) {
       if (!signals[i]->IsValid())
@@ -306,6 +447,11 @@ uint32_t Signal::WaitAny(uint32_t signal_count, const hsa_signal_t* hsa_signals,
     uint64_t ct=timer::duration_cast<std::chrono::milliseconds>(
       time_remaining).count();
     wait_ms = (ct>0xFFFFFFFEu) ? 0xFFFFFFFEu : ct;
+    for (uint32_t i = 0; i < signal_count; i++) signals[i]->FlushDeferredInterrupt();
+    if (unique_evts == 1) {
+      EventWaitMux::Wait(evts[0], generation, wait_ms, event_age, lead);
+      continue;
+    }
     hsaKmtWaitOnMultipleEvents_Ext(evts, unique_evts, false, wait_ms, event_age);
   }
 }
@@ -411,6 +557,7 @@ uint32_t Signal::WaitAnyExceptions(uint32_t signal_count, const hsa_signal_t* hs
       }
     }
 
+    for (uint32_t i = 0; i < signal_count; i++) signals[i]->FlushDeferredInterrupt();
     hsaKmtWaitOnMultipleEvents_Ext(evts, unique_evts, false, wait_ms, event_age);
   } //while
 }
@@ -426,6 +573,421 @@ SignalGroup::SignalGroup(uint32_t num_signals, const hsa_signal_t* hsa_signals)
   for (uint32_t i = 0; i < count; i++) signals[i] = hsa_signals[i];
 }
 
+SignalWaitSet::~SignalWaitSet() {
+  for (auto& member : members_) {
+    if (member.signal == nullptr) continue;
+    member.signal->WaitingDec();
+    member.signal->Release();
+  }
+}
+
+hsa_status_t SignalWaitSet::Add(hsa_signal_t hsa_signal, hsa_signal_condition_t cond,
+                                hsa_signal_value_t value) {
+  if (cond != HSA_SIGNAL_CONDITION_EQ && cond != HSA_SIGNAL_CONDITION_NE &&
+      cond != HSA_SIGNAL_CONDITION_LT && cond != HSA_SIGNAL_CONDITION_GTE)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  if (slot_of_.find(hsa_signal.handle) != slot_of_.end()) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  Signal* signal = Signal::Convert(hsa_signal);
+  HsaEvent* evt = signal->EopEvent();
+
+  // Book keeping is done before taking references so an allocation failure leaks nothing.
+  uint32_t slot;
+  if (free_slots_.empty()) {
+    slot = uint32_t(members_.size());
+    members_.push_back({nullptr, cond, value, kNoEvent});
+    if (ready_.size() * 64 < members_.size()) ready_.push_back(0);
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  }
+  MAKE_NAMED_SCOPE_GUARD(slotGuard, [&]() {
+    free_slots_.push_back(slot);
+    slot_of_.erase(hsa_signal.handle);
+  });
+  slot_of_[hsa_signal.handle] = slot;
+
+  uint32_t index = kNoEvent;
+  if (evt != nullptr) {
+    auto it = event_index_.find(evt);
+    if (it == event_index_.end()) {
+      index = uint32_t(events_.size());
+      events_.push_back(evt);
+      // Age 1 returns at once if the event has ever fired, closing the race with a completion
+      // which lands before the first sleep.
+      event_age_.push_back(1);
+      prior_age_.push_back(1);
+      event_members_.emplace_back();
+      event_index_[evt] = index;
+    } else {
+      index = it->second;
+    }
+    event_members_[index].push_back(slot);
+  }
+  slotGuard.Dismiss();
+
+  members_[slot] = {signal, cond, value, index};
+  if (index == kNoEvent) unevented_++;
+  signal->Retain();
+  signal->WaitingInc();
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t SignalWaitSet::Remove(hsa_signal_t hsa_signal) {
+  auto it = slot_of_.find(hsa_signal.handle);
+  if (it == slot_of_.end()) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  ReleaseSlot(it->second);
+  return HSA_STATUS_SUCCESS;
+}
+
+void SignalWaitSet::ReleaseSlot(uint32_t slot) {
+  Member& member = members_[slot];
+  ClearReady(slot);
+
+  if (member.event == kNoEvent) {
+    unevented_--;
+  } else {
+    const uint32_t index = member.event;
+    auto& list = event_members_[index];
+    list.erase(std::find(list.begin(), list.end(), slot));
+    if (list.empty()) {
+      // Swap the last event into the hole to keep the array handed to the driver dense.
+      const uint32_t last = uint32_t(events_.size() - 1);
+      event_index_.erase(events_[index]);
+      if (index != last) {
+        events_[index] = events_[last];
+        event_age_[index] = event_age_[last];
+        event_members_[index].swap(event_members_[last]);
+        event_index_[events_[index]] = index;
+        for (uint32_t moved : event_members_[index]) members_[moved].event = index;
+      }
+      events_.pop_back();
+      event_age_.pop_back();
+      prior_age_.pop_back();
+      event_members_.pop_back();
+    }
+  }
+
+  Signal* signal = member.signal;
+  slot_of_.erase(Signal::Convert(signal).handle);
+  member.signal = nullptr;
+  member.event = kNoEvent;
+  free_slots_.push_back(slot);
+
+  signal->WaitingDec();
+  signal->Release();
+}
+
+bool SignalWaitSet::Satisfied(const Member& member, hsa_signal_value_t& value) {
+  value = atomic::Load(&member.signal->signal_.value, std::memory_order_relaxed);
+  // Destroyed signals will never change, report them so the caller can drop them.
+  if (!member.signal->IsValid()) return true;
+  switch (member.cond) {
+    case HSA_SIGNAL_CONDITION_EQ:
+      return value == member.value;
+    case HSA_SIGNAL_CONDITION_NE:
+      return value != member.value;
+    case HSA_SIGNAL_CONDITION_GTE:
+      return value >= member.value;
+    case HSA_SIGNAL_CONDITION_LT:
+      return value < member.value;
+    default:
+      return false;
+  }
+}
+
+void SignalWaitSet::Poll(uint32_t slot) {
+  hsa_signal_value_t value;
+  if (!IsReady(slot) && Satisfied(members_[slot], value)) SetReady(slot);
+}
+
+bool SignalWaitSet::PollAll() {
+  bool contended = false;
+  for (uint32_t slot = 0; slot < members_.size(); slot++) {
+    if (members_[slot].signal == nullptr) continue;
+    Poll(slot);
+    contended |= members_[slot].signal->waiting_ > 1;
+  }
+  return contended;
+}
+
+void SignalWaitSet::Harvest(uint32_t max, hsa_signal_t* ready, hsa_signal_value_t* values,
+                            uint32_t* count) {
+  for (uint32_t word = 0; word < ready_.size() && *count < max && ready_count_ != 0; word++) {
+    while (ready_[word] != 0 && *count < max) {
+      const uint32_t slot = word * 64 + __builtin_ctzll(ready_[word]);
+      ClearReady(slot);
+      // Recheck, the value may have moved on since the slot was marked.
+      hsa_signal_value_t value;
+      if (!Satisfied(members_[slot], value)) continue;
+      ready[*count] = Signal::Convert(members_[slot].signal);
+      if (values != nullptr) values[*count] = value;
+      (*count)++;
+      ReleaseSlot(slot);
+    }
+  }
+}
+
+void SignalWaitSet::Wait(uint64_t timeout, hsa_wait_state_t wait_hint, uint32_t max_ready,
+                         hsa_signal_t* ready, hsa_signal_value_t* values, uint32_t* count) {
+  *count = 0;
+  if (slot_of_.empty() || max_ready == 0) return;
+
+  const bool event_age = core::Runtime::runtime_singleton_->KfdVersion().supports_event_age;
+  if (unevented_ != 0) wait_hint = HSA_WAIT_STATE_ACTIVE;
+
+  timer::fast_clock::time_point start_time = timer::fast_clock::now();
+
+  // Set a polling timeout value
+  const timer::fast_clock::duration kMaxElapsed = std::chrono::microseconds(200);
+
+  // Convert timeout value into the fast_clock domain
+  uint64_t hsa_freq;
+  HSA::hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY, &hsa_freq);
+  const timer::fast_clock::duration fast_timeout =
+      timer::duration_from_seconds<timer::fast_clock::duration>(
+          double(timeout) / double(hsa_freq));
+
+  // Members left ready by an earlier call are reported without a scan.
+  bool poll_all = (ready_count_ == 0);
+  while (true) {
+    if (poll_all) {
+      // Without event age tracking only the first waiter may sleep, see Signal::WaitAny.
+      if (PollAll() && !event_age) wait_hint = HSA_WAIT_STATE_ACTIVE;
+    }
+
+    if (ready_count_ != 0) {
+      Harvest(max_ready, ready, values, count);
+      if (*count != 0) return;
+    }
+    poll_all = true;
+
+    timer::fast_clock::time_point time = timer::fast_clock::now();
+    if (time - start_time > fast_timeout) return;
+
+    if (wait_hint == HSA_WAIT_STATE_ACTIVE) continue;
+
+    if (time - start_time < kMaxElapsed) continue;
+
+    uint32_t wait_ms;
+    auto time_remaining = fast_timeout - (time - start_time);
+    uint64_t ct = timer::duration_cast<std::chrono::milliseconds>(time_remaining).count();
+    wait_ms = (ct > 0xFFFFFFFEu) ? 0xFFFFFFFEu : ct;
+
+    for (auto& member : members_)
+      if (member.signal != nullptr) member.signal->FlushDeferredInterrupt();
+
+    if (!event_age) {
+      std::fill(event_age_.begin(), event_age_.end(), 0);
+      hsaKmtWaitOnMultipleEvents_Ext(&events_[0], uint32_t(events_.size()), false, wait_ms,
+                                     &event_age_[0]);
+      continue;
+    }
+
+    prior_age_ = event_age_;
+    hsaKmtWaitOnMultipleEvents_Ext(&events_[0], uint32_t(events_.size()), false, wait_ms,
+                                   &event_age_[0]);
+
+    // The driver advances the age of each event which fired.  Only their members need a look.
+    for (uint32_t i = 0; i < events_.size(); i++) {
+      if (event_age_[i] == prior_age_[i]) continue;
+      for (uint32_t slot : event_members_[i]) Poll(slot);
+      poll_all = false;
+    }
+  }
+}
+
+CompletionQueue::CompletionQueue(uint32_t size)
+    : size_(size), event_(nullptr), free_event_(false) {
+  if (!g_use_interrupt_wait) return;
+  InterruptSignal::EventPool* pool = Runtime::runtime_singleton_->GetEventPool();
+  event_ = pool->alloc();
+  free_event_ = (event_ != nullptr);
+  if (event_ == nullptr) event_ = pool->alloc_shared();
+}
+
+CompletionQueue::~CompletionQueue() {
+  for (auto& entry : pending_) {
+    entry.signal->WaitingDec();
+    entry.signal->DestroySignal();
+  }
+  if (free_event_) Runtime::runtime_singleton_->GetEventPool()->free(event_);
+}
+
+hsa_status_t CompletionQueue::CreateSignal(hsa_signal_value_t initial_value, uint64_t tag,
+                                           hsa_signal_t* signal) {
+  ScopedAcquire<KernelMutex> lock(&lock_);
+  if (pending_.size() >= size_) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  pending_.reserve(pending_.size() + 1);
+
+  Signal* ret;
+  if (event_ != nullptr)
+    ret = new InterruptSignal(initial_value, event_);
+  else
+    ret = new DefaultSignal(initial_value);
+
+  // The queue is a permanent waiter, so copies never skip the interrupt the consumer sleeps on.
+  ret->WaitingInc();
+  pending_.push_back({ret, tag});
+  *signal = Signal::Convert(ret);
+  return HSA_STATUS_SUCCESS;
+}
+
+void CompletionQueue::Reap(uint32_t max_records, hsa_amd_completion_record_t* records,
+                           uint32_t* count) {
+  const uint64_t now = os::ReadSystemClock();
+  size_t kept = 0;
+  for (size_t i = 0; i < pending_.size(); i++) {
+    Entry entry = pending_[i];
+    if (*count < max_records && entry.signal->LoadAcquire() < 1) {
+      records[*count].tag = entry.tag;
+      records[*count].timestamp = now;
+      (*count)++;
+      entry.signal->WaitingDec();
+      entry.signal->DestroySignal();
+      continue;
+    }
+    pending_[kept++] = entry;
+  }
+  pending_.resize(kept);
+}
+
+void CompletionQueue::Dequeue(uint64_t timeout, hsa_wait_state_t wait_hint, uint32_t max_records,
+                              hsa_amd_completion_record_t* records, uint32_t* count) {
+  *count = 0;
+  if (max_records == 0) return;
+
+  const bool event_age = core::Runtime::runtime_singleton_->KfdVersion().supports_event_age;
+  if (event_ == nullptr) wait_hint = HSA_WAIT_STATE_ACTIVE;
+
+  timer::fast_clock::time_point start_time = timer::fast_clock::now();
+
+  // Set a polling timeout value
+  const timer::fast_clock::duration kMaxElapsed = std::chrono::microseconds(200);
+
+  // Convert timeout value into the fast_clock domain
+  uint64_t hsa_freq;
+  HSA::hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY, &hsa_freq);
+  const timer::fast_clock::duration fast_timeout =
+      timer::duration_from_seconds<timer::fast_clock::duration>(
+          double(timeout) / double(hsa_freq));
+
+  // Age 1 returns at once if the event has ever fired, closing the race with a completion
+  // landing between the last scan and the sleep.
+  uint64_t age = 1;
+  while (true) {
+    {
+      ScopedAcquire<KernelMutex> lock(&lock_);
+      if (pending_.empty()) return;
+      Reap(max_records, records, count);
+    }
+    if (*count != 0) return;
+
+    timer::fast_clock::time_point time = timer::fast_clock::now();
+    if (time - start_time > fast_timeout) return;
+
+    if (wait_hint == HSA_WAIT_STATE_ACTIVE) continue;
+
+    if (time - start_time < kMaxElapsed) continue;
+
+    uint32_t wait_ms;
+    auto time_remaining = fast_timeout - (time - start_time);
+    uint64_t ct = timer::duration_cast<std::chrono::milliseconds>(time_remaining).count();
+    wait_ms = (ct > 0xFFFFFFFEu) ? 0xFFFFFFFEu : ct;
+
+    if (!event_age) age = 0;
+    hsaKmtWaitOnEvent_Ext(event_, wait_ms, &age);
+  }
+}
+
+static_assert(sizeof(hsa_amd_progress_counter_abi_t) == 64,
+              "Progress counter layout must fill one cache line.");
+
+ProgressCounter::ProgressCounter(int node_id, uint64_t initial_value, bool interrupt)
+    : abi_(nullptr), event_(nullptr), free_event_(false) {
+  // A cache line of its own keeps producer atomics off lines holding unrelated data.
+  abi_ = reinterpret_cast<hsa_amd_progress_counter_abi_t*>(
+      Runtime::runtime_singleton_->system_allocator()(sizeof(hsa_amd_progress_counter_abi_t), 64,
+                                                       0, node_id));
+  if (abi_ == nullptr)
+    throw AMD::hsa_exception(HSA_STATUS_ERROR_OUT_OF_RESOURCES,
+                             "Progress counter allocation failed.");
+  memset(abi_, 0, sizeof(*abi_));
+  abi_->value = initial_value;
+  abi_->threshold = UINT64_MAX;
+
+  if (!interrupt || !g_use_interrupt_wait) return;
+  InterruptSignal::EventPool* pool = Runtime::runtime_singleton_->GetEventPool();
+  event_ = pool->alloc();
+  free_event_ = (event_ != nullptr);
+  if (event_ == nullptr) event_ = pool->alloc_shared();
+  if (event_ != nullptr) {
+    abi_->event_mailbox_ptr = event_->EventData.HWData2;
+    abi_->event_id = event_->EventId;
+  }
+}
+
+ProgressCounter::~ProgressCounter() {
+  Runtime::runtime_singleton_->system_deallocator()(abi_);
+  if (free_event_) Runtime::runtime_singleton_->GetEventPool()->free(event_);
+}
+
+uint64_t ProgressCounter::Wait(uint64_t threshold, uint64_t timeout, hsa_wait_state_t wait_hint) {
+  uint64_t value = atomic::Load(&abi_->value, std::memory_order_acquire);
+  if (value >= threshold) return value;
+
+  const bool event_age = core::Runtime::runtime_singleton_->KfdVersion().supports_event_age;
+  if (event_ == nullptr) wait_hint = HSA_WAIT_STATE_ACTIVE;
+
+  timer::fast_clock::time_point start_time = timer::fast_clock::now();
+
+  // Set a polling timeout value
+  const timer::fast_clock::duration kMaxElapsed = std::chrono::microseconds(200);
+
+  // Convert timeout value into the fast_clock domain
+  uint64_t hsa_freq;
+  HSA::hsa_system_get_info(HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY, &hsa_freq);
+  const timer::fast_clock::duration fast_timeout =
+      timer::duration_from_seconds<timer::fast_clock::duration>(
+          double(timeout) / double(hsa_freq));
+
+  // Producers only interrupt while a threshold is published, so spinning costs them nothing.
+  bool armed = false;
+  MAKE_SCOPE_GUARD([&]() {
+    if (armed) atomic::Store(&abi_->threshold, uint64_t(UINT64_MAX), std::memory_order_relaxed);
+  });
+
+  uint64_t age = 1;
+  while (true) {
+    value = atomic::Load(&abi_->value, std::memory_order_acquire);
+    if (value >= threshold) return value;
+
+    timer::fast_clock::time_point time = timer::fast_clock::now();
+    if (time - start_time > fast_timeout) return value;
+
+    if (wait_hint == HSA_WAIT_STATE_ACTIVE) continue;
+
+    if (time - start_time < kMaxElapsed) continue;
+
+    // Publish the threshold and recheck the value before sleeping.  A producer racing with the
+    // store either observes the threshold and interrupts, or its update is seen by the recheck.
+    if (!armed) {
+      atomic::Store(&abi_->threshold, threshold, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      armed = true;
+      continue;
+    }
+
+    uint32_t wait_ms;
+    auto time_remaining = fast_timeout - (time - start_time);
+    uint64_t ct = timer::duration_cast<std::chrono::milliseconds>(time_remaining).count();
+    wait_ms = (ct > 0xFFFFFFFEu) ? 0xFFFFFFFEu : ct;
+
+    if (!event_age) age = 0;
+    hsaKmtWaitOnEvent_Ext(event_, wait_ms, &age);
+  }
+}
+
 }  // namespace core
 }  // namespace rocr
 
@@ -111,6 +111,109 @@ static const char* smi_unmap_string(uint32_t trigger) {
   return strings[trigger];
 }
 
+// Migration trigger values of SMI migrate events.
+static const uint32_t kMigratePageFaultGpu = 1;
+static const uint32_t kMigratePageFaultCpu = 2;
+
+// Policy ranges match the SVM migration granularity default.  Bounces only count when they fall
+// within one window, and idle ranges are forgotten once the table grows past kMaxRanges.
+static const uint64_t kPolicyGranule = 2 * 1024 * 1024;
+static const uint64_t kPolicyWindowNs = 100 * 1000 * 1000;
+static const size_t kMaxRanges = 4096;
+
+SvmMigrationPolicy::SvmMigrationPolicy(uint32_t threshold) : threshold_(threshold) {
+  cpu_node_ = core::Runtime::runtime_singleton_->cpu_agents()[0]->node_id();
+  for (auto agent : core::Runtime::runtime_singleton_->gpu_agents())
+    gpu_nodes_[uint32_t(static_cast<GpuAgent*>(agent)->KfdGpuID())] = agent->node_id();
+}
+
+bool SvmMigrationPolicy::Observe(const hsa_amd_svm_event_record_t& record) {
+  bool fault = (record.event == HSA_SMI_EVENT_PAGE_FAULT_START);
+  // Prefetches and evictions are not a sign of competing access.
+  bool migration = (record.event == HSA_SMI_EVENT_MIGRATE_END) &&
+      ((record.trigger == kMigratePageFaultGpu) || (record.trigger == kMigratePageFaultCpu));
+  if (!(fault || migration) || record.size == 0) return false;
+
+  if (ranges_.size() > kMaxRanges) {
+    for (auto it = ranges_.begin(); it != ranges_.end();) {
+      if (!it->second.settled && record.timestamp - it->second.window_start > kPolicyWindowNs)
+        it = ranges_.erase(it);
+      else
+        it++;
+    }
+  }
+
+  bool changed = false;
+  const uint64_t end = record.address + record.size;
+  for (uint64_t base = AlignDown(record.address, kPolicyGranule); base < end;
+       base += kPolicyGranule) {
+    RangeState& range = ranges_[base];
+    if (range.settled) continue;
+
+    if (record.timestamp - range.window_start > kPolicyWindowNs) {
+      range.window_start = record.timestamp;
+      range.bounces = 0;
+      range.demand.clear();
+    }
+
+    range.demand[record.dst_gpu_id]++;
+    if (!migration) continue;
+
+    uint64_t lo = Max(record.address, base);
+    uint64_t hi = Min(end, base + kPolicyGranule);
+    if (range.hi == 0) {
+      range.lo = lo;
+      range.hi = hi;
+    } else {
+      // Data leaving the agent a fault last moved it to is a bounce.
+      if ((record.src_gpu_id == range.last_dst) && (record.dst_gpu_id != range.last_dst))
+        range.bounces++;
+      range.lo = Min(range.lo, lo);
+      range.hi = Max(range.hi, hi);
+    }
+    range.last_dst = record.dst_gpu_id;
+
+    if (range.bounces >= threshold_) changed |= Settle(range);
+  }
+  return changed;
+}
+
+bool SvmMigrationPolicy::Settle(RangeState& range) {
+  range.settled = true;
+
+  // Memory the CPU keeps faulting back stays in system memory and GPUs reach it over the bus.
+  // Otherwise it lives with the GPU asking for it most and its peers access it in place.
+  uint32_t preferred = 0;
+  if (range.demand.find(0) == range.demand.end()) {
+    uint32_t most = 0;
+    for (auto& agent : range.demand) {
+      if (agent.second > most) {
+        most = agent.second;
+        preferred = agent.first;
+      }
+    }
+  }
+
+  std::vector<HSA_SVM_ATTRIBUTE> attribs;
+  if (preferred == 0) {
+    attribs.push_back({HSA_SVM_ATTR_PREFERRED_LOC, cpu_node_});
+  } else {
+    auto node = gpu_nodes_.find(preferred);
+    if (node == gpu_nodes_.end()) return false;
+    attribs.push_back({HSA_SVM_ATTR_PREFERRED_LOC, node->second});
+  }
+  for (auto& agent : range.demand) {
+    if (agent.first == 0 || agent.first == preferred) continue;
+    auto node = gpu_nodes_.find(agent.first);
+    if (node != gpu_nodes_.end()) attribs.push_back({HSA_SVM_ATTR_ACCESS_IN_PLACE, node->second});
+  }
+
+  HSAKMT_STATUS err = hsaKmtSVMSetAttr(reinterpret_cast<void*>(range.lo), range.hi - range.lo,
+                                       attribs.size(), &attribs[0]);
+  core::Runtime::runtime_singleton_->InvalidateSvmAttribs(range.lo, range.hi - range.lo);
+  return err == HSAKMT_STATUS_SUCCESS;
+}
+
 void SvmProfileControl::PollSmiRun(void* _profileControl) {
   SvmProfileControl* profileControl = (SvmProfileControl*)_profileControl;
 
@@ -118,14 +221,22 @@ void SvmProfileControl::PollSmiRun(void* _profileControl) {
 }
 
 void SvmProfileControl::PollSmi() {
-  if (core::Runtime::runtime_singleton_->flag().svm_profile().empty()) {
+  const Flag& flag = core::Runtime::runtime_singleton_->flag();
+  if (flag.svm_profile().empty() && granule_ == 0 && !policy_ && !flag.svm_attrib_cache()) {
     return;
   }
-  FILE* logFile = fopen(core::Runtime::runtime_singleton_->flag().svm_profile().c_str(), "a");
-  if (logFile == NULL) {
-    return;
+  const bool binary = flag.svm_profile_binary();
+  FILE* logFile = nullptr;
+  if (!flag.svm_profile().empty()) {
+    logFile = fopen(flag.svm_profile().c_str(), binary ? "ab" : "a");
+    if (logFile == NULL) {
+      return;
+    }
   }
-  MAKE_NAMED_SCOPE_GUARD(logGuard, [&]() { fclose(logFile); });
+  MAKE_NAMED_SCOPE_GUARD(logGuard, [&]() {
+    if (logFile != NULL) fclose(logFile);
+  });
+  const bool text = (logFile != NULL) && !binary;
 
   std::vector<pollfd> files;
   files.resize(core::Runtime::runtime_singleton_->gpu_agents().size() + 1);
@@ -212,6 +323,11 @@ void SvmProfileControl::PollSmi() {
             int args = sscanf(cursor, "%x %lu -%u%n", &event_id, &time, &pid, &offset);
             assert(args == 3 && "Parsing error!");
 
+            hsa_amd_svm_event_record_t record = {};
+            record.timestamp = time;
+            record.event = event_id;
+
+            // Text details are only built when they are written.
             std::string detail;
             cursor += offset + 1;
             switch (event_id) {
@@ -229,6 +345,8 @@ void SvmProfileControl::PollSmi() {
                 addr *= 4096;
                 size *= 4096;
 
+                record = {time, uint32_t(event_id), trigger, addr, size, from, to};
+                if (!text) break;
                 std::string from_agent = format_agent(from);
                 std::string to_agent = format_agent(to);
                 std::string range = format("[%p, %p]", addr, addr + size - 1);
@@ -248,6 +366,8 @@ void SvmProfileControl::PollSmi() {
                 addr *= 4096;
                 size *= 4096;
 
+                record = {time, uint32_t(event_id), trigger, addr, size, from, to};
+                if (!text) break;
                 std::string from_agent = format_agent(from);
                 std::string to_agent = format_agent(to);
                 std::string range = format("[%p, %p]", addr, addr + size - 1);
@@ -265,6 +385,8 @@ void SvmProfileControl::PollSmi() {
                 addr *= 4096;
 
                 assert(args == 3 && "Parsing error!");
+                record = {time, uint32_t(event_id), uint32_t(mode == 'W'), addr, 4096, 0, gpuid};
+                if (!text) break;
                 std::string agent = format_agent(gpuid);
                 std::string range = std::to_string(addr);
                 std::string cause = (mode == 'W') ? "Write" : "Read";
@@ -281,6 +403,8 @@ void SvmProfileControl::PollSmi() {
 
                 addr *= 4096;
 
+                record = {time, uint32_t(event_id), uint32_t(mode == 'M'), addr, 4096, 0, gpuid};
+                if (!text) break;
                 std::string agent = format_agent(gpuid);
                 std::string range = std::to_string(addr);
                 std::string cause = (mode == 'M') ? "Migration" : "Map";
@@ -293,6 +417,8 @@ void SvmProfileControl::PollSmi() {
                 uint32_t trigger;
                 args = sscanf(cursor, "%x %u", &gpuid, &trigger);
                 assert(args == 2 && "Parsing error!");
+                record = {time, uint32_t(event_id), trigger, 0, 0, 0, gpuid};
+                if (!text) break;
                 std::string agent = format_agent(gpuid);
                 std::string cause = smi_eviction_string(trigger);
                 detail = cause + " " + agent;
@@ -304,6 +430,8 @@ void SvmProfileControl::PollSmi() {
                 uint32_t trigger;
                 args = sscanf(cursor, "%x %u", &gpuid, &trigger);
                 assert(args == 2 && "Parsing error!");
+                record = {time, uint32_t(event_id), trigger, 0, 0, 0, gpuid};
+                if (!text) break;
                 std::string agent = format_agent(gpuid);
                 std::string cause = smi_eviction_string(trigger);
                 detail = cause + " " + agent;
@@ -321,6 +449,8 @@ void SvmProfileControl::PollSmi() {
                 addr *= 4096;
                 size *= 4096;
 
+                record = {time, uint32_t(event_id), trigger, addr, size, 0, gpuid};
+                if (!text) break;
                 std::string gpu = format_agent(gpuid);
                 std::string range = format("[%p, %p]", addr, addr + size - 1);
                 std::string cause = smi_unmap_string(trigger);
@@ -330,12 +460,24 @@ void SvmProfileControl::PollSmi() {
               default:;
             }
 
-            std::string record = std::string("ROCr HMM event: ") + std::to_string(time) + " " +
-                smi_event_string(event_id) + " " + detail;
-            // printf("%s\n", record.c_str());
-            fprintf(logFile, "%s\n", record.c_str());
+            if (granule_ != 0) Aggregate(record);
+            if ((event_id == HSA_SMI_EVENT_MIGRATE_END) ||
+                (event_id == HSA_SMI_EVENT_UNMAP_FROM_GPU))
+              core::Runtime::runtime_singleton_->InvalidateSvmAttribs(record.address, record.size);
+            if (policy_ && policy_->Observe(record) && text)
+              fprintf(logFile, "ROCr HMM policy: settled thrashing range at %p\n",
+                      reinterpret_cast<void*>(record.address));
+
+            if (text) {
+              std::string line = std::string("ROCr HMM event: ") + std::to_string(time) + " " +
+                  smi_event_string(event_id) + " " + detail;
+              // printf("%s\n", line.c_str());
+              fprintf(logFile, "%s\n", line.c_str());
+            } else if (logFile != NULL) {
+              fwrite(&record, sizeof(record), 1, logFile);
+            }
           }
-        } else {
+        } else if (text) {
           auto err = errno;
           const char* msg = strerror(err);
           // printf("ROCr HMM event error: Read returned %ld, %s (%d)\n", len, msg, err);
@@ -348,11 +490,51 @@ void SvmProfileControl::PollSmi() {
   }
 }
 
-SvmProfileControl::SvmProfileControl() : event(-1), exit(false) {
+void SvmProfileControl::Aggregate(const hsa_amd_svm_event_record_t& record) {
+  bool migration = (record.event == HSA_SMI_EVENT_MIGRATE_END);
+  bool fault = (record.event == HSA_SMI_EVENT_PAGE_FAULT_START);
+  bool unmap = (record.event == HSA_SMI_EVENT_UNMAP_FROM_GPU);
+  if (!(migration || fault || unmap) || record.size == 0) return;
+
+  const uint64_t end = record.address + record.size;
+  ScopedAcquire<KernelMutex> lock(&ranges_lock_);
+  for (uint64_t base = AlignDown(record.address, granule_); base < end; base += granule_) {
+    hsa_amd_svm_range_stats_t& range = ranges_[base];
+    range.base = base;
+    range.size = granule_;
+    if (migration) {
+      range.migrations++;
+      range.migrated_bytes += Min(end, base + granule_) - Max(record.address, base);
+    }
+    if (fault) range.page_faults++;
+    if (unmap) range.unmaps++;
+  }
+}
+
+uint32_t SvmProfileControl::GetRanges(hsa_amd_svm_range_stats_t* ranges, uint32_t max_ranges) {
+  ScopedAcquire<KernelMutex> lock(&ranges_lock_);
+  uint32_t count = 0;
+  for (auto& range : ranges_) {
+    if (count == max_ranges) break;
+    ranges[count++] = range.second;
+  }
+  return uint32_t(ranges_.size());
+}
+
+SvmProfileControl::SvmProfileControl() : event(-1), exit(false), granule_(0) {
+  const Flag& flag = core::Runtime::runtime_singleton_->flag();
+  // Ranges are at least a page and a power of two so they tile the address space.
+  const size_t granule = flag.svm_profile_aggregate();
+  if (granule != 0) granule_ = 1ull << (64 - __builtin_clzll(Max<uint64_t>(granule, 4096) - 1));
+
+  if (flag.svm_auto_migrate())
+    policy_.reset(new SvmMigrationPolicy(flag.svm_auto_migrate_threshold()));
+
   event = eventfd(0, EFD_CLOEXEC);
   if (event == -1) return;
 
-  poll_smi_thread_ = os::CreateThread(PollSmiRun, (void*)this);
+  poll_smi_thread_ = core::Runtime::runtime_singleton_->CreateThread(
+      HSA_AMD_THREAD_CLASS_SVM_PROFILER, PollSmiRun, (void*)this);
   if (poll_smi_thread_ == NULL) {
     assert(false && "Poll SMI thread creation error.");
     return;
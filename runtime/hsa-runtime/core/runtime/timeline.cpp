@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+#include "core/inc/timeline.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "core/inc/runtime.h"
+#include "core/util/locks.h"
+
+namespace rocr {
+namespace core {
+
+namespace {
+
+struct EventInfo {
+  const char* name;
+  const char* arg;
+};
+
+const EventInfo kEvents[Timeline::kEventCount] = {
+    {"queue_create", "size"},   {"scratch_alloc", "dispatch_id"},
+    {"scratch_free", nullptr},  {"scratch_reclaim", "alt"},
+    {"copy", "bytes"},          {"signal_wait", "signal"},
+    {"ipc_attach", "bytes"},    {"code_object_load", "agent"}};
+
+struct Registry {
+  KernelMutex lock;
+  std::vector<void*> buffers;
+  FILE* file = nullptr;
+  uint64_t capacity = 0;
+  double ticks_per_us = 1.0;
+};
+
+// Leaked so thread exit after static destruction still finds it.
+Registry& registry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+}  // namespace
+
+std::atomic<bool> Timeline::enabled_(false);
+
+Timeline::ThreadBuffer::ThreadBuffer() : buffer(new Buffer()) {
+  Registry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  buffer->spans = new Span[reg.capacity];
+  buffer->mask = reg.capacity - 1;
+  buffer->tid = int(syscall(SYS_gettid));
+  buffer->head.store(0, std::memory_order_relaxed);
+  buffer->tail.store(0, std::memory_order_relaxed);
+  buffer->dropped.store(0, std::memory_order_relaxed);
+  buffer->retired.store(false, std::memory_order_relaxed);
+  reg.buffers.push_back(buffer);
+}
+
+// Spans still in the ring are written by the next flush, which then frees the buffer.
+Timeline::ThreadBuffer::~ThreadBuffer() {
+  buffer->retired.store(true, std::memory_order_release);
+}
+
+void Timeline::Record(Event event, uint64_t start, uint64_t end, uint64_t arg) {
+  static thread_local ThreadBuffer local;
+  Buffer* buffer = local.buffer;
+
+  uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+  if (tail - buffer->head.load(std::memory_order_acquire) > buffer->mask) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  buffer->spans[tail & buffer->mask] = {start, end, arg, event};
+  buffer->tail.store(tail + 1, std::memory_order_release);
+}
+
+void Timeline::Start() {
+  const Flag& flag = Runtime::runtime_singleton_->flag();
+  if (flag.timeline_trace().empty()) return;
+
+  Registry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  if (reg.file != nullptr) return;
+
+  reg.file = fopen(flag.timeline_trace().c_str(), "w");
+  if (reg.file == nullptr) return;
+
+  // The trace viewers accept an array without the closing bracket, so spans can be appended by
+  // every flush.
+  fprintf(reg.file, "[\n");
+
+  // Rings are sized once since existing threads keep theirs.
+  if (reg.capacity == 0) reg.capacity = NextPow2(Max<uint64_t>(flag.timeline_trace_buffer(), 2));
+  reg.ticks_per_us = double(os::AccurateClockFrequency()) / 1000000.0;
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Timeline::Stop() {
+  if (!Enabled()) return;
+  enabled_.store(false, std::memory_order_relaxed);
+  Flush();
+
+  Registry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  fclose(reg.file);
+  reg.file = nullptr;
+}
+
+void Timeline::Flush() {
+  Registry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  if (reg.file == nullptr) return;
+
+  for (auto it = reg.buffers.begin(); it != reg.buffers.end();) {
+    Buffer* buffer = reinterpret_cast<Buffer*>(*it);
+    // Read retired first so a ring retired after this point is drained on a later flush.
+    bool retired = buffer->retired.load(std::memory_order_acquire);
+    Drain(buffer);
+    if (retired) {
+      delete[] buffer->spans;
+      delete buffer;
+      it = reg.buffers.erase(it);
+    } else {
+      it++;
+    }
+  }
+  fflush(reg.file);
+}
+
+// Called with the registry lock held.
+void Timeline::Drain(Buffer* buffer) {
+  Registry& reg = registry();
+  const int pid = os::GetProcessId();
+  const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  const uint64_t tail = buffer->tail.load(std::memory_order_acquire);
+
+  for (uint64_t i = head; i != tail; i++) {
+    const Span& span = buffer->spans[i & buffer->mask];
+    const EventInfo& info = kEvents[span.event];
+    fprintf(reg.file,
+            "{\"name\":\"%s\",\"cat\":\"rocr\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,"
+            "\"dur\":%.3f",
+            info.name, pid, buffer->tid, double(span.start) / reg.ticks_per_us,
+            double(span.end - span.start) / reg.ticks_per_us);
+    if (info.arg != nullptr) fprintf(reg.file, ",\"args\":{\"%s\":%lu}", info.arg, span.arg);
+    fprintf(reg.file, "},\n");
+  }
+  buffer->head.store(tail, std::memory_order_release);
+
+  uint64_t dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+  if (dropped != 0)
+    fprintf(reg.file,
+            "{\"name\":\"dropped_spans\",\"cat\":\"rocr\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,"
+            "\"tid\":%d,\"ts\":%.3f,\"args\":{\"count\":%lu}},\n",
+            pid, buffer->tid, double(os::ReadAccurateClock()) / reg.ticks_per_us, dropped);
+}
+
+}  // namespace core
+}  // namespace rocr
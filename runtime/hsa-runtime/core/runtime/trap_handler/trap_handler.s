@@ -185,6 +185,14 @@
   .endif
  .endm
 
+ .macro S_BITCMP1_B32_PCS_TTMP_REG2 bit_index
+  .if (.amdgcn.gfx_generation_minor >= 4)
+     s_bitcmp1_b32    ttmp11, \bit_index
+  .else
+     s_bitcmp1_b32    ttmp6, \bit_index
+  .endif
+ .endm
+
  .macro S_CMP_LG_U32_PCS_TTMP_REG1 src0
   .if (.amdgcn.gfx_generation_minor >= 4)
     s_cmp_lg_u32     \src0, ttmp6
@@ -312,16 +320,51 @@ trap_entry:
   //  }
   //}
 
+  // This path only gathers a sample, so it touches nothing beyond the ttmps and the saved
+  // IB_STS/STATUS that .exit_trap restores anyway. Per-sample latency is dominated by the
+  // buf_write_val reservation and the doorbell query; both are issued back to back so the
+  // doorbell spin and the timestamp read overlap the atomic, and the sample is then written
+  // with paired stores and a single cache write-back.
+
   // ttmp[14:15] is tma->host_trap_buffers; Available: ttmp[2:3], ttmp[4:5], ttmp7, ttmp13
 .profile_trap_handlers_gfx9:
   s_mov_b64             		ttmp[2:3], 1                    // atomic increment buf_write_val
   s_atomic_add_x2       		ttmp[2:3], ttmp[14:15], glc     // ttmp[2:3] = packed local_entry
   S_LOAD_DWORD_PCS_TTMP_REG1		ttmp[14:15], 0x8                // TTMP_REG1 = tma->buf_size
-  s_waitcnt             		lgkmcnt(0)
-  s_lshr_b32            		ttmp7, ttmp3, 31                // ttmp7 = buf_to_use
+
+  // get_correlation_id() needs the doorbell; fetch it while the reservation is in flight.
+  // Returns a value to use as a correlation ID.
+  // Returns a 64bit number made up of the 9-bit queue ID and the
+  // 25-bit dispatch_pkt concatenated together as:
+  // Upper 32 bits: {23 0s}{9b queue_id}
+  // Lower 32 bits: { 7 0s}{25b dispatch_pkt}
+  // __device__ uint64_t get_correlation_id() {
+  //   uint64_t output;
+  //   // Get bottom 10 bits of queue's doorbell, in doorbell region.
+  //   // Doorbell is 8B (3b per); region is 8K (13b total) so 10 bits.
+  //   output = s_sendmsg(MSG_GET_DOORBELL);
+  //   output &= 0x3ff;
+  //   output <<= 32;
+  //   // TTMP6 contains this packet dispatch ID modulus the queue size
+  //   output |= TTMP6;
+  //   return output;
+  // }
+  s_mov_b64             		ttmp[4:5], exec                 // back up EXEC mask
+  s_mov_b32             		exec_lo, 0x80000000             // prepare EXEC for doorbell spin
+  s_sendmsg             		sendmsg(MSG_GET_DOORBELL)       // message 10, puts doorbell in EXEC
+.wait_for_doorbell:
+  s_nop                 		0x7                             // wait a bit for message to return
+  s_bitcmp0_b32         		exec_lo, 0x1f                   // returned message  will 0 bit 31
+  s_cbranch_scc0        		.wait_for_doorbell              // wait some more if no data yet
+  s_mov_b32             		exec_hi, ttmp5                  // do not care about message[63:32]
+  s_and_b32             		ttmp7, exec_lo, DOORBELL_ID_MASK // doorbell now in ttmp7
+  s_mov_b32             		exec_lo, ttmp4                  // exec mask restored
+  s_memrealtime         		ttmp[4:5]                       // ttmp[4:5] = timestamp
+  s_waitcnt             		lgkmcnt(0)                      // reservation, buf_size, timestamp
+
   S_BITSET0_B32_PCS_TTMP_REG2   	31                              // clear out TTMP_REG2  bit31
-  s_cmp_eq_u32          		ttmp7, 0                        // store off buf_to_use ...
-  s_cbranch_scc1        		.skip_ttmp_set_gfx9             // into bit31 of TTMP_REG2
+  s_bitcmp1_b32         		ttmp3, 31                       // store off buf_to_use ...
+  s_cbranch_scc0        		.skip_ttmp_set_gfx9             // into bit31 of TTMP_REG2
   S_BITSET1_B32_PCS_TTMP_REG2   	31
 .skip_ttmp_set_gfx9:
   s_bfe_u64             		ttmp[2:3], ttmp[2:3], (63<<16)  // ttmp[2:3] = new local_entry
@@ -330,28 +373,25 @@ trap_entry:
   S_CMP_GE_U32_PCS_TTMP_REG1    	ttmp2                           // if local_entry >= buf_size
   s_cbranch_scc1        		.pc_sampling_exit
 
-  // ttmp2=local_entry, ttmp7=buf_to_use (also in bit31 of TTMP_REG2), TTMP_REG1=buf_size
-  // ttmp[14:15] is tma->host_trap_buffers. Available: ttmp3, ttmp[4:5]
-.if (.amdgcn.gfx_generation_number == 9 && .amdgcn.gfx_generation_minor == 4)
-  s_mul_i32             		ttmp6, ttmp6, ttmp7		// ttmp[4:5]=buf_size if ...
-  s_mul_i32             		ttmp4, ttmp6, 0x40              // buf_to_use=1, 0 otherwise
-  s_mul_hi_u32          		ttmp5, ttmp6, 0x40
-.else
-  s_mul_i32             		ttmp13, ttmp13, ttmp7		// ttmp[4:5]=buf_size if ...
-  s_mul_i32             		ttmp4, ttmp13, 0x40             // buf_to_use=1, 0 otherwise
-  s_mul_hi_u32          		ttmp5, ttmp13, 0x40
-.endif
-
-  s_add_u32             		ttmp4, ttmp4, 0x40              // now ttmp[4:5]=offset from ...
-  s_addc_u32            		ttmp5, ttmp5, 0                 // tma to start of target buffer;
-  s_add_u32             		ttmp4, ttmp14, ttmp4            // ttmp[4:5] now points to ...
-  s_addc_u32            		ttmp5, ttmp15, ttmp5            // buffer0 or buffer1
-  s_mov_b32             		ttmp7, ttmp2
-
-  // ttmp7 contains local_entry, ttmp[4:5] contains "&bufferX",
-  // ttmp[14:15] holds 'tma->host_trap_buffers' pointer
-  // ttmp[2:3] and ttmp13 are available for gathering perf sample info
-  // ttmp[14:15] is live out
+  // ttmp[2:3]=local_entry, bit31 of TTMP_REG2=buf_to_use, TTMP_REG1=buf_size,
+  // ttmp[4:5]=timestamp, ttmp7=doorbell, ttmp[14:15] is tma->host_trap_buffers.
+  // Both buffers are 64B samples laid out back to back after the 64B header, so
+  // &bufferX[local_entry] = tma + ((buf_to_use * buf_size + local_entry + 1) << 6).
+  S_BITCMP1_B32_PCS_TTMP_REG2   	31
+  s_cbranch_scc0        		.use_buffer0_gfx9
+  S_ADD_U32_PCS_TTMP_REG1       	ttmp2, ttmp2                    // skip over buffer0
+  s_addc_u32            		ttmp3, ttmp3, 0
+.use_buffer0_gfx9:
+  s_add_u32             		ttmp2, ttmp2, 1                 // skip over the header
+  s_addc_u32            		ttmp3, ttmp3, 0
+  s_lshl_b64            		ttmp[2:3], ttmp[2:3], 6         // 64B samples
+  s_add_u32             		ttmp2, ttmp2, ttmp14
+  s_addc_u32            		ttmp3, ttmp3, ttmp15            // ttmp[2:3]=&bufferX[local_entry]
+
+  // ttmp[2:3] contains "&bufferX[local_entry]", ttmp[4:5] the timestamp, ttmp7 the doorbell
+  // ttmp[14:15] holds 'tma->host_trap_buffers' pointer and is live out
+  // ttmp[4:5] and TTMP_REG1 are available for gathering perf sample info once the
+  // timestamp store has been issued; SMEM stores read their data at issue.
 
   // fill_sample(...) - begin //
   // typedef struct {
@@ -382,79 +422,35 @@ trap_entry:
   //    buf->correlation_id = get_correlation_id();
   // }
 
-  s_mul_i32             		ttmp2, ttmp7, 0x40              // offset into buffer for 64B objects
-  s_mul_hi_u32          		ttmp3, ttmp7, 0x40              // ttmp[2:3] will contain byte ...
-  s_add_u32             		ttmp2, ttmp2, ttmp4
-  s_addc_u32            		ttmp3, ttmp3, ttmp5             // ttmp[2:3]=&bufferX[local_entry]
-  s_memrealtime         		ttmp[4:5]
   s_and_b32             		ttmp1, ttmp1, 0xffff            // clear out extra data from PC_HI
   s_store_dwordx2       		ttmp[0:1], ttmp[2:3]            // store PC
-  s_waitcnt             		lgkmcnt(0)                      // wait for timestamp
-  S_MOV_B32_SRC_PCS_TTMP_REG1   	exec_lo
-  S_STORE_DWORD_PCS_TTMP_REG1   	ttmp[2:3], 0x8                  // store EXEC_LO
-  S_MOV_B32_SRC_PCS_TTMP_REG1   	exec_hi
-  S_STORE_DWORD_PCS_TTMP_REG1   	ttmp[2:3], 0xc                  // store EXEC_HI
+  s_store_dwordx2       		ttmp[4:5], ttmp[2:3], 0x30      // store timestamp
+  s_mov_b64             		ttmp[4:5], exec
+  s_store_dwordx2       		ttmp[4:5], ttmp[2:3], 0x8       // store EXEC
   s_store_dwordx2       		ttmp[8:9], ttmp[2:3], 0x10     	// store wg_id_x and wg_id_y
-  s_store_dword         		ttmp10, ttmp[2:3], 0x18        	// store wg_id_z
-  s_store_dwordx2       		ttmp[4:5], ttmp[2:3], 0x30     	// store timestamp
+  s_mov_b32             		ttmp4, ttmp10
 
 .if (.amdgcn.gfx_generation_number == 9 && .amdgcn.gfx_generation_minor >= 4)
-  s_getreg_b32          		ttmp4, hwreg(HW_REG_XCC_ID)     //store XCC_ID
-  s_lshl_b32            		ttmp4, ttmp4, 8
-  s_and_b32             		ttmp5, ttmp11, 0x3f
-  s_or_b32              		ttmp4, ttmp4, ttmp5
-  s_store_dword         		ttmp4, ttmp[2:3], 0x1c          // store wave_in_wg
+  s_getreg_b32          		ttmp5, hwreg(HW_REG_XCC_ID)     //store XCC_ID
+  s_lshl_b32            		ttmp5, ttmp5, 8
+  s_and_b32             		ttmp6, ttmp11, 0x3f             // TTMP_REG1 is free here
+  s_or_b32              		ttmp5, ttmp5, ttmp6
 .else
-  s_and_b32             		ttmp4, ttmp11, 0x3f
-  s_store_dword         		ttmp4, ttmp[2:3], 0x1c         	// store wave_in_wg
+  s_and_b32             		ttmp5, ttmp11, 0x3f
 .endif
+  s_store_dwordx2       		ttmp[4:5], ttmp[2:3], 0x18      // store wg_id_z and wave_in_wg
+
   // Get HW_ID using S_GETREG_B32 with size=32 (F8 in upper bits), offset=0, and HW_ID = 4 (0x4)
   s_getreg_b32          		ttmp4, hwreg(HW_REG_HW_ID)
   s_store_dword         		ttmp4, ttmp[2:3], 0x20          // store HW_ID
 
-  // ttmp[2:3] = &buffer[local_entry]; ttmp[4:5], ttmp7, and ttmp13 are free
-  // ttmp[14:15] = tma->host_trap_buffers and is live out; ttmp6.b31 is buf_to_use, 0 or 1
-
-  // get_correlation_id() -- begin //
-  // Returns a value to use as a correlation ID.
-  // Returns a 64bit number made up of the 9-bit queue ID and the
-  // 25-bit dispatch_pkt concatenated together as:
-  // Upper 32 bits: {23 0s}{9b queue_id}
-  // Lower 32 bits: { 7 0s}{25b dispatch_pkt}
-  // __device__ uint64_t get_correlation_id() {
-  //   uint64_t output;
-  //   // Get bottom 10 bits of queue's doorbell, in doorbell region.
-  //   // Doorbell is 8B (3b per); region is 8K (13b total) so 10 bits.
-  //   output = s_sendmsg(MSG_GET_DOORBELL);
-  //   output &= 0x3ff;
-  //   output <<= 32;
-  //   // TTMP6 contains this packet dispatch ID modulus the queue size
-  //   output |= TTMP6;
-  //   return output;
-  // }
-
-  // ttmp[2:3] = &buffer[local_entry]
-  // ttmp[4:5], ttmp7, and ttmp13 are free
-  // ttmp[14:15] = tma->host_trap_buffers and is live out
-  // ttmp6.b31 is buf_to_use, 0 or 1 and is live out
-  s_mov_b64             		ttmp[4:5], exec                 // back up EXEC mask
-  s_mov_b32             		exec_lo, 0x80000000             // prepare EXEC for doorbell spin
-  s_sendmsg             		sendmsg(MSG_GET_DOORBELL)       // message 10, puts doorbell in EXEC
-.wait_for_doorbell:
-  s_nop                 		0x7                             // wait a bit for message to return
-  s_bitcmp0_b32         		exec_lo, 0x1f                   // returned message  will 0 bit 31
-  s_cbranch_scc0        		.wait_for_doorbell              // wait some more if no data yet
-  s_mov_b32             		exec_hi, ttmp5                  // do not care about message[63:32]
-  s_and_b32             		ttmp5, exec_lo, DOORBELL_ID_MASK // doorbell now in ttmp5
-  s_mov_b32             		exec_lo, ttmp4                  // exec mask restored
-
 .if (.amdgcn.gfx_generation_number == 9 && .amdgcn.gfx_generation_minor >= 4)
   s_bfe_u32             		ttmp4, ttmp11, (6 | 25 << 16)    // extract dispatch ID from ttmp11
 .else
   s_and_b32             		ttmp4, ttmp6, 0x1ffffff         // extract low 25 bits from ttmp6 (DispatchPktIndx[24:0])
 .endif
+  s_mov_b32             		ttmp5, ttmp7                    // doorbell fetched above
   s_store_dwordx2       		ttmp[4:5], ttmp[2:3], 0x38      // ttmp[4:5] is correlation ID. Store correlation_id to sample
-  // get_correlation_id() -- end //
 
   // complete stores before returning
   s_dcache_wb
@@ -515,7 +511,8 @@ trap_entry:
 .pc_sampling_exit:
   // We can receive regular exceptions while doing PC-Sampling so we need to make sure we
   // handle these exceptions here
-  s_getreg_b32          		ttmp2, hwreg(HW_REG_TRAPSTS)
+  // A single read of each register is enough: MODE.EXCP_EN masks the math exceptions in
+  // TRAPSTS[7:0], while MEM_VIOL, ILL_INST and XNACK_ERROR are always reported.
   s_getreg_b32          		ttmp3, hwreg(HW_REG_MODE, SQ_WAVE_MODE_EXCP_EN_SHIFT, SQ_WAVE_MODE_EXCP_EN_SIZE) // ttmp3[7:0] = MODE.EXCP_EN
   // Set bits corresponding to TRAPSTS.MEM_VIOL, TRAPSTS.ILLEGAL_INST and TRAPSTS.XNACK_ERROR
   s_or_b32              		ttmp3, ttmp3, (1 << SQ_WAVE_TRAPSTS_MEM_VIOL_SHIFT | 1 << SQ_WAVE_TRAPSTS_ILLEGAL_INST_SHIFT | 1 << SQ_WAVE_TRAPSTS_XNACK_ERROR_SHIFT)
@@ -524,11 +521,6 @@ trap_entry:
   // SCC will be 1 if either a maskable instruction was set, or one of MEM_VIOL, ILL_INST, XNACK_ERROR
   s_cbranch_scc1        		.no_skip_debugtrap		// if any of those are set, handle exceptions
 
-  // Check for maskable exceptions
-  s_getreg_b32          		ttmp3, hwreg(HW_REG_MODE, SQ_WAVE_MODE_EXCP_EN_SHIFT, SQ_WAVE_MODE_EXCP_EN_SIZE)
-  s_and_b32             		ttmp3, ttmp2, ttmp3
-  s_cbranch_scc1        		.no_skip_debugtrap
-
   // Since we are in PC sampling, it is safe to ignore watch1/2/3 and single step
   // as those should only be enabled by the debugger.
   // We could add them for completeness, i.e. check MODE.DEBUG_EN (bit 11)
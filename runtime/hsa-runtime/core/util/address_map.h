@@ -0,0 +1,227 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+//
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+//
+// Developed by:
+//
+//                 AMD Research and AMD HSA Software Development
+//
+//                 Advanced Micro Devices, Inc.
+//
+//                 www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+// Address range index used to track runtime allocations.  Ranges are sharded by VA granule so
+// that unrelated allocations, frees and pointer queries do not contend on one lock or walk one
+// large tree.  Ranges which cross a granule boundary are kept in a separate spanning index so that
+// every range lives in exactly one shard.  Lookups are O(log n) in the shard population only.
+
+#ifndef HSA_RUNTME_CORE_UTIL_ADDRESS_MAP_H_
+#define HSA_RUNTME_CORE_UTIL_ADDRESS_MAP_H_
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "core/util/locks.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+
+template <typename T> class ShardedAddressMap {
+ public:
+  // 2MB granules match the fragment allocator block size so sub-allocations of one block share a
+  // shard.
+  static const uint32_t kGranuleShift = 21;
+  static const uint32_t kShardCount = 64;
+
+  ShardedAddressMap() {}
+
+  /// @brief Insert or replace the range [base, base + size).
+  void Insert(const void* base, size_t size, T&& value) {
+    uintptr_t key = reinterpret_cast<uintptr_t>(base);
+    Erase(base, nullptr);
+    Shard& shard = ShardForRange(key, size);
+    ScopedAcquire<KernelSharedMutex> lock(&shard.lock);
+    shard.map[key] = Node(size, std::move(value));
+  }
+
+  /// @brief Removes the range starting exactly at base.  The removed value is moved to out if
+  /// provided.  Returns false if no such range exists.
+  bool Erase(const void* base, T* out) {
+    return EraseIf(base, [](const T&) { return true; }, out);
+  }
+
+  /// @brief Removes the range starting exactly at base if pred(const T&) accepts it.  Lookup and
+  /// removal are atomic with respect to other operations on the map.
+  template <typename F> bool EraseIf(const void* base, F pred, T* out) {
+    uintptr_t key = reinterpret_cast<uintptr_t>(base);
+    Shard* candidates[2] = {&ShardForAddress(key), &spanning_};
+    for (Shard* shard : candidates) {
+      ScopedAcquire<KernelSharedMutex> lock(&shard->lock);
+      auto it = shard->map.find(key);
+      if (it == shard->map.end()) continue;
+      if (!pred(static_cast<const T&>(it->second.value))) return false;
+      if (out != nullptr) *out = std::move(it->second.value);
+      shard->map.erase(it);
+      return true;
+    }
+    return false;
+  }
+
+  /// @brief Exact match lookup.  func(T&) is invoked with the owning shard locked exclusively.
+  template <typename F> bool Find(const void* base, F func) {
+    return FindImpl<KernelSharedMutex>(base, func);
+  }
+
+  /// @brief Exact match lookup.  func(const T&) is invoked with the owning shard locked shared.
+  template <typename F> bool FindShared(const void* base, F func) {
+    return FindImpl<KernelSharedMutex::Shared>(base, func);
+  }
+
+  /// @brief Locates the range containing ptr.  func(const void* base, size_t size, T&) is
+  /// invoked with the owning shard locked exclusively and returns true if it accepted the range.
+  template <typename F> bool FindContaining(const void* ptr, F func) {
+    return FindContainingImpl<KernelSharedMutex>(ptr, func);
+  }
+
+  /// @brief As FindContaining but the owning shard is locked shared.
+  template <typename F> bool FindContainingShared(const void* ptr, F func) {
+    return FindContainingImpl<KernelSharedMutex::Shared>(ptr, func);
+  }
+
+  /// @brief Returns true if any range intersects [base, base + size).  Shards are checked one at a
+  /// time so the answer only stays valid if the caller serializes inserts.
+  bool Overlaps(const void* base, size_t size) {
+    if (FindContainingShared(base, [](const void*, size_t, const T&) { return true; }))
+      return true;
+    if (size == 0) return false;
+
+    // Remaining candidates start inside the range, so live in the shard of one of its granules.
+    uintptr_t lo = reinterpret_cast<uintptr_t>(base);
+    uintptr_t hi = lo + size;
+    auto starts_within = [&](Shard& shard) {
+      ScopedAcquire<KernelSharedMutex::Shared> lock(shard.lock.shared());
+      auto it = shard.map.lower_bound(lo);
+      return (it != shard.map.end()) && (it->first < hi);
+    };
+    if (starts_within(spanning_)) return true;
+    uintptr_t granules = std::min<uintptr_t>(Granule(hi - 1) - Granule(lo) + 1, kShardCount);
+    for (uintptr_t i = 0; i < granules; i++)
+      if (starts_within(ShardForAddress(lo + (i << kGranuleShift)))) return true;
+    return false;
+  }
+
+  /// @brief Visits every range, one shard at a time, in no particular order.
+  template <typename F> void ForEachShared(F func) {
+    auto visit = [&](Shard& shard) {
+      ScopedAcquire<KernelSharedMutex::Shared> lock(shard.lock.shared());
+      for (auto& it : shard.map)
+        func(reinterpret_cast<const void*>(it.first), it.second.size,
+             static_cast<const T&>(it.second.value));
+    };
+    for (Shard& shard : shards_) visit(shard);
+    visit(spanning_);
+  }
+
+ private:
+  struct Node {
+    Node() : size(0) {}
+    Node(size_t Size, T&& Value) : size(Size), value(std::move(Value)) {}
+    size_t size;
+    T value;
+  };
+
+  struct __ALIGNED__(64) Shard {
+    KernelSharedMutex lock;
+    std::map<uintptr_t, Node> map;
+  };
+
+  static __forceinline uintptr_t Granule(uintptr_t addr) { return addr >> kGranuleShift; }
+
+  __forceinline Shard& ShardForAddress(uintptr_t addr) {
+    return shards_[Granule(addr) % kShardCount];
+  }
+
+  __forceinline Shard& ShardForRange(uintptr_t base, size_t size) {
+    if ((size != 0) && (Granule(base) != Granule(base + size - 1))) return spanning_;
+    return ShardForAddress(base);
+  }
+
+  // Adapts a shard lock to the requested access mode.
+  static __forceinline KernelSharedMutex* Locker(KernelSharedMutex& lock, KernelSharedMutex*) {
+    return &lock;
+  }
+  static __forceinline KernelSharedMutex::Shared Locker(KernelSharedMutex& lock,
+                                                        KernelSharedMutex::Shared*) {
+    return lock.shared();
+  }
+
+  template <typename Lock, typename F> bool FindImpl(const void* base, F& func) {
+    uintptr_t key = reinterpret_cast<uintptr_t>(base);
+    Shard* candidates[2] = {&ShardForAddress(key), &spanning_};
+    for (Shard* shard : candidates) {
+      ScopedAcquire<Lock> lock(Locker(shard->lock, static_cast<Lock*>(nullptr)));
+      auto it = shard->map.find(key);
+      if (it == shard->map.end()) continue;
+      func(it->second.value);
+      return true;
+    }
+    return false;
+  }
+
+  template <typename Lock, typename F> bool FindContainingImpl(const void* ptr, F& func) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    // A range which does not cross a granule boundary and contains ptr must have its base in
+    // ptr's granule and so lives in ptr's shard.  Anything else is in the spanning index.
+    Shard* candidates[2] = {&ShardForAddress(addr), &spanning_};
+    for (Shard* shard : candidates) {
+      ScopedAcquire<Lock> lock(Locker(shard->lock, static_cast<Lock*>(nullptr)));
+      auto it = shard->map.upper_bound(addr);
+      if (it == shard->map.begin()) continue;
+      it--;
+      if (addr - it->first >= it->second.size) continue;
+      if (func(reinterpret_cast<const void*>(it->first), it->second.size, it->second.value))
+        return true;
+    }
+    return false;
+  }
+
+  Shard shards_[kShardCount];
+  Shard spanning_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedAddressMap);
+};
+
+}  // namespace rocr
+
+#endif  // HSA_RUNTME_CORE_UTIL_ADDRESS_MAP_H_
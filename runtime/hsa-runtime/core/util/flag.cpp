@@ -223,4 +223,73 @@ void Flag::parse_masks(std::string& var, uint32_t maxGpu, uint32_t maxCU) {
   }
 }
 
+/*
+Parse HSA_THREAD_POLICY per the following syntax, all whitespace is ignored:
+
+Class = ASYNC | PCS | SVM | IPC | BACKGROUND | ALL
+Cpus = NUMA | ANY | ID_list                     ex. 0,2-4,7
+Sched = DEFAULT | OTHER | BATCH | IDLE | FIFO | RR
+Priority = [-][0-9][0-9]*                       nice value or real time priority
+Policy = Class : Cpus [: Sched [: Priority]]    ex. ASYNC:NUMA:FIFO:10
+HSA_THREAD_POLICY = Policy [; Policy]*          ex. ALL:NUMA; BACKGROUND:0-3:IDLE
+
+Later policies override earlier ones for the same class.  Classes left out
+keep the default, NUMA local cores with the creator's scheduling class.
+Parsing stops at the first Policy that has a syntax error, that policy and all
+following ones are ignored.
+*/
+void Flag::parse_thread_policy(std::string& var) {
+  for (auto& policy : thread_policy_) policy = ThreadPolicy();
+  if (var.empty()) return;
+
+  // Remove whitespace
+  auto end = std::remove_if(var.begin(), var.end(),
+                            [](char c) { return std::isspace<char>(c, std::locale::classic()); });
+  var.erase(end, var.end());
+
+  // Switch to uppercase
+  for (auto& c : var) c = toupper(c);
+
+  static const char* classes[kThreadClasses] = {"ASYNC", "PCS", "SVM", "IPC", "BACKGROUND"};
+  static const char* scheds[] = {"DEFAULT", "OTHER", "BATCH", "IDLE", "FIFO", "RR"};
+
+  auto policies = split(var, ';');
+  for (auto& entry : policies) {
+    auto parts = split(entry, ':');
+    if (parts.size() < 2 || parts.size() > 4) return;
+
+    ThreadPolicy policy;
+    policy.set = true;
+    if (parts[1] == "NUMA") {
+      policy.affinity = 0;
+    } else if (parts[1] == "ANY") {
+      policy.affinity = 1;
+    } else {
+      policy.affinity = 2;
+      policy.cpus = get_elements(parts[1], UINT32_MAX - 1);
+      if (policy.cpus.empty()) return;
+    }
+
+    if (parts.size() > 2) {
+      auto it = std::find(std::begin(scheds), std::end(scheds), parts[2]);
+      if (it == std::end(scheds)) return;
+      policy.sched = it - std::begin(scheds);
+    }
+
+    if (parts.size() > 3) {
+      char* end;
+      policy.priority = strtol(parts[3].c_str(), &end, 10);
+      if (parts[3].empty() || *end != '\0') return;
+    }
+
+    if (parts[0] == "ALL") {
+      for (auto& p : thread_policy_) p = policy;
+      continue;
+    }
+    auto it = std::find(std::begin(classes), std::end(classes), parts[0]);
+    if (it == std::end(classes)) return;
+    thread_policy_[it - std::begin(classes)] = policy;
+  }
+}
+
 }  // namespace rocr
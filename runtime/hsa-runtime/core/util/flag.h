@@ -171,6 +171,9 @@ class Flag {
     var = os::GetEnvVar("HSA_DISABLE_FRAGMENT_ALLOCATOR");
     disable_fragment_alloc_ = (var == "1") ? true : false;
 
+    var = os::GetEnvVar("HSA_DISABLE_SLAB_ALLOCATOR");
+    disable_slab_alloc_ = (var == "1") ? true : false;
+
     var = os::GetEnvVar("HSA_ENABLE_SDMA_HDP_FLUSH");
     enable_sdma_hdp_flush_ = (var == "0") ? false : true;
 
@@ -186,6 +189,24 @@ class Flag {
     var = os::GetEnvVar("HSA_NO_SCRATCH_THREAD_LIMITER");
     no_scratch_thread_limit_ = (var == "1") ? true : false;
 
+    // Size queue scratch from its recent demand histogram, warm and shrink it in the background.
+    var = os::GetEnvVar("HSA_SCRATCH_ELASTIC");
+    scratch_elastic_ = (var == "1") ? true : false;
+
+    // Sample the read and write index progress of every queue on the agent's monitor thread.
+    var = os::GetEnvVar("HSA_QUEUE_TELEMETRY");
+    queue_telemetry_ = (var == "1") ? true : false;
+
+    // Nanoseconds a thread elected to ring a hardware doorbell waits for concurrent submitters
+    // to the same queue to publish theirs, capped at 10us.  Zero rings every doorbell directly.
+    var = os::GetEnvVar("HSA_DOORBELL_COMBINE_NS");
+    doorbell_combine_ns_ = var.empty() ? 0 : Min(uint32_t(atoi(var.c_str())), 10000u);
+
+    // Queues lease main and alt scratch from the agent's shared cache and return it when idle.
+    // Leases are only returned on agents that support asynchronous scratch reclaim.
+    var = os::GetEnvVar("HSA_SCRATCH_SHARED");
+    scratch_shared_ = (var == "1") ? true : false;
+
     var = os::GetEnvVar("HSA_DISABLE_IMAGE");
     disable_image_ = (var == "1") ? true : false;
 
@@ -195,9 +216,74 @@ class Flag {
     var = os::GetEnvVar("HSA_LOADER_ENABLE_MMAP_URI");
     loader_enable_mmap_uri_ = (var == "1") ? true : false;
 
+    var = os::GetEnvVar("HSA_LOADER_DIRECT_UPLOAD");
+    loader_direct_upload_ = (var == "1") ? true : false;
+
+    var = os::GetEnvVar("HSA_LOADER_LAZY_CODE");
+    loader_lazy_code_ = (var == "1") ? true : false;
+
     var = os::GetEnvVar("HSA_FORCE_SDMA_SIZE");
     force_sdma_size_ = var.empty() ? 1024 * 1024 : atoi(var.c_str());
 
+    // Number of unlocked host registrations hsa_amd_memory_lock keeps for reuse.
+    // Zero disables the cache.
+    var = os::GetEnvVar("HSA_MEMORY_LOCK_CACHE_SIZE");
+    memory_lock_cache_size_ = var.empty() ? 0 : atoi(var.c_str());
+
+    // Copies of at least this many bytes are striped across all free SDMA engines.
+    // Zero disables striping.
+    // Number of destroyed queues each GPU keeps for reuse by hsa_queue_create.
+    // Zero disables the pool.
+    var = os::GetEnvVar("HSA_QUEUE_POOL_SIZE");
+    queue_pool_size_ = var.empty() ? 0 : atoi(var.c_str());
+
+    // Number of monitor samples a queue may spend near full before its ring is doubled on its
+    // way back into the queue pool.  Zero disables growth.
+    var = os::GetEnvVar("HSA_QUEUE_GROW_HITS");
+    queue_grow_hits_ = var.empty() ? 0 : atoi(var.c_str());
+
+    // Number of hardware queues each GPU multiplexes user queues onto.  Zero gives every queue
+    // its own hardware queue.
+    var = os::GetEnvVar("HSA_VIRTUAL_QUEUE_LIMIT");
+    virtual_queue_limit_ = var.empty() ? 0 : atoi(var.c_str());
+
+    // Minimum milliseconds between batches of queue priority updates.  Non-zero makes
+    // hsa_amd_queue_set_priority return before the driver is updated.
+    var = os::GetEnvVar("HSA_QUEUE_PRIORITY_INTERVAL");
+    queue_priority_interval_ = var.empty() ? 0 : atoi(var.c_str());
+
+    var = os::GetEnvVar("HSA_SDMA_STRIPE_SIZE");
+    sdma_stripe_size_ = var.empty() ? 0 : strtoull(var.c_str(), nullptr, 0);
+
+    var = os::GetEnvVar("HSA_SDMA_LOAD_BALANCE");
+    sdma_load_balance_ = (var == "1") ? true : false;
+
+    var = os::GetEnvVar("HSA_SDMA_INDIRECT_COPY_LIST");
+    sdma_indirect_copy_list_ = (var == "0") ? false : true;
+
+    // SDMA ring size in KB, rounded up to a power of two no smaller than the default 1MB.
+    var = os::GetEnvVar("HSA_SDMA_RING_SIZE");
+    sdma_ring_size_ = (var.empty() ? 0 : strtoull(var.c_str(), nullptr, 10)) << 10;
+
+    // Copy contexts submit on an SDMA queue of their own instead of the agent's shared rings.
+    var = os::GetEnvVar("HSA_SDMA_CONTEXT_RING");
+    sdma_context_ring_ = (var == "1") ? true : false;
+
+    // Lets SDMA copies skip the completion interrupt while no thread sleeps on the signal.
+    var = os::GetEnvVar("HSA_SDMA_COALESCE_INTERRUPTS");
+    sdma_coalesce_interrupts_ = (var == "1") ? true : false;
+
+    // Hot queue index and signal calls skip the API table unless a tool replaced them.
+    var = os::GetEnvVar("HSA_DIRECT_API_DISPATCH");
+    direct_api_dispatch_ = (var == "0") ? false : true;
+
+    var = os::GetEnvVar("HSA_AGENT_INIT_THREADS");
+    agent_init_threads_ = var.empty() ? 0 : atoi(var.c_str());
+
+    // Worker threads running CPU agent queues, zero for one per core of the agent.
+    var = os::GetEnvVar("HSA_CPU_QUEUE_THREADS");
+    cpu_queue_threads_ = var.empty() ? 4 : atoi(var.c_str());
+
     var = os::GetEnvVar("HSA_IGNORE_SRAMECC_MISREPORT");
     check_sramecc_validity_ = (var == "1") ? false : true;
 
@@ -223,6 +309,25 @@ class Flag {
     var = os::GetEnvVar("HSA_SVM_PROFILE");
     svm_profile_ = var;
 
+    var = os::GetEnvVar("HSA_SVM_PROFILE_FORMAT");
+    svm_profile_binary_ = (var == "binary") ? true : false;
+
+    // Size of the address ranges the SVM profiler counts events for, 0 disables counting.
+    var = os::GetEnvVar("HSA_SVM_PROFILE_AGGREGATE");
+    svm_profile_aggregate_ = var.empty() ? 0 : strtoull(var.c_str(), nullptr, 0);
+
+    // Runtime settling of SVM ranges that fault back and forth between agents, and the number
+    // of fault driven bounces within the observation window that marks a range as thrashing.
+    var = os::GetEnvVar("HSA_SVM_AUTO_MIGRATE");
+    svm_auto_migrate_ = (var == "1") ? true : false;
+    var = os::GetEnvVar("HSA_SVM_AUTO_MIGRATE_THRESHOLD");
+    svm_auto_migrate_threshold_ = var.empty() ? 4 : Max(atoi(var.c_str()), 1);
+
+    // Cache of hsa_amd_svm_attributes_get results, invalidated by attribute changes and SMI
+    // migration and unmap events.
+    var = os::GetEnvVar("HSA_SVM_ATTRIB_CACHE");
+    svm_attrib_cache_ = (var == "1") ? true : false;
+
     var = os::GetEnvVar("HSA_ENABLE_SRAMECC");
     sramecc_enable_ =
         (var == "0") ? SRAMECC_DISABLED : ((var == "1") ? SRAMECC_ENABLED : SRAMECC_DEFAULT);
@@ -230,6 +335,22 @@ class Flag {
     var = os::GetEnvVar("HSA_IMAGE_PRINT_SRD");
     image_print_srd_ = (var == "1") ? true : false;
 
+    // Largest image import/export done by the CPU when the image is host accessible, 0 disables.
+    var = os::GetEnvVar("HSA_IMAGE_HOST_COPY_SIZE");
+    image_host_copy_size_ = var.empty() ? 256 * 1024 : strtoull(var.c_str(), nullptr, 0);
+
+    // Largest async copy done by the CPU when both sides are host accessible, 0 disables.
+    var = os::GetEnvVar("HSA_HOST_COPY_SIZE");
+    host_copy_size_ = var.empty() ? 4096 : strtoull(var.c_str(), nullptr, 0);
+
+    // Linear image transfers and copies use SDMA rect copies unless disabled.
+    var = os::GetEnvVar("HSA_IMAGE_ENABLE_SDMA");
+    image_sdma_ = (var == "0") ? false : true;
+
+    // Opt-in DCC compression of tiled opaque images, which also grows their reported size.
+    var = os::GetEnvVar("HSA_IMAGE_ENABLE_DCC");
+    image_dcc_ = (var == "1") ? true : false;
+
     var = os::GetEnvVar("HSA_ENABLE_MWAITX");
     enable_mwaitx_ = (var == "1") ? true : false;
 
@@ -257,6 +378,101 @@ class Flag {
     /* hsa_signal_wait_relaxed abort timeout  */
     var = os::GetEnvVar("HSA_SIGNAL_WAIT_ABORT_TIMEOUT");
     signal_abort_timeout_ = var.empty() ? 0 : atoi(var.c_str());
+
+    // Host wait policy for signals which don't select one explicitly.
+    var = os::GetEnvVar("HSA_SIGNAL_WAIT_POLICY");
+    adaptive_signal_wait_ = (var == "ADAPTIVE" || var == "adaptive") ? true : false;
+
+    // Interrupt signals share this many KFD events instead of taking one each (0 disables).
+    // Signals fall back to sharing once KFD runs out of events regardless of this setting.
+    var = os::GetEnvVar("HSA_SIGNAL_SHARED_EVENTS");
+    signal_shared_events_ = var.empty() ? 0 : atoi(var.c_str());
+
+    // Number of threads servicing hsa_amd_signal_async_handler callbacks.
+    var = os::GetEnvVar("HSA_ASYNC_EVENT_THREADS");
+    async_event_threads_ = var.empty() ? 1 : atoi(var.c_str());
+
+    // File receiving periodic dumps of the runtime metrics, and the dump period in ms.  A period
+    // of 0 only dumps at shutdown.
+    metrics_dump_ = os::GetEnvVar("HSA_METRICS_DUMP");
+    var = os::GetEnvVar("HSA_METRICS_DUMP_INTERVAL");
+    metrics_dump_interval_ = var.empty() ? 1000 : atoi(var.c_str());
+
+    // Chrome trace file receiving the runtime timeline, and the spans buffered per thread.
+    timeline_trace_ = os::GetEnvVar("HSA_TIMELINE_TRACE");
+    var = os::GetEnvVar("HSA_TIMELINE_TRACE_BUFFER");
+    timeline_trace_buffer_ = var.empty() ? 16384 : atoi(var.c_str());
+
+    // GPU core dump writer threads (0 picks one per CPU), zstd compression of the dump and
+    // omission of read-only (code) mappings.
+    var = os::GetEnvVar("HSA_COREDUMP_THREADS");
+    coredump_threads_ = var.empty() ? 0 : atoi(var.c_str());
+    var = os::GetEnvVar("HSA_COREDUMP_COMPRESS");
+    coredump_compress_ = (var == "1") ? true : false;
+    var = os::GetEnvVar("HSA_COREDUMP_SKIP_READONLY");
+    coredump_skip_readonly_ = (var == "1") ? true : false;
+
+    // Unreferenced IPC attachments kept mapped for reuse by a later attach of the same handle.
+    var = os::GetEnvVar("HSA_IPC_ATTACH_CACHE_SIZE");
+    ipc_attach_cache_size_ = var.empty() ? 8 : atoi(var.c_str());
+
+    // Unreferenced interop mappings kept imported for reuse by a later map of the same buffer.
+    var = os::GetEnvVar("HSA_INTEROP_CACHE_SIZE");
+    interop_cache_size_ = var.empty() ? 8 : atoi(var.c_str());
+
+    // Host doorbells waking IPC signal waiters in other processes.
+    var = os::GetEnvVar("HSA_IPC_SIGNAL_DOORBELL");
+    ipc_signal_doorbell_ = (var == "0") ? false : true;
+
+    // Released vmem physical handles kept for reuse by hsa_amd_vmem_handle_create, in MB.
+    var = os::GetEnvVar("HSA_VMEM_HANDLE_CACHE");
+    vmem_handle_cache_size_ = (var.empty() ? 256 : strtoull(var.c_str(), nullptr, 10)) << 20;
+
+    // Pinned staging chunks used by hsa_memory_copy for pageable memory, in KB, and their count.
+    var = os::GetEnvVar("HSA_STAGING_CHUNK_SIZE");
+    staging_chunk_size_ = (var.empty() ? 4096 : strtoull(var.c_str(), nullptr, 10)) << 10;
+    if (staging_chunk_size_ == 0) staging_chunk_size_ = 4096 << 10;
+
+    var = os::GetEnvVar("HSA_STAGING_CHUNK_COUNT");
+    staging_chunk_count_ = var.empty() ? 3 : atoi(var.c_str());
+    if (staging_chunk_count_ == 0) staging_chunk_count_ = 1;
+
+    // Blocks released by hsa_amd_memory_pool_free_async kept for reuse, in MB.
+    var = os::GetEnvVar("HSA_ASYNC_FREE_CACHE");
+    async_free_cache_size_ = (var.empty() ? 256 : strtoull(var.c_str(), nullptr, 10)) << 20;
+
+    // Release freed memory on a background thread rather than the freeing thread.
+    var = os::GetEnvVar("HSA_DEFERRED_FREE");
+    deferred_free_ = (var == "1") ? true : false;
+
+    // Deliver deallocation callbacks in batches on the deferred free thread.  Callbacks then run
+    // after the memory is released, possibly after its address was handed out again.
+    var = os::GetEnvVar("HSA_DEFERRED_FREE_NOTIFY");
+    deferred_free_notify_ = (var == "1") ? true : false;
+
+    // GPU free memory, in MB, below which runtime caches are trimmed.  0 disables the monitor.
+    var = os::GetEnvVar("HSA_MEMORY_PRESSURE_WATERMARK");
+    memory_pressure_watermark_ = (var.empty() ? 0 : strtoull(var.c_str(), nullptr, 10)) << 20;
+
+    // Release fragment allocator blocks left unused for this many ms.  0 keeps them until trimmed.
+    var = os::GetEnvVar("HSA_FRAGMENT_CACHE_IDLE_MS");
+    fragment_cache_idle_ms_ = var.empty() ? 0 : strtoull(var.c_str(), nullptr, 10);
+
+    // VRAM allocations of at least this many MB get large page backing.  0 disables the policy.
+    var = os::GetEnvVar("HSA_LARGE_PAGE_THRESHOLD");
+    large_page_threshold_ = (var.empty() ? 256 : strtoull(var.c_str(), nullptr, 10)) << 20;
+
+    // Forked children drop the inherited runtime and may call hsa_init again.
+    var = os::GetEnvVar("HSA_FORK_SAFE");
+    fork_safe_ = (var == "1") ? true : false;
+
+    // hsa_shut_down leaves memory held in runtime caches to be reclaimed at process exit.
+    var = os::GetEnvVar("HSA_FAST_SHUTDOWN");
+    fast_shutdown_ = (var == "1") ? true : false;
+
+    // Placement and scheduling of runtime internal threads, see parse_thread_policy.
+    var = os::GetEnvVar("HSA_THREAD_POLICY");
+    parse_thread_policy(var);
   }
 
   void parse_masks(uint32_t maxGpu, uint32_t maxCU) {
@@ -288,6 +504,8 @@ class Flag {
 
   bool disable_fragment_alloc() const { return disable_fragment_alloc_; }
 
+  bool disable_slab_alloc() const { return disable_slab_alloc_; }
+
   bool rev_copy_dir() const { return rev_copy_dir_; }
 
   bool fine_grain_pcie() const { return fine_grain_pcie_; }
@@ -296,6 +514,14 @@ class Flag {
 
   bool no_scratch_thread_limiter() const { return no_scratch_thread_limit_; }
 
+  bool scratch_elastic() const { return scratch_elastic_; }
+
+  bool queue_telemetry() const { return queue_telemetry_; }
+
+  uint32_t doorbell_combine_ns() const { return doorbell_combine_ns_; }
+
+  bool scratch_shared() const { return scratch_shared_; }
+
   SDMA_OVERRIDE enable_sdma() const { return enable_sdma_; }
 
   SDMA_OVERRIDE enable_peer_sdma() const { return enable_peer_sdma_; }
@@ -330,14 +556,54 @@ class Flag {
 
   bool loader_enable_mmap_uri() const { return loader_enable_mmap_uri_; }
 
+  bool loader_direct_upload() const { return loader_direct_upload_; }
+
+  bool loader_lazy_code() const { return loader_lazy_code_; }
+
   size_t force_sdma_size() const { return force_sdma_size_; }
 
+  size_t sdma_stripe_size() const { return sdma_stripe_size_; }
+
+  bool sdma_load_balance() const { return sdma_load_balance_; }
+
+  bool sdma_indirect_copy_list() const { return sdma_indirect_copy_list_; }
+
+  size_t sdma_ring_size() const { return sdma_ring_size_; }
+
+  bool sdma_context_ring() const { return sdma_context_ring_; }
+
+  bool sdma_coalesce_interrupts() const { return sdma_coalesce_interrupts_; }
+
+  bool direct_api_dispatch() const { return direct_api_dispatch_; }
+
+  uint32_t agent_init_threads() const { return agent_init_threads_; }
+
+  uint32_t cpu_queue_threads() const { return cpu_queue_threads_; }
+
+  size_t memory_lock_cache_size() const { return memory_lock_cache_size_; }
+
+  size_t queue_pool_size() const { return queue_pool_size_; }
+
+  uint32_t queue_grow_hits() const { return queue_grow_hits_; }
+
+  uint32_t virtual_queue_limit() const { return virtual_queue_limit_; }
+
+  uint32_t queue_priority_interval() const { return queue_priority_interval_; }
+
   bool check_sramecc_validity() const { return check_sramecc_validity_; }
 
   bool override_cpu_affinity() const { return override_cpu_affinity_; }
 
   bool image_print_srd() const { return image_print_srd_; }
 
+  size_t image_host_copy_size() const { return image_host_copy_size_; }
+
+  size_t host_copy_size() const { return host_copy_size_; }
+
+  bool image_dcc() const { return image_dcc_; }
+
+  bool image_sdma() const { return image_sdma_; }
+
   bool check_mwaitx(bool mwaitx_supported) {
     if (enable_mwaitx_ && !mwaitx_supported) enable_mwaitx_ = false;
 
@@ -357,12 +623,41 @@ class Flag {
 
   bool cu_mask_skip_init() const { return cu_mask_skip_init_; }
 
+  bool fast_shutdown() const { return fast_shutdown_; }
+
+  bool fork_safe() const { return fork_safe_; }
+
+  // Placement and scheduling of a class of runtime threads.  Mirrors hsa_amd_thread_policy_t,
+  // classes, affinity and sched use the values of the matching hsa_amd_thread_* enums.
+  struct ThreadPolicy {
+    bool set = false;
+    uint32_t affinity = 0;
+    std::vector<uint32_t> cpus;
+    uint32_t sched = 0;
+    int32_t priority = 0;
+  };
+  static constexpr uint32_t kThreadClasses = 5;
+
+  const ThreadPolicy& thread_policy(uint32_t thread_class) const {
+    return thread_policy_[thread_class];
+  }
+
   bool coop_cu_count() const { return coop_cu_count_; }
 
   bool discover_copy_agents() const { return discover_copy_agents_; }
 
   const std::string& svm_profile() const { return svm_profile_; }
 
+  bool svm_profile_binary() const { return svm_profile_binary_; }
+
+  size_t svm_profile_aggregate() const { return svm_profile_aggregate_; }
+
+  bool svm_auto_migrate() const { return svm_auto_migrate_; }
+
+  uint32_t svm_auto_migrate_threshold() const { return svm_auto_migrate_threshold_; }
+
+  bool svm_attrib_cache() const { return svm_attrib_cache_; }
+
   SRAMECC_ENABLE sramecc_enable() const { return sramecc_enable_; }
 
   bool enable_ipc_mode_legacy() const { return enable_ipc_mode_legacy_; }
@@ -373,6 +668,50 @@ class Flag {
 
   uint32_t signal_abort_timeout() const { return signal_abort_timeout_; }
 
+  bool adaptive_signal_wait() const { return adaptive_signal_wait_; }
+
+  uint32_t signal_shared_events() const { return signal_shared_events_; }
+
+  uint32_t async_event_threads() const { return async_event_threads_; }
+
+  const std::string& metrics_dump() const { return metrics_dump_; }
+
+  uint32_t metrics_dump_interval() const { return metrics_dump_interval_; }
+
+  const std::string& timeline_trace() const { return timeline_trace_; }
+
+  uint32_t timeline_trace_buffer() const { return timeline_trace_buffer_; }
+
+  uint32_t coredump_threads() const { return coredump_threads_; }
+
+  bool coredump_compress() const { return coredump_compress_; }
+
+  bool coredump_skip_readonly() const { return coredump_skip_readonly_; }
+
+  uint32_t ipc_attach_cache_size() const { return ipc_attach_cache_size_; }
+
+  uint32_t interop_cache_size() const { return interop_cache_size_; }
+
+  bool ipc_signal_doorbell() const { return ipc_signal_doorbell_; }
+
+  size_t vmem_handle_cache_size() const { return vmem_handle_cache_size_; }
+
+  size_t staging_chunk_size() const { return staging_chunk_size_; }
+
+  uint32_t staging_chunk_count() const { return staging_chunk_count_; }
+
+  size_t async_free_cache_size() const { return async_free_cache_size_; }
+
+  bool deferred_free() const { return deferred_free_; }
+
+  bool deferred_free_notify() const { return deferred_free_notify_; }
+
+  size_t memory_pressure_watermark() const { return memory_pressure_watermark_; }
+
+  uint64_t fragment_cache_idle_ms() const { return fragment_cache_idle_ms_; }
+
+  size_t large_page_threshold() const { return large_page_threshold_; }
+
  private:
   bool check_flat_scratch_;
   bool enable_vm_fault_message_;
@@ -385,25 +724,60 @@ class Flag {
   bool report_tool_register_failures_ = false;
   bool disable_tool_register_ = false;
   bool disable_fragment_alloc_;
+  bool disable_slab_alloc_;
   bool rev_copy_dir_;
   bool fine_grain_pcie_;
   bool no_scratch_reclaim_;
   bool no_scratch_thread_limit_;
+  bool scratch_elastic_;
+  bool queue_telemetry_;
+  uint32_t doorbell_combine_ns_;
+  bool scratch_shared_;
   bool disable_image_;
   bool disable_pc_sampling_;
   bool loader_enable_mmap_uri_;
+  bool loader_direct_upload_;
+  bool loader_lazy_code_;
   bool check_sramecc_validity_;
   bool debug_;
   bool cu_mask_skip_init_;
+  bool fast_shutdown_;
+  bool fork_safe_;
   bool coop_cu_count_;
   bool discover_copy_agents_;
   bool override_cpu_affinity_;
   bool image_print_srd_;
+  size_t image_host_copy_size_;
+  size_t host_copy_size_;
+  bool image_dcc_;
+  bool image_sdma_;
   bool enable_mwaitx_;
   bool enable_ipc_mode_legacy_;
   bool wait_any_;
   bool dev_mem_queue_;
   uint32_t signal_abort_timeout_;
+  bool adaptive_signal_wait_;
+  uint32_t signal_shared_events_;
+  uint32_t async_event_threads_;
+  std::string metrics_dump_;
+  uint32_t metrics_dump_interval_;
+  std::string timeline_trace_;
+  uint32_t timeline_trace_buffer_;
+  uint32_t coredump_threads_;
+  bool coredump_compress_;
+  bool coredump_skip_readonly_;
+  uint32_t ipc_attach_cache_size_;
+  uint32_t interop_cache_size_;
+  bool ipc_signal_doorbell_;
+  size_t vmem_handle_cache_size_;
+  size_t staging_chunk_size_;
+  uint32_t staging_chunk_count_;
+  size_t async_free_cache_size_;
+  bool deferred_free_;
+  bool deferred_free_notify_;
+  size_t memory_pressure_watermark_;
+  uint64_t fragment_cache_idle_ms_;
+  size_t large_page_threshold_;
 
   SDMA_OVERRIDE enable_sdma_;
   SDMA_OVERRIDE enable_peer_sdma_;
@@ -424,8 +798,27 @@ class Flag {
 
   std::string tools_lib_names_;
   std::string svm_profile_;
+  bool svm_profile_binary_;
+  size_t svm_profile_aggregate_;
+  bool svm_auto_migrate_;
+  uint32_t svm_auto_migrate_threshold_;
+  bool svm_attrib_cache_;
 
   size_t force_sdma_size_;
+  size_t sdma_stripe_size_;
+  bool sdma_load_balance_;
+  bool sdma_indirect_copy_list_;
+  size_t sdma_ring_size_;
+  bool sdma_context_ring_;
+  bool sdma_coalesce_interrupts_;
+  bool direct_api_dispatch_;
+  uint32_t agent_init_threads_;
+  uint32_t cpu_queue_threads_;
+  size_t memory_lock_cache_size_;
+  size_t queue_pool_size_;
+  uint32_t queue_grow_hits_;
+  uint32_t virtual_queue_limit_;
+  uint32_t queue_priority_interval_;
 
   // Indicates user preference for Xnack state.
   XNACK_REQUEST xnack_;
@@ -439,6 +832,10 @@ class Flag {
 
   void parse_masks(std::string& args, uint32_t maxGpu, uint32_t maxCU);
 
+  ThreadPolicy thread_policy_[kThreadClasses];
+
+  void parse_thread_policy(std::string& var);
+
   DISALLOW_COPY_AND_ASSIGN(Flag);
 };
 
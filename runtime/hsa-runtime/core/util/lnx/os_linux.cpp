@@ -46,17 +46,24 @@
 
 #include <link.h>
 #include <dlfcn.h>
+#include <dirent.h>
+#include <linux/futex.h>
 #include <pthread.h>
 #include <limits.h>
 #include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/sysinfo.h>
 #include <sys/time.h>
 #include <sys/utsname.h>
 #include <unistd.h>
 #include <errno.h>
+#include <cstdio>
 #include <cstring>
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <utility>
 #include <semaphore.h>
@@ -77,20 +84,81 @@ namespace os {
 struct ThreadArgs {
   void* entry_args;
   ThreadEntry entry_function;
+  uint32_t tag;
+  const void* context;
+  // Guarded by thread_list_lock.
+  ThreadPolicy policy;
+  pid_t tid;
 };
 
+class os_thread;
+
+// Live threads for SetThreadPolicy, intentionally leaked to outlive static destructors.
+static std::mutex thread_list_lock;
+static std::set<os_thread*>& ThreadList() {
+  static std::set<os_thread*>* list = new std::set<os_thread*>();
+  return *list;
+}
+
+static bool SetCpus(pthread_t thread, pthread_attr_t* attrib, const std::vector<uint32_t>& cpus) {
+  int cores = get_nprocs_conf();
+  cpu_set_t* cpuset = CPU_ALLOC(cores);
+  if (cpuset == nullptr) {
+    fprintf(stderr, "CPU_ALLOC failed: %s\n", strerror(errno));
+    return false;
+  }
+  CPU_ZERO_S(CPU_ALLOC_SIZE(cores), cpuset);
+  for (uint32_t cpu : cpus) {
+    if (cpu < uint32_t(cores)) CPU_SET_S(cpu, CPU_ALLOC_SIZE(cores), cpuset);
+  }
+  int err = (attrib != nullptr)
+      ? pthread_attr_setaffinity_np(attrib, CPU_ALLOC_SIZE(cores), cpuset)
+      : pthread_setaffinity_np(thread, CPU_ALLOC_SIZE(cores), cpuset);
+  CPU_FREE(cpuset);
+  if (err != 0) {
+    fprintf(stderr, "pthread_setaffinity_np failed: %s\n", strerror(err));
+    return false;
+  }
+  return true;
+}
+
+static bool ApplyThreadPolicy(pthread_t thread, pid_t tid, const ThreadPolicy& policy) {
+  bool ret = true;
+  if (!policy.cpus.empty()) ret &= SetCpus(thread, nullptr, policy.cpus);
+
+  const bool real_time = policy.sched >= ThreadPolicy::kFifo;
+  if (policy.sched != ThreadPolicy::kDefault) {
+    static const int classes[] = {SCHED_OTHER, SCHED_OTHER, SCHED_BATCH,
+                                  SCHED_IDLE,  SCHED_FIFO,  SCHED_RR};
+    sched_param param = {};
+    if (real_time) param.sched_priority = policy.priority;
+    // Real time classes usually need CAP_SYS_NICE, report rather than fail the thread.
+    ret &= (pthread_setschedparam(thread, classes[policy.sched], &param) == 0);
+  }
+  // Nice values are per thread on Linux.
+  if (!real_time && (policy.sched != ThreadPolicy::kDefault || policy.priority != 0))
+    ret &= (setpriority(PRIO_PROCESS, tid, policy.priority) == 0);
+  return ret;
+}
+
+static void ThreadStarted(ThreadArgs* args);
+static void ThreadExited(ThreadArgs* args);
+
 void* __stdcall ThreadTrampoline(void* arg) {
   ThreadArgs* ar = (ThreadArgs*)arg;
   ThreadEntry CallMe = ar->entry_function;
   void* Data = ar->entry_args;
+  ThreadStarted(ar);
   CallMe(Data);
+  ThreadExited(ar);
   return nullptr;
 }
 
 // Thread container allows multiple waits and separate close (destroy).
 class os_thread {
  public:
-  explicit os_thread(ThreadEntry function, void* threadArgument, uint stackSize)
+  explicit os_thread(ThreadEntry function, void* threadArgument, uint stackSize, uint32_t tag,
+                     const void* context, const ThreadPolicy* policy)
       : thread(0), lock(nullptr), state(RUNNING) {
     int err;
     lock = CreateMutex();
@@ -98,6 +166,10 @@ class os_thread {
 
     args.entry_args = threadArgument;
     args.entry_function = function;
+    args.tag = tag;
+    args.context = context;
+    if (policy != nullptr) args.policy = *policy;
+    args.tid = 0;
 
     pthread_attr_t attrib;
     err = pthread_attr_init(&attrib);
@@ -121,28 +193,17 @@ class os_thread {
       }
     }
 
-    int cores = 0;
-    cpu_set_t* cpuset = nullptr;
-
-    if (core::Runtime::runtime_singleton_->flag().override_cpu_affinity()) {
-      cores = get_nprocs_conf();
-      cpuset = CPU_ALLOC(cores);
-      if (cpuset == nullptr) {
-        fprintf(stderr, "CPU_ALLOC failed: %s\n", strerror(errno));
-        return;
-      }
-      CPU_ZERO_S(CPU_ALLOC_SIZE(cores), cpuset);
-      for (int i = 0; i < cores; i++) {
-        CPU_SET_S(i, CPU_ALLOC_SIZE(cores), cpuset);
-      }
-      err = pthread_attr_setaffinity_np(&attrib, CPU_ALLOC_SIZE(cores), cpuset);
-      CPU_FREE(cpuset);
-      if (err != 0) {
-        fprintf(stderr, "pthread_setaffinity_np failed: %s\n", strerror(err));
-        return;
-      }
+    // Without a placement the thread may use all cores rather than inherit the creator's mask.
+    if (!args.policy.cpus.empty()) {
+      if (!SetCpus(0, &attrib, args.policy.cpus)) return;
+    } else if (core::Runtime::runtime_singleton_->flag().override_cpu_affinity()) {
+      std::vector<uint32_t> all(get_nprocs_conf());
+      for (uint32_t i = 0; i < all.size(); i++) all[i] = i;
+      if (!SetCpus(0, &attrib, all)) return;
     }
 
+    // Register before the thread starts so policy changes are never missed.
+    std::lock_guard<std::mutex> list_lock(thread_list_lock);
     do {
       err = pthread_create(&thread, &attrib, ThreadTrampoline, &args);
       if (!err) break;
@@ -162,20 +223,27 @@ class os_thread {
         return;
       }
     } while (stackSize < 20 * 1024 * 1024);
+    if (thread != 0) ThreadList().insert(this);
   }
 
   os_thread(os_thread&& rhs) {
+    std::lock_guard<std::mutex> list_lock(thread_list_lock);
     thread = rhs.thread;
     args = rhs.args;
     lock = rhs.lock;
     state = int(rhs.state);
     rhs.thread = 0;
     rhs.lock = nullptr;
+    if (ThreadList().erase(&rhs) != 0) ThreadList().insert(this);
   }
 
   os_thread(os_thread&) = delete;
 
   ~os_thread() {
+    {
+      std::lock_guard<std::mutex> list_lock(thread_list_lock);
+      ThreadList().erase(this);
+    }
     if (lock != nullptr) DestroyMutex(lock);
     if ((state == RUNNING) && (thread != 0)) {
       int err = pthread_detach(thread);
@@ -183,6 +251,19 @@ class os_thread {
     }
   }
 
+  // Requires thread_list_lock.  A thread that has not started yet applies the policy itself,
+  // one that has exited may already be joined so its handle must not be used.
+  bool SetPolicy(const ThreadPolicy& policy) {
+    args.policy = policy;
+    if (args.tid < 0) return false;
+    if (args.tid == 0) return true;
+    return ApplyThreadPolicy(thread, args.tid, policy);
+  }
+
+  ThreadArgs* Args() { return &args; }
+  uint32_t Tag() const { return args.tag; }
+  const void* Context() const { return args.context; }
+
   bool Valid() { return (lock != nullptr) && (thread != 0); }
 
   bool Wait() {
@@ -207,6 +288,27 @@ class os_thread {
   enum { FINISHED = 0, RUNNING = 1 };
 };
 
+// The container may be closed while the thread runs, only touch args while it is registered.
+static bool Registered(ThreadArgs* args) {
+  for (os_thread* thread : ThreadList()) {
+    if (thread->Args() == args) return true;
+  }
+  return false;
+}
+
+static void ThreadStarted(ThreadArgs* args) {
+  // Apply the latest policy, SetThreadPolicy may have run before the thread started.
+  std::lock_guard<std::mutex> lock(thread_list_lock);
+  if (!Registered(args)) return;
+  args->tid = syscall(SYS_gettid);
+  ApplyThreadPolicy(pthread_self(), args->tid, args->policy);
+}
+
+static void ThreadExited(ThreadArgs* args) {
+  std::lock_guard<std::mutex> lock(thread_list_lock);
+  if (Registered(args)) args->tid = -1;
+}
+
 static_assert(sizeof(LibHandle) == sizeof(void*), "OS abstraction size mismatch");
 static_assert(sizeof(Semaphore) == sizeof(sem_t*), "OS abstraction size mismatch");
 static_assert(sizeof(Mutex) == sizeof(pthread_mutex_t*), "OS abstraction size mismatch");
@@ -413,8 +515,115 @@ void uSleep(int delayInUs) { usleep(delayInUs); }
 
 void YieldThread() { sched_yield(); }
 
-Thread CreateThread(ThreadEntry function, void* threadArgument, uint stackSize) {
-  os_thread* result = new os_thread(function, threadArgument, stackSize);
+uint32_t CurrentCpu() {
+  int cpu = sched_getcpu();
+  return (cpu < 0) ? 0 : cpu;
+}
+
+bool SetThreadAffinity(const uint32_t* cpus, uint32_t count) {
+  int cores = get_nprocs_conf();
+  cpu_set_t* cpuset = CPU_ALLOC(cores);
+  if (cpuset == nullptr) return false;
+  CPU_ZERO_S(CPU_ALLOC_SIZE(cores), cpuset);
+  for (uint32_t i = 0; i < count; i++) {
+    if (cpus[i] < uint32_t(cores)) CPU_SET_S(cpus[i], CPU_ALLOC_SIZE(cores), cpuset);
+  }
+  int err = pthread_setaffinity_np(pthread_self(), CPU_ALLOC_SIZE(cores), cpuset);
+  CPU_FREE(cpuset);
+  return err == 0;
+}
+
+void LowerThreadPriority() {
+  // Nice values are per thread on Linux.
+  const id_t tid = syscall(SYS_gettid);
+  errno = 0;
+  const int nice = getpriority(PRIO_PROCESS, tid);
+  if (errno == 0) setpriority(PRIO_PROCESS, tid, std::min(nice + 10, 19));
+}
+
+static int ReadNumaNode(const std::string& device_dir) {
+  int node = -1;
+  FILE* file = fopen((device_dir + "/numa_node").c_str(), "r");
+  if (file == nullptr) return -1;
+  if (fscanf(file, "%d", &node) != 1) node = -1;
+  fclose(file);
+  return node;
+}
+
+int GetPciNumaNode(uint32_t domain, uint32_t bdfid) {
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/bus/pci/devices/%04x:%02x:%02x.%x", domain,
+           (bdfid >> 8) & 0xff, (bdfid >> 3) & 0x1f, bdfid & 0x7);
+  return ReadNumaNode(path);
+}
+
+uint32_t GetPciMemoryPartitions(uint32_t domain, uint32_t bdfid) {
+  char path[96];
+  snprintf(path, sizeof(path), "/sys/bus/pci/devices/%04x:%02x:%02x.%x/current_memory_partition",
+           domain, (bdfid >> 8) & 0xff, (bdfid >> 3) & 0x1f, bdfid & 0x7);
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) return 0;
+
+  // The mode reads as NPS1, NPS2, NPS4 or NPS8.
+  uint32_t partitions = 0;
+  if (fscanf(file, "NPS%u", &partitions) != 1) partitions = 0;
+  fclose(file);
+  return partitions;
+}
+
+std::vector<NetDevice> GetNetDevices() {
+  std::vector<NetDevice> devices;
+  DIR* dir = opendir("/sys/class/net");
+  if (dir == nullptr) return devices;
+
+  while (dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] == '.') continue;
+    // Virtual interfaces have no device link, PCI ones resolve to a DDDD:BB:DD.F directory.
+    const std::string device_dir = std::string("/sys/class/net/") + entry->d_name + "/device";
+    char target[PATH_MAX];
+    if (realpath(device_dir.c_str(), target) == nullptr) continue;
+    const char* bdf = strrchr(target, '/');
+    uint32_t domain, bus, dev, fn;
+    if (bdf == nullptr || sscanf(bdf + 1, "%x:%x:%x.%x", &domain, &bus, &dev, &fn) != 4) continue;
+
+    NetDevice device;
+    device.name = entry->d_name;
+    device.domain = domain;
+    device.bdfid = (bus << 8) | (dev << 3) | fn;
+    device.numa_node = ReadNumaNode(device_dir);
+    devices.push_back(std::move(device));
+  }
+  closedir(dir);
+  return devices;
+}
+
+std::vector<uint32_t> GetNumaNodeCpus(int node) {
+  std::vector<uint32_t> cpus;
+  if (node < 0) return cpus;
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) return cpus;
+
+  // cpulist holds ranges like 0-7,16-23.
+  uint32_t first, last;
+  while (fscanf(file, "%u", &first) == 1) {
+    last = first;
+    int sep = fgetc(file);
+    if (sep == '-') {
+      if (fscanf(file, "%u", &last) != 1) break;
+      sep = fgetc(file);
+    }
+    for (uint32_t cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    if (sep != ',') break;
+  }
+  fclose(file);
+  return cpus;
+}
+
+Thread CreateThread(ThreadEntry function, void* threadArgument, uint stackSize, uint32_t tag,
+                    const void* context, const ThreadPolicy* policy) {
+  os_thread* result = new os_thread(function, threadArgument, stackSize, tag, context, policy);
   if (!result->Valid()) {
     delete result;
     return nullptr;
@@ -425,6 +634,18 @@ Thread CreateThread(ThreadEntry function, void* threadArgument, uint stackSize)
 
 void CloseThread(Thread thread) { delete reinterpret_cast<os_thread*>(thread); }
 
+bool SetThreadPolicy(Thread thread, const ThreadPolicy& policy) {
+  std::lock_guard<std::mutex> lock(thread_list_lock);
+  return reinterpret_cast<os_thread*>(thread)->SetPolicy(policy);
+}
+
+void SetThreadPolicy(uint32_t tag, const std::function<ThreadPolicy(const void*)>& policy) {
+  std::lock_guard<std::mutex> lock(thread_list_lock);
+  for (os_thread* thread : ThreadList()) {
+    if (thread->Tag() == tag) thread->SetPolicy(policy(thread->Context()));
+  }
+}
+
 bool WaitForThread(Thread thread) { return reinterpret_cast<os_thread*>(thread)->Wait(); }
 
 bool WaitForAllThreads(Thread* threads, uint threadCount) {
@@ -432,6 +653,35 @@ bool WaitForAllThreads(Thread* threads, uint threadCount) {
   return true;
 }
 
+static void (*fork_prepare)();
+static void (*fork_parent)();
+static void (*fork_child)();
+
+static void PrepareFork() {
+  fork_prepare();
+  thread_list_lock.lock();
+}
+
+static void ParentFork() {
+  thread_list_lock.unlock();
+  fork_parent();
+}
+
+static void ChildFork() {
+  // Only the forking thread exists in the child.
+  ThreadList().clear();
+  thread_list_lock.unlock();
+  fork_child();
+}
+
+bool RegisterForkHandlers(void (*prepare)(), void (*parent)(), void (*child)()) {
+  if (fork_prepare != nullptr) return false;
+  fork_prepare = prepare;
+  fork_parent = parent;
+  fork_child = child;
+  return pthread_atfork(PrepareFork, ParentFork, ChildFork) == 0;
+}
+
 bool IsEnvVarSet(std::string env_var_name) {
   char* buff = NULL;
   buff = getenv(env_var_name.c_str());
@@ -479,26 +729,100 @@ size_t GetUsablePhysicalHostMemorySize() {
 
 uintptr_t GetUserModeVirtualMemoryBase() { return (uintptr_t)0; }
 
+#ifndef SYS_futex_waitv
+#define SYS_futex_waitv 449
+#endif
+
+// struct futex_waitv and its flags, missing from pre 5.16 kernel headers.
+struct FutexWaitv {
+  uint64_t val;
+  uint64_t uaddr;
+  uint32_t flags;
+  uint32_t reserved;
+};
+static const uint32_t kFutex2Size32 = 0x02;
+static const uint32_t kFutexWaitvMax = 128;
+static std::atomic<bool> futex_waitv_supported(true);
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex word size mismatch");
+
+static timespec MilliSecondsToTimespec(uint32_t milli_seconds) {
+  timespec ts;
+  ts.tv_sec = milli_seconds / 1000;
+  ts.tv_nsec = (milli_seconds % 1000) * 1000000;
+  return ts;
+}
+
+static uint64_t MonotonicMilliSeconds() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return uint64_t(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
+bool FutexWait(std::atomic<uint32_t>* word, uint32_t expected, uint32_t milli_seconds) {
+  // FUTEX_WAIT takes a relative timeout.
+  timespec timeout = MilliSecondsToTimespec(milli_seconds);
+  long ret = syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected,
+                     (milli_seconds == 0xFFFFFFFF) ? nullptr : &timeout, nullptr, 0);
+  return !(ret == -1 && errno == ETIMEDOUT);
+}
+
+void FutexWake(std::atomic<uint32_t>* word, bool all) {
+  syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, nullptr, nullptr, 0);
+}
+
+bool FutexWaitMultiple(std::atomic<uint32_t>* const* words, const uint32_t* expected,
+                       uint32_t count, uint32_t milli_seconds) {
+  assert(count <= kFutexWaitvMax && "Too many futex words.");
+  if (count == 1) return FutexWait(words[0], expected[0], milli_seconds);
+
+  if (futex_waitv_supported.load(std::memory_order_relaxed)) {
+    FutexWaitv waiters[kFutexWaitvMax];
+    for (uint32_t i = 0; i < count; i++)
+      waiters[i] = {expected[i], uint64_t(uintptr_t(words[i])), kFutex2Size32 | FUTEX_PRIVATE_FLAG,
+                    0};
+
+    // futex_waitv takes an absolute timeout.
+    timespec deadline;
+    if (milli_seconds != 0xFFFFFFFF) {
+      clock_gettime(CLOCK_MONOTONIC, &deadline);
+      timespec timeout = MilliSecondsToTimespec(milli_seconds);
+      deadline.tv_sec += timeout.tv_sec;
+      deadline.tv_nsec += timeout.tv_nsec;
+      if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+      }
+    }
+    long ret = syscall(SYS_futex_waitv, waiters, count, 0,
+                       (milli_seconds == 0xFFFFFFFF) ? nullptr : &deadline, CLOCK_MONOTONIC);
+    if (ret >= 0 || errno != ENOSYS) return !(ret == -1 && errno == ETIMEDOUT);
+    futex_waitv_supported.store(false, std::memory_order_relaxed);
+  }
+
+  // Kernels without futex_waitv: sleep on the first word in 1ms slices and check the rest.
+  const uint64_t start = MonotonicMilliSeconds();
+  while (true) {
+    for (uint32_t i = 0; i < count; i++)
+      if (words[i]->load(std::memory_order_acquire) != expected[i]) return true;
+    if (milli_seconds != 0xFFFFFFFF && MonotonicMilliSeconds() - start >= milli_seconds)
+      return false;
+    FutexWait(words[0], expected[0], 1);
+  }
+}
+
 // Os event implementation
+// state is 1 when set.  Waiters sleep on it with FutexWait.
 typedef struct EventDescriptor_ {
-  pthread_cond_t event;
-  pthread_mutex_t mutex;
-  bool state;
+  std::atomic<uint32_t> state;
   bool auto_reset;
 } EventDescriptor;
 
 EventHandle CreateOsEvent(bool auto_reset, bool init_state) {
-  EventDescriptor* eventDescrp;
-  eventDescrp = (EventDescriptor*)malloc(sizeof(EventDescriptor));
-
-  pthread_mutex_init(&eventDescrp->mutex, NULL);
-  pthread_cond_init(&eventDescrp->event, NULL);
+  EventDescriptor* eventDescrp = new EventDescriptor;
+  eventDescrp->state.store(init_state ? 1 : 0, std::memory_order_relaxed);
   eventDescrp->auto_reset = auto_reset;
-  eventDescrp->state = init_state;
-
-  EventHandle handle = reinterpret_cast<EventHandle>(eventDescrp);
-
-  return handle;
+  return reinterpret_cast<EventHandle>(eventDescrp);
 }
 
 int DestroyOsEvent(EventHandle event) {
@@ -506,11 +830,8 @@ int DestroyOsEvent(EventHandle event) {
     return -1;
   }
 
-  EventDescriptor* eventDescrp = reinterpret_cast<EventDescriptor*>(event);
-  int ret_code = pthread_cond_destroy(&eventDescrp->event);
-  ret_code |= pthread_mutex_destroy(&eventDescrp->mutex);
-  free(eventDescrp);
-  return ret_code;
+  delete reinterpret_cast<EventDescriptor*>(event);
+  return 0;
 }
 
 int WaitForOsEvent(EventHandle event, unsigned int milli_seconds) {
@@ -519,57 +840,24 @@ int WaitForOsEvent(EventHandle event, unsigned int milli_seconds) {
   }
 
   EventDescriptor* eventDescrp = reinterpret_cast<EventDescriptor*>(event);
-  // Event wait time is 0 and state is non-signaled, return directly
-  if (milli_seconds == 0) {
-    int tmp_ret = pthread_mutex_trylock(&eventDescrp->mutex);
-    if (tmp_ret == EBUSY) {
-      // Timeout
-      return 1;
-    }
-  }
-
-  int ret_code = 0;
-  pthread_mutex_lock(&eventDescrp->mutex);
-  if (!eventDescrp->state) {
-    if (milli_seconds == 0) {
-      ret_code = 1;
-    } else {
-      struct timespec ts;
-      struct timeval tp;
-
-      ret_code = gettimeofday(&tp, NULL);
-      ts.tv_sec = tp.tv_sec;
-      ts.tv_nsec = tp.tv_usec * 1000;
-
-      unsigned int sec = milli_seconds / 1000;
-      unsigned int mSec = milli_seconds % 1000;
-
-      ts.tv_sec += sec;
-      ts.tv_nsec += mSec * 1000000;
-
-      // More then one second, add 1 sec to the tv_sec elem
-      if (ts.tv_nsec > 1000000000) {
-        ts.tv_sec += 1;
-        ts.tv_nsec = ts.tv_nsec - 1000000000;
-      }
-
-      ret_code =
-          pthread_cond_timedwait(&eventDescrp->event, &eventDescrp->mutex, &ts);
-      // Time out
-      if (ret_code == 110) {
-        ret_code = 0x14003;  // 1 means time out in HSA
-      }
-
-      if (ret_code == 0 && eventDescrp->auto_reset) {
-        eventDescrp->state = false;
-      }
+  const uint64_t start = (milli_seconds == 0xFFFFFFFF) ? 0 : MonotonicMilliSeconds();
+  while (true) {
+    // Auto reset events are consumed by the waiter that observes them set.
+    uint32_t set = 1;
+    if (eventDescrp->auto_reset
+            ? eventDescrp->state.compare_exchange_strong(set, 0, std::memory_order_acquire)
+            : eventDescrp->state.load(std::memory_order_acquire) == 1)
+      return 0;
+
+    if (milli_seconds == 0) return 1;
+    uint32_t remaining = milli_seconds;
+    if (milli_seconds != 0xFFFFFFFF) {
+      const uint64_t elapsed = MonotonicMilliSeconds() - start;
+      if (elapsed >= milli_seconds) return 0x14003;  // Time out
+      remaining = milli_seconds - elapsed;
     }
-  } else if (eventDescrp->auto_reset) {
-    eventDescrp->state = false;
+    FutexWait(&eventDescrp->state, 0, remaining);
   }
-  pthread_mutex_unlock(&eventDescrp->mutex);
-
-  return ret_code;
 }
 
 int SetOsEvent(EventHandle event) {
@@ -578,13 +866,9 @@ int SetOsEvent(EventHandle event) {
   }
 
   EventDescriptor* eventDescrp = reinterpret_cast<EventDescriptor*>(event);
-  int ret_code = 0;
-  ret_code = pthread_mutex_lock(&eventDescrp->mutex);
-  eventDescrp->state = true;
-  ret_code = pthread_mutex_unlock(&eventDescrp->mutex);
-  ret_code |= pthread_cond_signal(&eventDescrp->event);
-
-  return ret_code;
+  if (eventDescrp->state.exchange(1, std::memory_order_release) == 0)
+    FutexWake(&eventDescrp->state, !eventDescrp->auto_reset);
+  return 0;
 }
 
 int ResetOsEvent(EventHandle event) {
@@ -593,12 +877,8 @@ int ResetOsEvent(EventHandle event) {
   }
 
   EventDescriptor* eventDescrp = reinterpret_cast<EventDescriptor*>(event);
-  int ret_code = 0;
-  ret_code = pthread_mutex_lock(&eventDescrp->mutex);
-  eventDescrp->state = false;
-  ret_code = pthread_mutex_unlock(&eventDescrp->mutex);
-
-  return ret_code;
+  eventDescrp->state.store(0, std::memory_order_relaxed);
+  return 0;
 }
 
 static double invPeriod = 0.0;
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+// 
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+// 
+// Developed by:
+// 
+//                 AMD Research and AMD HSA Software Development
+// 
+//                 Advanced Micro Devices, Inc.
+// 
+//                 www.amd.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "core/util/locks.h"
+
+#ifdef HSA_LOCK_STATS
+
+#include <cstring>
+#include <vector>
+
+namespace rocr {
+
+namespace {
+
+struct LockRegistry {
+  KernelMutex lock;
+  std::vector<LockStats*> stats;
+};
+
+// Leaked so locks destroyed during static destruction can still be reported.
+LockRegistry& registry() {
+  static LockRegistry* registry = new LockRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+LockStats::LockStats(const char* lock_name) : name(lock_name), acquires(0), contended(0) {
+  for (auto& bucket : wait_ns_histogram) bucket.store(0, std::memory_order_relaxed);
+  for (auto& entry : sites) {
+    entry.site = LockSite{"unknown", 0};
+    entry.contended.store(0, std::memory_order_relaxed);
+  }
+  num_sites.store(1, std::memory_order_relaxed);
+}
+
+LockStats* LockStats::Get(const char* name) {
+  LockRegistry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  for (LockStats* stats : reg.stats)
+    if (strcmp(stats->name, name) == 0) return stats;
+  reg.stats.push_back(new LockStats(name));
+  return reg.stats.back();
+}
+
+void LockStats::Iterate(void (*callback)(const LockStats& stats, void* data), void* data) {
+  LockRegistry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  for (const LockStats* stats : reg.stats) callback(*stats, data);
+}
+
+uint32_t LockStats::Site(const LockSite& site) {
+  // Sites are only appended and published by num_sites, so lookups need no lock.
+  auto find = [&](uint32_t count) -> uint32_t {
+    for (uint32_t i = 1; i < count; i++)
+      if (sites[i].site.line == site.line && strcmp(sites[i].site.file, site.file) == 0) return i;
+    return 0;
+  };
+  uint32_t index = find(num_sites.load(std::memory_order_acquire));
+  if (index != 0) return index;
+
+  LockRegistry& reg = registry();
+  ScopedAcquire<KernelMutex> lock(&reg.lock);
+  const uint32_t count = num_sites.load(std::memory_order_relaxed);
+  index = find(count);
+  if (index != 0 || count == kSites) return index;
+  sites[count].site = site;
+  num_sites.store(count + 1, std::memory_order_release);
+  return count;
+}
+
+}  // namespace rocr
+
+#endif  // HSA_LOCK_STATS
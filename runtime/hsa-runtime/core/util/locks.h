@@ -50,51 +50,193 @@
 
 namespace rocr {
 
-class HybridMutex {
+/// @brief: Source location of a ScopedAcquire.  Only captured when built with HSA_LOCK_STATS.
+struct LockSite {
+#ifdef HSA_LOCK_STATS
+  static constexpr LockSite Here(const char* file = __builtin_FILE(),
+                                 uint32_t line = __builtin_LINE()) {
+    return LockSite{file, line};
+  }
+  const char* file;
+  uint32_t line;
+#else
+  static constexpr LockSite Here() { return LockSite(); }
+#endif
+};
+
+#ifdef HSA_LOCK_STATS
+/// @brief: Contention statistics shared by all locks constructed with the same name.
+/// Acquires and contended acquires are counted, contended waits are recorded in a log2 histogram
+/// of nanoseconds, and each contended acquire is charged to the ScopedAcquire site that held the
+/// lock when the wait started.  Reported by Metrics.
+class LockStats {
+ public:
+  static const uint32_t kBuckets = 64;
+  static const uint32_t kSites = 32;
+
+  /// @brief: Returns the statistics of name, creating them on first use.  Never freed.
+  static LockStats* Get(const char* name);
+
+  /// @brief: Calls callback on the statistics of every name.
+  static void Iterate(void (*callback)(const LockStats& stats, void* data), void* data);
+
+  /// @brief: Returns the index of site in sites, 0 (unknown) if the table is full.
+  uint32_t Site(const LockSite& site);
+
+  void Acquired() { acquires.fetch_add(1, std::memory_order_relaxed); }
+
+  void Contended(uint64_t wait_ns, uint32_t holder) {
+    contended.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t bucket = (wait_ns == 0) ? 0 : Min<uint32_t>(64 - __builtin_clzll(wait_ns),
+                                                               kBuckets - 1);
+    wait_ns_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    sites[holder].contended.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  const char* name;
+  std::atomic<uint64_t> acquires;
+  std::atomic<uint64_t> contended;
+  std::atomic<uint64_t> wait_ns_histogram[kBuckets];
+  // Entry 0 collects contention whose holder did not go through ScopedAcquire.
+  struct {
+    LockSite site;
+    std::atomic<uint64_t> contended;
+  } sites[kSites];
+  std::atomic<uint32_t> num_sites;
+
+ private:
+  explicit LockStats(const char* lock_name);
+};
+
+/// @brief: Per lock hooks into the LockStats named by the lock's constructor argument.  Locks
+/// constructed without a name are not tracked.
+class LockProfile {
  public:
-  HybridMutex():lock_(0) { 
-    sem_ = os::CreateSemaphore(); 
+  /// @brief: Records holder as the current owner's acquire site.
+  void Held(const LockSite& holder) {
+    if (stats_ != nullptr) holder_.store(stats_->Site(holder), std::memory_order_relaxed);
   }
 
-  ~HybridMutex() { 
-    os::DestroySemaphore(sem_); 
+ protected:
+  explicit LockProfile(const char* name)
+      : stats_(name == nullptr ? nullptr : LockStats::Get(name)), holder_(0) {}
+
+  template <class TryFn, class AcquireFn>
+  __forceinline bool ProfiledAcquire(TryFn try_acquire, AcquireFn acquire) {
+    if (stats_ == nullptr) return acquire();
+    if (!try_acquire()) {
+      const uint32_t holder = holder_.load(std::memory_order_relaxed);
+      const uint64_t start = os::ReadAccurateClock();
+      if (!acquire()) return false;
+      const double ticks = double(os::ReadAccurateClock() - start);
+      stats_->Contended(uint64_t(ticks * 1e9 / double(os::AccurateClockFrequency())), holder);
+    }
+    stats_->Acquired();
+    return true;
   }
 
+  __forceinline void ProfiledRelease() {
+    if (stats_ != nullptr) holder_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  LockStats* stats_;
+  std::atomic<uint32_t> holder_;
+};
+#else
+class LockProfile {
+ public:
+  void Held(const LockSite&) {}
+
+ protected:
+  explicit LockProfile(const char*) {}
+
+  template <class TryFn, class AcquireFn>
+  __forceinline bool ProfiledAcquire(TryFn, AcquireFn acquire) {
+    return acquire();
+  }
+
+  __forceinline void ProfiledRelease() {}
+};
+#endif
+
+/// @brief: Mutex which spins briefly and then sleeps on a futex.
+/// Free, uncontended and lightly contended acquires never enter the kernel or allocate.  The spin
+/// budget adapts to how long recent contended acquires had to spin.
+class HybridMutex : private LockProfile {
+ public:
+  using LockProfile::Held;
+
+  static constexpr uint32_t kMaxAny = 128;
+
+  HybridMutex() : HybridMutex(nullptr) {}
+  explicit HybridMutex(const char* name) : LockProfile(name), lock_(kFree), spins_(0) {}
+
   bool Try() {
-    int old = 0;
-    return lock_.compare_exchange_strong(old, 1);
+    uint32_t old = kFree;
+    return lock_.compare_exchange_strong(old, kLocked, std::memory_order_acquire);
   }
 
   bool Acquire() {
-    int cnt = maxSpinIterPause + maxSpinIterYield;
-
-    int old = 0;
-    while (!lock_.compare_exchange_strong(old, 1)) {
-      cnt--;
-      if (cnt > maxSpinIterPause) {
-        _mm_pause();
-      } else if (cnt-- > maxSpinIterYield) {
-        os::YieldThread();
-      } else {
-        os::WaitSemaphore(sem_);
-        cnt = maxSpinIterPause + maxSpinIterYield;
-      }
-      old = 0;
-    }
-    return true;
+    return ProfiledAcquire([this]() { return Try(); }, [this]() { return Wait(); });
   }
 
   void Release() {
-    int old = 1;
-    if (lock_.compare_exchange_strong(old, 0))
-      os::PostSemaphore(sem_);
+    ProfiledRelease();
+    if (lock_.exchange(kFree, std::memory_order_release) == kSleepers) os::FutexWake(&lock_, false);
+  }
+
+  /// @brief: Acquires whichever of locks is free first, sleeping on all of them at once.  Not
+  /// included in lock statistics.
+  /// @param: locks(Input), up to kMaxAny locks.
+  /// @return: index of the acquired lock.
+  static uint32_t AcquireAny(HybridMutex* const* locks, uint32_t count) {
+    assert(count <= kMaxAny && "Too many locks.");
+    for (uint32_t i = 0; i < count; i++)
+      if (locks[i]->Try()) return i;
+
+    std::atomic<uint32_t>* words[kMaxAny];
+    uint32_t expected[kMaxAny];
+    for (uint32_t i = 0; i < count; i++) {
+      words[i] = &locks[i]->lock_;
+      expected[i] = kSleepers;
+    }
+    while (true) {
+      // Marking every lock as slept on makes its release wake us.
+      for (uint32_t i = 0; i < count; i++)
+        if (locks[i]->lock_.exchange(kSleepers, std::memory_order_acquire) == kFree) return i;
+      os::FutexWaitMultiple(words, expected, count, 0xFFFFFFFF);
+    }
   }
 
  private:
-  std::atomic<int> lock_;
-  os::Semaphore sem_;
-  const uint32_t maxSpinIterPause = 55;
-  const uint32_t maxSpinIterYield = 55;
+  // lock_ states.  kSleepers is held with possible sleepers, so Release must wake one.
+  static constexpr uint32_t kFree = 0;
+  static constexpr uint32_t kLocked = 1;
+  static constexpr uint32_t kSleepers = 2;
+  static constexpr uint32_t kMaxSpins = 100;
+
+  bool Wait() {
+    // Spin up to about twice the recent average spin, then sleep.
+    const uint32_t spins = spins_.load(std::memory_order_relaxed);
+    const uint32_t limit = Min(kMaxSpins, spins * 2 + 10);
+    uint32_t cnt = 0;
+    while (cnt < limit) {
+      if (lock_.load(std::memory_order_relaxed) == kFree && Try()) break;
+      _mm_pause();
+      cnt++;
+    }
+    spins_.store(spins + (int32_t(cnt) - int32_t(spins)) / 8, std::memory_order_relaxed);
+    if (cnt < limit) return true;
+
+    // A lock taken after sleeping stays marked since other sleepers may remain.
+    while (lock_.exchange(kSleepers, std::memory_order_acquire) != kFree)
+      os::FutexWait(&lock_, kSleepers, 0xFFFFFFFF);
+    return true;
+  }
+
+  std::atomic<uint32_t> lock_;
+  std::atomic<uint32_t> spins_;
 
   /// @brief: Disable copiable and assignable ability.
   DISALLOW_COPY_AND_ASSIGN(HybridMutex);
@@ -105,14 +247,25 @@ class HybridMutex {
 /// Uses the kernel's scheduler to keep the waiting thread from being scheduled
 /// until the lock is released (Best for long waits, though anything using
 /// a kernel object is a long wait).
-class KernelMutex {
+class KernelMutex : private LockProfile {
  public:
-  KernelMutex() { lock_ = os::CreateMutex(); }
+  using LockProfile::Held;
+
+  KernelMutex() : KernelMutex(nullptr) {}
+  explicit KernelMutex(const char* name) : LockProfile(name) {
+    lock_ = os::CreateMutex();
+  }
   ~KernelMutex() { os::DestroyMutex(lock_); }
 
   bool Try() { return os::TryAcquireMutex(lock_); }
-  bool Acquire() { return os::AcquireMutex(lock_); }
-  void Release() { os::ReleaseMutex(lock_); }
+  bool Acquire() {
+    return ProfiledAcquire([this]() { return Try(); },
+                           [this]() { return os::AcquireMutex(lock_); });
+  }
+  void Release() {
+    ProfiledRelease();
+    os::ReleaseMutex(lock_);
+  }
 
  private:
   os::Mutex lock_;
@@ -124,24 +277,31 @@ class KernelMutex {
 /// @brief: represents a spin lock.
 /// For very short hold durations on the order of the thread scheduling
 /// quanta or less.
-class SpinMutex {
+class SpinMutex : private LockProfile {
  public:
-  SpinMutex() { lock_ = 0; }
+  using LockProfile::Held;
+
+  SpinMutex() : SpinMutex(nullptr) {}
+  explicit SpinMutex(const char* name) : LockProfile(name) { lock_ = 0; }
 
   bool Try() {
     int old = 0;
     return lock_.compare_exchange_strong(old, 1);
   }
   bool Acquire() {
-    int old = 0;
-    while (!lock_.compare_exchange_strong(old, 1))
-	{
-		old=0;
-    os::YieldThread();
-	}
-    return true;
+    return ProfiledAcquire([this]() { return Try(); }, [this]() {
+      int old = 0;
+      while (!lock_.compare_exchange_strong(old, 1)) {
+        old = 0;
+        os::YieldThread();
+      }
+      return true;
+    });
+  }
+  void Release() {
+    ProfiledRelease();
+    lock_ = 0;
   }
-  void Release() { lock_ = 0; }
 
  private:
   std::atomic<int> lock_;
@@ -150,18 +310,49 @@ class SpinMutex {
   DISALLOW_COPY_AND_ASSIGN(SpinMutex);
 };
 
+/// @brief: Auto reset event on a futex, initially set.  Observing the event set, through IsSet or
+/// a wait, resets it.
 class KernelEvent {
  public:
-  KernelEvent() { evt_ = os::CreateOsEvent(true, true); }
-  ~KernelEvent() { os::DestroyOsEvent(evt_); }
+  KernelEvent() : state_(1) {}
 
-  bool IsSet() { return os::WaitForOsEvent(evt_, 0)==0; }
-  bool WaitForSet() { return os::WaitForOsEvent(evt_, 0xFFFFFFFF)==0; }
-  void Set() { os::SetOsEvent(evt_); }
-  void Reset() { os::ResetOsEvent(evt_); }
+  bool IsSet() {
+    uint32_t set = 1;
+    return state_.compare_exchange_strong(set, 0, std::memory_order_acquire);
+  }
+  bool WaitForSet() {
+    while (!IsSet()) os::FutexWait(&state_, 0, 0xFFFFFFFF);
+    return true;
+  }
+  void Set() {
+    if (state_.exchange(1, std::memory_order_release) == 0) os::FutexWake(&state_, false);
+  }
+  void Reset() { state_.store(0, std::memory_order_relaxed); }
+
+  /// @brief: Waits until any of events is set and resets it.
+  /// @param: events(Input), up to HybridMutex::kMaxAny events.
+  /// @param: milli_seconds(Input), timeout, 0xFFFFFFFF waits forever.
+  /// @return: index of the event, or count if the timeout expired.
+  static uint32_t WaitForAny(KernelEvent* const* events, uint32_t count,
+                             uint32_t milli_seconds) {
+    assert(count <= HybridMutex::kMaxAny && "Too many events.");
+    std::atomic<uint32_t>* words[HybridMutex::kMaxAny];
+    uint32_t expected[HybridMutex::kMaxAny];
+    for (uint32_t i = 0; i < count; i++) {
+      words[i] = &events[i]->state_;
+      expected[i] = 0;
+    }
+    bool timed_out = false;
+    while (true) {
+      for (uint32_t i = 0; i < count; i++)
+        if (events[i]->IsSet()) return i;
+      if (timed_out) return count;
+      timed_out = !os::FutexWaitMultiple(words, expected, count, milli_seconds);
+    }
+  }
 
  private:
-  os::EventHandle evt_;
+  std::atomic<uint32_t> state_;
 
   /// @brief: Disable copiable and assignable ability.
   DISALLOW_COPY_AND_ASSIGN(KernelEvent);
@@ -169,7 +360,7 @@ class KernelEvent {
 
 /// @brief: represents a yielding shared mutex.
 /// aka read/write mutex
-class KernelSharedMutex {
+class KernelSharedMutex : private LockProfile {
  public:
   /// @brief: Interfaces ScopedAcquire to shared operations.
   class Shared {
@@ -183,17 +374,31 @@ class KernelSharedMutex {
     KernelSharedMutex* lock_;
   };
 
-  KernelSharedMutex() { lock_ = os::CreateSharedMutex(); }
+  using LockProfile::Held;
+
+  KernelSharedMutex() : KernelSharedMutex(nullptr) {}
+  explicit KernelSharedMutex(const char* name) : LockProfile(name) {
+    lock_ = os::CreateSharedMutex();
+  }
   ~KernelSharedMutex() { os::DestroySharedMutex(lock_); }
 
   // Exclusive mode operations
   bool Try() { return os::TryAcquireSharedMutex(lock_); }
-  bool Acquire() { return os::AcquireSharedMutex(lock_); }
-  void Release() { os::ReleaseSharedMutex(lock_); }
+  bool Acquire() {
+    return ProfiledAcquire([this]() { return Try(); },
+                           [this]() { return os::AcquireSharedMutex(lock_); });
+  }
+  void Release() {
+    ProfiledRelease();
+    os::ReleaseSharedMutex(lock_);
+  }
 
-  // Shared mode operations
+  // Shared mode operations.  Readers are counted but not recorded as holders.
   bool TryShared() { return os::TrySharedAcquireSharedMutex(lock_); }
-  bool AcquireShared() { return os::SharedAcquireSharedMutex(lock_); }
+  bool AcquireShared() {
+    return ProfiledAcquire([this]() { return TryShared(); },
+                           [this]() { return os::SharedAcquireSharedMutex(lock_); });
+  }
   void ReleaseShared() { os::SharedReleaseSharedMutex(lock_); }
 
   // Return shared operations interface
@@ -235,13 +440,16 @@ template <class LockType> class ScopedAcquire {
  public:
   /// @brief: When constructing, acquire the lock.
   /// @param: lock(Input), pointer to an existing lock.
-  explicit ScopedAcquire(LockType* lock) : lock_(lock), doRelease(true) {
+  /// @param: site(Input), caller's location, recorded as the holder for contention statistics.
+  explicit ScopedAcquire(LockType* lock, LockSite site = LockSite::Here())
+      : lock_(lock), doRelease(true) {
     static_assert(isMutex<LockType>::value, "ScopedAcquire requires a mutex type.");
-    lock_.Acquire();
+    lock_.Acquire(site);
   }
-  explicit ScopedAcquire(LockType lock) : lock_(lock), doRelease(true) {
+  explicit ScopedAcquire(LockType lock, LockSite site = LockSite::Here())
+      : lock_(lock), doRelease(true) {
     static_assert(!isMutex<LockType>::value, "Mutex types are not copyable.");
-    lock_.Acquire();
+    lock_.Acquire(site);
   }
 
   /// @brief: when destructing, release the lock.
@@ -260,7 +468,11 @@ template <class LockType> class ScopedAcquire {
   template <class T, bool B> class container {
    public:
     container(T* lock) : lock_(lock) {}
-    __forceinline bool Acquire() { return lock_->Acquire(); }
+    __forceinline bool Acquire(const LockSite& site) {
+      bool ret = lock_->Acquire();
+      lock_->Held(site);
+      return ret;
+    }
     __forceinline void Release() { return lock_->Release(); }
 
    private:
@@ -271,7 +483,7 @@ template <class LockType> class ScopedAcquire {
   template <class T> class container<T, false> {
    public:
     container(T lock) : lock_(lock) {}
-    __forceinline bool Acquire() { return lock_.Acquire(); }
+    __forceinline bool Acquire(const LockSite&) { return lock_.Acquire(); }
     __forceinline void Release() { return lock_.Release(); }
 
    private:
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+//
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+//
+// Developed by:
+//
+//                 AMD Research and AMD HSA Software Development
+//
+//                 Advanced Micro Devices, Inc.
+//
+//                 www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+// Bounded per-thread cache of free objects placed in front of a locked pool.  Objects move between
+// a thread's magazine and the pool in batches so the common alloc/free path does not touch the
+// pool lock.
+
+#ifndef HSA_RUNTME_CORE_UTIL_MAGAZINE_H_
+#define HSA_RUNTME_CORE_UTIL_MAGAZINE_H_
+
+#include <atomic>
+#include <stdint.h>
+
+#include "core/util/utils.h"
+
+namespace rocr {
+
+template <typename T, uint32_t kCapacity> class Magazine {
+ public:
+  /// @brief Returns count items to the owning pool, used when a thread exits.
+  typedef void (*return_fn)(void* pool, T** items, uint32_t count);
+
+  Magazine()
+      : pool_(nullptr), epoch_(0), live_epoch_(nullptr), return_(nullptr), count_(0) {}
+  ~Magazine() { Drain(); }
+
+  /// @brief Binds the magazine to a pool generation.  Contents cached for an older generation are
+  /// dropped since their pool has already released the backing storage.
+  __forceinline void Attach(void* pool, uint64_t epoch, const std::atomic<uint64_t>* live_epoch,
+                            return_fn ret) {
+    if (epoch_ == epoch) return;
+    pool_ = pool;
+    epoch_ = epoch;
+    live_epoch_ = live_epoch;
+    return_ = ret;
+    count_ = 0;
+  }
+
+  __forceinline T* Pop() { return (count_ == 0) ? nullptr : items_[--count_]; }
+
+  __forceinline bool Push(T* item) {
+    if (count_ == kCapacity) return false;
+    items_[count_++] = item;
+    return true;
+  }
+
+  /// @brief Removes up to count items from the top of the magazine, returning their location.
+  __forceinline T** Take(uint32_t& count) {
+    count = Min(count, count_);
+    count_ -= count;
+    return &items_[count_];
+  }
+
+  /// @brief Space available for a refill.  Callers fill Reserve() and then Commit().
+  __forceinline T** Reserve(uint32_t& count) {
+    count = Min(count, kCapacity - count_);
+    return &items_[count_];
+  }
+  __forceinline void Commit(uint32_t count) { count_ += count; }
+
+  __forceinline uint32_t Count() const { return count_; }
+
+  /// @brief Gives all cached items back to the pool if the pool generation is still live.
+  void Drain() {
+    if ((count_ != 0) && (live_epoch_ != nullptr) &&
+        (live_epoch_->load(std::memory_order_acquire) == epoch_))
+      return_(pool_, items_, count_);
+    count_ = 0;
+  }
+
+ private:
+  void* pool_;
+  uint64_t epoch_;
+  const std::atomic<uint64_t>* live_epoch_;
+  return_fn return_;
+  uint32_t count_;
+  T* items_[kCapacity];
+
+  DISALLOW_COPY_AND_ASSIGN(Magazine);
+};
+
+}  // namespace rocr
+
+#endif  // HSA_RUNTME_CORE_UTIL_MAGAZINE_H_
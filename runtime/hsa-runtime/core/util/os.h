@@ -45,6 +45,8 @@
 #ifndef HSA_RUNTIME_CORE_UTIL_OS_H_
 #define HSA_RUNTIME_CORE_UTIL_OS_H_
 
+#include <atomic>
+#include <functional>
 #include <string>
 #include <vector>
 #include "utils.h"
@@ -201,17 +203,103 @@ void uSleep(int delayInUs);
 /// @return: void.
 void YieldThread();
 
+/// @brief: Gets the processor the calling thread is running on.
+/// @param: void.
+/// @return: uint32_t, processor index, zero if unknown.
+uint32_t CurrentCpu();
+
+/// @brief: Restricts the calling thread to a set of processors.
+/// @param: cpus(Input), processor indices the thread may run on.
+/// @param: count(Input), number of entries in cpus.
+/// @return: bool, true if the affinity was applied.
+bool SetThreadAffinity(const uint32_t* cpus, uint32_t count);
+
+/// @brief: Lowers the scheduling priority of the calling thread below that
+/// of normal threads.
+/// @param: void.
+/// @return: void.
+void LowerThreadPriority();
+
+/// @brief: Gets the NUMA node a PCI device is attached to.
+/// @param: domain(Input), PCI domain.
+/// @param: bdfid(Input), bus[15:8], device[7:3] and function[2:0].
+/// @return: int, NUMA node or -1 if unknown.
+int GetPciNumaNode(uint32_t domain, uint32_t bdfid);
+
+/// @brief: Gets the number of memory partitions of a PCI device, from its NPS mode.
+/// @param: domain(Input), PCI domain.
+/// @param: bdfid(Input), bus[15:8], device[7:3] and function[2:0].
+/// @return: uint32_t, number of memory partitions or 0 if unknown.
+uint32_t GetPciMemoryPartitions(uint32_t domain, uint32_t bdfid);
+
+/// @brief Network interface backed by a PCI device.
+struct NetDevice {
+  std::string name;
+  uint32_t domain;
+  uint32_t bdfid;
+  int numa_node;
+};
+
+/// @brief: Lists the network interfaces backed by PCI devices.
+/// @return: std::vector<NetDevice>, the interfaces, empty if not supported.
+std::vector<NetDevice> GetNetDevices();
+
+/// @brief: Lists the processors of a NUMA node.
+/// @param: node(Input), operating system NUMA node.
+/// @return: std::vector<uint32_t>, processor indices, empty if unknown.
+std::vector<uint32_t> GetNumaNodeCpus(int node);
+
 typedef void (*ThreadEntry)(void*);
 
+/// @brief Placement and scheduling of a thread.
+struct ThreadPolicy {
+  enum Sched { kDefault = 0, kOther, kBatch, kIdle, kFifo, kRoundRobin };
+
+  /// Processors the thread may run on, unrestricted if empty.
+  std::vector<uint32_t> cpus;
+  /// Scheduling class, kDefault inherits the creator's.
+  Sched sched = kDefault;
+  /// Nice value for the time sharing classes, real time priority for kFifo and
+  /// kRoundRobin.  Ignored for kDefault unless non-zero.
+  int priority = 0;
+};
+
 /// @brief: Creates a thread will return NULL if failed.
 /// @param: entry_function(Input), a pointer to the function which the thread
 /// starts from.
 /// @param: entry_argument(Input), a pointer to the argument of the thread
 /// function.
 /// @param: stack_size(Input), size of the thread's stack, 0 by default.
+/// @param: tag(Input), caller defined class of the thread for ForEachThread.
+/// @param: context(Input), caller defined data passed back by ForEachThread.
+/// @param: policy(Input), placement and scheduling applied before the entry
+/// function runs, none if NULL.
 /// @return: Thread, a handle to thread created.
 Thread CreateThread(ThreadEntry entry_function, void* entry_argument,
-                    uint stack_size = 0);
+                    uint stack_size = 0, uint32_t tag = 0, const void* context = nullptr,
+                    const ThreadPolicy* policy = nullptr);
+
+/// @brief: Changes the placement and scheduling of a live thread.
+/// @param: thread(Input), handle to the thread.
+/// @param: policy(Input), new policy.
+/// @return: bool, true if every part of the policy was applied.
+bool SetThreadPolicy(Thread thread, const ThreadPolicy& policy);
+
+/// @brief: Changes the placement and scheduling of every live thread created
+/// with a tag.
+/// @param: tag(Input), tag given to CreateThread.
+/// @param: policy(Input), returns the policy of a thread given its context.
+/// @return: void.
+void SetThreadPolicy(uint32_t tag, const std::function<ThreadPolicy(const void*)>& policy);
+
+/// @brief: Registers handlers run around fork, at most once per process.  Os
+/// state that does not survive fork, such as the threads known to
+/// SetThreadPolicy, is reset in the child before @p child runs.
+/// @param: prepare(Input), run in the parent before fork.
+/// @param: parent(Input), run in the parent after fork.
+/// @param: child(Input), run in the child after fork.
+/// @return: bool, true if the handlers were registered.
+bool RegisterForkHandlers(void (*prepare)(), void (*parent)(), void (*child)());
 
 /// @brief: Destroys the thread.
 /// @param: thread(Input), thread handle to what will be destroyed.
@@ -293,6 +381,29 @@ int SetOsEvent(EventHandle event);
 /// @return: Whether event reset is correct
 int ResetOsEvent(EventHandle event);
 
+/// @brief: Sleeps while *word equals expected.  May return early on spurious wakeups, callers
+/// must recheck their condition.
+/// @param: word(Input), 32 bit word shared by the waiter and the waker.
+/// @param: expected(Input), value of word to sleep on.
+/// @param: milli_seconds(Input), timeout, 0xFFFFFFFF waits forever.
+/// @return: bool, false if the timeout expired.
+bool FutexWait(std::atomic<uint32_t>* word, uint32_t expected, uint32_t milli_seconds);
+
+/// @brief: Wakes threads sleeping in FutexWait or FutexWaitMultiple on word.
+/// @param: word(Input), 32 bit word waited on.
+/// @param: all(Input), wakes all sleepers if true, else one.
+void FutexWake(std::atomic<uint32_t>* word, bool all);
+
+/// @brief: Sleeps while every words[i] equals expected[i].  Uses futex_waitv when the kernel
+/// supports it, otherwise polls.  May return early on spurious wakeups.
+/// @param: words(Input), up to 128 words.
+/// @param: expected(Input), value of each word to sleep on.
+/// @param: count(Input), number of words.
+/// @param: milli_seconds(Input), timeout, 0xFFFFFFFF waits forever.
+/// @return: bool, false if the timeout expired.
+bool FutexWaitMultiple(std::atomic<uint32_t>* const* words, const uint32_t* expected,
+                       uint32_t count, uint32_t milli_seconds);
+
 /// @brief reads a clock which is deemed to be accurate for elapsed time
 /// measurements, though not necessarilly fast to query
 /// @return clock counter value
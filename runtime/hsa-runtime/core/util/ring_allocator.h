@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+//
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+//
+// Developed by:
+//
+//                 AMD Research and AMD HSA Software Development
+//
+//                 Advanced Micro Devices, Inc.
+//
+//                 www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+// Byte ring sub-allocator.  Allocations are tagged with a sequence number, such as the packet id
+// of the dispatch using them, and are reclaimed in order once the consumer has moved past the tag.
+// No memory is allocated after init so the alloc path is allocation-free.
+
+#ifndef HSA_RUNTME_CORE_UTIL_RING_ALLOCATOR_H_
+#define HSA_RUNTME_CORE_UTIL_RING_ALLOCATOR_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "core/util/utils.h"
+
+namespace rocr {
+
+class RingAllocator {
+ public:
+  RingAllocator() : base_(0), size_(0), head_(0), tail_(0), rec_head_(0), rec_tail_(0) {}
+
+  // Manage size bytes at base, tracking at most max_tags outstanding tags.
+  void init(void* base, size_t size, uint32_t max_tags) {
+    base_ = reinterpret_cast<uintptr_t>(base);
+    size_ = size;
+    head_ = tail_ = 0;
+    rec_head_ = rec_tail_ = 0;
+    records_.resize(max_tags);
+  }
+
+  // Returns nullptr if the ring has no room until more tags are retired.  Space tagged with a
+  // value below retired is reclaimed first.  align must be a power of two.
+  void* alloc(size_t bytes, size_t align, uint64_t tag, uint64_t retired) {
+    assert(IsPowerOfTwo(align) && "Ring alignment must be a power of two.");
+    reclaim(retired);
+
+    uint64_t offset = AlignUp(head_, align);
+    // Allocations never straddle the end of the ring.
+    if ((offset % size_) + bytes > size_) offset = AlignUp(offset, size_);
+    uint64_t end = offset + bytes;
+    if (end - tail_ > size_) return nullptr;
+
+    // Tags only retire in order, a tag below the newest outstanding one is folded into it.
+    if (rec_head_ != rec_tail_ && tag <= record(rec_head_ - 1).tag) {
+      record(rec_head_ - 1).end = end;
+    } else {
+      if (rec_head_ - rec_tail_ == records_.size()) return nullptr;
+      record(rec_head_++) = {tag, end};
+    }
+
+    head_ = end;
+    return reinterpret_cast<void*>(base_ + (offset % size_));
+  }
+
+  void* base() const { return reinterpret_cast<void*>(base_); }
+  size_t size() const { return size_; }
+
+ private:
+  struct Record {
+    uint64_t tag;
+    uint64_t end;
+  };
+
+  Record& record(uint64_t index) { return records_[index % records_.size()]; }
+
+  void reclaim(uint64_t retired) {
+    while (rec_tail_ != rec_head_ && record(rec_tail_).tag < retired) {
+      tail_ = record(rec_tail_).end;
+      rec_tail_++;
+    }
+    // Nothing outstanding, restart at the beginning of the ring to limit wrapping.
+    if (rec_tail_ == rec_head_) head_ = tail_ = AlignUp(head_, size_);
+  }
+
+  uintptr_t base_;
+  size_t size_;
+
+  // Monotonic byte offsets of the next allocation and of the oldest live allocation.
+  uint64_t head_;
+  uint64_t tail_;
+
+  // Outstanding tags and the end of their allocations, oldest at rec_tail_.
+  std::vector<Record> records_;
+  uint64_t rec_head_;
+  uint64_t rec_tail_;
+
+  DISALLOW_COPY_AND_ASSIGN(RingAllocator);
+};
+
+}  // namespace rocr
+
+#endif  // HSA_RUNTME_CORE_UTIL_RING_ALLOCATOR_H_
@@ -0,0 +1,293 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+//
+// Copyright (c) 2024, Advanced Micro Devices, Inc. All rights reserved.
+//
+// Developed by:
+//
+//                 AMD Research and AMD HSA Software Development
+//
+//                 Advanced Micro Devices, Inc.
+//
+//                 www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+
+// Segregated size-class allocator for small page multiple requests.  Fixed size slabs are carved
+// from an underlying allocator and split into objects of one size class.  Each CPU keeps a small
+// cache of free objects per class so most allocations and frees only take a per-CPU spin lock.
+
+#ifndef HSA_RUNTME_CORE_UTIL_SLAB_HEAP_H_
+#define HSA_RUNTME_CORE_UTIL_SLAB_HEAP_H_
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "core/util/locks.h"
+#include "core/util/os.h"
+#include "core/util/utils.h"
+
+namespace rocr {
+
+template <typename Allocator> class SlabHeap {
+ public:
+  // Largest request served from slabs.
+  static const size_t kMaxSize = 64 * 1024;
+  // Size of the chunks requested from the underlying allocator.
+  static const size_t kSlabSize = 256 * 1024;
+
+  explicit SlabHeap(const Allocator& SlabAllocator = Allocator())
+      : slab_allocator_(SlabAllocator), hits_(0), misses_(0), reserved_(0), allocated_(0) {}
+  ~SlabHeap() { release(); }
+
+  SlabHeap(const SlabHeap& rhs) = delete;
+  SlabHeap(SlabHeap&& rhs) = delete;
+  SlabHeap& operator=(const SlabHeap& rhs) = delete;
+  SlabHeap& operator=(SlabHeap&& rhs) = delete;
+
+  // Returns nullptr if bytes is not served by slabs.
+  void* alloc(size_t bytes) {
+    const uint32_t cls = classOf(bytes);
+    if (cls == kNumClasses) return nullptr;
+
+    CpuCache& cache = caches_[os::CurrentCpu() % kCpuSlots];
+    {
+      ScopedAcquire<SpinMutex> lock(&cache.lock);
+      if (cache.count[cls] != 0) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        allocated_.fetch_add(kClassSize[cls], std::memory_order_relaxed);
+        return reinterpret_cast<void*>(cache.items[cls][--cache.count[cls]]);
+      }
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    uintptr_t batch[kCacheBatch];
+    uint32_t count = refill(cls, batch);
+    allocated_.fetch_add(kClassSize[cls], std::memory_order_relaxed);
+
+    // Keep the rest of the batch for subsequent allocations on this CPU.
+    if (count > 1) {
+      ScopedAcquire<SpinMutex> lock(&cache.lock);
+      uint32_t i = 1;
+      while (i < count && cache.count[cls] < kCacheDepth)
+        cache.items[cls][cache.count[cls]++] = batch[i++];
+      lock.Release();
+      if (i < count) put(cls, &batch[i], count - i);
+    }
+    return reinterpret_cast<void*>(batch[0]);
+  }
+
+  // Returns false if ptr was not allocated from a slab.
+  bool free(void* ptr) {
+    if (ptr == nullptr) return false;
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+
+    uint32_t cls;
+    {
+      ScopedAcquire<KernelSharedMutex::Shared> lock(map_lock_.shared());
+      Slab* slab = find(addr);
+      if (slab == nullptr) return false;
+      cls = slab->cls;
+    }
+    allocated_.fetch_sub(kClassSize[cls], std::memory_order_relaxed);
+
+    CpuCache& cache = caches_[os::CurrentCpu() % kCpuSlots];
+    ScopedAcquire<SpinMutex> lock(&cache.lock);
+    if (cache.count[cls] < kCacheDepth) {
+      cache.items[cls][cache.count[cls]++] = addr;
+      return true;
+    }
+
+    // Cache is full, return half of it to the slabs.
+    uintptr_t batch[kCacheBatch + 1];
+    cache.count[cls] -= kCacheBatch;
+    std::copy(&cache.items[cls][cache.count[cls]], &cache.items[cls][cache.count[cls]] +
+              kCacheBatch, batch);
+    batch[kCacheBatch] = addr;
+    lock.Release();
+    put(cls, batch, kCacheBatch + 1);
+    return true;
+  }
+
+  // Allocations served from a CPU cache.
+  uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  // Allocations which had to refill a CPU cache from the slabs.
+  uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+  // Bytes held by slabs.
+  size_t reserved_size() const { return reserved_.load(std::memory_order_relaxed); }
+  // Bytes of slab objects currently allocated, including size class rounding.
+  size_t allocated_size() const { return allocated_.load(std::memory_order_relaxed); }
+
+ private:
+  static const uint32_t kNumClasses = 8;
+  static const uint32_t kCpuSlots = 32;
+  static const uint32_t kCacheDepth = 8;
+  static const uint32_t kCacheBatch = kCacheDepth / 2;
+
+  static const size_t kClassSize[kNumClasses];
+
+  static uint32_t classOf(size_t bytes) {
+    uint32_t cls = 0;
+    while (cls < kNumClasses && kClassSize[cls] < bytes) cls++;
+    return cls;
+  }
+
+  struct Slab {
+    uintptr_t base;
+    uint32_t cls;
+    uint32_t capacity;
+    std::vector<uintptr_t> free_list;
+    typename std::list<Slab*>::iterator partial_entry;
+    bool partial;
+  };
+
+  struct CpuCache {
+    SpinMutex lock;
+    uint32_t count[kNumClasses] = {};
+    uintptr_t items[kNumClasses][kCacheDepth];
+  };
+
+  // Slab containing addr.  Requires map_lock_ or lock_.
+  Slab* find(uintptr_t addr) {
+    auto it = slabs_.upper_bound(addr);
+    if (it == slabs_.begin()) return nullptr;
+    it--;
+    if (addr >= it->first + kSlabSize) return nullptr;
+    return it->second;
+  }
+
+  // Takes up to kCacheBatch objects of class cls, allocating a new slab if needed.  Returns at
+  // least one object or throws from the underlying allocator.
+  uint32_t refill(uint32_t cls, uintptr_t* batch) {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    if (partial_[cls].empty()) {
+      Slab* slab = new Slab();
+      MAKE_NAMED_SCOPE_GUARD(slabGuard, [&]() { delete slab; });
+      slab->base = reinterpret_cast<uintptr_t>(slab_allocator_.alloc(kSlabSize));
+      slabGuard.Dismiss();
+      slab->cls = cls;
+      slab->capacity = kSlabSize / kClassSize[cls];
+      slab->free_list.reserve(slab->capacity);
+      for (uint32_t i = slab->capacity; i != 0; i--)
+        slab->free_list.push_back(slab->base + (i - 1) * kClassSize[cls]);
+      partial_[cls].push_front(slab);
+      slab->partial_entry = partial_[cls].begin();
+      slab->partial = true;
+      {
+        ScopedAcquire<KernelSharedMutex> map_lock(&map_lock_);
+        slabs_[slab->base] = slab;
+      }
+      reserved_.fetch_add(kSlabSize, std::memory_order_relaxed);
+    }
+
+    uint32_t count = 0;
+    while (count < kCacheBatch && !partial_[cls].empty()) {
+      Slab* slab = partial_[cls].front();
+      while (count < kCacheBatch && !slab->free_list.empty()) {
+        batch[count++] = slab->free_list.back();
+        slab->free_list.pop_back();
+      }
+      if (slab->free_list.empty()) {
+        partial_[cls].pop_front();
+        slab->partial = false;
+      }
+    }
+    return count;
+  }
+
+  // Returns objects to their slabs.  Empty slabs beyond one per class are released.
+  void put(uint32_t cls, const uintptr_t* objects, uint32_t count) {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    for (uint32_t i = 0; i < count; i++) {
+      Slab* slab = find(objects[i]);
+      assert(slab != nullptr && slab->cls == cls && "Object returned to the wrong slab.");
+      slab->free_list.push_back(objects[i]);
+      if (!slab->partial) {
+        partial_[cls].push_back(slab);
+        slab->partial_entry = --partial_[cls].end();
+        slab->partial = true;
+      }
+      if (slab->free_list.size() == slab->capacity && partial_[cls].size() > 1)
+        destroy(slab);
+    }
+  }
+
+  // Requires lock_.
+  void destroy(Slab* slab) {
+    if (slab->partial) partial_[slab->cls].erase(slab->partial_entry);
+    {
+      ScopedAcquire<KernelSharedMutex> map_lock(&map_lock_);
+      slabs_.erase(slab->base);
+    }
+    slab_allocator_.free(reinterpret_cast<void*>(slab->base));
+    reserved_.fetch_sub(kSlabSize, std::memory_order_relaxed);
+    delete slab;
+  }
+
+  // Returns every slab to the underlying allocator.
+  void release() {
+    ScopedAcquire<KernelMutex> lock(&lock_);
+    for (auto& slab : slabs_) {
+      slab_allocator_.free(reinterpret_cast<void*>(slab.second->base));
+      delete slab.second;
+    }
+    slabs_.clear();
+    for (auto& list : partial_) list.clear();
+    reserved_ = 0;
+  }
+
+  Allocator slab_allocator_;
+
+  // Protects slab state and the partial lists.
+  KernelMutex lock_;
+  // Slabs with free objects, by size class.
+  std::list<Slab*> partial_[kNumClasses];
+
+  // Slabs by base address.  Written with both lock_ and map_lock_ held.
+  KernelSharedMutex map_lock_;
+  std::map<uintptr_t, Slab*> slabs_;
+
+  CpuCache caches_[kCpuSlots];
+
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+  std::atomic<size_t> reserved_;
+  std::atomic<size_t> allocated_;
+};
+
+template <typename Allocator>
+const size_t SlabHeap<Allocator>::kClassSize[SlabHeap<Allocator>::kNumClasses] = {
+    4096, 8192, 12288, 16384, 24 * 1024, 32 * 1024, 48 * 1024, 64 * 1024};
+
+}  // namespace rocr
+
+#endif  // HSA_RUNTME_CORE_UTIL_SLAB_HEAP_H_
@@ -0,0 +1,526 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+//
+// Copyright (c) 2014-2026, Advanced Micro Devices, Inc. All rights reserved.
+//
+// Developed by:
+//
+//                 AMD Research and AMD HSA Software Development
+//
+//                 Advanced Micro Devices, Inc.
+//
+//                 www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// A two level segregated fit (TLSF) memory allocator with eager compaction.  Manages block
+// sub-allocation.  Free fragments are binned by size class, found through a pair of bitmaps, so
+// alloc and free are O(1) regardless of how fragmented the blocks become.
+// Fully free blocks are cached for reuse and released when the cache outgrows the blocks in use,
+// on trim(), or once they have been idle longer than the age given to trimIdle().  Blocks added
+// with reserve() stay in the heap, free or not, until unreserve().
+
+#ifndef HSA_RUNTME_CORE_UTIL_TLSF_HEAP_H_
+#define HSA_RUNTME_CORE_UTIL_TLSF_HEAP_H_
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+#include "core/util/utils.h"
+
+namespace rocr {
+
+template <typename Allocator> class TlsfHeap {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Stats {
+    // Free space inside blocks that are at least partially in use.
+    size_t free_size;
+    // Largest free fragment, the biggest allocation servable without a new block.
+    size_t largest_free;
+    size_t free_fragments;
+    // Blocks at least partially in use.
+    size_t blocks;
+    size_t cache_blocks;
+    size_t cache_size;
+    // Size of blocks held by reserve().
+    size_t reserved_size;
+  };
+
+ private:
+  // Each power of two size range is split into kSlCount linear classes.
+  static const uint32_t kSlLog2 = 4;
+  static const uint32_t kSlCount = 1 << kSlLog2;
+  // Sizes below kSmallSize share the first range, binned kSmallSize / kSlCount bytes apart.
+  static const uint32_t kFlShift = 8;
+  static const size_t kSmallSize = size_t(1) << kFlShift;
+  static const uint32_t kFlCount = 64 - kFlShift + 1;
+
+  struct Block {
+    size_t length_;
+    // No further fragments are allocated from a discarded block and it bypasses the cache.
+    bool discard_;
+    // Kept in the heap when fully free, see reserve().
+    bool reserved_;
+  };
+
+  struct Fragment {
+    uintptr_t base_;
+    size_t size_;
+    Block* block_;
+    // Address ordered neighbours within the block.
+    Fragment* prev_phys_;
+    Fragment* next_phys_;
+    // Size class list links, valid while free and the block is not discarded.
+    Fragment* prev_free_;
+    Fragment* next_free_;
+    bool free_;
+  };
+
+  struct CachedBlock {
+    uintptr_t base_ptr_;
+    size_t length_;
+    Clock::time_point idle_since_;
+  };
+
+  Allocator block_allocator_;
+
+  // All fragments by base address.  References to elements are stable across rehashing.
+  std::unordered_map<uintptr_t, Fragment> fragments_;
+  // Blocks at least partially in use by base address.  Only searched by discardBlock.
+  std::map<uintptr_t, Block> block_list_;
+  // Idle blocks, least recently freed first.
+  std::deque<CachedBlock> block_cache_;
+
+  uint64_t fl_bitmap_;
+  uint32_t sl_bitmap_[kFlCount];
+  Fragment* free_heads_[kFlCount][kSlCount];
+
+  // Size of blocks that are at least partially in use.
+  size_t in_use_size_;
+  // Total size of block cache
+  size_t cache_size_;
+  // Blocks requested from block_allocator_.
+  size_t block_allocs_;
+  // Bytes and number of fragments on the free lists.
+  size_t free_size_;
+  size_t free_fragments_;
+  // Size of reserved blocks.
+  size_t reserved_size_;
+
+  static __forceinline uint32_t fls(size_t value) {
+    return 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+  }
+
+  static __forceinline void mapping(size_t size, uint32_t& fl, uint32_t& sl) {
+    if (size < kSmallSize) {
+      fl = 0;
+      sl = static_cast<uint32_t>(size / (kSmallSize / kSlCount));
+    } else {
+      const uint32_t bit = fls(size);
+      sl = static_cast<uint32_t>(size >> (bit - kSlLog2)) ^ kSlCount;
+      fl = bit - kFlShift + 1;
+    }
+  }
+
+  // Width of the size class holding size, less one.
+  static __forceinline size_t classRound(size_t size) {
+    if (size < kSmallSize) return (kSmallSize / kSlCount) - 1;
+    return (size_t(1) << (fls(size) - kSlLog2)) - 1;
+  }
+
+  void insertFree(Fragment* frag) {
+    uint32_t fl, sl;
+    mapping(frag->size_, fl, sl);
+    frag->prev_free_ = nullptr;
+    frag->next_free_ = free_heads_[fl][sl];
+    if (frag->next_free_ != nullptr) frag->next_free_->prev_free_ = frag;
+    free_heads_[fl][sl] = frag;
+    fl_bitmap_ |= uint64_t(1) << fl;
+    sl_bitmap_[fl] |= 1u << sl;
+    free_size_ += frag->size_;
+    free_fragments_++;
+  }
+
+  void removeFree(Fragment* frag) {
+    uint32_t fl, sl;
+    mapping(frag->size_, fl, sl);
+    if (frag->prev_free_ != nullptr)
+      frag->prev_free_->next_free_ = frag->next_free_;
+    else
+      free_heads_[fl][sl] = frag->next_free_;
+    if (frag->next_free_ != nullptr) frag->next_free_->prev_free_ = frag->prev_free_;
+    if (free_heads_[fl][sl] == nullptr) {
+      sl_bitmap_[fl] &= ~(1u << sl);
+      if (sl_bitmap_[fl] == 0) fl_bitmap_ &= ~(uint64_t(1) << fl);
+    }
+    frag->prev_free_ = frag->next_free_ = nullptr;
+    free_size_ -= frag->size_;
+    free_fragments_--;
+  }
+
+  // Good fit search: the first non-empty class at or above the class of bytes rounded up, so any
+  // fragment found is large enough.  Falls back to the head of bytes' own class.
+  Fragment* findFree(size_t bytes) {
+    uint32_t fl, sl;
+    mapping(bytes + classRound(bytes), fl, sl);
+    uint32_t sl_map = sl_bitmap_[fl] & (~0u << sl);
+    if (sl_map == 0) {
+      const uint64_t fl_map = (fl + 1 < kFlCount) ? fl_bitmap_ & (~uint64_t(0) << (fl + 1)) : 0;
+      if (fl_map != 0) {
+        fl = __builtin_ctzll(fl_map);
+        sl_map = sl_bitmap_[fl];
+      }
+    }
+    if (sl_map != 0) return free_heads_[fl][__builtin_ctz(sl_map)];
+
+    mapping(bytes, fl, sl);
+    Fragment* frag = free_heads_[fl][sl];
+    return ((frag != nullptr) && (frag->size_ >= bytes)) ? frag : nullptr;
+  }
+
+  // Trims frag to bytes, publishing any remainder as a free fragment.
+  void split(Fragment* frag, size_t bytes) {
+    assert(frag->size_ >= bytes && "TlsfHeap: fragment too small.");
+    if (frag->size_ == bytes) return;
+
+    Fragment& rest = fragments_[frag->base_ + bytes];
+    rest.base_ = frag->base_ + bytes;
+    rest.size_ = frag->size_ - bytes;
+    rest.block_ = frag->block_;
+    rest.prev_phys_ = frag;
+    rest.next_phys_ = frag->next_phys_;
+    rest.free_ = true;
+    if (rest.next_phys_ != nullptr) rest.next_phys_->prev_phys_ = &rest;
+    frag->next_phys_ = &rest;
+    frag->size_ = bytes;
+    if (!frag->block_->discard_) insertFree(&rest);
+  }
+
+  // Absorbs upper into lower.  Neither may be on a free list.
+  void merge(Fragment* lower, Fragment* upper) {
+    lower->size_ += upper->size_;
+    lower->next_phys_ = upper->next_phys_;
+    if (lower->next_phys_ != nullptr) lower->next_phys_->prev_phys_ = lower;
+    fragments_.erase(upper->base_);
+  }
+
+  void releaseBlock(const CachedBlock& block) {
+    block_allocator_.free(reinterpret_cast<void*>(block.base_ptr_), block.length_);
+    cache_size_ -= block.length_;
+  }
+
+ public:
+  explicit TlsfHeap(const Allocator& BlockAllocator = Allocator())
+      : block_allocator_(BlockAllocator),
+        fl_bitmap_(0),
+        in_use_size_(0),
+        cache_size_(0),
+        block_allocs_(0),
+        free_size_(0),
+        free_fragments_(0),
+        reserved_size_(0) {
+    for (uint32_t fl = 0; fl < kFlCount; fl++) {
+      sl_bitmap_[fl] = 0;
+      for (uint32_t sl = 0; sl < kSlCount; sl++) free_heads_[fl][sl] = nullptr;
+    }
+  }
+  ~TlsfHeap() {
+    unreserve();
+    trim();
+    // Leak here may be due to the user.  Check is for debugging only.
+    // assert(in_use_size_ == 0 && "Leak in TlsfHeap.");
+  }
+
+  TlsfHeap(const TlsfHeap& rhs) = delete;
+  TlsfHeap(TlsfHeap&& rhs) = delete;
+  TlsfHeap& operator=(const TlsfHeap& rhs) = delete;
+  TlsfHeap& operator=(TlsfHeap&& rhs) = delete;
+
+  void* alloc(size_t bytes) {
+    assert(bytes != 0 && "TlsfHeap: zero sized allocation.");
+
+    Fragment* frag = findFree(bytes);
+    if (frag != nullptr) {
+      removeFree(frag);
+      frag->free_ = false;
+      split(frag, bytes);
+      return reinterpret_cast<void*>(frag->base_);
+    }
+
+    uintptr_t base;
+    size_t size;
+
+    // No usable fragment, check block cache.  Reuse the most recently freed block.
+    if (bytes < default_block_size() && !block_cache_.empty()) {
+      const auto& block = block_cache_.back();
+      base = block.base_ptr_;
+      size = block.length_;
+      block_cache_.pop_back();
+      cache_size_ -= size;
+    } else {  // Alloc new block - new block may be larger than default.
+      void* ptr = block_allocator_.alloc(bytes, size);
+      base = reinterpret_cast<uintptr_t>(ptr);
+      assert(ptr != nullptr && "Block allocation failed, Allocator is expected to throw.");
+      block_allocs_++;
+    }
+
+    in_use_size_ += size;
+    assert(size >= bytes && "Alloc exceeds block size.");
+
+    Block& block = block_list_[base];
+    block.length_ = size;
+    block.discard_ = false;
+    block.reserved_ = false;
+
+    frag = &fragments_[base];
+    frag->base_ = base;
+    frag->size_ = size;
+    frag->block_ = &block;
+    frag->prev_phys_ = frag->next_phys_ = nullptr;
+    frag->prev_free_ = frag->next_free_ = nullptr;
+    frag->free_ = false;
+    split(frag, bytes);
+
+    // Disallow multiple suballocation from large blocks.
+    // Prevents a small allocation from retaining a large block.
+    if (bytes > default_block_size()) {
+      bool err = discardBlock(reinterpret_cast<void*>(base));
+      assert(err && "Large block discard failed.");
+    }
+
+    return reinterpret_cast<void*>(base);
+  }
+
+  bool free(void* ptr) {
+    if (ptr == nullptr) return true;
+
+    // Find fragment and validate.
+    auto it = fragments_.find(reinterpret_cast<uintptr_t>(ptr));
+    if (it == fragments_.end() || it->second.free_) return false;
+
+    Fragment* frag = &it->second;
+    Block* block = frag->block_;
+    frag->free_ = true;
+
+    // Merge lower then upper.
+    if ((frag->prev_phys_ != nullptr) && frag->prev_phys_->free_) {
+      Fragment* lower = frag->prev_phys_;
+      if (!block->discard_) removeFree(lower);
+      merge(lower, frag);
+      frag = lower;
+    }
+    if ((frag->next_phys_ != nullptr) && frag->next_phys_->free_) {
+      Fragment* upper = frag->next_phys_;
+      if (!block->discard_) removeFree(upper);
+      merge(frag, upper);
+    }
+
+    // Release whole free blocks.
+    if ((frag->prev_phys_ == nullptr) && (frag->next_phys_ == nullptr) && !block->reserved_) {
+      CachedBlock cached = {frag->base_, frag->size_, Clock::now()};
+      const bool discard = block->discard_;
+      fragments_.erase(frag->base_);
+      block_list_.erase(cached.base_ptr_);
+
+      // Discard or add to the block cache.
+      if (discard) {
+        block_allocator_.free(reinterpret_cast<void*>(cached.base_ptr_), cached.length_);
+      } else {
+        block_cache_.push_back(cached);
+        cache_size_ += cached.length_;
+        in_use_size_ -= cached.length_;
+      }
+
+      balance();
+
+      // Don't publish free space since block was moved to the cache.
+      return true;
+    }
+
+    // Don't report free memory if discarding the fragment.
+    if (!block->discard_) insertFree(frag);
+
+    // A discarded reserved block is never reused, let it go once empty.
+    if (block->discard_ && (frag->prev_phys_ == nullptr) && (frag->next_phys_ == nullptr)) {
+      reserved_size_ -= block->length_;
+      block_allocator_.free(reinterpret_cast<void*>(frag->base_), frag->size_);
+      block_list_.erase(frag->base_);
+      fragments_.erase(frag->base_);
+    }
+
+    return true;
+  }
+
+  // Allocate a block of at least bytes which stays in the heap until unreserve(), so allocations
+  // fitting in it never reach block_allocator_.  Throws like block_allocator_ on failure.
+  void reserve(size_t bytes) {
+    size_t size;
+    void* ptr = block_allocator_.alloc(bytes, size);
+    assert(ptr != nullptr && "Block allocation failed, Allocator is expected to throw.");
+    uintptr_t base = reinterpret_cast<uintptr_t>(ptr);
+    block_allocs_++;
+    in_use_size_ += size;
+    reserved_size_ += size;
+
+    Block& block = block_list_[base];
+    block.length_ = size;
+    block.discard_ = false;
+    block.reserved_ = true;
+
+    Fragment& frag = fragments_[base];
+    frag.base_ = base;
+    frag.size_ = size;
+    frag.block_ = &block;
+    frag.prev_phys_ = frag.next_phys_ = nullptr;
+    frag.free_ = true;
+    insertFree(&frag);
+  }
+
+  // Drop all reservations.  Free reserved blocks are released, the rest are once fully free.
+  void unreserve() {
+    for (auto it = block_list_.begin(); it != block_list_.end();) {
+      Block& block = it->second;
+      if (!block.reserved_) {
+        it++;
+        continue;
+      }
+      block.reserved_ = false;
+      reserved_size_ -= block.length_;
+
+      Fragment* frag = &fragments_.find(it->first)->second;
+      if (!frag->free_ || (frag->next_phys_ != nullptr)) {
+        it++;
+        continue;
+      }
+      if (!block.discard_) {
+        removeFree(frag);
+        in_use_size_ -= block.length_;
+      }
+      block_allocator_.free(reinterpret_cast<void*>(frag->base_), frag->size_);
+      fragments_.erase(frag->base_);
+      it = block_list_.erase(it);
+    }
+  }
+
+  size_t reserved_size() const { return reserved_size_; }
+
+  void balance() {
+    // Release old blocks when over cache limit.
+    while ((block_cache_.size() > 1) && (cache_size_ > in_use_size_ * 2)) {
+      releaseBlock(block_cache_.front());
+      block_cache_.pop_front();
+    }
+  }
+
+  void trim() {
+    for (const auto& block : block_cache_) releaseBlock(block);
+    block_cache_.clear();
+  }
+
+  // Release cached blocks which have been idle for at least age.
+  void trimIdle(Clock::duration age) {
+    const Clock::time_point cutoff = Clock::now() - age;
+    while (!block_cache_.empty() && (block_cache_.front().idle_since_ <= cutoff)) {
+      releaseBlock(block_cache_.front());
+      block_cache_.pop_front();
+    }
+  }
+
+  size_t cache_size() const { return cache_size_; }
+
+  // Number of idle blocks making up cache_size().
+  size_t cache_blocks() const { return block_cache_.size(); }
+
+  // Number of allocations which needed a new block.
+  size_t block_allocs() const { return block_allocs_; }
+
+  // Free space inside blocks that are at least partially in use.
+  size_t free_size() const { return free_size_; }
+
+  // Fragmentation statistics.  Cost is linear only in the length of the largest size class.
+  Stats stats() const {
+    Stats ret;
+    ret.free_size = free_size_;
+    ret.free_fragments = free_fragments_;
+    ret.blocks = block_list_.size();
+    ret.cache_blocks = block_cache_.size();
+    ret.cache_size = cache_size_;
+    ret.reserved_size = reserved_size_;
+    ret.largest_free = 0;
+    if (fl_bitmap_ != 0) {
+      const uint32_t fl = 63 - __builtin_clzll(fl_bitmap_);
+      const uint32_t sl = 31 - __builtin_clz(sl_bitmap_[fl]);
+      for (const Fragment* frag = free_heads_[fl][sl]; frag != nullptr; frag = frag->next_free_)
+        ret.largest_free = Max(ret.largest_free, frag->size_);
+    }
+    return ret;
+  }
+
+  size_t default_block_size() const { return block_allocator_.block_size(); }
+
+  // Prevent reuse of the block containing ptr.  No further fragments will be allocated from the
+  // block and the block will not be added to the block cache when it is free.
+  bool discardBlock(void* ptr) {
+    if (ptr == nullptr) return true;
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(ptr);
+
+    // Find block validate.
+    auto block_it = block_list_.upper_bound(base);
+    if (block_it == block_list_.begin()) return false;
+    block_it--;
+    Block& block = block_it->second;
+    if (block_it->first + block.length_ <= base) return false;
+
+    // Is block already discarded?
+    if (block.discard_) return true;
+
+    // Remove freelist records for all fragments in the block.
+    for (Fragment* frag = &fragments_.find(block_it->first)->second; frag != nullptr;
+         frag = frag->next_phys_) {
+      if (frag->free_) removeFree(frag);
+    }
+    block.discard_ = true;
+
+    // Remove discarded block from in-use tracking and rebalance the block cache.
+    in_use_size_ -= block.length_;
+    balance();
+
+    return true;
+  }
+};
+
+}  // namespace rocr
+
+#endif  // HSA_RUNTME_CORE_UTIL_TLSF_HEAP_H_
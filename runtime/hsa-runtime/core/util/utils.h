@@ -56,6 +56,9 @@
 #include <algorithm>
 #include <sstream>
 #include <thread>
+#include <atomic>
+#include <exception>
+#include <vector>
 
 namespace rocr {
 extern FILE* log_file;
@@ -371,6 +374,42 @@ inline void FlushCpuCache(const void* base, size_t offset, size_t len) {
   } while (cur <= (const char*)lastline);
 }
 
+/// @brief: Runs body(i) for every i in [0, count) on up to max_threads threads,
+/// the calling thread included. Indices are handed out in order. The first
+/// exception thrown by body is rethrown once every started call has returned.
+/// @param: count(Input), number of work items
+/// @param: max_threads(Input), thread limit, 0 selects the hardware concurrency
+/// @param: body(Input), callable taking the work item index
+template <typename F> void ParallelFor(size_t count, size_t max_threads, F body) {
+  if (max_threads == 0) max_threads = std::max(1u, std::thread::hardware_concurrency());
+  const size_t num_threads = std::min(count, max_threads);
+  if (num_threads <= 1) {
+    for (size_t i = 0; i < count; i++) body(i);
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  auto worker = [&]() {
+    for (size_t i = next++; i < count && !failed; i = next++) {
+      try {
+        body(i);
+      } catch (...) {
+        if (!failed.exchange(true)) error = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (size_t t = 1; t < num_threads; t++) threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads) thread.join();
+
+  if (error) std::rethrow_exception(error);
+}
+
 }  // namespace rocr
 
 template <uint32_t lowBit, uint32_t highBit, typename T>
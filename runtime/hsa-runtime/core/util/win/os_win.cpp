@@ -46,9 +46,12 @@
 #include "core/util/os.h"
 
 #include <algorithm>
+#include <map>
+#include <mutex>
 #include <process.h>
 #include <string>
 #include <windows.h>
+#include <synchapi.h>
 
 #include <emmintrin.h>
 #include <pmmintrin.h>
@@ -57,6 +60,8 @@
 #undef Yield
 #undef CreateMutex
 
+#pragma comment(lib, "Synchronization.lib")
+
 namespace rocr {
 namespace os {
 
@@ -135,6 +140,26 @@ void uSleep(int delayInUs) { ::Sleep(delayInUs / 1000); }
 
 void YieldThread() { ::Sleep(0); }
 
+uint32_t CurrentCpu() { return GetCurrentProcessorNumber(); }
+
+bool SetThreadAffinity(const uint32_t* cpus, uint32_t count) {
+  DWORD_PTR mask = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (cpus[i] < sizeof(mask) * 8) mask |= DWORD_PTR(1) << cpus[i];
+  }
+  return (mask != 0) && (SetThreadAffinityMask(GetCurrentThread(), mask) != 0);
+}
+
+void LowerThreadPriority() { SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL); }
+
+int GetPciNumaNode(uint32_t domain, uint32_t bdfid) { return -1; }
+
+uint32_t GetPciMemoryPartitions(uint32_t domain, uint32_t bdfid) { return 0; }
+
+std::vector<NetDevice> GetNetDevices() { return std::vector<NetDevice>(); }
+
+std::vector<uint32_t> GetNumaNodeCpus(int node) { return std::vector<uint32_t>(); }
+
 struct ThreadArgs {
   void* entry_args;
   ThreadEntry entry_function;
@@ -150,17 +175,88 @@ unsigned __stdcall ThreadTrampoline(void* arg) {
   return 0;
 }
 
+// Tag and context of live threads for SetThreadPolicy.
+static std::mutex thread_list_lock;
+static std::map<::HANDLE, std::pair<uint32_t, const void*>>& ThreadList() {
+  static auto* list = new std::map<::HANDLE, std::pair<uint32_t, const void*>>();
+  return *list;
+}
+
+static bool ApplyThreadPolicy(::HANDLE thread, const ThreadPolicy& policy) {
+  bool ret = true;
+  if (!policy.cpus.empty()) {
+    DWORD_PTR mask = 0;
+    for (uint32_t cpu : policy.cpus) {
+      if (cpu < sizeof(mask) * 8) mask |= DWORD_PTR(1) << cpu;
+    }
+    ret &= (mask != 0) && (SetThreadAffinityMask(thread, mask) != 0);
+  }
+  // Map the Linux classes onto the closest thread priorities.
+  int priority = THREAD_PRIORITY_NORMAL;
+  switch (policy.sched) {
+    case ThreadPolicy::kDefault:
+      if (policy.priority == 0) return ret;
+      [[fallthrough]];
+    case ThreadPolicy::kOther:
+    case ThreadPolicy::kBatch:
+      priority = (policy.priority > 0) ? THREAD_PRIORITY_BELOW_NORMAL
+          : (policy.priority < 0)      ? THREAD_PRIORITY_ABOVE_NORMAL
+                                       : THREAD_PRIORITY_NORMAL;
+      break;
+    case ThreadPolicy::kIdle:
+      priority = THREAD_PRIORITY_IDLE;
+      break;
+    case ThreadPolicy::kFifo:
+    case ThreadPolicy::kRoundRobin:
+      priority = THREAD_PRIORITY_TIME_CRITICAL;
+      break;
+  }
+  return ret && (SetThreadPriority(thread, priority) != 0);
+}
+
 Thread CreateThread(ThreadEntry entry_function, void* entry_argument,
-                    uint stack_size) {
+                    uint stack_size, uint32_t tag, const void* context,
+                    const ThreadPolicy* policy) {
   ThreadArgs* thread_args = new ThreadArgs();
   thread_args->entry_args = entry_argument;
   thread_args->entry_function = entry_function;
-  uintptr_t ret =
-      _beginthreadex(NULL, stack_size, ThreadTrampoline, thread_args, 0, NULL);
+  uintptr_t ret = _beginthreadex(NULL, stack_size, ThreadTrampoline, thread_args,
+                                 CREATE_SUSPENDED, NULL);
+  if (ret == 0) {
+    delete thread_args;
+    return nullptr;
+  }
+  ::HANDLE thread = (::HANDLE)ret;
+  if (policy != nullptr) ApplyThreadPolicy(thread, *policy);
+  {
+    std::lock_guard<std::mutex> lock(thread_list_lock);
+    ThreadList()[thread] = std::make_pair(tag, context);
+  }
+  ResumeThread(thread);
   return *(Thread*)&ret;
 }
 
-void CloseThread(Thread thread) { CloseHandle(*(::HANDLE*)&thread); }
+void CloseThread(Thread thread) {
+  {
+    std::lock_guard<std::mutex> lock(thread_list_lock);
+    ThreadList().erase(*(::HANDLE*)&thread);
+  }
+  CloseHandle(*(::HANDLE*)&thread);
+}
+
+bool SetThreadPolicy(Thread thread, const ThreadPolicy& policy) {
+  return ApplyThreadPolicy(*(::HANDLE*)&thread, policy);
+}
+
+void SetThreadPolicy(uint32_t tag, const std::function<ThreadPolicy(const void*)>& policy) {
+  std::lock_guard<std::mutex> lock(thread_list_lock);
+  for (auto& thread : ThreadList()) {
+    if (thread.second.first == tag)
+      ApplyThreadPolicy(thread.first, policy(thread.second.second));
+  }
+}
+
+bool RegisterForkHandlers(void (*prepare)(), void (*parent)(), void (*child)()) { return false; }
 
 bool WaitForThread(Thread thread) {
   return WaitForSingleObject(*(::HANDLE*)&thread, INFINITE) == WAIT_OBJECT_0;
@@ -246,6 +342,30 @@ int ResetOsEvent(EventHandle event) {
   return ResetEvent(reinterpret_cast<::HANDLE>(event));
 }
 
+bool FutexWait(std::atomic<uint32_t>* word, uint32_t expected, uint32_t milli_seconds) {
+  return WaitOnAddress(word, &expected, sizeof(expected), milli_seconds) ||
+      GetLastError() != ERROR_TIMEOUT;
+}
+
+void FutexWake(std::atomic<uint32_t>* word, bool all) {
+  if (all)
+    WakeByAddressAll(word);
+  else
+    WakeByAddressSingle(word);
+}
+
+bool FutexWaitMultiple(std::atomic<uint32_t>* const* words, const uint32_t* expected,
+                       uint32_t count, uint32_t milli_seconds) {
+  // WaitOnAddress watches one address, so sleep on the first in 1ms slices and check the rest.
+  const uint64_t start = GetTickCount64();
+  while (true) {
+    for (uint32_t i = 0; i < count; i++)
+      if (words[i]->load(std::memory_order_acquire) != expected[i]) return true;
+    if (milli_seconds != INFINITE && GetTickCount64() - start >= milli_seconds) return false;
+    FutexWait(words[0], expected[0], 1);
+  }
+}
+
 uint64_t ReadAccurateClock() {
   uint64_t ret;
   QueryPerformanceCounter((LARGE_INTEGER*)&ret);
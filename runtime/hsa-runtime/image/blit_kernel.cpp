@@ -48,6 +48,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <sstream>
 #include <string>
 
@@ -109,6 +110,52 @@ extern uint8_t ocl_blit_object_gfx1152[];
 extern uint8_t ocl_blit_object_gfx1200[];
 extern uint8_t ocl_blit_object_gfx1201[];
 
+// Prebuilt blit code objects, indexed by the agent name they were compiled for.
+static const struct {
+  const char* name;
+  uint8_t* code_object;
+} kBlitObjects[] = {
+    {"gfx700", ocl_blit_object_gfx700},
+    {"gfx701", ocl_blit_object_gfx701},
+    {"gfx702", ocl_blit_object_gfx702},
+    {"gfx801", ocl_blit_object_gfx801},
+    {"gfx802", ocl_blit_object_gfx802},
+    {"gfx803", ocl_blit_object_gfx803},
+    {"gfx805", ocl_blit_object_gfx805},
+    {"gfx810", ocl_blit_object_gfx810},
+    {"gfx900", ocl_blit_object_gfx900},
+    {"gfx902", ocl_blit_object_gfx902},
+    {"gfx904", ocl_blit_object_gfx904},
+    {"gfx906", ocl_blit_object_gfx906},
+    {"gfx908", ocl_blit_object_gfx908},
+    {"gfx909", ocl_blit_object_gfx909},
+    {"gfx90a", ocl_blit_object_gfx90a},
+    {"gfx90c", ocl_blit_object_gfx90c},
+    {"gfx940", ocl_blit_object_gfx940},
+    {"gfx941", ocl_blit_object_gfx941},
+    {"gfx942", ocl_blit_object_gfx942},
+    {"gfx1010", ocl_blit_object_gfx1010},
+    {"gfx1011", ocl_blit_object_gfx1011},
+    {"gfx1012", ocl_blit_object_gfx1012},
+    {"gfx1013", ocl_blit_object_gfx1013},
+    {"gfx1030", ocl_blit_object_gfx1030},
+    {"gfx1031", ocl_blit_object_gfx1031},
+    {"gfx1032", ocl_blit_object_gfx1032},
+    {"gfx1033", ocl_blit_object_gfx1033},
+    {"gfx1034", ocl_blit_object_gfx1034},
+    {"gfx1035", ocl_blit_object_gfx1035},
+    {"gfx1036", ocl_blit_object_gfx1036},
+    {"gfx1100", ocl_blit_object_gfx1100},
+    {"gfx1101", ocl_blit_object_gfx1101},
+    {"gfx1102", ocl_blit_object_gfx1102},
+    {"gfx1103", ocl_blit_object_gfx1103},
+    {"gfx1150", ocl_blit_object_gfx1150},
+    {"gfx1151", ocl_blit_object_gfx1151},
+    {"gfx1152", ocl_blit_object_gfx1152},
+    {"gfx1200", ocl_blit_object_gfx1200},
+    {"gfx1201", ocl_blit_object_gfx1201},
+};
+
 // Arguments inserted by OCL compiler, all zero here.
 struct OCLHiddenArgs {
   uint64_t offset_x;
@@ -164,51 +211,43 @@ hsa_status_t BlitKernel::Cleanup() {
 
 hsa_status_t BlitKernel::BuildBlitCode(
     hsa_agent_t agent, std::vector<BlitCodeInfo>& blit_code_catalog) {
-  // Find existing kernels in the list that have compatible ISA.
+  std::lock_guard<std::mutex> lock(lock_);
+
+  // Kernel symbols are per agent, so each agent gets its own executable.
+  auto it = code_executable_map_.find(agent.handle);
+  if (it != code_executable_map_.end()) {
+    return PopulateKernelCode(agent, it->second, blit_code_catalog);
+  }
+
   hsa_isa_t agent_isa = {0};
   hsa_status_t status = HSA::hsa_agent_get_info(agent, HSA_AGENT_INFO_ISA, &agent_isa);
   if (HSA_STATUS_SUCCESS != status) {
     return status;
   }
 
-  std::lock_guard<std::mutex> lock(lock_);
-
-  for (std::pair<uint64_t, hsa_executable_t> pair : code_executable_map_) {
-    bool isa_compatible = false;
-    hsa_isa_t code_isa = {pair.first};
-
-    status = HSA::hsa_isa_compatible(code_isa, agent_isa, &isa_compatible);
+  // The prebuilt code object only depends on the ISA, look it up once per ISA.
+  hsa_code_object_t code_object = {0};
+  auto object = code_object_map_.find(agent_isa.handle);
+  if (object != code_object_map_.end()) {
+    code_object = object->second;
+  } else {
+    // Get the target name
+    char agent_name[64] = {0};
+    status = HSA::hsa_agent_get_info(agent, HSA_AGENT_INFO_NAME, &agent_name);
     if (HSA_STATUS_SUCCESS != status) {
       return status;
     }
 
-    if (isa_compatible) {
-      return PopulateKernelCode(agent, pair.second, blit_code_catalog);
+    uint8_t* blit_code_object;
+    status = GetBlitObject(agent_name, &blit_code_object);
+    if (HSA_STATUS_SUCCESS != status) {
+      return status;
     }
-  }
 
-  // No existing compatible kernels. Build new kernels.
-  hsa_code_object_t code_object = {0};
-
-  // Get the target name
-  char agent_name[64] = {0};
-  status = HSA::hsa_agent_get_info(agent, HSA_AGENT_INFO_NAME, &agent_name);
-  if (HSA_STATUS_SUCCESS != status) {
-    return status;
-  }
-
-  // Get the patched code object
-  uint8_t* patched_code_object;
-  status = BlitKernel::GetPatchedBlitObject(agent_name, &patched_code_object);
-  if (HSA_STATUS_SUCCESS != status) {
-    return status;
+    code_object.handle = reinterpret_cast<uint64_t>(blit_code_object);
+    code_object_map_[agent_isa.handle] = code_object;
   }
 
-  // Pass the patched code object
-  code_object.handle = reinterpret_cast<uint64_t>(patched_code_object);
-
-  code_object_map_[agent_isa.handle] = code_object;
-
   // Create executable.
   hsa_executable_t executable = {0};
   status =
@@ -217,28 +256,29 @@ hsa_status_t BlitKernel::BuildBlitCode(
     return status;
   }
 
-  code_executable_map_[agent_isa.handle] = executable;
-
-  // Load code object.
+  // Load code object and freeze executable.
   status = HSA::hsa_executable_load_code_object(executable, agent, code_object, "");
-  if (HSA_STATUS_SUCCESS != status) {
-    return status;
+  if (HSA_STATUS_SUCCESS == status) {
+    status = HSA::hsa_executable_freeze(executable, "");
   }
-
-  // Freeze executable.
-  status = HSA::hsa_executable_freeze(executable, "");
   if (HSA_STATUS_SUCCESS != status) {
+    HSA::hsa_executable_destroy(executable);
     return status;
   }
 
+  code_executable_map_[agent.handle] = executable;
+
   return PopulateKernelCode(agent, executable, blit_code_catalog);
 }
 
 hsa_status_t BlitKernel::CopyBufferToImage(
     BlitQueue& blit_queue, const std::vector<BlitCodeInfo>& blit_code_catalog,
     const void* src_memory, size_t src_row_pitch, size_t src_slice_pitch,
-    const Image& dst_image, const hsa_ext_image_region_t& image_region) {
+    const Image& dst_image, const hsa_ext_image_region_t& image_region, Batch* batch) {
   if (dst_image.desc.geometry == HSA_EXT_IMAGE_GEOMETRY_1DB) {
+    // Buffer images are transferred by the host, which cannot wait for dependencies.
+    if (batch != NULL && batch->async_) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
     ImageManager* manager = ImageRuntime::instance()->image_manager(dst_image.component);
 
     const uint32_t element_size =
@@ -261,6 +301,9 @@ hsa_status_t BlitKernel::CopyBufferToImage(
 
   assert(dst_image_view != NULL);
 
+  if (dst_image_view == &dst_image) dst_image_view = BatchView(dst_image, batch);
+  if (dst_image_view == NULL) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
   hsa_kernel_dispatch_packet_t packet = {0};
 
   const BlitCodeInfo& blit_code =
@@ -331,12 +374,9 @@ hsa_status_t BlitKernel::CopyBufferToImage(
   // Setup packet dimension and working size.
   CalcWorkingSize(*dst_image_view, image_region.range, packet);
 
-  status = LaunchKernel(blit_queue, packet);
+  status = LaunchKernel(blit_queue, packet, batch);
 
-  if (&dst_image != dst_image_view) {
-    Image::Destroy(dst_image_view);
-  }
-  AMD::hsa_amd_memory_pool_free(args);
+  Release(batch, args, (&dst_image != dst_image_view) ? dst_image_view : NULL);
 
   return status;
 }
@@ -344,8 +384,11 @@ hsa_status_t BlitKernel::CopyBufferToImage(
 hsa_status_t BlitKernel::CopyImageToBuffer(
     BlitQueue& blit_queue, const std::vector<BlitCodeInfo>& blit_code_catalog,
     const Image& src_image, void* dst_memory, size_t dst_row_pitch,
-    size_t dst_slice_pitch, const hsa_ext_image_region_t& image_region) {
+    size_t dst_slice_pitch, const hsa_ext_image_region_t& image_region, Batch* batch) {
   if (src_image.desc.geometry == HSA_EXT_IMAGE_GEOMETRY_1DB) {
+    // Buffer images are transferred by the host, which cannot wait for dependencies.
+    if (batch != NULL && batch->async_) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
     ImageManager* manager = ImageRuntime::instance()->image_manager(src_image.component);
 
     const uint32_t element_size =
@@ -369,6 +412,9 @@ hsa_status_t BlitKernel::CopyImageToBuffer(
 
   assert(src_image_view != NULL);
 
+  if (src_image_view == &src_image) src_image_view = BatchView(src_image, batch);
+  if (src_image_view == NULL) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
   hsa_kernel_dispatch_packet_t packet = {0};
 
   const BlitCodeInfo& blit_code =
@@ -439,12 +485,9 @@ hsa_status_t BlitKernel::CopyImageToBuffer(
   // Setup packet dimension and working size.
   CalcWorkingSize(*src_image_view, image_region.range, packet);
 
-  status = LaunchKernel(blit_queue, packet);
+  status = LaunchKernel(blit_queue, packet, batch);
 
-  if (&src_image != src_image_view) {
-    Image::Destroy(src_image_view);
-  }
-  AMD::hsa_amd_memory_pool_free(args);
+  Release(batch, args, (&src_image != src_image_view) ? src_image_view : NULL);
 
   return status;
 }
@@ -453,7 +496,7 @@ hsa_status_t BlitKernel::CopyImage(
     BlitQueue& blit_queue, const std::vector<BlitCodeInfo>& blit_code_catalog,
     const Image& dst_image, const Image& src_image,
     const hsa_dim3_t& dst_origin, const hsa_dim3_t& src_origin,
-    const hsa_dim3_t size, KernelOp copy_type) {
+    const hsa_dim3_t size, KernelOp copy_type, Batch* batch) {
   assert(src_image.component.handle == dst_image.component.handle);
 
   const Image* src_image_view = &src_image;
@@ -496,6 +539,14 @@ hsa_status_t BlitKernel::CopyImage(
     blit_code = &blit_code_catalog.at(copy_type);
   }
 
+  if (src_image_view == &src_image) src_image_view = BatchView(src_image, batch);
+  if (dst_image_view == &dst_image) dst_image_view = BatchView(dst_image, batch);
+  if (src_image_view == NULL || dst_image_view == NULL) {
+    Release(batch, NULL, (src_image_view != &src_image) ? src_image_view : NULL,
+            (dst_image_view != &dst_image) ? dst_image_view : NULL);
+    return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
   hsa_kernel_dispatch_packet_t packet = {0};
 
   packet.kernel_object = blit_code->code_handle_;
@@ -536,17 +587,10 @@ hsa_status_t BlitKernel::CopyImage(
   // Setup packet dimension and working size.
   CalcWorkingSize(*src_image_view, *dst_image_view, size, packet);
 
-  hsa_status_t status = LaunchKernel(blit_queue, packet);
+  hsa_status_t status = LaunchKernel(blit_queue, packet, batch);
 
-  if (&src_image != src_image_view) {
-    Image::Destroy(src_image_view);
-  }
-
-  if (&dst_image != dst_image_view) {
-    Image::Destroy(dst_image_view);
-  }
-
-  AMD::hsa_amd_memory_pool_free(args);
+  Release(batch, args, (&src_image != src_image_view) ? src_image_view : NULL,
+          (&dst_image != dst_image_view) ? dst_image_view : NULL);
 
   return status;
 }
@@ -554,7 +598,10 @@ hsa_status_t BlitKernel::CopyImage(
 hsa_status_t BlitKernel::FillImage(
     BlitQueue& blit_queue, const std::vector<BlitCodeInfo>& blit_code_catalog,
     const Image& image, const void* pattern,
-    const hsa_ext_image_region_t& region) {
+    const hsa_ext_image_region_t& region, Batch* batch) {
+  const Image* image_view = BatchView(image, batch);
+  if (image_view == NULL) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
   hsa_kernel_dispatch_packet_t packet = {0};
 
   const BlitCodeInfo& blit_code =
@@ -580,7 +627,7 @@ hsa_status_t BlitKernel::FillImage(
   memset(args, 0, sizeof(KernelArgs));
 
   for(auto &img : args->image)
-    img = image.Convert();
+    img = image_view->Convert();
   args->format = image.desc.geometry;
   for(int i=0; i<4; i++)
     args->data[i] = ((const uint32_t*)pattern)[i];
@@ -594,9 +641,9 @@ hsa_status_t BlitKernel::FillImage(
   // Setup packet dimension and working size.
   CalcWorkingSize(image, region.range, packet);
 
-  hsa_status_t status = LaunchKernel(blit_queue, packet);
+  hsa_status_t status = LaunchKernel(blit_queue, packet, batch);
 
-  AMD::hsa_amd_memory_pool_free(args);
+  Release(batch, args, (&image != image_view) ? image_view : NULL);
 
   return status;
 }
@@ -911,59 +958,170 @@ hsa_status_t BlitKernel::ConvertImage(const Image& original_image,
   return HSA_STATUS_SUCCESS;
 }
 
-hsa_status_t BlitKernel::LaunchKernel(BlitQueue& blit_queue,
-                                      hsa_kernel_dispatch_packet_t& packet) {
-  static const uint16_t kInvalidPacketHeader = HSA_PACKET_TYPE_INVALID;
-
-  static const uint16_t kDispatchPacketHeader =
-      (HSA_PACKET_TYPE_KERNEL_DISPATCH << HSA_PACKET_HEADER_TYPE) |
-      (0 << HSA_PACKET_HEADER_BARRIER) |
-      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
-      (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
-
-  // Copying the packet content to the queue buffer is not atomic, so it is
-  // possible that the packet has a valid packet type but invalid content.
-  // To make sure packet processor does not read invalid packet, we first
-  // initialized the packet type to invalid.
-  packet.header = kInvalidPacketHeader;
-
-  // Setup completion signal.
-  hsa_signal_t kernel_signal = {0};
-  hsa_status_t status = HSA::hsa_signal_create(1, 0, NULL, &kernel_signal);
+const Image* BlitKernel::BatchView(const Image& image, Batch* batch) {
+  if (batch == NULL) return &image;
+
+  Image* view = Image::Create(image.component);
+  if (view != NULL) *view = image;
+  return view;
+}
+
+void BlitKernel::Release(Batch* batch, void* args, const Image* view,
+                         const Image* other_view) {
+  if (batch != NULL) {
+    if (args != NULL) batch->kernargs_.push_back(args);
+    if (view != NULL) batch->views_.push_back(view);
+    if (other_view != NULL) batch->views_.push_back(other_view);
+    return;
+  }
+
+  if (view != NULL) Image::Destroy(view);
+  if (other_view != NULL) Image::Destroy(other_view);
+  if (args != NULL) AMD::hsa_amd_memory_pool_free(args);
+}
+
+static const uint16_t kInvalidPacketHeader = HSA_PACKET_TYPE_INVALID;
+
+static const uint16_t kDispatchPacketHeader =
+    (HSA_PACKET_TYPE_KERNEL_DISPATCH << HSA_PACKET_HEADER_TYPE) |
+    (0 << HSA_PACKET_HEADER_BARRIER) |
+    (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
+    (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+
+static const uint16_t kBarrierPacketHeader =
+    (HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE) |
+    (1 << HSA_PACKET_HEADER_BARRIER) |
+    (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE) |
+    (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE);
+
+/// @brief Returns a barrier-AND packet, in a dispatch packet sized slot, waiting for up to five
+/// @p deps and signaling @p completion_signal.
+static hsa_kernel_dispatch_packet_t BarrierPacket(const hsa_signal_t* deps, size_t num_deps,
+                                                  hsa_signal_t completion_signal) {
+  hsa_kernel_dispatch_packet_t slot = {0};
+  hsa_barrier_and_packet_t* barrier = reinterpret_cast<hsa_barrier_and_packet_t*>(&slot);
+  static_assert(sizeof(*barrier) == sizeof(slot), "AQL packet size mismatch");
+
+  barrier->header = kBarrierPacketHeader;
+  assert(num_deps <= sizeof(barrier->dep_signal) / sizeof(barrier->dep_signal[0]));
+  for (size_t i = 0; i < num_deps; ++i) barrier->dep_signal[i] = deps[i];
+  barrier->completion_signal = completion_signal;
+  return slot;
+}
+
+void BlitKernel::ReleaseBatch(Batch& batch) {
+  for (const Image* view : batch.views_) Image::Destroy(view);
+  for (void* args : batch.kernargs_) AMD::hsa_amd_memory_pool_free(args);
+
+  batch.packets_.clear();
+  batch.views_.clear();
+  batch.kernargs_.clear();
+}
+
+hsa_status_t BlitKernel::SubmitBatch(BlitQueue& blit_queue, Batch& batch) {
+  hsa_status_t status = HSA_STATUS_SUCCESS;
+  if (!batch.packets_.empty()) {
+    status = LaunchPackets(blit_queue, &batch.packets_[0], batch.packets_.size());
+  }
+
+  ReleaseBatch(batch);
+
+  return status;
+}
+
+bool BlitKernel::RetireBatch(hsa_signal_value_t value, void* arg) {
+  Batch* batch = reinterpret_cast<Batch*>(arg);
+
+  HSA::hsa_signal_destroy(batch->retire_signal_);
+  ReleaseBatch(*batch);
+  delete batch;
+
+  return false;
+}
+
+hsa_status_t BlitKernel::SubmitBatchAsync(BlitQueue& blit_queue, Batch& batch,
+                                          uint32_t num_dep_signals,
+                                          const hsa_signal_t* dep_signals,
+                                          hsa_signal_t completion_signal) {
+  // Kernel arguments and views are released by an async handler once a barrier behind the
+  // batch retires, so they move to a heap allocated batch owned by that handler.
+  Batch* retired = new Batch();
+  std::swap(retired->packets_, batch.packets_);
+  std::swap(retired->kernargs_, batch.kernargs_);
+  std::swap(retired->views_, batch.views_);
+
+  hsa_status_t status = HSA::hsa_signal_create(1, 0, NULL, &retired->retire_signal_);
   if (HSA_STATUS_SUCCESS != status) {
+    ReleaseBatch(*retired);
+    delete retired;
     return status;
   }
-  packet.completion_signal = kernel_signal;
 
-  // Populate the queue.
-  hsa_queue_t* queue = blit_queue.queue_;
-  const uint32_t bitmask = queue->size - 1;
+  static const size_t kBarrierDeps = 5;
+  std::vector<hsa_kernel_dispatch_packet_t> packets;
+  packets.reserve((num_dep_signals + kBarrierDeps - 1) / kBarrierDeps +
+                  retired->packets_.size() + 2);
 
-  // Reserve write index.
-  uint64_t write_index = HSA::hsa_queue_add_write_index_scacq_screl(queue, 1);
+  // Barrier-AND packets stall the queue until their dependencies are satisfied.
+  for (uint32_t i = 0; i < num_dep_signals; i += kBarrierDeps) {
+    packets.push_back(BarrierPacket(dep_signals + i,
+                                    std::min<size_t>(kBarrierDeps, num_dep_signals - i),
+                                    hsa_signal_t{0}));
+  }
+  for (hsa_kernel_dispatch_packet_t& packet : retired->packets_) {
+    packet.header = kDispatchPacketHeader;
+    packets.push_back(packet);
+  }
+  packets.push_back(BarrierPacket(NULL, 0, completion_signal));
+  packets.push_back(BarrierPacket(NULL, 0, retired->retire_signal_));
 
-  while (true) {
-    // Wait until we have room in the queue;
-    const uint64_t read_index = HSA::hsa_queue_load_read_index_relaxed(queue);
-    if ((write_index - read_index) < queue->size) {
-      break;
-    }
+  status = AMD::hsa_amd_signal_async_handler(retired->retire_signal_, HSA_SIGNAL_CONDITION_LT,
+                                             1, RetireBatch, retired);
+  if (HSA_STATUS_SUCCESS != status) {
+    HSA::hsa_signal_destroy(retired->retire_signal_);
+    ReleaseBatch(*retired);
+    delete retired;
+    return status;
   }
 
-  // Populate queue buffer with AQL packet.
-  hsa_kernel_dispatch_packet_t* queue_buffer =
-      reinterpret_cast<hsa_kernel_dispatch_packet_t*>(queue->base_address);
-  queue_buffer[write_index & bitmask] = packet;
+  WritePackets(blit_queue, &packets[0], packets.size());
+
+  return HSA_STATUS_SUCCESS;
+}
 
-  std::atomic_thread_fence(std::memory_order_release);
+hsa_status_t BlitKernel::LaunchKernel(BlitQueue& blit_queue,
+                                      hsa_kernel_dispatch_packet_t& packet, Batch* batch) {
+  if (batch != NULL) {
+    batch->packets_.push_back(packet);
+    return HSA_STATUS_SUCCESS;
+  }
 
-  // Enable packet.
-  queue_buffer[write_index & bitmask].header = kDispatchPacketHeader;
+  return LaunchPackets(blit_queue, &packet, 1);
+}
 
-  // Update doorbel register.
-  HSA::hsa_signal_store_screlease(queue->doorbell_signal, write_index);
+hsa_status_t BlitKernel::LaunchPackets(BlitQueue& blit_queue,
+                                       hsa_kernel_dispatch_packet_t* packets, size_t count) {
+  assert(count != 0);
+
+  // Setup completion signal. A single dispatch signals it directly, a batch is retired by a
+  // trailing barrier packet which waits for all dispatches ahead of it.
+  hsa_signal_t kernel_signal = {0};
+  hsa_status_t status = HSA::hsa_signal_create(1, 0, NULL, &kernel_signal);
+  if (HSA_STATUS_SUCCESS != status) {
+    return status;
+  }
+
+  for (size_t i = 0; i < count; ++i) packets[i].header = kDispatchPacketHeader;
+  if (count == 1) {
+    packets[0].completion_signal = kernel_signal;
+    WritePackets(blit_queue, packets, 1);
+  } else {
+    std::vector<hsa_kernel_dispatch_packet_t> batch(packets, packets + count);
+    batch.push_back(BarrierPacket(NULL, 0, kernel_signal));
+    WritePackets(blit_queue, &batch[0], batch.size());
+  }
 
-  // Wait for the packet to finish.
+  // Wait for the packets to finish.
   if (HSA::hsa_signal_wait_scacquire(kernel_signal, HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1),
                                      HSA_WAIT_STATE_ACTIVE) != 0) {
     status = HSA::hsa_signal_destroy(kernel_signal);
@@ -979,93 +1137,57 @@ hsa_status_t BlitKernel::LaunchKernel(BlitQueue& blit_queue,
   return HSA_STATUS_SUCCESS;
 }
 
-hsa_status_t BlitKernel::GetPatchedBlitObject(const char* agent_name,
-                                              uint8_t** blit_code_object) {
-  std::string sname(agent_name);
-
-  if (sname == "gfx700") {
-    *blit_code_object = ocl_blit_object_gfx700;
-  } else if (sname == "gfx701") {
-    *blit_code_object = ocl_blit_object_gfx701;
-  } else if (sname == "gfx702") {
-    *blit_code_object = ocl_blit_object_gfx702;
-  } else if (sname == "gfx801") {
-    *blit_code_object = ocl_blit_object_gfx801;
-  } else if (sname == "gfx802") {
-    *blit_code_object = ocl_blit_object_gfx802;
-  } else if (sname == "gfx803") {
-    *blit_code_object = ocl_blit_object_gfx803;
-  } else if (sname == "gfx805") {
-    *blit_code_object = ocl_blit_object_gfx805;
-  } else if (sname == "gfx810") {
-    *blit_code_object = ocl_blit_object_gfx810;
-  } else if (sname == "gfx900") {
-    *blit_code_object = ocl_blit_object_gfx900;
-  } else if (sname == "gfx902") {
-    *blit_code_object = ocl_blit_object_gfx902;
-  } else if (sname == "gfx904") {
-    *blit_code_object = ocl_blit_object_gfx904;
-  } else if (sname == "gfx906") {
-    *blit_code_object = ocl_blit_object_gfx906;
-  } else if (sname == "gfx908") {
-    *blit_code_object = ocl_blit_object_gfx908;
-  } else if (sname == "gfx909") {
-    *blit_code_object = ocl_blit_object_gfx909;
-  } else if (sname == "gfx90a") {
-    *blit_code_object = ocl_blit_object_gfx90a;
-  } else if (sname == "gfx90c") {
-    *blit_code_object = ocl_blit_object_gfx90c;
-  } else if (sname == "gfx940") {
-    *blit_code_object = ocl_blit_object_gfx940;
-  } else if (sname == "gfx941") {
-    *blit_code_object = ocl_blit_object_gfx941;
-  } else if (sname == "gfx942") {
-    *blit_code_object = ocl_blit_object_gfx942;
-  } else if (sname == "gfx1010") {
-    *blit_code_object = ocl_blit_object_gfx1010;
-  } else if (sname == "gfx1011") {
-    *blit_code_object = ocl_blit_object_gfx1011;
-  } else if (sname == "gfx1012") {
-    *blit_code_object = ocl_blit_object_gfx1012;
-  } else if (sname == "gfx1013") {
-    *blit_code_object = ocl_blit_object_gfx1013;
-  } else if (sname == "gfx1030") {
-    *blit_code_object = ocl_blit_object_gfx1030;
-  } else if (sname == "gfx1031") {
-    *blit_code_object = ocl_blit_object_gfx1031;
-  } else if (sname == "gfx1032") {
-    *blit_code_object = ocl_blit_object_gfx1032;
-  } else if (sname == "gfx1033") {
-    *blit_code_object = ocl_blit_object_gfx1033;
-  } else if (sname == "gfx1034") {
-    *blit_code_object = ocl_blit_object_gfx1034;
-  } else if (sname == "gfx1035") {
-    *blit_code_object = ocl_blit_object_gfx1035;
-  } else if (sname == "gfx1036") {
-    *blit_code_object = ocl_blit_object_gfx1036;
-  } else if (sname == "gfx1100") {
-    *blit_code_object = ocl_blit_object_gfx1100;
-  } else if (sname == "gfx1101") {
-    *blit_code_object = ocl_blit_object_gfx1101;
-  } else if (sname == "gfx1102") {
-    *blit_code_object = ocl_blit_object_gfx1102;
-  } else if (sname == "gfx1103") {
-    *blit_code_object = ocl_blit_object_gfx1103;
-  } else if (sname == "gfx1150") {
-    *blit_code_object = ocl_blit_object_gfx1150;
-  } else if (sname == "gfx1151") {
-    *blit_code_object = ocl_blit_object_gfx1151;
-  } else if (sname == "gfx1152") {
-    *blit_code_object = ocl_blit_object_gfx1152;
-  } else if (sname == "gfx1200") {
-    *blit_code_object = ocl_blit_object_gfx1200;
-  } else if (sname == "gfx1201") {
-    *blit_code_object = ocl_blit_object_gfx1201;
-  } else {
-    return HSA_STATUS_ERROR_INVALID_ISA_NAME;
+void BlitKernel::WritePackets(BlitQueue& blit_queue, hsa_kernel_dispatch_packet_t* packets,
+                              size_t count) {
+  // Populate the queue.
+  hsa_queue_t* queue = blit_queue.queue_;
+  const uint32_t bitmask = queue->size - 1;
+
+  // Reserve write indices for all packets.
+  const uint64_t write_index = HSA::hsa_queue_add_write_index_scacq_screl(queue, count);
+
+  hsa_kernel_dispatch_packet_t* queue_buffer =
+      reinterpret_cast<hsa_kernel_dispatch_packet_t*>(queue->base_address);
+
+  for (size_t i = 0; i < count; ++i) {
+    const uint64_t index = write_index + i;
+
+    // Wait until we have room in the queue. Runs of packets larger than the queue need the
+    // packets written so far to be consumed first, so ring the doorbell for them.
+    if ((index - HSA::hsa_queue_load_read_index_relaxed(queue)) >= queue->size) {
+      if (i != 0) HSA::hsa_signal_store_screlease(queue->doorbell_signal, index - 1);
+      while ((index - HSA::hsa_queue_load_read_index_relaxed(queue)) >= queue->size) {
+      }
+    }
+
+    // Copying the packet content to the queue buffer is not atomic, so it is
+    // possible that the packet has a valid packet type but invalid content.
+    // To make sure packet processor does not read invalid packet, we first
+    // initialized the packet type to invalid.
+    const uint16_t header = packets[i].header;
+    packets[i].header = kInvalidPacketHeader;
+    queue_buffer[index & bitmask] = packets[i];
+    packets[i].header = header;
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Enable packet.
+    queue_buffer[index & bitmask].header = header;
   }
 
-  return HSA_STATUS_SUCCESS;
+  // Update doorbel register.
+  HSA::hsa_signal_store_screlease(queue->doorbell_signal, write_index + count - 1);
+}
+
+hsa_status_t BlitKernel::GetBlitObject(const char* agent_name, uint8_t** blit_code_object) {
+  for (const auto& object : kBlitObjects) {
+    if (strcmp(object.name, agent_name) == 0) {
+      *blit_code_object = object.code_object;
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
+  return HSA_STATUS_ERROR_INVALID_ISA_NAME;
 }
 
 }  // namespace image
@@ -81,6 +81,20 @@ class BlitKernel {
     KERNEL_OP_COUNT = 10
   } KernelOp;
 
+  /// @brief Dispatches recorded by blit operations issued with a batch, together with the
+  /// kernel arguments and image views they read. The dispatches are submitted back to back by
+  /// SubmitBatch and are not ordered with respect to each other.
+  typedef struct Batch {
+    std::vector<hsa_kernel_dispatch_packet_t> packets_;
+    std::vector<void*> kernargs_;
+    std::vector<const Image*> views_;
+    // Set when the batch is submitted behind dependency signals, the recorded operations must
+    // then not be carried out by the host.
+    bool async_ = false;
+    // Signaled once an asynchronous batch retired.
+    hsa_signal_t retire_signal_ = {0};
+  } Batch;
+
   explicit BlitKernel();
   ~BlitKernel();
 
@@ -95,25 +109,40 @@ class BlitKernel {
       BlitQueue& blit_queue,
       const std::vector<BlitCodeInfo>& blit_code_catalog,
       const void* src_memory, size_t src_row_pitch, size_t src_slice_pitch,
-      const Image& dst_image, const hsa_ext_image_region_t& image_region);
+      const Image& dst_image, const hsa_ext_image_region_t& image_region,
+      Batch* batch = NULL);
 
   hsa_status_t CopyImageToBuffer(
       BlitQueue& blit_queue,
       const std::vector<BlitCodeInfo>& blit_code_catalog,
       const Image& src_image, void* dst_memory, size_t dst_row_pitch,
-      size_t dst_slice_pitch, const hsa_ext_image_region_t& image_region);
+      size_t dst_slice_pitch, const hsa_ext_image_region_t& image_region,
+      Batch* batch = NULL);
 
   hsa_status_t CopyImage(BlitQueue& blit_queue,
                          const std::vector<BlitCodeInfo>& blit_code_catalog,
                          const Image& dst_image, const Image& src_image,
                          const hsa_dim3_t& dst_origin,
                          const hsa_dim3_t& src_origin, const hsa_dim3_t size,
-                         KernelOp copy_type);
+                         KernelOp copy_type, Batch* batch = NULL);
 
   hsa_status_t FillImage(BlitQueue& blit_queue,
                          const std::vector<BlitCodeInfo>& blit_code_catalog,
                          const Image& image, const void* pattern,
-                         const hsa_ext_image_region_t& region);
+                         const hsa_ext_image_region_t& region, Batch* batch = NULL);
+
+  /// @brief Submits the dispatches recorded in @p batch, retired by a single barrier packet,
+  /// waits for them and releases the batch's resources.
+  hsa_status_t SubmitBatch(BlitQueue& blit_queue, Batch& batch);
+
+  /// @brief Submits the dispatches recorded in @p batch behind @p dep_signals without waiting
+  /// for them. @p completion_signal is decremented once all of them finished.
+  hsa_status_t SubmitBatchAsync(BlitQueue& blit_queue, Batch& batch, uint32_t num_dep_signals,
+                                const hsa_signal_t* dep_signals,
+                                hsa_signal_t completion_signal);
+
+  /// @brief Releases the resources of a batch which is not going to be submitted.
+  static void ReleaseBatch(Batch& batch);
 
  private:
 
@@ -142,25 +171,42 @@ class BlitKernel {
   hsa_status_t ConvertImage(const Image& original_image,
                             const Image** new_image);
 
+  /// @brief Returns a copy of @p image owned by @p batch, so that callers may restore
+  /// descriptor changes made for the blit before the batch executes.
+  const Image* BatchView(const Image& image, Batch* batch);
+
+  /// @brief Frees @p args and the converted views, or hands them to @p batch when batching.
+  void Release(Batch* batch, void* args, const Image* view,
+               const Image* other_view = NULL);
+
   hsa_status_t LaunchKernel(BlitQueue& queue,
-                            hsa_kernel_dispatch_packet_t& packet);
+                            hsa_kernel_dispatch_packet_t& packet, Batch* batch);
+
+  hsa_status_t LaunchPackets(BlitQueue& queue, hsa_kernel_dispatch_packet_t* packets,
+                             size_t count);
+
+  /// @brief Writes @p count packets, each enabled with the header it holds, to consecutive
+  /// slots of the queue and rings its doorbell.
+  void WritePackets(BlitQueue& queue, hsa_kernel_dispatch_packet_t* packets, size_t count);
+
+  static bool RetireBatch(hsa_signal_value_t value, void* arg);
 
   // The kernels' name.
   static const char* kernel_name_[KERNEL_OP_COUNT];
   static const char* ocl_kernel_name_[KERNEL_OP_COUNT];
 
-  // Mapping of ISA and kernel object.
+  // Mapping of ISA and prebuilt code object.
   std::unordered_map<uint64_t, hsa_code_object_t> code_object_map_;
 
-  // Mapping of ISA and kernel executable.
+  // Mapping of agent and kernel executable.
   std::unordered_map<uint64_t, hsa_executable_t> code_executable_map_;
 
   std::mutex lock_;
 
   DISALLOW_COPY_AND_ASSIGN(BlitKernel);
 
-  // Get the patched code object
-  hsa_status_t GetPatchedBlitObject(const char* agent_name, uint8_t** code_object_handle);
+  // Get the prebuilt code object of an agent name
+  hsa_status_t GetBlitObject(const char* agent_name, uint8_t** code_object_handle);
 };
 
 }  // namespace image
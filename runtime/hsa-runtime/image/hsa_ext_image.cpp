@@ -176,6 +176,31 @@ hsa_status_t hsa_ext_image_create(hsa_agent_t agent,
   CATCH;
 }
 
+hsa_status_t hsa_amd_image_create_batch(hsa_agent_t agent, uint32_t num_images,
+                                        const hsa_ext_image_descriptor_t* image_descriptors,
+                                        const void* const* image_data,
+                                        hsa_access_permission_t access_permission,
+                                        hsa_ext_image_t* images) {
+  TRY;
+  if (agent.handle == 0) {
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+
+  if (num_images == 0) return HSA_STATUS_SUCCESS;
+
+  if (image_descriptors == NULL || image_data == NULL || images == NULL) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  for (uint32_t i = 0; i < num_images; ++i) {
+    if (image_data[i] == NULL) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  return ImageRuntime::instance()->CreateImageHandles(agent, num_images, image_descriptors,
+                                                      image_data, access_permission, images);
+  CATCH;
+}
+
 hsa_status_t hsa_ext_image_destroy(hsa_agent_t agent, hsa_ext_image_t image) {
   TRY;
   if (agent.handle == 0) {
@@ -253,6 +278,149 @@ hsa_status_t hsa_ext_image_clear(hsa_agent_t agent, hsa_ext_image_t image, const
   CATCH;
 };
 
+/// @brief Checks the entries of @p blits carry what their operation needs.
+static hsa_status_t ValidateBlits(uint32_t num_blits, const hsa_amd_image_blit_t* blits) {
+  for (uint32_t i = 0; i < num_blits; ++i) {
+    const hsa_amd_image_blit_t& blit = blits[i];
+    if (blit.image.handle == 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    switch (blit.op) {
+      case HSA_AMD_IMAGE_BLIT_IMPORT:
+      case HSA_AMD_IMAGE_BLIT_EXPORT:
+        if (blit.memory == NULL) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+        break;
+      case HSA_AMD_IMAGE_BLIT_COPY:
+        if (blit.src_image.handle == 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+        break;
+      case HSA_AMD_IMAGE_BLIT_CLEAR:
+        if (blit.data == NULL) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+        break;
+      default:
+        return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    }
+  }
+
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_image_blit(hsa_agent_t agent, uint32_t num_blits,
+                                const hsa_amd_image_blit_t* blits) {
+  TRY;
+  if (agent.handle == 0) {
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+
+  if (num_blits == 0) return HSA_STATUS_SUCCESS;
+
+  if (blits == NULL) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  hsa_status_t status = ValidateBlits(num_blits, blits);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  return ImageRuntime::instance()->BlitImages(num_blits, blits);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_image_blit_async(hsa_agent_t agent, uint32_t num_blits,
+                                      const hsa_amd_image_blit_t* blits,
+                                      uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                      hsa_signal_t completion_signal) {
+  TRY;
+  if (agent.handle == 0) {
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+
+  if (completion_signal.handle == 0) {
+    return HSA_STATUS_ERROR_INVALID_SIGNAL;
+  }
+
+  if ((num_blits != 0 && blits == NULL) || (num_dep_signals != 0 && dep_signals == NULL)) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  hsa_status_t status = ValidateBlits(num_blits, blits);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  return ImageRuntime::instance()->BlitImagesAsync(agent, num_blits, blits, num_dep_signals,
+                                                   dep_signals, completion_signal);
+  CATCH;
+}
+
+hsa_status_t hsa_amd_image_import_async(hsa_agent_t agent, const void* src_memory,
+                                        size_t src_row_pitch, size_t src_slice_pitch,
+                                        hsa_ext_image_t dst_image,
+                                        const hsa_ext_image_region_t* image_region,
+                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                        hsa_signal_t completion_signal) {
+  if (image_region == NULL) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  hsa_amd_image_blit_t blit = {};
+  blit.op = HSA_AMD_IMAGE_BLIT_IMPORT;
+  blit.image = dst_image;
+  blit.memory = const_cast<void*>(src_memory);
+  blit.row_pitch = src_row_pitch;
+  blit.slice_pitch = src_slice_pitch;
+  blit.region = *image_region;
+  return image::hsa_amd_image_blit_async(agent, 1, &blit, num_dep_signals, dep_signals,
+                                         completion_signal);
+}
+
+hsa_status_t hsa_amd_image_export_async(hsa_agent_t agent, hsa_ext_image_t src_image,
+                                        void* dst_memory, size_t dst_row_pitch,
+                                        size_t dst_slice_pitch,
+                                        const hsa_ext_image_region_t* image_region,
+                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                        hsa_signal_t completion_signal) {
+  if (image_region == NULL) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  hsa_amd_image_blit_t blit = {};
+  blit.op = HSA_AMD_IMAGE_BLIT_EXPORT;
+  blit.image = src_image;
+  blit.memory = dst_memory;
+  blit.row_pitch = dst_row_pitch;
+  blit.slice_pitch = dst_slice_pitch;
+  blit.region = *image_region;
+  return image::hsa_amd_image_blit_async(agent, 1, &blit, num_dep_signals, dep_signals,
+                                         completion_signal);
+}
+
+hsa_status_t hsa_amd_image_copy_async(hsa_agent_t agent, hsa_ext_image_t src_image,
+                                      const hsa_dim3_t* src_offset, hsa_ext_image_t dst_image,
+                                      const hsa_dim3_t* dst_offset, const hsa_dim3_t* range,
+                                      uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                      hsa_signal_t completion_signal) {
+  if (src_offset == NULL || dst_offset == NULL || range == NULL) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  hsa_amd_image_blit_t blit = {};
+  blit.op = HSA_AMD_IMAGE_BLIT_COPY;
+  blit.image = dst_image;
+  blit.src_image = src_image;
+  blit.region.offset = *dst_offset;
+  blit.region.range = *range;
+  blit.src_offset = *src_offset;
+  return image::hsa_amd_image_blit_async(agent, 1, &blit, num_dep_signals, dep_signals,
+                                         completion_signal);
+}
+
+hsa_status_t hsa_amd_image_clear_async(hsa_agent_t agent, hsa_ext_image_t image,
+                                       const void* data,
+                                       const hsa_ext_image_region_t* image_region,
+                                       uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                       hsa_signal_t completion_signal) {
+  if (image_region == NULL) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  hsa_amd_image_blit_t blit = {};
+  blit.op = HSA_AMD_IMAGE_BLIT_CLEAR;
+  blit.image = image;
+  blit.data = data;
+  blit.region = *image_region;
+  return image::hsa_amd_image_blit_async(agent, 1, &blit, num_dep_signals, dep_signals,
+                                         completion_signal);
+}
+
 hsa_status_t hsa_ext_sampler_create(hsa_agent_t agent,
                                     const hsa_ext_sampler_descriptor_t* sampler_descriptor,
                                     hsa_ext_sampler_t* sampler) {
@@ -418,6 +586,19 @@ void LoadImage(core::ImageExtTableInternal* image_api,
 
   image_api->hsa_amd_image_get_info_max_dim_fn = hsa_amd_image_get_info_max_dim;
 
+  image_api->hsa_amd_image_blit_fn = hsa_amd_image_blit;
+
+  image_api->hsa_amd_image_blit_async_fn = hsa_amd_image_blit_async;
+
+  image_api->hsa_amd_image_import_async_fn = hsa_amd_image_import_async;
+
+  image_api->hsa_amd_image_export_async_fn = hsa_amd_image_export_async;
+
+  image_api->hsa_amd_image_copy_async_fn = hsa_amd_image_copy_async;
+
+  image_api->hsa_amd_image_clear_async_fn = hsa_amd_image_clear_async;
+  image_api->hsa_amd_image_create_batch_fn = hsa_amd_image_create_batch;
+
   image_api->hsa_ext_sampler_create_v2_fn = hsa_ext_sampler_create_v2;
 
   *interface_api = hsa_amd_image_create;
@@ -42,6 +42,7 @@
 
 #include "inc/hsa_ext_amd.h"
 #include "inc/hsa_ext_image.h"
+#include "core/inc/hsa_internal.h"
 #include "core/inc/hsa_ext_amd_impl.h"
 #include "image_manager.h"
 #include "image_runtime.h"
@@ -61,69 +62,113 @@ namespace rocr {
 namespace image {
 
 Image* Image::Create(hsa_agent_t agent) {
-  hsa_amd_memory_pool_t pool = ImageRuntime::instance()->kernarg_pool();
-
-  Image* image = NULL;
+  ImageManager* manager = ImageRuntime::instance()->image_manager(agent);
+  if (manager == NULL) return NULL;
 
-  hsa_status_t status =
-      AMD::hsa_amd_memory_pool_allocate(pool, sizeof(Image), 0, reinterpret_cast<void**>(&image));
-  assert(status == HSA_STATUS_SUCCESS);
-
-  if (status != HSA_STATUS_SUCCESS) return NULL;
+  Image* image = reinterpret_cast<Image*>(manager->image_pool().Allocate(agent));
+  if (image == NULL) return NULL;
 
   new (image) Image();
-
-  status = AMD::hsa_amd_agents_allow_access(1, &agent, NULL, image);
-
-  if (status != HSA_STATUS_SUCCESS) {
-    Image::Destroy(image);
-    return NULL;
-  }
+  image->component = agent;
 
   return image;
 }
 
 void Image::Destroy(const Image* image) {
   assert(image != NULL);
+  const hsa_agent_t agent = image->component;
   image->~Image();
 
-  hsa_status_t status = AMD::hsa_amd_memory_pool_free(const_cast<Image*>(image));
-
-  assert(status == HSA_STATUS_SUCCESS);
+  ImageManager* manager = ImageRuntime::instance()->image_manager(agent);
+  assert(manager != NULL);
+  manager->image_pool().Free(const_cast<Image*>(image));
 }
 
 Sampler* Sampler::Create(hsa_agent_t agent) {
-  hsa_amd_memory_pool_t pool = ImageRuntime::instance()->kernarg_pool();
+  ImageManager* manager = ImageRuntime::instance()->image_manager(agent);
+  if (manager == NULL) return NULL;
 
-  Sampler* sampler = NULL;
+  Sampler* sampler = reinterpret_cast<Sampler*>(manager->sampler_pool().Allocate(agent));
+  if (sampler == NULL) return NULL;
 
-  hsa_status_t status = AMD::hsa_amd_memory_pool_allocate(pool, sizeof(Sampler), 0,
-                                                          reinterpret_cast<void**>(&sampler));
+  new (sampler) Sampler();
+  sampler->component = agent;
 
-  if (status != HSA_STATUS_SUCCESS) return NULL;
+  return sampler;
+}
 
-  new (sampler) Sampler();
+void Sampler::Destroy(const Sampler* sampler) {
+  assert(sampler != NULL);
+  const hsa_agent_t agent = sampler->component;
+  sampler->~Sampler();
+
+  ImageManager* manager = ImageRuntime::instance()->image_manager(agent);
+  assert(manager != NULL);
+  manager->sampler_pool().Free(const_cast<Sampler*>(sampler));
+}
+
+SrdPool::SrdPool(size_t object_size) : object_size_(object_size) {
+  assert(object_size_ <= kSlabSize);
+}
+
+SrdPool::~SrdPool() {
+  for (void* slab : slabs_) {
+    hsa_status_t status = AMD::hsa_amd_memory_pool_free(slab);
+    assert(status == HSA_STATUS_SUCCESS);
+  }
+}
+
+hsa_status_t SrdPool::Grow(hsa_agent_t agent) {
+  hsa_amd_memory_pool_t pool = ImageRuntime::instance()->kernarg_pool();
 
-  status = AMD::hsa_amd_agents_allow_access(1, &agent, NULL, sampler);
+  void* slab = NULL;
+  hsa_status_t status = AMD::hsa_amd_memory_pool_allocate(pool, kSlabSize, 0, &slab);
+  if (status != HSA_STATUS_SUCCESS) return status;
 
+  status = AMD::hsa_amd_agents_allow_access(1, &agent, NULL, slab);
   if (status != HSA_STATUS_SUCCESS) {
-    Sampler::Destroy(sampler);
-    return NULL;
+    AMD::hsa_amd_memory_pool_free(slab);
+    return status;
   }
 
-  return sampler;
+  slabs_.push_back(slab);
+
+  // Hand out the slab front to back.
+  const size_t count = kSlabSize / object_size_;
+  for (size_t i = count; i > 0; --i) {
+    free_list_.push_back(reinterpret_cast<char*>(slab) + (i - 1) * object_size_);
+  }
+
+  return HSA_STATUS_SUCCESS;
 }
 
-void Sampler::Destroy(const Sampler* sampler) {
-  assert(sampler != NULL);
-  sampler->~Sampler();
+void* SrdPool::Allocate(hsa_agent_t agent) {
+  std::lock_guard<std::mutex> lock(lock_);
 
-  hsa_status_t status = AMD::hsa_amd_memory_pool_free(const_cast<Sampler*>(sampler));
+  if (free_list_.empty() && Grow(agent) != HSA_STATUS_SUCCESS) return NULL;
 
-  assert(status == HSA_STATUS_SUCCESS);
+  void* object = free_list_.back();
+  free_list_.pop_back();
+  return object;
 }
 
-ImageManager::ImageManager() {}
+void SrdPool::Free(void* object) {
+  std::lock_guard<std::mutex> lock(lock_);
+  free_list_.push_back(object);
+}
+
+hsa_status_t SrdPool::Reserve(hsa_agent_t agent, size_t count) {
+  std::lock_guard<std::mutex> lock(lock_);
+
+  while (free_list_.size() < count) {
+    hsa_status_t status = Grow(agent);
+    if (status != HSA_STATUS_SUCCESS) return status;
+  }
+
+  return HSA_STATUS_SUCCESS;
+}
+
+ImageManager::ImageManager() : image_pool_(sizeof(Image)), sampler_pool_(sizeof(Sampler)) {}
 
 ImageManager::~ImageManager() {}
 
@@ -325,6 +370,52 @@ hsa_status_t ImageManager::CopyImage(const Image& dst_image,
   return HSA_STATUS_SUCCESS;
 }
 
+hsa_status_t ImageManager::BlitImages(uint32_t count, const hsa_amd_image_blit_t* blits) {
+  for (uint32_t i = 0; i < count; ++i) {
+    const hsa_amd_image_blit_t& blit = blits[i];
+    const Image& image = *Image::Convert(blit.image.handle);
+
+    hsa_status_t status = HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    switch (blit.op) {
+      case HSA_AMD_IMAGE_BLIT_IMPORT:
+        status = CopyBufferToImage(blit.memory, blit.row_pitch, blit.slice_pitch, image,
+                                   blit.region);
+        break;
+      case HSA_AMD_IMAGE_BLIT_EXPORT:
+        status = CopyImageToBuffer(image, blit.memory, blit.row_pitch, blit.slice_pitch,
+                                   blit.region);
+        break;
+      case HSA_AMD_IMAGE_BLIT_COPY:
+        status = CopyImage(image, *Image::Convert(blit.src_image.handle), blit.region.offset,
+                           blit.src_offset, blit.region.range);
+        break;
+      case HSA_AMD_IMAGE_BLIT_CLEAR:
+        status = FillImage(image, blit.data, blit.region);
+        break;
+    }
+    if (status != HSA_STATUS_SUCCESS) return status;
+  }
+
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t ImageManager::BlitImagesAsync(uint32_t count, const hsa_amd_image_blit_t* blits,
+                                           uint32_t num_dep_signals,
+                                           const hsa_signal_t* dep_signals,
+                                           hsa_signal_t completion_signal) {
+  // Host transfers have no queue to wait on, so satisfy the dependencies first.
+  for (uint32_t i = 0; i < num_dep_signals; ++i) {
+    HSA::hsa_signal_wait_scacquire(dep_signals[i], HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1),
+                                   HSA_WAIT_STATE_BLOCKED);
+  }
+
+  hsa_status_t status = BlitImages(count, blits);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  if (completion_signal.handle != 0) HSA::hsa_signal_subtract_screlease(completion_signal, 1);
+  return HSA_STATUS_SUCCESS;
+}
+
 uint16_t ImageManager::FloatToHalf(float in) {
   volatile union {
     float f;
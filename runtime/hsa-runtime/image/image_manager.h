@@ -44,14 +44,47 @@
 #define AMD_HSA_EXT_IMAGE_IMAGE_MANAGER_H
 
 #include <cstring>
+#include <mutex>
+#include <vector>
 #include "inc/hsa.h"
 #include "inc/hsa_ext_image.h"
+#include "inc/hsa_ext_amd.h"
 #include "resource.h"
 #include "util.h"
 
 namespace rocr {
 namespace image {
 
+/// @brief Slab allocator of agent accessible image / sampler objects. Slabs are carved from
+/// the kernarg pool and made accessible to the agent once, instead of per object.
+class SrdPool {
+ public:
+  explicit SrdPool(size_t object_size);
+  ~SrdPool();
+
+  /// @brief Returns storage for one object, or NULL if out of memory.
+  void* Allocate(hsa_agent_t agent);
+
+  /// @brief Returns storage obtained from Allocate to the pool.
+  void Free(void* object);
+
+  /// @brief Makes sure @p count objects can be allocated without growing the pool.
+  hsa_status_t Reserve(hsa_agent_t agent, size_t count);
+
+ private:
+  // Caller holds lock_.
+  hsa_status_t Grow(hsa_agent_t agent);
+
+  static const size_t kSlabSize = 64 * 1024;
+
+  const size_t object_size_;
+  std::vector<void*> slabs_;
+  std::vector<void*> free_list_;
+  std::mutex lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(SrdPool);
+};
+
 /// @brief Abstract class for creating AMD agent specific image / sampler
 /// resources and data transfer.
 class ImageManager {
@@ -59,6 +92,10 @@ class ImageManager {
   explicit ImageManager();
   virtual ~ImageManager();
 
+  /// @brief Pools backing the image and sampler objects of the agent.
+  SrdPool& image_pool() { return image_pool_; }
+  SrdPool& sampler_pool() { return sampler_pool_; }
+
   virtual hsa_status_t Initialize(hsa_agent_t agent_handle) = 0;
 
   virtual void Cleanup() = 0;
@@ -120,6 +157,16 @@ class ImageManager {
   virtual hsa_status_t FillImage(const Image& image, const void* pattern,
                                  const hsa_ext_image_region_t& region);
 
+  /// @brief Perform @p count independent image transfers and fills.
+  virtual hsa_status_t BlitImages(uint32_t count, const hsa_amd_image_blit_t* blits);
+
+  /// @brief Perform @p count independent image transfers and fills once @p dep_signals are
+  /// satisfied, decrementing @p completion_signal when done.
+  virtual hsa_status_t BlitImagesAsync(uint32_t count, const hsa_amd_image_blit_t* blits,
+                                       uint32_t num_dep_signals,
+                                       const hsa_signal_t* dep_signals,
+                                       hsa_signal_t completion_signal);
+
  protected:
   static uint16_t FloatToHalf(float in);
 
@@ -163,6 +210,9 @@ class ImageManager {
     return HSA_STATUS_SUCCESS;
   }
  private:
+  SrdPool image_pool_;
+  SrdPool sampler_pool_;
+
   DISALLOW_COPY_AND_ASSIGN(ImageManager);
 };
 
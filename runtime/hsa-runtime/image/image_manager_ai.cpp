@@ -503,6 +503,24 @@ uint32_t ImageManagerAi::GetAddrlibSurfaceInfoAi(
     size_t image_data_row_pitch,
     size_t image_data_slice_pitch,
     ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out) const {
+  SurfaceInfoKey key(component, desc, tileMode, image_data_row_pitch, image_data_slice_pitch);
+  SurfaceInfoCache<ADDR2_COMPUTE_SURFACE_INFO_OUTPUT>& cache =
+      SurfaceInfoCache<ADDR2_COMPUTE_SURFACE_INFO_OUTPUT>::Instance();
+  uint32_t swizzle_mode = 0;
+  if (cache.Find(key, out, swizzle_mode)) return swizzle_mode;
+
+  swizzle_mode = ComputeAddrlibSurfaceInfoAi(component, desc, tileMode, image_data_row_pitch,
+                                             image_data_slice_pitch, out);
+  if (swizzle_mode != (uint32_t)(-1)) cache.Insert(key, out, swizzle_mode);
+  return swizzle_mode;
+}
+
+uint32_t ImageManagerAi::ComputeAddrlibSurfaceInfoAi(
+    hsa_agent_t component, const hsa_ext_image_descriptor_t& desc,
+    Image::TileMode tileMode,
+    size_t image_data_row_pitch,
+    size_t image_data_slice_pitch,
+    ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out) const {
   const ImageProperty image_prop =
       GetImageProperty(component, desc.format, desc.geometry);
 
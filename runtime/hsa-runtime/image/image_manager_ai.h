@@ -84,6 +84,13 @@ class ImageManagerAi : public ImageManagerKv {
                              size_t image_data_slice_pitch,
                              ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out) const;
 
+  uint32_t ComputeAddrlibSurfaceInfoAi(hsa_agent_t component,
+                                       const hsa_ext_image_descriptor_t& desc,
+                                       Image::TileMode tileMode,
+                                       size_t image_data_row_pitch,
+                                       size_t image_data_slice_pitch,
+                                       ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out) const;
+
   bool IsLocalMemory(const void* address) const;
 
  private:
@@ -230,9 +230,9 @@ hsa_status_t ImageManagerGfx11::CalculateImageSizeAndAlignment(
                 desc.geometry != HSA_EXT_IMAGE_GEOMETRY_1DB)?
       Image::TileMode::TILED : Image::TileMode::LINEAR;
   }
-  if (GetAddrlibSurfaceInfoNv(component, desc, tileMode,
-        image_data_row_pitch, image_data_slice_pitch, out) ==
-                                                             (uint32_t)(-1)) {
+  const uint32_t swizzle_mode = GetAddrlibSurfaceInfoNv(component, desc, tileMode,
+        image_data_row_pitch, image_data_slice_pitch, out);
+  if (swizzle_mode == (uint32_t)(-1)) {
     return HSA_STATUS_ERROR;
   }
 
@@ -251,6 +251,13 @@ hsa_status_t ImageManagerGfx11::CalculateImageSizeAndAlignment(
   image_info.alignment = out.baseAlign;
   assert(image_info.alignment != 0);
 
+  // Compressed images keep their DCC metadata behind the surface.
+  ADDR2_COMPUTE_DCCINFO_OUTPUT dcc;
+  if (ComputeAddrlibDccInfo(desc, tileMode, swizzle_mode, out, dcc)) {
+    image_info.size = AlignUp(image_info.size, dcc.dccRamBaseAlign) + dcc.dccRamSize;
+    image_info.alignment = std::max<size_t>(image_info.alignment, dcc.dccRamBaseAlign);
+  }
+
   return HSA_STATUS_SUCCESS;
 }
 
@@ -455,8 +462,8 @@ hsa_status_t ImageManagerGfx11::PopulateImageSrd(Image& image) const {
     SQ_IMG_RSRC_WORD3 word3;
     SQ_IMG_RSRC_WORD4 word4;
     SQ_IMG_RSRC_WORD5 word5;
-    SQ_IMG_RSRC_WORD5 word6;
-    SQ_IMG_RSRC_WORD5 word7;
+    SQ_IMG_RSRC_WORD6 word6;
+    SQ_IMG_RSRC_WORD7 word7;
 
     ADDR2_COMPUTE_SURFACE_INFO_OUTPUT out = {0};
 
@@ -513,6 +520,23 @@ hsa_status_t ImageManagerGfx11::PopulateImageSrd(Image& image) const {
     word6.val = 0;
     word7.val = 0;
 
+    ADDR2_COMPUTE_DCCINFO_OUTPUT dcc;
+    if (ComputeAddrlibDccInfo(image.desc, image.tile_mode, swizzleMode, out, dcc)) {
+      const size_t meta_offset = AlignUp(static_cast<size_t>(out.surfSize), dcc.dccRamBaseAlign);
+      if (ClearDccMetadata(reinterpret_cast<char*>(image.data) + meta_offset, dcc.dccRamSize) ==
+          HSA_STATUS_SUCCESS) {
+        const void* meta = reinterpret_cast<const char*>(image_data_addr) + meta_offset;
+        // Independent 256B uncompressed and 128B compressed blocks allow shader writes.
+        word6.f.MAX_UNCOMP_BLK_SZ = 2;
+        word6.f.MAX_COMP_BLK_SZ = 1;
+        word6.f.META_PIPE_ALIGNED = 1;
+        word6.f.WRITE_COMPRESS_ENABLE = 1;
+        word6.f.COMPRESSION_ENABLE = 1;
+        word6.f.META_DATA_ADDRESS = PtrLow16Shift8(meta);
+        word7.f.META_DATA_ADDRESS_HI = PtrHigh64Shift16(meta);
+      }
+    }
+
     image.srd[0] = word0.val;
     image.srd[1] = word1.val;
     image.srd[2] = word2.val;
@@ -623,6 +647,35 @@ uint32_t ImageManagerGfx11::GetAddrlibSurfaceInfoNv(
     size_t image_data_row_pitch,
     size_t image_data_slice_pitch,
     ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out) const {
+  // Linear layouts follow directly from the element size, skip addrlib and the cache lock.
+  if (tileMode == Image::TileMode::LINEAR) {
+    const uint32_t element_size = static_cast<uint32_t>(
+        GetImageProperty(component, desc.format, desc.geometry).element_size);
+    if (element_size != 0) {
+      const uint32_t pitch_in_element =
+          static_cast<uint32_t>(image_data_row_pitch / element_size);
+      if (LinearSurfaceInfo(desc, element_size, pitch_in_element, out)) return ADDR_SW_LINEAR;
+    }
+  }
+
+  SurfaceInfoKey key(component, desc, tileMode, image_data_row_pitch, image_data_slice_pitch);
+  SurfaceInfoCache<ADDR2_COMPUTE_SURFACE_INFO_OUTPUT>& cache =
+      SurfaceInfoCache<ADDR2_COMPUTE_SURFACE_INFO_OUTPUT>::Instance();
+  uint32_t swizzle_mode = 0;
+  if (cache.Find(key, out, swizzle_mode)) return swizzle_mode;
+
+  swizzle_mode = ComputeAddrlibSurfaceInfoNv(component, desc, tileMode, image_data_row_pitch,
+                                             image_data_slice_pitch, out);
+  if (swizzle_mode != (uint32_t)(-1)) cache.Insert(key, out, swizzle_mode);
+  return swizzle_mode;
+}
+
+uint32_t ImageManagerGfx11::ComputeAddrlibSurfaceInfoNv(
+    hsa_agent_t component, const hsa_ext_image_descriptor_t& desc,
+    Image::TileMode tileMode,
+    size_t image_data_row_pitch,
+    size_t image_data_slice_pitch,
+    ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out) const {
   const ImageProperty image_prop =
       GetImageProperty(component, desc.format, desc.geometry);
 
@@ -713,7 +766,8 @@ uint32_t ImageManagerGfx11::GetAddrlibSurfaceInfoNv(
 }
 
 hsa_status_t ImageManagerGfx11::FillImage(const Image& image, const void* pattern,
-                                       const hsa_ext_image_region_t& region) {
+                                       const hsa_ext_image_region_t& region,
+                                       BlitKernel::Batch* batch) {
   if (BlitQueueInit().queue_ == NULL) {
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
@@ -766,7 +820,7 @@ hsa_status_t ImageManagerGfx11::FillImage(const Image& image, const void* patter
   }
 
   hsa_status_t status = ImageRuntime::instance()->blit_kernel().FillImage(
-      blit_queue_, blit_code_catalog_, *image_view, new_pattern, region);
+      blit_queue_, blit_code_catalog_, *image_view, new_pattern, region, batch);
 
   // Revert back original configuration.
   if (word3_buff != NULL) {
@@ -646,6 +646,24 @@ uint32_t ImageManagerGfx12::GetAddrlibSurfaceInfoNv(
     size_t image_data_row_pitch,
     size_t image_data_slice_pitch,
     ADDR3_COMPUTE_SURFACE_INFO_OUTPUT& out) const {
+  SurfaceInfoKey key(component, desc, tileMode, image_data_row_pitch, image_data_slice_pitch);
+  SurfaceInfoCache<ADDR3_COMPUTE_SURFACE_INFO_OUTPUT>& cache =
+      SurfaceInfoCache<ADDR3_COMPUTE_SURFACE_INFO_OUTPUT>::Instance();
+  uint32_t swizzle_mode = 0;
+  if (cache.Find(key, out, swizzle_mode)) return swizzle_mode;
+
+  swizzle_mode = ComputeAddrlibSurfaceInfoNv(component, desc, tileMode, image_data_row_pitch,
+                                             image_data_slice_pitch, out);
+  if (swizzle_mode != (uint32_t)(-1)) cache.Insert(key, out, swizzle_mode);
+  return swizzle_mode;
+}
+
+uint32_t ImageManagerGfx12::ComputeAddrlibSurfaceInfoNv(
+    hsa_agent_t component, const hsa_ext_image_descriptor_t& desc,
+    Image::TileMode tileMode,
+    size_t image_data_row_pitch,
+    size_t image_data_slice_pitch,
+    ADDR3_COMPUTE_SURFACE_INFO_OUTPUT& out) const {
   const ImageProperty image_prop =
       GetImageProperty(component, desc.format, desc.geometry);
 
@@ -806,7 +824,8 @@ uint32_t ImageManagerGfx12::GetAddrlibSurfaceInfoNv(
 }
 
 hsa_status_t ImageManagerGfx12::FillImage(const Image& image, const void* pattern,
-                                       const hsa_ext_image_region_t& region) {
+                                       const hsa_ext_image_region_t& region,
+                                       BlitKernel::Batch* batch) {
   if (BlitQueueInit().queue_ == NULL) {
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
@@ -859,7 +878,7 @@ hsa_status_t ImageManagerGfx12::FillImage(const Image& image, const void* patter
   }
 
   hsa_status_t status = ImageRuntime::instance()->blit_kernel().FillImage(
-      blit_queue_, blit_code_catalog_, *image_view, new_pattern, region);
+      blit_queue_, blit_code_catalog_, *image_view, new_pattern, region, batch);
 
   // Revert back original configuration.
   if (word3_buff != NULL) {
@@ -47,11 +47,15 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstring>
+#include <map>
+#include <vector>
 
 #include "hsakmt/hsakmt.h"
 #include "inc/hsa_ext_amd.h"
 #include "core/inc/hsa_internal.h"
 #include "core/inc/hsa_ext_amd_impl.h"
+#include "core/inc/runtime.h"
 #include "addrlib/inc/addrinterface.h"
 #include "addrlib/src/core/addrlib.h"
 #include "image_runtime.h"
@@ -82,6 +86,67 @@ ASSERT_SIZE_UINT32(SQ_IMG_SAMP_WORD1)
 ASSERT_SIZE_UINT32(SQ_IMG_SAMP_WORD2)
 ASSERT_SIZE_UINT32(SQ_IMG_SAMP_WORD3)
 
+namespace {
+// Addrlib instances only depend on the ASIC family and the tiling registers, so agents with
+// identical GPUs share one. Entries are reference counted by the image managers using them.
+struct SharedAddrLib {
+  ADDR_HANDLE handle;
+  uint32_t ref_count;
+};
+
+std::mutex& AddrLibLock() {
+  static std::mutex lock;
+  return lock;
+}
+
+std::map<std::vector<uint32_t>, SharedAddrLib>& AddrLibMap() {
+  static std::map<std::vector<uint32_t>, SharedAddrLib> addr_libs;
+  return addr_libs;
+}
+
+std::vector<uint32_t> AddrLibKey(const ADDR_CREATE_INPUT& input) {
+  const ADDR_REGISTER_VALUE& reg_val = input.regValue;
+  std::vector<uint32_t> key = {input.chipEngine,       input.chipFamily,
+                               input.chipRevision,     input.createFlags.value,
+                               reg_val.gbAddrConfig,   reg_val.noOfBanks,
+                               reg_val.noOfRanks,      reg_val.noOfEntries,
+                               reg_val.noOfMacroEntries};
+  key.insert(key.end(), reg_val.pTileConfig, reg_val.pTileConfig + reg_val.noOfEntries);
+  key.insert(key.end(), reg_val.pMacroTileConfig,
+             reg_val.pMacroTileConfig + reg_val.noOfMacroEntries);
+  return key;
+}
+
+ADDR_HANDLE AcquireAddrLib(const ADDR_CREATE_INPUT& input) {
+  std::lock_guard<std::mutex> lock(AddrLibLock());
+  SharedAddrLib& addr_lib = AddrLibMap()[AddrLibKey(input)];
+  if (addr_lib.ref_count == 0) {
+    ADDR_CREATE_OUTPUT output = {0};
+    if (AddrCreate(&input, &output) != ADDR_OK) {
+      AddrLibMap().erase(AddrLibKey(input));
+      return NULL;
+    }
+    addr_lib.handle = output.hLib;
+  }
+  addr_lib.ref_count++;
+  return addr_lib.handle;
+}
+
+void ReleaseAddrLib(ADDR_HANDLE handle) {
+  std::lock_guard<std::mutex> lock(AddrLibLock());
+  std::map<std::vector<uint32_t>, SharedAddrLib>& addr_libs = AddrLibMap();
+  for (auto it = addr_libs.begin(); it != addr_libs.end(); ++it) {
+    if (it->second.handle != handle) continue;
+    if (--it->second.ref_count == 0) {
+      AddrDestroy(handle);
+      addr_libs.erase(it);
+    }
+    return;
+  }
+  assert(false && "Releasing an unknown addrlib handle");
+}
+}  // namespace
+
 ImageManagerKv::ImageManagerKv() : ImageManager() {}
 
 ImageManagerKv::~ImageManagerKv() {}
@@ -98,8 +163,8 @@ hsa_status_t ImageManagerKv::Initialize(hsa_agent_t agent_handle) {
   assert(status == HSA_STATUS_SUCCESS);
 
   HsaGpuTileConfig tileConfig = {0};
-  unsigned int tc[40];
-  unsigned int mtc[40];
+  unsigned int tc[40] = {0};
+  unsigned int mtc[40] = {0};
   tileConfig.TileConfig = &tc[0];
   tileConfig.NumTileConfigs = 40;
   tileConfig.MacroTileConfig = &mtc[0];
@@ -116,7 +181,6 @@ hsa_status_t ImageManagerKv::Initialize(hsa_agent_t agent_handle) {
   // Need to get this information from KMD.
   addr_lib_ = NULL;
   ADDR_CREATE_INPUT addr_create_input = {0};
-  ADDR_CREATE_OUTPUT addr_create_output = {0};
 
   if (major_ver >= 9) {
     addr_create_input.chipEngine = CIASICIDGFXENGINE_ARCTICISLAND;
@@ -149,12 +213,8 @@ hsa_status_t ImageManagerKv::Initialize(hsa_agent_t agent_handle) {
 
   addr_create_input.minPitchAlignPixels = 0;
 
-  ADDR_E_RETURNCODE addr_ret =
-      AddrCreate(&addr_create_input, &addr_create_output);
-
-  if (addr_ret == ADDR_OK) {
-    addr_lib_ = addr_create_output.hLib;
-  } else {
+  addr_lib_ = AcquireAddrLib(addr_create_input);
+  if (addr_lib_ == NULL) {
     return HSA_STATUS_ERROR;
   }
 
@@ -170,6 +230,13 @@ hsa_status_t ImageManagerKv::Initialize(hsa_agent_t agent_handle) {
   // TODO: handle the case where the call to hsa_set_memory_type happens after
   // hsa_ext_image_create.
 
+  uint8_t memory_properties[8] = {0};
+  status = HSA::hsa_agent_get_info(
+      agent_, static_cast<hsa_agent_info_t>(HSA_AMD_AGENT_INFO_MEMORY_PROPERTIES),
+      memory_properties);
+  is_apu_ = (status == HSA_STATUS_SUCCESS) &&
+      hsa_flag_isset64(memory_properties, HSA_AMD_MEMORY_PROPERTY_AGENT_IS_APU);
+
   hsa_region_t local_region = {0};
   status = HSA::hsa_agent_iterate_regions(agent_, GetLocalMemoryRegion, &local_region);
   assert(status == HSA_STATUS_SUCCESS);
@@ -195,7 +262,8 @@ void ImageManagerKv::Cleanup() {
   }
 
   if (addr_lib_ != NULL) {
-    AddrDestroy(addr_lib_);
+    ReleaseAddrLib(addr_lib_);
+    addr_lib_ = NULL;
   }
 }
 
@@ -563,28 +631,357 @@ hsa_status_t ImageManagerKv::PopulateSamplerSrd(Sampler& sampler) const {
   return HSA_STATUS_SUCCESS;
 }
 
+bool ImageManagerKv::IsHostCopyable(const void* address) const {
+  hsa_amd_pointer_info_t info = {0};
+  info.size = sizeof(info);
+  if (AMD::hsa_amd_pointer_info(address, &info, NULL, NULL, NULL) != HSA_STATUS_SUCCESS) {
+    return false;
+  }
+
+  switch (info.type) {
+    case HSA_EXT_POINTER_TYPE_UNKNOWN:
+    case HSA_EXT_POINTER_TYPE_LOCKED:
+      // Pageable or locked system memory.
+      return true;
+    case HSA_EXT_POINTER_TYPE_HSA:
+      break;
+    default:
+      return false;
+  }
+
+  // Device memory not visible through the BAR has no host address.
+  if (info.hostBaseAddress == NULL || info.hostBaseAddress != info.agentBaseAddress) return false;
+
+  // CPU stores to coarse grained device memory would bypass the agent's L2 on a dGPU.
+  if (is_apu_ || (info.global_flags & HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_FINE_GRAINED)) return true;
+  hsa_device_type_t type;
+  return (HSA::hsa_agent_get_info(info.agentOwner, HSA_AGENT_INFO_DEVICE, &type) ==
+          HSA_STATUS_SUCCESS) &&
+      (type == HSA_DEVICE_TYPE_CPU);
+}
+
+bool ImageManagerKv::ComputeAddrlibDccInfo(const hsa_ext_image_descriptor_t& desc,
+                                           Image::TileMode tile_mode, uint32_t swizzle_mode,
+                                           const ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& surf,
+                                           ADDR2_COMPUTE_DCCINFO_OUTPUT& dcc) const {
+  if (!core::Runtime::runtime_singleton_->flag().image_dcc()) return false;
+
+  // Depth images use HTILE rather than DCC, 1D and 3D images are left uncompressed.
+  if (tile_mode != Image::TileMode::TILED ||
+      (desc.geometry != HSA_EXT_IMAGE_GEOMETRY_2D &&
+       desc.geometry != HSA_EXT_IMAGE_GEOMETRY_2DA)) {
+    return false;
+  }
+
+  ADDR2_COMPUTE_DCCINFO_INPUT in = {0};
+  in.size = sizeof(ADDR2_COMPUTE_DCCINFO_INPUT);
+  // Shader image stores, used by the blit kernels, require pipe aligned metadata.
+  in.dccKeyFlags.pipeAligned = 1;
+  in.colorFlags.texture = 1;
+  in.resourceType = ADDR_RSRC_TEX_2D;
+  in.swizzleMode = static_cast<AddrSwizzleMode>(swizzle_mode);
+  in.bpp = surf.bpp;
+  in.unalignedWidth = static_cast<uint32_t>(desc.width);
+  in.unalignedHeight = static_cast<uint32_t>(desc.height);
+  in.numSlices = static_cast<uint32_t>(std::max(desc.array_size, static_cast<size_t>(1)));
+  in.numFrags = 1;
+  in.numMipLevels = 1;
+  in.dataSurfaceSize = static_cast<uint32_t>(surf.surfSize);
+  in.firstMipIdInTail = surf.firstMipIdInTail;
+
+  // Swizzle modes without DCC support make addrlib fail, such images stay uncompressed.
+  dcc = {0};
+  dcc.size = sizeof(ADDR2_COMPUTE_DCCINFO_OUTPUT);
+  if (Addr2ComputeDccInfo(addr_lib_, &in, &dcc) != ADDR_OK) return false;
+
+  return dcc.dccRamSize != 0;
+}
+
+hsa_status_t ImageManagerKv::ClearDccMetadata(void* meta, size_t size) {
+  // 0xFF keys describe uncompressed blocks, so the surface reads back as stored.
+  assert(IsMultipleOf(size, sizeof(uint32_t)));
+  return AMD::hsa_amd_memory_fill(meta, UINT32_MAX, size / sizeof(uint32_t));
+}
+
+bool ImageManagerKv::LinearSurfaceInfo(const hsa_ext_image_descriptor_t& desc,
+                                       uint32_t element_size, uint32_t pitch_in_element,
+                                       ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out) {
+  // Non power of two elements, i.e. 96 bit formats, are expanded by addrlib.
+  if (element_size == 0 || !IsPowerOfTwo(element_size) || element_size > 16) return false;
+
+  const bool tex_1d = desc.geometry == HSA_EXT_IMAGE_GEOMETRY_1D ||
+      desc.geometry == HSA_EXT_IMAGE_GEOMETRY_1DA || desc.geometry == HSA_EXT_IMAGE_GEOMETRY_1DB;
+  const uint32_t width = std::max(static_cast<uint32_t>(desc.width), 1u);
+  const uint32_t height = std::max(static_cast<uint32_t>(desc.height), 1u);
+  if (tex_1d && height > 1) return false;
+
+  // Rows of a linear surface are 256 byte aligned, a custom pitch must keep that alignment.
+  const uint32_t pitch_align = 256 / element_size;
+  uint32_t pitch = AlignUp(width, pitch_align);
+  if (pitch_in_element != 0) {
+    if (!IsMultipleOf(pitch_in_element, pitch_align) || pitch_in_element < pitch) return false;
+    pitch = pitch_in_element;
+  }
+
+  static const size_t kMinNumSlice = 1;
+  const uint32_t num_slice = static_cast<uint32_t>(
+      std::max(kMinNumSlice, std::max(desc.array_size, desc.depth)));
+
+  out = {0};
+  out.size = sizeof(ADDR2_COMPUTE_SURFACE_INFO_OUTPUT);
+  out.pitch = pitch;
+  out.height = height;
+  out.numSlices = num_slice;
+  out.sliceSize = static_cast<uint64_t>(pitch) * height * element_size;
+  out.surfSize = out.sliceSize * num_slice;
+  out.baseAlign = 256;
+  out.bpp = element_size * 8;
+  out.pixelBits = out.bpp;
+  out.pixelPitch = pitch;
+  out.pixelHeight = height;
+  out.blockWidth = pitch_align;
+  out.blockHeight = 1;
+  out.blockSlices = 1;
+  return true;
+}
+
+bool ImageManagerKv::LinearLayout(const Image& image, size_t& row_pitch,
+                                  size_t& slice_pitch) const {
+  if (image.tile_mode != Image::TileMode::LINEAR) return false;
+
+  const ImageProperty image_prop =
+      GetImageProperty(image.component, image.desc.format, image.desc.geometry);
+  const size_t element_size = image_prop.element_size;
+  if (element_size == 0) return false;
+
+  // Only layouts fully described by the image's pitches, which image creation has checked
+  // against addrlib, can be walked without asking addrlib again.
+  switch (image.desc.geometry) {
+    case HSA_EXT_IMAGE_GEOMETRY_1DB:
+    case HSA_EXT_IMAGE_GEOMETRY_1D:
+      row_pitch = image.desc.width * element_size;
+      slice_pitch = row_pitch;
+      break;
+    case HSA_EXT_IMAGE_GEOMETRY_2D:
+    case HSA_EXT_IMAGE_GEOMETRY_2DDEPTH:
+      if (image.row_pitch == 0) return false;
+      row_pitch = image.row_pitch;
+      slice_pitch = row_pitch * image.desc.height;
+      break;
+    case HSA_EXT_IMAGE_GEOMETRY_3D:
+    case HSA_EXT_IMAGE_GEOMETRY_2DA:
+    case HSA_EXT_IMAGE_GEOMETRY_2DADEPTH:
+      if (image.row_pitch == 0 || image.slice_pitch == 0) return false;
+      row_pitch = image.row_pitch;
+      slice_pitch = image.slice_pitch;
+      break;
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+bool ImageManagerKv::HostCopyLayout(const Image& image, const hsa_ext_image_region_t& region,
+                                    size_t& row_pitch, size_t& slice_pitch) const {
+  const size_t limit = core::Runtime::runtime_singleton_->flag().image_host_copy_size();
+  if (limit == 0 || !LinearLayout(image, row_pitch, slice_pitch)) return false;
+
+  const size_t element_size =
+      GetImageProperty(image.component, image.desc.format, image.desc.geometry).element_size;
+  const size_t height = std::max<size_t>(region.range.y, 1);
+  const size_t depth = std::max<size_t>(region.range.z, 1);
+  if (region.range.x * element_size * height * depth > limit) return false;
+
+  return IsHostCopyable(image.data);
+}
+
+/// @brief Returns true if @p address is memory the runtime allocated or locked. SDMA engines
+/// can not service page faults on pageable memory the way shaders do with XNACK.
+static bool IsDmaAccessible(const void* address) {
+  hsa_amd_pointer_info_t info = {0};
+  info.size = sizeof(info);
+  if (AMD::hsa_amd_pointer_info(address, &info, NULL, NULL, NULL) != HSA_STATUS_SUCCESS) {
+    return false;
+  }
+  return info.type == HSA_EXT_POINTER_TYPE_HSA || info.type == HSA_EXT_POINTER_TYPE_LOCKED;
+}
+
+bool ImageManagerKv::SdmaCopyRect(const hsa_pitched_ptr_t& dst, const hsa_dim3_t& dst_offset,
+                                  const hsa_pitched_ptr_t& src, const hsa_dim3_t& src_offset,
+                                  const hsa_dim3_t& range, size_t element_size,
+                                  hsa_amd_copy_direction_t dir) const {
+  if (!core::Runtime::runtime_singleton_->flag().image_sdma()) return false;
+
+  // The rect packets need DWORD aligned bases and pitches.
+  if (((reinterpret_cast<uintptr_t>(dst.base) | dst.pitch | dst.slice |
+        reinterpret_cast<uintptr_t>(src.base) | src.pitch | src.slice) & 3) != 0) {
+    return false;
+  }
+
+  if (!IsDmaAccessible(dst.base) || !IsDmaAccessible(src.base)) return false;
+
+  // Offsets and range carry x in bytes.
+  const uint32_t size = static_cast<uint32_t>(element_size);
+  const hsa_dim3_t dst_off = {dst_offset.x * size, dst_offset.y, dst_offset.z};
+  const hsa_dim3_t src_off = {src_offset.x * size, src_offset.y, src_offset.z};
+  const hsa_dim3_t rect = {range.x * size, std::max(range.y, 1u), std::max(range.z, 1u)};
+
+  hsa_signal_t signal;
+  if (HSA::hsa_signal_create(1, 0, NULL, &signal) != HSA_STATUS_SUCCESS) return false;
+
+  // Agents without SDMA engines or with rects beyond the packet limits fail here.
+  hsa_status_t status = AMD::hsa_amd_memory_async_copy_rect(&dst, &dst_off, &src, &src_off,
+                                                            &rect, agent_, dir, 0, NULL, signal);
+  if (status == HSA_STATUS_SUCCESS) {
+    HSA::hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1),
+                                   HSA_WAIT_STATE_BLOCKED);
+  }
+
+  HSA::hsa_signal_destroy(signal);
+  return status == HSA_STATUS_SUCCESS;
+}
+
+/// @brief Copies @p size elements of @p element_size bytes row by row between two linear
+/// layouts, each given as base address and byte pitches.
+static void HostCopyRegion(uint8_t* dst, size_t dst_row_pitch, size_t dst_slice_pitch,
+                           const uint8_t* src, size_t src_row_pitch, size_t src_slice_pitch,
+                           const hsa_dim3_t& size, size_t element_size) {
+  const size_t row_bytes = size.x * element_size;
+  const size_t height = std::max<size_t>(size.y, 1);
+  const size_t depth = std::max<size_t>(size.z, 1);
+
+  if (row_bytes == dst_row_pitch && row_bytes == src_row_pitch &&
+      dst_slice_pitch == src_slice_pitch && dst_slice_pitch == row_bytes * height) {
+    std::memcpy(dst, src, dst_slice_pitch * depth);
+    return;
+  }
+
+  for (size_t z = 0; z < depth; ++z) {
+    uint8_t* dst_row = dst + z * dst_slice_pitch;
+    const uint8_t* src_row = src + z * src_slice_pitch;
+    for (size_t y = 0; y < height; ++y) {
+      std::memcpy(dst_row, src_row, row_bytes);
+      dst_row += dst_row_pitch;
+      src_row += src_row_pitch;
+    }
+  }
+}
+
 hsa_status_t ImageManagerKv::CopyBufferToImage(
     const void* src_memory, size_t src_row_pitch, size_t src_slice_pitch,
     const Image& dst_image, const hsa_ext_image_region_t& image_region) {
+  return CopyBufferToImage(src_memory, src_row_pitch, src_slice_pitch, dst_image, image_region,
+                           NULL);
+}
+
+hsa_status_t ImageManagerKv::CopyBufferToImage(
+    const void* src_memory, size_t src_row_pitch, size_t src_slice_pitch,
+    const Image& dst_image, const hsa_ext_image_region_t& image_region,
+    BlitKernel::Batch* batch) {
+  size_t row_pitch, slice_pitch;
+  if ((batch == NULL || !batch->async_) &&
+      HostCopyLayout(dst_image, image_region, row_pitch, slice_pitch) &&
+      IsHostCopyable(src_memory)) {
+    const size_t element_size =
+        GetImageProperty(dst_image.component, dst_image.desc.format, dst_image.desc.geometry)
+            .element_size;
+    const hsa_dim3_t& offset = image_region.offset;
+    const hsa_dim3_t& range = image_region.range;
+    if (src_row_pitch == 0) src_row_pitch = range.x * element_size;
+    if (src_slice_pitch == 0) src_slice_pitch = src_row_pitch * std::max<size_t>(range.y, 1);
+
+    uint8_t* dst = static_cast<uint8_t*>(dst_image.data) + offset.x * element_size +
+        offset.y * row_pitch + offset.z * slice_pitch;
+    HostCopyRegion(dst, row_pitch, slice_pitch, static_cast<const uint8_t*>(src_memory),
+                   src_row_pitch, src_slice_pitch, range, element_size);
+    return HSA_STATUS_SUCCESS;
+  }
+
+  if (batch == NULL && dst_image.desc.geometry != HSA_EXT_IMAGE_GEOMETRY_1DB &&
+      LinearLayout(dst_image, row_pitch, slice_pitch)) {
+    const size_t element_size =
+        GetImageProperty(dst_image.component, dst_image.desc.format, dst_image.desc.geometry)
+            .element_size;
+    const hsa_dim3_t& range = image_region.range;
+    const size_t src_row = src_row_pitch ? src_row_pitch : range.x * element_size;
+    const size_t src_slice =
+        src_slice_pitch ? src_slice_pitch : src_row * std::max<size_t>(range.y, 1);
+
+    const hsa_pitched_ptr_t dst = {dst_image.data, row_pitch, slice_pitch};
+    const hsa_pitched_ptr_t src = {const_cast<void*>(src_memory), src_row, src_slice};
+    const hsa_dim3_t src_offset = {0, 0, 0};
+    if (SdmaCopyRect(dst, image_region.offset, src, src_offset, range, element_size,
+                     hsaHostToDevice)) {
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
   if (BlitQueueInit().queue_ == NULL) {
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
 
   return ImageRuntime::instance()->blit_kernel().CopyBufferToImage(
       blit_queue_, blit_code_catalog_, src_memory, src_row_pitch, src_slice_pitch, dst_image,
-      image_region);
+      image_region, batch);
 }
 
 hsa_status_t ImageManagerKv::CopyImageToBuffer(
     const Image& src_image, void* dst_memory, size_t dst_row_pitch,
     size_t dst_slice_pitch, const hsa_ext_image_region_t& image_region) {
+  return CopyImageToBuffer(src_image, dst_memory, dst_row_pitch, dst_slice_pitch, image_region,
+                           NULL);
+}
+
+hsa_status_t ImageManagerKv::CopyImageToBuffer(
+    const Image& src_image, void* dst_memory, size_t dst_row_pitch,
+    size_t dst_slice_pitch, const hsa_ext_image_region_t& image_region,
+    BlitKernel::Batch* batch) {
+  size_t row_pitch, slice_pitch;
+  if ((batch == NULL || !batch->async_) &&
+      HostCopyLayout(src_image, image_region, row_pitch, slice_pitch) &&
+      IsHostCopyable(dst_memory)) {
+    const size_t element_size =
+        GetImageProperty(src_image.component, src_image.desc.format, src_image.desc.geometry)
+            .element_size;
+    const hsa_dim3_t& offset = image_region.offset;
+    const hsa_dim3_t& range = image_region.range;
+    if (dst_row_pitch == 0) dst_row_pitch = range.x * element_size;
+    if (dst_slice_pitch == 0) dst_slice_pitch = dst_row_pitch * std::max<size_t>(range.y, 1);
+
+    const uint8_t* src = static_cast<const uint8_t*>(src_image.data) +
+        offset.x * element_size + offset.y * row_pitch + offset.z * slice_pitch;
+    HostCopyRegion(static_cast<uint8_t*>(dst_memory), dst_row_pitch, dst_slice_pitch, src,
+                   row_pitch, slice_pitch, range, element_size);
+    return HSA_STATUS_SUCCESS;
+  }
+
+  if (batch == NULL && src_image.desc.geometry != HSA_EXT_IMAGE_GEOMETRY_1DB &&
+      LinearLayout(src_image, row_pitch, slice_pitch)) {
+    const size_t element_size =
+        GetImageProperty(src_image.component, src_image.desc.format, src_image.desc.geometry)
+            .element_size;
+    const hsa_dim3_t& range = image_region.range;
+    const size_t dst_row = dst_row_pitch ? dst_row_pitch : range.x * element_size;
+    const size_t dst_slice =
+        dst_slice_pitch ? dst_slice_pitch : dst_row * std::max<size_t>(range.y, 1);
+
+    const hsa_pitched_ptr_t dst = {dst_memory, dst_row, dst_slice};
+    const hsa_pitched_ptr_t src = {src_image.data, row_pitch, slice_pitch};
+    const hsa_dim3_t dst_offset = {0, 0, 0};
+    if (SdmaCopyRect(dst, dst_offset, src, image_region.offset, range, element_size,
+                     hsaDeviceToHost)) {
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
   if (BlitQueueInit().queue_ == NULL) {
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
 
   return ImageRuntime::instance()->blit_kernel().CopyImageToBuffer(
       blit_queue_, blit_code_catalog_, src_image, dst_memory, dst_row_pitch, dst_slice_pitch,
-      image_region);
+      image_region, batch);
 }
 
 hsa_status_t ImageManagerKv::CopyImage(const Image& dst_image,
@@ -592,6 +989,31 @@ hsa_status_t ImageManagerKv::CopyImage(const Image& dst_image,
                                        const hsa_dim3_t& dst_origin,
                                        const hsa_dim3_t& src_origin,
                                        const hsa_dim3_t size) {
+  return CopyImage(dst_image, src_image, dst_origin, src_origin, size, NULL);
+}
+
+hsa_status_t ImageManagerKv::CopyImage(const Image& dst_image, const Image& src_image,
+                                       const hsa_dim3_t& dst_origin,
+                                       const hsa_dim3_t& src_origin, const hsa_dim3_t size,
+                                       BlitKernel::Batch* batch) {
+  // Raw copies between linear images of the same format leave the shaders alone.
+  size_t dst_row_pitch, dst_slice_pitch, src_row_pitch, src_slice_pitch;
+  if (batch == NULL && src_image.desc.format.channel_order == dst_image.desc.format.channel_order &&
+      src_image.desc.format.channel_type == dst_image.desc.format.channel_type &&
+      src_image.desc.geometry != HSA_EXT_IMAGE_GEOMETRY_1DB &&
+      dst_image.desc.geometry != HSA_EXT_IMAGE_GEOMETRY_1DB &&
+      LinearLayout(dst_image, dst_row_pitch, dst_slice_pitch) &&
+      LinearLayout(src_image, src_row_pitch, src_slice_pitch)) {
+    const size_t element_size =
+        GetImageProperty(src_image.component, src_image.desc.format, src_image.desc.geometry)
+            .element_size;
+    const hsa_pitched_ptr_t dst = {dst_image.data, dst_row_pitch, dst_slice_pitch};
+    const hsa_pitched_ptr_t src = {src_image.data, src_row_pitch, src_slice_pitch};
+    if (SdmaCopyRect(dst, dst_origin, src, src_origin, size, element_size, hsaDeviceToDevice)) {
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
   if (BlitQueueInit().queue_ == NULL) {
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
@@ -609,7 +1031,7 @@ hsa_status_t ImageManagerKv::CopyImage(const Image& dst_image,
   if ((src_order == dst_order) && (src_type == dst_type)) {
     return ImageRuntime::instance()->blit_kernel().CopyImage(blit_queue_, blit_code_catalog_,
                                                              dst_image, src_image, dst_origin,
-                                                             src_origin, size, copy_type);
+                                                             src_origin, size, copy_type, batch);
   }
 
   // Source and destination format must be the same, except for
@@ -636,7 +1058,7 @@ hsa_status_t ImageManagerKv::CopyImage(const Image& dst_image,
 
       hsa_status_t status = ImageRuntime::instance()->blit_kernel().CopyImage(
           blit_queue_, blit_code_catalog_, dst_image, src_image, dst_origin, src_origin, size,
-          copy_type);
+          copy_type, batch);
 
       // Revert to the original format after the copy operation is finished.
       word1->bits.num_format = num_format_original;
@@ -650,6 +1072,12 @@ hsa_status_t ImageManagerKv::CopyImage(const Image& dst_image,
 
 hsa_status_t ImageManagerKv::FillImage(const Image& image, const void* pattern,
                                        const hsa_ext_image_region_t& region) {
+  return FillImage(image, pattern, region, NULL);
+}
+
+hsa_status_t ImageManagerKv::FillImage(const Image& image, const void* pattern,
+                                       const hsa_ext_image_region_t& region,
+                                       BlitKernel::Batch* batch) {
   if (BlitQueueInit().queue_ == NULL) {
     return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
   }
@@ -700,7 +1128,7 @@ hsa_status_t ImageManagerKv::FillImage(const Image& image, const void* pattern,
   }
 
   hsa_status_t status = ImageRuntime::instance()->blit_kernel().FillImage(
-      blit_queue_, blit_code_catalog_, *image_view, new_pattern, region);
+      blit_queue_, blit_code_catalog_, *image_view, new_pattern, region, batch);
 
   // Revert back original configuration.
   if (word3_buff != NULL) {
@@ -817,12 +1245,97 @@ ADDR_E_RETURNCODE ADDR_API
   return ADDR_OK;
 }
 
+hsa_status_t ImageManagerKv::RecordBlits(uint32_t count, const hsa_amd_image_blit_t* blits,
+                                         BlitKernel::Batch& batch) {
+  for (uint32_t i = 0; i < count; ++i) {
+    const hsa_amd_image_blit_t& blit = blits[i];
+    const Image& image = *Image::Convert(blit.image.handle);
+
+    hsa_status_t status = HSA_STATUS_ERROR_INVALID_ARGUMENT;
+    switch (blit.op) {
+      case HSA_AMD_IMAGE_BLIT_IMPORT:
+        status = CopyBufferToImage(blit.memory, blit.row_pitch, blit.slice_pitch, image,
+                                   blit.region, &batch);
+        break;
+      case HSA_AMD_IMAGE_BLIT_EXPORT:
+        status = CopyImageToBuffer(image, blit.memory, blit.row_pitch, blit.slice_pitch,
+                                   blit.region, &batch);
+        break;
+      case HSA_AMD_IMAGE_BLIT_COPY:
+        status = CopyImage(image, *Image::Convert(blit.src_image.handle), blit.region.offset,
+                           blit.src_offset, blit.region.range, &batch);
+        break;
+      case HSA_AMD_IMAGE_BLIT_CLEAR:
+        status = FillImage(image, blit.data, blit.region, &batch);
+        break;
+    }
+    if (status != HSA_STATUS_SUCCESS) return status;
+  }
+
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t ImageManagerKv::BlitImages(uint32_t count, const hsa_amd_image_blit_t* blits) {
+  if (BlitQueueInit().queue_ == NULL) {
+    return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
+  BlitKernel::Batch batch;
+  hsa_status_t status = RecordBlits(count, blits, batch);
+
+  // Dispatches recorded before a failure are still submitted, they own the batch's resources.
+  hsa_status_t submit_status =
+      ImageRuntime::instance()->blit_kernel().SubmitBatch(blit_queue_, batch);
+  return (status != HSA_STATUS_SUCCESS) ? status : submit_status;
+}
+
+hsa_status_t ImageManagerKv::BlitImagesAsync(uint32_t count, const hsa_amd_image_blit_t* blits,
+                                             uint32_t num_dep_signals,
+                                             const hsa_signal_t* dep_signals,
+                                             hsa_signal_t completion_signal) {
+  if (BlitQueueInit().queue_ == NULL) {
+    return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
+
+  BlitKernel::Batch batch;
+  batch.async_ = true;
+  hsa_status_t status = RecordBlits(count, blits, batch);
+  if (status != HSA_STATUS_SUCCESS) {
+    // Nothing was submitted yet, so none of the operations takes place.
+    BlitKernel::ReleaseBatch(batch);
+    return status;
+  }
+
+  return ImageRuntime::instance()->blit_kernel().SubmitBatchAsync(
+      blit_queue_, batch, num_dep_signals, dep_signals, completion_signal);
+}
+
 bool ImageManagerKv::GetAddrlibSurfaceInfo(
     hsa_agent_t component, const hsa_ext_image_descriptor_t& desc,
     Image::TileMode tileMode,
     size_t image_data_row_pitch,
     size_t image_data_slice_pitch,
     ADDR_COMPUTE_SURFACE_INFO_OUTPUT& out) const {
+  SurfaceInfoKey key(component, desc, tileMode, image_data_row_pitch, image_data_slice_pitch);
+  SurfaceInfoCache<ADDR_COMPUTE_SURFACE_INFO_OUTPUT>& cache =
+      SurfaceInfoCache<ADDR_COMPUTE_SURFACE_INFO_OUTPUT>::Instance();
+  uint32_t cached = 0;
+  if (cache.Find(key, out, cached)) return true;
+
+  if (!ComputeAddrlibSurfaceInfo(component, desc, tileMode, image_data_row_pitch,
+                                 image_data_slice_pitch, out)) {
+    return false;
+  }
+  cache.Insert(key, out, 1);
+  return true;
+}
+
+bool ImageManagerKv::ComputeAddrlibSurfaceInfo(
+    hsa_agent_t component, const hsa_ext_image_descriptor_t& desc,
+    Image::TileMode tileMode,
+    size_t image_data_row_pitch,
+    size_t image_data_slice_pitch,
+    ADDR_COMPUTE_SURFACE_INFO_OUTPUT& out) const {
   const ImageProperty image_prop =
       GetImageProperty(component, desc.format, desc.geometry);
 
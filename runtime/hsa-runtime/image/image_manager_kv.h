@@ -43,6 +43,11 @@
 #ifndef HSA_RUNTIME_EXT_IMAGE_IMAGE_MANAGER_KV_H
 #define HSA_RUNTIME_EXT_IMAGE_IMAGE_MANAGER_KV_H
 
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
 #include "addrlib/inc/addrinterface.h"
 #include "blit_kernel.h"
 #include "image_lut_kv.h"
@@ -51,6 +56,103 @@
 namespace rocr {
 namespace image {
 
+/// @brief Everything the addrlib surface info of an image depends on.
+struct SurfaceInfoKey {
+  uint64_t agent;
+  uint32_t channel_order;
+  uint32_t channel_type;
+  uint32_t geometry;
+  uint32_t tile_mode;
+  uint64_t width;
+  uint64_t height;
+  uint64_t depth;
+  uint64_t array_size;
+  uint64_t row_pitch;
+  uint64_t slice_pitch;
+
+  SurfaceInfoKey(hsa_agent_t component, const hsa_ext_image_descriptor_t& desc,
+                 Image::TileMode tileMode, size_t image_data_row_pitch,
+                 size_t image_data_slice_pitch)
+      : agent(component.handle),
+        channel_order(desc.format.channel_order),
+        channel_type(desc.format.channel_type),
+        geometry(desc.geometry),
+        tile_mode(tileMode),
+        width(desc.width),
+        height(desc.height),
+        depth(desc.depth),
+        array_size(desc.array_size),
+        row_pitch(image_data_row_pitch),
+        slice_pitch(image_data_slice_pitch) {}
+
+  bool operator==(const SurfaceInfoKey& other) const {
+    return memcmp(this, &other, sizeof(*this)) == 0;
+  }
+
+  struct Hash {
+    size_t operator()(const SurfaceInfoKey& key) const {
+      // FNV-1a over the key, which has no padding.
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&key);
+      uint64_t hash = 0xcbf29ce484222325ull;
+      for (size_t i = 0; i < sizeof(key); ++i) hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+      return size_t(hash);
+    }
+  };
+};
+
+/// @brief Process wide, least recently used bounded cache of addrlib surface
+/// info of type @p Output, shared by the image managers of all agents.
+/// Swizzle mode selection makes computing it expensive, while applications
+/// tend to create images of the same few descriptors over and over.
+template <typename Output> class SurfaceInfoCache {
+ public:
+  static SurfaceInfoCache& Instance() {
+    static SurfaceInfoCache* cache = new SurfaceInfoCache();
+    return *cache;
+  }
+
+  /// @brief Copies the surface info and result computed for @p key into
+  /// @p out and @p result, returns false if not cached.
+  bool Find(const SurfaceInfoKey& key, Output& out, uint32_t& result) {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = index_.find(key);
+    if (it == index_.end()) return false;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    out = it->second->out;
+    result = it->second->result;
+    return true;
+  }
+
+  void Insert(const SurfaceInfoKey& key, const Output& out, uint32_t result) {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (index_.find(key) != index_.end()) return;
+    if (entries_.size() == kCapacity) {
+      index_.erase(entries_.back().key);
+      entries_.pop_back();
+    }
+    entries_.push_front(Entry{key, out, result});
+    index_.emplace(key, entries_.begin());
+  }
+
+ private:
+  static const size_t kCapacity = 256;
+
+  struct Entry {
+    SurfaceInfoKey key;
+    Output out;
+    uint32_t result;
+  };
+
+  SurfaceInfoCache() {}
+
+  std::mutex lock_;
+  std::list<Entry> entries_;
+  std::unordered_map<SurfaceInfoKey, typename std::list<Entry>::iterator, SurfaceInfoKey::Hash>
+      index_;
+
+  DISALLOW_COPY_AND_ASSIGN(SurfaceInfoCache);
+};
+
 class ImageManagerKv : public ImageManager {
  public:
   explicit ImageManagerKv();
@@ -116,7 +218,40 @@ class ImageManagerKv : public ImageManager {
   virtual hsa_status_t FillImage(const Image& image, const void* pattern,
                                  const hsa_ext_image_region_t& region);
 
+  /// @brief Perform image transfers and fills with a single submission to the blit queue.
+  virtual hsa_status_t BlitImages(uint32_t count, const hsa_amd_image_blit_t* blits);
+
+  /// @brief Queue image transfers and fills behind dependency signals without waiting.
+  virtual hsa_status_t BlitImagesAsync(uint32_t count, const hsa_amd_image_blit_t* blits,
+                                       uint32_t num_dep_signals,
+                                       const hsa_signal_t* dep_signals,
+                                       hsa_signal_t completion_signal);
+
  protected:
+  /// @brief Records the dispatches of @p blits in @p batch.
+  hsa_status_t RecordBlits(uint32_t count, const hsa_amd_image_blit_t* blits,
+                           BlitKernel::Batch& batch);
+
+  // Variants of the transfers and fill recording their dispatches in @p batch when it is not
+  // NULL, instead of waiting for them.
+  hsa_status_t CopyBufferToImage(const void* src_memory, size_t src_row_pitch,
+                                 size_t src_slice_pitch, const Image& dst_image,
+                                 const hsa_ext_image_region_t& image_region,
+                                 BlitKernel::Batch* batch);
+
+  hsa_status_t CopyImageToBuffer(const Image& src_image, void* dst_memory,
+                                 size_t dst_row_pitch, size_t dst_slice_pitch,
+                                 const hsa_ext_image_region_t& image_region,
+                                 BlitKernel::Batch* batch);
+
+  hsa_status_t CopyImage(const Image& dst_image, const Image& src_image,
+                         const hsa_dim3_t& dst_origin, const hsa_dim3_t& src_origin,
+                         const hsa_dim3_t size, BlitKernel::Batch* batch);
+
+  virtual hsa_status_t FillImage(const Image& image, const void* pattern,
+                                 const hsa_ext_image_region_t& region,
+                                 BlitKernel::Batch* batch);
+
   static hsa_status_t GetLocalMemoryRegion(hsa_region_t region, void* data);
 
   static AddrFormat GetAddrlibFormat(const ImageProperty& image_prop);
@@ -133,12 +268,54 @@ class ImageManagerKv : public ImageManager {
                              size_t image_data_slice_pitch,
                              ADDR_COMPUTE_SURFACE_INFO_OUTPUT& out) const;
 
+  bool ComputeAddrlibSurfaceInfo(hsa_agent_t component,
+                                 const hsa_ext_image_descriptor_t& desc,
+                                 Image::TileMode tileMode,
+                                 size_t image_data_row_pitch,
+                                 size_t image_data_slice_pitch,
+                                 ADDR_COMPUTE_SURFACE_INFO_OUTPUT& out) const;
+
   size_t CalWorkingSizeBytes(hsa_ext_image_geometry_t geometry,
                              hsa_dim3_t size_pixel,
                              uint32_t element_size) const;
 
   virtual bool IsLocalMemory(const void* address) const;
 
+  /// @brief Returns true if the CPU may read and write @p address coherently with the agent.
+  bool IsHostCopyable(const void* address) const;
+
+  /// @brief Returns true if @p image is linear with a layout fully described by its pitches,
+  /// filling in its byte pitches.
+  bool LinearLayout(const Image& image, size_t& row_pitch, size_t& slice_pitch) const;
+
+  /// @brief Returns true if @p region of @p image is small enough to be transferred by the CPU
+  /// and the image layout allows it, filling in the image's byte pitches.
+  bool HostCopyLayout(const Image& image, const hsa_ext_image_region_t& region,
+                      size_t& row_pitch, size_t& slice_pitch) const;
+
+  /// @brief Copies @p range elements of @p element_size bytes between two linear layouts with
+  /// an SDMA engine and waits for it. Returns false if SDMA can not take the copy, which the
+  /// caller then does with the blit kernels.
+  bool SdmaCopyRect(const hsa_pitched_ptr_t& dst, const hsa_dim3_t& dst_offset,
+                    const hsa_pitched_ptr_t& src, const hsa_dim3_t& src_offset,
+                    const hsa_dim3_t& range, size_t element_size,
+                    hsa_amd_copy_direction_t dir) const;
+
+  /// @brief Computes the DCC metadata layout of a tiled 2D image when compression is enabled.
+  /// Returns false if the image stays uncompressed.
+  bool ComputeAddrlibDccInfo(const hsa_ext_image_descriptor_t& desc, Image::TileMode tile_mode,
+                             uint32_t swizzle_mode, const ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& surf,
+                             ADDR2_COMPUTE_DCCINFO_OUTPUT& dcc) const;
+
+  /// @brief Marks every block of the DCC metadata at @p meta uncompressed.
+  static hsa_status_t ClearDccMetadata(void* meta, size_t size);
+
+  /// @brief Fills @p out with the single level SW_LINEAR layout addrlib computes on gfx10 and
+  /// gfx11, without calling into addrlib. Returns false for layouts addrlib would reject or
+  /// that need its full setup, which the caller then sends to addrlib.
+  static bool LinearSurfaceInfo(const hsa_ext_image_descriptor_t& desc, uint32_t element_size,
+                                uint32_t pitch_in_element, ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out);
+
   BlitQueue& BlitQueueInit();
 
   virtual const ImageLutKv& ImageLut() const { return image_lut_; };
@@ -151,6 +328,8 @@ class ImageManagerKv : public ImageManager {
 
   uint32_t chip_id_;
 
+  bool is_apu_;
+
   BlitQueue blit_queue_;
 
   std::vector<BlitCodeInfo> blit_code_catalog_;
@@ -76,10 +76,14 @@ class ImageManagerNv : public ImageManagerKv {
   /// @brief Fill sampler structure with device specific sampler object.
   virtual hsa_status_t PopulateSamplerSrd(Sampler& sampler) const;
 
+  using ImageManagerKv::FillImage;
+
+ protected:
   /// @brief Fill image backing storage using agent copy.
   virtual hsa_status_t FillImage(const Image& image, const void* pattern,
-                                 const hsa_ext_image_region_t& region);
- protected:
+                                 const hsa_ext_image_region_t& region,
+                                 BlitKernel::Batch* batch);
+
   uint32_t GetAddrlibSurfaceInfoNv(hsa_agent_t component,
                              const hsa_ext_image_descriptor_t& desc,
                              Image::TileMode tileMode,
@@ -87,6 +91,13 @@ class ImageManagerNv : public ImageManagerKv {
                              size_t image_data_slice_pitch,
                              ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out) const;
 
+  uint32_t ComputeAddrlibSurfaceInfoNv(hsa_agent_t component,
+                                       const hsa_ext_image_descriptor_t& desc,
+                                       Image::TileMode tileMode,
+                                       size_t image_data_row_pitch,
+                                       size_t image_data_slice_pitch,
+                                       ADDR2_COMPUTE_SURFACE_INFO_OUTPUT& out) const;
+
   bool IsLocalMemory(const void* address) const;
 
  private:
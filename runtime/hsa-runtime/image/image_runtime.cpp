@@ -383,6 +383,9 @@ hsa_status_t ImageRuntime::CreateImageHandle(
   }
 
   Image* image = Image::Create(component);
+  if (image == NULL) {
+    return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
   image->component = component;
   image->desc = image_descriptor;
   image->permission = access_permission;
@@ -432,6 +435,9 @@ hsa_status_t ImageRuntime::CreateImageHandleWithLayout(
   const metadata_amd_t* desc = reinterpret_cast<const metadata_amd_t*>(image_layout);
 
   Image* image = Image::Create(component);
+  if (image == NULL) {
+    return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
   image->component = component;
   image->desc = image_descriptor;
   image->permission = access_permission;
@@ -449,6 +455,36 @@ hsa_status_t ImageRuntime::CreateImageHandleWithLayout(
   return HSA_STATUS_SUCCESS;
 }
 
+hsa_status_t ImageRuntime::CreateImageHandles(
+    hsa_agent_t component, uint32_t count,
+    const hsa_ext_image_descriptor_t* image_descriptors, const void* const* image_data,
+    const hsa_access_permission_t access_permission, hsa_ext_image_t* images) {
+  ImageManager* manager = image_manager(component);
+  if (manager == NULL) {
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+
+  // Grow the object pool once for the whole list.
+  hsa_status_t status = manager->image_pool().Reserve(component, count);
+  if (status != HSA_STATUS_SUCCESS) {
+    return status;
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+    status = CreateImageHandle(component, image_descriptors[i], image_data[i], access_permission,
+                               HSA_EXT_IMAGE_DATA_LAYOUT_OPAQUE, 0, 0, images[i]);
+    if (status != HSA_STATUS_SUCCESS) {
+      while (i-- > 0) {
+        DestroyImageHandle(images[i]);
+        images[i].handle = 0;
+      }
+      return status;
+    }
+  }
+
+  return HSA_STATUS_SUCCESS;
+}
+
 hsa_status_t ImageRuntime::DestroyImageHandle(
     const hsa_ext_image_t& image_handle) {
   const Image* image = Image::Convert(image_handle.handle);
@@ -531,6 +567,47 @@ hsa_status_t ImageRuntime::FillImage(
   return manager->FillImage(*image, pattern, image_region);
 }
 
+/// @brief Returns the agent owning all images of @p blits, or a null handle if they are not
+/// owned by a single agent.
+static hsa_agent_t BlitsComponent(uint32_t count, const hsa_amd_image_blit_t* blits) {
+  const hsa_agent_t component = Image::Convert(blits[0].image.handle)->component;
+  const hsa_agent_t none = {0};
+
+  for (uint32_t i = 0; i < count; ++i) {
+    if (Image::Convert(blits[i].image.handle)->component.handle != component.handle) {
+      return none;
+    }
+    if (blits[i].op == HSA_AMD_IMAGE_BLIT_COPY &&
+        Image::Convert(blits[i].src_image.handle)->component.handle != component.handle) {
+      return none;
+    }
+  }
+
+  return component;
+}
+
+hsa_status_t ImageRuntime::BlitImages(uint32_t count, const hsa_amd_image_blit_t* blits) {
+  const hsa_agent_t component = BlitsComponent(count, blits);
+  if (component.handle == 0) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  return image_manager(component)->BlitImages(count, blits);
+}
+
+hsa_status_t ImageRuntime::BlitImagesAsync(hsa_agent_t agent, uint32_t count,
+                                           const hsa_amd_image_blit_t* blits,
+                                           uint32_t num_dep_signals,
+                                           const hsa_signal_t* dep_signals,
+                                           hsa_signal_t completion_signal) {
+  // An empty list still orders the completion signal behind the dependencies on the agent.
+  const hsa_agent_t component = (count == 0) ? agent : BlitsComponent(count, blits);
+  if (component.handle == 0 || image_manager(component) == NULL) {
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+
+  return image_manager(component)->BlitImagesAsync(count, blits, num_dep_signals, dep_signals,
+                                                   completion_signal);
+}
+
 hsa_status_t ImageRuntime::CreateSamplerHandle(
     hsa_agent_t component,
     const hsa_ext_sampler_descriptor_v2_t& sampler_descriptor,
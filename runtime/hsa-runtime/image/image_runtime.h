@@ -103,6 +103,14 @@ class ImageRuntime {
       const void* image_data, const hsa_access_permission_t access_permission,
       hsa_ext_image_t& image);
 
+  /// @brief Create @p count opaque device image objects in one go. Either all handles are
+  /// created or none.
+  hsa_status_t CreateImageHandles(hsa_agent_t component, uint32_t count,
+                                  const hsa_ext_image_descriptor_t* image_descriptors,
+                                  const void* const* image_data,
+                                  const hsa_access_permission_t access_permission,
+                                  hsa_ext_image_t* images);
+
   /// @brief Destroy the device image object referenced by the handle.
   hsa_status_t DestroyImageHandle(const hsa_ext_image_t& image);
 
@@ -128,6 +136,15 @@ class ImageRuntime {
   hsa_status_t FillImage(const hsa_ext_image_t& image, const void* pattern,
                          const hsa_ext_image_region_t& image_region);
 
+  /// @brief Perform a list of unordered image transfers and fills.
+  hsa_status_t BlitImages(uint32_t count, const hsa_amd_image_blit_t* blits);
+
+  /// @brief Queue a list of unordered image transfers and fills behind dependency signals.
+  hsa_status_t BlitImagesAsync(hsa_agent_t agent, uint32_t count,
+                               const hsa_amd_image_blit_t* blits,
+                               uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                               hsa_signal_t completion_signal);
+
   /// @brief Create device sampler object and return its handle.
   hsa_status_t CreateSamplerHandle(
       hsa_agent_t component,
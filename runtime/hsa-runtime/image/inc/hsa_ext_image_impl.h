@@ -90,6 +90,46 @@ hsa_status_t hsa_ext_image_export(hsa_agent_t agent, hsa_ext_image_t src_image,
 hsa_status_t hsa_ext_image_clear(hsa_agent_t agent, hsa_ext_image_t image, const void* data,
                                  const hsa_ext_image_region_t* image_region);
 
+hsa_status_t hsa_amd_image_blit(hsa_agent_t agent, uint32_t num_blits,
+                                const hsa_amd_image_blit_t* blits);
+
+hsa_status_t hsa_amd_image_blit_async(hsa_agent_t agent, uint32_t num_blits,
+                                      const hsa_amd_image_blit_t* blits,
+                                      uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                      hsa_signal_t completion_signal);
+
+hsa_status_t hsa_amd_image_import_async(hsa_agent_t agent, const void* src_memory,
+                                        size_t src_row_pitch, size_t src_slice_pitch,
+                                        hsa_ext_image_t dst_image,
+                                        const hsa_ext_image_region_t* image_region,
+                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                        hsa_signal_t completion_signal);
+
+hsa_status_t hsa_amd_image_export_async(hsa_agent_t agent, hsa_ext_image_t src_image,
+                                        void* dst_memory, size_t dst_row_pitch,
+                                        size_t dst_slice_pitch,
+                                        const hsa_ext_image_region_t* image_region,
+                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                        hsa_signal_t completion_signal);
+
+hsa_status_t hsa_amd_image_copy_async(hsa_agent_t agent, hsa_ext_image_t src_image,
+                                      const hsa_dim3_t* src_offset, hsa_ext_image_t dst_image,
+                                      const hsa_dim3_t* dst_offset, const hsa_dim3_t* range,
+                                      uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                      hsa_signal_t completion_signal);
+
+hsa_status_t hsa_amd_image_clear_async(hsa_agent_t agent, hsa_ext_image_t image,
+                                       const void* data,
+                                       const hsa_ext_image_region_t* image_region,
+                                       uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                       hsa_signal_t completion_signal);
+
+hsa_status_t hsa_amd_image_create_batch(hsa_agent_t agent, uint32_t num_images,
+                                        const hsa_ext_image_descriptor_t* image_descriptors,
+                                        const void* const* image_data,
+                                        hsa_access_permission_t access_permission,
+                                        hsa_ext_image_t* images);
+
 hsa_status_t hsa_ext_sampler_create(hsa_agent_t agent,
                                     const hsa_ext_sampler_descriptor_t* sampler_descriptor,
                                     hsa_ext_sampler_t* sampler);
@@ -533,6 +533,12 @@ typedef enum {
    * implementation. The type of this attribute is uint16_t.
    */
   HSA_AMD_SYSTEM_INFO_EXT_VERSION_MINOR = 0x208,
+  /**
+   * Start and end timestamps of the phases of the last hsa_init that loaded
+   * the runtime.  The type of this attribute is hsa_amd_init_phase_times_t,
+   * defined in hsa_ext_amd.h.
+   */
+  HSA_AMD_SYSTEM_INFO_INIT_PHASE_TIMES = 0x209,
 } hsa_system_info_t;
 
 /**
@@ -118,6 +118,13 @@ typedef void (*hsa_amd_queue_intercept_handler)(const void* pkts, uint64_t pkt_c
 hsa_status_t hsa_amd_queue_intercept_register(hsa_queue_t* queue,
                                               hsa_amd_queue_intercept_handler callback,
                                               void* user_data);
+// Registers a handler that accepts batches of packets. The handler may be called with any number
+// of consecutive packets, user_pkt_index being the index of the first. Packets it writes are
+// forwarded in order: batch handlers below it receive each write whole, other handlers one packet
+// at a time.
+hsa_status_t hsa_amd_queue_intercept_register_batch(hsa_queue_t* queue,
+                                                    hsa_amd_queue_intercept_handler callback,
+                                                    void* user_data);
 hsa_status_t hsa_amd_queue_intercept_create(
     hsa_agent_t agent_handle, uint32_t size, hsa_queue_type32_t type,
     void (*callback)(hsa_status_t status, hsa_queue_t* source, void* data), void* data,
@@ -190,6 +197,8 @@ struct PcSamplingExtTable {
   decltype(hsa_ven_amd_pcs_start)* hsa_ven_amd_pcs_start_fn;
   decltype(hsa_ven_amd_pcs_stop)* hsa_ven_amd_pcs_stop_fn;
   decltype(hsa_ven_amd_pcs_flush)* hsa_ven_amd_pcs_flush_fn;
+  decltype(hsa_ven_amd_pcs_data_view)* hsa_ven_amd_pcs_data_view_fn;
+  decltype(hsa_ven_amd_pcs_aggregate)* hsa_ven_amd_pcs_aggregate_fn;
 };
 
 
@@ -268,6 +277,85 @@ struct AmdExtTable {
   decltype(hsa_amd_queue_get_info)* hsa_amd_queue_get_info_fn;
   decltype(hsa_amd_vmem_address_reserve_align)* hsa_amd_vmem_address_reserve_align_fn;
   decltype(hsa_amd_enable_logging)* hsa_amd_enable_logging_fn;
+  decltype(hsa_amd_signal_wait_policy)* hsa_amd_signal_wait_policy_fn;
+  decltype(hsa_amd_signal_wait_set_create)* hsa_amd_signal_wait_set_create_fn;
+  decltype(hsa_amd_signal_wait_set_destroy)* hsa_amd_signal_wait_set_destroy_fn;
+  decltype(hsa_amd_signal_wait_set_add)* hsa_amd_signal_wait_set_add_fn;
+  decltype(hsa_amd_signal_wait_set_remove)* hsa_amd_signal_wait_set_remove_fn;
+  decltype(hsa_amd_signal_wait_set_wait)* hsa_amd_signal_wait_set_wait_fn;
+  decltype(hsa_amd_signal_async_handler_with_flags)* hsa_amd_signal_async_handler_with_flags_fn;
+  decltype(hsa_amd_memory_async_copy_batch)* hsa_amd_memory_async_copy_batch_fn;
+  decltype(hsa_amd_memory_lock_cache_invalidate)* hsa_amd_memory_lock_cache_invalidate_fn;
+  decltype(hsa_amd_queue_kernarg_alloc)* hsa_amd_queue_kernarg_alloc_fn;
+  decltype(hsa_amd_queue_intercept_register_batch)* hsa_amd_queue_intercept_register_batch_fn;
+  decltype(hsa_amd_queue_submit_batch)* hsa_amd_queue_submit_batch_fn;
+  decltype(hsa_amd_queue_create)* hsa_amd_queue_create_fn;
+  decltype(hsa_amd_memory_async_copy_on_engine_with_priority)* hsa_amd_memory_async_copy_on_engine_with_priority_fn;
+  decltype(hsa_amd_copy_list_create)* hsa_amd_copy_list_create_fn;
+  decltype(hsa_amd_copy_list_submit)* hsa_amd_copy_list_submit_fn;
+  decltype(hsa_amd_copy_list_destroy)* hsa_amd_copy_list_destroy_fn;
+  decltype(hsa_amd_agents_allow_access_batch)* hsa_amd_agents_allow_access_batch_fn;
+  decltype(hsa_amd_signal_get_eventfd)* hsa_amd_signal_get_eventfd_fn;
+  decltype(hsa_amd_executable_freeze_async)* hsa_amd_executable_freeze_async_fn;
+  decltype(hsa_amd_executables_destroy)* hsa_amd_executables_destroy_fn;
+  decltype(hsa_amd_queue_dispatch_timestamps_enable)* hsa_amd_queue_dispatch_timestamps_enable_fn;
+  decltype(hsa_amd_queue_dispatch_timestamp_signal)* hsa_amd_queue_dispatch_timestamp_signal_fn;
+  decltype(hsa_amd_queue_dispatch_timestamps_read)* hsa_amd_queue_dispatch_timestamps_read_fn;
+  decltype(hsa_amd_runtime_metrics_get)* hsa_amd_runtime_metrics_get_fn;
+  decltype(hsa_amd_svm_profile_get_ranges)* hsa_amd_svm_profile_get_ranges_fn;
+  decltype(hsa_amd_runtime_trace_flush)* hsa_amd_runtime_trace_flush_fn;
+  decltype(hsa_amd_spm_stream_start)* hsa_amd_spm_stream_start_fn;
+  decltype(hsa_amd_spm_stream_stop)* hsa_amd_spm_stream_stop_fn;
+  decltype(hsa_amd_profiling_get_clock_params)* hsa_amd_profiling_get_clock_params_fn;
+  decltype(hsa_amd_ipc_memory_attach_batch)* hsa_amd_ipc_memory_attach_batch_fn;
+  decltype(hsa_amd_vmem_map_batch)* hsa_amd_vmem_map_batch_fn;
+  decltype(hsa_amd_vmem_set_access_batch)* hsa_amd_vmem_set_access_batch_fn;
+  decltype(hsa_amd_svm_prefetch_batch_async)* hsa_amd_svm_prefetch_batch_async_fn;
+  decltype(hsa_amd_portable_export_dmabuf_bulk)* hsa_amd_portable_export_dmabuf_bulk_fn;
+  decltype(hsa_amd_memory_async_copy_strided)* hsa_amd_memory_async_copy_strided_fn;
+  decltype(hsa_amd_memory_fill_async)* hsa_amd_memory_fill_async_fn;
+  decltype(hsa_amd_copy_context_create)* hsa_amd_copy_context_create_fn;
+  decltype(hsa_amd_copy_context_submit)* hsa_amd_copy_context_submit_fn;
+  decltype(hsa_amd_copy_context_destroy)* hsa_amd_copy_context_destroy_fn;
+  decltype(hsa_amd_memory_async_copy_stream)* hsa_amd_memory_async_copy_stream_fn;
+  decltype(hsa_amd_aie_buffer_host_access)* hsa_amd_aie_buffer_host_access_fn;
+  decltype(hsa_amd_cu_partitions_create)* hsa_amd_cu_partitions_create_fn;
+  decltype(hsa_amd_cu_partitions_bind_queue)* hsa_amd_cu_partitions_bind_queue_fn;
+  decltype(hsa_amd_cu_partitions_rebalance)* hsa_amd_cu_partitions_rebalance_fn;
+  decltype(hsa_amd_cu_partitions_destroy)* hsa_amd_cu_partitions_destroy_fn;
+  decltype(hsa_amd_queue_cu_set_dispatch_mask)* hsa_amd_queue_cu_set_dispatch_mask_fn;
+  decltype(hsa_amd_memory_pool_allocate_async)* hsa_amd_memory_pool_allocate_async_fn;
+  decltype(hsa_amd_memory_pool_free_async)* hsa_amd_memory_pool_free_async_fn;
+  decltype(hsa_amd_register_memory_pressure_callback)* hsa_amd_register_memory_pressure_callback_fn;
+  decltype(hsa_amd_deregister_memory_pressure_callback)* hsa_amd_deregister_memory_pressure_callback_fn;
+  decltype(hsa_amd_memory_pool_allocate_interleaved)* hsa_amd_memory_pool_allocate_interleaved_fn;
+  decltype(hsa_amd_memory_pool_free_interleaved)* hsa_amd_memory_pool_free_interleaved_fn;
+  decltype(hsa_amd_memory_pool_allocate_batch)* hsa_amd_memory_pool_allocate_batch_fn;
+  decltype(hsa_amd_memory_pool_reserve)* hsa_amd_memory_pool_reserve_fn;
+  decltype(hsa_amd_memory_pool_release_reservation)* hsa_amd_memory_pool_release_reservation_fn;
+  decltype(hsa_amd_dispatch_graph_create)* hsa_amd_dispatch_graph_create_fn;
+  decltype(hsa_amd_dispatch_graph_launch)* hsa_amd_dispatch_graph_launch_fn;
+  decltype(hsa_amd_dispatch_graph_destroy)* hsa_amd_dispatch_graph_destroy_fn;
+  decltype(hsa_amd_queue_suspend)* hsa_amd_queue_suspend_fn;
+  decltype(hsa_amd_queue_resume)* hsa_amd_queue_resume_fn;
+  decltype(hsa_amd_profiling_set_dispatch_filter)* hsa_amd_profiling_set_dispatch_filter_fn;
+  decltype(hsa_amd_system_get_properties)* hsa_amd_system_get_properties_fn;
+  decltype(hsa_amd_gpu_fault_records_get)* hsa_amd_gpu_fault_records_get_fn;
+  decltype(hsa_amd_completion_queue_create)* hsa_amd_completion_queue_create_fn;
+  decltype(hsa_amd_completion_queue_destroy)* hsa_amd_completion_queue_destroy_fn;
+  decltype(hsa_amd_completion_queue_signal_create)* hsa_amd_completion_queue_signal_create_fn;
+  decltype(hsa_amd_completion_queue_dequeue)* hsa_amd_completion_queue_dequeue_fn;
+  decltype(hsa_amd_topology_get)* hsa_amd_topology_get_fn;
+  decltype(hsa_amd_runtime_thread_policy_set)* hsa_amd_runtime_thread_policy_set_fn;
+  decltype(hsa_amd_memory_async_copy_gang)* hsa_amd_memory_async_copy_gang_fn;
+  decltype(hsa_amd_memory_copy_engine_hints)* hsa_amd_memory_copy_engine_hints_fn;
+  decltype(hsa_amd_memory_set_device_only)* hsa_amd_memory_set_device_only_fn;
+  decltype(hsa_amd_progress_counter_create)* hsa_amd_progress_counter_create_fn;
+  decltype(hsa_amd_progress_counter_destroy)* hsa_amd_progress_counter_destroy_fn;
+  decltype(hsa_amd_progress_counter_wait)* hsa_amd_progress_counter_wait_fn;
+  decltype(hsa_amd_memory_migrate_async)* hsa_amd_memory_migrate_async_fn;
+  decltype(hsa_amd_interop_cache_invalidate)* hsa_amd_interop_cache_invalidate_fn;
+  decltype(hsa_amd_profiling_get_agent_tick)* hsa_amd_profiling_get_agent_tick_fn;
 };
 
 // Table to export HSA Core Runtime Apis
@@ -57,9 +57,81 @@
  * - 1.4 - Virtual Memory API
  * - 1.5 - hsa_amd_agent_info: HSA_AMD_AGENT_INFO_MEMORY_PROPERTIES
  * - 1.6 - Virtual Memory API: hsa_amd_vmem_address_reserve_align
+ * - 1.7 - hsa_amd_signal_wait_policy
+ * - 1.8 - Signal wait sets: hsa_amd_signal_wait_set_*
+ * - 1.9 - hsa_amd_signal_async_handler_with_flags
+ * - 1.10 - hsa_amd_memory_async_copy_batch
+ * - 1.11 - hsa_amd_memory_lock_cache_invalidate
+ * - 1.12 - Slab allocator memory pool counters
+ * - 1.13 - hsa_amd_queue_kernarg_alloc
+ * - 1.14 - Scratch usage agent attributes and queue scratch demand histogram
+ * - 1.15 - hsa_amd_queue_intercept_register_batch
+ * - 1.16 - hsa_amd_queue_submit_batch
+ * - 1.17 - hsa_amd_queue_create
+ * - 1.18 - hsa_amd_memory_async_copy_on_engine_with_priority
+ * - 1.19 - hsa_amd_copy_list_create, hsa_amd_copy_list_submit and hsa_amd_copy_list_destroy
+ * - 1.20 - hsa_amd_agents_allow_access_batch
+ * - 1.21 - hsa_amd_signal_get_eventfd
+ * - 1.22 - HSA_AMD_MEMORY_POOL_HUGEPAGE_FLAG
+ * - 1.23 - HSA_AMD_QUEUE_CREATE_NUMA_HINT
+ * - 1.24 - hsa_amd_executable_freeze_async
+ * - 1.25 - hsa_amd_executables_destroy
+ * - 1.26 - hsa_amd_image_blit
+ * - 1.27 - hsa_amd_image_blit_async, hsa_amd_image_import_async, hsa_amd_image_export_async,
+ *          hsa_amd_image_copy_async, hsa_amd_image_clear_async
+ * - 1.28 - hsa_amd_image_create_batch
+ * - 1.29 - hsa_amd_queue_dispatch_timestamps_enable, hsa_amd_queue_dispatch_timestamp_signal,
+ *          hsa_amd_queue_dispatch_timestamps_read
+ * - 1.30 - hsa_amd_runtime_metrics_get
+ * - 1.31 - hsa_amd_svm_profile_get_ranges
+ * - 1.32 - hsa_amd_runtime_trace_flush
+ * - 1.33 - hsa_amd_spm_stream_start, hsa_amd_spm_stream_stop
+ * - 1.34 - hsa_amd_profiling_get_clock_params
+ * - 1.35 - Added hsa_amd_ipc_memory_attach_batch
+ * - 1.36 - Added hsa_amd_vmem_map_batch and hsa_amd_vmem_set_access_batch
+ * - 1.37 - Added hsa_amd_svm_prefetch_batch_async
+ * - 1.38 - Added hsa_amd_portable_export_dmabuf_bulk
+ * - 1.39 - Added hsa_amd_memory_async_copy_strided
+ * - 1.40 - Added hsa_amd_memory_fill_async
+ * - 1.41 - hsa_amd_copy_context_create, hsa_amd_copy_context_submit and hsa_amd_copy_context_destroy
+ * - 1.42 - Added hsa_amd_memory_async_copy_stream
+ * - 1.43 - Added hsa_amd_aie_buffer_host_access
+ * - 1.44 - hsa_amd_aie_ert_packet_t completion_signal and barrier-AND packets on AIE queues
+ * - 1.45 - Added hsa_amd_cu_partitions_create, hsa_amd_cu_partitions_bind_queue, hsa_amd_cu_partitions_rebalance and hsa_amd_cu_partitions_destroy
+ * - 1.46 - Added hsa_amd_queue_cu_set_dispatch_mask
+ * - 1.47 - Added HSA_AMD_AGENT_DISPATCH_HOST_CALL and hsa_amd_host_call_t for CPU agent queues
+ * - 1.48 - Added HSA_AMD_SYSTEM_INFO_INIT_PHASE_TIMES and HSA_AMD_AGENT_INFO_INIT_TIMES
+ * - 1.49 - Added hsa_amd_memory_pool_allocate_async and hsa_amd_memory_pool_free_async
+ * - 1.50 - Added hsa_amd_register_memory_pressure_callback and hsa_amd_deregister_memory_pressure_callback
+ * - 1.51 - Added HSA_AMD_MEMORY_POOL_INFO_USAGE and hsa_amd_memory_pool_usage_t
+ * - 1.52 - Added hsa_amd_memory_pool_allocate_interleaved and hsa_amd_memory_pool_free_interleaved
+ * - 1.53 - Added HSA_AMD_MEMORY_POOL_INFO_FRAGMENTATION and hsa_amd_memory_pool_fragmentation_t
+ * - 1.54 - Added HSA_AMD_MEMORY_POOL_LARGE_PAGE_FLAG
+ * - 1.55 - Added hsa_amd_memory_pool_allocate_batch and hsa_amd_memory_batch_flag_t
+ * - 1.56 - Added hsa_amd_memory_pool_reserve, hsa_amd_memory_pool_release_reservation and HSA_AMD_MEMORY_POOL_INFO_RESERVED_SIZE
+ * - 1.57 - Added hsa_amd_dispatch_graph_create, hsa_amd_dispatch_graph_launch and hsa_amd_dispatch_graph_destroy
+ * - 1.58 - Added hsa_amd_queue_suspend and hsa_amd_queue_resume
+ * - 1.59 - Added HSA_AMD_QUEUE_INFO_TELEMETRY, HSA_AMD_RUNTIME_HISTOGRAM_QUEUE_DEPTH and HSA_AMD_RUNTIME_HISTOGRAM_QUEUE_STALL_MS
+ * - 1.60 - Added hsa_amd_profiling_set_dispatch_filter
+ * - 1.61 - Added HSA_AMD_AGENT_INFO_QUEUE_RECOMMENDED_SIZE
+ * - 1.62 - Added hsa_amd_system_get_properties
+ * - 1.63 - Added hsa_amd_gpu_fault_records_get
+ * - 1.64 - Added completion queues, hsa_amd_completion_queue_*
+ * - 1.65 - Added hsa_amd_topology_get
+ * - 1.66 - Added HSA_AMD_RUNTIME_COUNTER_LOCK_ACQUIRES, HSA_AMD_RUNTIME_COUNTER_LOCK_CONTENDED and HSA_AMD_RUNTIME_HISTOGRAM_LOCK_WAIT_NS
+ * - 1.67 - Added hsa_amd_runtime_thread_policy_set
+ * - 1.68 - Added hsa_amd_memory_async_copy_gang
+ * - 1.69 - Added hsa_amd_memory_copy_engine_hints
+ * - 1.70 - Added hsa_amd_memory_set_device_only
+ * - 1.71 - Added HSA_AMD_MEMORY_POOL_COARSE_GRAIN_FLAG and HSA_AMD_MEMORY_POOL_UNCACHED_FLAG
+ * - 1.72 - Added progress counters, hsa_amd_progress_counter_*
+ * - 1.73 - Added HSA_AMD_AGENT_INFO_PARTITION_LAYOUT and hsa_amd_agent_partition_layout_t
+ * - 1.74 - Added hsa_amd_memory_migrate_async
+ * - 1.75 - Added hsa_amd_interop_cache_invalidate
+ * - 1.76 - Added hsa_amd_profiling_get_agent_tick and hsa_amd_clock_params_convert_system
  */
 #define HSA_AMD_INTERFACE_VERSION_MAJOR 1
-#define HSA_AMD_INTERFACE_VERSION_MINOR 6
+#define HSA_AMD_INTERFACE_VERSION_MINOR 76
 
 #ifdef __cplusplus
 extern "C" {
@@ -200,6 +272,22 @@ typedef struct hsa_amd_barrier_value_packet_s {
   hsa_signal_t completion_signal;
 } hsa_amd_barrier_value_packet_t;
 
+/**
+ * @brief Agent dispatch packet type run by queues created on CPU agents.
+ *
+ * @details arg[0] of the ::hsa_agent_dispatch_packet_t holds a
+ * ::hsa_amd_host_call_t, called with arg[1], arg[2], arg[3] and the packet's
+ * return_address on a thread bound to the CPU agent's cores. Packets without
+ * the barrier bit may run concurrently with each other.
+ */
+#define HSA_AMD_AGENT_DISPATCH_HOST_CALL 0x0001
+
+/**
+ * @brief Function run by an ::HSA_AMD_AGENT_DISPATCH_HOST_CALL packet.
+ */
+typedef void (*hsa_amd_host_call_t)(uint64_t arg1, uint64_t arg2, uint64_t arg3,
+                                    void* return_address);
+
 /**
  * State of an AIE ERT command.
  */
@@ -408,6 +496,11 @@ typedef struct hsa_amd_aie_ert_command_chain_data_s {
 
 /**
  * AMD AIE ERT packet. Used for sending a command to an AIE agent.
+ *
+ * AIE queues also accept ::hsa_barrier_and_packet_t packets, which hold back
+ * the packets behind them until every dependent signal reaches 0.  Together
+ * with the completion signal of ERT packets this lets GPU and AIE queues wait
+ * on each other without the application waking in between.
  */
 typedef struct hsa_amd_aie_ert_packet_s {
   /**
@@ -461,9 +554,10 @@ typedef struct hsa_amd_aie_ert_packet_s {
    */
   uint64_t reserved4;
   /**
-   * Reserved. Must be 0.
+   * Signal decremented once the command has completed, so GPU barrier packets
+   * can depend on it.  0 (no signal) when not required.
    */
-  uint64_t reserved5;
+  hsa_signal_t completion_signal;
   /**
    * Address of packet data payload. ERT commands contain arbitrarily sized
    * data payloads.
@@ -734,7 +828,43 @@ typedef enum hsa_amd_agent_info_s {
    * bit is set at that position. User may use the hsa_flag_isset64 macro to verify whether a flag
    * is set. The type of this attribute is uint8_t[8].
    */
-  HSA_AMD_AGENT_INFO_AQL_EXTENSIONS = 0xA115 /* Not implemented yet */
+  HSA_AMD_AGENT_INFO_AQL_EXTENSIONS = 0xA115, /* Not implemented yet */
+  /**
+   * Bytes of scratch memory held in reserve for this agent's queues. Reserved memory is counted
+   * by HSA_AMD_AGENT_INFO_SCRATCH_CACHED_SIZE while it is not bound to a queue.
+   * The type of this attribute is size_t.
+   */
+  HSA_AMD_AGENT_INFO_SCRATCH_RESERVED_SIZE = 0xA116,
+  /**
+   * Bytes of scratch memory currently bound to this agent's queues.
+   * The type of this attribute is size_t.
+   */
+  HSA_AMD_AGENT_INFO_SCRATCH_IN_USE_SIZE = 0xA117,
+  /**
+   * Bytes of mapped scratch memory cached for reuse and not bound to any queue.
+   * The type of this attribute is size_t.
+   */
+  HSA_AMD_AGENT_INFO_SCRATCH_CACHED_SIZE = 0xA118,
+  /**
+   * Timestamps of this agent's construction and of its post tools
+   * initialization (blit kernels, scratch and trap handler) during hsa_init.
+   * The type of this attribute is hsa_amd_agent_init_times_t.
+   */
+  HSA_AMD_AGENT_INFO_INIT_TIMES = 0xA119,
+  /**
+   * Suggested size in packets for queues created on this agent.  The suggestion
+   * leaves room for several dispatches per compute unit and, while
+   * HSA_QUEUE_GROW_HITS is set, for twice the deepest backlog observed on the
+   * agent's queues so far.  The value is a power of two between
+   * HSA_AGENT_INFO_QUEUE_MIN_SIZE and HSA_AGENT_INFO_QUEUE_MAX_SIZE.
+   * The type of this attribute is uint32_t.
+   */
+  HSA_AMD_AGENT_INFO_QUEUE_RECOMMENDED_SIZE = 0xA11A,
+  /**
+   * XCC and memory partition layout of the device this agent belongs to.
+   * The type of this attribute is hsa_amd_agent_partition_layout_t.
+   */
+  HSA_AMD_AGENT_INFO_PARTITION_LAYOUT = 0xA11B
 } hsa_amd_agent_info_t;
 
 /**
@@ -744,6 +874,104 @@ typedef enum hsa_amd_agent_memory_properties_s {
   HSA_AMD_MEMORY_PROPERTY_AGENT_IS_APU = (1 << 0),
 } hsa_amd_agent_memory_properties_t;
 
+/**
+ * @brief Phases of hsa_init reported by HSA_AMD_SYSTEM_INFO_INIT_PHASE_TIMES.
+ */
+typedef enum hsa_amd_init_phase_s {
+  /**
+   * All of runtime loading.
+   */
+  HSA_AMD_INIT_PHASE_TOTAL = 0,
+  /**
+   * Opening the kernel drivers, including setting up the process apertures.
+   */
+  HSA_AMD_INIT_PHASE_DRIVER_OPEN = 1,
+  /**
+   * Taking the topology snapshot from the kernel driver.
+   */
+  HSA_AMD_INIT_PHASE_TOPOLOGY_SNAPSHOT = 2,
+  /**
+   * Discovering nodes and constructing agents.
+   */
+  HSA_AMD_INIT_PHASE_AGENT_CREATE = 3,
+  /**
+   * Loading the image and finalizer extensions.
+   */
+  HSA_AMD_INIT_PHASE_EXTENSIONS = 4,
+  /**
+   * Per GPU blit kernel, scratch and trap handler setup.
+   */
+  HSA_AMD_INIT_PHASE_AGENT_INIT = 5,
+  /**
+   * Loading tools libraries.
+   */
+  HSA_AMD_INIT_PHASE_TOOLS = 6,
+  HSA_AMD_INIT_PHASE_COUNT = 7
+} hsa_amd_init_phase_t;
+
+/**
+ * @brief Start and end of each ::hsa_amd_init_phase_t, indexed by phase, in
+ * the domain of HSA_SYSTEM_INFO_TIMESTAMP.  Phases that did not run are 0.
+ */
+typedef struct hsa_amd_init_phase_times_s {
+  uint64_t start[HSA_AMD_INIT_PHASE_COUNT];
+  uint64_t end[HSA_AMD_INIT_PHASE_COUNT];
+} hsa_amd_init_phase_times_t;
+
+/**
+ * @brief Value of HSA_AMD_AGENT_INFO_INIT_TIMES, in the domain of
+ * HSA_SYSTEM_INFO_TIMESTAMP.  Steps the agent did not take are 0.
+ */
+typedef struct hsa_amd_agent_init_times_s {
+  uint64_t create_start;
+  uint64_t create_end;
+  uint64_t init_start;
+  uint64_t init_end;
+} hsa_amd_agent_init_times_t;
+
+/**
+ * @brief Value of HSA_AMD_AGENT_INFO_PARTITION_LAYOUT.
+ *
+ * @details A partitioned device exposes one agent per compute partition, each
+ * owning @p num_xcc XCCs.  Each dispatch is spread over all XCCs of its agent
+ * by the hardware, so work is placed on particular XCCs by choosing the agent.
+ * Device memory allocated through an agent, scratch included, comes from the
+ * memory partitions local to that agent.  CPU agents report zeros.
+ */
+typedef struct hsa_amd_agent_partition_layout_s {
+  /*
+  XCCs of this agent.
+  */
+  uint32_t num_xcc;
+  /*
+  Compute units per XCC.
+  */
+  uint32_t cu_per_xcc;
+  /*
+  Index of this agent among the compute partitions of its device.
+  */
+  uint32_t compute_partition;
+  /*
+  Compute partitions of the device, including agents hidden from this
+  process.
+  */
+  uint32_t num_compute_partitions;
+  /*
+  First memory partition local to this agent.
+  */
+  uint32_t memory_partition;
+  /*
+  Memory partitions local to this agent, 0 if the memory partition mode is
+  unknown.
+  */
+  uint32_t num_local_memory_partitions;
+  /*
+  Memory partitions of the device, from its NPS mode, 0 if unknown.
+  */
+  uint32_t num_memory_partitions;
+  uint32_t reserved;
+} hsa_amd_agent_partition_layout_t;
+
 /**
  * @brief SDMA engine IDs unique by single set bit position.
  */
@@ -911,6 +1139,54 @@ typedef struct hsa_amd_profiling_async_copy_time_s {
 hsa_status_t HSA_API
     hsa_amd_profiling_set_profiler_enabled(hsa_queue_t* queue, int enable);
 
+/**
+ * @brief Restrict dispatch profiling on a queue to selected kernels.
+ *
+ * @details Profiling every dispatch of a busy queue distorts the workload being
+ * measured.  With a filter installed only the selected kernel dispatches
+ * record start and end timestamps in their completion signals.  A dispatch is
+ * selected when its kernel object is listed in @p kernel_objects, or when
+ * @p sample_interval is non-zero and it is the first of each run of
+ * @p sample_interval kernel dispatches.  The queue's profiling is disabled for
+ * all other dispatches.
+ *
+ * Selected dispatches wait for the preceding packets to complete so that their
+ * profiling switch does not leak onto neighbouring dispatches.
+ *
+ * Filtering is only available on queues created by
+ * ::hsa_amd_queue_intercept_create on gfx9 and later agents.  Passing a
+ * @p kernel_object_count and @p sample_interval of zero removes the filter.
+ * Calling ::hsa_amd_profiling_set_profiler_enabled also removes the filter.
+ *
+ * @param[in] queue Intercept queue.
+ *
+ * @param[in] kernel_object_count Number of entries in @p kernel_objects.
+ *
+ * @param[in] kernel_objects Kernel object handles to profile.  May be NULL if
+ * @p kernel_object_count is 0.
+ *
+ * @param[in] sample_interval Profile one in every @p sample_interval kernel
+ * dispatches, 0 disables sampling.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The filter was installed or removed.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is not an intercept queue
+ * or its agent does not support filtering.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p queue is NULL, or
+ * @p kernel_objects is NULL while @p kernel_object_count is not 0.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Allocating the profiling
+ * packets failed.
+ */
+hsa_status_t HSA_API hsa_amd_profiling_set_dispatch_filter(hsa_queue_t* queue,
+                                                           uint32_t kernel_object_count,
+                                                           const uint64_t* kernel_objects,
+                                                           uint32_t sample_interval);
+
 /**
  * @brief Enable or disable asynchronous memory copy profiling.
  *
@@ -1015,6 +1291,148 @@ hsa_status_t HSA_API
                                                     uint64_t agent_tick,
                                                     uint64_t* system_tick);
 
+/**
+ * @brief Parameters converting an agent's ticks to system domain ticks without
+ * a call into the runtime.
+ *
+ * @details The runtime rewrites the parameters whenever it resamples the
+ * clocks.  @a sequence is odd while an update is in progress and increases
+ * with every update, so a reader retries until it reads the same even value
+ * before and after the other fields.  ::hsa_amd_clock_params_convert does so.
+ */
+typedef struct hsa_amd_clock_params_s {
+  /**
+   * Update sequence number.
+   */
+  uint64_t sequence;
+  /**
+   * Agent tick of the most recent clock sample.
+   */
+  uint64_t agent_tick;
+  /**
+   * System tick of the most recent clock sample.
+   */
+  uint64_t system_tick;
+  /**
+   * System ticks per agent tick.
+   */
+  double ratio;
+  /**
+   * Earliest agent tick the parameters convert.
+   */
+  uint64_t agent_tick_min;
+  /**
+   * Latest agent tick the parameters convert within the runtime's error bound.
+   */
+  uint64_t agent_tick_max;
+} hsa_amd_clock_params_t;
+
+/**
+ * @brief Get the clock conversion parameters of an agent.
+ *
+ * @details The parameters stay valid, and are kept up to date, until the
+ * runtime is shut down.  Ticks outside [@a agent_tick_min, @a agent_tick_max]
+ * must be converted with ::hsa_amd_profiling_convert_tick_to_system_domain,
+ * which also resamples the clocks and so extends the range for later ticks.
+ *
+ * @param[in] agent A GPU agent.
+ *
+ * @param[out] params Pointer to the agent's parameters.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is not a GPU agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p params is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_profiling_get_clock_params(hsa_agent_t agent,
+                                                        const hsa_amd_clock_params_t** params);
+
+/**
+ * @brief Convert an agent tick to a system domain tick with the agent's
+ * ::hsa_amd_clock_params_t.
+ *
+ * @details Gives the same result as
+ * ::hsa_amd_profiling_convert_tick_to_system_domain.  Returns false if
+ * @p agent_tick is outside the range of the parameters, in which case that
+ * function must be called instead.
+ */
+static __inline__ __attribute__((always_inline)) bool hsa_amd_clock_params_convert(
+    const hsa_amd_clock_params_t* params, uint64_t agent_tick, uint64_t* system_tick) {
+  uint64_t sequence, base_agent, base_system, min, max;
+  double ratio;
+  do {
+    sequence = __atomic_load_n(&params->sequence, __ATOMIC_ACQUIRE);
+    base_agent = params->agent_tick;
+    base_system = params->system_tick;
+    ratio = params->ratio;
+    min = params->agent_tick_min;
+    max = params->agent_tick_max;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((sequence & 1) || sequence != __atomic_load_n(&params->sequence, __ATOMIC_RELAXED));
+
+  if (agent_tick < min || agent_tick > max) return false;
+  *system_tick = (uint64_t)(int64_t)(ratio * (double)(int64_t)(agent_tick - base_agent)) +
+      base_system;
+  return true;
+}
+
+/**
+ * @brief Convert a system domain tick to an agent tick with the agent's
+ * ::hsa_amd_clock_params_t.
+ *
+ * @details Inverse of ::hsa_amd_clock_params_convert.  Returns false if the
+ * resulting agent tick is outside the range of the parameters.
+ */
+static __inline__ __attribute__((always_inline)) bool hsa_amd_clock_params_convert_system(
+    const hsa_amd_clock_params_t* params, uint64_t system_tick, uint64_t* agent_tick) {
+  uint64_t sequence, base_agent, base_system, min, max;
+  double ratio;
+  do {
+    sequence = __atomic_load_n(&params->sequence, __ATOMIC_ACQUIRE);
+    base_agent = params->agent_tick;
+    base_system = params->system_tick;
+    ratio = params->ratio;
+    min = params->agent_tick_min;
+    max = params->agent_tick_max;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((sequence & 1) || sequence != __atomic_load_n(&params->sequence, __ATOMIC_RELAXED));
+
+  if (min > max) return false;
+  uint64_t tick = (uint64_t)(int64_t)((double)(int64_t)(system_tick - base_system) / ratio) +
+      base_agent;
+  if (tick < min || tick > max) return false;
+  *agent_tick = tick;
+  return true;
+}
+
+/**
+ * @brief Read the current tick of an agent's clock.
+ *
+ * @details The tick is estimated from the system clock with the agent's
+ * ::hsa_amd_clock_params_t while the current time is within their range, and
+ * so costs no call into the kernel driver.  Otherwise the clocks are
+ * resampled, which also extends the range for later reads.  Error is within
+ * the bound of ::hsa_amd_profiling_convert_tick_to_system_domain.
+ *
+ * @param[in] agent A GPU agent.
+ *
+ * @param[out] agent_tick Current tick of the agent's clock.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is not a GPU agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p agent_tick is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_profiling_get_agent_tick(hsa_agent_t agent, uint64_t* agent_tick);
+
 /** @} */
 
 /** \defgroup status Runtime notifications
@@ -1110,6 +1528,79 @@ hsa_status_t HSA_API hsa_amd_signal_create(hsa_signal_value_t initial_value, uin
 hsa_status_t hsa_amd_signal_value_pointer(hsa_signal_t signal,
                                           volatile hsa_signal_value_t** value_ptr);
 
+/**
+ * @brief Host wait policies for signals.
+ */
+typedef enum hsa_amd_signal_wait_policy_s {
+  /**
+   * Use the process wide policy selected by HSA_SIGNAL_WAIT_POLICY.
+   */
+  HSA_AMD_SIGNAL_WAIT_POLICY_DEFAULT = 0,
+  /**
+   * Poll the signal for a fixed interval before sleeping.  This is the legacy
+   * behavior.
+   */
+  HSA_AMD_SIGNAL_WAIT_POLICY_FIXED = 1,
+  /**
+   * Track the latency of satisfied waits on the signal and poll only as long
+   * as completion is likely.  Waits which historically take much longer than
+   * the polling window sleep immediately.
+   */
+  HSA_AMD_SIGNAL_WAIT_POLICY_ADAPTIVE = 2
+} hsa_amd_signal_wait_policy_t;
+
+/**
+ * @brief Selects the policy used by blocked host waits on a signal.
+ *
+ * @details The policy only affects waits with ::HSA_WAIT_STATE_BLOCKED.  Active
+ * waits always poll.  Changing the policy of a signal resets its latency history.
+ *
+ * @param[in] signal Signal to configure.
+ *
+ * @param[in] policy Wait policy.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL signal is not a valid hsa_signal_t
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT policy is not a valid policy.
+ */
+hsa_status_t HSA_API hsa_amd_signal_wait_policy(hsa_signal_t signal,
+                                                hsa_amd_signal_wait_policy_t policy);
+
+/**
+ * @brief Retrieves a pollable file descriptor for an interrupt signal.
+ *
+ * @details The descriptor is an eventfd which becomes readable when the
+ * signal's interrupt event fires, so signal completion can be multiplexed with
+ * other descriptors in poll, epoll or io_uring loops.  Reading the descriptor
+ * clears its readiness.  Wakeups may be spurious and coalesced, the application
+ * must check the signal value after each wakeup.  The descriptor is owned by
+ * the signal and closed when the signal is destroyed.  Repeated calls return
+ * the same descriptor.
+ *
+ * @param[in] signal Signal to watch.
+ *
+ * @param[out] fd Location where the descriptor will be placed.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL signal is not a valid hsa_signal_t
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT fd is NULL or signal is not an
+ * interrupt signal.
+ *
+ * @retval ::HSA_STATUS_ERROR The kernel driver does not support exporting
+ * events or the descriptor could not be created.
+ */
+hsa_status_t HSA_API hsa_amd_signal_get_eventfd(hsa_signal_t signal, int* fd);
+
 /**
  * @brief Asyncronous signal handler function type.
  *
@@ -1183,6 +1674,60 @@ hsa_status_t HSA_API
                                  hsa_signal_value_t value,
                                  hsa_amd_signal_handler handler, void* arg);
 
+/**
+ * @brief Flags for hsa_amd_signal_async_handler_with_flags.
+ */
+typedef enum hsa_amd_signal_handler_flag_s {
+  /**
+   * Service the handler on a thread reserved for latency critical handlers so
+   * slow handlers registered through other paths cannot delay it.
+   */
+  HSA_AMD_SIGNAL_HANDLER_LATENCY_CRITICAL = 1
+} hsa_amd_signal_handler_flag_t;
+
+/**
+ * @brief Register asynchronous signal handler function with flags.
+ *
+ * @details Behaves as ::hsa_amd_signal_async_handler, except that handlers
+ * registered with ::HSA_AMD_SIGNAL_HANDLER_LATENCY_CRITICAL are invoked
+ * serially with each other but may run concurrently with all other handlers.
+ * Likewise, when HSA_ASYNC_EVENT_THREADS is set above one, handlers of
+ * different signals may run concurrently.  Handlers of one signal are always
+ * invoked serially.
+ *
+ * @param[in] signal hsa signal to be asynchronously monitored
+ *
+ * @param[in] cond condition value to monitor for
+ *
+ * @param[in] value signal value used in condition expression
+ *
+ * @param[in] handler asynchronous signal handler invoked when signal's
+ * condition is met
+ *
+ * @param[in] arg user provided value which is provided to handler when handler
+ * is invoked
+ *
+ * @param[in] flags Bitwise or of ::hsa_amd_signal_handler_flag_t values.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL signal is not a valid hsa_signal_t
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT handler is invalid (NULL) or
+ * flags contains unknown bits
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The HSA runtime is out of
+ * resources or blocking signals are not supported by the HSA driver component.
+ */
+hsa_status_t HSA_API hsa_amd_signal_async_handler_with_flags(hsa_signal_t signal,
+                                                             hsa_signal_condition_t cond,
+                                                             hsa_signal_value_t value,
+                                                             hsa_amd_signal_handler handler,
+                                                             void* arg, uint64_t flags);
+
 /**
  * @brief Wait for any signal-condition pair to be satisfied.
  *
@@ -1199,2352 +1744,6333 @@ uint32_t HSA_API
                             hsa_wait_state_t wait_hint,
                             hsa_signal_value_t* satisfying_value);
 
-/** @} */
+/**
+ * @brief Opaque handle to a persistent signal wait set.
+ */
+typedef struct hsa_amd_signal_wait_set_s {
+  /**
+   * Opaque handle.
+   */
+  uint64_t handle;
+} hsa_amd_signal_wait_set_t;
 
 /**
- * @brief Call a function asynchronously
+ * @brief Create an empty signal wait set.
  *
- * @details Provides access to the runtime's asynchronous event handling thread
- * for general asynchronous functions.  Functions queued this way are executed
- * in the same manner as if they were a signal handler who's signal is
- * satisfied.
+ * @details A wait set holds signal-condition pairs which are registered once
+ * and then waited on repeatedly.  It is intended for waiting on large numbers
+ * of outstanding completions, where ::hsa_amd_signal_wait_any would rescan
+ * every signal on every call.  Calls on one wait set must be serialized by the
+ * application.
  *
- * @param[in] callback asynchronous function to be invoked
- *
- * @param[in] arg user provided value which is provided to handler when handler
- * is invoked
+ * @param[out] wait_set Location where the new wait set handle is placed.
  *
  * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT handler is invalid (NULL)
- *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The HSA runtime is out of
- * resources or blocking signals are not supported by the HSA driver component.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES There is a failure in allocating
+ * the wait set.
  *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p wait_set is NULL.
  */
-hsa_status_t HSA_API
-    hsa_amd_async_function(void (*callback)(void* arg), void* arg);
-
-/** \addtogroup ext-images Images and samplers
- *  @{
- */
+hsa_status_t HSA_API hsa_amd_signal_wait_set_create(hsa_amd_signal_wait_set_t* wait_set);
 
 /**
- * @brief Encodes an opaque vendor specific image format.  The length of data
- * depends on the underlying format.  This structure must not be copied as its
- * true length can not be determined.
+ * @brief Destroy a signal wait set, releasing all signals still registered.
+ *
+ * @param[in] wait_set Wait set to destroy.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p wait_set is invalid.
  */
-typedef struct hsa_amd_image_descriptor_s {
-  /*
-  Version number of the descriptor
-  */
-  uint32_t version;
-
-  /*
-  Vendor and device PCI IDs for the format as VENDOR_ID<<16|DEVICE_ID.
-  */
-  uint32_t deviceID;
-
-  /*
-  Start of vendor specific data.
-  */
-  uint32_t data[1];
-} hsa_amd_image_descriptor_t;
+hsa_status_t HSA_API hsa_amd_signal_wait_set_destroy(hsa_amd_signal_wait_set_t wait_set);
 
 /**
- * @brief Creates an image from an opaque vendor specific image format.
- * Does not modify data at image_data.  Intended initially for
- * accessing interop images.
+ * @brief Register a signal-condition pair with a wait set.
  *
- * @param agent[in] Agent on which to create the image
+ * @details The signal is retained by the wait set and may be destroyed by the
+ * application while registered.  Destroyed signals are reported as satisfied.
  *
- * @param[in] image_descriptor[in] Vendor specific image format
+ * @param[in] wait_set Wait set.
  *
- * @param[in] image_data Pointer to image backing store
+ * @param[in] signal Signal to register.  A signal may be registered only once
+ * per wait set.
  *
- * @param[in] access_permission Access permissions for the image object
+ * @param[in] condition Condition used to compare the signal value with
+ * @p compare_value.
  *
- * @param[out] image Created image object.
+ * @param[in] compare_value Value to compare with.
  *
- * @retval HSA_STATUS_SUCCESS Image created successfully
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
- * necessary resources
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p signal is not a valid signal.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT Bad or mismatched descriptor,
- * null image_data, or mismatched access_permission.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p wait_set is invalid,
+ * @p condition is not a valid condition or @p signal is already registered.
  */
-hsa_status_t HSA_API hsa_amd_image_create(
-    hsa_agent_t agent,
-    const hsa_ext_image_descriptor_t *image_descriptor,
-    const hsa_amd_image_descriptor_t *image_layout,
-    const void *image_data,
-    hsa_access_permission_t access_permission,
-    hsa_ext_image_t *image
-);
+hsa_status_t HSA_API hsa_amd_signal_wait_set_add(hsa_amd_signal_wait_set_t wait_set,
+                                                 hsa_signal_t signal,
+                                                 hsa_signal_condition_t condition,
+                                                 hsa_signal_value_t compare_value);
 
 /**
- * @brief Query image limits.
- *
- * @param[in] agent A valid agent.
+ * @brief Unregister a signal from a wait set without reporting it.
  *
- * @param[in] attribute HSA image info attribute to query.
+ * @param[in] wait_set Wait set.
  *
- * @param[out] value Pointer to an application-allocated buffer where to store
- * the value of the attribute. If the buffer passed by the application is not
- * large enough to hold the value of @p attribute, the behavior is undefined.
+ * @param[in] signal Registered signal.
  *
  * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p value is NULL or @p attribute <
- * HSA_EXT_AGENT_INFO_IMAGE_1D_MAX_ELEMENTS or @p attribute >
- * HSA_EXT_AGENT_INFO_IMAGE_ARRAY_MAX_LAYERS.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p wait_set is invalid or
+ * @p signal is not registered.
+ */
+hsa_status_t HSA_API hsa_amd_signal_wait_set_remove(hsa_amd_signal_wait_set_t wait_set,
+                                                    hsa_signal_t signal);
+
+/**
+ * @brief Wait for registered signals to satisfy their conditions.
+ *
+ * @details Blocks until at least one registered signal satisfies its condition
+ * or the timeout expires.  Up to @p max_ready satisfied signals are removed
+ * from the wait set and reported together with the values which satisfied
+ * them.  Satisfied signals beyond @p max_ready remain registered and are
+ * reported by a later call.  This function provides only relaxed memory
+ * semantics.
+ *
+ * @param[in] wait_set Wait set.
+ *
+ * @param[in] timeout_hint Maximum duration of the wait, in the same units as
+ * ::HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY.
+ *
+ * @param[in] wait_hint Hint indicating whether the waiting thread may sleep.
+ *
+ * @param[in] max_ready Capacity of @p ready_signals and @p ready_values.
+ *
+ * @param[out] ready_signals Satisfied signals.
  *
+ * @param[out] ready_values Values which satisfied each reported signal.  May be
+ * NULL.
+ *
+ * @param[out] ready_count Number of signals reported.  Zero if the wait timed
+ * out or the wait set is empty.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p wait_set is invalid,
+ * @p ready_signals or @p ready_count is NULL.
  */
-hsa_status_t HSA_API hsa_amd_image_get_info_max_dim(hsa_agent_t agent,
-                                                    hsa_agent_info_t attribute,
-                                                    void* value);
+hsa_status_t HSA_API hsa_amd_signal_wait_set_wait(hsa_amd_signal_wait_set_t wait_set,
+                                                  uint64_t timeout_hint,
+                                                  hsa_wait_state_t wait_hint, uint32_t max_ready,
+                                                  hsa_signal_t* ready_signals,
+                                                  hsa_signal_value_t* ready_values,
+                                                  uint32_t* ready_count);
 
-/** @} */
+/**
+ * @brief Opaque handle to a completion queue.
+ */
+typedef struct hsa_amd_completion_queue_s {
+  uint64_t handle;
+} hsa_amd_completion_queue_t;
 
-/** \addtogroup queue Queues
- *  @{
+/**
+ * @brief Completion reported by ::hsa_amd_completion_queue_dequeue.
  */
+typedef struct hsa_amd_completion_record_s {
+  /*
+  Tag given to ::hsa_amd_completion_queue_signal_create.
+  */
+  uint64_t tag;
+  /*
+  System timestamp, in the HSA_SYSTEM_INFO_TIMESTAMP domain, at which the
+  runtime observed the completion.
+  */
+  uint64_t timestamp;
+} hsa_amd_completion_record_t;
 
 /**
- * @brief Set a queue's CU affinity mask.
- *
- * @details Enables the queue to run on only selected CUs.  The given mask is
- * combined by bitwise AND with any device wide mask in HSA_CU_MASK before
- * being applied.
- * If num_cu_mask_count is 0 then the request is interpreted as a request to
- * enable all CUs and no cu_mask array need be given.
+ * @brief Create a completion queue.
  *
- * @param[in] queue A pointer to HSA queue.
+ * @details A completion queue hands out completion signals, each carrying an
+ * application tag, and reports the tags of completed signals in batches.  It
+ * replaces polling many signals or registering one asynchronous handler per
+ * signal.  All signals of a completion queue share one interrupt event, so a
+ * burst of completions wakes the consumer once.
  *
- * @param[in] num_cu_mask_count Size of CUMask bit array passed in, in bits.
+ * @param[in] size Maximum number of signals outstanding on the queue.  Must
+ * not be 0.
  *
- * @param[in] cu_mask Bit-vector representing the CU mask.
+ * @param[out] queue Location where the new completion queue handle is placed.
  *
  * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
- * @retval ::HSA_STATUS_CU_MASK_REDUCED The function was successfully executed
- * but the given mask attempted to enable a CU which was disabled by
- * HSA_CU_MASK.  CUs disabled by HSA_CU_MASK remain disabled.
- *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is NULL or invalid.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES There is a failure in allocating
+ * the completion queue.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_cu_mask_count is not
- * a multiple of 32 or @p num_cu_mask_count is not 0 and cu_mask is NULL.
- * Devices with work group processors must even-index contiguous pairwise
- * CU enable e.g. 0x33(b'110011) is valid while 0x5(0x101) and 0x6(b'0110)
- * are invalid.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p size is 0 or @p queue is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_completion_queue_create(uint32_t size,
+                                                     hsa_amd_completion_queue_t* queue);
+
+/**
+ * @brief Destroy a completion queue together with its outstanding signals.
+ *
+ * @details The application must ensure no packet or copy still references a
+ * signal of the queue.
+ *
+ * @param[in] queue Completion queue to destroy.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p queue is invalid.
  */
-hsa_status_t HSA_API hsa_amd_queue_cu_set_mask(const hsa_queue_t* queue,
-                                               uint32_t num_cu_mask_count,
-                                               const uint32_t* cu_mask);
+hsa_status_t HSA_API hsa_amd_completion_queue_destroy(hsa_amd_completion_queue_t queue);
 
 /**
- * @brief Retrieve a queue's CU affinity mask.
+ * @brief Create a completion signal bound to a completion queue.
  *
- * @details Returns the first num_cu_mask_count bits of a queue's CU mask.
- * Ensure that num_cu_mask_count is at least as large as
- * HSA_AMD_AGENT_INFO_COMPUTE_UNIT_COUNT to retrieve the entire mask.
+ * @details The signal may be used wherever a completion signal is accepted,
+ * such as kernel dispatch and barrier packets or asynchronous copies.  It
+ * completes once its value drops below 1, after which @p tag is reported by
+ * ::hsa_amd_completion_queue_dequeue.  The signal is owned by the queue and is
+ * destroyed once its completion has been dequeued; the application must not
+ * destroy it.
  *
- * @param[in] queue A pointer to HSA queue.
+ * @param[in] queue Completion queue.
  *
- * @param[in] num_cu_mask_count Size of CUMask bit array passed in, in bits.
+ * @param[in] initial_value Initial value of the signal, typically 1.
  *
- * @param[out] cu_mask Bit-vector representing the CU mask.
+ * @param[in] tag Application value reported with the completion.
+ *
+ * @param[out] signal Location where the new signal handle is placed.
  *
  * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is NULL or invalid.
- *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_cu_mask_count is 0, not
- * a multiple of 32 or @p cu_mask is NULL.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES @p queue already has its maximum
+ * number of signals outstanding, or the signal could not be allocated.
  *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p queue is invalid or @p signal
+ * is NULL.
  */
-hsa_status_t HSA_API hsa_amd_queue_cu_get_mask(const hsa_queue_t* queue, uint32_t num_cu_mask_count,
-                                               uint32_t* cu_mask);
+hsa_status_t HSA_API hsa_amd_completion_queue_signal_create(hsa_amd_completion_queue_t queue,
+                                                            hsa_signal_value_t initial_value,
+                                                            uint64_t tag, hsa_signal_t* signal);
 
-/** @} */
+/**
+ * @brief Dequeue a batch of completions.
+ *
+ * @details Blocks until at least one signal of the queue has completed or the
+ * timeout expires, then reports up to @p max_records completions.  Further
+ * completions remain queued for a later call.  Records are ordered by signal
+ * creation, not by completion time.  Calls on one queue must be serialized;
+ * signal creation may happen concurrently from other threads.
+ *
+ * @param[in] queue Completion queue.
+ *
+ * @param[in] timeout_hint Maximum duration of the wait, in the same units as
+ * ::HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY.
+ *
+ * @param[in] wait_hint Hint indicating whether the waiting thread may sleep.
+ *
+ * @param[in] max_records Capacity of @p records.
+ *
+ * @param[out] records Completions dequeued.
+ *
+ * @param[out] count Number of records written.  Zero if the wait timed out or
+ * no signal is outstanding.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p queue is invalid, @p records
+ * or @p count is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_completion_queue_dequeue(hsa_amd_completion_queue_t queue,
+                                                      uint64_t timeout_hint,
+                                                      hsa_wait_state_t wait_hint,
+                                                      uint32_t max_records,
+                                                      hsa_amd_completion_record_t* records,
+                                                      uint32_t* count);
 
-/** \addtogroup memory Memory
- *  @{
+/**
+ * @brief Opaque handle to a progress counter.
  */
+typedef struct hsa_amd_progress_counter_s {
+  uint64_t handle;
+} hsa_amd_progress_counter_t;
 
 /**
- * @brief Memory segments associated with a memory pool.
+ * @brief Memory layout of a progress counter, shared by the producer and the
+ * runtime.
+ *
+ * @details The layout occupies one cache line of fine grain system memory.  A
+ * producer on the GPU reports progress with a system scope atomic add to @p
+ * value.  If the new value reaches @p threshold, it writes @p event_id to
+ * @p event_mailbox_ptr and raises an interrupt, as for an interrupt signal.
+ * Producers on the CPU do the same without the interrupt; the runtime polls
+ * the counter while a waiter spins.  Producers must not write any field
+ * other than @p value.
+ */
+typedef struct hsa_amd_progress_counter_abi_s {
+  /*
+  Current counter value.  Updated by producers.
+  */
+  volatile uint64_t value;
+  /*
+  Value at which a producer must raise an interrupt.  UINT64_MAX while no
+  consumer sleeps.
+  */
+  volatile uint64_t threshold;
+  /*
+  Address of the interrupt event mailbox, 0 if the counter has no interrupt.
+  */
+  uint64_t event_mailbox_ptr;
+  /*
+  Interrupt event ID written to the mailbox.
+  */
+  uint32_t event_id;
+  uint32_t reserved0;
+  uint64_t reserved1[4];
+} hsa_amd_progress_counter_abi_t;
+
+/**
+ * @brief Progress counter creation flags.
  */
-typedef enum {
-  /**
-   * Global segment. Used to hold data that is shared by all agents.
-   */
-  HSA_AMD_SEGMENT_GLOBAL = 0,
-  /**
-   * Read-only segment. Used to hold data that remains constant during the
-   * execution of a kernel.
-   */
-  HSA_AMD_SEGMENT_READONLY = 1,
-  /**
-   * Private segment. Used to hold data that is local to a single work-item.
-   */
-  HSA_AMD_SEGMENT_PRIVATE = 2,
+typedef enum hsa_amd_progress_counter_flag_s {
   /**
-   * Group segment. Used to hold data that is shared by the work-items of a
-   * work-group.
+   * Let waiters sleep on an interrupt raised by producers once the value
+   * reaches the waited for threshold.  Without this flag waiters poll.
    */
-  HSA_AMD_SEGMENT_GROUP = 3,
-} hsa_amd_segment_t;
+  HSA_AMD_PROGRESS_COUNTER_INTERRUPT = (1 << 0),
+} hsa_amd_progress_counter_flag_t;
 
 /**
- * @brief A memory pool encapsulates physical storage on an agent
- * along with a memory access model.
+ * @brief Create a progress counter.
  *
- * @details A memory pool encapsulates a physical partition of an agent's
- * memory system along with a memory access model.  Division of a single
- * memory system into separate pools allows querying each partition's access
- * path properties (see ::hsa_amd_agent_memory_pool_get_info). Allocations
- * from a pool are preferentially bound to that pool's physical partition.
- * Binding to the pool's preferential physical partition may not be
- * possible or persistent depending on the system's memory policy
- * and/or state which is beyond the scope of HSA APIs.
+ * @details A progress counter is a monotonically increasing value through
+ * which a producer, typically a streaming kernel, reports partial progress to
+ * a consumer on the CPU without a completion signal per chunk.  It lives in
+ * fine grain system memory on the NUMA node nearest @p agent, in a cache line
+ * of its own, so producer updates do not contend with unrelated data.
  *
- * For example, a multi-node NUMA memory system may be represented by multiple
- * pool's with each pool providing size and access path information for the
- * partition it represents.  Allocations from a pool are preferentially bound
- * to the pool's partition (which in this example is a NUMA node) while
- * following its memory access model. The actual placement may vary or migrate
- * due to the system's NUMA policy and state, which is beyond the scope of
- * HSA APIs.
- */ 
-typedef struct hsa_amd_memory_pool_s {
-  /**
-   * Opaque handle.
-   */
-  uint64_t handle;
-} hsa_amd_memory_pool_t;
-
-typedef enum hsa_amd_memory_pool_global_flag_s {
-  /**
-   * The application can use allocations in the memory pool to store kernel
-   * arguments, and provide the values for the kernarg segment of
-   * a kernel dispatch.
-   */
-  HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_KERNARG_INIT = 1,
-  /**
-   * Updates to memory in this pool conform to HSA memory consistency model.
-   * If this flag is set, then ::HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_COARSE_GRAINED
-   * must not be set.
-   */
-  HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_FINE_GRAINED = 2,
-  /**
-   * Writes to memory in this pool can be performed by a single agent at a time.
-   */
-  HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_COARSE_GRAINED = 4,
+ * @param[in] agent Agent producing progress.  Selects the memory placement.
+ *
+ * @param[in] initial_value Initial counter value.
+ *
+ * @param[in] flags Bitwise OR of ::hsa_amd_progress_counter_flag_t values.
+ *
+ * @param[out] counter Location where the new counter handle is placed.
+ *
+ * @param[out] abi Location where the address of the counter layout is
+ * placed.  The address is valid on the CPU and on all GPU agents and is
+ * passed to producers, for instance as a kernel argument.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The counter could not be
+ * allocated.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p flags contains unknown bits,
+ * @p counter or @p abi is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_progress_counter_create(hsa_agent_t agent, uint64_t initial_value,
+                                                     uint32_t flags,
+                                                     hsa_amd_progress_counter_t* counter,
+                                                     hsa_amd_progress_counter_abi_t** abi);
 
-  /** Updates to memory in this memory pool have extended scope, acting as
-   * system-scope atomics for variables in memory regions of this type.
-   * Note: On non-compliant systems, device-specific actions may be required
-   * for system-scope coherence. */
-  HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_EXTENDED_SCOPE_FINE_GRAINED = 8,
+/**
+ * @brief Destroy a progress counter.
+ *
+ * @details The application must ensure no producer still updates the counter
+ * and no thread waits on it.
+ *
+ * @param[in] counter Progress counter to destroy.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p counter is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_progress_counter_destroy(hsa_amd_progress_counter_t counter);
 
-} hsa_amd_memory_pool_global_flag_t;
+/**
+ * @brief Wait until a progress counter reaches a value.
+ *
+ * @details Spins briefly, then, if the counter was created with
+ * ::HSA_AMD_PROGRESS_COUNTER_INTERRUPT and @p wait_hint allows, publishes @p
+ * threshold to producers and sleeps until one of them raises the interrupt.
+ * Returns with acquire semantics.  A @p threshold of 0 returns the current
+ * value at once.  Waits on one counter must be serialized.
+ *
+ * @param[in] counter Progress counter.
+ *
+ * @param[in] threshold Value to wait for.
+ *
+ * @param[in] timeout_hint Maximum duration of the wait, in the same units as
+ * ::HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY.
+ *
+ * @param[in] wait_hint Hint indicating whether the waiting thread may sleep.
+ *
+ * @param[out] value Counter value observed last.  Below @p threshold if the
+ * wait timed out.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p counter is invalid or @p
+ * value is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_progress_counter_wait(hsa_amd_progress_counter_t counter,
+                                                   uint64_t threshold, uint64_t timeout_hint,
+                                                   hsa_wait_state_t wait_hint, uint64_t* value);
 
-typedef enum hsa_amd_memory_pool_location_s {
-    /**
-     * This memory pool resides on the host (CPU)
-     */
-    HSA_AMD_MEMORY_POOL_LOCATION_CPU = 0,
-    /**
-     * This memory pool resides on a GPU
-     */
-    HSA_AMD_MEMORY_POOL_LOCATION_GPU = 1
-} hsa_amd_memory_pool_location_t;
+/** @} */
 
 /**
- * @brief Memory pool features.
- */
-typedef enum {
-  /**
-  * Segment where the memory pool resides. The type of this attribute is
-  * ::hsa_amd_segment_t.
+ * @brief Call a function asynchronously
+ *
+ * @details Provides access to the runtime's asynchronous event handling thread
+ * for general asynchronous functions.  Functions queued this way are executed
+ * in the same manner as if they were a signal handler who's signal is
+ * satisfied.
+ *
+ * @param[in] callback asynchronous function to be invoked
+ *
+ * @param[in] arg user provided value which is provided to handler when handler
+ * is invoked
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT handler is invalid (NULL)
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The HSA runtime is out of
+ * resources or blocking signals are not supported by the HSA driver component.
+ *
+ */
+hsa_status_t HSA_API
+    hsa_amd_async_function(void (*callback)(void* arg), void* arg);
+
+/** \addtogroup ext-images Images and samplers
+ *  @{
+ */
+
+/**
+ * @brief Encodes an opaque vendor specific image format.  The length of data
+ * depends on the underlying format.  This structure must not be copied as its
+ * true length can not be determined.
+ */
+typedef struct hsa_amd_image_descriptor_s {
+  /*
+  Version number of the descriptor
   */
-  HSA_AMD_MEMORY_POOL_INFO_SEGMENT = 0,
-  /**
-  * Flag mask. The value of this attribute is undefined if the value of
-  * ::HSA_AMD_MEMORY_POOL_INFO_SEGMENT is not ::HSA_AMD_SEGMENT_GLOBAL. The type
-  * of
-  * this attribute is uint32_t, a bit-field of
-  * ::hsa_amd_memory_pool_global_flag_t
-  * values.
+  uint32_t version;
+
+  /*
+  Vendor and device PCI IDs for the format as VENDOR_ID<<16|DEVICE_ID.
   */
-  HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS = 1,
-  /**
-  * Size of this pool, in bytes. The type of this attribute is size_t.
+  uint32_t deviceID;
+
+  /*
+  Start of vendor specific data.
   */
-  HSA_AMD_MEMORY_POOL_INFO_SIZE = 2,
+  uint32_t data[1];
+} hsa_amd_image_descriptor_t;
+
+/**
+ * @brief Creates an image from an opaque vendor specific image format.
+ * Does not modify data at image_data.  Intended initially for
+ * accessing interop images.
+ *
+ * @param agent[in] Agent on which to create the image
+ *
+ * @param[in] image_descriptor[in] Vendor specific image format
+ *
+ * @param[in] image_data Pointer to image backing store
+ *
+ * @param[in] access_permission Access permissions for the image object
+ *
+ * @param[out] image Created image object.
+ *
+ * @retval HSA_STATUS_SUCCESS Image created successfully
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT Bad or mismatched descriptor,
+ * null image_data, or mismatched access_permission.
+ */
+hsa_status_t HSA_API hsa_amd_image_create(
+    hsa_agent_t agent,
+    const hsa_ext_image_descriptor_t *image_descriptor,
+    const hsa_amd_image_descriptor_t *image_layout,
+    const void *image_data,
+    hsa_access_permission_t access_permission,
+    hsa_ext_image_t *image
+);
+
+/**
+ * @brief Query image limits.
+ *
+ * @param[in] agent A valid agent.
+ *
+ * @param[in] attribute HSA image info attribute to query.
+ *
+ * @param[out] value Pointer to an application-allocated buffer where to store
+ * the value of the attribute. If the buffer passed by the application is not
+ * large enough to hold the value of @p attribute, the behavior is undefined.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p value is NULL or @p attribute <
+ * HSA_EXT_AGENT_INFO_IMAGE_1D_MAX_ELEMENTS or @p attribute >
+ * HSA_EXT_AGENT_INFO_IMAGE_ARRAY_MAX_LAYERS.
+ *
+ */
+hsa_status_t HSA_API hsa_amd_image_get_info_max_dim(hsa_agent_t agent,
+                                                    hsa_agent_info_t attribute,
+                                                    void* value);
+
+/**
+ * @brief Image operations performed by ::hsa_amd_image_blit.
+ */
+typedef enum hsa_amd_image_blit_op_s {
   /**
-  * Indicates whether memory in this pool can be allocated using
-  * ::hsa_amd_memory_pool_allocate. The type of this attribute is bool.
-  *
-  * The value of this flag is always false for memory pools in the group and
-  * private segments.
-  */
-  HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED = 5,
+   * Equivalent to ::hsa_ext_image_import.
+   */
+  HSA_AMD_IMAGE_BLIT_IMPORT = 0,
   /**
-   * Allocation granularity of buffers allocated by
-   * ::hsa_amd_memory_pool_allocate
-   * in this memory pool. The size of a buffer allocated in this pool is a
-   * multiple of the value of this attribute. While this is the minimum size of
-   * allocation allowed, it is recommened to use
-   * HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_REC_GRANULE to obtain the recommended
-   * allocation granularity size for this pool.
-   * The value of this attribute is only defined if
-   * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED is true for
-   * this pool. The type of this attribute is size_t.
+   * Equivalent to ::hsa_ext_image_export.
    */
-  HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE = 6,
+  HSA_AMD_IMAGE_BLIT_EXPORT = 1,
   /**
-   * Alignment of buffers allocated by ::hsa_amd_memory_pool_allocate in this
-   * pool. The value of this attribute is only defined if
-   * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED is true for this pool, and
-   * must be a power of 2. The type of this attribute is size_t.
+   * Equivalent to ::hsa_ext_image_copy.
    */
-  HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALIGNMENT = 7,
+  HSA_AMD_IMAGE_BLIT_COPY = 2,
   /**
-   * This memory_pool can be made directly accessible by all the agents in the
-   * system (::hsa_amd_agent_memory_pool_get_info does not return
-   * ::HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED for any agent). The type of this
-   * attribute is bool.
+   * Equivalent to ::hsa_ext_image_clear.
    */
-  HSA_AMD_MEMORY_POOL_INFO_ACCESSIBLE_BY_ALL = 15,
+  HSA_AMD_IMAGE_BLIT_CLEAR = 3
+} hsa_amd_image_blit_op_t;
+
+/**
+ * @brief One image operation of ::hsa_amd_image_blit.
+ */
+typedef struct hsa_amd_image_blit_s {
   /**
-   * Maximum aggregate allocation size in bytes. The type of this attribute
-   * is size_t.
+   * Operation to perform.
    */
-  HSA_AMD_MEMORY_POOL_INFO_ALLOC_MAX_SIZE = 16,
+  hsa_amd_image_blit_op_t op;
   /**
-   * Location of this memory pool. The type of this attribute
-   * is hsa_amd_memory_pool_location_t.
+   * Destination image of an import, copy or clear, source image of an export.
    */
-  HSA_AMD_MEMORY_POOL_INFO_LOCATION = 17,
+  hsa_ext_image_t image;
   /**
-   * Internal block size for allocations. This would also be the recommended
-   * granularity size for allocations as this prevents internal fragmentation.
-   * The value of this attribute is only defined if
-   * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED is true for this pool.
-   * The size of this attribute is size_t.
+   * Source image of a copy, ignored otherwise.
    */
-  HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_REC_GRANULE = 18,
-} hsa_amd_memory_pool_info_t;
-
-/**
- * @brief Memory pool flag used to specify allocation directives
- *
- */
-typedef enum hsa_amd_memory_pool_flag_s {
+  hsa_ext_image_t src_image;
   /**
-   * Allocates memory that conforms to standard HSA memory consistency model
+   * Source memory of an import, destination memory of an export, ignored otherwise.
    */
-  HSA_AMD_MEMORY_POOL_STANDARD_FLAG = 0,
+  void* memory;
   /**
-   * Allocates fine grain memory type where memory ordering is per point to point
-   * connection. Atomic memory operations on these memory buffers are not
-   * guaranteed to be visible at system scope.
+   * Row and slice pitch in bytes of @a memory, as for ::hsa_ext_image_import.
    */
-  HSA_AMD_MEMORY_POOL_PCIE_FLAG = (1 << 0),
+  size_t row_pitch;
+  size_t slice_pitch;
   /**
-   *  Allocates physically contiguous memory
+   * Clear pattern, ignored unless @a op is ::HSA_AMD_IMAGE_BLIT_CLEAR.
    */
-  HSA_AMD_MEMORY_POOL_CONTIGUOUS_FLAG = (1 << 1),
+  const void* data;
   /**
-   *  Allocates executable memory
+   * Region of @a image accessed. For copies the offset is the destination offset.
    */
-  HSA_AMD_MEMORY_POOL_EXECUTABLE_FLAG = (1 << 2),
-
-} hsa_amd_memory_pool_flag_t;
+  hsa_ext_image_region_t region;
+  /**
+   * Offset within @a src_image of a copy, ignored otherwise.
+   */
+  hsa_dim3_t src_offset;
+} hsa_amd_image_blit_t;
 
 /**
- * @brief Get the current value of an attribute of a memory pool.
+ * @brief Performs a list of image imports, exports, copies and clears.
  *
- * @param[in] memory_pool A valid memory pool.
+ * @details The operations are submitted to the agent together and the call
+ * returns once all of them finished. Operations in the list are not ordered
+ * with respect to each other, so no operation may write data accessed by
+ * another one in the same list.
  *
- * @param[in] attribute Attribute to query.
+ * @param[in] agent Agent owning all images in @p blits.
  *
- * @param[out] value Pointer to a application-allocated buffer where to store
- * the value of the attribute. If the buffer passed by the application is not
- * large enough to hold the value of @p attribute, the behavior is undefined.
+ * @param[in] num_blits Number of entries in @p blits.
+ *
+ * @param[in] blits Operations to perform.
  *
  * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p blits is NULL while
+ * @p num_blits is not 0, an entry has an unknown operation, an invalid image
+ * or a NULL pointer it requires, or the images do not all belong to the same
+ * agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The runtime failed to allocate
+ * the resources required by the operations.
  */
-hsa_status_t HSA_API
-    hsa_amd_memory_pool_get_info(hsa_amd_memory_pool_t memory_pool,
-                                 hsa_amd_memory_pool_info_t attribute,
-                                 void* value);
+hsa_status_t HSA_API hsa_amd_image_blit(hsa_agent_t agent, uint32_t num_blits,
+                                        const hsa_amd_image_blit_t* blits);
 
 /**
- * @brief Iterate over the memory pools associated with a given agent, and
- * invoke an application-defined callback on every iteration.
+ * @brief Asynchronous version of ::hsa_amd_image_blit.
  *
- * @details An agent can directly access buffers located in some memory pool, or
- * be enabled to access them by the application (see ::hsa_amd_agents_allow_access),
- * yet that memory pool may not be returned by this function for that given
- * agent.
+ * @details The operations are queued once all dependent signals dropped to
+ * zero and the call returns without waiting for them. The operations share the
+ * agent's image blit queue, so image operations issued later to the same agent
+ * also wait for @p dep_signals. Imports and exports of
+ * ::HSA_EXT_IMAGE_GEOMETRY_1DB images are not supported.
  *
- * A memory pool of fine-grained type must be associated only with the host.
+ * @param[in] agent Agent owning all images in @p blits.
  *
- * @param[in] agent A valid agent.
+ * @param[in] num_blits Number of entries in @p blits.
  *
- * @param[in] callback Callback to be invoked on the same thread that called
- * ::hsa_amd_agent_iterate_memory_pools, serially, once per memory pool that is
- * associated with the agent.  The HSA runtime passes two arguments to the
- * callback: the memory pool, and the application data.  If @p callback
- * returns a status other than ::HSA_STATUS_SUCCESS for a particular iteration,
- * the traversal stops and ::hsa_amd_agent_iterate_memory_pools returns that status
- * value.
+ * @param[in] blits Operations to perform. The list may be released once the
+ * call returned, the memory accessed by the operations may not.
  *
- * @param[in] data Application data that is passed to @p callback on every
- * iteration. May be NULL.
+ * @param[in] num_dep_signals Number of signals in @p dep_signals.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * operation starts.
+ *
+ * @param[in] completion_signal Signal decremented by one once the operation
+ * finished. The application may not assume the result is visible before the
+ * signal is decremented.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The operation has been queued successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The agent is invalid.
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p callback is NULL.
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The runtime failed to allocate
+ * the resources required by the operation.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p blits is NULL while
+ * @p num_blits is not 0, @p dep_signals is NULL while @p num_dep_signals is not
+ * 0, an entry is invalid as described in ::hsa_amd_image_blit or imports or
+ * exports a ::HSA_EXT_IMAGE_GEOMETRY_1DB image.
  */
-hsa_status_t HSA_API hsa_amd_agent_iterate_memory_pools(
-    hsa_agent_t agent,
-    hsa_status_t (*callback)(hsa_amd_memory_pool_t memory_pool, void* data),
-    void* data);
+hsa_status_t HSA_API hsa_amd_image_blit_async(hsa_agent_t agent, uint32_t num_blits,
+                                              const hsa_amd_image_blit_t* blits,
+                                              uint32_t num_dep_signals,
+                                              const hsa_signal_t* dep_signals,
+                                              hsa_signal_t completion_signal);
 
 /**
- * @brief Allocate a block of memory (or buffer) in the specified pool.
+ * @brief Asynchronous version of ::hsa_ext_image_import.
  *
- * @param[in] memory_pool Memory pool where to allocate memory from. The memory
- * pool must have the ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED flag set.
+ * @details See ::hsa_amd_image_blit_async for ordering and restrictions.
  *
- * @param[in] size Allocation size, in bytes. Must not be zero. This value is
- * rounded up to the nearest multiple of
- * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE in @p memory_pool.
+ * @param[in] agent Agent owning @p dst_image.
  *
- * @param[in] flags A bit-field that is used to specify allocation
- * directives.
+ * @param[in] src_memory Source memory, which must stay valid until
+ * @p completion_signal is decremented.
  *
- * @param[out] ptr Pointer to the location where to store the base virtual
- * address of
- * the allocated block. The returned base address is aligned to the value of
- * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALIGNMENT in @p memory_pool. If the
- * allocation fails, the returned value is undefined.
+ * @param[in] src_row_pitch Row pitch of @p src_memory in bytes, 0 if packed.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ * @param[in] src_slice_pitch Slice pitch of @p src_memory in bytes, 0 if packed.
  *
- * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
- * initialized.
+ * @param[in] dst_image Destination image.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES No memory is available.
+ * @param[in] image_region Region of @p dst_image written.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL The memory pool is invalid.
+ * @param[in] num_dep_signals Number of signals in @p dep_signals.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION The host is not allowed to
- * allocate memory in @p memory_pool, or @p size is greater than
- * the value of HSA_AMD_MEMORY_POOL_INFO_ALLOC_MAX_SIZE in @p memory_pool.
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * operation starts.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is NULL, or @p size is 0,
- * or flags is not 0.
+ * @param[in] completion_signal Signal decremented by one once the operation
+ * finished. The application may not assume the result is visible before the
+ * signal is decremented.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The operation has been queued successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid.
  *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The runtime failed to allocate
+ * the resources required by the operation.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p src_memory or
+ * @p image_region is NULL, or @p dst_image is a ::HSA_EXT_IMAGE_GEOMETRY_1DB
+ * image.
  */
-hsa_status_t HSA_API
-    hsa_amd_memory_pool_allocate(hsa_amd_memory_pool_t memory_pool, size_t size,
-                                 uint32_t flags, void** ptr);
+hsa_status_t HSA_API hsa_amd_image_import_async(hsa_agent_t agent, const void* src_memory,
+                                                size_t src_row_pitch, size_t src_slice_pitch,
+                                                hsa_ext_image_t dst_image,
+                                                const hsa_ext_image_region_t* image_region,
+                                                uint32_t num_dep_signals,
+                                                const hsa_signal_t* dep_signals,
+                                                hsa_signal_t completion_signal);
 
 /**
- * @brief Deallocate a block of memory previously allocated using
- * ::hsa_amd_memory_pool_allocate.
+ * @brief Asynchronous version of ::hsa_ext_image_export.
  *
- * @param[in] ptr Pointer to a memory block. If @p ptr does not match a value
- * previously returned by ::hsa_amd_memory_pool_allocate, the behavior is undefined.
+ * @details See ::hsa_amd_image_blit_async for ordering and restrictions.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ * @param[in] agent Agent owning @p src_image.
+ *
+ * @param[in] src_image Source image.
+ *
+ * @param[in] dst_memory Destination memory, which must stay valid until
+ * @p completion_signal is decremented.
+ *
+ * @param[in] dst_row_pitch Row pitch of @p dst_memory in bytes, 0 if packed.
+ *
+ * @param[in] dst_slice_pitch Slice pitch of @p dst_memory in bytes, 0 if packed.
+ *
+ * @param[in] image_region Region of @p src_image read.
+ *
+ * @param[in] num_dep_signals Number of signals in @p dep_signals.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * operation starts.
+ *
+ * @param[in] completion_signal Signal decremented by one once the operation
+ * finished. The application may not assume the result is visible before the
+ * signal is decremented.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The operation has been queued successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The runtime failed to allocate
+ * the resources required by the operation.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p dst_memory or
+ * @p image_region is NULL, or @p src_image is a ::HSA_EXT_IMAGE_GEOMETRY_1DB
+ * image.
  */
-hsa_status_t HSA_API hsa_amd_memory_pool_free(void* ptr);
+hsa_status_t HSA_API hsa_amd_image_export_async(hsa_agent_t agent, hsa_ext_image_t src_image,
+                                                void* dst_memory, size_t dst_row_pitch,
+                                                size_t dst_slice_pitch,
+                                                const hsa_ext_image_region_t* image_region,
+                                                uint32_t num_dep_signals,
+                                                const hsa_signal_t* dep_signals,
+                                                hsa_signal_t completion_signal);
 
 /**
- * @brief Asynchronously copy a block of memory from the location pointed to by
- * @p src on the @p src_agent to the memory block pointed to by @p dst on the @p
- * dst_agent.
- * Because the DMA engines used may not be in the same coherency domain, the caller must ensure
- * that buffers are system-level coherent. In general this requires the sending device to have
- * released the buffer to system scope prior to executing the copy API and the receiving device
- * must execute a system scope acquire fence prior to use of the destination buffer.
+ * @brief Asynchronous version of ::hsa_ext_image_copy.
  *
- * @param[out] dst Buffer where the content is to be copied.
+ * @details See ::hsa_amd_image_blit_async for ordering.
  *
- * @param[in] dst_agent Agent associated with the @p dst. The agent must be able to directly
- * access both the source and destination buffers in their current locations.
- * May be zero in which case the runtime will attempt to discover the destination agent.
- * Discovery may have variable and/or high latency.
+ * @param[in] agent Agent owning both images.
  *
- * @param[in] src A valid pointer to the source of data to be copied. The source
- * buffer must not overlap with the destination buffer, otherwise the copy will succeed
- * but contents of @p dst is undefined.
+ * @param[in] src_image Source image.
  *
- * @param[in] src_agent Agent associated with the @p src. The agent must be able to directly
- * access both the source and destination buffers in their current locations.
- * May be zero in which case the runtime will attempt to discover the destination agent.
- * Discovery may have variable and/or high latency.
+ * @param[in] src_offset Offset within @p src_image.
  *
- * @param[in] size Number of bytes to copy. If @p size is 0, no copy is
- * performed and the function returns success. Copying a number of bytes larger
- * than the size of the buffers pointed by @p dst or @p src results in undefined
- * behavior.
+ * @param[in] dst_image Destination image.
  *
- * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ * @param[in] dst_offset Offset within @p dst_image.
  *
- * @param[in] dep_signals List of signals that must be waited on before the copy
- * operation starts. The copy will start after every signal has been observed with
- * the value 0. The dependent signal should not include completion signal from
- * hsa_amd_memory_async_copy operation to be issued in future as that can result
- * in a deadlock. If @p num_dep_signals is 0, this argument is ignored.
+ * @param[in] range Dimensions of the copied block.
  *
- * @param[in] completion_signal Signal used to indicate completion of the copy
- * operation. When the copy operation is finished, the value of the signal is
- * decremented. The runtime indicates that an error has occurred during the copy
- * operation by setting the value of the completion signal to a negative
- * number. The signal handle must not be 0.
+ * @param[in] num_dep_signals Number of signals in @p dep_signals.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully. The
- * application is responsible for checking for asynchronous error conditions
- * (see the description of @p completion_signal).
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * operation starts.
+ *
+ * @param[in] completion_signal Signal decremented by one once the operation
+ * finished. The application may not assume the result is visible before the
+ * signal is decremented.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The operation has been queued successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent is invalid or no discovered agent has access.
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid.
  *
  * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT The source or destination
- * pointers are NULL, or the completion signal is 0.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The runtime failed to allocate
+ * the resources required by the operation.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p src_offset, @p dst_offset or
+ * @p range is NULL.
  */
-hsa_status_t HSA_API
-    hsa_amd_memory_async_copy(void* dst, hsa_agent_t dst_agent, const void* src,
-                              hsa_agent_t src_agent, size_t size,
-                              uint32_t num_dep_signals,
-                              const hsa_signal_t* dep_signals,
-                              hsa_signal_t completion_signal);
+hsa_status_t HSA_API hsa_amd_image_copy_async(hsa_agent_t agent, hsa_ext_image_t src_image,
+                                              const hsa_dim3_t* src_offset,
+                                              hsa_ext_image_t dst_image,
+                                              const hsa_dim3_t* dst_offset,
+                                              const hsa_dim3_t* range,
+                                              uint32_t num_dep_signals,
+                                              const hsa_signal_t* dep_signals,
+                                              hsa_signal_t completion_signal);
 
 /**
- * @brief Asynchronously copy a block of memory from the location pointed to by
- * @p src on the @p src_agent to the memory block pointed to by @p dst on the @p
- * dst_agent on engine_id.
+ * @brief Asynchronous version of ::hsa_ext_image_clear.
  *
- * WARNING: Concurrent use of this call with hsa_amd_memory_async_copy can result
- * in resource conflicts as HSA runtime will auto assign engines with the latter
- * call.  Approach using both calls concurrently with caution.
+ * @details See ::hsa_amd_image_blit_async for ordering.
  *
- * All param definitions are identical to hsa_amd_memory_async_copy with the
- * exception of engine_id and force_copy_on_sdma.
+ * @param[in] agent Agent owning @p image.
  *
- * @param[in] - engine_id Target engine defined by hsa_amd_sdma_engine_id_t.
- * Client should use hsa_amd_memory_copy_engine_status first to get the ID
- * availability.
+ * @param[in] image Image to clear.
  *
- * @param[in] - force_copy_on_sdma By default, blit kernel copies are used when
- * dst_agent == src_agent.  Setting this to true will force the copy over SDMA1.
+ * @param[in] data Clear pattern, copied before the call returns.
  *
- * All return definitions are identical to hsa_amd_memory_async_copy with the
- * following ammendments:
+ * @param[in] image_region Region of @p image cleared.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT The source or destination
- * pointers are NULL, or the completion signal is 0 or engine_id is improperly
- * bounded.
+ * @param[in] num_dep_signals Number of signals in @p dep_signals.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * operation starts.
+ *
+ * @param[in] completion_signal Signal decremented by one once the operation
+ * finished. The application may not assume the result is visible before the
+ * signal is decremented.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The operation has been queued successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The runtime failed to allocate
+ * the resources required by the operation.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p data or @p image_region is
+ * NULL.
  */
-hsa_status_t HSA_API
-    hsa_amd_memory_async_copy_on_engine(void* dst, hsa_agent_t dst_agent, const void* src,
-                              hsa_agent_t src_agent, size_t size,
-                              uint32_t num_dep_signals,
-                              const hsa_signal_t* dep_signals,
-                              hsa_signal_t completion_signal,
-                              hsa_amd_sdma_engine_id_t engine_id,
-                              bool force_copy_on_sdma);
+hsa_status_t HSA_API hsa_amd_image_clear_async(hsa_agent_t agent, hsa_ext_image_t image,
+                                               const void* data,
+                                               const hsa_ext_image_region_t* image_region,
+                                               uint32_t num_dep_signals,
+                                               const hsa_signal_t* dep_signals,
+                                               hsa_signal_t completion_signal);
+
 /**
- * @brief Reports the availability of SDMA copy engines.
+ * @brief Creates a list of images, as ::hsa_ext_image_create does for each of them.
  *
- * @param[in] dst_agent Destination agent of copy status direction.
+ * @details Image objects are carved from per agent slabs, which the call grows
+ * once for the whole list. Either all images are created or none.
  *
- * @param[in] src_agent Source agent of copy status direction.
+ * @param[in] agent Agent to be associated with the images.
  *
- * @param[out] engine_ids_mask returns available SDMA engine IDs that can be masked
- * with hsa_amd_sdma_engine_id_t.
+ * @param[in] num_images Number of images to create.
  *
- * @retval ::HSA_STATUS_SUCCESS Agent has available SDMA engines.
+ * @param[in] image_descriptors Array of @p num_images image descriptors.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Agent does not have available SDMA engines.
+ * @param[in] image_data Array of @p num_images image backing stores, laid out
+ * as described by ::hsa_ext_image_data_get_info.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_AGENT dst_agent and src_agent are the same as
- * dst_agent == src_agent is generally used for shader copies.
+ * @param[in] access_permission Access permission of all images.
+ *
+ * @param[out] images Array of @p num_images receiving the created images.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p image_descriptors,
+ * @p image_data or @p images is NULL while @p num_images is not 0, or an entry
+ * of @p image_data is NULL or misaligned.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The runtime failed to allocate
+ * the image objects.
+ *
+ * @retval ::HSA_EXT_STATUS_ERROR_IMAGE_FORMAT_UNSUPPORTED A descriptor has a
+ * format the agent does not support.
+ *
+ * @retval ::HSA_EXT_STATUS_ERROR_IMAGE_SIZE_UNSUPPORTED A descriptor exceeds
+ * the dimensions the agent supports.
  */
-hsa_status_t HSA_API
-    hsa_amd_memory_copy_engine_status(hsa_agent_t dst_agent, hsa_agent_t src_agent,
-                                      uint32_t *engine_ids_mask);
-
-/*
-[Provisional API]
-Pitched memory descriptor.
-All elements must be 4 byte aligned.  Pitch and slice are in bytes.
-*/
-typedef struct hsa_pitched_ptr_s {
-  void* base;
-  size_t pitch;
-  size_t slice;
-} hsa_pitched_ptr_t;
+hsa_status_t HSA_API hsa_amd_image_create_batch(hsa_agent_t agent, uint32_t num_images,
+                                                const hsa_ext_image_descriptor_t* image_descriptors,
+                                                const void* const* image_data,
+                                                hsa_access_permission_t access_permission,
+                                                hsa_ext_image_t* images);
 
-/*
-[Provisional API]
-Copy direction flag.
-*/
-typedef enum {
-  hsaHostToHost = 0,
-  hsaHostToDevice = 1,
-  hsaDeviceToHost = 2,
-  hsaDeviceToDevice = 3
-} hsa_amd_copy_direction_t;
+/** @} */
 
-/*
-[Provisional API]
-SDMA 3D memory copy API.  The same requirements must be met by src and dst as in
-hsa_amd_memory_async_copy.
-Both src and dst must be directly accessible to the copy_agent during the copy, src and dst rects
-must not overlap.
-CPU agents are not supported.  API requires SDMA and will return an error if SDMA is not available.
-Offsets and range carry x in bytes, y and z in rows and layers.
-*/
-hsa_status_t HSA_API hsa_amd_memory_async_copy_rect(
-    const hsa_pitched_ptr_t* dst, const hsa_dim3_t* dst_offset, const hsa_pitched_ptr_t* src,
-    const hsa_dim3_t* src_offset, const hsa_dim3_t* range, hsa_agent_t copy_agent,
-    hsa_amd_copy_direction_t dir, uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
-    hsa_signal_t completion_signal);
+/** \addtogroup queue Queues
+ *  @{
+ */
 
 /**
- * @brief Type of accesses to a memory pool from a given agent.
+ * @brief Set a queue's CU affinity mask.
+ *
+ * @details Enables the queue to run on only selected CUs.  The given mask is
+ * combined by bitwise AND with any device wide mask in HSA_CU_MASK before
+ * being applied.
+ * If num_cu_mask_count is 0 then the request is interpreted as a request to
+ * enable all CUs and no cu_mask array need be given.
+ *
+ * @param[in] queue A pointer to HSA queue.
+ *
+ * @param[in] num_cu_mask_count Size of CUMask bit array passed in, in bits.
+ *
+ * @param[in] cu_mask Bit-vector representing the CU mask.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_CU_MASK_REDUCED The function was successfully executed
+ * but the given mask attempted to enable a CU which was disabled by
+ * HSA_CU_MASK.  CUs disabled by HSA_CU_MASK remain disabled.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is NULL or invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_cu_mask_count is not
+ * a multiple of 32 or @p num_cu_mask_count is not 0 and cu_mask is NULL.
+ * Devices with work group processors must even-index contiguous pairwise
+ * CU enable e.g. 0x33(b'110011) is valid while 0x5(0x101) and 0x6(b'0110)
+ * are invalid.
+ *
  */
-typedef enum {
-  /**
-  * The agent cannot directly access any buffer in the memory pool.
-  */
-  HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED = 0,
-  /**
-  * The agent can directly access a buffer located in the pool; the application
-  * does not need to invoke ::hsa_amd_agents_allow_access.
-  */
-  HSA_AMD_MEMORY_POOL_ACCESS_ALLOWED_BY_DEFAULT = 1,
-  /**
-  * The agent can directly access a buffer located in the pool, but only if the
-  * application has previously requested access to that buffer using
-  * ::hsa_amd_agents_allow_access.
-  */
-  HSA_AMD_MEMORY_POOL_ACCESS_DISALLOWED_BY_DEFAULT = 2
-} hsa_amd_memory_pool_access_t;
+hsa_status_t HSA_API hsa_amd_queue_cu_set_mask(const hsa_queue_t* queue,
+                                               uint32_t num_cu_mask_count,
+                                               const uint32_t* cu_mask);
 
 /**
- * @brief Properties of the relationship between an agent a memory pool.
+ * @brief Retrieve a queue's CU affinity mask.
+ *
+ * @details Returns the first num_cu_mask_count bits of a queue's CU mask.
+ * Ensure that num_cu_mask_count is at least as large as
+ * HSA_AMD_AGENT_INFO_COMPUTE_UNIT_COUNT to retrieve the entire mask.
+ *
+ * @param[in] queue A pointer to HSA queue.
+ *
+ * @param[in] num_cu_mask_count Size of CUMask bit array passed in, in bits.
+ *
+ * @param[out] cu_mask Bit-vector representing the CU mask.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is NULL or invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_cu_mask_count is 0, not
+ * a multiple of 32 or @p cu_mask is NULL.
+ *
  */
-typedef enum {
-  /**
-  * Hyper-transport bus type.
-  */
-  HSA_AMD_LINK_INFO_TYPE_HYPERTRANSPORT = 0,
-
-  /**
-  * QPI bus type.
-  */
-  HSA_AMD_LINK_INFO_TYPE_QPI = 1,
-
-  /**
-  * PCIe bus type.
-  */
-  HSA_AMD_LINK_INFO_TYPE_PCIE = 2,
-
-  /**
-  * Infiniband bus type.
-  */
-  HSA_AMD_LINK_INFO_TYPE_INFINBAND = 3,
-
-  /**
-  * xGMI link type.
-  */
-  HSA_AMD_LINK_INFO_TYPE_XGMI = 4
-
-} hsa_amd_link_info_type_t;
-
-/**
- * @brief Link properties when accessing the memory pool from the specified
- * agent.
- */
-typedef struct hsa_amd_memory_pool_link_info_s {
-  /**
-  * Minimum transfer latency (rounded to ns).
-  */
-  uint32_t min_latency;
-
-  /**
-  * Maximum transfer latency (rounded to ns).
-  */
-  uint32_t max_latency;
-
-  /**
-  * Minimum link interface bandwidth in MB/s.
-  */
-  uint32_t min_bandwidth;
-
-  /**
-  * Maximum link interface bandwidth in MB/s.
-  */
-  uint32_t max_bandwidth;
-
-  /**
-  * Support for 32-bit atomic transactions.
-  */
-  bool atomic_support_32bit;
-
-  /**
-  * Support for 64-bit atomic transactions.
-  */
-  bool atomic_support_64bit;
-
-  /**
-  * Support for cache coherent transactions.
-  */
-  bool coherent_support;
-
-  /**
-  * The type of bus/link.
-  */
-  hsa_amd_link_info_type_t link_type;
-
-  /**
-   * NUMA distance of memory pool relative to querying agent
-   */
-  uint32_t numa_distance;
-} hsa_amd_memory_pool_link_info_t;
-
-/**
- * @brief Properties of the relationship between an agent a memory pool.
- */
-typedef enum {
-  /**
-  * Access to buffers located in the memory pool. The type of this attribute
-  * is ::hsa_amd_memory_pool_access_t.
-  *
-  * An agent can always directly access buffers currently located in a memory
-  * pool that is associated (the memory_pool is one of the values returned by
-  * ::hsa_amd_agent_iterate_memory_pools on the agent) with that agent. If the
-  * buffer is currently located in a memory pool that is not associated with
-  * the agent, and the value returned by this function for the given
-  * combination of agent and memory pool is not
-  * HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED, the application still needs to invoke
-  * ::hsa_amd_agents_allow_access in order to gain direct access to the buffer.
-  *
-  * If the given agent can directly access buffers the pool, the result is not
-  * HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED. If the memory pool is associated with
-  * the agent, or it is of fined-grained type, the result must not be
-  * HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED. If the memory pool is not associated
-  * with the agent, and does not reside in the global segment, the result must
-  * be HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED.
-  */
-  HSA_AMD_AGENT_MEMORY_POOL_INFO_ACCESS = 0,
-
-  /**
-  * Number of links to hop when accessing the memory pool from the specified
-  * agent. The value of this attribute is zero if the memory pool is associated
-  * with the agent, or if the access type is
-  * HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED. The type of this attribute is
-  * uint32_t.
-  */
-  HSA_AMD_AGENT_MEMORY_POOL_INFO_NUM_LINK_HOPS = 1,
-
-  /**
-  * Details of each link hop when accessing the memory pool starting from the
-  * specified agent. The type of this attribute is an array size of
-  * HSA_AMD_AGENT_MEMORY_POOL_INFO_NUM_LINK_HOPS with each element containing
-  * ::hsa_amd_memory_pool_link_info_t.
-  */
-  HSA_AMD_AGENT_MEMORY_POOL_INFO_LINK_INFO = 2
-
-} hsa_amd_agent_memory_pool_info_t;
+hsa_status_t HSA_API hsa_amd_queue_cu_get_mask(const hsa_queue_t* queue, uint32_t num_cu_mask_count,
+                                               uint32_t* cu_mask);
 
 /**
- * @brief Get the current value of an attribute of the relationship between an
- * agent and a memory pool.
+ * @brief Set the CU mask of the dispatches that follow in a queue.
  *
- * @param[in] agent Agent.
+ * @details Places a packet in the queue that narrows the CUs used by packets
+ * submitted after it, without the KFD call ::hsa_amd_queue_cu_set_mask makes.
+ * The packet takes a queue slot and is ordered with the queue's other packets,
+ * so a latency critical kernel can be given dedicated CUs for its dispatch and
+ * the queue returned to its full mask afterwards.  Waves of earlier dispatches
+ * that launch after the packet is processed also follow the new mask.
  *
- * @param[in] memory_pool Memory pool.
+ * The mask is intersected with the queue's CU mask.  It lasts until the next
+ * call, or until the queue's CU mask is changed with
+ * ::hsa_amd_queue_cu_set_mask.  When the scheduler preempts and restores the
+ * queue, the queue's CU mask applies again, so the override is a placement
+ * hint rather than an isolation guarantee.
  *
- * @param[in] attribute Attribute to query.
+ * @param[in] queue A pointer to HSA queue.
  *
- * @param[out] value Pointer to a application-allocated buffer where to store
- * the value of the attribute. If the buffer passed by the application is not
- * large enough to hold the value of @p attribute, the behavior is undefined.
+ * @param[in] num_cu_mask_count Size of the CU mask bit array passed in, in
+ * bits, a multiple of 32.  0 returns the following dispatches to the queue's
+ * CU mask.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ * @param[in] cu_mask Bit-vector representing the CU mask, numbered as for
+ * ::hsa_amd_queue_cu_set_mask.
  *
- */
-hsa_status_t HSA_API hsa_amd_agent_memory_pool_get_info(
-    hsa_agent_t agent, hsa_amd_memory_pool_t memory_pool,
-    hsa_amd_agent_memory_pool_info_t attribute, void* value);
-
-/**
- * @brief Enable direct access to a buffer from a given set of agents.
+ * @retval ::HSA_STATUS_SUCCESS The packet has been submitted.
  *
- * @details
+ * @retval ::HSA_STATUS_CU_MASK_REDUCED The packet has been submitted but the
+ * mask was reduced to CUs of the queue's CU mask.
  *
- * Upon return, only the listed agents and the agent associated with the
- * buffer's memory pool have direct access to the @p ptr.
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * Any agent that has access to the buffer before and after the call to
- * ::hsa_amd_agents_allow_access will also have access while
- * ::hsa_amd_agents_allow_access is in progress.
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is NULL, invalid or not a
+ * GPU queue.
  *
- * The caller is responsible for ensuring that each agent in the list
- * must be able to access the memory pool containing @p ptr
- * (using ::hsa_amd_agent_memory_pool_get_info with ::HSA_AMD_AGENT_MEMORY_POOL_INFO_ACCESS attribute),
- * otherwise error code is returned.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_cu_mask_count is not a
+ * multiple of 32, @p cu_mask is NULL, the mask leaves no CU of the queue's
+ * mask enabled, or it enables half of a WGP.
  *
- * @param[in] num_agents Size of @p agents.
+ * @retval ::HSA_STATUS_ERROR The agent's shader engine layout cannot be
+ * programmed from the queue; use ::hsa_amd_queue_cu_set_mask instead.
+ */
+hsa_status_t HSA_API hsa_amd_queue_cu_set_dispatch_mask(const hsa_queue_t* queue,
+                                                        uint32_t num_cu_mask_count,
+                                                        const uint32_t* cu_mask);
+
+/**
+ * @brief Opaque handle to a set of CU partitions.
+ */
+typedef struct hsa_amd_cu_partitions_s {
+  uint64_t handle;
+} hsa_amd_cu_partitions_t;
+
+/**
+ * @brief Partition index that unbinds a queue from its partition.
+ */
+#define HSA_AMD_CU_PARTITION_NONE UINT32_MAX
+
+/**
+ * @brief Split a GPU agent's compute units into disjoint partitions.
  *
- * @param[in] agents List of agents. If @p num_agents is 0, this argument is
- * ignored.
+ * @details Queues bound to a partition run only on its CUs, so work on
+ * different partitions does not compete for CUs.  CUs are handed out in
+ * slices of one CU per shader array; every partition gets whole slices and
+ * so spans all shader engines of the agent.  Partitions start out with an
+ * equal share of slices.
  *
- * @param[in] flags A list of bit-field that is used to specify access
- * information in a per-agent basis. This is currently reserved and must be NULL.
+ * @param[in] agent GPU agent.
  *
- * @param[in] ptr A buffer previously allocated using ::hsa_amd_memory_pool_allocate.
+ * @param[in] num_partitions Number of partitions, at least 1 and at most the
+ * number of CUs divided by the number of shader arrays.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ * @param[out] partitions Handle of the new partitions.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The partitions have been created.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_agents is 0, or @p agents
- * is NULL, @p flags is not NULL, or attempting to enable access to agent(s)
- * because @p ptr is allocated from an inaccessible pool.
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is invalid or not a GPU.
  *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_partitions is out of
+ * range or @p partitions is NULL.
  */
-hsa_status_t HSA_API
-    hsa_amd_agents_allow_access(uint32_t num_agents, const hsa_agent_t* agents,
-                                const uint32_t* flags, const void* ptr);
+hsa_status_t HSA_API hsa_amd_cu_partitions_create(hsa_agent_t agent, uint32_t num_partitions,
+                                                  hsa_amd_cu_partitions_t* partitions);
 
 /**
- * @brief Query if buffers currently located in some memory pool can be
- * relocated to a destination memory pool.
+ * @brief Restrict a queue to a CU partition.
  *
- * @details If the returned value is non-zero, a migration of a buffer to @p
- * dst_memory_pool using ::hsa_amd_memory_migrate may nevertheless fail due to
- * resource limitations.
+ * @details Replaces the queue's CU mask with the partition's CUs, as
+ * ::hsa_amd_queue_cu_set_mask would, and keeps it in step when the partition
+ * is resized.  Binding an already bound queue moves it.  Passing
+ * ::HSA_AMD_CU_PARTITION_NONE unbinds the queue and gives it the whole agent
+ * again.  Queues must be unbound before they are destroyed.
  *
- * @param[in] src_memory_pool Source memory pool.
+ * @param[in] partitions Partitions created on the queue's agent.
  *
- * @param[in] dst_memory_pool Destination memory pool.
+ * @param[in] queue Queue to bind.
  *
- * @param[out] result Pointer to a memory location where the result of the query
- * is stored. Must not be NULL. If buffers currently located in @p
- * src_memory_pool can be relocated to @p dst_memory_pool, the result is
- * true.
+ * @param[in] index Partition index or ::HSA_AMD_CU_PARTITION_NONE.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ * @retval ::HSA_STATUS_SUCCESS The queue's CU mask has been updated.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL One of the memory pools is
- * invalid.
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is NULL or invalid.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p result is NULL.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p partitions is invalid or
+ * @p index is out of range.
  */
-hsa_status_t HSA_API
-    hsa_amd_memory_pool_can_migrate(hsa_amd_memory_pool_t src_memory_pool,
-                                    hsa_amd_memory_pool_t dst_memory_pool,
-                                    bool* result);
+hsa_status_t HSA_API hsa_amd_cu_partitions_bind_queue(hsa_amd_cu_partitions_t partitions,
+                                                      hsa_queue_t* queue, uint32_t index);
 
 /**
- * @brief Relocate a buffer to a new memory pool.
- *
- * @details When a buffer is migrated, its virtual address remains the same but
- * its physical contents are moved to the indicated memory pool.
- *
- * After migration, only the agent associated with the destination pool will have access.
- *
- * The caller is also responsible for ensuring that the allocation in the
- * source memory pool where the buffer is currently located can be migrated to the
- * specified destination memory pool (using ::hsa_amd_memory_pool_can_migrate returns a value of true
- * for the source and destination memory pools), otherwise behavior is undefined.
- *
- * The caller must ensure that the buffer is not accessed while it is migrated.
- *
- * @param[in] ptr Buffer to be relocated. The buffer must have been released to system
- * prior to call this API.  The buffer will be released to system upon completion.
+ * @brief Resize CU partitions to follow their load.
  *
- * @param[in] memory_pool Memory pool where to place the buffer.
+ * @details Every partition keeps at least one slice; the remaining slices are
+ * shared out in proportion to the packets outstanding on each partition's
+ * bound queues.  Only queues whose partition changed get a new CU mask.
+ * Without outstanding packets the partitions are left as they are.  Intended
+ * to be called periodically by a scheduler.
  *
- * @param[in] flags A bit-field that is used to specify migration
- * information. Must be zero.
+ * @param[in] partitions Partitions to resize.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ * @retval ::HSA_STATUS_SUCCESS The partitions have been resized.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL The destination memory pool is
- * invalid.
- *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES There is a failure in
- * allocating the necessary resources.
- *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p flags is not 0.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p partitions is invalid.
  */
-hsa_status_t HSA_API hsa_amd_memory_migrate(const void* ptr,
-                                            hsa_amd_memory_pool_t memory_pool,
-                                            uint32_t flags);
+hsa_status_t HSA_API hsa_amd_cu_partitions_rebalance(hsa_amd_cu_partitions_t partitions);
 
 /**
+ * @brief Destroy CU partitions.
  *
- * @brief Pin a host pointer allocated by C/C++ or OS allocator (i.e. ordinary system DRAM) and
- * return a new pointer accessible by the @p agents. If the @p host_ptr overlaps with previously
- * locked memory, then the overlap area is kept locked (i.e multiple mappings are permitted). In
- * this case, the same input @p host_ptr may give different locked @p agent_ptr and when it does,
- * they are not necessarily coherent (i.e. accessing either @p agent_ptr is not equivalent).
- * Accesses to @p agent_ptr are coarse grained.
- *
- * @param[in] host_ptr A buffer allocated by C/C++ or OS allocator.
- *
- * @param[in] size The size to be locked.
- *
- * @param[in] agents Array of agent handle to gain access to the @p host_ptr.
- * If this parameter is NULL and the @p num_agent is 0, all agents
- * in the platform will gain access to the @p host_ptr.
+ * @details Queues still bound get the whole agent back.
  *
- * @param[out] agent_ptr Pointer to the location where to store the new address.
+ * @param[in] partitions Partitions to destroy.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ * @retval ::HSA_STATUS_SUCCESS The partitions have been destroyed.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES There is a failure in
- * allocating the necessary resources.
- *
- * @retval ::HSA_STATUS_ERROR_INVALID_AGENT One or more agent in @p agents is
- * invalid.
- *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p size is 0 or @p host_ptr or
- * @p agent_ptr is NULL or @p agents not NULL but @p num_agent is 0 or @p agents
- * is NULL but @p num_agent is not 0.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p partitions is invalid.
  */
-hsa_status_t HSA_API hsa_amd_memory_lock(void* host_ptr, size_t size,
-                                         hsa_agent_t* agents, int num_agent,
-                                         void** agent_ptr);
+hsa_status_t HSA_API hsa_amd_cu_partitions_destroy(hsa_amd_cu_partitions_t partitions);
+
+/** @} */
+
+/** \addtogroup memory Memory
+ *  @{
+ */
+
+/**
+ * @brief Memory segments associated with a memory pool.
+ */
+typedef enum {
+  /**
+   * Global segment. Used to hold data that is shared by all agents.
+   */
+  HSA_AMD_SEGMENT_GLOBAL = 0,
+  /**
+   * Read-only segment. Used to hold data that remains constant during the
+   * execution of a kernel.
+   */
+  HSA_AMD_SEGMENT_READONLY = 1,
+  /**
+   * Private segment. Used to hold data that is local to a single work-item.
+   */
+  HSA_AMD_SEGMENT_PRIVATE = 2,
+  /**
+   * Group segment. Used to hold data that is shared by the work-items of a
+   * work-group.
+   */
+  HSA_AMD_SEGMENT_GROUP = 3,
+} hsa_amd_segment_t;
+
+/**
+ * @brief A memory pool encapsulates physical storage on an agent
+ * along with a memory access model.
+ *
+ * @details A memory pool encapsulates a physical partition of an agent's
+ * memory system along with a memory access model.  Division of a single
+ * memory system into separate pools allows querying each partition's access
+ * path properties (see ::hsa_amd_agent_memory_pool_get_info). Allocations
+ * from a pool are preferentially bound to that pool's physical partition.
+ * Binding to the pool's preferential physical partition may not be
+ * possible or persistent depending on the system's memory policy
+ * and/or state which is beyond the scope of HSA APIs.
+ *
+ * For example, a multi-node NUMA memory system may be represented by multiple
+ * pool's with each pool providing size and access path information for the
+ * partition it represents.  Allocations from a pool are preferentially bound
+ * to the pool's partition (which in this example is a NUMA node) while
+ * following its memory access model. The actual placement may vary or migrate
+ * due to the system's NUMA policy and state, which is beyond the scope of
+ * HSA APIs.
+ */ 
+typedef struct hsa_amd_memory_pool_s {
+  /**
+   * Opaque handle.
+   */
+  uint64_t handle;
+} hsa_amd_memory_pool_t;
+
+typedef enum hsa_amd_memory_pool_global_flag_s {
+  /**
+   * The application can use allocations in the memory pool to store kernel
+   * arguments, and provide the values for the kernarg segment of
+   * a kernel dispatch.
+   */
+  HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_KERNARG_INIT = 1,
+  /**
+   * Updates to memory in this pool conform to HSA memory consistency model.
+   * If this flag is set, then ::HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_COARSE_GRAINED
+   * must not be set.
+   */
+  HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_FINE_GRAINED = 2,
+  /**
+   * Writes to memory in this pool can be performed by a single agent at a time.
+   */
+  HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_COARSE_GRAINED = 4,
+
+  /** Updates to memory in this memory pool have extended scope, acting as
+   * system-scope atomics for variables in memory regions of this type.
+   * Note: On non-compliant systems, device-specific actions may be required
+   * for system-scope coherence. */
+  HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_EXTENDED_SCOPE_FINE_GRAINED = 8,
+
+} hsa_amd_memory_pool_global_flag_t;
+
+typedef enum hsa_amd_memory_pool_location_s {
+    /**
+     * This memory pool resides on the host (CPU)
+     */
+    HSA_AMD_MEMORY_POOL_LOCATION_CPU = 0,
+    /**
+     * This memory pool resides on a GPU
+     */
+    HSA_AMD_MEMORY_POOL_LOCATION_GPU = 1
+} hsa_amd_memory_pool_location_t;
+
+/**
+ * @brief Memory pool features.
+ */
+typedef enum {
+  /**
+  * Segment where the memory pool resides. The type of this attribute is
+  * ::hsa_amd_segment_t.
+  */
+  HSA_AMD_MEMORY_POOL_INFO_SEGMENT = 0,
+  /**
+  * Flag mask. The value of this attribute is undefined if the value of
+  * ::HSA_AMD_MEMORY_POOL_INFO_SEGMENT is not ::HSA_AMD_SEGMENT_GLOBAL. The type
+  * of
+  * this attribute is uint32_t, a bit-field of
+  * ::hsa_amd_memory_pool_global_flag_t
+  * values.
+  */
+  HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS = 1,
+  /**
+  * Size of this pool, in bytes. The type of this attribute is size_t.
+  */
+  HSA_AMD_MEMORY_POOL_INFO_SIZE = 2,
+  /**
+  * Indicates whether memory in this pool can be allocated using
+  * ::hsa_amd_memory_pool_allocate. The type of this attribute is bool.
+  *
+  * The value of this flag is always false for memory pools in the group and
+  * private segments.
+  */
+  HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED = 5,
+  /**
+   * Allocation granularity of buffers allocated by
+   * ::hsa_amd_memory_pool_allocate
+   * in this memory pool. The size of a buffer allocated in this pool is a
+   * multiple of the value of this attribute. While this is the minimum size of
+   * allocation allowed, it is recommened to use
+   * HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_REC_GRANULE to obtain the recommended
+   * allocation granularity size for this pool.
+   * The value of this attribute is only defined if
+   * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED is true for
+   * this pool. The type of this attribute is size_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE = 6,
+  /**
+   * Alignment of buffers allocated by ::hsa_amd_memory_pool_allocate in this
+   * pool. The value of this attribute is only defined if
+   * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED is true for this pool, and
+   * must be a power of 2. The type of this attribute is size_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALIGNMENT = 7,
+  /**
+   * This memory_pool can be made directly accessible by all the agents in the
+   * system (::hsa_amd_agent_memory_pool_get_info does not return
+   * ::HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED for any agent). The type of this
+   * attribute is bool.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_ACCESSIBLE_BY_ALL = 15,
+  /**
+   * Maximum aggregate allocation size in bytes. The type of this attribute
+   * is size_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_ALLOC_MAX_SIZE = 16,
+  /**
+   * Location of this memory pool. The type of this attribute
+   * is hsa_amd_memory_pool_location_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_LOCATION = 17,
+  /**
+   * Internal block size for allocations. This would also be the recommended
+   * granularity size for allocations as this prevents internal fragmentation.
+   * The value of this attribute is only defined if
+   * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED is true for this pool.
+   * The size of this attribute is size_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_REC_GRANULE = 18,
+  /**
+   * Number of small allocations served from a per-CPU cache of the slab
+   * allocator.  The type of this attribute is uint64_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_SLAB_CACHE_HITS = 19,
+  /**
+   * Number of small allocations which had to refill a per-CPU cache from the
+   * slab allocator.  The type of this attribute is uint64_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_SLAB_CACHE_MISSES = 20,
+  /**
+   * Bytes of the pool held by the slab allocator.  The type of this attribute
+   * is size_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_SLAB_RESERVED_SIZE = 21,
+  /**
+   * Bytes of slab allocator objects currently allocated, including rounding up
+   * to the object size.  The difference with
+   * ::HSA_AMD_MEMORY_POOL_INFO_SLAB_RESERVED_SIZE is idle slab memory.  The
+   * type of this attribute is size_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_SLAB_ALLOCATED_SIZE = 22,
+  /**
+   * Free bytes inside internal blocks which are partially in use, a measure of
+   * fragmentation.  The type of this attribute is size_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_FRAGMENT_FREE_SIZE = 23,
+  /**
+   * Bytes and number of allocations of the pool held by each usage category,
+   * see ::hsa_amd_memory_usage_category_t.  Maintained with atomic counters
+   * so the query is cheap enough to poll.  The type of this attribute is
+   * hsa_amd_memory_pool_usage_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_USAGE = 24,
+  /**
+   * Fragmentation of the internal blocks small allocations are carved from.
+   * The type of this attribute is hsa_amd_memory_pool_fragmentation_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_FRAGMENTATION = 25,
+  /**
+   * Bytes set aside by ::hsa_amd_memory_pool_reserve.  The type of this
+   * attribute is size_t.
+   */
+  HSA_AMD_MEMORY_POOL_INFO_RESERVED_SIZE = 26,
+} hsa_amd_memory_pool_info_t;
+
+/**
+ * @brief What memory of a pool is being used for, see
+ * ::HSA_AMD_MEMORY_POOL_INFO_USAGE.
+ */
+typedef enum {
+  /**
+   * Allocations made by the application with ::hsa_amd_memory_pool_allocate
+   * or ::hsa_memory_allocate.
+   */
+  HSA_AMD_MEMORY_USAGE_USER = 0,
+  /**
+   * Idle blocks kept by the fragment allocator for small allocations.  The
+   * count is the number of blocks.
+   */
+  HSA_AMD_MEMORY_USAGE_FRAGMENT_CACHE = 1,
+  /**
+   * Scratch backing mapped for queues, in use or cached.  Reported on the
+   * coarse grained device local pools of GPU agents.  The count is the number
+   * of scratch allocations.
+   */
+  HSA_AMD_MEMORY_USAGE_SCRATCH = 2,
+  /**
+   * Ring buffers of runtime created AQL and SDMA queues.
+   */
+  HSA_AMD_MEMORY_USAGE_RING_BUFFER = 3,
+  /**
+   * Kernel arguments of runtime internal dispatches.
+   */
+  HSA_AMD_MEMORY_USAGE_KERNARG = 4,
+  /**
+   * Loaded code object segments and the trap handler.
+   */
+  HSA_AMD_MEMORY_USAGE_CODE_OBJECT = 5,
+  /**
+   * Staging and bounce buffers of copy engines.
+   */
+  HSA_AMD_MEMORY_USAGE_BLIT = 6,
+  /**
+   * Other runtime allocations.
+   */
+  HSA_AMD_MEMORY_USAGE_INTERNAL = 7,
+  HSA_AMD_MEMORY_USAGE_COUNT = 8
+} hsa_amd_memory_usage_category_t;
+
+/**
+ * @brief Usage of a memory pool, indexed by ::hsa_amd_memory_usage_category_t.
+ */
+typedef struct hsa_amd_memory_pool_usage_s {
+  /**
+   * Bytes held, after rounding up to the allocation granule.
+   */
+  uint64_t bytes[HSA_AMD_MEMORY_USAGE_COUNT];
+  /**
+   * Number of allocations.
+   */
+  uint64_t count[HSA_AMD_MEMORY_USAGE_COUNT];
+} hsa_amd_memory_pool_usage_t;
+
+/**
+ * @brief Fragmentation of a memory pool, see
+ * ::HSA_AMD_MEMORY_POOL_INFO_FRAGMENTATION.
+ */
+typedef struct hsa_amd_memory_pool_fragmentation_s {
+  /**
+   * Free bytes inside internal blocks which are partially in use, same as
+   * ::HSA_AMD_MEMORY_POOL_INFO_FRAGMENT_FREE_SIZE.
+   */
+  uint64_t free_size;
+  /**
+   * Largest free range inside those blocks.  Fragmentation is high when this
+   * is small compared to free_size.
+   */
+  uint64_t largest_free_size;
+  /**
+   * Number of free ranges making up free_size.
+   */
+  uint64_t free_fragments;
+  /**
+   * Number of internal blocks which are partially in use.
+   */
+  uint64_t blocks;
+  /**
+   * Number and total size of fully free blocks kept for reuse.  See
+   * HSA_FRAGMENT_CACHE_IDLE_MS for releasing them after a period of disuse.
+   */
+  uint64_t cached_blocks;
+  uint64_t cache_size;
+} hsa_amd_memory_pool_fragmentation_t;
+
+/**
+ * @brief Memory pool flag used to specify allocation directives
+ *
+ */
+typedef enum hsa_amd_memory_pool_flag_s {
+  /**
+   * Allocates memory that conforms to standard HSA memory consistency model
+   */
+  HSA_AMD_MEMORY_POOL_STANDARD_FLAG = 0,
+  /**
+   * Allocates fine grain memory type where memory ordering is per point to point
+   * connection. Atomic memory operations on these memory buffers are not
+   * guaranteed to be visible at system scope.  Use this to get a fine grain
+   * allocation from a coarse grain pool.
+   */
+  HSA_AMD_MEMORY_POOL_PCIE_FLAG = (1 << 0),
+  /**
+   *  Allocates physically contiguous memory
+   */
+  HSA_AMD_MEMORY_POOL_CONTIGUOUS_FLAG = (1 << 1),
+  /**
+   *  Allocates executable memory
+   */
+  HSA_AMD_MEMORY_POOL_EXECUTABLE_FLAG = (1 << 2),
+  /**
+   *  Backs system memory with huge pages: 1GB pages for sizes that are a
+   *  multiple of 1GB, 2MB pages otherwise.  The size is rounded up to 2MB.
+   *  hugetlbfs pages are used when reserved, transparent huge pages otherwise.
+   *  Ignored for device local pools.
+   */
+  HSA_AMD_MEMORY_POOL_HUGEPAGE_FLAG = (1 << 3),
+  /**
+   *  Backs device local memory with physically contiguous, 2MB aligned
+   *  fragments at a 2MB aligned address so the GPU can use large page table
+   *  fragments, reducing TLB misses.  The size is rounded up to 2MB.
+   *  Contiguity is best effort.  Allocations of at least
+   *  HSA_LARGE_PAGE_THRESHOLD MB (default 256, 0 disables) get this
+   *  automatically.  Ignored for system pools.
+   */
+  HSA_AMD_MEMORY_POOL_LARGE_PAGE_FLAG = (1 << 4),
+  /**
+   *  Allocates coarse grain, fully cached memory from a fine grain pool.
+   *  Writes are only guaranteed visible to other agents at dispatch or
+   *  copy boundaries.  Suited to buffers one agent produces in bulk, such as
+   *  staging buffers carved from system memory.  Cannot be combined with
+   *  ::HSA_AMD_MEMORY_POOL_PCIE_FLAG or ::HSA_AMD_MEMORY_POOL_UNCACHED_FLAG.
+   */
+  HSA_AMD_MEMORY_POOL_COARSE_GRAIN_FLAG = (1 << 5),
+  /**
+   *  Allocates fine grain memory that the GPU does not cache, so every
+   *  access reaches memory.  Suited to small flags and mailboxes polled by
+   *  another agent.  Implies ::HSA_AMD_MEMORY_POOL_PCIE_FLAG.
+   */
+  HSA_AMD_MEMORY_POOL_UNCACHED_FLAG = (1 << 6),
+
+} hsa_amd_memory_pool_flag_t;
+
+/**
+ * @brief Get the current value of an attribute of a memory pool.
+ *
+ * @param[in] memory_pool A valid memory pool.
+ *
+ * @param[in] attribute Attribute to query.
+ *
+ * @param[out] value Pointer to a application-allocated buffer where to store
+ * the value of the attribute. If the buffer passed by the application is not
+ * large enough to hold the value of @p attribute, the behavior is undefined.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ */
+hsa_status_t HSA_API
+    hsa_amd_memory_pool_get_info(hsa_amd_memory_pool_t memory_pool,
+                                 hsa_amd_memory_pool_info_t attribute,
+                                 void* value);
+
+/**
+ * @brief Iterate over the memory pools associated with a given agent, and
+ * invoke an application-defined callback on every iteration.
+ *
+ * @details An agent can directly access buffers located in some memory pool, or
+ * be enabled to access them by the application (see ::hsa_amd_agents_allow_access),
+ * yet that memory pool may not be returned by this function for that given
+ * agent.
+ *
+ * A memory pool of fine-grained type must be associated only with the host.
+ *
+ * @param[in] agent A valid agent.
+ *
+ * @param[in] callback Callback to be invoked on the same thread that called
+ * ::hsa_amd_agent_iterate_memory_pools, serially, once per memory pool that is
+ * associated with the agent.  The HSA runtime passes two arguments to the
+ * callback: the memory pool, and the application data.  If @p callback
+ * returns a status other than ::HSA_STATUS_SUCCESS for a particular iteration,
+ * the traversal stops and ::hsa_amd_agent_iterate_memory_pools returns that status
+ * value.
+ *
+ * @param[in] data Application data that is passed to @p callback on every
+ * iteration. May be NULL.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The agent is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p callback is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_agent_iterate_memory_pools(
+    hsa_agent_t agent,
+    hsa_status_t (*callback)(hsa_amd_memory_pool_t memory_pool, void* data),
+    void* data);
+
+/**
+ * @brief Allocate a block of memory (or buffer) in the specified pool.
+ *
+ * @param[in] memory_pool Memory pool where to allocate memory from. The memory
+ * pool must have the ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED flag set.
+ *
+ * @param[in] size Allocation size, in bytes. Must not be zero. This value is
+ * rounded up to the nearest multiple of
+ * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE in @p memory_pool.
+ *
+ * @param[in] flags A bit-field that is used to specify allocation
+ * directives.
+ *
+ * @param[out] ptr Pointer to the location where to store the base virtual
+ * address of
+ * the allocated block. The returned base address is aligned to the value of
+ * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALIGNMENT in @p memory_pool. If the
+ * allocation fails, the returned value is undefined.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES No memory is available.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL The memory pool is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION The host is not allowed to
+ * allocate memory in @p memory_pool, or @p size is greater than
+ * the value of HSA_AMD_MEMORY_POOL_INFO_ALLOC_MAX_SIZE in @p memory_pool.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is NULL, or @p size is 0,
+ * or flags is not 0.
+ *
+ */
+hsa_status_t HSA_API
+    hsa_amd_memory_pool_allocate(hsa_amd_memory_pool_t memory_pool, size_t size,
+                                 uint32_t flags, void** ptr);
+
+/**
+ * @brief Deallocate a block of memory previously allocated using
+ * ::hsa_amd_memory_pool_allocate.
+ *
+ * @param[in] ptr Pointer to a memory block. If @p ptr does not match a value
+ * previously returned by ::hsa_amd_memory_pool_allocate, the behavior is undefined.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ */
+hsa_status_t HSA_API hsa_amd_memory_pool_free(void* ptr);
+
+/**
+ * @brief Allocate a block of memory in a memory pool, reusing memory released
+ * with ::hsa_amd_memory_pool_free_async.
+ *
+ * @details Behaves as ::hsa_amd_memory_pool_allocate, except that a block of
+ * the same pool and flags released with ::hsa_amd_memory_pool_free_async may
+ * be returned.  A released block is eligible once its release signal has
+ * reached 0, or immediately if its release signal is @p dep_signal.  In that
+ * case the caller must order every use of the new allocation after
+ * @p dep_signal completes, for example by passing it as a dependency of the
+ * first copy or barrier packet using the memory.  This makes allocation and
+ * release stream ordered without host synchronization.
+ *
+ * @param[in] memory_pool Memory pool where to allocate memory from.
+ *
+ * @param[in] size Allocation size, in bytes.
+ *
+ * @param[in] flags A bit-field as for ::hsa_amd_memory_pool_allocate.
+ *
+ * @param[in] dep_signal Signal the caller orders use of the allocation after.
+ * May be a signal with a handle of 0 if there is none.
+ *
+ * @param[out] ptr Pointer to the location where to store the base virtual
+ * address of the allocated block.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES No memory is available.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL The memory pool is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p dep_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is NULL, or @p size is 0.
+ */
+hsa_status_t HSA_API hsa_amd_memory_pool_allocate_async(hsa_amd_memory_pool_t memory_pool,
+                                                        size_t size, uint32_t flags,
+                                                        hsa_signal_t dep_signal, void** ptr);
+
+/**
+ * @brief Deallocate a block of memory previously allocated using
+ * ::hsa_amd_memory_pool_allocate or ::hsa_amd_memory_pool_allocate_async once
+ * the work using it has completed.
+ *
+ * @details Returns immediately.  The block is kept in a reuse cache of its
+ * pool until @p dep_signal reaches 0, after which it may be freed or handed
+ * out again by ::hsa_amd_memory_pool_allocate_async.  Before then it is only
+ * reused by allocations ordered after @p dep_signal.  Deallocation callbacks
+ * registered on the block run before this function returns.  @p dep_signal
+ * must not be reset to a non-zero value while the block is cached.
+ *
+ * The environment variable HSA_ASYNC_FREE_CACHE bounds the cache, in MB.
+ * Blocks beyond the bound are freed once their signal completes.
+ *
+ * @param[in] ptr Pointer to a memory block.
+ *
+ * @param[in] dep_signal Signal completing the last use of @p ptr.  May be a
+ * signal with a handle of 0 if the block is already idle.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p dep_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION @p ptr is not the base of a
+ * block allocated from a memory pool, or was already released.
+ */
+hsa_status_t HSA_API hsa_amd_memory_pool_free_async(void* ptr, hsa_signal_t dep_signal);
+
+/**
+ * @brief Asynchronously copy a block of memory from the location pointed to by
+ * @p src on the @p src_agent to the memory block pointed to by @p dst on the @p
+ * dst_agent.
+ * Because the DMA engines used may not be in the same coherency domain, the caller must ensure
+ * that buffers are system-level coherent. In general this requires the sending device to have
+ * released the buffer to system scope prior to executing the copy API and the receiving device
+ * must execute a system scope acquire fence prior to use of the destination buffer.
+ *
+ * @param[out] dst Buffer where the content is to be copied.
+ *
+ * @param[in] dst_agent Agent associated with the @p dst. The agent must be able to directly
+ * access both the source and destination buffers in their current locations.
+ * May be zero in which case the runtime will attempt to discover the destination agent.
+ * Discovery may have variable and/or high latency.
+ *
+ * @param[in] src A valid pointer to the source of data to be copied. The source
+ * buffer must not overlap with the destination buffer, otherwise the copy will succeed
+ * but contents of @p dst is undefined.
+ *
+ * @param[in] src_agent Agent associated with the @p src. The agent must be able to directly
+ * access both the source and destination buffers in their current locations.
+ * May be zero in which case the runtime will attempt to discover the destination agent.
+ * Discovery may have variable and/or high latency.
+ *
+ * @param[in] size Number of bytes to copy. If @p size is 0, no copy is
+ * performed and the function returns success. Copying a number of bytes larger
+ * than the size of the buffers pointed by @p dst or @p src results in undefined
+ * behavior.
+ *
+ * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the copy
+ * operation starts. The copy will start after every signal has been observed with
+ * the value 0. The dependent signal should not include completion signal from
+ * hsa_amd_memory_async_copy operation to be issued in future as that can result
+ * in a deadlock. If @p num_dep_signals is 0, this argument is ignored.
+ *
+ * @param[in] completion_signal Signal used to indicate completion of the copy
+ * operation. When the copy operation is finished, the value of the signal is
+ * decremented. The runtime indicates that an error has occurred during the copy
+ * operation by setting the value of the completion signal to a negative
+ * number. The signal handle must not be 0.  When HSA_SDMA_COALESCE_INTERRUPTS=1
+ * SDMA copies skip the completion interrupt while no thread is blocked on the
+ * signal; the value is still updated for every copy and a thread that blocks
+ * later has the interrupt sent before it sleeps.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully. The
+ * application is responsible for checking for asynchronous error conditions
+ * (see the description of @p completion_signal).
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent is invalid or no discovered agent has access.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT The source or destination
+ * pointers are NULL, or the completion signal is 0.
+ */
+hsa_status_t HSA_API
+    hsa_amd_memory_async_copy(void* dst, hsa_agent_t dst_agent, const void* src,
+                              hsa_agent_t src_agent, size_t size,
+                              uint32_t num_dep_signals,
+                              const hsa_signal_t* dep_signals,
+                              hsa_signal_t completion_signal);
+
+/**
+ * @brief Descriptor of one copy in a batch submitted with
+ * ::hsa_amd_memory_async_copy_batch.
+ */
+typedef struct hsa_amd_memory_copy_descriptor_s {
+  /**
+   * Buffer where the content is to be copied.
+   */
+  void* dst;
+  /**
+   * Source of the data to be copied.
+   */
+  const void* src;
+  /**
+   * Number of bytes to copy.  Descriptors with a size of 0 are skipped.
+   */
+  size_t size;
+} hsa_amd_memory_copy_descriptor_t;
+
+/**
+ * @brief Asynchronously copy a batch of memory blocks between the same pair of
+ * agents, signaling completion once.
+ *
+ * @details Semantically equivalent to issuing ::hsa_amd_memory_async_copy for
+ * every descriptor with the same agents and dependencies, except that
+ * @p completion_signal is decremented only once, after all copies are
+ * finished.  On SDMA engines the copies are written to the engine in a single
+ * submission, avoiding per-copy synchronization and doorbell overhead.  The
+ * coherency requirements of ::hsa_amd_memory_async_copy apply to every
+ * buffer in the batch.
+ *
+ * @param[in] copies Array of @p num_copies copy descriptors.
+ *
+ * @param[in] num_copies Number of descriptors.  Must not be 0.
+ *
+ * @param[in] dst_agent Agent associated with every destination buffer.
+ *
+ * @param[in] src_agent Agent associated with every source buffer.
+ *
+ * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * copies start.  If @p num_dep_signals is 0, this argument is ignored.
+ *
+ * @param[in] completion_signal Signal decremented once when every copy in the
+ * batch is finished.  The signal handle must not be 0.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p copies is NULL,
+ * @p num_copies is 0 or a descriptor with non-zero size has a NULL pointer.
+ */
+hsa_status_t HSA_API hsa_amd_memory_async_copy_batch(
+    const hsa_amd_memory_copy_descriptor_t* copies, uint32_t num_copies, hsa_agent_t dst_agent,
+    hsa_agent_t src_agent, uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+    hsa_signal_t completion_signal);
+
+/**
+ * @brief Descriptor of one strided block copied with
+ * ::hsa_amd_memory_async_copy_strided.
+ *
+ * @details A block is @p depth slices of @p height rows of @p width bytes.
+ * Rows start @p dst_pitch and @p src_pitch bytes apart, slices start
+ * @p dst_slice and @p src_slice bytes apart.  A single row is described with
+ * @p height and @p depth of 1, in which case pitches and slices are ignored.
+ */
+typedef struct hsa_amd_memory_copy_strided_s {
+  /**
+   * First byte of the destination block.
+   */
+  void* dst;
+  /**
+   * First byte of the source block.
+   */
+  const void* src;
+  /**
+   * Bytes per row.  Blocks with a width of 0 are skipped.
+   */
+  size_t width;
+  /**
+   * Rows per slice, at least 1.
+   */
+  size_t height;
+  /**
+   * Number of slices, at least 1.
+   */
+  size_t depth;
+  /**
+   * Bytes between the start of consecutive destination rows.
+   */
+  size_t dst_pitch;
+  /**
+   * Bytes between the start of consecutive source rows.
+   */
+  size_t src_pitch;
+  /**
+   * Bytes between the start of consecutive destination slices.
+   */
+  size_t dst_slice;
+  /**
+   * Bytes between the start of consecutive source slices.
+   */
+  size_t src_slice;
+} hsa_amd_memory_copy_strided_t;
+
+/**
+ * @brief Asynchronously copy a list of strided blocks between the same pair of
+ * agents, signaling completion once.
+ *
+ * @details Semantically equivalent to ::hsa_amd_memory_async_copy_batch with
+ * one descriptor per row of every block.  SDMA engines copy blocks whose
+ * pitches and slices are DWORD multiples with sub-window packets, and
+ * contiguous rows and blocks with merged linear packets, so a list of tensor
+ * slices or paged blocks becomes one short packet stream.  Other engines fall
+ * back to a linear copy per contiguous run.  Blocks must not overlap each
+ * other.
+ *
+ * @param[in] blocks Array of @p num_blocks block descriptors.
+ *
+ * @param[in] num_blocks Number of descriptors.  Must not be 0.
+ *
+ * @param[in] dst_agent Agent associated with every destination block.
+ *
+ * @param[in] src_agent Agent associated with every source block.
+ *
+ * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * copies start.  If @p num_dep_signals is 0, this argument is ignored.
+ *
+ * @param[in] completion_signal Signal decremented once when every block is
+ * copied.  The signal handle must not be 0.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p blocks is NULL, @p num_blocks
+ * is 0, or a block with non-zero width has a NULL pointer, a zero height or
+ * depth, or overlapping rows or slices.
+ */
+hsa_status_t HSA_API hsa_amd_memory_async_copy_strided(
+    const hsa_amd_memory_copy_strided_t* blocks, uint32_t num_blocks, hsa_agent_t dst_agent,
+    hsa_agent_t src_agent, uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+    hsa_signal_t completion_signal);
+
+/**
+ * @brief Consumer of the chunks of ::hsa_amd_memory_async_copy_stream.
+ *
+ * @param[in] data Staged copy of the chunk, valid until the callback returns.
+ *
+ * @param[in] offset Offset of the chunk from the start of the source.
+ *
+ * @param[in] size Size of the chunk in bytes.
+ *
+ * @param[in] user_data Data passed to ::hsa_amd_memory_async_copy_stream.
+ *
+ * @return ::HSA_STATUS_SUCCESS to continue the stream, any other status
+ * abandons the chunks not yet delivered.
+ */
+typedef hsa_status_t (*hsa_amd_copy_stream_callback_t)(const void* data, size_t offset,
+                                                       size_t size, void* user_data);
+
+/**
+ * @brief Asynchronously read device memory through pinned staging buffers,
+ * handing each chunk to a callback as it lands.
+ *
+ * @details The source is read in HSA_STAGING_CHUNK_SIZE chunks, with
+ * HSA_STAGING_CHUNK_COUNT chunks in flight.  @p callback receives the chunks in
+ * order while the following chunks are still being copied, so a consumer such
+ * as a compressor writing a checkpoint overlaps with the transfer and the
+ * pipeline runs at the speed of the slower of the two.  @p callback runs on the
+ * runtime's asynchronous signal handler thread, under the same restrictions as
+ * handlers registered with ::hsa_amd_signal_async_handler.
+ *
+ * @p completion_signal is decremented once, after the last callback has
+ * returned or after a callback has returned an error, in which case the
+ * remaining chunks are not delivered.
+ *
+ * @param[in] src Device memory to read.
+ *
+ * @param[in] src_agent GPU agent owning @p src.
+ *
+ * @param[in] size Number of bytes to read.  Must not be 0.
+ *
+ * @param[in] callback Consumer of the chunks.
+ *
+ * @param[in] user_data Passed to @p callback.
+ *
+ * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * first chunk is read.  If @p num_dep_signals is 0, this argument is ignored.
+ *
+ * @param[in] completion_signal Signal decremented once the stream is done.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The stream has been started.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p src_agent is not a GPU agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL A signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Staging buffers could not be
+ * allocated.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p src or @p callback is NULL,
+ * or @p size is 0.
+ */
+hsa_status_t HSA_API hsa_amd_memory_async_copy_stream(const void* src, hsa_agent_t src_agent,
+                                                      size_t size,
+                                                      hsa_amd_copy_stream_callback_t callback,
+                                                      void* user_data, uint32_t num_dep_signals,
+                                                      const hsa_signal_t* dep_signals,
+                                                      hsa_signal_t completion_signal);
+
+/**
+ * @brief Asynchronously copy a block of memory from the location pointed to by
+ * @p src on the @p src_agent to the memory block pointed to by @p dst on the @p
+ * dst_agent on engine_id.
+ *
+ * WARNING: Concurrent use of this call with hsa_amd_memory_async_copy can result
+ * in resource conflicts as HSA runtime will auto assign engines with the latter
+ * call.  Approach using both calls concurrently with caution.
+ *
+ * All param definitions are identical to hsa_amd_memory_async_copy with the
+ * exception of engine_id and force_copy_on_sdma.
+ *
+ * @param[in] - engine_id Target engine defined by hsa_amd_sdma_engine_id_t.
+ * Client should use hsa_amd_memory_copy_engine_status first to get the ID
+ * availability.
+ *
+ * @param[in] - force_copy_on_sdma By default, blit kernel copies are used when
+ * dst_agent == src_agent.  Setting this to true will force the copy over SDMA1.
+ *
+ * All return definitions are identical to hsa_amd_memory_async_copy with the
+ * following ammendments:
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT The source or destination
+ * pointers are NULL, or the completion signal is 0 or engine_id is improperly
+ * bounded.
+ */
+hsa_status_t HSA_API
+    hsa_amd_memory_async_copy_on_engine(void* dst, hsa_agent_t dst_agent, const void* src,
+                              hsa_agent_t src_agent, size_t size,
+                              uint32_t num_dep_signals,
+                              const hsa_signal_t* dep_signals,
+                              hsa_signal_t completion_signal,
+                              hsa_amd_sdma_engine_id_t engine_id,
+                              bool force_copy_on_sdma);
+/**
+ * @brief Reports the availability of SDMA copy engines.
+ *
+ * @param[in] dst_agent Destination agent of copy status direction.
+ *
+ * @param[in] src_agent Source agent of copy status direction.
+ *
+ * @param[out] engine_ids_mask returns available SDMA engine IDs that can be masked
+ * with hsa_amd_sdma_engine_id_t.
+ *
+ * @retval ::HSA_STATUS_SUCCESS Agent has available SDMA engines.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Agent does not have available SDMA engines.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT dst_agent and src_agent are the same as
+ * dst_agent == src_agent is generally used for shader copies.
+ */
+hsa_status_t HSA_API
+    hsa_amd_memory_copy_engine_status(hsa_agent_t dst_agent, hsa_agent_t src_agent,
+                                      uint32_t *engine_ids_mask);
+
+/**
+ * @brief An SDMA engine able to serve a copy direction.
+ */
+typedef struct hsa_amd_copy_engine_hint_s {
+  /**
+   * Engine, a single ::hsa_amd_sdma_engine_id_t bit usable with
+   * ::hsa_amd_memory_async_copy_on_engine.
+   */
+  hsa_amd_sdma_engine_id_t engine_id;
+  /**
+   * The platform topology recommends the engine for this agent pair.
+   */
+  bool recommended;
+  /**
+   * No copies are queued on the engine.
+   */
+  bool idle;
+  /**
+   * Bytes queued on the engine and not yet copied.
+   */
+  uint64_t pending_bytes;
+} hsa_amd_copy_engine_hint_t;
+
+/**
+ * @brief Copy engines and link properties of an agent pair.
+ */
+typedef struct hsa_amd_copy_engine_hints_s {
+  /**
+   * Minimum and maximum bandwidth of the link from the source to the
+   * destination agent in MB/s, 0 if the link does not report it.
+   */
+  uint32_t min_bandwidth;
+  uint32_t max_bandwidth;
+  /**
+   * Number of engines ::hsa_amd_memory_async_copy gangs large copies across,
+   * 1 if copies in this direction are not ganged.
+   */
+  uint32_t gang_factor;
+  /**
+   * Number of valid entries in @p engines.
+   */
+  uint32_t num_engines;
+  /**
+   * Engines able to serve the copy, best first.  Recommended engines rank
+   * first, then idle engines, then engines by queued bytes.
+   */
+  hsa_amd_copy_engine_hint_t engines[16];
+} hsa_amd_copy_engine_hints_t;
+
+/**
+ * @brief Ranks the SDMA engines able to copy from @p src_agent to
+ * @p dst_agent.
+ *
+ * @details Unlike ::hsa_amd_memory_copy_engine_status, which only reports
+ * free engines, the hints include the engines the platform topology
+ * recommends for the agent pair and the bandwidth of the link.
+ * ::hsa_amd_memory_async_copy already prefers the recommended engines, the
+ * hints are for callers choosing engines themselves.  Engine load changes
+ * as copies are submitted, so the ranking is a snapshot.
+ *
+ * @param[in] dst_agent Destination agent of the copy direction.
+ *
+ * @param[in] src_agent Source agent of the copy direction.
+ *
+ * @param[out] hints Ranked engines and link properties.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The hints are valid.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent is invalid, neither is a
+ * GPU, or dst_agent and src_agent are the same.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p hints is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_memory_copy_engine_hints(hsa_agent_t dst_agent,
+                                                      hsa_agent_t src_agent,
+                                                      hsa_amd_copy_engine_hints_t* hints);
+
+/*
+[Provisional API]
+Pitched memory descriptor.
+All elements must be 4 byte aligned.  Pitch and slice are in bytes.
+*/
+typedef struct hsa_pitched_ptr_s {
+  void* base;
+  size_t pitch;
+  size_t slice;
+} hsa_pitched_ptr_t;
+
+/*
+[Provisional API]
+Copy direction flag.
+*/
+typedef enum {
+  hsaHostToHost = 0,
+  hsaHostToDevice = 1,
+  hsaDeviceToHost = 2,
+  hsaDeviceToDevice = 3
+} hsa_amd_copy_direction_t;
+
+/*
+[Provisional API]
+SDMA 3D memory copy API.  The same requirements must be met by src and dst as in
+hsa_amd_memory_async_copy.
+Both src and dst must be directly accessible to the copy_agent during the copy, src and dst rects
+must not overlap.
+CPU agents are not supported.  API requires SDMA and will return an error if SDMA is not available.
+Offsets and range carry x in bytes, y and z in rows and layers.
+*/
+hsa_status_t HSA_API hsa_amd_memory_async_copy_rect(
+    const hsa_pitched_ptr_t* dst, const hsa_dim3_t* dst_offset, const hsa_pitched_ptr_t* src,
+    const hsa_dim3_t* src_offset, const hsa_dim3_t* range, hsa_agent_t copy_agent,
+    hsa_amd_copy_direction_t dir, uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+    hsa_signal_t completion_signal);
+
+/**
+ * @brief Type of accesses to a memory pool from a given agent.
+ */
+typedef enum {
+  /**
+  * The agent cannot directly access any buffer in the memory pool.
+  */
+  HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED = 0,
+  /**
+  * The agent can directly access a buffer located in the pool; the application
+  * does not need to invoke ::hsa_amd_agents_allow_access.
+  */
+  HSA_AMD_MEMORY_POOL_ACCESS_ALLOWED_BY_DEFAULT = 1,
+  /**
+  * The agent can directly access a buffer located in the pool, but only if the
+  * application has previously requested access to that buffer using
+  * ::hsa_amd_agents_allow_access.
+  */
+  HSA_AMD_MEMORY_POOL_ACCESS_DISALLOWED_BY_DEFAULT = 2
+} hsa_amd_memory_pool_access_t;
+
+/**
+ * @brief Properties of the relationship between an agent a memory pool.
+ */
+typedef enum {
+  /**
+  * Hyper-transport bus type.
+  */
+  HSA_AMD_LINK_INFO_TYPE_HYPERTRANSPORT = 0,
+
+  /**
+  * QPI bus type.
+  */
+  HSA_AMD_LINK_INFO_TYPE_QPI = 1,
+
+  /**
+  * PCIe bus type.
+  */
+  HSA_AMD_LINK_INFO_TYPE_PCIE = 2,
+
+  /**
+  * Infiniband bus type.
+  */
+  HSA_AMD_LINK_INFO_TYPE_INFINBAND = 3,
+
+  /**
+  * xGMI link type.
+  */
+  HSA_AMD_LINK_INFO_TYPE_XGMI = 4
+
+} hsa_amd_link_info_type_t;
+
+/**
+ * @brief Link properties when accessing the memory pool from the specified
+ * agent.
+ */
+typedef struct hsa_amd_memory_pool_link_info_s {
+  /**
+  * Minimum transfer latency (rounded to ns).
+  */
+  uint32_t min_latency;
+
+  /**
+  * Maximum transfer latency (rounded to ns).
+  */
+  uint32_t max_latency;
+
+  /**
+  * Minimum link interface bandwidth in MB/s.
+  */
+  uint32_t min_bandwidth;
+
+  /**
+  * Maximum link interface bandwidth in MB/s.
+  */
+  uint32_t max_bandwidth;
+
+  /**
+  * Support for 32-bit atomic transactions.
+  */
+  bool atomic_support_32bit;
+
+  /**
+  * Support for 64-bit atomic transactions.
+  */
+  bool atomic_support_64bit;
+
+  /**
+  * Support for cache coherent transactions.
+  */
+  bool coherent_support;
+
+  /**
+  * The type of bus/link.
+  */
+  hsa_amd_link_info_type_t link_type;
+
+  /**
+   * NUMA distance of memory pool relative to querying agent
+   */
+  uint32_t numa_distance;
+} hsa_amd_memory_pool_link_info_t;
+
+/**
+ * @brief Properties of the relationship between an agent a memory pool.
+ */
+typedef enum {
+  /**
+  * Access to buffers located in the memory pool. The type of this attribute
+  * is ::hsa_amd_memory_pool_access_t.
+  *
+  * An agent can always directly access buffers currently located in a memory
+  * pool that is associated (the memory_pool is one of the values returned by
+  * ::hsa_amd_agent_iterate_memory_pools on the agent) with that agent. If the
+  * buffer is currently located in a memory pool that is not associated with
+  * the agent, and the value returned by this function for the given
+  * combination of agent and memory pool is not
+  * HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED, the application still needs to invoke
+  * ::hsa_amd_agents_allow_access in order to gain direct access to the buffer.
+  *
+  * If the given agent can directly access buffers the pool, the result is not
+  * HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED. If the memory pool is associated with
+  * the agent, or it is of fined-grained type, the result must not be
+  * HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED. If the memory pool is not associated
+  * with the agent, and does not reside in the global segment, the result must
+  * be HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED.
+  */
+  HSA_AMD_AGENT_MEMORY_POOL_INFO_ACCESS = 0,
+
+  /**
+  * Number of links to hop when accessing the memory pool from the specified
+  * agent. The value of this attribute is zero if the memory pool is associated
+  * with the agent, or if the access type is
+  * HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED. The type of this attribute is
+  * uint32_t.
+  */
+  HSA_AMD_AGENT_MEMORY_POOL_INFO_NUM_LINK_HOPS = 1,
+
+  /**
+  * Details of each link hop when accessing the memory pool starting from the
+  * specified agent. The type of this attribute is an array size of
+  * HSA_AMD_AGENT_MEMORY_POOL_INFO_NUM_LINK_HOPS with each element containing
+  * ::hsa_amd_memory_pool_link_info_t.
+  */
+  HSA_AMD_AGENT_MEMORY_POOL_INFO_LINK_INFO = 2
+
+} hsa_amd_agent_memory_pool_info_t;
+
+/**
+ * @brief Get the current value of an attribute of the relationship between an
+ * agent and a memory pool.
+ *
+ * @param[in] agent Agent.
+ *
+ * @param[in] memory_pool Memory pool.
+ *
+ * @param[in] attribute Attribute to query.
+ *
+ * @param[out] value Pointer to a application-allocated buffer where to store
+ * the value of the attribute. If the buffer passed by the application is not
+ * large enough to hold the value of @p attribute, the behavior is undefined.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ */
+hsa_status_t HSA_API hsa_amd_agent_memory_pool_get_info(
+    hsa_agent_t agent, hsa_amd_memory_pool_t memory_pool,
+    hsa_amd_agent_memory_pool_info_t attribute, void* value);
+
+/**
+ * @brief Agent entry of a ::hsa_amd_system_properties_t snapshot.  Each field
+ * holds the value of the agent attribute named in its comment, or zero if the
+ * agent does not support that attribute.
+ */
+typedef struct hsa_amd_agent_properties_s {
+  /**
+   * The agent.
+   */
+  hsa_agent_t agent;
+  /**
+   * HSA_AGENT_INFO_DEVICE.
+   */
+  hsa_device_type_t device_type;
+  /**
+   * HSA_AMD_AGENT_INFO_DRIVER_NODE_ID.
+   */
+  uint32_t node_id;
+  /**
+   * HSA_AGENT_INFO_NAME, HSA_AGENT_INFO_VENDOR_NAME, HSA_AMD_AGENT_INFO_PRODUCT_NAME
+   * and HSA_AMD_AGENT_INFO_UUID.
+   */
+  char name[64];
+  char vendor_name[64];
+  char product_name[64];
+  char uuid[24];
+  /**
+   * HSA_AMD_AGENT_INFO_CHIP_ID, HSA_AMD_AGENT_INFO_ASIC_REVISION,
+   * HSA_AMD_AGENT_INFO_DOMAIN and HSA_AMD_AGENT_INFO_BDFID.
+   */
+  uint32_t chip_id;
+  uint32_t asic_revision;
+  uint32_t domain;
+  uint32_t bdfid;
+  /**
+   * HSA_AMD_AGENT_INFO_COMPUTE_UNIT_COUNT, HSA_AMD_AGENT_INFO_NUM_SIMDS_PER_CU,
+   * HSA_AMD_AGENT_INFO_NUM_SHADER_ENGINES and HSA_AMD_AGENT_INFO_MAX_WAVES_PER_CU.
+   */
+  uint32_t compute_unit_count;
+  uint32_t simds_per_cu;
+  uint32_t shader_engines;
+  uint32_t max_waves_per_cu;
+  /**
+   * HSA_AGENT_INFO_WAVEFRONT_SIZE, HSA_AMD_AGENT_INFO_MAX_CLOCK_FREQUENCY and
+   * HSA_AMD_AGENT_INFO_CACHELINE_SIZE.
+   */
+  uint32_t wavefront_size;
+  uint32_t max_clock_frequency;
+  uint32_t cacheline_size;
+  /**
+   * HSA_AGENT_INFO_QUEUE_MIN_SIZE and HSA_AGENT_INFO_QUEUE_MAX_SIZE.
+   */
+  uint32_t queue_min_size;
+  uint32_t queue_max_size;
+  /**
+   * Ranges of the snapshot's pools, caches and links that belong to this agent.
+   * Pools are those listed by ::hsa_amd_agent_iterate_memory_pools and caches
+   * those listed by ::hsa_agent_iterate_caches.
+   */
+  uint32_t first_pool;
+  uint32_t num_pools;
+  uint32_t first_cache;
+  uint32_t num_caches;
+  uint32_t first_link;
+  uint32_t num_links;
+} hsa_amd_agent_properties_t;
+
+/**
+ * @brief Memory pool entry of a ::hsa_amd_system_properties_t snapshot.  Each
+ * field holds the value of the pool attribute named in its comment, or zero
+ * if the pool does not support that attribute.
+ */
+typedef struct hsa_amd_memory_pool_properties_s {
+  /**
+   * The pool and the agent that lists it.
+   */
+  hsa_amd_memory_pool_t pool;
+  hsa_agent_t owner;
+  /**
+   * HSA_AMD_MEMORY_POOL_INFO_SEGMENT, HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS and
+   * HSA_AMD_MEMORY_POOL_INFO_LOCATION.
+   */
+  hsa_amd_segment_t segment;
+  uint32_t global_flags;
+  hsa_amd_memory_pool_location_t location;
+  /**
+   * HSA_AMD_MEMORY_POOL_INFO_SIZE and HSA_AMD_MEMORY_POOL_INFO_ALLOC_MAX_SIZE.
+   */
+  size_t size;
+  size_t alloc_max_size;
+  /**
+   * HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE,
+   * HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_REC_GRANULE and
+   * HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALIGNMENT.
+   */
+  size_t alloc_granule;
+  size_t alloc_rec_granule;
+  size_t alloc_alignment;
+  /**
+   * HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED and
+   * HSA_AMD_MEMORY_POOL_INFO_ACCESSIBLE_BY_ALL.
+   */
+  bool alloc_allowed;
+  bool accessible_by_all;
+} hsa_amd_memory_pool_properties_t;
+
+/**
+ * @brief Cache entry of a ::hsa_amd_system_properties_t snapshot.
+ */
+typedef struct hsa_amd_cache_properties_s {
+  /**
+   * The cache and the agent it belongs to.
+   */
+  hsa_cache_t cache;
+  hsa_agent_t agent;
+  /**
+   * HSA_CACHE_INFO_LEVEL and HSA_CACHE_INFO_SIZE.
+   */
+  uint32_t level;
+  uint32_t size;
+} hsa_amd_cache_properties_t;
+
+/**
+ * @brief Access from an agent to a memory pool in a
+ * ::hsa_amd_system_properties_t snapshot.  Only pairs whose access is not
+ * HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED are listed.
+ */
+typedef struct hsa_amd_agent_pool_link_s {
+  /**
+   * The accessing agent and the pool accessed.
+   */
+  hsa_agent_t agent;
+  hsa_amd_memory_pool_t pool;
+  /**
+   * HSA_AMD_AGENT_MEMORY_POOL_INFO_ACCESS and
+   * HSA_AMD_AGENT_MEMORY_POOL_INFO_NUM_LINK_HOPS.
+   */
+  hsa_amd_memory_pool_access_t access;
+  uint32_t num_hops;
+  /**
+   * First hop of HSA_AMD_AGENT_MEMORY_POOL_INFO_LINK_INFO, zero if
+   * @a num_hops is 0.
+   */
+  hsa_amd_memory_pool_link_info_t link;
+} hsa_amd_agent_pool_link_t;
+
+/**
+ * @brief Snapshot of the properties of all agents, their memory pools and
+ * caches, and agent to pool links.
+ * Within a ROCr major version this structure can only grow.
+ */
+typedef struct hsa_amd_system_properties_s {
+  /**
+   * Size in bytes of this structure.  Used for version control within a major
+   * ROCr revision.  Set to sizeof(hsa_amd_system_properties_t) prior to calling
+   * hsa_amd_system_get_properties.  If the runtime supports an older version
+   * then size will be smaller on return and members past it are not updated.
+   */
+  uint32_t size;
+  /**
+   * Number of entries in each array.
+   */
+  uint32_t num_agents;
+  uint32_t num_pools;
+  uint32_t num_caches;
+  uint32_t num_links;
+  /**
+   * Agents in ::hsa_iterate_agents order, followed by the arrays their ranges
+   * index.  All four arrays live in a single block allocated by the caller's
+   * allocator, starting at @a agents.
+   */
+  hsa_amd_agent_properties_t* agents;
+  hsa_amd_memory_pool_properties_t* pools;
+  hsa_amd_cache_properties_t* caches;
+  hsa_amd_agent_pool_link_t* links;
+} hsa_amd_system_properties_t;
+
+/**
+ * @brief Retrieves the properties of every agent, memory pool, cache and agent
+ * to pool link in a single call.
+ *
+ * @details Equivalent to iterating agents, their pools and caches and querying
+ * each attribute of the snapshot structures with ::hsa_agent_get_info,
+ * ::hsa_amd_memory_pool_get_info, ::hsa_cache_get_info and
+ * ::hsa_amd_agent_memory_pool_get_info, without the per attribute calls.
+ * Dynamic attributes such as free memory are not part of the snapshot.
+ *
+ * @param[in, out] properties Snapshot to fill.  Data member size must be set
+ * to the size of the structure prior to calling.
+ *
+ * @param[in] alloc Function pointer to an allocator used to allocate the
+ * arrays of the snapshot.  The block starting at properties->agents must be
+ * released with the matching deallocator.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The snapshot was filled.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p properties or @p alloc is
+ * NULL, or properties->size is smaller than the first version of the
+ * structure.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES @p alloc failed.
+ */
+hsa_status_t HSA_API hsa_amd_system_get_properties(hsa_amd_system_properties_t* properties,
+                                                   void* (*alloc)(size_t));
+
+/**
+ * @brief Network interface entry of a ::hsa_amd_topology_t.
+ */
+typedef struct hsa_amd_topology_nic_s {
+  /**
+   * Interface name, NUL terminated.
+   */
+  char name[16];
+  /**
+   * PCI domain and bus/device/function of the interface, in the encoding of
+   * HSA_AMD_AGENT_INFO_DOMAIN and HSA_AMD_AGENT_INFO_BDFID.
+   */
+  uint32_t domain;
+  uint32_t bdfid;
+} hsa_amd_topology_nic_t;
+
+/**
+ * @brief Host resources nearest a GPU agent in a ::hsa_amd_topology_t.
+ */
+typedef struct hsa_amd_topology_nearest_s {
+  /**
+   * The GPU agent.
+   */
+  hsa_agent_t gpu;
+  /**
+   * CPU agent with the smallest NUMA distance, as reported by
+   * HSA_AMD_AGENT_INFO_NEAREST_CPU.
+   */
+  hsa_agent_t cpu;
+  /**
+   * Operating system NUMA node of the GPU, -1 if unknown.
+   */
+  int32_t numa_node;
+  /**
+   * Range of ::hsa_amd_topology_t::cores holding the operating system ids of
+   * the cores of @a cpu.
+   */
+  uint32_t first_core;
+  uint32_t num_cores;
+  /**
+   * Range of ::hsa_amd_topology_t::nics holding the network interfaces on
+   * @a numa_node.
+   */
+  uint32_t first_nic;
+  uint32_t num_nics;
+} hsa_amd_topology_nearest_t;
+
+/**
+ * @brief All-pairs connectivity between CPU and GPU agents, and the host
+ * resources nearest each GPU.
+ * Within a ROCr major version this structure can only grow.
+ */
+typedef struct hsa_amd_topology_s {
+  /**
+   * Size in bytes of this structure.  Used for version control within a major
+   * ROCr revision.  Set to sizeof(hsa_amd_topology_t) prior to calling
+   * hsa_amd_topology_get.  If the runtime supports an older version then size
+   * will be smaller on return and members past it are not updated.
+   */
+  uint32_t size;
+  /**
+   * Number of entries in @a agents, @a nearest, @a cores and @a nics.
+   */
+  uint32_t num_agents;
+  uint32_t num_gpus;
+  uint32_t num_cores;
+  uint32_t num_nics;
+  /**
+   * CPU and GPU agents in ::hsa_iterate_agents order.  Row i, column j of each
+   * matrix, at index i * num_agents + j, describes the route from agents[i] to
+   * agents[j].  All arrays live in a single block allocated by the caller's
+   * allocator, starting at @a agents.
+   */
+  hsa_agent_t* agents;
+  /**
+   * Links on the route, 0 on the diagonal and UINT32_MAX if there is no route.
+   */
+  uint32_t* hops;
+  /**
+   * Sum of the link weights on the route, 0 on the diagonal and UINT32_MAX if
+   * there is no route.
+   */
+  uint32_t* numa_distance;
+  /**
+   * Smallest maximum bandwidth, in MB/s, of the links on the route.  0 if any
+   * link does not report one.
+   */
+  uint32_t* bandwidth;
+  /**
+   * Sum of the minimum latencies, in ns, of the links on the route.  0 if any
+   * link does not report one.
+   */
+  uint32_t* latency;
+  /**
+   * One entry per GPU agent, in @a agents order.
+   */
+  hsa_amd_topology_nearest_t* nearest;
+  uint32_t* cores;
+  hsa_amd_topology_nic_t* nics;
+} hsa_amd_topology_t;
+
+/**
+ * @brief Retrieves the agent distance matrices and the host resources nearest
+ * each GPU.
+ *
+ * @details The data is derived once during topology discovery.  Routes follow
+ * the IO links reported by the driver and minimize the total link weight,
+ * preferring routes whose bandwidth is known among routes of equal weight.
+ *
+ * @param[in, out] topology Structure to fill.  Data member size must be set to
+ * the size of the structure prior to calling.
+ *
+ * @param[in] alloc Function pointer to an allocator used to allocate the
+ * arrays.  The block starting at topology->agents must be released with the
+ * matching deallocator.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The structure was filled.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p topology or @p alloc is NULL,
+ * or topology->size is smaller than the first version of the structure.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES @p alloc failed.
+ */
+hsa_status_t HSA_API hsa_amd_topology_get(hsa_amd_topology_t* topology, void* (*alloc)(size_t));
+
+/**
+ * @brief Classes of threads created internally by the runtime.
+ */
+typedef enum {
+  /**
+   * Thread running asynchronous signal handlers, see ::hsa_amd_signal_async_handler.
+   */
+  HSA_AMD_THREAD_CLASS_ASYNC_EVENTS = 0,
+  /**
+   * Threads draining PC sampling buffers, one per sampling session.
+   */
+  HSA_AMD_THREAD_CLASS_PC_SAMPLING = 1,
+  /**
+   * Thread polling SVM fault and migration events for HSA_SVM_PROFILE.
+   */
+  HSA_AMD_THREAD_CLASS_SVM_PROFILER = 2,
+  /**
+   * Threads serving IPC handle requests from other processes.
+   */
+  HSA_AMD_THREAD_CLASS_IPC_SERVER = 3,
+  /**
+   * Housekeeping threads such as scratch and memory pressure monitors, queue
+   * priority updates, deferred frees, metrics dumps and stream delivery.
+   */
+  HSA_AMD_THREAD_CLASS_BACKGROUND = 4,
+  HSA_AMD_THREAD_CLASS_COUNT
+} hsa_amd_thread_class_t;
+
+/**
+ * @brief Processors a class of runtime threads may run on.
+ */
+typedef enum {
+  /**
+   * Cores of the NUMA node local to the GPU the thread serves, or to any GPU
+   * for threads not tied to one.  Unrestricted if the node is unknown.
+   */
+  HSA_AMD_THREAD_AFFINITY_NUMA_LOCAL = 0,
+  /**
+   * Any core of the system.
+   */
+  HSA_AMD_THREAD_AFFINITY_ANY = 1,
+  /**
+   * The cores listed in ::hsa_amd_thread_policy_t::cpus.
+   */
+  HSA_AMD_THREAD_AFFINITY_CPUS = 2
+} hsa_amd_thread_affinity_t;
+
+/**
+ * @brief Operating system scheduling class of a class of runtime threads.
+ */
+typedef enum {
+  /**
+   * Inherit the scheduling class of the thread that caused the creation.
+   */
+  HSA_AMD_THREAD_SCHED_DEFAULT = 0,
+  /**
+   * Normal time sharing.
+   */
+  HSA_AMD_THREAD_SCHED_OTHER = 1,
+  /**
+   * Time sharing for throughput oriented threads.
+   */
+  HSA_AMD_THREAD_SCHED_BATCH = 2,
+  /**
+   * Run only when processors are otherwise idle.
+   */
+  HSA_AMD_THREAD_SCHED_IDLE = 3,
+  /**
+   * Real time, first in first out.  Usually requires elevated privileges.
+   */
+  HSA_AMD_THREAD_SCHED_FIFO = 4,
+  /**
+   * Real time, round robin.  Usually requires elevated privileges.
+   */
+  HSA_AMD_THREAD_SCHED_RR = 5
+} hsa_amd_thread_sched_t;
+
+/**
+ * @brief Placement and scheduling of a class of runtime threads.
+ */
+typedef struct hsa_amd_thread_policy_s {
+  hsa_amd_thread_affinity_t affinity;
+  /**
+   * Operating system processor indices, used with
+   * HSA_AMD_THREAD_AFFINITY_CPUS.
+   */
+  uint32_t num_cpus;
+  const uint32_t* cpus;
+  hsa_amd_thread_sched_t sched;
+  /**
+   * Nice value for the time sharing classes, real time priority for
+   * HSA_AMD_THREAD_SCHED_FIFO and HSA_AMD_THREAD_SCHED_RR.  With
+   * HSA_AMD_THREAD_SCHED_DEFAULT a non-zero value sets the nice value.
+   */
+  int32_t priority;
+} hsa_amd_thread_policy_t;
+
+/**
+ * @brief Sets the placement and scheduling of a class of runtime threads.
+ *
+ * @details The policy applies to threads of the class created later and to
+ * live ones.  It replaces any policy given by HSA_THREAD_POLICY.  By default
+ * threads run on the cores local to their GPU with the creator's scheduling
+ * class.  Failure to apply the scheduling class, typically for lack of
+ * privileges, is not reported.
+ *
+ * @param[in] thread_class Class of threads.
+ *
+ * @param[in] policy Policy to apply, NULL to restore the default.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The policy was recorded.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p thread_class or a member of
+ * @p policy is invalid, or HSA_AMD_THREAD_AFFINITY_CPUS is used without cores.
+ */
+hsa_status_t HSA_API hsa_amd_runtime_thread_policy_set(hsa_amd_thread_class_t thread_class,
+                                                       const hsa_amd_thread_policy_t* policy);
+
+/**
+ * @brief Enable direct access to a buffer from a given set of agents.
+ *
+ * @details
+ *
+ * Upon return, only the listed agents and the agent associated with the
+ * buffer's memory pool have direct access to the @p ptr.
+ *
+ * Any agent that has access to the buffer before and after the call to
+ * ::hsa_amd_agents_allow_access will also have access while
+ * ::hsa_amd_agents_allow_access is in progress.
+ *
+ * The caller is responsible for ensuring that each agent in the list
+ * must be able to access the memory pool containing @p ptr
+ * (using ::hsa_amd_agent_memory_pool_get_info with ::HSA_AMD_AGENT_MEMORY_POOL_INFO_ACCESS attribute),
+ * otherwise error code is returned.
+ *
+ * @param[in] num_agents Size of @p agents.
+ *
+ * @param[in] agents List of agents. If @p num_agents is 0, this argument is
+ * ignored.
+ *
+ * @param[in] flags A list of bit-field that is used to specify access
+ * information in a per-agent basis. This is currently reserved and must be NULL.
+ *
+ * @param[in] ptr A buffer previously allocated using ::hsa_amd_memory_pool_allocate.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_agents is 0, or @p agents
+ * is NULL, @p flags is not NULL, or attempting to enable access to agent(s)
+ * because @p ptr is allocated from an inaccessible pool.
+ *
+ */
+hsa_status_t HSA_API
+    hsa_amd_agents_allow_access(uint32_t num_agents, const hsa_agent_t* agents,
+                                const uint32_t* flags, const void* ptr);
+
+/**
+ * @brief Enable direct access to a set of buffers from a given set of agents.
+ *
+ * @details Behaves as ::hsa_amd_agents_allow_access called for each of
+ * @p ptrs, but buffers are mapped to the agents in as few driver calls as
+ * possible, so granting access to many buffers costs far less than one call
+ * per buffer.  Processing stops at the first buffer which fails, buffers
+ * before it keep the access granted.
+ *
+ * @param[in] num_agents Size of @p agents.
+ *
+ * @param[in] agents List of agents.
+ *
+ * @param[in] flags Reserved and must be NULL.
+ *
+ * @param[in] num_ptrs Size of @p ptrs.
+ *
+ * @param[in] ptrs Buffers previously allocated using
+ * ::hsa_amd_memory_pool_allocate.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_agents or @p num_ptrs is
+ * 0, @p agents or @p ptrs is NULL, an element of @p ptrs is NULL, @p flags is
+ * not NULL, or as for ::hsa_amd_agents_allow_access.
+ */
+hsa_status_t HSA_API hsa_amd_agents_allow_access_batch(uint32_t num_agents,
+                                                       const hsa_agent_t* agents,
+                                                       const uint32_t* flags, uint32_t num_ptrs,
+                                                       const void* const* ptrs);
+
+/**
+ * @brief Declare that the CPU does not write a device memory allocation.
+ *
+ * @details SDMA copies flush the HDP, the path of CPU writes into device memory,
+ * while the CPU may write some of the copying agent's device memory.  The CPU
+ * may write device memory it was granted access to with
+ * ::hsa_amd_agents_allow_access, device memory mapped for the host when
+ * allocated on large BAR systems, and memory shared with other processes.
+ * Marking an allocation device-only excludes it, so an agent whose
+ * CPU-accessible memory is all device-only skips the flush.  The CPU must not
+ * write the allocation while it is marked, reads are not affected.
+ *
+ * @param[in] ptr Base address of a device memory allocation made with
+ * ::hsa_amd_memory_pool_allocate.
+ *
+ * @param[in] device_only true to mark the allocation device-only, false to
+ * let the CPU write it again.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The allocation has been marked.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION @p ptr is not the base of an
+ * allocation.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is NULL or the allocation
+ * is not device memory.
+ */
+hsa_status_t HSA_API hsa_amd_memory_set_device_only(void* ptr, bool device_only);
+
+/**
+ * @brief Query if buffers currently located in some memory pool can be
+ * relocated to a destination memory pool.
+ *
+ * @details If the returned value is non-zero, a migration of a buffer to @p
+ * dst_memory_pool using ::hsa_amd_memory_migrate may nevertheless fail due to
+ * resource limitations.
+ *
+ * @param[in] src_memory_pool Source memory pool.
+ *
+ * @param[in] dst_memory_pool Destination memory pool.
+ *
+ * @param[out] result Pointer to a memory location where the result of the query
+ * is stored. Must not be NULL. If buffers currently located in @p
+ * src_memory_pool can be relocated to @p dst_memory_pool, the result is
+ * true.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL One of the memory pools is
+ * invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p result is NULL.
+ */
+hsa_status_t HSA_API
+    hsa_amd_memory_pool_can_migrate(hsa_amd_memory_pool_t src_memory_pool,
+                                    hsa_amd_memory_pool_t dst_memory_pool,
+                                    bool* result);
+
+/**
+ * @brief Relocate a buffer to a new memory pool.
+ *
+ * @details When a buffer is migrated, its virtual address remains the same but
+ * its physical contents are moved to the indicated memory pool.
+ *
+ * After migration, only the agent associated with the destination pool will have access.
+ *
+ * The caller is also responsible for ensuring that the allocation in the
+ * source memory pool where the buffer is currently located can be migrated to the
+ * specified destination memory pool (using ::hsa_amd_memory_pool_can_migrate returns a value of true
+ * for the source and destination memory pools), otherwise behavior is undefined.
+ *
+ * The caller must ensure that the buffer is not accessed while it is migrated.
+ *
+ * @param[in] ptr Buffer to be relocated. The buffer must have been released to system
+ * prior to call this API.  The buffer will be released to system upon completion.
+ *
+ * @param[in] memory_pool Memory pool where to place the buffer.
+ *
+ * @param[in] flags A bit-field that is used to specify migration
+ * information. Must be zero.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL The destination memory pool is
+ * invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES There is a failure in
+ * allocating the necessary resources.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p flags is not 0.
+ */
+hsa_status_t HSA_API hsa_amd_memory_migrate(const void* ptr,
+                                            hsa_amd_memory_pool_t memory_pool,
+                                            uint32_t flags);
+
+/**
+ * @brief Asynchronously migrate a range of memory to a memory pool.
+ *
+ * @details Moves the pages backing [@p ptr, @p ptr + @p size) to @p
+ * memory_pool once all @p dep_signals reach 0, then decrements @p
+ * completion_signal.  Virtual addresses are kept.  The data movement is done
+ * by the driver on the copy engines, so it overlaps with compute and with
+ * copies issued by the application.  The range is rounded out to page
+ * boundaries.
+ *
+ * The range must be shared virtual memory, such as memory from the system
+ * allocator on systems with XNACK or HMM support.  Memory allocated from a
+ * memory pool is backed by buffer objects whose backing can not change
+ * without a new address; use the virtual memory API
+ * (::hsa_amd_vmem_handle_create and ::hsa_amd_vmem_map) to move such data.
+ *
+ * @param[in] ptr Start of the range to migrate.
+ *
+ * @param[in] size Size of the range in bytes.  Must not be 0.
+ *
+ * @param[in] memory_pool Global segment memory pool to move the range to.  A
+ * system pool moves the range to host memory.
+ *
+ * @param[in] flags Must be 0.
+ *
+ * @param[in] num_dep_signals Number of dependency signals.
+ *
+ * @param[in] dep_signals Signals the migration waits on.  May be NULL if
+ * @p num_dep_signals is 0.
+ *
+ * @param[in] completion_signal Signal decremented once the range has been
+ * migrated.  May be a handle of 0.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The migration has been scheduled.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL @p memory_pool is invalid or
+ * not a global segment pool.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION The range overlaps memory
+ * allocated or registered through the runtime.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is NULL, @p size is 0,
+ * @p flags is not 0, or @p dep_signals is NULL while @p num_dep_signals is
+ * not 0.
+ */
+hsa_status_t HSA_API hsa_amd_memory_migrate_async(void* ptr, size_t size,
+                                                  hsa_amd_memory_pool_t memory_pool,
+                                                  uint32_t flags, uint32_t num_dep_signals,
+                                                  const hsa_signal_t* dep_signals,
+                                                  hsa_signal_t completion_signal);
+
+/**
+ *
+ * @brief Pin a host pointer allocated by C/C++ or OS allocator (i.e. ordinary system DRAM) and
+ * return a new pointer accessible by the @p agents. If the @p host_ptr overlaps with previously
+ * locked memory, then the overlap area is kept locked (i.e multiple mappings are permitted). In
+ * this case, the same input @p host_ptr may give different locked @p agent_ptr and when it does,
+ * they are not necessarily coherent (i.e. accessing either @p agent_ptr is not equivalent).
+ * Accesses to @p agent_ptr are coarse grained.
+ *
+ * @param[in] host_ptr A buffer allocated by C/C++ or OS allocator.
+ *
+ * @param[in] size The size to be locked.
+ *
+ * @param[in] agents Array of agent handle to gain access to the @p host_ptr.
+ * If this parameter is NULL and the @p num_agent is 0, all agents
+ * in the platform will gain access to the @p host_ptr.
+ *
+ * @param[out] agent_ptr Pointer to the location where to store the new address.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES There is a failure in
+ * allocating the necessary resources.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT One or more agent in @p agents is
+ * invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p size is 0 or @p host_ptr or
+ * @p agent_ptr is NULL or @p agents not NULL but @p num_agent is 0 or @p agents
+ * is NULL but @p num_agent is not 0.
+ */
+hsa_status_t HSA_API hsa_amd_memory_lock(void* host_ptr, size_t size,
+                                         hsa_agent_t* agents, int num_agent,
+                                         void** agent_ptr);
+
+/**
+ *
+ * @brief Pin a host pointer allocated by C/C++ or OS allocator (i.e. ordinary system DRAM) and
+ * return a new pointer accessible by the @p agents. If the @p host_ptr overlaps with previously
+ * locked memory, then the overlap area is kept locked (i.e. multiple mappings are permitted).
+ * In this case, the same input @p host_ptr may give different locked @p agent_ptr and when it
+ * does, they are not necessarily coherent (i.e. accessing either @p agent_ptr is not equivalent).
+ * Acesses to the memory via @p agent_ptr have the same access properties as memory allocated from
+ * @p pool as determined by ::hsa_amd_memory_pool_get_info and ::hsa_amd_agent_memory_pool_get_info
+ * (ex. coarse/fine grain, platform atomic support, link info).  Physical composition and placement
+ * of the memory (ex. page size, NUMA binding) is not changed.
+ *
+ * @param[in] host_ptr A buffer allocated by C/C++ or OS allocator.
+ *
+ * @param[in] size The size to be locked.
+ *
+ * @param[in] agents Array of agent handle to gain access to the @p host_ptr.
+ * If this parameter is NULL and the @p num_agent is 0, all agents
+ * in the platform will gain access to the @p host_ptr.
+ *
+ * @param[in] pool Global memory pool owned by a CPU agent.
+ *
+ * @param[in] flags A bit-field that is used to specify allocation
+ * directives. Reserved parameter, must be 0.
+ *
+ * @param[out] agent_ptr Pointer to the location where to store the new address.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES There is a failure in
+ * allocating the necessary resources.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT One or more agent in @p agents is
+ * invalid or can not access @p pool.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL @p pool is invalid or not owned
+ * by a CPU agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p size is 0 or @p host_ptr or
+ * @p agent_ptr is NULL or @p agents not NULL but @p num_agent is 0 or @p agents
+ * is NULL but @p num_agent is not 0 or flags is not 0.
+ */
+hsa_status_t HSA_API hsa_amd_memory_lock_to_pool(void* host_ptr, size_t size, hsa_agent_t* agents,
+                                                 int num_agent, hsa_amd_memory_pool_t pool,
+                                                 uint32_t flags, void** agent_ptr);
+
+/**
+ *
+ * @brief Unpin the host pointer previously pinned via ::hsa_amd_memory_lock or
+ * ::hsa_amd_memory_lock_to_pool.
+ *
+ * @details The behavior is undefined if the host pointer being unpinned does not
+ * match previous pinned address or if the host pointer was already deallocated.
+ *
+ * @param[in] host_ptr A buffer allocated by C/C++ or OS allocator that was
+ * pinned previously via ::hsa_amd_memory_lock or ::hsa_amd_memory_lock_to_pool.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ */
+hsa_status_t HSA_API hsa_amd_memory_unlock(void* host_ptr);
+
+/**
+ *
+ * @brief Drop cached lock registrations of host memory.
+ *
+ * @details When HSA_MEMORY_LOCK_CACHE_SIZE is non-zero ::hsa_amd_memory_unlock
+ * keeps the registration of unlocked host memory so that locking the same or
+ * contained pages again is nearly free.  Applications must invalidate a range
+ * before its pages are released to the OS or remapped, for example from their
+ * allocator's free path or from a deallocation callback registered with
+ * ::hsa_amd_register_deallocation_callback.  Registrations that are still
+ * locked are released by their last unlock.
+ *
+ * @param[in] ptr Start of the host range being released.
+ *
+ * @param[in] size Size of the range in bytes.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is NULL or @p size is 0.
+ */
+hsa_status_t HSA_API hsa_amd_memory_lock_cache_invalidate(void* ptr, size_t size);
+
+/**
+ * @brief Sets the first @p count of uint32_t of the block of memory pointed by
+ * @p ptr to the specified @p value.
+ *
+ * @param[in] ptr Pointer to the block of memory to fill.
+ *
+ * @param[in] value Value to be set.
+ *
+ * @param[in] count Number of uint32_t element to be set to the value.
+ *
+ * @retval HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is NULL or
+ * not 4 bytes aligned
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ALLOCATION if the given memory
+ * region was not allocated with HSA runtime APIs.
+ *
+ */
+hsa_status_t HSA_API
+    hsa_amd_memory_fill(void* ptr, uint32_t value, size_t count);
+
+/**
+ * @brief Asynchronously sets @p count copies of a @p pattern_size byte
+ * pattern starting at @p ptr.
+ *
+ * @details The fill starts once every dependent signal is 0 and decrements
+ * @p completion_signal when done.  GPU mapped memory is filled by the blit
+ * kernel of the owning or an accessing GPU, other host memory is filled by
+ * the CPU.  On GPU mapped memory, patterns that repeat within a DWORD (all 1,
+ * 2 and 4 byte patterns, and wider patterns made of one repeated DWORD) need
+ * @p ptr and the fill size to be 4 byte aligned.  Other 8 and 16 byte
+ * patterns need @p ptr and the fill size to be 16 byte aligned and are only
+ * supported on gfx9 and later.
+ *
+ * @param[in] ptr Pointer to the block of memory to fill.
+ *
+ * @param[in] pattern Pointer to the pattern.
+ *
+ * @param[in] pattern_size Size of the pattern in bytes, one of 1, 2, 4, 8 or
+ * 16.
+ *
+ * @param[in] count Number of patterns to write.  Must not be 0.
+ *
+ * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the
+ * fill starts.  If @p num_dep_signals is 0, this argument is ignored.
+ *
+ * @param[in] completion_signal Signal decremented once the fill is done.  The
+ * signal handle must not be 0.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The GPU owning @p ptr does not
+ * support the pattern.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr or @p pattern is NULL,
+ * @p pattern_size is not supported, @p count is 0 or the alignment
+ * requirements are not met.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION if the given memory
+ * region was not allocated with HSA runtime APIs.
+ */
+hsa_status_t HSA_API hsa_amd_memory_fill_async(void* ptr, const void* pattern,
+                                               uint32_t pattern_size, size_t count,
+                                               uint32_t num_dep_signals,
+                                               const hsa_signal_t* dep_signals,
+                                               hsa_signal_t completion_signal);
+
+/**
+ * @brief Maps an interop object into the HSA flat address space and establishes
+ * memory residency.  The metadata pointer is valid during the lifetime of the
+ * map (until hsa_amd_interop_unmap_buffer is called).
+ * Multiple calls to hsa_amd_interop_map_buffer with the same interop_handle
+ * result in multiple mappings with potentially different addresses and
+ * different metadata pointers.  Calls for the same set of agents share one
+ * cached mapping, see ::hsa_amd_interop_cache_invalidate.  Concurrent
+ * operations on these addresses are not coherent.  Memory must be fenced to
+ * system scope to ensure consistency, between mappings and with any views of
+ * this buffer in the originating software stack.
+ *
+ * @param[in] num_agents Number of agents which require access to the memory
+ *
+ * @param[in] agents List of accessing agents.
+ *
+ * @param[in] interop_handle Handle of interop buffer (dmabuf handle in Linux)
+ *
+ * @param [in] flags Reserved, must be 0
+ *
+ * @param[out] size Size in bytes of the mapped object
+ *
+ * @param[out] ptr Base address of the mapped object
+ *
+ * @param[out] metadata_size Size of metadata in bytes, may be NULL
+ *
+ * @param[out] metadata Pointer to metadata, may be NULL
+ *
+ * @retval HSA_STATUS_SUCCESS if successfully mapped
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT all other errors
+ */
+hsa_status_t HSA_API hsa_amd_interop_map_buffer(uint32_t num_agents,
+                                        hsa_agent_t* agents,
+                                        int interop_handle,
+                                        uint32_t flags,
+                                        size_t* size,
+                                        void** ptr,
+                                        size_t* metadata_size,
+                                        const void** metadata);
+
+/**
+ * @brief Removes a previously mapped interop object from HSA's flat address space.
+ * Ends lifetime for the mapping's associated metadata pointer.
+ */
+hsa_status_t HSA_API hsa_amd_interop_unmap_buffer(void* ptr);
+
+/**
+ * @brief Drop cached interop mappings of a graphics buffer.
+ *
+ * @details Mapping a buffer with ::hsa_amd_interop_map_buffer again, for the
+ * same set of agents, returns the mapping of the earlier call instead of
+ * importing the buffer anew.  Mappings stay imported after their last
+ * ::hsa_amd_interop_unmap_buffer, so a rotating set of buffers is mapped once
+ * for the life of the set.  The number of such unreferenced mappings is
+ * limited by HSA_INTEROP_CACHE_SIZE (default 8), the least recently unmapped
+ * being released first.  A cached mapping keeps its buffer alive.  Call this
+ * once a buffer is retired so its memory is released at once; mappings still
+ * in use are released at their last unmap.
+ *
+ * @param[in] interop_handle Handle of the interop buffer (dmabuf handle in
+ * Linux), or -1 for all buffers.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p interop_handle is not -1
+ * and not a valid handle.
+ */
+hsa_status_t HSA_API hsa_amd_interop_cache_invalidate(int interop_handle);
+
+/**
+ * @brief Denotes the type of memory in a pointer info query.
+ */
+typedef enum {
+  /*
+  Memory is not known to the HSA driver.  Unallocated or unlocked system memory.
+  */
+  HSA_EXT_POINTER_TYPE_UNKNOWN = 0,
+  /*
+  Memory was allocated with an HSA memory allocator.
+  */
+  HSA_EXT_POINTER_TYPE_HSA = 1,
+  /*
+  System memory which has been locked for use with an HSA agent.
+
+  Memory of this type is normal malloc'd memory and is always accessible to
+  the CPU.  Pointer info queries may not include CPU agents in the accessible
+  agents list as the CPU has implicit access.
+  */
+  HSA_EXT_POINTER_TYPE_LOCKED = 2,
+  /*
+  Memory originated in a graphics component and is shared with ROCr.
+  */
+  HSA_EXT_POINTER_TYPE_GRAPHICS = 3,
+  /*
+  Memory has been shared with the local process via ROCr IPC APIs.
+  */
+  HSA_EXT_POINTER_TYPE_IPC = 4
+} hsa_amd_pointer_type_t;
+
+/**
+ * @brief Describes a memory allocation known to ROCr.
+ * Within a ROCr major version this structure can only grow.
+ */
+typedef struct hsa_amd_pointer_info_s {
+  /*
+  Size in bytes of this structure.  Used for version control within a major ROCr
+  revision.  Set to sizeof(hsa_amd_pointer_t) prior to calling
+  hsa_amd_pointer_info.  If the runtime supports an older version of pointer
+  info then size will be smaller on return.  Members starting after the return
+  value of size will not be updated by hsa_amd_pointer_info.
+  */
+  uint32_t size;
+  /*
+  The type of allocation referenced.
+  */
+  hsa_amd_pointer_type_t type;
+  /*
+  Base address at which non-host agents may access the allocation. This field is
+  not meaningful if the type of the allocation is HSA_EXT_POINTER_TYPE_UNKNOWN.
+  */
+  void* agentBaseAddress;
+  /*
+  Base address at which the host agent may access the allocation. This field is
+  not meaningful if the type of the allocation is HSA_EXT_POINTER_TYPE_UNKNOWN.
+  */
+  void* hostBaseAddress;
+  /*
+  Size of the allocation. This field is not meaningful if the type of the allocation
+  is HSA_EXT_POINTER_TYPE_UNKNOWN.
+  */
+  size_t sizeInBytes;
+  /*
+  Application provided value. This field is not meaningful if the type of the
+  allocation is HSA_EXT_POINTER_TYPE_UNKNOWN.
+  */
+  void* userData;
+  /*
+  Reports an agent which "owns" (ie has preferred access to) the pool in which the
+  allocation was
+  made.  When multiple agents share equal access to a pool (ex: multiple CPU agents, or multi-die
+  GPU boards) any such agent may be returned. This field is not meaningful if
+  the type of the allocation is HSA_EXT_POINTER_TYPE_UNKNOWN or if this agent is not available in
+  this process, for e.g if this agent is masked using ROCR_VISIBLE_DEVICES.
+  */
+  hsa_agent_t agentOwner;
+  /*
+  Contains a bitfield of hsa_amd_memory_pool_global_flag_t values.
+  Reports the effective global flags bitmask for the allocation.  This field is not
+  meaningful if the type of the allocation is HSA_EXT_POINTER_TYPE_UNKNOWN.
+  */
+  uint32_t global_flags;
+} hsa_amd_pointer_info_t;
+
+/**
+ * @brief Retrieves information about the allocation referenced by the given
+ * pointer.  Optionally returns the number and list of agents which can
+ * directly access the allocation. In case this virtual address is unknown, the
+ * pointer type returned will be HSA_EXT_POINTER_TYPE_UNKNOWN and the only fields
+ * that are valid after hsa_amd_pointer_info returns are size and type.
+ *
+ * @param[in] ptr Pointer which references the allocation to retrieve info for.
+ *
+ * @param[in, out] info Pointer to structure to be filled with allocation info.
+ * Data member size must be set to the size of the structure prior to calling
+ * hsa_amd_pointer_info.  On return size will be set to the size of the
+ * pointer info structure supported by the runtime, if smaller.  Members
+ * beyond the returned value of size will not be updated by the API.
+ * Must not be NULL.
+ *
+ * @param[in] alloc Function pointer to an allocator used to allocate the
+ * @p accessible array.  If NULL @p accessible will not be returned.
+ *
+ * @param[out] num_agents_accessible Recieves the count of agents in
+ * @p accessible.  If NULL @p accessible will not be returned.
+ *
+ * @param[out] accessible Recieves a pointer to the array, allocated by @p alloc,
+ * holding the list of agents which may directly access the allocation.
+ * May be NULL.
+ *
+ * @retval HSA_STATUS_SUCCESS Info retrieved successfully
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT NULL in @p ptr or @p info.
+ */
+hsa_status_t HSA_API hsa_amd_pointer_info(const void* ptr,
+                                          hsa_amd_pointer_info_t* info,
+                                          void* (*alloc)(size_t),
+                                          uint32_t* num_agents_accessible,
+                                          hsa_agent_t** accessible);
+
+/**
+ * @brief Associates an arbitrary pointer with an allocation known to ROCr.
+ * The pointer can be fetched by hsa_amd_pointer_info in the userData field.
+ *
+ * @param[in] ptr Pointer to the first byte of an allocation known to ROCr
+ * with which to associate @p userdata.
+ *
+ * @param[in] userdata Abitrary pointer to associate with the allocation.
+ *
+ * @retval HSA_STATUS_SUCCESS @p userdata successfully stored.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is not known to ROCr.
+ */
+hsa_status_t HSA_API hsa_amd_pointer_info_set_userdata(const void* ptr,
+                                                       void* userdata);
+
+/**
+ * @brief 256-bit process independent identifier for a ROCr shared memory
+ * allocation.
+ */
+typedef struct hsa_amd_ipc_memory_s {
+  uint32_t handle[8];
+} hsa_amd_ipc_memory_t;
+
+/**
+ * @brief Prepares an allocation for interprocess sharing and creates a
+ * handle of type hsa_amd_ipc_memory_t uniquely identifying the allocation.  A
+ * handle is valid while the allocation it references remains accessible in
+ * any process.  In general applications should confirm that a shared memory
+ * region has been attached (via hsa_amd_ipc_memory_attach) in the remote
+ * process prior to releasing that memory in the local process.
+ * Repeated calls for the same allocation may, but are not required to, return
+ * unique handles. The allocation needs to be on memory on an agent of type
+ * HSA_DEVICE_TYPE_GPU.
+ *
+ * @param[in] ptr Pointer to device memory allocated via ROCr APIs to prepare for
+ * sharing.
+ *
+ * @param[in] len Length in bytes of the allocation to share.
+ *
+ * @param[out] handle Process independent identifier referencing the shared
+ * allocation.
+ *
+ * @retval HSA_STATUS_SUCCESS allocation is prepared for interprocess sharing.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr does not point to the
+ * first byte of an allocation made through ROCr, or len is not the full length
+ * of the allocation or handle is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_ipc_memory_create(void* ptr, size_t len,
+                                               hsa_amd_ipc_memory_t* handle);
+
+/**
+ * @brief Imports shared memory into the local process and makes it accessible
+ * by the given agents.  If a shared memory handle is attached multiple times
+ * in a process each attach may return a different address.  Each returned
+ * address is refcounted and requires a matching number of calls to
+ * hsa_amd_ipc_memory_detach to release the shared memory mapping.
+ *
+ * @param[in] handle Pointer to the identifier for the shared memory.
+ *
+ * @param[in] len Length of the shared memory to import.
+ * Reserved.  Must be the full length of the shared allocation in this version.
+ *
+ * @param[in] num_agents Count of agents in @p mapping_agents.
+ * May be zero if all agents are to be allowed access.
+ *
+ * @param[in] mapping_agents List of agents to access the shared memory.
+ * Ignored if @p num_agents is zero.
+ *
+ * @param[out] mapped_ptr Recieves a process local pointer to the shared memory.
+ *
+ * @retval HSA_STATUS_SUCCESS if memory is successfully imported.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p handle is not valid, @p len is
+ * incorrect, @p mapped_ptr is NULL, or some agent for which access was
+ * requested can not access the shared memory.
+ */
+hsa_status_t HSA_API hsa_amd_ipc_memory_attach(
+    const hsa_amd_ipc_memory_t* handle, size_t len,
+    uint32_t num_agents,
+    const hsa_agent_t* mapping_agents,
+    void** mapped_ptr);
+
+/**
+ * @brief Decrements the reference count for the shared memory mapping and
+ * releases access to shared memory imported with hsa_amd_ipc_memory_attach.
+ * Once unreferenced, the mapping may be kept for reuse by a later attach of
+ * the same handle.
+ *
+ * @param[in] mapped_ptr Pointer to the first byte of a shared allocation
+ * imported with hsa_amd_ipc_memory_attach.
+ *
+ * @retval HSA_STATUS_SUCCESS if @p mapped_ptr was imported with
+ * hsa_amd_ipc_memory_attach.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p mapped_ptr was not imported
+ * with hsa_amd_ipc_memory_attach.
+ */
+hsa_status_t HSA_API hsa_amd_ipc_memory_detach(void* mapped_ptr);
+
+/**
+ * @brief Imports many shared memory handles at once, as if by calling
+ * hsa_amd_ipc_memory_attach for each of them.  Handles exported by the same
+ * process are fetched together, which makes all-to-all exchanges between many
+ * processes considerably cheaper.  Each returned address must be released with
+ * hsa_amd_ipc_memory_detach.
+ *
+ * @param[in] handles Array of @p count shared memory identifiers.
+ *
+ * @param[in] lens Array of @p count lengths of the shared memory to import.
+ *
+ * @param[in] count Number of handles to import.
+ *
+ * @param[in] num_agents Count of agents in @p mapping_agents.
+ * May be zero if all agents are to be allowed access.
+ *
+ * @param[in] mapping_agents List of agents to access the shared memory.
+ * Ignored if @p num_agents is zero.
+ *
+ * @param[out] mapped_ptrs Array of @p count entries receiving the process local
+ * pointers to the shared memory.
+ *
+ * @retval HSA_STATUS_SUCCESS if all handles were successfully imported.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p handles, @p lens or
+ * @p mapped_ptrs is NULL, or some handle could not be imported.  No handle
+ * remains attached on failure.
+ */
+hsa_status_t HSA_API hsa_amd_ipc_memory_attach_batch(
+    const hsa_amd_ipc_memory_t* handles, const size_t* lens, uint32_t count,
+    uint32_t num_agents, const hsa_agent_t* mapping_agents, void** mapped_ptrs);
+
+/** @} */
+
+/** \addtogroup status Runtime notifications
+ *  @{
+ */
+
+/**
+ * @brief 256-bit process independent identifier for a ROCr IPC signal.
+ */
+typedef hsa_amd_ipc_memory_t hsa_amd_ipc_signal_t;
+
+/**
+ * @brief Obtains an interprocess sharing handle for a signal.  The handle is
+ * valid while the signal it references remains valid in any process.  In
+ * general applications should confirm that the signal has been attached (via
+ * hsa_amd_ipc_signal_attach) in the remote process prior to destroying that
+ * signal in the local process.
+ * Repeated calls for the same signal may, but are not required to, return
+ * unique handles.
+ *
+ * @param[in] signal Signal created with attribute HSA_AMD_SIGNAL_IPC.
+ *
+ * @param[out] handle Process independent identifier referencing the shared
+ * signal.
+ *
+ * @retval HSA_STATUS_SUCCESS @p handle is ready to use for interprocess sharing.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p signal is not a valid signal
+ * created with attribute HSA_AMD_SIGNAL_IPC or handle is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_ipc_signal_create(hsa_signal_t signal, hsa_amd_ipc_signal_t* handle);
+
+/**
+ * @brief Imports an IPC capable signal into the local process.  If an IPC
+ * signal handle is attached multiple times in a process each attach may return
+ * a different signal handle.  Each returned signal handle is refcounted and
+ * requires a matching number of calls to hsa_signal_destroy to release the
+ * shared signal.
+ *
+ * @param[in] handle Pointer to the identifier for the shared signal.
+ *
+ * @param[out] signal Recieves a process local signal handle to the shared signal.
+ *
+ * @retval HSA_STATUS_SUCCESS if the signal is successfully imported.
+ *
+ * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ *
+ * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p handle is not valid.
+ */
+hsa_status_t HSA_API hsa_amd_ipc_signal_attach(const hsa_amd_ipc_signal_t* handle,
+                                               hsa_signal_t* signal);
+
+/**
+ * @brief GPU system event type.
+ */
+typedef enum hsa_amd_event_type_s {
+  /*
+   AMD GPU memory fault.
+   */
+  HSA_AMD_GPU_MEMORY_FAULT_EVENT = 0,
+  /*
+   AMD GPU HW Exception.
+   */
+  HSA_AMD_GPU_HW_EXCEPTION_EVENT,
+  /*
+   AMD GPU memory error.
+   */
+  HSA_AMD_GPU_MEMORY_ERROR_EVENT,
+} hsa_amd_event_type_t;
+
+/**
+ * @brief Flags denoting the cause of a memory fault.
+ */
+typedef enum {
+  // Page not present or supervisor privilege.
+  HSA_AMD_MEMORY_FAULT_PAGE_NOT_PRESENT = 1 << 0,
+  // Write access to a read-only page.
+  HSA_AMD_MEMORY_FAULT_READ_ONLY = 1 << 1,
+  // Execute access to a page marked NX.
+  HSA_AMD_MEMORY_FAULT_NX = 1 << 2,
+  // GPU attempted access to a host only page.
+  HSA_AMD_MEMORY_FAULT_HOST_ONLY = 1 << 3,
+  // DRAM ECC failure.
+  HSA_AMD_MEMORY_FAULT_DRAMECC = 1 << 4,
+  // Can't determine the exact fault address.
+  HSA_AMD_MEMORY_FAULT_IMPRECISE = 1 << 5,
+  // SRAM ECC failure (ie registers, no fault address).
+  HSA_AMD_MEMORY_FAULT_SRAMECC = 1 << 6,
+  // GPU reset following unspecified hang.
+  HSA_AMD_MEMORY_FAULT_HANG = 1U << 31
+} hsa_amd_memory_fault_reason_t;
+
+/**
+ * @brief AMD GPU memory fault event data.
+ */
+typedef struct hsa_amd_gpu_memory_fault_info_s {
+  /*
+  The agent where the memory fault occurred.
+  */
+  hsa_agent_t agent;
+  /*
+  Virtual address accessed.
+  */
+  uint64_t virtual_address;
+  /*
+  Bit field encoding the memory access failure reasons. There could be multiple bits set
+  for one fault.  Bits are defined in hsa_amd_memory_fault_reason_t.
+  */
+  uint32_t fault_reason_mask;
+} hsa_amd_gpu_memory_fault_info_t;
+
+/**
+ * @brief Flags denoting the cause of a memory error.
+ */
+typedef enum {
+  // Memory was in use by low-level HW component and cannot be released
+  HSA_AMD_MEMORY_ERROR_MEMORY_IN_USE = (1 << 0),
+} hsa_amd_memory_error_reason_t;
+
+/**
+ * @brief AMD GPU memory error event data.
+ */
+typedef struct hsa_amd_gpu_memory_error_info_s {
+  /*
+  The agent where the memory error occurred.
+  */
+  hsa_agent_t agent;
+  /*
+  Virtual address involved.
+  */
+  uint64_t virtual_address;
+  /*
+  Bit field encoding the memory error failure reasons. There could be multiple bits set
+  for one error.  Bits are defined in hsa_amd_memory_error_reason_t.
+  */
+  uint32_t error_reason_mask;
+} hsa_amd_gpu_memory_error_info_t;
+
+/**
+ * @brief Flags denoting the type of a HW exception
+ */
+typedef enum {
+  // Unused for now
+  HSA_AMD_HW_EXCEPTION_RESET_TYPE_OTHER = 1 << 0,
+} hsa_amd_hw_exception_reset_type_t;
+
+/**
+ * @brief Flags denoting the cause of a HW exception
+ */
+typedef enum {
+  // GPU Hang
+  HSA_AMD_HW_EXCEPTION_CAUSE_GPU_HANG = 1 << 0,
+  // SRAM ECC
+  HSA_AMD_HW_EXCEPTION_CAUSE_ECC = 1 << 1,
+} hsa_amd_hw_exception_reset_cause_t;
+
+/**
+ * @brief AMD GPU HW Exception event data.
+ */
+typedef struct hsa_amd_gpu_hw_exception_info_s {
+  /*
+  The agent where the HW exception occurred.
+  */
+  hsa_agent_t agent;
+  hsa_amd_hw_exception_reset_type_t reset_type;
+  hsa_amd_hw_exception_reset_cause_t reset_cause;
+} hsa_amd_gpu_hw_exception_info_t;
+
+/**
+ * @brief AMD GPU event data passed to event handler.
+ */
+typedef struct hsa_amd_event_s {
+  /*
+  The event type.
+  */
+  hsa_amd_event_type_t event_type;
+  union {
+    /*
+    The memory fault info, only valid when @p event_type is HSA_AMD_GPU_MEMORY_FAULT_EVENT.
+    */
+    hsa_amd_gpu_memory_fault_info_t memory_fault;
+    /*
+    The memory fault info, only valid when @p event_type is HSA_AMD_GPU_HW_EXCEPTION_EVENT.
+    */
+    hsa_amd_gpu_hw_exception_info_t hw_exception;
+    /*
+    The memory error info, only valid when @p event_type is HSA_AMD_GPU_MEMORY_ERROR_EVENT.
+    */
+    hsa_amd_gpu_memory_error_info_t memory_error;
+  };
+} hsa_amd_event_t;
+
+typedef hsa_status_t (*hsa_amd_system_event_callback_t)(const hsa_amd_event_t* event, void* data);
+
+/**
+ * @brief Register AMD GPU event handler.
+ *
+ * @param[in] callback Callback to be invoked when an event is triggered.
+ * The HSA runtime passes two arguments to the callback: @p event
+ * is defined per event by the HSA runtime, and @p data is the user data.
+ *
+ * @param[in] data User data that is passed to @p callback. May be NULL.
+ *
+ * @retval HSA_STATUS_SUCCESS The handler has been registered successfully.
+ *
+ * @retval HSA_STATUS_ERROR An event handler has already been registered.
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p event is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_register_system_event_handler(hsa_amd_system_event_callback_t callback,
+                                                   void* data);
+
+/**
+ * @brief GPU fault received by the runtime, see ::hsa_amd_gpu_fault_records_get.
+ */
+typedef struct hsa_amd_gpu_fault_record_s {
+  /*
+  Position of the fault among all faults received by this process, starting at 1.
+  */
+  uint64_t sequence;
+  /*
+  System timestamp, in the HSA_SYSTEM_INFO_TIMESTAMP domain, at which the runtime
+  received the fault.
+  */
+  uint64_t timestamp;
+  /*
+  HSA_AMD_GPU_MEMORY_FAULT_EVENT or HSA_AMD_GPU_HW_EXCEPTION_EVENT.
+  */
+  hsa_amd_event_type_t event_type;
+  /*
+  The faulting agent.
+  */
+  hsa_agent_t agent;
+  /*
+  Faulting address and mask of hsa_amd_memory_fault_reason_t values, only valid
+  for memory faults.
+  */
+  uint64_t virtual_address;
+  uint32_t fault_reason_mask;
+  /*
+  Cause of the reset, only valid for HW exceptions.
+  */
+  hsa_amd_hw_exception_reset_cause_t reset_cause;
+  /*
+  True once a system event handler reported success for the fault.
+  */
+  bool handled;
+} hsa_amd_gpu_fault_record_t;
+
+/**
+ * @brief Retrieves the most recent GPU memory faults and HW exceptions
+ * received by the runtime.
+ *
+ * @details A fault is recorded as soon as it is received, before system event
+ * handlers run, so tools can inspect it from any thread while the handlers are
+ * still working.  The runtime keeps the 64 most recent records; gaps in
+ * sequence numbers indicate dropped records.
+ *
+ * @param[out] records Array receiving up to *@p count records, oldest first.
+ * May be NULL if *@p count is 0.
+ *
+ * @param[in, out] count Capacity of @p records on input, number of records
+ * written on output.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The records were copied.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p count is NULL, or @p records
+ * is NULL while *@p count is not 0.
+ */
+hsa_status_t HSA_API hsa_amd_gpu_fault_records_get(hsa_amd_gpu_fault_record_t* records,
+                                                   uint32_t* count);
+
+/** @} */
+
+/** \addtogroup queue Queues
+ *  @{
+ */
+
+/**
+ * @brief Per-queue dispatch and wavefront scheduling priority.
+ */
+typedef enum hsa_amd_queue_priority_s {
+  /*
+  Below normal/high priority compute and all graphics
+  */
+  HSA_AMD_QUEUE_PRIORITY_LOW = 0,
+  /*
+  Above low priority compute, below high priority compute and all graphics
+  */
+  HSA_AMD_QUEUE_PRIORITY_NORMAL = 1,
+  /*
+  Above low/normal priority compute and all graphics
+  */
+  HSA_AMD_QUEUE_PRIORITY_HIGH = 2,
+} hsa_amd_queue_priority_t;
+
+/**
+ * @brief Modifies the dispatch and wavefront scheduling prioirty for a
+ * given compute queue. The default is HSA_AMD_QUEUE_PRIORITY_NORMAL.
+ *
+ * When HSA_QUEUE_PRIORITY_INTERVAL is set to a number of milliseconds, the
+ * call only records the priority and returns.  A background thread hands the
+ * latest recorded priority of each queue to the driver, at most once per
+ * interval, and driver failures are no longer reported to the caller.
+ *
+ * @param[in] queue Compute queue to apply new priority to.
+ *
+ * @param[in] priority Priority to associate with queue.
+ *
+ * @retval HSA_STATUS_SUCCESS if priority was changed successfully.
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_QUEUE if queue is not a valid
+ * compute queue handle.
+ *
+ * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT if priority is not a valid
+ * value from hsa_amd_queue_priority_t.
+ */
+hsa_status_t HSA_API hsa_amd_queue_set_priority(hsa_queue_t* queue,
+                                                hsa_amd_queue_priority_t priority);
+
+/**
+ * @brief Deschedule a compute queue from the hardware without destroying it.
+ *
+ * @details The queue is preempted with its in-flight wavefronts saved by
+ * compute wave save/restore, so the call returns once the queue no longer
+ * occupies the GPU.  Packets may still be written and doorbells rung while the
+ * queue is suspended; they are processed after ::hsa_amd_queue_resume.  This
+ * lets a scheduler yield the GPU from low priority work to latency sensitive
+ * work without tearing down and recreating queues.  Suspending a suspended
+ * queue has no effect.
+ *
+ * On queues created while HSA_VIRTUAL_QUEUE_LIMIT is set, packets already
+ * handed to the shared hardware queue run to completion; suspension stops
+ * further packets from being handed over.
+ *
+ * @param[in] queue Compute queue to suspend.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The queue is suspended.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is not a valid GPU compute
+ * queue, or has been halted by an error.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The driver failed to preempt the
+ * queue.
+ */
+hsa_status_t HSA_API hsa_amd_queue_suspend(hsa_queue_t* queue);
+
+/**
+ * @brief Return a queue suspended by ::hsa_amd_queue_suspend to the hardware.
+ *
+ * @details Saved wavefronts are restored and packet processing continues from
+ * where it stopped.  Resuming a queue that is not suspended has no effect.
+ *
+ * @param[in] queue Compute queue to resume.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The queue is scheduled.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is not a valid GPU compute
+ * queue, or has been halted by an error.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The driver failed to map the
+ * queue.
+ */
+hsa_status_t HSA_API hsa_amd_queue_resume(hsa_queue_t* queue);
+
+/**
+ * @brief Flags for hsa_amd_queue_create.
+ */
+typedef enum hsa_amd_queue_create_flag_s {
+  /**
+   * Place the ring buffer in device local memory, mapped write-combined on the
+   * host, so the packet processor does not fetch packets across PCIe.  Needs
+   * all of device memory to be host visible (large BAR) or a coherent CPU-GPU
+   * link.  Producers writing packets directly must fence (e.g. sfence) before
+   * storing a packet header; ::hsa_amd_queue_submit_batch, doorbell stores and
+   * write index release stores fence as required.
+   */
+  HSA_AMD_QUEUE_CREATE_DEVICE_RING = (1 << 0),
+  /**
+   * Allocate the host side of the queue (ring buffer unless
+   * ::HSA_AMD_QUEUE_CREATE_DEVICE_RING is also given, kernarg ring and
+   * internal command buffers) on the NUMA node of the CPU agent selected by
+   * bits 32 to 63 of the flags, instead of the CPU nearest to the GPU.  Use
+   * ::HSA_AMD_QUEUE_CREATE_NUMA_NODE to build the flags.
+   */
+  HSA_AMD_QUEUE_CREATE_NUMA_HINT = (1 << 1)
+} hsa_amd_queue_create_flag_t;
+
+/**
+ * @brief Flags for ::hsa_amd_queue_create placing queue host memory near the
+ * CPU agent whose ::HSA_AGENT_INFO_NODE is @p node.
+ */
+#define HSA_AMD_QUEUE_CREATE_NUMA_NODE(node) \
+  ((((uint64_t)(node)) << 32) | (uint64_t)HSA_AMD_QUEUE_CREATE_NUMA_HINT)
+
+/**
+ * @brief Create a user mode queue with AMD specific options.
+ *
+ * @details Behaves as ::hsa_queue_create with the additional @p flags.
+ *
+ * @param[in] flags Bit mask of ::hsa_amd_queue_create_flag_t values.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The queue has been created successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT A flag was given and @p agent is
+ * not a GPU agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE_CREATION A flag was given for a
+ * cooperative queue, or ::HSA_AMD_QUEUE_CREATE_DEVICE_RING was given and
+ * device memory of @p agent is not host accessible.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p flags has unknown bits set,
+ * ::HSA_AMD_QUEUE_CREATE_NUMA_HINT names a node that is not a CPU agent with
+ * a kernarg pool, or as for ::hsa_queue_create.
+ *
+ * Other return values are as for ::hsa_queue_create.
+ */
+hsa_status_t HSA_API hsa_amd_queue_create(
+    hsa_agent_t agent, uint32_t size, hsa_queue_type32_t type,
+    void (*callback)(hsa_status_t status, hsa_queue_t* source, void* data), void* data,
+    uint32_t private_segment_size, uint32_t group_segment_size, uint64_t flags,
+    hsa_queue_t** queue);
+
+/**
+ * @brief Asynchronously copy memory on an engine with a priority class.
+ *
+ * @details Behaves as ::hsa_amd_memory_async_copy_on_engine.  Copies with a
+ * @p priority other than ::HSA_AMD_QUEUE_PRIORITY_NORMAL are submitted to
+ * rings reserved for that class, so latency critical copies do not wait
+ * behind bulk copies issued at another priority.  Blit kernels of a class run
+ * on a compute queue at that priority.  Priority classes apply to host to
+ * device, device to host, PCIe peer and same device copies; copies on xGMI
+ * engines ignore @p priority.
+ *
+ * @param[in] priority Priority class of the copy.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p priority is not a valid
+ * value from ::hsa_amd_queue_priority_t, or as for
+ * ::hsa_amd_memory_async_copy_on_engine.
+ */
+hsa_status_t HSA_API hsa_amd_memory_async_copy_on_engine_with_priority(
+    void* dst, hsa_agent_t dst_agent, const void* src, hsa_agent_t src_agent, size_t size,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal,
+    hsa_amd_sdma_engine_id_t engine_id, bool force_copy_on_sdma,
+    hsa_amd_queue_priority_t priority);
+
+/**
+ * @brief Engine leading a gang copy.  The leader decrements the completion
+ * signal once every engine of the gang has finished its part.
+ */
+typedef enum {
+  /**
+   * The engine ::hsa_amd_memory_async_copy would use for the copy.
+   */
+  HSA_AMD_GANG_LEADER_DEFAULT = 0,
+  /**
+   * The engine with the least queued work.
+   */
+  HSA_AMD_GANG_LEADER_LEAST_BUSY = 1,
+  /**
+   * The engine named by ::hsa_amd_gang_copy_policy_t::leader_engine.
+   */
+  HSA_AMD_GANG_LEADER_ENGINE = 2
+} hsa_amd_gang_leader_t;
+
+/**
+ * @brief How ::hsa_amd_memory_async_copy_gang splits a copy across SDMA
+ * engines.
+ */
+typedef struct hsa_amd_gang_copy_policy_s {
+  /**
+   * Number of engines sharing the copy.  0 uses the bandwidth factor of the
+   * xGMI link between the agents, 1 for other links.  Limited to the engines
+   * that can serve the copy direction and to one engine per 4KB copied.
+   */
+  uint32_t width;
+  hsa_amd_gang_leader_t leader;
+  /**
+   * Leading engine with ::HSA_AMD_GANG_LEADER_ENGINE, ignored otherwise.
+   */
+  hsa_amd_sdma_engine_id_t leader_engine;
+} hsa_amd_gang_copy_policy_t;
+
+/**
+ * @brief Asynchronously copy memory split evenly across several SDMA engines.
+ *
+ * @details Behaves as ::hsa_amd_memory_async_copy with the copy divided into
+ * one contiguous part per engine of the gang.  Engines other than the leader
+ * are picked from the idle ones first.  Bulk transfers between xGMI peers can
+ * use several links at once this way.  The runtime already gangs some peer
+ * copies implicitly, this call makes the width and leader explicit and applies
+ * to any copy direction served by more than one SDMA engine.  Copies that
+ * would not run on SDMA, or with a width of 1, are not split.
+ *
+ * @param[in] policy Gang width and leader selection.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p policy is NULL, its leader
+ * is not a valid ::hsa_amd_gang_leader_t value, ::HSA_AMD_GANG_LEADER_ENGINE
+ * names an engine that can not serve the copy direction, or as for
+ * ::hsa_amd_memory_async_copy.
+ *
+ * Other return values are as for ::hsa_amd_memory_async_copy.
+ */
+hsa_status_t HSA_API hsa_amd_memory_async_copy_gang(
+    void* dst, hsa_agent_t dst_agent, const void* src, hsa_agent_t src_agent, size_t size,
+    uint32_t num_dep_signals, const hsa_signal_t* dep_signals, hsa_signal_t completion_signal,
+    const hsa_amd_gang_copy_policy_t* policy);
+
+/**
+ * @brief Operation recorded by a copy list command.
+ */
+typedef enum {
+  /**
+   * Copy @p size bytes from @p src to @p dst.
+   */
+  HSA_AMD_COPY_COMMAND_COPY = 0,
+  /**
+   * Set @p count uint32_t elements at @p ptr to @p value.
+   */
+  HSA_AMD_COPY_COMMAND_FILL = 1,
+  /**
+   * Block the engine until the value of @p signal equals @p value.
+   */
+  HSA_AMD_COPY_COMMAND_WAIT = 2,
+  /**
+   * Decrement the value of @p signal by one.
+   */
+  HSA_AMD_COPY_COMMAND_SIGNAL = 3
+} hsa_amd_copy_command_type_t;
+
+/**
+ * @brief A single command of a copy list.
+ */
+typedef struct hsa_amd_copy_command_s {
+  /**
+   * Operation performed by the command.  Selects the union member used.
+   */
+  hsa_amd_copy_command_type_t type;
+  union {
+    struct {
+      void* dst;
+      const void* src;
+      size_t size;
+    } copy;
+    struct {
+      void* ptr;
+      uint32_t value;
+      size_t count;
+    } fill;
+    struct {
+      hsa_signal_t signal;
+      hsa_signal_value_t value;
+    } wait;
+    struct {
+      hsa_signal_t signal;
+    } signal;
+  };
+} hsa_amd_copy_command_t;
+
+/**
+ * @brief Opaque handle to a recorded copy list.
+ */
+typedef struct hsa_amd_copy_list_s {
+  uint64_t handle;
+} hsa_amd_copy_list_t;
+
+/**
+ * @brief Record a sequence of copy, fill, wait and signal commands for an
+ * SDMA engine.
+ *
+ * @details The commands are encoded once into an SDMA packet stream which
+ * ::hsa_amd_copy_list_submit places on the engine's ring as a single
+ * submission, so a list of small operations costs one reservation, one
+ * completion sequence and one doorbell.  Where possible the stream is
+ * captured into an indirect buffer, so a submission only writes a launch
+ * packet and the completion sequence to the ring whatever the size of the
+ * list.  Commands execute in order.  A list may be submitted any number of
+ * times.  Memory and signals referenced by the commands must remain valid for
+ * as long as the list is submitted.
+ *
+ * @param[in] agent GPU agent that owns the engine.
+ *
+ * @param[in] engine_id SDMA engine of @p agent, as returned by
+ * ::hsa_amd_memory_copy_engine_status.
+ *
+ * @param[in] commands Array of @p num_commands commands.
+ *
+ * @param[in] num_commands Number of commands.
+ *
+ * @param[out] list Handle of the recorded list.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The list has been recorded.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is not a GPU agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL A wait or signal command names an
+ * invalid signal.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p engine_id is not an SDMA
+ * engine of @p agent, @p commands or @p list is NULL, a command has an
+ * unknown type or NULL or misaligned pointers, or a signal command was given
+ * on a platform without PCIe atomics.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The engine is not available for
+ * SDMA, or the encoded list does not fit in a single submission.
+ */
+hsa_status_t HSA_API hsa_amd_copy_list_create(hsa_agent_t agent,
+                                              hsa_amd_sdma_engine_id_t engine_id,
+                                              const hsa_amd_copy_command_t* commands,
+                                              uint32_t num_commands, hsa_amd_copy_list_t* list);
+
+/**
+ * @brief Submit a recorded copy list to its engine.
+ *
+ * @details The list starts once all @p dep_signals are 0 and
+ * @p completion_signal is decremented when all of its commands have
+ * completed.  The call does not block.
+ *
+ * @param[in] list Recorded copy list.
+ *
+ * @param[in] num_dep_signals Number of dependent signals.
+ *
+ * @param[in] dep_signals Array of @p num_dep_signals dependent signals.
+ *
+ * @param[in] completion_signal Signal decremented on completion.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The list has been submitted.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p list is invalid, or
+ * @p dep_signals is NULL while @p num_dep_signals is not 0.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL A signal is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_copy_list_submit(hsa_amd_copy_list_t list, uint32_t num_dep_signals,
+                                              const hsa_signal_t* dep_signals,
+                                              hsa_signal_t completion_signal);
+
+/**
+ * @brief Destroy a recorded copy list.
+ *
+ * @details Submissions already made are not affected.  The call may block
+ * until the engine has executed them.
+ *
+ * @param[in] list Recorded copy list.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The list has been destroyed.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p list is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_copy_list_destroy(hsa_amd_copy_list_t list);
+
+/**
+ * @brief Opaque handle to a copy context.
+ */
+typedef struct hsa_amd_copy_context_s {
+  uint64_t handle;
+} hsa_amd_copy_context_t;
+
+/**
+ * @brief Bind a copy context to an SDMA engine of @p agent.
+ *
+ * @details The engine is chosen once, at creation, among @p engine_ids_mask,
+ * preferring an engine no other copy is using.  Copies submitted on the
+ * context with ::hsa_amd_copy_context_submit go straight to that engine
+ * without engine selection and execute in submission order, so a stream of
+ * dependent copies needs no signals between them.  Several contexts may share
+ * an engine.  When HSA_SDMA_CONTEXT_RING=1 each context creates a queue of its
+ * own on the engine, so contexts driven from different threads do not share a
+ * ring; destroying such a context waits for its copies to complete.
+ *
+ * @param[in] agent GPU agent that owns the engines.
+ *
+ * @param[in] engine_ids_mask Set of SDMA engines of @p agent, as returned by
+ * ::hsa_amd_memory_copy_engine_status.
+ *
+ * @param[out] context Handle of the new context.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The context has been created.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is not a GPU agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p context is NULL, or
+ * @p engine_ids_mask is 0 or names engines @p agent does not have.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The chosen engine is not
+ * available for SDMA.
+ */
+hsa_status_t HSA_API hsa_amd_copy_context_create(hsa_agent_t agent, uint32_t engine_ids_mask,
+                                                 hsa_amd_copy_context_t* context);
+
+/**
+ * @brief Copy @p size bytes on the engine of a copy context.
+ *
+ * @details Both buffers must be accessible to the agent that owns the context
+ * as for ::hsa_amd_memory_async_copy_on_engine.  The copy starts once all
+ * @p dep_signals are 0 and after every copy previously submitted on the
+ * context, and @p completion_signal is decremented when it has completed.
+ * The call does not block.
+ *
+ * @param[in] context Copy context.
+ *
+ * @param[in] dst Destination buffer.
+ *
+ * @param[in] src Source buffer.
+ *
+ * @param[in] size Number of bytes to copy.  A size of 0 is a no-op.
+ *
+ * @param[in] num_dep_signals Number of dependent signals.
+ *
+ * @param[in] dep_signals Array of @p num_dep_signals dependent signals.
+ *
+ * @param[in] completion_signal Signal decremented on completion.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The copy has been submitted.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p context is invalid, @p dst
+ * or @p src is NULL, or @p dep_signals is NULL while @p num_dep_signals is
+ * not 0.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL A signal is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_copy_context_submit(hsa_amd_copy_context_t context, void* dst,
+                                                 const void* src, size_t size,
+                                                 uint32_t num_dep_signals,
+                                                 const hsa_signal_t* dep_signals,
+                                                 hsa_signal_t completion_signal);
+
+/**
+ * @brief Destroy a copy context.
+ *
+ * @details Copies already submitted are not affected.
+ *
+ * @param[in] context Copy context.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The context has been destroyed.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p context is invalid.
+ */
+hsa_status_t HSA_API hsa_amd_copy_context_destroy(hsa_amd_copy_context_t context);
+
+/**
+ * @brief Hand a buffer of an AIE agent between the host and the device.
+ *
+ * @details Buffers allocated on an AIE agent start out host accessible: the
+ * runtime writes back and invalidates their CPU cache lines before and after
+ * every command that uses them.  Releasing a buffer to the device, with
+ * @p host_access false, syncs it once and lets commands skip it until the host
+ * takes it back with @p host_access true, which syncs it again so the host
+ * sees what the device wrote.  Buffers reused across many commands, such as
+ * resident weights, then stop paying the cache maintenance on every command.
+ * The host must not access a buffer while it is released to the device.
+ *
+ * @param[in] ptr Base address of a buffer allocated from a memory pool of an
+ * AIE agent.
+ *
+ * @param[in] host_access True before the host accesses the buffer, false once
+ * it is done with it.  Repeating the current state has no effect.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The buffer changed hands.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The system has no AIE agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION @p ptr is not the base of a
+ * buffer allocated on an AIE agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_aie_buffer_host_access(void* ptr, bool host_access);
+
+/** @} */
+
+/** \addtogroup memory Memory
+ *  @{
+ */
+
+/**
+ * @brief Deallocation notifier function type.
+ */
+typedef void (*hsa_amd_deallocation_callback_t)(void* ptr, void* user_data);
+
+/**
+ * @brief Registers a deallocation notifier monitoring for release of agent
+ * accessible address @p ptr.  If successful, @p callback will be invoked when
+ * @p ptr is removed from accessibility from all agents.
+ *
+ * Notification callbacks are automatically deregistered when they are invoked.
+ * They run on the freeing thread before the memory is released, unless
+ * HSA_DEFERRED_FREE_NOTIFY=1 is set.  Callbacks are then delivered in batches
+ * on a runtime thread, after the memory is released and possibly after its
+ * address was returned by another allocation.
+ *
+ * Note: The current version supports notifications of address release
+ * originating from ::hsa_amd_memory_pool_free.  Support for other address
+ * release APIs will follow.
+ *
+ * @param[in] ptr Agent accessible address to monitor for deallocation.  Passed
+ * to @p callback.
+ *
+ * @param[in] callback Notifier to be invoked when @p ptr is released from
+ * agent accessibility.
+ *
+ * @param[in] user_data User provided value passed to @p callback.  May be NULL.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The notifier registered successfully
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION @p ptr does not refer to a valid agent accessible
+ * address.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p callback is NULL or @p ptr is NULL.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
+ * necessary resources
+ */
+hsa_status_t HSA_API hsa_amd_register_deallocation_callback(void* ptr,
+                                                    hsa_amd_deallocation_callback_t callback,
+                                                    void* user_data);
+
+/**
+ * @brief Removes a deallocation notifier previously registered with
+ * ::hsa_amd_register_deallocation_callback.  Arguments must be identical to
+ * those given in ::hsa_amd_register_deallocation_callback.
+ *
+ * @param[in] ptr Agent accessible address which was monitored for deallocation.
+ *
+ * @param[in] callback Notifier to be removed.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The notifier has been removed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT The given notifier was not registered.
+ */
+hsa_status_t HSA_API hsa_amd_deregister_deallocation_callback(void* ptr,
+                                                      hsa_amd_deallocation_callback_t callback);
+
+/**
+ * @brief Memory pressure levels reported to memory pressure callbacks.
+ */
+typedef enum {
+  /**
+   * Free memory of the agent fell below the watermark set with the
+   * HSA_MEMORY_PRESSURE_WATERMARK environment variable.  Reported once per
+   * crossing by a runtime thread.
+   */
+  HSA_AMD_MEMORY_PRESSURE_LOW = 0,
+  /**
+   * An allocation failed and will fail unless memory is released.  Reported on
+   * the allocating thread, which retries the allocation once every callback
+   * has returned.
+   */
+  HSA_AMD_MEMORY_PRESSURE_CRITICAL = 1
+} hsa_amd_memory_pressure_level_t;
+
+/**
+ * @brief Memory pressure callback.
+ *
+ * @param[in] agent Agent owning the memory under pressure.  For system memory
+ * this is the CPU agent owning the pool.
+ *
+ * @param[in] level Pressure level.
+ *
+ * @param[in] size Bytes the runtime is trying to make available.
+ *
+ * @param[in] data User data given at registration.
+ */
+typedef void (*hsa_amd_memory_pressure_callback_t)(hsa_agent_t agent,
+                                                   hsa_amd_memory_pressure_level_t level,
+                                                   size_t size, void* data);
+
+/**
+ * @brief Registers a callback asking the application to release memory.
+ *
+ * @details Under memory pressure the runtime first releases its own caches,
+ * cheapest to rebuild first: fragment allocator blocks and cached memory
+ * handles, scratch, pooled queues, then staging buffers and blocks held for
+ * ::hsa_amd_memory_pool_allocate_async.  Callbacks run only if that does not
+ * make @p size bytes available, in registration order.  A callback may free
+ * memory.  Allocations made from a callback do not invoke callbacks again.
+ *
+ * @param[in] callback Callback to register.
+ *
+ * @param[in] data User data passed to @p callback.  May be NULL.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The callback has been registered.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p callback is NULL.
+ */
+hsa_status_t HSA_API hsa_amd_register_memory_pressure_callback(
+    hsa_amd_memory_pressure_callback_t callback, void* data);
+
+/**
+ * @brief Removes a callback registered with
+ * ::hsa_amd_register_memory_pressure_callback.  Arguments must be identical to
+ * those given at registration.
+ *
+ * @param[in] callback Callback to remove.
+ *
+ * @param[in] data User data given at registration.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The callback has been removed.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT The callback was not registered.
+ */
+hsa_status_t HSA_API hsa_amd_deregister_memory_pressure_callback(
+    hsa_amd_memory_pressure_callback_t callback, void* data);
+
+typedef enum hsa_amd_svm_model_s {
+  /**
+   * Updates to memory with this attribute conform to HSA memory consistency
+   * model.
+   */
+  HSA_AMD_SVM_GLOBAL_FLAG_FINE_GRAINED = 0,
+  /**
+   * Writes to memory with this attribute can be performed by a single agent
+   * at a time.
+   */
+  HSA_AMD_SVM_GLOBAL_FLAG_COARSE_GRAINED = 1,
+  /**
+   * Memory region queried contains subregions with both
+   * HSA_AMD_SVM_GLOBAL_FLAG_COARSE_GRAINED and
+   * HSA_AMD_SVM_GLOBAL_FLAG_FINE_GRAINED attributes.
+   *
+   * This attribute can not be used in hsa_amd_svm_attributes_set.  It is a
+   * possible return from hsa_amd_svm_attributes_get indicating that the query
+   * region contains both coarse and fine grained memory.
+   */
+  HSA_AMD_SVM_GLOBAL_FLAG_INDETERMINATE = 2
+} hsa_amd_svm_model_t;
+
+typedef enum hsa_amd_svm_attribute_s {
+  // Memory model attribute.
+  // Type of this attribute is hsa_amd_svm_model_t.
+  HSA_AMD_SVM_ATTRIB_GLOBAL_FLAG = 0,
+  // Marks the range read only.  This allows multiple physical copies to be
+  // placed local to each accessing device.
+  // Type of this attribute is bool.
+  HSA_AMD_SVM_ATTRIB_READ_ONLY = 1,
+  // Automatic migrations should attempt to keep the memory within the xgmi hive
+  // containing accessible agents.
+  // Type of this attribute is bool.
+  HSA_AMD_SVM_ATTRIB_HIVE_LOCAL = 2,
+  // Page granularity to migrate at once.  Page granularity is specified as
+  // log2(page_count).
+  // Type of this attribute is uint64_t.
+  HSA_AMD_SVM_ATTRIB_MIGRATION_GRANULARITY = 3,
+  // Physical location to prefer when automatic migration occurs.
+  // Set to the null agent handle (handle == 0) to indicate there
+  // is no preferred location.
+  // Type of this attribute is hsa_agent_t.
+  HSA_AMD_SVM_ATTRIB_PREFERRED_LOCATION = 4,
+  // This attribute can not be used in ::hsa_amd_svm_attributes_set (see
+  // ::hsa_amd_svm_prefetch_async).
+  // Queries the physical location of most recent prefetch command.
+  // If the prefetch location has not been set or is not uniform across the
+  // address range then returned hsa_agent_t::handle will be 0.
+  // Querying this attribute will return the destination agent of the most
+  // recent ::hsa_amd_svm_prefetch_async targeting the address range.  If
+  // multiple async prefetches have been issued targeting the region and the
+  // most recently issued prefetch has completed then the query will return
+  // the location of the most recently completed prefetch.
+  // Type of this attribute is hsa_agent_t.
+  HSA_AMD_SVM_ATTRIB_PREFETCH_LOCATION = 5,
+  // Optimizes with the anticipation that the majority of operations to the
+  // range will be read operations.
+  // Type of this attribute is bool.
+  HSA_AMD_SVM_ATTRIB_READ_MOSTLY = 6,
+  // Allows the execution on GPU.
+  // Type of this attribute is bool.
+  HSA_AMD_SVM_ATTRIB_GPU_EXEC = 7,
+  // This attribute can not be used in ::hsa_amd_svm_attributes_get.
+  // Enables an agent for access to the range.  Access may incur a page fault
+  // and associated memory migration.  Either this or
+  // HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE_IN_PLACE is required prior to SVM
+  // access if HSA_AMD_SYSTEM_INFO_SVM_ACCESSIBLE_BY_DEFAULT is false.
+  // Type of this attribute is hsa_agent_t.
+  HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE = 0x200,
+  // This attribute can not be used in ::hsa_amd_svm_attributes_get.
+  // Enables an agent for access to the range without page faults.  Access
+  // will not incur a page fault and will not cause access based migration.
+  // and associated memory migration.  Either this or
+  // HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE is required prior to SVM access if
+  // HSA_AMD_SYSTEM_INFO_SVM_ACCESSIBLE_BY_DEFAULT is false.
+  // Type of this attribute is hsa_agent_t.
+  HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE_IN_PLACE = 0x201,
+  // This attribute can not be used in ::hsa_amd_svm_attributes_get.
+  // Denies an agent access to the memory range.  Access will cause a terminal
+  // segfault.
+  // Type of this attribute is hsa_agent_t.
+  HSA_AMD_SVM_ATTRIB_AGENT_NO_ACCESS = 0x202,
+  // This attribute can not be used in ::hsa_amd_svm_attributes_set.
+  // Returns the access attribute associated with the agent.
+  // The agent to query must be set in the attribute value field.
+  // The attribute enum will be replaced with the agent's current access
+  // attribute for the address range.
+  // TODO: Clarify KFD return value for non-uniform access attribute.
+  // Type of this attribute is hsa_agent_t.
+  HSA_AMD_SVM_ATTRIB_ACCESS_QUERY = 0x203,
+} hsa_amd_svm_attribute_t;
+
+// List type for hsa_amd_svm_attributes_set/get. 
+typedef struct hsa_amd_svm_attribute_pair_s {
+  // hsa_amd_svm_attribute_t value.
+  uint64_t attribute;
+  // Attribute value.  Bit values should be interpreted according to the type
+  // given in the associated attribute description.
+  uint64_t value;
+} hsa_amd_svm_attribute_pair_t;
 
 /**
+ * @brief Sets SVM memory attributes.
  *
- * @brief Pin a host pointer allocated by C/C++ or OS allocator (i.e. ordinary system DRAM) and
- * return a new pointer accessible by the @p agents. If the @p host_ptr overlaps with previously
- * locked memory, then the overlap area is kept locked (i.e. multiple mappings are permitted).
- * In this case, the same input @p host_ptr may give different locked @p agent_ptr and when it
- * does, they are not necessarily coherent (i.e. accessing either @p agent_ptr is not equivalent).
- * Acesses to the memory via @p agent_ptr have the same access properties as memory allocated from
- * @p pool as determined by ::hsa_amd_memory_pool_get_info and ::hsa_amd_agent_memory_pool_get_info
- * (ex. coarse/fine grain, platform atomic support, link info).  Physical composition and placement
- * of the memory (ex. page size, NUMA binding) is not changed.
+ * If HSA_AMD_SYSTEM_INFO_SVM_ACCESSIBLE_BY_DEFAULT returns false then enabling
+ * access to an Agent via this API (setting HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE
+ * or HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE_IN_PLACE) is required prior to SVM
+ * memory access by that Agent.
  *
- * @param[in] host_ptr A buffer allocated by C/C++ or OS allocator.
+ * Attributes HSA_AMD_SVM_ATTRIB_ACCESS_QUERY and HSA_AMD_SVM_ATTRIB_PREFETCH_LOCATION
+ * may not be used with this API.
  *
- * @param[in] size The size to be locked.
+ * @param[in] ptr Will be aligned down to nearest page boundary.
  *
- * @param[in] agents Array of agent handle to gain access to the @p host_ptr.
- * If this parameter is NULL and the @p num_agent is 0, all agents
- * in the platform will gain access to the @p host_ptr.
+ * @param[in] size Will be aligned up to nearest page boundary.
  *
- * @param[in] pool Global memory pool owned by a CPU agent.
+ * @param[in] attribute_list List of attributes to set for the address range.
  *
- * @param[in] flags A bit-field that is used to specify allocation
- * directives. Reserved parameter, must be 0.
+ * @param[in] attribute_count Length of @p attribute_list.
+ */
+hsa_status_t hsa_amd_svm_attributes_set(void* ptr, size_t size,
+                                        hsa_amd_svm_attribute_pair_t* attribute_list,
+                                        size_t attribute_count);
+
+/**
+ * @brief Gets SVM memory attributes.
  *
- * @param[out] agent_ptr Pointer to the location where to store the new address.
+ * Attributes HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE,
+ * HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE_IN_PLACE and
+ * HSA_AMD_SVM_ATTRIB_PREFETCH_LOCATION may not be used with this API.
  *
- * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ * Note that attribute HSA_AMD_SVM_ATTRIB_ACCESS_QUERY takes as input an
+ * hsa_agent_t and returns the current access type through its attribute field.
  *
- * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
- * initialized.
+ * @param[in] ptr Will be aligned down to nearest page boundary.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES There is a failure in
- * allocating the necessary resources.
+ * @param[in] size Will be aligned up to nearest page boundary.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_AGENT One or more agent in @p agents is
- * invalid or can not access @p pool.
+ * @param[in] attribute_list List of attributes to set for the address range.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL @p pool is invalid or not owned
- * by a CPU agent.
+ * @param[in] attribute_count Length of @p attribute_list.
+ */
+hsa_status_t hsa_amd_svm_attributes_get(void* ptr, size_t size,
+                                        hsa_amd_svm_attribute_pair_t* attribute_list,
+                                        size_t attribute_count);
+
+/**
+ * @brief Asynchronously migrates memory to an agent.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p size is 0 or @p host_ptr or
- * @p agent_ptr is NULL or @p agents not NULL but @p num_agent is 0 or @p agents
- * is NULL but @p num_agent is not 0 or flags is not 0.
+ * Schedules memory migration to @p agent when @p dep_signals have been observed equal to zero.
+ * @p completion_signal will decrement when the migration is complete.
+ *
+ * @param[in] ptr Will be aligned down to nearest page boundary.
+ *
+ * @param[in] size Will be aligned up to nearest page boundary.
+ *
+ * @param[in] agent Agent to migrate to.
+ *
+ * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the migration
+ * operation starts. The migration will start after every signal has been observed with
+ * the value 0. If @p num_dep_signals is 0, this argument is ignored.
+ *
+ * @param[in] completion_signal Signal used to indicate completion of the migration
+ * operation. When the migration operation is finished, the value of the signal is
+ * decremented. The runtime indicates that an error has occurred during the copy
+ * operation by setting the value of the completion signal to a negative
+ * number. If no completion signal is required this handle may be null.
  */
-hsa_status_t HSA_API hsa_amd_memory_lock_to_pool(void* host_ptr, size_t size, hsa_agent_t* agents,
-                                                 int num_agent, hsa_amd_memory_pool_t pool,
-                                                 uint32_t flags, void** agent_ptr);
+hsa_status_t hsa_amd_svm_prefetch_async(void* ptr, size_t size, hsa_agent_t agent,
+                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
+                                        hsa_signal_t completion_signal);
+
+/**
+ * @brief One range of a batched prefetch, see ::hsa_amd_svm_prefetch_batch_async.
+ */
+typedef struct hsa_amd_svm_prefetch_range_s {
+  /**
+   * Start of the range, aligned down to the nearest page boundary.
+   */
+  void* ptr;
+  /**
+   * Size of the range, aligned up to the nearest page boundary.
+   */
+  size_t size;
+  /**
+   * Agent to migrate the range to.
+   */
+  hsa_agent_t agent;
+} hsa_amd_svm_prefetch_range_t;
 
 /**
+ * @brief Asynchronously migrates several address ranges, each to its own agent.
  *
- * @brief Unpin the host pointer previously pinned via ::hsa_amd_memory_lock or
- * ::hsa_amd_memory_lock_to_pool.
+ * Behaves as one ::hsa_amd_svm_prefetch_async per range sharing @p dep_signals and
+ * @p completion_signal, which is decremented once when every range has migrated.  Where ranges
+ * overlap the later entry in @p ranges determines the destination.  Adjacent and overlapping
+ * ranges with the same destination are merged so the driver is called once per resulting
+ * contiguous range.
  *
- * @details The behavior is undefined if the host pointer being unpinned does not
- * match previous pinned address or if the host pointer was already deallocated.
+ * @param[in] ranges Ranges to migrate.
  *
- * @param[in] host_ptr A buffer allocated by C/C++ or OS allocator that was
- * pinned previously via ::hsa_amd_memory_lock or ::hsa_amd_memory_lock_to_pool.
+ * @param[in] range_count Number of entries in @p ranges.
+ *
+ * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ *
+ * @param[in] dep_signals List of signals that must be waited on before the migration
+ * operation starts. If @p num_dep_signals is 0, this argument is ignored.
+ *
+ * @param[in] completion_signal Signal decremented when all migrations are complete.  If no
+ * completion signal is required this handle may be null.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The migration was scheduled.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p ranges is NULL or @p range_count is 0.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT A range names an invalid agent.
+ */
+hsa_status_t hsa_amd_svm_prefetch_batch_async(const hsa_amd_svm_prefetch_range_t* ranges,
+                                              size_t range_count, uint32_t num_dep_signals,
+                                              const hsa_signal_t* dep_signals,
+                                              hsa_signal_t completion_signal);
+
+/**
+ * @brief SVM profiler event record.
+ *
+ * @details With HSA_SVM_PROFILE_FORMAT=binary the file named by
+ * HSA_SVM_PROFILE receives one record per SMI event instead of a line of
+ * text.  GPUs are identified by their KFD gpu_id, 0 is the CPU.
+ */
+typedef struct hsa_amd_svm_event_record_s {
+  /**
+   * Event time in nanoseconds, as reported by the driver.
+   */
+  uint64_t timestamp;
+  /**
+   * SMI event id, HSA_SMI_EVENT_MIGRATE_START to HSA_SMI_EVENT_UNMAP_FROM_GPU.
+   */
+  uint32_t event;
+  /**
+   * Event specific cause: the migration, eviction or unmap trigger.  For a
+   * page fault start it is 1 for a write fault, for a page fault end it is 1
+   * if the fault was resolved by a migration.
+   */
+  uint32_t trigger;
+  /**
+   * Start of the affected address range, 0 for queue evictions and restores.
+   */
+  uint64_t address;
+  /**
+   * Size of the affected address range in bytes.  Page faults report one page.
+   */
+  uint64_t size;
+  /**
+   * Source of a migration, otherwise 0.
+   */
+  uint32_t src_gpu_id;
+  /**
+   * Destination of a migration, otherwise the GPU the event occurred on.
+   */
+  uint32_t dst_gpu_id;
+} hsa_amd_svm_event_record_t;
+
+/**
+ * @brief SVM profiler counts for one address range.
+ */
+typedef struct hsa_amd_svm_range_stats_s {
+  /**
+   * Start of the range, aligned to the range size.
+   */
+  uint64_t base;
+  /**
+   * Size of the range, as set by HSA_SVM_PROFILE_AGGREGATE.
+   */
+  uint64_t size;
+  /**
+   * Completed migrations touching the range.
+   */
+  uint64_t migrations;
+  /**
+   * Bytes of the range migrated.
+   */
+  uint64_t migrated_bytes;
+  /**
+   * GPU page faults within the range.
+   */
+  uint64_t page_faults;
+  /**
+   * Unmaps from GPUs touching the range.
+   */
+  uint64_t unmaps;
+} hsa_amd_svm_range_stats_t;
+
+/**
+ * @brief Read the per address range SVM profiler counts.
+ *
+ * @details Setting HSA_SVM_PROFILE_AGGREGATE to a size in bytes makes the SVM
+ * profiler count migrations, page faults and unmaps for each range of that
+ * size, with or without an HSA_SVM_PROFILE file.  The size is rounded up to a
+ * power of two of at least one page.  Ranges are returned in address order,
+ * and only ranges with at least one event are reported.  Counts are totals
+ * since the runtime was loaded.  Without HSA_SVM_PROFILE_AGGREGATE no ranges
+ * are reported.
+ *
+ * @param[out] ranges Array receiving up to @p max_ranges entries.  May be
+ * NULL if @p max_ranges is 0.
+ *
+ * @param[in] max_ranges Capacity of @p ranges.
+ *
+ * @param[out] range_count Total number of ranges with events, which may be
+ * larger than @p max_ranges.
  *
  * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
- * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
- * initialized.
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p range_count is NULL, or
+ * @p ranges is NULL while @p max_ranges is not 0.
+ */
+hsa_status_t HSA_API hsa_amd_svm_profile_get_ranges(hsa_amd_svm_range_stats_t* ranges,
+                                                    uint32_t max_ranges, uint32_t* range_count);
+
+/** @} */
+
+/** \addtogroup profile Profiling
+ *  @{
+ */
+
+/**
+ * @brief Acquire Stream Performance Monitor on an agent
+ *
+ * Acquire exclusive use of SPM on @p preferred_agent.
+ * See hsa_amd_spm_set_dest_buffer to provide a destination buffer to KFD to start recording and
+ * retrieve this data.
+ * @param[in] preferred_agent Agent on which to acquire SPM
+ */
+hsa_status_t hsa_amd_spm_acquire(hsa_agent_t preferred_agent);
+
+/**
+ * @brief Release Stream Performance Monitor on an agent
+ *
+ * Release exclusive use of SPM on @p preferred_agent. This will stop KFD writing SPM data.
+ * If a destination buffer is set, then data in the destination buffer is available to user
+ * when this function returns.
+ *
+ * @param[in] preferred_agent Agent on which to release SPM
  */
-hsa_status_t HSA_API hsa_amd_memory_unlock(void* host_ptr);
+hsa_status_t hsa_amd_spm_release(hsa_agent_t preferred_agent);
 
 /**
- * @brief Sets the first @p count of uint32_t of the block of memory pointed by
- * @p ptr to the specified @p value.
- *
- * @param[in] ptr Pointer to the block of memory to fill.
+ * @brief  Set up the current destination user mode buffer for stream performance
+ * counter data. KFD will start writing SPM data into the destination buffer. KFD will continue
+ * to copy data into the current destination buffer until any of the following functions are called
+ * - hsa_amd_spm_release
+ * - hsa_amd_spm_set_dest_buffer with dest set to NULL
+ * - hsa_amd_spm_set_dest_buffer with dest set to a new buffer
  *
- * @param[in] value Value to be set.
+ * if @p timeout is non-0, the call will wait for up to @p timeout ms for the previous
+ * buffer to be filled. If previous buffer to be filled before timeout, the @p timeout
+ * will be updated value with the time remaining. If the timeout is exceeded, the function
+ * copies any partial data available into the previous user buffer and returns success.
+ * User should not access destination data while KFD is copying data.
+ * If the previous destination buffer was full, then @p is_data_loss flag is set.
+ * @p dest is CPU accessible memory. It could be malloc'ed memory or host allocated memory
  *
- * @param[in] count Number of uint32_t element to be set to the value.
+ * @param[in] preferred_agent Agent on which to set the dest buffer
  *
- * @retval HSA_STATUS_SUCCESS The function has been executed successfully.
+ * @param[in] size_in_bytes size of the buffer
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
- * initialized.
+ * @param[in/out] timeout timeout in milliseconds
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is NULL or
- * not 4 bytes aligned
+ * @param[out] size_copied number of bytes copied
  *
- * @retval HSA_STATUS_ERROR_INVALID_ALLOCATION if the given memory
- * region was not allocated with HSA runtime APIs.
+ * @param[in] dest destination address. Set to NULL to stop copy on previous buffer
  *
+ * @param[out] is_data_loss true is data was lost
  */
-hsa_status_t HSA_API
-    hsa_amd_memory_fill(void* ptr, uint32_t value, size_t count);
+hsa_status_t hsa_amd_spm_set_dest_buffer(hsa_agent_t preferred_agent, size_t size_in_bytes,
+                                         uint32_t* timeout, uint32_t* size_copied, void* dest,
+                                         bool* is_data_loss);
 
 /**
- * @brief Maps an interop object into the HSA flat address space and establishes
- * memory residency.  The metadata pointer is valid during the lifetime of the
- * map (until hsa_amd_interop_unmap_buffer is called).
- * Multiple calls to hsa_amd_interop_map_buffer with the same interop_handle
- * result in multiple mappings with potentially different addresses and
- * different metadata pointers.  Concurrent operations on these addresses are
- * not coherent.  Memory must be fenced to system scope to ensure consistency,
- * between mappings and with any views of this buffer in the originating
- * software stack.
- *
- * @param[in] num_agents Number of agents which require access to the memory
+ * @brief Callback receiving a filled buffer of an SPM stream.
  *
- * @param[in] agents List of accessing agents.
+ * @param[in] agent Agent the data was recorded on.
  *
- * @param[in] interop_handle Handle of interop buffer (dmabuf handle in Linux)
+ * @param[in] data SPM data.  Only valid until the callback returns.
  *
- * @param [in] flags Reserved, must be 0
+ * @param[in] size Size of @p data in bytes.
  *
- * @param[out] size Size in bytes of the mapped object
+ * @param[in] data_loss True if data was lost before this buffer, because the
+ * stream fell behind.
  *
- * @param[out] ptr Base address of the mapped object
+ * @param[in] user_data User data passed to ::hsa_amd_spm_stream_start.
+ */
+typedef void (*hsa_amd_spm_stream_callback_t)(hsa_agent_t agent, const void* data, size_t size,
+                                              bool data_loss, void* user_data);
+
+/**
+ * @brief Start a runtime managed Stream Performance Monitor capture on an
+ * agent.
  *
- * @param[out] metadata_size Size of metadata in bytes, may be NULL
+ * @details Acquires SPM on @p agent and keeps KFD supplied with destination
+ * buffers from a ring of @p buffer_count buffers of @p buffer_size bytes, so
+ * that no samples are lost while buffers are consumed.  A runtime thread hands
+ * each filled buffer to @p callback and, if @p file is not NULL, appends it to
+ * @p file.  Buffers are handed over when full and at least every 100ms.
  *
- * @param[out] metadata Pointer to metadata, may be NULL
+ * Each buffer written to @p file is a 16 byte header of uint32_t values
+ * {0x4D505348 ("HSPM"), data size, encoded size, data loss} followed by the
+ * encoded data.  The data is encoded as 32 bit words: a word with the top bit
+ * set is followed by one word repeated (word & 0x7FFFFFFF) times, otherwise
+ * the word counts the literal words that follow it.  A data size that is not a
+ * multiple of 4 ends with the remaining bytes stored as they are.
  *
- * @retval HSA_STATUS_SUCCESS if successfully mapped
+ * The stream holds SPM until ::hsa_amd_spm_stream_stop, so it may not be
+ * combined with ::hsa_amd_spm_acquire on the same agent.
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ * @param[in] agent GPU agent to record.
  *
- * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
- * necessary resources
+ * @param[in] buffer_size Size of each buffer in bytes.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT all other errors
- */
-hsa_status_t HSA_API hsa_amd_interop_map_buffer(uint32_t num_agents,
-                                        hsa_agent_t* agents,
-                                        int interop_handle,
-                                        uint32_t flags,
-                                        size_t* size,
-                                        void** ptr,
-                                        size_t* metadata_size,
-                                        const void** metadata);
-
-/**
- * @brief Removes a previously mapped interop object from HSA's flat address space.
- * Ends lifetime for the mapping's associated metadata pointer.
- */
-hsa_status_t HSA_API hsa_amd_interop_unmap_buffer(void* ptr);
-
-/**
- * @brief Denotes the type of memory in a pointer info query.
- */
-typedef enum {
-  /*
-  Memory is not known to the HSA driver.  Unallocated or unlocked system memory.
-  */
-  HSA_EXT_POINTER_TYPE_UNKNOWN = 0,
-  /*
-  Memory was allocated with an HSA memory allocator.
-  */
-  HSA_EXT_POINTER_TYPE_HSA = 1,
-  /*
-  System memory which has been locked for use with an HSA agent.
-
-  Memory of this type is normal malloc'd memory and is always accessible to
-  the CPU.  Pointer info queries may not include CPU agents in the accessible
-  agents list as the CPU has implicit access.
-  */
-  HSA_EXT_POINTER_TYPE_LOCKED = 2,
-  /*
-  Memory originated in a graphics component and is shared with ROCr.
-  */
-  HSA_EXT_POINTER_TYPE_GRAPHICS = 3,
-  /*
-  Memory has been shared with the local process via ROCr IPC APIs.
-  */
-  HSA_EXT_POINTER_TYPE_IPC = 4
-} hsa_amd_pointer_type_t;
-
-/**
- * @brief Describes a memory allocation known to ROCr.
- * Within a ROCr major version this structure can only grow.
- */
-typedef struct hsa_amd_pointer_info_s {
-  /*
-  Size in bytes of this structure.  Used for version control within a major ROCr
-  revision.  Set to sizeof(hsa_amd_pointer_t) prior to calling
-  hsa_amd_pointer_info.  If the runtime supports an older version of pointer
-  info then size will be smaller on return.  Members starting after the return
-  value of size will not be updated by hsa_amd_pointer_info.
-  */
-  uint32_t size;
-  /*
-  The type of allocation referenced.
-  */
-  hsa_amd_pointer_type_t type;
-  /*
-  Base address at which non-host agents may access the allocation. This field is
-  not meaningful if the type of the allocation is HSA_EXT_POINTER_TYPE_UNKNOWN.
-  */
-  void* agentBaseAddress;
-  /*
-  Base address at which the host agent may access the allocation. This field is
-  not meaningful if the type of the allocation is HSA_EXT_POINTER_TYPE_UNKNOWN.
-  */
-  void* hostBaseAddress;
-  /*
-  Size of the allocation. This field is not meaningful if the type of the allocation
-  is HSA_EXT_POINTER_TYPE_UNKNOWN.
-  */
-  size_t sizeInBytes;
-  /*
-  Application provided value. This field is not meaningful if the type of the
-  allocation is HSA_EXT_POINTER_TYPE_UNKNOWN.
-  */
-  void* userData;
-  /*
-  Reports an agent which "owns" (ie has preferred access to) the pool in which the
-  allocation was
-  made.  When multiple agents share equal access to a pool (ex: multiple CPU agents, or multi-die
-  GPU boards) any such agent may be returned. This field is not meaningful if
-  the type of the allocation is HSA_EXT_POINTER_TYPE_UNKNOWN or if this agent is not available in
-  this process, for e.g if this agent is masked using ROCR_VISIBLE_DEVICES.
-  */
-  hsa_agent_t agentOwner;
-  /*
-  Contains a bitfield of hsa_amd_memory_pool_global_flag_t values.
-  Reports the effective global flags bitmask for the allocation.  This field is not
-  meaningful if the type of the allocation is HSA_EXT_POINTER_TYPE_UNKNOWN.
-  */
-  uint32_t global_flags;
-} hsa_amd_pointer_info_t;
-
-/**
- * @brief Retrieves information about the allocation referenced by the given
- * pointer.  Optionally returns the number and list of agents which can
- * directly access the allocation. In case this virtual address is unknown, the
- * pointer type returned will be HSA_EXT_POINTER_TYPE_UNKNOWN and the only fields
- * that are valid after hsa_amd_pointer_info returns are size and type.
+ * @param[in] buffer_count Number of buffers, at least 2.
  *
- * @param[in] ptr Pointer which references the allocation to retrieve info for.
+ * @param[in] callback Callback receiving the data, may be NULL if @p file is
+ * not NULL.
  *
- * @param[in, out] info Pointer to structure to be filled with allocation info.
- * Data member size must be set to the size of the structure prior to calling
- * hsa_amd_pointer_info.  On return size will be set to the size of the
- * pointer info structure supported by the runtime, if smaller.  Members
- * beyond the returned value of size will not be updated by the API.
- * Must not be NULL.
+ * @param[in] user_data User data passed to @p callback.
  *
- * @param[in] alloc Function pointer to an allocator used to allocate the
- * @p accessible array.  If NULL @p accessible will not be returned.
+ * @param[in] file Path of a file receiving the encoded data, may be NULL.
  *
- * @param[out] num_agents_accessible Recieves the count of agents in
- * @p accessible.  If NULL @p accessible will not be returned.
+ * @retval ::HSA_STATUS_SUCCESS The stream has started.
  *
- * @param[out] accessible Recieves a pointer to the array, allocated by @p alloc,
- * holding the list of agents which may directly access the allocation.
- * May be NULL.
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval HSA_STATUS_SUCCESS Info retrieved successfully
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is not a GPU agent.
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p buffer_size is 0 or exceeds
+ * UINT32_MAX, @p buffer_count is less than 2, both @p callback and @p file are
+ * NULL or @p file could not be opened.
  *
- * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
- * necessary resources
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES A stream is already running on
+ * @p agent or the buffers could not be allocated.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT NULL in @p ptr or @p info.
+ * @retval ::HSA_STATUS_ERROR SPM could not be acquired.
  */
-hsa_status_t HSA_API hsa_amd_pointer_info(const void* ptr,
-                                          hsa_amd_pointer_info_t* info,
-                                          void* (*alloc)(size_t),
-                                          uint32_t* num_agents_accessible,
-                                          hsa_agent_t** accessible);
+hsa_status_t HSA_API hsa_amd_spm_stream_start(hsa_agent_t agent, size_t buffer_size,
+                                              uint32_t buffer_count,
+                                              hsa_amd_spm_stream_callback_t callback,
+                                              void* user_data, const char* file);
 
 /**
- * @brief Associates an arbitrary pointer with an allocation known to ROCr.
- * The pointer can be fetched by hsa_amd_pointer_info in the userData field.
- *
- * @param[in] ptr Pointer to the first byte of an allocation known to ROCr
- * with which to associate @p userdata.
+ * @brief Stop the SPM stream of an agent.
  *
- * @param[in] userdata Abitrary pointer to associate with the allocation.
+ * @details Hands the data recorded up to the call to the callback and the
+ * file, then releases SPM.  No callback runs after this returns.
  *
- * @retval HSA_STATUS_SUCCESS @p userdata successfully stored.
+ * @param[in] agent GPU agent of the stream.
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ * @retval ::HSA_STATUS_SUCCESS The stream has stopped.
  *
- * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
- * necessary resources
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr is not known to ROCr.
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is not a GPU agent or has
+ * no running stream.
  */
-hsa_status_t HSA_API hsa_amd_pointer_info_set_userdata(const void* ptr,
-                                                       void* userdata);
+hsa_status_t HSA_API hsa_amd_spm_stream_stop(hsa_agent_t agent);
 
-/**
- * @brief 256-bit process independent identifier for a ROCr shared memory
- * allocation.
+/** @} */
+
+/** \addtogroup memory Memory
+ *  @{
  */
-typedef struct hsa_amd_ipc_memory_s {
-  uint32_t handle[8];
-} hsa_amd_ipc_memory_t;
 
 /**
- * @brief Prepares an allocation for interprocess sharing and creates a
- * handle of type hsa_amd_ipc_memory_t uniquely identifying the allocation.  A
- * handle is valid while the allocation it references remains accessible in
- * any process.  In general applications should confirm that a shared memory
- * region has been attached (via hsa_amd_ipc_memory_attach) in the remote
- * process prior to releasing that memory in the local process.
- * Repeated calls for the same allocation may, but are not required to, return
- * unique handles. The allocation needs to be on memory on an agent of type
- * HSA_DEVICE_TYPE_GPU.
+ * @brief Obtains an OS specific, vendor neutral, handle to a memory allocation.
+ *
+ * Obtains an OS specific handle to GPU agent memory.  The memory must be part
+ * of a single allocation from an hsa_amd_memory_pool_t exposed by a GPU Agent.
+ * The handle may be used with other APIs (e.g. Vulkan) to obtain shared access
+ * to the allocation.
+ *
+ * Shared access to the memory is not guaranteed to be fine grain coherent even
+ * if the allocation exported is from a fine grain pool.  The shared memory
+ * consistency model will be no stronger than the model exported from, consult
+ * the importing API to determine the final consistency model.
+ *
+ * The allocation's memory remains valid as long as the handle and any mapping
+ * of the handle remains valid.  When the handle and all mappings are closed
+ * the backing memory will be released for reuse.
+ *
+ * Repeated exports of one allocation share the underlying dma-buf object.
+ * Each call still returns a new file descriptor which must be closed.
+ *
+ * @param[in] ptr Pointer to the allocation being exported.
+ *
+ * @param[in] size Size in bytes to export following @p ptr.  The entire range
+ * being exported must be contained within a single allocation.
+ *
+ * @param[out] dmabuf Pointer to a dma-buf file descriptor holding a reference to the
+ * allocation.  Contents will not be altered in the event of failure.
  *
- * @param[in] ptr Pointer to device memory allocated via ROCr APIs to prepare for
- * sharing.
+ * @param[out] offset Offset in bytes into the memory referenced by the dma-buf
+ * object at which @p ptr resides.  Contents will not be altered in the event
+ * of failure.
  *
- * @param[in] len Length in bytes of the allocation to share.
+ * @retval ::HSA_STATUS_SUCCESS Export completed successfully.
  *
- * @param[out] handle Process independent identifier referencing the shared
- * allocation.
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval HSA_STATUS_SUCCESS allocation is prepared for interprocess sharing.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT One or more arguments is NULL.
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION The address range described by
+ * @p ptr and @p size are not contained within a single allocation.
  *
- * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
- * necessary resources
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The allocation described by @p ptr
+ * and @p size was allocated on a device which can not export memory.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p ptr does not point to the
- * first byte of an allocation made through ROCr, or len is not the full length
- * of the allocation or handle is NULL.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The return file descriptor,
+ * @p dmabuf, could not be created.
  */
-hsa_status_t HSA_API hsa_amd_ipc_memory_create(void* ptr, size_t len,
-                                               hsa_amd_ipc_memory_t* handle);
+hsa_status_t hsa_amd_portable_export_dmabuf(const void* ptr, size_t size, int* dmabuf,
+                                            uint64_t* offset);
 
 /**
- * @brief Imports shared memory into the local process and makes it accessible
- * by the given agents.  If a shared memory handle is attached multiple times
- * in a process each attach may return a different address.  Each returned
- * address is refcounted and requires a matching number of calls to
- * hsa_amd_ipc_memory_detach to release the shared memory mapping.
+ * @brief Obtains one OS specific handle covering several ranges of a memory allocation.
  *
- * @param[in] handle Pointer to the identifier for the shared memory.
+ * As ::hsa_amd_portable_export_dmabuf for each range in @p ptrs and @p sizes, returning a single
+ * handle and the offset of each range within it.  Every range must be contained within the same
+ * allocation.
  *
- * @param[in] len Length of the shared memory to import.
- * Reserved.  Must be the full length of the shared allocation in this version.
+ * @param[in] ptrs Start of each range.
  *
- * @param[in] num_agents Count of agents in @p mapping_agents.
- * May be zero if all agents are to be allowed access.
+ * @param[in] sizes Size in bytes of each range.
  *
- * @param[in] mapping_agents List of agents to access the shared memory.
- * Ignored if @p num_agents is zero.
+ * @param[in] count Number of ranges.
  *
- * @param[out] mapped_ptr Recieves a process local pointer to the shared memory.
+ * @param[out] dmabuf Pointer to a dma-buf file descriptor holding a reference to the
+ * allocation.  Contents will not be altered in the event of failure.
  *
- * @retval HSA_STATUS_SUCCESS if memory is successfully imported.
+ * @param[out] offsets Array of @p count offsets in bytes into the memory referenced by the
+ * dma-buf object at which each range resides.  Contents will not be altered in the event of
+ * failure.
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ * @retval ::HSA_STATUS_SUCCESS Export completed successfully.
  *
- * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
- * necessary resources
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p handle is not valid, @p len is
- * incorrect, @p mapped_ptr is NULL, or some agent for which access was
- * requested can not access the shared memory.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT One or more arguments is NULL or
+ * @p count is 0.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION The ranges are not contained within a single
+ * allocation.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The allocation was allocated on a device which can
+ * not export memory.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The return file descriptor,
+ * @p dmabuf, could not be created.
  */
-hsa_status_t HSA_API hsa_amd_ipc_memory_attach(
-    const hsa_amd_ipc_memory_t* handle, size_t len,
-    uint32_t num_agents,
-    const hsa_agent_t* mapping_agents,
-    void** mapped_ptr);
+hsa_status_t hsa_amd_portable_export_dmabuf_bulk(const void* const* ptrs, const size_t* sizes,
+                                                 size_t count, int* dmabuf, uint64_t* offsets);
 
 /**
- * @brief Decrements the reference count for the shared memory mapping and
- * releases access to shared memory imported with hsa_amd_ipc_memory_attach.
+ * @brief Closes an OS specific, vendor neutral, handle to a memory allocation.
  *
- * @param[in] mapped_ptr Pointer to the first byte of a shared allocation
- * imported with hsa_amd_ipc_memory_attach.
+ * Closes an OS specific handle to GPU agent memory.
  *
- * @retval HSA_STATUS_SUCCESS if @p mapped_ptr was imported with
- * hsa_amd_ipc_memory_attach.
+ * Applications should close a handle after imports are complete.  The handle
+ * is not required to remain open for the lifetime of imported mappings.  The
+ * referenced allocation will remain valid until all handles and mappings
+ * are closed.
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ * @param[in] dmabuf Handle to be closed.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p mapped_ptr was not imported
- * with hsa_amd_ipc_memory_attach.
- */
-hsa_status_t HSA_API hsa_amd_ipc_memory_detach(void* mapped_ptr);
-
-/** @} */
-
-/** \addtogroup status Runtime notifications
- *  @{
- */
-
-/**
- * @brief 256-bit process independent identifier for a ROCr IPC signal.
+ * @retval ::HSA_STATUS_SUCCESS Handle closed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_RESOURCE_FREE A generic error was encountered
+ * when closing the handle.  The handle may have been closed already or an
+ * async IO error may have occured.
  */
-typedef hsa_amd_ipc_memory_t hsa_amd_ipc_signal_t;
+hsa_status_t hsa_amd_portable_close_dmabuf(int dmabuf);
 
 /**
- * @brief Obtains an interprocess sharing handle for a signal.  The handle is
- * valid while the signal it references remains valid in any process.  In
- * general applications should confirm that the signal has been attached (via
- * hsa_amd_ipc_signal_attach) in the remote process prior to destroying that
- * signal in the local process.
- * Repeated calls for the same signal may, but are not required to, return
- * unique handles.
+ * @brief Allocate a reserved address range
  *
- * @param[in] signal Signal created with attribute HSA_AMD_SIGNAL_IPC.
+ * Reserve a virtual address range. The size must be a multiple of the system page size.
+ * If it is not possible to allocate the address specified by @p address, then @p va will be
+ * a different address range.
+ * Address range should be released by calling hsa_amd_vmem_address_free.
  *
- * @param[out] handle Process independent identifier referencing the shared
- * signal.
+ * @param[out] va virtual address allocated
+ * @param[in] size of address range requested
+ * @param[in] address requested
+ * @param[in] flags currently unsupported
  *
- * @retval HSA_STATUS_SUCCESS @p handle is ready to use for interprocess sharing.
+ * @retval ::HSA_STATUS_SUCCESS Address range allocated successfully
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
- * necessary resources
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources to allocate an address
+ * range of this size.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p signal is not a valid signal
- * created with attribute HSA_AMD_SIGNAL_IPC or handle is NULL.
+ * Note that this API will be deprecated in a future release and replaced by
+ * hsa_amd_vmem_address_reserve_align
  */
-hsa_status_t HSA_API hsa_amd_ipc_signal_create(hsa_signal_t signal, hsa_amd_ipc_signal_t* handle);
+hsa_status_t hsa_amd_vmem_address_reserve(void** va, size_t size, uint64_t address,
+                                          uint64_t flags);
 
 /**
- * @brief Imports an IPC capable signal into the local process.  If an IPC
- * signal handle is attached multiple times in a process each attach may return
- * a different signal handle.  Each returned signal handle is refcounted and
- * requires a matching number of calls to hsa_signal_destroy to release the
- * shared signal.
- *
- * @param[in] handle Pointer to the identifier for the shared signal.
+ * @brief Allocate a reserved address range
  *
- * @param[out] signal Recieves a process local signal handle to the shared signal.
+ * Reserve a virtual address range. The size must be a multiple of the system page size.
+ * If it is not possible to allocate the address specified by @p address, then @p va will be
+ * a different address range.
+ * Address range should be released by calling hsa_amd_vmem_address_free.
  *
- * @retval HSA_STATUS_SUCCESS if the signal is successfully imported.
+ * @param[out] va virtual address allocated
+ * @param[in] size of address range requested
+ * @param[in] address requested
+ * @param[in] alignment requested. 0 for default. Must be >= page-size and a power of 2
+ * @param[in] flags currently unsupported
  *
- * @retval HSA_STATUS_ERROR_NOT_INITIALIZED if HSA is not initialized
+ * @retval ::HSA_STATUS_SUCCESS Address range allocated successfully
  *
- * @retval HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
- * necessary resources
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p handle is not valid.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources to allocate an address
+ * range of this size.
  */
-hsa_status_t HSA_API hsa_amd_ipc_signal_attach(const hsa_amd_ipc_signal_t* handle,
-                                               hsa_signal_t* signal);
+hsa_status_t hsa_amd_vmem_address_reserve_align(void** va, size_t size, uint64_t address,
+                                          uint64_t alignment, uint64_t flags);
 
 /**
- * @brief GPU system event type.
+ * @brief Free a reserved address range
+ *
+ * Free a previously allocated address range. The size must match the size of a previously
+ * allocated address range.
+ *
+ * @param[out] va virtual address to be freed
+ * @param[in] size of address range
+ *
+ * @retval ::HSA_STATUS_SUCCESS Address range released successfully
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid va specified
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT Invalid size specified
+ * @retval ::HSA_STATUS_ERROR_RESOURCE_FREE Address range is still in use
+ * @retval ::HSA_STATUS_ERROR Internal unexpected error
  */
-typedef enum hsa_amd_event_type_s {
-  /*
-   AMD GPU memory fault.
-   */
-  HSA_AMD_GPU_MEMORY_FAULT_EVENT = 0,
-  /*
-   AMD GPU HW Exception.
-   */
-  HSA_AMD_GPU_HW_EXCEPTION_EVENT,
-  /*
-   AMD GPU memory error.
-   */
-  HSA_AMD_GPU_MEMORY_ERROR_EVENT,
-} hsa_amd_event_type_t;
+hsa_status_t hsa_amd_vmem_address_free(void* va, size_t size);
 
 /**
- * @brief Flags denoting the cause of a memory fault.
+ * @brief Struct containing an opaque handle to a memory allocation handle
  */
+typedef struct hsa_amd_vmem_alloc_handle_s {
+  /**
+   * Opaque handle. Two handles reference the same object of the enclosing type
+   * if and only if they are equal.
+   */
+  uint64_t handle;
+} hsa_amd_vmem_alloc_handle_t;
+
 typedef enum {
-  // Page not present or supervisor privilege.
-  HSA_AMD_MEMORY_FAULT_PAGE_NOT_PRESENT = 1 << 0,
-  // Write access to a read-only page.
-  HSA_AMD_MEMORY_FAULT_READ_ONLY = 1 << 1,
-  // Execute access to a page marked NX.
-  HSA_AMD_MEMORY_FAULT_NX = 1 << 2,
-  // GPU attempted access to a host only page.
-  HSA_AMD_MEMORY_FAULT_HOST_ONLY = 1 << 3,
-  // DRAM ECC failure.
-  HSA_AMD_MEMORY_FAULT_DRAMECC = 1 << 4,
-  // Can't determine the exact fault address.
-  HSA_AMD_MEMORY_FAULT_IMPRECISE = 1 << 5,
-  // SRAM ECC failure (ie registers, no fault address).
-  HSA_AMD_MEMORY_FAULT_SRAMECC = 1 << 6,
-  // GPU reset following unspecified hang.
-  HSA_AMD_MEMORY_FAULT_HANG = 1U << 31
-} hsa_amd_memory_fault_reason_t;
+  MEMORY_TYPE_NONE,
+  MEMORY_TYPE_PINNED,
+} hsa_amd_memory_type_t;
 
 /**
- * @brief AMD GPU memory fault event data.
+ * @brief Create a virtual memory handle
+ *
+ * Create a virtual memory handle within this pool
+ * @p size must be a aligned to allocation granule size for this memory pool, see
+ * HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE
+ * To minimize internal memory fragmentation, align the size to the recommended allocation granule
+ * size, see HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_REC_GRANULE
+ *
+ * Handles released by the application may be recycled by a later call with the same pool, size
+ * and type, so the initial contents of the memory are undefined.
+ *
+ * @param[in] pool memory to use
+ * @param[in] size of the memory allocation
+ * @param[in] type of memory
+ * @param[in] flags - currently unsupported
+ * @param[out] memory_handle - handle for the allocation
+ *
+ * @retval ::HSA_STATUS_SUCCESS memory allocated successfully
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT Invalid arguments
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION This memory pool does not support allocations
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources to allocate this memory
  */
-typedef struct hsa_amd_gpu_memory_fault_info_s {
-  /*
-  The agent where the memory fault occurred.
-  */
-  hsa_agent_t agent;
-  /*
-  Virtual address accessed.
-  */
-  uint64_t virtual_address;
-  /*
-  Bit field encoding the memory access failure reasons. There could be multiple bits set
-  for one fault.  Bits are defined in hsa_amd_memory_fault_reason_t.
-  */
-  uint32_t fault_reason_mask;
-} hsa_amd_gpu_memory_fault_info_t;
+hsa_status_t hsa_amd_vmem_handle_create(hsa_amd_memory_pool_t pool, size_t size,
+                                        hsa_amd_memory_type_t type, uint64_t flags,
+                                        hsa_amd_vmem_alloc_handle_t* memory_handle);
 
 /**
- * @brief Flags denoting the cause of a memory error.
+ * @brief Release a virtual memory handle
+ *
+ * @param[in] memory handle that was previously allocated
+ *
+ * @retval ::HSA_STATUS_SUCCESS Address range allocated successfully
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid memory handle
  */
-typedef enum {
-  // Memory was in use by low-level HW component and cannot be released
-  HSA_AMD_MEMORY_ERROR_MEMORY_IN_USE = (1 << 0),
-} hsa_amd_memory_error_reason_t;
+hsa_status_t hsa_amd_vmem_handle_release(hsa_amd_vmem_alloc_handle_t memory_handle);
 
 /**
- * @brief AMD GPU memory error event data.
+ * @brief Map a virtual memory handle
+ *
+ * Map a virtual memory handle to a reserved address range. The virtual address requested must be
+ * within a previously reserved address range. @p va and (@p va + size) must be must be within
+ * (va + size) of the previous allocated address range.
+ * @p size must be equal to size of the @p memory_handle
+ * hsa_amd_vmem_set_access needs to be called to make the memory accessible to specific agents
+ *
+ * @param[in] va virtual address range where memory will be mapped
+ * @param[in] size of memory mapping
+ * @param[in] in_offset offset into memory. Currently unsupported
+ * @param[in] memory_handle virtual memory handle to be mapped
+ * @param[in] flags. Currently unsupported
+ *
+ * @retval ::HSA_STATUS_SUCCESS Memory mapped successfully
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT va, size or memory_handle are invalid
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources
+ *
+ * @retval ::HSA_STATUS_ERROR Unexpected internal error
  */
-typedef struct hsa_amd_gpu_memory_error_info_s {
-  /*
-  The agent where the memory error occurred.
-  */
-  hsa_agent_t agent;
-  /*
-  Virtual address involved.
-  */
-  uint64_t virtual_address;
-  /*
-  Bit field encoding the memory error failure reasons. There could be multiple bits set
-  for one error.  Bits are defined in hsa_amd_memory_error_reason_t.
-  */
-  uint32_t error_reason_mask;
-} hsa_amd_gpu_memory_error_info_t;
+hsa_status_t hsa_amd_vmem_map(void* va, size_t size, size_t in_offset,
+                              hsa_amd_vmem_alloc_handle_t memory_handle, uint64_t flags);
 
 /**
- * @brief Flags denoting the type of a HW exception
+ * @brief Unmap a virtual memory handle
+ *
+ * Unmap previously mapped virtual address range
+ *
+ * @param[in] va virtual address range where memory will be mapped
+ * @param[in] size of memory mapping
+ *
+ * @retval ::HSA_STATUS_SUCCESS Memory backing unmapped successfully
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION memory_handle is invalid
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT size is invalid
+ *
+ * @retval ::HSA_STATUS_ERROR Unexpected internal error
  */
-typedef enum {
-  // Unused for now
-  HSA_AMD_HW_EXCEPTION_RESET_TYPE_OTHER = 1 << 0,
-} hsa_amd_hw_exception_reset_type_t;
+hsa_status_t hsa_amd_vmem_unmap(void* va, size_t size);
 
-/**
- * @brief Flags denoting the cause of a HW exception
- */
-typedef enum {
-  // GPU Hang
-  HSA_AMD_HW_EXCEPTION_CAUSE_GPU_HANG = 1 << 0,
-  // SRAM ECC
-  HSA_AMD_HW_EXCEPTION_CAUSE_ECC = 1 << 1,
-} hsa_amd_hw_exception_reset_cause_t;
+typedef struct hsa_amd_memory_access_desc_s {
+  hsa_access_permission_t permissions;
+  hsa_agent_t agent_handle;
+} hsa_amd_memory_access_desc_t;
 
 /**
- * @brief AMD GPU HW Exception event data.
+ * @brief Make a memory mapping accessible
+ *
+ * Make previously mapped virtual address accessible to specific agents. @p size must be equal to
+ * size of previously mapped virtual memory handle.
+ * Calling hsa_amd_vmem_set_access multiple times on the same @p va:
+ *  - Will overwrite permissions for agents specified in @p desc
+ *  - Will leave permissions unchanged for agents not specified in @p desc
+ *
+ * @param[in] va previously mapped virtual address
+ * @param[in] size of memory mapping
+ * @param[in] desc list of access permissions for each agent
+ * @param[in] desc_cnt number of elements in desc
+ *
+ * @retval ::HSA_STATUS_SUCCESS
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT va, size or memory_handle are invalid
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION memory_handle is invalid
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT Invalid agent in desc
+ *
+ * @retval ::HSA_STATUS_ERROR Unexpected internal error
  */
-typedef struct hsa_amd_gpu_hw_exception_info_s {
-  /*
-  The agent where the HW exception occurred.
-  */
-  hsa_agent_t agent;
-  hsa_amd_hw_exception_reset_type_t reset_type;
-  hsa_amd_hw_exception_reset_cause_t reset_cause;
-} hsa_amd_gpu_hw_exception_info_t;
+hsa_status_t hsa_amd_vmem_set_access(void* va, size_t size,
+                                     const hsa_amd_memory_access_desc_t* desc,
+                                     size_t desc_cnt);
 
 /**
- * @brief AMD GPU event data passed to event handler.
+ * @brief Describes one mapping of hsa_amd_vmem_map_batch
  */
-typedef struct hsa_amd_event_s {
-  /*
-  The event type.
-  */
-  hsa_amd_event_type_t event_type;
-  union {
-    /*
-    The memory fault info, only valid when @p event_type is HSA_AMD_GPU_MEMORY_FAULT_EVENT.
-    */
-    hsa_amd_gpu_memory_fault_info_t memory_fault;
-    /*
-    The memory fault info, only valid when @p event_type is HSA_AMD_GPU_HW_EXCEPTION_EVENT.
-    */
-    hsa_amd_gpu_hw_exception_info_t hw_exception;
-    /*
-    The memory error info, only valid when @p event_type is HSA_AMD_GPU_MEMORY_ERROR_EVENT.
-    */
-    hsa_amd_gpu_memory_error_info_t memory_error;
-  };
-} hsa_amd_event_t;
-
-typedef hsa_status_t (*hsa_amd_system_event_callback_t)(const hsa_amd_event_t* event, void* data);
+typedef struct hsa_amd_vmem_map_desc_s {
+  /**
+   * Virtual address within a previously reserved address range
+   */
+  void* va;
+  /**
+   * Size of the mapping, equal to the size of @p handle
+   */
+  size_t size;
+  /**
+   * Offset into memory. Currently unsupported
+   */
+  size_t offset;
+  /**
+   * Virtual memory handle to be mapped
+   */
+  hsa_amd_vmem_alloc_handle_t handle;
+} hsa_amd_vmem_map_desc_t;
 
 /**
- * @brief Register AMD GPU event handler.
+ * @brief Map many virtual memory handles
  *
- * @param[in] callback Callback to be invoked when an event is triggered.
- * The HSA runtime passes two arguments to the callback: @p event
- * is defined per event by the HSA runtime, and @p data is the user data.
+ * Equivalent to calling hsa_amd_vmem_map for every element of @p maps, but much cheaper when
+ * building large address ranges out of many small handles. Either all mappings succeed or none is
+ * left in place.
  *
- * @param[in] data User data that is passed to @p callback. May be NULL.
+ * @param[in] maps list of mappings to create
+ * @param[in] map_cnt number of elements in maps
+ * @param[in] flags. Currently unsupported
  *
- * @retval HSA_STATUS_SUCCESS The handler has been registered successfully.
+ * @retval ::HSA_STATUS_SUCCESS Memory mapped successfully
  *
- * @retval HSA_STATUS_ERROR An event handler has already been registered.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT some va, size or handle in maps is invalid
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT @p event is invalid.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources
+ *
+ * @retval ::HSA_STATUS_ERROR Unexpected internal error
  */
-hsa_status_t HSA_API hsa_amd_register_system_event_handler(hsa_amd_system_event_callback_t callback,
-                                                   void* data);
-
-/** @} */
+hsa_status_t hsa_amd_vmem_map_batch(const hsa_amd_vmem_map_desc_t* maps, size_t map_cnt,
+                                    uint64_t flags);
 
-/** \addtogroup queue Queues
- *  @{
+/**
+ * @brief Virtual address range of hsa_amd_vmem_set_access_batch
  */
+typedef struct hsa_amd_vmem_range_s {
+  void* va;
+  size_t size;
+} hsa_amd_vmem_range_t;
 
 /**
- * @brief Per-queue dispatch and wavefront scheduling priority.
+ * @brief Make many memory mappings accessible
+ *
+ * Equivalent to calling hsa_amd_vmem_set_access with @p desc for every element of @p ranges.
+ * Each range may span several previously mapped handles.
+ *
+ * @param[in] ranges list of previously mapped virtual address ranges
+ * @param[in] range_cnt number of elements in ranges
+ * @param[in] desc list of access permissions for each agent
+ * @param[in] desc_cnt number of elements in desc
+ *
+ * @retval ::HSA_STATUS_SUCCESS
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT some range is invalid
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION some range is not fully mapped
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT Invalid agent in desc
+ *
+ * @retval ::HSA_STATUS_ERROR Unexpected internal error
  */
-typedef enum hsa_amd_queue_priority_s {
-  /*
-  Below normal/high priority compute and all graphics
-  */
-  HSA_AMD_QUEUE_PRIORITY_LOW = 0,
-  /*
-  Above low priority compute, below high priority compute and all graphics
-  */
-  HSA_AMD_QUEUE_PRIORITY_NORMAL = 1,
-  /*
-  Above low/normal priority compute and all graphics
-  */
-  HSA_AMD_QUEUE_PRIORITY_HIGH = 2,
-} hsa_amd_queue_priority_t;
+hsa_status_t hsa_amd_vmem_set_access_batch(const hsa_amd_vmem_range_t* ranges, size_t range_cnt,
+                                           const hsa_amd_memory_access_desc_t* desc,
+                                           size_t desc_cnt);
 
 /**
- * @brief Modifies the dispatch and wavefront scheduling prioirty for a
- * given compute queue. The default is HSA_AMD_QUEUE_PRIORITY_NORMAL.
+ * @brief Allocate memory whose physical backing interleaves across several
+ * memory pools.
  *
- * @param[in] queue Compute queue to apply new priority to.
+ * @details Reserves @p size bytes of virtual address space and backs it with
+ * stripes of @p granularity bytes taken from @p pools in round robin order,
+ * so stripe k comes from pools[k % pool_count].  Streaming over the range
+ * aggregates the bandwidth of every pool, for example the device memory of
+ * GPUs connected by XGMI.  The range is built from ::hsa_amd_vmem_handle_create,
+ * ::hsa_amd_vmem_map_batch and ::hsa_amd_vmem_set_access, and must be
+ * released with ::hsa_amd_memory_pool_free_interleaved.
  *
- * @param[in] priority Priority to associate with queue.
+ * Only pools of GPU agents supporting the virtual memory API can be
+ * interleaved.
  *
- * @retval HSA_STATUS_SUCCESS if priority was changed successfully.
+ * @param[in] pools Pools providing the stripes.
  *
- * @retval HSA_STATUS_ERROR_INVALID_QUEUE if queue is not a valid
- * compute queue handle.
+ * @param[in] pool_count Number of entries in @p pools.
  *
- * @retval HSA_STATUS_ERROR_INVALID_ARGUMENT if priority is not a valid
- * value from hsa_amd_queue_priority_t.
+ * @param[in] size Allocation size in bytes.  Rounded up to a multiple of
+ * @p granularity.
+ *
+ * @param[in] granularity Stripe size in bytes.  Must be a multiple of the
+ * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE of every pool.  0 selects
+ * 2MB.
+ *
+ * @param[in] desc Access given to agents over the whole range, as for
+ * ::hsa_amd_vmem_set_access.
+ *
+ * @param[in] desc_cnt Number of entries in @p desc.
+ *
+ * @param[out] ptr Base address of the allocation.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Address space or memory of a pool
+ * is exhausted.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL A pool is invalid or not owned
+ * by a GPU agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent in @p desc is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p pools, @p desc or @p ptr is
+ * NULL, a count or @p size is 0, or @p granularity is not a multiple of a
+ * pool's allocation granule.
  */
-hsa_status_t HSA_API hsa_amd_queue_set_priority(hsa_queue_t* queue,
-                                                hsa_amd_queue_priority_t priority);
+hsa_status_t HSA_API hsa_amd_memory_pool_allocate_interleaved(
+    const hsa_amd_memory_pool_t* pools, size_t pool_count, size_t size, size_t granularity,
+    const hsa_amd_memory_access_desc_t* desc, size_t desc_cnt, void** ptr);
 
-/** @} */
-
-/** \addtogroup memory Memory
- *  @{
+/**
+ * @brief Release memory allocated with
+ * ::hsa_amd_memory_pool_allocate_interleaved.
+ *
+ * @param[in] ptr Base address of the allocation.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION @p ptr is not the base of an
+ * interleaved allocation.
  */
+hsa_status_t HSA_API hsa_amd_memory_pool_free_interleaved(void* ptr);
 
 /**
- * @brief Deallocation notifier function type.
+ * @brief Flags for ::hsa_amd_memory_pool_allocate_batch.
  */
-typedef void (*hsa_amd_deallocation_callback_t)(void* ptr, void* user_data);
+typedef enum hsa_amd_memory_batch_flag_s {
+  /**
+   * Carve every buffer out of one backing allocation.  Buffers may still be
+   * freed individually, the backing is released with the last of them.
+   */
+  HSA_AMD_MEMORY_BATCH_SHARED_BLOCK = (1 << 0),
+} hsa_amd_memory_batch_flag_t;
 
 /**
- * @brief Registers a deallocation notifier monitoring for release of agent
- * accessible address @p ptr.  If successful, @p callback will be invoked when
- * @p ptr is removed from accessibility from all agents.
+ * @brief Allocate many buffers from a memory pool in one call.
  *
- * Notification callbacks are automatically deregistered when they are invoked.
+ * @details Equivalent to calling ::hsa_amd_memory_pool_allocate for each entry
+ * of @p sizes followed by one ::hsa_amd_agents_allow_access over all of them,
+ * without the per call overhead.  Each buffer is released with
+ * ::hsa_amd_memory_pool_free.  On failure no buffer remains allocated.
  *
- * Note: The current version supports notifications of address release
- * originating from ::hsa_amd_memory_pool_free.  Support for other address
- * release APIs will follow.
+ * @param[in] memory_pool Memory pool to allocate from.
  *
- * @param[in] ptr Agent accessible address to monitor for deallocation.  Passed
- * to @p callback.
+ * @param[in] count Number of buffers.
  *
- * @param[in] callback Notifier to be invoked when @p ptr is released from
- * agent accessibility.
+ * @param[in] sizes Size in bytes of each buffer.
  *
- * @param[in] user_data User provided value passed to @p callback.  May be NULL.
+ * @param[in] flags Allocation directives, as for ::hsa_amd_memory_pool_allocate.
  *
- * @retval ::HSA_STATUS_SUCCESS The notifier registered successfully
+ * @param[in] batch_flags Bit-field of ::hsa_amd_memory_batch_flag_t.
+ *
+ * @param[in] num_agents Number of agents in @p agents.  May be 0.
+ *
+ * @param[in] agents Agents given access to every buffer.
+ *
+ * @param[out] ptrs Array of @p count entries receiving the buffer addresses.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION @p ptr does not refer to a valid agent accessible
- * address.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES No memory is available.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p callback is NULL or @p ptr is NULL.
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL The memory pool is invalid.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES if there is a failure in allocating
- * necessary resources
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent in @p agents is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p sizes or @p ptrs is NULL,
+ * @p count or an entry of @p sizes is 0, or @p agents is NULL while
+ * @p num_agents is not 0.
  */
-hsa_status_t HSA_API hsa_amd_register_deallocation_callback(void* ptr,
-                                                    hsa_amd_deallocation_callback_t callback,
-                                                    void* user_data);
+hsa_status_t HSA_API hsa_amd_memory_pool_allocate_batch(
+    hsa_amd_memory_pool_t memory_pool, size_t count, const size_t* sizes, uint32_t flags,
+    uint32_t batch_flags, uint32_t num_agents, const hsa_agent_t* agents, void** ptrs);
 
 /**
- * @brief Removes a deallocation notifier previously registered with
- * ::hsa_amd_register_deallocation_callback.  Arguments must be identical to
- * those given in ::hsa_amd_register_deallocation_callback.
+ * @brief Reserve memory of a pool for later allocations.
  *
- * @param[in] ptr Agent accessible address which was monitored for deallocation.
+ * @details Allocates and maps @p size bytes of the pool up front.  Later
+ * ::hsa_amd_memory_pool_allocate calls without flags are carved from the
+ * reservation without entering the kernel driver, giving steady allocation
+ * latency until the reservation is used up, after which allocations proceed
+ * as usual.  Reserved memory is kept when freed and is not released under
+ * memory pressure.  Reservations add up over calls.
  *
- * @param[in] callback Notifier to be removed.
+ * Only coarse and fine grained device local pools can be reserved, and not
+ * when the fragment allocator is disabled.
  *
- * @retval ::HSA_STATUS_SUCCESS The notifier has been removed successfully.
+ * @param[in] memory_pool Memory pool to reserve.
+ *
+ * @param[in] size Bytes to reserve.  Rounded up to
+ * ::HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_REC_GRANULE.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT The given notifier was not registered.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Not enough memory is available.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL The memory pool is invalid or
+ * can't be reserved.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p size is 0.
  */
-hsa_status_t HSA_API hsa_amd_deregister_deallocation_callback(void* ptr,
-                                                      hsa_amd_deallocation_callback_t callback);
-
-typedef enum hsa_amd_svm_model_s {
-  /**
-   * Updates to memory with this attribute conform to HSA memory consistency
-   * model.
-   */
-  HSA_AMD_SVM_GLOBAL_FLAG_FINE_GRAINED = 0,
-  /**
-   * Writes to memory with this attribute can be performed by a single agent
-   * at a time.
-   */
-  HSA_AMD_SVM_GLOBAL_FLAG_COARSE_GRAINED = 1,
-  /**
-   * Memory region queried contains subregions with both
-   * HSA_AMD_SVM_GLOBAL_FLAG_COARSE_GRAINED and
-   * HSA_AMD_SVM_GLOBAL_FLAG_FINE_GRAINED attributes.
-   *
-   * This attribute can not be used in hsa_amd_svm_attributes_set.  It is a
-   * possible return from hsa_amd_svm_attributes_get indicating that the query
-   * region contains both coarse and fine grained memory.
-   */
-  HSA_AMD_SVM_GLOBAL_FLAG_INDETERMINATE = 2
-} hsa_amd_svm_model_t;
-
-typedef enum hsa_amd_svm_attribute_s {
-  // Memory model attribute.
-  // Type of this attribute is hsa_amd_svm_model_t.
-  HSA_AMD_SVM_ATTRIB_GLOBAL_FLAG = 0,
-  // Marks the range read only.  This allows multiple physical copies to be
-  // placed local to each accessing device.
-  // Type of this attribute is bool.
-  HSA_AMD_SVM_ATTRIB_READ_ONLY = 1,
-  // Automatic migrations should attempt to keep the memory within the xgmi hive
-  // containing accessible agents.
-  // Type of this attribute is bool.
-  HSA_AMD_SVM_ATTRIB_HIVE_LOCAL = 2,
-  // Page granularity to migrate at once.  Page granularity is specified as
-  // log2(page_count).
-  // Type of this attribute is uint64_t.
-  HSA_AMD_SVM_ATTRIB_MIGRATION_GRANULARITY = 3,
-  // Physical location to prefer when automatic migration occurs.
-  // Set to the null agent handle (handle == 0) to indicate there
-  // is no preferred location.
-  // Type of this attribute is hsa_agent_t.
-  HSA_AMD_SVM_ATTRIB_PREFERRED_LOCATION = 4,
-  // This attribute can not be used in ::hsa_amd_svm_attributes_set (see
-  // ::hsa_amd_svm_prefetch_async).
-  // Queries the physical location of most recent prefetch command.
-  // If the prefetch location has not been set or is not uniform across the
-  // address range then returned hsa_agent_t::handle will be 0.
-  // Querying this attribute will return the destination agent of the most
-  // recent ::hsa_amd_svm_prefetch_async targeting the address range.  If
-  // multiple async prefetches have been issued targeting the region and the
-  // most recently issued prefetch has completed then the query will return
-  // the location of the most recently completed prefetch.
-  // Type of this attribute is hsa_agent_t.
-  HSA_AMD_SVM_ATTRIB_PREFETCH_LOCATION = 5,
-  // Optimizes with the anticipation that the majority of operations to the
-  // range will be read operations.
-  // Type of this attribute is bool.
-  HSA_AMD_SVM_ATTRIB_READ_MOSTLY = 6,
-  // Allows the execution on GPU.
-  // Type of this attribute is bool.
-  HSA_AMD_SVM_ATTRIB_GPU_EXEC = 7,
-  // This attribute can not be used in ::hsa_amd_svm_attributes_get.
-  // Enables an agent for access to the range.  Access may incur a page fault
-  // and associated memory migration.  Either this or
-  // HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE_IN_PLACE is required prior to SVM
-  // access if HSA_AMD_SYSTEM_INFO_SVM_ACCESSIBLE_BY_DEFAULT is false.
-  // Type of this attribute is hsa_agent_t.
-  HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE = 0x200,
-  // This attribute can not be used in ::hsa_amd_svm_attributes_get.
-  // Enables an agent for access to the range without page faults.  Access
-  // will not incur a page fault and will not cause access based migration.
-  // and associated memory migration.  Either this or
-  // HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE is required prior to SVM access if
-  // HSA_AMD_SYSTEM_INFO_SVM_ACCESSIBLE_BY_DEFAULT is false.
-  // Type of this attribute is hsa_agent_t.
-  HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE_IN_PLACE = 0x201,
-  // This attribute can not be used in ::hsa_amd_svm_attributes_get.
-  // Denies an agent access to the memory range.  Access will cause a terminal
-  // segfault.
-  // Type of this attribute is hsa_agent_t.
-  HSA_AMD_SVM_ATTRIB_AGENT_NO_ACCESS = 0x202,
-  // This attribute can not be used in ::hsa_amd_svm_attributes_set.
-  // Returns the access attribute associated with the agent.
-  // The agent to query must be set in the attribute value field.
-  // The attribute enum will be replaced with the agent's current access
-  // attribute for the address range.
-  // TODO: Clarify KFD return value for non-uniform access attribute.
-  // Type of this attribute is hsa_agent_t.
-  HSA_AMD_SVM_ATTRIB_ACCESS_QUERY = 0x203,
-} hsa_amd_svm_attribute_t;
-
-// List type for hsa_amd_svm_attributes_set/get. 
-typedef struct hsa_amd_svm_attribute_pair_s {
-  // hsa_amd_svm_attribute_t value.
-  uint64_t attribute;
-  // Attribute value.  Bit values should be interpreted according to the type
-  // given in the associated attribute description.
-  uint64_t value;
-} hsa_amd_svm_attribute_pair_t;
+hsa_status_t HSA_API hsa_amd_memory_pool_reserve(hsa_amd_memory_pool_t memory_pool, size_t size);
 
 /**
- * @brief Sets SVM memory attributes.
- *
- * If HSA_AMD_SYSTEM_INFO_SVM_ACCESSIBLE_BY_DEFAULT returns false then enabling
- * access to an Agent via this API (setting HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE
- * or HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE_IN_PLACE) is required prior to SVM
- * memory access by that Agent.
+ * @brief Drop all reservations of a pool made with
+ * ::hsa_amd_memory_pool_reserve.
  *
- * Attributes HSA_AMD_SVM_ATTRIB_ACCESS_QUERY and HSA_AMD_SVM_ATTRIB_PREFETCH_LOCATION
- * may not be used with this API.
+ * @details Unused reserved memory is released immediately, memory still
+ * holding allocations is released once they are freed.
  *
- * @param[in] ptr Will be aligned down to nearest page boundary.
+ * @param[in] memory_pool Memory pool.
  *
- * @param[in] size Will be aligned up to nearest page boundary.
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
- * @param[in] attribute_list List of attributes to set for the address range.
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @param[in] attribute_count Length of @p attribute_list.
+ * @retval ::HSA_STATUS_ERROR_INVALID_MEMORY_POOL The memory pool is invalid or
+ * can't be reserved.
  */
-hsa_status_t hsa_amd_svm_attributes_set(void* ptr, size_t size,
-                                        hsa_amd_svm_attribute_pair_t* attribute_list,
-                                        size_t attribute_count);
+hsa_status_t HSA_API hsa_amd_memory_pool_release_reservation(hsa_amd_memory_pool_t memory_pool);
 
 /**
- * @brief Gets SVM memory attributes.
+ * @brief Get current access permissions for memory mapping
  *
- * Attributes HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE,
- * HSA_AMD_SVM_ATTRIB_AGENT_ACCESSIBLE_IN_PLACE and
- * HSA_AMD_SVM_ATTRIB_PREFETCH_LOCATION may not be used with this API.
+ * Get access permissions for memory mapping for specific agent.
  *
- * Note that attribute HSA_AMD_SVM_ATTRIB_ACCESS_QUERY takes as input an
- * hsa_agent_t and returns the current access type through its attribute field.
+ * @param[in] va previously mapped virtual address
+ * @param[in] perms current permissions
+ * @param[in] agent_handle agent
  *
- * @param[in] ptr Will be aligned down to nearest page boundary.
+ * @retval ::HSA_STATUS_SUCCESS
  *
- * @param[in] size Will be aligned up to nearest page boundary.
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT Invalid agent
  *
- * @param[in] attribute_list List of attributes to set for the address range.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION va is not mapped or permissions never set for this
+ * agent
  *
- * @param[in] attribute_count Length of @p attribute_list.
+ * @retval ::HSA_STATUS_ERROR Unexpected internal error
  */
-hsa_status_t hsa_amd_svm_attributes_get(void* ptr, size_t size,
-                                        hsa_amd_svm_attribute_pair_t* attribute_list,
-                                        size_t attribute_count);
+hsa_status_t hsa_amd_vmem_get_access(void* va, hsa_access_permission_t* perms,
+                                     hsa_agent_t agent_handle);
 
 /**
- * @brief Asynchronously migrates memory to an agent.
- *
- * Schedules memory migration to @p agent when @p dep_signals have been observed equal to zero.
- * @p completion_signal will decrement when the migration is complete.
+ * @brief Get an exportable shareable handle
  *
- * @param[in] ptr Will be aligned down to nearest page boundary.
+ * Get an exportable shareable handle for a memory_handle. This shareabl handle can then be used to
+ * re-create a virtual memory handle using hsa_amd_vmem_import_shareable_handle. The shareable
+ * handle can be transferred using mechanisms that support posix file descriptors Once all shareable
+ * handles are closed, the memory_handle is released.
  *
- * @param[in] size Will be aligned up to nearest page boundary.
+ * @param[out] dmabuf_fd shareable handle
+ * @param[in] handle previously allocated virtual memory handle
+ * @param[in] flags Currently unsupported
  *
- * @param[in] agent Agent to migrate to.
+ * @retval ::HSA_STATUS_SUCCESS
  *
- * @param[in] num_dep_signals Number of dependent signals. Can be 0.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid memory handle
  *
- * @param[in] dep_signals List of signals that must be waited on before the migration
- * operation starts. The migration will start after every signal has been observed with
- * the value 0. If @p num_dep_signals is 0, this argument is ignored.
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Out of resources
  *
- * @param[in] completion_signal Signal used to indicate completion of the migration
- * operation. When the migration operation is finished, the value of the signal is
- * decremented. The runtime indicates that an error has occurred during the copy
- * operation by setting the value of the completion signal to a negative
- * number. If no completion signal is required this handle may be null.
- */
-hsa_status_t hsa_amd_svm_prefetch_async(void* ptr, size_t size, hsa_agent_t agent,
-                                        uint32_t num_dep_signals, const hsa_signal_t* dep_signals,
-                                        hsa_signal_t completion_signal);
-
-/** @} */
-
-/** \addtogroup profile Profiling
- *  @{
+ * @retval ::HSA_STATUS_ERROR Unexpected internal error
  */
-
+hsa_status_t hsa_amd_vmem_export_shareable_handle(int* dmabuf_fd,
+                                                  hsa_amd_vmem_alloc_handle_t handle,
+                                                  uint64_t flags);
 /**
- * @brief Acquire Stream Performance Monitor on an agent
+ * @brief Import a shareable handle
  *
- * Acquire exclusive use of SPM on @p preferred_agent.
- * See hsa_amd_spm_set_dest_buffer to provide a destination buffer to KFD to start recording and
- * retrieve this data.
- * @param[in] preferred_agent Agent on which to acquire SPM
- */
-hsa_status_t hsa_amd_spm_acquire(hsa_agent_t preferred_agent);
-
-/**
- * @brief Release Stream Performance Monitor on an agent
+ * Import a shareable handle for a memory handle. Importing a shareable handle that has been closed
+ * and released results in undefined behavior.
  *
- * Release exclusive use of SPM on @p preferred_agent. This will stop KFD writing SPM data.
- * If a destination buffer is set, then data in the destination buffer is available to user
- * when this function returns.
+ * @param[in] dmabuf_fd shareable handle exported with hsa_amd_vmem_export_shareable_handle
+ * @param[out] handle virtual memory handle
+ *
+ * @retval ::HSA_STATUS_SUCCESS
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid memory handle
  *
- * @param[in] preferred_agent Agent on which to release SPM
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Out of resources
+ *
+ * @retval ::HSA_STATUS_ERROR Unexpected internal error
  */
-hsa_status_t hsa_amd_spm_release(hsa_agent_t preferred_agent);
+hsa_status_t hsa_amd_vmem_import_shareable_handle(int dmabuf_fd,
+                                                  hsa_amd_vmem_alloc_handle_t* handle);
 
 /**
- * @brief  Set up the current destination user mode buffer for stream performance
- * counter data. KFD will start writing SPM data into the destination buffer. KFD will continue
- * to copy data into the current destination buffer until any of the following functions are called
- * - hsa_amd_spm_release
- * - hsa_amd_spm_set_dest_buffer with dest set to NULL
- * - hsa_amd_spm_set_dest_buffer with dest set to a new buffer
+ * @brief Returns memory handle for mapped memory
  *
- * if @p timeout is non-0, the call will wait for up to @p timeout ms for the previous
- * buffer to be filled. If previous buffer to be filled before timeout, the @p timeout
- * will be updated value with the time remaining. If the timeout is exceeded, the function
- * copies any partial data available into the previous user buffer and returns success.
- * User should not access destination data while KFD is copying data.
- * If the previous destination buffer was full, then @p is_data_loss flag is set.
- * @p dest is CPU accessible memory. It could be malloc'ed memory or host allocated memory
+ * Return a memory handle for previously mapped memory. The handle will be the same value of handle
+ * used to map the memory. The returned handle must be released with corresponding number of calls
+ * to hsa_amd_vmem_handle_release.
  *
- * @param[in] preferred_agent Agent on which to set the dest buffer
+ * @param[out] memory_handle memory handle for this mapped address
+ * @param[in] mapped address
  *
- * @param[in] size_in_bytes size of the buffer
+ * @retval ::HSA_STATUS_SUCCESS
  *
- * @param[in/out] timeout timeout in milliseconds
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid address
+ */
+hsa_status_t hsa_amd_vmem_retain_alloc_handle(hsa_amd_vmem_alloc_handle_t* memory_handle,
+                                              void* addr);
+
+/**
+ * @brief Returns the current allocation properties of a handle
  *
- * @param[out] size_copied number of bytes copied
+ * Returns the allocation properties of an existing handle
  *
- * @param[in] dest destination address. Set to NULL to stop copy on previous buffer
+ * @param[in] memory_handle memory handle to be queried
+ * @param[out] pool memory pool that owns this handle
+ * @param[out] memory type
+
+ * @retval ::HSA_STATUS_SUCCESS
  *
- * @param[out] is_data_loss true is data was lost
+ * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid memory_handle
  */
-hsa_status_t hsa_amd_spm_set_dest_buffer(hsa_agent_t preferred_agent, size_t size_in_bytes,
-                                         uint32_t* timeout, uint32_t* size_copied, void* dest,
-                                         bool* is_data_loss);
+hsa_status_t hsa_amd_vmem_get_alloc_properties_from_handle(
+    hsa_amd_vmem_alloc_handle_t memory_handle, hsa_amd_memory_pool_t* pool,
+    hsa_amd_memory_type_t* type);
 
 /** @} */
 
-/** \addtogroup memory Memory
+/** \addtogroup queue Queues
  *  @{
  */
 
 /**
- * @brief Obtains an OS specific, vendor neutral, handle to a memory allocation.
- *
- * Obtains an OS specific handle to GPU agent memory.  The memory must be part
- * of a single allocation from an hsa_amd_memory_pool_t exposed by a GPU Agent.
- * The handle may be used with other APIs (e.g. Vulkan) to obtain shared access
- * to the allocation.
- *
- * Shared access to the memory is not guaranteed to be fine grain coherent even
- * if the allocation exported is from a fine grain pool.  The shared memory
- * consistency model will be no stronger than the model exported from, consult
- * the importing API to determine the final consistency model.
- *
- * The allocation's memory remains valid as long as the handle and any mapping
- * of the handle remains valid.  When the handle and all mappings are closed
- * the backing memory will be released for reuse.
+ * @brief Set the asynchronous scratch limit threshold on all the queues for this agent.
+ * Dispatches that are enqueued on HW queues on this agent that are smaller than threshold will not
+ * result in a scratch use-once method.
  *
- * @param[in] ptr Pointer to the allocation being exported.
+ * Increasing this threshold will only increase the internal limit and not cause immediate allocation
+ * of additional scratch memory. Decreasing this threshold will result in a release in scratch memory
+ * on queues where the current amount of allocated scratch exceeds the new limit.
  *
- * @param[in] size Size in bytes to export following @p ptr.  The entire range
- * being exported must be contained within a single allocation.
+ * This API is only supported on devices that support asynchronous scratch reclaim.
  *
- * @param[out] dmabuf Pointer to a dma-buf file descriptor holding a reference to the
- * allocation.  Contents will not be altered in the event of failure.
+ * @param[in] agent A valid agent.
  *
- * @param[out] offset Offset in bytes into the memory referenced by the dma-buf
- * object at which @p ptr resides.  Contents will not be altered in the event
- * of failure.
+ * @param[in] threshold Threshold size in bytes
  *
- * @retval ::HSA_STATUS_SUCCESS Export completed successfully.
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT One or more arguments is NULL.
- *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION The address range described by
- * @p ptr and @p size are not contained within a single allocation.
- *
- * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The allocation described by @p ptr
- * and @p size was allocated on a device which can not export memory.
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The agent is invalid.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The return file descriptor,
- * @p dmabuf, could not be created.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT This agent does not support asynchronous scratch
+ * reclaim
  */
-hsa_status_t hsa_amd_portable_export_dmabuf(const void* ptr, size_t size, int* dmabuf,
-                                            uint64_t* offset);
+hsa_status_t HSA_API hsa_amd_agent_set_async_scratch_limit(hsa_agent_t agent, size_t threshold);
 
 /**
- * @brief Closes an OS specific, vendor neutral, handle to a memory allocation.
- *
- * Closes an OS specific handle to GPU agent memory.
+ * @brief Packet processing progress of a queue, sampled by the runtime.
  *
- * Applications should close a handle after imports are complete.  The handle
- * is not required to remain open for the lifetime of imported mappings.  The
- * referenced allocation will remain valid until all handles and mappings
- * are closed.
+ * @details Samples are taken every 100 milliseconds while the
+ * HSA_QUEUE_TELEMETRY environment variable is set to 1.  A queue is stalled
+ * while it has packets pending and its read index has not moved since the
+ * previous sample.
+ */
+typedef struct hsa_amd_queue_telemetry_s {
+  /**
+   * Number of samples taken.
+   */
+  uint64_t samples;
+  /**
+   * Packets between the read and write index at the last sample.
+   */
+  uint64_t depth;
+  /**
+   * Largest depth seen at any sample.
+   */
+  uint64_t peak_depth;
+  /**
+   * Percentage of the ring occupied at the last sample.
+   */
+  uint32_t occupancy;
+  uint32_t reserved;
+  /**
+   * Packets processed per second between the last two samples.
+   */
+  uint64_t packets_per_second;
+  /**
+   * Duration in nanoseconds of the current stall, 0 if the queue is not
+   * stalled.
+   */
+  uint64_t stall_ns;
+  /**
+   * Longest stall seen, in nanoseconds.
+   */
+  uint64_t max_stall_ns;
+} hsa_amd_queue_telemetry_t;
+
+typedef enum {
+  /*
+   * Returns the agent that owns the underlying HW queue.
+   * The type of this attribute is hsa_agent_t.
+   */
+  HSA_AMD_QUEUE_INFO_AGENT,
+  /*
+   * Returns the doorbell ID of the completion signal of the queue
+   * On agents with AQL hardware doorbells this is the doorbell address itself. A submitter
+   * that owns the queue may store the last published packet index to it directly, after a
+   * store fence, instead of calling hsa_signal_store_*.
+   * The type of this attribute is uint64_t.
+   */
+  HSA_AMD_QUEUE_INFO_DOORBELL_ID,
+  /*
+   * Returns the log2 histogram of per work-item scratch sizes requested by dispatches on the
+   * queue. Entry i counts requests of [16 << i, 32 << i) bytes, entry 0 also counts smaller
+   * requests and the last entry all larger ones. Counts are only collected when HSA_SCRATCH_ELASTIC
+   * is enabled and age over time.
+   * The type of this attribute is uint32_t[16].
+   */
+  HSA_AMD_QUEUE_INFO_SCRATCH_DEMAND_HISTOGRAM,
+  /*
+   * Returns the packet processing telemetry of the queue. All fields are 0 unless
+   * HSA_QUEUE_TELEMETRY is enabled. Not supported on queues multiplexed by
+   * HSA_VIRTUAL_QUEUE_LIMIT.
+   * The type of this attribute is hsa_amd_queue_telemetry_t.
+   */
+  HSA_AMD_QUEUE_INFO_TELEMETRY,
+} hsa_queue_info_attribute_t;
+
+hsa_status_t hsa_amd_queue_get_info(hsa_queue_t* queue, hsa_queue_info_attribute_t attribute,
+                                    void* value);
+
+/**
+ * @brief Allocate kernarg memory for a dispatch from a ring owned by the queue.
  *
- * @param[in] dmabuf Handle to be closed.
+ * @details The memory is tied to the packet at @p packet_id and is reclaimed
+ * once the read index of @p queue has moved past @p packet_id, so no free is
+ * needed.  As for the packet slot itself, the memory may be reused once the
+ * packet processor has consumed the packet.  Kernels still reading their
+ * kernargs after that point, for example when later packets are launched
+ * without the barrier bit, must use memory from the kernarg pool instead.
+ * Allocations for packet ids below the newest outstanding one are reclaimed
+ * with the newest.  The ring is created on first use.
  *
- * @retval ::HSA_STATUS_SUCCESS Handle closed successfully.
+ * @param[in] queue Queue the dispatch will be written to.  Only hardware AQL
+ * queues are supported.
  *
- * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
- * initialized.
+ * @param[in] size Size of the kernarg segment in bytes.
  *
- * @retval ::HSA_STATUS_ERROR_RESOURCE_FREE A generic error was encountered
- * when closing the handle.  The handle may have been closed already or an
- * async IO error may have occured.
- */
-hsa_status_t hsa_amd_portable_close_dmabuf(int dmabuf);
-
-/**
- * @brief Allocate a reserved address range
+ * @param[in] alignment Alignment of the kernarg segment, a power of two no
+ * larger than 4096.
  *
- * Reserve a virtual address range. The size must be a multiple of the system page size.
- * If it is not possible to allocate the address specified by @p address, then @p va will be
- * a different address range.
- * Address range should be released by calling hsa_amd_vmem_address_free.
+ * @param[in] packet_id Packet id of the dispatch using the memory.
  *
- * @param[out] va virtual address allocated
- * @param[in] size of address range requested
- * @param[in] address requested
- * @param[in] flags currently unsupported
+ * @param[out] kernarg_address Location of the kernarg segment.
  *
- * @retval ::HSA_STATUS_SUCCESS Address range allocated successfully
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources to allocate an address
- * range of this size.
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is invalid or does not
+ * support a kernarg ring.
  *
- * Note that this API will be deprecated in a future release and replaced by
- * hsa_amd_vmem_address_reserve_align
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p kernarg_address is NULL,
+ * @p size is 0 or too large for the ring, or @p alignment is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The ring is full until the read
+ * index advances.
  */
-hsa_status_t hsa_amd_vmem_address_reserve(void** va, size_t size, uint64_t address,
-                                          uint64_t flags);
+hsa_status_t HSA_API hsa_amd_queue_kernarg_alloc(const hsa_queue_t* queue, size_t size,
+                                                 size_t alignment, uint64_t packet_id,
+                                                 void** kernarg_address);
 
 /**
- * @brief Allocate a reserved address range
+ * @brief Submit a batch of AQL packets to a queue.
  *
- * Reserve a virtual address range. The size must be a multiple of the system page size.
- * If it is not possible to allocate the address specified by @p address, then @p va will be
- * a different address range.
- * Address range should be released by calling hsa_amd_vmem_address_free.
+ * @details Reserves @p packet_count consecutive slots with a single write
+ * index update, copies the packets into the ring and publishes their headers
+ * in order.  The call waits for free slots if the queue is full.  Doorbell
+ * rings from threads submitting to the same queue at the same time are
+ * coalesced, so one ring may cover the batches of several threads.  Packets in
+ * @p packets must be fully formed, including a valid header.  Mixing this
+ * call with manual doorbell rings on the same queue is not supported.
  *
- * @param[out] va virtual address allocated
- * @param[in] size of address range requested
- * @param[in] address requested
- * @param[in] alignment requested. 0 for default. Must be >= page-size and a power of 2
- * @param[in] flags currently unsupported
+ * @param[in] queue Queue to submit to.
  *
- * @retval ::HSA_STATUS_SUCCESS Address range allocated successfully
+ * @param[in] packets Array of @p packet_count 64-byte AQL packets.
+ *
+ * @param[in] packet_count Number of packets, from 1 up to the queue size.
+ *
+ * @param[out] first_index If not NULL, receives the packet id of the first
+ * packet of the batch.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources to allocate an address
- * range of this size.
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p packets is NULL or
+ * @p packet_count is 0 or larger than the queue size.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_PACKET_FORMAT A packet has an invalid
+ * header.
  */
-hsa_status_t hsa_amd_vmem_address_reserve_align(void** va, size_t size, uint64_t address,
-                                          uint64_t alignment, uint64_t flags);
+hsa_status_t HSA_API hsa_amd_queue_submit_batch(hsa_queue_t* queue, const void* packets,
+                                                uint32_t packet_count, uint64_t* first_index);
 
 /**
- * @brief Free a reserved address range
- *
- * Free a previously allocated address range. The size must match the size of a previously
- * allocated address range.
- *
- * @param[out] va virtual address to be freed
- * @param[in] size of address range
- *
- * @retval ::HSA_STATUS_SUCCESS Address range released successfully
- *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid va specified
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT Invalid size specified
- * @retval ::HSA_STATUS_ERROR_RESOURCE_FREE Address range is still in use
- * @retval ::HSA_STATUS_ERROR Internal unexpected error
+ * @brief Opaque handle to a recorded dispatch graph.
  */
-hsa_status_t hsa_amd_vmem_address_free(void* va, size_t size);
+typedef struct hsa_amd_dispatch_graph_s {
+  uint64_t handle;
+} hsa_amd_dispatch_graph_t;
 
 /**
- * @brief Struct containing an opaque handle to a memory allocation handle
+ * @brief Kernel argument update applied by ::hsa_amd_dispatch_graph_launch.
  */
-typedef struct hsa_amd_vmem_alloc_handle_s {
+typedef struct hsa_amd_dispatch_graph_update_s {
   /**
-   * Opaque handle. Two handles reference the same object of the enclosing type
-   * if and only if they are equal.
+   * Index of the kernel dispatch packet in the recorded graph.  Its kernel
+   * arguments must have been captured.
    */
-  uint64_t handle;
-} hsa_amd_vmem_alloc_handle_t;
-
-typedef enum {
-  MEMORY_TYPE_NONE,
-  MEMORY_TYPE_PINNED,
-} hsa_amd_memory_type_t;
+  uint32_t packet_index;
+  /**
+   * Byte offset in the captured kernel arguments.
+   */
+  uint32_t offset;
+  /**
+   * Bytes to write.
+   */
+  size_t size;
+  /**
+   * New argument bytes.
+   */
+  const void* data;
+} hsa_amd_dispatch_graph_update_t;
 
 /**
- * @brief Create a virtual memory handle
+ * @brief Record a sequence of kernel dispatch and barrier packets for repeated
+ * launch.
  *
- * Create a virtual memory handle within this pool
- * @p size must be a aligned to allocation granule size for this memory pool, see
- * HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE
- * To minimize internal memory fragmentation, align the size to the recommended allocation granule
- * size, see HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_REC_GRANULE
+ * @details The packets are validated and stored once as a packet image.  A
+ * launch places the whole image on a queue with a single write index
+ * reservation and a single doorbell ring.  Dependencies between packets are
+ * expressed with the barrier bit and barrier packets as usual.  Copies can be
+ * recorded with ::hsa_amd_copy_list_create and ordered against the graph with
+ * barrier AND packets on their completion signals.
  *
- * @param[in] pool memory to use
- * @param[in] size of the memory allocation
- * @param[in] type of memory
- * @param[in] flags - currently unsupported
- * @param[out] memory_handle - handle for the allocation
+ * For every kernel dispatch packet with a non-zero entry in
+ * @p kernarg_sizes, that many bytes are copied from the packet's
+ * kernarg_address into memory owned by the graph, and the recorded packet
+ * points there.  Captured arguments can be patched on each launch, so the
+ * caller does not need to keep its argument buffers.
  *
- * @retval ::HSA_STATUS_SUCCESS memory allocated successfully
+ * @param[in] agent GPU agent whose queues launch the graph.
  *
- * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been initialized.
+ * @param[in] packets Array of @p packet_count 64-byte AQL packets with valid
+ * headers.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT Invalid arguments
+ * @param[in] packet_count Number of packets.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION This memory pool does not support allocations
+ * @param[in] kernarg_sizes NULL, or an array of @p packet_count kernel
+ * argument sizes.  Entries of packets other than kernel dispatches must be 0.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources to allocate this memory
- */
-hsa_status_t hsa_amd_vmem_handle_create(hsa_amd_memory_pool_t pool, size_t size,
-                                        hsa_amd_memory_type_t type, uint64_t flags,
-                                        hsa_amd_vmem_alloc_handle_t* memory_handle);
-
-/**
- * @brief Release a virtual memory handle
+ * @param[out] graph Handle of the recorded graph.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The graph has been recorded.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @param[in] memory handle that was previously allocated
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT @p agent is not a GPU agent.
  *
- * @retval ::HSA_STATUS_SUCCESS Address range allocated successfully
+ * @retval ::HSA_STATUS_ERROR_INVALID_PACKET_FORMAT A packet is not a kernel
+ * dispatch, barrier AND or barrier OR packet.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid memory handle
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p packets or @p graph is NULL,
+ * @p packet_count is 0, or a kernel argument size is given for a packet
+ * without kernel arguments.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Kernel argument memory could not
+ * be allocated.
  */
-hsa_status_t hsa_amd_vmem_handle_release(hsa_amd_vmem_alloc_handle_t memory_handle);
+hsa_status_t HSA_API hsa_amd_dispatch_graph_create(hsa_agent_t agent, const void* packets,
+                                                   uint32_t packet_count,
+                                                   const uint32_t* kernarg_sizes,
+                                                   hsa_amd_dispatch_graph_t* graph);
 
 /**
- * @brief Map a virtual memory handle
+ * @brief Launch a recorded dispatch graph on a queue.
  *
- * Map a virtual memory handle to a reserved address range. The virtual address requested must be
- * within a previously reserved address range. @p va and (@p va + size) must be must be within
- * (va + size) of the previous allocated address range.
- * @p size must be equal to size of the @p memory_handle
- * hsa_amd_vmem_set_access needs to be called to make the memory accessible to specific agents
+ * @details @p updates are written to the captured kernel arguments, then the
+ * packet image is placed on @p queue as one batch.  If an earlier launch of
+ * the graph is still running, the call blocks until it has completed before
+ * applying updates.  Launches without updates do not block.
+ * @p completion_signal, if not 0, replaces the completion signal of the last
+ * recorded packet for this launch.
  *
- * @param[in] va virtual address range where memory will be mapped
- * @param[in] size of memory mapping
- * @param[in] in_offset offset into memory. Currently unsupported
- * @param[in] memory_handle virtual memory handle to be mapped
- * @param[in] flags. Currently unsupported
+ * Graphs with captured kernel arguments end with a barrier packet that tracks
+ * their completion, so later packets on @p queue wait for the whole graph.
+ * The image, including that barrier, must fit in @p queue.  Mixing launches with
+ * manual doorbell rings on the same queue is not supported, as for
+ * ::hsa_amd_queue_submit_batch.
  *
- * @retval ::HSA_STATUS_SUCCESS Memory mapped successfully
+ * @param[in] graph Recorded graph.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT va, size or memory_handle are invalid
+ * @param[in] queue Queue of the agent the graph was recorded for.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources
+ * @param[in] update_count Number of kernel argument updates.
  *
- * @retval ::HSA_STATUS_ERROR Unexpected internal error
+ * @param[in] updates Array of @p update_count updates.
+ *
+ * @param[in] completion_signal Signal for the last packet, or 0.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The graph has been launched.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is invalid or belongs to
+ * another agent.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p graph is invalid, the graph
+ * does not fit in @p queue, or an update names a packet without captured
+ * kernel arguments or lies outside them.
  */
-hsa_status_t hsa_amd_vmem_map(void* va, size_t size, size_t in_offset,
-                              hsa_amd_vmem_alloc_handle_t memory_handle, uint64_t flags);
+hsa_status_t HSA_API hsa_amd_dispatch_graph_launch(
+    hsa_amd_dispatch_graph_t graph, hsa_queue_t* queue, uint32_t update_count,
+    const hsa_amd_dispatch_graph_update_t* updates, hsa_signal_t completion_signal);
 
 /**
- * @brief Unmap a virtual memory handle
- *
- * Unmap previously mapped virtual address range
+ * @brief Destroy a recorded dispatch graph.
  *
- * @param[in] va virtual address range where memory will be mapped
- * @param[in] size of memory mapping
+ * @details Blocks until launches already made have completed.
  *
- * @retval ::HSA_STATUS_SUCCESS Memory backing unmapped successfully
+ * @param[in] graph Recorded graph.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION memory_handle is invalid
+ * @retval ::HSA_STATUS_SUCCESS The graph has been destroyed.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT size is invalid
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval ::HSA_STATUS_ERROR Unexpected internal error
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p graph is invalid.
  */
-hsa_status_t hsa_amd_vmem_unmap(void* va, size_t size);
+hsa_status_t HSA_API hsa_amd_dispatch_graph_destroy(hsa_amd_dispatch_graph_t graph);
 
-typedef struct hsa_amd_memory_access_desc_s {
-  hsa_access_permission_t permissions;
-  hsa_agent_t agent_handle;
-} hsa_amd_memory_access_desc_t;
+/**
+ * @brief Dispatch timestamp record read from a queue's timestamp ring.
+ *
+ * Times are reported as ticks in the domain of the HSA system clock.
+ */
+typedef struct hsa_amd_dispatch_timestamp_s {
+  /**
+   * Packet id the timestamp signal was requested for.
+   */
+  uint64_t packet_id;
+  /**
+   * Dispatch packet processing start time.
+   */
+  uint64_t start;
+  /**
+   * Dispatch packet completion time.
+   */
+  uint64_t end;
+} hsa_amd_dispatch_timestamp_t;
 
 /**
- * @brief Make a memory mapping accessible
+ * @brief Give a queue a ring of dispatch timestamp records.
  *
- * Make previously mapped virtual address accessible to specific agents. @p size must be equal to
- * size of previously mapped virtual memory handle.
- * Calling hsa_amd_vmem_set_access multiple times on the same @p va:
- *  - Will overwrite permissions for agents specified in @p desc
- *  - Will leave permissions unchanged for agents not specified in @p desc
+ * @details Allocates @p record_count timestamp records owned by @p queue and
+ * enables profiling on it, as ::hsa_amd_profiling_set_profiler_enabled does.
+ * Records are handed out with ::hsa_amd_queue_dispatch_timestamp_signal and
+ * collected in bulk with ::hsa_amd_queue_dispatch_timestamps_read, so
+ * dispatch timing needs no signal allocation and no per-packet query.
+ * Disabling profiling on the queue stops the packet processor from writing
+ * timestamps into the ring.  The ring lives until the queue is destroyed.
  *
- * @param[in] va previously mapped virtual address
- * @param[in] size of memory mapping
- * @param[in] desc list of access permissions for each agent
- * @param[in] desc_cnt number of elements in desc
+ * @param[in] queue Queue to attach the ring to.  Only hardware AQL queues are
+ * supported.
  *
- * @retval ::HSA_STATUS_SUCCESS
+ * @param[in] record_count Number of records in the ring.  Must not be 0.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT va, size or memory_handle are invalid
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION memory_handle is invalid
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Insufficient resources
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is invalid or does not
+ * support a timestamp ring.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_AGENT Invalid agent in desc
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p record_count is 0 or the
+ * queue already has a timestamp ring.
  *
- * @retval ::HSA_STATUS_ERROR Unexpected internal error
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES The ring could not be allocated.
  */
-hsa_status_t hsa_amd_vmem_set_access(void* va, size_t size,
-                                     const hsa_amd_memory_access_desc_t* desc,
-                                     size_t desc_cnt);
+hsa_status_t HSA_API hsa_amd_queue_dispatch_timestamps_enable(hsa_queue_t* queue,
+                                                              uint32_t record_count);
 
 /**
- * @brief Get current access permissions for memory mapping
+ * @brief Take the next record of a queue's timestamp ring for a dispatch.
  *
- * Get access permissions for memory mapping for specific agent.
+ * @details Returns a signal handle to be stored as the completion signal of
+ * the dispatch packet at @p packet_id.  The packet processor writes the start
+ * and end ticks of the dispatch into the record and marks it complete.  The
+ * handle is only valid as that completion signal and must not be passed to
+ * any other API.  Every handle returned must be submitted, records are read
+ * back in the order they were taken and an unsubmitted one holds back all
+ * later records.  If the ring is full the oldest unread record is
+ * overwritten once its dispatch has completed, and counted as dropped.
+ * Dispatches that need their own completion signal are timed through that
+ * signal as before.
  *
- * @param[in] va previously mapped virtual address
- * @param[in] perms current permissions
- * @param[in] agent_handle agent
+ * @param[in] queue Queue the dispatch will be written to.
  *
- * @retval ::HSA_STATUS_SUCCESS
+ * @param[in] packet_id Packet id of the dispatch, reported back in its record.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_AGENT Invalid agent
+ * @param[out] signal Completion signal for the dispatch.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION va is not mapped or permissions never set for this
- * agent
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
- * @retval ::HSA_STATUS_ERROR Unexpected internal error
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is invalid or has no
+ * timestamp ring.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p signal is NULL.
+ *
+ * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Every record belongs to a
+ * dispatch that has not completed yet.
  */
-hsa_status_t hsa_amd_vmem_get_access(void* va, hsa_access_permission_t* perms,
-                                     hsa_agent_t agent_handle);
+hsa_status_t HSA_API hsa_amd_queue_dispatch_timestamp_signal(const hsa_queue_t* queue,
+                                                             uint64_t packet_id,
+                                                             hsa_signal_t* signal);
 
 /**
- * @brief Get an exportable shareable handle
+ * @brief Read completed records from a queue's timestamp ring.
  *
- * Get an exportable shareable handle for a memory_handle. This shareabl handle can then be used to
- * re-create a virtual memory handle using hsa_amd_vmem_import_shareable_handle. The shareable
- * handle can be transferred using mechanisms that support posix file descriptors Once all shareable
- * handles are closed, the memory_handle is released.
- *
- * @param[out] dmabuf_fd shareable handle
- * @param[in] handle previously allocated virtual memory handle
- * @param[in] flags Currently unsupported
+ * @details Copies up to @p max_records records of completed dispatches, oldest
+ * first, and releases them for reuse.  Reading stops at the first record whose
+ * dispatch has not completed.  Timestamps are converted from agent ticks to
+ * the system domain during the copy.
  *
- * @retval ::HSA_STATUS_SUCCESS
+ * @param[in] queue Queue owning the ring.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid memory handle
+ * @param[in] max_records Capacity of @p records.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Out of resources
+ * @param[out] records Array receiving the records.
  *
- * @retval ::HSA_STATUS_ERROR Unexpected internal error
- */
-hsa_status_t hsa_amd_vmem_export_shareable_handle(int* dmabuf_fd,
-                                                  hsa_amd_vmem_alloc_handle_t handle,
-                                                  uint64_t flags);
-/**
- * @brief Import a shareable handle
+ * @param[out] record_count Number of records written to @p records.
  *
- * Import a shareable handle for a memory handle. Importing a shareable handle that has been closed
- * and released results in undefined behavior.
+ * @param[out] dropped If not NULL, receives the number of records overwritten
+ * unread since the previous call.
  *
- * @param[in] dmabuf_fd shareable handle exported with hsa_amd_vmem_export_shareable_handle
- * @param[out] handle virtual memory handle
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
- * @retval ::HSA_STATUS_SUCCESS
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid memory handle
+ * @retval ::HSA_STATUS_ERROR_INVALID_QUEUE @p queue is invalid or has no
+ * timestamp ring.
  *
- * @retval ::HSA_STATUS_ERROR_OUT_OF_RESOURCES Out of resources
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p records or @p record_count is
+ * NULL.
+ */
+hsa_status_t HSA_API hsa_amd_queue_dispatch_timestamps_read(hsa_queue_t* queue,
+                                                            uint32_t max_records,
+                                                            hsa_amd_dispatch_timestamp_t* records,
+                                                            uint32_t* record_count,
+                                                            uint64_t* dropped);
+
+/**
+ * @brief Event counters kept by the runtime.
+ */
+typedef enum {
+  /**
+   * Queue errors raised because a dispatch needed more scratch than the queue
+   * had.
+   */
+  HSA_AMD_RUNTIME_COUNTER_SCRATCH_TRAPS = 0,
+  /**
+   * Host signal waits satisfied while polling, without sleeping.
+   */
+  HSA_AMD_RUNTIME_COUNTER_SIGNAL_WAIT_SPINS = 1,
+  /**
+   * Sleeps in the driver taken by host signal waits.
+   */
+  HSA_AMD_RUNTIME_COUNTER_SIGNAL_WAIT_SLEEPS = 2,
+  /**
+   * Device memory sub-allocations served from a free fragment or a cached
+   * block.
+   */
+  HSA_AMD_RUNTIME_COUNTER_FRAGMENT_ALLOC_HITS = 3,
+  /**
+   * Device memory sub-allocations that needed a new block from the driver.
+   */
+  HSA_AMD_RUNTIME_COUNTER_FRAGMENT_ALLOC_MISSES = 4,
+  /**
+   * Acquires of the runtime's named internal locks.  Only counted when the
+   * runtime is built with LOCK_STATS_SUPPORT, otherwise 0.
+   */
+  HSA_AMD_RUNTIME_COUNTER_LOCK_ACQUIRES = 5,
+  /**
+   * Acquires of named internal locks that had to wait for another holder.
+   * Only counted when the runtime is built with LOCK_STATS_SUPPORT.
+   */
+  HSA_AMD_RUNTIME_COUNTER_LOCK_CONTENDED = 6,
+  HSA_AMD_RUNTIME_COUNTER_COUNT
+} hsa_amd_runtime_counter_t;
+
+/**
+ * @brief Value distributions kept by the runtime.
+ */
+typedef enum {
+  /**
+   * Host time in nanoseconds spent submitting an asynchronous copy.
+   */
+  HSA_AMD_RUNTIME_HISTOGRAM_COPY_SUBMIT_NS = 0,
+  /**
+   * Bytes still pending on an SDMA engine when it is picked for a copy.
+   */
+  HSA_AMD_RUNTIME_HISTOGRAM_SDMA_PENDING_BYTES = 1,
+  /**
+   * Size in bytes of memory allocations.
+   */
+  HSA_AMD_RUNTIME_HISTOGRAM_ALLOCATION_BYTES = 2,
+  /**
+   * Number of signals watched by an asynchronous handler thread, sampled each
+   * time it wakes.
+   */
+  HSA_AMD_RUNTIME_HISTOGRAM_ASYNC_HANDLER_SIGNALS = 3,
+  /**
+   * Packets pending on a queue, sampled for every queue while
+   * HSA_QUEUE_TELEMETRY is enabled.
+   */
+  HSA_AMD_RUNTIME_HISTOGRAM_QUEUE_DEPTH = 4,
+  /**
+   * Duration in milliseconds of queue stalls, recorded when the stall ends.
+   * See ::hsa_amd_queue_telemetry_t.
+   */
+  HSA_AMD_RUNTIME_HISTOGRAM_QUEUE_STALL_MS = 5,
+  /**
+   * Time in nanoseconds contended acquires of named internal locks waited.
+   * Only recorded when the runtime is built with LOCK_STATS_SUPPORT.  The
+   * per lock breakdown and the call sites holding each lock are written to the
+   * HSA_METRICS_DUMP file.
+   */
+  HSA_AMD_RUNTIME_HISTOGRAM_LOCK_WAIT_NS = 6,
+  HSA_AMD_RUNTIME_HISTOGRAM_COUNT
+} hsa_amd_runtime_histogram_t;
+
+/**
+ * @brief Number of buckets of a runtime histogram.
  *
- * @retval ::HSA_STATUS_ERROR Unexpected internal error
+ * Bucket 0 counts values of 0, bucket i counts values in [2^(i-1), 2^i) and
+ * the last bucket also counts all larger values.
  */
-hsa_status_t hsa_amd_vmem_import_shareable_handle(int dmabuf_fd,
-                                                  hsa_amd_vmem_alloc_handle_t* handle);
+#define HSA_AMD_RUNTIME_HISTOGRAM_BUCKETS 64
 
 /**
- * @brief Returns memory handle for mapped memory
+ * @brief Snapshot of the runtime's counters and histograms.
+ */
+typedef struct hsa_amd_runtime_metrics_s {
+  /**
+   * Counters, indexed by ::hsa_amd_runtime_counter_t.
+   */
+  uint64_t counters[HSA_AMD_RUNTIME_COUNTER_COUNT];
+  /**
+   * Histograms, indexed by ::hsa_amd_runtime_histogram_t.
+   */
+  uint64_t histograms[HSA_AMD_RUNTIME_HISTOGRAM_COUNT][HSA_AMD_RUNTIME_HISTOGRAM_BUCKETS];
+} hsa_amd_runtime_metrics_t;
+
+/**
+ * @brief Read the runtime's internal counters and histograms.
  *
- * Return a memory handle for previously mapped memory. The handle will be the same value of handle
- * used to map the memory. The returned handle must be released with corresponding number of calls
- * to hsa_amd_vmem_handle_release.
+ * @details Values are totals since the runtime was loaded, summed over all
+ * threads including ones that have exited.  Updates made concurrently with
+ * the call may or may not be included.  New counters and histograms are only
+ * appended, along with a bump of the interface minor version.
  *
- * @param[out] memory_handle memory handle for this mapped address
- * @param[in] mapped address
+ * @param[out] metrics Snapshot of the metrics.
  *
- * @retval ::HSA_STATUS_SUCCESS
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid address
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p metrics is NULL.
  */
-hsa_status_t hsa_amd_vmem_retain_alloc_handle(hsa_amd_vmem_alloc_handle_t* memory_handle,
-                                              void* addr);
+hsa_status_t HSA_API hsa_amd_runtime_metrics_get(hsa_amd_runtime_metrics_t* metrics);
 
 /**
- * @brief Returns the current allocation properties of a handle
+ * @brief Write out the runtime timeline trace recorded so far.
  *
- * Returns the allocation properties of an existing handle
+ * @details When the HSA_TIMELINE_TRACE environment variable names a file, the
+ * runtime records spans of queue creation, scratch allocation and reclaim,
+ * copies, signal waits, IPC attach and code object loads.  Spans are kept in
+ * per-thread buffers and appended to the file, in Chrome trace event format, by
+ * this call and at runtime shutdown.  Does nothing when tracing is not enabled.
  *
- * @param[in] memory_handle memory handle to be queried
- * @param[out] pool memory pool that owns this handle
- * @param[out] memory type
-
- * @retval ::HSA_STATUS_SUCCESS
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ALLOCATION Invalid memory_handle
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
  */
-hsa_status_t hsa_amd_vmem_get_alloc_properties_from_handle(
-    hsa_amd_vmem_alloc_handle_t memory_handle, hsa_amd_memory_pool_t* pool,
-    hsa_amd_memory_type_t* type);
-
-/** @} */
+hsa_status_t HSA_API hsa_amd_runtime_trace_flush(void);
 
-/** \addtogroup queue Queues
- *  @{
+/**
+ * @brief Freeze an executable without waiting for its code to reach the
+ * agents.
+ *
+ * @details Behaves like ::hsa_executable_freeze, except that the upload of
+ * the loaded code objects and the invalidation of the agents' instruction
+ * caches complete asynchronously.  The executable is frozen when the call
+ * returns, so its symbols may be queried, but none of its kernels may execute
+ * until @p completion_signal has been decremented by one, for example by
+ * using it as a barrier dependency ahead of the first dispatch.  The
+ * executable must not be destroyed before then.
+ *
+ * @param[in] executable Executable.
+ *
+ * @param[in] options Standard and vendor-specific options. Unknown options are
+ * ignored. A standard option begins with the "-hsa_" prefix. Options beginning
+ * with the "-hsa_ext_<extension_name>_" prefix are reserved for extensions. A
+ * vendor-specific option begins with the "-<vendor_name>_" prefix. Must be a
+ * NUL-terminated string. May be NULL.
+ *
+ * @param[in] completion_signal Signal decremented by one once the code of
+ * @p executable is resident on all of its agents.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The freeze has been started.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_EXECUTABLE The executable is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_SIGNAL @p completion_signal is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_FROZEN_EXECUTABLE @p executable is already frozen.
  */
+hsa_status_t HSA_API hsa_amd_executable_freeze_async(hsa_executable_t executable,
+                                                     const char* options,
+                                                     hsa_signal_t completion_signal);
 
 /**
- * @brief Set the asynchronous scratch limit threshold on all the queues for this agent.
- * Dispatches that are enqueued on HW queues on this agent that are smaller than threshold will not
- * result in a scratch use-once method.
- *
- * Increasing this threshold will only increase the internal limit and not cause immediate allocation
- * of additional scratch memory. Decreasing this threshold will result in a release in scratch memory
- * on queues where the current amount of allocated scratch exceeds the new limit.
+ * @brief Destroy several executables at once.
  *
- * This API is only supported on devices that support asynchronous scratch reclaim.
+ * @details Equivalent to calling ::hsa_executable_destroy on each executable
+ * in @p executables, except that the debugger is notified of the unloading of
+ * all their code objects in a single step.  No executable is destroyed if any
+ * of them is invalid.
  *
- * @param[in] agent A valid agent.
+ * @param[in] num_executables Number of executables in @p executables.
  *
- * @param[in] threshold Threshold size in bytes
+ * @param[in] executables Array of @p num_executables distinct executables.
  *
  * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
  *
  * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
  * initialized.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_AGENT The agent is invalid.
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p executables is NULL while
+ * @p num_executables is not 0, or an executable is listed twice.
  *
- * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT This agent does not support asynchronous scratch
- * reclaim
+ * @retval ::HSA_STATUS_ERROR_INVALID_EXECUTABLE An executable is invalid.
  */
-hsa_status_t HSA_API hsa_amd_agent_set_async_scratch_limit(hsa_agent_t agent, size_t threshold);
-
-typedef enum {
-  /*
-   * Returns the agent that owns the underlying HW queue.
-   * The type of this attribute is hsa_agent_t.
-   */
-  HSA_AMD_QUEUE_INFO_AGENT,
-  /*
-   * Returns the doorbell ID of the completion signal of the queue
-   * The type of this attribute is uint64_t.
-   */
-  HSA_AMD_QUEUE_INFO_DOORBELL_ID,
-} hsa_queue_info_attribute_t;
-
-hsa_status_t hsa_amd_queue_get_info(hsa_queue_t* queue, hsa_queue_info_attribute_t attribute,
-                                    void* value);
+hsa_status_t HSA_API hsa_amd_executables_destroy(uint32_t num_executables,
+                                                 const hsa_executable_t* executables);
 
 /**
  * @brief logging types
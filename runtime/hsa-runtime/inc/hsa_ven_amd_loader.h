@@ -527,10 +527,205 @@ hsa_ven_amd_loader_iterate_executables(
 
 //===----------------------------------------------------------------------===//
 
+/**
+ * @brief Load a program code object onto several agents in one call.
+ *
+ * @details Equivalent to calling ::hsa_executable_load_agent_code_object once
+ * per agent in @p agents, in order, except that the code object is parsed
+ * only once. The segment uploads to all agents are issued together when the
+ * executable is frozen, so they overlap instead of running back to back.
+ *
+ * @param[in] executable Executable.
+ *
+ * @param[in] num_agents Number of agents in @p agents. Must not be 0.
+ *
+ * @param[in] agents Array of @p num_agents distinct agents to load the code
+ * object onto. Must not be NULL.
+ *
+ * @param[in] code_object_reader A code object reader that holds the code
+ * object to load.
+ *
+ * @param[in] options Standard and vendor-specific options. Unknown options
+ * are ignored. May be NULL.
+ *
+ * @param[out] loaded_code_objects Array of @p num_agents entries receiving
+ * the loaded code object handle for each agent, in the order of @p agents.
+ * May be NULL.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_EXECUTABLE The executable is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_CODE_OBJECT_READER @p code_object_reader
+ * is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent in @p agents is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p agents is NULL, @p num_agents
+ * is 0, or @p agents contains the same agent more than once.
+ *
+ * @retval ::HSA_STATUS_ERROR_FROZEN_EXECUTABLE @p executable is frozen.
+ *
+ * @retval Any error reported by ::hsa_executable_load_agent_code_object. The
+ * code object may already have been loaded onto some of the agents.
+ */
+hsa_status_t
+hsa_ven_amd_loader_executable_load_agents_code_object(
+    hsa_executable_t executable,
+    uint32_t num_agents,
+    const hsa_agent_t *agents,
+    hsa_code_object_reader_t code_object_reader,
+    const char *options,
+    hsa_loaded_code_object_t *loaded_code_objects);
+
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Dispatch-relevant description of a kernel of a frozen executable.
+ */
+typedef struct hsa_ven_amd_loader_kernel_info_s {
+  /**
+   * Executable symbol of the kernel.
+   */
+  hsa_executable_symbol_t symbol;
+  /**
+   * Agent the kernel is loaded on.
+   */
+  hsa_agent_t agent;
+  /**
+   * Value of ::HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT.
+   */
+  uint64_t kernel_object;
+  /**
+   * NUL-terminated value of ::HSA_EXECUTABLE_SYMBOL_INFO_NAME, valid for the
+   * lifetime of the executable.
+   */
+  const char *name;
+  uint32_t kernarg_segment_size;
+  uint32_t kernarg_segment_alignment;
+  uint32_t group_segment_size;
+  uint32_t private_segment_size;
+  uint32_t wavefront_size;
+  bool is_dynamic_callstack;
+} hsa_ven_amd_loader_kernel_info_t;
+
+/**
+ * @brief Query the description of every kernel of a frozen executable in one
+ * call.
+ *
+ * @details The descriptions are built once when the executable is frozen, so
+ * this costs one copy per kernel instead of one
+ * ::hsa_executable_symbol_get_info call per attribute. If @p kernels is NULL
+ * and @p num_kernels points to zero, records the number of kernels in
+ * @p num_kernels. Otherwise @p num_kernels must point to exactly that number
+ * and the descriptions are recorded in @p kernels, ordered by agent.
+ *
+ * @param[in] executable Frozen executable.
+ *
+ * @param[in] agent If not NULL, only the kernels loaded on this agent are
+ * counted and described.
+ *
+ * @param[in,out] num_kernels Pointer to the number of entries of @p kernels,
+ * or to zero.
+ *
+ * @param[out] kernels Application-allocated array of @p num_kernels entries.
+ * Can be NULL if @p num_kernels points to zero.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_EXECUTABLE The executable is invalid or
+ * not frozen.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p num_kernels is NULL, or
+ * @p kernels is NULL while @p num_kernels points to a non-zero number, or is
+ * not NULL while it points to zero.
+ *
+ * @retval ::HSA_STATUS_ERROR_INCOMPATIBLE_ARGUMENTS @p num_kernels does not
+ * point to the number of kernels.
+ */
+hsa_status_t
+hsa_ven_amd_loader_executable_get_kernels(
+    hsa_executable_t executable,
+    const hsa_agent_t *agent,
+    uint32_t *num_kernels,
+    hsa_ven_amd_loader_kernel_info_t *kernels);
+
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Location of a code object within an offload bundle.
+ */
+typedef struct hsa_ven_amd_loader_bundled_code_object_s {
+  /**
+   * Byte offset of the code object from the start of the bundle.
+   */
+  size_t offset;
+  /**
+   * Size of the code object in bytes, 0 if the bundle holds no code object
+   * compatible with the agent.
+   */
+  size_t size;
+} hsa_ven_amd_loader_bundled_code_object_t;
+
+/**
+ * @brief Select the best code object of a clang offload bundle for each of
+ * several agents.
+ *
+ * @details Only the bundle header and the ELF header of each bundled code
+ * object are read, the code objects are not parsed.  A code object for the
+ * agent's processor is preferred over a generic one, and one built for the
+ * agent's exact XNACK and SRAMECC settings over one that accepts any setting.
+ * Among equally good code objects the first in the bundle is selected.  The
+ * selected range may be passed to
+ * ::hsa_code_object_reader_create_from_memory.
+ *
+ * Code objects older than code object version 3 name their target in a note
+ * and are never selected, and compressed bundles are not supported.
+ *
+ * @param[in] bundle Uncompressed clang offload bundle.
+ *
+ * @param[in] bundle_size Size of @p bundle in bytes.
+ *
+ * @param[in] num_agents Number of agents in @p agents.
+ *
+ * @param[in] agents Array of @p num_agents agents to select code objects for.
+ *
+ * @param[out] code_objects Array of @p num_agents entries receiving the
+ * selection for each agent, in the order of @p agents.
+ *
+ * @retval ::HSA_STATUS_SUCCESS The function has been executed successfully.
+ *
+ * @retval ::HSA_STATUS_ERROR_NOT_INITIALIZED The HSA runtime has not been
+ * initialized.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_AGENT An agent in @p agents is invalid.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_CODE_OBJECT @p bundle is not an
+ * uncompressed offload bundle, or an entry extends past @p bundle_size.
+ *
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p bundle, @p agents or
+ * @p code_objects is NULL, or @p num_agents is 0.
+ */
+hsa_status_t
+hsa_ven_amd_loader_select_bundled_code_objects(
+    const void *bundle,
+    size_t bundle_size,
+    uint32_t num_agents,
+    const hsa_agent_t *agents,
+    hsa_ven_amd_loader_bundled_code_object_t *code_objects);
+
+//===----------------------------------------------------------------------===//
+
 /**
  * @brief Extension version.
  */
-#define hsa_ven_amd_loader 001003
+#define hsa_ven_amd_loader 001006
 
 /**
  * @brief Extension function table version 1.00.
@@ -660,6 +855,187 @@ typedef struct hsa_ven_amd_loader_1_03_pfn_s {
       void *data);
 } hsa_ven_amd_loader_1_03_pfn_t;
 
+/**
+ * @brief Extension function table version 1.04.
+ */
+typedef struct hsa_ven_amd_loader_1_04_pfn_s {
+  hsa_status_t (*hsa_ven_amd_loader_query_host_address)(
+    const void *device_address,
+    const void **host_address);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_segment_descriptors)(
+    hsa_ven_amd_loader_segment_descriptor_t *segment_descriptors,
+    size_t *num_segment_descriptors);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_executable)(
+    const void *device_address,
+    hsa_executable_t *executable);
+
+  hsa_status_t (*hsa_ven_amd_loader_executable_iterate_loaded_code_objects)(
+    hsa_executable_t executable,
+    hsa_status_t (*callback)(
+      hsa_executable_t executable,
+      hsa_loaded_code_object_t loaded_code_object,
+      void *data),
+    void *data);
+
+  hsa_status_t (*hsa_ven_amd_loader_loaded_code_object_get_info)(
+    hsa_loaded_code_object_t loaded_code_object,
+    hsa_ven_amd_loader_loaded_code_object_info_t attribute,
+    void *value);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_code_object_reader_create_from_file_with_offset_size)(
+      hsa_file_t file,
+      size_t offset,
+      size_t size,
+      hsa_code_object_reader_t *code_object_reader);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_iterate_executables)(
+      hsa_status_t (*callback)(
+        hsa_executable_t executable,
+        void *data),
+      void *data);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_load_agents_code_object)(
+      hsa_executable_t executable,
+      uint32_t num_agents,
+      const hsa_agent_t *agents,
+      hsa_code_object_reader_t code_object_reader,
+      const char *options,
+      hsa_loaded_code_object_t *loaded_code_objects);
+} hsa_ven_amd_loader_1_04_pfn_t;
+
+/**
+ * @brief Extension function table version 1.05.
+ */
+typedef struct hsa_ven_amd_loader_1_05_pfn_s {
+  hsa_status_t (*hsa_ven_amd_loader_query_host_address)(
+    const void *device_address,
+    const void **host_address);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_segment_descriptors)(
+    hsa_ven_amd_loader_segment_descriptor_t *segment_descriptors,
+    size_t *num_segment_descriptors);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_executable)(
+    const void *device_address,
+    hsa_executable_t *executable);
+
+  hsa_status_t (*hsa_ven_amd_loader_executable_iterate_loaded_code_objects)(
+    hsa_executable_t executable,
+    hsa_status_t (*callback)(
+      hsa_executable_t executable,
+      hsa_loaded_code_object_t loaded_code_object,
+      void *data),
+    void *data);
+
+  hsa_status_t (*hsa_ven_amd_loader_loaded_code_object_get_info)(
+    hsa_loaded_code_object_t loaded_code_object,
+    hsa_ven_amd_loader_loaded_code_object_info_t attribute,
+    void *value);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_code_object_reader_create_from_file_with_offset_size)(
+      hsa_file_t file,
+      size_t offset,
+      size_t size,
+      hsa_code_object_reader_t *code_object_reader);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_iterate_executables)(
+      hsa_status_t (*callback)(
+        hsa_executable_t executable,
+        void *data),
+      void *data);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_load_agents_code_object)(
+      hsa_executable_t executable,
+      uint32_t num_agents,
+      const hsa_agent_t *agents,
+      hsa_code_object_reader_t code_object_reader,
+      const char *options,
+      hsa_loaded_code_object_t *loaded_code_objects);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_get_kernels)(
+      hsa_executable_t executable,
+      const hsa_agent_t *agent,
+      uint32_t *num_kernels,
+      hsa_ven_amd_loader_kernel_info_t *kernels);
+} hsa_ven_amd_loader_1_05_pfn_t;
+
+/**
+ * @brief Extension function table version 1.06.
+ */
+typedef struct hsa_ven_amd_loader_1_06_pfn_s {
+  hsa_status_t (*hsa_ven_amd_loader_query_host_address)(
+    const void *device_address,
+    const void **host_address);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_segment_descriptors)(
+    hsa_ven_amd_loader_segment_descriptor_t *segment_descriptors,
+    size_t *num_segment_descriptors);
+
+  hsa_status_t (*hsa_ven_amd_loader_query_executable)(
+    const void *device_address,
+    hsa_executable_t *executable);
+
+  hsa_status_t (*hsa_ven_amd_loader_executable_iterate_loaded_code_objects)(
+    hsa_executable_t executable,
+    hsa_status_t (*callback)(
+      hsa_executable_t executable,
+      hsa_loaded_code_object_t loaded_code_object,
+      void *data),
+    void *data);
+
+  hsa_status_t (*hsa_ven_amd_loader_loaded_code_object_get_info)(
+    hsa_loaded_code_object_t loaded_code_object,
+    hsa_ven_amd_loader_loaded_code_object_info_t attribute,
+    void *value);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_code_object_reader_create_from_file_with_offset_size)(
+      hsa_file_t file,
+      size_t offset,
+      size_t size,
+      hsa_code_object_reader_t *code_object_reader);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_iterate_executables)(
+      hsa_status_t (*callback)(
+        hsa_executable_t executable,
+        void *data),
+      void *data);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_load_agents_code_object)(
+      hsa_executable_t executable,
+      uint32_t num_agents,
+      const hsa_agent_t *agents,
+      hsa_code_object_reader_t code_object_reader,
+      const char *options,
+      hsa_loaded_code_object_t *loaded_code_objects);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_executable_get_kernels)(
+      hsa_executable_t executable,
+      const hsa_agent_t *agent,
+      uint32_t *num_kernels,
+      hsa_ven_amd_loader_kernel_info_t *kernels);
+
+  hsa_status_t
+    (*hsa_ven_amd_loader_select_bundled_code_objects)(
+      const void *bundle,
+      size_t bundle_size,
+      uint32_t num_agents,
+      const hsa_agent_t *agents,
+      hsa_ven_amd_loader_bundled_code_object_t *code_objects);
+} hsa_ven_amd_loader_1_06_pfn_t;
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -136,7 +136,8 @@ typedef hsa_status_t (*hsa_ven_amd_pcs_data_copy_callback_t)(void* hsa_callback_
  *
  * When the client receives this callback, the client should call back @p data_copy_callback for HSA
  * to perform the copy operation into an available buffer. @p data_copy_callback can be called back
- * multiple times with smaller @p data_size to split the copy operation.
+ * multiple times with smaller @p data_size to split the copy operation. Alternatively the client
+ * can read the data in place with ::hsa_ven_amd_pcs_data_view.
  *
  * This callback must not call ::hsa_ven_amd_pcs_flush.
  *
@@ -152,6 +153,47 @@ typedef void (*hsa_ven_amd_pcs_data_ready_callback_t)(
     void* client_callback_data, size_t data_size, size_t lost_sample_count,
     hsa_ven_amd_pcs_data_copy_callback_t data_copy_callback, void* hsa_callback_data);
 
+/**
+ * @brief PC Sampling data handed to a data_ready_callback, read in place
+ *
+ * The samples are in @p buf1 followed by @p buf2. @p buf2 is NULL unless the data wraps around
+ * the end of the HSA internal buffer.
+ */
+typedef struct {
+  const void* buf1;
+  size_t buf1_size;
+  const void* buf2;
+  size_t buf2_size;
+} hsa_ven_amd_pcs_data_view_t;
+
+/**
+ * @brief PC Sampling hits of one PC within one kernel dispatch
+ *
+ * @p offset is the address of the PC in the ELF virtual address space of @p code_object, that is
+ * the PC minus HSA_VEN_AMD_LOADER_LOADED_CODE_OBJECT_INFO_LOAD_DELTA. If the PC does not belong to
+ * a code object of a frozen executable, @p code_object is NULL and @p offset is the PC.
+ */
+typedef struct {
+  uint64_t correlation_id;
+  hsa_loaded_code_object_t code_object;
+  uint64_t offset;
+  uint64_t hit_count;
+} hsa_ven_amd_pcs_histogram_entry_t;
+
+/**
+ * @brief HSA callback function delivering the PC Sampling histogram of a session
+ *
+ * @param[in] client_callback_data client private data passed in via
+ * hsa_ven_amd_pcs_aggregate
+ * @param[in] entries histogram entries, ordered by correlation_id then PC. Only valid until the
+ * callback returns.
+ * @param[in] entry_count number of entries in @p entries
+ * @param[in] lost_sample_count number of lost samples since the last histogram
+ */
+typedef void (*hsa_ven_amd_pcs_histogram_callback_t)(
+    void* client_callback_data, const hsa_ven_amd_pcs_histogram_entry_t* entries,
+    size_t entry_count, size_t lost_sample_count);
+
 /**
  * @brief Opaque handle representing a sampling session.
  * Two sessions having same handle value represent the same session
@@ -375,6 +417,49 @@ hsa_status_t hsa_ven_amd_pcs_stop(hsa_ven_amd_pcs_t pc_sampling);
  */
 hsa_status_t hsa_ven_amd_pcs_flush(hsa_ven_amd_pcs_t pc_sampling);
 
+/**
+ * @brief  Read the data of a data_ready_callback without copying it
+ *
+ * Zero-copy alternative to the data_copy_callback. Must be called from within the
+ * data_ready_callback, the buffers in @p view point into HSA internal buffers and are only valid
+ * until the data_ready_callback returns. They must not be written, as other sessions on the same
+ * agent may read the same samples. The data is consumed when the data_ready_callback returns,
+ * whether or not data_copy_callback was called.
+ *
+ * @param[in] hsa_callback_data private data passed to the data_ready_callback
+ * @param[out] view location of the samples
+ *
+ * @retval ::HSA_STATUS_SUCCESS @p view filled in successfully
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT @p view is NULL or the function was not called from
+ * within a data_ready_callback
+ */
+hsa_status_t hsa_ven_amd_pcs_data_view(void* hsa_callback_data,
+                                       hsa_ven_amd_pcs_data_view_t* view);
+
+/**
+ * @brief  Aggregate the samples of a session into a histogram instead of delivering them
+ *
+ * Once enabled, samples of @p pc_sampling are no longer passed to its data_ready_callback. HSA
+ * counts the hits of every PC for every kernel dispatch instead, and delivers the counts with
+ * one invocation of @p histogram_callback from within each call to ::hsa_ven_amd_pcs_flush, on
+ * the calling thread. The histogram is reset after every delivery. Samples aggregated after the
+ * last flush are discarded by ::hsa_ven_amd_pcs_destroy.
+ *
+ * Must be called while the session is stopped. Passing a NULL @p histogram_callback restores the
+ * delivery of raw samples.
+ *
+ * @param[in] pc_sampling PC sampling session handle
+ * @param[in] histogram_callback callback function receiving the histogram
+ * @param[in] client_callback_data client private data passed back to @p histogram_callback
+ *
+ * @retval ::HSA_STATUS_SUCCESS Aggregation configured successfully
+ * @retval ::HSA_STATUS_ERROR_INVALID_ARGUMENT Invalid PC sampling handle
+ * @retval ::HSA_STATUS_ERROR Session is currently started
+ */
+hsa_status_t hsa_ven_amd_pcs_aggregate(hsa_ven_amd_pcs_t pc_sampling,
+                                       hsa_ven_amd_pcs_histogram_callback_t histogram_callback,
+                                       void* client_callback_data);
+
 #define hsa_ven_amd_pc_sampling_1_00
 
 /**
@@ -409,6 +494,84 @@ typedef struct hsa_ven_amd_pc_sampling_1_00_pfn_t {
 
 } hsa_ven_amd_pc_sampling_1_00_pfn_t;
 
+#define hsa_ven_amd_pc_sampling_1_01
+
+/**
+ * @brief The function pointer table for the PC Sampling v1.01 extension. Can be returned by
+ * ::hsa_system_get_extension_table or ::hsa_system_get_major_extension_table.
+ */
+typedef struct hsa_ven_amd_pc_sampling_1_01_pfn_t {
+  hsa_status_t (*hsa_ven_amd_pcs_iterate_configuration)(
+      hsa_agent_t agent, hsa_ven_amd_pcs_iterate_configuration_callback_t configuration_callback,
+      void* callback_data);
+
+  hsa_status_t (*hsa_ven_amd_pcs_create)(hsa_agent_t agent, hsa_ven_amd_pcs_method_kind_t method,
+                                         hsa_ven_amd_pcs_units_t units, size_t interval,
+                                         size_t latency, size_t buffer_size,
+                                         hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback,
+                                         void* client_callback_data,
+                                         hsa_ven_amd_pcs_t* pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_create_from_id)(
+      uint32_t pcs_id, hsa_agent_t agent, hsa_ven_amd_pcs_method_kind_t method,
+      hsa_ven_amd_pcs_units_t units, size_t interval, size_t latency, size_t buffer_size,
+      hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback, void* client_callback_data,
+      hsa_ven_amd_pcs_t* pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_destroy)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_start)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_stop)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_flush)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_data_view)(void* hsa_callback_data,
+                                            hsa_ven_amd_pcs_data_view_t* view);
+
+} hsa_ven_amd_pc_sampling_1_01_pfn_t;
+
+#define hsa_ven_amd_pc_sampling_1_02
+
+/**
+ * @brief The function pointer table for the PC Sampling v1.02 extension. Can be returned by
+ * ::hsa_system_get_extension_table or ::hsa_system_get_major_extension_table.
+ */
+typedef struct hsa_ven_amd_pc_sampling_1_02_pfn_t {
+  hsa_status_t (*hsa_ven_amd_pcs_iterate_configuration)(
+      hsa_agent_t agent, hsa_ven_amd_pcs_iterate_configuration_callback_t configuration_callback,
+      void* callback_data);
+
+  hsa_status_t (*hsa_ven_amd_pcs_create)(hsa_agent_t agent, hsa_ven_amd_pcs_method_kind_t method,
+                                         hsa_ven_amd_pcs_units_t units, size_t interval,
+                                         size_t latency, size_t buffer_size,
+                                         hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback,
+                                         void* client_callback_data,
+                                         hsa_ven_amd_pcs_t* pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_create_from_id)(
+      uint32_t pcs_id, hsa_agent_t agent, hsa_ven_amd_pcs_method_kind_t method,
+      hsa_ven_amd_pcs_units_t units, size_t interval, size_t latency, size_t buffer_size,
+      hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback, void* client_callback_data,
+      hsa_ven_amd_pcs_t* pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_destroy)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_start)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_stop)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_flush)(hsa_ven_amd_pcs_t pc_sampling);
+
+  hsa_status_t (*hsa_ven_amd_pcs_data_view)(void* hsa_callback_data,
+                                            hsa_ven_amd_pcs_data_view_t* view);
+
+  hsa_status_t (*hsa_ven_amd_pcs_aggregate)(
+      hsa_ven_amd_pcs_t pc_sampling, hsa_ven_amd_pcs_histogram_callback_t histogram_callback,
+      void* client_callback_data);
+
+} hsa_ven_amd_pc_sampling_1_02_pfn_t;
+
 #ifdef __cplusplus
 }  // end extern "C" block
 #endif /*__cplusplus*/
@@ -44,11 +44,21 @@
 #include <elf.h>
 #include <fcntl.h>
 #include <sys/resource.h>
+#include <sys/uio.h>
+#include <climits>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <sstream>
 #include <fstream>
 #include <memory>
+#if defined(HSA_COREDUMP_ZSTD)
+#include <zstd.h>
+#endif
 #include "core/util/utils.h"
 #include "./amd_hsa_code_util.hpp"
 #include "core/inc/amd_core_dump.hpp"
@@ -59,6 +69,8 @@ constexpr uint32_t LOAD_ALIGNMENT_SHIFT = 4;
 constexpr uint32_t NOTE_ALIGNMENT_SHIFT = 2;
 const std::string PREFIX_FILE_NAME = "gpucore";
 constexpr size_t MAX_BUFFER_SIZE = 4 * 1024 * 1024;
+constexpr size_t ZERO_PAGE_SIZE = 4096;
+constexpr uint32_t MAX_COPY_THREADS = 8;
 
 namespace rocr {
 namespace amd {
@@ -68,7 +80,7 @@ namespace impl {
 class PackageBuilder {
  public:
   PackageBuilder() : st_(std::stringstream::out | std::stringstream::binary) {}
-  size_t Size() const { return st_.str().size(); }
+  size_t Size() { return static_cast<size_t>(st_.tellp()); }
   template <typename T, typename = typename std::enable_if<!std::is_pointer<T>::value>::type>
   void Write(const T& v) {
     st_.write((char*)&v, sizeof(T));
@@ -110,6 +122,9 @@ struct SegmentBuilder {
   virtual hsa_status_t Collect(SegmentsInfo& segments) = 0;
   /* Called to read a given SegmentInfo's data.  */
   virtual hsa_status_t Read(void* buf, size_t buf_size, off_t offset) = 0;
+  /* Segments already held in host memory return their contents here so
+     they can be written in place instead of being copied through a buffer.  */
+  virtual const unsigned char* Data() const { return nullptr; }
 };
 
 struct NoteSegmentBuilder : public SegmentBuilder {
@@ -199,6 +214,8 @@ struct NoteSegmentBuilder : public SegmentBuilder {
     return HSA_STATUS_SUCCESS;
   }
 
+  const unsigned char* Data() const override { return raw_.data(); }
+
  private:
   PackageBuilder note_package_builder_;
   std::vector<unsigned char> raw_;
@@ -291,8 +308,250 @@ struct LoadSegmentBuilder : public SegmentBuilder {
   int fd_ = -1;
 };
 
-hsa_status_t build_core_dump(const std::string& filename, const SegmentsInfo& segments) {
-  std::unique_ptr<unsigned char[]> copy_buffer(new unsigned char[MAX_BUFFER_SIZE]);
+/* A piece of a segment copied by one worker: SIZE bytes read at VADDR
+   through BUILDER and stored at OFFSET in the (uncompressed) dump.  */
+struct CopyChunk {
+  SegmentBuilder* builder;
+  uint64_t vaddr;
+  uint64_t offset;
+  size_t size;
+};
+
+static bool is_zero(const unsigned char* buf, size_t size) {
+  return size == 0 || (buf[0] == 0 && memcmp(buf, buf + 1, size - 1) == 0);
+}
+
+static bool write_all(int fd, const unsigned char* buf, size_t size, off_t offset) {
+  while (size > 0) {
+    ssize_t written = pwrite(fd, buf, size, offset);
+    if (written == -1) {
+      if (errno == EINTR) continue;
+      perror("Failed to write core dump");
+      return false;
+    }
+    buf += written;
+    offset += written;
+    size -= written;
+  }
+  return true;
+}
+
+/* Write the buffers in IOV back to back starting at OFFSET.  */
+static bool write_all(int fd, struct iovec* iov, int iovcnt, off_t offset) {
+  while (iovcnt > 0) {
+    ssize_t written = pwritev(fd, iov, std::min(iovcnt, IOV_MAX), offset);
+    if (written == -1) {
+      if (errno == EINTR) continue;
+      perror("Failed to write core dump");
+      return false;
+    }
+    offset += written;
+    while (iovcnt > 0 && static_cast<size_t>(written) >= iov->iov_len) {
+      written -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+      iov->iov_len -= written;
+    }
+  }
+  return true;
+}
+
+/* Write CHUNK's data from BUF, skipping all-zero pages.  The dump file starts
+   out empty so skipped pages are left as holes and read back as zeros.  */
+static bool write_sparse(int fd, const unsigned char* buf, const CopyChunk& chunk) {
+  size_t pos = 0;
+  while (pos < chunk.size) {
+    size_t len = std::min(ZERO_PAGE_SIZE, chunk.size - pos);
+    if (is_zero(buf + pos, len)) {
+      pos += len;
+      continue;
+    }
+    size_t start = pos;
+    do {
+      pos += len;
+      len = std::min(ZERO_PAGE_SIZE, chunk.size - pos);
+    } while (pos < chunk.size && !is_zero(buf + pos, len));
+    if (!write_all(fd, buf + start, pos - start, chunk.offset + start)) return false;
+  }
+  return true;
+}
+
+static bool read_chunk(unsigned char* buf, const CopyChunk& chunk) {
+  try {
+    return chunk.builder->Read(buf, chunk.size, chunk.vaddr) == HSA_STATUS_SUCCESS;
+  } catch (...) {
+    return false;
+  }
+}
+
+/* Copy all chunks in parallel.  File offsets are fixed up front, so every
+   worker reads and writes independently.  */
+static hsa_status_t copy_chunks(int fd, const std::vector<CopyChunk>& chunks, uint32_t threads) {
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+
+  auto worker = [&]() {
+    std::unique_ptr<unsigned char[]> buffer(new (std::nothrow) unsigned char[MAX_BUFFER_SIZE]);
+    if (!buffer) {
+      failed = true;
+      return;
+    }
+    for (size_t i = next++; i < chunks.size() && !failed; i = next++) {
+      if (!read_chunk(buffer.get(), chunks[i]) || !write_sparse(fd, buffer.get(), chunks[i]))
+        failed = true;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  try {
+    for (uint32_t i = 1; i < threads; i++) workers.emplace_back(worker);
+  } catch (...) {
+    /* Carry on with the workers we got.  */
+  }
+  worker();
+  for (auto& t : workers) t.join();
+
+  return failed ? HSA_STATUS_ERROR : HSA_STATUS_SUCCESS;
+}
+
+#if defined(HSA_COREDUMP_ZSTD)
+class ZstdWriter {
+ public:
+  explicit ZstdWriter(int fd)
+      : fd_(fd),
+        ctx_(ZSTD_createCCtx()),
+        out_(new (std::nothrow) unsigned char[ZSTD_CStreamOutSize()]),
+        pos_(0),
+        out_pos_(0) {}
+  ~ZstdWriter() { ZSTD_freeCCtx(ctx_); }
+
+  bool Init() {
+    if (!ctx_ || !out_) return false;
+    return !ZSTD_isError(ZSTD_CCtx_setParameter(ctx_, ZSTD_c_compressionLevel, 1));
+  }
+
+  /* Append zeros up to OFFSET in the uncompressed stream.  */
+  bool PadTo(uint64_t offset) {
+    static const unsigned char zeros[256] = {};
+    while (pos_ < offset) {
+      if (!Write(zeros, std::min<uint64_t>(sizeof(zeros), offset - pos_))) return false;
+    }
+    return true;
+  }
+
+  bool Write(const void* data, size_t size) {
+    pos_ += size;
+    return Stream(data, size, ZSTD_e_continue);
+  }
+
+  bool Finish() { return Stream(nullptr, 0, ZSTD_e_end); }
+
+ private:
+  bool Stream(const void* data, size_t size, ZSTD_EndDirective mode) {
+    ZSTD_inBuffer in = {data, size, 0};
+    bool done;
+    do {
+      ZSTD_outBuffer out = {out_.get(), ZSTD_CStreamOutSize(), 0};
+      size_t remaining = ZSTD_compressStream2(ctx_, &out, &in, mode);
+      if (ZSTD_isError(remaining)) {
+        fprintf(stderr, "Failed to compress core dump: %s\n", ZSTD_getErrorName(remaining));
+        return false;
+      }
+      if (!write_all(fd_, out_.get(), out.pos, out_pos_)) return false;
+      out_pos_ += out.pos;
+      done = (mode == ZSTD_e_end) ? remaining == 0 : in.pos == in.size;
+    } while (!done);
+    return true;
+  }
+
+  int fd_;
+  ZSTD_CCtx* ctx_;
+  std::unique_ptr<unsigned char[]> out_;
+  uint64_t pos_;      /* Uncompressed bytes consumed.  */
+  uint64_t out_pos_;  /* Compressed bytes written.  */
+};
+
+/* Copy all chunks into a single zstd stream.  Workers read ahead into a ring
+   of slots while this thread compresses the slots in file order.  */
+static hsa_status_t compress_chunks(int fd, const std::vector<iovec>& head,
+                                    const std::vector<CopyChunk>& chunks, uint32_t threads,
+                                    uint64_t file_size) {
+  struct Slot {
+    std::unique_ptr<unsigned char[]> buffer;
+    size_t index;
+    bool ready = false;
+  };
+
+  ZstdWriter writer(fd);
+  if (!writer.Init()) return HSA_STATUS_ERROR;
+  for (const iovec& iov : head)
+    if (!writer.Write(iov.iov_base, iov.iov_len)) return HSA_STATUS_ERROR;
+
+  const size_t nslots = 2 * threads;
+  std::vector<Slot> slots(nslots);
+  for (size_t i = 0; i < nslots; i++) {
+    slots[i].buffer.reset(new (std::nothrow) unsigned char[MAX_BUFFER_SIZE]);
+    if (!slots[i].buffer) return HSA_STATUS_ERROR;
+    slots[i].index = i;
+  }
+
+  std::mutex lock;
+  std::condition_variable cond;
+  std::atomic<size_t> next(0);
+  bool failed = false;
+
+  auto worker = [&]() {
+    for (size_t i = next++; i < chunks.size(); i = next++) {
+      Slot& slot = slots[i % nslots];
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        cond.wait(guard, [&]() { return failed || slot.index == i; });
+        if (failed) return;
+      }
+      bool ok = read_chunk(slot.buffer.get(), chunks[i]);
+      std::lock_guard<std::mutex> guard(lock);
+      if (ok)
+        slot.ready = true;
+      else
+        failed = true;
+      cond.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  try {
+    for (uint32_t i = 0; i < threads; i++) workers.emplace_back(worker);
+  } catch (...) {
+    if (workers.empty()) return HSA_STATUS_ERROR;
+  }
+
+  bool ok = true;
+  for (size_t i = 0; ok && i < chunks.size(); i++) {
+    Slot& slot = slots[i % nslots];
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      cond.wait(guard, [&]() { return failed || slot.ready; });
+      if (failed) break;
+    }
+    ok = writer.PadTo(chunks[i].offset) && writer.Write(slot.buffer.get(), chunks[i].size);
+    std::lock_guard<std::mutex> guard(lock);
+    slot.ready = false;
+    slot.index += nslots;
+    if (!ok) failed = true;
+    cond.notify_all();
+  }
+  for (auto& t : workers) t.join();
+
+  if (failed || !writer.PadTo(file_size) || !writer.Finish()) return HSA_STATUS_ERROR;
+  return HSA_STATUS_SUCCESS;
+}
+#endif
+
+hsa_status_t build_core_dump(const std::string& filename, const SegmentsInfo& segments,
+                             const DumpOptions& options) {
   struct rlimit rlimit;
 
   if (getrlimit(RLIMIT_CORE, &rlimit)) {
@@ -307,49 +566,20 @@ hsa_status_t build_core_dump(const std::string& filename, const SegmentsInfo& se
     debug_print("Core file size over limit\n");
     return HSA_STATUS_SUCCESS;
   }
-  int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
-  if (fd == -1) {
-    perror("Failed to create GPU coredump");
-    return HSA_STATUS_ERROR;
-  }
-  Elf64_Ehdr ehdr{};
-  ehdr.e_ident[EI_MAG0] = ELFMAG0;
-  ehdr.e_ident[EI_MAG1] = ELFMAG1;
-  ehdr.e_ident[EI_MAG2] = ELFMAG2;
-  ehdr.e_ident[EI_MAG3] = ELFMAG3;
-  ehdr.e_ident[EI_CLASS] = ELFCLASS64;
-  ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
-  ehdr.e_ident[EI_VERSION] = EV_CURRENT;
-  ehdr.e_ident[EI_OSABI] = ELF::ELFOSABI_AMDGPU_HSA;
-  ehdr.e_ident[EI_ABIVERSION] = 0;
-  ehdr.e_type = ET_CORE;
-  ehdr.e_machine = ELF::EM_AMDGPU;
-  ehdr.e_version = EV_CURRENT;
-  ehdr.e_entry = 0;
-  ehdr.e_phoff = sizeof(Elf64_Ehdr);
-  ehdr.e_shoff = 0;
-  ehdr.e_flags = 0;
-  ehdr.e_ehsize = sizeof(Elf64_Ehdr);
-  ehdr.e_phentsize = sizeof(Elf64_Phdr);
-  ehdr.e_phnum = segments.size();
-  ehdr.e_shentsize = 0;
-  ehdr.e_shnum = 0;
-  ehdr.e_shstrndx = 0;
 
-  if (write(fd, &ehdr, sizeof(ehdr)) == -1) {
-    perror("Failed to write ELF header");
-    close(fd);
-    return HSA_STATUS_ERROR;
-  }
-
-  /* Make sure that the underlying file has enough space for the file headers. */
-  int error = posix_fallocate(fd, sizeof(Elf64_Ehdr), segments.size() * sizeof(Elf64_Phdr));
-  if (error != 0) {
-    fprintf(stderr, "Failed to allocate file: %s\n", strerror(error));
-    close(fd);
-    return HSA_STATUS_ERROR;
-  }
-  size_t idx = 0;
+  /* Lay out the program headers and split the segments into chunks before
+     touching the file.  Segments past the core file limit are dropped.
+     In-memory segments placed before any chunked one are written straight
+     from their builder together with the headers.  */
+  struct InlineSegment {
+    uint64_t offset;
+    const unsigned char* data;
+    size_t size;
+  };
+  std::vector<Elf64_Phdr> phdrs;
+  std::vector<InlineSegment> inline_segments;
+  std::vector<CopyChunk> chunks;
+  bool truncated = false;
   for (SegmentInfo seg : segments) {
     Elf64_Phdr phdr{};
     phdr.p_type = [](SegmentType s) {
@@ -380,56 +610,102 @@ hsa_status_t build_core_dump(const std::string& filename, const SegmentsInfo& se
       }
     }(seg.stype);
     if (rlimit.rlim_cur != -1 && (offset + seg.size > rlimit.rlim_cur)) {
-      printf("Core limit file reached. GPU core dump created: %s\n", filename.c_str());
-      close(fd);
-      return HSA_STATUS_SUCCESS;
+      truncated = true;
+      break;
     }
     phdr.p_offset = alignUp(offset, (uint64_t)1 << phdr.p_align);
-    if (pwrite(fd, &phdr, sizeof(phdr), sizeof(Elf64_Ehdr) + idx * sizeof(Elf64_Phdr)) == -1) {
-      perror("Failed to write ELF header");
-      close(fd);
-      return HSA_STATUS_ERROR;
-    }
-    /* Allocate stace for the segment on the file, and write the segment
-       content.  */
-    error = posix_fallocate(fd, phdr.p_offset, phdr.p_filesz);
-    if (error != 0) {
-      fprintf(stderr, "Failed to allocate file: %s\n", strerror(error));
-      close(fd);
-      return HSA_STATUS_ERROR;
-    }
-    size_t remaining = phdr.p_filesz;
-    while (remaining > 0) {
-      size_t curr_chunk = std::min(remaining, MAX_BUFFER_SIZE);
-      try {
-        hsa_status_t st = seg.builder->Read(copy_buffer.get(), curr_chunk,
-                                                    phdr.p_vaddr + phdr.p_filesz - remaining);
-        if (st != HSA_STATUS_SUCCESS) {
-          close(fd);
-          return st;
-        }
-        if (pwrite(fd, copy_buffer.get(), curr_chunk, phdr.p_offset + phdr.p_filesz - remaining) ==
-            -1) {
-          perror("Failed to white core dump");
-          close(fd);
-          return HSA_STATUS_ERROR;
-        }
-      } catch (...) {
-        close(fd);
-        return HSA_STATUS_ERROR;
+    const unsigned char* data = seg.builder->Data();
+    if (data && chunks.empty()) {
+      inline_segments.push_back({phdr.p_offset, data, phdr.p_filesz});
+    } else {
+      for (uint64_t done = 0; done < phdr.p_filesz; done += MAX_BUFFER_SIZE) {
+        chunks.push_back({seg.builder, phdr.p_vaddr + done, phdr.p_offset + done,
+                          std::min<size_t>(phdr.p_filesz - done, MAX_BUFFER_SIZE)});
       }
-      remaining -= curr_chunk;
     }
-    offset += phdr.p_filesz;
-    idx++;
+    phdrs.push_back(phdr);
+    offset = phdr.p_offset + phdr.p_filesz;
+  }
+  uint64_t file_size = offset;
+
+  Elf64_Ehdr ehdr{};
+  ehdr.e_ident[EI_MAG0] = ELFMAG0;
+  ehdr.e_ident[EI_MAG1] = ELFMAG1;
+  ehdr.e_ident[EI_MAG2] = ELFMAG2;
+  ehdr.e_ident[EI_MAG3] = ELFMAG3;
+  ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+  ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+  ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+  ehdr.e_ident[EI_OSABI] = ELF::ELFOSABI_AMDGPU_HSA;
+  ehdr.e_ident[EI_ABIVERSION] = 0;
+  ehdr.e_type = ET_CORE;
+  ehdr.e_machine = ELF::EM_AMDGPU;
+  ehdr.e_version = EV_CURRENT;
+  ehdr.e_entry = 0;
+  ehdr.e_phoff = sizeof(Elf64_Ehdr);
+  ehdr.e_shoff = 0;
+  ehdr.e_flags = 0;
+  ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+  ehdr.e_phentsize = sizeof(Elf64_Phdr);
+  ehdr.e_phnum = phdrs.size();
+  ehdr.e_shentsize = 0;
+  ehdr.e_shnum = 0;
+  ehdr.e_shstrndx = 0;
+
+  /* Everything up to the first chunked segment goes out in one vectored
+     write, alignment padding included.  */
+  static unsigned char padding[1 << LOAD_ALIGNMENT_SHIFT] = {};
+  std::vector<iovec> head = {{&ehdr, sizeof(ehdr)},
+                             {phdrs.data(), phdrs.size() * sizeof(Elf64_Phdr)}};
+  uint64_t head_end = sizeof(ehdr) + phdrs.size() * sizeof(Elf64_Phdr);
+  for (const InlineSegment& seg : inline_segments) {
+    assert(seg.offset - head_end <= sizeof(padding));
+    if (seg.offset > head_end) head.push_back({padding, seg.offset - head_end});
+    head.push_back({const_cast<unsigned char*>(seg.data), seg.size});
+    head_end = seg.offset + seg.size;
+  }
+
+  uint32_t threads = options.threads;
+  if (threads == 0) threads = std::min(std::thread::hardware_concurrency(), MAX_COPY_THREADS);
+  threads = std::max(1u, std::min<uint32_t>(threads, chunks.size()));
+
+  std::string path = filename;
+#if defined(HSA_COREDUMP_ZSTD)
+  if (options.compress) path += ".zst";
+#endif
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd == -1) {
+    perror("Failed to create GPU coredump");
+    return HSA_STATUS_ERROR;
+  }
+
+  hsa_status_t status;
+#if defined(HSA_COREDUMP_ZSTD)
+  if (options.compress) {
+    status = compress_chunks(fd, head, chunks, threads, file_size);
+  } else
+#endif
+  {
+    status = write_all(fd, head.data(), head.size(), 0) ? copy_chunks(fd, chunks, threads)
+                                                        : HSA_STATUS_ERROR;
+    /* Materialize trailing zero pages that were skipped.  */
+    if (status == HSA_STATUS_SUCCESS && ftruncate(fd, file_size) == -1) {
+      perror("Failed to size core dump");
+      status = HSA_STATUS_ERROR;
+    }
   }
-  printf("GPU core dump created: %s\n", filename.c_str());
   close(fd);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  if (truncated)
+    printf("Core limit file reached. GPU core dump created: %s\n", path.c_str());
+  else
+    printf("GPU core dump created: %s\n", path.c_str());
   return HSA_STATUS_SUCCESS;
 }
 }   //  namespace impl
 
-hsa_status_t dump_gpu_core() {
+hsa_status_t dump_gpu_core(const DumpOptions& options) {
   impl::NoteSegmentBuilder nbuilder;
   impl::LoadSegmentBuilder lbuilder;
   impl::SegmentsInfo segments;
@@ -440,9 +716,19 @@ hsa_status_t dump_gpu_core() {
   status = lbuilder.Collect(segments);
   if (status != HSA_STATUS_SUCCESS) return status;
 
+  /* Code object mappings are read-only and can be recovered from the
+     application binary.  */
+  if (options.skip_readonly) {
+    segments.erase(std::remove_if(segments.begin(), segments.end(),
+                                  [](const impl::SegmentInfo& s) {
+                                    return s.stype == impl::LOAD && !(s.flags & SHF_WRITE);
+                                  }),
+                   segments.end());
+  }
+
   std::stringstream st;
   st << PREFIX_FILE_NAME << "." << getpid();
-  return build_core_dump(st.str(), segments);
+  return build_core_dump(st.str(), segments, options);
 }
 }   //  namespace coredump
 }   //  namespace amd
@@ -702,6 +702,316 @@ namespace code {
       return MI.Name;
     }
 
+    bool GetCodeObjectTarget(const void* image, size_t size, CodeObjectTarget* target)
+    {
+      if (size < sizeof(Elf64_Ehdr)) return false;
+      Elf64_Ehdr ehdr;
+      memcpy(&ehdr, image, sizeof(ehdr));
+
+      if (memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 || ehdr.e_ident[EI_CLASS] != ELFCLASS64 ||
+          ehdr.e_machine != ELF::EM_AMDGPU || ehdr.e_ident[EI_OSABI] != ELF::ELFOSABI_AMDGPU_HSA)
+        return false;
+
+      MachInfo MI;
+      target->mach = ehdr.e_flags & ELF::EF_AMDGPU_MACH;
+      if (!GetMachInfo(target->mach, MI)) return false;
+      target->genericVersion = 0;
+
+      switch (ehdr.e_ident[EI_ABIVERSION]) {
+      case ELF::ELFABIVERSION_AMDGPU_HSA_V3:
+        // V3 has no "any" setting, a clear bit means off where the feature exists.
+        target->xnack = (ehdr.e_flags & ELF::EF_AMDGPU_FEATURE_XNACK_V3) ? 1
+                        : MI.XnackSupported ? 0 : -1;
+        target->sramecc = (ehdr.e_flags & ELF::EF_AMDGPU_FEATURE_SRAMECC_V3) ? 1
+                          : MI.SrameccSupported ? 0 : -1;
+        return true;
+      case ELF::ELFABIVERSION_AMDGPU_HSA_V4:
+      case ELF::ELFABIVERSION_AMDGPU_HSA_V5:
+      case ELF::ELFABIVERSION_AMDGPU_HSA_V6:
+        switch (ehdr.e_flags & ELF::EF_AMDGPU_FEATURE_XNACK_V4) {
+        case ELF::EF_AMDGPU_FEATURE_XNACK_OFF_V4: target->xnack = 0; break;
+        case ELF::EF_AMDGPU_FEATURE_XNACK_ON_V4: target->xnack = 1; break;
+        default: target->xnack = -1; break;
+        }
+        switch (ehdr.e_flags & ELF::EF_AMDGPU_FEATURE_SRAMECC_V4) {
+        case ELF::EF_AMDGPU_FEATURE_SRAMECC_OFF_V4: target->sramecc = 0; break;
+        case ELF::EF_AMDGPU_FEATURE_SRAMECC_ON_V4: target->sramecc = 1; break;
+        default: target->sramecc = -1; break;
+        }
+        if (ehdr.e_ident[EI_ABIVERSION] == ELF::ELFABIVERSION_AMDGPU_HSA_V6)
+          target->genericVersion = (ehdr.e_flags & ELF::EF_AMDGPU_GENERIC_VERSION) >>
+                                   ELF::EF_AMDGPU_GENERIC_VERSION_OFFSET;
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    bool IndexOffloadBundle(const void* bundle, size_t size,
+                            std::vector<BundledCodeObject>& code_objects)
+    {
+      static const char magic[] = "__CLANG_OFFLOAD_BUNDLE__";
+      const size_t magic_size = sizeof(magic) - 1;
+      const uint8_t* base = static_cast<const uint8_t*>(bundle);
+
+      // Layout: magic, entry count, then per entry offset, size, triple size and triple.
+      if (size < magic_size + sizeof(uint64_t) || memcmp(base, magic, magic_size) != 0)
+        return false;
+      size_t pos = magic_size;
+      auto read = [&](uint64_t& value) {
+        if (size - pos < sizeof(value)) return false;
+        memcpy(&value, base + pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+      };
+
+      uint64_t count;
+      read(count);
+      code_objects.clear();
+      for (uint64_t i = 0; i < count; i++) {
+        uint64_t offset, entry_size, triple_size;
+        if (!read(offset) || !read(entry_size) || !read(triple_size)) return false;
+        if (size - pos < triple_size) return false;
+        pos += triple_size;
+        if (offset > size || entry_size > size - offset) return false;
+
+        BundledCodeObject code_object;
+        if (!GetCodeObjectTarget(base + offset, entry_size, &code_object.target)) continue;
+        code_object.offset = offset;
+        code_object.size = entry_size;
+        code_objects.push_back(code_object);
+      }
+      return true;
+    }
+
+    unsigned GetMachForProcessor(const std::string& processor)
+    {
+      MachInfo MI;
+      for (unsigned mach = ELF::EF_AMDGPU_MACH_AMDGCN_FIRST; mach <= ELF::EF_AMDGPU_MACH; mach++) {
+        if (GetMachInfo(mach, MI) && MI.Name == processor) return mach;
+      }
+      return 0;
+    }
+
+    namespace {
+    // Minimal msgpack reader.  Reads fail on truncated or unexpected input and
+    // leave the position undefined.
+    class MsgPackReader {
+    public:
+      MsgPackReader(const uint8_t* data, size_t size, size_t pos = 0)
+        : data_(data), size_(size), pos_(pos) {}
+
+      size_t Pos() const { return pos_; }
+
+      bool ReadMap(uint64_t* count) { return ReadContainer(0x80, 0xde, count); }
+      bool ReadArray(uint64_t* count) { return ReadContainer(0x90, 0xdc, count); }
+
+      bool ReadString(std::string_view* str)
+      {
+        uint8_t b;
+        uint64_t len;
+        if (!Byte(&b)) return false;
+        if ((b & 0xe0) == 0xa0) {
+          len = b & 0x1f;
+        } else if (b < 0xd9 || b > 0xdb || !BigEndian(1u << (b - 0xd9), &len)) {
+          return false;
+        }
+        if (size_ - pos_ < len) return false;
+        *str = std::string_view(reinterpret_cast<const char*>(data_ + pos_), len);
+        pos_ += len;
+        return true;
+      }
+
+      bool ReadUInt(uint64_t* value)
+      {
+        uint8_t b;
+        if (!Byte(&b)) return false;
+        if (b < 0x80) {
+          *value = b;
+          return true;
+        }
+        return b >= 0xcc && b <= 0xcf && BigEndian(1u << (b - 0xcc), value);
+      }
+
+      // Skips one object, including everything nested in it.
+      bool Skip()
+      {
+        for (uint64_t pending = 1; pending > 0; pending--) {
+          uint8_t b;
+          uint64_t n;
+          if (!Byte(&b)) return false;
+          if (b < 0x80 || b >= 0xe0 || b == 0xc0 || b == 0xc2 || b == 0xc3) continue;
+          if ((b & 0xf0) == 0x80) {
+            pending += 2 * (b & 0x0f);
+            continue;
+          }
+          if ((b & 0xf0) == 0x90) {
+            pending += b & 0x0f;
+            continue;
+          }
+          if ((b & 0xe0) == 0xa0) {
+            n = b & 0x1f;
+          } else {
+            switch (b) {
+            case 0xc4: case 0xc5: case 0xc6:  // bin 8/16/32
+              if (!BigEndian(1u << (b - 0xc4), &n)) return false;
+              break;
+            case 0xc7: case 0xc8: case 0xc9:  // ext 8/16/32, plus the type byte
+              if (!BigEndian(1u << (b - 0xc7), &n)) return false;
+              n += 1;
+              break;
+            case 0xca: n = 4; break;
+            case 0xcb: n = 8; break;
+            case 0xcc: case 0xcd: case 0xce: case 0xcf:
+              n = 1u << (b - 0xcc);
+              break;
+            case 0xd0: case 0xd1: case 0xd2: case 0xd3:
+              n = 1u << (b - 0xd0);
+              break;
+            case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:  // fixext
+              n = (1u << (b - 0xd4)) + 1;
+              break;
+            case 0xd9: case 0xda: case 0xdb:
+              if (!BigEndian(1u << (b - 0xd9), &n)) return false;
+              break;
+            case 0xdc: case 0xdd:
+              if (!BigEndian(2u << (b - 0xdc), &n)) return false;
+              pending += n;
+              continue;
+            case 0xde: case 0xdf:
+              if (!BigEndian(2u << (b - 0xde), &n)) return false;
+              pending += 2 * n;
+              continue;
+            default:
+              return false;
+            }
+          }
+          if (size_ - pos_ < n) return false;
+          pos_ += n;
+        }
+        return true;
+      }
+
+    private:
+      bool Byte(uint8_t* b)
+      {
+        if (pos_ >= size_) return false;
+        *b = data_[pos_++];
+        return true;
+      }
+
+      bool BigEndian(unsigned bytes, uint64_t* value)
+      {
+        if (size_ - pos_ < bytes) return false;
+        *value = 0;
+        for (unsigned i = 0; i < bytes; i++) *value = (*value << 8) | data_[pos_++];
+        return true;
+      }
+
+      bool ReadContainer(uint8_t fix, uint8_t first, uint64_t* count)
+      {
+        uint8_t b;
+        if (!Byte(&b)) return false;
+        if ((b & 0xf0) == fix) {
+          *count = b & 0x0f;
+          return true;
+        }
+        return (b == first || b == first + 1) && BigEndian(2u << (b - first), count);
+      }
+
+      const uint8_t* data_;
+      size_t size_;
+      size_t pos_;
+    };
+    }   // namespace
+
+    void KernelMetadata::BuildIndex()
+    {
+      indexed_ = true;
+      MsgPackReader r(data_, size_);
+      uint64_t entries;
+      if (!r.ReadMap(&entries)) return;
+      for (uint64_t i = 0; i < entries; i++) {
+        std::string_view key;
+        if (!r.ReadString(&key)) return;
+        if (key != "amdhsa.kernels") {
+          if (!r.Skip()) return;
+          continue;
+        }
+        // Only the .symbol of each kernel is read, the other fields are skipped undecoded.
+        uint64_t kernels;
+        if (!r.ReadArray(&kernels)) return;
+        for (uint64_t k = 0; k < kernels; k++) {
+          size_t start = r.Pos();
+          uint64_t fields;
+          if (!r.ReadMap(&fields)) return;
+          for (uint64_t f = 0; f < fields; f++) {
+            std::string_view name, symbol;
+            if (!r.ReadString(&name)) return;
+            if (name == ".symbol") {
+              if (!r.ReadString(&symbol)) return;
+              kernels_.emplace(symbol, start);
+            } else if (!r.Skip()) {
+              return;
+            }
+          }
+        }
+        return;
+      }
+    }
+
+    bool KernelMetadata::FindField(std::string_view kernel, std::string_view field, size_t* pos)
+    {
+      if (!indexed_) BuildIndex();
+      auto it = kernels_.find(kernel);
+      if (it == kernels_.end()) return false;
+
+      MsgPackReader r(data_, size_, it->second);
+      uint64_t fields;
+      if (!r.ReadMap(&fields)) return false;
+      for (uint64_t f = 0; f < fields; f++) {
+        std::string_view name;
+        if (!r.ReadString(&name)) return false;
+        if (name == field) {
+          *pos = r.Pos();
+          return true;
+        }
+        if (!r.Skip()) return false;
+      }
+      return false;
+    }
+
+    bool KernelMetadata::GetUInt(std::string_view kernel, std::string_view field, uint64_t* value)
+    {
+      size_t pos;
+      if (!FindField(kernel, field, &pos)) return false;
+      MsgPackReader r(data_, size_, pos);
+      return r.ReadUInt(value);
+    }
+
+    bool KernelMetadata::GetString(std::string_view kernel, std::string_view field,
+                                   std::string_view* value)
+    {
+      size_t pos;
+      if (!FindField(kernel, field, &pos)) return false;
+      MsgPackReader r(data_, size_, pos);
+      return r.ReadString(value);
+    }
+
+    KernelMetadata& AmdHsaCode::GetKernelMetadata()
+    {
+      if (!kernelMetadata) {
+        void* desc = nullptr;
+        uint32_t desc_size = 0;
+        if (!img->note()->getNote("AMDGPU", NT_AMDGPU_METADATA, &desc, &desc_size)) {
+          desc = nullptr;
+          desc_size = 0;
+        }
+        kernelMetadata.reset(new KernelMetadata(desc, desc_size));
+      }
+      return *kernelMetadata;
+    }
+
     bool AmdHsaCode::GetIsa(std::string& isa_name, unsigned *genericVersion)
     {
       isa_name.clear();
@@ -0,0 +1,398 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+//
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+//
+// Developed by:
+//
+//                 AMD Research and AMD HSA Software Development
+//
+//                 Advanced Micro Devices, Inc.
+//
+//                 www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "code_object_cache.hpp"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace rocr {
+namespace amd {
+namespace hsa {
+namespace loader {
+
+namespace {
+
+const uint32_t kRecordMagic = 0x434f4352;  // 'RCOC'
+// Bump when CodeObjectRecord or its file layout changes.
+const uint32_t kRecordVersion = 3;
+
+const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t Read64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t Read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t Round(uint64_t acc, uint64_t input) {
+  acc += input * kPrime2;
+  acc = Rotl(acc, 31);
+  return acc * kPrime1;
+}
+
+inline uint64_t Merge(uint64_t acc, uint64_t val) {
+  acc ^= Round(0, val);
+  return acc * kPrime1 + kPrime4;
+}
+
+// Serializes a record into a flat little endian byte string.
+class RecordWriter {
+public:
+  void U32(uint32_t v) { out_.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+  void U64(uint64_t v) { out_.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+  void Str(const std::string &s) {
+    U32(uint32_t(s.size()));
+    out_.append(s);
+  }
+  const std::string& data() const { return out_; }
+
+private:
+  std::string out_;
+};
+
+// Reads back a RecordWriter byte string, failing on truncated input.
+class RecordReader {
+public:
+  explicit RecordReader(const std::string &in) : in_(in), pos_(0), ok_(true) {}
+
+  uint32_t U32() {
+    uint32_t v = 0;
+    Get(&v, sizeof(v));
+    return v;
+  }
+  uint64_t U64() {
+    uint64_t v = 0;
+    Get(&v, sizeof(v));
+    return v;
+  }
+  std::string Str() {
+    uint32_t len = U32();
+    if (!ok_ || len > in_.size() - pos_) {
+      ok_ = false;
+      return std::string();
+    }
+    std::string s = in_.substr(pos_, len);
+    pos_ += len;
+    return s;
+  }
+  // Element count that can't exceed the remaining input.
+  uint32_t Count(size_t min_element_size) {
+    uint32_t n = U32();
+    if (ok_ && uint64_t(n) * min_element_size > in_.size() - pos_) ok_ = false;
+    return ok_ ? n : 0;
+  }
+  bool ok() const { return ok_; }
+  bool done() const { return ok_ && pos_ == in_.size(); }
+
+private:
+  void Get(void *v, size_t size) {
+    if (!ok_ || size > in_.size() - pos_) {
+      ok_ = false;
+      return;
+    }
+    memcpy(v, in_.data() + pos_, size);
+    pos_ += size;
+  }
+
+  const std::string &in_;
+  size_t pos_;
+  bool ok_;
+};
+
+} // namespace
+
+CodeObjectCache& CodeObjectCache::Instance() {
+  static CodeObjectCache *cache = new CodeObjectCache();
+  return *cache;
+}
+
+CodeObjectCache::CodeObjectCache() {
+  const char *dir = getenv("HSA_CODE_OBJECT_CACHE_DIR");
+  if (!dir || !*dir) return;
+
+  if (mkdir(dir, 0755) != 0 && errno != EEXIST) return;
+  dir_ = dir;
+}
+
+uint64_t CodeObjectCache::Hash(const void *data, uint64_t size) {
+  const uint8_t *p = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t *end = p + size;
+  uint64_t h;
+
+  if (size >= 32) {
+    uint64_t v1 = kPrime1 + kPrime2;
+    uint64_t v2 = kPrime2;
+    uint64_t v3 = 0;
+    uint64_t v4 = 0 - kPrime1;
+    const uint8_t *limit = end - 32;
+    do {
+      v1 = Round(v1, Read64(p));
+      v2 = Round(v2, Read64(p + 8));
+      v3 = Round(v3, Read64(p + 16));
+      v4 = Round(v4, Read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+    h = Merge(h, v1);
+    h = Merge(h, v2);
+    h = Merge(h, v3);
+    h = Merge(h, v4);
+  } else {
+    h = kPrime5;
+  }
+
+  h += size;
+  for (; p + 8 <= end; p += 8) {
+    h ^= Round(0, Read64(p));
+    h = Rotl(h, 27) * kPrime1 + kPrime4;
+  }
+  if (p + 4 <= end) {
+    h ^= uint64_t(Read32(p)) * kPrime1;
+    h = Rotl(h, 23) * kPrime2 + kPrime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h ^= (*p) * kPrime5;
+    h = Rotl(h, 11) * kPrime1;
+  }
+
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+std::shared_ptr<const CodeObjectRecord> CodeObjectCache::Find(uint64_t hash, uint64_t size) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = records_.find(std::make_pair(hash, size));
+  if (it != records_.end()) return it->second;
+
+  std::shared_ptr<CodeObjectRecord> record(new CodeObjectRecord());
+  if (!Read(Path(hash, size), hash, size, record.get())) return nullptr;
+
+  records_[std::make_pair(hash, size)] = record;
+  return record;
+}
+
+void CodeObjectCache::Insert(uint64_t hash, uint64_t size,
+                             std::shared_ptr<const CodeObjectRecord> record) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (!records_.insert(std::make_pair(std::make_pair(hash, size), record)).second) return;
+
+  // Failing to persist only costs other processes the parse.
+  Write(Path(hash, size), hash, size, *record);
+}
+
+std::string CodeObjectCache::Path(uint64_t hash, uint64_t size) const {
+  char name[64];
+  snprintf(name, sizeof(name), "/%016llx-%llx.co", (unsigned long long)hash,
+           (unsigned long long)size);
+  return dir_ + name;
+}
+
+bool CodeObjectCache::Read(const std::string &path, uint64_t hash, uint64_t size,
+                           CodeObjectRecord *record) const {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  RecordReader r(data);
+  if (r.U32() != kRecordMagic || r.U32() != kRecordVersion) return false;
+  if (r.U64() != hash || r.U64() != size) return false;
+
+  record->isa = r.Str();
+  record->generic_version = r.U32();
+  record->major_version = r.U32();
+  record->minor_version = r.U32();
+
+  record->segments.resize(r.Count(4 * sizeof(uint64_t)));
+  for (auto &seg : record->segments) {
+    seg.vaddr = r.U64();
+    seg.offset = r.U64();
+    seg.file_size = r.U64();
+    seg.mem_size = r.U64();
+  }
+
+  record->symbols.resize(r.Count(18 * sizeof(uint32_t)));
+  for (auto &sym : record->symbols) {
+    sym.kind = r.U32();
+    sym.name = r.Str();
+    sym.module_name = r.Str();
+    sym.symbol_name = r.Str();
+    sym.linkage = r.U32();
+    sym.section_addr = r.U64();
+    sym.vaddr = r.U64();
+    sym.size = r.U64();
+    sym.kernarg_segment_size = r.U32();
+    sym.kernarg_segment_alignment = r.U32();
+    sym.group_segment_size = r.U32();
+    sym.private_segment_size = r.U32();
+    sym.is_dynamic_callstack = r.U32();
+    sym.uses_wave32 = r.U32();
+    sym.allocation = r.U32();
+    sym.segment = r.U32();
+    sym.alignment = r.U32();
+    sym.is_const = r.U32();
+    sym.code_vaddr = r.U64();
+    sym.code_size = r.U64();
+    if (sym.kind > CodeObjectRecord::kDeclaration) return false;
+  }
+
+  record->relocations.resize(r.Count(8 * sizeof(uint32_t)));
+  for (auto &rel : record->relocations) {
+    rel.offset = r.U64();
+    rel.type = r.U32();
+    rel.symbol_type = r.U32();
+    rel.symbol_value = r.U64();
+    rel.addend = int64_t(r.U64());
+    rel.symbol_name = r.Str();
+  }
+
+  return r.done() && !record->segments.empty();
+}
+
+bool CodeObjectCache::Write(const std::string &path, uint64_t hash, uint64_t size,
+                            const CodeObjectRecord &record) const {
+  if (!enabled()) return false;
+
+  RecordWriter w;
+  w.U32(kRecordMagic);
+  w.U32(kRecordVersion);
+  w.U64(hash);
+  w.U64(size);
+
+  w.Str(record.isa);
+  w.U32(record.generic_version);
+  w.U32(record.major_version);
+  w.U32(record.minor_version);
+
+  w.U32(uint32_t(record.segments.size()));
+  for (const auto &seg : record.segments) {
+    w.U64(seg.vaddr);
+    w.U64(seg.offset);
+    w.U64(seg.file_size);
+    w.U64(seg.mem_size);
+  }
+
+  w.U32(uint32_t(record.symbols.size()));
+  for (const auto &sym : record.symbols) {
+    w.U32(sym.kind);
+    w.Str(sym.name);
+    w.Str(sym.module_name);
+    w.Str(sym.symbol_name);
+    w.U32(sym.linkage);
+    w.U64(sym.section_addr);
+    w.U64(sym.vaddr);
+    w.U64(sym.size);
+    w.U32(sym.kernarg_segment_size);
+    w.U32(sym.kernarg_segment_alignment);
+    w.U32(sym.group_segment_size);
+    w.U32(sym.private_segment_size);
+    w.U32(sym.is_dynamic_callstack);
+    w.U32(sym.uses_wave32);
+    w.U32(sym.allocation);
+    w.U32(sym.segment);
+    w.U32(sym.alignment);
+    w.U32(sym.is_const);
+    w.U64(sym.code_vaddr);
+    w.U64(sym.code_size);
+  }
+
+  w.U32(uint32_t(record.relocations.size()));
+  for (const auto &rel : record.relocations) {
+    w.U64(rel.offset);
+    w.U32(rel.type);
+    w.U32(rel.symbol_type);
+    w.U64(rel.symbol_value);
+    w.U64(uint64_t(rel.addend));
+    w.Str(rel.symbol_name);
+  }
+
+  // Publish atomically, concurrent processes may be writing the same record.
+  std::ostringstream tmp;
+  tmp << path << ".tmp." << getpid();
+  {
+    std::ofstream out(tmp.str(), std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(w.data().data(), w.data().size());
+    if (!out) {
+      out.close();
+      unlink(tmp.str().c_str());
+      return false;
+    }
+  }
+  if (rename(tmp.str().c_str(), path.c_str()) != 0) {
+    unlink(tmp.str().c_str());
+    return false;
+  }
+  return true;
+}
+
+} // namespace loader
+} // namespace hsa
+} // namespace amd
+} // namespace rocr
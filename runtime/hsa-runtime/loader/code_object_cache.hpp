@@ -0,0 +1,176 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// The University of Illinois/NCSA
+// Open Source License (NCSA)
+//
+// Copyright (c) 2026, Advanced Micro Devices, Inc. All rights reserved.
+//
+// Developed by:
+//
+//                 AMD Research and AMD HSA Software Development
+//
+//                 Advanced Micro Devices, Inc.
+//
+//                 www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal with the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+//  - Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimers.
+//  - Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimers in
+//    the documentation and/or other materials provided with the distribution.
+//  - Neither the names of Advanced Micro Devices, Inc,
+//    nor the names of its contributors may be used to endorse or promote
+//    products derived from this Software without specific prior written
+//    permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS WITH THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HSA_RUNTIME_CORE_LOADER_CODE_OBJECT_CACHE_HPP_
+#define HSA_RUNTIME_CORE_LOADER_CODE_OBJECT_CACHE_HPP_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rocr {
+namespace amd {
+namespace hsa {
+namespace loader {
+
+//===----------------------------------------------------------------------===//
+// CodeObjectRecord.                                                          //
+//===----------------------------------------------------------------------===//
+
+/// @brief Everything ExecutableImpl::LoadCodeObject derives from the ELF of a
+/// code object v3 or later, independent of where it is loaded.  Loading from a
+/// record copies segments straight out of the ELF image and skips parsing it.
+struct CodeObjectRecord {
+  /// @brief PT_LOAD segment, relative to the start of the ELF image.
+  struct Segment {
+    uint64_t vaddr;
+    uint64_t offset;
+    uint64_t file_size;
+    uint64_t mem_size;
+  };
+
+  enum SymbolKind : uint32_t {
+    kKernel = 0,
+    kVariable = 1,
+    kDeclaration = 2
+  };
+
+  struct Symbol {
+    uint32_t kind;
+    std::string name;
+    std::string module_name;
+    std::string symbol_name;
+    uint32_t linkage;
+    uint64_t section_addr;
+    uint64_t vaddr;
+    uint64_t size;
+    // Kernels, from the kernel descriptor.
+    uint32_t kernarg_segment_size;
+    uint32_t kernarg_segment_alignment;  // From the metadata note.
+    uint32_t group_segment_size;
+    uint32_t private_segment_size;
+    uint32_t is_dynamic_callstack;
+    uint32_t uses_wave32;
+    // Kernels, the function holding the kernel body if known, else zero.
+    uint64_t code_vaddr;
+    uint64_t code_size;
+    // Variables.
+    uint32_t allocation;
+    uint32_t segment;
+    uint32_t alignment;
+    uint32_t is_const;
+  };
+
+  /// @brief Dynamic relocation with its symbol resolved to plain values.
+  struct Relocation {
+    uint64_t offset;
+    uint32_t type;
+    uint32_t symbol_type;
+    uint64_t symbol_value;
+    int64_t addend;
+    std::string symbol_name;
+  };
+
+  std::string isa;
+  uint32_t generic_version;
+  uint32_t major_version;
+  uint32_t minor_version;
+  std::vector<Segment> segments;
+  std::vector<Symbol> symbols;
+  std::vector<Relocation> relocations;
+};
+
+//===----------------------------------------------------------------------===//
+// CodeObjectCache.                                                           //
+//===----------------------------------------------------------------------===//
+
+/// @brief Process wide cache of CodeObjectRecords keyed by a hash of the code
+/// object contents.  Records are kept in memory and, if
+/// HSA_CODE_OBJECT_CACHE_DIR names a directory, persisted there so other
+/// processes loading the same code object can skip parsing it.
+class CodeObjectCache final {
+public:
+  static CodeObjectCache& Instance();
+
+  bool enabled() const { return !dir_.empty(); }
+
+  /// @brief 64-bit content hash (XXH64) of @p size bytes at @p data.
+  static uint64_t Hash(const void *data, uint64_t size);
+
+  /// @brief Returns the record of the code object with content hash @p hash
+  /// and ELF size @p size, or null if it is not cached.
+  std::shared_ptr<const CodeObjectRecord> Find(uint64_t hash, uint64_t size);
+
+  /// @brief Caches @p record for the code object with content hash @p hash
+  /// and ELF size @p size.
+  void Insert(uint64_t hash, uint64_t size, std::shared_ptr<const CodeObjectRecord> record);
+
+  /// @brief Hold the cache lock across fork so a child inherits consistent
+  /// records and can keep using them.
+  void LockForFork() { lock_.lock(); }
+  void UnlockAfterFork() { lock_.unlock(); }
+
+private:
+  CodeObjectCache();
+  CodeObjectCache(const CodeObjectCache &c);
+  CodeObjectCache& operator=(const CodeObjectCache &c);
+
+  std::string Path(uint64_t hash, uint64_t size) const;
+  bool Read(const std::string &path, uint64_t hash, uint64_t size, CodeObjectRecord *record) const;
+  bool Write(const std::string &path, uint64_t hash, uint64_t size,
+             const CodeObjectRecord &record) const;
+
+  std::string dir_;
+  std::mutex lock_;
+  std::map<std::pair<uint64_t, uint64_t>, std::shared_ptr<const CodeObjectRecord>> records_;
+};
+
+} // namespace loader
+} // namespace hsa
+} // namespace amd
+} // namespace rocr
+
+#endif // HSA_RUNTIME_CORE_LOADER_CODE_OBJECT_CACHE_HPP_
@@ -54,6 +54,7 @@
 #include <iostream>
 #include <atomic>
 #include <fstream>
+#include <unordered_set>
 #include "inc/amd_hsa_elf.h"
 #include "inc/amd_hsa_kernel_code.h"
 #include "core/inc/amd_hsa_code.hpp"
@@ -185,7 +186,11 @@ Executable* AmdHsaCodeLoader::CreateExecutable(
 {
   WriterLockGuard<ReaderWriterLock> writer_lock(rw_lock_);
 
-  executables.push_back(new ExecutableImpl(profile, context, executables.size(), default_float_rounding_mode));
+  ExecutableImpl *executable =
+      new ExecutableImpl(profile, context, executables.size(), default_float_rounding_mode);
+  // Executables with an isolated context do not share its segments.
+  executable->shared_segments_ = &shared_segments_;
+  executables.push_back(executable);
   return executables.back();
 }
 
@@ -201,6 +206,66 @@ Executable* AmdHsaCodeLoader::CreateExecutable(
   return executables.back();
 }
 
+// Whether the ELF image has allocated writable data besides the dynamic
+// section, in which case each load needs its own copy of the segment.
+static bool HasWritableData(const char *elf, uint64_t elf_size) {
+  const Elf64_Ehdr *ehdr = reinterpret_cast<const Elf64_Ehdr*>(elf);
+  if (elf_size < sizeof(Elf64_Ehdr) || ehdr->e_shentsize != sizeof(Elf64_Shdr) ||
+      ehdr->e_shoff > elf_size ||
+      uint64_t(ehdr->e_shnum) * sizeof(Elf64_Shdr) > elf_size - ehdr->e_shoff) {
+    return true;
+  }
+  const Elf64_Shdr *shdr = reinterpret_cast<const Elf64_Shdr*>(elf + ehdr->e_shoff);
+  for (uint16_t i = 0; i < ehdr->e_shnum; ++i) {
+    if ((shdr[i].sh_flags & (SHF_ALLOC | SHF_WRITE)) == (SHF_ALLOC | SHF_WRITE) &&
+        shdr[i].sh_type != SHT_DYNAMIC && shdr[i].sh_size != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Kernel descriptors do not record the kernarg alignment, so it comes from the
+// metadata note, raised to the minimum HSA requires.
+static uint32_t KernargSegmentAlignment(code::AmdHsaCode *c, const std::string &kd_name) {
+  uint64_t align = 0;
+  c->GetKernelMetadata().GetUInt(kd_name, ".kernarg_segment_align", &align);
+  return uint32_t(std::min<uint64_t>(std::max<uint64_t>(align, 16), UINT32_MAX));
+}
+
+// Bodies of the kernels of a code object keyed by kernel descriptor name.
+typedef std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> KernelBodyMap;
+
+static KernelBodyMap KernelBodies(code::AmdHsaCode *c) {
+  KernelBodyMap bodies;
+  elf::SymbolTable *symtab = c->Symtab();
+  for (size_t i = 0; i < symtab->symbolCount(); ++i) {
+    elf::Symbol *sym = symtab->symbol(i);
+    if (sym->type() != STT_FUNC || sym->size() == 0) continue;
+    bodies.emplace(sym->name() + ".kd", std::make_pair(sym->value(), sym->size()));
+  }
+  return bodies;
+}
+
+// Kernels named one per line in HSA_LOADER_LAZY_HOT_KERNELS are loaded at
+// freeze, with the rest of the code object, instead of on first use.
+static bool IsHotKernel(const std::string &name) {
+  static const std::unordered_set<std::string> *hot_kernels = [] {
+    std::unordered_set<std::string> *kernels = new std::unordered_set<std::string>();
+    const char *path = getenv("HSA_LOADER_LAZY_HOT_KERNELS");
+    if (path) {
+      std::ifstream manifest(path);
+      std::string line;
+      while (std::getline(manifest, line)) {
+        size_t end = line.find_last_not_of(" \t\r");
+        if (end != std::string::npos) kernels->insert(line.substr(0, end + 1));
+      }
+    }
+    return kernels;
+  }();
+  return hot_kernels->count(name) != 0;
+}
+
 static void AddCodeObjectInfoIntoDebugMap(link_map* map) {
   if (r_debug_tail()) {
       r_debug_tail()->l_next = map;
@@ -234,7 +299,28 @@ static void RemoveCodeObjectInfoFromDebugMap(link_map* map) {
 }
 
 hsa_status_t AmdHsaCodeLoader::FreezeExecutable(Executable *executable, const char *options) {
-  hsa_status_t  status = executable->Freeze(options);
+  hsa_status_t status = FreezeExecutableStart(executable, options);
+  if (status != HSA_STATUS_SUCCESS) {
+    return status;
+  }
+  return FreezeExecutableFinish(executable);
+}
+
+hsa_status_t AmdHsaCodeLoader::FreezeExecutableStart(Executable *executable,
+                                                     const char *options) {
+  hsa_status_t status = executable->FreezeStart(options);
+  if (status != HSA_STATUS_SUCCESS) {
+    return status;
+  }
+
+  WriterLockGuard<ReaderWriterLock> writer_lock(rw_lock_);
+  segment_index_.Insert(reinterpret_cast<ExecutableImpl*>(executable));
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t AmdHsaCodeLoader::FreezeExecutableFinish(Executable *executable) {
+  // The debugger is told about the code objects once their code is in place.
+  hsa_status_t status = executable->FreezeFinish();
   if (status != HSA_STATUS_SUCCESS) {
     return status;
   }
@@ -255,20 +341,29 @@ hsa_status_t AmdHsaCodeLoader::FreezeExecutable(Executable *executable, const ch
 }
 
 void AmdHsaCodeLoader::DestroyExecutable(Executable *executable) {
+  DestroyExecutables(&executable, 1);
+}
+
+void AmdHsaCodeLoader::DestroyExecutables(Executable *const *executables_, size_t count) {
   // Assuming runtime atomic implements C++ std::memory_order
   WriterLockGuard<ReaderWriterLock> writer_lock(rw_lock_);
   atomic::Store(&_amdgpu_r_debug.r_state, r_debug::RT_DELETE, std::memory_order_relaxed);
   atomic::Fence(std::memory_order_acq_rel);
   _loader_debug_state();
   atomic::Fence(std::memory_order_acq_rel);
-  for (auto &lco : reinterpret_cast<ExecutableImpl*>(executable)->loaded_code_objects) {
-    RemoveCodeObjectInfoFromDebugMap(&(lco->r_debug_info));
+  for (size_t i = 0; i < count; ++i) {
+    for (auto &lco : reinterpret_cast<ExecutableImpl*>(executables_[i])->loaded_code_objects) {
+      RemoveCodeObjectInfoFromDebugMap(&(lco->r_debug_info));
+    }
   }
   atomic::Store(&_amdgpu_r_debug.r_state, r_debug::RT_CONSISTENT, std::memory_order_release);
   _loader_debug_state();
 
-  executables[((ExecutableImpl*)executable)->id()] = nullptr;
-  delete executable;
+  for (size_t i = 0; i < count; ++i) {
+    segment_index_.Erase(reinterpret_cast<ExecutableImpl*>(executables_[i]));
+    executables[((ExecutableImpl*)executables_[i])->id()] = nullptr;
+    delete executables_[i];
+  }
 }
 
 hsa_status_t AmdHsaCodeLoader::IterateExecutables(
@@ -343,8 +438,14 @@ uint64_t AmdHsaCodeLoader::FindHostAddress(uint64_t device_address)
     return 0;
   }
 
+  Segment *seg = segment_index_.Find(device_address);
+  if (seg) {
+    return seg->Owner()->FindHostAddress(seg, device_address);
+  }
+
+  // Executables which are not frozen yet are not indexed.
   for (auto &exec : executables) {
-    if (exec != nullptr) {
+    if (exec != nullptr && ((ExecutableImpl*)exec)->state() != HSA_EXECUTABLE_STATE_FROZEN) {
       uint64_t host_address = exec->FindHostAddress(device_address);
       if (host_address != 0) {
         return host_address;
@@ -551,6 +652,13 @@ bool KernelSymbol::GetInfo(hsa_symbol_info32_t symbol_info, void *value) {
       *((uint32_t*)value) = alignment;
       break;
     }
+    case HSA_EXECUTABLE_SYMBOL_INFO_KERNEL_OBJECT: {
+      // Kernel objects are queried before any dispatch of the kernel.
+      if (!MakeCodeResident()) {
+        return false;
+      }
+      return SymbolImpl::GetInfo(symbol_info, value);
+    }
     default: {
       return SymbolImpl::GetInfo(symbol_info, value);
     }
@@ -559,6 +667,16 @@ bool KernelSymbol::GetInfo(hsa_symbol_info32_t symbol_info, void *value) {
   return true;
 }
 
+bool KernelSymbol::MakeCodeResident() {
+  if (!code_resident.load(std::memory_order_acquire)) {
+    if (!code_segment->MakeResident(code_vaddr, code_size)) {
+      return false;
+    }
+    code_resident.store(true, std::memory_order_release);
+  }
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 // VariableSymbol.                                                            //
 //===----------------------------------------------------------------------===//
@@ -706,6 +824,35 @@ bool Segment::Freeze()
   return !frozen ? (frozen = owner->context()->SegmentFreeze(segment, agent, ptr, size)) : true;
 }
 
+bool Segment::Upload()
+{
+  return frozen || owner->context()->SegmentUpload(segment, agent, ptr, size);
+}
+
+bool Segment::FreezeStart()
+{
+  if (frozen || freezing) { return true; }
+  return freezing = owner->context()->SegmentFreezeStart(segment, agent, ptr, size);
+}
+
+bool Segment::FreezeFinish()
+{
+  if (!freezing) { return frozen; }
+  freezing = false;
+  return frozen = owner->context()->SegmentFreezeFinish(segment, agent, ptr, size);
+}
+
+bool Segment::Defer(uint64_t addr, size_t size)
+{
+  assert(!frozen && IsAddressInSegment(addr) && size <= vaddr + this->size - addr);
+  return owner->context()->SegmentDefer(segment, agent, ptr, Offset(addr), size);
+}
+
+bool Segment::MakeResident(uint64_t addr, size_t size)
+{
+  return owner->context()->SegmentMakeResident(segment, agent, ptr, Offset(addr), size);
+}
+
 bool Segment::IsAddressInSegment(uint64_t addr)
 {
   return vaddr <= addr && addr < vaddr + size;
@@ -733,6 +880,7 @@ void Segment::Print(std::ostream& out)
 
 void Segment::Destroy()
 {
+  if (shared && !owner->shared_segments()->Release(ptr)) { return; }
   owner->context()->SegmentFree(segment, agent, ptr, size);
 }
 
@@ -873,12 +1021,152 @@ Symbol* ExecutableImpl::GetSymbol(
   return this->GetSymbolInternal(symbol_name, agent);
 }
 
+void SymbolIndex::Build(const ProgramSymbolMap &program_symbols,
+                        const AgentSymbolMap &agent_symbols) {
+  Clear();
+  const size_t count = program_symbols.size() + agent_symbols.size();
+  if (count == 0) return;
+
+  // Keep the load factor at or below one half so probe sequences stay short.
+  size_t capacity = 16;
+  while (capacity < count * 2) capacity <<= 1;
+  entries_.assign(capacity, Entry());
+  mask_ = capacity - 1;
+
+  for (auto &symbol_entry : program_symbols) {
+    Insert(symbol_entry.first, 0, symbol_entry.second);
+  }
+  for (auto &symbol_entry : agent_symbols) {
+    Insert(symbol_entry.first.first, symbol_entry.first.second.handle, symbol_entry.second);
+  }
+}
+
+void SymbolIndex::Clear() {
+  entries_.clear();
+  mask_ = 0;
+}
+
+uint64_t SymbolIndex::Hash(const char *name, size_t length, uint64_t agent) {
+  // FNV-1a over the name, then fold in the agent handle.
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < length; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(name[i])) * 0x100000001b3ULL;
+  }
+  hash ^= agent + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+void SymbolIndex::Insert(const std::string &name, uint64_t agent, SymbolImpl *symbol) {
+  const uint64_t hash = Hash(name.data(), name.size(), agent);
+  size_t slot = hash & mask_;
+  while (entries_[slot].symbol) slot = (slot + 1) & mask_;
+  entries_[slot] = {hash, agent, &name, symbol};
+}
+
+SymbolImpl* SymbolIndex::Find(const char *name, uint64_t agent) const {
+  if (entries_.empty()) return nullptr;
+
+  const size_t length = strlen(name);
+  const uint64_t hash = Hash(name, length, agent);
+  for (size_t slot = hash & mask_; entries_[slot].symbol; slot = (slot + 1) & mask_) {
+    const Entry &entry = entries_[slot];
+    if (entry.hash == hash && entry.agent == agent && entry.name->size() == length &&
+        memcmp(entry.name->data(), name, length) == 0) {
+      return entry.symbol;
+    }
+  }
+  return nullptr;
+}
+
+//===----------------------------------------------------------------------===//
+// SegmentIndex.                                                              //
+//===----------------------------------------------------------------------===//
+
+void SegmentIndex::Insert(ExecutableImpl *executable) {
+  for (LoadedCodeObjectImpl *lco : executable->loaded_code_objects) {
+    for (Segment *seg : lco->LoadedSegments()) {
+      if (seg->Size() == 0) continue;
+      uint64_t start = (uint64_t)(uintptr_t)seg->Address(seg->VAddr());
+      segments_.emplace(start, Entry{start + seg->Size(), seg, lco});
+    }
+  }
+}
+
+void SegmentIndex::Erase(ExecutableImpl *executable) {
+  for (LoadedCodeObjectImpl *lco : executable->loaded_code_objects) {
+    for (Segment *seg : lco->LoadedSegments()) {
+      auto range = segments_.equal_range((uint64_t)(uintptr_t)seg->Address(seg->VAddr()));
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.segment == seg) {
+          segments_.erase(it);
+          break;
+        }
+      }
+    }
+  }
+}
+
+const SegmentIndex::Entry* SegmentIndex::FindEntry(uint64_t device_address) const {
+  auto it = segments_.upper_bound(device_address);
+  if (it == segments_.begin()) return nullptr;
+  --it;
+  return device_address < it->second.end ? &it->second : nullptr;
+}
+
+Segment* SegmentIndex::Find(uint64_t device_address) const {
+  const Entry *entry = FindEntry(device_address);
+  return entry ? entry->segment : nullptr;
+}
+
+LoadedCodeObjectImpl* SegmentIndex::FindCodeObject(uint64_t device_address) const {
+  const Entry *entry = FindEntry(device_address);
+  return entry ? entry->code_object : nullptr;
+}
+
+//===----------------------------------------------------------------------===//
+// SharedCodeSegments.                                                        //
+//===----------------------------------------------------------------------===//
+
+void* SharedCodeSegments::Acquire(const Key &key, size_t size) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto segment = segments_.find(key);
+  if (segment == segments_.end() || segment->second.size != size) return nullptr;
+  ++segment->second.refs;
+  return segment->second.ptr;
+}
+
+bool SharedCodeSegments::Publish(const Key &key, void *ptr, size_t size) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (!segments_.emplace(key, Entry{ptr, size, 1}).second) return false;
+  keys_.emplace(ptr, key);
+  return true;
+}
+
+bool SharedCodeSegments::Release(void *ptr) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto key = keys_.find(ptr);
+  assert(key != keys_.end() && "segment is not shared");
+  auto segment = segments_.find(key->second);
+  if (--segment->second.refs != 0) return false;
+  segments_.erase(segment);
+  keys_.erase(key);
+  return true;
+}
+
 Symbol* ExecutableImpl::GetSymbolInternal(
   const char *symbol_name,
   const hsa_agent_t *agent)
 {
   assert(symbol_name);
 
+  // Symbols cannot change once frozen, so use the prebuilt index.
+  if (HSA_EXECUTABLE_STATE_FROZEN == state_) {
+    if (symbol_name[0] == '\0') {
+      return nullptr;
+    }
+    return symbol_index_.Find(symbol_name, agent ? agent->handle : 0);
+  }
+
   std::string mangled_name = std::string(symbol_name);
   if (mangled_name.empty()) {
     return nullptr;
@@ -1075,8 +1363,14 @@ hsa_executable_t AmdHsaCodeLoader::FindExecutable(uint64_t device_address)
     return execHandle;
   }
 
+  Segment *seg = segment_index_.Find(device_address);
+  if (seg) {
+    return Executable::Handle(seg->Owner());
+  }
+
+  // Executables which are not frozen yet are not indexed.
   for (auto &exec : executables) {
-    if (exec != nullptr) {
+    if (exec != nullptr && ((ExecutableImpl*)exec)->state() != HSA_EXECUTABLE_STATE_FROZEN) {
       uint64_t host_address = exec->FindHostAddress(device_address);
       if (host_address != 0) {
         return Executable::Handle(exec);
@@ -1086,6 +1380,32 @@ hsa_executable_t AmdHsaCodeLoader::FindExecutable(uint64_t device_address)
   return execHandle;
 }
 
+hsa_loaded_code_object_t AmdHsaCodeLoader::FindLoadedCodeObject(
+  uint64_t device_address, int64_t *load_delta)
+{
+  hsa_loaded_code_object_t handle = {0};
+  ReaderLockGuard<ReaderWriterLock> reader_lock(rw_lock_);
+  if (device_address == 0) {
+    return handle;
+  }
+
+  LoadedCodeObjectImpl *lco = segment_index_.FindCodeObject(device_address);
+  if (lco) {
+    handle = LoadedCodeObject::Handle(lco);
+    *load_delta = lco->getDelta();
+  }
+  return handle;
+}
+
+uint64_t ExecutableImpl::FindHostAddress(Segment *seg, uint64_t device_address)
+{
+  uint64_t paddr = (uint64_t)(uintptr_t)seg->Address(seg->VAddr());
+  assert(paddr <= device_address && device_address < paddr + seg->Size());
+  void *haddr = context_->SegmentHostAddress(
+    seg->ElfSegment(), seg->Agent(), seg->Ptr(), device_address - paddr);
+  return nullptr == haddr ? 0 : (uint64_t)(uintptr_t)haddr;
+}
+
 uint64_t ExecutableImpl::FindHostAddress(uint64_t device_address)
 {
   for (auto &obj : loaded_code_objects) {
@@ -1155,6 +1475,14 @@ static uint32_t NextCodeObjectNum()
   return dumpN++;
 }
 
+namespace {
+
+bool string_ends_with(const std::string &str, const std::string &suf) {
+  return str.size() >= suf.size() ? str.compare(str.size() - suf.size(), suf.size(), suf) == 0 : false;
+}
+
+}
+
 hsa_status_t ExecutableImpl::LoadCodeObject(
   hsa_agent_t agent,
   hsa_code_object_t code_object,
@@ -1179,6 +1507,57 @@ hsa_status_t ExecutableImpl::LoadCodeObject(
     return HSA_STATUS_ERROR_FROZEN_EXECUTABLE;
   }
 
+  return LoadCodeObjectLocked(agent, code_object, options, uri, loaded_code_object, nullptr);
+}
+
+hsa_status_t ExecutableImpl::LoadCodeObject(
+  const hsa_agent_t *agents,
+  size_t num_agents,
+  hsa_code_object_t code_object,
+  const char *options,
+  const std::string &uri,
+  hsa_loaded_code_object_t *loaded_code_objects)
+{
+  assert(agents && num_agents > 0 && code_object.handle != 0);
+
+  WriterLockGuard<ReaderWriterLock> writer_lock(rw_lock_);
+  if (HSA_EXECUTABLE_STATE_FROZEN == state_) {
+    logger_ << "LoaderError: executable is already frozen\n";
+    return HSA_STATUS_ERROR_FROZEN_EXECUTABLE;
+  }
+
+  // Parse the ELF for the first agent only; every other agent is loaded from
+  // the record that parse produced, the same way a code object cache hit is.
+  std::shared_ptr<const CodeObjectRecord> record;
+  hsa_loaded_code_object_t *loaded = loaded_code_objects ? &loaded_code_objects[0] : nullptr;
+  hsa_status_t status =
+      LoadCodeObjectLocked(agents[0], code_object, options, uri, loaded, &record);
+  if (status != HSA_STATUS_SUCCESS) return status;
+
+  const char *elf = reinterpret_cast<const char*>(code_object.handle);
+  const uint64_t elf_size = record ? amd::elf::ElfSize(elf) : 0;
+  for (size_t i = 1; i < num_agents; ++i) {
+    loaded = loaded_code_objects ? &loaded_code_objects[i] : nullptr;
+    if (!record) {
+      status = LoadCodeObjectLocked(agents[i], code_object, options, uri, loaded, nullptr);
+      if (status != HSA_STATUS_SUCCESS) return status;
+      continue;
+    }
+    status = LoadCachedCodeObject(agents[i], *record, elf, elf_size);
+    if (status != HSA_STATUS_SUCCESS) return status;
+    PublishLoadedCodeObject(uri, loaded);
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t ExecutableImpl::LoadCodeObjectLocked(
+  hsa_agent_t agent,
+  hsa_code_object_t code_object,
+  const char *options,
+  const std::string &uri,
+  hsa_loaded_code_object_t *loaded_code_object,
+  std::shared_ptr<const CodeObjectRecord> *parsed)
+{
   LoaderOptions loaderOptions;
   if (options && !loaderOptions.ParseOptions(options)) {
     return HSA_STATUS_ERROR;
@@ -1223,6 +1602,31 @@ hsa_status_t ExecutableImpl::LoadCodeObject(
       break;
     }
   }
+
+  // Code objects seen before by this or another process load from their cached record.
+  CodeObjectCache& cache = CodeObjectCache::Instance();
+  const bool dumping = loaderOptions.DumpAll()->is_set() || loaderOptions.DumpCode()->is_set() ||
+      loaderOptions.DumpIsa()->is_set() || loaderOptions.DumpExec()->is_set();
+  const bool use_cache = cache.enabled() && agent.handle != 0 && code_object.handle != 0 &&
+      substituteFileName.empty() && !dumping;
+  const bool want_record = parsed && agent.handle != 0 && substituteFileName.empty() && !dumping;
+  if (parsed) parsed->reset();
+  uint64_t elf_hash = 0, elf_size = 0;
+  if (use_cache) {
+    const char *elf = reinterpret_cast<const char*>(code_object.handle);
+    elf_size = amd::elf::ElfSize(elf);
+    elf_hash = CodeObjectCache::Hash(elf, elf_size);
+    std::shared_ptr<const CodeObjectRecord> record = cache.Find(elf_hash, elf_size);
+    if (record) {
+      code.reset();
+      hsa_status_t status = LoadCachedCodeObject(agent, *record, elf, elf_size);
+      if (status != HSA_STATUS_SUCCESS) return status;
+      PublishLoadedCodeObject(uri, loaded_code_object);
+      if (want_record) *parsed = record;
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
   std::vector<char> buffer;
   if (substituteFileName.empty()) {
    if (!code->InitAsHandle(code_object)) {
@@ -1275,7 +1679,9 @@ hsa_status_t ExecutableImpl::LoadCodeObject(
   hsa_profile_t codeProfile;
   hsa_machine_model_t codeMachineModel;
   hsa_default_float_rounding_mode_t codeRoundingMode;
-  if (!code->GetNoteHsail(&codeHsailMajor, &codeHsailMinor, &codeProfile, &codeMachineModel, &codeRoundingMode)) {
+  const bool hasHsailNote = code->GetNoteHsail(&codeHsailMajor, &codeHsailMinor, &codeProfile,
+                                               &codeMachineModel, &codeRoundingMode);
+  if (!hasHsailNote) {
     codeProfile = profile_;
   }
   if (profile_ != codeProfile) {
@@ -1299,7 +1705,17 @@ hsa_status_t ExecutableImpl::LoadCodeObject(
   objects.push_back(new LoadedCodeObjectImpl(this, agent, code->ElfData(), code->ElfSize()));
   loaded_code_objects.push_back((LoadedCodeObjectImpl*)objects.back());
 
-  status = LoadSegments(agent, code.get(), majorVersion);
+  bool relocated = false;
+  for (size_t i = 0; i < code->RelocationSectionCount(); ++i) {
+    code::RelocationSection *sec = code->GetRelocationSection(i);
+    if (!sec->targetSection() && sec->relocationCount() != 0) { relocated = true; }
+  }
+  SharedCodeSegments::Key share_key;
+  const bool share = majorVersion >= 3 &&
+      SharedSegmentKey(agent, code->ElfData(), code->ElfSize(), use_cache ? elf_hash : 0,
+                       relocated, &share_key);
+
+  status = LoadSegments(agent, code.get(), majorVersion, share ? &share_key : nullptr);
   if (status != HSA_STATUS_SUCCESS) return status;
 
   for (size_t i = 0; i < code->SymbolCount(); ++i) {
@@ -1312,9 +1728,23 @@ hsa_status_t ExecutableImpl::LoadCodeObject(
     if (status != HSA_STATUS_SUCCESS) { return status; }
   }
 
+  if (majorVersion >= 3) { DeferKernelCode(agent, code.get()); }
+
   status = ApplyRelocations(agent, code.get());
   if (status != HSA_STATUS_SUCCESS) { return status; }
 
+  // The copy sources may be the reader's mapping or a substitute buffer, so
+  // anything not staged on the host must reach the agent before returning.
+  status = UploadLoadedSegments();
+  if (status != HSA_STATUS_SUCCESS) { return status; }
+
+  if ((use_cache || want_record) && !hasHsailNote) {
+    std::shared_ptr<CodeObjectRecord> record =
+        BuildCodeObjectRecord(code.get(), codeIsa, genericVersion, majorVersion, minorVersion);
+    if (record && use_cache) cache.Insert(elf_hash, elf_size, record);
+    if (want_record) *parsed = record;
+  }
+
   code.reset();
 
   if (loaderOptions.DumpAll()->is_set() || loaderOptions.DumpExec()->is_set()) {
@@ -1323,22 +1753,228 @@ hsa_status_t ExecutableImpl::LoadCodeObject(
     }
   }
 
+  PublishLoadedCodeObject(uri, loaded_code_object);
+  return HSA_STATUS_SUCCESS;
+}
+
+void ExecutableImpl::PublishLoadedCodeObject(const std::string &uri,
+                                             hsa_loaded_code_object_t *loaded_code_object) {
   loaded_code_objects.back()->r_debug_info.l_addr = loaded_code_objects.back()->getDelta();
   loaded_code_objects.back()->r_debug_info.l_name = strdup(uri.c_str());
   loaded_code_objects.back()->r_debug_info.l_prev = nullptr;
   loaded_code_objects.back()->r_debug_info.l_next = nullptr;
 
   if (nullptr != loaded_code_object) { *loaded_code_object = LoadedCodeObject::Handle(loaded_code_objects.back()); }
+}
+
+std::shared_ptr<CodeObjectRecord> ExecutableImpl::BuildCodeObjectRecord(
+    code::AmdHsaCode *c, const std::string &isa, unsigned genericVersion, uint32_t majorVersion,
+    uint32_t minorVersion) {
+  // Only code objects with kernel descriptors and dynamic relocations are recorded.
+  if (majorVersion < 3 || !c->DataSegmentCount()) return nullptr;
+
+  std::shared_ptr<CodeObjectRecord> record(new CodeObjectRecord());
+  record->isa = isa;
+  record->generic_version = genericVersion;
+  record->major_version = majorVersion;
+  record->minor_version = minorVersion;
+
+  const KernelBodyMap bodies = KernelBodies(c);
+
+  for (size_t i = 0; i < c->DataSegmentCount(); ++i) {
+    const code::Segment *seg = c->DataSegment(i);
+    record->segments.push_back({seg->vaddr(), seg->offset(), seg->imageSize(), seg->memSize()});
+  }
+
+  for (size_t i = 0; i < c->SymbolCount(); ++i) {
+    code::Symbol *sym = c->GetSymbol(i);
+    if (sym->elfSym()->type() != STT_AMDGPU_HSA_KERNEL && sym->elfSym()->binding() == STB_LOCAL)
+      continue;
+
+    CodeObjectRecord::Symbol rsym = {};
+    rsym.name = sym->Name();
+    if (sym->IsDeclaration()) {
+      rsym.kind = CodeObjectRecord::kDeclaration;
+      record->symbols.push_back(rsym);
+      continue;
+    }
+
+    rsym.module_name = sym->GetModuleName();
+    rsym.symbol_name = sym->GetSymbolName();
+    rsym.linkage = sym->Linkage();
+    rsym.section_addr = sym->GetSection()->addr();
+    rsym.vaddr = sym->VAddr();
+    rsym.size = sym->Size();
+    if (string_ends_with(sym->GetSymbolName(), ".kd")) {
+      llvm::amdhsa::kernel_descriptor_t kd;
+      sym->GetSection()->getData(sym->SectionOffset(), &kd, sizeof(kd));
+      rsym.kind = CodeObjectRecord::kKernel;
+      rsym.kernarg_segment_size = kd.kernarg_size;
+      rsym.kernarg_segment_alignment = KernargSegmentAlignment(c, rsym.symbol_name);
+      rsym.group_segment_size = kd.group_segment_fixed_size;
+      rsym.private_segment_size = kd.private_segment_fixed_size;
+      rsym.is_dynamic_callstack = AMDHSA_BITS_GET(
+          kd.kernel_code_properties, rocr::llvm::amdhsa::KERNEL_CODE_PROPERTY_USES_DYNAMIC_STACK);
+      rsym.uses_wave32 = AMDHSA_BITS_GET(
+          kd.kernel_code_properties,
+          rocr::llvm::amdhsa::KERNEL_CODE_PROPERTY_ENABLE_WAVEFRONT_SIZE32);
+      auto body = bodies.find(rsym.name);
+      if (body != bodies.end()) {
+        rsym.code_vaddr = body->second.first;
+        rsym.code_size = body->second.second;
+      }
+    } else if (sym->IsVariableSymbol()) {
+      rsym.kind = CodeObjectRecord::kVariable;
+      rsym.allocation = sym->Allocation();
+      rsym.segment = sym->Segment();
+      rsym.alignment = sym->Alignment();
+      rsym.is_const = sym->IsConst();
+    } else {
+      return nullptr;
+    }
+    record->symbols.push_back(rsym);
+  }
+
+  for (size_t i = 0; i < c->RelocationSectionCount(); ++i) {
+    code::RelocationSection *sec = c->GetRelocationSection(i);
+    // Static relocations are never applied to code object v2 and up.
+    if (sec->targetSection()) continue;
+    for (size_t j = 0; j < sec->relocationCount(); ++j) {
+      code::Relocation *rel = sec->relocation(j);
+      record->relocations.push_back({rel->offset(), rel->type(), rel->symbol()->type(),
+                                     rel->symbol()->value(), rel->addend(),
+                                     rel->symbol()->name()});
+    }
+  }
+
+  return record;
+}
+
+hsa_status_t ExecutableImpl::LoadCachedCodeObject(hsa_agent_t agent,
+                                                  const CodeObjectRecord &record,
+                                                  const char *elf, uint64_t elf_size) {
+  hsa_isa_t objectsIsa = context_->IsaFromName(record.isa.c_str());
+  if (!objectsIsa.handle) {
+    logger_ << "LoaderError: code object's ISA (" << record.isa.c_str() << ") is invalid\n";
+    return HSA_STATUS_ERROR_INVALID_ISA_NAME;
+  }
+
+  if (!context_->IsaSupportedByAgent(agent, objectsIsa, record.generic_version)) {
+    logger_ << "LoaderError: code object's ISA (" << record.isa.c_str() << ") is not supported by the agent\n";
+    return HSA_STATUS_ERROR_INCOMPATIBLE_ARGUMENTS;
+  }
+
+  for (const CodeObjectRecord::Segment &seg : record.segments) {
+    if (seg.offset > elf_size || seg.file_size > elf_size - seg.offset)
+      return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
+  }
+
+  objects.push_back(new LoadedCodeObjectImpl(this, agent, elf, elf_size));
+  loaded_code_objects.push_back((LoadedCodeObjectImpl*)objects.back());
+
+  // Same layout as LoadSegmentsV2.
+  uint64_t vaddr = record.segments.front().vaddr;
+  uint64_t size = record.segments.back().vaddr + record.segments.back().mem_size;
+
+  SharedCodeSegments::Key share_key;
+  const bool share = SharedSegmentKey(agent, elf, elf_size, 0, !record.relocations.empty(),
+                                      &share_key);
+  Segment *load_segment = share ? AcquireSharedSegment(share_key, agent, size, vaddr,
+                                                       record.segments.front().offset)
+                                : nullptr;
+  if (!load_segment) {
+    void *ptr = context_->SegmentAlloc(AMDGPU_HSA_SEGMENT_CODE_AGENT, agent, size,
+        AMD_ISA_ALIGN_BYTES, true);
+    if (!ptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+    load_segment = new Segment(this, agent, AMDGPU_HSA_SEGMENT_CODE_AGENT,
+        ptr, size, vaddr, record.segments.front().offset);
+    for (const CodeObjectRecord::Segment &seg : record.segments)
+      load_segment->Copy(seg.vaddr, elf + seg.offset, seg.file_size);
+    if (share) unshared_segments_.emplace_back(load_segment, share_key);
+  }
+
+  objects.push_back(load_segment);
+  loaded_code_objects.back()->LoadedSegments().push_back(load_segment);
+
+  for (const CodeObjectRecord::Symbol &sym : record.symbols) {
+    auto agent_symbol = agent_symbols_.find(std::make_pair(sym.name, agent));
+    if (sym.kind == CodeObjectRecord::kDeclaration) {
+      if (program_symbols_.find(sym.name) == program_symbols_.end() &&
+          agent_symbol == agent_symbols_.end()) {
+        logger_ << "LoaderError: symbol \"" << sym.name << "\" is undefined\n";
+        return HSA_STATUS_ERROR_VARIABLE_UNDEFINED;
+      }
+      continue;
+    }
+
+    if (agent_symbol != agent_symbols_.end()) {
+      // TODO(spec): this is not spec compliant.
+      return HSA_STATUS_ERROR_VARIABLE_ALREADY_DEFINED;
+    }
+
+    Segment *seg = VirtualAddressSegment(sym.section_addr);
+    uint64_t address = nullptr == seg ? 0 : (uint64_t) (uintptr_t) seg->Address(sym.vaddr);
+    SymbolImpl *symbol = nullptr;
+    if (sym.kind == CodeObjectRecord::kKernel) {
+      symbol = new KernelSymbol(true,
+                                sym.module_name,
+                                sym.symbol_name,
+                                hsa_symbol_linkage_t(sym.linkage),
+                                true, // sym->IsDefinition()
+                                sym.kernarg_segment_size,
+                                sym.kernarg_segment_alignment,
+                                sym.group_segment_size,
+                                sym.private_segment_size,
+                                sym.is_dynamic_callstack != 0,
+                                sym.size,
+                                64,
+                                sym.uses_wave32 ? 32 : 64,
+                                address);
+    } else {
+      symbol = new VariableSymbol(true,
+                                  sym.module_name,
+                                  sym.symbol_name,
+                                  hsa_symbol_linkage_t(sym.linkage),
+                                  true, // sym->IsDefinition()
+                                  hsa_variable_allocation_t(sym.allocation),
+                                  hsa_variable_segment_t(sym.segment),
+                                  sym.size,
+                                  sym.alignment,
+                                  sym.is_const != 0,
+                                  false,
+                                  address);
+    }
+    symbol->agent = agent;
+    agent_symbols_.insert(std::make_pair(std::make_pair(sym.name, agent), symbol));
+    if (sym.code_size != 0) { DeferKernelCode(agent, sym.name, sym.code_vaddr, sym.code_size); }
+  }
+
+  for (const CodeObjectRecord::Relocation &rel : record.relocations) {
+    if (!VirtualAddressSegment(rel.offset)) return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
+    hsa_status_t status = ApplyDynamicRelocation(agent, rel.offset, rel.type, rel.symbol_type,
+                                                 rel.symbol_value, rel.symbol_name, rel.addend);
+    if (status != HSA_STATUS_SUCCESS) return status;
+  }
+
+  return UploadLoadedSegments();
+}
+
+hsa_status_t ExecutableImpl::UploadLoadedSegments() {
+  for (Segment *seg : loaded_code_objects.back()->LoadedSegments()) {
+    if (!seg->Upload()) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+  }
   return HSA_STATUS_SUCCESS;
 }
 
 hsa_status_t ExecutableImpl::LoadSegments(hsa_agent_t agent,
                                           const code::AmdHsaCode *c,
-                                          uint32_t majorVersion) {
+                                          uint32_t majorVersion,
+                                          const SharedCodeSegments::Key *share_key) {
   if (majorVersion < 2)
     return LoadSegmentsV1(agent, c);
   else
-    return LoadSegmentsV2(agent, c);
+    return LoadSegmentsV2(agent, c, share_key);
 }
 
 hsa_status_t ExecutableImpl::LoadSegmentsV1(hsa_agent_t agent,
@@ -1353,7 +1989,8 @@ hsa_status_t ExecutableImpl::LoadSegmentsV1(hsa_agent_t agent,
 }
 
 hsa_status_t ExecutableImpl::LoadSegmentsV2(hsa_agent_t agent,
-                                            const code::AmdHsaCode *c) {
+                                            const code::AmdHsaCode *c,
+                                            const SharedCodeSegments::Key *share_key) {
   assert(c->Machine() == ELF::EM_AMDGPU && "Program code objects are not supported");
 
   if (!c->DataSegmentCount()) return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
@@ -1362,6 +1999,16 @@ hsa_status_t ExecutableImpl::LoadSegmentsV2(hsa_agent_t agent,
   uint64_t size = c->DataSegment(c->DataSegmentCount() - 1)->vaddr() +
                   c->DataSegment(c->DataSegmentCount() - 1)->memSize();
 
+  if (share_key) {
+    Segment *shared_segment = AcquireSharedSegment(*share_key, agent, size, vaddr,
+                                                   c->DataSegment(0)->offset());
+    if (shared_segment) {
+      objects.push_back(shared_segment);
+      loaded_code_objects.back()->LoadedSegments().push_back(shared_segment);
+      return HSA_STATUS_SUCCESS;
+    }
+  }
+
   void *ptr = context_->SegmentAlloc(AMDGPU_HSA_SEGMENT_CODE_AGENT, agent, size,
       AMD_ISA_ALIGN_BYTES, true);
   if (!ptr) return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
@@ -1378,6 +2025,7 @@ hsa_status_t ExecutableImpl::LoadSegmentsV2(hsa_agent_t agent,
 
   objects.push_back(load_segment);
   loaded_code_objects.back()->LoadedSegments().push_back(load_segment);
+  if (share_key) unshared_segments_.emplace_back(load_segment, *share_key);
 
   return HSA_STATUS_SUCCESS;
 }
@@ -1430,14 +2078,6 @@ hsa_status_t ExecutableImpl::LoadSymbol(hsa_agent_t agent,
   }
 }
 
-namespace {
-
-bool string_ends_with(const std::string &str, const std::string &suf) {
-  return str.size() >= suf.size() ? str.compare(str.size() - suf.size(), suf.size(), suf) == 0 : false;
-}
-
-}
-
 hsa_status_t ExecutableImpl::LoadDefinitionSymbol(hsa_agent_t agent,
                                                   code::Symbol* sym,
                                                   uint32_t majorVersion)
@@ -1468,7 +2108,7 @@ hsa_status_t ExecutableImpl::LoadDefinitionSymbol(hsa_agent_t agent,
     sym->GetSection()->getData(sym->SectionOffset(), &kd, sizeof(kd));
 
     uint32_t kernarg_segment_size = kd.kernarg_size; // FIXME: If 0 then the compiler is not specifying the size.
-    uint32_t kernarg_segment_alignment = 16;         // FIXME: Use the minumum HSA required alignment.
+    uint32_t kernarg_segment_alignment = KernargSegmentAlignment(code.get(), sym->GetSymbolName());
     uint32_t group_segment_size = kd.group_segment_fixed_size;
     uint32_t private_segment_size = kd.private_segment_fixed_size;
     bool is_dynamic_callstack = AMDHSA_BITS_GET(kd.kernel_code_properties, rocr::llvm::amdhsa::KERNEL_CODE_PROPERTY_USES_DYNAMIC_STACK);
@@ -1584,6 +2224,58 @@ hsa_status_t ExecutableImpl::LoadDeclarationSymbol(hsa_agent_t agent,
   return HSA_STATUS_SUCCESS;
 }
 
+bool ExecutableImpl::SharedSegmentKey(hsa_agent_t agent, const char *elf, uint64_t elf_size,
+                                      uint64_t elf_hash, bool relocated,
+                                      SharedCodeSegments::Key *key)
+{
+  if (nullptr == shared_segments_ || agent.handle == 0 || relocated ||
+      HasWritableData(elf, elf_size)) {
+    return false;
+  }
+  if (elf_hash == 0) { elf_hash = CodeObjectCache::Hash(elf, elf_size); }
+  *key = std::make_tuple(agent.handle, elf_hash, elf_size);
+  return true;
+}
+
+Segment* ExecutableImpl::AcquireSharedSegment(const SharedCodeSegments::Key &key,
+                                              hsa_agent_t agent, size_t size, uint64_t vaddr,
+                                              size_t storage_offset)
+{
+  void *ptr = shared_segments_->Acquire(key, size);
+  if (nullptr == ptr) { return nullptr; }
+  Segment *segment = new Segment(this, agent, AMDGPU_HSA_SEGMENT_CODE_AGENT, ptr, size, vaddr,
+                                 storage_offset);
+  segment->MarkShared(true);
+  return segment;
+}
+
+void ExecutableImpl::DeferKernelCode(hsa_agent_t agent, code::AmdHsaCode *c)
+{
+  for (const auto &body : KernelBodies(c)) {
+    DeferKernelCode(agent, body.first, body.second.first, body.second.second);
+  }
+}
+
+void ExecutableImpl::DeferKernelCode(hsa_agent_t agent, const std::string &name,
+                                     uint64_t code_vaddr, uint64_t code_size)
+{
+  auto agent_symbol = agent_symbols_.find(std::make_pair(name, agent));
+  if (agent_symbol == agent_symbols_.end() || !agent_symbol->second->IsKernel()) { return; }
+  KernelSymbol *kernel = static_cast<KernelSymbol*>(agent_symbol->second);
+  kernel->code_vaddr = code_vaddr;
+  kernel->code_size = code_size;
+
+  if (IsHotKernel(kernel->symbol_name.substr(0, kernel->symbol_name.size() - 3))) { return; }
+  Segment *seg = VirtualAddressSegment(code_vaddr);
+  if (nullptr == seg || !seg->IsAddressInSegment(code_vaddr + code_size - 1)) { return; }
+  // A shared segment is already frozen, the body may have been deferred by
+  // the executable that loaded it.
+  if (seg->Frozen() || seg->Defer(code_vaddr, code_size)) {
+    kernel->code_segment = seg;
+    kernel->code_resident.store(false, std::memory_order_relaxed);
+  }
+}
+
 Segment* ExecutableImpl::VirtualAddressSegment(uint64_t vaddr)
 {
   for (auto &seg : loaded_code_objects.back()->LoadedSegments()) {
@@ -1842,15 +2534,25 @@ hsa_status_t ExecutableImpl::ApplyDynamicRelocationSection(hsa_agent_t agent, am
 
 hsa_status_t ExecutableImpl::ApplyDynamicRelocation(hsa_agent_t agent, amd::hsa::code::Relocation *rel)
 {
-  Segment* relSeg = VirtualAddressSegment(rel->offset());
+  return ApplyDynamicRelocation(agent, rel->offset(), rel->type(), rel->symbol()->type(),
+                                rel->symbol()->value(), rel->symbol()->name(), rel->addend());
+}
+
+hsa_status_t ExecutableImpl::ApplyDynamicRelocation(hsa_agent_t agent, uint64_t offset,
+                                                    uint32_t type, uint32_t symbol_type,
+                                                    uint64_t symbol_value,
+                                                    const std::string &symbol_name,
+                                                    int64_t addend)
+{
+  Segment* relSeg = VirtualAddressSegment(offset);
   uint64_t symAddr = 0;
-  switch (rel->symbol()->type()) {
+  switch (symbol_type) {
     case STT_OBJECT:
     case STT_AMDGPU_HSA_KERNEL:
     case STT_FUNC:
     {
-      Segment* symSeg = VirtualAddressSegment(rel->symbol()->value());
-      symAddr = reinterpret_cast<uint64_t>(symSeg->Address(rel->symbol()->value()));
+      Segment* symSeg = VirtualAddressSegment(symbol_value);
+      symAddr = reinterpret_cast<uint64_t>(symSeg->Address(symbol_value));
       break;
     }
 
@@ -1860,7 +2562,7 @@ hsa_status_t ExecutableImpl::ApplyDynamicRelocation(hsa_agent_t agent, amd::hsa:
       // TODO: Only agent allocation variables are supported in v2.1. How will
       // we distinguish between program allocation and agent allocation
       // variables?
-      auto agent_symbol = agent_symbols_.find(std::make_pair(rel->symbol()->name(), agent));
+      auto agent_symbol = agent_symbols_.find(std::make_pair(symbol_name, agent));
       if (agent_symbol != agent_symbols_.end())
         symAddr = agent_symbol->second->address;
       break;
@@ -1870,61 +2572,61 @@ hsa_status_t ExecutableImpl::ApplyDynamicRelocation(hsa_agent_t agent, amd::hsa:
       // Only objects and kernels are supported in v2.1.
       return HSA_STATUS_ERROR_INVALID_CODE_OBJECT;
   }
-  symAddr += rel->addend();
+  symAddr += addend;
 
-  switch (rel->type()) {
+  switch (type) {
     case ELF::R_AMDGPU_ABS32_HI:
     {
       if (!symAddr) {
-        logger_ << "LoaderError: symbol \"" << rel->symbol()->name() << "\" is undefined\n";
+        logger_ << "LoaderError: symbol \"" << symbol_name << "\" is undefined\n";
         return HSA_STATUS_ERROR_VARIABLE_UNDEFINED;
       }
 
       uint32_t symAddr32 = uint32_t((symAddr >> 32) & 0xFFFFFFFF);
-      relSeg->Copy(rel->offset(), &symAddr32, sizeof(symAddr32));
+      relSeg->Copy(offset, &symAddr32, sizeof(symAddr32));
       break;
     }
 
     case ELF::R_AMDGPU_ABS32_LO:
     {
       if (!symAddr) {
-        logger_ << "LoaderError: symbol \"" << rel->symbol()->name() << "\" is undefined\n";
+        logger_ << "LoaderError: symbol \"" << symbol_name << "\" is undefined\n";
         return HSA_STATUS_ERROR_VARIABLE_UNDEFINED;
       }
 
       uint32_t symAddr32 = uint32_t(symAddr & 0xFFFFFFFF);
-      relSeg->Copy(rel->offset(), &symAddr32, sizeof(symAddr32));
+      relSeg->Copy(offset, &symAddr32, sizeof(symAddr32));
       break;
     }
 
     case ELF::R_AMDGPU_ABS32:
     {
       if (!symAddr) {
-        logger_ << "LoaderError: symbol \"" << rel->symbol()->name() << "\" is undefined\n";
+        logger_ << "LoaderError: symbol \"" << symbol_name << "\" is undefined\n";
         return HSA_STATUS_ERROR_VARIABLE_UNDEFINED;
       }
 
       uint32_t symAddr32 = uint32_t(symAddr);
-      relSeg->Copy(rel->offset(), &symAddr32, sizeof(symAddr32));
+      relSeg->Copy(offset, &symAddr32, sizeof(symAddr32));
       break;
     }
 
     case ELF::R_AMDGPU_ABS64:
     {
       if (!symAddr) {
-        logger_ << "LoaderError: symbol \"" << rel->symbol()->name() << "\" is undefined\n";
+        logger_ << "LoaderError: symbol \"" << symbol_name << "\" is undefined\n";
         return HSA_STATUS_ERROR_VARIABLE_UNDEFINED;
       }
 
-      relSeg->Copy(rel->offset(), &symAddr, sizeof(symAddr));
+      relSeg->Copy(offset, &symAddr, sizeof(symAddr));
       break;
     }
 
     case ELF::R_AMDGPU_RELATIVE64:
     {
       int64_t baseDelta = reinterpret_cast<uint64_t>(relSeg->Address(0)) - relSeg->VAddr();
-      uint64_t relocatedAddr = baseDelta + rel->addend();
-      relSeg->Copy(rel->offset(), &relocatedAddr, sizeof(relocatedAddr));
+      uint64_t relocatedAddr = baseDelta + addend;
+      relSeg->Copy(offset, &relocatedAddr, sizeof(relocatedAddr));
       break;
     }
 
@@ -1935,18 +2637,115 @@ hsa_status_t ExecutableImpl::ApplyDynamicRelocation(hsa_agent_t agent, amd::hsa:
 }
 
 hsa_status_t ExecutableImpl::Freeze(const char *options) {
+  hsa_status_t status = FreezeStart(options);
+  if (status != HSA_STATUS_SUCCESS) {
+    return status;
+  }
+  return FreezeFinish();
+}
+
+hsa_status_t ExecutableImpl::GetKernels(const hsa_agent_t *agent, uint32_t *num_kernels,
+                                        hsa_ven_amd_loader_kernel_info_t *kernels) {
+  amd::hsa::common::ReaderLockGuard<amd::hsa::common::ReaderWriterLock> reader_lock(rw_lock_);
+  if (HSA_EXECUTABLE_STATE_FROZEN != state_) {
+    return HSA_STATUS_ERROR_INVALID_EXECUTABLE;
+  }
+
+  size_t first = 0, last = kernel_table_.size();
+  if (agent) {
+    const auto by_agent = [](const hsa_ven_amd_loader_kernel_info_t &info, uint64_t handle) {
+      return info.agent.handle < handle;
+    };
+    first = std::lower_bound(kernel_table_.begin(), kernel_table_.end(), agent->handle,
+                             by_agent) - kernel_table_.begin();
+    last = std::lower_bound(kernel_table_.begin() + first, kernel_table_.end(),
+                            agent->handle + 1, by_agent) - kernel_table_.begin();
+  }
+
+  if (nullptr == kernels) {
+    *num_kernels = uint32_t(last - first);
+    return HSA_STATUS_SUCCESS;
+  }
+  if (*num_kernels != last - first) {
+    return HSA_STATUS_ERROR_INCOMPATIBLE_ARGUMENTS;
+  }
+  for (size_t i = first; i < last; ++i) {
+    if (!kernel_table_symbols_[i]->MakeCodeResident()) {
+      return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+    }
+  }
+  memcpy(kernels, &kernel_table_[first], (last - first) * sizeof(*kernels));
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t ExecutableImpl::FreezeStart(const char *options) {
   amd::hsa::common::WriterLockGuard<amd::hsa::common::ReaderWriterLock> writer_lock(rw_lock_);
   if (HSA_EXECUTABLE_STATE_FROZEN == state_) {
     return HSA_STATUS_ERROR_FROZEN_EXECUTABLE;
   }
 
+  // Start every segment's upload before waiting on any of them, so that the
+  // copies to all agents overlap.
   for (auto &lco : loaded_code_objects) {
     for (auto &ls : lco->LoadedSegments()) {
-      ls->Freeze();
+      ls->FreezeStart();
     }
   }
 
+  symbol_index_.Build(program_symbols_, agent_symbols_);
+
+  kernel_table_symbols_.clear();
+  for (auto &symbol_entry : agent_symbols_) {
+    if (symbol_entry.second->IsKernel() && symbol_entry.second->is_definition) {
+      kernel_table_symbols_.push_back(static_cast<KernelSymbol*>(symbol_entry.second));
+    }
+  }
+  std::sort(kernel_table_symbols_.begin(), kernel_table_symbols_.end(),
+            [](const KernelSymbol *a, const KernelSymbol *b) {
+              return a->agent.handle < b->agent.handle;
+            });
+  kernel_table_.resize(kernel_table_symbols_.size());
+  for (size_t i = 0; i < kernel_table_symbols_.size(); ++i) {
+    const KernelSymbol *kernel = kernel_table_symbols_[i];
+    hsa_ven_amd_loader_kernel_info_t &info = kernel_table_[i];
+    info.symbol.handle = reinterpret_cast<uint64_t>(static_cast<const Symbol*>(kernel));
+    info.agent = kernel->agent;
+    info.kernel_object = kernel->address;
+    info.name = kernel->symbol_name.c_str();
+    info.kernarg_segment_size = kernel->kernarg_segment_size;
+    info.kernarg_segment_alignment = kernel->kernarg_segment_alignment;
+    info.group_segment_size = kernel->group_segment_size;
+    info.private_segment_size = kernel->private_segment_size;
+    info.wavefront_size = kernel->wavefront_size;
+    info.is_dynamic_callstack = kernel->is_dynamic_callstack;
+  }
+
   state_ = HSA_EXECUTABLE_STATE_FROZEN;
+  freezing_ = true;
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t ExecutableImpl::FreezeFinish() {
+  amd::hsa::common::WriterLockGuard<amd::hsa::common::ReaderWriterLock> writer_lock(rw_lock_);
+  if (!freezing_) {
+    return HSA_STATUS_SUCCESS;
+  }
+
+  for (auto &lco : loaded_code_objects) {
+    for (auto &ls : lco->LoadedSegments()) {
+      ls->FreezeFinish();
+    }
+  }
+
+  for (auto &unshared : unshared_segments_) {
+    Segment *seg = unshared.first;
+    if (seg->Frozen() && shared_segments_->Publish(unshared.second, seg->Ptr(), seg->Size())) {
+      seg->MarkShared(false);
+    }
+  }
+  unshared_segments_.clear();
+
+  freezing_ = false;
   return HSA_STATUS_SUCCESS;
 }
 
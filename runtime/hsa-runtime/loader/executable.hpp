@@ -44,12 +44,15 @@
 #define HSA_RUNTIME_CORE_LOADER_EXECUTABLE_HPP_
 
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <iostream>
 #include <libelf.h>
 #include <link.h>
 #include <list>
+#include <map>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -61,6 +64,7 @@
 #include "core/inc/amd_hsa_code.hpp"
 #include "inc/amd_hsa_kernel_code.h"
 #include "amd_hsa_locks.hpp"
+#include "code_object_cache.hpp"
 
 namespace rocr {
 namespace amd {
@@ -70,6 +74,7 @@ namespace loader {
 class MemoryAddress;
 class SymbolImpl;
 class KernelSymbol;
+class Segment;
 class VariableSymbol;
 class ExecutableImpl;
 
@@ -167,6 +172,9 @@ public:
 
   bool GetInfo(hsa_symbol_info32_t symbol_info, void *value);
 
+  /// @brief Makes a deferred kernel body resident, see code_segment.
+  bool MakeCodeResident();
+
   std::string full_name;
   uint32_t kernarg_segment_size;
   uint32_t kernarg_segment_alignment;
@@ -177,6 +185,12 @@ public:
   uint32_t alignment;
   uint32_t wavefront_size;
   amd_runtime_loader_debug_info_t debug_info;
+  // Kernel body, if deferred it is made resident on the first query of the
+  // kernel object.
+  uint64_t code_vaddr = 0;
+  uint64_t code_size = 0;
+  Segment *code_segment = nullptr;
+  std::atomic<bool> code_resident{true};
 
 private:
   KernelSymbol(const KernelSymbol &ks);
@@ -340,18 +354,26 @@ private:
   size_t size;
   uint64_t vaddr;
   bool frozen;
+  bool freezing;
+  bool shared;
   size_t storage_offset;
 
 public:
   Segment(ExecutableImpl *owner_, hsa_agent_t agent_, amdgpu_hsa_elf_segment_t segment_, void* ptr_, size_t size_, uint64_t vaddr_, size_t storage_offset_)
     : ExecutableObject(owner_, agent_), segment(segment_),
-      ptr(ptr_), size(size_), vaddr(vaddr_), frozen(false), storage_offset(storage_offset_) { }
+      ptr(ptr_), size(size_), vaddr(vaddr_), frozen(false), freezing(false),
+      shared(false), storage_offset(storage_offset_) { }
 
   amdgpu_hsa_elf_segment_t ElfSegment() const { return segment; }
   void* Ptr() const { return ptr; }
   size_t Size() const { return size; }
   uint64_t VAddr() const { return vaddr; }
   size_t StorageOffset() const { return storage_offset;  }
+  bool Frozen() const { return frozen; }
+
+  /// @brief Marks the memory as owned by the executable's SharedCodeSegments.
+  /// A segment acquired from there is already @p frozen_.
+  void MarkShared(bool frozen_) { shared = true; frozen = frozen || frozen_; }
 
   bool GetInfo(amd_loaded_segment_info_t attribute, void *value) override;
 
@@ -359,7 +381,19 @@ public:
 
   void* Address(uint64_t addr); // Address in segment. Used for relocations and valid on agent.
 
+  /// @brief Writes what has been copied into the segment so far to the agent,
+  /// for memory that does not keep a host copy.
+  bool Upload();
+
   bool Freeze();
+  /// @brief Two halves of Freeze, letting the copies of many segments overlap.
+  bool FreezeStart();
+  bool FreezeFinish();
+
+  /// @brief Leaves [@p addr, @p addr + @p size) out of the agent copy until
+  /// made resident. Returns false if the memory cannot defer.
+  bool Defer(uint64_t addr, size_t size);
+  bool MakeResident(uint64_t addr, size_t size);
 
   bool IsAddressInSegment(uint64_t addr);
   void Copy(uint64_t addr, const void* src, size_t size);
@@ -407,8 +441,91 @@ struct ASH {
 };
 typedef std::unordered_map<AgentSymbol, SymbolImpl*, ASH, ASC> AgentSymbolMap;
 
+/// @class SymbolIndex.
+/// @brief Open addressing index over the program and agent symbol maps of a
+/// frozen executable. Lookups hash the name in place, so no key strings are
+/// built on the query path. Program symbols are keyed with agent handle 0.
+class SymbolIndex final {
+public:
+  void Build(const ProgramSymbolMap &program_symbols, const AgentSymbolMap &agent_symbols);
+  void Clear();
+  SymbolImpl* Find(const char *name, uint64_t agent) const;
+
+private:
+  struct Entry {
+    uint64_t hash;
+    uint64_t agent;
+    const std::string *name;  // Key owned by the symbol map.
+    SymbolImpl *symbol;       // Null for an empty slot.
+  };
+
+  static uint64_t Hash(const char *name, size_t length, uint64_t agent);
+  void Insert(const std::string &name, uint64_t agent, SymbolImpl *symbol);
+
+  std::vector<Entry> entries_;
+  size_t mask_ = 0;
+};
+
+/// @class SharedCodeSegments.
+/// @brief Reference counted code segments of code objects without dynamic
+/// relocations or writable data, whose frozen contents depend only on the ELF
+/// image. Executables loading the same image on the same agent map the
+/// segment already frozen by another instead of allocating and uploading it.
+class SharedCodeSegments final {
+public:
+  /// @brief Agent handle, content hash and size of the ELF image.
+  typedef std::tuple<uint64_t, uint64_t, uint64_t> Key;
+
+  /// @brief Returns the memory of the segment of @p size bytes published
+  /// under @p key with a reference taken, or null.
+  void* Acquire(const Key &key, size_t size);
+  /// @brief Publishes frozen segment memory @p ptr holding one reference.
+  /// Returns false if another segment has been published under @p key.
+  bool Publish(const Key &key, void *ptr, size_t size);
+  /// @brief Drops a reference to @p ptr, returns true if it was the last and
+  /// the memory is to be freed.
+  bool Release(void *ptr);
+
+private:
+  struct Entry {
+    void *ptr;
+    size_t size;
+    size_t refs;
+  };
+
+  std::mutex lock_;
+  std::map<Key, Entry> segments_;
+  std::unordered_map<void*, Key> keys_;
+};
+
+/// @class SegmentIndex.
+/// @brief Loaded segments of frozen executables ordered by device address,
+/// for reverse lookups of device addresses in logarithmic time.
+class SegmentIndex final {
+public:
+  void Insert(ExecutableImpl *executable);
+  void Erase(ExecutableImpl *executable);
+  /// @brief Returns the segment holding @p device_address, or null.
+  Segment* Find(uint64_t device_address) const;
+  /// @brief Returns the code object holding @p device_address, or null.
+  LoadedCodeObjectImpl* FindCodeObject(uint64_t device_address) const;
+
+private:
+  struct Entry {
+    uint64_t end;
+    Segment *segment;
+    LoadedCodeObjectImpl *code_object;
+  };
+
+  const Entry* FindEntry(uint64_t device_address) const;
+
+  // Executables sharing a segment add equal ranges.
+  std::multimap<uint64_t, Entry> segments_;
+};
+
 class ExecutableImpl final: public Executable {
 friend class AmdHsaCodeLoader;
+friend class SegmentIndex;
 public:
   const hsa_profile_t& profile() const {
     return profile_;
@@ -433,6 +550,8 @@ public:
 
   hsa_status_t GetInfo(hsa_executable_info_t executable_info, void *value) override;
 
+  SharedCodeSegments* shared_segments() const { return shared_segments_; }
+
   hsa_status_t DefineProgramExternalVariable(
     const char *name, void *address) override;
 
@@ -457,7 +576,19 @@ public:
     const std::string &uri,
     hsa_loaded_code_object_t *loaded_code_object) override;
 
+  hsa_status_t LoadCodeObject(
+    const hsa_agent_t *agents,
+    size_t num_agents,
+    hsa_code_object_t code_object,
+    const char *options,
+    const std::string &uri,
+    hsa_loaded_code_object_t *loaded_code_objects) override;
+
   hsa_status_t Freeze(const char *options) override;
+  hsa_status_t GetKernels(const hsa_agent_t *agent, uint32_t *num_kernels,
+                          hsa_ven_amd_loader_kernel_info_t *kernels) override;
+  hsa_status_t FreezeStart(const char *options) override;
+  hsa_status_t FreezeFinish() override;
 
   hsa_status_t Validate(uint32_t *result) override {
     amd::hsa::common::ReaderLockGuard<amd::hsa::common::ReaderWriterLock> reader_lock(rw_lock_);
@@ -509,6 +640,9 @@ public:
 
   uint64_t FindHostAddress(uint64_t device_address) override;
 
+  /// @brief Host address of @p device_address within loaded segment @p seg.
+  uint64_t FindHostAddress(Segment *seg, uint64_t device_address);
+
   void EnableReadOnlyMode();
   void DisableReadOnlyMode();
 
@@ -529,9 +663,11 @@ private:
     const hsa_agent_t *agent);
 
   hsa_status_t LoadSegments(hsa_agent_t agent, const code::AmdHsaCode *c,
-                            uint32_t majorVersion);
+                            uint32_t majorVersion,
+                            const SharedCodeSegments::Key *share_key = nullptr);
   hsa_status_t LoadSegmentsV1(hsa_agent_t agent, const code::AmdHsaCode *c);
-  hsa_status_t LoadSegmentsV2(hsa_agent_t agent, const code::AmdHsaCode *c);
+  hsa_status_t LoadSegmentsV2(hsa_agent_t agent, const code::AmdHsaCode *c,
+                              const SharedCodeSegments::Key *share_key);
   hsa_status_t LoadSegmentV1(hsa_agent_t agent, const code::Segment *s);
   hsa_status_t LoadSegmentV2(const code::Segment *data_segment,
                              loader::Segment *load_segment);
@@ -545,6 +681,48 @@ private:
   hsa_status_t ApplyStaticRelocation(hsa_agent_t agent, amd::hsa::code::Relocation *rel);
   hsa_status_t ApplyDynamicRelocationSection(hsa_agent_t agent, amd::hsa::code::RelocationSection* sec);
   hsa_status_t ApplyDynamicRelocation(hsa_agent_t agent, amd::hsa::code::Relocation *rel);
+  hsa_status_t ApplyDynamicRelocation(hsa_agent_t agent, uint64_t offset, uint32_t type,
+                                      uint32_t symbol_type, uint64_t symbol_value,
+                                      const std::string &symbol_name, int64_t addend);
+
+  /// @brief Describes the code object being loaded for the code object
+  /// cache.  Returns null if it uses features the cache does not record.
+  std::shared_ptr<CodeObjectRecord> BuildCodeObjectRecord(amd::hsa::code::AmdHsaCode *c,
+                                                          const std::string &isa,
+                                                          unsigned genericVersion,
+                                                          uint32_t majorVersion,
+                                                          uint32_t minorVersion);
+  /// @brief Loads a code object from its cached record without parsing the
+  /// ELF image at @p elf.
+  hsa_status_t LoadCachedCodeObject(hsa_agent_t agent, const CodeObjectRecord &record,
+                                    const char *elf, uint64_t elf_size);
+  void PublishLoadedCodeObject(const std::string &uri,
+                               hsa_loaded_code_object_t *loaded_code_object);
+  /// @brief Uploads the segments of the last loaded code object while the
+  /// sources they were copied from are still valid.
+  hsa_status_t UploadLoadedSegments();
+  /// @brief Body of LoadCodeObject, called with the writer lock held. If
+  /// @p parsed is not null it receives the record of the code object, or null
+  /// if it cannot be loaded from one.
+  hsa_status_t LoadCodeObjectLocked(hsa_agent_t agent, hsa_code_object_t code_object,
+                                    const char *options, const std::string &uri,
+                                    hsa_loaded_code_object_t *loaded_code_object,
+                                    std::shared_ptr<const CodeObjectRecord> *parsed);
+
+  /// @brief Records the bodies of the kernels of @p c and defers those not
+  /// listed in HSA_LOADER_LAZY_HOT_KERNELS if the code segment allows it.
+  void DeferKernelCode(hsa_agent_t agent, code::AmdHsaCode *c);
+  void DeferKernelCode(hsa_agent_t agent, const std::string &name, uint64_t code_vaddr,
+                       uint64_t code_size);
+
+  /// @brief Computes the key under which the code segment of the ELF image
+  /// at @p elf may be shared, returns false if it may not.
+  bool SharedSegmentKey(hsa_agent_t agent, const char *elf, uint64_t elf_size,
+                        uint64_t elf_hash, bool relocated, SharedCodeSegments::Key *key);
+  /// @brief Returns a new segment of a frozen shared code segment for
+  /// @p key, or null if none is published yet.
+  Segment* AcquireSharedSegment(const SharedCodeSegments::Key &key, hsa_agent_t agent,
+                                size_t size, uint64_t vaddr, size_t storage_offset);
 
   Segment* VirtualAddressSegment(uint64_t vaddr);
   uint64_t SymbolAddress(hsa_agent_t agent, amd::hsa::code::Symbol* sym);
@@ -560,9 +738,18 @@ private:
   const size_t id_;
   hsa_default_float_rounding_mode_t default_float_rounding_mode_;
   hsa_executable_state_t state_;
+  // Frozen by FreezeStart, FreezeFinish has not run yet.
+  bool freezing_ = false;
 
   ProgramSymbolMap program_symbols_;
   AgentSymbolMap agent_symbols_;
+  SymbolIndex symbol_index_;
+  // Kernels of the frozen executable ordered by agent, and their symbols.
+  std::vector<hsa_ven_amd_loader_kernel_info_t> kernel_table_;
+  std::vector<KernelSymbol*> kernel_table_symbols_;
+  SharedCodeSegments *shared_segments_ = nullptr;
+  // Code segments to publish to shared_segments_ once frozen.
+  std::vector<std::pair<Segment*, SharedCodeSegments::Key>> unshared_segments_;
   std::vector<ExecutableObject*> objects;
   Segment *program_allocation_segment;
   std::vector<LoadedCodeObjectImpl*> loaded_code_objects;
@@ -573,6 +760,8 @@ private:
   Context* context;
   std::vector<Executable*> executables;
   amd::hsa::common::ReaderWriterLock rw_lock_;
+  SharedCodeSegments shared_segments_;
+  SegmentIndex segment_index_;
 
 public:
   AmdHsaCodeLoader(Context* context_)
@@ -592,7 +781,10 @@ public:
       hsa_default_float_rounding_mode_t default_float_rounding_mode = HSA_DEFAULT_FLOAT_ROUNDING_MODE_DEFAULT) override;
 
   hsa_status_t FreezeExecutable(Executable *executable, const char *options) override;
+  hsa_status_t FreezeExecutableStart(Executable *executable, const char *options) override;
+  hsa_status_t FreezeExecutableFinish(Executable *executable) override;
   void DestroyExecutable(Executable *executable) override;
+  void DestroyExecutables(Executable *const *executables_, size_t count) override;
 
   hsa_status_t IterateExecutables(
     hsa_status_t (*callback)(
@@ -608,6 +800,9 @@ public:
 
   uint64_t FindHostAddress(uint64_t device_address) override;
 
+  hsa_loaded_code_object_t FindLoadedCodeObject(
+    uint64_t device_address, int64_t *load_delta) override;
+
   void PrintHelp(std::ostream& out) override;
 
   void EnableReadOnlyMode();
@@ -152,6 +152,22 @@ hsa_status_t hsa_ven_amd_pcs_flush(hsa_ven_amd_pcs_t handle) {
   CATCH;
 }
 
+hsa_status_t hsa_ven_amd_pcs_data_view(void* hsa_callback_data,
+                                       hsa_ven_amd_pcs_data_view_t* view) {
+  TRY;
+  return PcsRuntime::instance()->PcSamplingDataView(hsa_callback_data, view);
+  CATCH;
+}
+
+hsa_status_t hsa_ven_amd_pcs_aggregate(hsa_ven_amd_pcs_t handle,
+                                       hsa_ven_amd_pcs_histogram_callback_t histogram_callback,
+                                       void* client_callback_data) {
+  TRY;
+  return PcsRuntime::instance()->PcSamplingAggregate(handle, histogram_callback,
+                                                     client_callback_data);
+  CATCH;
+}
+
 void LoadPcSampling(core::PcSamplingExtTableInternal* pcs_api) {
   pcs_api->hsa_ven_amd_pcs_iterate_configuration_fn = hsa_ven_amd_pcs_iterate_configuration;
   pcs_api->hsa_ven_amd_pcs_create_fn = hsa_ven_amd_pcs_create;
@@ -160,6 +176,8 @@ void LoadPcSampling(core::PcSamplingExtTableInternal* pcs_api) {
   pcs_api->hsa_ven_amd_pcs_start_fn = hsa_ven_amd_pcs_start;
   pcs_api->hsa_ven_amd_pcs_stop_fn = hsa_ven_amd_pcs_stop;
   pcs_api->hsa_ven_amd_pcs_flush_fn = hsa_ven_amd_pcs_flush;
+  pcs_api->hsa_ven_amd_pcs_data_view_fn = hsa_ven_amd_pcs_data_view;
+  pcs_api->hsa_ven_amd_pcs_aggregate_fn = hsa_ven_amd_pcs_aggregate;
 }
 
 }  //  namespace pcs
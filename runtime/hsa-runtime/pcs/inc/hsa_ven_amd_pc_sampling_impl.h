@@ -79,6 +79,13 @@ hsa_status_t hsa_ven_amd_pcs_stop(hsa_ven_amd_pcs_t pc_sampling);
 
 hsa_status_t hsa_ven_amd_pcs_flush(hsa_ven_amd_pcs_t pc_sampling);
 
+hsa_status_t hsa_ven_amd_pcs_data_view(void* hsa_callback_data,
+                                       hsa_ven_amd_pcs_data_view_t* view);
+
+hsa_status_t hsa_ven_amd_pcs_aggregate(hsa_ven_amd_pcs_t pc_sampling,
+                                       hsa_ven_amd_pcs_histogram_callback_t histogram_callback,
+                                       void* client_callback_data);
+
 // Update Api table with func pointers that implement functionality
 void LoadPcSampling(core::PcSamplingExtTableInternal* pcs_api);
 
@@ -106,7 +106,16 @@ PcsRuntime::PcSamplingSession::PcSamplingSession(
     core::Agent* _agent, hsa_ven_amd_pcs_method_kind_t method, hsa_ven_amd_pcs_units_t units,
     size_t interval, size_t latency, size_t buffer_size,
     hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback, void* client_callback_data)
-    : agent(_agent), thunkId_(0), active_(false), valid_(true), sample_size_(0) {
+    : agent(_agent),
+      read_index(0),
+      lost_sample_count(0),
+      thunkId_(0),
+      active_(false),
+      valid_(true),
+      sample_size_(0),
+      histogram_callback_(nullptr),
+      histogram_callback_data_(nullptr),
+      histogram_lost_sample_count_(0) {
   switch (method) {
     case HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1:
       sample_size_ = sizeof(perf_sample_hosttrap_v1_t);
@@ -186,55 +195,106 @@ hsa_status_t PcsRuntime::PcSamplingSession::DataCopyCallback(uint8_t* buffer,
   return HSA_STATUS_SUCCESS;
 }
 
+hsa_status_t PcsRuntime::PcSamplingSession::DataView(hsa_ven_amd_pcs_data_view_t* view) {
+  // Views are only valid while the data_ready_callback runs.
+  if (data_rdy.buf1 == nullptr) return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  view->buf1 = data_rdy.buf1;
+  view->buf1_size = data_rdy.buf1_sz;
+  view->buf2 = data_rdy.buf2;
+  view->buf2_size = data_rdy.buf2_sz;
+  return HSA_STATUS_SUCCESS;
+}
+
 hsa_status_t PcsRuntime::PcSamplingSession::HandleSampleData(uint8_t* buf1, size_t buf1_sz,
                                                              uint8_t* buf2, size_t buf2_sz,
                                                              size_t lost_sample_count) {
+  // Sample timestamps were translated by the agent when the samples reached the host, the
+  // buffers may be shared with other sessions and must not be modified here.
+  if (isAggregating()) {
+    ScopedAcquire<KernelMutex> lock(&histogram_lock_);
+    histogram_lost_sample_count_ += lost_sample_count;
+    if (csd.method == HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1) {
+      AggregateSamples<perf_sample_hosttrap_v1_t>(buf1, buf1_sz);
+      AggregateSamples<perf_sample_hosttrap_v1_t>(buf2, buf2_sz);
+    } else {
+      AggregateSamples<perf_sample_snapshot_v1_t>(buf1, buf1_sz);
+      AggregateSamples<perf_sample_snapshot_v1_t>(buf2, buf2_sz);
+    }
+    return HSA_STATUS_SUCCESS;
+  }
+
   data_rdy.buf1 = buf1;
   data_rdy.buf1_sz = buf1_sz;
   data_rdy.buf2 = buf2;
   data_rdy.buf2_sz = buf2_sz;
 
-  AMD::GpuAgent* gpuAgent = static_cast<AMD::GpuAgent*>(agent);
+  csd.data_ready_callback(csd.client_callback_data, buf1_sz + buf2_sz, lost_sample_count,
+                          &PcSamplingDataCopyCallback,
+                          /* hsa_callback_data*/ this);
 
-  switch (csd.method) {
-    case HSA_VEN_AMD_PCS_METHOD_HOSTTRAP_V1: {
-      size_t buf_samples = buf1_sz / sizeof(perf_sample_hosttrap_v1_t);
-      perf_sample_hosttrap_v1_t* samples = reinterpret_cast<perf_sample_hosttrap_v1_t*>(buf1);
-      while (buf_samples--) {
-        samples->timestamp = gpuAgent->TranslateTime(samples->timestamp);
-        samples++;
-      }
-
-      buf_samples = buf2_sz / sizeof(perf_sample_hosttrap_v1_t);
-      samples = reinterpret_cast<perf_sample_hosttrap_v1_t*>(buf2);
-      while (buf_samples--) {
-        samples->timestamp = gpuAgent->TranslateTime(samples->timestamp);
-        samples++;
-      }
+  data_rdy.buf1 = nullptr;
+  data_rdy.buf1_sz = 0;
+  data_rdy.buf2 = nullptr;
+  data_rdy.buf2_sz = 0;
+  return HSA_STATUS_SUCCESS;
+}
+
+template <typename SampleT>
+void PcsRuntime::PcSamplingSession::AggregateSamples(const uint8_t* buf, size_t size) {
+  const SampleT* samples = reinterpret_cast<const SampleT*>(buf);
+  for (size_t i = 0; i < size / sizeof(SampleT); i++) {
+    const uint64_t pc = samples[i].pc;
+    if (pc_locations_.find(pc) == pc_locations_.end()) {
+      // Resolved once per PC, samples of one loop mostly hit the same few PCs.
+      int64_t delta = 0;
+      pc_location_t loc;
+      loc.code_object =
+          core::Runtime::runtime_singleton_->loader()->FindLoadedCodeObject(pc, &delta);
+      loc.offset = pc - delta;
+      pc_locations_.emplace(pc, loc);
     }
-    break;
-    case HSA_VEN_AMD_PCS_METHOD_STOCHASTIC_V1: {
-      size_t buf_samples = buf1_sz / sizeof(perf_sample_snapshot_v1_t);
-      perf_sample_snapshot_v1_t* samples = reinterpret_cast<perf_sample_snapshot_v1_t*>(buf1);
-      while (buf_samples--) {
-        samples->timestamp = gpuAgent->TranslateTime(samples->timestamp);
-        samples++;
-      }
-
-      buf_samples = buf2_sz / sizeof(perf_sample_snapshot_v1_t);
-      samples = reinterpret_cast<perf_sample_snapshot_v1_t*>(buf2);
-      while (buf_samples--) {
-        samples->timestamp = gpuAgent->TranslateTime(samples->timestamp);
-        samples++;
-      }
+    histogram_[std::make_pair(samples[i].correlation_id, pc)]++;
+  }
+}
+
+void PcsRuntime::PcSamplingSession::SetHistogramCallback(
+    hsa_ven_amd_pcs_histogram_callback_t callback, void* callback_data) {
+  ScopedAcquire<KernelMutex> lock(&histogram_lock_);
+  histogram_callback_ = callback;
+  histogram_callback_data_ = callback_data;
+  histogram_.clear();
+  pc_locations_.clear();
+  histogram_lost_sample_count_ = 0;
+}
+
+void PcsRuntime::PcSamplingSession::DeliverHistogram() {
+  std::vector<hsa_ven_amd_pcs_histogram_entry_t> entries;
+  size_t lost;
+  {
+    ScopedAcquire<KernelMutex> lock(&histogram_lock_);
+    entries.reserve(histogram_.size());
+    for (const auto& bin : histogram_) {
+      const pc_location_t& loc = pc_locations_[bin.first.second];
+      entries.push_back({bin.first.first, loc.code_object, loc.offset, bin.second});
     }
-    break;
+    lost = histogram_lost_sample_count_;
+    histogram_.clear();
+    pc_locations_.clear();
+    histogram_lost_sample_count_ = 0;
   }
 
-  csd.data_ready_callback(csd.client_callback_data, buf1_sz + buf2_sz, lost_sample_count,
-                          &PcSamplingDataCopyCallback,
-                          /* hsa_callback_data*/ this);
-  return HSA_STATUS_SUCCESS;
+  // Called outside histogram_lock_ so the sampling thread keeps aggregating.
+  if (!entries.empty() || lost)
+    histogram_callback_(histogram_callback_data_, entries.data(), entries.size(), lost);
+}
+
+hsa_status_t PcsRuntime::PcSamplingDataView(void* hsa_callback_data,
+                                            hsa_ven_amd_pcs_data_view_t* view) {
+  IS_BAD_PTR(hsa_callback_data);
+  IS_BAD_PTR(view);
+
+  return reinterpret_cast<PcSamplingSession*>(hsa_callback_data)->DataView(view);
 }
 
 hsa_status_t PcsRuntime::PcSamplingIterateConfig(
@@ -351,7 +411,25 @@ hsa_status_t PcsRuntime::PcSamplingFlush(hsa_ven_amd_pcs_t handle) {
   }
   AMD::GpuAgentInt* gpu_agent = static_cast<AMD::GpuAgentInt*>(pcSamplingSessionIt->second.agent);
 
-  return gpu_agent->PcSamplingFlush(pcSamplingSessionIt->second);
+  hsa_status_t ret = gpu_agent->PcSamplingFlush(pcSamplingSessionIt->second);
+  if (ret == HSA_STATUS_SUCCESS && pcSamplingSessionIt->second.isAggregating())
+    pcSamplingSessionIt->second.DeliverHistogram();
+  return ret;
+}
+
+hsa_status_t PcsRuntime::PcSamplingAggregate(
+    hsa_ven_amd_pcs_t handle, hsa_ven_amd_pcs_histogram_callback_t histogram_callback,
+    void* client_callback_data) {
+  ScopedAcquire<KernelMutex> lock(&pc_sampling_lock_);
+  auto pcSamplingSessionIt = pc_sampling_.find(reinterpret_cast<uint64_t>(handle.handle));
+  if (pcSamplingSessionIt == pc_sampling_.end()) {
+    debug_warning(false && "Cannot find PcSampling session");
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+  if (pcSamplingSessionIt->second.isActive()) return HSA_STATUS_ERROR;
+
+  pcSamplingSessionIt->second.SetHistogramCallback(histogram_callback, client_callback_data);
+  return HSA_STATUS_SUCCESS;
 }
 
 }  // namespace pcs
@@ -46,6 +46,9 @@
 #include <atomic>
 #include <map>
 #include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "hsakmt/hsakmt.h"
 
@@ -72,7 +75,15 @@ class PcsRuntime {
 
   class PcSamplingSession {
    public:
-    PcSamplingSession() : agent(NULL), thunkId_(0), active_(false){};
+    PcSamplingSession()
+        : agent(NULL),
+          read_index(0),
+          lost_sample_count(0),
+          thunkId_(0),
+          active_(false),
+          histogram_callback_(nullptr),
+          histogram_callback_data_(nullptr),
+          histogram_lost_sample_count_(0){};
     PcSamplingSession(core::Agent* agent, hsa_ven_amd_pcs_method_kind_t method,
                       hsa_ven_amd_pcs_units_t units, size_t interval, size_t latency,
                       size_t buffer_size, hsa_ven_amd_pcs_data_ready_callback_t data_ready_callback,
@@ -83,14 +94,26 @@ class PcsRuntime {
     size_t buffer_size() const { return csd.buffer_size; }
     hsa_ven_amd_pcs_method_kind_t method() const { return csd.method; }
     size_t latency() const { return csd.latency; }
+    hsa_ven_amd_pcs_units_t units() const { return csd.units; }
+    size_t interval() const { return csd.interval; }
     size_t sample_size() const { return sample_size_; }
 
     void GetHsaKmtSamplingInfo(HsaPcSamplingInfo* sampleInfo);
     hsa_status_t HandleSampleData(uint8_t* buf1, size_t buf1_sz, uint8_t* buf2, size_t buf2_sz,
                                   size_t lost_sample_count);
     hsa_status_t DataCopyCallback(uint8_t* buffer, size_t buffer_size);
+    hsa_status_t DataView(hsa_ven_amd_pcs_data_view_t* view);
+
+    void SetHistogramCallback(hsa_ven_amd_pcs_histogram_callback_t callback, void* callback_data);
+    bool isAggregating() const { return histogram_callback_ != nullptr; }
+    /// @brief Deliver the histogram to the client and reset it.
+    void DeliverHistogram();
 
     core::Agent* agent;
+    // Position of this session in the agent's sample ring and the samples it lost since its
+    // last data_ready_callback. Owned by the agent.
+    uint64_t read_index;
+    size_t lost_sample_count;
     void SetThunkId(HsaPcSamplingTraceId thunkId) { thunkId_ = thunkId; }
     HsaPcSamplingTraceId ThunkId() { return thunkId_; }
     bool isActive() { return active_; }
@@ -122,6 +145,23 @@ class PcsRuntime {
       size_t buf2_sz;
     };
     struct data_ready_info_t data_rdy;
+
+    template <typename SampleT> void AggregateSamples(const uint8_t* buf, size_t size);
+
+    // Histogram of sample hits keyed by (correlation_id, pc), and the code object location of
+    // every PC seen since the last delivery. Code objects may be unloaded and their addresses
+    // reused, so locations are not kept across deliveries.
+    struct pc_location_t {
+      hsa_loaded_code_object_t code_object;
+      uint64_t offset;
+    };
+    hsa_ven_amd_pcs_histogram_callback_t histogram_callback_;
+    void* histogram_callback_data_;
+    std::map<std::pair<uint64_t, uint64_t>, uint64_t> histogram_;
+    std::unordered_map<uint64_t, pc_location_t> pc_locations_;
+    size_t histogram_lost_sample_count_;
+    // Serializes aggregation on the sampling thread with delivery by hsa_ven_amd_pcs_flush.
+    KernelMutex histogram_lock_;
   };  // class PcSamplingSession
 
   hsa_status_t PcSamplingIterateConfig(
@@ -146,6 +186,10 @@ class PcsRuntime {
   hsa_status_t PcSamplingStart(hsa_ven_amd_pcs_t handle);
   hsa_status_t PcSamplingStop(hsa_ven_amd_pcs_t handle);
   hsa_status_t PcSamplingFlush(hsa_ven_amd_pcs_t handle);
+  hsa_status_t PcSamplingDataView(void* hsa_callback_data, hsa_ven_amd_pcs_data_view_t* view);
+  hsa_status_t PcSamplingAggregate(hsa_ven_amd_pcs_t handle,
+                                   hsa_ven_amd_pcs_histogram_callback_t histogram_callback,
+                                   void* client_callback_data);
 
  private:
   /// @brief Initialize singleton object, must be called once.